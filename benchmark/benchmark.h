@@ -0,0 +1,180 @@
+/**
+ * @file
+ * Minimal on-target benchmark harness
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_BENCHMARK_H
+#define ZHELE_BENCHMARK_H
+
+#include <zhele/clock.h>
+#include <zhele/delay.h>
+
+#include <cstring>
+#include <stdint.h>
+
+namespace Benchmark
+{
+    /**
+     * @brief Benchmark runner
+     *
+     * @details
+     * Every operation call is measured separately by @ref Zhele::CycleCounter (DWT on Cortex-M3/M4,
+     * SysTick on Cortex-M0), measurement overhead is subtracted. Results are written as CSV lines:
+     * @code
+     *  # zhele-benchmark,<family>,<core clock>
+     *  name,iterations,avg_cycles,min_cycles,max_cycles,bytes,bytes_per_second
+     *  gpio.pin_set,1000,2,2,14,0,0
+     *  ...
+     *  # end
+     * @endcode
+     * Bytes per second are calculated from average cycles (it's zero for operations without data).
+     *
+     * @tparam _Output Output with Write(const void* data, size_t size) method (Usart, Trace::ItmPort and so on)
+     */
+    template<typename _Output>
+    class Runner
+    {
+    public:
+        /**
+         * @brief Calibrates measurement and writes report header
+         *
+         * @param [in] family Family name
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Begin(const char* family)
+        {
+            Zhele::CycleCounter::Enable();
+
+            _overhead = ~0u;
+            for (unsigned i = 0; i < 16; ++i)
+            {
+                uint32_t cycles = Zhele::CycleCounter::Measure([]() {});
+                if (cycles < _overhead)
+                    _overhead = cycles;
+            }
+
+            WriteString("# zhele-benchmark,");
+            WriteString(family);
+            WriteString(",");
+            WriteNumber(Zhele::Clock::SysClock::ClockFreq());
+            WriteString("\r\nname,iterations,avg_cycles,min_cycles,max_cycles,bytes,bytes_per_second\r\n");
+        }
+
+        /**
+         * @brief Writes report end
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void End()
+        {
+            WriteString("# end\r\n");
+        }
+
+        /**
+         * @brief Measures operation and writes result line
+         *
+         * @param [in] name Operation name
+         * @param [in] iterations Measurements count
+         * @param [in] bytes Bytes processed by one operation call (zero if not applicable)
+         * @param [in] operation Operation (lambda)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Operation>
+        static void Run(const char* name, unsigned iterations, unsigned bytes, _Operation&& operation)
+        {
+            uint64_t total = 0;
+            uint32_t min = ~0u;
+            uint32_t max = 0;
+
+            for (unsigned i = 0; i < iterations; ++i)
+            {
+                uint32_t cycles = Zhele::CycleCounter::Measure(operation);
+                cycles = cycles > _overhead ? cycles - _overhead : 0;
+
+                total += cycles;
+                if (cycles < min)
+                    min = cycles;
+                if (cycles > max)
+                    max = cycles;
+            }
+
+            WriteResult(name, iterations, static_cast<uint32_t>(total / iterations), min, max, bytes);
+        }
+
+        /**
+         * @brief Writes result line for externally measured cycles (for example, interrupt latency)
+         *
+         * @param [in] name Operation name
+         * @param [in] iterations Measurements count
+         * @param [in] total Total cycles (measurement overhead is subtracted from every sample)
+         * @param [in] min Min cycles
+         * @param [in] max Max cycles
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Report(const char* name, unsigned iterations, uint64_t total, uint32_t min, uint32_t max)
+        {
+            uint64_t overhead = static_cast<uint64_t>(iterations) * _overhead;
+            total = total > overhead ? total - overhead : 0;
+            min = min > _overhead ? min - _overhead : 0;
+            max = max > _overhead ? max - _overhead : 0;
+
+            WriteResult(name, iterations, static_cast<uint32_t>(total / iterations), min, max, 0);
+        }
+
+    private:
+        static void WriteResult(const char* name, unsigned iterations, uint32_t average, uint32_t min, uint32_t max, unsigned bytes)
+        {
+            uint64_t bytesPerSecond = bytes != 0 && average != 0
+                ? static_cast<uint64_t>(bytes) * Zhele::Clock::SysClock::ClockFreq() / average
+                : 0;
+
+            WriteString(name);
+            WriteString(",");
+            WriteNumber(iterations);
+            WriteString(",");
+            WriteNumber(average);
+            WriteString(",");
+            WriteNumber(min);
+            WriteString(",");
+            WriteNumber(max);
+            WriteString(",");
+            WriteNumber(bytes);
+            WriteString(",");
+            WriteNumber(static_cast<uint32_t>(bytesPerSecond));
+            WriteString("\r\n");
+        }
+
+        static void WriteString(const char* string)
+        {
+            _Output::Write(string, strlen(string));
+        }
+
+        static void WriteNumber(uint32_t value)
+        {
+            char buffer[10];
+            unsigned position = sizeof(buffer);
+            do
+            {
+                buffer[--position] = '0' + value % 10;
+                value /= 10;
+            } while (value != 0);
+
+            _Output::Write(buffer + position, sizeof(buffer) - position);
+        }
+
+        static inline uint32_t _overhead = 0; ///< Measurement overhead (cycles)
+    };
+}
+
+#endif //! ZHELE_BENCHMARK_H
@@ -0,0 +1,54 @@
+// Compile-time benchmark of TypeList algorithms.
+// Build time of this file (see CMakeLists.txt) is the measured value,
+// TYPE_LIST_SIZE sets types count (pin lists and USB endpoints lists are far shorter).
+
+#include <zhele/common/template_utils/type_list.h>
+
+#include <utility>
+
+#if !defined (TYPE_LIST_SIZE)
+    #define TYPE_LIST_SIZE 64
+#endif
+
+using namespace Zhele::TemplateUtils;
+
+namespace
+{
+    template<int _Number>
+    struct Item
+    {
+        static constexpr int Number = _Number;
+    };
+
+    constexpr int Size = TYPE_LIST_SIZE;
+
+    // Items in reversed order
+    constexpr auto Items = []<int... Is>(std::integer_sequence<int, Is...>) {
+        return TypeList<Item<Size - 1 - Is>...>{};
+    }(std::make_integer_sequence<int, Size>());
+
+    // Every item is twice in list
+    constexpr auto Duplicates = []<int... Is>(std::integer_sequence<int, Is...>) {
+        return TypeList<Item<Is % (Size / 2)>...>{};
+    }(std::make_integer_sequence<int, Size>());
+
+    constexpr auto Sorted = Items.sort([](auto a, auto b) { return a.Number < b.Number; });
+    static_assert(Sorted.size() == Size);
+    static_assert(std::is_same_v<TypeUnbox<Sorted.head()>, Item<0>>);
+    static_assert(std::is_same_v<TypeUnbox<Sorted.back()>, Item<Size - 1>>);
+    static_assert(std::is_same_v<TypeUnbox<Sorted.template get<Size / 2>()>, Item<Size / 2>>);
+
+    constexpr auto Unique = Duplicates.remove_duplicates();
+    static_assert(Unique.size() == Size / 2);
+    static_assert(Unique.is_unique());
+    static_assert(!Duplicates.is_unique());
+
+    static_assert(Items.template search<Item<0>>() == Size - 1);
+    static_assert(Items.template search<Item<Size>>() == -1);
+    static_assert(Unique.template search<Item<Size / 2 - 1>>() == Size / 2 - 1);
+}
+
+int main()
+{
+    return 0;
+}
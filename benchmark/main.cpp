@@ -0,0 +1,224 @@
+// On-target benchmarks for hot paths of Zhele.
+// Results are written as CSV lines (see benchmark.h) to USART1 (Pb6, 115200 8N1)
+// or to ITM stimulus port 0 if ZHELE_BENCHMARK_SWO is defined (Cortex-M3/M4 only).
+// Benchmarks run at core clock after reset, cycles are comparable between releases
+// on the same board, bytes per second are given for this clock.
+
+#include "benchmark.h"
+
+#include <zhele/containers/ring_buffer.h>
+#include <zhele/crc.h>
+#include <zhele/dma.h>
+#include <zhele/iopins.h>
+#include <zhele/pinlist.h>
+#include <zhele/soft_crc.h>
+#include <zhele/spi.h>
+#include <zhele/usart.h>
+
+#if defined (USB_PMAADDR)
+    #include <zhele/common/usb/common.h>
+#endif
+
+#if defined (ZHELE_BENCHMARK_SWO)
+    #include <zhele/itm.h>
+#endif
+
+using namespace Zhele;
+using namespace Zhele::IO;
+
+#if defined (STM32F0)
+    const char Family[] = "f0";
+    using MemDma = Dma1Channel1;
+    using Serial = Usart1;
+    using SpiInterface = Spi1;
+    #define BENCHMARK_IRQn EXTI0_1_IRQn
+    #define BENCHMARK_IRQHandler EXTI0_1_IRQHandler
+#elif defined (STM32F1)
+    const char Family[] = "f1";
+    using MemDma = Dma1Channel1;
+    using Serial = Usart1;
+    using SpiInterface = Spi1;
+    #define BENCHMARK_IRQn EXTI0_IRQn
+    #define BENCHMARK_IRQHandler EXTI0_IRQHandler
+#elif defined (STM32F4)
+    const char Family[] = "f4";
+    using MemDma = Dma2Stream1; // Only DMA2 is able to perform memory-to-memory transfers
+    using Serial = Usart1;
+    using SpiInterface = Spi1;
+    #define BENCHMARK_IRQn EXTI0_IRQn
+    #define BENCHMARK_IRQHandler EXTI0_IRQHandler
+#elif defined (STM32G0)
+    #include <zhele/dmamux.h>
+    const char Family[] = "g0";
+    using MemDma = Dma1Channel1;
+    using Serial = Usart1<>;
+    using SpiInterface = Spi1<Dma1Channel2, Dma1Channel3>;
+    #define BENCHMARK_IRQn EXTI0_1_IRQn
+    #define BENCHMARK_IRQHandler EXTI0_1_IRQHandler
+#else
+    #error "No benchmark"
+#endif
+
+#if defined (ZHELE_BENCHMARK_SWO)
+    using Output = Trace::ItmPort<0>;
+#else
+    using Output = Serial;
+#endif
+
+using Bench = Benchmark::Runner<Output>;
+using VirtualPort = PinList<Pa0, Pa1, Pc14, Pc15>;
+
+const unsigned BlockSize = 512;
+alignas(4) uint8_t Source[BlockSize];
+alignas(4) uint8_t Destination[BlockSize];
+
+volatile uint32_t Sink; ///< Keeps results of pure functions
+volatile uint32_t IrqEntry;
+volatile bool IrqHandled;
+
+void GpioBenchmarks()
+{
+    VirtualPort::Enable();
+    VirtualPort::SetConfiguration<VirtualPort::Configuration::Out>();
+    VirtualPort::SetDriverType<VirtualPort::DriverType::PushPull>();
+
+    Bench::Run("gpio.pin_set", 1000, 0, []() { Pa0::Set(); });
+    Bench::Run("gpio.pin_toggle", 1000, 0, []() { Pa0::Toggle(); });
+
+    static unsigned value = 0;
+    Bench::Run("gpio.pinlist_write", 1000, 0, []() { VirtualPort::Write(++value); });
+}
+
+template<unsigned _Size>
+void MemToMem()
+{
+    MemDma::Transfer(MemDma::Mem2Mem | MemDma::MSize32Bits | MemDma::PSize32Bits | MemDma::MemIncrement | MemDma::PeriphIncrement,
+        Destination, Source, _Size / 4);
+    while (!MemDma::Ready()) continue;
+}
+
+void DmaBenchmarks()
+{
+    Bench::Run("dma.mem2mem_64", 100, 64, MemToMem<64>);
+    Bench::Run("dma.mem2mem_512", 100, BlockSize, MemToMem<BlockSize>);
+}
+
+void UsartBenchmarks()
+{
+    // Report line being sent is flushed by first iteration, so min is more representative here
+    Bench::Run("usart.write_byte", 16, 1, []() { Serial::Write(uint8_t(0)); });
+    Bench::Run("usart.write_64", 4, 64, []() { Serial::Write(Source, 64); });
+}
+
+void SpiBenchmarks()
+{
+#if defined (STM32G0)
+    Dma1::Enable();
+    DmaMux1Channel2::SelectRequestInput(DmaMux1::RequestInput::Spi1Tx);
+    DmaMux1Channel3::SelectRequestInput(DmaMux1::RequestInput::Spi1Rx);
+#endif
+    // MOSI, MISO and SCK only, data is sent to nothing
+    SpiInterface::Init(SpiInterface::Fastest);
+    SpiInterface::SelectPins<Pa7, Pa6, Pa5, NullPin>();
+
+    Bench::Run("spi.write_byte", 100, 1, []() { SpiInterface::Send(0xff); });
+    Bench::Run("spi.transfer_8", 100, 8, []() { SpiInterface::Transfer(Source, Destination, 8); });
+    Bench::Run("spi.transfer_512", 20, BlockSize, []() { SpiInterface::Transfer(Source, Destination, BlockSize); });
+}
+
+void CrcBenchmarks()
+{
+    Crc::Enable();
+
+    Bench::Run("crc.hw_crc32_512", 20, BlockSize, []() { Sink = Crc::CalculateCrc32(Source, BlockSize); });
+    Bench::Run("crc.soft_crc32c_512", 20, BlockSize, []() { Sink = Crc32C::Calculate(Source, BlockSize); });
+    Bench::Run("crc.soft_crc16_modbus_512", 20, BlockSize, []() { Sink = Crc16Modbus::Calculate(Source, BlockSize); });
+}
+
+void UsbBenchmarks()
+{
+#if defined (USB_PMAADDR)
+    Clock::UsbClock::Enable();
+
+    // Buffer (64 bytes) is placed after buffer table
+    void* pma = reinterpret_cast<void*>(USB_PMAADDR + 0x40 * Usb::PmaAlignMultiplier);
+
+    Bench::Run("usb.copy_to_pma_64", 100, 64, [pma]() { Usb::CopyToUsbPma(pma, Source, 64); });
+    Bench::Run("usb.copy_from_pma_64", 100, 64, [pma]() { Usb::CopyFromUsbPma(Destination, pma, 64); });
+    Bench::Run("usb.copy_to_pma_64_unaligned", 100, 64, [pma]() { Usb::CopyToUsbPma(pma, Source + 1, 64); });
+#endif
+}
+
+void RingBufferBenchmarks()
+{
+    static Containers::RingBuffer<64, uint8_t> po2Buffer;
+    static Containers::RingBuffer<60, uint8_t> buffer;
+
+    Bench::Run("ring.po2_push_pop", 1000, 1, []() { po2Buffer.push_back(0x55); po2Buffer.pop_front(); });
+    Bench::Run("ring.push_pop", 1000, 1, []() { buffer.push_back(0x55); buffer.pop_front(); });
+}
+
+void InterruptBenchmarks()
+{
+    // Latency from pending interrupt (by software) to first instruction of handler body
+    const unsigned Iterations = 100;
+    uint64_t total = 0;
+    uint32_t min = ~0u;
+    uint32_t max = 0;
+
+    NVIC_EnableIRQ(BENCHMARK_IRQn);
+    for (unsigned i = 0; i < Iterations; ++i)
+    {
+        IrqHandled = false;
+        uint32_t start = CycleCounter::Read();
+        NVIC_SetPendingIRQ(BENCHMARK_IRQn);
+        while (!IrqHandled) continue;
+
+        uint32_t cycles = CycleCounter::Elapsed(start, IrqEntry);
+        total += cycles;
+        if (cycles < min)
+            min = cycles;
+        if (cycles > max)
+            max = cycles;
+    }
+    NVIC_DisableIRQ(BENCHMARK_IRQn);
+
+    Bench::Report("isr.latency", Iterations, total, min, max);
+}
+
+int main()
+{
+#if defined (ZHELE_BENCHMARK_SWO)
+    Trace::Itm::Enable(2000000);
+#else
+    Serial::Init(115200);
+    Serial::SelectTxRxPins<Pb6, Pb7>();
+#endif
+
+    for (unsigned i = 0; i < BlockSize; ++i)
+        Source[i] = static_cast<uint8_t>(i);
+
+    Bench::Begin(Family);
+    GpioBenchmarks();
+    DmaBenchmarks();
+    UsartBenchmarks();
+    SpiBenchmarks();
+    CrcBenchmarks();
+    UsbBenchmarks();
+    RingBufferBenchmarks();
+    InterruptBenchmarks();
+    Bench::End();
+
+    for (;;)
+    {
+    }
+}
+
+extern "C"
+{
+    void BENCHMARK_IRQHandler()
+    {
+        IrqEntry = CycleCounter::Read();
+        IrqHandled = true;
+    }
+}
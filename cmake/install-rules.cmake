@@ -48,6 +48,15 @@ install(
     COMPONENT zhele_Development
 )
 
+install(
+    FILES
+    cmake/zhele-placement.ld
+    cmake/zhele-placement-ccm.ld
+    cmake/zhele-placement-sram2.ld
+    DESTINATION "${zhele_INSTALL_CMAKEDIR}"
+    COMPONENT zhele_Development
+)
+
 install(
     FILES "${PROJECT_BINARY_DIR}/${package}ConfigVersion.cmake"
     DESTINATION "${zhele_INSTALL_CMAKEDIR}"
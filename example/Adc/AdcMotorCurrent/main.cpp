@@ -0,0 +1,133 @@
+#include <zhele/clock.h>
+#include <zhele/iopins.h>
+#include <zhele/motor_sampler.h>
+#include <zhele/timer.h>
+#include <zhele/usart.h>
+
+#include <algorithm>
+#include <cstdio> // For snprintf
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// Phase A and B shunt amplifiers (phase C current is -(A + B))
+using Sampler = MotorSampler<Timer1, Adc1>;
+
+using UsartConnection = Usart2;
+
+// 20 kHz center-aligned PWM at 72 MHz timer clock
+constexpr uint16_t PwmPeriod = 72000000 / 20000 / 2;
+
+// Amplifiers output is biased to the middle of ADC range
+constexpr int32_t CurrentOffset = 2048;
+
+// Alignment current (Q15)
+constexpr int16_t ReferenceAlpha = 4096;
+
+void ConfigureClock();
+void ConfigurePwm();
+void ControlLoop(const uint16_t* currents, uint8_t count);
+
+volatile int16_t CurrentAlpha = 0;
+volatile int16_t CurrentBeta = 0;
+
+// This program holds rotor in alignment position (current vector along phase A) by proportional current loop.
+// Currents are sampled once per PWM period in the middle of low-side pulses, loop runs in ADC interrupt
+// and new pulses are applied on the next PWM period. Measured current vector is sent to USART.
+int main()
+{
+    ConfigureClock();
+
+    UsartConnection::Init(115200);
+    UsartConnection::SelectTxRxPins<Pa2, Pa3>();
+
+    ConfigurePwm();
+
+    // 12 MHz ADC clock: two conversions of 7 + 12.5 cycles take 3.25 us (117 timer ticks), so trigger is 58 ticks before peak
+    Adc1::Init<Adc1::AdcDivider::Div6>();
+    NVIC_SetPriority(ADC1_IRQn, 0);
+    Sampler::Start<Pa0, Pa1>(ControlLoop, 7, 58);
+
+    Timer1::EnableOutputs();
+    Timer1::Start();
+
+    char message[48];
+    for (;;)
+    {
+        int length = snprintf(message, sizeof(message), "alpha %d, beta %d\r\n", CurrentAlpha, CurrentBeta);
+        UsartConnection::Write(message, length);
+    }
+}
+
+void ControlLoop(const uint16_t* currents, uint8_t count)
+{
+    (void)count;
+
+    // Q15 phase currents
+    const int32_t a = (static_cast<int32_t>(currents[0]) - CurrentOffset) << 4;
+    const int32_t b = (static_cast<int32_t>(currents[1]) - CurrentOffset) << 4;
+
+    // Clarke transform (1 / sqrt(3) = 18919 in Q15)
+    const int32_t alpha = a;
+    const int32_t beta = ((a + 2 * b) * 18919) >> 15;
+    CurrentAlpha = static_cast<int16_t>(std::clamp<int32_t>(alpha, INT16_MIN, INT16_MAX));
+    CurrentBeta = static_cast<int16_t>(std::clamp<int32_t>(beta, INT16_MIN, INT16_MAX));
+
+    // Proportional regulator (gain is 1/2)
+    const int32_t voltageAlpha = (ReferenceAlpha - alpha) / 2;
+    const int32_t voltageBeta = -beta / 2;
+    Timer1::SetSpaceVector(static_cast<int16_t>(std::clamp<int32_t>(voltageAlpha, INT16_MIN, INT16_MAX)),
+        static_cast<int16_t>(std::clamp<int32_t>(voltageBeta, INT16_MIN, INT16_MAX)));
+}
+
+void ConfigurePwm()
+{
+    Timer1::Enable();
+    Timer1::InitCenterAligned(PwmPeriod);
+    Timer1::SetDeadTime<72000000, 500>();
+
+    Timer1::ComplementaryPwm<0>::SetOutputMode(Timer1::ComplementaryPwm<0>::PWM1);
+    Timer1::ComplementaryPwm<0>::SelectPins<Pa8>();
+    Timer1::ComplementaryPwm<0>::SelectComplementaryPins<Pb13>();
+    Timer1::ComplementaryPwm<0>::Enable();
+    Timer1::ComplementaryPwm<0>::EnableComplementary();
+
+    Timer1::ComplementaryPwm<1>::SetOutputMode(Timer1::ComplementaryPwm<1>::PWM1);
+    Timer1::ComplementaryPwm<1>::SelectPins<Pa9>();
+    Timer1::ComplementaryPwm<1>::SelectComplementaryPins<Pb14>();
+    Timer1::ComplementaryPwm<1>::Enable();
+    Timer1::ComplementaryPwm<1>::EnableComplementary();
+
+    Timer1::ComplementaryPwm<2>::SetOutputMode(Timer1::ComplementaryPwm<2>::PWM1);
+    Timer1::ComplementaryPwm<2>::SelectPins<Pa10>();
+    Timer1::ComplementaryPwm<2>::SelectComplementaryPins<Pb15>();
+    Timer1::ComplementaryPwm<2>::Enable();
+    Timer1::ComplementaryPwm<2>::EnableComplementary();
+
+    // Zero vector (50% duty) until the first sample
+    Timer1::SetSpaceVector(0, 0);
+
+    // Driver fault input
+    Timer1::SelectBreakPins<Pb12>();
+    Timer1::EnableBreak(Timer1::BreakPolarity::ActiveLow);
+}
+
+#if defined (STM32F1) // F103C8
+void ConfigureClock()
+{
+    PllClock::SelectClockSource<PllClock::ClockSource::External>();
+    PllClock::SetMultiplier<9>();
+    Apb1Clock::SetPrescaler<Apb1Clock::Div2>();
+    SysClock::SelectClockSource<SysClock::Pll>();
+}
+#endif
+
+extern "C"
+{
+    void ADC1_IRQHandler()
+    {
+        Sampler::IrqHandler();
+    }
+}
@@ -0,0 +1,89 @@
+#include <zhele/adc_sampler.h>
+#include <zhele/clock.h>
+#include <zhele/deferred.h>
+#include <zhele/iopins.h>
+#include <zhele/spectrum_analyzer.h>
+#include <zhele/timer.h>
+#include <zhele/usart.h>
+
+#include <cstdio> // For snprintf
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// 10 kHz sampling paced by Timer3 TRGO (72 MHz timer and ADC source clocks)
+using Sampler = AdcSampler<Adc1, Timer3, 10000, 72000000, 72000000>;
+
+// 256-point Q15 transform with Hann window, bin is 10000 / 256 = 39 Hz
+using Analyzer = SpectrumAnalyzer<Adc1, int16_t, 256>;
+
+using UsartConnection = Usart1;
+
+void ConfigureClock();
+void OnSpectrum(std::span<const Dsp::Complex<int16_t>> spectrum);
+
+volatile bool ReportPending = false;
+Dsp::SpectrumPeak<int16_t> Peak;
+
+// This program samples Pa0 at 10 kHz and transforms every block of 256 samples while the next one is filling.
+// Peak frequency and its magnitude, cycles spent on the last block and dropped blocks count are sent to USART.
+int main()
+{
+    ConfigureClock();
+
+    UsartConnection::Init(115200);
+    UsartConnection::SelectTxRxPins<Pa9, Pa10>();
+
+    // Transform runs in PendSV handler (the lowest priority)
+    Deferred::Init();
+    Analyzer::Init(OnSpectrum);
+
+    Sampler::Init();
+    Sampler::Start<Pa0>(Analyzer::Buffer(), Analyzer::BlockSize, Analyzer::BlockReady);
+
+    char message[80];
+    for (;;)
+    {
+        if (!ReportPending)
+            continue;
+
+        const Dsp::SpectrumPeak<int16_t> peak = Peak;
+        ReportPending = false;
+
+        // Block takes 256 / 10 kHz = 25.6 ms = 1843200 cycles at 72 MHz
+        int length = snprintf(message, sizeof(message), "peak %lu Hz, magnitude %d, %lu cycles, dropped %lu\r\n",
+            static_cast<unsigned long>(Analyzer::Fft::BinFrequency(peak.bin, 10000)), peak.magnitude,
+            static_cast<unsigned long>(Analyzer::LastCycles()), static_cast<unsigned long>(Analyzer::Dropped()));
+        UsartConnection::Write(message, length);
+    }
+}
+
+void OnSpectrum(std::span<const Dsp::Complex<int16_t>> spectrum)
+{
+    // Main loop reports the latest peak (it's slower than analyzer)
+    if (ReportPending)
+        return;
+
+    Peak = Analyzer::Fft::FindPeak(spectrum);
+    ReportPending = true;
+}
+
+#if defined (STM32F1) // F103C8
+void ConfigureClock()
+{
+    PllClock::SelectClockSource<PllClock::ClockSource::External>();
+    PllClock::SetMultiplier<9>();
+    Apb1Clock::SetPrescaler<Apb1Clock::Div2>();
+    SysClock::SelectClockSource<SysClock::Pll>();
+}
+#endif
+
+extern "C"
+{
+    void PendSV_Handler()
+    {
+        Deferred::IrqHandler();
+    }
+}
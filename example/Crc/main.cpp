@@ -1,4 +1,5 @@
 #include <zhele/crc.h>
+#include <zhele/soft_crc.h>
 
 int main()
 {
@@ -12,7 +13,18 @@ int main()
     uint8_t data[] = "123456789";
     uint32_t crc = Zhele::Crc::CalculateCrc32(data, sizeof(data));
 
+    // Incremental calculation (chunks may have any size), result is the same
+    Zhele::Crc::Begin();
+    Zhele::Crc::Update(std::span<const uint8_t>(data, 3));
+    Zhele::Crc::Update(std::span<const uint8_t>(data + 3, sizeof(data) - 3));
+    uint32_t incrementalCrc = Zhele::Crc::Finish();
+
+    // Software CRC with compile-time tables (standard CRC-32 is calculated by hardware unit)
+    uint16_t modbusCrc = Zhele::Crc16Modbus::Calculate(data, sizeof(data) - 1);
+    uint32_t crc32c = Zhele::Crc32C::Calculate(data, sizeof(data) - 1);
+    uint8_t crc8 = Zhele::SoftCrc<0x07, 8, false, 0x00, 0x00, Zhele::CrcTable::Nibble>::Calculate(data, sizeof(data) - 1);
+
     for(;;)
     {
     }
-}
\ No newline at end of file
+}
@@ -2,45 +2,119 @@
 // I need to define this macro globally (as compiler option) for correct clock settings.
 
 #include <zhele/drivers/adm485.h>
+#include <zhele/drivers/modbus_rtu.h>
+
+#if defined (STM32G0)
+    #include <zhele/dma.h>
+    #include <zhele/dmamux.h>
+    using Usart = Zhele::Usart1<Zhele::Dma1Channel1, Zhele::Dma1Channel2>;
+#else
+    using Usart = Zhele::Usart1;
+#endif
 
 using namespace Zhele;
 using namespace Zhele::IO;
 
-using Connection = Zhele::Drivers::Adm485<Zhele::Usart1, Pb5>;
+// DE is driven by Pb5 (released in TC interrupt).
+// Use NullPin to drive DE by USART (RTS pin in alternate function mode) on F0/G0.
+using Connection = Zhele::Drivers::Adm485<Usart, Pb5>;
+using Modbus = Zhele::Drivers::ModbusRtu<Connection>;
 using Led = Pc13Inv;
 
-char TxBuffer[] = "SomeData";
-char RxBuffer[9];
+const uint8_t SlaveAddress = 0x01;
+const uint8_t ReadHoldingRegisters = 0x03;
+
+volatile bool ResponseReceived = true;
+uint16_t Registers[10];
 
-void TransferCompleteHandler(void* data, unsigned size, bool success);
+void FrameReceived(uint8_t address, uint8_t function, const uint8_t* data, unsigned size);
 
 int main()
-{	
+{
     Led::Port::Enable();
     Led::SetConfiguration(Led::Configuration::Out);
     Led::SetDriverType(Led::DriverType::PushPull);
     Led::Clear();
 
-    // Init
-    Connection::Init(9600);
-    Connection::SelectTxRxPins<Pb6, Pb7>();
+#if defined (STM32G0)
+    Zhele::Dma1::Enable();
+    Zhele::DmaMux1Channel1::SelectRequestInput(Zhele::DmaMux1::RequestInput::Usart1Tx);
+    Zhele::DmaMux1Channel2::SelectRequestInput(Zhele::DmaMux1::RequestInput::Usart1Rx);
+#endif
 
-    // Init async read (via DMA)
-    Connection::EnableAsyncRead(RxBuffer, 9, TransferCompleteHandler);
+    // Modbus master
+    Modbus::Init(115200);
+    Connection::SelectTxRxPins<Pb6, Pb7>();
+    Modbus::SetFrameCallback(FrameReceived);
 
-    // Async write
-    // Connection::Write(TxBuffer, 8);
-    // Async write
-    Connection::WriteAsync(TxBuffer, 8);
+    // Read 10 holding registers from address 0
+    const uint8_t request[] = {0x00, 0x00, 0x00, 0x0a};
 
     for (;;)
     {
+        // Next request is sent right after response (response end is detected by t3.5 silence)
+        if (ResponseReceived && Modbus::Send(SlaveAddress, ReadHoldingRegisters, request, sizeof(request)))
+            ResponseReceived = false;
     }
 }
 
-void TransferCompleteHandler(void* data, unsigned size, bool success)
+void FrameReceived(uint8_t address, uint8_t function, const uint8_t* data, unsigned size)
 {
-    if(success) {
-        Led::Set();
+    if (address == SlaveAddress && function == ReadHoldingRegisters && size == 1 + sizeof(Registers) && data[0] == sizeof(Registers))
+    {
+        for (unsigned i = 0; i < 10; ++i)
+            Registers[i] = (data[1 + 2 * i] << 8) | data[2 + 2 * i];
+        Led::Toggle();
+    }
+    ResponseReceived = true;
+}
+
+extern "C" {
+
+    void USART1_IRQHandler()
+    {
+        Modbus::IrqHandler();
+    }
+
+// F072: Dma1Channel2, Dma1Channel3
+// F103: Dma1Channel4, Dma1Channel5
+// F401: Dma2Stream7Channel4, Dma2Stream2Channel4
+// G030 (configurable by DMAMUX): Dma1Channel1, Dma1Channel2
+
+#if defined (STM32F0)
+    void DMA1_Channel2_3_IRQHandler()
+    {
+        Usart::DmaTx::IrqHandler();
+        Usart::DmaRx::IrqHandler();
+    }
+#elif defined (STM32F1)
+    void DMA1_Channel4_IRQHandler()
+    {
+        Usart::DmaTx::IrqHandler();
+    }
+    void DMA1_Channel5_IRQHandler()
+    {
+        Usart::DmaRx::IrqHandler();
+    }
+#elif defined (STM32F4)
+    void DMA2_Stream7_IRQHandler()
+    {
+        Usart::DmaTx::IrqHandler();
+    }
+    void DMA2_Stream2_IRQHandler()
+    {
+        Usart::DmaRx::IrqHandler();
+    }
+#elif defined (STM32G0)
+    void DMA1_Channel1_IRQHandler()
+    {
+        Usart::DmaTx::IrqHandler();
+    }
+    void DMA1_Channel2_3_IRQHandler()
+    {
+        Usart::DmaRx::IrqHandler();
     }
+#else
+    #error "No example"
+#endif
 }
@@ -1,4 +1,6 @@
+#include <zhele/exti.h>
 #include <zhele/i2c.h>
+#include <zhele/timer.h>
 #include <zhele/drivers/ds1307.h>
 
 using namespace Zhele;
@@ -10,7 +12,8 @@ using Interface = I2c1<>;
 using Interface = I2c1;
 #endif
 
-using Rtc = Ds1307<Interface>;
+// SQW output is connected to Pb0 (Timer3 interpolates milliseconds)
+using Rtc = Ds1307<Interface, IO::Pb0, Exti0, Timers::Timer3>;
 
 int main()
 {
@@ -29,7 +32,25 @@ int main()
     // Read all data
     auto dt = Rtc::GetDateTime();
 
+    // Update cached time by SQW output
+    Rtc::EnableCache();
+
     for (;;)
     {
+        // Doesn't use I2C
+        auto now = Rtc::Now();
+        auto date = Rtc::FromEpoch(now.Epoch);
+    }
+}
+
+extern "C"
+{
+#if defined (STM32F0) || defined (STM32G0)
+    void EXTI0_1_IRQHandler()
+#else
+    void EXTI0_IRQHandler()
+#endif
+    {
+        Rtc::IrqHandler();
     }
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <zhele/iopins.h>
 #include <zhele/i2c.h>
+#include <zhele/timer.h>
+#include <zhele/timer_wheel.h>
 #include <zhele/drivers/hd44780.h>
 
 using namespace Zhele;
@@ -12,12 +14,16 @@ using Interface = I2c1<Dma1Channel1, Dma1Channel2>;
 using Interface = I2c1;
 #endif
 
+// Timer wheel with 100 us ticks, queued lcd output is sent from timer interrupt
+using Wheel = Timers::TimerWheel<Timers::Timer3>;
+using lcd = LcdAsync<LcdI2c<Interface>, Wheel, 100>;
+
 int main()
 {
     Interface::Init();
     Interface::SelectPins<Pb6, Pb7>();
 
-    using lcd = LcdI2c<Interface>;
+    Wheel::Init(F_CPU / 10000 - 1);
 
     lcd::Init();
     lcd::Clear();
@@ -26,4 +32,12 @@ int main()
     for (;;)
     {
     }
-}
\ No newline at end of file
+}
+
+extern "C"
+{
+    void TIM3_IRQHandler()
+    {
+        Wheel::IrqHandler();
+    }
+}
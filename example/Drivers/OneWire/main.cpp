@@ -2,8 +2,8 @@
 #define HSI_VALUE 16000000
 #define F_CPU 16000000
 
-#include <one_wire.h>
-#include <usart.h>
+#include <zhele/one_wire.h>
+#include <zhele/usart.h>
 
 using namespace Zhele;
 
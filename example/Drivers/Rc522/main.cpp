@@ -1,11 +1,10 @@
+#include <zhele/exti.h>
 #include <zhele/iopins.h>
 #include <zhele/spi.h>
 #include <zhele/timer.h>
 
 #include <zhele/drivers/rc522.h>
 
-#include <stdio.h>
-
 using namespace Zhele;
 using namespace Zhele::IO;
 
@@ -15,13 +14,16 @@ using Interface = Spi1<>;
 using Interface = Spi1;
 #endif
 
-using NfcReader = Drivers::Rc522<Interface, IO::Pa4>;
+// IRQ pin is connected to Pa3
+using NfcReader = Drivers::Rc522<Interface, IO::Pa4, IO::Pa3, Exti3>;
 using CheckTimer = Timers::Timer3;
 
 void ConfigureNfcReader();
 void ConfigureTimer();
+void CardChecked(NfcReader::Status status, const uint8_t* cardId);
 
-uint8_t buffer[8];
+volatile bool CheckRequired = false;
+uint8_t lastCardId[5];
 
 int main()
 {	
@@ -30,6 +32,13 @@ int main()
 
     for (;;)
     {
+        if (CheckRequired && NfcReader::CheckAsync(CardChecked))
+            CheckRequired = false;
+
+        // Returns immediately while reader is waiting for card answer
+        NfcReader::Process();
+
+        // Do other tasks
     }
 }
 
@@ -41,27 +50,42 @@ void ConfigureNfcReader()
 
     Interface::SelectPins<Pa7, Pa6, Pa5, NullPin>();
     NfcReader::Init();
+    NfcReader::EnableInterruptMode();
 }
 
 void ConfigureTimer()
 {
     CheckTimer::Enable();
     CheckTimer::SetPrescaler(3999);
-    CheckTimer::SetPeriod(1999);
+    CheckTimer::SetPeriod(199);
     CheckTimer::EnableInterrupt();
     CheckTimer::Start();
 }
 
+void CardChecked(NfcReader::Status status, const uint8_t* cardId)
+{
+    if(status == NfcReader::Status::Success && !NfcReader::Compare(cardId, lastCardId))
+    {
+        for (unsigned i = 0; i < sizeof(lastCardId); ++i)
+            lastCardId[i] = cardId[i];
+        // Do smth
+    }
+}
+
 extern "C"
 {
     void TIM3_IRQHandler()
     {
         CheckTimer::ClearInterruptFlag();
+        CheckRequired = true;
+    }
 
-        volatile auto status = NfcReader::Check(buffer);
-        if(status == NfcReader::Status::Success)
-        {
-            // Do smth
-        }
+#if defined (STM32F0) || defined (STM32G0)
+    void EXTI2_3_IRQHandler()
+#else
+    void EXTI3_IRQHandler()
+#endif
+    {
+        NfcReader::IrqHandler();
     }
 }
@@ -36,6 +36,8 @@ int main()
     Lcd::WriteString<TimesNewRoman13>(10, 10, "Abcdefghijklmnopqrstuvwxyz", Lcd::Color::White, Lcd::Color::Black);
     // Write string with monospace font
     Lcd::WriteString<Fixed10x15Bold>(10, 30, "Abcdefghijklmnopqrstuvwxyz", Lcd::Color::Yellow, Lcd::Color::Black);
+    // Write string with compressed font (built from bitmap font at compile time)
+    Lcd::WriteString<RleFont<Fixed10x15Bold>>(10, 50, "Abcdefghijklmnopqrstuvwxyz", Lcd::Color::Green, Lcd::Color::Black);
 
     for (;;)
     {
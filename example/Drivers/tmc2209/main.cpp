@@ -3,29 +3,108 @@
 #include <zhele/drivers/tmc2209.h>
 
 #if defined (STM32G0)
-    using tmc_usart = Zhele::Usart2<>;
+    #include <zhele/dma.h>
+    #include <zhele/dmamux.h>
+    using tmc_usart = Zhele::Usart2<Zhele::Dma1Channel1, Zhele::Dma1Channel2>;
 #else
     using tmc_usart = Zhele::Usart2;
 #endif
 using tmc_usart_tx_pin = Zhele::IO::Pa2;
-using tmc = Zhele::Drivers::tmc2209<tmc_usart, tmc_usart_tx_pin>;
+// Four drivers (MS1/MS2 select serial address) share single wire UART
+using tmc_x = Zhele::Drivers::tmc2209<tmc_usart, tmc_usart_tx_pin, 0>;
+using tmc_y = Zhele::Drivers::tmc2209<tmc_usart, tmc_usart_tx_pin, 1>;
+using tmc_z = Zhele::Drivers::tmc2209<tmc_usart, tmc_usart_tx_pin, 2>;
+using tmc_e = Zhele::Drivers::tmc2209<tmc_usart, tmc_usart_tx_pin, 3>;
 
-int main()
+template<typename tmc>
+void setup()
 {
-    tmc::init(9600);
-    
+    tmc::init(115200);
+
     tmc::setRunCurrent(50);
     tmc::setHoldCurrent(50);
     tmc::setMicrostepsPerStep(64);
-    
+
     tmc::enableAutomaticGradientAdaptation();
     tmc::enableAutomaticCurrentScaling();
     tmc::enableStealthChop();
     tmc::enableCoolStep();
     tmc::enable();
-    tmc::moveAtVelocity(100000);
+}
+
+int main()
+{
+#if defined (STM32G0)
+    Zhele::Dma1::Enable();
+    Zhele::DmaMux1Channel1::SelectRequestInput(Zhele::DmaMux1::RequestInput::Usart2Tx);
+    Zhele::DmaMux1Channel2::SelectRequestInput(Zhele::DmaMux1::RequestInput::Usart2Rx);
+#endif
+
+    setup<tmc_x>();
+    setup<tmc_y>();
+    setup<tmc_z>();
+    setup<tmc_e>();
+
+    // Unchanged value is not sent (shadow register cache)
+    tmc_x::moveAtVelocity(100000);
+    tmc_x::moveAtVelocity(100000);
 
     for (;;)
     {
+        // Servo tick: poll all axes without waiting replies
+        Zhele::delay_ms<10>();
+        tmc_x::bus::poll();
+        tmc_x::requestStallGuardResult();
+        tmc_y::requestStallGuardResult();
+        tmc_z::requestStallGuardResult();
+        tmc_e::requestStallGuardResult();
+
+        if (tmc_x::lastStallGuardResult() < 50)
+            tmc_x::moveAtVelocity(0);
+    }
+}
+
+extern "C" {
+
+// F072: Dma1Channel4, Dma1Channel5
+// F103: Dma1Channel7, Dma1Channel6
+// F401: Dma1Stream6Channel4, Dma1Stream5Channel4
+// G030 (configurable by DMAMUX): Dma1Channel1, Dma1Channel2
+
+#if defined (STM32F0)
+    void DMA1_Channel4_5_6_7_IRQHandler()
+    {
+        tmc_usart::DmaTx::IrqHandler();
+        tmc_usart::DmaRx::IrqHandler();
+    }
+#elif defined (STM32F1)
+    void DMA1_Channel7_IRQHandler()
+    {
+        tmc_usart::DmaTx::IrqHandler();
+    }
+    void DMA1_Channel6_IRQHandler()
+    {
+        tmc_usart::DmaRx::IrqHandler();
+    }
+#elif defined (STM32F4)
+    void DMA1_Stream6_IRQHandler()
+    {
+        tmc_usart::DmaTx::IrqHandler();
     }
-}
\ No newline at end of file
+    void DMA1_Stream5_IRQHandler()
+    {
+        tmc_usart::DmaRx::IrqHandler();
+    }
+#elif defined (STM32G0)
+    void DMA1_Channel1_IRQHandler()
+    {
+        tmc_usart::DmaTx::IrqHandler();
+    }
+    void DMA1_Channel2_3_IRQHandler()
+    {
+        tmc_usart::DmaRx::IrqHandler();
+    }
+#else
+    #error "No example"
+#endif
+}
@@ -5,11 +5,31 @@ using Encoder = Zhele::Drivers::Encoder<Zhele::Timers::Timer3>;
 
 uint16_t Value;
 
+#if defined (STM32F1) || defined (STM32F4)
+// Timer4 measures period between encoder edges (low speed velocity), Timer2 runs control loop at 1 kHz
+using Tracker = Zhele::Drivers::EncoderTracker<Encoder, Zhele::Timers::Timer4, 0, 1000>;
+using ControlTimer = Zhele::Timers::Timer2;
+
+int32_t Position;
+int32_t Velocity;
+#endif
+
 int main()
 {
     Encoder::Init();
     Encoder::EnableInterrupt();
 
+#if defined (STM32F1) || defined (STM32F4)
+    // 1 MHz time base
+    Tracker::Init(Zhele::Timers::Timer4::GetClockFreq() / 1000000 - 1);
+
+    ControlTimer::Enable();
+    ControlTimer::SetPrescaler(ControlTimer::GetClockFreq() / 1000000 - 1);
+    ControlTimer::SetPeriod(999);
+    ControlTimer::EnableInterrupt();
+    ControlTimer::Start();
+#endif
+
     for(;;)
     {
     }
@@ -22,4 +42,15 @@ extern "C"
         Value = Encoder::GetValueInterrupt();
         Zhele::Timers::Timer3::ClearInterruptFlag();
     }
-}
\ No newline at end of file
+
+#if defined (STM32F1) || defined (STM32F4)
+    void TIM2_IRQHandler()
+    {
+        ControlTimer::ClearInterruptFlag();
+
+        Tracker::Update();
+        Position = Tracker::GetPosition();
+        Velocity = Tracker::GetVelocity();
+    }
+#endif
+}
@@ -0,0 +1,53 @@
+#include <zhele/clock.h>
+#include <zhele/iopins.h>
+#include <zhele/timer.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+using namespace Zhele::Clock;
+
+void ConfigurePwmInput();
+
+using InputTimer = Timer3;
+using Input = InputTimer::PwmInput<0>;
+
+volatile uint32_t Period = 0;
+volatile uint32_t Pulse = 0;
+volatile uint16_t Duty = 0;
+
+// Period and pulse of signal on the first pin of Timer3 channel 1 are measured by hardware,
+// main loop only reads them (without interrupts).
+int main()
+{
+    ConfigurePwmInput();
+
+    for (;;)
+    {
+        if (Input::IsOverflow())
+        {
+            // There is no signal (or its period is longer than 65.5 ms)
+            Period = 0;
+            InputTimer::ClearInterruptFlag();
+        }
+
+        if (Input::IsReady())
+        {
+            Pulse = Input::GetPulse();
+            Period = Input::GetPeriod();
+            Duty = Input::CalculateDuty(Period - 1, Pulse - 1);
+        }
+    }
+}
+
+void ConfigurePwmInput()
+{
+    InputTimer::Enable();
+    InputTimer::SetPrescaler(InputTimer::GetClockFreq() / 1000000 - 1); // 1 tick = 1 us
+    InputTimer::SetPeriod(65535);
+
+    Input::SelectPins<0>();
+    Input::Enable(Input::Polarity::ActiveHigh);
+
+    InputTimer::Start();
+}
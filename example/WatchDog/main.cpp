@@ -1,12 +1,19 @@
 #include <zhele/iopins.h>
 #include <zhele/timer.h>
 #include <zhele/watchdog.h>
+#include <zhele/watchdog_supervisor.h>
 
 using namespace Zhele::Clock;
 using namespace Zhele::IO;
 using namespace Zhele::Timers;
 
 using Led = Pc13Inv;
+
+// Watchdog is refreshed only if main loop and timer interrupt both are alive
+struct MainLoop;
+struct BlinkTimer;
+using Supervisor = WatchdogSupervisor<IWdg, MainLoop, BlinkTimer>;
+
 int main()
 {
     Led::Port::Enable();
@@ -26,6 +33,8 @@ int main()
 
     for (;;)
     {
+        Supervisor::CheckIn<MainLoop>();
+        Supervisor::Service();
     }
 }
 
@@ -35,7 +44,7 @@ extern "C"
     {
         Led::Toggle();
         Timer3::ClearInterruptFlag();
-        IWdg::Reset();
+        Supervisor::CheckIn<BlinkTimer>();
     }
 }
 
@@ -0,0 +1,103 @@
+# Footprint report of one firmware (cmake -P script, called after build)
+#
+# Symbols (nm -S) are grouped by subsystem using demangled name up to first template argument list,
+# flash = code, read-only data and initialized data, RAM = initialized and zero-initialized data.
+# Report is written to REPORTS/NAME.csv, every subsystem is checked against BASELINE/NAME.csv:
+# build fails if flash or RAM grew more than TOLERANCE percent.
+#
+# Arguments: NM, ELF, NAME, REPORTS, BASELINE, TOLERANCE
+
+# Subsystem patterns (checked in order, first match wins)
+set(SUBSYSTEMS drivers usb dma usart gpio clock zhele other)
+set(PATTERN_drivers "^Zhele::Drivers::")
+set(PATTERN_usb "Usb|USB")
+set(PATTERN_dma "Dma|DMA")
+set(PATTERN_usart "Usart|USART|Uart")
+set(PATTERN_gpio "^Zhele::IO::|PinList|Port")
+set(PATTERN_clock "^Zhele::Clock::|SystemInit|SystemCoreClock")
+set(PATTERN_zhele "^Zhele::")
+set(PATTERN_other ".")
+
+foreach(subsystem ${SUBSYSTEMS})
+    set(FLASH_${subsystem} 0)
+    set(RAM_${subsystem} 0)
+endforeach()
+
+execute_process(COMMAND ${NM} -C -S --size-sort ${ELF}
+    OUTPUT_VARIABLE symbols
+    RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "footprint: cannot read symbols of ${ELF}")
+endif()
+
+# Semicolons of demangled names would break list
+string(REPLACE ";" "" symbols "${symbols}")
+string(REPLACE "\n" ";" symbols "${symbols}")
+
+foreach(line ${symbols})
+    if (NOT line MATCHES "^[0-9a-fA-F]+ ([0-9a-fA-F]+) ([A-Za-z]) (.*)$")
+        continue()
+    endif()
+    math(EXPR size "0x${CMAKE_MATCH_1}")
+    set(type ${CMAKE_MATCH_2})
+    string(REGEX REPLACE "[<(].*$" "" name "${CMAKE_MATCH_3}")
+
+    set(subsystem other)
+    foreach(candidate ${SUBSYSTEMS})
+        if (name MATCHES "${PATTERN_${candidate}}")
+            set(subsystem ${candidate})
+            break()
+        endif()
+    endforeach()
+
+    if (type MATCHES "[tTrRwWvV]")
+        math(EXPR FLASH_${subsystem} "${FLASH_${subsystem}} + ${size}")
+    elseif (type MATCHES "[dD]")
+        math(EXPR FLASH_${subsystem} "${FLASH_${subsystem}} + ${size}")
+        math(EXPR RAM_${subsystem} "${RAM_${subsystem}} + ${size}")
+    elseif (type MATCHES "[bBcC]")
+        math(EXPR RAM_${subsystem} "${RAM_${subsystem}} + ${size}")
+    endif()
+endforeach()
+
+# Baseline values: FLASH_BASE_<subsystem>, RAM_BASE_<subsystem>
+set(baseline_file ${BASELINE}/${NAME}.csv)
+if (EXISTS ${baseline_file})
+    file(STRINGS ${baseline_file} baseline_lines)
+    foreach(line ${baseline_lines})
+        if (line MATCHES "^([a-z]+),([0-9]+),([0-9]+)$")
+            set(FLASH_BASE_${CMAKE_MATCH_1} ${CMAKE_MATCH_2})
+            set(RAM_BASE_${CMAKE_MATCH_1} ${CMAKE_MATCH_3})
+        endif()
+    endforeach()
+else()
+    message(STATUS "footprint: ${NAME} has no baseline")
+endif()
+
+set(report "subsystem,flash,ram\n")
+set(summary "")
+set(regressions "")
+set(flash_total 0)
+set(ram_total 0)
+foreach(subsystem ${SUBSYSTEMS})
+    string(APPEND report "${subsystem},${FLASH_${subsystem}},${RAM_${subsystem}}\n")
+    string(APPEND summary " ${subsystem}=${FLASH_${subsystem}}/${RAM_${subsystem}}")
+    math(EXPR flash_total "${flash_total} + ${FLASH_${subsystem}}")
+    math(EXPR ram_total "${ram_total} + ${RAM_${subsystem}}")
+
+    foreach(memory FLASH RAM)
+        if (DEFINED ${memory}_BASE_${subsystem})
+            math(EXPR limit "${${memory}_BASE_${subsystem}} * (100 + ${TOLERANCE}) / 100")
+            if (${${memory}_${subsystem}} GREATER limit)
+                string(APPEND regressions "\n  ${subsystem} ${memory}: ${${memory}_BASE_${subsystem}} -> ${${memory}_${subsystem}}")
+            endif()
+        endif()
+    endforeach()
+endforeach()
+
+file(WRITE ${REPORTS}/${NAME}.csv "${report}")
+message(STATUS "footprint: ${NAME} flash=${flash_total} ram=${ram_total} (flash/ram:${summary})")
+
+if (regressions)
+    message(FATAL_ERROR "footprint: ${NAME} exceeds baseline by more than ${TOLERANCE}%:${regressions}")
+endif()
@@ -0,0 +1,199 @@
+/**
+ * @file
+ * Implements multi ADC (dual) mode
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ADC_MULTI_H
+#define ZHELE_ADC_MULTI_H
+
+#include <zhele/adc.h>
+
+#include "common/template_utils/type_list.h"
+
+#include <initializer_list>
+#include <stdint.h>
+
+#if defined (ADC_CR1_DUALMOD)
+namespace Zhele
+{
+    /**
+     * @brief Multi ADC regular conversion callback
+     * 
+     * @param [in] data Packed data (see AdcMulti::MasterData and AdcMulti::SlaveData)
+     * @param [in] count Words count
+     */
+    using AdcMultiCallbackType = std::add_pointer_t<void(uint32_t* data, uint32_t count)>;
+
+    /**
+     * @brief Multi ADC regular stream block callback
+     * 
+     * @param [in] data Filled block (packed data)
+     * @param [in] count Words count in block
+     * @param [in] overruns Total count of overruns (consumer has not processed block in time)
+     */
+    using AdcMultiStreamCallbackType = std::add_pointer_t<void(uint32_t* data, uint32_t count, uint32_t overruns)>;
+
+    /**
+     * @brief Implements simultaneous and interleaved sampling by several ADC
+     * 
+     * @details
+     * Master ADC triggers slave ADC, both results are packed into one 32-bit word
+     * (master in low half-word, slave in high half-word) and transferred by master DMA channel.
+     * STM32F1 supports dual mode only: ADC1 is master, ADC2 is slave.
+     * 
+     * @par Example
+     * @code
+     *  using Adc = AdcMulti<Adc1, Adc2>;
+     *  Adc::Init();
+     *  Adc::StartRegular(Adc::Mode::RegularSimultaneous, {0, 1, 2}, {3, 4, 5}, buffer, 16);
+     * @endcode
+     * 
+     * @tparam _Master Master ADC
+     * @tparam _Slaves Slave ADC
+     */
+    template<typename _Master, typename... _Slaves>
+    class AdcMulti
+    {
+        static_assert(sizeof...(_Slaves) == 1, "Only dual mode (one slave ADC) is supported");
+
+        using Slave = TemplateUtils::TypeUnbox<TemplateUtils::TypeList<_Slaves...>::head()>;
+        using MasterRegs = typename _Master::Regs;
+        using SlaveRegs = typename Slave::Regs;
+        using AdcError = Private::AdcCommon::AdcError;
+
+        struct MultiData
+        {
+            AdcMultiCallbackType regularCallback = nullptr;
+            AdcMultiStreamCallbackType streamCallback = nullptr;
+            uint32_t streamOverruns = 0;
+            AdcError error = AdcError::NoError;
+        };
+    public:
+        /// Packed data type
+        using DataT = uint32_t;
+
+        /// Multi ADC mode
+        enum class Mode : uint8_t
+        {
+            RegularSimultaneous = 0b0110, //< Regular channels are converted simultaneously
+            FastInterleaved = 0b0111, //< One channel is converted by ADC alternately, 7 ADC cycles interval
+            SlowInterleaved = 0b1000, //< One channel is converted by ADC alternately, 14 ADC cycles interval
+        };
+
+        /**
+         * @brief Returns master ADC data from packed word
+         * 
+         * @param [in] data Packed word
+         * 
+         * @returns Master ADC data
+         */
+        static constexpr uint16_t MasterData(DataT data) { return static_cast<uint16_t>(data); }
+
+        /**
+         * @brief Returns slave ADC data from packed word
+         * 
+         * @param [in] data Packed word
+         * 
+         * @returns Slave ADC data
+         */
+        static constexpr uint16_t SlaveData(DataT data) { return static_cast<uint16_t>(data >> 16); }
+
+        /**
+         * @brief Init all ADC
+         * 
+         * @tparam divider Clock divider
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Master::AdcDivider divider = _Master::AdcDivider::Div2>
+        static void Init();
+
+        /**
+         * @brief Start regular conversion
+         * 
+         * @details
+         * Regular simultaneous mode requires sequences of the same length,
+         * interleaved modes require one (usually the same) channel for every ADC.
+         * 
+         * @param [in] mode Mode
+         * @param [in] masterChannels Master ADC channels
+         * @param [in] slaveChannels Slave ADC channels
+         * @param [out] dataBuffer Buffer for packed data (masterChannels.size() * scanCount words)
+         * @param [in] scanCount Scans count
+         * @param [in] callback Conversion complete callback
+         * 
+         * @retval true Conversion started
+         * @retval false Invalid arguments
+         */
+        static bool StartRegular(Mode mode, std::initializer_list<uint8_t> masterChannels, std::initializer_list<uint8_t> slaveChannels,
+                                DataT* dataBuffer, uint16_t scanCount, AdcMultiCallbackType callback = nullptr);
+
+        /**
+         * @brief Start continuous regular conversion into double buffer
+         * 
+         * @details
+         * If master ADC has hardware regular trigger, each trigger starts one conversion (scan),
+         * otherwise ADC convert continuously.
+         * 
+         * @param [in] mode Mode
+         * @param [in] masterChannels Master ADC channels
+         * @param [in] slaveChannels Slave ADC channels
+         * @param [out] buffer Buffer. Must has 2 * blockSize words (two blocks).
+         * @param [in] blockSize Block size in words (multiple of master channels count)
+         * @param [in] callback Block callback
+         * 
+         * @retval true Stream started
+         * @retval false Invalid arguments
+         */
+        static bool StartRegularStream(Mode mode, std::initializer_list<uint8_t> masterChannels, std::initializer_list<uint8_t> slaveChannels,
+                                DataT* buffer, uint16_t blockSize, AdcMultiStreamCallbackType callback);
+
+        /**
+         * @brief Check regular conversion is complete
+         * 
+         * @retval true Conversion complete
+         * @retval false Conversion in progress
+         */
+        static bool RegularReady();
+
+        /**
+         * @brief Stop regular conversion and return ADC to independent mode
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void StopRegular();
+
+        /**
+         * @brief Returns regular stream overruns count
+         * 
+         * @returns Overruns count
+         */
+        static uint32_t StreamOverruns();
+
+        /**
+         * @brief Returns last error
+         * 
+         * @returns Error
+         */
+        static AdcError GetError();
+
+    private:
+        static bool Configure(Mode mode, std::initializer_list<uint8_t> masterChannels, std::initializer_list<uint8_t> slaveChannels);
+        static void StartConversion(bool continuous);
+        static void DmaHandler(void* data, unsigned size, bool success);
+        static void StreamHandler(void* data, unsigned size, unsigned bufferIndex);
+
+        static MultiData _data;
+    };
+}
+
+#include "impl/adc_multi.h"
+#endif
+
+#endif //! ZHELE_ADC_MULTI_H
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * Implements timer-paced ADC sampling
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ADC_SAMPLER_H
+#define ZHELE_ADC_SAMPLER_H
+
+#include <zhele/adc.h>
+#include <zhele/timer.h>
+
+#include <stdint.h>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements ADC sampling at exact rate paced by timer TRGO
+     * 
+     * @details
+     * Timer prescaler and period, ADC clock divider and sample time are calculated
+     * at compile time. Compilation fails if sample rate is not exactly reachable,
+     * timer TRGO can not trigger ADC or conversion does not fit sample period.
+     * Samples are streamed by circular DMA (see AdcBase::StartRegularStream).
+     * 
+     * @par Example
+     * @code
+     *  using Sampler = AdcSampler<Adc1, Timers::Timer3, 10000, 72000000, 72000000>;
+     *  Sampler::Init();
+     *  Sampler::Start<IO::Pa0>(buffer, 256, [](uint16_t* data, uint32_t count, uint32_t overruns) { ... });
+     * @endcode
+     * 
+     * @tparam _Adc ADC
+     * @tparam _Timer Timer (its TRGO must be ADC regular trigger)
+     * @tparam _SampleRate Sample rate (scans per second)
+     * @tparam _TimerClockFreq Timer clock frequency
+     * @tparam _AdcSourceClockFreq ADC clock frequency before ADC divider
+     */
+    template<typename _Adc, typename _Timer, unsigned long _SampleRate, unsigned long _TimerClockFreq, unsigned long _AdcSourceClockFreq>
+    class AdcSampler
+    {
+        using Trigger = Private::AdcTimerTrigger<_Adc, _Timer>;
+        static_assert(Trigger::Supported, "Timer TRGO can not trigger ADC regular conversion");
+        static_assert(_SampleRate > 0, "Sample rate must be positive");
+
+        static consteval uint32_t CalculatePrescaler();
+        static consteval typename _Adc::AdcDivider SelectDivider();
+        static consteval unsigned DividerValue(typename _Adc::AdcDivider divider);
+    public:
+        /// Timer prescaler (divider)
+        static constexpr uint32_t TimerPrescaler = CalculatePrescaler();
+        static_assert(TimerPrescaler != 0, "Sample rate is not exactly reachable with given timer clock");
+
+        /// Timer period (in prescaled ticks)
+        static constexpr uint32_t TimerPeriod = _TimerClockFreq / TimerPrescaler / _SampleRate;
+
+        /// ADC clock divider
+        static constexpr typename _Adc::AdcDivider Divider = SelectDivider();
+
+        /// ADC clock frequency
+        static constexpr unsigned long AdcClockFreq = _AdcSourceClockFreq / DividerValue(Divider);
+
+        /// ADC cycles per sample period
+        static constexpr unsigned long CyclesPerSample = AdcClockFreq / _SampleRate;
+
+        /**
+         * @brief Returns the longest sample time (ADC cycles) that fits sample period
+         * 
+         * @tparam _ChannelsCount Count of channels in scan
+         * 
+         * @returns Sample time (0 if conversion does not fit sample period)
+         */
+        template<unsigned _ChannelsCount>
+        static consteval unsigned SampleTime();
+
+        /**
+         * @brief Init ADC (with calculated divider) and timer
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Start sampling
+         * 
+         * @tparam _Pins ADC input pins
+         * 
+         * @param [out] buffer Buffer. Must has 2 * blockSize elements (two blocks).
+         * @param [in] blockSize Block size in samples (multiple of pins count)
+         * @param [in] callback Block callback
+         * 
+         * @retval true Sampling started
+         * @retval false Sampling start fail
+         */
+        template<typename... _Pins>
+        static bool Start(uint16_t* buffer, uint16_t blockSize, AdcStreamCallbackType callback);
+
+        /**
+         * @brief Stop sampling
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+    };
+}
+
+#include "impl/adc_sampler.h"
+
+#endif //! ZHELE_ADC_SAMPLER_H
@@ -0,0 +1,397 @@
+/**
+ * @file
+ * Implements C++20 coroutines support: tasks, scheduler and awaitable peripheral operations
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ASYNC_H
+#define ZHELE_ASYNC_H
+
+#include <zhele/i2c.h>
+#include <zhele/system_time.h>
+
+#include "common/template_utils/data_transfer.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <stdint.h>
+
+#if !defined (ZHELE_ASYNC_MAX_TASKS)
+    /// Maximal count of simultaneously existing coroutine frames
+    #define ZHELE_ASYNC_MAX_TASKS 8
+#endif
+
+#if !defined (ZHELE_ASYNC_FRAME_SIZE)
+    /// Coroutine frame size (bytes)
+    #define ZHELE_ASYNC_FRAME_SIZE 256
+#endif
+
+namespace Zhele::Async
+{
+    /**
+     * @brief Coroutine task
+     * 
+     * @details
+     * Task is lazy: it starts when it's awaited or spawned by Scheduler.
+     * Frames are allocated from static pool (ZHELE_ASYNC_MAX_TASKS frames by ZHELE_ASYNC_FRAME_SIZE bytes),
+     * if pool is exhausted task is invalid (Scheduler::Spawn returns false).
+     * 
+     * @par Example
+     * @code
+     *  Async::Task Report()
+     *  {
+     *      co_await Async::Write<Usart1>("Hello\r\n", 7);
+     *      auto status = co_await Async::Read<I2c1>(0x68, 0x3b, data, 6);
+     *  }
+     *  Async::Scheduler::Spawn(Report());
+     *  Async::Scheduler::Run();
+     * @endcode
+     */
+    class Task
+    {
+    public:
+        class promise_type
+        {
+            friend class Task;
+            friend class Scheduler;
+        public:
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+                void await_resume() const noexcept {}
+            };
+
+            Task get_return_object() noexcept;
+            static Task get_return_object_on_allocation_failure() noexcept;
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            FinalAwaiter final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept;
+
+            static void* operator new(size_t size) noexcept;
+            static void operator delete(void* frame) noexcept;
+
+        private:
+            std::coroutine_handle<> _continuation;
+            bool _detached = false;
+        };
+
+        Task(Task&& other) noexcept;
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task();
+
+        /**
+         * @brief Check that task frame is allocated
+         * 
+         * @retval true Task is valid
+         * @retval false Frames pool is exhausted
+         */
+        bool IsValid() const;
+
+        bool await_ready() const noexcept;
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept;
+        void await_resume() const noexcept {}
+
+    private:
+        friend class Scheduler;
+        explicit Task(std::coroutine_handle<promise_type> handle);
+
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    /**
+     * @brief Cooperative coroutines scheduler
+     * 
+     * @details
+     * Coroutines are resumed only from Poll/Run (main loop), never from interrupts:
+     * completion callbacks just put coroutine to ready queue.
+     */
+    class Scheduler
+    {
+    public:
+        /**
+         * @brief Spawn detached task (task frame is freed on completion)
+         * 
+         * @param [in] task Task
+         * 
+         * @retval true Task is scheduled
+         * @retval false Task is invalid (frames pool is exhausted)
+         */
+        static bool Spawn(Task&& task);
+
+        /**
+         * @brief Put coroutine to ready queue (can be called from interrupt)
+         * 
+         * @param [in] handle Coroutine handle
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Ready(std::coroutine_handle<> handle);
+
+        /**
+         * @brief Put coroutine to sleep (it's put to ready queue by Poll after given time)
+         * 
+         * @param [in] handle Coroutine handle
+         * @param [in] milliseconds Sleep time (ms)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Sleep(std::coroutine_handle<> handle, uint32_t milliseconds);
+
+        /**
+         * @brief Resume all ready coroutines
+         * 
+         * @retval true Some coroutine was resumed
+         * @retval false Nothing to resume
+         */
+        static bool Poll();
+
+        /**
+         * @brief Run scheduler forever (sleeps by WFI while there is nothing to resume)
+         * 
+         * @details
+         * Sleeping coroutines are woken by SysTick (@ref SystemTime should be started).
+         */
+        [[noreturn]] static void Run();
+
+    private:
+        static std::coroutine_handle<> Pop();
+        static void Wake();
+
+        struct Sleeper
+        {
+            std::coroutine_handle<> Handle = nullptr;
+            Deadline Wake{0};
+        };
+
+        // Every frame can be ready only once at a time
+        static const unsigned QueueSize = ZHELE_ASYNC_MAX_TASKS;
+
+        static std::coroutine_handle<> _queue[QueueSize];
+        static unsigned _head;
+        static unsigned _count;
+        static Sleeper _sleepers[QueueSize];
+        static unsigned _sleeping;
+    };
+
+    namespace Private
+    {
+        /**
+         * @brief Completion of asynchronous operation of peripheral
+         * 
+         * @details
+         * Peripheral callbacks are plain function pointers, so awaiting coroutine
+         * is stored in static memory (one operation per tag at a time).
+         * 
+         * @tparam _Tag Peripheral (or peripheral direction, see @ref ReadTag and @ref WriteTag)
+         * @tparam _Result Operation result
+         */
+        template<typename _Tag, typename _Result>
+        class Completion
+        {
+        public:
+            static void Begin(std::coroutine_handle<> handle);
+            static bool Cancel(_Result result);
+            static _Result Result();
+
+            static void OnTransfer(void* data, unsigned size, bool success);
+            static void OnStatus(_Result status);
+
+        private:
+            static void Complete(_Result result);
+
+            static std::coroutine_handle<> _handle;
+            static _Result _result;
+            static volatile bool _pending;
+        };
+
+        /**
+         * @brief Read direction of peripheral (reads and writes of full-duplex peripheral complete independently)
+         * 
+         * @tparam _Peripheral Peripheral
+         */
+        template<typename _Peripheral>
+        struct ReadTag {};
+
+        /**
+         * @brief Write direction of peripheral
+         * 
+         * @tparam _Peripheral Peripheral
+         */
+        template<typename _Peripheral>
+        struct WriteTag {};
+
+        /**
+         * @brief Awaitable peripheral operation
+         * 
+         * @tparam _Tag Completion tag (peripheral or its direction)
+         * @tparam _Result Operation result
+         * @tparam _Start Operation start functor (returns false if coroutine should not be suspended)
+         */
+        template<typename _Tag, typename _Result, typename _Start>
+        class Operation
+        {
+            using Completion = Private::Completion<_Tag, _Result>;
+        public:
+            Operation(_Start start)
+                : _start(start)
+            {}
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> handle);
+            _Result await_resume() const { return Completion::Result(); }
+
+        private:
+            _Start _start;
+        };
+    }
+
+    /**
+     * @brief Awaitable: reschedule current coroutine (let other coroutines run)
+     */
+    struct Yield
+    {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const { Scheduler::Ready(handle); }
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief Awaitable: suspend current coroutine for given time (other coroutines run, core sleeps if there is nothing to run)
+     * 
+     * @details
+     * Time is measured by @ref SystemTime, without it coroutine is just rescheduled (as by @ref Yield).
+     * 
+     * @par Example
+     * @code
+     *  Async::Task Blink()
+     *  {
+     *      while (true)
+     *      {
+     *          Led::Toggle();
+     *          co_await Async::Delay(500);
+     *      }
+     *  }
+     * @endcode
+     */
+    class Delay
+    {
+    public:
+        explicit Delay(uint32_t milliseconds)
+            : _milliseconds(milliseconds)
+        {}
+
+        bool await_ready() const noexcept { return _milliseconds == 0; }
+        void await_suspend(std::coroutine_handle<> handle) const { Scheduler::Sleep(handle, _milliseconds); }
+        void await_resume() const noexcept {}
+
+    private:
+        uint32_t _milliseconds;
+    };
+
+    /**
+     * @brief Awaitable DMA transfer
+     * 
+     * @tparam _DmaChannel DMA channel
+     * 
+     * @param [in] mode Channel mode
+     * @param [in] buffer Memory buffer
+     * @param [in] periph Peripheral address
+     * @param [in] size Transfer size
+     * 
+     * @returns Awaitable with transfer result (true if success)
+     */
+    template<typename _DmaChannel>
+    auto Transfer(typename _DmaChannel::Mode mode, const void* buffer, volatile void* periph, uint32_t size);
+
+    /**
+     * @brief Awaitable write (Usart, Spi)
+     * 
+     * @details
+     * Write can run simultaneously with @ref Read of the same peripheral,
+     * but only one write per peripheral can be awaited at a time.
+     * 
+     * @tparam _Peripheral Peripheral with WriteAsync(data, size, callback)
+     * 
+     * @param [in] data Data
+     * @param [in] size Data size
+     * 
+     * @returns Awaitable with transfer result (true if success)
+     */
+    template<typename _Peripheral>
+    auto Write(const void* data, size_t size);
+
+    /**
+     * @brief Awaitable read (Usart, Spi)
+     * 
+     * @details
+     * Read can run simultaneously with @ref Write of the same peripheral,
+     * but only one read per peripheral can be awaited at a time.
+     * 
+     * @tparam _Peripheral Peripheral with ReadAsync or EnableAsyncRead(buffer, size, callback)
+     * 
+     * @param [out] buffer Receive buffer
+     * @param [in] size Data size
+     * 
+     * @returns Awaitable with transfer result (true if success)
+     */
+    template<typename _Peripheral>
+    auto Read(void* buffer, size_t size);
+
+    /**
+     * @brief Awaitable full-duplex SPI transfer
+     * 
+     * @tparam _Spi SPI
+     * 
+     * @param [in] transmitBuffer Transmit data
+     * @param [out] receiveBuffer Receive buffer
+     * @param [in] size Data size
+     * 
+     * @returns Awaitable with transfer result (true if success)
+     */
+    template<typename _Spi>
+    auto Send(void* transmitBuffer, void* receiveBuffer, size_t size);
+
+    /**
+     * @brief Awaitable I2C write
+     * 
+     * @tparam _I2c I2C
+     * 
+     * @param [in] devAddr Device address
+     * @param [in] regAddr Register address
+     * @param [in] data Data
+     * @param [in] size Data size
+     * @param [in] opts I2C options
+     * 
+     * @returns Awaitable with I2cStatus
+     */
+    template<typename _I2c>
+    auto Write(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cOpts opts = I2cOpts::None);
+
+    /**
+     * @brief Awaitable I2C read
+     * 
+     * @tparam _I2c I2C
+     * 
+     * @param [in] devAddr Device address
+     * @param [in] regAddr Register address
+     * @param [out] data Receive buffer
+     * @param [in] size Data size
+     * @param [in] opts I2C options
+     * 
+     * @returns Awaitable with I2cStatus
+     */
+    template<typename _I2c>
+    auto Read(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts = I2cOpts::None);
+}
+
+#include "impl/async.h"
+
+#endif //! ZHELE_ASYNC_H
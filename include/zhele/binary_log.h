@@ -0,0 +1,141 @@
+/**
+ * @file
+ * Implements deferred binary logging (format strings are decoded on host)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_BINARY_LOG_H
+#define ZHELE_BINARY_LOG_H
+
+#include <zhele/irq.h>
+
+#include "common/template_utils/data_transfer.h"
+#include "common/template_utils/fixed_string.h"
+#include "containers/ring_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Appends binary log record
+ *
+ * @par Example
+ * @code
+ *  using Log = Zhele::BinaryLog<1024>;
+ *  #define LOG(...) ZHELE_LOG(Log, __VA_ARGS__)
+ *  ...
+ *  LOG("adc=%u t=%d", sample, temperature);
+ * @endcode
+ *
+ * @param log BinaryLog type
+ * @param format Format string literal (printf-like, see @ref Zhele::BinaryLog)
+ */
+#define ZHELE_LOG(log, format, ...) log::template Write<format>(__VA_OPT__(__VA_ARGS__))
+
+namespace Zhele
+{
+    /**
+     * @brief Implements deferred binary log
+     *
+     * @details
+     * Record is 32-bit format string id and raw arguments, text is never formatted on target.
+     * Id is address of format string, it's one literal load (as any 32-bit constant). Format strings are
+     * moved to not loaded .zhele_log section by cmake/zhele-log.ld linker script (so they take no flash),
+     * host decoder (tools/zhele_log_decode.py) reads them from ELF symbols and prints records.
+     *
+     * Format string is printf-like: d, i, u, x, X, o, c (4 bytes on wire), ll modifier (8 bytes),
+     * f, e, g (float, 4 bytes), lf, le, lg (double, 8 bytes), h, hh, l and z modifiers are allowed
+     * and ignored, %s is not supported. Argument types are checked against format at compile time.
+     *
+     * Write is copy of few words into byte ring in critical section, so it can be used in interrupt handlers.
+     * If ring has no room record is dropped and counted. Ring is drained by @ref Drain (blocking sinks,
+     * CdcSerial, BufferedUsart, ItmPort) or @ref DrainAsync (USART DMA, next part is sent from DMA interrupt).
+     *
+     * @par Example
+     * @code
+     *  using Log = BinaryLog<1024>;
+     *  ZHELE_LOG(Log, "adc=%u t=%d", sample, temperature);
+     *  ...
+     *  Log::DrainAsync<Usart1>(); // In main loop or timer
+     * @endcode
+     *
+     * @tparam _Size Ring size (in bytes)
+     * @tparam _Level Highest preemption priority of interrupts that write log (see @ref Irq::CriticalSection)
+     */
+    template<unsigned _Size, uint8_t _Level = 0>
+    class BinaryLog
+    {
+    public:
+        /**
+         * @brief Appends record
+         *
+         * @tparam _Format Format string
+         * @tparam Args Arguments types (integers, enums, float, double)
+         *
+         * @param [in] args Arguments
+         *
+         * @retval true Record is stored
+         * @retval false Ring is full, record is dropped
+         */
+        template<TemplateUtils::fixed_string _Format, typename... Args>
+        static bool Write(Args... args);
+
+        /**
+         * @brief Writes stored records to sink
+         *
+         * @details
+         * If sink Write returns written count (CdcSerial, BufferedUsart), the rest of data is kept in ring.
+         *
+         * @tparam _Output Sink with static Write(const void* data, size_t size)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Output>
+        static void Drain();
+
+        /**
+         * @brief Starts async (DMA) write of stored records
+         *
+         * @details
+         * Next stored part (including records written during transfer) is sent from
+         * transfer complete callback until ring is empty.
+         *
+         * @tparam _Usart USART
+         *
+         * @retval true Transfer started
+         * @retval false Transfer is in progress or ring is empty
+         */
+        template<typename _Usart>
+        static bool DrainAsync();
+
+        /**
+         * @brief Returns stored bytes count
+         *
+         * @returns Bytes count
+         */
+        static unsigned Size();
+
+        /**
+         * @brief Returns dropped records count
+         *
+         * @returns Records count
+         */
+        static uint32_t Dropped();
+
+    private:
+        template<typename _Usart>
+        static void DrainComplete(void* data, unsigned size, bool success);
+
+        static Containers::RingBuffer<_Size, uint8_t> _buffer;
+        static volatile uint32_t _dropped;
+        static volatile unsigned _sending;
+    };
+}
+
+#include "impl/binary_log.h"
+
+#endif //! ZHELE_BINARY_LOG_H
@@ -10,7 +10,11 @@
 #ifndef ZHELE_BINARY_STREAM_H
 #define ZHELE_BINARY_STREAM_H
 
+#include "common/template_utils/data_transfer.h"
+
+#include <cstddef>
 #include <cstdint>
+#include <span>
 
 namespace Zhele
 {
@@ -22,9 +26,60 @@ namespace Zhele
         MixedEndian = 2 ///< Mixed endian
     };
 
+    namespace Private
+    {
+        /// Source with full-duplex bulk transfer (SPI, uses DMA for long blocks)
+        template<typename T>
+        concept BulkTransferSource = requires(const void* tx, void* rx, size_t size) { T::Transfer(tx, rx, size); };
+
+        /// Source with bulk read
+        template<typename T>
+        concept BulkReadSource = requires(void* data, size_t size) { T::Read(data, size); };
+
+        /// Source with bulk write (USART, ITM)
+        template<typename T>
+        concept BulkWriteSource = requires(const void* data, size_t size) { T::Write(data, size); };
+
+        /**
+         * @brief Reverses bytes order of 32-bit value
+         * 
+         * @param [in] value Value
+         * 
+         * @returns Value with reversed bytes
+         */
+        inline uint32_t ByteSwap32(uint32_t value)
+        {
+        #if defined (__CORTEX_M)
+            return __REV(value);
+        #else
+            return __builtin_bswap32(value);
+        #endif
+        }
+
+        /**
+         * @brief Reverses bytes order of 16-bit value
+         * 
+         * @param [in] value Value
+         * 
+         * @returns Value with reversed bytes
+         */
+        inline uint16_t ByteSwap16(uint16_t value)
+        {
+        #if defined (__CORTEX_M)
+            return static_cast<uint16_t>(__REV16(value));
+        #else
+            return __builtin_bswap16(value);
+        #endif
+        }
+    }
+
     /**
      * @brief Implements binary stream
      * 
+     * @details
+     * Span methods transfer whole block by one source call if source has bulk transfer
+     * (for example, SPI Transfer with DMA for long blocks), otherwise they read (write) data byte by byte.
+     * 
      * @tparam _Source Data source
      */
     template<typename _Source>
@@ -222,6 +277,112 @@ namespace Zhele
             }
         }
 
+        /**
+         * @brief Reads data block
+         * 
+         * @param [out] data Receive buffer
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        inline void ReadSpan(std::span<uint8_t> data);
+
+        /**
+         * @brief Writes data block
+         * 
+         * @param [in] data Data to write
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        inline void WriteSpan(std::span<const uint8_t> data);
+
+        /**
+         * @brief Reads array of 4-bytes big-endian values
+         * 
+         * @param [out] values Receive buffer
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        inline void ReadU32BeSpan(std::span<uint32_t> values);
+
+        /**
+         * @brief Reads array of 4-bytes little-endian values
+         * 
+         * @param [out] values Receive buffer
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        inline void ReadU32LeSpan(std::span<uint32_t> values) { ReadSpan(AsBytes(values)); }
+
+        /**
+         * @brief Reads array of 2-bytes big-endian values
+         * 
+         * @param [out] values Receive buffer
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        inline void ReadU16BeSpan(std::span<uint16_t> values);
+
+        /**
+         * @brief Reads array of 2-bytes little-endian values
+         * 
+         * @param [out] values Receive buffer
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        inline void ReadU16LeSpan(std::span<uint16_t> values) { ReadSpan(AsBytes(values)); }
+
+        /**
+         * @brief Writes array of 4-bytes values in big-endian order
+         * 
+         * @details
+         * Values are converted by chunks in stack buffer, so source data is not modified.
+         * 
+         * @param [in] values Values to write
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        inline void WriteU32BeSpan(std::span<const uint32_t> values);
+
+        /**
+         * @brief Writes array of 4-bytes values in little-endian order
+         * 
+         * @param [in] values Values to write
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        inline void WriteU32LeSpan(std::span<const uint32_t> values) { WriteSpan(AsBytes(values)); }
+
+        /**
+         * @brief Writes array of 2-bytes values in big-endian order
+         * 
+         * @details
+         * Values are converted by chunks in stack buffer, so source data is not modified.
+         * 
+         * @param [in] values Values to write
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        inline void WriteU16BeSpan(std::span<const uint16_t> values);
+
+        /**
+         * @brief Writes array of 2-bytes values in little-endian order
+         * 
+         * @param [in] values Values to write
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        inline void WriteU16LeSpan(std::span<const uint16_t> values) { WriteSpan(AsBytes(values)); }
+
         /**
          * @brief Writes data async
          * 
@@ -234,6 +395,22 @@ namespace Zhele
         {
             _Source::WriteAsync(buffer, size);
         }
+
+    private:
+        /// Chunk size (in bytes) for big-endian writes
+        static const size_t SwapChunkSize = 32;
+
+        template<typename T>
+        static std::span<uint8_t> AsBytes(std::span<T> values)
+        {
+            return {reinterpret_cast<uint8_t*>(values.data()), values.size_bytes()};
+        }
+
+        template<typename T>
+        static std::span<const uint8_t> AsBytes(std::span<const T> values)
+        {
+            return {reinterpret_cast<const uint8_t*>(values.data()), values.size_bytes()};
+        }
     };
 }
 
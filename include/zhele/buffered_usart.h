@@ -0,0 +1,215 @@
+/**
+ * @file
+ * Implements interrupt-driven buffered USART
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_BUFFERED_USART_H
+#define ZHELE_BUFFERED_USART_H
+
+#include <zhele/containers/ring_buffer.h>
+#include <zhele/usart.h>
+
+#include <stddef.h>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements interrupt-driven buffered USART
+     * 
+     * @details
+     * Write puts data into TX ring buffer and returns immediately, data is transmitted
+     * by TXE interrupt. Received bytes are saved into RX ring buffer by RXNE interrupt.
+     * Call IrqHandler from USART IRQ handler.
+     * Also adapter tracks buffers high-water marks (max fill level).
+     * 
+     * @tparam _Usart USART
+     * @tparam _TxSize TX buffer size (should be power of 2)
+     * @tparam _RxSize RX buffer size (should be power of 2)
+     */
+    template<typename _Usart, unsigned _TxSize = 64, unsigned _RxSize = 64>
+    class BufferedUsart : public _Usart
+    {
+        static_assert((_TxSize & (_TxSize - 1)) == 0 && (_RxSize & (_RxSize - 1)) == 0, "Buffer size should be power of 2");
+
+        using Base = _Usart;
+        using TxBuffer = Containers::RingBuffer<_TxSize, uint8_t>;
+        using RxBuffer = Containers::RingBuffer<_RxSize, uint8_t>;
+    public:
+        using UsartMode = typename Base::UsartMode;
+        using InterruptFlags = typename Base::InterruptFlags;
+    #if defined (USART_CR1_FIFOEN)
+        using FifoThreshold = typename Base::FifoThreshold;
+    #endif
+
+        /**
+         * @brief Initialize USART and enable RX interrupt
+         * 
+         * @tparam baud Baud rate
+         * @param [in] mode Mode
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        template<unsigned long baud>
+        static void Init(UsartMode mode = DefaultUsartMode);
+
+        /**
+         * @brief Initialize USART and enable RX interrupt
+         * 
+         * @param [in] baud Baud rate
+         * @param [in] mode Mode
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Init(unsigned baud, UsartMode mode = DefaultUsartMode);
+
+        /**
+         * @brief Put byte into TX buffer
+         * 
+         * @param [in] data Byte to write
+         * 
+         * @retval true Byte was buffered
+         * @retval false TX buffer is full
+         */
+        static bool Write(uint8_t data);
+
+        /**
+         * @brief Put data into TX buffer
+         * 
+         * @param [in] data Data to write
+         * @param [in] size Data size
+         * 
+         * @returns Count of buffered bytes (less than size if TX buffer is full)
+         */
+        static size_t Write(const void* data, size_t size);
+
+        /**
+         * @brief Get byte from RX buffer
+         * 
+         * @param [out] data Received byte
+         * 
+         * @retval true Byte was read
+         * @retval false RX buffer is empty
+         */
+        static bool Read(uint8_t& data);
+
+        /**
+         * @brief Get data from RX buffer
+         * 
+         * @param [out] data Output buffer
+         * @param [in] size Output buffer size
+         * 
+         * @returns Count of read bytes
+         */
+        static size_t Read(void* data, size_t size);
+
+        /**
+         * @brief Returns count of received bytes in RX buffer
+         * 
+         * @returns Bytes count
+         */
+        static unsigned RxAvailable();
+
+        /**
+         * @brief Returns free space in TX buffer
+         * 
+         * @returns Bytes count
+         */
+        static unsigned TxFree();
+
+        /**
+         * @brief Wait until all buffered data has been transmitted
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Flush();
+
+        /**
+         * @brief Returns max fill level of TX buffer
+         * 
+         * @returns TX buffer high-water mark
+         */
+        static unsigned TxHighWater();
+
+        /**
+         * @brief Returns max fill level of RX buffer
+         * 
+         * @returns RX buffer high-water mark
+         */
+        static unsigned RxHighWater();
+
+        /**
+         * @brief Returns count of bytes dropped because RX buffer was full
+         * 
+         * @returns Dropped bytes count
+         */
+        static unsigned RxOverflows();
+
+        /**
+         * @brief Reset high-water marks and overflows counter
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void ResetStatistics();
+
+    #if defined (USART_CR1_FIFOEN)
+        /**
+         * @brief Enables hardware FIFO and switches to threshold interrupts
+         * 
+         * @details
+         * Interrupt handler reads (writes) all FIFO content at once, so interrupt rate
+         * is reduced by FIFO threshold. Bytes below RX threshold are read on line idle.
+         * 
+         * @param [in] rxThreshold RX FIFO threshold
+         * @param [in] txThreshold TX FIFO threshold
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void EnableFifo(FifoThreshold rxThreshold, FifoThreshold txThreshold);
+    #endif
+
+        /**
+         * @brief USART interrupt handler. Should be called from USART IRQ handler.
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static TxBuffer _txBuffer;
+        static RxBuffer _rxBuffer;
+        static unsigned _txHighWater;
+        static unsigned _rxHighWater;
+        static unsigned _rxOverflows;
+        static InterruptFlags _rxInterrupt;
+        static InterruptFlags _txInterrupt;
+    };
+
+    template<typename _Usart, unsigned _TxSize, unsigned _RxSize>
+    typename BufferedUsart<_Usart, _TxSize, _RxSize>::TxBuffer BufferedUsart<_Usart, _TxSize, _RxSize>::_txBuffer;
+    template<typename _Usart, unsigned _TxSize, unsigned _RxSize>
+    typename BufferedUsart<_Usart, _TxSize, _RxSize>::RxBuffer BufferedUsart<_Usart, _TxSize, _RxSize>::_rxBuffer;
+    template<typename _Usart, unsigned _TxSize, unsigned _RxSize>
+    unsigned BufferedUsart<_Usart, _TxSize, _RxSize>::_txHighWater = 0;
+    template<typename _Usart, unsigned _TxSize, unsigned _RxSize>
+    unsigned BufferedUsart<_Usart, _TxSize, _RxSize>::_rxHighWater = 0;
+    template<typename _Usart, unsigned _TxSize, unsigned _RxSize>
+    unsigned BufferedUsart<_Usart, _TxSize, _RxSize>::_rxOverflows = 0;
+    template<typename _Usart, unsigned _TxSize, unsigned _RxSize>
+    typename BufferedUsart<_Usart, _TxSize, _RxSize>::InterruptFlags BufferedUsart<_Usart, _TxSize, _RxSize>::_rxInterrupt = _Usart::InterruptFlags::RxNotEmptyInt;
+    template<typename _Usart, unsigned _TxSize, unsigned _RxSize>
+    typename BufferedUsart<_Usart, _TxSize, _RxSize>::InterruptFlags BufferedUsart<_Usart, _TxSize, _RxSize>::_txInterrupt = _Usart::InterruptFlags::TxEmptyInt;
+}
+
+#include "impl/buffered_usart.h"
+
+#endif //! ZHELE_BUFFERED_USART_H
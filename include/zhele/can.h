@@ -0,0 +1,24 @@
+/**
+ * @file
+ * United header for CAN
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @licence FreeBSD
+ */
+
+#if defined(STM32F0)
+    #error CAN is not implemented for STM32F0
+#endif
+#if defined(STM32F1)
+    #include "f1/can.h"
+#endif
+#if defined(STM32F4)
+    #include "f4/can.h"
+#endif
+#if defined(STM32L4)
+    #error CAN is not implemented for STM32L4
+#endif
+#if defined(STM32G0)
+    #error STM32G0 does not support bxCAN
+#endif
@@ -0,0 +1,233 @@
+/**
+ * @file
+ * Implements compile-time clock tree configuration
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CLOCK_TREE_H
+#define ZHELE_CLOCK_TREE_H
+
+#include <zhele/clock.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+#if defined (STM32F1)
+    #if !defined (ZHELE_CLOCK_MAX_SYSCLK)
+        #if defined (STM32F100xB) || defined (STM32F100xE)
+            #define ZHELE_CLOCK_MAX_SYSCLK 24000000
+        #else
+            #define ZHELE_CLOCK_MAX_SYSCLK 72000000
+        #endif
+    #endif
+    #if !defined (ZHELE_CLOCK_MAX_APB1)
+        #if defined (STM32F100xB) || defined (STM32F100xE)
+            #define ZHELE_CLOCK_MAX_APB1 24000000
+        #else
+            #define ZHELE_CLOCK_MAX_APB1 36000000
+        #endif
+    #endif
+#endif
+
+#if defined (STM32F0)
+    #if !defined (ZHELE_CLOCK_MAX_SYSCLK)
+        #define ZHELE_CLOCK_MAX_SYSCLK 48000000
+    #endif
+    #if !defined (ZHELE_CLOCK_MAX_APB1)
+        #define ZHELE_CLOCK_MAX_APB1 48000000
+    #endif
+#endif
+
+#if defined (STM32F4)
+    #if !defined (ZHELE_CLOCK_MAX_SYSCLK)
+        #if defined (STM32F401xC) || defined (STM32F401xE)
+            #define ZHELE_CLOCK_MAX_SYSCLK 84000000
+        #elif defined (STM32F410Tx) || defined (STM32F410Cx) || defined (STM32F410Rx) || defined (STM32F411xE) \
+            || defined (STM32F412Cx) || defined (STM32F412Rx) || defined (STM32F412Vx) || defined (STM32F412Zx) \
+            || defined (STM32F413xx) || defined (STM32F423xx)
+            #define ZHELE_CLOCK_MAX_SYSCLK 100000000
+        #elif defined (STM32F405xx) || defined (STM32F407xx) || defined (STM32F415xx) || defined (STM32F417xx)
+            #define ZHELE_CLOCK_MAX_SYSCLK 168000000
+        #else
+            #define ZHELE_CLOCK_MAX_SYSCLK 180000000
+        #endif
+    #endif
+    #if !defined (ZHELE_CLOCK_MAX_APB1)
+        #if defined (STM32F401xC) || defined (STM32F401xE) || defined (STM32F405xx) || defined (STM32F407xx) \
+            || defined (STM32F415xx) || defined (STM32F417xx)
+            #define ZHELE_CLOCK_MAX_APB1 42000000
+        #else
+            #define ZHELE_CLOCK_MAX_APB1 (ZHELE_CLOCK_MAX_SYSCLK / 2)
+        #endif
+    #endif
+    #if !defined (ZHELE_CLOCK_MAX_APB2)
+        #define ZHELE_CLOCK_MAX_APB2 (ZHELE_CLOCK_MAX_APB1 * 2)
+    #endif
+#endif
+
+#if defined (STM32G0)
+    #if !defined (ZHELE_CLOCK_MAX_SYSCLK)
+        #define ZHELE_CLOCK_MAX_SYSCLK 64000000
+    #endif
+    #if !defined (ZHELE_CLOCK_MAX_APB1)
+        #define ZHELE_CLOCK_MAX_APB1 64000000
+    #endif
+#endif
+
+#if defined (STM32L4)
+    #if !defined (ZHELE_CLOCK_MAX_SYSCLK)
+        #define ZHELE_CLOCK_MAX_SYSCLK 80000000
+    #endif
+    #if !defined (ZHELE_CLOCK_MAX_APB1)
+        #define ZHELE_CLOCK_MAX_APB1 ZHELE_CLOCK_MAX_SYSCLK
+    #endif
+#endif
+
+#if !defined (ZHELE_CLOCK_MAX_APB2)
+    #define ZHELE_CLOCK_MAX_APB2 ZHELE_CLOCK_MAX_SYSCLK
+#endif
+
+namespace Zhele::Clock
+{
+    /**
+     * @brief PLL configuration found by clock tree solver
+     */
+    struct PllConfiguration
+    {
+        bool Valid; ///< Configuration is found
+        ClockFrequenceT Input; ///< PLL source frequence (before divider)
+        unsigned Divider; ///< PLL input divider (PREDIV / PLLM)
+        unsigned Multiplier; ///< PLL multiplier (PLLMUL / PLLN)
+        unsigned SystemDivider; ///< PLL system output divider (PLLP / PLLR), 1 if family has not it
+        unsigned UsbDivider; ///< PLL 48 MHz output divider (PLLQ), 0 if not used
+        unsigned Apb1Divider; ///< APB1 prescaler
+        unsigned Apb2Divider; ///< APB2 prescaler
+    };
+
+    /**
+     * @brief Implements compile-time clock tree solver
+     *
+     * @details
+     * Solver searches legal PLL factors for given source and target system clock frequencies
+     * (family limits on PLL input, VCO and output frequencies are checked) and selects
+     * minimal APB prescalers to keep buses within their limits.
+     * Impossible targets are rejected by static_assert. Flash latency
+     * and accelerators are configured by Flash::OptimiseForFrequency before switching to PLL.
+     * Maximum frequencies can be overriden by ZHELE_CLOCK_MAX_SYSCLK, ZHELE_CLOCK_MAX_APB1
+     * and ZHELE_CLOCK_MAX_APB2 macros.
+     *
+     * @par Example
+     * @code
+     *  // Blue pill: 8 MHz HSE, 72 MHz system clock and 48 MHz for USB
+     *  ClockTree::Configure<8000000, 72000000, true>();
+     *  // HSI (zero HSE frequence) on stm32g0
+     *  ClockTree::Configure<0, 64000000>();
+     * @endcode
+     */
+    class ClockTree
+    {
+    public:
+        /**
+         * @brief Returns PLL configuration for given frequencies
+         *
+         * @tparam _HseHz External oscillator frequence (zero for internal oscillator)
+         * @tparam _SysHz Target system clock frequence
+         * @tparam _Usb48 Need 48 MHz clock for USB (OTG)
+         *
+         * @returns Configuration (Valid is false if target is impossible)
+         */
+        template<ClockFrequenceT _HseHz, ClockFrequenceT _SysHz, bool _Usb48 = false>
+        static consteval PllConfiguration Solve();
+
+        /**
+         * @brief Configures PLL, bus prescalers and switches system clock to PLL
+         *
+         * @details
+         * If system clock is already PLL, it is switched to HSI during PLL reconfiguration.
+         *
+         * @tparam _HseHz External oscillator frequence (zero for internal oscillator), must be equal to HSE_VALUE
+         * @tparam _SysHz Target system clock frequence
+         * @tparam _Usb48 Need 48 MHz clock for USB (OTG)
+         *
+         * @returns Result of switching system clock
+         */
+        template<ClockFrequenceT _HseHz, ClockFrequenceT _SysHz, bool _Usb48 = false>
+        static SysClock::ErrorCode Configure();
+    };
+
+    /**
+     * @brief Implements asynchronous clock tree bring-up (fast boot)
+     *
+     * @details
+     * Unlike @ref ClockTree::Configure it doesn't wait for oscillator and PLL start up:
+     * @ref Start configures PLL factors and bus prescalers while system clock is HSI, turns HSE
+     * (or PLL for internal source) on and returns immediately. Application initializes peripherals
+     * on HSI meanwhile, RCC ready interrupts turn PLL on after HSE is ready and switch system clock
+     * to PLL after lock. Peripherals subscribed to @ref ClockChange (USART, SPI, I2C, timers, SysTick)
+     * are re-timed by switch in RCC interrupt, so their subscribers must be safe in interrupt context
+     * (or peripherals should be initialized by ready callback).
+     *
+     * If HSE fails to start, system clock stays HSI and @ref IsReady never returns true.
+     *
+     * @par Example
+     * @code
+     *  using Boot = Clock::AsyncClockTree<8000000, 72000000>;
+     *  extern "C" void RCC_IRQHandler() { Boot::IrqHandler(); }
+     *  ...
+     *  Boot::Start();
+     *  // GPIO, DMA, USART... on HSI
+     * @endcode
+     *
+     * @tparam _HseHz External oscillator frequence (zero for internal oscillator), must be equal to HSE_VALUE
+     * @tparam _SysHz Target system clock frequence
+     * @tparam _Usb48 Need 48 MHz clock for USB (OTG)
+     */
+    template<ClockFrequenceT _HseHz, ClockFrequenceT _SysHz, bool _Usb48 = false>
+    class AsyncClockTree
+    {
+        static_assert(_HseHz == 0 || _HseHz == HSE_VALUE, "HSE frequence must be equal to HSE_VALUE (it is used to calculate clocks at runtime)");
+        static_assert(_SysHz <= ZHELE_CLOCK_MAX_SYSCLK, "Target system clock frequence exceeds max frequence");
+
+        static constexpr PllConfiguration Config = ClockTree::Solve<_HseHz, _SysHz, _Usb48>();
+        static_assert(Config.Valid, "There is no PLL configuration for target system clock frequence (and 48 MHz clock)");
+    public:
+        /// Clock switch callback (switch result)
+        using ReadyCallback = std::add_pointer_t<void(SysClock::ErrorCode result)>;
+
+        /**
+         * @brief Configures clock tree and starts oscillator and PLL in background
+         *
+         * @param [in] callback Callback is called from RCC interrupt after switch to PLL
+         *
+         * @returns Result of switching system clock to HSI
+         */
+        static SysClock::ErrorCode Start(ReadyCallback callback = nullptr);
+
+        /**
+         * @brief Returns switch state
+         *
+         * @retval true System clock is switched to PLL
+         * @retval false PLL is not locked yet
+         */
+        static bool IsReady();
+
+        /**
+         * @brief RCC interrupt handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static inline ReadyCallback _callback = nullptr; ///< Ready callback
+        static inline volatile bool _ready = false; ///< System clock is PLL
+    };
+}
+
+#include "impl/clock_tree.h"
+
+#endif //! ZHELE_CLOCK_TREE_H
@@ -9,12 +9,29 @@
 #ifndef ZHELE_ADC_COMMON_H
 #define ZHELE_ADC_COMMON_H
 
+#include "profiling.h"
+
 #include <initializer_list>
+#include <span>
 
 namespace Zhele
 {
     using AdcCallbackType = std::add_pointer_t<void(uint16_t* data, uint32_t count)>;
 
+    /**
+     * @brief Regular stream block callback
+     * 
+     * @param [in] data Filled block
+     * @param [in] count Samples count in block
+     * @param [in] overruns Total count of overruns (consumer has not processed block in time)
+     */
+    using AdcStreamCallbackType = std::add_pointer_t<void(uint16_t* data, uint32_t count, uint32_t overruns)>;
+
+    /**
+     * @brief Analog watchdog callback (converted value is out of thresholds)
+     */
+    using AdcWatchdogCallbackType = std::add_pointer_t<void()>;
+
     namespace Private
     {
         /**
@@ -73,19 +90,57 @@ namespace Zhele
             AdcData()
                 : regularCallback(nullptr),
                 injectedCallback(nullptr),
+                streamCallback(nullptr),
+                watchdogCallback(nullptr),
                 regularData(0),
                 injectedData(0),
                 error(AdcCommon::AdcError::NoError),
-                vRef(0)
+                vRef(0),
+                millivoltsScale(0),
+                streamOverruns(0),
+                powerUpTime(0),
+                stable(false),
+                calibrated(false)
             {
             }
 
             AdcCallbackType regularCallback;
             AdcCallbackType injectedCallback;
+            AdcStreamCallbackType streamCallback;
+            AdcWatchdogCallbackType watchdogCallback;
             uint16_t* regularData;
             uint16_t* injectedData;
             AdcCommon::AdcError error;
             uint16_t vRef;
+            uint32_t millivoltsScale;
+            uint32_t streamOverruns;
+            uint32_t powerUpTime; ///< Cycle counter value at ADC power up
+            bool stable; ///< ADC power up time is passed
+            bool calibrated; ///< ADC keeps calibration
+        };
+
+        /**
+         * @brief ADC regular trigger by timer TRGO (specialized in family headers)
+         * 
+         * @tparam _Adc ADC
+         * @tparam _Timer Timer
+         */
+        template<typename _Adc, typename _Timer>
+        struct AdcTimerTrigger
+        {
+            static constexpr bool Supported = false;
+        };
+
+        /**
+         * @brief ADC injected trigger by timer channel 4 compare (specialized in family headers)
+         * 
+         * @tparam _Adc ADC
+         * @tparam _Timer Timer
+         */
+        template<typename _Adc, typename _Timer>
+        struct AdcInjectedTimerTrigger
+        {
+            static constexpr bool Supported = false;
         };
 
         template <typename _Regs, typename _ClockCtrl, typename _InputPins, typename _DmaChannel>
@@ -98,6 +153,8 @@ namespace Zhele
 
             using Clock = _ClockCtrl;
             using Pins = _InputPins;
+            using Regs = _Regs;
+            using DmaChannel = _DmaChannel;
 
             using AdcDivider = typename _ClockCtrl::Prescaler;
             using ClockSource = typename _ClockCtrl::ClockSource;
@@ -168,6 +225,70 @@ namespace Zhele
              */
             template<AdcDivider divider = AdcDivider::Div2, ClockSource clockSource = AdcClock>
             static void Init(Reference reference = Reference::External);
+
+            /**
+             * @brief Starts adc init without waiting
+             * 
+             * @details
+             * ADC is powered up and configured, method doesn't wait for ADC stabilization,
+             * so other startup code runs meanwhile. Call WaitReady before first conversion.
+             * 
+             * @tparam divider Clock divider
+             * @tparam clockSource Clock source
+             * @param [in] reference Reference volatage source
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<AdcDivider divider = AdcDivider::Div2, ClockSource clockSource = AdcClock>
+            static void InitAsync(Reference reference = Reference::External);
+
+            /**
+             * @brief Returns ADC stabilization state
+             * 
+             * @retval true ADC power up time is passed
+             * @retval false ADC is stabilizing
+             */
+            static bool Ready();
+
+            /**
+             * @brief Waits for ADC stabilization and calibrates it (if it's not calibrated yet)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void WaitReady();
+
+            /**
+             * @brief Calibrates ADC
+             * 
+             * @details
+             * Calibration is kept while ADC is not disabled (suspended ADC keeps it too),
+             * so Init calibrates ADC once.
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Calibrate();
+
+            /**
+             * @brief Returns ADC calibration state
+             * 
+             * @retval true ADC is calibrated
+             * @retval false ADC is not calibrated
+             */
+            static bool Calibrated();
+
+            /**
+             * @brief Powers ADC down keeping its configuration and calibration
+             * 
+             * @details
+             * Next Init (or InitAsync) waits power up time only.
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Suspend();
             
             /**
              * @brief Set adc resolution
@@ -178,6 +299,62 @@ namespace Zhele
              */
             static uint8_t SetResolution(uint8_t resolution);
 
+        #if defined (ADC_CFGR2_OVSR)
+            /**
+             * @brief Returns effective resolution of oversampled result
+             * 
+             * @tparam ratio Oversampling ratio (power of 2, from 2 to 256)
+             * @tparam shift Result right shift (from 0 to 8 bits)
+             * 
+             * @returns Effective resolution (bits count)
+             */
+            template<unsigned ratio, unsigned shift>
+            static consteval uint8_t OversampledResolution();
+
+            /**
+             * @brief Enable hardware oversampling for regular channels
+             * 
+             * @details
+             * Hardware accumulates ratio conversions and shifts sum right, so
+             * result is averaged (and extended) without CPU.
+             * Compilation fails if result does not fit data register (16 bits).
+             * ADC should be stopped.
+             * 
+             * @tparam ratio Oversampling ratio (power of 2, from 2 to 256)
+             * @tparam shift Result right shift (from 0 to 8 bits)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<unsigned ratio, unsigned shift>
+            static void SetOversampling();
+
+        #if defined (ADC_CFGR2_JOVSE)
+            /**
+             * @brief Enable hardware oversampling for injected channels
+             * 
+             * @details
+             * Ratio and shift are common for regular and injected channels.
+             * 
+             * @tparam ratio Oversampling ratio (power of 2, from 2 to 256)
+             * @tparam shift Result right shift (from 0 to 8 bits)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<unsigned ratio, unsigned shift>
+            static void SetInjectedOversampling();
+        #endif
+
+            /**
+             * @brief Disable hardware oversampling (for regular and injected channels)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableOversampling();
+        #endif
+
             /**
              * @brief Set conversion mode
              * 
@@ -229,6 +406,27 @@ namespace Zhele
              */
             static bool StartInjected(const uint8_t* channels, uint16_t* data, uint8_t count, AdcCallbackType callback = nullptr);
             
+            /**
+             * @brief Start injected conversions by external trigger
+             * 
+             * @details
+             * Whole sequence is converted on every trigger event (scan mode, no discontinuous mode),
+             * JEOC interrupt is enabled. Results of the last sequence stay in JDRx registers (JDR1 is the first channel).
+             * If data buffer is given, @ref IrqHandler copies results to it and calls callback.
+             * Use @ref StopInjected to return to software trigger.
+             * 
+             * @param [in] channels Channels
+             * @param [in] count Channels count (up to MaxInjected)
+             * @param [in] trigger Trigger (family InjectedTrigger)
+             * @param [out] data Buffer for result
+             * @param [in] callback Callback
+             * 
+             * @retval true Conversions started
+             * @retval false Start fail
+             */
+            template<typename InjectedTrigger>
+            static bool StartInjectedTriggered(const uint8_t* channels, uint8_t count, InjectedTrigger trigger, uint16_t* data = nullptr, AdcCallbackType callback = nullptr);
+
             /**
              * @brief Start injected measurment for one channel
              * 
@@ -304,6 +502,17 @@ namespace Zhele
              */
             static void SetRegularCallback(AdcCallbackType callback);
 
+            /**
+             * @brief Set regular sequence (configures pins as analog and enables scan mode if needed)
+             * 
+             * @param [in] channels Channels
+             * @param [in] channelsCount Channels count
+             * 
+             * @retval true Sequence is set
+             * @retval false Invalid channels count
+             */
+            static bool SetRegularSequence(const uint8_t* channels, uint8_t channelsCount);
+
             /**
              * @brief Returns state for regular measurement
              * 
@@ -352,6 +561,46 @@ namespace Zhele
             template <typename... _Pins>
             static bool StartRegular(uint16_t* dataBuffer, uint16_t scanCount);
 
+            /**
+             * @brief Start continuous regular measurement (stream)
+             * 
+             * @details
+             * ADC converts channels continuously (or by regular trigger, if it is selected),
+             * DMA fills buffer circularly.
+             * Callback is called for each filled block while the other one is filling.
+             * If callback does not return until the next block is filled, overrun is counted.
+             * 
+             * @param [in] channels Array with channels
+             * @param [in] channelsCount Channels count
+             * @param [out] buffer Buffer. Must has 2 * blockSize elements (two blocks).
+             * @param [in] blockSize Block size in samples (multiple of channels count)
+             * @param [in] callback Block callback
+             * 
+             * @retval true Stream started
+             * @retval false Stream start fail
+             */
+            static bool StartRegularStream(const uint8_t* channels, uint8_t channelsCount, uint16_t* buffer, uint16_t blockSize, AdcStreamCallbackType callback);
+
+            /**
+             * @brief Start continuous regular measurement (stream)
+             * 
+             * @param [in] channels Channels as initializer_list
+             * @param [out] buffer Buffer. Must has 2 * blockSize elements (two blocks).
+             * @param [in] blockSize Block size in samples (multiple of channels count)
+             * @param [in] callback Block callback
+             * 
+             * @retval true Stream started
+             * @retval false Stream start fail
+             */
+            static bool StartRegularStream(std::initializer_list<uint8_t> channels, uint16_t* buffer, uint16_t blockSize, AdcStreamCallbackType callback);
+
+            /**
+             * @brief Returns count of stream overruns since stream start
+             * 
+             * @returns Overruns count
+             */
+            static uint32_t StreamOverruns();
+
             /**
              * @brief Stop regular measurement
              * 
@@ -370,6 +619,42 @@ namespace Zhele
             template <typename _Pin>
             constexpr static unsigned ChannelNum();
 
+            /**
+             * @brief Enable analog watchdog on one channel (regular and injected conversions)
+             * 
+             * @details
+             * Callback is called from ADC interrupt after every conversion that is out of thresholds.
+             * 
+             * @param [in] channel Channel
+             * @param [in] low Low threshold
+             * @param [in] high High threshold
+             * @param [in] callback Out of thresholds callback
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableAnalogWatchdog(uint8_t channel, uint16_t low, uint16_t high, AdcWatchdogCallbackType callback);
+
+            /**
+             * @brief Enable analog watchdog on all channels (regular and injected conversions)
+             * 
+             * @param [in] low Low threshold
+             * @param [in] high High threshold
+             * @param [in] callback Out of thresholds callback
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableAnalogWatchdog(uint16_t low, uint16_t high, AdcWatchdogCallbackType callback);
+
+            /**
+             * @brief Disable analog watchdog
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableAnalogWatchdog();
+
             /**
              * @brief Get error of last operation
              * 
@@ -386,6 +671,41 @@ namespace Zhele
              */
             static unsigned ToVolts(uint16_t value);
 
+            /**
+             * @brief Converts measurement results to millivolts (same scale as ToVolts)
+             * 
+             * @details
+             * Uses precomputed Q16 reciprocal of reference measurement, so there is no division per sample.
+             * 
+             * @param [in] input Measurement results
+             * @param [out] output Results in millivolts (at least input.size() elements)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void ToMillivolts(std::span<const uint16_t> input, std::span<int32_t> output);
+
+            /**
+             * @brief Converts measurement results to Q15 fraction of full scale
+             * 
+             * @param [in] input Measurement results
+             * @param [out] output Q15 results (at least input.size() elements)
+             * @param [in] gain Q15 gain (saturated result)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void ToQ15(std::span<const uint16_t> input, std::span<int16_t> output, int16_t gain = INT16_MAX);
+
+            /**
+             * @brief Removes DC offset (mean value) in place
+             * 
+             * @param [in, out] data Measurement results
+             * 
+             * @returns Same buffer as signed values
+             */
+            static std::span<int16_t> RemoveDcOffset(std::span<uint16_t> data);
+
             /**
              * @brief Returns ADC source clock frequence
              * 
@@ -430,6 +750,18 @@ namespace Zhele
              */
             static void DmaHandler(void *data, size_t size, bool success);
 
+            /**
+             * @brief Dma handler for regular stream
+             * 
+             * @param [in] data Filled block
+             * @param [in] size Block size
+             * @param [in] bufferIndex Block index
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void StreamHandler(void *data, unsigned size, unsigned bufferIndex);
+
             /**
              * @brief Adc irq handler
              * 
@@ -441,6 +773,7 @@ namespace Zhele
         protected:
             static bool VerifyReady(unsigned);
             static unsigned SampleTimeToReg(unsigned sampleTime);
+            static uint16_t VRef();
             static AdcData _adcData;
         };
     } // namespace Private
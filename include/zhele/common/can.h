@@ -0,0 +1,345 @@
+/**
+ * @file
+ * Implements bxCAN
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CAN_COMMON_H
+#define ZHELE_CAN_COMMON_H
+
+#include "ioreg.h"
+#include "statistics.h"
+
+#include <zhele/clock.h>
+#include <zhele/containers/ring_buffer.h>
+#include <zhele/iopins.h>
+#include <zhele/pinlist.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+#if !defined (ZHELE_CAN_RX_QUEUE_SIZE)
+    /// Receive queue size (messages, one queue per FIFO)
+    #define ZHELE_CAN_RX_QUEUE_SIZE 32
+#endif
+
+#if !defined (ZHELE_CAN_TX_QUEUE_SIZE)
+    /// Transmit queue size (messages, in addition to 3 hardware mailboxes)
+    #define ZHELE_CAN_TX_QUEUE_SIZE 16
+#endif
+
+namespace Zhele
+{
+    /**
+     * @brief CAN message
+     */
+    struct CanMessage
+    {
+        uint32_t Id; ///< Identifier (11 or 29 bits)
+        uint8_t Length; ///< Data length (0-8)
+        bool Extended; ///< Identifier is extended (29 bits)
+        bool Remote; ///< Remote transmission request
+        uint8_t Filter; ///< Filter match index (received messages only)
+        uint8_t Data[8]; ///< Data
+    };
+
+    /**
+     * @brief CAN bit timing
+     */
+    struct CanTiming
+    {
+        uint16_t Prescaler; ///< Time quantum prescaler (0 if bit rate is unreachable)
+        uint8_t Segment1; ///< Time quanta before sample point (without sync segment)
+        uint8_t Segment2; ///< Time quanta after sample point
+        uint8_t JumpWidth; ///< Resynchronization jump width
+        uint16_t SamplePointPermille; ///< Achieved sample point (permille of bit time)
+    };
+
+    namespace Private
+    {
+        /**
+         * @brief Implements bxCAN
+         *
+         * @details
+         * Received messages are drained from both hardware FIFOs by interrupts into software queues
+         * (one per FIFO), so hardware FIFOs (3 messages) do not overflow while main loop is busy.
+         * Transmitted messages are written into free mailbox directly or queued and sent from
+         * "transmit mailbox empty" interrupt. All 3 mailboxes are used and they are sent in identifier
+         * priority order (queued messages are sent in FIFO order).
+         *
+         * Filter banks belong to CAN1 (CAN2 uses banks from start bank, see SplitFilterBanks),
+         * messages that do not pass any active filter are discarded by hardware.
+         * There is no active filter after reset, so at least one filter must be set to receive messages.
+         *
+         * Interrupt handlers must be called from IRQ handlers (TX, RX0, RX1 and SCE).
+         *
+         * @par Example
+         * @code
+         *  Can1::SelectPins<IO::Pb9, IO::Pb8>();
+         *  Can1::Init<1000000, 36000000>();
+         *  Can1::SetMaskFilter(0, 0x100, 0x700); // 0x100-0x1ff to FIFO 0
+         *  Can1::Send({.Id = 0x123, .Length = 2, .Data = {1, 2}});
+         * @endcode
+         *
+         * @tparam _Regs Registers
+         * @tparam _FilterRegs Filter registers (CAN1 registers)
+         * @tparam _ClockCtrl Clock
+         * @tparam _FilterClockCtrl Filter registers clock (CAN1 clock)
+         * @tparam _TxIrq Transmit IRQ
+         * @tparam _Rx0Irq FIFO 0 IRQ
+         * @tparam _Rx1Irq FIFO 1 IRQ
+         * @tparam _SceIrq Status change and error IRQ
+         * @tparam _TxPins TX pins
+         * @tparam _RxPins RX pins
+         */
+        template<typename _Regs, typename _FilterRegs, typename _ClockCtrl, typename _FilterClockCtrl,
+            IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _TxPins, typename _RxPins>
+        class Can
+        {
+            using RxQueue = Containers::RingBuffer<ZHELE_CAN_RX_QUEUE_SIZE, CanMessage>;
+            using TxQueue = Containers::RingBuffer<ZHELE_CAN_TX_QUEUE_SIZE, CanMessage>;
+
+        public:
+            using Counters = Statistics::Counters<Statistics::CanCounters, Can>;
+
+            /// Filter banks count
+            static constexpr uint8_t FilterBanks = sizeof(CAN_TypeDef::sFilterRegister) / sizeof(CAN_TypeDef::sFilterRegister[0]);
+
+            /// Mode
+            enum class Mode : uint32_t
+            {
+                Normal = 0, ///< Normal mode
+                Loopback = CAN_BTR_LBKM, ///< Transmitted messages are received, TX pin is recessive
+                Silent = CAN_BTR_SILM, ///< Bus monitoring (no acknowledge and no transmission)
+                SilentLoopback = CAN_BTR_LBKM | CAN_BTR_SILM, ///< Self test without bus
+            };
+
+            /**
+             * @brief Calculates bit timing
+             *
+             * @details
+             * Bit rate must be achieved exactly. Timing with sample point closest to requested one is selected,
+             * more time quanta per bit are preferred with equal sample points.
+             *
+             * @param [in] clockFrequency CAN clock (APB1) frequency
+             * @param [in] bitRate Bit rate
+             * @param [in] samplePointPermille Sample point (permille of bit time)
+             *
+             * @returns Timing (with zero prescaler if bit rate is unreachable)
+             */
+            static constexpr CanTiming CalculateTiming(uint32_t clockFrequency, uint32_t bitRate, uint16_t samplePointPermille);
+
+            /**
+             * @brief Initializes CAN
+             *
+             * @details
+             * Pins must be selected before init: CAN leaves initialization mode after 11 recessive bits
+             * on RX pin. Bus-off state is left automatically.
+             *
+             * @tparam bitRate Bit rate (up to 1 Mbit/s)
+             * @tparam clockFrequency CAN clock (APB1) frequency
+             * @tparam samplePointPermille Sample point (permille of bit time, 875 is CANopen recommendation)
+             *
+             * @param [in] mode Mode
+             *
+             * @retval true CAN is synchronized with bus
+             * @retval false CAN is not synchronized (bus is dominant or RX pin is not connected)
+             */
+            template<uint32_t bitRate, uint32_t clockFrequency, uint16_t samplePointPermille = 875>
+            static bool Init(Mode mode = Mode::Normal);
+
+            /**
+             * @brief Selects TX and RX pins (indexes in pin lists)
+             *
+             * @tparam txPinNumber TX pin index
+             * @tparam rxPinNumber RX pin index
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<int8_t txPinNumber, int8_t rxPinNumber>
+            static void SelectPins();
+
+            /**
+             * @brief Selects TX and RX pins
+             *
+             * @tparam TxPin TX pin
+             * @tparam RxPin RX pin
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<typename TxPin, typename RxPin>
+            static void SelectPins();
+
+            /**
+             * @brief Sets filter in identifier mask mode (32-bit scale)
+             *
+             * @details
+             * Message passes filter if identifier bits selected by mask are equal to filter identifier bits.
+             * Identifier type (standard or extended) must match filter type.
+             *
+             * @param [in] bank Filter bank
+             * @param [in] id Identifier
+             * @param [in] mask Mask (1 bits must match)
+             * @param [in] extended Identifier is extended
+             * @param [in] fifo Target FIFO (0 or 1)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void SetMaskFilter(uint8_t bank, uint32_t id, uint32_t mask, bool extended = false, uint8_t fifo = 0);
+
+            /**
+             * @brief Sets filter in identifier list mode (32-bit scale)
+             *
+             * @details
+             * Message passes filter if it's identifier is equal to one of filter identifiers.
+             * Remote frames do not pass list filter.
+             *
+             * @param [in] bank Filter bank
+             * @param [in] id1 First identifier
+             * @param [in] id2 Second identifier
+             * @param [in] extended Identifiers are extended
+             * @param [in] fifo Target FIFO (0 or 1)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void SetListFilter(uint8_t bank, uint32_t id1, uint32_t id2, bool extended = false, uint8_t fifo = 0);
+
+            /**
+             * @brief Disables filter
+             *
+             * @param [in] bank Filter bank
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableFilter(uint8_t bank);
+
+        #if defined (CAN_FMR_CAN2SB)
+            /**
+             * @brief Splits filter banks between CAN1 and CAN2
+             *
+             * @param [in] can2StartBank First CAN2 filter bank (banks before it belong to CAN1)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void SplitFilterBanks(uint8_t can2StartBank);
+        #endif
+
+            /**
+             * @brief Sends message (non-blocking)
+             *
+             * @param [in] message Message
+             *
+             * @retval true Message is written into mailbox or queued
+             * @retval false Transmit queue is full
+             */
+            static bool Send(const CanMessage& message);
+
+            /**
+             * @brief Receives message (non-blocking)
+             *
+             * @details
+             * FIFO 0 messages are returned first.
+             *
+             * @param [out] message Message
+             *
+             * @retval true Message is received
+             * @retval false There is no received messages
+             */
+            static bool Receive(CanMessage& message);
+
+            /**
+             * @brief Returns received messages count
+             *
+             * @returns Messages count (both FIFOs)
+             */
+            static unsigned Available();
+
+            /**
+             * @brief Returns transmit is completed
+             *
+             * @retval true All messages are sent (or aborted)
+             * @retval false There are pending messages
+             */
+            static bool TransmitCompleted();
+
+            /**
+             * @brief Returns transmit error counter
+             *
+             * @returns Transmit error counter
+             */
+            static uint8_t TransmitErrors();
+
+            /**
+             * @brief Returns receive error counter
+             *
+             * @returns Receive error counter
+             */
+            static uint8_t ReceiveErrors();
+
+            /**
+             * @brief Returns CAN is in bus-off state
+             *
+             * @retval true CAN is bus-off
+             * @retval false CAN is error active or error passive
+             */
+            static bool BusOff();
+
+            /**
+             * @brief Transmit interrupt handler (mailbox empty)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void TxIrqHandler();
+
+            /**
+             * @brief FIFO 0 interrupt handler
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Rx0IrqHandler();
+
+            /**
+             * @brief FIFO 1 interrupt handler
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Rx1IrqHandler();
+
+            /**
+             * @brief Status change and error interrupt handler
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void SceIrqHandler();
+
+        private:
+            static bool WriteMailbox(const CanMessage& message);
+            static void ConfigureFilter(uint8_t bank, uint32_t fr1, uint32_t fr2, bool listMode, uint8_t fifo);
+            static constexpr uint32_t FilterId(uint32_t id, bool extended);
+
+            template<uint8_t fifo>
+            static void DrainFifo(volatile uint32_t& fifoRegister, RxQueue& queue);
+
+            static RxQueue _rxQueue0;
+            static RxQueue _rxQueue1;
+            static TxQueue _txQueue;
+        };
+    }
+}
+
+#include "impl/can.h"
+
+#endif //! ZHELE_CAN_COMMON_H
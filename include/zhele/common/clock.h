@@ -15,6 +15,12 @@
 #include <zhele/flash.h>
 
 #include <stdint.h>
+#include <type_traits>
+
+#if !defined (ZHELE_CLOCK_CHANGE_SUBSCRIBERS)
+    /// Max count of runtime clock change subscribers (compile-time subscribers don't use slots)
+    #define ZHELE_CLOCK_CHANGE_SUBSCRIBERS 8
+#endif
 
 namespace Zhele
 {
@@ -372,6 +378,118 @@ namespace Zhele
         };
     #endif
 
+        /**
+         * @brief Implements clock change notification
+         *
+         * @details
+         * Peripherals that have frequence-dependent registers (USART BRR, SPI divider, I2C timing,
+         * timer prescaler, SysTick reload) subscribe at init and recompute them after system clock source
+         * or bus prescaler change. Changes between BeginUpdate and EndUpdate (for example, whole clock tree
+         * configuration) are notified once, at EndUpdate, so peripherals are re-timed in one pass.
+         * Subscribers are called in thread mode of changing code, they must not change clocks.
+         *
+         * Callback known at compile time is subscribed by Subscribe<Callback>(): its list node is
+         * static variable of that callback, so subscription never fails and memory is sized by
+         * actual subscribers (framework peripherals subscribe this way). Runtime callbacks use
+         * ZHELE_CLOCK_CHANGE_SUBSCRIBERS slots, raise it if Subscribe(callback) returns false.
+         *
+         * @par Example
+         * @code
+         *  ClockChange::Subscribe<OnClockChange>();
+         *  ...
+         *  SysClock::SelectClockSource<SysClock::Internal>(); // OnClockChange is called
+         * @endcode
+         */
+        class ClockChange
+        {
+        public:
+            /// Subscriber type
+            using Callback = std::add_pointer_t<void()>;
+
+            /**
+             * @brief Subscribes to clock change (repeated subscription is ignored)
+             *
+             * @param [in] callback Callback
+             *
+             * @retval true Callback is subscribed
+             * @retval false There is no free slot (see ZHELE_CLOCK_CHANGE_SUBSCRIBERS)
+             */
+            static bool Subscribe(Callback callback);
+
+            /**
+             * @brief Subscribes callback known at compile time (repeated subscription is ignored)
+             *
+             * @tparam _Callback Callback
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<Callback _Callback>
+            static void Subscribe();
+
+            /**
+             * @brief Unsubscribes from clock change
+             *
+             * @param [in] callback Callback
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Unsubscribe(Callback callback);
+
+            /**
+             * @brief Unsubscribes callback subscribed by Subscribe<Callback>()
+             *
+             * @tparam _Callback Callback
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<Callback _Callback>
+            static void Unsubscribe();
+
+            /**
+             * @brief Starts clock update: notifications are delayed until EndUpdate
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void BeginUpdate();
+
+            /**
+             * @brief Finishes clock update and notifies subscribers if clock was changed
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void EndUpdate();
+
+            /**
+             * @brief Notifies subscribers about clock change
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Notify();
+
+        private:
+            /// Compile-time subscriber list node
+            struct Node
+            {
+                Callback callback; ///< Callback
+                Node* next; ///< Next subscriber
+                bool linked; ///< Node is in list
+            };
+
+            template<Callback _Callback>
+            static inline Node _node = {_Callback, nullptr, false}; ///< Node of compile-time subscriber
+
+            static inline Node* _head = nullptr; ///< Compile-time subscribers list
+            static inline Callback _subscribers[ZHELE_CLOCK_CHANGE_SUBSCRIBERS] = {}; ///< Runtime subscribers
+            static inline uint8_t _updateLevel = 0; ///< Nested BeginUpdate count
+            static inline bool _pending = false; ///< Clock was changed during update
+        };
+
         /**
          * @brief Implements system clock
          */
@@ -406,6 +524,10 @@ namespace Zhele
             /**
              * Select source for system clock
              * 
+             * @details
+             * Flash latency is increased before switch to higher frequence and decreased after switch
+             * to lower one. Clock change subscribers (@ref ClockChange) are notified after switch.
+             * 
              * @tparam clockSource Clock source (Internal, external or PLL)
              * 
              * @returns Select result
@@ -416,6 +538,10 @@ namespace Zhele
             /**
              * @brief Returns system clock frequence
              * 
+             * @details
+             * Frequence is calculated from RCC registers once and cached, cache is updated
+             * by SelectClockSource (so clock must be changed by this class).
+             * 
              * @returns Clock frequence
              */
             static ClockFrequenceT ClockFreq();
@@ -429,6 +555,9 @@ namespace Zhele
              * @returns Source clock frequence
              */
             static ClockFrequenceT SrcClockFreq();
+
+        private:
+            static inline ClockFrequenceT _frequence = 0; ///< Cached frequence (0 if it's not calculated yet)
         };
 
         /**
@@ -515,6 +644,115 @@ namespace Zhele
             static ClockFrequenceT ClockFreq();
         };
         
+    #if defined (RCC_CCIPR_USART1SEL)
+        /**
+         * @brief USART/LPUART kernel clock sources
+         */
+        enum class UsartClockSource : uint8_t
+        {
+            Pclk = 0b00, ///< APB clock (default)
+            SysClk = 0b01, ///< System clock
+            Hsi = 0b10, ///< HSI16 (is kept in Stop mode while USART receives with wake up enabled)
+            Lse = 0b11, ///< LSE 32768 Hz (LPUART up to 9600 baud)
+        };
+
+        /**
+         * @brief Implements USART kernel clock
+         * 
+         * @details
+         * Kernel clock is selected in RCC_CCIPR. USART should be clocked by HSI16 or LSE
+         * to receive in Stop mode (bus clocks are stopped and system clock is HSI after wake up).
+         * 
+         * @tparam _BusClock Bus clock
+         * @tparam _SelectPosition Position of USART clock selection field in RCC_CCIPR
+         */
+        template<typename _BusClock, unsigned _SelectPosition>
+        class UsartKernelClock : public _BusClock
+        {
+        public:
+            /**
+             * @brief Selects kernel clock source
+             * 
+             * @details
+             * USART should be disabled. Clock source (HSI16 or LSE) should be enabled.
+             * 
+             * @param [in] source Clock source
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void SelectClockSource(UsartClockSource source);
+
+            /**
+             * @brief Returns selected kernel clock source
+             * 
+             * @returns Clock source
+             */
+            static UsartClockSource GetClockSource();
+
+            /**
+             * @brief Returns kernel clock frequence
+             * 
+             * @returns Current frequence
+             */
+            static ClockFrequenceT ClockFreq();
+        };
+    #endif
+
+    #if defined (RCC_CCIPR_LPTIM1SEL)
+        /**
+         * @brief LPTIM kernel clock sources
+         */
+        enum class LpTimerClockSource : uint8_t
+        {
+            Pclk = 0b00, ///< APB clock (default)
+            Lsi = 0b01, ///< LSI
+            Hsi = 0b10, ///< HSI16
+            Lse = 0b11, ///< LSE 32768 Hz
+        };
+
+        /**
+         * @brief Implements LPTIM kernel clock
+         * 
+         * @details
+         * Kernel clock is selected in RCC_CCIPR. LPTIM counts in Stop mode if it's clocked by LSE or LSI.
+         * 
+         * @tparam _BusClock Bus clock
+         * @tparam _SelectPosition Position of LPTIM clock selection field in RCC_CCIPR
+         */
+        template<typename _BusClock, unsigned _SelectPosition>
+        class LpTimerKernelClock : public _BusClock
+        {
+        public:
+            /**
+             * @brief Selects kernel clock source
+             * 
+             * @details
+             * LPTIM should be disabled. Clock source (LSE or LSI) should be enabled.
+             * 
+             * @param [in] source Clock source
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void SelectClockSource(LpTimerClockSource source);
+
+            /**
+             * @brief Returns selected kernel clock source
+             * 
+             * @returns Clock source
+             */
+            static LpTimerClockSource GetClockSource();
+
+            /**
+             * @brief Returns kernel clock frequence
+             * 
+             * @returns Current frequence
+             */
+            static ClockFrequenceT ClockFreq();
+        };
+    #endif
+
         /**
          * @brief Implements clock control
          * 
@@ -9,7 +9,10 @@
 #ifndef ZHELE_CRC_COMMON_H
 #define ZHELE_CRC_COMMON_H
 
+#include "template_utils/data_transfer.h"
+
 #include <stdint.h>
+#include <span>
 #include <type_traits>
 
 namespace Zhele::Private
@@ -23,6 +26,43 @@ namespace Zhele::Private
          *  Nothing
         */
         static void Reset();
+
+        /**
+         * @brief Writes data word (with bit reversal if unit doesn't support it)
+         * 
+         * @param [in] word Data word
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void WriteWord(uint32_t word);
+
+        /**
+         * @brief Appends byte to pending word
+         * 
+         * @param [in] byte Data byte
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void AppendByte(uint8_t byte);
+
+    #if defined (CRC_CR_REV_IN)
+        template<typename _DmaChannel>
+        static void StartChunk();
+
+        template<typename _DmaChannel>
+        static void TransferHandler(void* data, unsigned size, bool success);
+    #endif
+
+        static inline uint32_t _pending = 0; ///< Bytes that don't fill word
+        static inline uint8_t _pendingSize = 0; ///< Pending bytes count
+        static inline const uint8_t* _asyncData = nullptr; ///< Async update data
+        static inline uint32_t _asyncSize = 0; ///< Async update size
+        static inline const uint8_t* _nextWord = nullptr; ///< Next DMA chunk
+        static inline uint32_t _remainingWords = 0; ///< Words to write by DMA
+        static inline TransferCallback _asyncCallback = nullptr; ///< Async update callback
+        static inline volatile bool _busy = false; ///< Async update is in progress
     public:
     #if defined (CRC_POL_POL)
         enum class PolynomSize {
@@ -108,6 +148,67 @@ namespace Zhele::Private
         */
         static uint32_t CalculateCrc32(const uint8_t* data, unsigned size);
 
+        /**
+         * @brief Begins incremental CRC32 calculation
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void Begin();
+
+        /**
+         * @brief Adds data to incremental CRC32 calculation
+         * 
+         * @details
+         * Data may have any size and alignment: bytes that don't fill word are kept
+         * until next @ref Update (or @ref Finish).
+         * 
+         * @param [in] data Data
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void Update(std::span<const uint8_t> data);
+
+        /**
+         * @brief Finishes incremental CRC32 calculation
+         * 
+         * @returns CRC32 of all data since @ref Begin
+        */
+        static uint32_t Finish();
+
+    #if defined (CRC_CR_REV_IN)
+        /**
+         * @brief Adds data to incremental CRC32 calculation by DMA (Mem2Mem transfer to data register)
+         * 
+         * @details
+         * Words are written by DMA, unaligned head and tail bytes are processed by CPU.
+         * If data address is not word aligned (relative to stream position), data is processed
+         * synchronously and callback is called immediately. Don't call other methods until callback.
+         * DMA IRQ handler should call _DmaChannel::IrqHandler.
+         * 
+         * @note Input bit reversal is required for DMA feeding, so MCUs without it (F1, F4) support only synchronous @ref Update.
+         * 
+         * @tparam _DmaChannel DMA channel (stream) that supports memory to memory transfers
+         * 
+         * @param [in] data Data (must be valid until callback)
+         * @param [in] callback Complete callback (accepts data and size)
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        template<typename _DmaChannel>
+        static void UpdateAsync(std::span<const uint8_t> data, TransferCallback callback = nullptr);
+    #endif
+
+        /**
+         * @brief Check that async update is in progress
+         * 
+         * @retval true DMA feeds data
+         * @retval false CRC unit is idle
+        */
+        static bool Busy();
+
         /**
          * @brief Store data to independet register
          * 
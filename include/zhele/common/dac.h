@@ -17,6 +17,17 @@ namespace Zhele
 {
     namespace Private
     {
+        /**
+         * @brief DAC trigger by timer TRGO (specialized in family headers)
+         * 
+         * @tparam _Timer Timer
+         */
+        template<typename _Timer>
+        struct DacTimerTrigger
+        {
+            static constexpr bool Supported = false;
+        };
+
         /**
          * @brief Implementd Digital-to-Analog converter
          * 
@@ -39,6 +50,9 @@ namespace Zhele
             };
 
         public:
+            /// DMA sample type (12-bit right-aligned)
+            using SampleType = uint16_t;
+
             /// Wave amplitude
             enum class WaveAmplitude : uint8_t
             {
@@ -174,6 +188,141 @@ namespace Zhele
              *  Nothing
              */
             static void CauseSoftwareTrigger();
+
+            /**
+             * @brief Enable DMA request (on trigger)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableDma();
+
+            /**
+             * @brief Disable DMA request
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableDma();
+
+            /**
+             * @brief Returns DMA target data register (12-bit right-aligned)
+             * 
+             * @returns Data register address
+             */
+            static volatile void* DataRegister();
+        };
+
+        /**
+         * @brief Implements synchronized output of both DAC channels
+         * 
+         * @details
+         * Both channels are updated by one write (and one DMA transfer) of packed word:
+         * channel 1 data in low half-word, channel 2 data in high half-word.
+         * 
+         * @tparam _Regs Registers
+         * @tparam _ClockCtrl Clock control
+         */
+        template <typename _Regs, typename _ClockCtrl>
+        class DacDual
+        {
+            using Channel1 = DacBase<_Regs, _ClockCtrl, 0>;
+            using Channel2 = DacBase<_Regs, _ClockCtrl, 1>;
+        public:
+            /// DMA sample type (packed 12-bit right-aligned data of both channels)
+            using SampleType = uint32_t;
+
+            /**
+             * @brief Init both channels
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Init();
+
+            /**
+             * @brief Init both channels with the same trigger
+             * 
+             * @tparam Trigger Trigger type
+             * 
+             * @param trigger Trigger
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template <typename Trigger>
+            static void Init(Trigger trigger);
+
+            /**
+             * @brief Enable both channels
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Enable();
+
+            /**
+             * @brief Disable both channels
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Disable();
+
+            /**
+             * @brief Write 12-bit right-aligned data to both channels
+             * 
+             * @param channel1 Channel 1 data
+             * @param channel2 Channel 2 data
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Write(uint16_t channel1, uint16_t channel2);
+
+            /**
+             * @brief Pack data of both channels to one sample
+             * 
+             * @param channel1 Channel 1 data
+             * @param channel2 Channel 2 data
+             * 
+             * @returns Packed sample
+             */
+            static constexpr SampleType Pack(uint16_t channel1, uint16_t channel2)
+            {
+                return (static_cast<SampleType>(channel2) << 16) | channel1;
+            }
+
+            /**
+             * @brief Cause software trigger on both channels
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void CauseSoftwareTrigger();
+
+            /**
+             * @brief Enable DMA request (channel 1 request serves both channels)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableDma();
+
+            /**
+             * @brief Disable DMA request
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableDma();
+
+            /**
+             * @brief Returns DMA target data register (dual 12-bit right-aligned)
+             * 
+             * @returns Data register address
+             */
+            static volatile void* DataRegister();
         };
 #if defined (DAC1)
         IO_STRUCT_WRAPPER(DAC1, Dac1Regs, DAC_TypeDef);
@@ -183,6 +332,7 @@ namespace Zhele
 #if defined (DAC1)
     using Dac1Channel1 = Private::DacBase<Private::Dac1Regs, Clock::DacClock, 0>;
     using Dac1Channel2 = Private::DacBase<Private::Dac1Regs, Clock::DacClock, 1>;
+    using Dac1Dual = Private::DacDual<Private::Dac1Regs, Clock::DacClock>;
 #endif
 
 } // namespace Zhele
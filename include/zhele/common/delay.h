@@ -0,0 +1,120 @@
+/**
+ * @file
+ * Implements delays and cycle counter
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DELAY_COMMON_H
+#define ZHELE_DELAY_COMMON_H
+
+#include <stdint.h>
+
+#if (__CORTEX_M >= 3)
+    #define ZHELE_DELAY_DWT
+#endif
+
+namespace Zhele
+{
+    /**
+     * @brief Core cycle counter
+     * 
+     * @details
+     * Cortex-M3/M4 cores use DWT cycle counter (32 bit).
+     * Cortex-M0/M0+ cores have no DWT, so SysTick counter is used: it's started free-running
+     * if it's not enabled yet, otherwise its current configuration is used (so measured interval
+     * must be less than SysTick period).
+     * 
+     * @par Example
+     * @code
+     *  uint32_t cycles = CycleCounter::Measure([]() { Filter(samples); });
+     * @endcode
+     */
+    class CycleCounter
+    {
+    public:
+        /**
+         * @brief Enable counter (if it's not enabled)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Enable();
+
+        /**
+         * @brief Returns current counter value
+         * 
+         * @details
+         * Use Elapsed to get difference between two values.
+         * 
+         * @returns Counter value
+         */
+        static uint32_t Read();
+
+        /**
+         * @brief Returns cycles count between two counter values
+         * 
+         * @param [in] start Start counter value
+         * @param [in] end End counter value
+         * 
+         * @returns Core cycles count
+         */
+        static uint32_t Elapsed(uint32_t start, uint32_t end);
+
+        /**
+         * @brief Measure function execution time
+         * 
+         * @param [in] function Function (lambda)
+         * 
+         * @returns Core cycles count
+         */
+        template<typename _Function>
+        static uint32_t Measure(_Function&& function);
+    };
+
+    namespace Private
+    {
+        /**
+         * @brief Busy wait given core cycles count
+         * 
+         * @param [in] cycles Core cycles count
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        void DelayCycles(uint32_t cycles);
+    }
+
+    /**
+     * @brief Microseconds delay
+     * 
+     * @tparam us Delay in microseconds
+     * @tparam CpuFreq Core clock frequency
+     * 
+     * @par Returns
+     *  Nothing
+     */
+    template<unsigned long us, unsigned long CpuFreq = F_CPU>
+    void delay_us();
+
+    /**
+     * @brief Nanoseconds delay
+     * 
+     * @details
+     * Resolution is one core cycle, call overhead is several cycles.
+     * 
+     * @tparam ns Delay in nanoseconds
+     * @tparam CpuFreq Core clock frequency
+     * 
+     * @par Returns
+     *  Nothing
+     */
+    template<unsigned long ns, unsigned long CpuFreq = F_CPU>
+    void delay_ns();
+}
+
+#include "impl/delay.h"
+
+#endif //! ZHELE_DELAY_COMMON_H
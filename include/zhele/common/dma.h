@@ -13,10 +13,14 @@
 #include "./template_utils/data_transfer.h"
 #include "./macro_utils/enum.h"
 #include "ioreg.h"
+#include "profiling.h"
+#include "statistics.h"
 
 #include <zhele/clock.h>
+#include <zhele/containers/ring_buffer.h>
 
 #include <stddef.h>
+#include <string.h>
 
 #define COMMA ,
 
@@ -96,6 +100,14 @@ namespace Zhele
 			Periph2Mem = 0,
 			Mem2Periph = DMA_SxCR_DIR_0,
 			Mem2Mem = DMA_SxCR_DIR_1,
+
+			PeriphFlowControl = DMA_SxCR_PFCTRL, ///< Peripheral controls transfer length (SDIO)
+			MemBurst4 = DMA_SxCR_MBURST_0, ///< Memory burst of 4 beats (requires FIFO)
+			MemBurst8 = DMA_SxCR_MBURST_1, ///< Memory burst of 8 beats (requires FIFO)
+			MemBurst16 = DMA_SxCR_MBURST_1 | DMA_SxCR_MBURST_0, ///< Memory burst of 16 beats (requires FIFO)
+			PeriphBurst4 = DMA_SxCR_PBURST_0, ///< Peripheral burst of 4 beats (requires FIFO)
+			PeriphBurst8 = DMA_SxCR_PBURST_1, ///< Peripheral burst of 8 beats (requires FIFO)
+			PeriphBurst16 = DMA_SxCR_PBURST_1 | DMA_SxCR_PBURST_0, ///< Peripheral burst of 16 beats (requires FIFO)
 			
 			TransferErrorInterrupt = DMA_SxCR_TEIE,
 			HalfTransferInterrupt = DMA_SxCR_HTIE,
@@ -103,6 +115,19 @@ namespace Zhele
             DirectModeErrorInterrupt = DMA_SxCR_DMEIE,
         #endif
         };
+
+    #if defined (DMA_SxCR_EN)
+        /**
+         * @brief Stream FIFO threshold (FIFO size is 4 words)
+         */
+        enum class FifoThreshold : uint8_t
+        {
+            Quarter = 0, ///< 1 word
+            Half = DMA_SxFCR_FTH_0, ///< 2 words
+            ThreeQuarters = DMA_SxFCR_FTH_1, ///< 3 words
+            Full = DMA_SxFCR_FTH_1 | DMA_SxFCR_FTH_0, ///< 4 words
+        };
+    #endif
     };
 
     /**
@@ -110,6 +135,61 @@ namespace Zhele
      */
     DECLARE_ENUM_OPERATIONS(DmaBase::Mode)
 
+#if defined (DMA_SxCR_EN)
+    /**
+     * @brief Stream FIFO and burst configuration (validated at compile time)
+     * 
+     * @details
+     * Burst of memory (or peripheral) port must fit FIFO threshold: threshold level in bytes
+     * must be multiple of burst size in bytes (beats * data width), so, for example,
+     * 16 beats are allowed for bytes with full threshold only, 4 beats of words require full threshold
+     * and 8 or 16 beats of words are impossible. Peripheral burst must not exceed FIFO.
+     * 
+     * Burst must not cross 1 KB address boundary, so buffer address should be aligned to burst size.
+     * In peripheral controlled flow and with incremented peripheral address transfer size
+     * should be multiple of burst.
+     * 
+     * @par Example
+     * @code
+     *  // Memory to memory copy by 16-byte bursts of words
+     *  using Fifo = DmaFifo<DmaBase::FifoThreshold::Full, 4, 4>;
+     *  Dma2Stream0::Transfer<Fifo>(Dma2Stream0::Mem2Mem | Dma2Stream0::MemIncrement | Dma2Stream0::PeriphIncrement, dst, src, size / 4);
+     * @endcode
+     * 
+     * @tparam _Threshold FIFO threshold
+     * @tparam _MemWidth Memory data width in bytes (1, 2 or 4)
+     * @tparam _MemBurst Memory burst beats (1 - single, 4, 8 or 16)
+     * @tparam _PeriphWidth Peripheral data width in bytes (1, 2 or 4)
+     * @tparam _PeriphBurst Peripheral burst beats (1 - single, 4, 8 or 16)
+     */
+    template<DmaBase::FifoThreshold _Threshold, unsigned _MemWidth, unsigned _MemBurst = 1, unsigned _PeriphWidth = _MemWidth, unsigned _PeriphBurst = 1>
+    class DmaFifo
+    {
+        static constexpr bool IsWidth(unsigned width) { return width == 1 || width == 2 || width == 4; }
+        static constexpr bool IsBurst(unsigned beats) { return beats == 1 || beats == 4 || beats == 8 || beats == 16; }
+        static constexpr uint32_t WidthCode(unsigned width) { return width == 1 ? 0 : (width == 2 ? 1 : 2); }
+        static constexpr uint32_t BurstCode(unsigned beats) { return beats == 1 ? 0 : (beats == 4 ? 1 : (beats == 8 ? 2 : 3)); }
+
+        static constexpr unsigned ThresholdBytes = (static_cast<unsigned>(_Threshold) + 1) * 4;
+
+        static_assert(IsWidth(_MemWidth) && IsWidth(_PeriphWidth), "Data width must be 1, 2 or 4 bytes");
+        static_assert(IsBurst(_MemBurst) && IsBurst(_PeriphBurst), "Burst must be 1 (single), 4, 8 or 16 beats");
+        static_assert(_MemBurst == 1 || ThresholdBytes % (_MemBurst * _MemWidth) == 0,
+            "Memory burst size is not allowed with this FIFO threshold (threshold must be multiple of burst)");
+        static_assert(_PeriphBurst == 1 || _PeriphBurst * _PeriphWidth <= 16, "Peripheral burst exceeds FIFO size");
+    public:
+        /// Stream control register bits (data sizes and bursts)
+        static constexpr uint32_t Control = (WidthCode(_MemWidth) << DMA_SxCR_MSIZE_Pos) | (BurstCode(_MemBurst) << DMA_SxCR_MBURST_Pos)
+            | (WidthCode(_PeriphWidth) << DMA_SxCR_PSIZE_Pos) | (BurstCode(_PeriphBurst) << DMA_SxCR_PBURST_Pos);
+
+        /// Stream control register bits which are defined by configuration
+        static constexpr uint32_t ControlMask = DMA_SxCR_MSIZE | DMA_SxCR_MBURST | DMA_SxCR_PSIZE | DMA_SxCR_PBURST;
+
+        /// FIFO control register value
+        static constexpr uint32_t FifoControl = DMA_SxFCR_DMDIS | static_cast<uint32_t>(_Threshold);
+    };
+#endif
+
     /**
      * @brief DMA channel data
      */
@@ -123,14 +203,22 @@ namespace Zhele
          */
         DmaChannelData()
             :transferCallback(nullptr),
+            halfTransferCallback(nullptr),
+            doubleBufferedCallback(nullptr),
             data(nullptr),
-            size(0)
+            secondData(nullptr),
+            size(0),
+            doubleBuffered(false)
         {}
 
         TransferCallback transferCallback; ///< Transfer complete/error callback pointer
+        TransferCallback halfTransferCallback; ///< Half transfer callback pointer
+        DoubleBufferedTransferCallback doubleBufferedCallback; ///< Double buffered transfer callback pointer
 
         void *data;	///< Data buffer
+        void *secondData; ///< Second data buffer (double buffered mode only)
         uint16_t size; ///< Data buffer size
+        bool doubleBuffered; ///< Double buffered mode is active
 
         /**
          * @brief Transfer complete handler. Call user`s callback if it has been set.
@@ -147,6 +235,27 @@ namespace Zhele
          *	Nothing
          */
         inline void NotifyError();
+
+        /**
+         * @brief Half transfer handler. Call user`s callback if it has been set.
+         * 
+         * @details
+         * Callback accepts data buffer and size of its first (completed) half.
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        inline void NotifyHalfTransfer();
+
+        /**
+         * @brief Double buffered transfer handler. Call user`s callback if it has been set.
+         * 
+         * @param [in] bufferIndex Index of completed buffer (0 or 1)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        inline void NotifyBufferComplete(unsigned bufferIndex);
     };
 
     /**
@@ -166,6 +275,10 @@ namespace Zhele
         using Module = _Module;
         using DmaBase::Mode;
         static constexpr unsigned Channel = _Channel;
+        static constexpr IRQn_Type IRQNumber = _IRQNumber;
+
+        /// Runtime counters (completions and errors are counted by interrupt handler), enabled by ZHELE_STATISTICS
+        using Counters = Statistics::Counters<Statistics::DmaCounters, DmaChannel>;
 
         /**
          * @brief Initialize DMA channel and start transfer
@@ -181,6 +294,86 @@ namespace Zhele
         static void Transfer(Mode mode, const void* buffer, volatile void* periph, uint32_t bufferSize
         ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t channel = 0));
 
+        /**
+         * @brief Initialize DMA channel and start double buffered (ping-pong) transfer
+         * 
+         * @details
+         * DMA fills (or sends) buffers alternately without stop, so CPU can process one buffer
+         * while DMA works with another. Streams (DMA_SxCR) use hardware double buffer mode (DBM, M1AR).
+         * Channels (DMA_CCR) emulate it with circular transfer and half/complete interrupts,
+         * so on these MCUs buffer1 must directly follow buffer0 in memory
+         * (for example, two halves of one array).
+         * 
+         * @param [in] mode Channel mode (support logic operations, OR ("||") for example)
+         * @param [in] buffer0 First memory buffer
+         * @param [in] buffer1 Second memory buffer
+         * @param [in] periph Peripheral address
+         * @param [in] bufferSize Size of one buffer (count of transfers)
+         * @param [in] channel Channel (for DMA with streams)
+         * 
+         * @note Completed buffers are reported by callback set with SetDoubleBufferedTransferCallback,
+         * transfer errors are reported by callback set with SetTransferCallback.
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void TransferDoubleBuffered(Mode mode, void* buffer0, void* buffer1, volatile void* periph, uint32_t bufferSize
+        ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t channel = 0));
+
+    #if defined (DMA_SxCR_EN)
+        /**
+         * @brief Enables (or disables) stream FIFO
+         * 
+         * @details
+         * FIFO threshold is full FIFO (4 words), so it's suitable for bursts of 4 words.
+         * Without FIFO stream works in direct mode. Call it before @ref Transfer (when stream is disabled).
+         * 
+         * @param [in] enabled FIFO mode flag
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void SetFifoMode(bool enabled);
+
+        /**
+         * @brief Initialize DMA stream with FIFO and bursts and start transfer
+         * 
+         * @details
+         * Data sizes and bursts of @p mode are replaced with FIFO configuration ones.
+         * FIFO stays enabled for next transfers, disable it by @ref SetFifoMode.
+         * 
+         * @tparam _Fifo FIFO configuration (@ref DmaFifo)
+         * 
+         * @param [in] mode Channel mode (support logic operations, OR ("||") for example)
+         * @param [in] buffer Memory buffer
+         * @param [in] periph Peripheral address (or second memory buffer in Mem2Mem case)
+         * @param [in] bufferSize Memory buffer size (count of peripheral data items)
+         * @param [in] channel Channel
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        template<typename _Fifo>
+        static void Transfer(Mode mode, const void* buffer, volatile void* periph, uint32_t bufferSize, uint8_t channel = 0);
+    #endif
+
+        /**
+         * @brief Returns index of buffer that DMA currently works with (double buffered mode)
+         * 
+         * @returns Current buffer index (0 or 1)
+         */
+        static unsigned CurrentBuffer();
+
+        /**
+         * @brief Set double buffered transfer callback function
+         * 
+         * @par [in] callback Pointer to callback function
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void SetDoubleBufferedTransferCallback(DoubleBufferedTransferCallback callback);
+
         /**
          * @brief Set transfer callback function 
          * 
@@ -191,6 +384,20 @@ namespace Zhele
          */
         static void SetTransferCallback(TransferCallback callback);
 
+        /**
+         * @brief Set half transfer callback function
+         * 
+         * @details
+         * If callback is set, next transfers enable half transfer interrupt,
+         * so circular transfers may be processed entirely in interrupts.
+         * 
+         * @par [in] callback Pointer to callback function (nullptr to disable)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void SetHalfTransferCallback(TransferCallback callback);
+
         /**
          * @brief Check that DMA ready to transfer data
          * 
@@ -329,6 +536,46 @@ namespace Zhele
          *	Nothing
          */
         static void IrqHandler();
+
+        /**
+         * @brief DMA channel IRQ handler with compile-time transfer callbacks
+         * 
+         * @details
+         * Transfer complete/error (and half transfer if given) are reported to given callbacks by direct call,
+         * so they are inlined into ISR. Runtime callbacks (passed to @ref Transfer or @ref SetTransferCallback)
+         * are ignored, double buffered callback still works.
+         * 
+         * @par Example
+         * @code
+         *  void OnSent(void* data, unsigned size, bool success);
+         *  ZHELE_IRQ_HANDLER(DMA1_Channel4, DmaCallback<Dma1Channel4, OnSent>);
+         * @endcode
+         * 
+         * @tparam _Callback Transfer complete/error callback
+         * @tparam _HalfCallback Half transfer callback (nullptr to use runtime one)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        template<TransferCallback _Callback, TransferCallback _HalfCallback = nullptr>
+        static void IrqHandler();
+
+    private:
+        template<TransferCallback _Callback, TransferCallback _HalfCallback>
+        static void HandleInterrupt();
+    };
+
+    /**
+     * @brief DMA channel handler with compile-time callbacks (for ZHELE_IRQ_HANDLER)
+     * 
+     * @tparam _DmaChannel DMA channel
+     * @tparam _Callback Transfer complete/error callback
+     * @tparam _HalfCallback Half transfer callback (nullptr to use runtime one)
+     */
+    template<typename _DmaChannel, TransferCallback _Callback, TransferCallback _HalfCallback = nullptr>
+    struct DmaCallback
+    {
+        static void IrqHandler() { _DmaChannel::template IrqHandler<_Callback, _HalfCallback>(); }
     };
 
     /**
@@ -533,8 +780,266 @@ namespace Zhele
     #endif
     };
 
+    /**
+     * @brief DMA transfer descriptor (one item of transfer queue)
+     */
+    struct DmaTransferDescriptor
+    {
+        DmaBase::Mode mode; ///< Channel mode
+        const void* buffer; ///< Memory buffer
+        volatile void* periph; ///< Peripheral address (or second memory buffer in Mem2Mem case)
+        uint32_t size; ///< Memory buffer size
+        TransferCallback callback; ///< Transfer complete/error callback pointer (may be nullptr)
+    };
+
+    /**
+     * @brief Implements DMA transfer queue.
+     * 
+     * @details
+     * Queue holds transfer descriptors for one DMA channel. When current transfer completes,
+     * next queued transfer is started directly from channel IRQ handler (without application round-trip),
+     * and only then callback of completed transfer is called.
+     * 
+     * @note Queue owns channel transfer callback, so do not call SetTransferCallback
+     * for this channel while queue is used. Channel IRQ handler should call DmaChannel::IrqHandler as usual.
+     * 
+     * @tparam _DmaChannel DMA channel (or stream channel)
+     * @tparam _Depth Queue depth (count of transfers that can wait for channel)
+     */
+    template<typename _DmaChannel, unsigned _Depth = 8>
+    class DmaTransferQueue
+    {
+        static Containers::RingBuffer<_Depth, DmaTransferDescriptor> _queue;
+        static TransferCallback _activeCallback;
+        static volatile bool _busy;
+    public:
+        using Channel = _DmaChannel;
+        using Mode = DmaBase::Mode;
+        static constexpr unsigned Depth = _Depth;
+
+        /**
+         * @brief Add transfer to queue (or start it immediately if channel is idle)
+         * 
+         * @param [in] mode Channel mode (support logic operations, OR ("||") for example)
+         * @param [in] buffer Memory buffer
+         * @param [in] periph Peripheral address (or second memory buffer in Mem2Mem case)
+         * @param [in] bufferSize Memory buffer size
+         * @param [in] callback Transfer complete/error callback (optional parameter)
+         * 
+         * @retval true Transfer was started or queued
+         * @retval false Queue is full, transfer was rejected
+         */
+        static bool Enqueue(Mode mode, const void* buffer, volatile void* periph, uint32_t bufferSize, TransferCallback callback = nullptr);
+
+        /**
+         * @brief Check that queue has active transfer
+         * 
+         * @retval true Channel transfers queued data
+         * @retval false Channel is idle
+         */
+        static bool Busy();
+
+        /**
+         * @brief Returns count of transfers waiting for channel (without active transfer)
+         * 
+         * @returns Pending transfers count
+         */
+        static unsigned Pending();
+
+        /**
+         * @brief Drop all pending transfers (active transfer is not affected)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Clear();
+
+    private:
+        /**
+         * @brief Start transfer by descriptor
+         * 
+         * @param [in] descriptor Transfer descriptor
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Start(const DmaTransferDescriptor& descriptor);
+
+        /**
+         * @brief Channel transfer callback. Starts next transfer and notify user about completed one.
+         * 
+         * @param [in] data Completed transfer buffer
+         * @param [in] size Completed transfer size
+         * @param [in] success Transfer result
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void TransferHandler(void* data, unsigned size, bool success);
+    };
+
+    /**
+     * @brief Implements DMA-accelerated memcpy/memset.
+     * 
+     * @details
+     * Copy and fill operations uses Mem2Mem mode of given channel. Data size (8, 16 or 32 bits)
+     * is selected automatically by buffers alignment and size. Operations smaller than
+     * sync threshold are performed by CPU immediately (DMA setup costs more than CPU copy).
+     * Operations larger than channel counter limit are split into several transfers
+     * which are chained from channel IRQ handler.
+     * 
+     * @note Memcpy owns channel transfer callback, so do not call SetTransferCallback
+     * for this channel while memcpy is used. Channel IRQ handler should call DmaChannel::IrqHandler as usual.
+     * @note Only DMA2 is able to perform memory-to-memory transfers on F4 series.
+     * 
+     * @tparam _DmaChannel DMA channel (or stream)
+     * @tparam _SyncThreshold Operations with size (in bytes) less than threshold are performed by CPU
+     */
+    template<typename _DmaChannel, unsigned _SyncThreshold = 32>
+    class DmaMemcpy
+    {
+        static TransferCallback _callback;
+        static void* _destination;
+        static uint32_t _size;
+        static uint8_t* _nextDestination;
+        static const uint8_t* _nextSource;
+        static uint32_t _remaining;
+        static unsigned _dataWidth;
+        static DmaBase::Mode _mode;
+        static uint32_t _pattern;
+        static volatile bool _busy;
+    public:
+        using Channel = _DmaChannel;
+        using Mode = DmaBase::Mode;
+        static constexpr unsigned SyncThreshold = _SyncThreshold;
+
+        /**
+         * @brief Copy memory block
+         * 
+         * @details
+         * Waits for previous operation and starts copying.
+         * 
+         * @param [in] destination Destination buffer
+         * @param [in] source Source buffer
+         * @param [in] size Size in bytes
+         * @param [in] callback Operation complete callback (optional parameter).
+         * Callback accepts destination buffer and size in bytes.
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Copy(void* destination, const void* source, uint32_t size, TransferCallback callback = nullptr);
+
+        /**
+         * @brief Fill memory block with byte pattern
+         * 
+         * @details
+         * Waits for previous operation and starts filling (source address is not incremented).
+         * 
+         * @param [in] destination Destination buffer
+         * @param [in] pattern Fill value
+         * @param [in] size Size in bytes
+         * @param [in] callback Operation complete callback (optional parameter).
+         * Callback accepts destination buffer and size in bytes.
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Fill(void* destination, uint8_t pattern, uint32_t size, TransferCallback callback = nullptr);
+
+        /**
+         * @brief Check that operation is in progress
+         * 
+         * @retval true Operation is in progress
+         * @retval false Memcpy is idle
+         */
+        static bool Busy();
+
+        /**
+         * @brief Wait for operation complete
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Wait();
+
+    private:
+        /**
+         * @brief Returns max data width (1, 2 or 4 bytes) suitable for given addresses and size
+         * 
+         * @param [in] destination Destination address
+         * @param [in] source Source address
+         * @param [in] size Size in bytes
+         * 
+         * @returns Data width in bytes
+         */
+        static unsigned SelectDataWidth(uintptr_t destination, uintptr_t source, uint32_t size);
+
+        /**
+         * @brief Start DMA operation
+         * 
+         * @param [in] destination Destination buffer
+         * @param [in] source Source buffer
+         * @param [in] size Size in bytes
+         * @param [in] sourceIncrement Source is buffer (not single value)
+         * @param [in] callback Operation complete callback
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Start(void* destination, const void* source, uint32_t size, bool sourceIncrement, TransferCallback callback);
+
+        /**
+         * @brief Start next transfer of operation
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void StartChunk();
+
+        /**
+         * @brief Channel transfer callback. Starts next transfer or notify user about completed operation.
+         * 
+         * @param [in] data Completed transfer buffer
+         * @param [in] size Completed transfer size (in data items)
+         * @param [in] success Transfer result
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void TransferHandler(void* data, unsigned size, bool success);
+    };
+
     template<typename _Module, typename _ChannelRegs, unsigned _Channel, IRQn_Type _IRQnumber>
     DmaChannelData DmaChannel<_Module, _ChannelRegs, _Channel, _IRQnumber>::Data;
+
+    template<typename _DmaChannel, unsigned _Depth>
+    Containers::RingBuffer<_Depth, DmaTransferDescriptor> DmaTransferQueue<_DmaChannel, _Depth>::_queue;
+    template<typename _DmaChannel, unsigned _Depth>
+    TransferCallback DmaTransferQueue<_DmaChannel, _Depth>::_activeCallback = nullptr;
+    template<typename _DmaChannel, unsigned _Depth>
+    volatile bool DmaTransferQueue<_DmaChannel, _Depth>::_busy = false;
+
+    template<typename _DmaChannel, unsigned _SyncThreshold>
+    TransferCallback DmaMemcpy<_DmaChannel, _SyncThreshold>::_callback = nullptr;
+    template<typename _DmaChannel, unsigned _SyncThreshold>
+    void* DmaMemcpy<_DmaChannel, _SyncThreshold>::_destination = nullptr;
+    template<typename _DmaChannel, unsigned _SyncThreshold>
+    uint32_t DmaMemcpy<_DmaChannel, _SyncThreshold>::_size = 0;
+    template<typename _DmaChannel, unsigned _SyncThreshold>
+    uint8_t* DmaMemcpy<_DmaChannel, _SyncThreshold>::_nextDestination = nullptr;
+    template<typename _DmaChannel, unsigned _SyncThreshold>
+    const uint8_t* DmaMemcpy<_DmaChannel, _SyncThreshold>::_nextSource = nullptr;
+    template<typename _DmaChannel, unsigned _SyncThreshold>
+    uint32_t DmaMemcpy<_DmaChannel, _SyncThreshold>::_remaining = 0;
+    template<typename _DmaChannel, unsigned _SyncThreshold>
+    unsigned DmaMemcpy<_DmaChannel, _SyncThreshold>::_dataWidth = 1;
+    template<typename _DmaChannel, unsigned _SyncThreshold>
+    DmaBase::Mode DmaMemcpy<_DmaChannel, _SyncThreshold>::_mode = DmaBase::Mem2Mem;
+    template<typename _DmaChannel, unsigned _SyncThreshold>
+    uint32_t DmaMemcpy<_DmaChannel, _SyncThreshold>::_pattern = 0;
+    template<typename _DmaChannel, unsigned _SyncThreshold>
+    volatile bool DmaMemcpy<_DmaChannel, _SyncThreshold>::_busy = false;
 }
 
 #include "impl/dma.h"
@@ -0,0 +1,185 @@
+/**
+ * @file
+ * Implements DMA2D (Chrom-ART accelerator)
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMA2D_COMMON_H
+#define ZHELE_DMA2D_COMMON_H
+
+#include <zhele/clock.h>
+
+#include <cstdint>
+
+#if !defined (ZHELE_DMA2D_THRESHOLD)
+    /// Framebuffer operations smaller than threshold (in pixels) are done by CPU (DMA2D setup takes longer)
+    #define ZHELE_DMA2D_THRESHOLD 64
+#endif
+
+namespace Zhele
+{
+    /**
+     * @brief Implements DMA2D (Chrom-ART accelerator)
+     *
+     * @details
+     * Operations transfer rectangles: stride is line length of buffer (in pixels), so rectangle
+     * can be part of bigger framebuffer. Operation is started and method returns without waiting,
+     * use @ref Wait before access to destination (next operation waits for previous one itself).
+     *
+     * @par Example
+     * @code
+     *  Dma2d::Init();
+     *  Dma2d::Fill(frame + 10 * 320 + 10, 320, 100, 50, 0xf800);
+     *  Dma2d::Convert(image, Dma2d::InputColorMode::Argb8888, 64, frame + 20 * 320, Dma2d::ColorMode::Rgb565, 320, 64, 64);
+     *  Dma2d::Wait();
+     * @endcode
+     */
+    class Dma2d
+    {
+    public:
+        /// Output color mode
+        enum class ColorMode : uint8_t
+        {
+            Argb8888 = 0b000, ///< 32 bit ARGB
+            Rgb888 = 0b001, ///< 24 bit RGB
+            Rgb565 = 0b010, ///< 16 bit RGB
+            Argb1555 = 0b011, ///< 16 bit ARGB (1 bit alpha)
+            Argb4444 = 0b100, ///< 16 bit ARGB (4 bit alpha)
+        };
+
+        /// Input (foreground and background) color mode
+        enum class InputColorMode : uint8_t
+        {
+            Argb8888 = 0b0000, ///< 32 bit ARGB
+            Rgb888 = 0b0001, ///< 24 bit RGB
+            Rgb565 = 0b0010, ///< 16 bit RGB
+            Argb1555 = 0b0011, ///< 16 bit ARGB (1 bit alpha)
+            Argb4444 = 0b0100, ///< 16 bit ARGB (4 bit alpha)
+            A8 = 0b1001, ///< 8 bit alpha (color is given by @ref Blend parameter)
+            A4 = 0b1010, ///< 4 bit alpha (color is given by @ref Blend parameter)
+        };
+
+        /**
+         * @brief Enables DMA2D clock
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static inline void Init();
+
+        /**
+         * @brief Fills rectangle by color (register to memory)
+         *
+         * @param [out] destination First pixel of rectangle
+         * @param [in] stride Destination line length (pixels)
+         * @param [in] width Rectangle width
+         * @param [in] height Rectangle height
+         * @param [in] color Color (in output color mode)
+         * @param [in] mode Output color mode
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static inline void Fill(void* destination, uint16_t stride, uint16_t width, uint16_t height, uint32_t color, ColorMode mode = ColorMode::Rgb565);
+
+        /**
+         * @brief Copies rectangle (memory to memory, without pixel format conversion)
+         *
+         * @param [in] source First pixel of source rectangle
+         * @param [in] sourceStride Source line length (pixels)
+         * @param [out] destination First pixel of destination rectangle
+         * @param [in] destinationStride Destination line length (pixels)
+         * @param [in] width Rectangle width
+         * @param [in] height Rectangle height
+         * @param [in] mode Color mode (pixel size)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static inline void Copy(const void* source, uint16_t sourceStride, void* destination, uint16_t destinationStride, uint16_t width, uint16_t height, ColorMode mode = ColorMode::Rgb565);
+
+        /**
+         * @brief Copies rectangle with pixel format conversion
+         *
+         * @param [in] source First pixel of source rectangle
+         * @param [in] sourceMode Source color mode
+         * @param [in] sourceStride Source line length (pixels)
+         * @param [out] destination First pixel of destination rectangle
+         * @param [in] destinationMode Destination color mode
+         * @param [in] destinationStride Destination line length (pixels)
+         * @param [in] width Rectangle width
+         * @param [in] height Rectangle height
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static inline void Convert(const void* source, InputColorMode sourceMode, uint16_t sourceStride,
+            void* destination, ColorMode destinationMode, uint16_t destinationStride, uint16_t width, uint16_t height);
+
+        /**
+         * @brief Blends foreground rectangle with background one
+         *
+         * @details
+         * Foreground alpha is multiplied by given alpha. For A8/A4 foreground color is given by color parameter.
+         * Background and destination can be the same rectangle (draw over framebuffer).
+         *
+         * @param [in] foreground First pixel of foreground rectangle
+         * @param [in] foregroundMode Foreground color mode
+         * @param [in] foregroundStride Foreground line length (pixels)
+         * @param [in] background First pixel of background rectangle
+         * @param [in] backgroundMode Background color mode
+         * @param [in] backgroundStride Background line length (pixels)
+         * @param [out] destination First pixel of destination rectangle
+         * @param [in] destinationMode Destination color mode
+         * @param [in] destinationStride Destination line length (pixels)
+         * @param [in] width Rectangle width
+         * @param [in] height Rectangle height
+         * @param [in] alpha Foreground alpha
+         * @param [in] color Foreground color (RGB888) for A8/A4 modes
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static inline void Blend(const void* foreground, InputColorMode foregroundMode, uint16_t foregroundStride,
+            const void* background, InputColorMode backgroundMode, uint16_t backgroundStride,
+            void* destination, ColorMode destinationMode, uint16_t destinationStride,
+            uint16_t width, uint16_t height, uint8_t alpha = 0xff, uint32_t color = 0);
+
+        /**
+         * @brief Returns operation state
+         *
+         * @retval true Operation is in progress
+         * @retval false DMA2D is idle
+         */
+        static inline bool Busy();
+
+        /**
+         * @brief Waits for operation complete
+         *
+         * @retval true Operation is complete
+         * @retval false Operation fails (transfer or configuration error)
+         */
+        static inline bool Wait();
+
+        static const IRQn_Type IRQNumber = DMA2D_IRQn; ///< DMA2D interrupt
+
+    private:
+        /// Transfer mode
+        enum Mode : uint32_t
+        {
+            MemoryToMemory = 0b00,
+            MemoryToMemoryPfc = 0b01,
+            MemoryToMemoryBlend = 0b10,
+            RegisterToMemory = 0b11,
+        };
+
+        static inline void SetOutput(void* destination, ColorMode mode, uint16_t stride, uint16_t width, uint16_t height);
+        static inline void Start(Mode mode);
+    };
+}
+
+#include "impl/dma2d.h"
+
+#endif //! ZHELE_DMA2D_COMMON_H
@@ -128,6 +128,188 @@ namespace Zhele
             */
             static RequestInput GetRequestInput();
         };
+
+        /**
+         * @brief Implements DMAMUX request generator
+         * 
+         * @details
+         * Generator produces DMA requests on edges of signal input (EXTI line, DMAMUX event or timer output)
+         * without any peripheral request, so DMA channel routed to generator moves data by GPIO edges or timer
+         * events without CPU: for example, GPIO port is captured on every external strobe or memory is copied
+         * to GPIO by timer output compare. Every signal edge generates configured count of requests.
+         * Edge which comes while previous requests are not served yet is overrun.
+         * 
+         * @par Example
+         * @code
+         *  // Capture GPIOA input data register to buffer on every PB3 rising edge
+         *  using Generator = DmaMux1::RequestGenerator<0>;
+         *  Generator::Configure(DmamuxSyncInput::Exti3, Generator::Polarity::Rising);
+         *  Generator::Route<Dma1Channel1>();
+         *  Dma1Channel1::Transfer(Dma1Channel1::Periph2Mem | Dma1Channel1::MemIncrement, buffer, &GPIOA->IDR, size);
+         * @endcode
+         * 
+         * @tparam _GeneratorNumber Generator number (0 - 3)
+        */
+        template<unsigned _GeneratorNumber>
+        class RequestGenerator
+        {
+            static_assert(_GeneratorNumber < 4, "DMAMUX has 4 request generators");
+
+            DECLARE_IO_BITFIELD_WRAPPER(RequestGeneratorRegs::Get()[_GeneratorNumber].RGCR, SignalInputBitfield, DMAMUX_RGxCR_SIG_ID)
+            DECLARE_IO_BITFIELD_WRAPPER(RequestGeneratorRegs::Get()[_GeneratorNumber].RGCR, PolarityBitfield, DMAMUX_RGxCR_GPOL)
+            DECLARE_IO_BITFIELD_WRAPPER(RequestGeneratorRegs::Get()[_GeneratorNumber].RGCR, RequestCountBitfield, DMAMUX_RGxCR_GNBREQ)
+        public:
+            /// Request input of DMAMUX channels connected to generator
+            static constexpr RequestInput Request = static_cast<RequestInput>(_GeneratorNumber + 1);
+
+            /// @brief Signal polarity (active edges)
+            enum class Polarity
+            {
+                None = 0b00,
+                Rising = 0b01,
+                Falling = 0b10,
+                Both = 0b11
+            };
+
+            /**
+             * @brief Configures and enables generator
+             * 
+             * @param [in] signal Signal input
+             * @param [in] polarity Active edges
+             * @param [in] requests DMA requests count per edge (1 - 32)
+             * 
+             * @par Returns
+             *  Nothing
+            */
+            static void Configure(SyncInput signal, Polarity polarity, uint8_t requests = 1);
+
+            /**
+             * @brief Select signal input
+             * 
+             * @param [in] signal Signal input
+             * 
+             * @par Returns
+             *  Nothing
+            */
+            static void SetSignalInput(SyncInput signal);
+
+            /**
+             * @brief Returns current signal input
+             * 
+             * @returns Signal input
+            */
+            static SyncInput GetSignalInput();
+
+            /**
+             * @brief Set signal polarity
+             * 
+             * @param [in] polarity Active edges
+             * 
+             * @par Returns
+             *  Nothing
+            */
+            static void SetPolarity(Polarity polarity);
+
+            /**
+             * @brief Returns current signal polarity
+             * 
+             * @returns Signal polarity
+            */
+            static Polarity GetPolarity();
+
+            /**
+             * @brief Set DMA requests count per signal edge (generator must be disabled)
+             * 
+             * @param [in] requests Requests count (1 - 32)
+             * 
+             * @par Returns
+             *  Nothing
+            */
+            static void SetRequestCount(uint8_t requests);
+
+            /**
+             * @brief Returns DMA requests count per signal edge
+             * 
+             * @returns Requests count
+            */
+            static uint8_t GetRequestCount();
+
+            /**
+             * @brief Enables generator
+             * 
+             * @par Returns
+             *  Nothing
+            */
+            static void Enable();
+
+            /**
+             * @brief Disables generator
+             * 
+             * @par Returns
+             *  Nothing
+            */
+            static void Disable();
+
+            /**
+             * @brief Returns overrun flag (signal edge came while previous requests were not served)
+             * 
+             * @retval true Overrun occured
+             * @retval false No overrun
+            */
+            static bool IsOverrun();
+
+            /**
+             * @brief Clears overrun flag
+             * 
+             * @par Returns
+             *  Nothing
+            */
+            static void ClearOverrun();
+
+            /**
+             * @brief Routes generator requests to DMA channel
+             * 
+             * @tparam _DmaChannel DMA channel
+             * @tparam _MuxChannel DMAMUX channel number (DMA1 channel N is connected to DMAMUX channel N - 1)
+             * 
+             * @par Returns
+             *  Nothing
+            */
+            template<typename _DmaChannel, unsigned _MuxChannel = _DmaChannel::Channel - 1>
+            static void Route();
+        };
+
+        /**
+         * @brief Binding of DMAMUX request to DMA channel
+         * 
+         * @details
+         * Binding is compile-time description of request routing, so it can be checked
+         * with DmaRegistry for conflicts.
+         * 
+         * @tparam _DmaChannel DMA channel
+         * @tparam _Request Request input
+         * @tparam _MuxChannel DMAMUX channel number (DMA1 channel N is connected to DMAMUX channel N - 1)
+        */
+        template<typename _DmaChannel, RequestInput _Request, unsigned _MuxChannel = _DmaChannel::Channel - 1>
+        class Binding
+        {
+        public:
+            using Dma = _DmaChannel;
+            static constexpr RequestInput Request = _Request;
+            static constexpr unsigned MuxChannel = _MuxChannel;
+
+            /**
+             * @brief Route request to DMA channel
+             * 
+             * @par Returns
+             *  Nothing
+            */
+            static void Select()
+            {
+                _DmaChannel::Module::Enable();
+                Channel<_MuxChannel>::SelectRequestInput(_Request);
+            }
+        };
     };
 }
 
@@ -23,6 +23,12 @@ namespace Zhele
     class Exti
     {
     public:
+        /// EXTI line number
+        static constexpr uint8_t Line = _Line;
+
+        /// IRQ number of line (may be shared with other lines)
+        static constexpr IRQn_Type IRQNumber = _IRQn;
+
         enum Trigger
         {
             Rising = 1,
@@ -9,7 +9,24 @@
 #ifndef ZHELE_FLASH_COMMON_H
 #define ZHELE_FLASH_COMMON_H
 
+#include "ioreg.h"
+
 #include <cstdint>
+#include <type_traits>
+
+/**
+ * @def ZHELE_RAMFUNC
+ * @brief Places function to RAM
+ * @details
+ * CPU stalls on flash fetch while flash erase/program is in progress (on single-bank parts),
+ * so code that should run during flash operation (interrupt handlers, wait loops)
+ * must be executed from RAM. Linker script (and startup code) must copy ".RamFunc" section
+ * to RAM (as ".data" section). Vector table should be relocated to RAM too (SCB->VTOR/SRAM remap).
+ * Long call is required because RAM is too far from flash for BL instruction.
+ */
+#if !defined (ZHELE_RAMFUNC)
+    #define ZHELE_RAMFUNC __attribute__((section(".RamFunc"), noinline, long_call))
+#endif
 
 namespace Zhele
 {
@@ -27,6 +44,9 @@ namespace Zhele
         /**
          * @brief Configure flash for target system frequency
          * 
+         * @details
+         * Enables accelerators and sets wait states for frequence (so latency can be decreased too).
+         * 
          * @param frequence Flash frequence
          * 
          * @par Returns
@@ -34,6 +54,98 @@ namespace Zhele
         */
         static void ConfigureFrequence(uint32_t frequence);
 
+        /**
+         * @brief Configures flash latency and accelerators for target system frequence
+         * 
+         * @details
+         * Sets exact wait states count (see @ref ZHELE_FLASH_WAIT_STATE_FREQUENCE) and enables
+         * every available accelerator: prefetch buffer, instruction cache and data cache (F4 ART, L4),
+         * instruction cache (G0). Wait states count is set exactly (it may decrease), so call it
+         * before switching to higher frequence and after switching to lower one.
+         * @ref ClockTree::Configure calls it.
+         * 
+         * @tparam _Frequence Target HCLK frequence
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        template<uint32_t _Frequence>
+        static void OptimiseForFrequency();
+
+        /**
+         * @brief Enables prefetch buffer
+         * 
+         * @details
+         * On F1 prefetch buffer can be switched on/off only while SYSCLK is lower than 24 MHz
+         * and AHB prescaler is 1.
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void EnablePrefetch();
+
+        /**
+         * @brief Disables prefetch buffer
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void DisablePrefetch();
+
+        /**
+         * @brief Enables instruction cache (F4, L4, G0)
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void EnableICache();
+
+        /**
+         * @brief Disables instruction cache (F4, L4, G0)
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void DisableICache();
+
+        /**
+         * @brief Resets (invalidates) instruction cache (F4, L4, G0)
+         * 
+         * @details
+         * Cache is disabled while reset, its state is restored after reset.
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void ResetICache();
+
+        /**
+         * @brief Enables data cache (F4, L4)
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void EnableDCache();
+
+        /**
+         * @brief Disables data cache (F4, L4)
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void DisableDCache();
+
+        /**
+         * @brief Resets (invalidates) data cache (F4, L4)
+         * 
+         * @details
+         * Cache is disabled while reset, its state is restored after reset.
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void ResetDCache();
+
         /**
          * @brief Returns total flash size
          * 
@@ -144,7 +256,197 @@ namespace Zhele
         */
         static bool WriteFlash(void* dst, const void* src, unsigned size);
 
+        /// Async operation completion callback
+        using AsyncCallback = std::add_pointer_t<void(bool success)>;
+
+        /**
+         * @brief Starts flash page erase (non-blocking)
+         * 
+         * @details
+         * Method returns immediately after erase start, completion is signaled by EOP interrupt
+         * (call @ref IrqHandler from FLASH_IRQHandler). CPU stalls on any flash fetch while
+         * erase is in progress, so code and interrupts that should not wait must be placed in RAM
+         * (see @ref ZHELE_RAMFUNC). Don't call sync methods until operation completion.
+         * 
+         * @param [in] page Page number
+         * @param [in] callback Completion callback (it's called from interrupt)
+         * 
+         * @retval true Erase is started
+         * @retval false Invalid page or flash is busy
+        */
+        static bool ErasePageAsync(uint32_t page, AsyncCallback callback = nullptr);
+
+        /**
+         * @brief Starts data writing to flash (non-blocking)
+         * 
+         * @details
+         * Every program unit (half word for F0, double word for G0) is written from EOP interrupt
+         * (call @ref IrqHandler from FLASH_IRQHandler). Source buffer must be valid until completion.
+         * 
+         * @param [in] dst Destination address
+         * @param [in] src Data to write
+         * @param [in] size Data size
+         * @param [in] callback Completion callback (it's called from interrupt)
+         * 
+         * @retval true Write is started
+         * @retval false Flash is busy or write failed
+        */
+        static bool WriteFlashAsync(void* dst, const void* src, unsigned size, AsyncCallback callback = nullptr);
+
+        /**
+         * @brief Returns async operation status
+         * 
+         * @retval true Async operation is in progress
+         * @retval false Flash is ready
+        */
+        static bool IsBusy();
+
+        /**
+         * @brief Flash interrupt handler (it's placed in RAM)
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void IrqHandler();
+
+        /**
+         * @brief Checks flash content by CRC
+         * 
+         * @details
+         * Flash is read by streaming CRC API (Begin/Update/Finish), so written image
+         * can be verified before it's activated.
+         * 
+         * @tparam _Crc CRC unit (for example, @ref Crc)
+         * 
+         * @param [in] address Data address
+         * @param [in] size Data size
+         * @param [in] crc Expected CRC
+         * 
+         * @retval true CRC matches
+         * @retval false CRC doesn't match
+        */
+        template<typename _Crc>
+        static bool Verify(const void* address, unsigned size, uint32_t crc);
+
+    #if defined (ZHELE_FLASH_DUAL_BANK)
+        /**
+         * @brief Flash bank (physical)
+         */
+        enum class Bank : uint8_t
+        {
+            Bank1 = 0, ///< Bank 1
+            Bank2 = 1, ///< Bank 2
+        };
+
+        /**
+         * @brief Checks that flash is organized as two banks (option bytes)
+         * 
+         * @retval true Flash has two banks
+         * @retval false Flash has single bank
+        */
+        static bool IsDualBank();
+
+        /**
+         * @brief Returns bank size
+         * 
+         * @returns Bank size in bytes (flash size for single bank flash)
+        */
+        static uint32_t BankSize();
+
+        /**
+         * @brief Returns bank that is mapped at flash base address (code is executed from it)
+         * 
+         * @returns Active bank
+        */
+        static Bank ActiveBank();
+
+        /**
+         * @brief Returns bank that is mapped after active one
+         * 
+         * @returns Inactive bank
+        */
+        static Bank InactiveBank();
+
+        /**
+         * @brief Returns address where bank is mapped now
+         * 
+         * @details
+         * Firmware image is linked for flash base address, it's written to inactive bank address
+         * and runs from flash base address after @ref SwapBanks.
+         * 
+         * @param [in] bank Bank
+         * 
+         * @returns Bank address
+        */
+        static uint32_t BankAddress(Bank bank);
+
+        /**
+         * @brief Returns bank of address
+         * 
+         * @param [in] address Flash address
+         * 
+         * @returns Physical bank
+        */
+        static Bank AddressToBank(const void* address);
+
+        /**
+         * @brief Erases whole bank
+         * 
+         * @details
+         * Active bank can't be erased (method returns false). Flash is read while other bank
+         * is erased or programmed, so erase and program of inactive bank (sync and async)
+         * don't stall code that runs from active bank.
+         * 
+         * @param [in] bank Bank
+         * 
+         * @retval true Erase success
+         * @retval false Erase failed
+        */
+        static bool EraseBank(Bank bank);
+
+        /**
+         * @brief Starts whole bank erase (non-blocking)
+         * 
+         * @param [in] bank Bank (inactive)
+         * @param [in] callback Completion callback (it's called from interrupt)
+         * 
+         * @retval true Erase is started
+         * @retval false Bank is active or flash is busy
+        */
+        static bool EraseBankAsync(Bank bank, AsyncCallback callback = nullptr);
+
+        /**
+         * @brief Makes inactive bank active (boot bank option bit is toggled)
+         * 
+         * @details
+         * Method programs option bytes and launches their reload, that resets MCU,
+         * so method doesn't return on success. Verify image (see @ref Verify) before swap.
+         * 
+         * @retval false Option bytes programming failed (or flash has single bank)
+        */
+        static bool SwapBanks();
+    #endif
+
     private:
+        /**
+         * @brief Calculates wait states count for HCLK frequence
+         * 
+         * @param [in] frequence HCLK frequence
+         * 
+         * @returns Wait states count
+        */
+        static constexpr uint32_t Latency(uint32_t frequence);
+
+        /**
+         * @brief Sets wait states count
+         * 
+         * @param [in] latency Wait states count
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void SetLatency(uint32_t latency);
+
         /**
          * @brief Block execution while flash busy
          * 
@@ -152,6 +454,47 @@ namespace Zhele
          *  Nothing
         */
         static void WaitWhileBusy();
+
+        /**
+         * @brief Writes next program unit of async write
+         * 
+         * @retval true Unit write is started
+         * @retval false Write failed
+        */
+        static bool ProgramNextAsync();
+
+        /**
+         * @brief Completes async operation
+         * 
+         * @param [in] success Operation result
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void CompleteAsync(bool success);
+
+        /**
+         * @brief Returns page selection bits of control register (page number and bank)
+         * 
+         * @param [in] page Page number
+         * 
+         * @returns CR bits
+        */
+        static uint32_t PageSelection(uint32_t page);
+
+        /// Async operation
+        enum class AsyncOperation : uint8_t
+        {
+            None, ///< There is no operation
+            Erase, ///< Page erase
+            Write ///< Data write
+        };
+
+        static inline volatile AsyncOperation _asyncOperation = AsyncOperation::None; ///< Current async operation
+        static inline uint8_t* _asyncDst = nullptr; ///< Async write destination
+        static inline const uint8_t* _asyncSrc = nullptr; ///< Async write source
+        static inline unsigned _asyncSize = 0; ///< Async write remaining size
+        static inline AsyncCallback _asyncCallback = nullptr; ///< Async operation callback
     };
 }
 
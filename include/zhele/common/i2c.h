@@ -11,13 +11,18 @@
 #define ZHELE_I2C_COMMON_H
 
 #include "macro_utils/enum.h"
+#include "profiling.h"
+#include "statistics.h"
 #include "template_utils/type_list.h"
 
 #include <zhele/clock.h>
 #include <zhele/iopins.h>
 #include <zhele/pinlist.h>
+#include <zhele/system_time.h>
 
+#include <algorithm>
 #include <functional>
+#include <type_traits>
 
 #if defined(I2C_ISR_BUSY)
     #define I2C_TYPE_1
@@ -131,6 +136,17 @@ namespace Zhele
     #endif
     };
     DECLARE_ENUM_OPERATIONS(Events);
+
+#if defined(I2C_TYPE_1)
+    /**
+     * @brief I2C timing (TIMINGR value and achieved SCL frequency)
+     */
+    struct I2cTiming
+    {
+        uint32_t Timing; ///< TIMINGR register value
+        uint32_t Frequency; ///< Achieved SCL frequency (0 if requested frequency is unreachable)
+    };
+#endif
     
     struct ReadResult
     {
@@ -140,6 +156,21 @@ namespace Zhele
 
     using I2cCallback = std::add_pointer_t<void(I2cStatus status)>;
 
+    /**
+     * @brief Slave transaction callback
+     * 
+     * @details
+     * Called once per transaction (on STOP, repeated START or NACK).
+     * Mode is given from master side: Write - master has written registers, Read - master has read registers.
+     * Offset and size are in bytes of slave register file.
+     */
+    /**
+     * @brief Tick source for I2C timeouts (SysTick counter, timer counter and so on)
+     */
+    using I2cTickSource = std::add_pointer_t<uint32_t()>;
+
+    using I2cSlaveCallback = std::add_pointer_t<void(I2cMode mode, uint16_t offset, uint16_t size)>;
+
     namespace Private
     {
         /**
@@ -165,7 +196,8 @@ namespace Zhele
             typename _DmaRx>
         class I2cBase
         {
-            static const uint16_t _timeout = 10000;
+            static const uint16_t _timeout = 10000; ///< Wait iterations count (without system time)
+            static const uint16_t _timeoutMs = 10; ///< Wait timeout (ms)
 
             struct AsyncTransferData
             {
@@ -177,16 +209,44 @@ namespace Zhele
             };
 
             static AsyncTransferData _transferData;
+
+            struct SlaveTransferData
+            {
+                uint8_t* Registers;
+                uint16_t Size;
+                uint16_t Offset;
+                uint16_t Count;
+                uint16_t DmaSize;
+                I2cMode Mode;
+                bool OffsetReceived;
+                I2cSlaveCallback Callback;
+            };
+
+            static SlaveTransferData _slaveData;
+
+            static I2cTickSource _tickSource;
+            static uint32_t _timeoutTicks;
+            static std::add_pointer_t<bool()> _busClear;
+            static uint32_t _clockSpeed;
+        #if defined (I2C_TYPE_2)
+            static bool _dutyCycle2;
+        #endif
         public:
             using SclPins = _SclPins;
             using SdaPins = _SdaPins;
 
             using DmaTx = _DmaTx;
             using DmaRx = _DmaRx;
+
+            /// Runtime error counters, enabled by ZHELE_STATISTICS
+            using Counters = Statistics::Counters<Statistics::I2cCounters, I2cBase>;
             
             /**
              * @brief Initialize I2C
              * 
+             * @details
+             * Timing is recalculated on system clock change (see @ref Clock::ClockChange).
+             * 
              * @param [in] i2cClockSpeed I2C speed
              * @param [in] dutyCycle2 Enable duty cycle 16/9 (not for all MCU)
              * 
@@ -195,6 +255,45 @@ namespace Zhele
              */
         #if defined (I2C_TYPE_1)
             static void Init(uint32_t i2cClockSpeed = 100000U);
+
+            /**
+             * @brief Initialize I2C with TIMINGR value calculated at compile time
+             * 
+             * @details
+             * Fast-mode plus (SCL frequency above 400 kHz) is enabled automatically.
+             * Compilation fails if SCL frequency is unreachable with given kernel clock.
+             * 
+             * @tparam sclFrequency SCL frequency (up to 1 MHz)
+             * @tparam clockFrequency I2C kernel clock frequency
+             * @tparam maxErrorPercent Max allowed relative lag of achieved frequency (SCL never exceeds requested frequency)
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            template<unsigned long sclFrequency, unsigned long clockFrequency, unsigned maxErrorPercent = 10>
+            static void Init();
+
+            /**
+             * @brief Calculate TIMINGR value
+             * 
+             * @details
+             * Timing satisfies I2C specification (min SCL low/high periods, data setup and hold times)
+             * for max rise/fall times of the mode. Achieved SCL frequency does not exceed requested one.
+             * 
+             * @param [in] clockFrequency I2C kernel clock frequency
+             * @param [in] sclFrequency SCL frequency (up to 1 MHz)
+             * 
+             * @returns Timing (with zero frequency if requested SCL frequency is unreachable)
+             */
+            static constexpr I2cTiming CalculateTiming(uint32_t clockFrequency, uint32_t sclFrequency);
+
+            /**
+             * @brief Enable fast-mode plus (20 mA drive for SCL/SDA pins)
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void EnableFastModePlus();
         #endif
         #if defined (I2C_TYPE_2)
             static void Init(uint32_t i2cClockSpeed = 100000U, bool dutyCycle2 = false);
@@ -228,6 +327,10 @@ namespace Zhele
             /**
              * @brief Write data to register async.
              * 
+             * @details
+             * Data is transmitted by DMA, callback is called on completion. Without DMA Tx
+             * channel data is written synchronously and callback is called before return.
+             * 
              * @param [in] devAddr Device address.
              * @param [in] regAddr Register address.
              * @param [in] data Data to write.
@@ -266,6 +369,11 @@ namespace Zhele
             /**
              * @brief Read some bytes async.
              * 
+             * @details
+             * Data is received by DMA, callback is called on completion. Without DMA Rx
+             * channel (and for single byte on F1/F4) data is read synchronously and callback
+             * is called before return.
+             * 
              * @param [in] devAddr Device address.
              * @param [in] regAddr Register address.
              * @param [out] data Output buffer.
@@ -314,6 +422,93 @@ namespace Zhele
              */
             static bool WaitWhileBusy();
             
+            /**
+             * @brief Enable slave mode with register file
+             * 
+             * @details
+             * Slave exposes memory-mapped register file. The first byte written by master
+             * is register offset, next bytes are written to registers starting from this offset.
+             * Master read returns registers starting from last written offset (0xff beyond the end).
+             * Data bytes are transferred by DMA (if I2C has DMA), application is notified
+             * once per transaction. I2C must be initialized (Init) before.
+             * EventIrqHandler (and ErrorIrqHandler) must be called from I2C interrupt handlers.
+             * 
+             * @param [in] address 7-bit own address
+             * @param [in] registers Register file
+             * @param [in] size Register file size (up to 256 bytes)
+             * @param [in] callback Transaction callback
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableSlave(uint8_t address, uint8_t* registers, uint16_t size, I2cSlaveCallback callback = nullptr);
+
+            /**
+             * @brief Disable slave mode
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableSlave();
+
+            /**
+             * @brief Set tick source for timeouts
+             * 
+             * @details
+             * All waits (for event, for bus release) are limited by deadline
+             * instead of fixed iterations count.
+             * 
+             * @param [in] tickSource Tick source (nullptr to use 10 ms @ref SystemTime deadline, or iterations count if system time is not started)
+             * @param [in] timeout Timeout in ticks
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SetTickSource(I2cTickSource tickSource, uint32_t timeout);
+
+        #if defined (I2C_TYPE_1)
+            /**
+             * @brief Enable hardware SCL low timeout
+             * 
+             * @details
+             * If device holds SCL low longer than timeout, ErrorIrqHandler
+             * aborts current transfer (callback gets Timeout status) and recovers bus.
+             * 
+             * @param [in] timeoutUs Timeout in microseconds (up to 4096 * 2048 I2C clock cycles)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableBusTimeout(uint32_t timeoutUs);
+        #endif
+
+            /**
+             * @brief Recover bus: reset I2C and clear bus if SDA is held low
+             * 
+             * @details
+             * Bus clear is available if pins were selected by template SelectPins.
+             * 
+             * @retval true Bus is free
+             * @retval false Bus is still busy
+             */
+            static bool Recover();
+
+            /**
+             * @brief Clear bus: generate up to 9 SCL pulses until SDA is released, then STOP
+             * 
+             * @details
+             * Pins are switched to open-drain outputs for clear and back to alternate function.
+             * I2C should be disabled.
+             * 
+             * @tparam SclPin SCL pin
+             * @tparam SdaPin SDA pin
+             * 
+             * @retval true SDA is released
+             * @retval false SDA is still low
+             */
+            template<typename SclPin, typename SdaPin>
+            static bool ClearBus();
+
             /**
              * @brief Event IRQ handler
              * 
@@ -405,6 +600,17 @@ namespace Zhele
              * @param [in] isLast Is this transfer last
              */
             static void SetTransferSize(uint8_t size, bool isLast = true);
+
+            /**
+             * @brief Write timing and enable I2C
+             * 
+             * @param [in] timing TIMINGR value
+             * @param [in] fastModePlus Enable fast-mode plus
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void ApplyTiming(uint32_t timing, bool fastModePlus);
             #endif
 
             #if defined (I2C_TYPE_2)
@@ -429,6 +635,94 @@ namespace Zhele
             static bool Start();
             #endif
 
+            /**
+             * @brief Completes async operation that was performed synchronously (without DMA)
+             * 
+             * @details
+             * Result is passed to callback like for DMA transfer, so operation is reported as started.
+             * 
+             * @param [in] status Operation status
+             * @param [in] callback Complete (or error) callback
+             * 
+             * @returns Success if callback is given, otherwise operation status
+             */
+            static I2cStatus CompleteSync(I2cStatus status, I2cCallback callback);
+
+            /**
+             * @brief Recalculates timing for new clock frequence (after current transfer)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void ClockChanged();
+
+            /**
+             * @brief Start slave data transfer from/to register file at current offset
+             * 
+             * @param [in] mode Transfer mode (from master side)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void StartSlaveTransfer(I2cMode mode);
+
+            /**
+             * @brief Handle byte received in slave mode (without DMA)
+             * 
+             * @param [in] value Received byte
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SlaveReceive(uint8_t value);
+
+            /**
+             * @brief Returns next byte to transmit in slave mode (without DMA)
+             * 
+             * @returns Register value (0xff beyond the end of register file)
+             */
+            static uint8_t SlaveTransmit();
+
+            /**
+             * @brief Finish slave transaction and notify application
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void FinishSlaveTransfer();
+
+            /**
+             * @brief Enable (or disable) slave data requests: interrupts or DMA
+             * 
+             * @param [in] mode Transfer mode (Idle disables all requests)
+             * @param [in] dma Use DMA requests instead of interrupts
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SetSlaveRequests(I2cMode mode, bool dma);
+
+            /**
+             * @brief Abort current async transfer (if any) with error
+             * 
+             * @param [in] status Error status for callback
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void AbortTransfer(I2cStatus status);
+
+            /**
+             * @brief Wait for condition with timeout
+             * 
+             * @param [in] condition Condition
+             * 
+             * @retval true Condition is satisfied
+             * @retval false Timeout
+             */
+            template<typename Condition>
+            static bool WaitFor(Condition condition);
+
             /**
              * @brief Returns last event (SR register value)
              * 
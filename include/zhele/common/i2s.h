@@ -0,0 +1,210 @@
+/**
+ * @file
+ * Implements I2S (SPI in I2S mode)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_I2S_COMMON_H
+#define ZHELE_I2S_COMMON_H
+
+#include <zhele/clock.h>
+#include <zhele/dma.h>
+#include <zhele/iopins.h>
+#include <zhele/spi.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief I2S clock configuration (PLLI2S and prescaler)
+     */
+    struct I2sTiming
+    {
+        uint16_t Multiplier; ///< PLLI2S multiplier (N)
+        uint8_t OutputDivider; ///< PLLI2S output divider (R)
+        uint16_t Prescaler; ///< I2S prescaler (2 * I2SDIV + ODD), 0 if sample rate is unreachable
+        uint32_t ErrorPpm; ///< Sample rate error (parts per million)
+    };
+
+    /**
+     * @brief Implements I2S master (SPI in I2S mode)
+     *
+     * @details
+     * I2S clock is PLLI2S, it's configured at compile time for requested sample rate
+     * (PLLI2S is shared by I2S peripherals, so they must use the same configuration).
+     * Pins: SD is SPI MOSI pin, CK is SCK pin, WS is NSS pin, master clock (256 * Fs) is
+     * optional pin (PC6 for I2S2, PC7 for I2S3).
+     *
+     * Samples are streamed by circular double-buffered DMA: callback is called from DMA interrupt
+     * when block has been sent (refill it) or received (process it), while DMA works with
+     * another block. Samples are 16-bit words: 24 and 32-bit data is transferred as two words (MSW first).
+     *
+     * @par Example
+     * @code
+     *  using Audio = I2s<Spi2, IO::Pc6>;
+     *  Audio::Init<48000, 1000000>(Audio::Mode::MasterTx);
+     *  Audio::SelectPins<IO::Pb15, IO::Pb13, IO::Pb12>();
+     *  Audio::Stream(samples, 256, Render); // samples has 512 (two blocks) of stereo 16-bit words
+     * @endcode
+     *
+     * @tparam _Spi SPI module (it's DMA channels are used)
+     * @tparam _MckPin Master clock output pin (IO::NullPin if master clock is not used)
+     */
+    template<typename _Spi, typename _MckPin = IO::NullPin>
+    class I2s
+    {
+        using Regs = typename _Spi::Regs;
+        static constexpr bool MasterClockOutput = !std::is_same_v<_MckPin, IO::NullPin>;
+
+    public:
+        /// Mode
+        enum class Mode : uint16_t
+        {
+            MasterTx = SPI_I2SCFGR_I2SCFG_1, ///< Master transmit
+            MasterRx = SPI_I2SCFGR_I2SCFG_1 | SPI_I2SCFGR_I2SCFG_0, ///< Master receive
+        };
+
+        /// Standard
+        enum class Standard : uint16_t
+        {
+            Philips = 0, ///< I2S Philips standard
+            Msb = SPI_I2SCFGR_I2SSTD_0, ///< Left justified
+            Lsb = SPI_I2SCFGR_I2SSTD_1, ///< Right justified
+            PcmShort = SPI_I2SCFGR_I2SSTD_0 | SPI_I2SCFGR_I2SSTD_1, ///< PCM with short frame synchronization
+            PcmLong = SPI_I2SCFGR_I2SSTD_0 | SPI_I2SCFGR_I2SSTD_1 | SPI_I2SCFGR_PCMSYNC, ///< PCM with long frame synchronization
+        };
+
+        /// Data and channel length
+        enum class DataFormat : uint16_t
+        {
+            Data16 = 0, ///< 16-bit data in 16-bit channel
+            Data16Extended = SPI_I2SCFGR_CHLEN, ///< 16-bit data in 32-bit channel
+            Data24 = SPI_I2SCFGR_CHLEN | SPI_I2SCFGR_DATLEN_0, ///< 24-bit data in 32-bit channel
+            Data32 = SPI_I2SCFGR_CHLEN | SPI_I2SCFGR_DATLEN_1, ///< 32-bit data in 32-bit channel
+        };
+
+        /**
+         * @brief Block callback
+         *
+         * @param [in, out] block Block that has been sent (to refill) or received (to process)
+         * @param [in] count Words count in block
+         */
+        using BlockCallback = std::add_pointer_t<void(uint16_t* block, uint32_t count)>;
+
+        /**
+         * @brief Calculates PLLI2S and prescaler for sample rate
+         *
+         * @param [in] pllInputFrequency PLL input frequency (PLL source divided by PLLM)
+         * @param [in] sampleRate Sample rate
+         * @param [in] masterClock Master clock output is enabled
+         * @param [in] longChannel Channel length is 32 bit (it's not used if master clock is enabled)
+         *
+         * @returns Configuration with the least error
+         */
+        static constexpr I2sTiming CalculateTiming(uint32_t pllInputFrequency, uint32_t sampleRate, bool masterClock, bool longChannel);
+
+        /**
+         * @brief Initializes I2S and PLLI2S
+         *
+         * @tparam sampleRate Sample rate (8000, 16000, 44100, 48000, 96000 and so on)
+         * @tparam pllInputFrequency PLL input frequency (PLL source divided by PLLM, 1 or 2 MHz is recommended)
+         * @tparam format Data format
+         * @tparam maxErrorPpm Max sample rate error (parts per million)
+         *
+         * @param [in] mode Mode
+         * @param [in] standard Standard
+         * @param [in] clockPolarityHigh Clock steady state is high
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<uint32_t sampleRate, uint32_t pllInputFrequency, DataFormat format = DataFormat::Data16, uint32_t maxErrorPpm = 1000>
+        static void Init(Mode mode, Standard standard = Standard::Philips, bool clockPolarityHigh = false);
+
+        /**
+         * @brief Selects SD, CK and WS pins (indexes in SPI MOSI, SCK and NSS pin lists)
+         *
+         * @tparam sdPinNumber SD pin index
+         * @tparam ckPinNumber CK pin index
+         * @tparam wsPinNumber WS pin index
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<int8_t sdPinNumber, int8_t ckPinNumber, int8_t wsPinNumber>
+        static void SelectPins();
+
+        /**
+         * @brief Selects SD, CK and WS pins
+         *
+         * @tparam SdPin SD pin
+         * @tparam CkPin CK pin
+         * @tparam WsPin WS pin
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename SdPin, typename CkPin, typename WsPin>
+        static void SelectPins();
+
+        /**
+         * @brief Starts circular double-buffered stream
+         *
+         * @param [in, out] buffer Buffer of two blocks (2 * blockSize words). For transmit both blocks must be filled.
+         * @param [in] blockSize Block size (words)
+         * @param [in] callback Block callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stream(uint16_t* buffer, uint16_t blockSize, BlockCallback callback);
+
+        /**
+         * @brief Stops stream and disables I2S
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+
+        /**
+         * @brief Writes word (blocking)
+         *
+         * @param [in] data Word
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Write(uint16_t data);
+
+        /**
+         * @brief Reads word (blocking)
+         *
+         * @returns Word
+         */
+        static uint16_t Read();
+
+        /**
+         * @brief Returns and clears underrun (transmit) or overrun (receive) flag
+         *
+         * @retval true Samples has been lost
+         * @retval false No errors
+         */
+        static bool DataLost();
+
+    private:
+        static void StreamHandler(void* data, unsigned size, unsigned bufferIndex);
+
+        static Mode _mode;
+        static BlockCallback _callback;
+    };
+}
+
+#include "impl/i2s.h"
+
+#endif //! ZHELE_I2S_COMMON_H
@@ -16,7 +16,10 @@
 #define ADC_TYPE_2
 #endif
 
-#include <zhele/delay.h>
+#include <zhele/system_time.h>
+
+#include <algorithm>
+#include <cstring>
 
 namespace Zhele::Private
 {
@@ -101,6 +104,70 @@ namespace Zhele::Private
 
 #if defined (ADC_TYPE_1)
     
+#endif
+#if defined (ADC_CFGR2_OVSR)
+    #if defined (ADC_CFGR2_ROVSE)
+        #define ADC_CFGR2_REGULAR_OVSE ADC_CFGR2_ROVSE
+    #else
+        #define ADC_CFGR2_REGULAR_OVSE ADC_CFGR2_OVSE
+    #endif
+
+    ADC_TEMPLATE_ARGS
+    template<unsigned ratio, unsigned shift>
+    consteval uint8_t ADC_TEMPLATE_QUALIFIER::OversampledResolution()
+    {
+        static_assert(ratio >= 2 && ratio <= 256 && (ratio & (ratio - 1)) == 0, "Oversampling ratio must be power of 2 from 2 to 256");
+        static_assert(shift <= 8, "Oversampling shift must be from 0 to 8 bits");
+
+        uint8_t ratioBits = 0;
+        for (unsigned value = ratio; value > 1; value >>= 1)
+            ++ratioBits;
+
+        return ResolutionBits + ratioBits - shift;
+    }
+
+    ADC_TEMPLATE_ARGS
+    template<unsigned ratio, unsigned shift>
+    void ADC_TEMPLATE_QUALIFIER::SetOversampling()
+    {
+        constexpr uint8_t resolution = OversampledResolution<ratio, shift>();
+        static_assert(resolution <= 16, "Oversampled result does not fit data register, increase shift");
+
+        // OVSR = log2(ratio) - 1
+        constexpr uint32_t ratioValue = resolution + shift - ResolutionBits - 1;
+
+        _Regs()->CFGR2 = (_Regs()->CFGR2 & ~(ADC_CFGR2_OVSR | ADC_CFGR2_OVSS))
+            | (ratioValue << ADC_CFGR2_OVSR_Pos)
+            | (shift << ADC_CFGR2_OVSS_Pos)
+            | ADC_CFGR2_REGULAR_OVSE;
+    }
+
+#if defined (ADC_CFGR2_JOVSE)
+    ADC_TEMPLATE_ARGS
+    template<unsigned ratio, unsigned shift>
+    void ADC_TEMPLATE_QUALIFIER::SetInjectedOversampling()
+    {
+        constexpr uint8_t resolution = OversampledResolution<ratio, shift>();
+        static_assert(resolution <= 16, "Oversampled result does not fit data register, increase shift");
+
+        constexpr uint32_t ratioValue = resolution + shift - ResolutionBits - 1;
+
+        _Regs()->CFGR2 = (_Regs()->CFGR2 & ~(ADC_CFGR2_OVSR | ADC_CFGR2_OVSS))
+            | (ratioValue << ADC_CFGR2_OVSR_Pos)
+            | (shift << ADC_CFGR2_OVSS_Pos)
+            | ADC_CFGR2_JOVSE;
+    }
+#endif
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::DisableOversampling()
+    {
+    #if defined (ADC_CFGR2_JOVSE)
+        _Regs()->CFGR2 &= ~(ADC_CFGR2_REGULAR_OVSE | ADC_CFGR2_JOVSE);
+    #else
+        _Regs()->CFGR2 &= ~ADC_CFGR2_REGULAR_OVSE;
+    #endif
+    }
 #endif
 #if defined (ADC_TYPE_2)
     ADC_TEMPLATE_ARGS
@@ -148,6 +215,14 @@ namespace Zhele::Private
     ADC_TEMPLATE_ARGS
     template<ADC_TEMPLATE_QUALIFIER::AdcDivider divider, ADC_TEMPLATE_QUALIFIER::ClockSource clockSource>
     void ADC_TEMPLATE_QUALIFIER::Init(ADC_TEMPLATE_QUALIFIER::Reference reference)
+    {
+        InitAsync<divider, clockSource>(reference);
+        WaitReady();
+    }
+
+    ADC_TEMPLATE_ARGS
+    template<ADC_TEMPLATE_QUALIFIER::AdcDivider divider, ADC_TEMPLATE_QUALIFIER::ClockSource clockSource>
+    void ADC_TEMPLATE_QUALIFIER::InitAsync(ADC_TEMPLATE_QUALIFIER::Reference reference)
     {
         _ClockCtrl::Enable();
         SelectClockSource<clockSource>();
@@ -159,21 +234,73 @@ namespace Zhele::Private
         _Regs()->JSQR = 0;
         
         _Regs()->CR1 = ADC_CR1_EOSIE | ADC_CR1_JEOSIE;
-        _Regs()->CR2 = ADC_CR2_ADON | ADC_CR2_EXTSEL | ADC_CR2_EXTTRIG;
+
+        const uint32_t control = ADC_CR2_ADON | ADC_CR2_EXTSEL | ADC_CR2_EXTTRIG;
+        if (!(_Regs()->CR2 & ADC_CR2_ADON))
+        {
+            CycleCounter::Enable();
+            _adcData.powerUpTime = CycleCounter::Read();
+            _adcData.stable = false;
+        }
+        // ADON write to powered ADC starts conversion if other bits are not changed
+        if (_Regs()->CR2 != control)
+            _Regs()->CR2 = control;
+
+        _adcData.vRef = 0;
+        NVIC_EnableIRQ(ADC1_IRQn);
+    }
+
+    ADC_TEMPLATE_ARGS
+    bool ADC_TEMPLATE_QUALIFIER::Ready()
+    {
+        if (!_adcData.stable)
+        {
+            // Power up time (1 us) and two ADC clocks before calibration
+            const uint32_t coreClock = Zhele::Clock::AhbClock::ClockFreq();
+            const uint32_t cycles = coreClock / 1000000 + 2 * (coreClock / ClockFreq()) + 1;
+            _adcData.stable = CycleCounter::Elapsed(_adcData.powerUpTime, CycleCounter::Read()) >= cycles;
+        }
+        return _adcData.stable;
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::WaitReady()
+    {
+        while (!Ready())
+        {
+        }
+
+        if (!_adcData.calibrated)
+            Calibrate();
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::Calibrate()
+    {
         _Regs()->CR2 |= ADC_CR2_RSTCAL;
         while (_Regs()->CR2 & ADC_CR2_RSTCAL)
         {
         }
 
-        delay_ms<100>(); // need delay at least one ADC cycle
-
         _Regs()->CR2 |= ADC_CR2_CAL;
         while (_Regs()->CR2 & ADC_CR2_CAL)
         {
         }
 
-        _adcData.vRef = 0;
-        NVIC_EnableIRQ(ADC1_IRQn);
+        _adcData.calibrated = true;
+    }
+
+    ADC_TEMPLATE_ARGS
+    bool ADC_TEMPLATE_QUALIFIER::Calibrated()
+    {
+        return _adcData.calibrated;
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::Suspend()
+    {
+        _Regs()->CR2 &= ~ADC_CR2_ADON;
+        _adcData.stable = false;
     }
 
     ADC_TEMPLATE_ARGS
@@ -189,13 +316,15 @@ namespace Zhele::Private
         _Regs()->CR1 = 0;
         _Regs()->CR2 = 0;
         _ClockCtrl::Disable();
+        _adcData.stable = false;
+        _adcData.calibrated = false;
     }
 
     ADC_TEMPLATE_ARGS
     template <typename InjectedTrigger, typename TriggerMode>
     void ADC_TEMPLATE_QUALIFIER::SetInjectedTrigger(InjectedTrigger trigger, TriggerMode mode)
     {
-        _Regs()->CR2 = (_Regs()->CR2 & ~(ADC_CR2_JEXTSEL | ADC_CR2_JEXTTRIG)) | ((trigger & 0x07) << ADC_CR2_JEXTSEL_Pos) | (mode << ADC_CR2_JEXTTRIG_Pos);
+        _Regs()->CR2 = (_Regs()->CR2 & ~(ADC_CR2_JEXTSEL | ADC_CR2_JEXTTRIG)) | (static_cast<uint32_t>(trigger) << ADC_CR2_JEXTSEL_Pos) | (static_cast<uint32_t>(mode) << ADC_CR2_JEXTTRIG_Pos);
     }
 
     template <typename Pins, typename _Regs>
@@ -213,14 +342,11 @@ namespace Zhele::Private
 
     static unsigned GetJsqr(const uint8_t *channels, uint8_t count, uint32_t jsqr)
     {
-        jsqr = ((count - 1) << 20) | (channels[0] << 0);
-
-        if (count > 1)
-            jsqr |= (channels[1] << 5);
-        if (count > 2)
-            jsqr |= (channels[2] << 10);
-        if (count > 3)
-            jsqr |= (channels[3] << 15);
+        // Sequence shorter than 4 conversions ends at JSQ4 (JL = 0 converts JSQ4 only)
+        jsqr = (count - 1) << 20;
+        const unsigned first = 4 - count;
+        for (unsigned i = 0; i < count; ++i)
+            jsqr |= channels[i] << ((first + i) * 5);
         return jsqr;
     }
 
@@ -263,6 +389,37 @@ namespace Zhele::Private
         return true;
     }
 
+    ADC_TEMPLATE_ARGS
+    template<typename InjectedTrigger>
+    bool ADC_TEMPLATE_QUALIFIER::StartInjectedTriggered(const uint8_t *channels, uint8_t count, InjectedTrigger trigger, uint16_t *data, AdcCallbackType callback)
+    {
+        if (count == 0 || count > MaxInjected)
+        {
+            _adcData.error = AdcError::ArgumentError;
+            return false;
+        }
+
+        if (!VerifyReady(ADC_SR_JSTRT))
+        {
+            _adcData.error = AdcError::HardwareError;
+            return false;
+        }
+
+        _adcData.injectedCallback = callback;
+        _adcData.injectedData = data;
+
+        for (unsigned i = 0; i < count; i++)
+            EnableChannel<Pins, _Regs>(channels[i]);
+
+        _Regs()->JSQR = GetJsqr(channels, count, _Regs()->JSQR);
+        _Regs()->SR &= ~(ADC_SR_JEOC | ADC_SR_JSTRT);
+        _Regs()->CR1 = (_Regs()->CR1 & ~(ADC_CR1_JDISCEN | ADC_CR1_JAUTO)) | ADC_CR1_SCAN | ADC_CR1_JEOCIE;
+        _Regs()->CR2 = (_Regs()->CR2 & ~ADC_CR2_JEXTSEL) | (static_cast<uint32_t>(trigger) << ADC_CR2_JEXTSEL_Pos) | ADC_CR2_JEXTTRIG;
+
+        _adcData.error = AdcError::NoError;
+        return true;
+    }
+
     ADC_TEMPLATE_ARGS
     bool ADC_TEMPLATE_QUALIFIER::ReadInjected(const uint8_t *channels, uint16_t *data, uint8_t count)
     {
@@ -326,6 +483,8 @@ namespace Zhele::Private
     ADC_TEMPLATE_ARGS
     void ADC_TEMPLATE_QUALIFIER::IrqHandler()
     {
+        ZHELE_PROFILE_ISR();
+
         unsigned sr = _Regs()->SR;
 
         if (sr & ADC_SR_JEOC)
@@ -347,6 +506,12 @@ namespace Zhele::Private
                     _adcData.injectedCallback(data, count);
             }
         }
+        if ((sr & ADC_SR_AWD) && (_Regs()->CR1 & ADC_CR1_AWDIE))
+        {
+            _Regs()->SR &= ~ADC_SR_AWD;
+            if (_adcData.watchdogCallback)
+                _adcData.watchdogCallback();
+        }
         // reset all flags
         _Regs()->SR &= ~(ADC_SR_JEOC | ADC_SR_JSTRT);
         NVIC_ClearPendingIRQ(ADC1_IRQn);
@@ -369,7 +534,7 @@ namespace Zhele::Private
 
         _Regs()->CR1 |= ADC_CR1_DISCEN;
         _Regs()->SR = ~(ADC_SR_JEOC);
-        _Regs()->JSQR = (unsigned)channel;
+        _Regs()->JSQR = (unsigned)channel << 15; // JSQ4 (the only conversion if JL = 0)
 
         EnableChannel<Pins, _Regs>(channel);
 
@@ -411,6 +576,8 @@ namespace Zhele::Private
     ADC_TEMPLATE_ARGS
     void ADC_TEMPLATE_QUALIFIER::StopInjected()
     {
+        // Back to software trigger
+        _Regs()->CR2 |= ADC_CR2_JEXTSEL;
         _Regs()->SR &= ~(ADC_SR_JSTRT | ADC_SR_JEOC);
         _Regs()->JSQR = 0;
     }
@@ -419,7 +586,45 @@ namespace Zhele::Private
     template<typename RegularTrigger, typename TriggerMode>
     void ADC_TEMPLATE_QUALIFIER::SetRegularTrigger(RegularTrigger trigger, TriggerMode mode)
     {
-        _Regs()->CR2 = (_Regs()->CR2 & ~(ADC_CR2_EXTSEL | ADC_CR2_EXTTRIG)) | ((trigger & 0x0f) << ADC_CR2_EXTSEL) | (mode << ADC_CR2_EXTTRIG_Pos);
+        _Regs()->CR2 = (_Regs()->CR2 & ~(ADC_CR2_EXTSEL | ADC_CR2_EXTTRIG)) | (static_cast<uint32_t>(trigger) << ADC_CR2_EXTSEL_Pos) | (static_cast<uint32_t>(mode) << ADC_CR2_EXTTRIG_Pos);
+    }
+
+    ADC_TEMPLATE_ARGS
+    bool ADC_TEMPLATE_QUALIFIER::SetRegularSequence(const uint8_t *channels, uint8_t channelsCount)
+    {
+        if (channelsCount == 0 || channelsCount > MaxRegular)
+        {
+            _adcData.error = AdcError::ArgumentError;
+            return false;
+        }
+
+        _Regs()->SQR1 = ((channelsCount - 1) << 20);
+        _Regs()->SQR3 = 0;
+        _Regs()->SQR2 = 0;
+
+        for (unsigned i = 0; i < channelsCount; i++)
+        {
+            Pins::SetConfiguration(Pins::Analog, 1u << channels[i]);
+            if (i < 6)
+            {
+                _Regs()->SQR3 |= (channels[i] & 0x1f) << 5 * (i);
+            }
+            else if (i < 12)
+            {
+                _Regs()->SQR2 |= (channels[i] & 0x1f) << 5 * (i - 6);
+            }
+            else
+            {
+                _Regs()->SQR1 |= (channels[i] & 0x1f) << 5 * (i - 12);
+            }
+        }
+
+        uint32_t controlReg = _Regs()->CR1 & ~(ADC_CR1_DISCEN | ADC_CR1_DISCNUM | ADC_CR1_SCAN);
+        if (channelsCount > 1)
+            controlReg |= ADC_CR1_SCAN;
+        _Regs()->CR1 = controlReg;
+
+        return true;
     }
 
     ADC_TEMPLATE_ARGS
@@ -575,7 +780,122 @@ namespace Zhele::Private
     template <typename... _Pins>
     bool ADC_TEMPLATE_QUALIFIER::StartRegular(uint16_t *dataBuffer, uint16_t scanCount)
     {
-        return StartRegular({Pins::template PinIndex<_Pins>::Value...}, dataBuffer, scanCount);
+        return StartRegular({static_cast<uint8_t>(Pins::template IndexOf<_Pins>)...}, dataBuffer, scanCount);
+    }
+
+    ADC_TEMPLATE_ARGS
+    bool ADC_TEMPLATE_QUALIFIER::StartRegularStream(const uint8_t *channels, uint8_t channelsCount, uint16_t *buffer, uint16_t blockSize, AdcStreamCallbackType callback)
+    {
+        if (channelsCount == 0 || channelsCount > MaxRegular || blockSize == 0 || blockSize % channelsCount != 0)
+        {
+            _adcData.error = AdcError::ArgumentError;
+            return false;
+        }
+
+        if (!VerifyReady(ADC_SR_STRT))
+        {
+            _adcData.error = AdcError::NotReady;
+            return false;
+        }
+
+        _Regs()->SR &= ~(ADC_SR_STRT | ADC_SR_EOC);
+
+        _Regs()->SQR1 = ((channelsCount - 1) << 20);
+        _Regs()->SQR3 = 0;
+        _Regs()->SQR2 = 0;
+
+        for (unsigned i = 0; i < channelsCount; i++)
+        {
+            Pins::SetConfiguration(Pins::Analog, 1u << channels[i]);
+            if (i < 6)
+            {
+                _Regs()->SQR3 |= (channels[i] & 0x1f) << 5 * (i);
+            }
+            else if (i < 12)
+            {
+                _Regs()->SQR2 |= (channels[i] & 0x1f) << 5 * (i - 6);
+            }
+            else
+            {
+                _Regs()->SQR1 |= (channels[i] & 0x1f) << 5 * (i - 12);
+            }
+        }
+
+        _adcData.streamCallback = callback;
+        _adcData.streamOverruns = 0;
+        _adcData.error = AdcError::NoError;
+
+        _DmaChannel::SetTransferCallback(DmaHandler);
+        _DmaChannel::SetDoubleBufferedTransferCallback(StreamHandler);
+        _DmaChannel::TransferDoubleBuffered(DmaBase::Periph2Mem | DmaBase::MemIncrement | DmaBase::PriorityHigh | DmaBase::PSize16Bits | DmaBase::MSize16Bits,
+                            buffer, buffer + blockSize, &_Regs()->DR, blockSize);
+
+        uint32_t controlReg = _Regs()->CR1;
+        controlReg &= ~(ADC_CR1_DISCEN | ADC_CR1_DISCNUM | ADC_CR1_SCAN);
+        if(channelsCount > 1)
+            controlReg |= ADC_CR1_SCAN;
+        _Regs()->CR1 = controlReg;
+
+        // Hardware trigger paces conversions, otherwise ADC converts continuously
+        if ((_Regs()->CR2 & ADC_CR2_EXTSEL) != ADC_CR2_EXTSEL)
+        {
+            _Regs()->CR2 |= ADC_CR2_DMA;
+        }
+        else
+        {
+            _Regs()->CR2 |= ADC_CR2_DMA | ADC_CR2_CONT;
+            _Regs()->CR2 |= ADC_CR2_SWSTART;
+        }
+
+        return true;
+    }
+
+    ADC_TEMPLATE_ARGS
+    bool ADC_TEMPLATE_QUALIFIER::StartRegularStream(std::initializer_list<uint8_t> channels, uint16_t *buffer, uint16_t blockSize, AdcStreamCallbackType callback)
+    {
+        return StartRegularStream(channels.begin(), static_cast<uint8_t>(channels.size()), buffer, blockSize, callback);
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::StreamHandler(void *data, unsigned size, unsigned bufferIndex)
+    {
+        if (_adcData.streamCallback)
+            _adcData.streamCallback(static_cast<uint16_t *>(data), size, _adcData.streamOverruns);
+
+        // DMA has returned to the reported block while callback was processing it
+        if (_DmaChannel::CurrentBuffer() == bufferIndex)
+            ++_adcData.streamOverruns;
+    }
+
+    ADC_TEMPLATE_ARGS
+    uint32_t ADC_TEMPLATE_QUALIFIER::StreamOverruns()
+    {
+        return _adcData.streamOverruns;
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::EnableAnalogWatchdog(uint8_t channel, uint16_t low, uint16_t high, AdcWatchdogCallbackType callback)
+    {
+        EnableAnalogWatchdog(low, high, callback);
+        _Regs()->CR1 = (_Regs()->CR1 & ~ADC_CR1_AWDCH) | ADC_CR1_AWDSGL | (channel & ADC_CR1_AWDCH);
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::EnableAnalogWatchdog(uint16_t low, uint16_t high, AdcWatchdogCallbackType callback)
+    {
+        _adcData.watchdogCallback = callback;
+        _Regs()->LTR = low;
+        _Regs()->HTR = high;
+        _Regs()->SR &= ~ADC_SR_AWD;
+        _Regs()->CR1 = (_Regs()->CR1 & ~(ADC_CR1_AWDCH | ADC_CR1_AWDSGL)) | ADC_CR1_AWDEN | ADC_CR1_JAWDEN | ADC_CR1_AWDIE;
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::DisableAnalogWatchdog()
+    {
+        _Regs()->CR1 &= ~(ADC_CR1_AWDEN | ADC_CR1_JAWDEN | ADC_CR1_AWDIE | ADC_CR1_AWDSGL | ADC_CR1_AWDCH);
+        _Regs()->SR &= ~ADC_SR_AWD;
+        _adcData.watchdogCallback = nullptr;
     }
 
     ADC_TEMPLATE_ARGS
@@ -588,6 +908,7 @@ namespace Zhele::Private
     void ADC_TEMPLATE_QUALIFIER::StopRegular()
     {
         _DmaChannel::Disable();
+        _Regs()->CR2 &= ~(ADC_CR2_DMA | ADC_CR2_CONT);
         _Regs()->SR &= ~(ADC_SR_STRT | ADC_SR_EOC);
         _Regs()->SQR1 = 0;
         _Regs()->SQR2 = 0;
@@ -632,7 +953,7 @@ namespace Zhele::Private
     AdcData ADC_TEMPLATE_QUALIFIER::_adcData;
 
     ADC_TEMPLATE_ARGS
-    unsigned ADC_TEMPLATE_QUALIFIER::ToVolts(uint16_t value)
+    uint16_t ADC_TEMPLATE_QUALIFIER::VRef()
     {
         if(_adcData.vRef == 0)
         {
@@ -641,8 +962,89 @@ namespace Zhele::Private
                 _adcData.vRef += ReadInjected(ReferenceChannel);
             }
             _adcData.vRef /= 4;
+            _adcData.millivoltsScale = ((VRefNominal / 10) << 16) / _adcData.vRef;
         }
-        return VRefNominal * value / _adcData.vRef;
+        return _adcData.vRef;
+    }
+
+    ADC_TEMPLATE_ARGS
+    unsigned ADC_TEMPLATE_QUALIFIER::ToVolts(uint16_t value)
+    {
+        return VRefNominal * value / VRef();
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::ToMillivolts(std::span<const uint16_t> input, std::span<int32_t> output)
+    {
+        VRef();
+        const uint64_t scale = _adcData.millivoltsScale;
+        const size_t count = std::min(input.size(), output.size());
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            output[i] = static_cast<int32_t>((input[i] * scale + 0x8000) >> 16);
+        }
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::ToQ15(std::span<const uint16_t> input, std::span<int16_t> output, int16_t gain)
+    {
+        const size_t count = std::min(input.size(), output.size());
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            int32_t value = (static_cast<int32_t>(input[i] << (15 - ResolutionBits)) * gain) >> 15;
+#if defined (__ARM_FEATURE_SAT) && (__ARM_FEATURE_SAT == 1)
+            output[i] = static_cast<int16_t>(__SSAT(value, 16));
+#else
+            output[i] = static_cast<int16_t>(std::clamp<int32_t>(value, INT16_MIN, INT16_MAX));
+#endif
+        }
+    }
+
+    ADC_TEMPLATE_ARGS
+    std::span<int16_t> ADC_TEMPLATE_QUALIFIER::RemoveDcOffset(std::span<uint16_t> data)
+    {
+        // Signed and unsigned types may alias each other
+        std::span<int16_t> result(reinterpret_cast<int16_t*>(data.data()), data.size());
+        if (data.empty())
+            return result;
+
+        uint32_t sum = 0;
+        size_t i = 0;
+#if defined (__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+        // Two samples per instruction, values are less than 0x8000 and are not affected by sign
+        for (; i + 1 < data.size(); i += 2)
+        {
+            uint32_t pair;
+            std::memcpy(&pair, &data[i], sizeof(pair));
+            sum = __SMLAD(pair, 0x00010001, sum);
+        }
+#endif
+        for (; i < data.size(); ++i)
+        {
+            sum += data[i];
+        }
+
+        const uint16_t offset = static_cast<uint16_t>((sum + data.size() / 2) / data.size());
+
+        i = 0;
+#if defined (__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+        const uint32_t offsetPair = (static_cast<uint32_t>(offset) << 16) | offset;
+        for (; i + 1 < data.size(); i += 2)
+        {
+            uint32_t pair;
+            std::memcpy(&pair, &data[i], sizeof(pair));
+            pair = __SSUB16(pair, offsetPair);
+            std::memcpy(&data[i], &pair, sizeof(pair));
+        }
+#endif
+        for (; i < data.size(); ++i)
+        {
+            result[i] = static_cast<int16_t>(data[i] - offset);
+        }
+
+        return result;
     }
 }
 
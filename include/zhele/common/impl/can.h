@@ -0,0 +1,342 @@
+/**
+ * @file
+ * Implements bxCAN
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CAN_IMPL_COMMON_H
+#define ZHELE_CAN_IMPL_COMMON_H
+
+namespace Zhele::Private
+{
+    #define CAN_TEMPLATE_ARGS template<typename _Regs, typename _FilterRegs, typename _ClockCtrl, typename _FilterClockCtrl, \
+        IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _TxPins, typename _RxPins>
+    #define CAN_TEMPLATE_QUALIFIER Can<_Regs, _FilterRegs, _ClockCtrl, _FilterClockCtrl, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _TxPins, _RxPins>
+
+    CAN_TEMPLATE_ARGS
+    constexpr CanTiming CAN_TEMPLATE_QUALIFIER::CalculateTiming(uint32_t clockFrequency, uint32_t bitRate, uint16_t samplePointPermille)
+    {
+        CanTiming best {0, 0, 0, 0, 0};
+        unsigned bestError = ~0u;
+
+        if (bitRate == 0)
+            return best;
+
+        // Bit time is 1 (sync) + BS1 (1-16) + BS2 (1-8) time quanta
+        for (unsigned quanta = 25; quanta >= 8; --quanta)
+        {
+            const uint64_t quantumRate = static_cast<uint64_t>(bitRate) * quanta;
+            if (clockFrequency % quantumRate != 0)
+                continue;
+
+            const uint64_t prescaler = clockFrequency / quantumRate;
+            if (prescaler < 1 || prescaler > 1024)
+                continue;
+
+            for (unsigned segment2 = 1; segment2 <= 8; ++segment2)
+            {
+                const unsigned segment1 = quanta - 1 - segment2;
+                if (segment1 < 1 || segment1 > 16)
+                    continue;
+
+                const unsigned samplePoint = (1 + segment1) * 1000 / quanta;
+                const unsigned error = samplePoint > samplePointPermille ? samplePoint - samplePointPermille : samplePointPermille - samplePoint;
+
+                // Quanta are iterated from max, so strict comparison prefers more quanta
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = CanTiming {
+                        static_cast<uint16_t>(prescaler),
+                        static_cast<uint8_t>(segment1),
+                        static_cast<uint8_t>(segment2),
+                        static_cast<uint8_t>(segment2 < 4 ? segment2 : 4),
+                        static_cast<uint16_t>(samplePoint)};
+                }
+            }
+        }
+
+        return best;
+    }
+
+    CAN_TEMPLATE_ARGS
+    template<uint32_t bitRate, uint32_t clockFrequency, uint16_t samplePointPermille>
+    bool CAN_TEMPLATE_QUALIFIER::Init(Mode mode)
+    {
+        constexpr CanTiming timing = CalculateTiming(clockFrequency, bitRate, samplePointPermille);
+        static_assert(timing.Prescaler != 0, "Bit rate is unreachable with given clock frequency");
+        static_assert(bitRate <= 1000000, "Max CAN bit rate is 1 Mbit/s");
+
+        _FilterClockCtrl::Enable();
+        if constexpr (!std::is_same_v<_ClockCtrl, _FilterClockCtrl>)
+        {
+            _ClockCtrl::Enable();
+        }
+
+        // Leave sleep mode and enter initialization mode
+        _Regs()->MCR = CAN_MCR_INRQ;
+        while (!(_Regs()->MSR & CAN_MSR_INAK))
+            continue;
+
+        // Automatic bus-off recovery, TX mailboxes priority is driven by identifier
+        _Regs()->MCR = CAN_MCR_INRQ | CAN_MCR_ABOM;
+        _Regs()->BTR = static_cast<uint32_t>(mode)
+            | ((timing.JumpWidth - 1u) << CAN_BTR_SJW_Pos)
+            | ((timing.Segment2 - 1u) << CAN_BTR_TS2_Pos)
+            | ((timing.Segment1 - 1u) << CAN_BTR_TS1_Pos)
+            | (timing.Prescaler - 1u);
+        _Regs()->IER = CAN_IER_TMEIE
+            | CAN_IER_FMPIE0 | CAN_IER_FOVIE0
+            | CAN_IER_FMPIE1 | CAN_IER_FOVIE1
+            | CAN_IER_ERRIE | CAN_IER_BOFIE;
+
+        NVIC_EnableIRQ(_TxIrq);
+        NVIC_EnableIRQ(_Rx0Irq);
+        NVIC_EnableIRQ(_Rx1Irq);
+        NVIC_EnableIRQ(_SceIrq);
+
+        // Synchronization takes 11 recessive bits, wait for at least 128 bit times
+        _Regs()->MCR &= ~CAN_MCR_INRQ;
+        for (uint32_t timeout = clockFrequency / bitRate * 128; timeout > 0; --timeout)
+        {
+            if (!(_Regs()->MSR & CAN_MSR_INAK))
+                return true;
+        }
+        return false;
+    }
+
+    CAN_TEMPLATE_ARGS
+    constexpr uint32_t CAN_TEMPLATE_QUALIFIER::FilterId(uint32_t id, bool extended)
+    {
+        // 32-bit scale filter has the same layout as mailbox identifier register
+        return extended
+            ? (id << CAN_TI0R_EXID_Pos) | CAN_TI0R_IDE
+            : (id << CAN_TI0R_STID_Pos);
+    }
+
+    CAN_TEMPLATE_ARGS
+    void CAN_TEMPLATE_QUALIFIER::ConfigureFilter(uint8_t bank, uint32_t fr1, uint32_t fr2, bool listMode, uint8_t fifo)
+    {
+        const uint32_t bit = 1u << bank;
+
+        _FilterClockCtrl::Enable();
+        _FilterRegs()->FMR |= CAN_FMR_FINIT;
+        _FilterRegs()->FA1R &= ~bit;
+        _FilterRegs()->FS1R |= bit;
+        if (listMode)
+            _FilterRegs()->FM1R |= bit;
+        else
+            _FilterRegs()->FM1R &= ~bit;
+        if (fifo != 0)
+            _FilterRegs()->FFA1R |= bit;
+        else
+            _FilterRegs()->FFA1R &= ~bit;
+        _FilterRegs()->sFilterRegister[bank].FR1 = fr1;
+        _FilterRegs()->sFilterRegister[bank].FR2 = fr2;
+        _FilterRegs()->FA1R |= bit;
+        _FilterRegs()->FMR &= ~CAN_FMR_FINIT;
+    }
+
+    CAN_TEMPLATE_ARGS
+    void CAN_TEMPLATE_QUALIFIER::SetMaskFilter(uint8_t bank, uint32_t id, uint32_t mask, bool extended, uint8_t fifo)
+    {
+        // IDE bit is always compared, RTR bit is ignored
+        ConfigureFilter(bank, FilterId(id, extended), FilterId(mask, extended) | CAN_TI0R_IDE, false, fifo);
+    }
+
+    CAN_TEMPLATE_ARGS
+    void CAN_TEMPLATE_QUALIFIER::SetListFilter(uint8_t bank, uint32_t id1, uint32_t id2, bool extended, uint8_t fifo)
+    {
+        ConfigureFilter(bank, FilterId(id1, extended), FilterId(id2, extended), true, fifo);
+    }
+
+    CAN_TEMPLATE_ARGS
+    void CAN_TEMPLATE_QUALIFIER::DisableFilter(uint8_t bank)
+    {
+        _FilterClockCtrl::Enable();
+        _FilterRegs()->FA1R &= ~(1u << bank);
+    }
+
+#if defined (CAN_FMR_CAN2SB)
+    CAN_TEMPLATE_ARGS
+    void CAN_TEMPLATE_QUALIFIER::SplitFilterBanks(uint8_t can2StartBank)
+    {
+        _FilterClockCtrl::Enable();
+        _FilterRegs()->FMR |= CAN_FMR_FINIT;
+        _FilterRegs()->FMR = (_FilterRegs()->FMR & ~CAN_FMR_CAN2SB) | (static_cast<uint32_t>(can2StartBank) << CAN_FMR_CAN2SB_Pos);
+        _FilterRegs()->FMR &= ~CAN_FMR_FINIT;
+    }
+#endif
+
+    CAN_TEMPLATE_ARGS
+    bool CAN_TEMPLATE_QUALIFIER::WriteMailbox(const CanMessage& message)
+    {
+        uint32_t status = _Regs()->TSR;
+        if (!(status & CAN_TSR_TME))
+            return false;
+
+        // CODE is the number of empty mailbox
+        auto& mailbox = _Regs()->sTxMailBox[(status & CAN_TSR_CODE) >> CAN_TSR_CODE_Pos];
+        mailbox.TDLR = message.Data[0] | (message.Data[1] << 8) | (message.Data[2] << 16) | (static_cast<uint32_t>(message.Data[3]) << 24);
+        mailbox.TDHR = message.Data[4] | (message.Data[5] << 8) | (message.Data[6] << 16) | (static_cast<uint32_t>(message.Data[7]) << 24);
+        mailbox.TDTR = message.Length & CAN_TDT0R_DLC;
+        mailbox.TIR = FilterId(message.Id, message.Extended)
+            | (message.Remote ? CAN_TI0R_RTR : 0)
+            | CAN_TI0R_TXRQ;
+        return true;
+    }
+
+    CAN_TEMPLATE_ARGS
+    bool CAN_TEMPLATE_QUALIFIER::Send(const CanMessage& message)
+    {
+        // Mailbox empty interrupt is masked, so queue and mailboxes are not changed by handler
+        _Regs()->IER &= ~CAN_IER_TMEIE;
+        bool result = (_txQueue.empty() && WriteMailbox(message)) || _txQueue.push_back(message);
+        _Regs()->IER |= CAN_IER_TMEIE;
+        return result;
+    }
+
+    CAN_TEMPLATE_ARGS
+    bool CAN_TEMPLATE_QUALIFIER::Receive(CanMessage& message)
+    {
+        RxQueue& queue = !_rxQueue0.empty() ? _rxQueue0 : _rxQueue1;
+        if (queue.empty())
+            return false;
+
+        message = queue.front();
+        queue.pop_front();
+        return true;
+    }
+
+    CAN_TEMPLATE_ARGS
+    unsigned CAN_TEMPLATE_QUALIFIER::Available()
+    {
+        return _rxQueue0.size() + _rxQueue1.size();
+    }
+
+    CAN_TEMPLATE_ARGS
+    bool CAN_TEMPLATE_QUALIFIER::TransmitCompleted()
+    {
+        return _txQueue.empty() && (_Regs()->TSR & CAN_TSR_TME) == CAN_TSR_TME;
+    }
+
+    CAN_TEMPLATE_ARGS
+    uint8_t CAN_TEMPLATE_QUALIFIER::TransmitErrors()
+    {
+        return static_cast<uint8_t>((_Regs()->ESR & CAN_ESR_TEC) >> CAN_ESR_TEC_Pos);
+    }
+
+    CAN_TEMPLATE_ARGS
+    uint8_t CAN_TEMPLATE_QUALIFIER::ReceiveErrors()
+    {
+        return static_cast<uint8_t>((_Regs()->ESR & CAN_ESR_REC) >> CAN_ESR_REC_Pos);
+    }
+
+    CAN_TEMPLATE_ARGS
+    bool CAN_TEMPLATE_QUALIFIER::BusOff()
+    {
+        return (_Regs()->ESR & CAN_ESR_BOFF) != 0;
+    }
+
+    CAN_TEMPLATE_ARGS
+    void CAN_TEMPLATE_QUALIFIER::TxIrqHandler()
+    {
+        uint32_t status = _Regs()->TSR;
+
+        if constexpr (Statistics::Enabled)
+        {
+            constexpr uint32_t completed[3][2] = {{CAN_TSR_RQCP0, CAN_TSR_TXOK0}, {CAN_TSR_RQCP1, CAN_TSR_TXOK1}, {CAN_TSR_RQCP2, CAN_TSR_TXOK2}};
+            for (const auto& [request, ok] : completed)
+            {
+                if (status & request)
+                    Counters::Add((status & ok) ? Statistics::CanCounters::TxFrames : Statistics::CanCounters::TxErrors);
+            }
+        }
+
+        // Clear request completed flags (interrupt source)
+        _Regs()->TSR = status & (CAN_TSR_RQCP0 | CAN_TSR_RQCP1 | CAN_TSR_RQCP2);
+
+        while (!_txQueue.empty() && WriteMailbox(_txQueue.front()))
+        {
+            _txQueue.pop_front();
+        }
+    }
+
+    CAN_TEMPLATE_ARGS
+    template<uint8_t fifo>
+    void CAN_TEMPLATE_QUALIFIER::DrainFifo(volatile uint32_t& fifoRegister, RxQueue& queue)
+    {
+        // RF0R and RF1R have the same layout
+        while (fifoRegister & CAN_RF0R_FMP0)
+        {
+            auto& mailbox = _Regs()->sFIFOMailBox[fifo];
+            uint32_t identifier = mailbox.RIR;
+            uint32_t lengthTime = mailbox.RDTR;
+            uint32_t low = mailbox.RDLR;
+            uint32_t high = mailbox.RDHR;
+
+            // Release mailbox as soon as possible
+            fifoRegister = CAN_RF0R_RFOM0;
+
+            CanMessage message {};
+            message.Extended = (identifier & CAN_RI0R_IDE) != 0;
+            message.Id = message.Extended
+                ? identifier >> CAN_RI0R_EXID_Pos
+                : identifier >> CAN_RI0R_STID_Pos;
+            message.Remote = (identifier & CAN_RI0R_RTR) != 0;
+            message.Length = static_cast<uint8_t>(lengthTime & CAN_RDT0R_DLC);
+            message.Filter = static_cast<uint8_t>((lengthTime & CAN_RDT0R_FMI) >> CAN_RDT0R_FMI_Pos);
+            for (unsigned i = 0; i < 4; ++i)
+            {
+                message.Data[i] = static_cast<uint8_t>(low >> (8 * i));
+                message.Data[i + 4] = static_cast<uint8_t>(high >> (8 * i));
+            }
+
+            Counters::Add(queue.push_back(message) ? Statistics::CanCounters::RxFrames : Statistics::CanCounters::RxDropped);
+        }
+
+        if (fifoRegister & CAN_RF0R_FOVR0)
+        {
+            Counters::Add(Statistics::CanCounters::RxOverruns);
+        }
+        // Overrun and full flags are cleared by writing 1
+        fifoRegister = fifoRegister & (CAN_RF0R_FOVR0 | CAN_RF0R_FULL0);
+    }
+
+    CAN_TEMPLATE_ARGS
+    void CAN_TEMPLATE_QUALIFIER::Rx0IrqHandler()
+    {
+        DrainFifo<0>(_Regs()->RF0R, _rxQueue0);
+    }
+
+    CAN_TEMPLATE_ARGS
+    void CAN_TEMPLATE_QUALIFIER::Rx1IrqHandler()
+    {
+        DrainFifo<1>(_Regs()->RF1R, _rxQueue1);
+    }
+
+    CAN_TEMPLATE_ARGS
+    void CAN_TEMPLATE_QUALIFIER::SceIrqHandler()
+    {
+        if (_Regs()->ESR & CAN_ESR_BOFF)
+        {
+            Counters::Add(Statistics::CanCounters::BusOff);
+        }
+        // Error interrupt flag is cleared by writing 1
+        _Regs()->MSR = CAN_MSR_ERRI;
+    }
+
+    CAN_TEMPLATE_ARGS
+    typename CAN_TEMPLATE_QUALIFIER::RxQueue CAN_TEMPLATE_QUALIFIER::_rxQueue0;
+
+    CAN_TEMPLATE_ARGS
+    typename CAN_TEMPLATE_QUALIFIER::RxQueue CAN_TEMPLATE_QUALIFIER::_rxQueue1;
+
+    CAN_TEMPLATE_ARGS
+    typename CAN_TEMPLATE_QUALIFIER::TxQueue CAN_TEMPLATE_QUALIFIER::_txQueue;
+}
+
+#endif //! ZHELE_CAN_IMPL_COMMON_H
@@ -22,6 +22,92 @@
 
 namespace Zhele::Clock
 {
+    inline bool ClockChange::Subscribe(Callback callback)
+    {
+        Callback* freeSlot = nullptr;
+        for (Callback& subscriber : _subscribers)
+        {
+            if (subscriber == callback)
+                return true;
+            if (subscriber == nullptr && freeSlot == nullptr)
+                freeSlot = &subscriber;
+        }
+
+        if (freeSlot == nullptr)
+            return false;
+
+        *freeSlot = callback;
+        return true;
+    }
+
+    inline void ClockChange::Unsubscribe(Callback callback)
+    {
+        for (Callback& subscriber : _subscribers)
+        {
+            if (subscriber == callback)
+                subscriber = nullptr;
+        }
+    }
+
+    template<ClockChange::Callback _Callback>
+    void ClockChange::Subscribe()
+    {
+        Node& node = _node<_Callback>;
+        if (node.linked)
+            return;
+
+        node.next = _head;
+        node.linked = true;
+        _head = &node;
+    }
+
+    template<ClockChange::Callback _Callback>
+    void ClockChange::Unsubscribe()
+    {
+        Node& node = _node<_Callback>;
+        for (Node** link = &_head; *link != nullptr; link = &(*link)->next)
+        {
+            if (*link == &node)
+            {
+                *link = node.next;
+                node.linked = false;
+                return;
+            }
+        }
+    }
+
+    inline void ClockChange::BeginUpdate()
+    {
+        ++_updateLevel;
+    }
+
+    inline void ClockChange::EndUpdate()
+    {
+        if (_updateLevel == 0 || --_updateLevel != 0 || !_pending)
+            return;
+
+        _pending = false;
+        Notify();
+    }
+
+    inline void ClockChange::Notify()
+    {
+        if (_updateLevel != 0)
+        {
+            _pending = true;
+            return;
+        }
+
+        for (Node* node = _head; node != nullptr; node = node->next)
+            node->callback();
+
+        for (Callback subscriber : _subscribers)
+        {
+            if (subscriber != nullptr)
+                subscriber();
+        }
+    }
+
     template <typename _Regs>
     bool ClockBase<_Regs>::EnableClockSource(unsigned turnMask, unsigned waitReadyMask)
     {
@@ -56,7 +142,11 @@ namespace Zhele::Clock
     template<typename PrescalerType>
     void BusClock<_SrcClock, _PrescalerBitField>::SetPrescaler(PrescalerType prescaler)
     {
+        if (_PrescalerBitField::Get() == static_cast<ClockFrequenceT>(prescaler))
+            return;
+
         _PrescalerBitField::Set(static_cast<ClockFrequenceT>(prescaler));
+        ClockChange::Notify();
     }
 
     template<typename _Reg, unsigned _Mask, typename _ClockSrc>
@@ -183,9 +273,15 @@ namespace Zhele::Clock
             return InvalidClockSource;
         }
 
-        Flash::ConfigureFrequence(resultFrequence);
+        const ClockFrequenceT currentFrequence = ClockFreq();
+        if ((RCC->CFGR & RCC_CFGR_SWS) == clockStatusValue && currentFrequence == resultFrequence)
+            return Success;
 
-        RCC->CFGR = clockSelectMask;
+        // Flash must be slowed down before clock speeds up and can be sped up only after clock slows down
+        if (resultFrequence > currentFrequence)
+            Flash::ConfigureFrequence(resultFrequence);
+
+        RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | clockSelectMask;
         
         uint32_t timeout = 10000;
         while (((RCC->CFGR & RCC_CFGR_SWS) != clockStatusValue) && --timeout)
@@ -194,19 +290,28 @@ namespace Zhele::Clock
         {
             return ClockSelectFailed;
         }
+
+        if (resultFrequence < currentFrequence)
+            Flash::ConfigureFrequence(resultFrequence);
+
+        _frequence = resultFrequence;
+        ClockChange::Notify();
         return Success;
     }
 
     inline ClockFrequenceT SysClock::ClockFreq()
     {
+        if (_frequence != 0)
+            return _frequence;
+
         uint32_t clockSrc = RCC->CFGR & RCC_CFGR_SWS;
         switch (clockSrc)
         {
-            case RCC_CFGR_SWS_HSI: return HsiClock::ClockFreq();
-            case RCC_CFGR_SWS_HSE: return HseClock::ClockFreq();
-            case RCC_CFGR_SWS_PLL: return PllClock::ClockFreq() / PllClock::GetSystemOutputDivider();
+            case RCC_CFGR_SWS_HSI: _frequence = HsiClock::ClockFreq(); break;
+            case RCC_CFGR_SWS_HSE: _frequence = HseClock::ClockFreq(); break;
+            case RCC_CFGR_SWS_PLL: _frequence = PllClock::ClockFreq() / PllClock::GetSystemOutputDivider(); break;
         }
-        return 0;
+        return _frequence;
     }
 
     inline ClockFrequenceT SysClock::SrcClockFreq()
@@ -229,6 +334,58 @@ namespace Zhele::Clock
         return SrcClockFreq();
     }
 #endif
+
+#if defined (RCC_CCIPR_USART1SEL)
+    template<typename _BusClock, unsigned _SelectPosition>
+    void UsartKernelClock<_BusClock, _SelectPosition>::SelectClockSource(UsartClockSource source)
+    {
+        RCC->CCIPR = (RCC->CCIPR & ~(0b11u << _SelectPosition)) | (static_cast<uint32_t>(source) << _SelectPosition);
+    }
+
+    template<typename _BusClock, unsigned _SelectPosition>
+    UsartClockSource UsartKernelClock<_BusClock, _SelectPosition>::GetClockSource()
+    {
+        return static_cast<UsartClockSource>((RCC->CCIPR >> _SelectPosition) & 0b11u);
+    }
+
+    template<typename _BusClock, unsigned _SelectPosition>
+    ClockFrequenceT UsartKernelClock<_BusClock, _SelectPosition>::ClockFreq()
+    {
+        switch (GetClockSource())
+        {
+            case UsartClockSource::SysClk: return SysClock::ClockFreq();
+            case UsartClockSource::Hsi: return HsiClock::ClockFreq();
+            case UsartClockSource::Lse: return 32768;
+            default: return _BusClock::ClockFreq();
+        }
+    }
+#endif
+
+#if defined (RCC_CCIPR_LPTIM1SEL)
+    template<typename _BusClock, unsigned _SelectPosition>
+    void LpTimerKernelClock<_BusClock, _SelectPosition>::SelectClockSource(LpTimerClockSource source)
+    {
+        RCC->CCIPR = (RCC->CCIPR & ~(0b11u << _SelectPosition)) | (static_cast<uint32_t>(source) << _SelectPosition);
+    }
+
+    template<typename _BusClock, unsigned _SelectPosition>
+    LpTimerClockSource LpTimerKernelClock<_BusClock, _SelectPosition>::GetClockSource()
+    {
+        return static_cast<LpTimerClockSource>((RCC->CCIPR >> _SelectPosition) & 0b11u);
+    }
+
+    template<typename _BusClock, unsigned _SelectPosition>
+    ClockFrequenceT LpTimerKernelClock<_BusClock, _SelectPosition>::ClockFreq()
+    {
+        switch (GetClockSource())
+        {
+            case LpTimerClockSource::Lsi: return LsiClock::ClockFreq();
+            case LpTimerClockSource::Hsi: return HsiClock::ClockFreq();
+            case LpTimerClockSource::Lse: return 32768;
+            default: return _BusClock::ClockFreq();
+        }
+    }
+#endif
 }
 
 #endif //! ZHELE_CLOCK_IMPL_COMMON_H
\ No newline at end of file
@@ -10,6 +10,7 @@
 #define ZHELE_CRC_IMPL_COMMON_H
 
 #include <stdint.h>
+#include <string.h>
 #include <limits>
 #include <type_traits>
 
@@ -79,39 +80,167 @@ namespace Zhele::Private
     template<typename _Clock>
     inline uint32_t Crc32<_Clock>::CalculateCrc32(const uint8_t* data, unsigned size)
     {
+        Begin();
+        Update(std::span<const uint8_t>(data, size));
+        return Finish();
+    }
+
+    template<typename _Clock>
+    inline void Crc32<_Clock>::Begin()
+    {
+        while (_busy) continue;
+
         Reset();
-        const uint32_t* data_aligned = reinterpret_cast<const uint32_t*>(data);
+        _pending = 0;
+        _pendingSize = 0;
+    }
 
-#if defined (CRC_CR_REV_IN) && defined (CRC_CR_REV_OUT)
-        for (int i = 0; i < (size / sizeof(uint32_t)); ++i) {
-            CRC->DR = data_aligned[i];
+    template<typename _Clock>
+    inline void Crc32<_Clock>::Update(std::span<const uint8_t> data)
+    {
+        while (_busy) continue;
+
+        const uint8_t* bytes = data.data();
+        size_t size = data.size();
+
+        for (; size > 0 && _pendingSize != 0; ++bytes, --size) {
+            AppendByte(*bytes);
+        }
+
+        for (; size >= sizeof(uint32_t); bytes += sizeof(uint32_t), size -= sizeof(uint32_t)) {
+            uint32_t word;
+            memcpy(&word, bytes, sizeof(word));
+            WriteWord(word);
         }
 
+        for (; size > 0; ++bytes, --size) {
+            AppendByte(*bytes);
+        }
+    }
+
+    template<typename _Clock>
+    inline uint32_t Crc32<_Clock>::Finish()
+    {
+        while (_busy) continue;
+
+        unsigned bits_remain = _pendingSize * std::numeric_limits<uint8_t>::digits;
+#if defined (CRC_CR_REV_IN) && defined (CRC_CR_REV_OUT)
         uint32_t result = CRC->DR;
-        unsigned bits_remain = (size % sizeof(uint32_t)) * std::numeric_limits<uint8_t>::digits;
         if (bits_remain) {
             CRC->DR = CRC->DR;
-            CRC->DR = ((data_aligned[size / sizeof(uint32_t)] & (0xFFFFFFFF >> (32 - bits_remain))) ^ result) << (32 - bits_remain);
+            CRC->DR = ((_pending & (0xFFFFFFFF >> (32 - bits_remain))) ^ result) << (32 - bits_remain);
             result = (result >> bits_remain) ^ CRC->DR;
         }
 #else
-        for (int i = 0; i < (size / sizeof(uint32_t)); ++i) {
-            CRC->DR = __RBIT(data_aligned[i]);
-        }
-
-
         uint32_t result = __RBIT(CRC->DR);
-        unsigned bits_remain = (size % sizeof(uint32_t)) * std::numeric_limits<uint8_t>::digits;
         if (bits_remain) {
             CRC->DR = CRC->DR;
-            CRC->DR = __RBIT((data_aligned[size / sizeof(uint32_t)] & (0xFFFFFFFF >> (32 - bits_remain))) ^ result) >> (32 - bits_remain);
+            CRC->DR = __RBIT((_pending & (0xFFFFFFFF >> (32 - bits_remain))) ^ result) >> (32 - bits_remain);
             result = (result >> bits_remain) ^ __RBIT(CRC->DR);
         }
 #endif
+        _pendingSize = 0;
 
         return ~result;
     }
 
+    template<typename _Clock>
+    inline bool Crc32<_Clock>::Busy()
+    {
+        return _busy;
+    }
+
+    template<typename _Clock>
+    inline void Crc32<_Clock>::WriteWord(uint32_t word)
+    {
+#if defined (CRC_CR_REV_IN) && defined (CRC_CR_REV_OUT)
+        CRC->DR = word;
+#else
+        CRC->DR = __RBIT(word);
+#endif
+    }
+
+    template<typename _Clock>
+    inline void Crc32<_Clock>::AppendByte(uint8_t byte)
+    {
+        _pending |= static_cast<uint32_t>(byte) << (_pendingSize * std::numeric_limits<uint8_t>::digits);
+        if (++_pendingSize == sizeof(uint32_t)) {
+            WriteWord(_pending);
+            _pending = 0;
+            _pendingSize = 0;
+        }
+    }
+
+#if defined (CRC_CR_REV_IN)
+    template<typename _Clock>
+    template<typename _DmaChannel>
+    inline void Crc32<_Clock>::UpdateAsync(std::span<const uint8_t> data, TransferCallback callback)
+    {
+        while (_busy) continue;
+
+        const uint8_t* bytes = data.data();
+        size_t size = data.size();
+
+        for (; size > 0 && _pendingSize != 0; ++bytes, --size) {
+            AppendByte(*bytes);
+        }
+
+        if (size < sizeof(uint32_t) || (reinterpret_cast<uintptr_t>(bytes) % sizeof(uint32_t)) != 0) {
+            Update(std::span<const uint8_t>(bytes, size));
+            if (callback != nullptr)
+                callback(const_cast<uint8_t*>(data.data()), data.size(), true);
+            return;
+        }
+
+        _asyncData = data.data();
+        _asyncSize = data.size();
+        _asyncCallback = callback;
+        _nextWord = bytes;
+        _remainingWords = size / sizeof(uint32_t);
+        _busy = true;
+
+        _DmaChannel::SetTransferCallback(TransferHandler<_DmaChannel>);
+        StartChunk<_DmaChannel>();
+    }
+
+    template<typename _Clock>
+    template<typename _DmaChannel>
+    inline void Crc32<_Clock>::StartChunk()
+    {
+        // Channel counter is 16-bit
+        uint32_t words = _remainingWords > 0xffff ? 0xffff : _remainingWords;
+        const uint8_t* source = _nextWord;
+        _nextWord += words * sizeof(uint32_t);
+        _remainingWords -= words;
+
+        // In Mem2Mem mode source = periph, destination = mem
+        _DmaChannel::Transfer(_DmaChannel::Mem2Mem | _DmaChannel::PeriphIncrement | _DmaChannel::MSize32Bits | _DmaChannel::PSize32Bits,
+            const_cast<void*>(static_cast<volatile void*>(&CRC->DR)), const_cast<uint8_t*>(source), words);
+    }
+
+    template<typename _Clock>
+    template<typename _DmaChannel>
+    inline void Crc32<_Clock>::TransferHandler(void* data, unsigned size, bool success)
+    {
+        if (success && _remainingWords > 0) {
+            StartChunk<_DmaChannel>();
+            return;
+        }
+
+        // Tail bytes don't fill word, so they are only appended to pending word
+        const uint8_t* tail = _nextWord;
+        const uint8_t* end = _asyncData + _asyncSize;
+        for (; tail < end; ++tail) {
+            AppendByte(*tail);
+        }
+
+        _busy = false;
+
+        if (_asyncCallback != nullptr)
+            _asyncCallback(const_cast<uint8_t*>(_asyncData), _asyncSize, success);
+    }
+#endif
+
     template<typename _Clock>
     inline void Crc32<_Clock>::Reset()
     {
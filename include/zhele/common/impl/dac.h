@@ -110,6 +110,83 @@ namespace Zhele::Private
     {
         _Regs()->SWTRIGR = 1 << _Channel;
     }
+
+    DAC_TEMPLATE_ARGS
+    void DAC_TEMPLATE_QUALIFIER::EnableDma()
+    {
+        _Regs()->CR |= DAC_CR_DMAEN1 << (_Channel * ChannelOffset);
+    }
+
+    DAC_TEMPLATE_ARGS
+    void DAC_TEMPLATE_QUALIFIER::DisableDma()
+    {
+        _Regs()->CR &= ~(DAC_CR_DMAEN1 << (_Channel * ChannelOffset));
+    }
+
+    DAC_TEMPLATE_ARGS
+    volatile void* DAC_TEMPLATE_QUALIFIER::DataRegister()
+    {
+        if constexpr (_Channel == 0)
+            return &_Regs()->DHR12R1;
+        else
+            return &_Regs()->DHR12R2;
+    }
+
+    template <typename _Regs, typename _ClockCtrl>
+    void DacDual<_Regs, _ClockCtrl>::Init()
+    {
+        _ClockCtrl::Enable();
+    }
+
+    template <typename _Regs, typename _ClockCtrl>
+    template <typename Trigger>
+    void DacDual<_Regs, _ClockCtrl>::Init(Trigger trigger)
+    {
+        Channel1::Init(trigger);
+        Channel2::Init(trigger);
+    }
+
+    template <typename _Regs, typename _ClockCtrl>
+    void DacDual<_Regs, _ClockCtrl>::Enable()
+    {
+        _Regs()->CR |= DAC_CR_EN1 | DAC_CR_EN2;
+    }
+
+    template <typename _Regs, typename _ClockCtrl>
+    void DacDual<_Regs, _ClockCtrl>::Disable()
+    {
+        _Regs()->CR &= ~(DAC_CR_EN1 | DAC_CR_EN2);
+    }
+
+    template <typename _Regs, typename _ClockCtrl>
+    void DacDual<_Regs, _ClockCtrl>::Write(uint16_t channel1, uint16_t channel2)
+    {
+        _Regs()->DHR12RD = Pack(channel1, channel2);
+    }
+
+    template <typename _Regs, typename _ClockCtrl>
+    void DacDual<_Regs, _ClockCtrl>::CauseSoftwareTrigger()
+    {
+        _Regs()->SWTRIGR = 0b11;
+    }
+
+    template <typename _Regs, typename _ClockCtrl>
+    void DacDual<_Regs, _ClockCtrl>::EnableDma()
+    {
+        Channel1::EnableDma();
+    }
+
+    template <typename _Regs, typename _ClockCtrl>
+    void DacDual<_Regs, _ClockCtrl>::DisableDma()
+    {
+        Channel1::DisableDma();
+    }
+
+    template <typename _Regs, typename _ClockCtrl>
+    volatile void* DacDual<_Regs, _ClockCtrl>::DataRegister()
+    {
+        return &_Regs()->DHR12RD;
+    }
 }
 
 #endif //! ZHELE_DAC_IMPL_COMMON_H
\ No newline at end of file
@@ -0,0 +1,110 @@
+/**
+ * @file
+ * Implements delays and cycle counter
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DELAY_IMPL_COMMON_H
+#define ZHELE_DELAY_IMPL_COMMON_H
+
+namespace Zhele
+{
+#if defined (ZHELE_DELAY_DWT)
+    inline void CycleCounter::Enable()
+    {
+        if (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)
+            return;
+
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
+    inline uint32_t CycleCounter::Read()
+    {
+        return DWT->CYCCNT;
+    }
+
+    inline uint32_t CycleCounter::Elapsed(uint32_t start, uint32_t end)
+    {
+        return end - start;
+    }
+#else
+    inline void CycleCounter::Enable()
+    {
+        if (SysTick->CTRL & SysTick_CTRL_ENABLE_Msk)
+            return;
+
+        SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+        SysTick->VAL = 0;
+        SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+    }
+
+    inline uint32_t CycleCounter::Read()
+    {
+        return SysTick->VAL;
+    }
+
+    inline uint32_t CycleCounter::Elapsed(uint32_t start, uint32_t end)
+    {
+        // SysTick counts down and reloads from LOAD
+        uint32_t ticks = start >= end
+            ? start - end
+            : start + SysTick->LOAD + 1 - end;
+
+        // External SysTick clock is core clock / 8
+        return (SysTick->CTRL & SysTick_CTRL_CLKSOURCE_Msk) ? ticks : ticks * 8;
+    }
+#endif
+
+    template<typename _Function>
+    uint32_t CycleCounter::Measure(_Function&& function)
+    {
+        Enable();
+        uint32_t start = Read();
+        function();
+        return Elapsed(start, Read());
+    }
+
+    namespace Private
+    {
+        inline void DelayCycles(uint32_t cycles)
+        {
+            CycleCounter::Enable();
+
+        #if defined (ZHELE_DELAY_DWT)
+            uint32_t start = CycleCounter::Read();
+            while (CycleCounter::Read() - start < cycles) ;
+        #else
+            // Sum up short intervals: SysTick period can be less than delay
+            uint32_t elapsed = 0;
+            uint32_t previous = CycleCounter::Read();
+            while (elapsed < cycles)
+            {
+                uint32_t current = CycleCounter::Read();
+                elapsed += CycleCounter::Elapsed(previous, current);
+                previous = current;
+            }
+        #endif
+        }
+    }
+
+    template<unsigned long us, unsigned long CpuFreq>
+    void delay_us()
+    {
+        static const uint32_t cycles = static_cast<uint64_t>(us) * CpuFreq / 1000000u;
+        Private::DelayCycles(cycles);
+    }
+
+    template<unsigned long ns, unsigned long CpuFreq>
+    void delay_ns()
+    {
+        static const uint32_t cycles = static_cast<uint64_t>(ns) * CpuFreq / 1000000000u;
+        Private::DelayCycles(cycles);
+    }
+}
+
+#endif //! ZHELE_DELAY_IMPL_COMMON_H
@@ -28,6 +28,22 @@ namespace Zhele
         }
     }
 
+    void DmaChannelData::NotifyHalfTransfer()
+    {
+        if(halfTransferCallback)
+        {
+            halfTransferCallback(data, size / 2, true);
+        }
+    }
+
+    void DmaChannelData::NotifyBufferComplete(unsigned bufferIndex)
+    {
+        if(doubleBufferedCallback)
+        {
+            doubleBufferedCallback(bufferIndex == 0 ? data : secondData, size, bufferIndex);
+        }
+    }
+
     #define DMACHANNEL_TEMPLATE_ARGS template<typename _Module, typename _ChannelRegs, unsigned _Channel, IRQn_Type _IRQNumber>
     #define DMACHANNEL_TEMPLATE_QUALIFIER DmaChannel<_Module, _ChannelRegs, _Channel, _IRQNumber>
 
@@ -44,20 +60,26 @@ namespace Zhele
     #if defined (DMA_CCR_EN)
         _ChannelRegs()->CCR = 0;
         _ChannelRegs()->CNDTR = bufferSize;
-        _ChannelRegs()->CPAR = reinterpret_cast<uint32_t>(periph);
-        _ChannelRegs()->CMAR = reinterpret_cast<uint32_t>(buffer);
+        _ChannelRegs()->CPAR = AddressOf(periph);
+        _ChannelRegs()->CMAR = AddressOf(buffer);
     #endif
     #if defined (DMA_SxCR_EN)
         _ChannelRegs()->CR = 0;
         _ChannelRegs()->NDTR = bufferSize;
-        _ChannelRegs()->PAR = reinterpret_cast<uint32_t>(periph);
-        _ChannelRegs()->M0AR = reinterpret_cast<uint32_t>(buffer);
+        _ChannelRegs()->PAR = AddressOf(periph);
+        _ChannelRegs()->M0AR = AddressOf(buffer);
     #endif
     Data.data = const_cast<void*>(buffer);
     Data.size = bufferSize;
+    Data.doubleBuffered = false;
+
+    Counters::Add(Statistics::DmaCounters::Transfers);
+    Counters::Add(Statistics::DmaCounters::Items, bufferSize);
 
     if(Data.transferCallback)
         mode = mode | DmaBase::TransferCompleteInterrupt | DmaBase::TransferErrorInterrupt;
+    if(Data.halfTransferCallback)
+        mode = mode | DmaBase::HalfTransferInterrupt;
 
     NVIC_EnableIRQ(_IRQNumber);
 
@@ -69,12 +91,108 @@ namespace Zhele
         _ChannelRegs()->CR = mode | ((channel & 0x07) << 25) | DMA_SxCR_EN;
     #endif
     }
+    DMACHANNEL_TEMPLATE_ARGS
+    void DMACHANNEL_TEMPLATE_QUALIFIER::TransferDoubleBuffered(Mode mode, void* buffer0, void* buffer1, volatile void* periph, uint32_t bufferSize
+    ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t channel))
+    {
+        _Module::Enable();
+        if(!TransferError())
+        {
+            while(!Ready())
+                ;
+        }
+    #if defined (DMA_CCR_EN)
+        // Emulation: circular transfer over both buffers, half transfer means first buffer complete
+        _ChannelRegs()->CCR = 0;
+        _ChannelRegs()->CNDTR = bufferSize * 2;
+        _ChannelRegs()->CPAR = AddressOf(periph);
+        _ChannelRegs()->CMAR = AddressOf(buffer0);
+        mode = mode | DmaBase::HalfTransferInterrupt;
+    #endif
+    #if defined (DMA_SxCR_EN)
+        _ChannelRegs()->CR = 0;
+        _ChannelRegs()->NDTR = bufferSize;
+        _ChannelRegs()->PAR = AddressOf(periph);
+        _ChannelRegs()->M0AR = AddressOf(buffer0);
+        _ChannelRegs()->M1AR = AddressOf(buffer1);
+        mode = mode | static_cast<Mode>(DMA_SxCR_DBM);
+    #endif
+        Data.data = buffer0;
+        Data.secondData = buffer1;
+        Data.size = bufferSize;
+        Data.doubleBuffered = true;
+
+        Counters::Add(Statistics::DmaCounters::Transfers);
+        Counters::Add(Statistics::DmaCounters::Items, bufferSize * 2);
+
+        mode = mode | DmaBase::Circular | DmaBase::TransferCompleteInterrupt | DmaBase::TransferErrorInterrupt;
+
+        NVIC_EnableIRQ(_IRQNumber);
+
+    #if defined (DMA_CCR_EN)
+        ONLY_IF_STREAM_SUPPORTED (_Module::template SetChannelSelect<_Channel> (channel));
+        _ChannelRegs()->CCR = mode | DMA_CCR_EN;
+    #endif
+    #if defined (DMA_SxCR_EN)
+        _ChannelRegs()->CR = mode | ((channel & 0x07) << 25) | DMA_SxCR_EN;
+    #endif
+    }
+
+    DMACHANNEL_TEMPLATE_ARGS
+    unsigned DMACHANNEL_TEMPLATE_QUALIFIER::CurrentBuffer()
+    {
+    #if defined (DMA_CCR_EN)
+        return RemainingTransfers() > Data.size ? 0 : 1;
+    #endif
+    #if defined (DMA_SxCR_EN)
+        return (_ChannelRegs()->CR & DMA_SxCR_CT) ? 1 : 0;
+    #endif
+    }
+
+    DMACHANNEL_TEMPLATE_ARGS
+    void DMACHANNEL_TEMPLATE_QUALIFIER::SetDoubleBufferedTransferCallback(DoubleBufferedTransferCallback callback)
+    {
+        Data.doubleBufferedCallback = callback;
+    }
+
     DMACHANNEL_TEMPLATE_ARGS
     void DMACHANNEL_TEMPLATE_QUALIFIER::SetTransferCallback(TransferCallback callback)
     {
         Data.transferCallback = callback;
     }
 
+    DMACHANNEL_TEMPLATE_ARGS
+    void DMACHANNEL_TEMPLATE_QUALIFIER::SetHalfTransferCallback(TransferCallback callback)
+    {
+        Data.halfTransferCallback = callback;
+    }
+
+#if defined (DMA_SxCR_EN)
+    DMACHANNEL_TEMPLATE_ARGS
+    void DMACHANNEL_TEMPLATE_QUALIFIER::SetFifoMode(bool enabled)
+    {
+        _ChannelRegs()->FCR = enabled ? (DMA_SxFCR_DMDIS | DMA_SxFCR_FTH) : 0;
+    }
+
+    DMACHANNEL_TEMPLATE_ARGS
+    template<typename _Fifo>
+    void DMACHANNEL_TEMPLATE_QUALIFIER::Transfer(Mode mode, const void* buffer, volatile void* periph, uint32_t bufferSize, uint8_t channel)
+    {
+        _Module::Enable();
+        if(!TransferError())
+        {
+            while(!Ready())
+                ;
+        }
+
+        // FIFO control can be changed only while stream is disabled
+        _ChannelRegs()->CR = 0;
+        _ChannelRegs()->FCR = _Fifo::FifoControl;
+
+        Transfer(static_cast<Mode>((static_cast<uint32_t>(mode) & ~_Fifo::ControlMask) | _Fifo::Control), buffer, periph, bufferSize, channel);
+    }
+#endif
+
     DMACHANNEL_TEMPLATE_ARGS
     bool DMACHANNEL_TEMPLATE_QUALIFIER::Ready()
     {
@@ -174,23 +292,93 @@ namespace Zhele
     DMACHANNEL_TEMPLATE_ARGS
     void DMACHANNEL_TEMPLATE_QUALIFIER::IrqHandler()
     {
+        HandleInterrupt<nullptr, nullptr>();
+    }
+
+    DMACHANNEL_TEMPLATE_ARGS
+    template<TransferCallback _Callback, TransferCallback _HalfCallback>
+    void DMACHANNEL_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        HandleInterrupt<_Callback, _HalfCallback>();
+    }
+
+    DMACHANNEL_TEMPLATE_ARGS
+    template<TransferCallback _Callback, TransferCallback _HalfCallback>
+    void DMACHANNEL_TEMPLATE_QUALIFIER::HandleInterrupt()
+    {
+        ZHELE_PROFILE_ISR();
+
+        if(Data.doubleBuffered)
+        {
+        #if defined (DMA_CCR_EN)
+            if(HalfTransfer())
+            {
+                ClearHalfTransfer();
+                Counters::Add(Statistics::DmaCounters::Completed);
+                Data.NotifyBufferComplete(0);
+            }
+            if(TransferComplete())
+            {
+                ClearTransferComplete();
+                Counters::Add(Statistics::DmaCounters::Completed);
+                Data.NotifyBufferComplete(1);
+            }
+        #endif
+        #if defined (DMA_SxCR_EN)
+            if(TransferComplete())
+            {
+                ClearTransferComplete();
+                Counters::Add(Statistics::DmaCounters::Completed);
+                // Target memory is already switched, so completed buffer is the other one
+                Data.NotifyBufferComplete((_ChannelRegs()->CR & DMA_SxCR_CT) ? 0 : 1);
+            }
+        #endif
+            if(TransferError())
+            {
+                ClearFlags();
+                Disable();
+                Counters::Add(Statistics::DmaCounters::Errors);
+                Data.doubleBuffered = false;
+                Data.NotifyError();
+            }
+            return;
+        }
+
+        // Half transfer first: both flags may be set if interrupt was delayed
+        if(HalfTransfer() && (_ChannelRegs()->ONLY_FOR_CCR(CCR)ONLY_FOR_SXCR(CR) & Mode::HalfTransferInterrupt))
+        {
+            ClearHalfTransfer();
+
+            if constexpr (_HalfCallback != nullptr)
+                _HalfCallback(Data.data, Data.size / 2, true);
+            else
+                Data.NotifyHalfTransfer();
+        }
         if(TransferComplete())
         {
             ClearFlags();
+            Counters::Add(Statistics::DmaCounters::Completed);
             
             if(static_cast<uint32_t>(_ChannelRegs()->ONLY_FOR_CCR(CCR)ONLY_FOR_SXCR(CR) & Mode::Circular) == 0)
                 Disable();
 
-            Data.NotifyTransferComplete();
+            if constexpr (_Callback != nullptr)
+                _Callback(Data.data, Data.size, true);
+            else
+                Data.NotifyTransferComplete();
         }
         if(TransferError())
         {
             ClearFlags();
+            Counters::Add(Statistics::DmaCounters::Errors);
 
             if(static_cast<uint32_t>(_ChannelRegs()->ONLY_FOR_CCR(CCR)ONLY_FOR_SXCR(CR) & Mode::Circular) == 0)
                 Disable();
 
-            Data.NotifyError();
+            if constexpr (_Callback != nullptr)
+                _Callback(Data.data, Data.size, false);
+            else
+                Data.NotifyError();
         }
     }
 
@@ -372,5 +560,204 @@ namespace Zhele
                 | (channelSelect << 4 * channel);
         }
     #endif
+
+    #define DMATRANSFERQUEUE_TEMPLATE_ARGS template<typename _DmaChannel, unsigned _Depth>
+    #define DMATRANSFERQUEUE_TEMPLATE_QUALIFIER DmaTransferQueue<_DmaChannel, _Depth>
+
+    DMATRANSFERQUEUE_TEMPLATE_ARGS
+    bool DMATRANSFERQUEUE_TEMPLATE_QUALIFIER::Enqueue(Mode mode, const void* buffer, volatile void* periph, uint32_t bufferSize, TransferCallback callback)
+    {
+        DmaTransferDescriptor descriptor{mode, buffer, periph, bufferSize, callback};
+        bool result = true;
+
+        // Channel IRQ handler pops queue, so lock it while check state
+        NVIC_DisableIRQ(_DmaChannel::IRQNumber);
+        if(!_busy)
+        {
+            _busy = true;
+            Start(descriptor);
+        }
+        else
+        {
+            result = _queue.push_back(descriptor);
+        }
+        NVIC_EnableIRQ(_DmaChannel::IRQNumber);
+
+        return result;
+    }
+
+    DMATRANSFERQUEUE_TEMPLATE_ARGS
+    bool DMATRANSFERQUEUE_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _busy;
+    }
+
+    DMATRANSFERQUEUE_TEMPLATE_ARGS
+    unsigned DMATRANSFERQUEUE_TEMPLATE_QUALIFIER::Pending()
+    {
+        return _queue.size();
+    }
+
+    DMATRANSFERQUEUE_TEMPLATE_ARGS
+    void DMATRANSFERQUEUE_TEMPLATE_QUALIFIER::Clear()
+    {
+        NVIC_DisableIRQ(_DmaChannel::IRQNumber);
+        _queue.clear();
+        NVIC_EnableIRQ(_DmaChannel::IRQNumber);
+    }
+
+    DMATRANSFERQUEUE_TEMPLATE_ARGS
+    void DMATRANSFERQUEUE_TEMPLATE_QUALIFIER::Start(const DmaTransferDescriptor& descriptor)
+    {
+        _activeCallback = descriptor.callback;
+        _DmaChannel::SetTransferCallback(TransferHandler);
+        _DmaChannel::Transfer(descriptor.mode, descriptor.buffer, descriptor.periph, descriptor.size);
+    }
+
+    DMATRANSFERQUEUE_TEMPLATE_ARGS
+    void DMATRANSFERQUEUE_TEMPLATE_QUALIFIER::TransferHandler(void* data, unsigned size, bool success)
+    {
+        TransferCallback completedCallback = _activeCallback;
+
+        // Keep bus busy: start next transfer before user callback
+        if(!_queue.empty())
+        {
+            DmaTransferDescriptor next = _queue.front();
+            _queue.pop_front();
+            Start(next);
+        }
+        else
+        {
+            _activeCallback = nullptr;
+            _busy = false;
+        }
+
+        if(completedCallback)
+            completedCallback(data, size, success);
+    }
+
+    #define DMAMEMCPY_TEMPLATE_ARGS template<typename _DmaChannel, unsigned _SyncThreshold>
+    #define DMAMEMCPY_TEMPLATE_QUALIFIER DmaMemcpy<_DmaChannel, _SyncThreshold>
+
+    DMAMEMCPY_TEMPLATE_ARGS
+    void DMAMEMCPY_TEMPLATE_QUALIFIER::Copy(void* destination, const void* source, uint32_t size, TransferCallback callback)
+    {
+        Wait();
+
+        if(size < _SyncThreshold)
+        {
+            memcpy(destination, source, size);
+            if(callback)
+                callback(destination, size, true);
+            return;
+        }
+
+        Start(destination, source, size, true, callback);
+    }
+
+    DMAMEMCPY_TEMPLATE_ARGS
+    void DMAMEMCPY_TEMPLATE_QUALIFIER::Fill(void* destination, uint8_t pattern, uint32_t size, TransferCallback callback)
+    {
+        Wait();
+
+        if(size < _SyncThreshold)
+        {
+            memset(destination, pattern, size);
+            if(callback)
+                callback(destination, size, true);
+            return;
+        }
+
+        // Pattern is replicated, so any data width reads the same bytes
+        _pattern = pattern * 0x01010101u;
+        Start(destination, &_pattern, size, false, callback);
+    }
+
+    DMAMEMCPY_TEMPLATE_ARGS
+    bool DMAMEMCPY_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _busy;
+    }
+
+    DMAMEMCPY_TEMPLATE_ARGS
+    void DMAMEMCPY_TEMPLATE_QUALIFIER::Wait()
+    {
+        while(_busy)
+            ;
+    }
+
+    DMAMEMCPY_TEMPLATE_ARGS
+    unsigned DMAMEMCPY_TEMPLATE_QUALIFIER::SelectDataWidth(uintptr_t destination, uintptr_t source, uint32_t size)
+    {
+        uintptr_t alignment = destination | source | size;
+
+        if((alignment & 0x03) == 0)
+            return 4;
+        if((alignment & 0x01) == 0)
+            return 2;
+        return 1;
+    }
+
+    DMAMEMCPY_TEMPLATE_ARGS
+    void DMAMEMCPY_TEMPLATE_QUALIFIER::Start(void* destination, const void* source, uint32_t size, bool sourceIncrement, TransferCallback callback)
+    {
+        _dataWidth = SelectDataWidth(reinterpret_cast<uintptr_t>(destination),
+            sourceIncrement ? reinterpret_cast<uintptr_t>(source) : 0, size);
+
+        // In Mem2Mem mode source = periph, destination = mem
+        Mode mode = DmaBase::Mem2Mem | DmaBase::MemIncrement;
+        if(sourceIncrement)
+            mode = mode | DmaBase::PeriphIncrement;
+        if(_dataWidth == 4)
+            mode = mode | DmaBase::MSize32Bits | DmaBase::PSize32Bits;
+        else if(_dataWidth == 2)
+            mode = mode | DmaBase::MSize16Bits | DmaBase::PSize16Bits;
+
+        _mode = mode;
+        _callback = callback;
+        _destination = destination;
+        _size = size;
+        _nextDestination = static_cast<uint8_t*>(destination);
+        _nextSource = static_cast<const uint8_t*>(source);
+        _remaining = size;
+        _busy = true;
+
+        _DmaChannel::SetTransferCallback(TransferHandler);
+        StartChunk();
+    }
+
+    DMAMEMCPY_TEMPLATE_ARGS
+    void DMAMEMCPY_TEMPLATE_QUALIFIER::StartChunk()
+    {
+        // Channel counter is 16-bit
+        uint32_t items = _remaining / _dataWidth;
+        if(items > 0xffff)
+            items = 0xffff;
+
+        uint8_t* destination = _nextDestination;
+        const uint8_t* source = _nextSource;
+
+        _nextDestination += items * _dataWidth;
+        if(_mode & DmaBase::PeriphIncrement)
+            _nextSource += items * _dataWidth;
+        _remaining -= items * _dataWidth;
+
+        _DmaChannel::Transfer(_mode, destination, const_cast<uint8_t*>(source), items);
+    }
+
+    DMAMEMCPY_TEMPLATE_ARGS
+    void DMAMEMCPY_TEMPLATE_QUALIFIER::TransferHandler(void* data, unsigned size, bool success)
+    {
+        if(success && _remaining > 0)
+        {
+            StartChunk();
+            return;
+        }
+
+        _busy = false;
+
+        if(_callback)
+            _callback(_destination, _size, success);
+    }
 }
 #endif //! ZHELE_DMA_IMPL_COMMON_H
\ No newline at end of file
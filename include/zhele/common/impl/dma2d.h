@@ -0,0 +1,106 @@
+/**
+ * @file
+ * Contains DMA2D methods definition
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMA2D_IMPL_COMMON_H
+#define ZHELE_DMA2D_IMPL_COMMON_H
+
+namespace Zhele
+{
+    void Dma2d::Init()
+    {
+        Clock::Dma2DClock::Enable();
+    }
+
+    void Dma2d::Fill(void* destination, uint16_t stride, uint16_t width, uint16_t height, uint32_t color, ColorMode mode)
+    {
+        Wait();
+
+        SetOutput(destination, mode, stride, width, height);
+        DMA2D->OCOLR = color;
+
+        Start(Mode::RegisterToMemory);
+    }
+
+    void Dma2d::Copy(const void* source, uint16_t sourceStride, void* destination, uint16_t destinationStride, uint16_t width, uint16_t height, ColorMode mode)
+    {
+        Wait();
+
+        SetOutput(destination, mode, destinationStride, width, height);
+        DMA2D->FGMAR = reinterpret_cast<uint32_t>(source);
+        DMA2D->FGOR = sourceStride - width;
+        DMA2D->FGPFCCR = static_cast<uint32_t>(mode);
+
+        Start(Mode::MemoryToMemory);
+    }
+
+    void Dma2d::Convert(const void* source, InputColorMode sourceMode, uint16_t sourceStride,
+        void* destination, ColorMode destinationMode, uint16_t destinationStride, uint16_t width, uint16_t height)
+    {
+        Wait();
+
+        SetOutput(destination, destinationMode, destinationStride, width, height);
+        DMA2D->FGMAR = reinterpret_cast<uint32_t>(source);
+        DMA2D->FGOR = sourceStride - width;
+        DMA2D->FGPFCCR = static_cast<uint32_t>(sourceMode);
+
+        Start(Mode::MemoryToMemoryPfc);
+    }
+
+    void Dma2d::Blend(const void* foreground, InputColorMode foregroundMode, uint16_t foregroundStride,
+        const void* background, InputColorMode backgroundMode, uint16_t backgroundStride,
+        void* destination, ColorMode destinationMode, uint16_t destinationStride,
+        uint16_t width, uint16_t height, uint8_t alpha, uint32_t color)
+    {
+        // Foreground alpha is multiplied by given one
+        constexpr uint32_t MultiplyAlpha = 0b10;
+
+        Wait();
+
+        SetOutput(destination, destinationMode, destinationStride, width, height);
+        DMA2D->FGMAR = reinterpret_cast<uint32_t>(foreground);
+        DMA2D->FGOR = foregroundStride - width;
+        DMA2D->FGCOLR = color & 0x00ffffff;
+        DMA2D->FGPFCCR = static_cast<uint32_t>(foregroundMode)
+            | (MultiplyAlpha << DMA2D_FGPFCCR_AM_Pos)
+            | (static_cast<uint32_t>(alpha) << DMA2D_FGPFCCR_ALPHA_Pos);
+
+        DMA2D->BGMAR = reinterpret_cast<uint32_t>(background);
+        DMA2D->BGOR = backgroundStride - width;
+        DMA2D->BGPFCCR = static_cast<uint32_t>(backgroundMode);
+
+        Start(Mode::MemoryToMemoryBlend);
+    }
+
+    bool Dma2d::Busy()
+    {
+        return (DMA2D->CR & DMA2D_CR_START) != 0;
+    }
+
+    bool Dma2d::Wait()
+    {
+        while (Busy()) continue;
+
+        return (DMA2D->ISR & (DMA2D_ISR_TEIF | DMA2D_ISR_CEIF)) == 0;
+    }
+
+    void Dma2d::SetOutput(void* destination, ColorMode mode, uint16_t stride, uint16_t width, uint16_t height)
+    {
+        DMA2D->OPFCCR = static_cast<uint32_t>(mode);
+        DMA2D->OMAR = reinterpret_cast<uint32_t>(destination);
+        DMA2D->OOR = stride - width;
+        DMA2D->NLR = (static_cast<uint32_t>(width) << DMA2D_NLR_PL_Pos) | height;
+    }
+
+    void Dma2d::Start(Mode mode)
+    {
+        DMA2D->IFCR = DMA2D_IFCR_CTEIF | DMA2D_IFCR_CTCIF | DMA2D_IFCR_CCEIF;
+        DMA2D->CR = (static_cast<uint32_t>(mode) << DMA2D_CR_MODE_Pos) | DMA2D_CR_START;
+    }
+}
+
+#endif //! ZHELE_DMA2D_IMPL_COMMON_H
@@ -72,5 +72,97 @@ namespace Zhele
     {
         return static_cast<_RequestInput>(RequestPolarityBitfield::Get());
     }
+
+    DMAMUXIMPL_TEMPLATE_ARGS
+    template<unsigned _GeneratorNumber>
+    inline void DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::Configure(_SyncInput signal, Polarity polarity, uint8_t requests)
+    {
+        // Requests count can be changed only while generator is disabled
+        Disable();
+        SetSignalInput(signal);
+        SetRequestCount(requests);
+        SetPolarity(polarity);
+        ClearOverrun();
+        Enable();
+    }
+
+    DMAMUXIMPL_TEMPLATE_ARGS
+    template<unsigned _GeneratorNumber>
+    inline void DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::SetSignalInput(_SyncInput signal)
+    {
+        SignalInputBitfield::Set(static_cast<uint32_t>(signal));
+    }
+
+    DMAMUXIMPL_TEMPLATE_ARGS
+    template<unsigned _GeneratorNumber>
+    inline _SyncInput DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::GetSignalInput()
+    {
+        return static_cast<_SyncInput>(SignalInputBitfield::Get());
+    }
+
+    DMAMUXIMPL_TEMPLATE_ARGS
+    template<unsigned _GeneratorNumber>
+    inline void DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::SetPolarity(Polarity polarity)
+    {
+        PolarityBitfield::Set(static_cast<uint32_t>(polarity));
+    }
+
+    DMAMUXIMPL_TEMPLATE_ARGS
+    template<unsigned _GeneratorNumber>
+    inline DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::Polarity DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::GetPolarity()
+    {
+        return static_cast<Polarity>(PolarityBitfield::Get());
+    }
+
+    DMAMUXIMPL_TEMPLATE_ARGS
+    template<unsigned _GeneratorNumber>
+    inline void DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::SetRequestCount(uint8_t requests)
+    {
+        RequestCountBitfield::Set(requests > 0 ? requests - 1u : 0u);
+    }
+
+    DMAMUXIMPL_TEMPLATE_ARGS
+    template<unsigned _GeneratorNumber>
+    inline uint8_t DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::GetRequestCount()
+    {
+        return static_cast<uint8_t>(RequestCountBitfield::Get() + 1);
+    }
+
+    DMAMUXIMPL_TEMPLATE_ARGS
+    template<unsigned _GeneratorNumber>
+    inline void DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::Enable()
+    {
+        RequestGeneratorRegs::Get()[_GeneratorNumber].RGCR |= DMAMUX_RGxCR_GE;
+    }
+
+    DMAMUXIMPL_TEMPLATE_ARGS
+    template<unsigned _GeneratorNumber>
+    inline void DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::Disable()
+    {
+        RequestGeneratorRegs::Get()[_GeneratorNumber].RGCR &= ~DMAMUX_RGxCR_GE;
+    }
+
+    DMAMUXIMPL_TEMPLATE_ARGS
+    template<unsigned _GeneratorNumber>
+    inline bool DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::IsOverrun()
+    {
+        return (RequestGeneratorStatusReg::Get()->RGSR & (DMAMUX_RGSR_OF0 << _GeneratorNumber)) != 0;
+    }
+
+    DMAMUXIMPL_TEMPLATE_ARGS
+    template<unsigned _GeneratorNumber>
+    inline void DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::ClearOverrun()
+    {
+        RequestGeneratorStatusReg::Get()->RGCFR = DMAMUX_RGCFR_COF0 << _GeneratorNumber;
+    }
+
+    DMAMUXIMPL_TEMPLATE_ARGS
+    template<unsigned _GeneratorNumber>
+    template<typename _DmaChannel, unsigned _MuxChannel>
+    inline void DMAMUXIMPL_TEMPLATE_QUALIFIER::RequestGenerator<_GeneratorNumber>::Route()
+    {
+        _DmaChannel::Module::Enable();
+        Channel<_MuxChannel>::SelectRequestInput(Request);
+    }
 }
 #endif  //! ZHELE_DMAMUX_IMPL_COMMON_H
\ No newline at end of file
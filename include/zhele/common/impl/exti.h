@@ -66,7 +66,7 @@ namespace Zhele
     template<uint8_t _Line, IRQn_Type _IRQn>
     void Exti<_Line, _IRQn>::ClearInterruptFlag()
     {
-        EXTI->PR |= (1 << _Line);
+        EXTI->PR = (1 << _Line);
     }
 }
 #endif //! ZHELE_EXTI_IMPL_COMMON_H
\ No newline at end of file
@@ -10,6 +10,7 @@
 #define ZHELE_FLASH_IMPL_COMMON_H
 
 #include <cstdint>
+#include <span>
 
 namespace Zhele
 {
@@ -41,6 +42,20 @@ namespace Zhele
     #endif
     }
 
+    inline constexpr uint32_t Flash::Latency(uint32_t frequence)
+    {
+        uint32_t ws = (frequence - 1) / ZHELE_FLASH_WAIT_STATE_FREQUENCE;
+        return ws > ZHELE_FLASH_MAX_LATENCY ? ZHELE_FLASH_MAX_LATENCY : ws;
+    }
+
+    inline void Flash::SetLatency(uint32_t latency)
+    {
+        FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) | latency;
+        // New latency must be checked before frequence change
+        while ((FLASH->ACR & FLASH_ACR_LATENCY) != latency)
+            continue;
+    }
+
     inline constexpr uint32_t Flash::PageAddress(unsigned page)
     {
         return FLASH_BASE + page * PageSize(page);
@@ -72,7 +87,7 @@ namespace Zhele
     inline bool Flash::WritePage(void* dst, const void* src, unsigned size)
     {
         unsigned page = AddressToPage(dst);
-		uint32_t offset = reinterpret_cast<uint32_t>(dst) - PageAddress(page);
+		uint32_t offset = AddressOf(dst) - PageAddress(page);
 
         if(page > PageCount())
             return false;
@@ -94,9 +109,52 @@ namespace Zhele
 		return WriteFlash(reinterpret_cast<uint8_t*>(PageAddress(page)) + offset, src, size);
     }
 
+    inline bool Flash::IsBusy()
+    {
+        return _asyncOperation != AsyncOperation::None;
+    }
+
+    ZHELE_RAMFUNC inline void Flash::CompleteAsync(bool success)
+    {
+        AsyncCallback callback = _asyncCallback;
+        _asyncCallback = nullptr;
+        _asyncOperation = AsyncOperation::None;
+        FLASH->CR |= FLASH_CR_LOCK; // Lock() may be not inlined, so it can be in flash
+
+        if (callback != nullptr)
+            callback(success);
+    }
+
+    template<typename _Crc>
+    inline bool Flash::Verify(const void* address, unsigned size, uint32_t crc)
+    {
+        _Crc::Begin();
+        _Crc::Update(std::span<const uint8_t>(static_cast<const uint8_t*>(address), size));
+        return _Crc::Finish() == crc;
+    }
+
+#if defined (ZHELE_FLASH_DUAL_BANK)
+    inline Flash::Bank Flash::InactiveBank()
+    {
+        return ActiveBank() == Bank::Bank1 ? Bank::Bank2 : Bank::Bank1;
+    }
+
+    inline uint32_t Flash::BankAddress(Bank bank)
+    {
+        return bank == ActiveBank() ? FLASH_BASE : FLASH_BASE + BankSize();
+    }
+
+    inline Flash::Bank Flash::AddressToBank(const void* address)
+    {
+        return AddressOf(address) < FLASH_BASE + BankSize() ? ActiveBank() : InactiveBank();
+    }
+#endif
+
     inline void Flash::WaitWhileBusy()
     {
-    #if defined (FLASH_SR_BSY1)
+    #if defined (FLASH_SR_BSY2)
+        while(FLASH->SR & (FLASH_SR_BSY1 | FLASH_SR_BSY2)) continue;
+    #elif defined (FLASH_SR_BSY1)
         while(FLASH->SR & FLASH_SR_BSY1 ) continue;
     #else
         while(FLASH->SR & FLASH_SR_BSY) continue;
@@ -36,6 +36,27 @@ namespace Zhele
 
         I2C_TEMPLATE_ARGS
         typename I2C_TEMPLATE_QUALIFIER::AsyncTransferData I2C_TEMPLATE_QUALIFIER::_transferData;
+
+        I2C_TEMPLATE_ARGS
+        typename I2C_TEMPLATE_QUALIFIER::SlaveTransferData I2C_TEMPLATE_QUALIFIER::_slaveData;
+
+        I2C_TEMPLATE_ARGS
+        I2cTickSource I2C_TEMPLATE_QUALIFIER::_tickSource = nullptr;
+
+        I2C_TEMPLATE_ARGS
+        uint32_t I2C_TEMPLATE_QUALIFIER::_timeoutTicks = 0;
+
+        I2C_TEMPLATE_ARGS
+        std::add_pointer_t<bool()> I2C_TEMPLATE_QUALIFIER::_busClear = nullptr;
+
+        I2C_TEMPLATE_ARGS
+        uint32_t I2C_TEMPLATE_QUALIFIER::_clockSpeed = 0;
+
+    #if defined (I2C_TYPE_2)
+        I2C_TEMPLATE_ARGS
+        bool I2C_TEMPLATE_QUALIFIER::_dutyCycle2 = false;
+    #endif
+
     #if defined (I2C_TYPE_1)
     static inline uint32_t CalcTiming (uint32_t sourceClock, uint32_t sclClock)
     {
@@ -71,11 +92,95 @@ namespace Zhele
     void I2C_TEMPLATE_QUALIFIER::Init(uint32_t i2cClockSpeed)
     {
         _ClockCtrl::Enable();
-        
+        ApplyTiming(CalcTiming(_ClockCtrl::ClockFreq(), i2cClockSpeed), i2cClockSpeed > 400000);
+        _clockSpeed = i2cClockSpeed;
+        Clock::ClockChange::Subscribe<ClockChanged>();
+    }
+
+    I2C_TEMPLATE_ARGS
+    template<unsigned long sclFrequency, unsigned long clockFrequency, unsigned maxErrorPercent>
+    void I2C_TEMPLATE_QUALIFIER::Init()
+    {
+        constexpr I2cTiming timing = CalculateTiming(clockFrequency, sclFrequency);
+        static_assert(timing.Frequency != 0, "SCL frequency is unreachable with given clock frequency");
+        static_assert(timing.Frequency * 100 >= sclFrequency * (100 - maxErrorPercent), "Achieved SCL frequency is too low");
+
+        _ClockCtrl::Enable();
+        ApplyTiming(timing.Timing, sclFrequency > 400000);
+        _clockSpeed = sclFrequency;
+        Clock::ClockChange::Subscribe<ClockChanged>();
+    }
+
+    I2C_TEMPLATE_ARGS
+    constexpr I2cTiming I2C_TEMPLATE_QUALIFIER::CalculateTiming(uint32_t clockFrequency, uint32_t sclFrequency)
+    {
+        if (clockFrequency == 0 || sclFrequency == 0 || sclFrequency > 1000000)
+            return {0, 0};
+
+        bool stdMode = sclFrequency <= 100000;
+        bool fstMode = sclFrequency <= 400000;
+
+        // I2C specification values (nsec)
+        uint32_t lowMin = stdMode ? 4700 : fstMode ? 1300 : 500;
+        uint32_t highMin = stdMode ? 4000 : fstMode ? 600 : 260;
+        uint32_t riseTime = stdMode ? 1000 : fstMode ? 300 : 120;
+        uint32_t fallTime = fstMode ? 300 : 120;
+        uint32_t setupMin = stdMode ? 250 : fstMode ? 100 : 50;
+        const uint32_t analogFilterMin = 50;
+
+        auto toCycles = [clockFrequency](uint32_t ns, bool roundUp) {
+            return static_cast<uint32_t>((static_cast<uint64_t>(ns) * clockFrequency + (roundUp ? 999999999 : 0)) / 1000000000);
+        };
+        auto divUp = [](uint32_t value, uint32_t divider) { return (value + divider - 1) / divider; };
+        auto subtract = [](uint32_t value, uint32_t delta) { return value > delta ? value - delta : 0; };
+
+        // Each SCL edge is delayed by analog filter and input synchronization (2 kernel clocks)
+        uint32_t syncDelay = toCycles(analogFilterMin, false) + 2;
+        uint32_t overhead = toCycles(riseTime + fallTime, true) + 2 * syncDelay;
+        uint32_t period = (clockFrequency + sclFrequency - 1) / sclFrequency;
+        uint32_t lowCycles = subtract(toCycles(lowMin, true), syncDelay);
+        uint32_t highCycles = subtract(toCycles(highMin, true), syncDelay);
+        uint32_t scldelCycles = toCycles(riseTime + setupMin, true);
+        uint32_t sdadelCycles = subtract(toCycles(fallTime, true), syncDelay + 1);
+
+        for (uint32_t presc = 0; presc < 16; ++presc)
+        {
+            uint32_t prescaler = presc + 1;
+            uint32_t low = std::max(divUp(lowCycles, prescaler), 1u);
+            uint32_t high = std::max(divUp(highCycles, prescaler), 1u);
+            uint32_t units = divUp(subtract(period, overhead), prescaler);
+            if (units > low + high)
+            {
+                uint32_t extra = units - low - high;
+                low += extra - extra / 2;
+                high += extra / 2;
+            }
+            uint32_t scldel = std::max(divUp(scldelCycles, prescaler), 1u);
+            uint32_t sdadel = divUp(sdadelCycles, prescaler);
+
+            if (low > 256 || high > 256 || scldel > 16 || sdadel > 15)
+                continue;
+
+            return {
+                (presc << I2C_TIMINGR_PRESC_Pos) | ((scldel - 1) << I2C_TIMINGR_SCLDEL_Pos) | (sdadel << I2C_TIMINGR_SDADEL_Pos)
+                    | ((high - 1) << I2C_TIMINGR_SCLH_Pos) | ((low - 1) << I2C_TIMINGR_SCLL_Pos),
+                clockFrequency / ((low + high) * prescaler + overhead)
+            };
+        }
+
+        return {0, 0};
+    }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::ApplyTiming(uint32_t timing, bool fastModePlus)
+    {
         _Regs()->CR1 &= ~I2C_CR1_PE;
         while (_Regs()->CR1 & I2C_CR1_PE) {};
 
-        _Regs()->TIMINGR = CalcTiming(_ClockCtrl::ClockFreq(), i2cClockSpeed);
+        if (fastModePlus)
+            EnableFastModePlus();
+
+        _Regs()->TIMINGR = timing;
         _Regs()->CR1 |= I2C_CR1_PE;
 
         while ((_Regs()->CR1 & I2C_CR1_PE) == 0) {};
@@ -84,6 +189,22 @@ namespace Zhele
         _Regs()->OAR2 = 0;
     }
 
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::ClockChanged()
+    {
+        if (_clockSpeed == 0)
+            return;
+
+        // Disabling I2C aborts transfer
+        WaitWhileBusy();
+
+        _Regs()->CR1 &= ~I2C_CR1_PE;
+        while (_Regs()->CR1 & I2C_CR1_PE) {};
+
+        _Regs()->TIMINGR = CalcTiming(_ClockCtrl::ClockFreq(), _clockSpeed);
+        _Regs()->CR1 |= I2C_CR1_PE;
+    }
+
     I2C_TEMPLATE_ARGS
     I2cStatus I2C_TEMPLATE_QUALIFIER::WriteU8(uint16_t devAddr, uint16_t regAddr, uint8_t data, I2cOpts opts)
     {
@@ -159,68 +280,75 @@ namespace Zhele
     I2C_TEMPLATE_ARGS
     I2cStatus I2C_TEMPLATE_QUALIFIER::WriteAsync(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cOpts opts, I2cCallback callback)
     {
-        if(!WaitWhileBusy())
-            return I2cStatus::Busy;
-        
-        if(!WriteDevAddrForWrite(devAddr, opts))
-            return GetErorFromEvent(GetLastEvent());
-
-        if(!HasAnyFlag(opts, I2cOpts::RegAddrNone))
+        if constexpr (std::is_same_v<_DmaTx, void>)
         {
-            if(!WriteRegAddr(regAddr, opts))
-                return GetErorFromEvent(GetLastEvent());
+            return CompleteSync(Write(devAddr, regAddr, data, size, opts), callback);
         }
-
-        _transferData.Buffer = const_cast<uint8_t*>(data);
-        _transferData.Size = size;
-        _transferData.Callback = callback;
-
-        SetTransferSize(size > 255 ? 255 : size, size <= 255);
-        _DmaTx::ClearTransferComplete();
-        _Regs()->CR1 |= I2C_CR1_TXDMAEN;
-        _DmaTx::SetTransferCallback([](void* buffer, unsigned bytesTransmit, bool success)
+        else
         {
-            if (!success)
+            if(!WaitWhileBusy())
+                return I2cStatus::Busy;
+        
+            if(!WriteDevAddrForWrite(devAddr, opts))
+                return GetErorFromEvent(GetLastEvent());
+
+            if(!HasAnyFlag(opts, I2cOpts::RegAddrNone))
             {
-                if(_transferData.Callback != nullptr)
-                    _transferData.Callback(GetErorFromEvent(GetLastEvent()));
-                return;
+                if(!WriteRegAddr(regAddr, opts))
+                    return GetErorFromEvent(GetLastEvent());
             }
 
-            _transferData.Size -= bytesTransmit;
-            _transferData.Buffer += bytesTransmit;
+            _transferData.Buffer = const_cast<uint8_t*>(data);
+            _transferData.Size = size;
+            _transferData.Callback = callback;
 
-            if(!WaitEvent(_transferData.Size > 0 ? TransfertCompleteReload : TransfertComplete))
+            SetTransferSize(size > 255 ? 255 : size, size <= 255);
+            _DmaTx::ClearTransferComplete();
+            _Regs()->CR1 |= I2C_CR1_TXDMAEN;
+            _DmaTx::SetTransferCallback([](void* buffer, unsigned bytesTransmit, bool success)
             {
-                if(_transferData.Callback != nullptr)
-                    _transferData.Callback(GetErorFromEvent(GetLastEvent()));
-                return;
-            }
+                if (!success)
+                {
+                    if(_transferData.Callback != nullptr)
+                        _transferData.Callback(GetErorFromEvent(GetLastEvent()));
+                    return;
+                }
 
-            if(_transferData.Size > 255)
-            {
-                SetTransferSize(255, false);
-                _DmaTx::ClearTransferComplete();
-                _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, _transferData.Buffer, &_Regs()->TXDR, 255);
-                return;
-            }
-            if(_transferData.Size > 0)
-            {
-                SetTransferSize(_transferData.Size & 0xff);
-                _DmaTx::ClearTransferComplete();
-                _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, _transferData.Buffer, &_Regs()->TXDR, _transferData.Size);
-            }
-            else
-            {
-                _Regs()->CR1 &= ~I2C_CR1_TXDMAEN;
-                if(_transferData.Callback != nullptr)
-                    _transferData.Callback(I2cStatus::Success);
-            }
-        });
+                _transferData.Size -= bytesTransmit;
+                _transferData.Buffer += bytesTransmit;
+
+                if(!WaitEvent(_transferData.Size > 0 ? TransfertCompleteReload : TransfertComplete))
+                {
+                    if(_transferData.Callback != nullptr)
+                        _transferData.Callback(GetErorFromEvent(GetLastEvent()));
+                    return;
+                }
+
+                if(_transferData.Size > 255)
+                {
+                    SetTransferSize(255, false);
+                    _DmaTx::ClearTransferComplete();
+                    _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, _transferData.Buffer, &_Regs()->TXDR, 255);
+                    return;
+                }
+                if(_transferData.Size > 0)
+                {
+                    SetTransferSize(_transferData.Size & 0xff);
+                    _DmaTx::ClearTransferComplete();
+                    _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, _transferData.Buffer, &_Regs()->TXDR, _transferData.Size);
+                }
+                else
+                {
+                    _Regs()->CR1 &= ~I2C_CR1_TXDMAEN;
+                    if(_transferData.Callback != nullptr)
+                        _transferData.Callback(I2cStatus::Success);
+                }
+            });
         
-        _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, data, &_Regs()->TXDR, (size > 255 ? 255 : size));
+            _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, data, &_Regs()->TXDR, (size > 255 ? 255 : size));
 
-        return I2cStatus::Success;
+            return I2cStatus::Success;
+        }
     }
 
     I2C_TEMPLATE_ARGS
@@ -305,72 +433,79 @@ namespace Zhele
     I2C_TEMPLATE_ARGS
     I2cStatus I2C_TEMPLATE_QUALIFIER::EnableAsyncRead(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts, I2cCallback callback)
     {
-        if(!WaitWhileBusy())
-            return I2cStatus::Busy;
-
-        if(!WriteDevAddrForWrite(devAddr, opts))
-            return GetErorFromEvent(GetLastEvent());
-
-        _Regs()->CR2 &= ~(I2C_CR2_AUTOEND | I2C_CR2_RELOAD);
-        if(!HasAnyFlag(opts, I2cOpts::RegAddrNone))
+        if constexpr (std::is_same_v<_DmaRx, void>)
         {
-            if(!WriteRegAddr(regAddr, opts))
-                GetErorFromEvent(GetLastEvent());
+            return CompleteSync(Read(devAddr, regAddr, data, size, opts), callback);
         }
+        else
+        {
+            if(!WaitWhileBusy())
+                return I2cStatus::Busy;
 
-        if(!WriteDevAddrForRead(devAddr, opts, size > 255 ? 255 : size, size > 255))
-            return GetErorFromEvent(GetLastEvent());
-
-        _transferData.Buffer = data;
-        _transferData.Size = size;
-        _transferData.Callback = callback;
-
-        _DmaRx::ClearTransferComplete();
-        _Regs()->CR1 |= I2C_CR1_RXDMAEN;
+            if(!WriteDevAddrForWrite(devAddr, opts))
+                return GetErorFromEvent(GetLastEvent());
 
-        _DmaRx::SetTransferCallback([](void* buffer, unsigned bytesReceived, bool success)
-        {
-            if (!success)
+            _Regs()->CR2 &= ~(I2C_CR2_AUTOEND | I2C_CR2_RELOAD);
+            if(!HasAnyFlag(opts, I2cOpts::RegAddrNone))
             {
-                if(_transferData.Callback != nullptr)
-                    _transferData.Callback(GetErorFromEvent(GetLastEvent()));
-                return;
+                if(!WriteRegAddr(regAddr, opts))
+                    return GetErorFromEvent(GetLastEvent());
             }
 
-            _transferData.Size -= bytesReceived;
-            _transferData.Buffer += bytesReceived;
+            if(!WriteDevAddrForRead(devAddr, opts, size > 255 ? 255 : size, size > 255))
+                return GetErorFromEvent(GetLastEvent());
 
-            if(!WaitEvent(_transferData.Size > 0 ? TransfertCompleteReload : TransfertComplete))
-            {
-                if(_transferData.Callback != nullptr)
-                    _transferData.Callback(GetErorFromEvent(GetLastEvent()));
-                return;
-            }
+            _transferData.Buffer = data;
+            _transferData.Size = size;
+            _transferData.Callback = callback;
 
-            if(_transferData.Size > 255)
-            {
-                SetTransferSize(255, false);
-                _DmaRx::ClearTransferComplete();
-                _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular, _transferData.Buffer, &_Regs()->RXDR, 255);
-                return;
-            }
-            if(_transferData.Size > 0)
-            {
-                SetTransferSize(_transferData.Size & 0xff);
-                _DmaRx::ClearTransferComplete();
-                _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular, _transferData.Buffer, &_Regs()->RXDR, _transferData.Size);
-            }
-            else
+            _DmaRx::ClearTransferComplete();
+            _Regs()->CR1 |= I2C_CR1_RXDMAEN;
+
+            _DmaRx::SetTransferCallback([](void* buffer, unsigned bytesReceived, bool success)
             {
-                _Regs()->CR1 &= ~I2C_CR1_RXDMAEN;
-                if(_transferData.Callback != nullptr)
-                    _transferData.Callback(I2cStatus::Success);
-            }
-        });
+                if (!success)
+                {
+                    if(_transferData.Callback != nullptr)
+                        _transferData.Callback(GetErorFromEvent(GetLastEvent()));
+                    return;
+                }
 
-        _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular, data, &_Regs()->RXDR, (size > 255 ? 255 : size));
+                _transferData.Size -= bytesReceived;
+                _transferData.Buffer += bytesReceived;
 
-        return I2cStatus::Success;
+                if(!WaitEvent(_transferData.Size > 0 ? TransfertCompleteReload : TransfertComplete))
+                {
+                    if(_transferData.Callback != nullptr)
+                        _transferData.Callback(GetErorFromEvent(GetLastEvent()));
+                    return;
+                }
+
+                if(_transferData.Size > 255)
+                {
+                    SetTransferSize(255, false);
+                    _DmaRx::ClearTransferComplete();
+                    _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement, _transferData.Buffer, &_Regs()->RXDR, 255);
+                    return;
+                }
+                if(_transferData.Size > 0)
+                {
+                    SetTransferSize(_transferData.Size & 0xff);
+                    _DmaRx::ClearTransferComplete();
+                    _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement, _transferData.Buffer, &_Regs()->RXDR, _transferData.Size);
+                }
+                else
+                {
+                    _Regs()->CR1 &= ~I2C_CR1_RXDMAEN;
+                    if(_transferData.Callback != nullptr)
+                        _transferData.Callback(I2cStatus::Success);
+                }
+            });
+
+            _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement, data, &_Regs()->RXDR, (size > 255 ? 255 : size));
+
+            return I2cStatus::Success;
+        }
     }
 
     I2C_TEMPLATE_ARGS
@@ -443,6 +578,141 @@ namespace Zhele
             | (size << I2C_CR2_NBYTES_Pos)
             | (isLast ? 0 : I2C_CR2_RELOAD);
     }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::EnableSlave(uint8_t address, uint8_t* registers, uint16_t size, I2cSlaveCallback callback)
+    {
+        _slaveData = {registers, size, 0, 0, 0, I2cMode::Idle, false, callback};
+
+        _Regs()->OAR1 = 0;
+        _Regs()->OAR1 = I2C_OAR1_OA1EN | (static_cast<uint32_t>(address) << 1);
+        _Regs()->CR1 |= I2C_CR1_ADDRIE | I2C_CR1_STOPIE | I2C_CR1_NACKIE | I2C_CR1_ERRIE;
+
+        NVIC_EnableIRQ(_EventIrqNumber);
+        NVIC_EnableIRQ(_ErrorIrqNumber);
+    }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::DisableSlave()
+    {
+        _Regs()->CR1 &= ~(I2C_CR1_ADDRIE | I2C_CR1_STOPIE | I2C_CR1_NACKIE | I2C_CR1_ERRIE);
+        _Regs()->OAR1 &= ~I2C_OAR1_OA1EN;
+
+        _slaveData.Callback = nullptr;
+        FinishSlaveTransfer();
+    }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::SetSlaveRequests(I2cMode mode, bool dma)
+    {
+        uint32_t cr1 = _Regs()->CR1 & ~(I2C_CR1_RXIE | I2C_CR1_TXIE | I2C_CR1_RXDMAEN | I2C_CR1_TXDMAEN);
+        if (mode == I2cMode::Write)
+            cr1 |= dma ? I2C_CR1_RXDMAEN : I2C_CR1_RXIE;
+        if (mode == I2cMode::Read)
+            cr1 |= dma ? I2C_CR1_TXDMAEN : I2C_CR1_TXIE;
+        _Regs()->CR1 = cr1;
+    }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::EventIrqHandler()
+    {
+        ZHELE_PROFILE_ISR();
+
+        uint32_t isr = _Regs()->ISR;
+
+        if (isr & I2C_ISR_ADDR)
+        {
+            FinishSlaveTransfer();
+            if (isr & I2C_ISR_DIR)
+            {
+                // Flush transmit register
+                _Regs()->ISR = I2C_ISR_TXE;
+                StartSlaveTransfer(I2cMode::Read);
+            }
+            else
+            {
+                _slaveData.Mode = I2cMode::Write;
+                _slaveData.OffsetReceived = false;
+                _slaveData.Count = 0;
+                SetSlaveRequests(I2cMode::Write, false);
+            }
+            // Clock is stretched until address flag is cleared
+            _Regs()->ICR = I2C_ICR_ADDRCF;
+        }
+        if ((isr & I2C_ISR_RXNE) && (_Regs()->CR1 & I2C_CR1_RXIE))
+        {
+            SlaveReceive(_Regs()->RXDR);
+        }
+        if ((isr & I2C_ISR_TXIS) && (_Regs()->CR1 & I2C_CR1_TXIE))
+        {
+            _Regs()->TXDR = SlaveTransmit();
+        }
+        if (isr & I2C_ISR_NACKF)
+        {
+            _Regs()->ICR = I2C_ICR_NACKCF;
+        }
+        if (isr & I2C_ISR_STOPF)
+        {
+            _Regs()->ICR = I2C_ICR_STOPCF;
+            FinishSlaveTransfer();
+        }
+
+        if constexpr (_EventIrqNumber == _ErrorIrqNumber)
+        {
+            ErrorIrqHandler();
+        }
+    }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::ErrorIrqHandler()
+    {
+        ZHELE_PROFILE_ISR();
+
+        uint32_t isr = _Regs()->ISR;
+
+        if (isr & I2C_ISR_TIMEOUT)
+        {
+            _Regs()->ICR = I2C_ICR_TIMOUTCF;
+            FinishSlaveTransfer();
+            Counters::Add(Statistics::I2cCounters::Timeouts);
+            AbortTransfer(I2cStatus::Timeout);
+            Recover();
+        }
+        if (isr & (I2C_ISR_BERR | I2C_ISR_ARLO | I2C_ISR_OVR))
+        {
+            _Regs()->ICR = I2C_ICR_BERRCF | I2C_ICR_ARLOCF | I2C_ICR_OVRCF;
+            FinishSlaveTransfer();
+            AbortTransfer(GetErorFromEvent(isr));
+        }
+    }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::EnableBusTimeout(uint32_t timeoutUs)
+    {
+        // tTIMEOUT = (TIMEOUTA + 1) * 2048 * tI2CCLK
+        uint32_t timeout = static_cast<uint32_t>(static_cast<uint64_t>(timeoutUs) * _ClockCtrl::ClockFreq() / 1000000 / 2048);
+        timeout = std::clamp<uint32_t>(timeout, 1, 4096) - 1;
+
+        _Regs()->TIMEOUTR &= ~I2C_TIMEOUTR_TIMOUTEN;
+        _Regs()->TIMEOUTR = (timeout << I2C_TIMEOUTR_TIMEOUTA_Pos) | I2C_TIMEOUTR_TIMOUTEN;
+        _Regs()->CR1 |= I2C_CR1_ERRIE;
+
+        NVIC_EnableIRQ(_ErrorIrqNumber);
+    }
+
+    I2C_TEMPLATE_ARGS
+    bool I2C_TEMPLATE_QUALIFIER::Recover()
+    {
+        // Disabling peripheral resets communication state machine and status flags
+        _Regs()->CR1 &= ~I2C_CR1_PE;
+        while (_Regs()->CR1 & I2C_CR1_PE) {};
+
+        bool released = _busClear != nullptr ? _busClear() : true;
+
+        _Regs()->CR1 |= I2C_CR1_PE;
+
+        return released && !Busy();
+    }
     #endif
     #if defined (I2C_TYPE_2)
         template<typename _Regs>
@@ -509,6 +779,27 @@ namespace Zhele
             {
                 NVIC_EnableIRQ(_ErrorIrqNumber);
             }
+
+            _clockSpeed = i2cClockSpeed;
+            _dutyCycle2 = dutyCycle2;
+            Clock::ClockChange::Subscribe<ClockChanged>();
+        }
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::ClockChanged()
+        {
+            if (_clockSpeed == 0)
+                return;
+
+            // Disabling I2C aborts transfer
+            WaitWhileBusy();
+
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~I2C_CR1_PE;
+            while (_Regs()->CR1 & I2C_CR1_PE) {};
+
+            CalcTiming<_Regs>(_ClockCtrl::ClockFreq(), _clockSpeed, _dutyCycle2);
+            _Regs()->CR1 = cr1 | I2C_CR1_PE;
         }
 
         I2C_TEMPLATE_ARGS
@@ -582,53 +873,57 @@ namespace Zhele
         I2C_TEMPLATE_ARGS
         I2cStatus I2C_TEMPLATE_QUALIFIER::WriteAsync(uint16_t devAddr, uint16_t regAddr, const uint8_t *data, uint16_t size, I2cOpts opts, I2cCallback callback)
         {
-            _Regs()->SR1 = 0;
-            _Regs()->SR2 = 0;
-
-            if(!WaitWhileBusy())
-                return GetErorFromEvent(GetLastEvent());
-
-            _Regs()->CR1 |= I2C_CR1_ACK;
-            
-            if(!Start())
-                return GetErorFromEvent(GetLastEvent());
-            
-           if(!WriteDevAddr(devAddr, false, opts))
-                return GetErorFromEvent(GetLastEvent());
-
-            if(!HasAnyFlag(opts, I2cOpts::RegAddrNone) )
+            if constexpr (std::is_same_v<_DmaTx, void>)
             {
-                if(!WriteRegAddr(regAddr, opts))
-                    return GetErorFromEvent(GetLastEvent());
+                return CompleteSync(Write(devAddr, regAddr, data, size, opts), callback);
             }
-            
-            _transferData.Callback = callback;
+            else
+            {
+                _Regs()->SR1 = 0;
+                _Regs()->SR2 = 0;
 
-            _DmaTx::ClearTransferComplete();
-            _Regs()->CR2 |= I2C_CR2_DMAEN;
+                if(!WaitWhileBusy())
+                    return GetErorFromEvent(GetLastEvent());
 
-            _DmaTx::SetTransferCallback([](void* buffer, unsigned size, bool success)
-            {
-                if(!WaitEvent(Events::ByteTransferFinished))
+                _Regs()->CR1 |= I2C_CR1_ACK;
+                
+                if(!Start())
+                    return GetErorFromEvent(GetLastEvent());
+                
+                if(!WriteDevAddr(devAddr, false, opts))
+                    return GetErorFromEvent(GetLastEvent());
+
+                if(!HasAnyFlag(opts, I2cOpts::RegAddrNone) )
                 {
-                    if (_transferData.Callback != nullptr)
-                    {
-                        _transferData.Callback(GetErorFromEvent(GetLastEvent()));
-                    }
+                    if(!WriteRegAddr(regAddr, opts))
+                        return GetErorFromEvent(GetLastEvent());
                 }
+                
+                _transferData.Callback = callback;
 
-                _Regs()->CR1 &= ~I2C_CR1_ACK;
-                _Regs()->CR1 |= I2C_CR1_STOP;
+                _DmaTx::ClearTransferComplete();
+                _Regs()->CR2 |= I2C_CR2_DMAEN;
 
-                if (_transferData.Callback != nullptr)
+                _DmaTx::SetTransferCallback([](void* buffer, unsigned size, bool success)
                 {
-                    _transferData.Callback(success ? I2cStatus::Success : GetErorFromEvent(GetLastEvent()));
-                }
-            });
+                    _Regs()->CR2 &= ~I2C_CR2_DMAEN;
 
-            _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, data, &_Regs()->DR, size);
+                    // DMA is complete when last byte is written to DR, so wait it on the bus
+                    I2cStatus status = success && WaitEvent(Events::ByteTransferFinished)
+                        ? I2cStatus::Success
+                        : GetErorFromEvent(GetLastEvent());
 
-            return I2cStatus::Success;
+                    _Regs()->CR1 &= ~I2C_CR1_ACK;
+                    _Regs()->CR1 |= I2C_CR1_STOP;
+
+                    if (_transferData.Callback != nullptr)
+                        _transferData.Callback(status);
+                });
+
+                _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, data, &_Regs()->DR, size);
+
+                return I2cStatus::Success;
+            }
         }
 
         I2C_TEMPLATE_ARGS
@@ -709,60 +1004,63 @@ namespace Zhele
 
         I2C_TEMPLATE_ARGS
         I2cStatus I2C_TEMPLATE_QUALIFIER::EnableAsyncRead(uint16_t devAddr, uint16_t regAddr, uint8_t *data, uint16_t size, I2cOpts opts, I2cCallback callback)
-        {            
-            if(!WaitWhileBusy())
-                GetErorFromEvent(GetLastEvent());
-            
-            if(!Start())
-                GetErorFromEvent(GetLastEvent());
-
-            if(!WriteDevAddr(devAddr, false, opts))
-                GetErorFromEvent(GetLastEvent());
-
-            if(!HasAnyFlag(opts, I2cOpts::RegAddrNone))
+        {
+            // Single byte should be NACKed before address is acknowledged, so DMA is useless for it
+            if constexpr (std::is_same_v<_DmaRx, void>)
             {
-                if(!WriteRegAddr(regAddr, opts))
-                    return GetErorFromEvent(GetLastEvent());
+                return CompleteSync(Read(devAddr, regAddr, data, size, opts), callback);
             }
-            
-            if(!Start())
-                return GetErorFromEvent(GetLastEvent());
+            else
+            {
+                if(size < 2)
+                    return CompleteSync(Read(devAddr, regAddr, data, size, opts), callback);
 
-            _Regs()->CR1 |= I2C_CR1_ACK;
+                if(!WaitWhileBusy())
+                    return GetErorFromEvent(GetLastEvent());
+                
+                if(!Start())
+                    return GetErorFromEvent(GetLastEvent());
 
-            if(!WriteDevAddr(devAddr, true, opts))
-                GetErorFromEvent(GetLastEvent());
-            
-            _transferData.Callback = callback;
+                if(!WriteDevAddr(devAddr, false, opts))
+                    return GetErorFromEvent(GetLastEvent());
 
-            _DmaRx::ClearTransferComplete();
-            _Regs()->CR2 |= I2C_CR2_DMAEN;
+                if(!HasAnyFlag(opts, I2cOpts::RegAddrNone))
+                {
+                    if(!WriteRegAddr(regAddr, opts))
+                        return GetErorFromEvent(GetLastEvent());
+                }
+                
+                if(!Start())
+                    return GetErorFromEvent(GetLastEvent());
 
-            _DmaRx::SetTransferCallback([](void* buffer, unsigned size, bool success)
-            {
-                _Regs()->CR1 &= ~I2C_CR1_ACK;
+                _Regs()->CR1 |= I2C_CR1_ACK;
 
-                if(!WaitEvent(Events::RxNotEmpty | Events::MasterSlave | Events::BusBusy))
+                _transferData.Callback = callback;
+
+                _DmaRx::ClearTransferComplete();
+                _DmaRx::SetTransferCallback([](void* buffer, unsigned size, bool success)
                 {
-                    if (_transferData.Callback != nullptr)
-                    {
-                        _transferData.Callback(GetErorFromEvent(GetLastEvent()));
-                    }
-                }
+                    _Regs()->CR2 &= ~(I2C_CR2_DMAEN | I2C_CR2_LAST);
+                    _Regs()->CR1 |= I2C_CR1_STOP;
 
-                static_cast<uint8_t*>(buffer)[size] = static_cast<uint8_t>(_Regs()->DR);
+                    if (_transferData.Callback != nullptr)
+                        _transferData.Callback(success ? I2cStatus::Success : GetErorFromEvent(GetLastEvent()));
+                });
+                _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement, data, &_Regs()->DR, size);
 
-                _Regs()->CR1 |= I2C_CR1_STOP;
+                // DMA reads all bytes, LAST makes hardware NACK the last one
+                _Regs()->CR2 |= I2C_CR2_DMAEN | I2C_CR2_LAST;
 
-                if (_transferData.Callback != nullptr)
+                _Regs()->DR = (devAddr << 1) | 1;
+                if(!WaitEvent(Events::AddressSent | Events::MasterSlave | Events::BusBusy))
                 {
-                    _transferData.Callback(success ? I2cStatus::Success : GetErorFromEvent(GetLastEvent()));
+                    _Regs()->CR2 &= ~(I2C_CR2_DMAEN | I2C_CR2_LAST);
+                    _DmaRx::Disable();
+                    return GetErorFromEvent(GetLastEvent());
                 }
-            });
 
-            _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular, data, &_Regs()->DR, size - 1);
-
-            return I2cStatus::Success;
+                return I2cStatus::Success;
+            }
         }
 
         I2C_TEMPLATE_ARGS
@@ -814,53 +1112,416 @@ namespace Zhele
         {
             return (_Regs()->SR1 | _Regs()->SR2 << 16) & 0x00ffffff;
         }
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::EnableSlave(uint8_t address, uint8_t* registers, uint16_t size, I2cSlaveCallback callback)
+        {
+            _slaveData = {registers, size, 0, 0, 0, I2cMode::Idle, false, callback};
+
+            // Bit 14 of OAR1 should be kept at 1 by software
+            _Regs()->OAR1 = (1 << 14) | (static_cast<uint32_t>(address) << 1);
+            _Regs()->CR1 |= I2C_CR1_ACK;
+            _Regs()->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITERREN;
+
+            NVIC_EnableIRQ(_EventIrqNumber);
+            NVIC_EnableIRQ(_ErrorIrqNumber);
+        }
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::DisableSlave()
+        {
+            _Regs()->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITERREN);
+            _Regs()->CR1 &= ~I2C_CR1_ACK;
+
+            _slaveData.Callback = nullptr;
+            FinishSlaveTransfer();
+        }
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::SetSlaveRequests(I2cMode mode, bool dma)
+        {
+            uint32_t cr2 = _Regs()->CR2 & ~(I2C_CR2_ITBUFEN | I2C_CR2_DMAEN);
+            if (mode != I2cMode::Idle)
+                cr2 |= dma ? I2C_CR2_DMAEN : I2C_CR2_ITBUFEN;
+            _Regs()->CR2 = cr2;
+        }
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::EventIrqHandler()
+        {
+            ZHELE_PROFILE_ISR();
+
+            uint32_t sr1 = _Regs()->SR1;
+
+            if (sr1 & I2C_SR1_ADDR)
+            {
+                FinishSlaveTransfer();
+                // Reading SR2 after SR1 clears address flag
+                if (_Regs()->SR2 & I2C_SR2_TRA)
+                {
+                    StartSlaveTransfer(I2cMode::Read);
+                }
+                else
+                {
+                    _slaveData.Mode = I2cMode::Write;
+                    _slaveData.OffsetReceived = false;
+                    _slaveData.Count = 0;
+                    SetSlaveRequests(I2cMode::Write, false);
+                }
+            }
+            if (_Regs()->CR2 & I2C_CR2_ITBUFEN)
+            {
+                if (sr1 & I2C_SR1_RXNE)
+                    SlaveReceive(_Regs()->DR);
+                else if (sr1 & I2C_SR1_TXE)
+                    _Regs()->DR = SlaveTransmit();
+            }
+            if (sr1 & I2C_SR1_STOPF)
+            {
+                // Reading SR1 and writing CR1 clears stop flag
+                _Regs()->CR1 |= I2C_CR1_PE;
+                FinishSlaveTransfer();
+            }
+        }
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::ErrorIrqHandler()
+        {
+            ZHELE_PROFILE_ISR();
+
+            uint32_t sr1 = _Regs()->SR1;
+
+            // Master NACK ends slave transmission
+            if (sr1 & (I2C_SR1_AF | I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_OVR | I2C_SR1_TIMEOUT))
+            {
+                _Regs()->SR1 = sr1 & ~(I2C_SR1_AF | I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_OVR | I2C_SR1_TIMEOUT);
+                FinishSlaveTransfer();
+                AbortTransfer(GetErorFromEvent(sr1));
+            }
+            if (sr1 & I2C_SR1_TIMEOUT)
+            {
+                Recover();
+            }
+        }
+
+        I2C_TEMPLATE_ARGS
+        bool I2C_TEMPLATE_QUALIFIER::Recover()
+        {
+            // Software reset clears all registers, so configuration is restored after it
+            uint32_t cr1 = _Regs()->CR1 & ~(I2C_CR1_PE | I2C_CR1_START | I2C_CR1_STOP | I2C_CR1_POS);
+            uint32_t cr2 = _Regs()->CR2 & ~(I2C_CR2_DMAEN | I2C_CR2_LAST);
+            uint32_t ccr = _Regs()->CCR;
+            uint32_t trise = _Regs()->TRISE;
+            uint32_t oar1 = _Regs()->OAR1;
+            uint32_t oar2 = _Regs()->OAR2;
+
+            _Regs()->CR1 &= ~I2C_CR1_PE;
+
+            bool released = _busClear != nullptr ? _busClear() : true;
+
+            _Regs()->CR1 |= I2C_CR1_SWRST;
+            _Regs()->CR1 &= ~I2C_CR1_SWRST;
+
+            _Regs()->CR2 = cr2;
+            _Regs()->CCR = ccr;
+            _Regs()->TRISE = trise;
+            _Regs()->OAR1 = oar1;
+            _Regs()->OAR2 = oar2;
+            _Regs()->CR1 = cr1 | I2C_CR1_PE;
+
+            return released && !Busy();
+        }
     #endif
         I2C_TEMPLATE_ARGS
-        bool I2C_TEMPLATE_QUALIFIER::WaitWhileBusy()
+        void I2C_TEMPLATE_QUALIFIER::StartSlaveTransfer(I2cMode mode)
+        {
+            _slaveData.Mode = mode;
+            _slaveData.Count = 0;
+            _slaveData.DmaSize = 0;
+
+            uint16_t size = _slaveData.Size - _slaveData.Offset;
+            uint8_t* registers = _slaveData.Registers + _slaveData.Offset;
+        #if defined (I2C_TYPE_1)
+            volatile void* rxRegister = &_Regs()->RXDR;
+            volatile void* txRegister = &_Regs()->TXDR;
+        #else
+            volatile void* rxRegister = &_Regs()->DR;
+            volatile void* txRegister = &_Regs()->DR;
+        #endif
+
+            if constexpr (!std::is_same_v<_DmaRx, void>)
+            {
+                if (mode == I2cMode::Write && size > 0)
+                {
+                    _slaveData.DmaSize = size;
+                    _DmaRx::ClearTransferComplete();
+                    _DmaRx::SetTransferCallback([](void*, unsigned, bool)
+                    {
+                        if (_slaveData.DmaSize == 0)
+                            return;
+                        // Register file is full, next bytes are discarded by interrupt handler
+                        _slaveData.Count += _slaveData.DmaSize;
+                        _slaveData.DmaSize = 0;
+                        SetSlaveRequests(I2cMode::Write, false);
+                    });
+                    _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement, registers, rxRegister, size);
+                    SetSlaveRequests(mode, true);
+                    return;
+                }
+            }
+            if constexpr (!std::is_same_v<_DmaTx, void>)
+            {
+                if (mode == I2cMode::Read && size > 0)
+                {
+                    _slaveData.DmaSize = size;
+                    _DmaTx::ClearTransferComplete();
+                    _DmaTx::SetTransferCallback([](void*, unsigned, bool)
+                    {
+                        if (_slaveData.DmaSize == 0)
+                            return;
+                        // End of register file, next bytes are sent by interrupt handler
+                        _slaveData.Count += _slaveData.DmaSize;
+                        _slaveData.DmaSize = 0;
+                        SetSlaveRequests(I2cMode::Read, false);
+                    });
+                    _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, registers, txRegister, size);
+                    SetSlaveRequests(mode, true);
+                    return;
+                }
+            }
+            SetSlaveRequests(mode, false);
+        }
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::SlaveReceive(uint8_t value)
+        {
+            if (!_slaveData.OffsetReceived)
+            {
+                _slaveData.OffsetReceived = true;
+                _slaveData.Offset = value < _slaveData.Size ? value : _slaveData.Size;
+                StartSlaveTransfer(I2cMode::Write);
+                return;
+            }
+
+            if (_slaveData.Offset + _slaveData.Count < _slaveData.Size)
+            {
+                _slaveData.Registers[_slaveData.Offset + _slaveData.Count] = value;
+                ++_slaveData.Count;
+            }
+        }
+
+        I2C_TEMPLATE_ARGS
+        uint8_t I2C_TEMPLATE_QUALIFIER::SlaveTransmit()
+        {
+            uint16_t index = _slaveData.Offset + _slaveData.Count;
+            ++_slaveData.Count;
+
+            return index < _slaveData.Size ? _slaveData.Registers[index] : 0xff;
+        }
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::FinishSlaveTransfer()
+        {
+            I2cMode mode = _slaveData.Mode;
+            if (mode == I2cMode::Idle)
+                return;
+
+            _slaveData.Mode = I2cMode::Idle;
+            SetSlaveRequests(I2cMode::Idle, false);
+
+            if (_slaveData.DmaSize != 0)
+            {
+                if constexpr (!std::is_same_v<_DmaRx, void>)
+                {
+                    if (mode == I2cMode::Write)
+                    {
+                        _slaveData.Count += _slaveData.DmaSize - _DmaRx::RemainingTransfers();
+                        _DmaRx::Disable();
+                    }
+                }
+                if constexpr (!std::is_same_v<_DmaTx, void>)
+                {
+                    if (mode == I2cMode::Read)
+                    {
+                        _slaveData.Count += _slaveData.DmaSize - _DmaTx::RemainingTransfers();
+                        _DmaTx::Disable();
+                    }
+                }
+                _slaveData.DmaSize = 0;
+            }
+
+            if (mode == I2cMode::Read)
+            {
+                // Last byte loaded to data register has not been sent
+            #if defined (I2C_TYPE_1)
+                bool pending = (_Regs()->ISR & I2C_ISR_TXE) == 0;
+                _Regs()->ISR = I2C_ISR_TXE;
+            #else
+                bool pending = (_Regs()->SR1 & I2C_SR1_TXE) == 0;
+            #endif
+                if (pending && _slaveData.Count > 0)
+                    --_slaveData.Count;
+            }
+
+            uint16_t count = std::min<uint16_t>(_slaveData.Count, _slaveData.Size - _slaveData.Offset);
+            if (_slaveData.Callback != nullptr && count > 0)
+                _slaveData.Callback(mode, _slaveData.Offset, count);
+        }
+
+        I2C_TEMPLATE_ARGS
+        I2cStatus I2C_TEMPLATE_QUALIFIER::CompleteSync(I2cStatus status, I2cCallback callback)
         {
-            for(uint32_t i = _timeout; i >= 0 && Busy(); --i);
+            if(callback == nullptr)
+                return status;
 
-            return !Busy();
+            callback(status);
+            return I2cStatus::Success;
+        }
+
+        I2C_TEMPLATE_ARGS
+        bool I2C_TEMPLATE_QUALIFIER::WaitWhileBusy()
+        {
+            return WaitFor([]() { return !Busy(); });
         }
 
         I2C_TEMPLATE_ARGS
         bool I2C_TEMPLATE_QUALIFIER::WaitEvent(uint32_t i2c_event)
         {
-            bool result = false;
-            auto timer = _timeout;
-            uint32_t lastevent;
-            do
+            return WaitFor([i2c_event]() { return (GetLastEvent() & i2c_event) == i2c_event; });
+        }
+
+        I2C_TEMPLATE_ARGS
+        template<typename Condition>
+        bool I2C_TEMPLATE_QUALIFIER::WaitFor(Condition condition)
+        {
+            if (_tickSource != nullptr)
+            {
+                uint32_t start = _tickSource();
+                while (!condition())
+                {
+                    if (_tickSource() - start >= _timeoutTicks)
+                        return condition();
+                }
+                return true;
+            }
+
+            Deadline deadline(_timeoutMs, _timeout);
+            while (!condition())
+            {
+                if (deadline.Expired())
+                    return condition();
+            }
+            return true;
+        }
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::SetTickSource(I2cTickSource tickSource, uint32_t timeout)
+        {
+            _tickSource = tickSource;
+            _timeoutTicks = timeout;
+        }
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::AbortTransfer(I2cStatus status)
+        {
+            bool active = false;
+            if constexpr (!std::is_same_v<_DmaTx, void>)
             {
-                lastevent = GetLastEvent();
-                result = (lastevent & i2c_event) == i2c_event;
-            } while(!result && --timer > 0);
+                active |= _DmaTx::Enabled();
+                _DmaTx::Disable();
+            }
+            if constexpr (!std::is_same_v<_DmaRx, void>)
+            {
+                active |= _DmaRx::Enabled();
+                _DmaRx::Disable();
+            }
+            if (!active)
+                return;
+
+        #if defined (I2C_TYPE_1)
+            _Regs()->CR1 &= ~(I2C_CR1_TXDMAEN | I2C_CR1_RXDMAEN);
+        #else
+            _Regs()->CR2 &= ~(I2C_CR2_DMAEN | I2C_CR2_LAST);
+        #endif
+            if (_transferData.Callback != nullptr)
+                _transferData.Callback(status);
+        }
+
+        I2C_TEMPLATE_ARGS
+        template<typename SclPin, typename SdaPin>
+        bool I2C_TEMPLATE_QUALIFIER::ClearBus()
+        {
+            // About 100 kHz (loop iteration takes several CPU cycles)
+            const uint32_t halfPeriod = _ClockCtrl::ClockFreq() / 800000;
+            auto delay = [halfPeriod]() { for (volatile uint32_t i = 0; i < halfPeriod; ++i) {} };
+            auto release = []() { SclPin::Set(); for (uint32_t i = _timeout; i > 0 && !SclPin::IsSet(); --i) {} };
+
+            SclPin::Set();
+            SdaPin::Set();
+            SclPin::SetConfiguration(SclPin::Port::Out);
+            SclPin::SetDriverType(SclPin::Port::OpenDrain);
+            SdaPin::SetConfiguration(SdaPin::Port::Out);
+            SdaPin::SetDriverType(SdaPin::Port::OpenDrain);
+            delay();
+
+            for (uint8_t i = 0; i < 9 && !SdaPin::IsSet(); ++i)
+            {
+                SclPin::Clear();
+                delay();
+                release();
+                delay();
+            }
+
+            // STOP condition: SDA rises while SCL is high
+            SclPin::Clear();
+            delay();
+            SdaPin::Clear();
+            delay();
+            release();
+            delay();
+            SdaPin::Set();
+            delay();
+
+            bool released = SdaPin::IsSet();
+
+            SclPin::SetConfiguration(SclPin::Port::AltFunc);
+            SclPin::SetDriverType(SclPin::Port::OpenDrain);
+            SdaPin::SetConfiguration(SdaPin::Port::AltFunc);
+            SdaPin::SetDriverType(SdaPin::Port::OpenDrain);
 
-            return result;
+            return released;
         }
 
         I2C_TEMPLATE_ARGS
         I2cStatus I2C_TEMPLATE_QUALIFIER::GetErorFromEvent(uint32_t lastevent)
         {
+            // Every failed transfer is mapped here, so it's also the place to count errors
             if(lastevent & Timeout)
             {
+                Counters::Add(Statistics::I2cCounters::Timeouts);
                 return I2cStatus::Timeout;
             }
             if(lastevent & Overrun)
             {
+                Counters::Add(Statistics::I2cCounters::Overruns);
                 return I2cStatus::Overflow;
             }
             if(lastevent & AckFailure)
             {
+                Counters::Add(Statistics::I2cCounters::Nacks);
                 return I2cStatus::Nack;
             }
             if(lastevent & ArbitrationLost)
             {
+                Counters::Add(Statistics::I2cCounters::ArbitrationLost);
                 return I2cStatus::ArbitrationError;
             }
             if(lastevent & BusError)
             {
+                Counters::Add(Statistics::I2cCounters::BusErrors);
                 return I2cStatus::BusError;
             }
+            Counters::Add(Statistics::I2cCounters::Timeouts);
             return I2cStatus::Timeout;
         }
     }
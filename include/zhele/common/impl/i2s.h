@@ -0,0 +1,200 @@
+/**
+ * @file
+ * Implements I2S (SPI in I2S mode)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_I2S_IMPL_COMMON_H
+#define ZHELE_I2S_IMPL_COMMON_H
+
+namespace Zhele
+{
+    #define I2S_TEMPLATE_ARGS template<typename _Spi, typename _MckPin>
+    #define I2S_TEMPLATE_QUALIFIER I2s<_Spi, _MckPin>
+
+    I2S_TEMPLATE_ARGS
+    constexpr I2sTiming I2S_TEMPLATE_QUALIFIER::CalculateTiming(uint32_t pllInputFrequency, uint32_t sampleRate, bool masterClock, bool longChannel)
+    {
+        // Bit clock is 32 or 64 Fs, master clock is 256 Fs
+        const uint64_t frameClock = static_cast<uint64_t>(sampleRate) * (masterClock ? 256 : (longChannel ? 64 : 32));
+        I2sTiming best {0, 0, 0, UINT32_MAX};
+
+        for (uint16_t multiplier = 50; multiplier <= 432; ++multiplier)
+        {
+            // VCO output must be in range 100-432 MHz
+            const uint64_t vco = static_cast<uint64_t>(pllInputFrequency) * multiplier;
+            if (vco < 100000000 || vco > 432000000)
+                continue;
+
+            for (uint8_t divider = 2; divider <= 7; ++divider)
+            {
+                // I2S clock is vco / divider, error is calculated without rounding of it
+                const uint64_t clockDivider = frameClock * divider;
+                const uint64_t prescaler = (vco + clockDivider / 2) / clockDivider;
+                if (prescaler < 4 || prescaler > 511)
+                    continue;
+
+                const uint64_t achieved = clockDivider * prescaler;
+                const uint64_t difference = achieved > vco ? achieved - vco : vco - achieved;
+                const uint32_t error = static_cast<uint32_t>(difference * 1000000 / achieved);
+
+                // Strict comparison keeps the lowest VCO frequency among equal candidates
+                if (error < best.ErrorPpm)
+                    best = I2sTiming {multiplier, divider, static_cast<uint16_t>(prescaler), error};
+            }
+        }
+
+        return best;
+    }
+
+    I2S_TEMPLATE_ARGS
+    template<uint32_t sampleRate, uint32_t pllInputFrequency, typename I2S_TEMPLATE_QUALIFIER::DataFormat format, uint32_t maxErrorPpm>
+    void I2S_TEMPLATE_QUALIFIER::Init(Mode mode, Standard standard, bool clockPolarityHigh)
+    {
+        constexpr bool longChannel = (static_cast<uint16_t>(format) & SPI_I2SCFGR_CHLEN) != 0;
+        constexpr I2sTiming timing = CalculateTiming(pllInputFrequency, sampleRate, MasterClockOutput, longChannel);
+        static_assert(timing.Prescaler != 0, "Sample rate is unreachable with given PLL input frequency");
+        static_assert(timing.ErrorPpm <= maxErrorPpm, "Sample rate error is too high");
+
+        // PLLI2S is shared, it's not restarted if it's already configured (by another I2S)
+        if (!(RCC->CR & RCC_CR_PLLI2SON)
+            || Clock::PllI2sClock::GetMultiplier() != timing.Multiplier
+            || Clock::PllI2sClock::GetOutputDivider() != timing.OutputDivider)
+        {
+            Clock::PllI2sClock::Disable();
+            Clock::PllI2sClock::SetMultiplier<timing.Multiplier>();
+            Clock::PllI2sClock::SetOutputDivider<timing.OutputDivider>();
+            Clock::PllI2sClock::Enable();
+        }
+
+        _Spi::ClockCtrl::Enable();
+        Regs()->I2SCFGR = 0;
+        Regs()->I2SPR = (timing.Prescaler / 2)
+            | ((timing.Prescaler & 1) ? SPI_I2SPR_ODD : 0)
+            | (MasterClockOutput ? SPI_I2SPR_MCKOE : 0);
+        Regs()->I2SCFGR = SPI_I2SCFGR_I2SMOD
+            | static_cast<uint16_t>(mode)
+            | static_cast<uint16_t>(standard)
+            | static_cast<uint16_t>(format)
+            | (clockPolarityHigh ? SPI_I2SCFGR_CKPOL : 0);
+        _mode = mode;
+
+        if constexpr (MasterClockOutput)
+        {
+            _MckPin::Port::Enable();
+            _MckPin::template SetConfiguration<_MckPin::Port::AltFunc>();
+            _MckPin::template SetDriverType<_MckPin::DriverType::PushPull>();
+            _MckPin::template SetSpeed<_MckPin::Speed::Fast>();
+            _MckPin::template AltFuncNumber<Private::GetAltFunctionNumber<Regs>>();
+        }
+    }
+
+    I2S_TEMPLATE_ARGS
+    template<int8_t sdPinNumber, int8_t ckPinNumber, int8_t wsPinNumber>
+    void I2S_TEMPLATE_QUALIFIER::SelectPins()
+    {
+        _Spi::template SelectPins<sdPinNumber, -1, ckPinNumber, wsPinNumber>();
+    }
+
+    I2S_TEMPLATE_ARGS
+    template<typename SdPin, typename CkPin, typename WsPin>
+    void I2S_TEMPLATE_QUALIFIER::SelectPins()
+    {
+        constexpr auto sdPinIndex = _Spi::MosiPins::template IndexOf<SdPin>;
+        constexpr auto ckPinIndex = _Spi::ClockPins::template IndexOf<CkPin>;
+        constexpr auto wsPinIndex = _Spi::SsPins::template IndexOf<WsPin>;
+
+        static_assert(sdPinIndex >= 0, "SD pin must be one of SPI MOSI pins");
+        static_assert(ckPinIndex >= 0, "CK pin must be one of SPI SCK pins");
+        static_assert(wsPinIndex >= 0, "WS pin must be one of SPI NSS pins");
+
+        SelectPins<sdPinIndex, ckPinIndex, wsPinIndex>();
+    }
+
+    I2S_TEMPLATE_ARGS
+    void I2S_TEMPLATE_QUALIFIER::Stream(uint16_t* buffer, uint16_t blockSize, BlockCallback callback)
+    {
+        constexpr DmaBase::Mode transferMode = DmaBase::MemIncrement | DmaBase::PSize16Bits | DmaBase::MSize16Bits | DmaBase::PriorityHigh;
+
+        _callback = callback;
+        if (_mode == Mode::MasterTx)
+        {
+            using Dma = typename _Spi::DmaTx;
+            Dma::SetDoubleBufferedTransferCallback(StreamHandler);
+            Dma::TransferDoubleBuffered(transferMode | DmaBase::Mem2Periph, buffer, buffer + blockSize, &Regs()->DR, blockSize);
+            Regs()->CR2 |= SPI_CR2_TXDMAEN;
+        }
+        else
+        {
+            using Dma = typename _Spi::DmaRx;
+            Dma::SetDoubleBufferedTransferCallback(StreamHandler);
+            Dma::TransferDoubleBuffered(transferMode | DmaBase::Periph2Mem, buffer, buffer + blockSize, &Regs()->DR, blockSize);
+            Regs()->CR2 |= SPI_CR2_RXDMAEN;
+        }
+
+        Regs()->I2SCFGR |= SPI_I2SCFGR_I2SE;
+    }
+
+    I2S_TEMPLATE_ARGS
+    void I2S_TEMPLATE_QUALIFIER::Stop()
+    {
+        Regs()->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+        Regs()->CR2 &= ~(SPI_CR2_TXDMAEN | SPI_CR2_RXDMAEN);
+        if (_mode == Mode::MasterTx)
+            _Spi::DmaTx::Disable();
+        else
+            _Spi::DmaRx::Disable();
+        _callback = nullptr;
+    }
+
+    I2S_TEMPLATE_ARGS
+    void I2S_TEMPLATE_QUALIFIER::Write(uint16_t data)
+    {
+        Regs()->I2SCFGR |= SPI_I2SCFGR_I2SE;
+        while (!(Regs()->SR & SPI_SR_TXE))
+            continue;
+        Regs()->DR = data;
+    }
+
+    I2S_TEMPLATE_ARGS
+    uint16_t I2S_TEMPLATE_QUALIFIER::Read()
+    {
+        Regs()->I2SCFGR |= SPI_I2SCFGR_I2SE;
+        while (!(Regs()->SR & SPI_SR_RXNE))
+            continue;
+        return Regs()->DR;
+    }
+
+    I2S_TEMPLATE_ARGS
+    bool I2S_TEMPLATE_QUALIFIER::DataLost()
+    {
+        uint32_t status = Regs()->SR;
+        if (status & SPI_SR_OVR)
+        {
+            // Overrun is cleared by DR read followed by SR read
+            (void)Regs()->DR;
+            (void)Regs()->SR;
+            return true;
+        }
+        // Underrun is cleared by SR read
+        return (status & SPI_SR_UDR) != 0;
+    }
+
+    I2S_TEMPLATE_ARGS
+    void I2S_TEMPLATE_QUALIFIER::StreamHandler(void* data, unsigned size, unsigned)
+    {
+        if (_callback)
+            _callback(static_cast<uint16_t*>(data), size);
+    }
+
+    I2S_TEMPLATE_ARGS
+    typename I2S_TEMPLATE_QUALIFIER::Mode I2S_TEMPLATE_QUALIFIER::_mode = Mode::MasterTx;
+
+    I2S_TEMPLATE_ARGS
+    typename I2S_TEMPLATE_QUALIFIER::BlockCallback I2S_TEMPLATE_QUALIFIER::_callback = nullptr;
+}
+
+#endif //! ZHELE_I2S_IMPL_COMMON_H
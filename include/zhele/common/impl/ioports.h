@@ -158,6 +158,33 @@ namespace Zhele::IO::Private
         _Regs()->AFR[1] = UnpackConfig4Bit((mask >> 8) & 0xff, _Regs()->AFR[1], number);
     }
 
+    PORTIMPL_TEMPLATE_ARGS
+    template<typename PORTIMPL_TEMPLATE_QUALIFIER::Configuration configuration, typename PORTIMPL_TEMPLATE_QUALIFIER::Speed speed,
+        typename PORTIMPL_TEMPLATE_QUALIFIER::PullMode pull, uint8_t altFunc, typename PORTIMPL_TEMPLATE_QUALIFIER::DriverType driver,
+        typename PORTIMPL_TEMPLATE_QUALIFIER::DataType mask>
+    void PORTIMPL_TEMPLATE_QUALIFIER::Configure()
+    {
+        if constexpr (mask == 0)
+            return;
+
+        if constexpr (configuration == AltFunc)
+        {
+            if constexpr ((mask & 0xff) != 0)
+                _Regs()->AFR[0] = UnpackConfig4Bit(mask & 0xff, _Regs()->AFR[0], altFunc);
+            if constexpr (((mask >> 8) & 0xff) != 0)
+                _Regs()->AFR[1] = UnpackConfig4Bit((mask >> 8) & 0xff, _Regs()->AFR[1], altFunc);
+        }
+
+        if constexpr (configuration == Out || configuration == AltFunc)
+        {
+            _Regs()->OTYPER = (_Regs()->OTYPER & ~mask) | mask * driver;
+            _Regs()->OSPEEDR = UnpackConfig2bits(mask, _Regs()->OSPEEDR, speed);
+        }
+
+        _Regs()->PUPDR = UnpackConfig2bits(mask, _Regs()->PUPDR, pull);
+        _Regs()->MODER = UnpackConfig2bits(mask, _Regs()->MODER, configuration);
+    }
+
     PORTIMPL_TEMPLATE_ARGS
     void PORTIMPL_TEMPLATE_QUALIFIER::Enable()
     {
@@ -170,6 +197,18 @@ namespace Zhele::IO::Private
         _ClkEnReg::Disable();
     }
 
+    PORTIMPL_TEMPLATE_ARGS
+    volatile uint32_t* PORTIMPL_TEMPLATE_QUALIFIER::BitSetResetRegister()
+    {
+        return &_Regs()->BSRR;
+    }
+
+    PORTIMPL_TEMPLATE_ARGS
+    volatile uint32_t* PORTIMPL_TEMPLATE_QUALIFIER::InputDataRegister()
+    {
+        return &_Regs()->IDR;
+    }
+
     PORTIMPL_TEMPLATE_ARGS
     constexpr inline unsigned PORTIMPL_TEMPLATE_QUALIFIER::UnpackConfig2bits(unsigned mask, unsigned value, unsigned configuration)
     {
@@ -0,0 +1,320 @@
+/**
+ * @file
+ * Implements low-power timer (LPTIM)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LPTIMER_IMPL_COMMON_H
+#define ZHELE_LPTIMER_IMPL_COMMON_H
+
+namespace Zhele::Timers::Private
+{
+    #define LPTIMER_TEMPLATE_ARGS template<typename _Regs, typename _ClockCtrl, IRQn_Type _IRQNumber, typename _In1Pins, typename _In2Pins, typename _OutPins>
+    #define LPTIMER_TEMPLATE_QUALIFIER LpTimer<_Regs, _ClockCtrl, _IRQNumber, _In1Pins, _In2Pins, _OutPins>
+
+    LPTIMER_TEMPLATE_ARGS
+    template<unsigned _Channel>
+    void LPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_Channel>::SetPulse(Counter pulse)
+    {
+        // Compare register is writable only when timer is enabled
+        if (!(_Regs()->CR & LPTIM_CR_ENABLE))
+            _Regs()->CR = LPTIM_CR_ENABLE;
+
+        if (_compareWritten)
+        {
+            while (!(_Regs()->ISR & LPTIM_ISR_CMPOK)) ;
+        }
+        _Regs()->ICR = LPTIM_ICR_CMPOKCF;
+        _Regs()->CMP = pulse;
+        _compareWritten = true;
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    template<unsigned _Channel>
+    typename LPTIMER_TEMPLATE_QUALIFIER::Counter LPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_Channel>::GetPulse()
+    {
+        return _Regs()->CMP;
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    template<unsigned _Channel>
+    void LPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_Channel>::SetOutputMode(OutputMode mode)
+    {
+        ModifyDisabled(_Regs()->CFGR, LPTIM_CFGR_WAVE, mode == SetOnce ? LPTIM_CFGR_WAVE : 0);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    template<unsigned _Channel>
+    void LPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_Channel>::SetOutputPolarity(OutputPolarity polarity)
+    {
+        ModifyDisabled(_Regs()->CFGR, LPTIM_CFGR_WAVPOL, polarity == ActiveLow ? LPTIM_CFGR_WAVPOL : 0);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    template<unsigned _Channel>
+    void LPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_Channel>::EnableInterrupt()
+    {
+        LpTimer::EnableInterrupt(Interrupt::CompareMatch);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    template<unsigned _Channel>
+    void LPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_Channel>::DisableInterrupt()
+    {
+        LpTimer::DisableInterrupt(Interrupt::CompareMatch);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    template<unsigned _Channel>
+    bool LPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_Channel>::IsInterrupt()
+    {
+        return _softwareEvent || (_Regs()->ISR & LPTIM_ISR_CMPM);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    template<unsigned _Channel>
+    void LPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_Channel>::ClearInterruptFlag()
+    {
+        _softwareEvent = false;
+        _Regs()->ICR = LPTIM_ICR_CMPMCF;
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    template<unsigned _Channel>
+    void LPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_Channel>::GenerateEvent()
+    {
+        _softwareEvent = true;
+        NVIC_SetPendingIRQ(_IRQNumber);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::Enable()
+    {
+        _ClockCtrl::Enable();
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::Disable()
+    {
+        Stop();
+        _ClockCtrl::Disable();
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    unsigned LPTIMER_TEMPLATE_QUALIFIER::GetClockFreq()
+    {
+        return _ClockCtrl::ClockFreq() >> ((_Regs()->CFGR & LPTIM_CFGR_PRESC_Msk) >> LPTIM_CFGR_PRESC_Pos);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::SetPrescaler(Prescaler prescaler)
+    {
+        ModifyDisabled(_Regs()->CFGR, LPTIM_CFGR_PRESC_Msk, static_cast<uint32_t>(prescaler) << LPTIM_CFGR_PRESC_Pos);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::SetPeriod(Counter period)
+    {
+        // Autoreload register is writable only when timer is enabled
+        if (!(_Regs()->CR & LPTIM_CR_ENABLE))
+            _Regs()->CR = LPTIM_CR_ENABLE;
+
+        if (_periodWritten)
+        {
+            while (!(_Regs()->ISR & LPTIM_ISR_ARROK)) ;
+        }
+        _Regs()->ICR = LPTIM_ICR_ARROKCF;
+        _Regs()->ARR = period;
+        _periodWritten = true;
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    typename LPTIMER_TEMPLATE_QUALIFIER::Counter LPTIMER_TEMPLATE_QUALIFIER::GetPeriod()
+    {
+        return _Regs()->ARR;
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    typename LPTIMER_TEMPLATE_QUALIFIER::Counter LPTIMER_TEMPLATE_QUALIFIER::GetCounterValue()
+    {
+        Counter previous;
+        Counter value = _Regs()->CNT;
+        do
+        {
+            previous = value;
+            value = _Regs()->CNT;
+        } while (value != previous);
+
+        return value;
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::ResetCounterValue()
+    {
+        // Counter is reset when timer is disabled
+        if (!(_Regs()->CR & LPTIM_CR_ENABLE))
+            return;
+
+        WaitWrites();
+        _Regs()->CR = 0;
+        _Regs()->CR = LPTIM_CR_ENABLE;
+        if (_continuous)
+            _Regs()->CR = LPTIM_CR_ENABLE | LPTIM_CR_CNTSTRT;
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::Start()
+    {
+        if (!(_Regs()->CR & LPTIM_CR_ENABLE))
+            _Regs()->CR = LPTIM_CR_ENABLE;
+        _Regs()->CR = LPTIM_CR_ENABLE | LPTIM_CR_CNTSTRT;
+        _continuous = true;
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::StartOnce()
+    {
+        if (!(_Regs()->CR & LPTIM_CR_ENABLE))
+            _Regs()->CR = LPTIM_CR_ENABLE;
+        _Regs()->CR = LPTIM_CR_ENABLE | LPTIM_CR_SNGSTRT;
+        _continuous = false;
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::Stop()
+    {
+        WaitWrites();
+        _Regs()->CR = 0;
+        _continuous = false;
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::EnableInterrupt(Interrupt interrupts)
+    {
+        ModifyDisabled(_Regs()->IER, 0, static_cast<uint32_t>(interrupts));
+        NVIC_EnableIRQ(_IRQNumber);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::DisableInterrupt(Interrupt interrupts)
+    {
+        ModifyDisabled(_Regs()->IER, static_cast<uint32_t>(interrupts), 0);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    bool LPTIMER_TEMPLATE_QUALIFIER::IsInterrupt(Interrupt interrupts)
+    {
+        // Flags in ISR have the same positions as interrupt enable bits
+        return _Regs()->ISR & static_cast<uint32_t>(interrupts);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::ClearInterruptFlag(Interrupt interrupts)
+    {
+        _Regs()->ICR = static_cast<uint32_t>(interrupts);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::EnableEncoderMode(Edge edge)
+    {
+        ModifyDisabled(_Regs()->CFGR, LPTIM_CFGR_CKSEL | LPTIM_CFGR_CKPOL_Msk | LPTIM_CFGR_COUNTMODE,
+            LPTIM_CFGR_ENC | (static_cast<uint32_t>(edge) << LPTIM_CFGR_CKPOL_Pos));
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::DisableEncoderMode()
+    {
+        ModifyDisabled(_Regs()->CFGR, LPTIM_CFGR_ENC | LPTIM_CFGR_CKPOL_Msk, 0);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::EnableExternalCounting(Edge edge, bool asynchronous, uint8_t filter)
+    {
+        uint32_t config = (static_cast<uint32_t>(edge) << LPTIM_CFGR_CKPOL_Pos)
+            | (asynchronous
+                ? LPTIM_CFGR_CKSEL
+                : LPTIM_CFGR_COUNTMODE | ((static_cast<uint32_t>(filter) << LPTIM_CFGR_CKFLT_Pos) & LPTIM_CFGR_CKFLT_Msk));
+        ModifyDisabled(_Regs()->CFGR, LPTIM_CFGR_CKSEL | LPTIM_CFGR_CKPOL_Msk | LPTIM_CFGR_CKFLT_Msk | LPTIM_CFGR_COUNTMODE | LPTIM_CFGR_ENC, config);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::DisableExternalCounting()
+    {
+        ModifyDisabled(_Regs()->CFGR, LPTIM_CFGR_CKSEL | LPTIM_CFGR_CKPOL_Msk | LPTIM_CFGR_CKFLT_Msk | LPTIM_CFGR_COUNTMODE, 0);
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    template<typename In1Pin, typename In2Pin>
+    void LPTIMER_TEMPLATE_QUALIFIER::SelectInputPins()
+    {
+        SelectPin<In1Pin, _In1Pins>();
+        if constexpr (!std::is_same_v<In2Pin, IO::NullPin>)
+            SelectPin<In2Pin, _In2Pins>();
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    template<typename OutPin>
+    void LPTIMER_TEMPLATE_QUALIFIER::SelectOutputPin()
+    {
+        SelectPin<OutPin, _OutPins>();
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::ModifyDisabled(volatile uint32_t& reg, uint32_t clearMask, uint32_t setMask)
+    {
+        uint32_t value = (reg & ~clearMask) | setMask;
+        if (value == reg)
+            return;
+
+        const bool enabled = (_Regs()->CR & LPTIM_CR_ENABLE) != 0;
+        if (enabled)
+        {
+            // Pending compare/autoreload write is lost if timer is disabled before synchronization
+            WaitWrites();
+            _Regs()->CR = 0;
+        }
+
+        reg = value;
+
+        if (enabled)
+        {
+            _Regs()->CR = LPTIM_CR_ENABLE;
+            if (_continuous)
+                _Regs()->CR = LPTIM_CR_ENABLE | LPTIM_CR_CNTSTRT;
+        }
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    void LPTIMER_TEMPLATE_QUALIFIER::WaitWrites()
+    {
+        if (_compareWritten)
+        {
+            while (!(_Regs()->ISR & LPTIM_ISR_CMPOK)) ;
+            _Regs()->ICR = LPTIM_ICR_CMPOKCF;
+            _compareWritten = false;
+        }
+        if (_periodWritten)
+        {
+            while (!(_Regs()->ISR & LPTIM_ISR_ARROK)) ;
+            _Regs()->ICR = LPTIM_ICR_ARROKCF;
+            _periodWritten = false;
+        }
+    }
+
+    LPTIMER_TEMPLATE_ARGS
+    template<typename Pin, typename Pins>
+    void LPTIMER_TEMPLATE_QUALIFIER::SelectPin()
+    {
+        constexpr int index = Pins::Key::template IndexOf<Pin>;
+        static_assert(index >= 0, "Pin is not LPTIM pin");
+
+        Pin::Port::Enable();
+        Pin::template SetConfiguration<Pin::Port::AltFunc>();
+        Pin::template AltFuncNumber<GetNonTypeValueByIndex<index, typename Pins::Value>::value>();
+    }
+}
+
+#endif //! ZHELE_LPTIMER_IMPL_COMMON_H
@@ -19,7 +19,9 @@ namespace Zhele
                         | _Usart::UsartMode::NoneParity
                         | _Usart::UsartMode::RxTxEnable
                         | _Usart::UsartMode::OneStopBit
+                    #if defined (USART_CR3_ONEBIT)
                         | _Usart::UsartMode::OneSampleBitEnable
+                    #endif
                         | _Usart::UsartMode::HalfDuplex);
         
         _Usart::template SelectTxRxPins<_Pin>();
@@ -31,71 +33,119 @@ namespace Zhele
     template<typename _Usart, typename _Pin>
     bool OneWire<_Usart, _Pin>::Reset()
     {
-        _Usart::SetBaud(9600);
+        while (ReadBusy());
 
-        volatile bool complete = false;
-        uint8_t precenseBit = 0;
+        _Usart::SetBaud(9600);
 
-        _Usart::EnableAsyncRead(&precenseBit, 1, [&complete](void*, unsigned, bool){complete = true;});
-        _Usart::Write(0xf0);
-        while (!complete);
+        _slots[0] = 0xf0;
+        Transfer(1);
 
         _Usart::SetBaud(115200);
 
-        return precenseBit != 0xf0;
+        return _slots[0] != 0xf0;
     }
 
     template<typename _Usart, typename _Pin>
     void OneWire<_Usart, _Pin>::WriteByte(uint8_t byteToWrite)
     {
-        uint8_t buffer[8];
-        uint8_t dummyBuffer[8];
-        ConvertToBits(byteToWrite, buffer);
-        volatile bool complete = false;
+        WriteBytes(&byteToWrite, 1);
+    }
 
-        // Send byte async, receive because it's half-duplex
-        _Usart::EnableAsyncRead(dummyBuffer, 8, [&complete](void*, unsigned, bool){complete = true;});
-        _Usart::Write(buffer, 8, true);
+    template<typename _Usart, typename _Pin>
+    void OneWire<_Usart, _Pin>::WriteBytes(const void* data, uint8_t size)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+
+        while (ReadBusy());
 
-        while(!complete);
+        while (size > 0)
+        {
+            uint8_t chunk = size < MaxTransferSize ? size : MaxTransferSize;
+            for (uint8_t i = 0; i < chunk; ++i)
+            {
+                ConvertToBits(bytes[i], &_slots[i * 8]);
+            }
+
+            // Received frames are dropped (line is half-duplex)
+            Transfer(chunk * 8);
+
+            bytes += chunk;
+            size -= chunk;
+        }
     }
 
     template<typename _Usart, typename _Pin>
     uint8_t OneWire<_Usart, _Pin>::ReadByte()
     {
-        uint8_t buffer[8];
-        volatile bool readComplete = false;            
+        uint8_t byte;
+        ReadBytes(&byte, 1);
+        return byte;
+    }
 
-        _Usart::EnableAsyncRead(buffer, 8,
-                        [&readComplete](void* data, unsigned size, bool success){
-                            readComplete = true;});
-        
-        _Usart::WriteAsync(_readDummyBuffer, 8);
+    template<typename _Usart, typename _Pin>
+    void OneWire<_Usart, _Pin>::ReadBytes(void* data, uint8_t size)
+    {
+        uint8_t* buffer = reinterpret_cast<uint8_t*>(data);
 
-        while (!readComplete){}
+        while (ReadBusy());
+
+        while (size > 0)
+        {
+            uint8_t chunk = size < MaxTransferSize ? size : MaxTransferSize;
+            for (unsigned i = 0; i < chunk * 8u; ++i)
+            {
+                _slots[i] = 0xff;
+            }
 
-        return ConvertToByte(buffer);
+            Transfer(chunk * 8);
+
+            for (uint8_t i = 0; i < chunk; ++i)
+            {
+                buffer[i] = ConvertToByte(&_slots[i * 8]);
+            }
+
+            buffer += chunk;
+            size -= chunk;
+        }
     }
 
     template<typename _Usart, typename _Pin>
-    void OneWire<_Usart, _Pin>::ReadBytes(void* data, uint8_t size)
+    bool OneWire<_Usart, _Pin>::ReadBytesAsync(void* data, uint8_t size, TransferCallback callback)
     {
-        uint8_t* buffer = reinterpret_cast<uint8_t*>(data);
+        if (size == 0 || size > MaxTransferSize)
+            return false;
+
+        while (ReadBusy());
 
-        for(uint8_t i = 0; i < size; ++i)
+        for (unsigned i = 0; i < size * 8u; ++i)
         {
-            buffer[i] = ReadByte();
+            _slots[i] = 0xff;
         }
+
+        _readData = reinterpret_cast<uint8_t*>(data);
+        _readSize = size;
+        _readCallback = callback;
+        StartTransfer(size * 8);
+
+        return true;
+    }
+
+    template<typename _Usart, typename _Pin>
+    bool OneWire<_Usart, _Pin>::ReadBusy()
+    {
+        return _readData != nullptr;
     }
 
     template<typename _Usart, typename _Pin>
     void OneWire<_Usart, _Pin>::MatchRom(const uint8_t rom[8])
     {
-        WriteByte(Commands::Match);
+        uint8_t command[9] = {Commands::Match};
 
         for (uint8_t i = 0; i < 8; ++i) {
-            WriteByte(rom[i]);
+            command[i + 1] = rom[i];
         }
+
+        WriteBytes(command, sizeof(command));
     }
 
     template<typename _Usart, typename _Pin>
@@ -111,12 +161,147 @@ namespace Zhele
         if(!Reset())
             return false;
         WriteByte(Commands::Read);
+        ReadBytes(rom, 8);
+        return true;
+    }
+
+    template<typename _Usart, typename _Pin>
+    bool OneWire<_Usart, _Pin>::SearchFirst(uint8_t* rom)
+    {
+        _lastDiscrepancy = 0;
+        _lastDevice = false;
+
+        return SearchNext(rom);
+    }
+
+    template<typename _Usart, typename _Pin>
+    bool OneWire<_Usart, _Pin>::SearchNext(uint8_t* rom)
+    {
+        if(_lastDevice || !Reset())
+        {
+            _lastDiscrepancy = 0;
+            _lastDevice = false;
+            return false;
+        }
+
+        WriteByte(Commands::Search);
+
+        uint8_t lastZero = 0;
+        for (uint8_t bit = 1; bit <= 64; ++bit)
+        {
+            uint8_t& byte = _searchRom[(bit - 1) / 8];
+            uint8_t mask = 1 << ((bit - 1) % 8);
+
+            bool idBit = ReadBit();
+            bool complementBit = ReadBit();
+
+            // No devices answered
+            if(idBit && complementBit)
+            {
+                _lastDiscrepancy = 0;
+                _lastDevice = false;
+                return false;
+            }
+
+            bool direction;
+            if(idBit != complementBit)
+            {
+                direction = idBit;
+            }
+            else
+            {
+                // Discrepancy: follow previous path before last discrepancy, take 1 at it, and 0 after it
+                direction = bit < _lastDiscrepancy
+                    ? (byte & mask) != 0
+                    : bit == _lastDiscrepancy;
+
+                if(!direction)
+                    lastZero = bit;
+            }
+
+            if(direction)
+                byte |= mask;
+            else
+                byte &= ~mask;
+
+            WriteBit(direction);
+        }
+
+        _lastDiscrepancy = lastZero;
+        _lastDevice = lastZero == 0;
 
         for (uint8_t i = 0; i < 8; ++i)
         {
-            rom[i] = ReadByte();
+            rom[i] = _searchRom[i];
         }
-        return true;
+
+        return Crc8(_searchRom, 7) == _searchRom[7];
+    }
+
+    template<typename _Usart, typename _Pin>
+    bool OneWire<_Usart, _Pin>::ReadBit()
+    {
+        return TransferSlot(0xff) == 0xff;
+    }
+
+    template<typename _Usart, typename _Pin>
+    void OneWire<_Usart, _Pin>::WriteBit(bool bit)
+    {
+        TransferSlot(bit ? 0xff : 0x00);
+    }
+
+    template<typename _Usart, typename _Pin>
+    uint8_t OneWire<_Usart, _Pin>::Crc8(const void* data, uint8_t size)
+    {
+        return Crc8Maxim::Calculate(data, size);
+    }
+
+    template<typename _Usart, typename _Pin>
+    uint8_t OneWire<_Usart, _Pin>::TransferSlot(uint8_t value)
+    {
+        while (ReadBusy());
+
+        _slots[0] = value;
+        Transfer(1);
+
+        return _slots[0];
+    }
+
+    template<typename _Usart, typename _Pin>
+    void OneWire<_Usart, _Pin>::Transfer(unsigned size)
+    {
+        StartTransfer(size);
+        while (!_complete);
+    }
+
+    template<typename _Usart, typename _Pin>
+    void OneWire<_Usart, _Pin>::StartTransfer(unsigned size)
+    {
+        _complete = false;
+
+        _Usart::EnableAsyncRead(_slots, size, TransferComplete);
+        _Usart::WriteAsync(_slots, size);
+    }
+
+    template<typename _Usart, typename _Pin>
+    void OneWire<_Usart, _Pin>::TransferComplete(void*, unsigned, bool success)
+    {
+        _complete = true;
+
+        if (_readData == nullptr)
+            return;
+
+        uint8_t* data = _readData;
+        for (uint8_t i = 0; i < _readSize; ++i)
+        {
+            data[i] = ConvertToByte(&_slots[i * 8]);
+        }
+
+        TransferCallback callback = _readCallback;
+        _readData = nullptr;
+
+        if (callback != nullptr)
+            callback(data, _readSize, success);
     }
 
     template<typename _Usart, typename _Pin>
@@ -12,6 +12,131 @@
 using namespace Zhele::TemplateUtils;
 namespace Zhele::IO
 {
+    namespace Private
+    {
+        /// Max runs count for shift-and-mask mapping (other mappings use lookup tables)
+        const static unsigned MaxPinRunsForShift = 3;
+
+        /// Pinlist value bits per lookup table
+        const static unsigned PinListTableBits = 4;
+
+    #if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+        const static bool HasReverseBits = true;
+        inline uint32_t ReverseBits(uint32_t value) { return __RBIT(value); }
+    #else
+        const static bool HasReverseBits = false;
+        inline uint32_t ReverseBits(uint32_t value) { return value; }
+    #endif
+
+        /**
+         * @brief Pinlist bits which are mapped to port bits with the same shift
+         * 
+         * @tparam _Size Pinlist size
+         */
+        template<size_t _Size>
+        struct PinRuns
+        {
+            unsigned Count = 0; ///< Runs count
+            uint64_t Masks[_Size] = {}; ///< Pinlist value masks
+            int Offsets[_Size] = {}; ///< Shifts from pinlist value to port value
+        };
+
+        /**
+         * @brief Groups pins by offset between bit in pinlist value and bit in port
+         * 
+         * @param [in] numbers Pin number for each pinlist bit (-1 for pins of other ports)
+         * 
+         * @returns Runs
+         */
+        template<size_t _Size>
+        consteval PinRuns<_Size> FindPinRuns(const std::array<int, _Size>& numbers)
+        {
+            PinRuns<_Size> runs;
+            for (size_t index = 0; index < _Size; ++index)
+            {
+                if (numbers[index] < 0)
+                    continue;
+
+                int offset = numbers[index] - static_cast<int>(index);
+                unsigned run = 0;
+                while (run < runs.Count && runs.Offsets[run] != offset)
+                    ++run;
+                if (run == runs.Count)
+                    runs.Offsets[runs.Count++] = offset;
+                runs.Masks[run] |= uint64_t(1) << index;
+            }
+            return runs;
+        }
+
+        /**
+         * @brief Detects reversed run (pinlist bit i is port bit (last - i))
+         * 
+         * @param [in] numbers Pin number for each pinlist bit (-1 for pins of other ports)
+         * 
+         * @returns Last port bit (for pinlist bit 0) or -1 if pins are not reversed run
+         */
+        template<size_t _Size>
+        consteval int FindReversedRun(const std::array<int, _Size>& numbers)
+        {
+            int last = -1;
+            for (size_t index = 0; index < _Size; ++index)
+            {
+                if (numbers[index] < 0)
+                    continue;
+
+                int sum = numbers[index] + static_cast<int>(index);
+                if (last >= 0 && sum != last)
+                    return -1;
+                last = sum;
+            }
+            return last;
+        }
+
+        /**
+         * @brief Lookup tables (one table per PinListTableBits bits of pinlist value)
+         * 
+         * @tparam _DataType Port data type
+         * @tparam _Numbers Pin number for each pinlist bit (-1 for pins of other ports)
+         */
+        template<typename _DataType, auto _Numbers>
+        constexpr auto PinListTables = []() {
+            constexpr size_t count = (_Numbers.size() + PinListTableBits - 1) / PinListTableBits;
+            std::array<std::array<_DataType, 1 << PinListTableBits>, count> tables{};
+            for (size_t table = 0; table < count; ++table)
+            {
+                for (unsigned value = 0; value < (1u << PinListTableBits); ++value)
+                {
+                    for (unsigned bit = 0; bit < PinListTableBits; ++bit)
+                    {
+                        size_t index = table * PinListTableBits + bit;
+                        if (index < _Numbers.size() && _Numbers[index] >= 0 && (value & (1u << bit)))
+                            tables[table][value] |= _DataType(1) << _Numbers[index];
+                    }
+                }
+            }
+            return tables;
+        }();
+
+        /**
+         * @brief Returns used lookup tables (some pins of port have bits in table)
+         * 
+         * @param [in] numbers Pin number for each pinlist bit (-1 for pins of other ports)
+         * 
+         * @returns Mask of used tables
+         */
+        template<size_t _Size>
+        consteval uint32_t GetUsedPinListTables(const std::array<int, _Size>& numbers)
+        {
+            uint32_t used = 0;
+            for (size_t index = 0; index < _Size; ++index)
+            {
+                if (numbers[index] >= 0)
+                    used |= 1u << (index / PinListTableBits);
+            }
+            return used;
+        }
+    }
+
     template<typename... _Pins>
     void PinList<_Pins...>::Write(PinList<_Pins...>::DataType value)
     {
@@ -35,6 +160,55 @@ namespace Zhele::IO
         });
     }
 
+    template<typename... _Pins>
+    void PinList<_Pins...>::WriteSynchronized(PinList<_Pins...>::DataType value)
+    {
+        [value]<typename... _Ports>(TypeList<_Ports...> ports) {
+            const uint32_t words[sizeof...(_Ports)] = { GetBitSetResetWordForPort(TypeBox<_Ports>{}, value)... };
+            StoreSynchronized(ports, words);
+        }(GetRealPorts());
+    }
+
+    template<typename... _Pins>
+    template<typename PinList<_Pins...>::DataType value>
+    void PinList<_Pins...>::WriteSynchronized()
+    {
+        []<typename... _Ports>(TypeList<_Ports...> ports) {
+            static constexpr uint32_t words[sizeof...(_Ports)] = { GetBitSetResetWordForPort(TypeBox<_Ports>{}, value)... };
+            StoreSynchronized(ports, words);
+        }(GetRealPorts());
+    }
+
+    template<typename... _Pins>
+    template<typename... _Ports>
+    void PinList<_Pins...>::StoreSynchronized(TypeList<_Ports...>, const uint32_t (&words)[sizeof...(_Ports)])
+    {
+        volatile uint32_t* const registers[sizeof...(_Ports)] = { _Ports::BitSetResetRegister()... };
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        [&registers, &words]<size_t... _Index>(std::index_sequence<_Index...>) {
+            ((*registers[_Index] = words[_Index]), ...);
+        }(std::index_sequence_for<_Ports...>{});
+        __set_PRIMASK(primask);
+    }
+
+    template<typename... _Pins>
+    constexpr uint32_t PinList<_Pins...>::GetBitSetResetWordForPort(auto port, PinList<_Pins...>::DataType value)
+    {
+        constexpr uint32_t mask = GetPinlistMaskForPort(decltype(port){});
+        uint32_t setBits = GetPinlistValueForPort(port, value);
+        return setBits | ((mask & ~setBits) << 16);
+    }
+
+    template<typename... _Pins>
+    consteval auto PinList<_Pins...>::GetRealPorts()
+    {
+        return _ports.filter([](auto port) {
+            return !std::is_same_v<TypeUnbox<port>, NullPort>;
+        });
+    }
+
     template<typename... _Pins>
     typename PinList<_Pins...>::DataType PinList<_Pins...>::Read()
     {
@@ -212,6 +386,16 @@ namespace Zhele::IO
         });
     }
 
+    template<typename... _Pins>
+    template<NativePortBase::Configuration configuration, NativePortBase::Speed speed,
+        NativePortBase::PullMode pull, uint8_t altFunc, NativePortBase::DriverType driver>
+    void PinList<_Pins...>::Configure()
+    {
+        _ports.foreach([](auto port) {
+            port.template Configure<configuration, speed, pull, altFunc, driver, GetPinlistMaskForPort(port)>();
+        });
+    }
+
     template<typename... _Pins>
     void PinList<_Pins...>::Enable()
     {
@@ -224,16 +408,74 @@ namespace Zhele::IO
         _ports.foreach([](auto port){ port.Disable(); });
     }
 
+    template<typename... _Pins>
+    template<typename _Port>
+    constexpr typename _Port::DataType PinList<_Pins...>::PortValue(typename PinList<_Pins...>::DataType value)
+    {
+        return GetPinlistValueForPort(TypeBox<_Port>{}, value);
+    }
+
+    template<typename... _Pins>
+    template<typename _Port>
+    consteval typename _Port::DataType PinList<_Pins...>::PortMask()
+    {
+        return GetPinlistMaskForPort(TypeBox<_Port>{});
+    }
+
     template<typename... _Pins>
     constexpr auto PinList<_Pins...>::GetPinlistValueForPort(auto port, typename PinList<_Pins...>::DataType value)
     {
-        auto result = typename TypeUnbox<port>::DataType();
+        using Port = decltype(port);
+        using PortDataType = typename TypeUnbox<port>::DataType;
+        using ValueType = std::common_type_t<DataType, uint32_t>;
+
+        constexpr auto numbers = GetPinNumbersForPort(Port{});
+        constexpr auto runs = Private::FindPinRuns(numbers);
+        constexpr int reversedRunLast = Private::FindReversedRun(numbers);
+
+        auto shiftAndMask = [value]<unsigned... _Index>(std::integer_sequence<unsigned, _Index...>) {
+            return static_cast<PortDataType>((ValueType() | ... | (runs.Offsets[_Index] >= 0
+                ? (static_cast<ValueType>(value) & static_cast<ValueType>(runs.Masks[_Index])) << runs.Offsets[_Index]
+                : (static_cast<ValueType>(value) & static_cast<ValueType>(runs.Masks[_Index])) >> -runs.Offsets[_Index])));
+        };
+
+        if constexpr (runs.Count <= Private::MaxPinRunsForShift)
+        {
+            return shiftAndMask(std::make_integer_sequence<unsigned, runs.Count>{});
+        }
+        else if constexpr (Private::HasReverseBits && sizeof(DataType) <= sizeof(uint32_t) && reversedRunLast >= 0)
+        {
+            if consteval
+            {
+                return shiftAndMask(std::make_integer_sequence<unsigned, runs.Count>{});
+            }
+            else
+            {
+                return static_cast<PortDataType>((Private::ReverseBits(value) >> (31 - reversedRunLast)) & GetPinlistMaskForPort(Port{}));
+            }
+        }
+        else
+        {
+            constexpr auto& tables = Private::PinListTables<PortDataType, numbers>;
+            constexpr uint32_t usedTables = Private::GetUsedPinListTables(numbers);
+            return [value]<unsigned... _Index>(std::integer_sequence<unsigned, _Index...>) {
+                return static_cast<PortDataType>((PortDataType() | ... | ((usedTables & (1u << _Index))
+                    ? tables[_Index][(static_cast<ValueType>(value) >> (_Index * Private::PinListTableBits)) & ((1u << Private::PinListTableBits) - 1)]
+                    : PortDataType())));
+            }(std::make_integer_sequence<unsigned, tables.size()>{});
+        }
+    }
 
-        GetPinsForPort(port).foreach([value, &result](auto pin) {
-            if (value & (1 << _pins.search(pin)))
-                result |= (1 << pin.Number);
+    template<typename... _Pins>
+    consteval auto PinList<_Pins...>::GetPinNumbersForPort(auto port)
+    {
+        std::array<int, _pins.size()> numbers{};
+        numbers.fill(-1);
+
+        GetPinsForPort(port).foreach([&numbers](auto pin) {
+            numbers[_pins.search(pin)] = pin.Number;
         });
-        return result;
+        return numbers;
     }
 
     template<typename... _Pins>
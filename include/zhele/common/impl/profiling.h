@@ -0,0 +1,121 @@
+/**
+ * @file
+ * Implements interrupt handlers profiling
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PROFILING_IMPL_COMMON_H
+#define ZHELE_PROFILING_IMPL_COMMON_H
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+
+namespace Zhele::Profiling
+{
+    inline uint32_t HandlerStatistics::AverageCycles() const
+    {
+        return _count > 0
+            ? static_cast<uint32_t>(_totalCycles / _count)
+            : 0;
+    }
+
+    inline void HandlerStatistics::Record(uint32_t cycles)
+    {
+        if (!_registered)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _next = _first;
+            _first = this;
+            _registered = true;
+            __set_PRIMASK(primask);
+        }
+
+        ++_count;
+        _totalCycles += cycles;
+        if (cycles > _maxCycles)
+            _maxCycles = cycles;
+
+        unsigned bucket = std::bit_width(cycles);
+        ++_histogram[bucket < HistogramSize ? bucket : HistogramSize - 1];
+    }
+
+    inline void HandlerStatistics::Reset()
+    {
+        _count = 0;
+        _maxCycles = 0;
+        _totalCycles = 0;
+        std::memset(_histogram, 0, sizeof(_histogram));
+    }
+
+    inline Scope::Scope(HandlerStatistics& statistics)
+        : _statistics(statistics)
+    {
+        CycleCounter::Enable();
+        _start = CycleCounter::Read();
+    }
+
+    inline Scope::~Scope()
+    {
+        _statistics.Record(CycleCounter::Elapsed(_start, CycleCounter::Read()));
+    }
+
+    inline const HandlerStatistics* First()
+    {
+        return HandlerStatistics::_first;
+    }
+
+    inline void Reset()
+    {
+        for (HandlerStatistics* statistics = HandlerStatistics::_first; statistics != nullptr; statistics = statistics->_next)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            statistics->Reset();
+            __set_PRIMASK(primask);
+        }
+    }
+
+    namespace Private
+    {
+        template<typename _Output>
+        void WriteNumber(uint32_t value)
+        {
+            char buffer[11];
+            unsigned position = sizeof(buffer);
+            buffer[--position] = ' ';
+            do
+            {
+                buffer[--position] = '0' + value % 10;
+                value /= 10;
+            } while (value != 0);
+
+            _Output::Write(buffer + position, sizeof(buffer) - position);
+        }
+    }
+
+    template<typename _Output>
+    void Report()
+    {
+        for (const HandlerStatistics* statistics = First(); statistics != nullptr; statistics = statistics->Next())
+        {
+            Private::WriteNumber<_Output>(statistics->Count());
+            Private::WriteNumber<_Output>(statistics->AverageCycles());
+            Private::WriteNumber<_Output>(statistics->MaxCycles());
+
+            _Output::Write("[ ", 2);
+            for (unsigned i = 0; i < HandlerStatistics::HistogramSize; ++i)
+                Private::WriteNumber<_Output>(statistics->Histogram()[i]);
+            _Output::Write("] ", 2);
+
+            _Output::Write(statistics->Name(), std::strlen(statistics->Name()));
+            _Output::Write("\r\n", 2);
+        }
+    }
+}
+
+#endif //! ZHELE_PROFILING_IMPL_COMMON_H
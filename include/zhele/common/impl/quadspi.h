@@ -0,0 +1,222 @@
+/**
+ * @file
+ * Implements QUADSPI
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_QUADSPI_IMPL_COMMON_H
+#define ZHELE_QUADSPI_IMPL_COMMON_H
+
+namespace Zhele::Private
+{
+    #define QUADSPI_TEMPLATE_ARGS template<typename _Regs, typename _ClockCtrl, typename _Dma, typename _ClkPins, typename _NcsPins, \
+        typename _Io0Pins, typename _Io1Pins, typename _Io2Pins, typename _Io3Pins>
+    #define QUADSPI_TEMPLATE_QUALIFIER QuadSpi<_Regs, _ClockCtrl, _Dma, _ClkPins, _NcsPins, _Io0Pins, _Io1Pins, _Io2Pins, _Io3Pins>
+
+    QUADSPI_TEMPLATE_ARGS
+    template<uint32_t frequency, uint32_t clockFrequency>
+    void QUADSPI_TEMPLATE_QUALIFIER::Init(uint8_t sizeLog2, uint8_t csHighCycles, bool sampleShift)
+    {
+        // Clock is kernel clock / (PRESCALER + 1), it does not exceed requested frequency
+        constexpr uint32_t prescaler = (clockFrequency + frequency - 1) / frequency - 1;
+        static_assert(frequency > 0 && prescaler <= 255, "Frequency is too low for given clock frequency");
+
+        _ClockCtrl::Enable();
+        _Regs()->CR = 0;
+        _Regs()->DCR = (static_cast<uint32_t>(sizeLog2 - 1) << QUADSPI_DCR_FSIZE_Pos)
+            | (static_cast<uint32_t>(csHighCycles - 1) << QUADSPI_DCR_CSHT_Pos);
+        _Regs()->CR = (prescaler << QUADSPI_CR_PRESCALER_Pos)
+            | (sampleShift ? QUADSPI_CR_SSHIFT : 0)
+            | QUADSPI_CR_EN;
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    constexpr uint32_t QUADSPI_TEMPLATE_QUALIFIER::Ccr(const QuadSpiCommand& command, FunctionalMode mode)
+    {
+        return command.Instruction
+            | (static_cast<uint32_t>(command.InstructionLines) << QUADSPI_CCR_IMODE_Pos)
+            | (static_cast<uint32_t>(command.AddressLines) << QUADSPI_CCR_ADMODE_Pos)
+            | (static_cast<uint32_t>(command.AddressBytes - 1) << QUADSPI_CCR_ADSIZE_Pos)
+            | (static_cast<uint32_t>(command.AlternateLines) << QUADSPI_CCR_ABMODE_Pos)
+            | (static_cast<uint32_t>(command.DummyCycles) << QUADSPI_CCR_DCYC_Pos)
+            | (static_cast<uint32_t>(command.DataLines) << QUADSPI_CCR_DMODE_Pos)
+            | (static_cast<uint32_t>(mode) << QUADSPI_CCR_FMODE_Pos);
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    void QUADSPI_TEMPLATE_QUALIFIER::WaitIdle()
+    {
+        // Memory-mapped mode is aborted, previous indirect command is completed (CR can be changed only while idle)
+        DisableMemoryMapped();
+        while (Busy())
+            continue;
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    void QUADSPI_TEMPLATE_QUALIFIER::Start(const QuadSpiCommand& command, FunctionalMode mode, uint32_t address, uint32_t size)
+    {
+        _Regs()->FCR = QUADSPI_FCR_CTEF | QUADSPI_FCR_CTCF | QUADSPI_FCR_CSMF | QUADSPI_FCR_CTOF;
+        if (size > 0)
+            _Regs()->DLR = size - 1;
+        if (command.AlternateLines != QuadSpiLines::None)
+            _Regs()->ABR = command.Alternate;
+
+        // Command starts on CCR write (or AR write if there is address phase)
+        _Regs()->CCR = Ccr(command, mode);
+        if (command.AddressLines != QuadSpiLines::None)
+            _Regs()->AR = address;
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    bool QUADSPI_TEMPLATE_QUALIFIER::WaitComplete()
+    {
+        uint32_t status;
+        while (!((status = _Regs()->SR) & (QUADSPI_SR_TCF | QUADSPI_SR_TEF)))
+            continue;
+        _Regs()->FCR = QUADSPI_FCR_CTCF | QUADSPI_FCR_CTEF;
+        return !(status & QUADSPI_SR_TEF);
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    bool QUADSPI_TEMPLATE_QUALIFIER::Command(const QuadSpiCommand& command, uint32_t address)
+    {
+        WaitIdle();
+        _Regs()->CR &= ~QUADSPI_CR_DMAEN;
+        Start(command, FunctionalMode::IndirectWrite, address, 0);
+        return WaitComplete();
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    bool QUADSPI_TEMPLATE_QUALIFIER::Read(const QuadSpiCommand& command, uint32_t address, void* data, uint32_t size)
+    {
+        WaitIdle();
+        _Regs()->CR &= ~QUADSPI_CR_DMAEN;
+        Start(command, FunctionalMode::IndirectRead, address, size);
+
+        // Byte access to DR reads one byte from FIFO
+        volatile uint8_t* dataRegister = reinterpret_cast<volatile uint8_t*>(&_Regs()->DR);
+        uint8_t* buffer = static_cast<uint8_t*>(data);
+        while (size > 0)
+        {
+            uint32_t status = _Regs()->SR;
+            if (status & QUADSPI_SR_TEF)
+                break;
+            if (status & (QUADSPI_SR_FTF | QUADSPI_SR_TCF))
+            {
+                *buffer++ = *dataRegister;
+                --size;
+            }
+        }
+        return WaitComplete();
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    bool QUADSPI_TEMPLATE_QUALIFIER::Write(const QuadSpiCommand& command, uint32_t address, const void* data, uint32_t size)
+    {
+        WaitIdle();
+        _Regs()->CR &= ~QUADSPI_CR_DMAEN;
+        Start(command, FunctionalMode::IndirectWrite, address, size);
+
+        volatile uint8_t* dataRegister = reinterpret_cast<volatile uint8_t*>(&_Regs()->DR);
+        const uint8_t* buffer = static_cast<const uint8_t*>(data);
+        while (size > 0)
+        {
+            uint32_t status = _Regs()->SR;
+            if (status & QUADSPI_SR_TEF)
+                break;
+            if (status & QUADSPI_SR_FTF)
+            {
+                *dataRegister = *buffer++;
+                --size;
+            }
+        }
+        return WaitComplete();
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    void QUADSPI_TEMPLATE_QUALIFIER::ReadAsync(const QuadSpiCommand& command, uint32_t address, void* data, uint32_t size, TransferCallback callback)
+    {
+        // FIFO threshold is 1 byte (FTHRES = 0), so DMA request is issued for each byte
+        WaitIdle();
+        _Regs()->CR |= QUADSPI_CR_DMAEN;
+        _Dma::ClearTransferComplete();
+        _Dma::SetTransferCallback(callback);
+        _Dma::Transfer(_Dma::Periph2Mem | _Dma::MemIncrement | _Dma::PSize8Bits | _Dma::MSize8Bits, data, &_Regs()->DR, size);
+        Start(command, FunctionalMode::IndirectRead, address, size);
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    void QUADSPI_TEMPLATE_QUALIFIER::WriteAsync(const QuadSpiCommand& command, uint32_t address, const void* data, uint32_t size, TransferCallback callback)
+    {
+        WaitIdle();
+        _Regs()->CR |= QUADSPI_CR_DMAEN;
+        _Dma::ClearTransferComplete();
+        _Dma::SetTransferCallback(callback);
+        Start(command, FunctionalMode::IndirectWrite, address, size);
+        _Dma::Transfer(_Dma::Mem2Periph | _Dma::MemIncrement | _Dma::PSize8Bits | _Dma::MSize8Bits, data, &_Regs()->DR, size);
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    bool QUADSPI_TEMPLATE_QUALIFIER::AutoPoll(const QuadSpiCommand& command, uint8_t mask, uint8_t match, uint16_t interval)
+    {
+        WaitIdle();
+        _Regs()->CR = (_Regs()->CR & ~QUADSPI_CR_DMAEN) | QUADSPI_CR_APMS;
+        _Regs()->PSMKR = mask;
+        _Regs()->PSMAR = match;
+        _Regs()->PIR = interval;
+        Start(command, FunctionalMode::AutoPolling, 0, 1);
+
+        // Automatic polling mode stops on match (APMS)
+        uint32_t status;
+        while (!((status = _Regs()->SR) & (QUADSPI_SR_SMF | QUADSPI_SR_TEF)))
+            continue;
+        _Regs()->FCR = QUADSPI_FCR_CSMF | QUADSPI_FCR_CTCF | QUADSPI_FCR_CTEF;
+        return !(status & QUADSPI_SR_TEF);
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    void QUADSPI_TEMPLATE_QUALIFIER::EnableMemoryMapped(const QuadSpiCommand& command, uint16_t timeoutCycles)
+    {
+        WaitIdle();
+        _Regs()->CR &= ~(QUADSPI_CR_DMAEN | QUADSPI_CR_TCEN);
+        if (timeoutCycles > 0)
+        {
+            _Regs()->LPTR = timeoutCycles;
+            _Regs()->CR |= QUADSPI_CR_TCEN;
+        }
+        Start(command, FunctionalMode::MemoryMapped, 0, 0);
+        _memoryMapped = true;
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    void QUADSPI_TEMPLATE_QUALIFIER::DisableMemoryMapped()
+    {
+        if (!_memoryMapped)
+            return;
+
+        _Regs()->CR |= QUADSPI_CR_ABORT;
+        while (_Regs()->CR & QUADSPI_CR_ABORT)
+            continue;
+        _memoryMapped = false;
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    bool QUADSPI_TEMPLATE_QUALIFIER::MemoryMapped()
+    {
+        return _memoryMapped;
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    bool QUADSPI_TEMPLATE_QUALIFIER::Busy()
+    {
+        return (_Regs()->SR & QUADSPI_SR_BUSY) != 0;
+    }
+
+    QUADSPI_TEMPLATE_ARGS
+    bool QUADSPI_TEMPLATE_QUALIFIER::_memoryMapped = false;
+}
+
+#endif //! ZHELE_QUADSPI_IMPL_COMMON_H
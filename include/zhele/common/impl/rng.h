@@ -19,16 +19,20 @@ namespace Zhele {
     }
     
     std::optional<uint32_t> Rng::Next() {
-        unsigned timeout = _gen_timeout;
-        while((RNG->SR & RNG_SR_DRDY) == 0 && --timeout){}
-        if(timeout != 0) {
+        if(RNG->SR & RNG_SR_DRDY) {
             return RNG->DR;
         }
-        return std::nullopt;
+
+        // Number is generated in 40 RNG clock periods, so 1 ms is enough for any RNG clock
+        Deadline deadline(1, _gen_timeout);
+        while((RNG->SR & RNG_SR_DRDY) == 0) {
+            if(deadline.Expired())
+                return std::nullopt;
+        }
+        return RNG->DR;
     }
     
     std::optional<uint32_t> Rng::Next(uint32_t lowerBound, uint32_t upperBound) {
-        auto random = Next();
         if(auto random = Next()) {
             return (lowerBound + (random.value() % (upperBound - lowerBound)));
         }
@@ -50,6 +54,9 @@ namespace Zhele {
             data[i + 3] = static_cast<uint8_t>(random.value() >> 24);
         }
 
+        if(sizeAligned == size)
+            return true;
+
         auto random = Next();
         if(!random)
             return false;
@@ -65,6 +72,88 @@ namespace Zhele {
     bool Rng::IsOk() {
         return (RNG->SR & (RNG_SR_CECS | RNG_SR_SECS)) == 0;
     }
+
+    void Rng::EnableInterrupt(bool enable) {
+        if(enable)
+            RNG->CR |= RNG_CR_IE;
+        else
+            RNG->CR &= ~RNG_CR_IE;
+    }
+
+    void Rng::Recover() {
+        RNG->SR &= ~RNG_SR_SEIS;
+        RNG->CR &= ~RNG_CR_RNGEN;
+        RNG->CR |= RNG_CR_RNGEN;
+    }
+
+    template<unsigned _Size>
+    void RngPool<_Size>::Init()
+    {
+        Rng::Init();
+        Rng::EnableInterrupt();
+        NVIC_EnableIRQ(Rng::IRQNumber);
+    }
+
+    template<unsigned _Size>
+    unsigned RngPool<_Size>::Available()
+    {
+        return _pool.size();
+    }
+
+    template<unsigned _Size>
+    std::optional<uint32_t> RngPool<_Size>::Next()
+    {
+        if(_pool.empty())
+            return std::nullopt;
+
+        uint32_t random = _pool.front();
+        _pool.pop_front();
+        Rng::EnableInterrupt();
+        return random;
+    }
+
+    template<unsigned _Size>
+    bool RngPool<_Size>::NextBytes(uint8_t* data, size_t size)
+    {
+        if(_pool.size() < (size + 3) / 4)
+            return false;
+
+        for(size_t i = 0; i < size; i += 4) {
+            uint32_t random = _pool.front();
+            _pool.pop_front();
+            for(size_t j = i; j < size && j < i + 4; ++j, random >>= 8)
+                data[j] = static_cast<uint8_t>(random);
+        }
+
+        Rng::EnableInterrupt();
+        return true;
+    }
+
+    template<unsigned _Size>
+    unsigned RngPool<_Size>::Errors()
+    {
+        return _errors;
+    }
+
+    template<unsigned _Size>
+    void RngPool<_Size>::IrqHandler()
+    {
+        uint32_t status = RNG->SR;
+
+        if(status & (RNG_SR_SEIS | RNG_SR_CEIS)) {
+            _errors = _errors + 1;
+            RNG->SR &= ~RNG_SR_CEIS;
+            if(status & RNG_SR_SEIS)
+                Rng::Recover();
+            return;
+        }
+
+        while((RNG->SR & RNG_SR_DRDY) && !_pool.full())
+            _pool.push_back(static_cast<uint32_t>(RNG->DR));
+
+        if(_pool.full())
+            Rng::EnableInterrupt(false);
+    }
 } 
 
 #endif //! ZHELE_RNG_IMPL_COMMON_H_
\ No newline at end of file
@@ -0,0 +1,467 @@
+/**
+ * @file
+ * Implements internal RTC (calendar, wakeup timer, alarms)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_RTC_IMPL_COMMON_H
+#define ZHELE_RTC_IMPL_COMMON_H
+
+namespace Zhele::Private
+{
+    #define RTC_TEMPLATE_ARGS template<typename _ApbClock, uint8_t _WakeupLine, IRQn_Type _WakeupIRQn, uint8_t _AlarmLine, IRQn_Type _AlarmIRQn>
+    #define RTC_TEMPLATE_QUALIFIER Rtc<_ApbClock, _WakeupLine, _WakeupIRQn, _AlarmLine, _AlarmIRQn>
+
+    RTC_TEMPLATE_ARGS
+    bool RTC_TEMPLATE_QUALIFIER::Init(ClockSource source, uint32_t clockFreq, uint32_t asyncPrescaler)
+    {
+        if constexpr (!std::is_same_v<_ApbClock, void>)
+            _ApbClock::Enable();
+        EnableBackupAccess();
+
+        const uint32_t select = static_cast<uint32_t>(source) << RCC_BDCR_RTCSEL_Pos;
+        if ((RCC->BDCR & (RCC_BDCR_RTCEN | RCC_BDCR_RTCSEL)) == (RCC_BDCR_RTCEN | select))
+            return true;
+
+        // Clock source can be changed only after backup domain reset
+        if ((RCC->BDCR & RCC_BDCR_RTCSEL) != 0 && (RCC->BDCR & RCC_BDCR_RTCSEL) != select)
+        {
+            RCC->BDCR |= RCC_BDCR_BDRST;
+            RCC->BDCR &= ~RCC_BDCR_BDRST;
+        }
+
+        if (source == ClockSource::Lse)
+        {
+            RCC->BDCR |= RCC_BDCR_LSEON;
+            Deadline deadline(LseStartupTimeout, LseStartupTimeout * 1000);
+            while (!(RCC->BDCR & RCC_BDCR_LSERDY))
+            {
+                if (deadline.Expired())
+                    return false;
+            }
+        }
+        else if (!Clock::LsiClock::Enable())
+        {
+            return false;
+        }
+
+        RCC->BDCR = (RCC->BDCR & ~RCC_BDCR_RTCSEL) | select | RCC_BDCR_RTCEN;
+
+        Unlock();
+        const bool initialized = EnterInitMode();
+        if (initialized)
+        {
+            // Synchronous prescaler is written first
+            const uint32_t syncPrescaler = clockFreq / asyncPrescaler - 1;
+            RTC->PRER = syncPrescaler;
+            RTC->PRER = ((asyncPrescaler - 1) << RTC_PRER_PREDIV_A_Pos) | syncPrescaler;
+            RTC->CR &= ~RTC_CR_FMT;
+            ExitInitMode();
+        }
+        Lock();
+
+        return initialized;
+    }
+
+    RTC_TEMPLATE_ARGS
+    uint32_t RTC_TEMPLATE_QUALIFIER::TicksPerSecond()
+    {
+        return (RTC->PRER & RTC_PRER_PREDIV_S) + 1;
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::SetDateTime(const DateTime& dateTime)
+    {
+        Unlock();
+        if (EnterInitMode())
+        {
+            RTC->TR = (ToBcd(dateTime.Hours) << RTC_TR_HU_Pos)
+                | (ToBcd(dateTime.Minutes) << RTC_TR_MNU_Pos)
+                | (ToBcd(dateTime.Seconds) << RTC_TR_SU_Pos);
+            RTC->DR = (ToBcd(dateTime.Year) << RTC_DR_YU_Pos)
+                | (static_cast<uint32_t>(dateTime.Weekday) << RTC_DR_WDU_Pos)
+                | (ToBcd(dateTime.Month) << RTC_DR_MU_Pos)
+                | (ToBcd(dateTime.Day) << RTC_DR_DU_Pos);
+            ExitInitMode();
+        }
+        Lock();
+    }
+
+    RTC_TEMPLATE_ARGS
+    typename RTC_TEMPLATE_QUALIFIER::DateTime RTC_TEMPLATE_QUALIFIER::GetDateTime()
+    {
+        // Time register read locks date shadow register until it's read
+        const uint32_t time = RTC->TR;
+        const uint32_t date = RTC->DR;
+        return Decode(time, date);
+    }
+
+    RTC_TEMPLATE_ARGS
+    typename RTC_TEMPLATE_QUALIFIER::Instant RTC_TEMPLATE_QUALIFIER::Now()
+    {
+        // Sub-second register read locks time and date shadow registers until date is read
+        const uint32_t subseconds = RTC->SSR;
+        const uint32_t time = RTC->TR;
+        const uint32_t date = RTC->DR;
+
+        // Sub-second counter counts down from synchronous prescaler
+        const uint32_t prescaler = RTC->PRER & RTC_PRER_PREDIV_S;
+        const uint32_t ticks = subseconds <= prescaler ? prescaler - subseconds : 0;
+
+        return {ToEpoch(Decode(time, date)), static_cast<uint16_t>(ticks * 1000 / (prescaler + 1))};
+    }
+
+    RTC_TEMPLATE_ARGS
+    uint32_t RTC_TEMPLATE_QUALIFIER::DayTicks()
+    {
+        const uint32_t subseconds = RTC->SSR;
+        const uint32_t time = RTC->TR;
+        static_cast<void>(RTC->DR);
+
+        const uint32_t prescaler = RTC->PRER & RTC_PRER_PREDIV_S;
+        const uint32_t seconds = FromBcd(time >> RTC_TR_HU_Pos & 0x3f) * 3600
+            + FromBcd(time >> RTC_TR_MNU_Pos & 0x7f) * 60
+            + FromBcd(time >> RTC_TR_SU_Pos & 0x7f);
+
+        return seconds * (prescaler + 1) + (subseconds <= prescaler ? prescaler - subseconds : 0);
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::Resynchronize()
+    {
+        Unlock();
+        WaitSynchronization();
+        Lock();
+    }
+
+#if defined (RTC_CR_WUTE)
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::EnableWakeup(uint32_t milliseconds)
+    {
+        const uint32_t prescalers = RTC->PRER;
+        const uint32_t rtcClock = (((prescalers & RTC_PRER_PREDIV_A) >> RTC_PRER_PREDIV_A_Pos) + 1) * ((prescalers & RTC_PRER_PREDIV_S) + 1);
+        const uint64_t ticks = static_cast<uint64_t>(milliseconds) * (rtcClock / 16) / 1000;
+
+        uint32_t clockSelect;
+        uint32_t reload;
+        if (ticks <= 0x10000)
+        {
+            // RTC clock / 16
+            clockSelect = 0b000;
+            reload = ticks > 0 ? static_cast<uint32_t>(ticks) - 1 : 0;
+        }
+        else
+        {
+            // 1 Hz, 2^16 is added to counter if period is longer than 2^16 seconds
+            const uint32_t seconds = (milliseconds + 500) / 1000;
+            clockSelect = seconds <= 0x10000 ? 0b100 : 0b110;
+            reload = seconds <= 0x10000 ? seconds - 1 : (seconds - 0x10001 <= 0xffff ? seconds - 0x10001 : 0xffff);
+        }
+
+        Unlock();
+        RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+        while (!(InitStatus() & WakeupWriteFlag)) ;
+        RTC->WUTR = reload;
+        RTC->CR = (RTC->CR & ~RTC_CR_WUCKSEL) | (clockSelect << RTC_CR_WUCKSEL_Pos);
+        ClearInterruptFlag(Interrupt::Wakeup);
+        RTC->CR |= RTC_CR_WUTE | RTC_CR_WUTIE;
+        Lock();
+
+        EnableExtiLine(_WakeupLine, _WakeupIRQn);
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::DisableWakeup()
+    {
+        Unlock();
+        RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+        Lock();
+        ClearInterruptFlag(Interrupt::Wakeup);
+    }
+#endif
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::EnableAlarm(Alarm alarm, const DateTime& dateTime, AlarmMatch match)
+    {
+        const uint32_t value = static_cast<uint32_t>(match)
+            | (ToBcd(dateTime.Day) << RTC_ALRMAR_DU_Pos)
+            | (ToBcd(dateTime.Hours) << RTC_ALRMAR_HU_Pos)
+            | (ToBcd(dateTime.Minutes) << RTC_ALRMAR_MNU_Pos)
+            | (ToBcd(dateTime.Seconds) << RTC_ALRMAR_SU_Pos);
+
+        Unlock();
+    #if defined (RTC_CR_ALRBE)
+        if (alarm == Alarm::B)
+        {
+            RTC->CR &= ~(RTC_CR_ALRBE | RTC_CR_ALRBIE);
+        #if defined (RTC_ISR_ALRBWF)
+            while (!(RTC->ISR & RTC_ISR_ALRBWF)) ;
+        #endif
+            RTC->ALRMBR = value;
+            RTC->ALRMBSSR = 0;
+            ClearInterruptFlag(Interrupt::AlarmB);
+            RTC->CR |= RTC_CR_ALRBE | RTC_CR_ALRBIE;
+        }
+        else
+    #endif
+        {
+            RTC->CR &= ~(RTC_CR_ALRAE | RTC_CR_ALRAIE);
+        #if defined (RTC_ISR_ALRAWF)
+            while (!(RTC->ISR & RTC_ISR_ALRAWF)) ;
+        #endif
+            RTC->ALRMAR = value;
+            RTC->ALRMASSR = 0;
+            ClearInterruptFlag(Interrupt::AlarmA);
+            RTC->CR |= RTC_CR_ALRAE | RTC_CR_ALRAIE;
+        }
+        Lock();
+
+        EnableExtiLine(_AlarmLine, _AlarmIRQn);
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::DisableAlarm(Alarm alarm)
+    {
+        Unlock();
+    #if defined (RTC_CR_ALRBE)
+        if (alarm == Alarm::B)
+        {
+            RTC->CR &= ~(RTC_CR_ALRBE | RTC_CR_ALRBIE);
+            ClearInterruptFlag(Interrupt::AlarmB);
+        }
+        else
+    #endif
+        {
+            RTC->CR &= ~(RTC_CR_ALRAE | RTC_CR_ALRAIE);
+            ClearInterruptFlag(Interrupt::AlarmA);
+        }
+        Lock();
+    }
+
+    RTC_TEMPLATE_ARGS
+    bool RTC_TEMPLATE_QUALIFIER::IsInterrupt(Interrupt interrupt)
+    {
+    #if defined (RTC_ICSR_INIT)
+        return RTC->SR & static_cast<uint32_t>(interrupt);
+    #else
+        return RTC->ISR & static_cast<uint32_t>(interrupt);
+    #endif
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::ClearInterruptFlag(Interrupt interrupt)
+    {
+    #if defined (RTC_ICSR_INIT)
+        // Clear register bits have the same positions as status bits
+        RTC->SCR = static_cast<uint32_t>(interrupt);
+    #else
+        // Flags are cleared by writing zero, init bit is kept
+        RTC->ISR = ~(static_cast<uint32_t>(interrupt) | RTC_ISR_INIT) | (RTC->ISR & RTC_ISR_INIT);
+    #endif
+
+    #if defined (RTC_CR_WUTE)
+        ClearExtiLine(interrupt == Interrupt::Wakeup ? _WakeupLine : _AlarmLine);
+    #else
+        ClearExtiLine(_AlarmLine);
+    #endif
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::SetCalibration(int32_t ppb)
+    {
+        Unlock();
+        // Calibration register can't be written while previous value is applying
+        while (InitStatus() & RecalibrationFlag) ;
+        RTC->CALR = CalculateCalibration(ppb);
+        Lock();
+    }
+
+    RTC_TEMPLATE_ARGS
+    constexpr uint32_t RTC_TEMPLATE_QUALIFIER::CalculateCalibration(int32_t ppb)
+    {
+        // Correction is number of pulses added in 2^20 RTC clocks window: CALP adds 512 pulses, CALM masks pulses
+        const int64_t scaled = static_cast<int64_t>(ppb) * (1 << 20);
+        const int64_t pulses = (scaled + (scaled >= 0 ? 500000000 : -500000000)) / 1000000000;
+
+        if (pulses > 0)
+            return RTC_CALR_CALP | static_cast<uint32_t>(512 - (pulses < 512 ? pulses : 512));
+
+        return static_cast<uint32_t>(-pulses < 511 ? -pulses : 511);
+    }
+
+    RTC_TEMPLATE_ARGS
+    constexpr uint32_t RTC_TEMPLATE_QUALIFIER::ToEpoch(const DateTime& dateTime)
+    {
+        // Year starts from March, so leap day is last day of year (days from civil algorithm)
+        const uint32_t year = 2000u + dateTime.Year - (dateTime.Month <= 2 ? 1 : 0);
+        const uint32_t era = year / 400;
+        const uint32_t yearOfEra = year - era * 400;
+        const uint32_t dayOfYear = (153 * (dateTime.Month > 2 ? dateTime.Month - 3 : dateTime.Month + 9) + 2) / 5 + dateTime.Day - 1;
+        const uint32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        const uint32_t days = era * 146097 + dayOfEra - UnixEpochDays;
+
+        return days * 86400 + dateTime.Hours * 3600 + dateTime.Minutes * 60 + dateTime.Seconds;
+    }
+
+    RTC_TEMPLATE_ARGS
+    constexpr typename RTC_TEMPLATE_QUALIFIER::DateTime RTC_TEMPLATE_QUALIFIER::FromEpoch(uint32_t epoch)
+    {
+        // Civil from days algorithm
+        const uint32_t days = epoch / 86400;
+        const uint32_t seconds = epoch % 86400;
+
+        const uint32_t shiftedDays = days + UnixEpochDays;
+        const uint32_t era = shiftedDays / 146097;
+        const uint32_t dayOfEra = shiftedDays - era * 146097;
+        const uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const uint32_t monthIndex = (5 * dayOfYear + 2) / 153;
+        const uint32_t month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+        const uint32_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+        DateTime dateTime {};
+        dateTime.Seconds = static_cast<uint8_t>(seconds % 60);
+        dateTime.Minutes = static_cast<uint8_t>(seconds / 60 % 60);
+        dateTime.Hours = static_cast<uint8_t>(seconds / 3600);
+        // 1970-01-01 is Thursday
+        dateTime.Weekday = static_cast<uint8_t>((days + 3) % 7 + 1);
+        dateTime.Day = static_cast<uint8_t>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+        dateTime.Month = static_cast<uint8_t>(month);
+        dateTime.Year = static_cast<uint8_t>(year - 2000);
+
+        return dateTime;
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::EnableBackupAccess()
+    {
+        Clock::PowerClock::Enable();
+    #if defined (PWR_CR1_DBP)
+        PWR->CR1 |= PWR_CR1_DBP;
+        while (!(PWR->CR1 & PWR_CR1_DBP)) ;
+    #else
+        PWR->CR |= PWR_CR_DBP;
+        while (!(PWR->CR & PWR_CR_DBP)) ;
+    #endif
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::Unlock()
+    {
+        RTC->WPR = 0xca;
+        RTC->WPR = 0x53;
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::Lock()
+    {
+        RTC->WPR = 0xff;
+    }
+
+    RTC_TEMPLATE_ARGS
+    bool RTC_TEMPLATE_QUALIFIER::EnterInitMode()
+    {
+    #if defined (RTC_ICSR_INIT)
+        RTC->ICSR |= RTC_ICSR_INIT;
+    #else
+        // Flags are not cleared by writing ones
+        RTC->ISR = ~0u;
+    #endif
+
+        // Init mode is entered in 2 RTC clocks
+        Deadline deadline(10, 10000);
+        while (!(InitStatus() & InitReadyFlag))
+        {
+            if (deadline.Expired())
+            {
+                ExitInitMode();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::ExitInitMode()
+    {
+    #if defined (RTC_ICSR_INIT)
+        RTC->ICSR &= ~RTC_ICSR_INIT;
+    #else
+        RTC->ISR = ~RTC_ISR_INIT;
+    #endif
+        WaitSynchronization();
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::WaitSynchronization()
+    {
+    #if defined (RTC_ICSR_INIT)
+        RTC->ICSR &= ~RTC_ICSR_RSF;
+    #else
+        RTC->ISR = ~(RTC_ISR_RSF | RTC_ISR_INIT) | (RTC->ISR & RTC_ISR_INIT);
+    #endif
+
+        Deadline deadline(10, 10000);
+        while (!(InitStatus() & SyncFlag) && !deadline.Expired()) ;
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::EnableExtiLine(uint8_t line, IRQn_Type irq)
+    {
+        const uint32_t mask = 1u << line;
+    #if defined (EXTI_PR1_PIF0)
+        EXTI->RTSR1 |= mask;
+        EXTI->IMR1 |= mask;
+    #elif defined (EXTI_IMR1_IM0)
+        // RTC line is direct (always rising edge)
+        EXTI->IMR1 |= mask;
+    #else
+        EXTI->RTSR |= mask;
+        EXTI->IMR |= mask;
+    #endif
+        NVIC_EnableIRQ(irq);
+    }
+
+    RTC_TEMPLATE_ARGS
+    void RTC_TEMPLATE_QUALIFIER::ClearExtiLine(uint8_t line)
+    {
+    #if defined (EXTI_PR1_PIF0)
+        EXTI->PR1 = 1u << line;
+    #elif defined (EXTI_IMR1_IM0)
+        // Direct line has no pending flag
+        static_cast<void>(line);
+    #else
+        EXTI->PR = 1u << line;
+    #endif
+    }
+
+    RTC_TEMPLATE_ARGS
+    volatile uint32_t& RTC_TEMPLATE_QUALIFIER::InitStatus()
+    {
+    #if defined (RTC_ICSR_INIT)
+        return RTC->ICSR;
+    #else
+        return RTC->ISR;
+    #endif
+    }
+
+    RTC_TEMPLATE_ARGS
+    typename RTC_TEMPLATE_QUALIFIER::DateTime RTC_TEMPLATE_QUALIFIER::Decode(uint32_t time, uint32_t date)
+    {
+        DateTime dateTime {};
+        dateTime.Seconds = FromBcd(time >> RTC_TR_SU_Pos & 0x7f);
+        dateTime.Minutes = FromBcd(time >> RTC_TR_MNU_Pos & 0x7f);
+        dateTime.Hours = FromBcd(time >> RTC_TR_HU_Pos & 0x3f);
+        dateTime.Weekday = static_cast<uint8_t>(date >> RTC_DR_WDU_Pos & 0x07);
+        dateTime.Day = FromBcd(date >> RTC_DR_DU_Pos & 0x3f);
+        dateTime.Month = FromBcd(date >> RTC_DR_MU_Pos & 0x1f);
+        dateTime.Year = FromBcd(date >> RTC_DR_YU_Pos & 0xff);
+
+        return dateTime;
+    }
+}
+
+#endif //! ZHELE_RTC_IMPL_COMMON_H
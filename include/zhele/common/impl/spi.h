@@ -39,6 +39,7 @@ namespace Zhele::Private
     void SPI_TEMPLATE_QUALIFIER::Init(SPI_TEMPLATE_QUALIFIER::ClockDivider divider, SPI_TEMPLATE_QUALIFIER::Mode mode)
     {
         _Clock::Enable();
+        _maxFrequency = 0;
         _Regs()->CR1 = static_cast<unsigned>(divider) | mode;
         _Regs()->CR2 = (mode >> 16) | SPI_CR2_SSOE;
         SetDataSize(DataSize::DataSize8);
@@ -48,9 +49,57 @@ namespace Zhele::Private
         Enable();
     }
 
+    SPI_TEMPLATE_ARGS
+    template<unsigned long maxFreq>
+    void SPI_TEMPLATE_QUALIFIER::Init(SPI_TEMPLATE_QUALIFIER::Mode mode)
+    {
+        Init(CalculateDivider(_Clock::ClockFreq(), maxFreq), mode);
+        _maxFrequency = maxFreq;
+        Clock::ClockChange::Subscribe<ClockChanged>();
+    }
+
+    SPI_TEMPLATE_ARGS
+    template<unsigned long maxFreq, unsigned long clockFreq>
+    void SPI_TEMPLATE_QUALIFIER::Init(SPI_TEMPLATE_QUALIFIER::Mode mode)
+    {
+        static_assert(AchievedFrequency<maxFreq, clockFreq>() <= maxFreq, "SPI clock cannot be reduced to required frequency");
+        Init(CalculateDivider(clockFreq, maxFreq), mode);
+        _maxFrequency = maxFreq;
+        Clock::ClockChange::Subscribe<ClockChanged>();
+    }
+
+    SPI_TEMPLATE_ARGS
+    uint32_t SPI_TEMPLATE_QUALIFIER::SetFrequency(uint32_t maxFreq)
+    {
+        uint32_t clockFreq = _Clock::ClockFreq();
+        ClockDivider divider = CalculateDivider(clockFreq, maxFreq);
+
+        // Baud rate should not be changed during communication
+        while (Busy()) ;
+        SetDivider(divider);
+        _maxFrequency = maxFreq;
+        Clock::ClockChange::Subscribe<ClockChanged>();
+
+        return DividerFrequency(clockFreq, divider);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::ClockChanged()
+    {
+        if (_maxFrequency != 0)
+            SetFrequency(_maxFrequency);
+    }
+
+    SPI_TEMPLATE_ARGS
+    uint32_t SPI_TEMPLATE_QUALIFIER::GetFrequency()
+    {
+        return DividerFrequency(_Clock::ClockFreq(), static_cast<ClockDivider>(_Regs()->CR1 & SPI_CR1_BR));
+    }
+
     SPI_TEMPLATE_ARGS
     void SPI_TEMPLATE_QUALIFIER::SetDivider(SPI_TEMPLATE_QUALIFIER::ClockDivider divider)
     {
+        _maxFrequency = 0;
         _Regs()->CR1 = (_Regs()->CR1 & ~SPI_CR1_BR) | divider;
     }
 
@@ -88,6 +137,38 @@ namespace Zhele::Private
         #endif
     }
 
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::Configure(SPI_TEMPLATE_QUALIFIER::ClockDivider divider, SPI_TEMPLATE_QUALIFIER::ClockPolarity clockPolarity,
+        SPI_TEMPLATE_QUALIFIER::ClockPhase clockPhase, SPI_TEMPLATE_QUALIFIER::BitOrder bitOrder, SPI_TEMPLATE_QUALIFIER::DataSize dataSize)
+    {
+        _maxFrequency = 0;
+        while (Busy()) ;
+
+        ShadowReg cr1(_Regs()->CR1);
+        ShadowReg cr2(_Regs()->CR2);
+    #if defined (SPI_CR1_DFF)
+        cr1.AndOr(~(SPI_CR1_BR | SPI_CR1_CPOL | SPI_CR1_CPHA | SPI_CR1_LSBFIRST | SPI_CR1_DFF_Msk),
+            static_cast<uint32_t>(divider) | clockPolarity | clockPhase | bitOrder | dataSize);
+    #else
+        cr1.AndOr(~(SPI_CR1_BR | SPI_CR1_CPOL | SPI_CR1_CPHA | SPI_CR1_LSBFIRST), static_cast<uint32_t>(divider) | clockPolarity | clockPhase | bitOrder);
+        #if defined (SPI_CR2_FRXTH)
+            cr2.AndOr(~(SPI_CR2_DS | SPI_CR2_FRXTH), dataSize | (dataSize <= DataSize8 ? SPI_CR2_FRXTH : 0));
+        #else
+            cr2.AndOr(~SPI_CR2_DS, dataSize);
+        #endif
+    #endif
+
+        if (!cr1.Changed() && !cr2.Changed())
+            return;
+
+        // Shadow keeps SPE, so SPI is enabled again by CR1 commit
+        const bool enabled = (cr1.Get() & SPI_CR1_SPE) != 0;
+        if (enabled)
+            Disable();
+        cr2.Commit();
+        cr1.Commit(enabled);
+    }
+
     SPI_TEMPLATE_ARGS
     void SPI_TEMPLATE_QUALIFIER::SetSlaveControl(SPI_TEMPLATE_QUALIFIER::SlaveControl slaveControl)
     {
@@ -149,7 +230,7 @@ namespace Zhele::Private
     void SPI_TEMPLATE_QUALIFIER::SendAsync(void* transmitBuffer, void* receiveBuffer, size_t bufferSize, TransferCallback callback)
     {
         _DmaRx::ClearTransferComplete();
-        _Regs()->CR2 |= (SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+        AtomicSetBits(_Regs()->CR2, SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
         auto dataSize = 
         #if defined(SPI_CR1_DFF)
             (_Regs()->CR1 & SPI_CR1_DFF) > 0
@@ -158,12 +239,256 @@ namespace Zhele::Private
         #endif
             ? (_DmaTx::PSize16Bits | _DmaTx::MSize16Bits)
             : (_DmaTx::PSize8Bits | _DmaTx::MSize8Bits);
-        _DmaRx::SetTransferCallback(callback);
-        _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular | dataSize, receiveBuffer, &_Regs()->DR, bufferSize);
+        if (_Regs()->CR1 & SPI_CR1_CRCEN)
+        {
+            // CRC is sent by hardware after last TX DMA frame and is checked after last RX frame
+            _crcCallback = callback;
+            _DmaRx::SetTransferCallback(CrcTransferComplete);
+        }
+        else
+        {
+            _DmaRx::SetTransferCallback(callback);
+        }
+        _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | dataSize, receiveBuffer, &_Regs()->DR, bufferSize);
 
         _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaRx::MemIncrement | dataSize, transmitBuffer, &_Regs()->DR, bufferSize);
     }
 
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::EnableCrc(uint16_t polynomial)
+    {
+        while (Busy()) ;
+
+        // CRC configuration can be changed only when SPI is disabled
+        Disable();
+        _Regs()->CR1 &= ~SPI_CR1_CRCEN;
+        _Regs()->CRCPR = polynomial;
+    #if defined (SPI_CR1_CRCL)
+        _Regs()->CR1 = (_Regs()->CR1 & ~SPI_CR1_CRCL) | (polynomial > 0xff ? SPI_CR1_CRCL : 0) | SPI_CR1_CRCEN;
+    #else
+        _Regs()->CR1 |= SPI_CR1_CRCEN;
+    #endif
+        _Regs()->SR = static_cast<uint16_t>(~SPI_SR_CRCERR);
+        _crcErrors = 0;
+        Enable();
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::DisableCrc()
+    {
+        while (Busy()) ;
+
+        Disable();
+        _Regs()->CR1 &= ~SPI_CR1_CRCEN;
+        Enable();
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::ResetCrc()
+    {
+        if (!(_Regs()->CR1 & SPI_CR1_CRCEN))
+            return;
+
+        while (Busy()) ;
+
+        // CRC registers are cleared by CRCEN toggle
+        Disable();
+        _Regs()->CR1 &= ~SPI_CR1_CRCEN;
+        _Regs()->CR1 |= SPI_CR1_CRCEN;
+        Enable();
+    }
+
+    SPI_TEMPLATE_ARGS
+    uint16_t SPI_TEMPLATE_QUALIFIER::RxCrc()
+    {
+        return _Regs()->RXCRCR;
+    }
+
+    SPI_TEMPLATE_ARGS
+    uint16_t SPI_TEMPLATE_QUALIFIER::TxCrc()
+    {
+        return _Regs()->TXCRCR;
+    }
+
+    SPI_TEMPLATE_ARGS
+    uint32_t SPI_TEMPLATE_QUALIFIER::CrcErrors()
+    {
+        return _crcErrors;
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::CrcTransferComplete(void* data, unsigned size, bool success)
+    {
+        // Received CRC is not transferred by DMA: it's left in data register (RX FIFO)
+        while (Busy()) ;
+        while (_Regs()->SR & SPI_SR_RXNE)
+            (void)*reinterpret_cast<volatile uint8_t*>(&_Regs()->DR);
+
+        if (_Regs()->SR & SPI_SR_CRCERR)
+        {
+            _Regs()->SR = static_cast<uint16_t>(~SPI_SR_CRCERR);
+            ++_crcErrors;
+            success = false;
+        }
+        ResetCrc();
+
+        TransferCallback callback = _crcCallback;
+        if (callback)
+            callback(data, size, success);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::Transfer(const void* transmitBuffer, void* receiveBuffer, size_t size)
+    {
+        TransferFrames(transmitBuffer, receiveBuffer, size, false);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::Transfer16(const uint16_t* transmitBuffer, uint16_t* receiveBuffer, size_t count)
+    {
+        while (Busy()) ;
+
+    #if defined(SPI_CR1_DFF)
+        uint32_t previousDataSize = _Regs()->CR1 & SPI_CR1_DFF;
+    #else
+        uint32_t previousDataSize = _Regs()->CR2 & SPI_CR2_DS;
+    #endif
+
+        // Data size can be changed only when SPI is disabled
+        Disable();
+        SetDataSize(DataSize16);
+    #if defined(SPI_CR2_FRXTH)
+        _Regs()->CR2 &= ~SPI_CR2_FRXTH;
+    #endif
+        Enable();
+
+        TransferFrames(transmitBuffer, receiveBuffer, count, true);
+
+        Disable();
+        SetDataSize(static_cast<DataSize>(previousDataSize));
+        Enable();
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::TransferFrames(const void* transmitBuffer, void* receiveBuffer, size_t count, bool wide)
+    {
+        if (count == 0)
+            return;
+
+        if constexpr (!std::is_same_v<_DmaTx, void> && !std::is_same_v<_DmaRx, void>)
+        {
+            if (count >= DmaTransferThreshold)
+            {
+                typename _DmaTx::Mode dataSize = wide
+                    ? (_DmaTx::PSize16Bits | _DmaTx::MSize16Bits)
+                    : (_DmaTx::PSize8Bits | _DmaTx::MSize8Bits);
+
+                // Missing buffers are replaced by dummy values without memory increment
+                // (received data goes to separate sink, so transmitted dummy stays 0xffff)
+                typename _DmaTx::Mode rxMode = _DmaRx::Periph2Mem | dataSize;
+                if (receiveBuffer)
+                    rxMode = rxMode | _DmaRx::MemIncrement;
+                typename _DmaTx::Mode txMode = _DmaTx::Mem2Periph | dataSize;
+                if (transmitBuffer)
+                    txMode = txMode | _DmaTx::MemIncrement;
+
+                _DmaTx::SetTransferCallback(nullptr);
+                _DmaRx::SetTransferCallback(nullptr);
+                _DmaTx::SetHalfTransferCallback(nullptr);
+                _DmaRx::SetHalfTransferCallback(nullptr);
+                _DmaRx::ClearFlags();
+                _DmaTx::ClearFlags();
+
+                // RX should be ready before first frame is clocked
+                AtomicSetBits(_Regs()->CR2, SPI_CR2_RXDMAEN);
+                _DmaRx::Transfer(rxMode, receiveBuffer ? receiveBuffer : &_dummyRx, &_Regs()->DR, count);
+                _DmaTx::Transfer(txMode, transmitBuffer ? transmitBuffer : &_dummy, &_Regs()->DR, count);
+                AtomicSetBits(_Regs()->CR2, SPI_CR2_TXDMAEN);
+
+                // Last frame is received after it was transmitted, so RX complete means both are finished
+                while (!_DmaRx::TransferComplete() && !_DmaRx::TransferError()) ;
+                while (Busy()) ;
+
+                AtomicClearBits(_Regs()->CR2, SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+                _DmaRx::ClearFlags();
+                _DmaTx::ClearFlags();
+                _DmaRx::Disable();
+                _DmaTx::Disable();
+                return;
+            }
+        }
+
+    #if defined (SPI_CR2_FRXTH)
+        if (!wide && count > 1)
+        {
+            TransferPacked(static_cast<const uint8_t*>(transmitBuffer), static_cast<uint8_t*>(receiveBuffer), count);
+            return;
+        }
+    #endif
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (wide)
+            {
+                uint16_t value = Send(transmitBuffer ? static_cast<const uint16_t*>(transmitBuffer)[i] : _dummy);
+                if (receiveBuffer)
+                    static_cast<uint16_t*>(receiveBuffer)[i] = value;
+            }
+            else
+            {
+                uint8_t value = Send(transmitBuffer ? static_cast<const uint8_t*>(transmitBuffer)[i] : 0xff);
+                if (receiveBuffer)
+                    static_cast<uint8_t*>(receiveBuffer)[i] = value;
+            }
+        }
+    }
+
+#if defined (SPI_CR2_FRXTH)
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::TransferPacked(const uint8_t* transmitBuffer, uint8_t* receiveBuffer, size_t count)
+    {
+        __IO uint16_t& dr = *reinterpret_cast<__IO uint16_t*>(&_Regs()->DR);
+        const size_t pairs = count / 2;
+        size_t sent = 0;
+        size_t received = 0;
+
+        // RXNE is set when FIFO holds two frames
+        _Regs()->CR2 &= ~SPI_CR2_FRXTH;
+
+        while (received < pairs)
+        {
+            // TXE means TX FIFO is at most half full, so packed pair fits it
+            if (sent < pairs && sent - received < 2 && (_Regs()->SR & SPI_SR_TXE))
+            {
+                dr = transmitBuffer
+                    ? static_cast<uint16_t>(transmitBuffer[2 * sent] | (transmitBuffer[2 * sent + 1] << 8))
+                    : 0xffff;
+                ++sent;
+            }
+
+            if (_Regs()->SR & SPI_SR_RXNE)
+            {
+                uint16_t value = dr;
+                if (receiveBuffer)
+                {
+                    receiveBuffer[2 * received] = static_cast<uint8_t>(value);
+                    receiveBuffer[2 * received + 1] = static_cast<uint8_t>(value >> 8);
+                }
+                ++received;
+            }
+        }
+
+        _Regs()->CR2 |= SPI_CR2_FRXTH;
+
+        if (count & 1)
+        {
+            uint8_t value = Send(transmitBuffer ? transmitBuffer[count - 1] : 0xff);
+            if (receiveBuffer)
+                receiveBuffer[count - 1] = value;
+        }
+    }
+#endif
+
     SPI_TEMPLATE_ARGS
     void SPI_TEMPLATE_QUALIFIER::Write(uint16_t data)
     {
@@ -174,7 +499,7 @@ namespace Zhele::Private
     void SPI_TEMPLATE_QUALIFIER::WriteAsync(const void* data, uint16_t size, TransferCallback callback)
     {
         _DmaTx::ClearTransferComplete();
-        _Regs()->CR2 |= SPI_CR2_TXDMAEN;
+        AtomicSetBits(_Regs()->CR2, SPI_CR2_TXDMAEN);
         typename _DmaTx::Mode dataSize = 
         #if defined(SPI_CR1_DFF)
             (_Regs()->CR1 & SPI_CR1_DFF) > 0
@@ -192,7 +517,7 @@ namespace Zhele::Private
     void SPI_TEMPLATE_QUALIFIER::WriteAsyncNoIncrement(const void* data, uint16_t size, TransferCallback callback)
     {
         _DmaTx::ClearTransferComplete();
-        _Regs()->CR2 |= SPI_CR2_TXDMAEN;
+        AtomicSetBits(_Regs()->CR2, SPI_CR2_TXDMAEN);
         auto dataSize = 
         #if defined(SPI_CR1_DFF)
             (_Regs()->CR1 & SPI_CR1_DFF) > 0
@@ -206,6 +531,125 @@ namespace Zhele::Private
         _DmaTx::Transfer(_DmaTx::Mem2Periph | dataSize, data, &_Regs()->DR, size);
     }
 
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::Fill(uint16_t value, size_t count, TransferCallback callback)
+    {
+        while (Busy()) ;
+
+    #if defined(SPI_CR1_DFF)
+        _fillDataSize = _Regs()->CR1 & SPI_CR1_DFF;
+    #else
+        _fillDataSize = _Regs()->CR2 & SPI_CR2_DS;
+    #endif
+
+        // Data size can be changed only when SPI is disabled
+        Disable();
+        SetDataSize(DataSize16);
+        Enable();
+
+        _fillValue = value;
+        _fillCount = count;
+        _fillRemaining = count;
+        _fillCallback = callback;
+
+        if constexpr (!std::is_same_v<_DmaTx, void>)
+        {
+            if (count > 0)
+            {
+                FillChunk();
+                return;
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            Write(value);
+        _fillRemaining = 0;
+
+        FillComplete();
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::FillChunk()
+    {
+        uint16_t chunk = _fillRemaining > 0xffff ? 0xffff : _fillRemaining;
+        _fillRemaining = _fillRemaining - chunk;
+
+        _DmaTx::ClearTransferComplete();
+        AtomicSetBits(_Regs()->CR2, SPI_CR2_TXDMAEN);
+        _DmaTx::SetTransferCallback(FillHandler);
+        _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::PSize16Bits | _DmaTx::MSize16Bits, &_fillValue, &_Regs()->DR, chunk);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::FillHandler(void* data, unsigned size, bool success)
+    {
+        if (success && _fillRemaining > 0)
+        {
+            FillChunk();
+            return;
+        }
+
+        FillComplete();
+    }
+
+    SPI_TEMPLATE_ARGS
+    volatile void* SPI_TEMPLATE_QUALIFIER::RxDataRegister()
+    {
+        return &_Regs()->DR;
+    }
+
+    SPI_TEMPLATE_ARGS
+    volatile void* SPI_TEMPLATE_QUALIFIER::TxDataRegister()
+    {
+        return &_Regs()->DR;
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::EnableRxDma(bool enable)
+    {
+        if (enable)
+            AtomicSetBits(_Regs()->CR2, SPI_CR2_RXDMAEN);
+        else
+            AtomicClearBits(_Regs()->CR2, SPI_CR2_RXDMAEN);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::EnableTxDma(bool enable)
+    {
+        if (enable)
+            AtomicSetBits(_Regs()->CR2, SPI_CR2_TXDMAEN);
+        else
+            AtomicClearBits(_Regs()->CR2, SPI_CR2_TXDMAEN);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::EndWrite()
+    {
+        // Last frame is still shifted out when DMA is complete
+        while ((_Regs()->SR & SPI_SR_TXE) == 0) ;
+        while (Busy()) ;
+
+        if constexpr (!std::is_same_v<_DmaTx, void>)
+            AtomicClearBits(_Regs()->CR2, SPI_CR2_TXDMAEN);
+
+        // Received frames are ignored, so clear overrun flag
+        (void)_Regs()->DR;
+        (void)_Regs()->SR;
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::FillComplete()
+    {
+        EndWrite();
+
+        Disable();
+        SetDataSize(static_cast<DataSize>(_fillDataSize));
+        Enable();
+
+        if (_fillCallback)
+            _fillCallback(&_fillValue, _fillCount - _fillRemaining, _fillRemaining == 0);
+    }
+
     SPI_TEMPLATE_ARGS
     uint16_t SPI_TEMPLATE_QUALIFIER::Read()
     {
@@ -216,7 +660,7 @@ namespace Zhele::Private
     void SPI_TEMPLATE_QUALIFIER::ReadAsync(void* receiveBuffer, size_t bufferSize, TransferCallback callback)
     {
         _DmaRx::ClearTransferComplete();
-        _Regs()->CR2 |= (SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+        AtomicSetBits(_Regs()->CR2, SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
         auto dataSize = 
         #if defined(SPI_CR1_DFF)
             (_Regs()->CR1 & SPI_CR1_DFF) > 0
@@ -226,11 +670,76 @@ namespace Zhele::Private
             ? (_DmaTx::PSize16Bits | _DmaTx::MSize16Bits)
             : (_DmaTx::PSize8Bits | _DmaTx::MSize8Bits);
         _DmaRx::SetTransferCallback(callback);
+        _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | dataSize, receiveBuffer, &_Regs()->DR, bufferSize);
+
+        // Send dummmy value (static, because DMA reads it after return)
+        WriteAsyncNoIncrement(&_dummy, bufferSize);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::EnableSlaveStream(void* receiveBuffer, size_t bufferSize, ReceiveCallback callback)
+    {
+        _streamBuffer = static_cast<uint8_t*>(receiveBuffer);
+        _streamBufferSize = bufferSize;
+        _streamPosition = 0;
+        _streamCallback = callback;
+
+        typename _DmaRx::Mode dataSize =
+        #if defined(SPI_CR1_DFF)
+            (_Regs()->CR1 & SPI_CR1_DFF) > 0
+        #else
+            (_Regs()->CR2 & SPI_CR2_DS) > DataSize8
+        #endif
+            ? (_DmaRx::PSize16Bits | _DmaRx::MSize16Bits)
+            : (_DmaRx::PSize8Bits | _DmaRx::MSize8Bits);
+
+        _DmaRx::ClearFlags();
+        _DmaRx::SetTransferCallback(nullptr);
+        _DmaRx::SetHalfTransferCallback(nullptr);
+        AtomicSetBits(_Regs()->CR2, SPI_CR2_RXDMAEN);
         _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular | dataSize, receiveBuffer, &_Regs()->DR, bufferSize);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::DisableSlaveStream()
+    {
+        _DmaRx::Disable();
+        AtomicClearBits(_Regs()->CR2, SPI_CR2_RXDMAEN);
+        _streamCallback = nullptr;
+        _streamBufferSize = 0;
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::SlaveFrameEnd()
+    {
+        if(_streamBufferSize == 0)
+            return;
+
+        size_t position = _streamBufferSize - _DmaRx::RemainingTransfers();
+        size_t last = _streamPosition;
+        size_t frameSize =
+        #if defined(SPI_CR1_DFF)
+            (_Regs()->CR1 & SPI_CR1_DFF) > 0
+        #else
+            (_Regs()->CR2 & SPI_CR2_DS) > DataSize8
+        #endif
+            ? 2 : 1;
+
+        if(_streamCallback && position != last)
+        {
+            if(position > last)
+            {
+                _streamCallback(_streamBuffer + last * frameSize, (position - last) * frameSize);
+            }
+            else
+            {
+                _streamCallback(_streamBuffer + last * frameSize, (_streamBufferSize - last) * frameSize);
+                if(position > 0)
+                    _streamCallback(_streamBuffer, position * frameSize);
+            }
+        }
 
-        // Send dummmy value
-        uint16_t dummy = 0xffff;
-        _DmaTx::Transfer(_DmaTx::Mem2Periph | dataSize, &dummy, &_Regs()->DR, bufferSize);
+        _streamPosition = position == _streamBufferSize ? 0 : position;
     }
 }
 #endif //! ZHELE_SPI_IMPL_COMMON_H
\ No newline at end of file
@@ -0,0 +1,80 @@
+/**
+ * @file
+ * Implements peripheral runtime statistics counters
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_STATISTICS_IMPL_COMMON_H
+#define ZHELE_STATISTICS_IMPL_COMMON_H
+
+#include <cstring>
+
+namespace Zhele::Statistics
+{
+    inline Group::Group(const char* name, const char* const* names, volatile uint32_t* values, unsigned size)
+        : _name(name)
+        , _names(names)
+        , _values(values)
+        , _size(size)
+        , _next(_first)
+    {
+        // Groups are constructed on static initialization (before interrupts are enabled)
+        _first = this;
+    }
+
+    inline const Group* First()
+    {
+        return Group::_first;
+    }
+
+    inline void Reset()
+    {
+        for (Group* group = Group::_first; group != nullptr; group = group->_next)
+        {
+            for (unsigned i = 0; i < group->_size; ++i)
+                group->_values[i] = 0;
+        }
+    }
+
+    namespace Private
+    {
+        template<typename _Output>
+        void WriteNumber(uint32_t value)
+        {
+            char buffer[10];
+            unsigned position = sizeof(buffer);
+            do
+            {
+                buffer[--position] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+
+            _Output::Write(buffer + position, sizeof(buffer) - position);
+        }
+    }
+
+    template<typename _Output>
+    void Report()
+    {
+        for (const Group* group = First(); group != nullptr; group = group->Next())
+        {
+            _Output::Write(group->Name(), std::strlen(group->Name()));
+            _Output::Write(":", 1);
+
+            for (unsigned i = 0; i < group->Size(); ++i)
+            {
+                _Output::Write(" ", 1);
+                _Output::Write(group->CounterName(i), std::strlen(group->CounterName(i)));
+                _Output::Write("=", 1);
+                Private::WriteNumber<_Output>(group->Value(i));
+            }
+
+            _Output::Write("\r\n", 2);
+        }
+    }
+}
+
+#endif //! ZHELE_STATISTICS_IMPL_COMMON_H
@@ -0,0 +1,149 @@
+/**
+ * @file
+ * Implements system time (SysTick) and deadlines
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SYSTEM_TIME_IMPL_COMMON_H
+#define ZHELE_SYSTEM_TIME_IMPL_COMMON_H
+
+namespace Zhele
+{
+    void SystemTime::Init(uint32_t coreClock)
+    {
+        _millis = 0;
+        SysTick_Config(coreClock / 1000);
+        _running = true;
+        Clock::ClockChange::Subscribe<ClockChanged>();
+    }
+
+    void SystemTime::ClockChanged()
+    {
+        // Current millisecond is restarted with new reload value
+        SysTick->LOAD = Clock::AhbClock::ClockFreq() / 1000 - 1;
+        SysTick->VAL = 0;
+    }
+
+    bool SystemTime::Running()
+    {
+        return _running;
+    }
+
+    uint32_t SystemTime::Millis()
+    {
+        return _millis;
+    }
+
+    uint32_t SystemTime::Micros()
+    {
+        uint32_t millis;
+        uint32_t counter;
+        bool pending;
+
+        do
+        {
+            millis = _millis;
+            counter = SysTick->VAL;
+            pending = (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0;
+            // Counter could be read before reload, read it again after flag
+            if (pending)
+                counter = SysTick->VAL;
+        } while (millis != _millis);
+
+        // SysTick counts down from LOAD, so LOAD - VAL ticks of (LOAD + 1) are passed
+        const uint32_t reload = SysTick->LOAD;
+        return (millis + (pending ? 1 : 0)) * 1000 + (reload - counter) * 1000 / (reload + 1);
+    }
+
+    void SystemTime::Sleep(uint32_t milliseconds)
+    {
+        if (!_running)
+        {
+            const uint32_t cycles = Clock::AhbClock::ClockFreq() / 1000;
+            for (uint32_t i = 0; i < milliseconds; ++i)
+                Private::DelayCycles(cycles);
+            return;
+        }
+
+        Deadline deadline(milliseconds);
+        while (!deadline.Expired())
+        {
+            if (__get_IPSR() == 0)
+                __WFI();
+        }
+    }
+
+    void SystemTime::IrqHandler()
+    {
+        _millis = _millis + 1;
+    }
+
+    template<typename _LpTimer>
+    void SystemTime::SetStopTimeSource()
+    {
+        _stopCounter = _LpTimer::GetCounterValue;
+        _stopFrequency = _LpTimer::GetClockFreq();
+        _stopRemainder = 0;
+    }
+
+    void SystemTime::Suspend()
+    {
+        if (!_running || _stopCounter == nullptr)
+            return;
+
+        _stopStart = _stopCounter();
+        // Current millisecond fraction is counted by stop time source after wake up
+        const uint32_t reload = SysTick->LOAD;
+        _stopRemainder += static_cast<uint64_t>(reload - SysTick->VAL) * _stopFrequency / (reload + 1);
+    }
+
+    void SystemTime::Resume()
+    {
+        if (!_running || _stopCounter == nullptr)
+            return;
+
+        const uint16_t ticks = _stopCounter() - _stopStart;
+        const uint32_t total = _stopRemainder + ticks * 1000u;
+        _millis = _millis + total / _stopFrequency;
+        _stopRemainder = total % _stopFrequency;
+        SysTick->VAL = 0;
+    }
+
+    Deadline::Deadline(uint32_t milliseconds, uint32_t polls)
+        : _last(0)
+        , _remaining(milliseconds * 1000)
+        , _polls(polls)
+        , _timed(SystemTime::Running())
+    {
+        if (_timed)
+            _last = SystemTime::Micros();
+    }
+
+    bool Deadline::Expired()
+    {
+        if (_timed)
+        {
+            uint32_t now = SystemTime::Micros();
+            uint32_t elapsed = now - _last;
+            // SysTick handler can't preempt interrupt with the same or higher priority, so pending tick
+            // is not handled and time goes back on next reload: count it by polls (they are more frequent than ticks)
+            if (static_cast<int32_t>(elapsed) < 0)
+                elapsed += 1000;
+            _last = now;
+
+            _remaining = elapsed < _remaining ? _remaining - elapsed : 0;
+            return _remaining == 0;
+        }
+
+        if (_polls == 0)
+            return true;
+
+        --_polls;
+        return false;
+    }
+}
+
+#endif //! ZHELE_SYSTEM_TIME_IMPL_COMMON_H
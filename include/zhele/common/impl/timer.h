@@ -9,6 +9,8 @@
 #ifndef ZHELE_TIMER_IMPL_COMMON_H
 #define ZHELE_TIMER_IMPL_COMMON_H
 
+#include <algorithm>
+
 namespace Zhele::Timers::Private
 {
 
@@ -60,6 +62,7 @@ namespace Zhele::Timers::Private
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::SetPrescaler(BASETIMER_TEMPLATE_QUALIFIER::Prescaler prescaler)
     {
+        _counterFrequency = 0;
         _Regs()->PSC = prescaler;
     }
 
@@ -69,6 +72,27 @@ namespace Zhele::Timers::Private
         return _Regs()->PSC;
     }
 
+    BASETIMER_TEMPLATE_ARGS
+    uint32_t BASETIMER_TEMPLATE_QUALIFIER::SetCounterFrequency(uint32_t frequency)
+    {
+        uint32_t clockFreq = GetClockFreq();
+        uint32_t divider = frequency == 0 ? 1 : clockFreq / frequency;
+        divider = std::clamp<uint32_t>(divider, 1, 0x10000);
+
+        _Regs()->PSC = divider - 1;
+        _counterFrequency = frequency;
+        Clock::ClockChange::Subscribe<ClockChanged>();
+
+        return clockFreq / divider;
+    }
+
+    BASETIMER_TEMPLATE_ARGS
+    void BASETIMER_TEMPLATE_QUALIFIER::ClockChanged()
+    {
+        if (_counterFrequency != 0)
+            SetCounterFrequency(_counterFrequency);
+    }
+
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::SetPeriod(BASETIMER_TEMPLATE_QUALIFIER::Counter period)
     {
@@ -89,6 +113,24 @@ namespace Zhele::Timers::Private
     }
 
 
+    BASETIMER_TEMPLATE_ARGS
+    void BASETIMER_TEMPLATE_QUALIFIER::EnablePeriodPreload()
+    {
+        _Regs()->CR1 |= TIM_CR1_ARPE;
+    }
+
+    BASETIMER_TEMPLATE_ARGS
+    void BASETIMER_TEMPLATE_QUALIFIER::DisablePeriodPreload()
+    {
+        _Regs()->CR1 &= ~TIM_CR1_ARPE;
+    }
+
+    BASETIMER_TEMPLATE_ARGS
+    volatile void* BASETIMER_TEMPLATE_QUALIFIER::PeriodRegister()
+    {
+        return &_Regs()->ARR;
+    }
+
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::EnableOnePulseMode()
     {
@@ -116,14 +158,14 @@ namespace Zhele::Timers::Private
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::EnableInterrupt(Interrupt interruptMask)
     {
-        _Regs()->DIER |= static_cast<uint16_t>(interruptMask);
+        AtomicSetBits(_Regs()->DIER, static_cast<uint16_t>(interruptMask));
         NVIC_EnableIRQ(_IRQNumber);
     }
 
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::DisableInterrupt(Interrupt interruptMask)
     {
-        _Regs()->DIER &= ~(static_cast<uint16_t>(interruptMask));
+        AtomicClearBits(_Regs()->DIER, static_cast<uint16_t>(interruptMask));
     }
 
     BASETIMER_TEMPLATE_ARGS
@@ -142,19 +184,19 @@ namespace Zhele::Timers::Private
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::SetMasterMode(BASETIMER_TEMPLATE_QUALIFIER::MasterMode mode)
     {
-        _Regs()->CR2 |= static_cast<uint32_t>(mode);
+        _Regs()->CR2 = (_Regs()->CR2 & ~TIM_CR2_MMS_Msk) | static_cast<uint32_t>(mode);
     }
 
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::DmaRequestEnable()
     {
-        _Regs()->DIER |= TIM_DIER_UDE;
+        AtomicSetBits(_Regs()->DIER, TIM_DIER_UDE);
     }
 
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::DmaRequestDisable()
     {
-        _Regs()->DIER &= ~TIM_DIER_UDE;
+        AtomicClearBits(_Regs()->DIER, TIM_DIER_UDE);
     }
 
     #define GPTIMER_TEMPLATE_ARGS template<typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins>
@@ -184,11 +226,55 @@ namespace Zhele::Timers::Private
         _Regs()->SMCR = (_Regs()->SMCR & ~TIM_SMCR_ETPS_Msk) | static_cast<uint16_t>(prescaler);
     }
 
+    GPTIMER_TEMPLATE_ARGS
+    void GPTIMER_TEMPLATE_QUALIFIER::SlaveMode::SetTriggerFilter(ExternalTriggerFilter filter)
+    {
+        _Regs()->SMCR = (_Regs()->SMCR & ~TIM_SMCR_ETF_Msk) | static_cast<uint16_t>(filter);
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    void GPTIMER_TEMPLATE_QUALIFIER::SlaveMode::SetTriggerPolarity(ExternalTriggerPolarity polarity)
+    {
+        _Regs()->SMCR = (_Regs()->SMCR & ~TIM_SMCR_ETP_Msk) | static_cast<uint16_t>(polarity);
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    void GPTIMER_TEMPLATE_QUALIFIER::SlaveMode::SetExternalClockMode2(ExternalClockMode2 mode)
+    {
+        _Regs()->SMCR = (_Regs()->SMCR & ~TIM_SMCR_ECE_Msk) | static_cast<uint16_t>(mode);
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<typename _DmaChannel>
+    void GPTIMER_TEMPLATE_QUALIFIER::StartDmaBurst(BurstRegister firstReg, uint8_t regCount, const typename Base::Counter* buffer, uint16_t updates,
+                                                TransferCallback callback, bool circular)
+    {
+        _Regs()->DCR = ((static_cast<uint32_t>(regCount - 1) << TIM_DCR_DBL_Pos) & TIM_DCR_DBL_Msk)
+                    | ((static_cast<uint32_t>(firstReg) << TIM_DCR_DBA_Pos) & TIM_DCR_DBA_Msk);
+
+        auto mode = _DmaChannel::Mem2Periph | _DmaChannel::MemIncrement | _DmaChannel::PSize16Bits | _DmaChannel::MSize16Bits | _DmaChannel::PriorityHigh;
+        if (circular)
+            mode = mode | _DmaChannel::Circular;
+
+        _DmaChannel::SetTransferCallback(callback);
+        _DmaChannel::Transfer(mode, buffer, &_Regs()->DMAR, regCount * updates);
+        Base::DmaRequestEnable();
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<typename _DmaChannel>
+    void GPTIMER_TEMPLATE_QUALIFIER::StopDmaBurst()
+    {
+        Base::DmaRequestDisable();
+        _DmaChannel::Disable();
+        _Regs()->DCR = 0;
+    }
+
     GPTIMER_TEMPLATE_ARGS
     template<unsigned _ChannelNumber>
     void GPTIMER_TEMPLATE_QUALIFIER::ChannelBase<_ChannelNumber>::EnableInterrupt()
     {
-        _Regs()->DIER |= (TIM_DIER_CC1IE << _ChannelNumber);
+        AtomicSetBits(_Regs()->DIER, TIM_DIER_CC1IE << _ChannelNumber);
         NVIC_EnableIRQ(_IRQNumber);
     }
 
@@ -196,7 +282,7 @@ namespace Zhele::Timers::Private
     template<unsigned _ChannelNumber>
     void GPTIMER_TEMPLATE_QUALIFIER::ChannelBase<_ChannelNumber>::DisableInterrupt()
     {
-        _Regs()->DIER &= ~(TIM_DIER_CC1IE << _ChannelNumber);
+        AtomicClearBits(_Regs()->DIER, TIM_DIER_CC1IE << _ChannelNumber);
     }
 
     GPTIMER_TEMPLATE_ARGS
@@ -213,18 +299,25 @@ namespace Zhele::Timers::Private
         _Regs()->SR = ~(TIM_SR_CC1IF << _ChannelNumber);
     }
 
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void GPTIMER_TEMPLATE_QUALIFIER::ChannelBase<_ChannelNumber>::GenerateEvent()
+    {
+        _Regs()->EGR = (TIM_EGR_CC1G << _ChannelNumber);
+    }
+
     GPTIMER_TEMPLATE_ARGS
     template<unsigned _ChannelNumber>
     void GPTIMER_TEMPLATE_QUALIFIER::ChannelBase<_ChannelNumber>::EnableDmaRequest()
     {
-        _Regs()->DIER |= (TIM_DIER_CC1DE << _ChannelNumber);
+        AtomicSetBits(_Regs()->DIER, TIM_DIER_CC1DE << _ChannelNumber);
     }
 
     GPTIMER_TEMPLATE_ARGS
     template<unsigned _ChannelNumber>
     void GPTIMER_TEMPLATE_QUALIFIER::ChannelBase<_ChannelNumber>::DisableDmaRequest()
     {
-        _Regs()->DIER &= ~(TIM_DIER_CC1DE << _ChannelNumber);
+        AtomicClearBits(_Regs()->DIER, TIM_DIER_CC1DE << _ChannelNumber);
     }
 
     GPTIMER_TEMPLATE_ARGS
@@ -255,6 +348,14 @@ namespace Zhele::Timers::Private
         Channel::ModeBitField::Set(mode);
     }
 
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void GPTIMER_TEMPLATE_QUALIFIER::InputCapture<_ChannelNumber>::SetFilter(typename SlaveMode::ExternalTriggerFilter filter)
+    {
+        const uint32_t value = static_cast<uint16_t>(filter) >> TIM_SMCR_ETF_Pos;
+        Channel::ModeBitField::Set((Channel::ModeBitField::Get() & ~TIM_CCMR1_IC1F_Msk) | (value << TIM_CCMR1_IC1F_Pos));
+    }
+
     GPTIMER_TEMPLATE_ARGS
     template<unsigned _ChannelNumber>
     typename GPTIMER_TEMPLATE_QUALIFIER::Base::Counter GPTIMER_TEMPLATE_QUALIFIER::InputCapture<_ChannelNumber>::GetValue()
@@ -262,6 +363,215 @@ namespace Zhele::Timers::Private
         return (&_Regs()->CCR1)[_ChannelNumber];
     }
 
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    template<typename _DmaChannel>
+    void GPTIMER_TEMPLATE_QUALIFIER::InputCapture<_ChannelNumber>::StartCaptureStream(typename Base::Counter* buffer, uint16_t count, TransferCallback callback, bool circular)
+    {
+        auto mode = _DmaChannel::Periph2Mem | _DmaChannel::MemIncrement | _DmaChannel::PSize16Bits | _DmaChannel::MSize16Bits | _DmaChannel::PriorityHigh;
+        if (circular)
+            mode = mode | _DmaChannel::Circular;
+
+        _DmaChannel::SetTransferCallback(callback);
+        _DmaChannel::Transfer(mode, buffer, &(&_Regs()->CCR1)[_ChannelNumber], count);
+        Channel::EnableDmaRequest();
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    template<typename _DmaChannel>
+    void GPTIMER_TEMPLATE_QUALIFIER::InputCapture<_ChannelNumber>::StopCaptureStream()
+    {
+        Channel::DisableDmaRequest();
+        _DmaChannel::Disable();
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    CaptureStatistics GPTIMER_TEMPLATE_QUALIFIER::InputCapture<_ChannelNumber>::CalculateStatistics(const typename Base::Counter* buffer, uint16_t count, uint32_t timerPeriod)
+    {
+        CaptureStatistics statistics{0, UINT32_MAX, 0, 0, 0};
+        if (count < 2)
+        {
+            statistics.minPeriod = 0;
+            return statistics;
+        }
+
+        auto period = [buffer, timerPeriod](uint16_t i) -> uint32_t {
+            return buffer[i] >= buffer[i - 1]
+                ? buffer[i] - buffer[i - 1]
+                : timerPeriod - buffer[i - 1] + buffer[i];
+        };
+
+        uint64_t sum = 0;
+        for (uint16_t i = 1; i < count; ++i)
+        {
+            uint32_t value = period(i);
+            statistics.minPeriod = std::min(statistics.minPeriod, value);
+            statistics.maxPeriod = std::max(statistics.maxPeriod, value);
+            sum += value;
+        }
+
+        statistics.count = count - 1;
+        statistics.meanPeriod = static_cast<uint32_t>((sum + statistics.count / 2) / statistics.count);
+
+        uint64_t squaresSum = 0;
+        for (uint16_t i = 1; i < count; ++i)
+        {
+            int64_t difference = static_cast<int64_t>(period(i)) - statistics.meanPeriod;
+            squaresSum += static_cast<uint64_t>(difference * difference);
+        }
+        // Period is less than 2^16, so variance is less than 2^32
+        uint32_t variance = static_cast<uint32_t>(squaresSum / statistics.count);
+
+        // Integer square root of variance
+        uint32_t root = 0;
+        for (uint32_t bit = 1u << 30; bit != 0; bit >>= 2)
+        {
+            if (variance >= root + bit)
+            {
+                variance -= root + bit;
+                root = (root >> 1) + bit;
+            }
+            else
+            {
+                root >>= 1;
+            }
+        }
+        statistics.deviation = root;
+
+        return statistics;
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::Enable(Polarity polarity)
+    {
+        const bool activeHigh = polarity == Polarity::ActiveHigh;
+
+        PeriodChannel::SetCaptureMode(PeriodChannel::Direct);
+        PeriodChannel::SetCapturePolarity(activeHigh ? PeriodChannel::RisingEdge : PeriodChannel::FallingEdge);
+        PulseChannel::SetCaptureMode(PulseChannel::Indirect);
+        PulseChannel::SetCapturePolarity(activeHigh ? PulseChannel::FallingEdge : PulseChannel::RisingEdge);
+
+        // Active edge resets counter
+        SlaveMode::SelectTrigger(_ChannelNumber == 0 ? SlaveMode::Trigger::FilteredTimerInput1 : SlaveMode::Trigger::FilteredTimerInput2);
+        SlaveMode::EnableSlaveMode(SlaveMode::Mode::ResetMode);
+
+        // Slave reset does not generate update event, only overflow does
+        _Regs()->CR1 |= TIM_CR1_URS;
+        _Regs()->SR = 0;
+
+        PeriodChannel::Enable();
+        PulseChannel::Enable();
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::Disable()
+    {
+        PeriodChannel::Disable();
+        PulseChannel::Disable();
+        SlaveMode::DisableSlaveMode();
+        _Regs()->CR1 &= ~TIM_CR1_URS;
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    bool GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::IsReady()
+    {
+        return PeriodChannel::IsInterrupt();
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    bool GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::IsOverflow()
+    {
+        return (_Regs()->SR & TIM_SR_UIF) != 0;
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    uint32_t GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::GetPeriod()
+    {
+        // Counter value before reset is captured
+        return static_cast<uint32_t>(PeriodChannel::GetValue()) + 1;
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    uint32_t GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::GetPulse()
+    {
+        return static_cast<uint32_t>(PulseChannel::GetValue()) + 1;
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    uint16_t GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::GetDuty()
+    {
+        const typename Base::Counter pulse = PulseChannel::GetValue();
+        return CalculateDuty(PeriodChannel::GetValue(), pulse);
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    uint16_t GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::CalculateDuty(typename Base::Counter period, typename Base::Counter pulse)
+    {
+        const uint32_t duty = ((static_cast<uint32_t>(pulse) + 1) << 15) / (static_cast<uint32_t>(period) + 1);
+        return static_cast<uint16_t>(std::min<uint32_t>(duty, 1u << 15));
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    template<typename _DmaChannel>
+    void GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::StartStream(typename Base::Counter* buffer, uint16_t count, TransferCallback callback, bool circular)
+    {
+        // CCR1 and CCR2 are read by one burst on every period capture request
+        _Regs()->DCR = ((1u << TIM_DCR_DBL_Pos) & TIM_DCR_DBL_Msk)
+                    | ((static_cast<uint32_t>(BurstRegister::Ccr1) << TIM_DCR_DBA_Pos) & TIM_DCR_DBA_Msk);
+
+        auto mode = _DmaChannel::Periph2Mem | _DmaChannel::MemIncrement | _DmaChannel::PSize16Bits | _DmaChannel::MSize16Bits | _DmaChannel::PriorityHigh;
+        if (circular)
+            mode = mode | _DmaChannel::Circular;
+
+        _DmaChannel::SetTransferCallback(callback);
+        _DmaChannel::Transfer(mode, buffer, &_Regs()->DMAR, 2 * count);
+        PeriodChannel::EnableDmaRequest();
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    template<typename _DmaChannel>
+    void GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::StopStream()
+    {
+        PeriodChannel::DisableDmaRequest();
+        _DmaChannel::Disable();
+        _Regs()->DCR = 0;
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::SelectPins(int pinNumber)
+    {
+        PeriodChannel::SelectPins(pinNumber);
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    template<unsigned PinNumber>
+    void GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::SelectPins()
+    {
+        PeriodChannel::template SelectPins<PinNumber>();
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    template<typename Pin>
+    void GPTIMER_TEMPLATE_QUALIFIER::PwmInput<_ChannelNumber>::SelectPins()
+    {
+        PeriodChannel::template SelectPins<Pin>();
+    }
+
     GPTIMER_TEMPLATE_ARGS
     template<unsigned _ChannelNumber>
     void GPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_ChannelNumber>::SetPulse(typename Base::Counter pulse)
@@ -276,6 +586,27 @@ namespace Zhele::Timers::Private
         return (&_Regs()->CCR1)[_ChannelNumber];
     }
 
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    volatile void* GPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_ChannelNumber>::PulseRegister()
+    {
+        return &(&_Regs()->CCR1)[_ChannelNumber];
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void GPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_ChannelNumber>::EnablePreload()
+    {
+        Channel::ModeBitField::Set(Channel::ModeBitField::Get() | TIM_CCMR1_OC1PE);
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void GPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_ChannelNumber>::DisablePreload()
+    {
+        Channel::ModeBitField::Set(Channel::ModeBitField::Get() & ~TIM_CCMR1_OC1PE);
+    }
+
     GPTIMER_TEMPLATE_ARGS
     template<unsigned _ChannelNumber>
     void GPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_ChannelNumber>::SetOutputPolarity(OutputPolarity polarity)
@@ -336,8 +667,8 @@ namespace Zhele::Timers::Private
         Base::template SelectPins<Pin>();
     }
 
-    #define ADVANCED_TIMER_TEMPLATE_ARGS template<typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins>
-    #define ADVANCED_TIMER_TEMPLATE_QUALIFIER AdvancedTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins>
+    #define ADVANCED_TIMER_TEMPLATE_ARGS template<typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins, template<unsigned> typename _ChNPins, typename _BreakPins>
+    #define ADVANCED_TIMER_TEMPLATE_QUALIFIER AdvancedTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins, _ChNPins, _BreakPins>
 
     ADVANCED_TIMER_TEMPLATE_ARGS
     void ADVANCED_TIMER_TEMPLATE_QUALIFIER::SetRepetitionCounter(uint8_t repetitionCounter)
@@ -350,5 +681,168 @@ namespace Zhele::Timers::Private
     {
         return _Regs()->RCR & 0xff;
     }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::WriteBreakAndDeadTime(uint32_t mask, uint32_t value)
+    {
+        _Regs()->BDTR = (_Regs()->BDTR & ~mask) | value;
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    template<unsigned long _TimerClockFreq, unsigned _Nanoseconds>
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::SetDeadTime()
+    {
+        // Dead-time clock is timer clock divided by 1, 2 or 4 (CKD), the fastest one gives the best resolution
+        constexpr auto ticks = [](unsigned divider) {
+            return (static_cast<uint64_t>(_Nanoseconds) * _TimerClockFreq + 999999999ull * divider) / (1000000000ull * divider);
+        };
+        constexpr unsigned clockDivision = EncodeDeadTime(ticks(1)) >= 0 ? 0 : (EncodeDeadTime(ticks(2)) >= 0 ? 1 : 2);
+        constexpr int deadTime = EncodeDeadTime(ticks(1u << clockDivision));
+        static_assert(deadTime >= 0, "Dead time is too long for timer clock");
+
+        _Regs()->CR1 = (_Regs()->CR1 & ~TIM_CR1_CKD_Msk) | (clockDivision << TIM_CR1_CKD_Pos);
+        WriteBreakAndDeadTime(TIM_BDTR_DTG_Msk, static_cast<uint32_t>(deadTime) << TIM_BDTR_DTG_Pos);
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::EnableBreak(BreakPolarity polarity, bool automaticOutput)
+    {
+        WriteBreakAndDeadTime(TIM_BDTR_BKE | TIM_BDTR_BKP | TIM_BDTR_AOE,
+            TIM_BDTR_BKE | static_cast<uint32_t>(polarity) | (automaticOutput ? TIM_BDTR_AOE : 0));
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::DisableBreak()
+    {
+        WriteBreakAndDeadTime(TIM_BDTR_BKE | TIM_BDTR_AOE, 0);
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    bool ADVANCED_TIMER_TEMPLATE_QUALIFIER::IsBreak()
+    {
+        return (_Regs()->SR & TIM_SR_BIF) != 0;
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ClearBreakFlag()
+    {
+        // SR bits are cleared by writing zero (rc_w0)
+        _Regs()->SR = ~TIM_SR_BIF;
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::SetOffState(bool runMode, bool idleMode)
+    {
+        WriteBreakAndDeadTime(TIM_BDTR_OSSR | TIM_BDTR_OSSI, (runMode ? TIM_BDTR_OSSR : 0) | (idleMode ? TIM_BDTR_OSSI : 0));
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::EnableOutputs()
+    {
+        _Regs()->BDTR |= TIM_BDTR_MOE;
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::DisableOutputs()
+    {
+        _Regs()->BDTR &= ~TIM_BDTR_MOE;
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    bool ADVANCED_TIMER_TEMPLATE_QUALIFIER::IsOutputsEnabled()
+    {
+        return (_Regs()->BDTR & TIM_BDTR_MOE) != 0;
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::Lock(LockLevel level)
+    {
+        WriteBreakAndDeadTime(TIM_BDTR_LOCK_Msk, static_cast<uint32_t>(level));
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::InitCenterAligned(Counter period)
+    {
+        Base::SetCounterMode(Base::CounterMode::CenterAligned1);
+        Base::EnablePeriodPreload();
+        Base::SetPeriod(period);
+        SetRepetitionCounter(1);
+
+        // Channels 1..3: new pulses are applied on update event
+        _Regs()->CCMR1 |= TIM_CCMR1_OC1PE | TIM_CCMR1_OC2PE;
+        _Regs()->CCMR2 |= TIM_CCMR2_OC3PE;
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::SpaceVectorPulses(int16_t alpha, int16_t beta, Counter period, Counter* pulses)
+    {
+        // sqrt(3) / 2 in Q15
+        constexpr int32_t HalfSqrt3 = 28378;
+        const int32_t betaPart = (HalfSqrt3 * beta) >> 15;
+        const int32_t phases[3] = {alpha, -alpha / 2 + betaPart, -alpha / 2 - betaPart};
+
+        // Zero sequence centers phase voltages between minimal and maximal ones
+        const int32_t offset = (std::max({phases[0], phases[1], phases[2]}) + std::min({phases[0], phases[1], phases[2]})) / 2;
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            // Duty is 1/2 + phase voltage (fraction of DC bus)
+            const int32_t duty = std::clamp<int32_t>((phases[i] - offset) + (1 << 14), 0, 1 << 15);
+            pulses[i] = static_cast<Counter>((static_cast<uint32_t>(duty) * period + (1u << 14)) >> 15);
+        }
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::SetSpaceVector(int16_t alpha, int16_t beta)
+    {
+        Counter pulses[3];
+        SpaceVectorPulses(alpha, beta, Base::GetPeriod(), pulses);
+        _Regs()->CCR1 = pulses[0];
+        _Regs()->CCR2 = pulses[1];
+        _Regs()->CCR3 = pulses[2];
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    template<typename _DmaChannel>
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::StartPhaseStream(const Counter* pulses, uint16_t updates, TransferCallback callback, bool circular)
+    {
+        Base::template StartDmaBurst<_DmaChannel>(Base::BurstRegister::Ccr1, 3, pulses, updates, callback, circular);
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    template<typename _DmaChannel>
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::StopPhaseStream()
+    {
+        Base::template StopDmaBurst<_DmaChannel>();
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ComplementaryPwm<_ChannelNumber>::EnableComplementary()
+    {
+        _Regs()->CCER |= (TIM_CCER_CC1NE << (_ChannelNumber * 4));
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ComplementaryPwm<_ChannelNumber>::DisableComplementary()
+    {
+        _Regs()->CCER &= ~(TIM_CCER_CC1NE << (_ChannelNumber * 4));
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ComplementaryPwm<_ChannelNumber>::SetComplementaryPolarity(typename Channel::OutputPolarity polarity)
+    {
+        const uint32_t value = polarity == Channel::ActiveLow ? TIM_CCER_CC1NP : 0;
+        _Regs()->CCER = (_Regs()->CCER & ~(TIM_CCER_CC1NP << (_ChannelNumber * 4))) | (value << (_ChannelNumber * 4));
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ComplementaryPwm<_ChannelNumber>::SetIdleState(bool output, bool complementary)
+    {
+        const uint32_t value = (output ? TIM_CR2_OIS1 : 0) | (complementary ? TIM_CR2_OIS1N : 0);
+        _Regs()->CR2 = (_Regs()->CR2 & ~((TIM_CR2_OIS1 | TIM_CR2_OIS1N) << (_ChannelNumber * 2))) | (value << (_ChannelNumber * 2));
+    }
 }
 #endif //! ZHELE_TIMER_IMPL_COMMON_H
\ No newline at end of file
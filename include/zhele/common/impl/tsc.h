@@ -0,0 +1,142 @@
+/**
+ * @file
+ * Implements touch sensing controller (TSC)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TSC_IMPL_COMMON_H
+#define ZHELE_TSC_IMPL_COMMON_H
+
+namespace Zhele::Private
+{
+    #define TSC_TEMPLATE_ARGS template<typename _Regs, typename _ClockCtrl, IRQn_Type _IRQNumber, typename _Pins, uint8_t _AltFunc>
+    #define TSC_TEMPLATE_QUALIFIER Tsc<_Regs, _ClockCtrl, _IRQNumber, _Pins, _AltFunc>
+
+    TSC_TEMPLATE_ARGS
+    void TSC_TEMPLATE_QUALIFIER::Init(Prescaler prescaler, uint8_t pulseLength, MaxCount maxCount)
+    {
+        _ClockCtrl::Enable();
+
+        uint32_t pulse = static_cast<uint32_t>(pulseLength - 1) & 0x0f;
+
+        // IODEF is cleared: idle IOs are driven low, so capacitors are discharged between acquisitions
+        _Regs()->CR = (pulse << TSC_CR_CTPH_Pos)
+            | (pulse << TSC_CR_CTPL_Pos)
+            | (static_cast<uint32_t>(prescaler) << TSC_CR_PGPSC_Pos)
+            | (static_cast<uint32_t>(maxCount) << TSC_CR_MCV_Pos)
+            | TSC_CR_TSCE;
+        _Regs()->ICR = TSC_ICR_EOAIC | TSC_ICR_MCEIC;
+    }
+
+    TSC_TEMPLATE_ARGS
+    void TSC_TEMPLATE_QUALIFIER::Disable()
+    {
+        _Regs()->CR = 0;
+        _ClockCtrl::Disable();
+    }
+
+    TSC_TEMPLATE_ARGS
+    template<typename... _SamplingPins>
+    void TSC_TEMPLATE_QUALIFIER::SelectSamplingPins()
+    {
+        constexpr uint32_t mask = (0ul | ... | IoMask<_SamplingPins>);
+
+        (SelectPin<_SamplingPins, _SamplingPins::Port::OpenDrain>(), ...);
+
+        // Schmitt trigger hysteresis is disabled for better sensitivity
+        _Regs()->IOHCR &= ~mask;
+        _Regs()->IOSCR |= mask;
+    }
+
+    TSC_TEMPLATE_ARGS
+    template<typename... _ChannelPins>
+    void TSC_TEMPLATE_QUALIFIER::SelectChannelPins()
+    {
+        constexpr uint32_t mask = (0ul | ... | IoMask<_ChannelPins>);
+
+        (SelectPin<_ChannelPins, _ChannelPins::Port::PushPull>(), ...);
+
+        _Regs()->IOHCR &= ~mask;
+    }
+
+    TSC_TEMPLATE_ARGS
+    void TSC_TEMPLATE_QUALIFIER::SetChannels(uint32_t channels)
+    {
+        uint32_t groups = 0;
+        for (unsigned group = 0; group < Groups; ++group)
+        {
+            if (channels & (0x0ful << (group * 4)))
+                groups |= TSC_IOGCSR_G1E << group;
+        }
+
+        _Regs()->IOCCR = channels;
+        _Regs()->IOGCSR = groups;
+    }
+
+    TSC_TEMPLATE_ARGS
+    void TSC_TEMPLATE_QUALIFIER::StartAcquisition()
+    {
+        _Regs()->ICR = TSC_ICR_EOAIC | TSC_ICR_MCEIC;
+        _Regs()->CR |= TSC_CR_START;
+    }
+
+    TSC_TEMPLATE_ARGS
+    bool TSC_TEMPLATE_QUALIFIER::IsAcquisitionComplete()
+    {
+        return _Regs()->ISR & TSC_ISR_EOAF;
+    }
+
+    TSC_TEMPLATE_ARGS
+    bool TSC_TEMPLATE_QUALIFIER::IsGroupComplete(unsigned group)
+    {
+        return _Regs()->IOGCSR & (TSC_IOGCSR_G1S << group);
+    }
+
+    TSC_TEMPLATE_ARGS
+    uint16_t TSC_TEMPLATE_QUALIFIER::GetGroupCount(unsigned group)
+    {
+        return _Regs()->IOGXCR[group] & TSC_IOGXCR_CNT;
+    }
+
+    TSC_TEMPLATE_ARGS
+    void TSC_TEMPLATE_QUALIFIER::EnableInterrupt(Interrupt interrupts)
+    {
+        _Regs()->IER |= static_cast<uint32_t>(interrupts);
+        NVIC_EnableIRQ(_IRQNumber);
+    }
+
+    TSC_TEMPLATE_ARGS
+    void TSC_TEMPLATE_QUALIFIER::DisableInterrupt(Interrupt interrupts)
+    {
+        _Regs()->IER &= ~static_cast<uint32_t>(interrupts);
+    }
+
+    TSC_TEMPLATE_ARGS
+    bool TSC_TEMPLATE_QUALIFIER::IsInterrupt(Interrupt interrupts)
+    {
+        return _Regs()->ISR & static_cast<uint32_t>(interrupts);
+    }
+
+    TSC_TEMPLATE_ARGS
+    void TSC_TEMPLATE_QUALIFIER::ClearInterruptFlag(Interrupt interrupts)
+    {
+        _Regs()->ICR = static_cast<uint32_t>(interrupts);
+    }
+
+    TSC_TEMPLATE_ARGS
+    template<typename _Pin, auto _Driver>
+    void TSC_TEMPLATE_QUALIFIER::SelectPin()
+    {
+        static_assert(_Pins::template IndexOf<_Pin> >= 0, "Pin is not TSC IO");
+
+        _Pin::Port::Enable();
+        _Pin::template SetConfiguration<_Pin::Port::AltFunc>();
+        _Pin::template SetDriverType<_Driver>();
+        _Pin::template AltFuncNumber<_AltFunc>();
+    }
+}
+
+#endif //! ZHELE_TSC_IMPL_COMMON_H
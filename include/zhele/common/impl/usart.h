@@ -69,15 +69,36 @@ namespace Zhele
             Init(baud, mode);
         }
 
+        USART_TEMPLATE_ARGS
+        template<unsigned long baud, unsigned long clockFreq, unsigned maxErrorPpm>
+        void USART_TEMPLATE_QUALIFIER::Init(UsartMode mode)
+        {
+            if constexpr (LowPower)
+            {
+                // Resolution of LPUART divider is 1/256, so only range is checked
+                static_assert(clockFreq >= 3ul * baud && clockFreq <= 4096ul * baud, "Baud rate is out of LPUART range");
+            }
+            else
+            {
+                constexpr int32_t error = BaudError<baud, clockFreq>();
+                static_assert(error <= static_cast<int32_t>(maxErrorPpm) && -error <= static_cast<int32_t>(maxErrorPpm),
+                    "Baud rate error exceeds tolerance");
+            }
+            Init(baud, mode);
+        }
+
         USART_TEMPLATE_ARGS
         void USART_TEMPLATE_QUALIFIER::Init(unsigned baud, UsartMode mode)
         {
             _ClockCtrl::Enable();
+            _Regs()->CR1 = 0;
+            // SetBaud may set OVER8, so CR1 is not overwritten below
             SetBaud(baud);
             _Regs()->STATUS_REG = 0x00;
             _Regs()->CR3 = mode.CR3;
             _Regs()->CR2 = mode.CR2;
-            _Regs()->CR1 = mode.CR1 | USART_CR1_UE;
+            _Regs()->CR1 |= mode.CR1 | USART_CR1_UE;
+            Clock::ClockChange::Subscribe<ClockChanged>();
         }
 
         USART_TEMPLATE_ARGS
@@ -96,12 +117,124 @@ namespace Zhele
             _Regs()->CR1 &= ~modeMask.CR1;
         }
 
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::ModifyConfig(UsartMode clearMask, UsartMode setMask)
+        {
+            ShadowReg cr1(_Regs()->CR1);
+            ShadowReg cr2(_Regs()->CR2);
+            ShadowReg cr3(_Regs()->CR3);
+            cr1.AndOr(~clearMask.CR1, setMask.CR1);
+            cr2.AndOr(~clearMask.CR2, setMask.CR2);
+            cr3.AndOr(~clearMask.CR3, setMask.CR3);
+
+            if (!cr1.Changed() && !cr2.Changed() && !cr3.Changed())
+                return;
+
+            // Shadow keeps UE (if it's not in masks), so USART is enabled again by CR1 commit
+            const bool enabled = (_Regs()->CR1 & USART_CR1_UE) != 0;
+            if (enabled)
+                _Regs()->CR1 &= ~USART_CR1_UE;
+            cr3.Commit();
+            cr2.Commit();
+            cr1.Commit(enabled);
+        }
+
         USART_TEMPLATE_ARGS
         void USART_TEMPLATE_QUALIFIER::SetBaud(unsigned baud)
         {
-            _Regs()->BRR = _ClockCtrl::ClockFreq() / baud;
+            _baud = baud;
+            uint32_t clockFreq = _ClockCtrl::ClockFreq();
+            if constexpr (LowPower)
+            {
+                // LPUART BRR can be written only when LPUART is disabled
+                uint32_t cr1 = _Regs()->CR1;
+                _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+                _Regs()->BRR = CalculateLowPowerBaudRegister(clockFreq, baud);
+                _Regs()->CR1 = cr1;
+                return;
+            }
+
+            bool oversampling8 = PreferOversampling8(clockFreq, baud);
+
+        #if defined (USART_CR1_OVER8)
+            uint32_t cr1 = _Regs()->CR1;
+            if(static_cast<bool>(cr1 & USART_CR1_OVER8) != oversampling8)
+            {
+                // OVER8 can be changed only when USART is disabled
+                _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+                cr1 = oversampling8 ? (cr1 | USART_CR1_OVER8) : (cr1 & ~USART_CR1_OVER8);
+                _Regs()->BRR = CalculateBaudRegister(clockFreq, baud, oversampling8);
+                _Regs()->CR1 = cr1;
+                return;
+            }
+        #endif
+            _Regs()->BRR = CalculateBaudRegister(clockFreq, baud, oversampling8);
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::ClockChanged()
+        {
+            if (_baud != 0)
+                SetBaud(_baud);
         }
 
+        USART_TEMPLATE_ARGS
+        unsigned USART_TEMPLATE_QUALIFIER::GetBaud()
+        {
+            uint32_t brr = _Regs()->BRR;
+            if constexpr (LowPower)
+                return brr == 0 ? 0 : static_cast<unsigned>(static_cast<uint64_t>(_ClockCtrl::ClockFreq()) * 256 / brr);
+        #if defined (USART_CR1_OVER8)
+            if(_Regs()->CR1 & USART_CR1_OVER8)
+            {
+                uint32_t divider = ((brr >> 4) << 3) | (brr & 0x07u);
+                return divider == 0 ? 0 : _ClockCtrl::ClockFreq() / divider;
+            }
+        #endif
+            return brr == 0 ? 0 : _ClockCtrl::ClockFreq() / brr;
+        }
+
+#if defined (USART_CR2_ABREN)
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableAutoBaud(AutoBaudMode mode)
+        {
+            // ABREN and ABRMODE can be written only when USART is disabled
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR2 = (_Regs()->CR2 & ~USART_CR2_ABRMODE_Msk)
+                | (static_cast<uint32_t>(mode) << USART_CR2_ABRMODE_Pos)
+                | USART_CR2_ABREN;
+            _Regs()->CR1 = cr1;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableAutoBaud()
+        {
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR2 &= ~USART_CR2_ABREN;
+            _Regs()->CR1 = cr1;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::RestartAutoBaud()
+        {
+            _Regs()->RQR = USART_RQR_ABRRQ;
+        }
+
+        USART_TEMPLATE_ARGS
+        bool USART_TEMPLATE_QUALIFIER::AutoBaudReady()
+        {
+            return _Regs()->ISR & USART_ISR_ABRF;
+        }
+
+        USART_TEMPLATE_ARGS
+        bool USART_TEMPLATE_QUALIFIER::AutoBaudFailed()
+        {
+            return _Regs()->ISR & USART_ISR_ABRE;
+        }
+#endif
+
         USART_TEMPLATE_ARGS
         bool USART_TEMPLATE_QUALIFIER::ReadReady()
         {
@@ -113,6 +246,7 @@ namespace Zhele
         {
             while(!ReadReady())
                 ;
+            Counters::Add(Statistics::UsartCounters::RxBytes);
             return _Regs()->RECEIVE_DATA_REG;
         }
 
@@ -120,11 +254,107 @@ namespace Zhele
         void USART_TEMPLATE_QUALIFIER::EnableAsyncRead(void* receiveBuffer, size_t bufferSize, TransferCallback callback)
         {
             _DmaRx::ClearTransferComplete();
-            _Regs()->CR3 |= USART_CR3_DMAR;
+            AtomicSetBits(_Regs()->CR3, USART_CR3_DMAR);
             _DmaRx::SetTransferCallback(callback);
+            Counters::Add(Statistics::UsartCounters::RxBytes, bufferSize);
             _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement, receiveBuffer, &_Regs()->RECEIVE_DATA_REG, bufferSize);
         }
 
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableCircularRead(void* receiveBuffer, size_t bufferSize, ReceiveCallback callback)
+        {
+            _circularBuffer = static_cast<uint8_t*>(receiveBuffer);
+            _circularBufferSize = bufferSize;
+            _circularPosition = 0;
+            _receiveCallback = callback;
+
+            _DmaRx::ClearFlags();
+            AtomicSetBits(_Regs()->CR3, USART_CR3_DMAR);
+            _DmaRx::SetTransferCallback(CircularTransferHandler);
+            _DmaRx::SetHalfTransferCallback(CircularTransferHandler);
+            _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular, receiveBuffer, &_Regs()->RECEIVE_DATA_REG, bufferSize);
+
+            ClearInterruptFlag(IdleInt);
+            EnableInterrupt(IdleInt);
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableCircularRead()
+        {
+            DisableInterrupt(IdleInt);
+            _DmaRx::Disable();
+            AtomicClearBits(_Regs()->CR3, USART_CR3_DMAR);
+            _DmaRx::SetTransferCallback(nullptr);
+            _DmaRx::SetHalfTransferCallback(nullptr);
+            _receiveCallback = nullptr;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::CircularReadIrqHandler()
+        {
+            InterruptFlags source = InterruptSource();
+
+        #if defined (USART_CR3_WUFIE)
+            if(source & WakeUpInt)
+                ClearInterruptFlag(WakeUpInt);
+        #endif
+
+        #if defined (USART_CR2_RTOEN)
+            if(source & ReceiveTimeout)
+            {
+                ClearInterruptFlag(ReceiveTimeout);
+                ProcessCircularRead();
+            }
+        #endif
+            if(source & IdleInt)
+            {
+            #if defined (USART_TYPE_1)
+                ClearInterruptFlag(IdleInt);
+            #endif
+            #if defined (USART_TYPE_2)
+                // IDLE is cleared by SR read followed by DR read
+                (void)_Regs()->RECEIVE_DATA_REG;
+            #endif
+                ProcessCircularRead();
+            }
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::ProcessCircularRead()
+        {
+            if(_circularBufferSize == 0)
+                return;
+
+            size_t position = _circularBufferSize - _DmaRx::RemainingTransfers();
+            size_t last = _circularPosition;
+
+            if(position != last)
+                Counters::Add(Statistics::UsartCounters::RxBytes, position > last ? position - last : _circularBufferSize - last + position);
+
+            if(_receiveCallback && position != last)
+            {
+                if(position > last)
+                {
+                    _receiveCallback(_circularBuffer + last, position - last);
+                }
+                else
+                {
+                    _receiveCallback(_circularBuffer + last, _circularBufferSize - last);
+                    if(position > 0)
+                        _receiveCallback(_circularBuffer, position);
+                }
+            }
+
+            _circularPosition = position == _circularBufferSize ? 0 : position;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::CircularTransferHandler(void* data, unsigned size, bool success)
+        {
+            if(success)
+                ProcessCircularRead();
+        }
+
         USART_TEMPLATE_ARGS
         bool USART_TEMPLATE_QUALIFIER::WriteReady()
         {
@@ -165,7 +395,8 @@ namespace Zhele
             while (!WriteReady()) ;
             _DmaTx::ClearTransferComplete();
             _DmaTx::SetTransferCallback(callback);
-            _Regs()->CR3 |= USART_CR3_DMAT;
+            Counters::Add(Statistics::UsartCounters::TxBytes, size);
+            AtomicSetBits(_Regs()->CR3, USART_CR3_DMAT);
         #if defined (USART_TYPE_1)
             _Regs()->ICR = TxCompleteInt;
         #endif
@@ -175,11 +406,52 @@ namespace Zhele
             _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, data, &_Regs()->TRANSMIT_DATA_REG, size);
         }
 
+        USART_TEMPLATE_ARGS
+        bool USART_TEMPLATE_QUALIFIER::WriteAsync(std::initializer_list<std::span<const uint8_t>> segments, TransferCallback callback)
+        {
+            using Queue = DmaTransferQueue<_DmaTx, MaxWriteSegments>;
+
+            if (segments.size() > MaxWriteSegments)
+                return false;
+
+            const std::span<const uint8_t>* last = nullptr;
+            for (const auto& segment : segments)
+            {
+                if (!segment.empty())
+                    last = &segment;
+            }
+            if (last == nullptr)
+                return true;
+
+            while (Queue::Busy()) ;
+            while (!WriteReady()) ;
+            _DmaTx::ClearTransferComplete();
+            AtomicSetBits(_Regs()->CR3, USART_CR3_DMAT);
+        #if defined (USART_TYPE_1)
+            _Regs()->ICR = TxCompleteInt;
+        #endif
+        #if defined (USART_TYPE_2)
+            _Regs()->SR &= ~TxCompleteInt;
+        #endif
+
+            for (const auto& segment : segments)
+            {
+                if (segment.empty())
+                    continue;
+                Counters::Add(Statistics::UsartCounters::TxBytes, segment.size());
+                Queue::Enqueue(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, segment.data(), &_Regs()->TRANSMIT_DATA_REG,
+                    segment.size(), &segment == last ? callback : nullptr);
+            }
+
+            return true;
+        }
+
         USART_TEMPLATE_ARGS
         void USART_TEMPLATE_QUALIFIER::Write(uint8_t data)
         {
             while (!WriteReady()) continue;
 
+            Counters::Add(Statistics::UsartCounters::TxBytes);
             _Regs()->TRANSMIT_DATA_REG = data;  
         }
 
@@ -197,6 +469,148 @@ namespace Zhele
             _Regs()->RTOR = (_Regs()->RTOR & ~USART_RTOR_RTO_Msk)
                 | (bitCount << USART_RTOR_RTO_Pos);
         }
+#endif
+#if defined (USART_CR3_DEM)
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableDriverEnable(uint8_t assertionTime, uint8_t deassertionTime, bool activeLow)
+        {
+            // DEAT, DEDT and DEM can be written only when USART is disabled
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR3 = (_Regs()->CR3 & ~USART_CR3_DEP) | USART_CR3_DEM | (activeLow ? USART_CR3_DEP : 0);
+            _Regs()->CR1 = (cr1 & ~(USART_CR1_DEAT_Msk | USART_CR1_DEDT_Msk))
+                | ((assertionTime << USART_CR1_DEAT_Pos) & USART_CR1_DEAT_Msk)
+                | ((deassertionTime << USART_CR1_DEDT_Pos) & USART_CR1_DEDT_Msk);
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableDriverEnable()
+        {
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR3 &= ~(USART_CR3_DEM | USART_CR3_DEP);
+            _Regs()->CR1 = cr1;
+        }
+#endif
+#if defined (USART_CR1_UESM)
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableWakeUpFromStop(WakeUpSource source, uint8_t address)
+        {
+            // WUS and ADD can be written only when USART is disabled
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            if(source == WakeUpSource::AddressMatch)
+            {
+                _Regs()->CR2 = (_Regs()->CR2 & ~(USART_CR2_ADD_Msk | USART_CR2_ADDM7))
+                    | (static_cast<uint32_t>(address) << USART_CR2_ADD_Pos)
+                    | (address > 0x0f ? USART_CR2_ADDM7 : 0);
+            }
+            _Regs()->CR3 = (_Regs()->CR3 & ~USART_CR3_WUS_Msk) | (static_cast<uint32_t>(source) << USART_CR3_WUS_Pos);
+            _Regs()->CR1 = cr1 | USART_CR1_UESM;
+
+            ClearInterruptFlag(WakeUpInt);
+            EnableInterrupt(WakeUpInt);
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableWakeUpFromStop()
+        {
+            DisableInterrupt(WakeUpInt);
+            AtomicClearBits(_Regs()->CR1, USART_CR1_UESM);
+        }
+#endif
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableMuteMode(MuteWakeup wakeup, uint8_t address)
+        {
+            uint32_t wake = wakeup == MuteWakeup::AddressMark ? USART_CR1_WAKE : 0;
+#if defined (USART_CR1_MME)
+            // WAKE and ADD can be written only when USART is disabled
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR2 = (_Regs()->CR2 & ~(USART_CR2_ADD_Msk | USART_CR2_ADDM7))
+                | (static_cast<uint32_t>(address) << USART_CR2_ADD_Pos)
+                | (address > 0x0f ? USART_CR2_ADDM7 : 0);
+            _Regs()->CR1 = (cr1 & ~USART_CR1_WAKE) | wake | USART_CR1_MME;
+#else
+            _Regs()->CR2 = (_Regs()->CR2 & ~USART_CR2_ADD) | (address & USART_CR2_ADD);
+            _Regs()->CR1 = (_Regs()->CR1 & ~(USART_CR1_WAKE | USART_CR1_RWU)) | wake;
+#endif
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableMuteMode()
+        {
+#if defined (USART_CR1_MME)
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR1 = cr1 & ~(USART_CR1_MME | USART_CR1_WAKE);
+#else
+            AtomicClearBits(_Regs()->CR1, USART_CR1_RWU | USART_CR1_WAKE);
+#endif
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnterMuteMode()
+        {
+#if defined (USART_CR1_MME)
+            _Regs()->RQR = USART_RQR_MMRQ;
+#else
+            AtomicSetBits(_Regs()->CR1, USART_CR1_RWU);
+#endif
+        }
+
+        USART_TEMPLATE_ARGS
+        bool USART_TEMPLATE_QUALIFIER::IsMuted()
+        {
+#if defined (USART_CR1_MME)
+            return _Regs()->ISR & USART_ISR_RWU;
+#else
+            return _Regs()->CR1 & USART_CR1_RWU;
+#endif
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::WriteAddress(uint8_t address)
+        {
+            // Address mark is MSB of word
+#if defined (USART_CR1_M0)
+            uint16_t mark = (_Regs()->CR1 & USART_CR1_M0) ? 0x100 : 0x80;
+#else
+            uint16_t mark = (_Regs()->CR1 & USART_CR1_M) ? 0x100 : 0x80;
+#endif
+
+            while (!WriteReady()) continue;
+
+            Counters::Add(Statistics::UsartCounters::TxBytes);
+            _Regs()->TRANSMIT_DATA_REG = mark | address;
+        }
+
+#if defined (USART_CR1_FIFOEN)
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableFifo(FifoThreshold rxThreshold, FifoThreshold txThreshold)
+        {
+            // FIFOEN and thresholds can be written only when USART is disabled
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR3 = (_Regs()->CR3 & ~(USART_CR3_RXFTCFG_Msk | USART_CR3_TXFTCFG_Msk))
+                | (static_cast<uint32_t>(rxThreshold) << USART_CR3_RXFTCFG_Pos)
+                | (static_cast<uint32_t>(txThreshold) << USART_CR3_TXFTCFG_Pos);
+            _Regs()->CR1 = cr1 | USART_CR1_FIFOEN;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableFifo()
+        {
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR1 = cr1 & ~USART_CR1_FIFOEN;
+        }
+
+        USART_TEMPLATE_ARGS
+        bool USART_TEMPLATE_QUALIFIER::FifoEnabled()
+        {
+            return _Regs()->CR1 & USART_CR1_FIFOEN;
+        }
 #endif
         USART_TEMPLATE_ARGS
         void USART_TEMPLATE_QUALIFIER::EnableInterrupt(InterruptFlags interruptFlags)
@@ -233,9 +647,25 @@ namespace Zhele
             if(interruptFlags & CtsInt)
                 cr3Mask |= USART_CR3_CTSIE;
 
-            _Regs()->CR1 |= cr1Mask;
-            _Regs()->CR2 |= cr2Mask;
-            _Regs()->CR3 |= cr3Mask;
+        #if defined (USART_CR1_FIFOEN)
+            if(interruptFlags & RxFifoFull)
+                cr1Mask |= USART_CR1_RXFFIE;
+            if(interruptFlags & TxFifoEmpty)
+                cr1Mask |= USART_CR1_TXFEIE;
+            if(interruptFlags & RxFifoThreshold)
+                cr3Mask |= USART_CR3_RXFTIE;
+            if(interruptFlags & TxFifoThreshold)
+                cr3Mask |= USART_CR3_TXFTIE;
+        #endif
+
+        #if defined (USART_CR3_WUFIE)
+            if(interruptFlags & WakeUpInt)
+                cr3Mask |= USART_CR3_WUFIE;
+        #endif
+
+            AtomicSetBits(_Regs()->CR1, cr1Mask);
+            AtomicSetBits(_Regs()->CR2, cr2Mask);
+            AtomicSetBits(_Regs()->CR3, cr3Mask);
 
             if(interruptFlags != NoInterrupt)
                 NVIC_EnableIRQ(_IRQNumber);
@@ -275,9 +705,25 @@ namespace Zhele
             if(interruptFlags & CtsInt)
                 cr3Mask |= USART_CR3_CTSIE;
 
-            _Regs()->CR1 &= ~cr1Mask;
-            _Regs()->CR2 &= ~cr2Mask;
-            _Regs()->CR3 &= ~cr3Mask;
+        #if defined (USART_CR1_FIFOEN)
+            if(interruptFlags & RxFifoFull)
+                cr1Mask |= USART_CR1_RXFFIE;
+            if(interruptFlags & TxFifoEmpty)
+                cr1Mask |= USART_CR1_TXFEIE;
+            if(interruptFlags & RxFifoThreshold)
+                cr3Mask |= USART_CR3_RXFTIE;
+            if(interruptFlags & TxFifoThreshold)
+                cr3Mask |= USART_CR3_TXFTIE;
+        #endif
+
+        #if defined (USART_CR3_WUFIE)
+            if(interruptFlags & WakeUpInt)
+                cr3Mask |= USART_CR3_WUFIE;
+        #endif
+
+            AtomicClearBits(_Regs()->CR1, cr1Mask);
+            AtomicClearBits(_Regs()->CR2, cr2Mask);
+            AtomicClearBits(_Regs()->CR3, cr3Mask);
         }
 
         USART_TEMPLATE_ARGS
@@ -289,7 +735,21 @@ namespace Zhele
         USART_TEMPLATE_ARGS
         typename USART_TEMPLATE_QUALIFIER::Error USART_TEMPLATE_QUALIFIER::GetError()
         {
-            return static_cast<Error>(_Regs()->STATUS_REG & ErrorMask);
+            Error error = static_cast<Error>(_Regs()->STATUS_REG & ErrorMask);
+
+            if constexpr (Statistics::Enabled)
+            {
+                if (error & OverrunError)
+                    Counters::Add(Statistics::UsartCounters::Overrun);
+                if (error & FramingError)
+                    Counters::Add(Statistics::UsartCounters::Framing);
+                if (error & NoiseError)
+                    Counters::Add(Statistics::UsartCounters::Noise);
+                if (error & ParityError)
+                    Counters::Add(Statistics::UsartCounters::Parity);
+            }
+
+            return error;
         }
 
         USART_TEMPLATE_ARGS
@@ -313,6 +773,36 @@ namespace Zhele
             _Regs()->SR = 0x00000000;
         #endif
         }
+
+        USART_TEMPLATE_ARGS
+        volatile void* USART_TEMPLATE_QUALIFIER::RxDataRegister()
+        {
+            return &_Regs()->RECEIVE_DATA_REG;
+        }
+
+        USART_TEMPLATE_ARGS
+        volatile void* USART_TEMPLATE_QUALIFIER::TxDataRegister()
+        {
+            return &_Regs()->TRANSMIT_DATA_REG;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableRxDma(bool enable)
+        {
+            if (enable)
+                AtomicSetBits(_Regs()->CR3, USART_CR3_DMAR);
+            else
+                AtomicClearBits(_Regs()->CR3, USART_CR3_DMAR);
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableTxDma(bool enable)
+        {
+            if (enable)
+                AtomicSetBits(_Regs()->CR3, USART_CR3_DMAT);
+            else
+                AtomicClearBits(_Regs()->CR3, USART_CR3_DMAT);
+        }
     }
 }
 #endif
@@ -365,6 +365,9 @@ namespace Zhele
             template<uint8_t, DataT>
             static void AltFuncNumber() {}
 
+            template<Configuration, Speed, PullMode, uint8_t, DriverType, DataT>
+            static void Configure() {}
+
             static void Enable() {}
             static void Disable() {}
 
@@ -618,6 +621,27 @@ namespace Zhele
                 template<uint8_t number, DataType mask = std::numeric_limits<DataType>::max()>
                 static void AltFuncNumber();
 
+                /**
+                 * @brief Configure pins (all attributes at once)
+                 * 
+                 * @details
+                 * Register images are computed at compile time, every register is written once.
+                 * Mode register is written last, so pin is switched to new mode with already configured attributes.
+                 * 
+                 * @tparam configuration Configuration
+                 * @tparam speed Speed (for outputs)
+                 * @tparam pull Pull mode
+                 * @tparam altFunc Alternate function number (for AltFunc configuration)
+                 * @tparam driver Driver type (for outputs)
+                 * @tparam mask Pin mask
+                 * 
+                 * @par Returns
+                 *  Nothing
+                */
+                template<Configuration configuration, Speed speed, PullMode pull, uint8_t altFunc = 0,
+                    DriverType driver = PushPull, DataType mask = std::numeric_limits<DataType>::max()>
+                static void Configure();
+
                 /**
                  * @brief Enable clock for port
                  * 
@@ -633,6 +657,20 @@ namespace Zhele
                  *  Nothing
                 */
                 static void Disable();
+
+                /**
+                 * @brief Returns BSRR register address (for DMA)
+                 * 
+                 * @returns BSRR address
+                */
+                static volatile uint32_t* BitSetResetRegister();
+
+                /**
+                 * @brief Returns IDR register address (for DMA)
+                 * 
+                 * @returns IDR address
+                */
+                static volatile uint32_t* InputDataRegister();
                 
                 enum { Id = ID };
 
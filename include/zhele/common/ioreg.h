@@ -9,6 +9,7 @@
 #ifndef ZHELE_IOREG_COMMON_H
 #define ZHELE_IOREG_COMMON_H
 
+#include <bit>
 #include <cstdint>
 
 namespace Zhele
@@ -57,6 +58,80 @@ namespace Zhele
         static bool IsBitClear(){return !( *reinterpret_cast<_DataType*>(_Address) & (1 << Bit));}
     };
 
+    /**
+     * @brief Register shadow (configuration transaction)
+     * 
+     * @details
+     * Register is read once at construction, changes are collected in RAM copy
+     * (with the same methods as @ref RegisterWrapper) and Commit writes register once
+     * (only if value is changed). So sequence of read-modify-write operations with the same register
+     * is replaced by one read and one write. Register should not be changed by hardware
+     * or interrupts between construction and Commit.
+     * 
+     * @par Example
+     * @code
+     *  ShadowReg cr1(SPI1->CR1);
+     *  cr1.AndOr(~(SPI_CR1_CPOL | SPI_CR1_CPHA), SPI_CR1_CPOL);
+     *  cr1.Or(SPI_CR1_LSBFIRST);
+     *  cr1.Commit();
+     * @endcode
+     * 
+     * @tparam _DataType Register data type
+     */
+    template<typename _DataType>
+    class ShadowReg
+    {
+    public:
+        using DataT = _DataType;
+
+        /**
+         * @brief Reads register
+         * 
+         * @param [in] reg Register
+         */
+        explicit ShadowReg(volatile DataT& reg) : _reg(reg), _value(reg), _original(_value) {}
+
+        DataT Get() const {return _value;}
+        void Set(DataT value){_value = value;}
+        void Or(DataT value){_value |= value;}
+        void And(DataT value){_value &= value;}
+        void Xor(DataT value){_value ^= value;}
+        void AndOr(DataT andMask, DataT orMask){_value = (_value & andMask) | orMask;}
+        template<unsigned Bit>
+        bool IsBitSet() const {return _value & (1 << Bit);}
+        template<unsigned Bit>
+        bool IsBitClear() const {return !(_value & (1 << Bit));}
+
+        /**
+         * @brief Returns true if value differs from register value
+         * 
+         * @retval true Value is changed
+         * @retval false Value is not changed
+         */
+        bool Changed() const {return _value != _original;}
+
+        /**
+         * @brief Writes value to register (if it's changed)
+         * 
+         * @param [in] force Write unchanged value too (register was changed after read, for example peripheral was disabled)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        void Commit(bool force = false)
+        {
+            if (!force && !Changed())
+                return;
+            _reg = _value;
+            _original = _value;
+        }
+
+    private:
+        volatile DataT& _reg;
+        DataT _value;
+        DataT _original;
+    };
+
     /**
      * @brief Wrap around some type
      */
@@ -202,6 +277,185 @@ namespace Zhele
         static void Clear(){ Value() &= ~(1 << _BitfieldOffset); }
     };
 
+    /**
+     * @brief Returns bus address of object (for DMA address registers and address arithmetic)
+     * 
+     * @details
+     * It's pointer value on MCU. In host build (ZHELE_HOST) pointer is 64-bit, so it's truncated.
+     * 
+     * @param [in] pointer Object pointer
+     * 
+     * @returns Address
+     */
+    inline uint32_t AddressOf(const volatile void* pointer)
+    {
+        return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pointer));
+    }
+
+#if defined (__CORTEX_M) && (__CORTEX_M >= 3) && defined (SRAM_BB_BASE) && defined (PERIPH_BB_BASE) && !defined (ZHELE_HOST)
+    /// Bit-band is available (Cortex-M3/M4)
+    constexpr bool HasBitBand = true;
+#else
+    constexpr bool HasBitBand = false;
+#endif
+
+    /**
+     * @brief Returns true if address is in bit-band region (first megabyte of SRAM or peripherals)
+     * 
+     * @param [in] address Address
+     * 
+     * @retval true Address has bit-band alias
+     * @retval false Address has no bit-band alias (or bit-band is not available)
+     */
+    constexpr bool IsBitBandAddress(uint32_t address)
+    {
+    #if defined (__CORTEX_M) && (__CORTEX_M >= 3) && defined (SRAM_BB_BASE) && defined (PERIPH_BB_BASE) && !defined (ZHELE_HOST)
+        return (address >= SRAM_BASE && address - SRAM_BASE < 0x100000) || (address >= PERIPH_BASE && address - PERIPH_BASE < 0x100000);
+    #else
+        return false;
+    #endif
+    }
+
+    /**
+     * @brief Returns bit-band alias of bit
+     * 
+     * @param [in] address Word address (in bit-band region)
+     * @param [in] bit Bit number
+     * 
+     * @returns Alias address
+     */
+    constexpr uint32_t BitBandAlias(uint32_t address, unsigned bit)
+    {
+    #if defined (__CORTEX_M) && (__CORTEX_M >= 3) && defined (SRAM_BB_BASE) && defined (PERIPH_BB_BASE) && !defined (ZHELE_HOST)
+        return address >= PERIPH_BASE
+            ? PERIPH_BB_BASE + ((address - PERIPH_BASE) << 5) + (bit << 2)
+            : SRAM_BB_BASE + ((address - SRAM_BASE) << 5) + (bit << 2);
+    #else
+        return 0;
+    #endif
+    }
+
+    /**
+     * @brief Implements atomic access to bit of register or RAM word
+     * 
+     * @details
+     * On Cortex-M3/M4 bit is written by one store to bit-band alias (alias address is calculated in compile-time),
+     * so it's safe to change bits of the same register from thread mode and interrupts without masking.
+     * On Cortex-M0/M0+ bit is changed by read-modify-write with masked interrupts.
+     * Bit-band write is read-modify-write of word by bus, so don't use it for registers
+     * with write-to-clear flags (status registers).
+     * 
+     * @par Example
+     * @code
+     *  using TxDmaEnable = BitBand<SPI1_BASE + offsetof(SPI_TypeDef, CR2), SPI_CR2_TXDMAEN_Pos>;
+     *  TxDmaEnable::Set();
+     * @endcode
+     * 
+     * @tparam _Address Word address
+     * @tparam _Bit Bit number
+     */
+    template<uint32_t _Address, unsigned _Bit>
+    class BitBand
+    {
+        static_assert(_Bit < 32, "Bit number should be less than 32");
+        static_assert(!HasBitBand || IsBitBandAddress(_Address), "Address is out of bit-band region");
+
+        static volatile uint32_t& Word(){return *reinterpret_cast<volatile uint32_t*>(_Address);}
+        static volatile uint32_t& Alias(){return *reinterpret_cast<volatile uint32_t*>(BitBandAlias(_Address, _Bit));}
+    public:
+        static void Set(){Write(true);}
+        static void Clear(){Write(false);}
+        static bool IsSet()
+        {
+            if constexpr (HasBitBand)
+                return Alias() != 0;
+            else
+                return (Word() & (1u << _Bit)) != 0;
+        }
+
+        static void Write(bool value)
+        {
+            if constexpr (HasBitBand)
+            {
+                Alias() = value ? 1 : 0;
+            }
+            else
+            {
+                uint32_t primask = __get_PRIMASK();
+                __disable_irq();
+                Word() = value ? (Word() | (1u << _Bit)) : (Word() & ~(1u << _Bit));
+                __set_PRIMASK(primask);
+            }
+        }
+    };
+
+    /**
+     * @brief Atomically sets bits of register or RAM word
+     * 
+     * @details
+     * Bits are set by bit-band stores (one per bit) on Cortex-M3/M4 if register is in bit-band region,
+     * otherwise by read-modify-write with masked interrupts. See @ref BitBand.
+     * 
+     * @param [in, out] reg Register
+     * @param [in] mask Bits to set
+     * 
+     * @par Returns
+     *  Nothing
+     */
+    template<typename _DataType>
+    void AtomicSetBits(volatile _DataType& reg, uint32_t mask)
+    {
+        if (mask == 0)
+            return;
+
+        const uint32_t address = AddressOf(&reg);
+        if (IsBitBandAddress(address))
+        {
+            volatile uint32_t* alias = reinterpret_cast<volatile uint32_t*>(BitBandAlias(address, 0));
+            for (; mask != 0; mask &= mask - 1)
+                alias[std::countr_zero(mask)] = 1;
+            return;
+        }
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        reg = static_cast<_DataType>(reg | mask);
+        __set_PRIMASK(primask);
+    }
+
+    /**
+     * @brief Atomically clears bits of register or RAM word
+     * 
+     * @details
+     * See @ref AtomicSetBits.
+     * 
+     * @param [in, out] reg Register
+     * @param [in] mask Bits to clear
+     * 
+     * @par Returns
+     *  Nothing
+     */
+    template<typename _DataType>
+    void AtomicClearBits(volatile _DataType& reg, uint32_t mask)
+    {
+        if (mask == 0)
+            return;
+
+        const uint32_t address = AddressOf(&reg);
+        if (IsBitBandAddress(address))
+        {
+            volatile uint32_t* alias = reinterpret_cast<volatile uint32_t*>(BitBandAlias(address, 0));
+            for (; mask != 0; mask &= mask - 1)
+                alias[std::countr_zero(mask)] = 0;
+            return;
+        }
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        reg = static_cast<_DataType>(reg & ~mask);
+        __set_PRIMASK(primask);
+    }
+
     /**
      * @brief Calculate bitfield length (if bitfield is continuous) in compile-time
      * 
@@ -0,0 +1,464 @@
+/**
+ * @file
+ * Implements low-power timer (LPTIM)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LPTIMER_COMMON_H
+#define ZHELE_LPTIMER_COMMON_H
+
+#include "macro_utils/enum.h"
+#include "template_utils/pair.h"
+#include "template_utils/static_array.h"
+#include "ioreg.h"
+
+#include <zhele/clock.h>
+#include <zhele/iopins.h>
+#include <zhele/pinlist.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Timers
+{
+    namespace Private
+    {
+        /**
+         * @brief Implements low-power timer
+         *
+         * @details
+         * LPTIM counts in Stop mode if its kernel clock is LSE or LSI (see @ref Clock::LpTimerKernelClock),
+         * or if it counts external pulses asynchronously. Compare match and autoreload match interrupts
+         * wake MCU up from Stop mode.
+         *
+         * Interface is compatible with GP timer subset used by @ref TimerWheel (OutputCompare<0> is compare channel),
+         * so wheel can schedule wake ups from Stop mode, and timer can measure Stop time for @ref SystemTime.
+         *
+         * LPTIM registers have write restrictions: configuration and interrupt enable registers are written
+         * only when timer is disabled (methods disable timer and restart it, counter is reset then),
+         * compare and autoreload registers are written only when timer is enabled and are synchronized
+         * with kernel clock (next write waits for previous one completion).
+         *
+         * @par Example
+         * @code
+         *  Clock::LpTim1Clock::SelectClockSource(Clock::LpTimerClockSource::Lse);
+         *  using Wheel = Timers::TimerWheel<Timers::LpTimer1, 0, 256>;
+         *  Wheel::Init(Timers::LpTimer1::Div32); // 1024 Hz ticks
+         *  SystemTime::SetStopTimeSource<Timers::LpTimer1>();
+         *  extern "C" void LPTIM1_IRQHandler() { Wheel::IrqHandler(); }
+         * @endcode
+         *
+         * @tparam _Regs Registers
+         * @tparam _ClockCtrl Clock (with kernel clock selection)
+         * @tparam _IRQNumber IRQ number
+         * @tparam _In1Pins IN1 pins (with alternate function numbers)
+         * @tparam _In2Pins IN2 pins (with alternate function numbers)
+         * @tparam _OutPins OUT pins (with alternate function numbers)
+         */
+        template<typename _Regs, typename _ClockCtrl, IRQn_Type _IRQNumber, typename _In1Pins, typename _In2Pins, typename _OutPins>
+        class LpTimer
+        {
+        public:
+            using Counter = uint16_t;
+            static constexpr IRQn_Type IRQNumber = _IRQNumber;
+
+            /**
+             * @brief Clock prescaler
+             */
+            enum Prescaler : uint8_t
+            {
+                Div1 = 0,
+                Div2 = 1,
+                Div4 = 2,
+                Div8 = 3,
+                Div16 = 4,
+                Div32 = 5,
+                Div64 = 6,
+                Div128 = 7,
+            };
+
+            /**
+             * @brief Interrupts
+             */
+            enum class Interrupt : uint32_t
+            {
+                CompareMatch = LPTIM_IER_CMPMIE, ///< Counter matches compare register
+                AutoReloadMatch = LPTIM_IER_ARRMIE, ///< Counter matches autoreload register
+                ExternalTrigger = LPTIM_IER_EXTTRIGIE, ///< External trigger edge
+                CompareOk = LPTIM_IER_CMPOKIE, ///< Compare register write is completed
+                AutoReloadOk = LPTIM_IER_ARROKIE, ///< Autoreload register write is completed
+                Up = LPTIM_IER_UPIE, ///< Direction changed to up (encoder mode)
+                Down = LPTIM_IER_DOWNIE, ///< Direction changed to down (encoder mode)
+            };
+            DECLARE_ENUM_OPERATIONS_IN_CLASS(Interrupt)
+
+            /**
+             * @brief Active edge of external input
+             */
+            enum class Edge : uint8_t
+            {
+                Rising = 0b00, ///< Rising edge
+                Falling = 0b01, ///< Falling edge
+                Both = 0b10, ///< Both edges
+            };
+
+            /**
+             * @brief Compare channel (compatible with GP timer output compare)
+             *
+             * @tparam _Channel Channel number (LPTIM has one channel)
+             */
+            template<unsigned _Channel>
+            class OutputCompare
+            {
+                static_assert(_Channel == 0, "LPTIM has one compare channel");
+            public:
+                /**
+                 * @brief Output modes
+                 */
+                enum OutputMode
+                {
+                    Timing, ///< Compare only (output is PWM if OUT pin is selected)
+                    Pwm, ///< OUT is active from compare match to autoreload match
+                    SetOnce, ///< OUT is set on first compare match
+                };
+
+                /**
+                 * @brief Output polarity
+                 */
+                enum OutputPolarity
+                {
+                    ActiveHigh,
+                    ActiveLow,
+                };
+
+                /**
+                 * @brief Sets compare value
+                 *
+                 * @details
+                 * Value should be less than autoreload value.
+                 *
+                 * @param [in] pulse Compare value
+                 *
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetPulse(Counter pulse);
+
+                /**
+                 * @brief Returns compare value
+                 *
+                 * @returns Compare value
+                 */
+                static Counter GetPulse();
+
+                /**
+                 * @brief Sets output mode
+                 *
+                 * @param [in] mode Output mode
+                 *
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetOutputMode(OutputMode mode);
+
+                /**
+                 * @brief Sets output polarity
+                 *
+                 * @param [in] polarity Polarity
+                 *
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetOutputPolarity(OutputPolarity polarity);
+
+                /**
+                 * @brief Enables compare match interrupt
+                 *
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void EnableInterrupt();
+
+                /**
+                 * @brief Disables compare match interrupt
+                 *
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void DisableInterrupt();
+
+                /**
+                 * @brief Checks compare match (or software event)
+                 *
+                 * @retval true Compare matched
+                 * @retval false No compare match
+                 */
+                static bool IsInterrupt();
+
+                /**
+                 * @brief Clears compare match flag
+                 *
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void ClearInterruptFlag();
+
+                /**
+                 * @brief Generates compare match event by software
+                 *
+                 * @details
+                 * LPTIM can't set flag by software, so IRQ is pended and IsInterrupt returns true until flag clear.
+                 *
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void GenerateEvent();
+
+            private:
+                static inline volatile bool _softwareEvent = false;
+            };
+
+            /**
+             * @brief Enables timer clock
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Enable();
+
+            /**
+             * @brief Disables timer and its clock
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Disable();
+
+            /**
+             * @brief Returns counter frequency
+             *
+             * @returns Kernel clock frequency divided by prescaler
+             */
+            static unsigned GetClockFreq();
+
+            /**
+             * @brief Sets prescaler
+             *
+             * @param [in] prescaler Prescaler
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void SetPrescaler(Prescaler prescaler);
+
+            /**
+             * @brief Sets autoreload value (counter counts from 0 to period)
+             *
+             * @param [in] period Autoreload value
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void SetPeriod(Counter period);
+
+            /**
+             * @brief Returns autoreload value
+             *
+             * @returns Autoreload value
+             */
+            static Counter GetPeriod();
+
+            /**
+             * @brief Returns counter value
+             *
+             * @details
+             * Counter is clocked asynchronously, so it's read until two reads are equal.
+             *
+             * @returns Counter value
+             */
+            static Counter GetCounterValue();
+
+            /**
+             * @brief Resets counter
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void ResetCounterValue();
+
+            /**
+             * @brief Starts timer in continuous mode
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Start();
+
+            /**
+             * @brief Starts timer in single mode (it stops on autoreload match)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void StartOnce();
+
+            /**
+             * @brief Stops (disables) timer
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Stop();
+
+            /**
+             * @brief Enables interrupts
+             *
+             * @details
+             * Timer is restarted if interrupts mask changes.
+             *
+             * @param [in] interrupts Interrupts
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableInterrupt(Interrupt interrupts);
+
+            /**
+             * @brief Disables interrupts
+             *
+             * @details
+             * Timer is restarted if interrupts mask changes.
+             *
+             * @param [in] interrupts Interrupts
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableInterrupt(Interrupt interrupts);
+
+            /**
+             * @brief Checks interrupt flags
+             *
+             * @param [in] interrupts Interrupts
+             *
+             * @retval true Any of flags is set
+             * @retval false Flags are not set
+             */
+            static bool IsInterrupt(Interrupt interrupts);
+
+            /**
+             * @brief Clears interrupt flags
+             *
+             * @param [in] interrupts Interrupts
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void ClearInterruptFlag(Interrupt interrupts);
+
+            /**
+             * @brief Enables encoder mode (IN1 and IN2 are quadrature inputs)
+             *
+             * @details
+             * Encoder mode requires internal kernel clock. Counter counts up and down between 0 and period.
+             *
+             * @param [in] edge Counted edges (Both counts every edge of both inputs)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableEncoderMode(Edge edge = Edge::Both);
+
+            /**
+             * @brief Disables encoder mode
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableEncoderMode();
+
+            /**
+             * @brief Counts external pulses on IN1
+             *
+             * @details
+             * In synchronous mode pulses are sampled by kernel clock (glitch filter is available).
+             * In asynchronous mode IN1 clocks counter directly, so pulses are counted without kernel clock
+             * (in Stop mode with stopped oscillators), prescaler must be Div1 then.
+             *
+             * @param [in] edge Counted edge
+             * @param [in] asynchronous IN1 is counter clock
+             * @param [in] filter Glitch filter (0 - none, 1...3 - 2, 4 or 8 kernel clocks), synchronous mode only
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableExternalCounting(Edge edge, bool asynchronous = false, uint8_t filter = 0);
+
+            /**
+             * @brief Counts kernel clock pulses (default)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableExternalCounting();
+
+            /**
+             * @brief Selects IN1 and IN2 pins
+             *
+             * @tparam In1Pin IN1 pin
+             * @tparam In2Pin IN2 pin (encoder mode)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<typename In1Pin, typename In2Pin = IO::NullPin>
+            static void SelectInputPins();
+
+            /**
+             * @brief Selects OUT pin
+             *
+             * @tparam OutPin OUT pin
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<typename OutPin>
+            static void SelectOutputPin();
+
+        private:
+            /**
+             * @brief Writes configuration or interrupt enable register (they are writable when timer is disabled)
+             *
+             * @param [in] reg Register
+             * @param [in] clearMask Bits to clear
+             * @param [in] setMask Bits to set
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void ModifyDisabled(volatile uint32_t& reg, uint32_t clearMask, uint32_t setMask);
+
+            /**
+             * @brief Waits for compare and autoreload registers synchronization
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void WaitWrites();
+
+            template<typename Pin, typename Pins>
+            static void SelectPin();
+
+            static inline bool _continuous = false; ///< Timer runs in continuous mode
+            static inline bool _compareWritten = false; ///< Compare register write is not synchronized yet
+            static inline bool _periodWritten = false; ///< Autoreload register write is not synchronized yet
+        };
+    }
+}
+
+#include "impl/lptimer.h"
+
+#endif //! ZHELE_LPTIMER_COMMON_H
@@ -12,6 +12,9 @@
 #ifndef ZHELE_ONE_WIRE_COMMON_H
 #define ZHELE_ONE_WIRE_COMMON_H
 
+#include "template_utils/data_transfer.h"
+#include "../soft_crc.h"
+
 #include <cstdint>
 
 namespace Zhele
@@ -19,7 +22,15 @@ namespace Zhele
     /**
      * @brief Class for one-wired communicate
      * 
-     * @tparam Pin GPIO Pin
+     * @details
+     * Line is driven by half-duplex USART: reset pulse is one frame at 9600 baud,
+     * time slot is one frame at 115200 baud (0xff for write 1 / read slot, 0x00 for write 0).
+     * Slot frames are moved by DMA in both directions, so interrupts stay enabled and
+     * timing doesn't depend on CPU load. Bytes are sent and received by one DMA transfer
+     * up to MaxTransferSize bytes (whole scratchpad or MATCH ROM command).
+     * 
+     * @tparam _Usart USART (with DMA channels)
+     * @tparam _Pin GPIO Pin
      */
     template<typename _Usart, typename _Pin>
     class OneWire
@@ -32,6 +43,9 @@ namespace Zhele
             Skip = 0xcc,
             Search = 0xf0,
         };
+
+        /// Max bytes count of one DMA transfer
+        static const uint8_t MaxTransferSize = 9;
         
         /**
          * @brief Initialize one-wire communicate line
@@ -85,6 +99,40 @@ namespace Zhele
         static void ReadBytes(void* data, uint8_t size);
        
 
+        /**
+         * @brief Reads bytes from line async (by DMA, CPU is not used)
+         * 
+         * @param [out] data Output buffer (should be valid until callback)
+         * @param [in] size Size to read (not more than MaxTransferSize)
+         * @param [in] callback Read complete callback (it's called from DMA interrupt)
+         * 
+         * @retval true Read was started
+         * @retval false Too big size
+         */
+        static bool ReadBytesAsync(void* data, uint8_t size, TransferCallback callback);
+       
+
+        /**
+         * @brief Check that async read is in progress
+         * 
+         * @retval true Read is in progress
+         * @retval false There is no async read
+         */
+        static bool ReadBusy();
+       
+
+        /**
+         * @brief Writes bytes to line
+         * 
+         * @param [in] data Data
+         * @param [in] size Data size
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void WriteBytes(const void* data, uint8_t size);
+       
+
         /**
          * @brief Select (match) device by ROM.
          * 
@@ -128,16 +176,69 @@ namespace Zhele
         /**
          * @brief Start new search.
          * 
+         * @details
+         * Search state is reset, so first device (with the lowest ROM) is found.
+         * Use SearchNext to find other devices.
+         * 
          * @param [out] rom Address of found device.
          * 
-         * @todo Implement this method
+         * @retval true Device was found (ROM has valid CRC)
+         * @retval false No devices on line or search error
+         */
+        static bool SearchFirst(uint8_t* rom);
+       
+
+        /**
+         * @brief Continue search.
          * 
-         * @returns
+         * @details
+         * Performs one pass of ROM search algorithm (Maxim AN187).
+         * 
+         * @par Example
+         * @code
+         *  uint8_t rom[8];
+         *  for(bool found = OneWireLine::SearchFirst(rom); found; found = OneWireLine::SearchNext(rom))
+         *  {
+         *      // rom contains address of next device
+         *  }
+         * @endcode
+         * 
+         * @param [out] rom Address of found device.
+         * 
+         * @retval true Device was found (ROM has valid CRC)
+         * @retval false All devices were found, no devices on line or search error
+         */
+        static bool SearchNext(uint8_t* rom);
+       
+
+        /**
+         * @brief Reads one time slot
+         * 
+         * @returns Bit value
+         */
+        static bool ReadBit();
+       
+
+        /**
+         * @brief Writes one time slot
+         * 
+         * @param [in] bit Bit value
+         * 
+         * @par Returns
          *	Nothing
          */
-        static void SearchFirst(uint8_t* rom)
-        {
-        }
+        static void WriteBit(bool bit);
+       
+
+        /**
+         * @brief Calculates CRC8 (Dallas/Maxim, polynomial x^8 + x^5 + x^4 + 1)
+         * 
+         * @param [in] data Data
+         * @param [in] size Data size
+         * 
+         * @returns CRC8
+         */
+        static uint8_t Crc8(const void* data, uint8_t size);
 
     private:
         /**
@@ -161,9 +262,64 @@ namespace Zhele
          */
         static void ConvertToBits(uint8_t byte, uint8_t* bits);
        
+        /**
+         * @brief Transfers one time slot (one USART frame at 115200 baud)
+         * 
+         * @param [in] value Frame to send
+         * 
+         * @returns Received frame
+         */
+        static uint8_t TransferSlot(uint8_t value);
+       
+
+        /**
+         * @brief Transfers slot frames (in place) and waits for completion
+         * 
+         * @param [in] size Frames count
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Transfer(unsigned size);
+       
+
+        /**
+         * @brief Starts slot frames transfer (in place)
+         * 
+         * @details
+         * Received frame overwrites transmitted one. It's safe, because TX DMA
+         * always reads frame before it's received back.
+         * 
+         * @param [in] size Frames count
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void StartTransfer(unsigned size);
+       
+
+        /**
+         * @brief Receive complete handler
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void TransferComplete(void* data, unsigned size, bool success);
+       
     private:
-        // Dummy buffer for read operation
-        static constexpr uint8_t _readDummyBuffer[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+        // Slot frames buffer
+        static inline uint8_t _slots[MaxTransferSize * 8] = {};
+        static inline volatile bool _complete = true; ///< Transfer complete flag
+
+        // Async read state
+        static inline uint8_t* _readData = nullptr; ///< Async read output buffer
+        static inline uint8_t _readSize = 0; ///< Async read size
+        static inline TransferCallback _readCallback = nullptr; ///< Async read callback
+
+        // Search state
+        static inline uint8_t _searchRom[8] = {}; ///< Last found ROM
+        static inline uint8_t _lastDiscrepancy = 0; ///< Bit position of last zero-direction discrepancy (1...64, 0 if there is no one)
+        static inline bool _lastDevice = false; ///< Last device was found
     };
 }
 
@@ -14,10 +14,21 @@
 
 #include <zhele/ioports.h>
 
+#include <array>
 #include <type_traits>
 #include <numeric>
+#include <utility>
 using namespace Zhele::TemplateUtils;
 
+#if !defined (ZHELE_GPIO_STORE_CYCLES)
+    // CPU cycles per GPIO register store (IOPORT on stm32g0 is single-cycle)
+    #if defined (STM32G0)
+        #define ZHELE_GPIO_STORE_CYCLES 1
+    #else
+        #define ZHELE_GPIO_STORE_CYCLES 2
+    #endif
+#endif
+
 namespace Zhele::IO
 {
     /**
@@ -60,6 +71,42 @@ namespace Zhele::IO
         template<DataType value>
         static void Write();
 
+        /**
+         * @brief Send value to all ports with minimal skew
+         * 
+         * @details
+         * BSRR words for all ports are computed first, then they are stored
+         * back-to-back with interrupts disabled (see @ref SynchronizedWriteSkew).
+         * 
+         * @param [in] value Value to write
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void WriteSynchronized(DataType value);
+
+        /**
+         * @brief Template @ref WriteSynchronized method
+         * 
+         * @tparam value Value to write
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        template<DataType value>
+        static void WriteSynchronized();
+
+        /// Worst-case skew between the first and the last port store of WriteSynchronized (CPU cycles)
+        static const unsigned SynchronizedWriteSkew = (_ports.size() - 1) * ZHELE_GPIO_STORE_CYCLES;
+
+        /**
+         * @brief Worst-case skew of WriteSynchronized in nanoseconds
+         * 
+         * @tparam _CpuFreq CPU frequence
+         */
+        template<unsigned long _CpuFreq>
+        static constexpr unsigned long SynchronizedWriteSkewNs = (SynchronizedWriteSkew * 1000000000ull + _CpuFreq - 1) / _CpuFreq;
+
         /**
          * @brief Read output port value
          * @details
@@ -277,6 +324,25 @@ namespace Zhele::IO
         template<uint8_t number, DataType mask = std::numeric_limits<DataType>::max()>
         static void AltFuncNumber();
 
+        /**
+         * @brief Configure pins (all attributes at once)
+         * 
+         * @details
+         * Register images are computed at compile time and every configuration
+         * register is written once per port, so reconfiguration is short and glitch-free.
+         * 
+         * @tparam configuration Configuration
+         * @tparam speed Speed (for outputs)
+         * @tparam pull Pull mode
+         * @tparam altFunc Alternate function number (for AltFunc configuration)
+         * @tparam driver Driver type (for outputs)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<Configuration configuration, Speed speed, PullMode pull, uint8_t altFunc = 0, DriverType driver = PushPull>
+        static void Configure();
+
         /**
          * @brief Enable clock for port
          * 
@@ -293,6 +359,31 @@ namespace Zhele::IO
         */
         static void Disable();
 
+        /**
+         * @brief Returns port value for pinlist value
+         * 
+         * @tparam _Port Port
+         * 
+         * @param [in] value Pinlist value
+         * 
+         * @returns Port value (bits of pins of given port)
+         */
+        template<typename _Port>
+        static constexpr typename _Port::DataType PortValue(DataType value);
+
+        /**
+         * @brief Returns mask of pins in port
+         * 
+         * @tparam _Port Port
+         * 
+         * @returns Port mask
+         */
+        template<typename _Port>
+        static consteval typename _Port::DataType PortMask();
+
+        /// Pins count
+        static const unsigned Length = sizeof...(_Pins);
+
         /**
          * @brief Detect index of pin in pinlist
          * 
@@ -310,8 +401,25 @@ namespace Zhele::IO
         using Pin = Zhele::TemplateUtils::TypeUnbox<_pins.template get<Index>()>;
 
     private:
+        /**
+         * @brief Maps pinlist value to port value
+         * 
+         * @details
+         * Mapping is selected at compile time: pins with constant offset between bit in value and
+         * bit in port (contiguous and shifted runs) are mapped by shift-and-mask, reversed run
+         * is mapped by RBIT (Cortex-M3 and higher), other sequences use small lookup tables.
+         */
         static constexpr auto GetPinlistValueForPort(auto port, DataType value);
 
+        static consteval auto GetPinNumbersForPort(auto port);
+
+        static constexpr uint32_t GetBitSetResetWordForPort(auto port, DataType value);
+
+        template<typename... _Ports>
+        static void StoreSynchronized(TypeList<_Ports...>, const uint32_t (&words)[sizeof...(_Ports)]);
+
+        static consteval auto GetRealPorts();
+
         static consteval auto GetPinlistMaskForPort(auto port);
 
         template<typename Port>
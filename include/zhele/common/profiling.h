@@ -0,0 +1,167 @@
+/**
+ * @file
+ * Implements interrupt handlers profiling
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PROFILING_COMMON_H
+#define ZHELE_PROFILING_COMMON_H
+
+/**
+ * @def ZHELE_PROFILE_ISR
+ * @brief Profile current interrupt handler (until scope end)
+ * 
+ * @details
+ * Profiling is enabled by ZHELE_PROFILING macro, otherwise macro is empty.
+ * Nested interrupts are included into duration of interrupted handler.
+ */
+#if defined (ZHELE_PROFILING)
+
+#include "delay.h"
+
+#include <stdint.h>
+
+#define ZHELE_PROFILE_ISR() \
+    static ::Zhele::Profiling::HandlerStatistics zheleHandlerStatistics(__PRETTY_FUNCTION__); \
+    ::Zhele::Profiling::Scope zheleProfilingScope(zheleHandlerStatistics)
+
+namespace Zhele::Profiling
+{
+    /**
+     * @brief Interrupt handler statistics
+     */
+    class HandlerStatistics
+    {
+        friend class Scope;
+    public:
+        /// Duration histogram buckets count (bucket N counts durations in [2^(N-1), 2^N) cycles)
+        static const unsigned HistogramSize = 16;
+
+        /**
+         * @brief Constructor
+         * 
+         * @param [in] name Handler name
+         */
+        constexpr HandlerStatistics(const char* name)
+            : _name(name)
+        {}
+
+        /**
+         * @brief Returns handler name
+         * 
+         * @returns Name (function signature)
+         */
+        const char* Name() const { return _name; }
+
+        /**
+         * @brief Returns handler calls count
+         * 
+         * @returns Calls count
+         */
+        uint32_t Count() const { return _count; }
+
+        /**
+         * @brief Returns maximal duration
+         * 
+         * @returns Cycles count
+         */
+        uint32_t MaxCycles() const { return _maxCycles; }
+
+        /**
+         * @brief Returns average duration
+         * 
+         * @returns Cycles count
+         */
+        uint32_t AverageCycles() const;
+
+        /**
+         * @brief Returns total duration
+         * 
+         * @returns Cycles count
+         */
+        uint64_t TotalCycles() const { return _totalCycles; }
+
+        /**
+         * @brief Returns duration histogram
+         * 
+         * @returns Histogram (HistogramSize buckets)
+         */
+        const uint32_t* Histogram() const { return _histogram; }
+
+        /**
+         * @brief Returns next registered handler
+         * 
+         * @returns Next handler statistics or nullptr
+         */
+        const HandlerStatistics* Next() const { return _next; }
+
+    private:
+        void Record(uint32_t cycles);
+        void Reset();
+
+        const char* _name;
+        HandlerStatistics* _next = nullptr;
+        bool _registered = false;
+        uint32_t _count = 0;
+        uint32_t _maxCycles = 0;
+        uint64_t _totalCycles = 0;
+        uint32_t _histogram[HistogramSize] = {};
+
+        friend const HandlerStatistics* First();
+        friend void Reset();
+        static inline HandlerStatistics* _first = nullptr;
+    };
+
+    /**
+     * @brief Profiling scope (records duration in destructor)
+     */
+    class Scope
+    {
+    public:
+        Scope(HandlerStatistics& statistics);
+        ~Scope();
+
+    private:
+        HandlerStatistics& _statistics;
+        uint32_t _start;
+    };
+
+    /**
+     * @brief Returns first handler statistics (handlers are registered on first call)
+     * 
+     * @returns Statistics or nullptr
+     */
+    const HandlerStatistics* First();
+
+    /**
+     * @brief Reset statistics of all handlers
+     * 
+     * @par Returns
+     *  Nothing
+     */
+    void Reset();
+
+    /**
+     * @brief Write text report (one line per handler: count, average, max, histogram and name)
+     * 
+     * @tparam _Output Output with Write(const void* data, size_t size) method (Usart, Trace::ItmPort and so on)
+     * 
+     * @par Returns
+     *  Nothing
+     */
+    template<typename _Output>
+    void Report();
+}
+
+#include "impl/profiling.h"
+
+#else
+
+#define ZHELE_PROFILE_ISR()
+
+#endif
+
+#endif //! ZHELE_PROFILING_COMMON_H
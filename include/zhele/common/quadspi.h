@@ -0,0 +1,264 @@
+/**
+ * @file
+ * Implements QUADSPI
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_QUADSPI_COMMON_H
+#define ZHELE_QUADSPI_COMMON_H
+
+#include "ioreg.h"
+#include "./template_utils/data_transfer.h"
+
+#include <zhele/clock.h>
+#include <zhele/dma.h>
+#include <zhele/iopins.h>
+#include <zhele/pinlist.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief QUADSPI phase lines
+     */
+    enum class QuadSpiLines : uint8_t
+    {
+        None = 0, ///< Phase is skipped
+        Single = 1, ///< One line
+        Dual = 2, ///< Two lines
+        Quad = 3, ///< Four lines
+    };
+
+    /**
+     * @brief QUADSPI command (instruction, address, alternate byte, dummy cycles and data phases)
+     */
+    struct QuadSpiCommand
+    {
+        uint8_t Instruction; ///< Instruction
+        QuadSpiLines InstructionLines = QuadSpiLines::Single; ///< Instruction lines
+        QuadSpiLines AddressLines = QuadSpiLines::None; ///< Address lines
+        uint8_t AddressBytes = 3; ///< Address size (1-4 bytes)
+        QuadSpiLines AlternateLines = QuadSpiLines::None; ///< Alternate byte lines
+        uint8_t Alternate = 0; ///< Alternate byte (mode bits of fast read commands)
+        uint8_t DummyCycles = 0; ///< Dummy cycles (0-31)
+        QuadSpiLines DataLines = QuadSpiLines::None; ///< Data lines
+    };
+
+    namespace Private
+    {
+        /**
+         * @brief Implements QUADSPI (single flash)
+         *
+         * @details
+         * Indirect mode runs one command (with optional data), data is transferred by CPU (FIFO polling) or DMA.
+         * Memory-mapped mode executes read command on every access to mapped region, so external memory
+         * can be read by pointer with hardware prefetch. Any indirect command leaves memory-mapped mode,
+         * so it must be enabled again after memory is changed.
+         *
+         * @par Example
+         * @code
+         *  QuadSpi::SelectPins<IO::Pe10, IO::Pe11, IO::Pe12, IO::Pe13, IO::Pe14, IO::Pe15>();
+         *  QuadSpi::Init<40000000, 80000000>(23); // 8 MB (2 ^ 23)
+         *  QuadSpi::EnableMemoryMapped({.Instruction = 0xeb, .AddressLines = QuadSpiLines::Quad,
+         *      .AlternateLines = QuadSpiLines::Quad, .Alternate = 0xff, .DummyCycles = 4, .DataLines = QuadSpiLines::Quad});
+         *  auto font = reinterpret_cast<const uint8_t*>(QuadSpi::MappedAddress);
+         * @endcode
+         *
+         * @tparam _Regs Registers
+         * @tparam _ClockCtrl Clock
+         * @tparam _Dma DMA channel
+         * @tparam _ClkPins CLK pins
+         * @tparam _NcsPins NCS pins
+         * @tparam _Io0Pins IO0 pins
+         * @tparam _Io1Pins IO1 pins
+         * @tparam _Io2Pins IO2 pins
+         * @tparam _Io3Pins IO3 pins
+         */
+        template<typename _Regs, typename _ClockCtrl, typename _Dma, typename _ClkPins, typename _NcsPins,
+            typename _Io0Pins, typename _Io1Pins, typename _Io2Pins, typename _Io3Pins>
+        class QuadSpi
+        {
+        public:
+            /// Memory-mapped region address
+            static constexpr uintptr_t MappedAddress = QSPI_BASE;
+
+            /**
+             * @brief Initializes QUADSPI
+             *
+             * @tparam frequency Max clock frequency
+             * @tparam clockFrequency QUADSPI kernel (AHB) clock frequency
+             *
+             * @param [in] sizeLog2 Memory size (log2 of bytes count)
+             * @param [in] csHighCycles Min chip select high time between commands (1-8 clock cycles)
+             * @param [in] sampleShift Sample data half cycle later (for high frequency)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<uint32_t frequency, uint32_t clockFrequency>
+            static void Init(uint8_t sizeLog2, uint8_t csHighCycles = 2, bool sampleShift = false);
+
+            /**
+             * @brief Selects pins
+             *
+             * @tparam ClkPin CLK pin
+             * @tparam NcsPin NCS pin
+             * @tparam Io0Pin IO0 pin
+             * @tparam Io1Pin IO1 pin
+             * @tparam Io2Pin IO2 pin (IO::NullPin for single and dual modes)
+             * @tparam Io3Pin IO3 pin (IO::NullPin for single and dual modes)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<typename ClkPin, typename NcsPin, typename Io0Pin, typename Io1Pin, typename Io2Pin = IO::NullPin, typename Io3Pin = IO::NullPin>
+            static void SelectPins();
+
+            /**
+             * @brief Runs command without data
+             *
+             * @param [in] command Command
+             * @param [in] address Address (if command has address phase)
+             *
+             * @retval true Command is completed
+             * @retval false Transfer error
+             */
+            static bool Command(const QuadSpiCommand& command, uint32_t address = 0);
+
+            /**
+             * @brief Reads data (blocking)
+             *
+             * @param [in] command Command
+             * @param [in] address Address
+             * @param [out] data Data buffer
+             * @param [in] size Data size
+             *
+             * @retval true Data is read
+             * @retval false Transfer error
+             */
+            static bool Read(const QuadSpiCommand& command, uint32_t address, void* data, uint32_t size);
+
+            /**
+             * @brief Writes data (blocking)
+             *
+             * @param [in] command Command
+             * @param [in] address Address
+             * @param [in] data Data
+             * @param [in] size Data size
+             *
+             * @retval true Data is written
+             * @retval false Transfer error
+             */
+            static bool Write(const QuadSpiCommand& command, uint32_t address, const void* data, uint32_t size);
+
+            /**
+             * @brief Reads data by DMA
+             *
+             * @param [in] command Command
+             * @param [in] address Address
+             * @param [out] data Data buffer
+             * @param [in] size Data size
+             * @param [in] callback Completion callback (called from DMA interrupt)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void ReadAsync(const QuadSpiCommand& command, uint32_t address, void* data, uint32_t size, TransferCallback callback = nullptr);
+
+            /**
+             * @brief Writes data by DMA
+             *
+             * @details
+             * Callback is called when the last byte is written into FIFO, so command may be still in progress
+             * (next command waits for it).
+             *
+             * @param [in] command Command
+             * @param [in] address Address
+             * @param [in] data Data
+             * @param [in] size Data size
+             * @param [in] callback Completion callback (called from DMA interrupt)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void WriteAsync(const QuadSpiCommand& command, uint32_t address, const void* data, uint32_t size, TransferCallback callback = nullptr);
+
+            /**
+             * @brief Polls status register by hardware until masked bits match (blocking)
+             *
+             * @details
+             * Status is read every interval clock cycles without CPU, for example
+             * to wait for write in progress bit is cleared.
+             *
+             * @param [in] command Status read command (data phase is 1 byte)
+             * @param [in] mask Status mask
+             * @param [in] match Expected masked status
+             * @param [in] interval Interval between status reads (clock cycles)
+             *
+             * @retval true Status matches
+             * @retval false Transfer error
+             */
+            static bool AutoPoll(const QuadSpiCommand& command, uint8_t mask, uint8_t match, uint16_t interval = 16);
+
+            /**
+             * @brief Enables memory-mapped mode
+             *
+             * @param [in] command Read command
+             * @param [in] timeoutCycles Chip select is released after timeout (clock cycles) without access, 0 to disable
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableMemoryMapped(const QuadSpiCommand& command, uint16_t timeoutCycles = 0);
+
+            /**
+             * @brief Leaves memory-mapped mode (aborts current command)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableMemoryMapped();
+
+            /**
+             * @brief Returns memory-mapped mode is enabled
+             *
+             * @retval true Memory-mapped mode
+             * @retval false Indirect mode
+             */
+            static bool MemoryMapped();
+
+            /**
+             * @brief Returns QUADSPI is busy
+             *
+             * @retval true Command is in progress
+             * @retval false QUADSPI is idle
+             */
+            static bool Busy();
+
+        private:
+            enum class FunctionalMode : uint32_t
+            {
+                IndirectWrite = 0,
+                IndirectRead = 1,
+                AutoPolling = 2,
+                MemoryMapped = 3,
+            };
+
+            static constexpr uint32_t Ccr(const QuadSpiCommand& command, FunctionalMode mode);
+            static void WaitIdle();
+            static void Start(const QuadSpiCommand& command, FunctionalMode mode, uint32_t address, uint32_t size);
+            static bool WaitComplete();
+
+            static bool _memoryMapped;
+        };
+    }
+}
+
+#include "impl/quadspi.h"
+
+#endif //! ZHELE_QUADSPI_COMMON_H
@@ -10,6 +10,8 @@
 #define ZHELE_RNG_COMMON_H_
 
 #include <zhele/clock.h>
+#include <zhele/containers/ring_buffer.h>
+#include <zhele/system_time.h>
 
 #include <cstdint>
 #include <cstddef>
@@ -18,7 +20,7 @@
 namespace Zhele {
 
     class Rng {
-        static constexpr unsigned _gen_timeout = 40 * 4;
+        static constexpr unsigned _gen_timeout = 40 * 4; ///< Wait iterations count (without system time)
     public:
         /**
          * @brief Initialize RNG module
@@ -63,6 +65,121 @@ namespace Zhele {
          * @retval false Module FAIL (seed or clock error)
          */
         static inline bool IsOk();
+
+        /**
+         * @brief Enables or disables data ready (and error) interrupt
+         * 
+         * @param [in] enable Enable interrupt
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static inline void EnableInterrupt(bool enable = true);
+
+        /**
+         * @brief Restarts generator after seed error
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static inline void Recover();
+
+    #if defined (STM32F4) || defined (HASH)
+        static const IRQn_Type IRQNumber = HASH_RNG_IRQn; ///< RNG interrupt (shared with HASH)
+    #else
+        static const IRQn_Type IRQNumber = RNG_IRQn; ///< RNG interrupt
+    #endif
+    };
+
+    /**
+     * @brief Implements entropy pool (RNG words buffer refilled by interrupt)
+     * 
+     * @details
+     * Generator produces word every ~40 RNG clock cycles, so waiting for it in @ref Rng::Next
+     * takes time. Pool collects words in interrupt and returns buffered ones without waiting,
+     * interrupt is disabled when pool is full and enabled again when words are taken.
+     * Seed error restarts generator (word of failed seed is not taken).
+     * 
+     * RNG interrupt handler should call @ref IrqHandler.
+     * 
+     * @par Example
+     * @code
+     *  using Entropy = RngPool<16>;
+     *  Entropy::Init();
+     *  uint8_t nonce[12];
+     *  if(Entropy::NextBytes(nonce, sizeof(nonce)))
+     *  {
+     *      // Use nonce
+     *  }
+     * 
+     *  extern "C" void HASH_RNG_IRQHandler()
+     *  {
+     *      Entropy::IrqHandler();
+     *  }
+     * @endcode
+     * 
+     * @tparam _Size Pool size (in 32-bit words)
+     */
+    template<unsigned _Size = 16>
+    class RngPool
+    {
+        using Buffer = Containers::RingBuffer<_Size, uint32_t>;
+    public:
+        /**
+         * @brief Initializes RNG and starts pool filling
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Returns buffered words count
+         * 
+         * @returns Words count
+         */
+        static unsigned Available();
+
+        /**
+         * @brief Takes one random word from pool (doesn't wait)
+         * 
+         * @returns Random number or nothing if pool is empty
+         */
+        static std::optional<uint32_t> Next();
+
+        /**
+         * @brief Fills buffer from pool (doesn't wait)
+         * 
+         * @details
+         * Data is taken only if pool has enough words ((size + 3) / 4),
+         * so size should not exceed pool size (4 * _Size bytes).
+         * 
+         * @param [out] data Data buffer
+         * @param [in] size Bytes to generate
+         * 
+         * @retval true Buffer is filled
+         * @retval false Pool doesn't have enough entropy (buffer is not changed)
+         */
+        static bool NextBytes(uint8_t* data, size_t size);
+
+        /**
+         * @brief Returns errors (seed and clock) count
+         * 
+         * @returns Errors count
+         */
+        static unsigned Errors();
+
+        /**
+         * @brief RNG interrupt handler
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static inline Buffer _pool; ///< Random words
+        static inline volatile unsigned _errors = 0; ///< Errors count
     };
 }
 
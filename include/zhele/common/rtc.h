@@ -0,0 +1,345 @@
+/**
+ * @file
+ * Implements internal RTC (calendar, wakeup timer, alarms)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_RTC_COMMON_H
+#define ZHELE_RTC_COMMON_H
+
+#include <zhele/clock.h>
+#include <zhele/system_time.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    namespace Private
+    {
+        /**
+         * @brief Implements internal RTC
+         *
+         * @details
+         * RTC is clocked by LSE or LSI and keeps counting in Stop and Standby modes and over system reset,
+         * so @ref Init doesn't reset calendar if RTC is already running from the same clock source.
+         * Calendar is read from shadow registers (synchronized with RTC clock), after wake up from Stop mode
+         * call @ref Resynchronize before reading. Sub-second counter resolution is 1 / @ref TicksPerSecond seconds
+         * (synchronous prescaler), @ref Now and @ref DayTicks read three registers and don't wait.
+         *
+         * Periodic wakeup timer and alarms wake MCU up from Stop and Standby modes (they are connected
+         * to EXTI lines which are configured by enable methods), call @ref ClearInterruptFlag from interrupt handler.
+         *
+         * @par Example
+         * @code
+         *  Rtc::Init(); // LSE, 256 ticks per second
+         *  Rtc::SetDateTime({.Seconds = 0, .Minutes = 30, .Hours = 12, .Weekday = 1, .Day = 1, .Month = 7, .Year = 24});
+         *  Rtc::EnableWakeup(1000);
+         *  extern "C" void RTC_WKUP_IRQHandler() { Rtc::ClearInterruptFlag(Rtc::Interrupt::Wakeup); }
+         *  ...
+         *  Power::Idle();
+         *  Rtc::Resynchronize();
+         *  auto now = Rtc::Now();
+         * @endcode
+         *
+         * @tparam _ApbClock RTC registers clock (void if it's always enabled)
+         * @tparam _WakeupLine EXTI line of wakeup timer
+         * @tparam _WakeupIRQn Wakeup timer IRQ
+         * @tparam _AlarmLine EXTI line of alarms
+         * @tparam _AlarmIRQn Alarms IRQ
+         */
+        template<typename _ApbClock, uint8_t _WakeupLine, IRQn_Type _WakeupIRQn, uint8_t _AlarmLine, IRQn_Type _AlarmIRQn>
+        class Rtc
+        {
+        #if defined (RTC_ICSR_INIT)
+            static constexpr uint32_t InitReadyFlag = RTC_ICSR_INITF;
+            static constexpr uint32_t SyncFlag = RTC_ICSR_RSF;
+            static constexpr uint32_t RecalibrationFlag = RTC_ICSR_RECALPF;
+            static constexpr uint32_t WakeupWriteFlag = RTC_ICSR_WUTWF;
+        #else
+            static constexpr uint32_t InitReadyFlag = RTC_ISR_INITF;
+            static constexpr uint32_t SyncFlag = RTC_ISR_RSF;
+            static constexpr uint32_t RecalibrationFlag = RTC_ISR_RECALPF;
+        #if defined (RTC_ISR_WUTWF)
+            static constexpr uint32_t WakeupWriteFlag = RTC_ISR_WUTWF;
+        #endif
+        #endif
+
+            static const uint32_t UnixEpochDays = 719468; ///< Days from 0000-03-01 to 1970-01-01
+            static const unsigned LseStartupTimeout = 5000; ///< LSE startup timeout (ms)
+
+        public:
+            /**
+             * @brief RTC clock source (RTCSEL value)
+             */
+            enum class ClockSource : uint8_t
+            {
+                Lse = 0b01, ///< External 32768 Hz crystal
+                Lsi = 0b10, ///< Internal low-speed oscillator
+            };
+
+            /**
+             * @brief RTC interrupts (status flags)
+             */
+            enum class Interrupt : uint32_t
+            {
+            #if defined (RTC_ICSR_INIT)
+                AlarmA = RTC_SR_ALRAF, ///< Alarm A
+                AlarmB = RTC_SR_ALRBF, ///< Alarm B
+                Wakeup = RTC_SR_WUTF, ///< Periodic wakeup
+            #else
+                AlarmA = RTC_ISR_ALRAF, ///< Alarm A
+            #if defined (RTC_ISR_ALRBF)
+                AlarmB = RTC_ISR_ALRBF, ///< Alarm B
+            #endif
+            #if defined (RTC_ISR_WUTF)
+                Wakeup = RTC_ISR_WUTF, ///< Periodic wakeup
+            #endif
+            #endif
+            };
+
+            /**
+             * @brief Alarms
+             */
+            enum class Alarm : uint8_t
+            {
+                A, ///< Alarm A
+            #if defined (RTC_CR_ALRBE)
+                B, ///< Alarm B
+            #endif
+            };
+
+            /**
+             * @brief Alarm matched fields
+             */
+            enum class AlarmMatch : uint32_t
+            {
+                EverySecond = RTC_ALRMAR_MSK4 | RTC_ALRMAR_MSK3 | RTC_ALRMAR_MSK2 | RTC_ALRMAR_MSK1, ///< Every second
+                Seconds = RTC_ALRMAR_MSK4 | RTC_ALRMAR_MSK3 | RTC_ALRMAR_MSK2, ///< Every minute at given second
+                MinutesSeconds = RTC_ALRMAR_MSK4 | RTC_ALRMAR_MSK3, ///< Every hour at given minute and second
+                Time = RTC_ALRMAR_MSK4, ///< Every day at given time
+                DayTime = 0, ///< Every month at given day and time
+            };
+
+            /**
+             * @brief Date and time
+             */
+            struct DateTime
+            {
+                uint8_t Seconds; ///< Seconds, from 0 to 59
+                uint8_t Minutes; ///< Minutes, from 0 to 59
+                uint8_t Hours; ///< Hours (24-hour format), from 0 to 23
+                uint8_t Weekday; ///< Day of week, from 1 (Monday) to 7 (Sunday)
+                uint8_t Day; ///< Day of month, from 1 to 31
+                uint8_t Month; ///< Month, from 1 to 12
+                uint8_t Year; ///< Year, from 0 (2000) to 99 (2099)
+            };
+
+            /**
+             * @brief Timestamp
+             */
+            struct Instant
+            {
+                uint32_t Epoch; ///< Unix time (seconds since 1970-01-01 00:00:00)
+                uint16_t Milliseconds; ///< Milliseconds, 0 to 999
+            };
+
+            /**
+             * @brief Enables RTC clock and sets prescalers
+             *
+             * @details
+             * Calendar is kept if RTC already runs from given source. Otherwise backup domain is reset
+             * (if other source is selected), clock source is started and calendar is initialized (2000-01-01 00:00:00).
+             * Synchronous prescaler is clockFreq / asyncPrescaler, it's sub-second counter resolution.
+             *
+             * @param [in] source Clock source
+             * @param [in] clockFreq Clock source frequence (measured LSI frequence for LSI)
+             * @param [in] asyncPrescaler Asynchronous prescaler, from 1 to 128 (higher is less power consumption)
+             *
+             * @retval true RTC is running
+             * @retval false Clock source is not started
+             */
+            static bool Init(ClockSource source = ClockSource::Lse, uint32_t clockFreq = 32768, uint32_t asyncPrescaler = 128);
+
+            /**
+             * @brief Returns sub-second counter frequence
+             *
+             * @returns Sub-second ticks per second
+             */
+            static uint32_t TicksPerSecond();
+
+            /**
+             * @brief Sets date and time
+             *
+             * @param [in] dateTime Date and time
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void SetDateTime(const DateTime& dateTime);
+
+            /**
+             * @brief Reads date and time
+             *
+             * @returns Date and time
+             */
+            static DateTime GetDateTime();
+
+            /**
+             * @brief Returns current time with milliseconds
+             *
+             * @returns Unix time and milliseconds
+             */
+            static Instant Now();
+
+            /**
+             * @brief Returns time of day in sub-second ticks
+             *
+             * @details
+             * Cheap timestamp (no calendar conversion), it wraps at midnight.
+             *
+             * @returns Ticks since midnight
+             */
+            static uint32_t DayTicks();
+
+            /**
+             * @brief Waits for shadow registers synchronization
+             *
+             * @details
+             * Shadow registers are not updated in Stop mode, call method after wake up before calendar read.
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Resynchronize();
+
+        #if defined (RTC_CR_WUTE)
+            /**
+             * @brief Enables periodic wakeup
+             *
+             * @details
+             * Period up to 32 s (for 32768 Hz clock) is counted by RTC clock / 16 (resolution is 0.49 ms),
+             * longer period (up to 36 hours) is rounded to seconds.
+             *
+             * @param [in] milliseconds Period
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableWakeup(uint32_t milliseconds);
+
+            /**
+             * @brief Disables periodic wakeup
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableWakeup();
+        #endif
+
+            /**
+             * @brief Enables alarm
+             *
+             * @param [in] alarm Alarm
+             * @param [in] dateTime Alarm time (weekday, month and year are ignored)
+             * @param [in] match Matched fields
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableAlarm(Alarm alarm, const DateTime& dateTime, AlarmMatch match = AlarmMatch::Time);
+
+            /**
+             * @brief Disables alarm
+             *
+             * @param [in] alarm Alarm
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableAlarm(Alarm alarm);
+
+            /**
+             * @brief Checks interrupt flag
+             *
+             * @param [in] interrupt Interrupt
+             *
+             * @retval true Flag is set
+             * @retval false Flag is not set
+             */
+            static bool IsInterrupt(Interrupt interrupt);
+
+            /**
+             * @brief Clears interrupt flag (and EXTI pending flag)
+             *
+             * @param [in] interrupt Interrupt
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void ClearInterruptFlag(Interrupt interrupt);
+
+            /**
+             * @brief Sets smooth calibration
+             *
+             * @details
+             * RTC clock pulses are added or masked evenly in 32 s window (resolution is 0.95 ppm).
+             *
+             * @param [in] ppb Frequency correction in parts per billion, from -487100 to 488500 (positive speeds RTC up)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void SetCalibration(int32_t ppb);
+
+            /**
+             * @brief Calculates calibration register value
+             *
+             * @param [in] ppb Frequency correction in parts per billion
+             *
+             * @returns CALR register value
+             */
+            static constexpr uint32_t CalculateCalibration(int32_t ppb);
+
+            /**
+             * @brief Converts date and time to Unix time
+             *
+             * @param [in] dateTime Date and time (from 2000 to 2099 year)
+             *
+             * @returns Seconds since 1970-01-01 00:00:00
+             */
+            static constexpr uint32_t ToEpoch(const DateTime& dateTime);
+
+            /**
+             * @brief Converts Unix time to date and time
+             *
+             * @param [in] epoch Seconds since 1970-01-01 00:00:00 (from 2000 to 2099 year)
+             *
+             * @returns Date and time
+             */
+            static constexpr DateTime FromEpoch(uint32_t epoch);
+
+        private:
+            static void EnableBackupAccess();
+            static void Unlock();
+            static void Lock();
+            static bool EnterInitMode();
+            static void ExitInitMode();
+            static void WaitSynchronization();
+            static void EnableExtiLine(uint8_t line, IRQn_Type irq);
+            static void ClearExtiLine(uint8_t line);
+            static volatile uint32_t& InitStatus();
+            static DateTime Decode(uint32_t time, uint32_t date);
+
+            static constexpr uint8_t ToBcd(uint8_t value) { return static_cast<uint8_t>(((value / 10) << 4) | (value % 10)); }
+            static constexpr uint8_t FromBcd(uint32_t value) { return static_cast<uint8_t>(((value >> 4) & 0x0f) * 10 + (value & 0x0f)); }
+        };
+    }
+}
+
+#include "impl/rtc.h"
+
+#endif //! ZHELE_RTC_COMMON_H
@@ -13,6 +13,7 @@
 #include "template_utils/data_transfer.h"
 
 #include <zhele/clock.h>
+#include <zhele/dma.h>
 #include <zhele/iopins.h>
 #include <zhele/pinlist.h>
 
@@ -138,6 +139,52 @@ namespace Zhele
                 LsbFirst			= SPI_CR1_LSBFIRST, ///< LSB
                 MsbFirst			= 0 ///< MSB
             };
+
+            /**
+             * @brief Calculates SPI clock frequency for divider
+             * 
+             * @param [in] clockFreq SPI source (APB) clock frequency
+             * @param [in] divider Clock divider
+             * 
+             * @returns SPI clock frequency
+             */
+            static constexpr uint32_t DividerFrequency(uint32_t clockFreq, ClockDivider divider)
+            {
+                return clockFreq >> ((static_cast<uint32_t>(divider) >> SPI_CR1_BR_Pos) + 1);
+            }
+
+            /**
+             * @brief Calculates the fastest divider for SPI clock not greater than given
+             * 
+             * @param [in] clockFreq SPI source (APB) clock frequency
+             * @param [in] maxFreq Max SPI clock frequency
+             * 
+             * @returns Clock divider (Div256 if frequency cannot be reached)
+             */
+            static constexpr ClockDivider CalculateDivider(uint32_t clockFreq, uint32_t maxFreq)
+            {
+                for(uint32_t value = 0; value < 7; ++value)
+                {
+                    ClockDivider divider = static_cast<ClockDivider>(value << SPI_CR1_BR_Pos);
+                    if(DividerFrequency(clockFreq, divider) <= maxFreq)
+                        return divider;
+                }
+                return Div256;
+            }
+
+            /**
+             * @brief Achieved SPI clock frequency for required one
+             * 
+             * @tparam maxFreq Max SPI clock frequency
+             * @tparam clockFreq SPI source (APB) clock frequency
+             * 
+             * @returns SPI clock frequency
+             */
+            template<unsigned long maxFreq, unsigned long clockFreq>
+            static consteval uint32_t AchievedFrequency()
+            {
+                return DividerFrequency(clockFreq, CalculateDivider(clockFreq, maxFreq));
+            }
         };
         
 
@@ -155,8 +202,24 @@ namespace Zhele
         class Spi : public SpiBase
         {
         public:
+            using Regs = _Regs;
+            using ClockCtrl = _Clock;
+            using MosiPins = _MosiPins;
+            using ClockPins = _ClockPins;
+            using SsPins = _SsPins;
             using DmaTx = _DmaTx;
             using DmaRx = _DmaRx;
+
+            /// DMA TX handler with compile-time transfer complete callback (see @ref Zhele::DmaCallback)
+            template<TransferCallback _Callback>
+            using TxCompleteHandler = DmaCallback<_DmaTx, _Callback>;
+
+            /// DMA RX handler with compile-time transfer complete (and half transfer) callbacks (see @ref Zhele::DmaCallback)
+            template<TransferCallback _Callback, TransferCallback _HalfCallback = nullptr>
+            using RxCompleteHandler = DmaCallback<_DmaRx, _Callback, _HalfCallback>;
+
+            /// Transfers shorter than threshold (count of frames) are performed without DMA
+            static constexpr size_t DmaTransferThreshold = 16;
             /**
              * @brief Enable SPI
              * 
@@ -184,6 +247,53 @@ namespace Zhele
              * 	Nothing
              */
             static void Init(ClockDivider divider = Medium, Mode mode = Master);
+
+            /**
+             * @brief Init SPI interface with the fastest clock not greater than given
+             * 
+             * @details
+             * Divider is recalculated on system clock change (see @ref Clock::ClockChange).
+             * 
+             * @tparam maxFreq Max SPI clock frequency
+             * @param [in] mode SPI mode
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            template<unsigned long maxFreq>
+            static void Init(Mode mode = Master);
+
+            /**
+             * @brief Init SPI interface with compile-time clock frequency check
+             * 
+             * @tparam maxFreq Max SPI clock frequency
+             * @tparam clockFreq SPI source (APB) clock frequency
+             * @param [in] mode SPI mode
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            template<unsigned long maxFreq, unsigned long clockFreq>
+            static void Init(Mode mode = Master);
+
+            /**
+             * @brief Set the fastest SPI clock not greater than given
+             * 
+             * @details
+             * Divider is recalculated on system clock change (see @ref Clock::ClockChange).
+             * 
+             * @param [in] maxFreq Max SPI clock frequency
+             * 
+             * @returns Achieved SPI clock frequency
+             */
+            static uint32_t SetFrequency(uint32_t maxFreq);
+
+            /**
+             * @brief Returns current SPI clock frequency
+             * 
+             * @returns SPI clock frequency
+             */
+            static uint32_t GetFrequency();
            
 
             /**
@@ -240,6 +350,25 @@ namespace Zhele
              * 	Nothing
              */
             static void SetDataSize(DataSize dataSize);
+
+            /**
+             * @brief Set clock divider and frame format at once
+             * 
+             * @details
+             * Waits for end of transfer and disables SPI if configuration is changed (clock settings
+             * and data size should not be changed while SPI is enabled). Each control register is read
+             * and written once (see @ref ShadowReg), so it's faster than sequence of SetXxx calls.
+             * 
+             * @param [in] divider Clock divider
+             * @param [in] clockPolarity Clock polarity
+             * @param [in] clockPhase Clock phase
+             * @param [in] bitOrder Bit order
+             * @param [in] dataSize Data size
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void Configure(ClockDivider divider, ClockPolarity clockPolarity, ClockPhase clockPhase, BitOrder bitOrder = MsbFirst, DataSize dataSize = DataSize8);
           
             /**
              * @brief Set slave control (NSS pin)
@@ -292,11 +421,105 @@ namespace Zhele
              * @param [in] bufferSize Data size
              * @param [in, opt] callback Transfer complete callback (optional parameter)
              * 
+             * @details
+             * If hardware CRC is enabled (see @ref EnableCrc), CRC is transmitted after data automatically
+             * (it's not counted in @p bufferSize) and received CRC is checked: callback is called with
+             * success = false on CRC mismatch. CRC is reset for next frame before callback.
+             * 
              * @par Returns
              *  Nothing
              */
             
             static void SendAsync(void* transmitBuffer, void* receiveBuffer, size_t bufferSize, TransferCallback callback = nullptr);
+
+            /**
+             * @brief Enables hardware CRC
+             * 
+             * @details
+             * CRC is calculated for transmitted and received frames,
+             * DMA transfers (@ref SendAsync) append and check it without CPU.
+             * CRC length is 16 bits if polynomial is greater than 0xff, otherwise 8 bits.
+             * For SPI without data FIFO (F1, F4) CRC length is data size, so polynomial should match it.
+             * Both sides must use the same polynomial.
+             * 
+             * @param [in] polynomial CRC polynomial (for example 0x07 for CRC-8 or 0x1021 for CRC-16-CCITT)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableCrc(uint16_t polynomial);
+
+            /**
+             * @brief Disables hardware CRC
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableCrc();
+
+            /**
+             * @brief Resets CRC calculation (for example, after frame error)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void ResetCrc();
+
+            /**
+             * @brief Returns CRC of received data
+             * 
+             * @returns RX CRC register value
+             */
+            static uint16_t RxCrc();
+
+            /**
+             * @brief Returns CRC of transmitted data
+             * 
+             * @returns TX CRC register value
+             */
+            static uint16_t TxCrc();
+
+            /**
+             * @brief Returns CRC errors count (since CRC enable)
+             * 
+             * @returns Frames with CRC mismatch
+             */
+            static uint32_t CrcErrors();
+            /**
+             * @brief Full-duplex bulk transfer of 8-bit data
+             * 
+             * @details
+             * Blocking call. Uses DMA (both RX and TX channels) for transfers
+             * not shorter than DmaTransferThreshold, otherwise polling. SPI with data FIFO
+             * (F0, G0, L4) packs two frames into one 16-bit data register access while polling.
+             * Returns when both RX and TX are finished. SPI data size should be 8 bits.
+             * 
+             * @param [in] transmitBuffer Data to transmit (nullptr to send 0xff)
+             * @param [out] receiveBuffer Output buffer (nullptr to ignore received data)
+             * @param [in] size Data size (in bytes)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Transfer(const void* transmitBuffer, void* receiveBuffer, size_t size);
+
+            /**
+             * @brief Full-duplex bulk transfer of 16-bit data
+             * 
+             * @details
+             * Blocking call. Temporarily switches SPI data size to 16 bits, so
+             * frame count is half of 8-bit transfer (for example, for RGB565 pixels).
+             * Words are sent in host order (with MSB first bit order high byte goes first).
+             * 
+             * @param [in] transmitBuffer Data to transmit (nullptr to send 0xffff)
+             * @param [out] receiveBuffer Output buffer (nullptr to ignore received data)
+             * @param [in] count Count of 16-bit words
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Transfer16(const uint16_t* transmitBuffer, uint16_t* receiveBuffer, size_t count);
+
             /**
              * @brief Send data with ignored receive
              * 
@@ -330,6 +553,70 @@ namespace Zhele
              */
             static void WriteAsyncNoIncrement(const void* data, uint16_t size, TransferCallback callback = nullptr);
 
+            /**
+             * @brief Send the same 16-bit value many times async (by DMA) with ignored receive.
+             * 
+             * @details
+             * SPI is switched to 16-bit data size for the operation and previous data size is restored
+             * before callback. Counts above DMA limit (65535) are sent by several chained transfers.
+             * Without DMA channel fill is blocking.
+             * 
+             * @param [in] value Value to send
+             * @param [in] count Count of 16-bit frames
+             * @param [in] callback Fill complete callback (optional parameter)
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void Fill(uint16_t value, size_t count, TransferCallback callback = nullptr);
+
+            /**
+             * @brief Completes async write (it can be called from write callback)
+             * 
+             * @details
+             * DMA transfer is complete when last frame is put to data register, so method waits
+             * until it's shifted out, disables TX DMA request and drops ignored received frames,
+             * so following blocking transfers are synchronized again.
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void EndWrite();
+
+            /**
+             * @brief Returns receive data register address (for DMA transfers set up outside of driver)
+             * 
+             * @returns Data register address
+             */
+            static volatile void* RxDataRegister();
+
+            /**
+             * @brief Returns transmit data register address (for DMA transfers set up outside of driver)
+             * 
+             * @returns Data register address
+             */
+            static volatile void* TxDataRegister();
+
+            /**
+             * @brief Enables (or disables) RX DMA request
+             * 
+             * @param [in] enable Request is enabled
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void EnableRxDma(bool enable = true);
+
+            /**
+             * @brief Enables (or disables) TX DMA request
+             * 
+             * @param [in] enable Request is enabled
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void EnableTxDma(bool enable = true);
+
             /**
              * @brief Read data (via send 0xFF dummy value)
              * 
@@ -349,6 +636,56 @@ namespace Zhele
              *  Nothing
              */
             static void ReadAsync(void* receiveBuffer, size_t bufferSize, TransferCallback callback = nullptr);
+
+            /**
+             * @brief Enable slave stream receive (by circular DMA)
+             * 
+             * @details
+             * SPI should be initialized in slave mode. DMA receives frames into given buffer
+             * in circular mode. Frame boundary is NSS rising edge: configure EXTI for NSS pin
+             * and call SlaveFrameEnd from its IRQ handler. Frame is delivered to callback without
+             * copying. If frame wraps around buffer end, callback is called twice.
+             * 
+             * @par Example
+             * @code
+             *  Spi1::Init(Spi1::Slowest, Spi1::Slave);
+             *  Spi1::EnableSlaveStream(buffer, sizeof(buffer), OnFrame);
+             *  using NssExti = Exti4; // Pa4 is NSS
+             *  NssExti::Init<NssExti::Trigger::Rising, IO::Porta>();
+             *  NssExti::EnableInterrupt();
+             *  ...
+             *  extern "C" void EXTI4_IRQHandler() { NssExti::ClearInterruptFlag(); Spi1::SlaveFrameEnd(); }
+             * @endcode
+             * 
+             * @note Buffer should be larger than the longest frame.
+             * 
+             * @param [out] receiveBuffer Circular buffer
+             * @param [in] bufferSize Circular buffer size (count of frames)
+             * @param [in] callback Frame received callback
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void EnableSlaveStream(void* receiveBuffer, size_t bufferSize, ReceiveCallback callback);
+
+            /**
+             * @brief Disable slave stream receive
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void DisableSlaveStream();
+
+            /**
+             * @brief Complete slave stream frame and deliver it to callback
+             * 
+             * @details
+             * Should be called from EXTI IRQ handler on NSS rising edge.
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void SlaveFrameEnd();
          
 
             /**
@@ -391,7 +728,132 @@ namespace Zhele
              */
             template<typename mosiPin, typename misoPin, typename clockPin, typename ssPin>
             static void SelectPins();
+
+        private:
+            /**
+             * @brief Blocking transfer with current data size
+             * 
+             * @param [in] transmitBuffer Data to transmit (nullptr to send dummy value)
+             * @param [out] receiveBuffer Output buffer (nullptr to ignore received data)
+             * @param [in] count Count of frames
+             * @param [in] wide Frame is 16-bit
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void TransferFrames(const void* transmitBuffer, void* receiveBuffer, size_t count, bool wide);
+
+        #if defined (SPI_CR2_FRXTH)
+            /**
+             * @brief Blocking 8-bit transfer by 16-bit data register accesses (two frames are packed in FIFO)
+             * 
+             * @details
+             * FRXTH is cleared, so RXNE means that two frames are received. Two packed pairs are kept in flight,
+             * so TX FIFO is not empty between frames and RX FIFO (32 bits) never overflows.
+             * Odd last frame is transferred with FRXTH set.
+             * 
+             * @param [in] transmitBuffer Data to transmit (nullptr to send 0xff)
+             * @param [out] receiveBuffer Output buffer (nullptr to ignore received data)
+             * @param [in] count Count of frames
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void TransferPacked(const uint8_t* transmitBuffer, uint8_t* receiveBuffer, size_t count);
+        #endif
+
+            /**
+             * @brief Start next fill chunk
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void FillChunk();
+
+            /**
+             * @brief Fill chunk transfer complete handler
+             * 
+             * @param [in] data Value pointer
+             * @param [in] size Chunk size
+             * @param [in] success Transfer result
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void FillHandler(void* data, unsigned size, bool success);
+
+            /**
+             * @brief Restore data size that was active before fill
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void FillComplete();
+
+            /**
+             * @brief Recalculates divider for new clock frequence
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void ClockChanged();
+
+            /**
+             * @brief DMA RX complete handler with CRC check
+             * 
+             * @param [in] data Buffer
+             * @param [in] size Size
+             * @param [in] success Transfer result
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void CrcTransferComplete(void* data, unsigned size, bool success);
+
+            static uint32_t _maxFrequency;
+            static uint16_t _dummy;
+            static uint16_t _dummyRx;
+            static uint16_t _fillValue;
+            static size_t _fillCount;
+            static volatile size_t _fillRemaining;
+            static uint32_t _fillDataSize;
+            static TransferCallback _fillCallback;
+            static uint8_t* _streamBuffer;
+            static size_t _streamBufferSize;
+            static size_t _streamPosition;
+            static ReceiveCallback _streamCallback;
+            static TransferCallback _crcCallback;
+            static uint32_t _crcErrors;
         };
+
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        uint32_t Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_maxFrequency = 0;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        uint16_t Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_dummy = 0xffff;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        uint16_t Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_dummyRx = 0;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        uint16_t Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_fillValue = 0;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        size_t Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_fillCount = 0;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        volatile size_t Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_fillRemaining = 0;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        uint32_t Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_fillDataSize = 0;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        TransferCallback Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_fillCallback = nullptr;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        uint8_t* Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_streamBuffer = nullptr;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        size_t Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_streamBufferSize = 0;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        size_t Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_streamPosition = 0;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        ReceiveCallback Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_streamCallback = nullptr;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        TransferCallback Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_crcCallback = nullptr;
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        uint32_t Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_crcErrors = 0;
     }
 }
 
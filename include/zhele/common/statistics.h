@@ -0,0 +1,285 @@
+/**
+ * @file
+ * Implements peripheral runtime statistics counters
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_STATISTICS_COMMON_H
+#define ZHELE_STATISTICS_COMMON_H
+
+#include <stdint.h>
+
+namespace Zhele::Statistics
+{
+    /**
+     * @brief Statistics are enabled
+     *
+     * @details
+     * Counters are enabled by ZHELE_STATISTICS macro. Otherwise counters methods are empty
+     * and counters storage is not instantiated, so drivers have no overhead.
+     */
+#if defined (ZHELE_STATISTICS)
+    inline constexpr bool Enabled = true;
+#else
+    inline constexpr bool Enabled = false;
+#endif
+
+    /// USART counters
+    struct UsartCounters
+    {
+        enum Counter : uint8_t
+        {
+            TxBytes, ///< Written bytes (sync and DMA)
+            RxBytes, ///< Read bytes (sync, DMA and circular DMA)
+            Overrun, ///< Overrun errors (seen by GetError)
+            Framing, ///< Framing errors (seen by GetError)
+            Noise, ///< Noise errors (seen by GetError)
+            Parity, ///< Parity errors (seen by GetError)
+            Count
+        };
+        static constexpr const char* Names[Count] = {"tx", "rx", "overrun", "framing", "noise", "parity"};
+    };
+
+    /// I2C counters
+    struct I2cCounters
+    {
+        enum Counter : uint8_t
+        {
+            Nacks, ///< Not acknowledged transfers
+            Timeouts, ///< Timeouts (software deadline and SMBus timeout)
+            BusErrors, ///< Bus errors (misplaced start or stop)
+            ArbitrationLost, ///< Arbitration lost
+            Overruns, ///< Overrun (underrun) errors
+            Count
+        };
+        static constexpr const char* Names[Count] = {"nack", "timeout", "bus_error", "arbitration", "overrun"};
+    };
+
+    /// DMA channel counters
+    struct DmaCounters
+    {
+        enum Counter : uint8_t
+        {
+            Transfers, ///< Started transfers
+            Items, ///< Items of started transfers (bytes for byte-sized transfers)
+            Completed, ///< Transfer complete events
+            Errors, ///< Transfer errors
+            Count
+        };
+        static constexpr const char* Names[Count] = {"transfers", "items", "completed", "errors"};
+    };
+
+    /// SD card counters
+    struct SdCardCounters
+    {
+        enum Counter : uint8_t
+        {
+            BlocksRead, ///< Read blocks
+            BlocksWritten, ///< Written blocks
+            Errors, ///< Failed blocks operations (token, CRC, data response or timeout)
+            BusyPolls, ///< Repeated polls of busy card (or data token)
+            BusyCycles, ///< Cycles spent waiting busy card (blocking wait only)
+            Count
+        };
+        static constexpr const char* Names[Count] = {"read", "written", "errors", "busy_polls", "busy_cycles"};
+    };
+
+    /// USB endpoint counters
+    struct EndpointCounters
+    {
+        enum Counter : uint8_t
+        {
+            InPackets, ///< Packets sent to host
+            OutPackets, ///< Packets received from host
+            Zlps, ///< Zero-length packets sent
+            Naks, ///< Endpoint is set to NAK by firmware (flow control)
+            Count
+        };
+        static constexpr const char* Names[Count] = {"in", "out", "zlp", "nak"};
+    };
+
+    /// CAN counters
+    struct CanCounters
+    {
+        enum Counter : uint8_t
+        {
+            TxFrames, ///< Successfully transmitted frames
+            TxErrors, ///< Aborted transmissions
+            RxFrames, ///< Received frames
+            RxDropped, ///< Received frames dropped because receive queue is full
+            RxOverruns, ///< Hardware FIFO overruns (frames lost by hardware)
+            BusOff, ///< Bus-off events
+            Count
+        };
+        static constexpr const char* Names[Count] = {"tx", "tx_error", "rx", "rx_dropped", "overrun", "bus_off"};
+    };
+
+    /**
+     * @brief Counters group of one peripheral (registry node)
+     */
+    class Group
+    {
+    public:
+        /**
+         * @brief Constructor (registers group)
+         *
+         * @param [in] name Group name
+         * @param [in] names Counters names
+         * @param [in] values Counters values
+         * @param [in] size Counters count
+         */
+        Group(const char* name, const char* const* names, volatile uint32_t* values, unsigned size);
+
+        /**
+         * @brief Returns group name
+         *
+         * @returns Name (counters type signature with peripheral type)
+         */
+        const char* Name() const { return _name; }
+
+        /**
+         * @brief Returns counters count
+         *
+         * @returns Counters count
+         */
+        unsigned Size() const { return _size; }
+
+        /**
+         * @brief Returns counter name
+         *
+         * @param [in] index Counter index
+         *
+         * @returns Name
+         */
+        const char* CounterName(unsigned index) const { return _names[index]; }
+
+        /**
+         * @brief Returns counter value
+         *
+         * @param [in] index Counter index
+         *
+         * @returns Value
+         */
+        uint32_t Value(unsigned index) const { return _values[index]; }
+
+        /**
+         * @brief Returns next registered group
+         *
+         * @returns Next group or nullptr
+         */
+        const Group* Next() const { return _next; }
+
+    private:
+        const char* _name;
+        const char* const* _names;
+        volatile uint32_t* _values;
+        unsigned _size;
+        Group* _next;
+
+        friend const Group* First();
+        friend void Reset();
+        static inline Group* _first = nullptr;
+    };
+
+    /**
+     * @brief Counters of one peripheral
+     *
+     * @details
+     * Counters are plain 32-bit words (they wrap), increment is not atomic: peripheral
+     * is expected to be used from one context. Group is registered on startup
+     * (static initialization) if any counter is used.
+     *
+     * @par Example
+     * @code
+     *  Usart1::Counters::Value(Statistics::UsartCounters::Overrun);
+     * @endcode
+     *
+     * @tparam _Counters Counters description (UsartCounters and so on)
+     * @tparam _Owner Peripheral
+     */
+    template<typename _Counters, typename _Owner>
+    class Counters
+    {
+    public:
+        using Counter = typename _Counters::Counter;
+
+        /**
+         * @brief Adds value to counter
+         *
+         * @param [in] counter Counter
+         * @param [in] value Value
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Add(Counter counter, uint32_t value = 1)
+        {
+            if constexpr (Enabled)
+            {
+                // Group is instantiated (and registered) only if counters are used
+                static_cast<void>(&_group);
+                _values[counter] = _values[counter] + value;
+            }
+        }
+
+        /**
+         * @brief Returns counter value
+         *
+         * @param [in] counter Counter
+         *
+         * @returns Value (0 if statistics are disabled)
+         */
+        static uint32_t Value(Counter counter)
+        {
+            if constexpr (Enabled)
+            {
+                static_cast<void>(&_group);
+                return _values[counter];
+            }
+            else
+                return 0;
+        }
+
+    private:
+        static const char* Name()
+        {
+            return __PRETTY_FUNCTION__;
+        }
+
+        static inline volatile uint32_t _values[_Counters::Count] = {};
+        static inline Group _group{Name(), _Counters::Names, _values, _Counters::Count};
+    };
+
+    /**
+     * @brief Returns first registered group
+     *
+     * @returns Group or nullptr
+     */
+    const Group* First();
+
+    /**
+     * @brief Resets all counters
+     *
+     * @par Returns
+     *  Nothing
+     */
+    void Reset();
+
+    /**
+     * @brief Write text report (one line per peripheral: name, then counters as name=value)
+     *
+     * @tparam _Output Output with Write(const void* data, size_t size) method (Usart, CdcSerial, ItmPort and so on)
+     *
+     * @par Returns
+     *  Nothing
+     */
+    template<typename _Output>
+    void Report();
+}
+
+#include "impl/statistics.h"
+
+#endif //! ZHELE_STATISTICS_COMMON_H
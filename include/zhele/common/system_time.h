@@ -0,0 +1,204 @@
+/**
+ * @file
+ * Implements system time (SysTick) and deadlines
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SYSTEM_TIME_COMMON_H
+#define ZHELE_SYSTEM_TIME_COMMON_H
+
+#include <zhele/clock.h>
+#include <zhele/delay.h>
+
+#include <stdint.h>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements monotonic system time on SysTick
+     *
+     * @details
+     * SysTick interrupt is generated every millisecond (reload value is exact core clock / 1000,
+     * so time doesn't drift), call IrqHandler from SysTick_Handler.
+     * Micros() combines milliseconds count with SysTick counter. It's lock-free and consistent:
+     * it retries if tick was handled during read and accounts pending (not handled yet) tick,
+     * so it can be used with interrupts disabled (for less than 1 ms) and from interrupts.
+     * Millis() wraps in 49 days, Micros() wraps in 71 minutes: compare differences, not values.
+     * Library timeouts (@ref Deadline) are measured by system time after Init.
+     * On Cortex-M0/M0+ @ref CycleCounter uses SysTick counter too, so measured interval must be less than 1 ms.
+     * SysTick is stopped in Stop mode: if low-power timer is set as stop time source (@ref SetStopTimeSource),
+     * Stop time is measured by it and added on wake up (@ref Power::PowerManager does it).
+     *
+     * @par Example
+     * @code
+     *  SystemTime::Init();
+     *  extern "C" void SysTick_Handler() { SystemTime::IrqHandler(); }
+     *  uint32_t start = SystemTime::Micros();
+     *  ...
+     *  uint32_t elapsed = SystemTime::Micros() - start;
+     *  SystemTime::Sleep(100);
+     * @endcode
+     */
+    class SystemTime
+    {
+    public:
+        /**
+         * @brief Starts SysTick with 1 ms period
+         *
+         * @details
+         * Reload value is recalculated on system clock change (see @ref Clock::ClockChange), time is kept.
+         *
+         * @param [in] coreClock Core (AHB) clock frequence
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static inline void Init(uint32_t coreClock = Clock::AhbClock::ClockFreq());
+
+        /**
+         * @brief Returns system time state
+         *
+         * @retval true System time is started
+         * @retval false System time is not started
+         */
+        static inline bool Running();
+
+        /**
+         * @brief Returns milliseconds count since Init
+         *
+         * @returns Milliseconds
+         */
+        static inline uint32_t Millis();
+
+        /**
+         * @brief Returns microseconds count since Init
+         *
+         * @returns Microseconds
+         */
+        static inline uint32_t Micros();
+
+        /**
+         * @brief Sleeps given time
+         *
+         * @details
+         * Core sleeps by WFI until deadline (it's woken by SysTick every millisecond and by other interrupts),
+         * so interrupts are handled and idle power is saved. In interrupt handler (SysTick can't wake core)
+         * and without system time it's busy wait. Coroutines should use @ref Async::Delay instead
+         * (it lets other coroutines run).
+         *
+         * @param [in] milliseconds Time (ms)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static inline void Sleep(uint32_t milliseconds);
+
+        /**
+         * @brief SysTick interrupt handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static inline void IrqHandler();
+
+        /**
+         * @brief Sets low-power timer that measures time in Stop mode
+         *
+         * @details
+         * Timer should be configured (clock source, prescaler) and running with 0xffff period before call.
+         * Timer should wake MCU up more often than its counter wraps (for example, by @ref TimerWheel on this timer).
+         *
+         * @tparam _LpTimer Low-power timer (see @ref Timers::LpTimer1)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _LpTimer>
+        static void SetStopTimeSource();
+
+        /**
+         * @brief Saves time before Stop mode
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static inline void Suspend();
+
+        /**
+         * @brief Adds Stop mode time after wake up
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static inline void Resume();
+
+    private:
+        /**
+         * @brief Recalculates reload value for new clock frequence
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static inline void ClockChanged();
+
+        static inline volatile uint32_t _millis = 0; ///< Milliseconds count
+        static inline bool _running = false; ///< System time is started
+        static inline uint16_t (*_stopCounter)() = nullptr; ///< Reads stop time source counter
+        static inline uint32_t _stopFrequency = 0; ///< Stop time source counter frequence
+        static inline uint16_t _stopStart = 0; ///< Stop time source counter on suspend
+        static inline uint32_t _stopRemainder = 0; ///< Not counted time (in 1 / (1000 * frequence) seconds)
+    };
+
+    /**
+     * @brief Implements timeout
+     *
+     * @details
+     * Deadline is measured by @ref SystemTime if it's started, so timeout doesn't depend on core clock and code speed.
+     * Otherwise Expired calls are counted: deadline expires after given polls count (legacy spin timeout),
+     * so drivers keep working without system time. Maximal timeout is 71 minutes.
+     * Deadline can be checked in interrupt handlers (SysTick can't preempt them): ticks are counted
+     * by checks then, so they should be checked more often than every millisecond.
+     *
+     * @par Example
+     * @code
+     *  Deadline deadline(10, 10000); // 10 ms or 10000 polls without system time
+     *  while (!Ready())
+     *  {
+     *      if (deadline.Expired())
+     *          return false;
+     *  }
+     * @endcode
+     */
+    class Deadline
+    {
+    public:
+        /**
+         * @brief Starts deadline
+         *
+         * @param [in] milliseconds Timeout
+         * @param [in] polls Expired calls count before expiration if system time is not started
+         */
+        inline Deadline(uint32_t milliseconds, uint32_t polls = 0);
+
+        /**
+         * @brief Checks deadline
+         *
+         * @retval true Timeout is expired
+         * @retval false Timeout is not expired
+         */
+        inline bool Expired();
+
+    private:
+        uint32_t _last; ///< Last check time (microseconds)
+        uint32_t _remaining; ///< Remaining time (microseconds)
+        uint32_t _polls; ///< Remaining polls
+        bool _timed; ///< Deadline is measured by system time
+    };
+}
+
+#include "impl/system_time.h"
+
+#endif //! ZHELE_SYSTEM_TIME_COMMON_H
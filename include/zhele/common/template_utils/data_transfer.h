@@ -22,6 +22,10 @@ namespace Zhele
     /// Tagged transfer callback pointer
     using TaggedTransferCallback = std::add_pointer_t<void(void* tag, void* data, unsigned size, bool success)>;
     //using TaggedTransferCallback = std::function<void(void* tag, void* data, unsigned size, bool success)>;
+    /// Double buffered transfer callback pointer (bufferIndex is index of completed buffer: 0 or 1)
+    using DoubleBufferedTransferCallback = std::add_pointer_t<void(void* data, unsigned size, unsigned bufferIndex)>;
+    /// Receive callback pointer (data points to newly received chunk)
+    using ReceiveCallback = std::add_pointer_t<void(const void* data, unsigned size)>;
 }
 
 #endif //!ZHELE_DATATRANSFER_H
\ No newline at end of file
@@ -24,6 +24,15 @@ namespace Zhele::TemplateUtils
         const static unsigned Length = _Length;
         const static unsigned Size = _Length;
         char Text[_Length + 1] = {};
+
+        constexpr fixed_string() = default;
+
+        /// Constructor allows pass string literal as non-type template argument
+        constexpr fixed_string(const char (&str)[_Length + 1])
+        {
+            for (unsigned i = 0; i < _Length; ++i)
+                Text[i] = str[i];
+        }
     };
 
     template <unsigned _Length>
@@ -9,8 +9,10 @@
 #ifndef ZHELE_TYPELIST_H
 #define ZHELE_TYPELIST_H
 
+#include <array>
 #include <concepts>
 #include <type_traits>
+#include <cstddef>
 #include <utility>
 
 namespace Zhele::TemplateUtils
@@ -72,8 +74,33 @@ namespace Zhele::TemplateUtils
     */
     constexpr auto value_unbox(auto t) { return decltype(t)::type::value; }
 
+    namespace Private
+    {
+        /**
+         * @brief Type with its index in list
+        */
+        template<std::size_t Index, typename T>
+        struct IndexedType {};
+
+        /**
+         * @brief Inherits every type with its index, so type is found by overload resolution (without recursion)
+        */
+        template<typename Indexes, typename... Ts>
+        struct TypeIndexer;
+
+        template<std::size_t... Indexes, typename... Ts>
+        struct TypeIndexer<std::index_sequence<Indexes...>, Ts...> : IndexedType<Indexes, Ts>... {};
+
+        template<std::size_t Index, typename T>
+        TypeBox<T> select_type(IndexedType<Index, T>);
+    }
+
     /**
      * @brief Implements type list
+     * 
+     * @details
+     * Algorithms are implemented by fold expressions and index sequences,
+     * so instantiation depth doesn't depend on list size.
     */
     template<typename... Ts>
     class TypeList
@@ -132,10 +159,8 @@ namespace Zhele::TemplateUtils
 
             if constexpr (index < 0)
                 return TypeBox<void>();
-            else if constexpr (index == 0)
-                return head();
             else
-                return tail().template get<index - 1>();
+                return decltype(Private::select_type<index>(Private::TypeIndexer<std::index_sequence_for<Ts...>, Ts...>{})){};
         }
 
         /**
@@ -148,14 +173,13 @@ namespace Zhele::TemplateUtils
         template<typename T>
         static consteval int search()
         {
-            if constexpr (is_empty())
-                return -1;
-            else if constexpr (std::is_same_v<TypeUnbox<head()>, T>)
-                return 0;
-            else
-                return tail().template search<T>() == -1
-                    ? -1
-                    : tail().template search<T>() + 1;
+            constexpr bool matches[] = {std::is_same_v<T, Ts>..., false};
+            for (int i = 0; i < static_cast<int>(size()); ++i)
+            {
+                if (matches[i])
+                    return i;
+            }
+            return -1;
         }
 
         /**
@@ -229,7 +253,12 @@ namespace Zhele::TemplateUtils
          * @retval true Typelist is unique
          * @retval false Typelist does not unique
         */
-        static consteval bool is_unique(auto func) { return is_unique_<Ts...>(func); }
+        static consteval bool is_unique(auto func)
+        {
+            return []<std::size_t... Indexes>(auto func, std::index_sequence<Indexes...> indexes) {
+                return (... && is_unique_from<Indexes>(func, indexes));
+            }(func, std::index_sequence_for<Ts...>());
+        }
 
         /**
          * @brief Check that typelist does not have duplicates
@@ -249,24 +278,31 @@ namespace Zhele::TemplateUtils
         */
         static consteval auto remove_duplicates()
         {
-            if constexpr (is_empty())
-                return TypeList<>{};
-            else if constexpr (size() == 1)
-                return TypeList<Ts...>{};
-            else if constexpr (tail().contains(head()))
-                return TypeList<>{} + tail().remove_duplicates();
-            else
-                return TypeList<TypeUnbox<head()>>{} + tail().remove_duplicates();
+            // Last occurrence of every type is kept
+            return []<std::size_t... Indexes>(std::index_sequence<Indexes...>) {
+                return (TypeList<>{} + ... + std::conditional_t<last_index<Ts>() == Indexes, TypeList<Ts>, TypeList<>>{});
+            }(std::index_sequence_for<Ts...>());
         }
 
         /**
          * @brief Sort typelist by given predicate
          * 
+         * @details
+         * Sort is stable: position of every type is count of types
+         * that precede it by predicate plus count of equal types before it.
+         * Predicate must be strict weak ordering ("<", not "<="), otherwise
+         * positions collide and sort fails by static_assert.
+         * 
+         * @param pred Predicate (pred(a, b) is true if a precedes b)
+         * 
          * @returns Sorted typelist
         */
         static consteval auto sort(auto pred)
         {
-            return insertion_sort<0, 1>(pred);
+            if constexpr (size() < 2)
+                return TypeList<Ts...>{};
+            else
+                return sort_(pred, std::index_sequence_for<Ts...>());
         }
 
         /**
@@ -353,51 +389,121 @@ namespace Zhele::TemplateUtils
         friend class TypeList;
     private:
         /**
-         * @brief Dummy is_unique_ for empty list
+         * @brief Check type is not equal to next types by given predicate
          * 
-         * @par unused
+         * @tparam Index Type index
+         * 
+         * @param func Binary predicate
          * 
-         * @returns Always true
+         * @retval true Next types are not equal to given one
+         * @retval false Given type has equal one after it
         */
-        static consteval bool is_unique_(auto) { return true; }
+        template<std::size_t Index, std::size_t... Indexes>
+        static consteval bool is_unique_from(auto func, std::index_sequence<Indexes...>)
+        {
+            return !((Indexes > Index && func(get<Index>(), TypeBox<Ts>{})) || ...);
+        }
 
         /**
-         * @brief Check typelist is unique by given predicate
+         * @brief Returns index of last occurrence of type
          * 
-         * @tparam T Head
-         * @tparam Us Tail
+         * @tparam T Required type
          * 
-         * @param func Binary predicate
+         * @returns Type index or -1 if type does not present in typelist
+        */
+        template<typename T>
+        static consteval int last_index()
+        {
+            constexpr bool matches[] = {std::is_same_v<T, Ts>..., false};
+            for (int i = static_cast<int>(size()) - 1; i >= 0; --i)
+            {
+                if (matches[i])
+                    return i;
+            }
+            return -1;
+        }
+
+        /**
+         * @brief Returns predicate results of given type with every type
+         * 
+         * @tparam Index Type index
+         * 
+         * @param pred Predicate
          * 
-         * @retval true Typelist is unique by predicate
-         * @retval false Typelist does not unique by predicate
+         * @returns pred(get<Index>(), Ts) for every type
         */
-        template <typename T, typename... Us>
-        static consteval bool is_unique_(auto func)
+        template<std::size_t Index>
+        static consteval auto precedes(auto pred)
         {
-            return !(func(TypeBox<T>{}, TypeBox<Us>{}) || ...) && is_unique_<Us...>(func);
+            return std::array<bool, sizeof...(Ts)>{pred(get<Index>(), TypeBox<Ts>{})...};
         }
 
-        template<auto i, auto j>
-        static consteval auto insertion_sort(auto pred)
+        /**
+         * @brief Calculates sorted positions by predicate matrix
+         * 
+         * @param less less[i][j] is true if i-th type precedes j-th type
+         * 
+         * @returns Position of every type in sorted typelist
+        */
+        static consteval auto sort_positions(const std::array<std::array<bool, sizeof...(Ts)>, sizeof...(Ts)>& less)
         {
-            if constexpr (i == size()) {
-                return TypeList<Ts...>{};
-            } else if constexpr (j == size()) {
-                return insertion_sort<i + 1, i + 2>(pred);
-            } else if constexpr (!pred(get<i>(), get<j>())) {
-                return swap<i, j>().template insertion_sort<i, j + 1>(pred);
-            } else {
-                return insertion_sort<i, j + 1>(pred);
+            std::array<std::size_t, sizeof...(Ts)> positions{};
+            for (std::size_t i = 0; i < sizeof...(Ts); ++i)
+            {
+                for (std::size_t j = 0; j < sizeof...(Ts); ++j)
+                {
+                    if (less[j][i] || (j < i && !less[i][j]))
+                        ++positions[i];
+                }
+            }
+            return positions;
+        }
+
+        /**
+         * @brief Check that positions are permutation (every position is taken once)
+         * 
+         * @param positions Positions of types
+         * 
+         * @returns True if positions are permutation
+        */
+        static consteval bool is_permutation(const std::array<std::size_t, sizeof...(Ts)>& positions)
+        {
+            std::array<bool, sizeof...(Ts)> taken{};
+            for (std::size_t position : positions)
+            {
+                if (position >= sizeof...(Ts) || taken[position])
+                    return false;
+                taken[position] = true;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Calculates sorted order by positions
+         * 
+         * @param positions Positions of types (invalid ones are skipped)
+         * 
+         * @returns Indexes of types in sorted order
+        */
+        static consteval auto sort_order(const std::array<std::size_t, sizeof...(Ts)>& positions)
+        {
+            std::array<std::size_t, sizeof...(Ts)> order{};
+            for (std::size_t i = 0; i < sizeof...(Ts); ++i)
+            {
+                if (positions[i] < sizeof...(Ts))
+                    order[positions[i]] = i;
             }
+            return order;
         }
 
-        template<auto i, auto j>
-        static consteval auto swap()
+        template<std::size_t... Indexes>
+        static consteval auto sort_(auto pred, std::index_sequence<Indexes...>)
         {
-            return []<typename... Us, unsigned... Indexes>(TypeList<Ts...>, std::index_sequence<Indexes...>){
-                return TypeList<TypeUnbox<get<Indexes != i && Indexes != j ? Indexes : Indexes == i ? j : i>()> ...>{};
-            }(TypeList<Ts...>{}, std::make_index_sequence<size()>());
+            constexpr std::array<std::array<bool, sizeof...(Ts)>, sizeof...(Ts)> less = {precedes<Indexes>(pred)...};
+            constexpr auto positions = sort_positions(less);
+            static_assert(is_permutation(positions), "Sort predicate must be strict weak ordering (use '<', not '<=')");
+            constexpr auto order = sort_order(positions);
+            return TypeList<TypeUnbox<get<order[Indexes]>()>...>{};
         }
     };
 
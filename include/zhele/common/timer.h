@@ -10,15 +10,30 @@
 #define ZHELE_TIMER_COMMON_H
 
 #include "macro_utils/enum.h"
+#include "template_utils/data_transfer.h"
 #include "template_utils/type_list.h"
 #include "ioreg.h"
 
+#include <cstddef>
+
 #include <zhele/clock.h>
 #include <zhele/iopins.h>
 #include <zhele/pinlist.h>
 
 namespace Zhele::Timers
 {
+    /**
+     * @brief Statistics of periods between successive captures (in timer ticks)
+     */
+    struct CaptureStatistics
+    {
+        uint32_t count; ///< Periods count
+        uint32_t minPeriod; ///< Min period
+        uint32_t maxPeriod; ///< Max period
+        uint32_t meanPeriod; ///< Mean period
+        uint32_t deviation; ///< Standard deviation of period (jitter)
+    };
+
     namespace Private
     {
         /**
@@ -42,6 +57,7 @@ namespace Zhele::Timers
         public:
             using Prescaler = uint16_t;
             using Counter = uint16_t;
+            static constexpr IRQn_Type IRQNumber = _IRQNumber;
 
             /// All timer`s interrupts
             enum class Interrupt
@@ -172,6 +188,20 @@ namespace Zhele::Timers
              */
             static Counter GetPrescaler();
 
+            /**
+             * @brief Set prescaler for given counter frequence
+             * 
+             * @details
+             * Prescaler is recalculated on system clock change (see @ref Clock::ClockChange),
+             * so counter frequence (and period in time units) is kept. New prescaler is applied
+             * on next update event (like after SetPrescaler).
+             * 
+             * @param [in] frequency Counter frequence
+             * 
+             * @returns Achieved counter frequence
+             */
+            static uint32_t SetCounterFrequency(uint32_t frequency);
+
             /**
              * @brief Set timer`s period (ARR register) value
              * 
@@ -206,6 +236,32 @@ namespace Zhele::Timers
              * (auto-reload preload enable) bit in CR1 register
              */
             static Counter GetPeriod();
+
+            /**
+             * @brief Enable auto-reload preload (ARPE)
+             * 
+             * @details
+             * New period (ARR register value) is applied on next update event.
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnablePeriodPreload();
+
+            /**
+             * @brief Disable auto-reload preload (ARPE)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisablePeriodPreload();
+
+            /**
+             * @brief Returns period (ARR) register address (for DMA)
+             * 
+             * @returns Register address
+             */
+            static volatile void* PeriodRegister();
            
             /**
              * @brief Enable one-pulse mode
@@ -320,8 +376,22 @@ namespace Zhele::Timers
              * Nothing
              */
             static void DmaRequestDisable();
+
+        private:
+            /**
+             * @brief Recalculates prescaler for new clock frequence
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void ClockChanged();
+
+            static uint32_t _counterFrequency;
         };
 
+        template<typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber>
+        uint32_t BaseTimer<_Regs, _ClockEnReg, _IRQNumber>::_counterFrequency = 0;
+
         /**
          * @brief Class implements STM32 General-Purpose timer`s functional.
          * 
@@ -388,6 +458,14 @@ namespace Zhele::Timers
                  */
                 static void ClearInterruptFlag();
 
+                /**
+                 * @brief Generate capture/compare event by software (sets interrupt flag)
+                 * 
+                 * @par Returns
+                 * 	Nothing
+                 */
+                static void GenerateEvent();
+
                 /**
                  * @brief Enable DMA request for channel
                  * 
@@ -422,6 +500,62 @@ namespace Zhele::Timers
             };
 
         public:
+            /// Registers for DMA burst (DCR.DBA values)
+            enum class BurstRegister : uint8_t
+            {
+                Cr1 = offsetof(TIM_TypeDef, CR1) / 4, ///< CR1
+                Cr2 = offsetof(TIM_TypeDef, CR2) / 4, ///< CR2
+                Smcr = offsetof(TIM_TypeDef, SMCR) / 4, ///< SMCR
+                Dier = offsetof(TIM_TypeDef, DIER) / 4, ///< DIER
+                Sr = offsetof(TIM_TypeDef, SR) / 4, ///< SR
+                Egr = offsetof(TIM_TypeDef, EGR) / 4, ///< EGR
+                Ccmr1 = offsetof(TIM_TypeDef, CCMR1) / 4, ///< CCMR1
+                Ccmr2 = offsetof(TIM_TypeDef, CCMR2) / 4, ///< CCMR2
+                Ccer = offsetof(TIM_TypeDef, CCER) / 4, ///< CCER
+                Cnt = offsetof(TIM_TypeDef, CNT) / 4, ///< CNT
+                Psc = offsetof(TIM_TypeDef, PSC) / 4, ///< PSC
+                Arr = offsetof(TIM_TypeDef, ARR) / 4, ///< ARR
+                Rcr = offsetof(TIM_TypeDef, RCR) / 4, ///< RCR
+                Ccr1 = offsetof(TIM_TypeDef, CCR1) / 4, ///< CCR1
+                Ccr2 = offsetof(TIM_TypeDef, CCR2) / 4, ///< CCR2
+                Ccr3 = offsetof(TIM_TypeDef, CCR3) / 4, ///< CCR3
+                Ccr4 = offsetof(TIM_TypeDef, CCR4) / 4, ///< CCR4
+            };
+
+            /**
+             * @brief Start DMA burst: every update event writes several consecutive registers
+             * 
+             * @details
+             * Buffer contains regCount values per update (for example, CCR1..CCR4 for 4-channel pattern),
+             * DMA writes them through DMAR without CPU.
+             * 
+             * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+             * 
+             * @param [in] firstReg First register
+             * @param [in] regCount Registers count per update (1..18)
+             * @param [in] buffer Values (regCount * updates elements)
+             * @param [in] updates Updates count
+             * @param [in] callback Transfer complete callback
+             * @param [in] circular Repeat buffer endlessly
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<typename _DmaChannel>
+            static void StartDmaBurst(BurstRegister firstReg, uint8_t regCount, const typename Base::Counter* buffer, uint16_t updates,
+                                    TransferCallback callback = nullptr, bool circular = false);
+
+            /**
+             * @brief Stop DMA burst
+             * 
+             * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<typename _DmaChannel>
+            static void StopDmaBurst();
+
             class SlaveMode
             {
             public:
@@ -532,6 +666,40 @@ namespace Zhele::Timers
                  *  Nothing
                  */
                 static void SetTriggerPrescaler(ExternalTriggerPrescaler prescaler);
+
+                /**
+                 * @brief Select external trigger (ETR) digital filter
+                 * 
+                 * @param filter Filter value
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetTriggerFilter(ExternalTriggerFilter filter);
+
+                /**
+                 * @brief Select external trigger (ETR) polarity
+                 * 
+                 * @param polarity Polarity (inverted - falling edges / low level)
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetTriggerPolarity(ExternalTriggerPolarity polarity);
+
+                /**
+                 * @brief Enable or disable external clock mode 2 (counter is clocked by ETR)
+                 * 
+                 * @details
+                 * Unlike external clock mode 1 it doesn't use slave mode controller,
+                 * so it may be combined with reset, gated or trigger mode.
+                 * 
+                 * @param mode Mode
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetExternalClockMode2(ExternalClockMode2 mode);
             };
 
             /**
@@ -583,6 +751,20 @@ namespace Zhele::Timers
                  */
                 static void SetCaptureMode(CaptureMode mode);
 
+                /**
+                 * @brief Set input digital filter
+                 * 
+                 * @details
+                 * Input filter has the same encoding as external trigger filter.
+                 * Call it after @ref SetCaptureMode (capture mode resets filter).
+                 * 
+                 * @param [in] filter Filter value
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetFilter(typename SlaveMode::ExternalTriggerFilter filter);
+
                 /**
                  * @brief Get the Value object
                  * 
@@ -590,6 +772,47 @@ namespace Zhele::Timers
                  */
                 static typename Base::Counter GetValue();
 
+                /**
+                 * @brief Start copying successive captured values to buffer by DMA
+                 * 
+                 * @tparam _DmaChannel DMA channel (stream) connected to channel capture request
+                 * 
+                 * @param [out] buffer Buffer for captured values
+                 * @param [in] count Values count
+                 * @param [in] callback Transfer complete callback
+                 * @param [in] circular Overwrite buffer endlessly
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                template<typename _DmaChannel>
+                static void StartCaptureStream(typename Base::Counter* buffer, uint16_t count, TransferCallback callback = nullptr, bool circular = false);
+
+                /**
+                 * @brief Stop capture stream
+                 * 
+                 * @tparam _DmaChannel DMA channel (stream) connected to channel capture request
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                template<typename _DmaChannel>
+                static void StopCaptureStream();
+
+                /**
+                 * @brief Calculates period statistics of captured values
+                 * 
+                 * @details
+                 * Counter overflow between successive captures is handled if period is less than timer period.
+                 * 
+                 * @param [in] buffer Captured values
+                 * @param [in] count Values count
+                 * @param [in] timerPeriod Timer period (auto-reload value + 1)
+                 * 
+                 * @returns Statistics
+                 */
+                static CaptureStatistics CalculateStatistics(const typename Base::Counter* buffer, uint16_t count, uint32_t timerPeriod = 0x10000);
+
                 /**
                  * @brief Select channel pin
                  * 
@@ -620,6 +843,183 @@ namespace Zhele::Timers
                 static void SelectPins();
             };
 
+            /**
+             * @brief Internal class for PWM input feature (frequency and duty of one input)
+             * 
+             * @details
+             * Channel input (TI1 or TI2) is captured by both channels: by own channel on active edge
+             * and by the other channel (cross-capture) on inactive edge. Active edge also resets counter (slave reset mode),
+             * so own channel holds period and the other one holds pulse, both are updated by hardware without interrupts.
+             * Update event is generated by counter overflow only, so it signals that period is longer than timer period (signal is lost).
+             * Successive samples could be logged by DMA burst (see @ref StartStream).
+             * 
+             * @par Example
+             * @code
+             *  using Input = Timer3::PwmInput<0>;
+             *  Timer3::Enable();
+             *  Timer3::SetPrescaler(71); // 1 us tick
+             *  Timer3::SetPeriod(0xffff);
+             *  Input::SelectPins<IO::Pa6>();
+             *  Input::Enable();
+             *  Timer3::Start();
+             *  uint32_t period = Input::GetPeriod();
+             *  uint16_t duty = Input::GetDuty();
+             * @endcode
+             * 
+             * @tparam _ChannelNumber Channel number (0 for TI1, 1 for TI2)
+             */
+            template<unsigned _ChannelNumber>
+            class PwmInput
+            {
+                static_assert(_ChannelNumber < 2, "Only TI1 and TI2 inputs support PWM input mode");
+                using PeriodChannel = InputCapture<_ChannelNumber>;
+                using PulseChannel = InputCapture<1 - _ChannelNumber>;
+            public:
+                using Pins = typename PeriodChannel::Pins;
+                using PinsAltFuncNumber = typename PeriodChannel::PinsAltFuncNumber;
+
+                /// Index of period in stream sample (CCR1, CCR2 pair)
+                static constexpr unsigned PeriodIndex = _ChannelNumber;
+
+                /// Index of pulse in stream sample (CCR1, CCR2 pair)
+                static constexpr unsigned PulseIndex = 1 - _ChannelNumber;
+
+                /// Signal polarity
+                enum class Polarity
+                {
+                    ActiveHigh, ///< Period starts at rising edge, pulse is high level
+                    ActiveLow, ///< Period starts at falling edge, pulse is low level
+                };
+
+                /**
+                 * @brief Configure channels and slave reset mode, enable capture
+                 * 
+                 * @param [in] polarity Signal polarity
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void Enable(Polarity polarity = Polarity::ActiveHigh);
+
+                /**
+                 * @brief Disable capture and slave mode
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void Disable();
+
+                /**
+                 * @brief Returns state of measurement
+                 * 
+                 * @retval true New period has been captured since the last GetPeriod call
+                 * @retval false No new period
+                 */
+                static bool IsReady();
+
+                /**
+                 * @brief Returns state of signal
+                 * 
+                 * @details
+                 * Flag is cleared by ClearInterruptFlag.
+                 * 
+                 * @retval true Counter has overflowed (period is longer than timer period or there is no signal)
+                 * @retval false Period fits timer period
+                 */
+                static bool IsOverflow();
+
+                /**
+                 * @brief Returns the last period
+                 * 
+                 * @returns Period (timer ticks)
+                 */
+                static uint32_t GetPeriod();
+
+                /**
+                 * @brief Returns the last pulse
+                 * 
+                 * @returns Pulse (timer ticks)
+                 */
+                static uint32_t GetPulse();
+
+                /**
+                 * @brief Returns the last duty cycle
+                 * 
+                 * @returns Duty cycle (Q15, 32768 is 100%)
+                 */
+                static uint16_t GetDuty();
+
+                /**
+                 * @brief Calculates duty cycle of captured values
+                 * 
+                 * @param [in] period Captured period (CCR value)
+                 * @param [in] pulse Captured pulse (CCR value)
+                 * 
+                 * @returns Duty cycle (Q15, 32768 is 100%)
+                 */
+                static uint16_t CalculateDuty(typename Base::Counter period, typename Base::Counter pulse);
+
+                /**
+                 * @brief Start logging of successive samples by DMA burst
+                 * 
+                 * @details
+                 * Every period DMA reads CCR1 and CCR2 (period is at PeriodIndex, pulse is at PulseIndex).
+                 * Captured values are one tick less than period and pulse.
+                 * 
+                 * @tparam _DmaChannel DMA channel (stream) connected to period channel capture request
+                 * 
+                 * @param [out] buffer Buffer (2 * count values)
+                 * @param [in] count Samples count
+                 * @param [in] callback Transfer complete callback
+                 * @param [in] circular Overwrite buffer endlessly
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                template<typename _DmaChannel>
+                static void StartStream(typename Base::Counter* buffer, uint16_t count, TransferCallback callback = nullptr, bool circular = false);
+
+                /**
+                 * @brief Stop samples logging
+                 * 
+                 * @tparam _DmaChannel DMA channel (stream) connected to period channel capture request
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                template<typename _DmaChannel>
+                static void StopStream();
+
+                /**
+                 * @brief Select input pin
+                 * 
+                 * @param [in] pinNumber Pin number
+                 * 
+                 * @par Returns
+                 * 	Nothing
+                 */
+                static void SelectPins(int pinNumber);
+
+                /**
+                 * @brief Select input pin by number (template method)
+                 * 
+                 * @tparam PinNumber Pin number
+                 */
+                template<unsigned PinNumber>
+                static void SelectPins();
+
+                /**
+                 * @brief Select input pin (template method)
+                 * 
+                 * @tparam Pin Pin class
+                 * 
+                 * @par Returns
+                 * 	Nothing
+                 */
+                template<typename Pin>
+                static void SelectPins();
+            };
+
             /**
              * @brief Internal class for output compare feature
              * 
@@ -669,6 +1069,29 @@ namespace Zhele::Timers
                  * @returns Pulse value
                  */
                 static typename Base::Counter GetPulse();                
+
+                /**
+                 * @brief Returns pulse (CCR) register address (for DMA)
+                 * 
+                 * @returns Register address
+                 */
+                static volatile void* PulseRegister();
+
+                /**
+                 * @brief Enable pulse preload (new pulse is applied on update event)
+                 * 
+                 * @par Returns
+                 * 	Nothing
+                 */
+                static void EnablePreload();
+
+                /**
+                 * @brief Disable pulse preload
+                 * 
+                 * @par Returns
+                 * 	Nothing
+                 */
+                static void DisablePreload();
             
                 /**
                  * @brief Set output polarity
@@ -782,22 +1205,84 @@ namespace Zhele::Timers
             };
         };
         
+        /**
+         * @brief Encodes dead time (BDTR.DTG)
+         * 
+         * @param [in] ticks Dead time in dead-time clock (tDTS) ticks
+         * 
+         * @returns DTG value (dead time is not less than given), -1 if dead time is too long
+         */
+        constexpr int EncodeDeadTime(uint64_t ticks)
+        {
+            if (ticks <= 127)
+                return static_cast<int>(ticks);
+            if (ticks <= 254)
+                return 0x80 | static_cast<int>((ticks + 1) / 2 - 64);
+            if (ticks <= 504)
+                return 0xc0 | static_cast<int>((ticks + 7) / 8 - 32);
+            if (ticks <= 1008)
+                return 0xe0 | static_cast<int>((ticks + 15) / 16 - 32);
+            return -1;
+        }
+
         /**
          * @brief Class implements STM32 advanced timer`s functional.
          * 
+         * @details
+         * Advanced timer adds complementary outputs with dead time, break (fault) input and
+         * main output enable (MOE) to general-purpose timer. Three-phase bridge is driven by
+         * three @ref ComplementaryPwm channels with center-aligned counter (see @ref InitCenterAligned):
+         * new pulses are written to preload registers and applied together on update event,
+         * either by CPU (see @ref SetSpaceVector) or by DMA burst (see @ref StartPhaseStream).
+         * 
+         * @par Example
+         * @code
+         *  // 20 kHz center-aligned PWM, 72 MHz timer clock, 500 ns dead time
+         *  Timer1::Enable();
+         *  Timer1::InitCenterAligned(72000000 / 20000 / 2);
+         *  Timer1::SetDeadTime<72000000, 500>();
+         *  Timer1::ComplementaryPwm<0>::SetOutputMode(Timer1::ComplementaryPwm<0>::PWM1);
+         *  Timer1::ComplementaryPwm<0>::EnableComplementary();
+         *  Timer1::EnableBreak(Timer1::BreakPolarity::ActiveLow);
+         *  Timer1::Start();
+         *  Timer1::SetSpaceVector(alpha, beta);
+         * @endcode
+         * 
          * @tparam _Regs Timer`s register wrapper
          * @tparam _ClockEnReg Timer`s clock
          * @tparam _IRQNumber Timer`s IRQ number
          * @tparam _ChPins Channel`s pins
-         * 
-         * @todo Implements this class!
+         * @tparam _ChNPins Complementary channel`s pins
+         * @tparam _BreakPins Break input pins
          */
-        template<typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins>
+        template<typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins, template<unsigned> typename _ChNPins, typename _BreakPins>
         class AdvancedTimer : public GPTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins>
         {
             using Base = GPTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins>;
+            using Counter = typename Base::Counter;
+
+            static void WriteBreakAndDeadTime(uint32_t mask, uint32_t value);
 
         public:
+            /// Break input polarity
+            enum class BreakPolarity : uint16_t
+            {
+                ActiveLow = 0x0000U, ///< Break on low level
+                ActiveHigh = TIM_BDTR_BKP, ///< Break on high level
+            };
+
+            /// Write protection of break and dead-time configuration (till reset)
+            enum class LockLevel : uint16_t
+            {
+                Off = 0x0 << TIM_BDTR_LOCK_Pos, ///< No protection
+                Level1 = 0x1 << TIM_BDTR_LOCK_Pos, ///< Dead time, break and idle states are locked
+                Level2 = 0x2 << TIM_BDTR_LOCK_Pos, ///< Level 1 and polarities, off-states are locked
+                Level3 = 0x3 << TIM_BDTR_LOCK_Pos, ///< Level 2 and output modes are locked
+            };
+
+            /// Break input pins
+            using BreakPins = typename _BreakPins::Key;
+
             /**
              * @brief Set repetition counter (RCR reister)
              * 
@@ -814,6 +1299,276 @@ namespace Zhele::Timers
              * @returns Current RCR register value
              */
             static uint8_t GetRepetitionCounter();
+
+            /**
+             * @brief Set dead time of complementary outputs
+             * 
+             * @details
+             * DTG value and dead-time clock divider (CR1.CKD) are calculated at compile time,
+             * dead time is not less than requested. Compilation fails if dead time is too long.
+             * Dead time is locked by @ref Lock level 1.
+             * 
+             * @tparam _TimerClockFreq Timer clock frequency
+             * @tparam _Nanoseconds Dead time (ns)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<unsigned long _TimerClockFreq, unsigned _Nanoseconds>
+            static void SetDeadTime();
+
+            /**
+             * @brief Enable break input
+             * 
+             * @details
+             * Active break level clears MOE asynchronously (without clock), so outputs go to idle state
+             * (see @ref ComplementaryPwm::SetIdleState). Break interrupt (Interrupt::Break) is handled by BRK IRQ.
+             * 
+             * @param [in] polarity Break active level
+             * @param [in] automaticOutput Set MOE on the next update event after break is released
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableBreak(BreakPolarity polarity, bool automaticOutput = false);
+
+            /**
+             * @brief Disable break input
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableBreak();
+
+            /**
+             * @brief Select break input pin
+             * 
+             * @tparam _Pin Pin class
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<typename _Pin>
+            static void SelectBreakPins();
+
+            /**
+             * @brief Check that break has occured
+             * 
+             * @retval true Break flag is set
+             * @retval false No break
+             */
+            static bool IsBreak();
+
+            /**
+             * @brief Clear break flag
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void ClearBreakFlag();
+
+            /**
+             * @brief Select off-state of enabled outputs
+             * 
+             * @param [in] runMode Outputs drive inactive level instead of high impedance when MOE is set (OSSR)
+             * @param [in] idleMode Outputs drive idle level instead of high impedance when MOE is clear (OSSI)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SetOffState(bool runMode, bool idleMode);
+
+            /**
+             * @brief Enable main output (set MOE)
+             * 
+             * @details
+             * Call it after break to resume outputs (if automatic output is disabled).
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableOutputs();
+
+            /**
+             * @brief Disable main output (clear MOE), outputs go to idle state
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableOutputs();
+
+            /**
+             * @brief Check main output
+             * 
+             * @retval true Outputs are enabled
+             * @retval false Outputs are disabled (by software or break)
+             */
+            static bool IsOutputsEnabled();
+
+            /**
+             * @brief Lock break and dead-time configuration (can be written once after reset)
+             * 
+             * @param [in] level Lock level
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Lock(LockLevel level);
+
+            /**
+             * @brief Init center-aligned counter for bridge PWM
+             * 
+             * @details
+             * Counter counts up to period and down to zero, so PWM frequency is timer clock / (2 * period).
+             * Period and pulses preload is enabled and repetition counter is 1, so update event (new pulses and DMA request)
+             * occurs once per PWM period at counter underflow (pulses center of high-side switches in PWM1 mode).
+             * 
+             * @param [in] period Period (ARR)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void InitCenterAligned(Counter period);
+
+            /**
+             * @brief Calculates space vector PWM pulses
+             * 
+             * @details
+             * Phase voltages of vector (alpha, beta) are shifted by min-max zero sequence, that is
+             * equivalent to symmetrical SVPWM. Modulation is linear for vector magnitude up to 1/sqrt(3) (18919 in Q15),
+             * longer vectors are clipped.
+             * 
+             * @param [in] alpha Alpha voltage (Q15 fraction of DC bus voltage)
+             * @param [in] beta Beta voltage (Q15 fraction of DC bus voltage)
+             * @param [in] period Period (ARR)
+             * @param [out] pulses Pulses of phases A, B, C (CCR1..CCR3)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SpaceVectorPulses(int16_t alpha, int16_t beta, Counter period, Counter* pulses);
+
+            /**
+             * @brief Write space vector PWM pulses of channels 1..3 (applied on the next update event)
+             * 
+             * @param [in] alpha Alpha voltage (Q15 fraction of DC bus voltage)
+             * @param [in] beta Beta voltage (Q15 fraction of DC bus voltage)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SetSpaceVector(int16_t alpha, int16_t beta);
+
+            /**
+             * @brief Start writing pulses of channels 1..3 by DMA burst on every update event
+             * 
+             * @details
+             * Every update DMA writes three values (CCR1, CCR2, CCR3) to preload registers, so all phases
+             * change at the same update event without CPU. Circular buffer of two updates with transfer complete and half-transfer
+             * (see DmaChannel::SetHalfTransferCallback) callbacks lets control loop fill one half while the other one is written.
+             * 
+             * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+             * 
+             * @param [in] pulses Pulses (3 * updates values)
+             * @param [in] updates Updates count
+             * @param [in] callback Transfer callback
+             * @param [in] circular Repeat buffer endlessly
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<typename _DmaChannel>
+            static void StartPhaseStream(const Counter* pulses, uint16_t updates, TransferCallback callback = nullptr, bool circular = true);
+
+            /**
+             * @brief Stop pulses DMA burst
+             * 
+             * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<typename _DmaChannel>
+            static void StopPhaseStream();
+
+            /**
+             * @brief Internal class for PWM with complementary output
+             * 
+             * @tparam _ChannelNumber Channel number (0..2)
+             */
+            template<unsigned _ChannelNumber>
+            class ComplementaryPwm : public Base::template PWMGeneration<_ChannelNumber>
+            {
+                static_assert(_ChannelNumber < 3, "Only channels 1..3 have complementary outputs");
+                using Channel = typename Base::template PWMGeneration<_ChannelNumber>;
+            public:
+                using ComplementaryPins = typename _ChNPins<_ChannelNumber>::Pins::Key;
+                using ComplementaryPinsAltFuncNumber = typename _ChNPins<_ChannelNumber>::Pins::Value;
+
+                /**
+                 * @brief Enable complementary output (CCxNE)
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void EnableComplementary();
+
+                /**
+                 * @brief Disable complementary output
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void DisableComplementary();
+
+                /**
+                 * @brief Set complementary output polarity
+                 * 
+                 * @param [in] polarity Output polarity
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetComplementaryPolarity(typename Channel::OutputPolarity polarity);
+
+                /**
+                 * @brief Set output levels when main output is disabled (after dead time)
+                 * 
+                 * @param [in] output Output idle level (OISx)
+                 * @param [in] complementary Complementary output idle level (OISxN)
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetIdleState(bool output, bool complementary);
+
+                /**
+                 * @brief Select complementary output pin
+                 * 
+                 * @tparam _Pin Pin class
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                template<typename _Pin>
+                static void SelectComplementaryPins();
+            };
+        };
+
+        /**
+         * @brief Internal trigger (ITRx) of slave timer connected to master timer TRGO
+         * 
+         * @details
+         * Connection table differs between families (see reference manual),
+         * so every family specializes it for supported pairs.
+         * 
+         * @tparam _Master Master timer
+         * @tparam _Slave Slave timer
+         */
+        template<typename _Master, typename _Slave>
+        struct TimerInternalTrigger
+        {
+            static const int Value = -1;
         };
     }
 }
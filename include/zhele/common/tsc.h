@@ -0,0 +1,276 @@
+/**
+ * @file
+ * Implements touch sensing controller (TSC)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TSC_COMMON_H
+#define ZHELE_TSC_COMMON_H
+
+#include "macro_utils/enum.h"
+#include "ioreg.h"
+
+#include <zhele/clock.h>
+#include <zhele/iopins.h>
+#include <zhele/pinlist.h>
+
+#include <stdint.h>
+
+namespace Zhele
+{
+    namespace Private
+    {
+        /**
+         * @brief Implements touch sensing controller
+         *
+         * @details
+         * TSC measures electrode capacitance by charge transfer: electrode (channel IO) charge is transferred
+         * to sampling capacitor (sampling IO of the same group) until it reaches threshold, transfers count
+         * is acquisition result. Touch increases electrode capacitance, so count decreases.
+         * Every group (4 IOs) has its own counter, groups are acquired in parallel: one acquisition
+         * measures one channel of every enabled group without CPU.
+         *
+         * IO bit in IOCCR/IOSCR/IOGCSR registers has the same index as IO pin in @p _Pins
+         * (group * 4 + IO number in group), so channels set is bit mask (see @ref IoMask).
+         *
+         * When TSC is idle, IOs are driven low (Cs and electrodes are discharged), so there should be
+         * discharge pause (about 1 ms for typical Cs) between acquisitions.
+         *
+         * @par Example
+         * @code
+         *  Tsc::Init();
+         *  Tsc::SelectSamplingPins<IO::Pa3, IO::Pa7>();
+         *  Tsc::SelectChannelPins<IO::Pa0, IO::Pa4>();
+         *  Tsc::SetChannels(Tsc::IoMask<IO::Pa0> | Tsc::IoMask<IO::Pa4>);
+         *  Tsc::StartAcquisition();
+         *  while (!Tsc::IsAcquisitionComplete()) continue;
+         *  uint16_t count = Tsc::GetGroupCount(Tsc::GroupOf<IO::Pa0>);
+         * @endcode
+         *
+         * @tparam _Regs Registers
+         * @tparam _ClockCtrl Clock
+         * @tparam _IRQNumber IRQ number
+         * @tparam _Pins All group IOs (group 1 IO 1, group 1 IO 2, ..., group 8 IO 4)
+         * @tparam _AltFunc TSC alternate function number
+         */
+        template<typename _Regs, typename _ClockCtrl, IRQn_Type _IRQNumber, typename _Pins, uint8_t _AltFunc>
+        class Tsc
+        {
+            static_assert(_Pins::Length == 32, "TSC has 8 groups of 4 IOs");
+        public:
+            static constexpr IRQn_Type IRQNumber = _IRQNumber;
+
+            /// Groups count
+            static const unsigned Groups = 8;
+
+            /**
+             * @brief Pulse generator clock prescaler (AHB clock divider)
+             */
+            enum class Prescaler : uint8_t
+            {
+                Div1 = 0,
+                Div2 = 1,
+                Div4 = 2,
+                Div8 = 3,
+                Div16 = 4,
+                Div32 = 5,
+                Div64 = 6,
+                Div128 = 7,
+            };
+
+            /**
+             * @brief Max transfers count (acquisition is failed if it's reached)
+             */
+            enum class MaxCount : uint8_t
+            {
+                Count255 = 0,
+                Count511 = 1,
+                Count1023 = 2,
+                Count2047 = 3,
+                Count4095 = 4,
+                Count8191 = 5,
+                Count16383 = 6,
+            };
+
+            /**
+             * @brief Interrupts (status flags have the same positions)
+             */
+            enum class Interrupt : uint32_t
+            {
+                EndOfAcquisition = TSC_IER_EOAIE, ///< Acquisition is completed
+                MaxCountError = TSC_IER_MCEIE, ///< Max count is reached in some group
+            };
+            DECLARE_ENUM_OPERATIONS_IN_CLASS(Interrupt)
+
+            /**
+             * @brief Returns IO mask of pin
+             *
+             * @tparam _Pin TSC pin
+             */
+            template<typename _Pin>
+            static constexpr uint32_t IoMask = 1ul << _Pins::template IndexOf<_Pin>;
+
+            /**
+             * @brief Returns group (zero-based) of pin
+             *
+             * @tparam _Pin TSC pin
+             */
+            template<typename _Pin>
+            static constexpr unsigned GroupOf = static_cast<unsigned>(_Pins::template IndexOf<_Pin>) / 4;
+
+            /**
+             * @brief Enables TSC and sets charge transfer timings
+             *
+             * @details
+             * Charge transfer pulse high and low phases last @p pulseLength pulse generator clock periods.
+             * For large electrodes pulse should be longer than electrode RC constant.
+             *
+             * @param [in] prescaler Pulse generator clock prescaler
+             * @param [in] pulseLength Charge transfer pulse phase length, from 1 to 16 cycles
+             * @param [in] maxCount Max transfers count
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Init(Prescaler prescaler = Prescaler::Div4, uint8_t pulseLength = 2, MaxCount maxCount = MaxCount::Count8191);
+
+            /**
+             * @brief Disables TSC
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Disable();
+
+            /**
+             * @brief Configures sampling capacitor IOs (one per used group)
+             *
+             * @tparam _SamplingPins Sampling pins
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<typename... _SamplingPins>
+            static void SelectSamplingPins();
+
+            /**
+             * @brief Configures channel (electrode) IOs
+             *
+             * @details
+             * Method doesn't enable channels for acquisition (see @ref SetChannels).
+             *
+             * @tparam _ChannelPins Channel pins
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<typename... _ChannelPins>
+            static void SelectChannelPins();
+
+            /**
+             * @brief Selects channels of next acquisition and enables their groups
+             *
+             * @param [in] channels Channels mask (no more than one channel per group)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void SetChannels(uint32_t channels);
+
+            /**
+             * @brief Starts acquisition of selected channels
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void StartAcquisition();
+
+            /**
+             * @brief Checks acquisition is completed (or failed)
+             *
+             * @retval true Acquisition is completed
+             * @retval false Acquisition is in progress
+             */
+            static bool IsAcquisitionComplete();
+
+            /**
+             * @brief Checks group acquisition is completed successfully
+             *
+             * @param [in] group Group (zero-based)
+             *
+             * @retval true Group count is valid
+             * @retval false Group acquisition is not completed (max count error)
+             */
+            static bool IsGroupComplete(unsigned group);
+
+            /**
+             * @brief Returns group transfers count
+             *
+             * @param [in] group Group (zero-based)
+             *
+             * @returns Transfers count
+             */
+            static uint16_t GetGroupCount(unsigned group);
+
+            /**
+             * @brief Enables interrupts
+             *
+             * @param [in] interrupts Interrupts
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableInterrupt(Interrupt interrupts = Interrupt::EndOfAcquisition | Interrupt::MaxCountError);
+
+            /**
+             * @brief Disables interrupts
+             *
+             * @param [in] interrupts Interrupts
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableInterrupt(Interrupt interrupts = Interrupt::EndOfAcquisition | Interrupt::MaxCountError);
+
+            /**
+             * @brief Checks interrupt flags
+             *
+             * @param [in] interrupts Interrupts
+             *
+             * @retval true Some flag is set
+             * @retval false Flags are clear
+             */
+            static bool IsInterrupt(Interrupt interrupts);
+
+            /**
+             * @brief Clears interrupt flags
+             *
+             * @param [in] interrupts Interrupts
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void ClearInterruptFlag(Interrupt interrupts = Interrupt::EndOfAcquisition | Interrupt::MaxCountError);
+
+        private:
+            /**
+             * @brief Configures TSC pin
+             *
+             * @tparam _Pin Pin
+             * @tparam _Driver Output driver type
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<typename _Pin, auto _Driver>
+            static void SelectPin();
+        };
+    }
+}
+
+#include "impl/tsc.h"
+
+#endif //! ZHELE_TSC_COMMON_H
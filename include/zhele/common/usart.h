@@ -12,12 +12,18 @@
 
 #include "./template_utils/data_transfer.h"
 #include "ioreg.h"
+#include "statistics.h"
 
 #include <zhele/clock.h>
 #include <zhele/dma.h>
 #include <zhele/iopins.h>
 #include <zhele/pinlist.h>
 
+#include <initializer_list>
+#include <stdint.h>
+#include <span>
+#include <type_traits>
+
 
 namespace Zhele
 {
@@ -150,6 +156,10 @@ namespace Zhele
             ReceiveTimeout = USART_ISR_RTOF,
         #endif
 
+        #if defined (USART_CR3_WUFIE)
+            WakeUpInt = USART_ISR_WUF, ///< Wake up from Stop mode
+        #endif
+
             AllInterrupts  =  ParityErrorInt | TxEmptyInt | TxCompleteInt | RxNotEmptyInt | IdleInt | LineBreakInt | ErrorInt | CtsInt
         #if defined (USART_CR1_FIFOEN)
              | RxFifoFull | TxFifoEmpty | RxFifoThreshold | TxFifoThreshold
@@ -157,6 +167,9 @@ namespace Zhele
         #if defined (USART_CR2_RTOEN)
             | ReceiveTimeout
         #endif
+        #if defined (USART_CR3_WUFIE)
+            | WakeUpInt
+        #endif
         };
 
         enum Error
@@ -176,15 +189,165 @@ namespace Zhele
         #endif
         };
 
+    #if defined (USART_CR2_ABREN)
+        /**
+         * @brief Auto baud rate detection mode
+         */
+        enum class AutoBaudMode : uint8_t
+        {
+            StartBit = 0, ///< Measurement of the start bit
+            FallingEdge = 1, ///< Falling edge to falling edge measurement
+            Frame0x7F = 2, ///< 0x7F frame detection
+            Frame0x55 = 3, ///< 0x55 frame detection
+        };
+    #endif
+
+        /**
+         * @brief Mute mode wakeup method (multiprocessor communication)
+         */
+        enum class MuteWakeup : uint8_t
+        {
+            IdleLine = 0, ///< Receiver is woken up by idle line
+            AddressMark = 1, ///< Receiver is woken up by address byte (MSB is set) with node address
+        };
+
+    #if defined (USART_CR1_UESM)
+        /**
+         * @brief Event that wakes MCU up from Stop mode
+         */
+        enum class WakeUpSource : uint8_t
+        {
+            AddressMatch = 0b00, ///< Received address matches (see EnableWakeUpFromStop)
+            StartBit = 0b10, ///< Start bit detection
+            RxNotEmpty = 0b11, ///< Received byte
+        };
+    #endif
+
+        /**
+         * @brief Calculates BRR value
+         * 
+         * @param [in] clockFreq USART clock frequency
+         * @param [in] baud Baud rate
+         * @param [in] oversampling8 Oversampling by 8 (otherwise by 16)
+         * 
+         * @returns BRR value
+         */
+        static constexpr uint32_t CalculateBaudRegister(uint32_t clockFreq, uint32_t baud, bool oversampling8 = false)
+        {
+            // Divider = clock / baud (BRR for oversampling by 16)
+            uint32_t divider = (clockFreq + baud / 2) / baud;
+            if(!oversampling8)
+                return divider;
+
+            // Oversampling by 8: BRR[3] is reserved, BRR[2:0] = fraction
+            return ((divider >> 3) << 4) | (divider & 0x07u);
+        }
+
+        /**
+         * @brief Calculates LPUART BRR value
+         * 
+         * @param [in] clockFreq LPUART clock frequency
+         * @param [in] baud Baud rate
+         * 
+         * @returns BRR value (valid range is 0x300...0xfffff)
+         */
+        static constexpr uint32_t CalculateLowPowerBaudRegister(uint32_t clockFreq, uint32_t baud)
+        {
+            // BRR = 256 * clock / baud
+            return static_cast<uint32_t>((static_cast<uint64_t>(clockFreq) * 256 + baud / 2) / baud);
+        }
+
+        /**
+         * @brief Calculates baud rate error
+         * 
+         * @param [in] clockFreq USART clock frequency
+         * @param [in] baud Required baud rate
+         * @param [in] oversampling8 Oversampling by 8 (otherwise by 16)
+         * 
+         * @returns Signed error of real baud rate (in ppm), INT32_MAX if baud rate is unreachable
+         */
+        static constexpr int32_t CalculateBaudError(uint32_t clockFreq, uint32_t baud, bool oversampling8 = false)
+        {
+            uint32_t brr = CalculateBaudRegister(clockFreq, baud, oversampling8);
+            int64_t divider = oversampling8
+                ? (((brr >> 4) << 3) | (brr & 0x07u))
+                : brr;
+            if(divider < (oversampling8 ? 8 : 16))
+                return INT32_MAX;
+
+            // Real baud = clock / divider
+            int64_t expected = static_cast<int64_t>(baud) * divider;
+            return static_cast<int32_t>((static_cast<int64_t>(clockFreq) - expected) * 1000000 / expected);
+        }
+
+        /**
+         * @brief Check that oversampling by 8 gives lower baud rate error
+         * 
+         * @details
+         * Both modes have the same divider resolution, so oversampling by 8
+         * is selected only when baud rate is too high for oversampling by 16
+         * (clock / baud is less than 16).
+         * 
+         * @param [in] clockFreq USART clock frequency
+         * @param [in] baud Baud rate
+         * 
+         * @retval true Oversampling by 8 is better
+         * @retval false Oversampling by 16 is better (or OVER8 is not supported)
+         */
+        static constexpr bool PreferOversampling8(uint32_t clockFreq, uint32_t baud)
+        {
+        #if defined (USART_CR1_OVER8)
+            auto abs = [](int32_t value) { return value < 0 ? -value : value; };
+            return abs(CalculateBaudError(clockFreq, baud, true)) < abs(CalculateBaudError(clockFreq, baud, false));
+        #else
+            return false;
+        #endif
+        }
+
+        /**
+         * @brief Baud rate error for best oversampling mode
+         * 
+         * @tparam baud Baud rate
+         * @tparam clockFreq USART clock frequency
+         * 
+         * @returns Signed error of real baud rate (in ppm)
+         */
+        template<unsigned long baud, unsigned long clockFreq>
+        static consteval int32_t BaudError()
+        {
+            return CalculateBaudError(clockFreq, baud, PreferOversampling8(clockFreq, baud));
+        }
+
+    #if defined (USART_CR1_FIFOEN)
+        /**
+         * @brief FIFO threshold
+         */
+        enum class FifoThreshold : uint8_t
+        {
+            OneEighth = 0b000, ///< FIFO reaches 1/8 of its depth
+            OneQuarter = 0b001, ///< FIFO reaches 1/4 of its depth
+            Half = 0b010, ///< FIFO reaches 1/2 of its depth
+            ThreeQuarters = 0b011, ///< FIFO reaches 3/4 of its depth
+            SevenEighths = 0b100, ///< FIFO reaches 7/8 of its depth
+            Full = 0b101, ///< FIFO becomes empty (TX) / full (RX)
+        };
+    #endif
+
     protected:
         static const unsigned ErrorMask = OverrunError | NoiseError | FramingError | ParityError;
 
         static const unsigned InterruptMask = ParityErrorInt | TxEmptyInt |
                 TxCompleteInt | RxNotEmptyInt | IdleInt | LineBreakInt |
                 ErrorInt | CtsInt
+        #if defined (USART_CR1_FIFOEN)
+                | RxFifoFull | TxFifoEmpty | RxFifoThreshold | TxFifoThreshold
+        #endif
         #if defined (USART_CR2_RTOEN)
                 | ReceiveTimeout
         #endif
+        #if defined (USART_CR3_WUFIE)
+                | WakeUpInt
+        #endif
         ;
     };
     
@@ -192,6 +355,15 @@ namespace Zhele
 
     namespace Private
     {
+        /**
+         * @brief Low-power UART trait (specialized for LPUART registers by platform)
+         * 
+         * @details
+         * LPUART has no oversampling, its BRR is 256 * clock / baud.
+         */
+        template<typename _Regs>
+        struct IsLowPowerUart : std::false_type {};
+
         template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
         class Usart : public UsartBase
         {
@@ -199,6 +371,22 @@ namespace Zhele
             using DmaTx = _DmaTx;
             using DmaRx = _DmaRx;
             using Regs = _Regs;
+            static constexpr IRQn_Type IRQNumber = _IRQNumber;
+            static constexpr bool LowPower = IsLowPowerUart<_Regs>::value;
+
+            /// Runtime counters (bytes, line errors seen by @ref GetError), enabled by ZHELE_STATISTICS
+            using Counters = Statistics::Counters<Statistics::UsartCounters, Usart>;
+
+            /// DMA TX handler with compile-time transfer complete callback (see @ref Zhele::DmaCallback)
+            template<TransferCallback _Callback>
+            using TxCompleteHandler = DmaCallback<_DmaTx, _Callback>;
+
+            /// DMA RX handler with compile-time transfer complete (and half transfer) callbacks (see @ref Zhele::DmaCallback)
+            template<TransferCallback _Callback, TransferCallback _HalfCallback = nullptr>
+            using RxCompleteHandler = DmaCallback<_DmaRx, _Callback, _HalfCallback>;
+
+            /// Max count of segments in scatter-gather write
+            static constexpr unsigned MaxWriteSegments = 8;
 
             /**
              * @brief Initialize USART
@@ -211,11 +399,28 @@ namespace Zhele
              */
             template<unsigned long baud>
             static inline void Init(UsartMode mode = DefaultUsartMode);
+
+            /**
+             * @brief Initialize USART with compile-time baud rate error check
+             * 
+             * @tparam baud Baud rate
+             * @tparam clockFreq USART clock frequency
+             * @tparam maxErrorPpm Max allowed baud rate error (in ppm, 2% by default)
+             * @param [in] mode Mode
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            template<unsigned long baud, unsigned long clockFreq, unsigned maxErrorPpm = 20000>
+            static inline void Init(UsartMode mode = DefaultUsartMode);
             
 
             /**
              * @brief Initialize USART
              * 
+             * @details
+             * Baud rate is kept on system clock change (see @ref Clock::ClockChange).
+             * 
              * @param [in] baud Baud rate
              * @param[in] mode Mode
              * 
@@ -239,6 +444,22 @@ namespace Zhele
              * @param [in] modeMask Mode mask
              */
             static void ClearConfig(UsartMode modeMask);
+
+            /**
+             * @brief Clear and set config at once
+             * 
+             * @details
+             * USART is disabled while config is changed (most of frame format bits can be written
+             * only when USART is disabled), so call it after transfer complete. Each control register
+             * is read and written once (see @ref ShadowReg), unchanged registers are not written.
+             * 
+             * @param [in] clearMask Mode mask to clear
+             * @param [in] setMask Mode mask to set
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void ModifyConfig(UsartMode clearMask, UsartMode setMask);
             
 
             /**
@@ -249,7 +470,62 @@ namespace Zhele
              * @par Returns
              *  Nothing
              */
-            static void SetBaud(unsigned baud);           
+            static void SetBaud(unsigned baud);
+
+            /**
+             * @brief Returns current baud rate (calculated by BRR)
+             * 
+             * @returns Baud rate
+             */
+            static unsigned GetBaud();
+
+        #if defined (USART_CR2_ABREN)
+            /**
+             * @brief Enable auto baud rate detection
+             * 
+             * @details
+             * Baud rate is measured on next received character (see AutoBaudMode).
+             * Check AutoBaudReady/AutoBaudFailed, then GetBaud returns detected baud rate.
+             * 
+             * @param [in] mode Detection mode
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableAutoBaud(AutoBaudMode mode = AutoBaudMode::StartBit);
+
+            /**
+             * @brief Disable auto baud rate detection
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableAutoBaud();
+
+            /**
+             * @brief Restart auto baud rate detection
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void RestartAutoBaud();
+
+            /**
+             * @brief Check that auto baud rate detection completed
+             * 
+             * @retval true Baud rate detected
+             * @retval false Detection in progress
+             */
+            static bool AutoBaudReady();
+
+            /**
+             * @brief Check that auto baud rate detection failed
+             * 
+             * @retval true Detection error
+             * @retval false No error
+             */
+            static bool AutoBaudFailed();
+        #endif
 
             /**
              * @brief Check that USART ready to read
@@ -277,6 +553,46 @@ namespace Zhele
              * 	Nothing
              */
             static void EnableAsyncRead(void* receiveBuffer, size_t bufferSize, TransferCallback callback = nullptr);
+
+            /**
+             * @brief Enable continuous read (by circular DMA)
+             * 
+             * @details
+             * DMA receives data into given buffer in circular mode. Newly received data
+             * is delivered to callback (without copying) on half transfer, transfer complete
+             * and line idle (or receive timeout) events. If data wraps around buffer end,
+             * callback is called twice. Call CircularReadIrqHandler from USART IRQ handler.
+             * 
+             * @note USART and DMA interrupts should have the same priority. Callback should
+             * process data faster than half of buffer is received, otherwise data is overwritten.
+             * 
+             * @param [out] receiveBuffer Circular buffer
+             * @param [in] bufferSize Circular buffer size
+             * @param [in] callback Data received callback
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void EnableCircularRead(void* receiveBuffer, size_t bufferSize, ReceiveCallback callback);
+
+            /**
+             * @brief Disable continuous read
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void DisableCircularRead();
+
+            /**
+             * @brief Handle line idle (and receive timeout) event of continuous read
+             * 
+             * @details
+             * Should be called from USART IRQ handler.
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void CircularReadIrqHandler();
            
 
             /**
@@ -314,6 +630,15 @@ namespace Zhele
             /**
              * @brief Write data to USART async (via DMA)
              * 
+             * @details
+             * Callback is called by pointer from DMA interrupt. For inlined callback use
+             * compile-time form: bind DMA vector to @ref TxCompleteHandler and omit callback here.
+             * @code
+             *  ZHELE_IRQ_HANDLER(DMA1_Channel4, Usart1::TxCompleteHandler<OnSent>);
+             *  ...
+             *  Usart1::WriteAsync(buffer, size);
+             * @endcode
+             * 
              * @param [in] data Data to write
              * @param [in] size Data size
              * @param [in] callback Transfer complete callback
@@ -323,6 +648,22 @@ namespace Zhele
              */
             static void WriteAsync(const void* data, size_t size, TransferCallback callback = nullptr);
 
+            /**
+             * @brief Write several data segments to USART async (via DMA) as one frame
+             * 
+             * @details
+             * Segments are chained by DMA transfer queue (next segment is started from
+             * DMA TC interrupt), so frame is sent without copying into staging buffer.
+             * Segment descriptors are copied, but data should be valid until callback.
+             * 
+             * @param [in] segments Data segments (empty segments are skipped)
+             * @param [in] callback Transfer complete callback (called after last segment)
+             * 
+             * @retval true Transfer was started
+             * @retval false Too many segments (more than MaxWriteSegments)
+             */
+            static bool WriteAsync(std::initializer_list<std::span<const uint8_t>> segments, TransferCallback callback = nullptr);
+
             /**
              * @brief Synch write byte
              * 
@@ -353,6 +694,152 @@ namespace Zhele
             */
             static void SetReceiverTimeout(uint32_t bitCount);
 
+        #if defined (USART_CR3_DEM)
+            /**
+             * @brief Enables RS485 driver enable output (DE is driven on RTS pin by hardware)
+             * @details
+             * DE is asserted before start bit of first byte and deasserted after stop bit of last byte.
+             * Times are in sample time units (1/16 or 1/8 of bit depends on oversampling).
+             * DE (RTS) pin should be configured as alternate function.
+             * @param [in] assertionTime Time between DE activation and start bit (0...31)
+             * @param [in] deassertionTime Time between end of stop bit and DE deactivation (0...31)
+             * @param [in] activeLow DE signal is active low
+             * @par Returns
+             *  Nothing
+            */
+            static void EnableDriverEnable(uint8_t assertionTime, uint8_t deassertionTime, bool activeLow = false);
+
+            /**
+             * @brief Disables RS485 driver enable output
+             * @par Returns
+             *  Nothing
+            */
+            static void DisableDriverEnable();
+        #endif
+
+        #if defined (USART_CR1_UESM)
+            /**
+             * @brief Enables wake up from Stop mode
+             * 
+             * @details
+             * USART receives in Stop mode if its kernel clock is HSI16 or LSE
+             * (see @ref Clock::UsartKernelClock::SelectClockSource), wake up interrupt (WakeUpInt) is enabled,
+             * so USART IRQ handler should clear it (CircularReadIrqHandler does it).
+             * 
+             * Reception by DMA (EnableAsyncRead, EnableCircularRead) continues after wake up without
+             * lost bytes: DMA serves pending request as soon as its clock is resumed.
+             * So do not use RX DMA channel as PowerManager guard. StartBit source is preferred
+             * for DMA reception: MCU wakes while the first byte is received.
+             * 
+             * @param [in] source Wake up event
+             * @param [in] address Node address for AddressMatch source (4-bit, or 7-bit if it's greater than 0x0f)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableWakeUpFromStop(WakeUpSource source, uint8_t address = 0);
+
+            /**
+             * @brief Disables wake up from Stop mode
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableWakeUpFromStop();
+        #endif
+
+            /**
+             * @brief Enables mute mode (multiprocessor communication)
+             * 
+             * @details
+             * Muted receiver doesn't set RXNE and other flags, so node doesn't handle traffic for other nodes.
+             * With AddressMark wakeup byte with MSB set (bit 8 for 9-bit word, bit 7 for 8-bit word)
+             * is address: matching address (it's received) wakes receiver up, other address mutes it again
+             * by hardware. Node address is 4-bit (or 7-bit if it's greater than 0x0f, F0/L4/G0 only).
+             * With IdleLine wakeup receiver is woken up by idle line, software mutes it after frame.
+             * 
+             * Receiver isn't muted by method, call @ref EnterMuteMode.
+             * 
+             * @param [in] wakeup Wakeup method
+             * @param [in] address Node address (for AddressMark wakeup)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableMuteMode(MuteWakeup wakeup, uint8_t address = 0);
+
+            /**
+             * @brief Disables mute mode
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableMuteMode();
+
+            /**
+             * @brief Mutes receiver (mute mode must be enabled)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnterMuteMode();
+
+            /**
+             * @brief Checks receiver is muted
+             * 
+             * @retval true Receiver is muted
+             * @retval false Receiver is active
+             */
+            static bool IsMuted();
+
+            /**
+             * @brief Sync write address byte (MSB is set)
+             * 
+             * @details
+             * Use 9-bit word (DataBits9 without parity) for 8-bit addresses,
+             * for 8-bit word address is 7-bit.
+             * 
+             * @param [in] address Node address
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void WriteAddress(uint8_t address);
+
+        #if defined (USART_CR1_FIFOEN)
+            /**
+             * @brief Enables TX and RX hardware FIFO
+             * 
+             * @details
+             * With FIFO enabled RxNotEmptyInt/TxEmptyInt mean "RX FIFO not empty"/"TX FIFO not full",
+             * so several bytes can be read/written per interrupt. Threshold interrupts
+             * (RxFifoThreshold, TxFifoThreshold) fire once per configured FIFO level.
+             * 
+             * @param [in] rxThreshold RX FIFO threshold
+             * @param [in] txThreshold TX FIFO threshold
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableFifo(FifoThreshold rxThreshold, FifoThreshold txThreshold);
+
+            /**
+             * @brief Disables hardware FIFO
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableFifo();
+
+            /**
+             * @brief Check that hardware FIFO is enabled
+             * 
+             * @retval true FIFO is enabled
+             * @retval false FIFO is disabled
+             */
+            static bool FifoEnabled();
+        #endif
+
             /**
              * @brief Enables one or more interrupts
              * 
@@ -405,6 +892,40 @@ namespace Zhele
              */
             static void ClearAllInterruptFlags();
 
+            /**
+             * @brief Returns receive data register address (for DMA transfers set up outside of driver)
+             * 
+             * @returns Data register address
+             */
+            static volatile void* RxDataRegister();
+
+            /**
+             * @brief Returns transmit data register address (for DMA transfers set up outside of driver)
+             * 
+             * @returns Data register address
+             */
+            static volatile void* TxDataRegister();
+
+            /**
+             * @brief Enables (or disables) RX DMA request
+             * 
+             * @param [in] enable Request is enabled
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void EnableRxDma(bool enable = true);
+
+            /**
+             * @brief Enables (or disables) TX DMA request
+             * 
+             * @param [in] enable Request is enabled
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void EnableTxDma(bool enable = true);
+
             /**
              * @brief Select RX and TX pins (set settings)
              * 
@@ -439,7 +960,53 @@ namespace Zhele
              */
             template<typename TxPin, typename RxPin = typename IO::NullPin>
             static void SelectTxRxPins();
+
+        private:
+            /**
+             * @brief Deliver newly received data of continuous read to callback
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void ProcessCircularRead();
+
+            /**
+             * @brief DMA half transfer and transfer complete handler of continuous read
+             * 
+             * @param [in] data Buffer
+             * @param [in] size Size
+             * @param [in] success Transfer result
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void CircularTransferHandler(void* data, unsigned size, bool success);
+
+            /**
+             * @brief Recalculates BRR for new clock frequence
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void ClockChanged();
+
+            static unsigned _baud;
+            static uint8_t* _circularBuffer;
+            static size_t _circularBufferSize;
+            static size_t _circularPosition;
+            static ReceiveCallback _receiveCallback;
         };
+
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        unsigned Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::_baud = 0;
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        uint8_t* Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::_circularBuffer = nullptr;
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        size_t Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::_circularBufferSize = 0;
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        size_t Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::_circularPosition = 0;
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        ReceiveCallback Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::_receiveCallback = nullptr;
     }
 }
 
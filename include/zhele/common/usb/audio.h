@@ -0,0 +1,494 @@
+/**
+ * @file
+ * Implements USB audio class (UAC 1.0) microphone
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_AUDIO_H
+#define ZHELE_USB_AUDIO_H
+
+#include "common.h"
+#include "endpoint.h"
+#include "interface.h"
+
+#include "../../containers/ring_buffer.h"
+
+#include <array>
+#include <stdint.h>
+#include <string.h>
+
+namespace Zhele::Usb
+{
+    /**
+     * @brief Audio interface subclass
+     */
+    enum class AudioSubClass : uint8_t
+    {
+        AudioControl = 0x01, ///< Audio control
+        AudioStreaming = 0x02, ///< Audio streaming
+    };
+
+    /**
+     * @brief Audio class-specific descriptor types
+     */
+    enum class AudioDescriptorType : uint8_t
+    {
+        Interface = 0x24, ///< Class-specific interface
+        Endpoint = 0x25, ///< Class-specific endpoint
+    };
+
+    /**
+     * @brief Audio terminal types
+     */
+    enum class AudioTerminalType : uint16_t
+    {
+        UsbStreaming = 0x0101, ///< USB streaming
+        Microphone = 0x0201, ///< Microphone
+    };
+
+    /**
+     * @brief Implements audio control interface for microphone (input terminal -> output terminal)
+     *
+     * @details
+     * Topology has no feature unit, so interface has no class-specific requests.
+     *
+     * @tparam _Number Interface number
+     * @tparam _StreamingNumber Audio streaming interface number
+     * @tparam _Ep0 Zero endpoint instance
+     * @tparam _Channels Channels count (1 or 2)
+     */
+    template <uint8_t _Number, uint8_t _StreamingNumber, typename _Ep0, uint8_t _Channels = 1>
+    class AudioControlInterface : public Interface<_Number, 0, DeviceAndInterfaceClass::Audio, static_cast<uint8_t>(AudioSubClass::AudioControl), 0, _Ep0>
+    {
+        static_assert(_Channels == 1 || _Channels == 2, "Only mono and stereo microphones are supported");
+
+        static const uint8_t InputTerminalId = 1;
+        static const uint8_t OutputTerminalId = 2;
+        static const uint16_t ClassSpecificSize = 9 + 12 + 9;
+        static const uint16_t ChannelConfig = _Channels == 2 ? 0x0003 : 0x0000;
+    public:
+        /// Output terminal ID (for streaming interface terminal link)
+        static const uint8_t TerminalLink = OutputTerminalId;
+
+        /**
+         * @brief Interface setup request handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            SetupPacket* setup = reinterpret_cast<SetupPacket*>(_Ep0::RxBuffer);
+
+            if (setup->RequestType.Type == 0 && setup->Request == StandartRequestCode::SetInterface && setup->Value == 0)
+            {
+                _Ep0::SendZLP();
+            }
+            else if (setup->RequestType.Type == 0 && setup->Request == StandartRequestCode::GetInterface)
+            {
+                static const uint8_t alternateSetting = 0;
+                _Ep0::SendData(&alternateSetting, 1);
+            }
+            else
+            {
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+            }
+        }
+
+        /**
+         * @brief Build audio control interface descriptor
+         *
+         * @returns Bytes of interface descriptor
+         */
+        static consteval auto GetDescriptor()
+        {
+            std::array<uint8_t, sizeof(InterfaceDescriptor) + ClassSpecificSize> result;
+
+            constexpr auto head = InterfaceDescriptor {
+                .Number = _Number,
+                .AlternateSetting = 0,
+                .EndpointsCount = 0,
+                .Class = DeviceAndInterfaceClass::Audio,
+                .SubClass = static_cast<uint8_t>(AudioSubClass::AudioControl),
+                .Protocol = 0
+            }.GetBytes();
+            auto dst = std::copy(head.begin(), head.end(), result.begin());
+
+            constexpr std::array<uint8_t, ClassSpecificSize> classSpecific {
+                // Header
+                9, static_cast<uint8_t>(AudioDescriptorType::Interface), 0x01,
+                0x00, 0x01, // bcdADC 1.00
+                ClassSpecificSize & 0xff, ClassSpecificSize >> 8,
+                1, // Streaming interfaces count
+                _StreamingNumber,
+                // Input terminal
+                12, static_cast<uint8_t>(AudioDescriptorType::Interface), 0x02,
+                InputTerminalId,
+                static_cast<uint16_t>(AudioTerminalType::Microphone) & 0xff, static_cast<uint16_t>(AudioTerminalType::Microphone) >> 8,
+                0, // Associated terminal
+                _Channels,
+                ChannelConfig & 0xff, ChannelConfig >> 8,
+                0, // Channel names string
+                0, // Terminal string
+                // Output terminal
+                9, static_cast<uint8_t>(AudioDescriptorType::Interface), 0x03,
+                OutputTerminalId,
+                static_cast<uint16_t>(AudioTerminalType::UsbStreaming) & 0xff, static_cast<uint16_t>(AudioTerminalType::UsbStreaming) >> 8,
+                0, // Associated terminal
+                InputTerminalId, // Source
+                0, // Terminal string
+            };
+            std::copy(classSpecific.begin(), classSpecific.end(), dst);
+
+            return result;
+        }
+    };
+
+    /**
+     * @brief Implements audio streaming interface for microphone (16-bit PCM)
+     *
+     * @details
+     * Interface has two alternate settings: zero bandwidth (0) and streaming (1).
+     * Host selects alternate setting 1 to start streaming, so SET_INTERFACE request
+     * starts or stops source.
+     *
+     * @tparam _Number Interface number
+     * @tparam _Ep0 Zero endpoint instance
+     * @tparam _Endpoint Isochronous IN endpoint
+     * @tparam _SampleRate Sample rate (in Hz)
+     * @tparam _Channels Channels count
+     * @tparam _Source Samples source with static Start/Stop methods (for example, @ref AudioAdcSource)
+     * @tparam _TerminalLink Output terminal ID of audio control interface
+     */
+    template <uint8_t _Number, typename _Ep0, typename _Endpoint, uint32_t _SampleRate, uint8_t _Channels = 1, typename _Source = _Endpoint, uint8_t _TerminalLink = 2>
+    class AudioMicrophoneStreamingInterface : public Interface<_Number, 0, DeviceAndInterfaceClass::Audio, static_cast<uint8_t>(AudioSubClass::AudioStreaming), 0, _Ep0, _Endpoint>
+    {
+        using Base = Interface<_Number, 0, DeviceAndInterfaceClass::Audio, static_cast<uint8_t>(AudioSubClass::AudioStreaming), 0, _Ep0, _Endpoint>;
+
+        static_assert(_Endpoint::Type == EndpointType::Isochronous && _Endpoint::Direction == EndpointDirection::In, "Microphone endpoint must be isochronous IN");
+        static_assert(_Endpoint::MaxPacketSize >= (_SampleRate / 1000 + 2) * _Channels * 2, "Endpoint must contain frame samples (with adaptation)");
+
+        static const uint16_t StreamingDescriptorSize = 2 * sizeof(InterfaceDescriptor) + 7 + 11 + 9 + 7;
+        static volatile uint8_t _alternateSetting;
+    public:
+        /**
+         * @brief Reset interface (alternate setting 0)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            _alternateSetting = 0;
+            Base::Reset();
+        }
+
+        /**
+         * @brief Check streaming state
+         *
+         * @retval true Host selected streaming alternate setting
+         * @retval false Interface is idle
+         */
+        static bool IsStreaming()
+        {
+            return _alternateSetting == 1;
+        }
+
+        /**
+         * @brief Interface setup request handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            SetupPacket* setup = reinterpret_cast<SetupPacket*>(_Ep0::RxBuffer);
+
+            if (setup->RequestType.Type == 0 && setup->Request == StandartRequestCode::SetInterface && setup->Value <= 1)
+            {
+                if (setup->Value != _alternateSetting)
+                {
+                    _alternateSetting = setup->Value;
+                    setup->Value == 1 ? _Source::Start() : _Source::Stop();
+                }
+                _Ep0::SendZLP();
+            }
+            else if (setup->RequestType.Type == 0 && setup->Request == StandartRequestCode::GetInterface)
+            {
+                _Ep0::SendData(const_cast<const uint8_t*>(&_alternateSetting), 1);
+            }
+            else
+            {
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+            }
+        }
+
+        /**
+         * @brief Build audio streaming interface descriptor (both alternate settings)
+         *
+         * @returns Bytes of interface descriptor
+         */
+        static consteval auto GetDescriptor()
+        {
+            std::array<uint8_t, StreamingDescriptorSize> result;
+
+            constexpr auto zeroBandwidth = InterfaceDescriptor {
+                .Number = _Number,
+                .AlternateSetting = 0,
+                .EndpointsCount = 0,
+                .Class = DeviceAndInterfaceClass::Audio,
+                .SubClass = static_cast<uint8_t>(AudioSubClass::AudioStreaming),
+                .Protocol = 0
+            }.GetBytes();
+            auto dst = std::copy(zeroBandwidth.begin(), zeroBandwidth.end(), result.begin());
+
+            constexpr auto streaming = InterfaceDescriptor {
+                .Number = _Number,
+                .AlternateSetting = 1,
+                .EndpointsCount = 1,
+                .Class = DeviceAndInterfaceClass::Audio,
+                .SubClass = static_cast<uint8_t>(AudioSubClass::AudioStreaming),
+                .Protocol = 0
+            }.GetBytes();
+            dst = std::copy(streaming.begin(), streaming.end(), dst);
+
+            constexpr std::array<uint8_t, 7 + 11 + 9 + 7> classSpecific {
+                // AS general
+                7, static_cast<uint8_t>(AudioDescriptorType::Interface), 0x01,
+                _TerminalLink,
+                1, // Delay (in frames)
+                0x01, 0x00, // PCM
+                // Format type I
+                11, static_cast<uint8_t>(AudioDescriptorType::Interface), 0x02,
+                0x01, // Format type I
+                _Channels,
+                2, // Subframe size
+                16, // Bit resolution
+                1, // Discrete sample rates count
+                _SampleRate & 0xff, (_SampleRate >> 8) & 0xff, (_SampleRate >> 16) & 0xff,
+                // Standard isochronous endpoint (audio, 9 bytes)
+                9, static_cast<uint8_t>(DescriptorType::Endpoint),
+                static_cast<uint8_t>(_Endpoint::Number | 0x80),
+                0x05, // Isochronous, asynchronous
+                _Endpoint::MaxPacketSize & 0xff, _Endpoint::MaxPacketSize >> 8,
+                1, // Interval
+                0, // Refresh
+                0, // Synch address
+                // Class-specific isochronous endpoint
+                7, static_cast<uint8_t>(AudioDescriptorType::Endpoint), 0x01,
+                0, // Attributes
+                0, // Lock delay units
+                0, 0, // Lock delay
+            };
+            std::copy(classSpecific.begin(), classSpecific.end(), dst);
+
+            return result;
+        }
+    };
+
+    template <uint8_t _Number, typename _Ep0, typename _Endpoint, uint32_t _SampleRate, uint8_t _Channels, typename _Source, uint8_t _TerminalLink>
+    volatile uint8_t AudioMicrophoneStreamingInterface<_Number, _Ep0, _Endpoint, _SampleRate, _Channels, _Source, _TerminalLink>::_alternateSetting = 0;
+
+    /**
+     * @brief Implements microphone samples source fed by ADC regular stream
+     *
+     * @details
+     * ADC stream callback converts 12-bit samples to signed 16-bit PCM and stores them to ring.
+     * Isochronous endpoint TX callback (every frame) writes SampleRate / 1000 samples per channel
+     * (fractional rates are accumulated). ADC clock is not locked to USB SOF, so packet size
+     * is adapted by ring fill: one frame more if ring is more than 3/4 full, one frame less
+     * if it is less than 1/4 full. Missing samples (underrun) are sent as silence.
+     *
+     * @par Example
+     * @code
+     *  using MicEpBase = IsochronousEndpointBase<1, EndpointDirection::In, 40>;
+     *  ...
+     *  using MicEp = EpInitializer::ExtendEndpoint<MicEpBase>;
+     *  using Mic = AudioAdcSource<MicEp, 16000>;
+     *  using MicControl = AudioControlInterface<0, 1, Ep0>;
+     *  using MicStreaming = AudioMicrophoneStreamingInterface<1, Ep0, MicEp, 16000, 1, Mic>;
+     *  uint16_t adcBuffer[2 * 32];
+     *  ...
+     *  Mic::Init();
+     *  Adc1::StartRegularStream({0}, adcBuffer, 32, Mic::AdcHandler); // ADC is triggered by 16 kHz timer
+     * @endcode
+     *
+     * @tparam _Endpoint Isochronous IN endpoint
+     * @tparam _SampleRate Sample rate (in Hz)
+     * @tparam _Channels Channels count (ADC channels are interleaved)
+     * @tparam _RingSamples Ring size (in samples, several frames)
+     */
+    template <typename _Endpoint, uint32_t _SampleRate, uint8_t _Channels = 1, unsigned _RingSamples = 256>
+    class AudioAdcSource
+    {
+        static const unsigned FrameSamples = _SampleRate / 1000;
+        static const unsigned MaxPacketSamples = _Endpoint::MaxPacketSize / 2;
+
+        static_assert(MaxPacketSamples >= (FrameSamples + 2) * _Channels, "Endpoint must contain frame samples (with adaptation)");
+        static_assert(_RingSamples >= 4 * (FrameSamples + 1) * _Channels, "Ring must contain several frames");
+    public:
+        /**
+         * @brief Init source (set endpoint TX callback)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+            _Endpoint::SetTxCallback(SendFrame);
+        }
+
+        /**
+         * @brief Start streaming (called by streaming interface)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _samples.clear();
+            _fraction = 0;
+            _active = true;
+            _Endpoint::Start();
+            __set_PRIMASK(primask);
+        }
+
+        /**
+         * @brief Stop streaming (called by streaming interface)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop()
+        {
+            _active = false;
+            _Endpoint::Stop();
+        }
+
+        /**
+         * @brief ADC stream callback (@ref AdcStreamCallbackType)
+         *
+         * @param [in] data Samples
+         * @param [in] count Samples count
+         * @param [in] overruns ADC overruns (unused)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void AdcHandler(uint16_t* data, uint32_t count, uint32_t overruns)
+        {
+            if (!_active)
+                return;
+
+            while (count > 0)
+            {
+                auto region = _samples.writable_span();
+                if (region.empty())
+                {
+                    _dropped = _dropped + count;
+                    break;
+                }
+
+                unsigned chunk = region.size() < count ? region.size() : count;
+                for (unsigned i = 0; i < chunk; ++i)
+                    region[i] = static_cast<int16_t>((static_cast<int32_t>(data[i]) - 2048) << 4);
+                _samples.commit(chunk);
+                data += chunk;
+                count -= chunk;
+            }
+        }
+
+        /**
+         * @brief Returns dropped samples count (ring overflow)
+         *
+         * @returns Samples count
+         */
+        static uint32_t Dropped()
+        {
+            return _dropped;
+        }
+
+        /**
+         * @brief Returns silence samples count (ring underrun)
+         *
+         * @returns Samples count
+         */
+        static uint32_t Underruns()
+        {
+            return _underruns;
+        }
+
+    private:
+        static void SendFrame()
+        {
+            unsigned frames = FrameSamples;
+            _fraction += _SampleRate % 1000;
+            if (_fraction >= 1000)
+            {
+                _fraction -= 1000;
+                ++frames;
+            }
+
+            unsigned fill = _samples.size();
+            if (fill > _RingSamples * 3 / 4)
+                ++frames;
+            else if (fill < _RingSamples / 4 && frames > 0)
+                --frames;
+
+            int16_t packet[MaxPacketSamples];
+            unsigned samples = frames * _Channels;
+            unsigned count = 0;
+
+            while (count < samples)
+            {
+                auto region = _samples.readable_span();
+                if (region.empty())
+                    break;
+
+                unsigned chunk = region.size() < samples - count ? region.size() : samples - count;
+                memcpy(&packet[count], region.data(), chunk * sizeof(int16_t));
+                _samples.consume(chunk);
+                count += chunk;
+            }
+
+            if (count < samples)
+            {
+                memset(&packet[count], 0, (samples - count) * sizeof(int16_t));
+                _underruns = _underruns + (samples - count);
+            }
+
+            _Endpoint::WritePacket(packet, samples * sizeof(int16_t));
+        }
+
+        static Containers::RingBuffer<_RingSamples, int16_t> _samples;
+        static unsigned _fraction;
+        static volatile bool _active;
+        static volatile uint32_t _dropped;
+        static volatile uint32_t _underruns;
+    };
+
+    #define AUDIO_ADC_SOURCE_TEMPLATE_ARGS template <typename _Endpoint, uint32_t _SampleRate, uint8_t _Channels, unsigned _RingSamples>
+    #define AUDIO_ADC_SOURCE_TEMPLATE_QUALIFIER AudioAdcSource<_Endpoint, _SampleRate, _Channels, _RingSamples>
+
+    AUDIO_ADC_SOURCE_TEMPLATE_ARGS
+    Containers::RingBuffer<_RingSamples, int16_t> AUDIO_ADC_SOURCE_TEMPLATE_QUALIFIER::_samples;
+
+    AUDIO_ADC_SOURCE_TEMPLATE_ARGS
+    unsigned AUDIO_ADC_SOURCE_TEMPLATE_QUALIFIER::_fraction = 0;
+
+    AUDIO_ADC_SOURCE_TEMPLATE_ARGS
+    volatile bool AUDIO_ADC_SOURCE_TEMPLATE_QUALIFIER::_active = false;
+
+    AUDIO_ADC_SOURCE_TEMPLATE_ARGS
+    volatile uint32_t AUDIO_ADC_SOURCE_TEMPLATE_QUALIFIER::_dropped = 0;
+
+    AUDIO_ADC_SOURCE_TEMPLATE_ARGS
+    volatile uint32_t AUDIO_ADC_SOURCE_TEMPLATE_QUALIFIER::_underruns = 0;
+}
+
+#endif //! ZHELE_USB_AUDIO_H
@@ -15,6 +15,7 @@
 #include "../template_utils/type_list.h"
 
 #include <string.h>
+#include <type_traits>
 
 namespace Zhele::Usb
 {
@@ -59,6 +60,7 @@ namespace Zhele::Usb
         static constexpr auto Functionals = Zhele::TemplateUtils::TypeList<_Functionals...>{};
 
         static LineCoding _lineCoding;
+        static std::add_pointer_t<void(const LineCoding& lineCoding)> _lineCodingCallback;
 
         /**
          * @brief Returns nested interface descriptor total size
@@ -81,6 +83,32 @@ namespace Zhele::Usb
         }
 
     public:
+        /// Line coding change callback (called from USB interrupt)
+        using LineCodingCallback = std::add_pointer_t<void(const LineCoding& lineCoding)>;
+
+        /**
+         * @brief Sets line coding change callback
+         * 
+         * @param [in] callback Callback (for example, CdcUsartBridge::SetLineCoding)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetLineCodingCallback(LineCodingCallback callback)
+        {
+            _lineCodingCallback = callback;
+        }
+
+        /**
+         * @brief Returns current line coding
+         * 
+         * @returns Line coding
+         */
+        static const LineCoding& GetLineCoding()
+        {
+            return _lineCoding;
+        }
+
         /**
          * @brief Interface setup request handler
          * 
@@ -101,6 +129,8 @@ namespace Zhele::Usb
                         memcpy(&_lineCoding, reinterpret_cast<const void*>(_Ep0::RxBuffer), 7);
                         _Ep0::ResetOutDataTransferCallback();
                         _Ep0::SendZLP();
+                        if(_lineCodingCallback)
+                            _lineCodingCallback(_lineCoding);
                     });
                     _Ep0::SetRxStatus(EndpointStatus::Valid);
                 }
@@ -151,6 +181,8 @@ namespace Zhele::Usb
     };
     template <uint8_t _Number, uint8_t _AlternateSetting, uint8_t _SubClass, uint8_t _Protocol, typename _Ep0, typename _Endpoint, typename... _Functionals>
     LineCoding CdcCommInterface<_Number, _AlternateSetting, _SubClass, _Protocol, _Ep0, _Endpoint, _Functionals...>::_lineCoding = {115200, 0, 0, 8};
+    template <uint8_t _Number, uint8_t _AlternateSetting, uint8_t _SubClass, uint8_t _Protocol, typename _Ep0, typename _Endpoint, typename... _Functionals>
+    std::add_pointer_t<void(const LineCoding& lineCoding)> CdcCommInterface<_Number, _AlternateSetting, _SubClass, _Protocol, _Ep0, _Endpoint, _Functionals...>::_lineCodingCallback = nullptr;
 
     /**
      * @brief Implements CDC communication interface
@@ -228,6 +260,7 @@ namespace Zhele::Usb
         DeviceManagement = 0x09, ///< Device Management
         MobileDirectLine = 0x0a, ///< Mobile Direct Line Model
         Obex = 0x0b, ///< OBEX
+        Ncm = 0x0d, ///< Network Control Model
     };
     
     /**
@@ -0,0 +1,333 @@
+/**
+ * @file
+ * Implements buffered serial port over USB-CDC data endpoints
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_CDC_SERIAL_H
+#define ZHELE_USB_CDC_SERIAL_H
+
+#include "common.h"
+#include "endpoint.h"
+
+#include "../../containers/ring_buffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace Zhele::Usb
+{
+    /**
+     * @brief Implements buffered serial port over CDC data endpoints
+     *
+     * @details
+     * Received packets are copied to RX ring in USB interrupt. If ring has no room for next packet,
+     * OUT endpoint is left NAKed (host retries), it's enabled by @ref Read after ring frees.
+     * Written data is stored to TX ring and is sent from ring directly (without copy):
+     * full packets are sent at once, tail that is shorter than max packet size is sent
+     * after _FlushTicks calls of @ref Tick (so many small writes are sent by one packet).
+     * Next part of ring is sent from transfer complete callback (USB interrupt).
+     *
+     * @par Example
+     * @code
+     *  using Serial = CdcSerial<CdcDataEndpoint>;
+     *  template<>
+     *  void CdcDataEndpoint::HandleRx()
+     *  {
+     *      Serial::RxHandler();
+     *  }
+     *  extern "C" void SysTick_Handler()
+     *  {
+     *      Serial::Tick();
+     *  }
+     *  ...
+     *  while (Serial::Available() > 0)
+     *      Serial::Write(Serial::Read());
+     * @endcode
+     *
+     * @tparam _InEp Data IN (or bidirectional) endpoint
+     * @tparam _OutEp Data OUT (or bidirectional) endpoint
+     * @tparam _RxSize RX ring size (in bytes), at least one packet
+     * @tparam _TxSize TX ring size (in bytes)
+     * @tparam _FlushTicks Short packet delay (in @ref Tick calls)
+     */
+    template<typename _InEp, typename _OutEp = _InEp, unsigned _RxSize = 256, unsigned _TxSize = 256, unsigned _FlushTicks = 2>
+    class CdcSerial
+    {
+        static_assert(_RxSize >= _OutEp::MaxPacketSize, "RX ring must contain at least one packet");
+        static_assert(_TxSize >= _InEp::MaxPacketSize, "TX ring must contain at least one packet");
+    public:
+        /**
+         * @brief Returns received bytes count
+         *
+         * @returns Bytes count
+         */
+        static unsigned Available()
+        {
+            return _rxBuffer.size();
+        }
+
+        /**
+         * @brief Reads received byte
+         *
+         * @returns Byte (zero if there is no data)
+         */
+        static uint8_t Read()
+        {
+            uint8_t data = 0;
+            Read(&data, 1);
+            return data;
+        }
+
+        /**
+         * @brief Reads received data
+         *
+         * @param [out] data Buffer
+         * @param [in] size Buffer size
+         *
+         * @returns Read bytes count
+         */
+        static size_t Read(void* data, size_t size)
+        {
+            uint8_t* destination = static_cast<uint8_t*>(data);
+            size_t count = 0;
+
+            while (count < size)
+            {
+                auto region = _rxBuffer.readable_span();
+                if (region.empty())
+                    break;
+
+                size_t chunk = region.size() < size - count ? region.size() : size - count;
+                memcpy(destination + count, region.data(), chunk);
+                _rxBuffer.consume(chunk);
+                count += chunk;
+            }
+
+            ResumeRx();
+            return count;
+        }
+
+        /**
+         * @brief Writes data to TX ring
+         *
+         * @param [in] data Data
+         * @param [in] size Data size
+         *
+         * @returns Written bytes count (less than size if ring is full)
+         */
+        static size_t Write(const void* data, size_t size)
+        {
+            const uint8_t* source = static_cast<const uint8_t*>(data);
+            size_t count = 0;
+
+            while (count < size)
+            {
+                auto region = _txBuffer.writable_span();
+                if (region.empty())
+                    break;
+
+                size_t chunk = region.size() < size - count ? region.size() : size - count;
+                memcpy(region.data(), source + count, chunk);
+                _txBuffer.commit(chunk);
+                count += chunk;
+            }
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            StartTx(false);
+            __set_PRIMASK(primask);
+
+            return count;
+        }
+
+        /**
+         * @brief Writes byte to TX ring
+         *
+         * @param [in] data Byte
+         *
+         * @retval true Byte is written
+         * @retval false TX ring is full
+         */
+        static bool Write(uint8_t data)
+        {
+            return Write(&data, 1) == 1;
+        }
+
+        /**
+         * @brief Returns TX ring free space
+         *
+         * @returns Bytes count
+         */
+        static unsigned WriteAvailable()
+        {
+            return _TxSize - _txBuffer.size();
+        }
+
+        /**
+         * @brief Sends pending data immediately (short packet is not delayed)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Flush()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            StartTx(true);
+            __set_PRIMASK(primask);
+        }
+
+        /**
+         * @brief Timer tick (call it periodically, for example from SysTick handler)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Tick()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if (!_txBusy && !_txBuffer.empty() && ++_txTicks >= _FlushTicks)
+                StartTx(true);
+            __set_PRIMASK(primask);
+        }
+
+        /**
+         * @brief OUT endpoint handler (call it from endpoint HandleRx, do not set RX status there)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void RxHandler()
+        {
+#if defined (USB)
+            const void* pma;
+            uint16_t size;
+            if constexpr (requires { _OutEp::RxBufferCount::Get(); })
+            {
+                pma = reinterpret_cast<const void*>(_OutEp::RxBuffer);
+                size = _OutEp::RxBufferCount::Get() & 0x3ff;
+            }
+            else
+            {
+                pma = reinterpret_cast<const void*>(_OutEp::Buffer);
+                size = _OutEp::BufferCount::Get() & 0x3ff;
+            }
+
+            auto region = _rxBuffer.writable_span();
+            if (region.size() >= size)
+            {
+                CopyFromUsbPma(region.data(), pma, size);
+                _rxBuffer.commit(size);
+            }
+            else
+            {
+                // Packet wraps ring, so it's copied to ring by parts
+                uint8_t packet[_OutEp::MaxPacketSize];
+                CopyFromUsbPma(packet, pma, size);
+                Store(packet, size);
+            }
+#else
+            Store(_OutEp::Buffer, _OutEp::BufferSize);
+#endif
+
+            if (_RxSize - _rxBuffer.size() >= _OutEp::MaxPacketSize)
+                _OutEp::SetRxStatus(EndpointStatus::Valid);
+            else
+                _rxStalled = true;
+        }
+
+    private:
+        static void Store(const uint8_t* data, unsigned size)
+        {
+            while (size > 0)
+            {
+                auto region = _rxBuffer.writable_span();
+                if (region.empty())
+                    break;
+
+                unsigned chunk = region.size() < size ? region.size() : size;
+                memcpy(region.data(), data, chunk);
+                _rxBuffer.commit(chunk);
+                data += chunk;
+                size -= chunk;
+            }
+        }
+
+        static void ResumeRx()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if (_rxStalled && _RxSize - _rxBuffer.size() >= _OutEp::MaxPacketSize)
+            {
+                _rxStalled = false;
+                _OutEp::SetRxStatus(EndpointStatus::Valid);
+            }
+            __set_PRIMASK(primask);
+        }
+
+        static void StartTx(bool flush)
+        {
+            if (_txBusy)
+                return;
+
+            auto region = _txBuffer.readable_span();
+            unsigned size = region.size();
+
+            // Full packets are sent at once, short tail waits for timer (or next writes)
+            if (size == 0 || (size < _InEp::MaxPacketSize && !flush && _txBuffer.size() < _InEp::MaxPacketSize))
+                return;
+
+            if (!flush && size >= _InEp::MaxPacketSize)
+                size -= size % _InEp::MaxPacketSize;
+
+            _txBusy = true;
+            _txTicks = 0;
+            _txSending = size;
+            _InEp::SendData(region.data(), size, TxComplete);
+        }
+
+        static void TxComplete()
+        {
+            _txBuffer.consume(_txSending);
+            _txSending = 0;
+            _txBusy = false;
+            StartTx(false);
+        }
+
+        static Containers::RingBuffer<_RxSize, uint8_t> _rxBuffer;
+        static Containers::RingBuffer<_TxSize, uint8_t> _txBuffer;
+        static volatile bool _rxStalled;
+        static volatile bool _txBusy;
+        static unsigned _txSending;
+        static unsigned _txTicks;
+    };
+
+    #define CDC_SERIAL_TEMPLATE_ARGS template<typename _InEp, typename _OutEp, unsigned _RxSize, unsigned _TxSize, unsigned _FlushTicks>
+    #define CDC_SERIAL_TEMPLATE_QUALIFIER CdcSerial<_InEp, _OutEp, _RxSize, _TxSize, _FlushTicks>
+
+    CDC_SERIAL_TEMPLATE_ARGS
+    Containers::RingBuffer<_RxSize, uint8_t> CDC_SERIAL_TEMPLATE_QUALIFIER::_rxBuffer;
+
+    CDC_SERIAL_TEMPLATE_ARGS
+    Containers::RingBuffer<_TxSize, uint8_t> CDC_SERIAL_TEMPLATE_QUALIFIER::_txBuffer;
+
+    CDC_SERIAL_TEMPLATE_ARGS
+    volatile bool CDC_SERIAL_TEMPLATE_QUALIFIER::_rxStalled = false;
+
+    CDC_SERIAL_TEMPLATE_ARGS
+    volatile bool CDC_SERIAL_TEMPLATE_QUALIFIER::_txBusy = false;
+
+    CDC_SERIAL_TEMPLATE_ARGS
+    unsigned CDC_SERIAL_TEMPLATE_QUALIFIER::_txSending = 0;
+
+    CDC_SERIAL_TEMPLATE_ARGS
+    unsigned CDC_SERIAL_TEMPLATE_QUALIFIER::_txTicks = 0;
+}
+
+#endif //! ZHELE_USB_CDC_SERIAL_H
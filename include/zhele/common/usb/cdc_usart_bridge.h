@@ -0,0 +1,340 @@
+/**
+ * @file
+ * Implements USB-CDC to USART bridge (USB to serial adapter)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_CDC_USART_BRIDGE_H
+#define ZHELE_USB_CDC_USART_BRIDGE_H
+
+#include "cdc.h"
+#include "common.h"
+#include "endpoint.h"
+
+#include "../../containers/ring_buffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace Zhele::Usb
+{
+    /**
+     * @brief Implements USB to serial adapter over CDC data endpoints and USART with DMA
+     *
+     * @details
+     * Host to device: OUT packets are copied to TX ring in USB interrupt, USART TX DMA sends
+     * ring contents by contiguous regions (next region is started from DMA interrupt).
+     * If ring has no room for next packet, OUT endpoint is left NAKed (host retries),
+     * it's enabled again by USART TX DMA interrupt, so no byte is dropped at any baud rate.
+     *
+     * Device to host: USART receives data to RX ring by circular DMA. Newly received data is
+     * reported on DMA half/complete and line idle events and it's sent by one IN transfer
+     * directly from ring, so data received while previous IN transfer is in progress is batched
+     * into full packets. Line idle flushes short tail immediately. USART can't be NAKed, so if host
+     * doesn't read data for ring half time, lost data is skipped and counted (@ref Overruns),
+     * use RTS flow control for such hosts.
+     *
+     * Line coding (baud rate, data bits, parity, stop bits) is applied to USART by @ref SetLineCoding,
+     * subscribe it to communication interface. USART must be initialized (with DMA channels) before.
+     *
+     * At 3 Mbaud both directions take about 300 KB/s, so rings should hold at least
+     * 1 ms of data (USB frame) with margin: default 1 KB rings are enough.
+     *
+     * @par Example
+     * @code
+     *  using Bridge = CdcUsartBridge<Usart1, CdcDataEndpoint>;
+     *  template<>
+     *  void CdcDataEndpoint::HandleRx()
+     *  {
+     *      Bridge::RxHandler();
+     *  }
+     *  extern "C" void USART1_IRQHandler()
+     *  {
+     *      Usart1::CircularReadIrqHandler();
+     *  }
+     *  ...
+     *  Usart1::Init(115200);
+     *  Usart1::SelectTxRxPins<IO::Pa9, IO::Pa10>();
+     *  CdcComm::SetLineCodingCallback(Bridge::SetLineCoding);
+     *  Bridge::Start();
+     * @endcode
+     *
+     * @tparam _Usart USART (with TX and RX DMA channels)
+     * @tparam _InEp Data IN (or bidirectional) endpoint
+     * @tparam _OutEp Data OUT (or bidirectional) endpoint
+     * @tparam _TxSize Host to device (USART TX) ring size (in bytes), at least two packets
+     * @tparam _RxSize Device to host (USART RX) ring size (in bytes)
+     */
+    template<typename _Usart, typename _InEp, typename _OutEp = _InEp, unsigned _TxSize = 1024, unsigned _RxSize = 1024>
+    class CdcUsartBridge
+    {
+        static_assert(_TxSize >= 2 * _OutEp::MaxPacketSize, "TX ring must contain at least two packets");
+        static_assert(_RxSize % 2 == 0, "RX ring size must be even");
+
+        using UsartMode = typename _Usart::UsartMode;
+    public:
+        /**
+         * @brief Starts bridge (USART reception and USB OUT endpoint)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start()
+        {
+            _txBuffer.clear();
+            _txSending = 0;
+            _txBusy = false;
+            _outStalled = false;
+            _received = 0;
+            _sent = 0;
+            _inSending = 0;
+            _overruns = 0;
+
+            _Usart::EnableCircularRead(_rxBuffer, _RxSize, Received);
+            _OutEp::SetRxStatus(EndpointStatus::Valid);
+        }
+
+        /**
+         * @brief Stops bridge (USART reception, OUT packets are NAKed)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop()
+        {
+            _OutEp::SetRxStatus(EndpointStatus::Nak);
+            _Usart::DisableCircularRead();
+        }
+
+        /**
+         * @brief Applies line coding to USART (subscribe it to CDC communication interface)
+         *
+         * @details
+         * Supported frames are 8N, 8E, 8O, 7E and 7O with 1, 1.5 or 2 stop bits.
+         * Other data bits and mark/space parity are replaced with 8N.
+         * Data in flight is lost, hosts change line coding on port open usually.
+         *
+         * @param [in] lineCoding Line coding
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetLineCoding(const LineCoding& lineCoding)
+        {
+            // USART word length includes parity bit
+            bool parity = lineCoding.ParityType == 1 || lineCoding.ParityType == 2;
+            bool supported = parity ? (lineCoding.DataBits == 7 || lineCoding.DataBits == 8) : lineCoding.DataBits == 8;
+            if (!supported)
+                parity = false;
+
+            auto cr1 = !parity
+                ? UsartMode::DataBits8 | UsartMode::NoneParity
+                : (lineCoding.DataBits == 8 ? UsartMode::DataBits9 : UsartMode::DataBits8)
+                    | (lineCoding.ParityType == 1 ? UsartMode::OddParity : UsartMode::EvenParity);
+            auto cr2 = lineCoding.CharFormat == 1
+                ? UsartMode::OneAndHalfStopBits
+                : (lineCoding.CharFormat == 2 ? UsartMode::TwoStopBits : UsartMode::OneStopBit);
+
+            _Usart::ModifyConfig(UsartMode{static_cast<typename UsartMode::_CR1>(UsartMode::DataBits9 | UsartMode::OddParity), UsartMode::OneAndHalfStopBits, UsartMode::FullDuplex},
+                UsartMode{static_cast<typename UsartMode::_CR1>(cr1), cr2, UsartMode::FullDuplex});
+
+            if (lineCoding.BaudRate != 0)
+                _Usart::SetBaud(lineCoding.BaudRate);
+        }
+
+        /**
+         * @brief Returns device to host overruns count
+         *
+         * @returns Count of USART data losses (host didn't read data in time)
+         */
+        static uint32_t Overruns()
+        {
+            return _overruns;
+        }
+
+        /**
+         * @brief OUT endpoint handler (call it from endpoint HandleRx, do not set RX status there)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void RxHandler()
+        {
+#if defined (USB)
+            const void* pma;
+            uint16_t size;
+            if constexpr (requires { _OutEp::RxBufferCount::Get(); })
+            {
+                pma = reinterpret_cast<const void*>(_OutEp::RxBuffer);
+                size = _OutEp::RxBufferCount::Get() & 0x3ff;
+            }
+            else
+            {
+                pma = reinterpret_cast<const void*>(_OutEp::Buffer);
+                size = _OutEp::BufferCount::Get() & 0x3ff;
+            }
+
+            auto region = _txBuffer.writable_span();
+            if (region.size() >= size)
+            {
+                CopyFromUsbPma(region.data(), pma, size);
+                _txBuffer.commit(size);
+            }
+            else
+            {
+                // Packet wraps ring, so it's copied to ring by parts
+                uint8_t packet[_OutEp::MaxPacketSize];
+                CopyFromUsbPma(packet, pma, size);
+                Store(packet, size);
+            }
+#else
+            Store(_OutEp::Buffer, _OutEp::BufferSize);
+#endif
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            StartUsartTx();
+            if (_TxSize - _txBuffer.size() >= _OutEp::MaxPacketSize)
+                _OutEp::SetRxStatus(EndpointStatus::Valid);
+            else
+                _outStalled = true;
+            __set_PRIMASK(primask);
+        }
+
+    private:
+        static void Store(const uint8_t* data, unsigned size)
+        {
+            while (size > 0)
+            {
+                auto region = _txBuffer.writable_span();
+                if (region.empty())
+                    break;
+
+                unsigned chunk = region.size() < size ? region.size() : size;
+                memcpy(region.data(), data, chunk);
+                _txBuffer.commit(chunk);
+                data += chunk;
+                size -= chunk;
+            }
+        }
+
+        static void StartUsartTx()
+        {
+            if (_txBusy)
+                return;
+
+            auto region = _txBuffer.readable_span();
+            if (region.empty())
+                return;
+
+            _txBusy = true;
+            _txSending = region.size();
+            _Usart::WriteAsync(region.data(), region.size(), UsartTxComplete);
+        }
+
+        static void UsartTxComplete([[maybe_unused]] void* data, [[maybe_unused]] unsigned size, [[maybe_unused]] bool success)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _txBuffer.consume(_txSending);
+            _txSending = 0;
+            _txBusy = false;
+            StartUsartTx();
+
+            if (_outStalled && _TxSize - _txBuffer.size() >= _OutEp::MaxPacketSize)
+            {
+                _outStalled = false;
+                _OutEp::SetRxStatus(EndpointStatus::Valid);
+            }
+            __set_PRIMASK(primask);
+        }
+
+        static void Received([[maybe_unused]] const void* data, unsigned size)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _received += size;
+            StartUsbTx();
+            __set_PRIMASK(primask);
+        }
+
+        static void StartUsbTx()
+        {
+            if (_inSending != 0)
+                return;
+
+            // Unsent data is overwritten by USART DMA: skip it
+            if (_received - _sent > _RxSize)
+            {
+                ++_overruns;
+                _sent = _received;
+            }
+
+            uint32_t offset = _sent % _RxSize;
+            uint32_t available = _received - _sent;
+            uint32_t size = available < _RxSize - offset ? available : _RxSize - offset;
+            if (size == 0)
+                return;
+
+            _inSending = size;
+            _InEp::SendData(_rxBuffer + offset, size, UsbTxComplete);
+        }
+
+        static void UsbTxComplete()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _sent += _inSending;
+            _inSending = 0;
+            StartUsbTx();
+            __set_PRIMASK(primask);
+        }
+
+        static Containers::RingBuffer<_TxSize, uint8_t> _txBuffer;
+        static unsigned _txSending;
+        static volatile bool _txBusy;
+        static volatile bool _outStalled;
+
+        alignas(4) static uint8_t _rxBuffer[_RxSize];
+        static uint32_t _received;
+        static uint32_t _sent;
+        static uint32_t _inSending;
+        static uint32_t _overruns;
+    };
+
+    #define CDC_USART_BRIDGE_TEMPLATE_ARGS template<typename _Usart, typename _InEp, typename _OutEp, unsigned _TxSize, unsigned _RxSize>
+    #define CDC_USART_BRIDGE_TEMPLATE_QUALIFIER CdcUsartBridge<_Usart, _InEp, _OutEp, _TxSize, _RxSize>
+
+    CDC_USART_BRIDGE_TEMPLATE_ARGS
+    Containers::RingBuffer<_TxSize, uint8_t> CDC_USART_BRIDGE_TEMPLATE_QUALIFIER::_txBuffer;
+
+    CDC_USART_BRIDGE_TEMPLATE_ARGS
+    unsigned CDC_USART_BRIDGE_TEMPLATE_QUALIFIER::_txSending = 0;
+
+    CDC_USART_BRIDGE_TEMPLATE_ARGS
+    volatile bool CDC_USART_BRIDGE_TEMPLATE_QUALIFIER::_txBusy = false;
+
+    CDC_USART_BRIDGE_TEMPLATE_ARGS
+    volatile bool CDC_USART_BRIDGE_TEMPLATE_QUALIFIER::_outStalled = false;
+
+    CDC_USART_BRIDGE_TEMPLATE_ARGS
+    alignas(4) uint8_t CDC_USART_BRIDGE_TEMPLATE_QUALIFIER::_rxBuffer[_RxSize];
+
+    CDC_USART_BRIDGE_TEMPLATE_ARGS
+    uint32_t CDC_USART_BRIDGE_TEMPLATE_QUALIFIER::_received = 0;
+
+    CDC_USART_BRIDGE_TEMPLATE_ARGS
+    uint32_t CDC_USART_BRIDGE_TEMPLATE_QUALIFIER::_sent = 0;
+
+    CDC_USART_BRIDGE_TEMPLATE_ARGS
+    uint32_t CDC_USART_BRIDGE_TEMPLATE_QUALIFIER::_inSending = 0;
+
+    CDC_USART_BRIDGE_TEMPLATE_ARGS
+    uint32_t CDC_USART_BRIDGE_TEMPLATE_QUALIFIER::_overruns = 0;
+}
+
+#endif //! ZHELE_USB_CDC_USART_BRIDGE_H
@@ -24,33 +24,197 @@ namespace Zhele::Usb
     const unsigned PmaAlignMultiplier = 1;
 #endif
 
-    inline void CopyFromUsbPma(void* destination, const void* source, unsigned size)
+    namespace Private
     {
-        if constexpr(PmaAlignMultiplier != 1) {
-            for(int i = 0; i < size / 2; ++i) {
-                reinterpret_cast<uint16_t*>(destination)[i] = reinterpret_cast<const uint16_t*>(source)[PmaAlignMultiplier * i];
+        /**
+         * @brief Loads word from unaligned address
+         *
+         * @details
+         * It's one LDR on Cortex-M3/M4 (unaligned access is supported), byte loads on Cortex-M0.
+         *
+         * @param [in] source Source
+         *
+         * @returns Word
+         */
+        inline uint32_t LoadUnalignedWord(const uint8_t* source)
+        {
+            uint32_t value;
+            memcpy(&value, source, sizeof(value));
+            return value;
+        }
+
+        /**
+         * @brief Stores word to unaligned address
+         *
+         * @param [in] destination Destination
+         * @param [in] value Word
+         *
+         * @par Returns
+         *  Nothing
+         */
+        inline void StoreUnalignedWord(uint8_t* destination, uint32_t value)
+        {
+            memcpy(destination, &value, sizeof(value));
+        }
+
+        /**
+         * @brief Copies words to PMA (every word is stored as two halfwords)
+         *
+         * @tparam _Aligned Source is word-aligned
+         *
+         * @param [in] destination PMA halfword
+         * @param [in] source Source
+         * @param [in] words Words count
+         *
+         * @returns Next PMA halfword
+         */
+        template<bool _Aligned>
+        inline volatile uint16_t* CopyWordsToUsbPma(volatile uint16_t* destination, const uint8_t* source, unsigned words)
+        {
+            const auto load = [](const uint8_t* address) {
+                if constexpr (_Aligned)
+                    return *reinterpret_cast<const uint32_t*>(address);
+                else
+                    return LoadUnalignedWord(address);
+            };
+
+            // 16 bytes per iteration: loads are grouped to use LDM/LDRD and free pipeline from loop overhead
+            for (; words >= 4; words -= 4, source += 16, destination += 8 * PmaAlignMultiplier)
+            {
+                uint32_t word0 = load(source);
+                uint32_t word1 = load(source + 4);
+                uint32_t word2 = load(source + 8);
+                uint32_t word3 = load(source + 12);
+                destination[0 * PmaAlignMultiplier] = word0;
+                destination[1 * PmaAlignMultiplier] = word0 >> 16;
+                destination[2 * PmaAlignMultiplier] = word1;
+                destination[3 * PmaAlignMultiplier] = word1 >> 16;
+                destination[4 * PmaAlignMultiplier] = word2;
+                destination[5 * PmaAlignMultiplier] = word2 >> 16;
+                destination[6 * PmaAlignMultiplier] = word3;
+                destination[7 * PmaAlignMultiplier] = word3 >> 16;
             }
-            if(size & 0x01) {
-                reinterpret_cast<uint8_t*>(&destination)[size - 1] = reinterpret_cast<const uint8_t*>(source)[PmaAlignMultiplier * (size - 1)];
+            for (; words > 0; --words, source += 4, destination += 2 * PmaAlignMultiplier)
+            {
+                uint32_t word = load(source);
+                destination[0] = word;
+                destination[PmaAlignMultiplier] = word >> 16;
             }
+            return destination;
+        }
+
+        /**
+         * @brief Copies words from PMA (every word is loaded as two halfwords)
+         *
+         * @tparam _Aligned Destination is word-aligned
+         *
+         * @param [in] destination Destination
+         * @param [in] source PMA halfword
+         * @param [in] words Words count
+         *
+         * @returns Next PMA halfword
+         */
+        template<bool _Aligned>
+        inline const volatile uint16_t* CopyWordsFromUsbPma(uint8_t* destination, const volatile uint16_t* source, unsigned words)
+        {
+            const auto store = [](uint8_t* address, uint32_t value) {
+                if constexpr (_Aligned)
+                    *reinterpret_cast<uint32_t*>(address) = value;
+                else
+                    StoreUnalignedWord(address, value);
+            };
+
+            for (; words >= 4; words -= 4, destination += 16, source += 8 * PmaAlignMultiplier)
+            {
+                uint32_t word0 = source[0 * PmaAlignMultiplier] | (source[1 * PmaAlignMultiplier] << 16);
+                uint32_t word1 = source[2 * PmaAlignMultiplier] | (source[3 * PmaAlignMultiplier] << 16);
+                uint32_t word2 = source[4 * PmaAlignMultiplier] | (source[5 * PmaAlignMultiplier] << 16);
+                uint32_t word3 = source[6 * PmaAlignMultiplier] | (source[7 * PmaAlignMultiplier] << 16);
+                store(destination, word0);
+                store(destination + 4, word1);
+                store(destination + 8, word2);
+                store(destination + 12, word3);
+            }
+            for (; words > 0; --words, destination += 4, source += 2 * PmaAlignMultiplier)
+            {
+                store(destination, source[0] | (source[PmaAlignMultiplier] << 16));
+            }
+            return source;
+        }
+    }
+
+    /**
+     * @brief Copies data from USB packet memory
+     *
+     * @details
+     * PMA is accessed by halfwords only (with gaps on 2x16 layout), user memory is accessed by words.
+     *
+     * @param [out] destination Destination
+     * @param [in] source PMA buffer
+     * @param [in] size Data size (in bytes)
+     *
+     * @par Returns
+     *  Nothing
+     */
+    inline void CopyFromUsbPma(void* destination, const void* source, unsigned size)
+    {
+        uint8_t* bytes = static_cast<uint8_t*>(destination);
+        const volatile uint16_t* pma = static_cast<const volatile uint16_t*>(source);
+        unsigned words = size / 4;
+
+        pma = (reinterpret_cast<uintptr_t>(bytes) & 0x03) == 0
+            ? Private::CopyWordsFromUsbPma<true>(bytes, pma, words)
+            : Private::CopyWordsFromUsbPma<false>(bytes, pma, words);
+        bytes += words * 4;
+
+        if (size & 0x02)
+        {
+            uint16_t halfword = *pma;
+            bytes[0] = halfword;
+            bytes[1] = halfword >> 8;
+            bytes += 2;
+            pma += PmaAlignMultiplier;
         }
-        else {
-            memcpy(destination, source, size);
+        if (size & 0x01)
+        {
+            bytes[0] = *pma;
         }
     }
 
+    /**
+     * @brief Copies data to USB packet memory
+     *
+     * @details
+     * PMA is accessed by halfwords only (with gaps on 2x16 layout), user memory is accessed by words
+     * (unaligned source is supported).
+     *
+     * @param [out] destination PMA buffer
+     * @param [in] source Source
+     * @param [in] size Data size (in bytes)
+     *
+     * @par Returns
+     *  Nothing
+     */
     inline void CopyToUsbPma(void* destination, const void* source, unsigned size)
     {
-        if constexpr(PmaAlignMultiplier != 1) {
-            for(int i = 0; i < size / 2; ++i) {
-                reinterpret_cast<uint16_t*>(destination)[PmaAlignMultiplier * i] = reinterpret_cast<const uint16_t*>(source)[i];
-            }
-            if(size & 0x01) {
-                reinterpret_cast<uint8_t*>(&destination)[PmaAlignMultiplier * (size - 1)] = reinterpret_cast<const uint8_t*>(source)[size - 1];
-            }
+        const uint8_t* bytes = static_cast<const uint8_t*>(source);
+        volatile uint16_t* pma = static_cast<volatile uint16_t*>(destination);
+        unsigned words = size / 4;
+
+        pma = (reinterpret_cast<uintptr_t>(bytes) & 0x03) == 0
+            ? Private::CopyWordsToUsbPma<true>(pma, bytes, words)
+            : Private::CopyWordsToUsbPma<false>(pma, bytes, words);
+        bytes += words * 4;
+
+        if (size & 0x02)
+        {
+            *pma = bytes[0] | (bytes[1] << 8);
+            bytes += 2;
+            pma += PmaAlignMultiplier;
         }
-        else {
-            memcpy(destination, source, size);
+        if (size & 0x01)
+        {
+            *pma = bytes[0];
         }
     }
 
@@ -82,6 +246,7 @@ namespace Zhele::Usb
         Storage = 0x08, ///< Storage device
         Hub = 0x09, ///< Hub
         CdcData = 0x0a, ///< CDC Data
+        ApplicationSpecific = 0xfe, ///< Application specific (DFU)
         VendorSpecified = 0xff ///< Vendor specified device
     };
     using InterfaceClass = DeviceAndInterfaceClass; // legacy
@@ -119,6 +284,7 @@ namespace Zhele::Usb
         StringSerialNumberDescriptor = 0x303, ///< String serial number descriptor
         StringMsOsDescriptor = 0x3ee, ///< MS OS Descriptor
         DeviceQualifierDescriptor = 0x600, ///< Device qualifier descriptor
+        BosDescriptor = 0xf00, ///< Binary device object store descriptor
     };
 
     /**
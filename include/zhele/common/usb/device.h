@@ -10,14 +10,22 @@
 #ifndef ZHELE_USB_DEVICE_H
 #define ZHELE_USB_DEVICE_H
 
+#include "audio.h"
 #include "configuration.h"
 #include "cdc.h"
+#include "cdc_serial.h"
+#include "cdc_usart_bridge.h"
+#include "dfu.h"
 #include "endpoints_manager.h"
 #include "hid.h"
 #include "interface.h"
 #include "msc.h"
+#include "msc_stream.h"
+#include "transfer_queue.h"
+#include "winusb.h"
 
 #include "../ioreg.h"
+#include "../profiling.h"
 #include "../../common/template_utils/fixed_string.h"
 
 #include <type_traits>
@@ -59,6 +67,12 @@ namespace Zhele::Usb
     };
 #pragma pack(pop)
 
+    /// Start of frame callback (called from USB interrupt every 1 ms)
+    using SofCallback = std::add_pointer_t<void(uint16_t frameNumber)>;
+
+    /// Suspend/resume callback (called from USB interrupt)
+    using SuspendCallback = std::add_pointer_t<void(bool suspended)>;
+
     /**
      * @brief Implements USB device.
      * 
@@ -135,6 +149,7 @@ namespace Zhele::Usb
         static constexpr auto _epBufferManager = EndpointsManager{_endpoints.template push_back<_Ep0>()};
         static constexpr auto _epHandlers = EndpointHandlers{_endpoints.template push_back<This>()}; // Replace Ep0 with this for correct handler register.
         static constexpr auto _ifHandlers = InterfaceHandlers{(TypeList<>{} + ... + _Configurations::Interfaces)};
+        static constexpr auto _msOsDescriptors = MsOs20Descriptors{_interfaces};
 #if defined (USB_OTG_FS)
         static constexpr auto _outEndpoints = _endpoints.filter([](auto endpoint){
             return endpoint.Direction == EndpointDirection::Out || endpoint.Direction == EndpointDirection::Bidirectional;
@@ -144,6 +159,18 @@ namespace Zhele::Usb
 
         static uint8_t _tempAddressStorage;
         static volatile bool _isDeviceConfigured;
+        static SofCallback _sofCallback;
+        static SuspendCallback _suspendCallback;
+        static volatile bool _suspended;
+        static volatile bool _remoteWakeupEnabled;
+#if defined (USB)
+        static volatile uint8_t _resumeFrames;
+#endif
+
+        /// Resume signalling length (in 1 ms frames, USB requires 1 to 15 ms)
+        static const uint8_t ResumeSignallingFrames = 4;
+        /// DEVICE_REMOTE_WAKEUP feature selector
+        static const uint16_t RemoteWakeupFeature = 1;
     public:
         /**
          * @brief Select clock source
@@ -182,6 +209,83 @@ namespace Zhele::Usb
          */
         static bool IsDeviceConfigured();
 
+        /**
+         * @brief Set start of frame callback (SOF interrupt is enabled only with callback)
+         * 
+         * @details
+         * Callback can be used as 1 ms time base that is synchronous with host
+         * (for example, for isochronous streams).
+         * 
+         * @param [in] callback Callback (nullptr disables SOF interrupt)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetSofCallback(SofCallback callback);
+
+        /**
+         * @brief Set suspend/resume callback
+         * 
+         * @details
+         * On bus suspend (3 ms idle) peripheral is switched to low-power mode (FSUSP and LPMODE
+         * or PHY clock gating for OTG) and callback is called with true, so application can drop
+         * system clocks (host allows 2.5 mA only). On resume (host resume signalling, bus reset
+         * or @ref RemoteWakeup) peripheral leaves low-power mode before callback is called with false.
+         * Endpoint registers and packet memory are kept in low-power mode, so nothing is restored.
+         * 
+         * To wake MCU up from Stop mode enable USB wakeup EXTI line (rising edge), @ref Power::PowerManager
+         * restores PLL before USB interrupt is handled, so resume is handled well within 10 ms recovery time.
+         * 
+         * @par Example
+         * @code
+         *  MyDevice::SetSuspendCallback([](bool suspended) {
+         *      // Stop mode is allowed while bus is suspended
+         *      suspended ? Power::Unlock(Power::Mode::Sleep) : Power::Lock(Power::Mode::Sleep);
+         *  });
+         *  Power::Lock(Power::Mode::Sleep);
+         *  MyDevice::Enable();
+         *  for (;;)
+         *      Power::Idle();
+         * @endcode
+         * 
+         * @param [in] callback Callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetSuspendCallback(SuspendCallback callback);
+
+        /**
+         * @brief Checks bus is suspended
+         * 
+         * @retval true Device is suspended
+         * @retval false Device is active
+         */
+        static bool IsSuspended();
+
+        /**
+         * @brief Checks host enabled remote wakeup (SET_FEATURE DEVICE_REMOTE_WAKEUP)
+         * 
+         * @details
+         * Host enables remote wakeup only for configuration with remote wakeup attribute.
+         * 
+         * @retval true Remote wakeup is enabled
+         * @retval false Remote wakeup is disabled
+         */
+        static bool IsRemoteWakeupEnabled();
+
+        /**
+         * @brief Wakes host up (for example, on HID key press while bus is suspended)
+         * 
+         * @details
+         * Method leaves low-power mode and starts resume signalling, it's stopped
+         * from USB interrupt after @ref ResumeSignallingFrames ms (system clock must be restored already).
+         * 
+         * @retval true Resume signalling is started
+         * @retval false Device is not suspended or host didn't enable remote wakeup
+         */
+        static bool RemoteWakeup();
+
         /**
          * @brief Common USB handler
          *
@@ -219,6 +323,31 @@ namespace Zhele::Usb
          */
         static void SetAddress(uint16_t address);
 
+        /**
+         * @brief Switches peripheral to low-power mode (bus suspend)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Suspend();
+
+        /**
+         * @brief Switches peripheral from low-power mode (bus resume)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Resume();
+#if defined (USB_OTG_FS)
+
+        /**
+         * @brief Returns power and clock gating control register (PCGCCTL)
+         * 
+         * @returns Register reference
+         */
+        static volatile uint32_t& ClockGating();
+#endif
+
         /**
          * @brief Calculate DAINTMSK value for OTG
          * 
@@ -0,0 +1,538 @@
+/**
+ * @file
+ * Implements USB DFU 1.1 class (DFU mode interface)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_DFU_H
+#define ZHELE_USB_DFU_H
+
+#include "common.h"
+#include "endpoint.h"
+#include "interface.h"
+
+#include <zhele/flash.h>
+#include <zhele/system_time.h>
+
+#include <array>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @def ZHELE_USB_DFU_ERASE_TIME
+ * @brief Initial flash page erase time estimation (ms)
+ * @details
+ * It's used for bwPollTimeout until first erase is measured (by SystemTime, if it's running).
+ * Default value is typical page erase time from F0/G0 datasheets.
+ */
+#if !defined (ZHELE_USB_DFU_ERASE_TIME)
+    #define ZHELE_USB_DFU_ERASE_TIME 25
+#endif
+
+namespace Zhele::Usb
+{
+    /**
+     * @brief DFU class requests
+     */
+    enum class DfuRequest : uint8_t
+    {
+        Detach = 0x00, ///< Detach
+        Dnload = 0x01, ///< Download block
+        Upload = 0x02, ///< Upload block
+        GetStatus = 0x03, ///< Get status
+        ClrStatus = 0x04, ///< Clear error status
+        GetState = 0x05, ///< Get state
+        Abort = 0x06, ///< Abort transfer
+    };
+
+    /**
+     * @brief DFU states
+     */
+    enum class DfuState : uint8_t
+    {
+        AppIdle = 0, ///< Application is running
+        AppDetach = 1, ///< Application waits for reset
+        Idle = 2, ///< DFU mode, waits for requests
+        DnloadSync = 3, ///< Block is received, waits GETSTATUS
+        DnBusy = 4, ///< Block is being programmed
+        DnloadIdle = 5, ///< Waits next block
+        ManifestSync = 6, ///< Last block is received, waits GETSTATUS
+        Manifest = 7, ///< Manifestation is in progress
+        ManifestWaitReset = 8, ///< Waits reset
+        UploadIdle = 9, ///< Upload is in progress
+        Error = 10, ///< Error, waits CLRSTATUS
+    };
+
+    /**
+     * @brief DFU status codes
+     */
+    enum class DfuStatus : uint8_t
+    {
+        Ok = 0x00, ///< No error
+        ErrTarget = 0x01, ///< File is not targeted for this device
+        ErrFile = 0x02, ///< File fails verification
+        ErrWrite = 0x03, ///< Device is unable to write memory
+        ErrErase = 0x04, ///< Memory erase failed
+        ErrCheckErased = 0x05, ///< Memory erase check failed
+        ErrProg = 0x06, ///< Program memory failed
+        ErrVerify = 0x07, ///< Programmed memory failed verification
+        ErrAddress = 0x08, ///< Address is out of range
+        ErrNotDone = 0x09, ///< Zero-length download, but firmware is not complete
+        ErrFirmware = 0x0a, ///< Firmware is corrupt
+        ErrVendor = 0x0b, ///< Vendor-specific error
+        ErrUsbReset = 0x0c, ///< Unexpected USB reset
+        ErrPowerOnReset = 0x0d, ///< Unexpected power on reset
+        ErrUnknown = 0x0e, ///< Unknown error
+        ErrStalledPacket = 0x0f, ///< Unexpected request
+    };
+
+    /**
+     * @brief Implements DFU 1.1 interface (DFU mode) over Flash
+     *
+     * @details
+     * Firmware image is downloaded to flash region [_Address, _Address + _Size), block N is written
+     * at _Address + N * _TransferSize (dfu-util -D image.bin). Received blocks are double-buffered:
+     * EP0 data stage is finished as soon as block is copied to free buffer, GETSTATUS reports dfuDNLOAD-IDLE
+     * (without poll timeout) while there is free buffer, so host sends block N+1 while block N is erased
+     * and programmed by @ref Process in main loop. When both buffers are full, GETSTATUS reports dfuDNBUSY
+     * with bwPollTimeout estimated from measured page erase and block program times.
+     * Pages are erased when first block reaches them, every block is verified after programming.
+     * Upload reads flash region (dfu-util -U).
+     *
+     * Interface is manifestation tolerant: after zero-length download and completion of all pending
+     * writes it returns to dfuIDLE, @ref Completed returns true and application may reset to new firmware.
+     * CPU stalls on flash fetch during erase (single-bank parts), so USB reception overlaps programming
+     * only if USB interrupt handler is in RAM (see @ref ZHELE_RAMFUNC), otherwise packets are NAKed while erasing.
+     *
+     * @par Example
+     * @code
+     *  // Bootloader occupies first 16K, application is the rest of 64K flash
+     *  using Dfu = DfuInterface<0, Ep0, FLASH_BASE + 0x4000, 48 * 1024>;
+     *  using Config = Configuration<0, 250, false, false, Dfu>;
+     *  using MyDevice = Device<0x0200, DeviceAndInterfaceClass::InterfaceSpecified, 0, 0, 0x0483, 0xdf11, 0, Ep0, Config>;
+     *  ...
+     *  while (!Dfu::Completed())
+     *      Dfu::Process();
+     *  NVIC_SystemReset();
+     * @endcode
+     *
+     * @tparam _Number Interface number
+     * @tparam _Ep0 Zero endpoint instance
+     * @tparam _Address Firmware region address (must be page aligned)
+     * @tparam _Size Firmware region size
+     * @tparam _TransferSize Block size (wTransferSize)
+     * @tparam _Flash Flash (@ref Flash or flash with same interface)
+     */
+    template <uint8_t _Number, typename _Ep0, uint32_t _Address, uint32_t _Size, uint16_t _TransferSize = 1024, typename _Flash = Flash>
+    class DfuInterface : public Interface<_Number, 0, DeviceAndInterfaceClass::ApplicationSpecific, 0x01, 0x02, _Ep0>
+    {
+        static_assert(_TransferSize >= 64 && _TransferSize % 8 == 0, "Transfer size must be multiple of 8 and not less than 64");
+
+        static const uint8_t FunctionalDescriptorSize = 9;
+        static const uint8_t DfuFunctionalDescriptor = 0x21;
+        /// bitCanDnload | bitCanUpload | bitManifestationTolerant
+        static const uint8_t Attributes = 0x01 | 0x02 | 0x04;
+        static const uint16_t DetachTimeout = 1000;
+        static const uint8_t Buffers = 2;
+    public:
+        /**
+         * @brief Interface setup request handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            SetupPacket* setup = reinterpret_cast<SetupPacket*>(_Ep0::RxBuffer);
+
+            if (setup->RequestType.Type != 1)
+            {
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+                return;
+            }
+
+            switch (static_cast<DfuRequest>(setup->Request))
+            {
+            case DfuRequest::Dnload:
+                Download(setup->Value, setup->Length);
+                break;
+            case DfuRequest::Upload:
+                Upload(setup->Value, setup->Length);
+                break;
+            case DfuRequest::GetStatus:
+                SendStatus();
+                break;
+            case DfuRequest::ClrStatus:
+                if (_state == DfuState::Error)
+                {
+                    _status = DfuStatus::Ok;
+                    _state = DfuState::Idle;
+                }
+                _Ep0::SendZLP();
+                break;
+            case DfuRequest::GetState:
+                _Ep0::SendData(const_cast<const DfuState*>(&_state), 1);
+                break;
+            case DfuRequest::Abort:
+                if (_state != DfuState::Error)
+                    _state = DfuState::Idle;
+                _Ep0::SendZLP();
+                break;
+            case DfuRequest::Detach:
+                _Ep0::SendZLP();
+                break;
+            default:
+                Fail(DfuStatus::ErrStalledPacket);
+                break;
+            }
+        }
+
+        /**
+         * @brief Build DFU interface descriptor
+         *
+         * @returns Bytes of interface descriptor
+         */
+        static consteval auto GetDescriptor()
+        {
+            std::array<uint8_t, sizeof(InterfaceDescriptor) + FunctionalDescriptorSize> result;
+
+            constexpr auto head = InterfaceDescriptor {
+                .Number = _Number,
+                .AlternateSetting = 0,
+                .EndpointsCount = 0,
+                .Class = DeviceAndInterfaceClass::ApplicationSpecific,
+                .SubClass = 0x01, // Device firmware upgrade
+                .Protocol = 0x02 // DFU mode
+            }.GetBytes();
+            auto dst = std::copy(head.begin(), head.end(), result.begin());
+
+            constexpr std::array<uint8_t, FunctionalDescriptorSize> functional {
+                FunctionalDescriptorSize,
+                DfuFunctionalDescriptor,
+                Attributes,
+                DetachTimeout & 0xff, DetachTimeout >> 8,
+                _TransferSize & 0xff, _TransferSize >> 8,
+                0x10, 0x01 // bcdDFUVersion 1.1
+            };
+            std::copy(functional.begin(), functional.end(), dst);
+
+            return result;
+        }
+
+        /**
+         * @brief Reset interface (on USB reset)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            if (_state != DfuState::Idle && _state != DfuState::Error)
+                _state = DfuState::Idle;
+        }
+
+        /**
+         * @brief Programs received blocks (call it from main loop)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Process()
+        {
+            if (_pending == 0)
+                return;
+
+            const uint8_t* data = _buffers[_readIndex];
+            uint32_t address = _blockAddress[_readIndex];
+            uint16_t size = _blockSize[_readIndex];
+
+            DfuStatus status = Program(address, data, size);
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _readIndex = (_readIndex + 1) % Buffers;
+            --_pending;
+            if (status != DfuStatus::Ok)
+            {
+                // Remaining blocks are dropped, host gets error by next GETSTATUS
+                _pending = 0;
+                _readIndex = _writeIndex;
+                _status = status;
+                _state = DfuState::Error;
+            }
+            __set_PRIMASK(primask);
+        }
+
+        /**
+         * @brief Returns firmware download is completed (manifestation phase is passed)
+         *
+         * @retval true Firmware is downloaded and programmed
+         * @retval false Download is not completed
+         */
+        static bool Completed()
+        {
+            return _completed;
+        }
+
+        /**
+         * @brief Returns current state
+         *
+         * @returns DFU state
+         */
+        static DfuState State()
+        {
+            return _state;
+        }
+
+    private:
+        static void Download(uint16_t block, uint16_t length)
+        {
+            if (_state != DfuState::Idle && _state != DfuState::DnloadIdle)
+            {
+                Fail(DfuStatus::ErrStalledPacket);
+                return;
+            }
+
+            if (length == 0)
+            {
+                // Zero-length download is end of image, it's accepted only after some blocks
+                if (_state != DfuState::DnloadIdle)
+                {
+                    Fail(DfuStatus::ErrNotDone);
+                    return;
+                }
+                _state = DfuState::ManifestSync;
+                _Ep0::SendZLP();
+                return;
+            }
+
+            uint32_t offset = static_cast<uint32_t>(block) * _TransferSize;
+            if (length > _TransferSize || offset >= _Size || length > _Size - offset || _pending == Buffers)
+            {
+                Fail(length > _TransferSize || _pending == Buffers ? DfuStatus::ErrStalledPacket : DfuStatus::ErrAddress);
+                return;
+            }
+
+            if (_state == DfuState::Idle)
+            {
+                _erasedEnd = _Address;
+                _completed = false;
+            }
+
+            _rxAddress = _Address + offset;
+            _rxExpected = length;
+            _rxReceived = 0;
+            _Ep0::SetOutDataTransferCallback(RxHandler);
+            _Ep0::SetRxStatus(EndpointStatus::Valid);
+        }
+
+        static void RxHandler()
+        {
+            uint8_t* buffer = _buffers[_writeIndex] + _rxReceived;
+            uint16_t remain = _rxExpected - _rxReceived;
+#if defined (USB)
+            uint16_t size = _Ep0::RxBufferCount::Get() & 0x3ff;
+            if (size > remain)
+                size = remain;
+            CopyFromUsbPma(buffer, reinterpret_cast<const void*>(_Ep0::RxBuffer), size);
+#else
+            uint16_t size = _Ep0::BufferSize;
+            if (size > remain)
+                size = remain;
+            memcpy(buffer, _Ep0::RxBuffer, size);
+#endif
+            _rxReceived += size;
+
+            if (_rxReceived < _rxExpected && size > 0)
+            {
+                _Ep0::SetRxStatus(EndpointStatus::Valid);
+                return;
+            }
+
+            _Ep0::ResetOutDataTransferCallback();
+            _blockAddress[_writeIndex] = _rxAddress;
+            _blockSize[_writeIndex] = _rxReceived;
+            _writeIndex = (_writeIndex + 1) % Buffers;
+            ++_pending;
+            _state = DfuState::DnloadSync;
+            _Ep0::SendZLP();
+        }
+
+        static void Upload(uint16_t block, uint16_t length)
+        {
+            if ((_state != DfuState::Idle && _state != DfuState::UploadIdle) || _pending > 0)
+            {
+                Fail(DfuStatus::ErrStalledPacket);
+                return;
+            }
+
+            uint32_t offset = static_cast<uint32_t>(block) * _TransferSize;
+            uint32_t size = offset < _Size ? _Size - offset : 0;
+            if (size > length)
+                size = length;
+            if (size > _TransferSize)
+                size = _TransferSize;
+
+            // Short packet is end of upload
+            _state = size < length ? DfuState::Idle : DfuState::UploadIdle;
+            _Ep0::SendData(reinterpret_cast<const void*>(_Address + offset), size);
+        }
+
+        static void SendStatus()
+        {
+            uint32_t pollTimeout = 0;
+            switch (_state)
+            {
+            case DfuState::DnloadSync:
+            case DfuState::DnBusy:
+                // Next block is accepted while there is free buffer
+                if (_pending < Buffers)
+                {
+                    _state = DfuState::DnloadIdle;
+                }
+                else
+                {
+                    _state = DfuState::DnBusy;
+                    pollTimeout = _eraseTime + _programTime;
+                }
+                break;
+            case DfuState::ManifestSync:
+            case DfuState::Manifest:
+                if (_pending > 0)
+                {
+                    _state = DfuState::Manifest;
+                    pollTimeout = _pending * (_eraseTime + _programTime);
+                }
+                else
+                {
+                    _state = DfuState::Idle;
+                    _completed = true;
+                }
+                break;
+            default:
+                break;
+            }
+
+            _statusResponse = {
+                static_cast<uint8_t>(_status),
+                static_cast<uint8_t>(pollTimeout), static_cast<uint8_t>(pollTimeout >> 8), static_cast<uint8_t>(pollTimeout >> 16),
+                static_cast<uint8_t>(_state),
+                0
+            };
+            _Ep0::SendData(_statusResponse.data(), _statusResponse.size());
+        }
+
+        static void Fail(DfuStatus status)
+        {
+            _status = status;
+            _state = DfuState::Error;
+            _Ep0::SetTxStatus(EndpointStatus::Stall);
+        }
+
+        static DfuStatus Program(uint32_t address, const uint8_t* data, uint16_t size)
+        {
+            bool measure = SystemTime::Running();
+
+            // Blocks are sequential, so pages are erased once (when first block reaches them)
+            uint32_t end = address + size;
+            uint32_t eraseAddress = _erasedEnd > address ? _erasedEnd : address;
+            while (eraseAddress < end)
+            {
+                unsigned page = _Flash::AddressToPage(reinterpret_cast<const void*>(eraseAddress));
+                uint32_t start = measure ? SystemTime::Millis() : 0;
+                if (!_Flash::ErasePage(page))
+                    return DfuStatus::ErrErase;
+                if (measure)
+                    _eraseTime = SystemTime::Millis() - start + 1;
+                eraseAddress = _Flash::PageAddress(page) + _Flash::PageSize(page);
+            }
+            if (eraseAddress > _erasedEnd)
+                _erasedEnd = eraseAddress;
+
+            uint32_t start = measure ? SystemTime::Millis() : 0;
+            void* destination = reinterpret_cast<void*>(address);
+            if (!_Flash::WriteFlash(destination, data, size))
+                return DfuStatus::ErrProg;
+            if (measure)
+                _programTime = SystemTime::Millis() - start + 1;
+
+            return memcmp(destination, data, size) == 0 ? DfuStatus::Ok : DfuStatus::ErrVerify;
+        }
+
+        alignas(4) static uint8_t _buffers[Buffers][_TransferSize];
+        static uint32_t _blockAddress[Buffers];
+        static uint16_t _blockSize[Buffers];
+        static uint8_t _writeIndex;
+        static uint8_t _readIndex;
+        static volatile uint8_t _pending;
+
+        static uint32_t _rxAddress;
+        static uint16_t _rxExpected;
+        static uint16_t _rxReceived;
+
+        static volatile DfuState _state;
+        static DfuStatus _status;
+        static volatile bool _completed;
+        static uint32_t _erasedEnd;
+        static uint32_t _eraseTime;
+        static uint32_t _programTime;
+        static std::array<uint8_t, 6> _statusResponse;
+    };
+
+    #define DFU_INTERFACE_TEMPLATE_ARGS template <uint8_t _Number, typename _Ep0, uint32_t _Address, uint32_t _Size, uint16_t _TransferSize, typename _Flash>
+    #define DFU_INTERFACE_TEMPLATE_QUALIFIER DfuInterface<_Number, _Ep0, _Address, _Size, _TransferSize, _Flash>
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    alignas(4) uint8_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_buffers[Buffers][_TransferSize];
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint32_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_blockAddress[Buffers];
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint16_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_blockSize[Buffers];
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint8_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_writeIndex = 0;
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint8_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_readIndex = 0;
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    volatile uint8_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_pending = 0;
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint32_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_rxAddress = 0;
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint16_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_rxExpected = 0;
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint16_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_rxReceived = 0;
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    volatile DfuState DFU_INTERFACE_TEMPLATE_QUALIFIER::_state = DfuState::Idle;
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    DfuStatus DFU_INTERFACE_TEMPLATE_QUALIFIER::_status = DfuStatus::Ok;
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    volatile bool DFU_INTERFACE_TEMPLATE_QUALIFIER::_completed = false;
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint32_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_erasedEnd = _Address;
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint32_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_eraseTime = ZHELE_USB_DFU_ERASE_TIME;
+
+    // Initial estimation: about 50 us per half word
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint32_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_programTime = _TransferSize / 2 * 50 / 1000 + 1;
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    std::array<uint8_t, 6> DFU_INTERFACE_TEMPLATE_QUALIFIER::_statusResponse = {};
+}
+
+#endif // ZHELE_USB_DFU_H
@@ -17,6 +17,7 @@
 #ifndef ZHELE_USB_ENDPOINT_H
 #define ZHELE_USB_ENDPOINT_H
 
+#include "../statistics.h"
 #include "../template_utils/type_list.h"
 #include "../template_utils/static_array.h"
 
@@ -120,6 +121,9 @@ namespace Zhele::Usb
         static const EndpointType Type = _Type;
         static const uint16_t MaxPacketSize = _MaxPacketSize;
         static const uint8_t Interval = _Interval;
+
+        /// Runtime counters (packets, ZLPs, NAK states set by firmware), enabled by ZHELE_STATISTICS
+        using Counters = Statistics::Counters<Statistics::EndpointCounters, EndpointBase>;
     };
 
     template<uint8_t _Number, EndpointDirection _Direction, EndpointType _Type, uint16_t _MaxPacketSize, uint8_t _Interval>
@@ -161,6 +165,35 @@ namespace Zhele::Usb
         const static bool DisableZlp;
     };
 
+    /**
+     * @brief Implements bulk endpoint base with multi-packet transfers
+     *
+     * @details
+     * On OTG core OUT endpoint receives up to _Packets packets in one transfer (HandleRx is called
+     * once per transfer or after short packet) and IN endpoint TX FIFO holds _Packets packets.
+     * On USB device with PMA parameter is ignored, so endpoint is the same as simple bulk endpoint.
+     *
+     * @tparam _Number Endpoint number (address)
+     * @tparam _Direction Endpoint direction (In or Out)
+     * @tparam _MaxPacketSize Max packet size
+     * @tparam _Packets Packets count in transfer (FIFO)
+     */
+    template<uint8_t _Number, EndpointDirection _Direction, uint16_t _MaxPacketSize, uint8_t _Packets>
+    class BulkMultiPacketEndpointBase : public UniDirectionalEndpointBase<_Number, _Direction, EndpointType::Bulk, _MaxPacketSize, 0>
+    {
+        static_assert(_Direction != EndpointDirection::Bidirectional, "Multi-packet endpoint must be unidirectional");
+        static_assert(_Packets > 0, "Packets count must be positive");
+    public:
+        static const uint8_t Packets = _Packets;
+    };
+
+    template<uint8_t _Number, uint16_t _MaxPacketSize, uint8_t _Packets>
+    class InBulkMultiPacketWithoutZlpEndpointBase : public BulkMultiPacketEndpointBase<_Number, EndpointDirection::In, _MaxPacketSize, _Packets>
+    {
+    public:
+        const static bool DisableZlp;
+    };
+
     template <uint8_t _Number, uint16_t _MaxPacketSize>
     class ControlEndpointBase : public EndpointBase<_Number, EndpointDirection::Bidirectional, EndpointType::Control, _MaxPacketSize, 0>
     {      
@@ -171,6 +204,39 @@ namespace Zhele::Usb
     {
     }; 
 #if defined (USB)
+    /**
+     * @brief Isochronous endpoint synchronization type
+     */
+    enum class IsochronousSyncType : uint8_t
+    {
+        None = 0, ///< No synchronization
+        Asynchronous = 1, ///< Asynchronous (device clock)
+        Adaptive = 2, ///< Adaptive
+        Synchronous = 3, ///< Synchronous (SOF)
+    };
+
+    /**
+     * @brief Implements isochronous endpoint base
+     *
+     * @details
+     * Isochronous endpoint is double-buffered in packet memory: application fills (reads) one buffer
+     * while USB transfers another one, buffers are switched by hardware every frame.
+     * Isochronous endpoints are supported on USB device with PMA only.
+     *
+     * @tparam _Number Endpoint number (address)
+     * @tparam _Direction Endpoint direction (In or Out)
+     * @tparam _MaxPacketSize Max packet size (up to 1023 bytes)
+     * @tparam _SyncType Synchronization type (bits 3:2 of endpoint attributes)
+     */
+    template<uint8_t _Number, EndpointDirection _Direction, uint16_t _MaxPacketSize, IsochronousSyncType _SyncType = IsochronousSyncType::Asynchronous>
+    class IsochronousEndpointBase : public UniDirectionalEndpointBase<_Number, _Direction, EndpointType::Isochronous, _MaxPacketSize, 1>
+    {
+        static_assert(_Direction != EndpointDirection::Bidirectional, "Isochronous endpoint must be unidirectional");
+        static_assert(_MaxPacketSize <= 1023, "Full-speed isochronous packet is up to 1023 bytes");
+    public:
+        static const IsochronousSyncType SyncType = _SyncType;
+    };
+
     /**
      * @brief Endpoint type values for EPnR registers.
      */
@@ -255,6 +321,8 @@ namespace Zhele::Usb
         */
         static void SetRxStatus(EndpointStatus status)
         {
+            if (status == EndpointStatus::Nak)
+                _Base::Counters::Add(Statistics::EndpointCounters::Naks);
             ToogleAndSet<USB_EPREG_MASK | USB_EPRX_STAT, USB_EP_CTR_TX | USB_EP_CTR_RX>(static_cast<uint16_t>(status) << 12);
         }
         /**
@@ -267,6 +335,8 @@ namespace Zhele::Usb
         */
         static void SetTxStatus(EndpointStatus status)
         {
+            if (status == EndpointStatus::Nak)
+                _Base::Counters::Add(Statistics::EndpointCounters::Naks);
             ToogleAndSet<USB_EPREG_MASK | USB_EPTX_STAT, USB_EP_CTR_TX | USB_EP_CTR_RX>(static_cast<uint16_t>(status) << 4);
         }
         /**
@@ -390,6 +460,7 @@ namespace Zhele::Usb
          */
         static void SendData(uint16_t size)
         {
+            CountPacket(size);
             BufferCountReg::Set(size);
             _Endpoint::SetTxStatus(EndpointStatus::Valid);
         }
@@ -405,14 +476,20 @@ namespace Zhele::Usb
          */
         static void SendData(const void* data, uint16_t size)
         {
-            const uint16_t* source = reinterpret_cast<const uint16_t*>(data);
-            uint16_t* destination = reinterpret_cast<uint16_t*>(_BufferAddress);
-            for(uint16_t i = 0; i < (size + 1) / 2; ++i)
-                destination[PmaAlignMultiplier * i] = source[i];
+            CopyToUsbPma(reinterpret_cast<void*>(_BufferAddress), data, size);
 
+            CountPacket(size);
             BufferCountReg::Set(size);
             _Endpoint::SetTxStatus(EndpointStatus::Valid);
         }
+
+    private:
+        static void CountPacket(uint16_t size)
+        {
+            _Endpoint::Counters::Add(Statistics::EndpointCounters::InPackets);
+            if (size == 0)
+                _Endpoint::Counters::Add(Statistics::EndpointCounters::Zlps);
+        }
     };
 
     // Using std::function allows lambdas as callbacks, but takes ~1,2Kb flash and ~100 bytes RAM.
@@ -565,6 +642,7 @@ namespace Zhele::Usb
         static void Handler()
         {
             Base::ClearCtrRx();
+            _Base::Counters::Add(Statistics::EndpointCounters::OutPackets);
             HandleRx();       
         }
 
@@ -629,6 +707,7 @@ namespace Zhele::Usb
             if(Reg::Get() & USB_EP_CTR_RX)
             {
                 Base::ClearCtrRx();
+                _Base::Counters::Add(Statistics::EndpointCounters::OutPackets);
                 HandleRx();
             }
             if(Reg::Get() & USB_EP_CTR_TX)
@@ -680,6 +759,7 @@ namespace Zhele::Usb
         static void Handler()
         {
             Base::ClearCtrRx();
+            _Base::Counters::Add(Statistics::EndpointCounters::OutPackets);
 
             GetCurrentBuffer() == 0
                 ? HandleRx(reinterpret_cast<void*>(Buffer0), Buffer0Count::Get() & 0x3ff)
@@ -810,16 +890,14 @@ namespace Zhele::Usb
          */
         static void WriteData(const void* data, uint16_t size)
         {
-            uint16_t* destination;
-            destination = reinterpret_cast<uint16_t*>(GetCurrentBuffer() == 0 ? Buffer0 : Buffer1);
+            CopyToUsbPma(reinterpret_cast<void*>(GetCurrentBuffer() == 0 ? Buffer0 : Buffer1), data, size);
 
-            const uint16_t* source = reinterpret_cast<const uint16_t*>(data);
-            for(uint16_t i = 0; i < (size + 1) / 2; ++i)
-                destination[PmaAlignMultiplier * i] = source[i];
-
-            
             GetCurrentBuffer() == 0 ? Buffer0Count::Set(size) : Buffer1Count::Set(size);
 
+            _Base::Counters::Add(Statistics::EndpointCounters::InPackets);
+            if (size == 0)
+                _Base::Counters::Add(Statistics::EndpointCounters::Zlps);
+
             SwitchBuffer();
         }
 
@@ -872,7 +950,354 @@ namespace Zhele::Usb
         OutBulkDoubleBufferedEndpoint<_Base, _Reg, _Buffer0Address, _Count0RegAddress, _Buffer1Address, _Count1RegAddress>,
         InBulkDoubleBufferedEndpoint<_Base, _Reg, _Buffer0Address, _Count0RegAddress, _Buffer1Address, _Count1RegAddress>
         >;
+
+    /**
+     * @brief Implements in (TX) isochronous endpoint
+     *
+     * @details
+     * USB transfers buffer selected by DTOG_TX and application writes another one.
+     * Endpoint handler calls TX callback after every transferred packet (once per frame),
+     * so callback should write next packet by @ref WritePacket. If packet is not written,
+     * previous buffer content is sent again (write zero-size packet to send nothing).
+     *
+     * @tparam _Base Enpoint base (@ref IsochronousEndpointBase)
+     * @tparam _Reg EPnR register
+     * @tparam _Buffer0Address Buffer0 address
+     * @tparam _Count0RegAddress Count0 register address
+     * @tparam _Buffer1Address Buffer1 address
+     * @tparam _Count1RegAddress Count1 register address
+     */
+    template<typename _Base, typename _Reg, uint32_t _Buffer0Address, uint32_t _Count0RegAddress, uint32_t _Buffer1Address, uint32_t _Count1RegAddress>
+    class IsochronousInEndpoint : public Endpoint<_Base, _Reg>
+    {
+        using Base = Endpoint<_Base, _Reg>;
+
+        using Reg = _Reg;
+        static constexpr uint32_t Buffer0 = _Buffer0Address;
+        using Buffer0Count = RegisterWrapper<_Count0RegAddress, uint16_t>;
+        static constexpr uint32_t Buffer1 = _Buffer1Address;
+        using Buffer1Count = RegisterWrapper<_Count1RegAddress, uint16_t>;
+    public:
+        /**
+         * @brief Reset endpoint (endpoint is stopped)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            Base::Reset();
+            Base::SetTxStatus(EndpointStatus::Disable);
+            Buffer0Count::Set(0);
+            Buffer1Count::Set(0);
+        }
+
+        /**
+         * @brief Build endpoint descriptor (with synchronization type)
+         *
+         * @returns Bytes of descriptor
+         */
+        static consteval auto GetDescriptor()
+        {
+            return EndpointDescriptor{
+                .Address = static_cast<uint8_t>(Base::Number) | 0x80,
+                .Attributes = static_cast<uint8_t>(static_cast<uint8_t>(EndpointType::Isochronous) | (static_cast<uint8_t>(_Base::SyncType) << 2)),
+                .MaxPacketSize = Base::MaxPacketSize,
+                .Interval = Base::Interval}.GetBytes();
+        }
+
+        /**
+         * @brief Set TX callback (called from USB interrupt after every transferred packet)
+         *
+         * @param [in] callback Callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetTxCallback(InTransferCallback callback)
+        {
+            _txCallback = callback;
+        }
+
+        /**
+         * @brief Write next packet to application buffer
+         *
+         * @param [in] data Data
+         * @param [in] size Data size (not greater than max packet size)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void WritePacket(const void* data, uint16_t size)
+        {
+            if (GetCurrentBuffer() == 0)
+            {
+                CopyToUsbPma(reinterpret_cast<void*>(Buffer0), data, size);
+                Buffer0Count::Set(size);
+            }
+            else
+            {
+                CopyToUsbPma(reinterpret_cast<void*>(Buffer1), data, size);
+                Buffer1Count::Set(size);
+            }
+        }
+
+        /**
+         * @brief Start streaming (first packets are zero-size)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start()
+        {
+            Buffer0Count::Set(0);
+            Buffer1Count::Set(0);
+            Base::SetTxStatus(EndpointStatus::Valid);
+        }
+
+        /**
+         * @brief Stop streaming
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop()
+        {
+            Base::SetTxStatus(EndpointStatus::Disable);
+        }
+
+        /**
+         * @brief CTR handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Handler()
+        {
+            Base::ClearCtrTx();
+
+            if (_txCallback)
+                _txCallback();
+        }
+
+    private:
+        /**
+         * @brief Returns current buffer for application.
+         * 
+         * @retval 0 Buffer_0 should be used.
+         * @retval 1 Buffer_1 should be used.
+         */
+        static uint8_t GetCurrentBuffer()
+        {
+            return (Reg::Get() & USB_EP_DTOG_TX) > 0
+                ? 0
+                : 1;
+        }
+
+        static InTransferCallback _txCallback;
+    };
+
+    template<typename _Base, typename _Reg, uint32_t _Buffer0Address, uint32_t _Count0RegAddress, uint32_t _Buffer1Address, uint32_t _Count1RegAddress>
+    InTransferCallback IsochronousInEndpoint<_Base, _Reg, _Buffer0Address, _Count0RegAddress, _Buffer1Address, _Count1RegAddress>::_txCallback = nullptr;
+
+    /**
+     * @brief Implements out (RX) isochronous endpoint
+     *
+     * @details
+     * USB receives packet to buffer selected by DTOG_RX and handler passes another
+     * (just received) buffer to HandleRx. Isochronous transfer has no handshake,
+     * so HandleRx should copy data before next frame.
+     *
+     * @tparam _Base Enpoint base (@ref IsochronousEndpointBase)
+     * @tparam _Reg EPnR register
+     * @tparam _Buffer0Address Buffer0 address
+     * @tparam _Count0RegAddress Count0 register address
+     * @tparam _Buffer1Address Buffer1 address
+     * @tparam _Count1RegAddress Count1 register address
+     */
+    template<typename _Base, typename _Reg, uint32_t _Buffer0Address, uint32_t _Count0RegAddress, uint32_t _Buffer1Address, uint32_t _Count1RegAddress>
+    class IsochronousOutEndpoint : public Endpoint<_Base, _Reg>
+    {
+        using Base = Endpoint<_Base, _Reg>;
+
+        using Reg = _Reg;
+        static constexpr uint32_t Buffer0 = _Buffer0Address;
+        using Buffer0Count = RegisterWrapper<_Count0RegAddress, uint16_t>;
+        static constexpr uint32_t Buffer1 = _Buffer1Address;
+        using Buffer1Count = RegisterWrapper<_Count1RegAddress, uint16_t>;
+    public:
+        /**
+         * @brief Reset endpoint (endpoint is stopped)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            Base::Reset();
+            Base::SetRxStatus(EndpointStatus::Disable);
+        }
+
+        /**
+         * @brief Build endpoint descriptor (with synchronization type)
+         *
+         * @returns Bytes of descriptor
+         */
+        static consteval auto GetDescriptor()
+        {
+            return EndpointDescriptor{
+                .Address = static_cast<uint8_t>(Base::Number),
+                .Attributes = static_cast<uint8_t>(static_cast<uint8_t>(EndpointType::Isochronous) | (static_cast<uint8_t>(_Base::SyncType) << 2)),
+                .MaxPacketSize = Base::MaxPacketSize,
+                .Interval = Base::Interval}.GetBytes();
+        }
+
+        /**
+         * @brief Start streaming
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start()
+        {
+            Base::SetRxStatus(EndpointStatus::Valid);
+        }
+
+        /**
+         * @brief Stop streaming
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop()
+        {
+            Base::SetRxStatus(EndpointStatus::Disable);
+        }
+
+        /**
+         * @brief CTR handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Handler()
+        {
+            Base::ClearCtrRx();
+
+            (Reg::Get() & USB_EP_DTOG_RX) > 0
+                ? HandleRx(reinterpret_cast<void*>(Buffer0), Buffer0Count::Get() & 0x3ff)
+                : HandleRx(reinterpret_cast<void*>(Buffer1), Buffer1Count::Get() & 0x3ff);
+        }
+
+    private:
+        static void HandleRx(void* data, uint16_t size);
+    };
+
+    /**
+     * @brief Implements isochronous endpoint (selects in or out implementation)
+     * 
+     * @tparam _Base Enpoint base
+     * @tparam _Reg EPnR register
+     * @tparam _Buffer0Address Buffer0 address
+     * @tparam _Count0RegAddress Count0 register address
+     * @tparam _Buffer1Address Buffer1 address
+     * @tparam _Count1RegAddress Count1 register address
+     */
+    template<typename _Base, typename _Reg, uint32_t _Buffer0Address, uint32_t _Count0RegAddress, uint32_t _Buffer1Address, uint32_t _Count1RegAddress>
+    using IsochronousEndpoint = std::conditional_t<
+        _Base::Direction == EndpointDirection::Out,
+        IsochronousOutEndpoint<_Base, _Reg, _Buffer0Address, _Count0RegAddress, _Buffer1Address, _Count1RegAddress>,
+        IsochronousInEndpoint<_Base, _Reg, _Buffer0Address, _Count0RegAddress, _Buffer1Address, _Count1RegAddress>
+        >;
 #elif defined (USB_OTG_FS)
+    /**
+     * @brief Returns packets count in endpoint transfer (@ref BulkMultiPacketEndpointBase)
+     *
+     * @tparam _Endpoint Endpoint
+     *
+     * @returns Packets count (2 for IN endpoint TX FIFO and 1 for OUT endpoint if endpoint has no packets count)
+     */
+    template<typename _Endpoint>
+    consteval uint8_t GetEndpointPackets()
+    {
+        if constexpr (requires { _Endpoint::Packets; })
+            return _Endpoint::Packets;
+        else
+            return _Endpoint::Direction == EndpointDirection::Out ? 1 : 2;
+    }
+
+    namespace Private
+    {
+        /**
+         * @brief Writes data to OTG FIFO
+         *
+         * @details
+         * FIFO is accessed by 32-bit words only, copy is unrolled by 4 words.
+         * Source can be unaligned, tail bytes are not read beyond data.
+         *
+         * @param [in] fifo FIFO
+         * @param [in] source Data
+         * @param [in] size Data size (in bytes)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        inline void WriteOtgFifo(volatile uint32_t* fifo, const uint8_t* source, unsigned size)
+        {
+            for (; size >= 4 * sizeof(uint32_t); size -= 4 * sizeof(uint32_t), source += 4 * sizeof(uint32_t))
+            {
+                *fifo = LoadUnalignedWord(source);
+                *fifo = LoadUnalignedWord(source + 4);
+                *fifo = LoadUnalignedWord(source + 8);
+                *fifo = LoadUnalignedWord(source + 12);
+            }
+            for (; size >= sizeof(uint32_t); size -= sizeof(uint32_t), source += sizeof(uint32_t))
+            {
+                *fifo = LoadUnalignedWord(source);
+            }
+            if (size > 0)
+            {
+                uint32_t tail = 0;
+                memcpy(&tail, source, size);
+                *fifo = tail;
+            }
+        }
+
+        /**
+         * @brief Reads data from OTG FIFO
+         *
+         * @details
+         * FIFO is accessed by 32-bit words only, copy is unrolled by 4 words.
+         * Destination can be unaligned, tail bytes are not written beyond data.
+         *
+         * @param [in] fifo FIFO
+         * @param [out] destination Destination
+         * @param [in] size Data size (in bytes)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        inline void ReadOtgFifo(volatile uint32_t* fifo, uint8_t* destination, unsigned size)
+        {
+            for (; size >= 4 * sizeof(uint32_t); size -= 4 * sizeof(uint32_t), destination += 4 * sizeof(uint32_t))
+            {
+                StoreUnalignedWord(destination, *fifo);
+                StoreUnalignedWord(destination + 4, *fifo);
+                StoreUnalignedWord(destination + 8, *fifo);
+                StoreUnalignedWord(destination + 12, *fifo);
+            }
+            for (; size >= sizeof(uint32_t); size -= sizeof(uint32_t), destination += sizeof(uint32_t))
+            {
+                StoreUnalignedWord(destination, *fifo);
+            }
+            if (size > 0)
+            {
+                uint32_t tail = *fifo;
+                memcpy(destination, &tail, size);
+            }
+        }
+    }
+
     /**
      * @brief Implements endpoint
      * 
@@ -960,9 +1385,14 @@ namespace Zhele::Usb
     template<typename _Base, typename _Regs, uint32_t _FifoAddress>
     class OutEndpoint : public Endpoint<_Base>
     {
+        static const uint8_t Packets = GetEndpointPackets<_Base>();
+        static_assert(Packets == 1 || _Base::MaxPacketSize % sizeof(uint32_t) == 0, "Multi-packet endpoint max packet size must be multiple of 4");
     public:
-        static uint8_t BufferSize;
-        static uint8_t Buffer[_Base::MaxPacketSize];
+        /// Buffer capacity (whole transfer)
+        static const uint16_t BufferCapacity = _Base::MaxPacketSize * Packets;
+
+        static uint16_t BufferSize;
+        static uint8_t Buffer[BufferCapacity];
 
         /**
          * @brief Reset endpoint
@@ -984,8 +1414,8 @@ namespace Zhele::Usb
             }
             else
             {
-                _Regs()->DOEPTSIZ = (1 << USB_OTG_DOEPTSIZ_PKTCNT_Pos)
-                    | (_Base::MaxPacketSize << USB_OTG_DOEPTSIZ_XFRSIZ_Pos);
+                _Regs()->DOEPTSIZ = (Packets << USB_OTG_DOEPTSIZ_PKTCNT_Pos)
+                    | (BufferCapacity << USB_OTG_DOEPTSIZ_XFRSIZ_Pos);
                 _Regs()->DOEPCTL = USB_OTG_DOEPCTL_EPENA 
                     | USB_OTG_DOEPCTL_CNAK
                     | (static_cast<uint32_t>(_Base::Type) << USB_OTG_DOEPCTL_EPTYP_Pos)
@@ -995,11 +1425,15 @@ namespace Zhele::Usb
         }
 
         /**
-         * @brief RX fifo not empty handler
+         * @brief Endpoint interrupt handler (RX transfer complete)
          */
         static void Handler()
         {
-            HandleRx();
+            uint32_t interrupts = _Regs()->DOEPINT;
+            _Regs()->DOEPINT = interrupts;
+
+            if (interrupts & USB_OTG_DOEPINT_XFRC)
+                HandleRx();
         }
 
         /**
@@ -1028,12 +1462,13 @@ namespace Zhele::Usb
                 _Regs()->DOEPCTL |= USB_OTG_DOEPCTL_STALL;
                 break;
             case EndpointStatus::Nak:
+                _Base::Counters::Add(Statistics::EndpointCounters::Naks);
                 _Regs()->DOEPCTL |= USB_OTG_DOEPCTL_SNAK;
                 break;
             case EndpointStatus::Valid:
                 BufferSize = 0;
-                _Regs()->DOEPTSIZ = (1 << USB_OTG_DOEPTSIZ_PKTCNT_Pos)
-                    | (_Base::MaxPacketSize << USB_OTG_DOEPTSIZ_XFRSIZ_Pos);
+                _Regs()->DOEPTSIZ = (Packets << USB_OTG_DOEPTSIZ_PKTCNT_Pos)
+                    | (BufferCapacity << USB_OTG_DOEPTSIZ_XFRSIZ_Pos);
                 _Regs()->DOEPCTL |= USB_OTG_DOEPCTL_CNAK | USB_OTG_DOEPCTL_EPENA;
                 break;
             }
@@ -1068,10 +1503,18 @@ namespace Zhele::Usb
          */
         static void HandlerFifoNotEmpty(uint16_t size)
         {
-            for(int i = 0; i < (size + 3) / 4; ++i)
+            volatile uint32_t* fifo = reinterpret_cast<volatile uint32_t*>(_FifoAddress);
+            _Base::Counters::Add(Statistics::EndpointCounters::OutPackets);
+
+            // Packet must be popped from FIFO even if buffer has no room
+            if (BufferSize + size > BufferCapacity)
             {
-                reinterpret_cast<uint32_t*>(Buffer + BufferSize)[i] = *reinterpret_cast<uint32_t*>(_FifoAddress);
+                for (unsigned i = 0; i < (size + 3u) / 4u; ++i)
+                    (void)*fifo;
+                return;
             }
+
+            Private::ReadOtgFifo(fifo, Buffer + BufferSize, size);
             BufferSize += size;
         }
 
@@ -1120,10 +1563,10 @@ namespace Zhele::Usb
     OutTransferCallback OutEndpoint<_Base, _Regs, _FifoAddress>::_dataTransferCallback = nullptr;
 
     template<typename _Base, typename _Regs, uint32_t _FifoAddress>
-    uint8_t OutEndpoint<_Base, _Regs, _FifoAddress>::BufferSize = 0;
+    uint16_t OutEndpoint<_Base, _Regs, _FifoAddress>::BufferSize = 0;
 
     template<typename _Base, typename _Regs, uint32_t _FifoAddress>
-    uint8_t OutEndpoint<_Base, _Regs, _FifoAddress>::Buffer[_Base::MaxPacketSize] = {};
+    uint8_t OutEndpoint<_Base, _Regs, _FifoAddress>::Buffer[BufferCapacity] = {};
 
     using InTransferCallback = std::add_pointer_t<void()>;
     /**
@@ -1220,6 +1663,7 @@ namespace Zhele::Usb
                 _Regs()->DIEPCTL |= USB_OTG_DIEPCTL_STALL;
                 break;
             case EndpointStatus::Nak:
+                _Base::Counters::Add(Statistics::EndpointCounters::Naks);
                 _Regs()->DIEPCTL |= USB_OTG_DIEPCTL_SNAK;
                 break;
             case EndpointStatus::Valid:
@@ -1250,6 +1694,8 @@ namespace Zhele::Usb
             _txCompleteCallback = callback;
             _Regs()->DIEPTSIZ = (1 << USB_OTG_DIEPTSIZ_PKTCNT_Pos)
                 | (0 << USB_OTG_DIEPTSIZ_XFRSIZ_Pos);
+            _Base::Counters::Add(Statistics::EndpointCounters::InPackets);
+            _Base::Counters::Add(Statistics::EndpointCounters::Zlps);
             SetTxStatus(EndpointStatus::Valid);
         }
 
@@ -1262,13 +1708,14 @@ namespace Zhele::Usb
          */
         static void SendData(const void* data, uint32_t size, InTransferCallback callback = nullptr)
         {
-            _dataToTransmit = reinterpret_cast<const uint32_t*>(data);
+            _dataToTransmit = reinterpret_cast<const uint8_t*>(data);
             _needZlpSend = size % _Base::MaxPacketSize == 0;
             _txCompleteCallback = callback;
 
             uint32_t packetsCount = (size + _Base::MaxPacketSize - 1) / _Base::MaxPacketSize;
 
             _Regs()->DIEPTSIZ = (packetsCount << USB_OTG_DIEPTSIZ_PKTCNT_Pos) | (size << USB_OTG_DIEPTSIZ_XFRSIZ_Pos);
+            _Base::Counters::Add(Statistics::EndpointCounters::InPackets, packetsCount);
 
             TxFifoEmptyInterruptMask::Set();
 
@@ -1297,14 +1744,35 @@ namespace Zhele::Usb
         }
         
         /**
-         * @brief Handle TX FIFO not empty
+         * @brief Handle TX FIFO empty
+         *
+         * @details
+         * FIFO is filled with as many packets as it can hold (not one packet per interrupt),
+         * FIFO empty interrupt is disabled after the last packet is written.
          * 
          * @par Returns
          *  Nothing
          */
         static void HandleFifoEmpty()
         {
-            SendPacket();
+            // Core decrements XFRSIZ on every packet is written to FIFO
+            uint32_t bytesRemain = _Regs()->DIEPTSIZ & USB_OTG_DIEPTSIZ_XFRSIZ;
+
+            while (bytesRemain > 0)
+            {
+                uint32_t packetSize = bytesRemain < _Base::MaxPacketSize
+                    ? bytesRemain
+                    : _Base::MaxPacketSize;
+
+                if ((_Regs()->DTXFSTS & USB_OTG_DTXFSTS_INEPTFSAV) < (packetSize + sizeof(uint32_t) - 1) / sizeof(uint32_t))
+                    break;
+
+                SendPacket(packetSize);
+                bytesRemain -= packetSize;
+            }
+
+            if (bytesRemain == 0)
+                TxFifoEmptyInterruptMask::Clear();
         }
 
         /**
@@ -1315,29 +1783,20 @@ namespace Zhele::Usb
          * @par Returns
          *  Nothing
          */
-        inline static void SendPacket()
+        inline static void SendPacket(uint32_t size)
         {
-            int32_t bytesRemain = _Regs()->DIEPTSIZ & USB_OTG_DIEPTSIZ_XFRSIZ;
-
-            int32_t doubleWordsToWrite = (
-                (bytesRemain < _Base::MaxPacketSize
-                    ? bytesRemain
-                    : _Base::MaxPacketSize)
-                + sizeof(uint32_t) - 1) / sizeof(uint32_t);
-
-            for(int i = 0; i < doubleWordsToWrite; ++i) {
-                *reinterpret_cast<uint32_t*>(_FifoAddress) = *(_dataToTransmit++);
-            }
+            Private::WriteOtgFifo(reinterpret_cast<volatile uint32_t*>(_FifoAddress), _dataToTransmit, size);
+            _dataToTransmit += size;
         }
 
     private:
-        static const uint32_t* _dataToTransmit;
+        static const uint8_t* _dataToTransmit;
         static bool _needZlpSend;
         static InTransferCallback _txCompleteCallback;
     };
     
     template<typename _Base, typename _Regs, uint8_t _FifoNumber, uint32_t _FifoAddress>
-    const uint32_t* InEndpoint<_Base, _Regs, _FifoNumber, _FifoAddress>::_dataToTransmit = nullptr;
+    const uint8_t* InEndpoint<_Base, _Regs, _FifoNumber, _FifoAddress>::_dataToTransmit = nullptr;
 
     template<typename _Base, typename _Regs, uint8_t _FifoNumber, uint32_t _FifoAddress>
     bool InEndpoint<_Base, _Regs, _FifoNumber, _FifoAddress>::_needZlpSend = false;
@@ -44,6 +44,23 @@ namespace Zhele::Usb
         static const EndpointType Type = EndpointType::Control;
     };
 
+    /**
+     * @brief Check that endpoint uses two buffers of the same direction
+     * 
+     * @details
+     * Isochronous endpoints on USB device with PMA are always double-buffered
+     * (like @ref BulkDoubleBufferedEndpointBase), so they have the same layout.
+     * 
+     * @param [in] endpoint Boxed endpoint
+     * 
+     * @retval true Endpoint is double-buffered
+     * @retval false Endpoint is single-buffered
+     */
+    consteval bool IsDoubleBufferedEndpoint(auto endpoint)
+    {
+        return endpoint.Type == EndpointType::BulkDoubleBuffered || endpoint.Type == EndpointType::Isochronous;
+    }
+
     /**
      * @brief USB offsets calculator
      * 
@@ -72,17 +89,85 @@ namespace Zhele::Usb
             constexpr auto index = _endpoints.search(endpoint);
 
             if constexpr (index == 0) {
-                return 0;
+                return 0u;
             } else {
                 constexpr auto previousEndpoint = _endpoints.template get<index - 1>();
 
-                return GetBufferOffset(previousEndpoint) + 
-                    ((previousEndpoint.Type == EndpointType::BulkDoubleBuffered
-                    || previousEndpoint.Direction == EndpointDirection::Bidirectional)
-                        ? previousEndpoint.MaxPacketSize * 2
-                        : previousEndpoint.MaxPacketSize);
+                return GetBufferOffset(previousEndpoint) + GetBufferSize(previousEndpoint);
             }
         }
+
+        /**
+         * @brief Returns TX buffer size for given endpoint
+         * 
+         * @details
+         * Packet memory is accessed by halfwords, so buffer size is rounded up to even.
+         * 
+         * @param [in] endpoint Boxed endpoint
+         * 
+         * @returns Buffer size
+        */
+        static consteval unsigned GetTxBufferSize(auto endpoint) {
+            return (endpoint.MaxPacketSize + 1u) & ~1u;
+        }
+
+        /**
+         * @brief Returns RX buffer size for given endpoint
+         * 
+         * @details
+         * RX buffer is allocated by 2-byte blocks (up to 62 bytes) or by 32-byte blocks,
+         * so buffer size is rounded up to block size (buffer is never smaller than allocated in BDT).
+         * 
+         * @param [in] endpoint Boxed endpoint
+         * 
+         * @returns Buffer size
+        */
+        static consteval unsigned GetRxBufferSize(auto endpoint) {
+            return endpoint.MaxPacketSize <= 62
+                ? (endpoint.MaxPacketSize + 1u) & ~1u
+                : (endpoint.MaxPacketSize + 31u) & ~31u;
+        }
+
+        /**
+         * @brief Returns size of first endpoint buffer (TX buffer or Buffer0)
+         * 
+         * @param [in] endpoint Boxed endpoint
+         * 
+         * @returns Buffer size
+        */
+        static consteval unsigned GetFirstBufferSize(auto endpoint) {
+            return endpoint.Direction == EndpointDirection::Out
+                ? GetRxBufferSize(endpoint)
+                : GetTxBufferSize(endpoint);
+        }
+
+        /**
+         * @brief Returns all buffers size for given endpoint
+         * 
+         * @param [in] endpoint Boxed endpoint
+         * 
+         * @returns Buffers size
+        */
+        static consteval unsigned GetBufferSize(auto endpoint) {
+            if (endpoint.Direction == EndpointDirection::Bidirectional)
+                return GetTxBufferSize(endpoint) + GetRxBufferSize(endpoint);
+            if (IsDoubleBufferedEndpoint(endpoint))
+                return 2 * GetFirstBufferSize(endpoint);
+            return GetFirstBufferSize(endpoint);
+        }
+
+        /**
+         * @brief Returns total size of all endpoints buffers
+         * 
+         * @returns Buffers size
+        */
+        static consteval unsigned GetTotalBuffersSize() {
+            unsigned size = 0;
+            _endpoints.foreach([&size](auto endpoint) {
+                size += GetBufferSize(endpoint);
+            });
+            return size;
+        }
         /**
          * @brief Template version of @ref GetBufferOffset method
         */
@@ -105,7 +190,7 @@ namespace Zhele::Usb
                 return 0;
             } else {
                 constexpr auto previousEndpoint = _endpoints.template get<index - 1>();
-                return endpoint.Type == EndpointType::BulkDoubleBuffered
+                return IsDoubleBufferedEndpoint(endpoint)
                     ? 4 + GetPacketDescriptorOffset(previousEndpoint)
                     : 2 + GetPacketDescriptorOffset(previousEndpoint);
             }
@@ -124,6 +209,33 @@ namespace Zhele::Usb
     OffsetCalculator(TypeList<Endpoints...> endpoints) -> OffsetCalculator<Endpoints...>;
 
 #if defined (USB)
+    /// USB packet memory size (in bytes)
+    #if !defined (ZHELE_USB_PMA_SIZE)
+        #if defined (STM32F1) || defined (STM32F3)
+            #define ZHELE_USB_PMA_SIZE 512
+        #else
+            #define ZHELE_USB_PMA_SIZE 1024
+        #endif
+    #endif
+
+    /**
+     * @brief Packet memory budget check
+     * 
+     * @details
+     * Compiler prints template arguments in instantiation context of failed assert,
+     * so error message contains used and available packet memory size.
+     * 
+     * @tparam _Used Used packet memory (BDT and buffers, in bytes)
+     * @tparam _Available Packet memory size (ZHELE_USB_PMA_SIZE)
+     */
+    template<unsigned _Used, unsigned _Available>
+    struct PmaBudget
+    {
+        static_assert(_Used <= _Available, "USB packet memory overflow (see PmaBudget<used, available>): "
+            "reduce MaxPacketSize, use unidirectional endpoints or set ZHELE_USB_PMA_SIZE");
+        static const bool Fits = true;
+    };
+
     /**
      * @brief Calculates endpoint`s registers.
      * 
@@ -173,10 +285,10 @@ namespace Zhele::Usb
 
                 constexpr bool IsEndpointIncompatibleWithPrevious = endpoint.Number == previousEndpoint.Number &&
                 (endpoint.Type == EndpointType::Control
-                    || endpoint.Type == EndpointType::BulkDoubleBuffered
+                    || IsDoubleBufferedEndpoint(endpoint)
                     || endpoint.Direction == EndpointDirection::Bidirectional
                     || previousEndpoint.Type == EndpointType::Control
-                    || previousEndpoint.Type == EndpointType::BulkDoubleBuffered
+                    || IsDoubleBufferedEndpoint(previousEndpoint)
                     || previousEndpoint.Direction == EndpointDirection::Bidirectional);
 
                 static_assert(!IsEndpointIncompatibleWithPrevious, "Incompatible endpoints with same number");
@@ -231,6 +343,8 @@ namespace Zhele::Usb
         static constexpr auto _offsetCalculator = OffsetCalculator{_sortedUniqueEndpoints};
         /// Buffer descriptor table size (all realy used endpoints * 8)
         static constexpr auto BdtSize = 8 * (_registersManager.GetRegisterNumber(_sortedUniqueEndpoints.back()) + 1);
+        /// Used packet memory size
+        static constexpr unsigned PmaUsage = BdtSize + _offsetCalculator.GetTotalBuffersSize();
 
         /**
          * @brief Returns buffer offset for given endpoint
@@ -246,6 +360,20 @@ namespace Zhele::Usb
         template<typename Endpoint>
         static constexpr uint32_t BufferOffset = GetBufferOffset(TypeBox<Endpoint>{});
 
+        /**
+         * @brief Returns second buffer (RX buffer or Buffer1) offset for given endpoint
+         * 
+         * @param [in] endpoint Boxed endpoint
+         * 
+         * @returns Buffer offset
+        */
+        static consteval auto GetSecondBufferOffset(auto endpoint) {
+            return GetBufferOffset(endpoint) + _offsetCalculator.GetFirstBufferSize(endpoint);
+        }
+        /// @brief Template variant of @ref GetSecondBufferOffset
+        template<typename Endpoint>
+        static constexpr uint32_t SecondBufferOffset = GetSecondBufferOffset(TypeBox<Endpoint>{});
+
         /**
          * @brief Returns BDT cell offset for given endpoint
          * 
@@ -255,7 +383,7 @@ namespace Zhele::Usb
         */
         static consteval auto GetBdtCellOffset(auto endpoint) {
             return _registersManager.GetRegisterNumber(endpoint) * 8
-                + (endpoint.Type == EndpointType::BulkDoubleBuffered
+                + (IsDoubleBufferedEndpoint(endpoint)
                 || endpoint.Direction == EndpointDirection::In
                 || endpoint.Direction == EndpointDirection::Bidirectional
                     ? 0
@@ -286,14 +414,21 @@ namespace Zhele::Usb
                     TypeUnbox<_registersManager.template GetEndpointReg<Endpoint>()>,
                     PmaBufferBase + PmaAlignMultiplier * BufferOffset<Endpoint>, // TxBuffer
                     PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 2), // TxCount
-                    PmaBufferBase + PmaAlignMultiplier * (BufferOffset<Endpoint> + Endpoint::MaxPacketSize), // RxBuffer
+                    PmaBufferBase + PmaAlignMultiplier * SecondBufferOffset<Endpoint>, // RxBuffer
                     PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 6)>, //RxCount
             typename std::conditional_t<Endpoint::Type == EndpointType::BulkDoubleBuffered,
                 BulkDoubleBufferedEndpoint<Endpoint,
                     TypeUnbox<_registersManager.template GetEndpointReg<Endpoint>()>,
                     PmaBufferBase + PmaAlignMultiplier * BufferOffset<Endpoint>, // Buffer0
                     PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 2), // Buffer0Count
-                    PmaBufferBase + PmaAlignMultiplier * (BufferOffset<Endpoint> + Endpoint::MaxPacketSize), // Buffer1
+                    PmaBufferBase + PmaAlignMultiplier * SecondBufferOffset<Endpoint>, // Buffer1
+                    PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 6)>, //Buffer1Count
+            typename std::conditional_t<Endpoint::Type == EndpointType::Isochronous,
+                IsochronousEndpoint<Endpoint,
+                    TypeUnbox<_registersManager.template GetEndpointReg<Endpoint>()>,
+                    PmaBufferBase + PmaAlignMultiplier * BufferOffset<Endpoint>, // Buffer0
+                    PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 2), // Buffer0Count
+                    PmaBufferBase + PmaAlignMultiplier * SecondBufferOffset<Endpoint>, // Buffer1
                     PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 6)>, //Buffer1Count
             typename std::conditional_t<Endpoint::Direction == EndpointDirection::In,
                 InEndpoint<Endpoint,
@@ -305,7 +440,7 @@ namespace Zhele::Usb
                     TypeUnbox<_registersManager.template GetEndpointReg<Endpoint>()>,
                     PmaBufferBase + PmaAlignMultiplier * BufferOffset<Endpoint>, // Buffer
                     PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 2)>, // BufferCount
-            void>>>>;
+            void>>>>>;
 
         /**
          * @brief Inits USB PMA
@@ -315,6 +450,8 @@ namespace Zhele::Usb
          */
         static void Init()
         {
+            static_assert(PmaBudget<PmaUsage, ZHELE_USB_PMA_SIZE>::Fits);
+
             InitTxFieldsInDescriptor();
             InitRxAddressFieldInDescriptor();
             InitRxCountFieldInDescriptor();
@@ -333,11 +470,11 @@ namespace Zhele::Usb
         static void InitRxAddressFieldInDescriptor()
         {
             constexpr auto bidirectionalAndBulkDoubleBufferedEndpoints = _sortedUniqueEndpoints.filter([](auto endpoint){
-                return endpoint.Direction == EndpointDirection::Bidirectional || endpoint.Type == EndpointType::BulkDoubleBuffered;
+                return endpoint.Direction == EndpointDirection::Bidirectional || IsDoubleBufferedEndpoint(endpoint);
             });
 
             bidirectionalAndBulkDoubleBufferedEndpoints.foreach([](auto endpoint){
-                *reinterpret_cast<uint16_t*>(BdtBase + PmaAlignMultiplier * (GetBdtCellOffset(endpoint) + 4)) = GetBufferOffset(endpoint) + endpoint.MaxPacketSize;
+                *reinterpret_cast<uint16_t*>(BdtBase + PmaAlignMultiplier * (GetBdtCellOffset(endpoint) + 4)) = GetSecondBufferOffset(endpoint);
             });
         }
         
@@ -357,7 +494,7 @@ namespace Zhele::Usb
         static void InitSecondRxCountFieldInDescriptor()
         {
             constexpr auto bidirectionalAndBulkDoubleBufferedEndpoints = _sortedUniqueEndpoints.filter([](auto endpoint){
-                return endpoint.Direction == EndpointDirection::Bidirectional || endpoint.Type == EndpointType::BulkDoubleBuffered;
+                return endpoint.Direction == EndpointDirection::Bidirectional || IsDoubleBufferedEndpoint(endpoint);
             });
 
             bidirectionalAndBulkDoubleBufferedEndpoints.foreach([](auto endpoint) {
@@ -368,12 +505,20 @@ namespace Zhele::Usb
         static consteval uint16_t CalculateRxCountValue(auto endpoint)
         {
             return endpoint.MaxPacketSize <= 62
-                ? (endpoint.MaxPacketSize / 2) << 10
-                : 0x8000 | ((endpoint.MaxPacketSize / 32 - 1) << 10);
+                ? ((endpoint.MaxPacketSize + 1) / 2) << 10
+                : 0x8000 | (((endpoint.MaxPacketSize + 31) / 32 - 1) << 10);
         }
     };
 
 #elif defined (USB_OTG_FS)
+    #if !defined (ZHELE_USB_OTG_FIFO_WORDS)
+        #if defined (USB_OTG_FS_TOTAL_FIFO_SIZE)
+            #define ZHELE_USB_OTG_FIFO_WORDS (USB_OTG_FS_TOTAL_FIFO_SIZE / 4)
+        #else
+            #define ZHELE_USB_OTG_FIFO_WORDS 320
+        #endif
+    #endif
+
     /**
      * @brief Calculates endpoint`s registers.
      * 
@@ -520,6 +665,9 @@ namespace Zhele::Usb
          */
         static void Init()
         {
+            static_assert(GetRxFifoSize() + GetSumOfFifoSize(_sortedUniqueInEndpoints) <= ZHELE_USB_OTG_FIFO_WORDS,
+                "Endpoints FIFO do not fit in USB OTG FIFO RAM, reduce packets count or ZHELE_USB_OTG_RX_FIFO_SIZE");
+
             OtgFsGlobal()->GRXFSIZ = GetRxFifoSize();
 
             InitTransmitFifos();
@@ -529,7 +677,7 @@ namespace Zhele::Usb
         /**
          * @brief Init TX fifo for endpoint.
          * 
-         * @details TX fifo size for endpoint = 2 x MaxPacketSize
+         * @details TX fifo size for endpoint = Packets x MaxPacketSize (2 packets by default)
          * 
          * @tparam Endpoint Endpoint
          */
@@ -568,12 +716,33 @@ namespace Zhele::Usb
             return maxPacketSize;
         }
 
+        /**
+         * @brief Calculates the largest packets count in transfer for endpoints list
+         * 
+         * @param [in] endpoints Endpoints list
+         * 
+         * @returns The largest packets count
+        */
+        static consteval uint8_t GetLargestEndpointsPackets(auto endpoints)
+        {
+            uint8_t packets = 0;
+
+            endpoints.foreach([&packets](auto endpoint) {
+                if (GetEndpointPackets<typename decltype(endpoint)::type>() > packets) {
+                    packets = GetEndpointPackets<typename decltype(endpoint)::type>();
+                }
+            });
+
+            return packets;
+        }
+
         /**
          * @brief Calculates TX FIFO depth 
          * 
-         * @details In default Tx buffer size is 2 * MaxPacketSize,
+         * @details In default Tx buffer size is 2 * MaxPacketSize (Packets * MaxPacketSize for multi-packet endpoint),
+         * so FIFO empty interrupt fills FIFO with next packet while previous one is being sent,
          * but minimum value IN endpoint TxFIFO depth is 16 (in terms of 32-bit words).
-         * So, real size (in bytes) is Max(MaxPacketSize * 2, 64)
+         * So, real size (in bytes) is Max(MaxPacketSize * Packets, 64)
          * 
          * @param endpoint Boxed endpoint
          * 
@@ -581,8 +750,9 @@ namespace Zhele::Usb
          */
         static consteval uint32_t CalculateTxFifoDepth(auto endpoint)
         {
-            return (2 * ((endpoint.MaxPacketSize + 3) / 4)) > 16
-                ? (2 * ((endpoint.MaxPacketSize + 3) / 4))
+            const uint32_t depth = GetEndpointPackets<typename decltype(endpoint)::type>() * ((endpoint.MaxPacketSize + 3) / 4);
+            return depth > 16
+                ? depth
                 : 16;
         }
 
@@ -607,13 +777,23 @@ namespace Zhele::Usb
         /**
          * @brief Returns receive FIFO size
          * 
+         * @details
+         * FIFO contains 2 largest packets (or packets count of multi-packet OUT endpoint),
+         * size can be overriden by ZHELE_USB_OTG_RX_FIFO_SIZE macro (in terms of 32-bit words).
+         * 
          * @returns Rx FIFO size
         */
         static consteval uint16_t GetRxFifoSize()
         {
-            return (11 + 2 * ((3 + GetLargestEndpointsMaxPacketSizeMax(_sortedUniqueOutEndpoints)) / 4)) > 16 // 11 = 10 (SETUP) + 1 (global out NAK)
-            ? 11 + 2 * ((3 + GetLargestEndpointsMaxPacketSizeMax(_sortedUniqueOutEndpoints)) / 4)
+        #if defined (ZHELE_USB_OTG_RX_FIFO_SIZE)
+            return ZHELE_USB_OTG_RX_FIFO_SIZE;
+        #else
+            const uint8_t largestPackets = GetLargestEndpointsPackets(_sortedUniqueOutEndpoints);
+            const uint16_t packets = largestPackets > 2 ? largestPackets : 2;
+            return (11 + packets * ((3 + GetLargestEndpointsMaxPacketSizeMax(_sortedUniqueOutEndpoints)) / 4)) > 16 // 11 = 10 (SETUP) + 1 (global out NAK)
+            ? 11 + packets * ((3 + GetLargestEndpointsMaxPacketSizeMax(_sortedUniqueOutEndpoints)) / 4)
             : 16;
+        #endif
         }
     };
 #endif
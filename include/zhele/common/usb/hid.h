@@ -192,5 +192,234 @@ namespace Zhele::Usb
             return result;
         }
     };
+
+    /**
+     * @brief HID report scheduler mode
+     */
+    enum class HidReportMode : uint8_t
+    {
+        Latest, ///< Only the freshest report is sent (mouse, gamepad)
+        Queued ///< All reports are sent in order (data acquisition)
+    };
+
+    /**
+     * @brief HID report scheduler statistics
+     */
+    struct HidReportStatistics
+    {
+        uint32_t Intervals; ///< Intervals count (@ref HidReportScheduler::IntervalTick calls)
+        uint32_t Sent; ///< Sent reports count
+        uint32_t MissedPolls; ///< Intervals with pending report, but without sent report
+        uint32_t Replaced; ///< Reports replaced by newer ones before sending (latest mode)
+        uint32_t Dropped; ///< Reports dropped because queue was full (queued mode)
+    };
+
+    /**
+     * @brief Implements HID IN reports scheduler
+     *
+     * @details
+     * Endpoint is armed with next report from transfer complete callback (in USB interrupt),
+     * so report is ready in endpoint buffer before next host poll and main loop latency does not matter.
+     * Scheduler owns report buffers (report is copied by @ref Submit), in latest mode report that is
+     * submitted while previous one is being sent replaces pending one, in queued mode reports are
+     * queued (up to _Depth reports including report in flight).
+     * Call @ref IntervalTick once per poll interval (for example, from SOF handler or 1 ms timer)
+     * to collect missed polls statistics.
+     *
+     * @par Example
+     * @code
+     *  using Mouse = HidReportScheduler<MouseEp, sizeof(MouseReport)>;
+     *  // Main loop
+     *  Mouse::Submit(&report);
+     *  // 1 ms timer
+     *  Mouse::IntervalTick();
+     *  ...
+     *  HidReportStatistics statistics = Mouse::GetStatistics();
+     * @endcode
+     *
+     * @tparam _Ep IN endpoint
+     * @tparam _ReportSize Report size (in bytes, not greater than endpoint max packet size)
+     * @tparam _Mode Mode
+     * @tparam _Depth Queue depth (queued mode only)
+     */
+    template<typename _Ep, unsigned _ReportSize, HidReportMode _Mode = HidReportMode::Latest, unsigned _Depth = 8>
+    class HidReportScheduler
+    {
+        static_assert(_ReportSize > 0 && _ReportSize <= _Ep::MaxPacketSize, "Report must fit one packet");
+        static_assert(_Depth >= 2 && _Depth < 0xff, "Invalid queue depth");
+
+        /// Buffers count (latest mode: report in flight and pending report)
+        static const unsigned Buffers = _Mode == HidReportMode::Latest ? 2 : _Depth;
+    public:
+        /**
+         * @brief Submit report (it's copied)
+         *
+         * @param [in] report Report
+         *
+         * @retval true Report is accepted
+         * @retval false Queue is full (queued mode only)
+         */
+        static bool Submit(const void* report)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+
+            bool accepted = true;
+            if constexpr (_Mode == HidReportMode::Latest)
+            {
+                if (_count == 2)
+                {
+                    ++_statistics.Replaced;
+                }
+                else
+                {
+                    ++_count;
+                }
+                memcpy(_reports[(_head + _count - 1) % Buffers], report, _ReportSize);
+            }
+            else
+            {
+                if (_count == Buffers)
+                {
+                    ++_statistics.Dropped;
+                    accepted = false;
+                }
+                else
+                {
+                    memcpy(_reports[(_head + _count) % Buffers], report, _ReportSize);
+                    ++_count;
+                }
+            }
+
+            if (accepted && !_armed)
+                Arm();
+
+            __set_PRIMASK(primask);
+            return accepted;
+        }
+
+        /**
+         * @brief Poll interval tick (call it once per endpoint poll interval)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IntervalTick()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+
+            ++_statistics.Intervals;
+            if (_count > 0 && _statistics.Sent == _sentAtTick)
+                ++_statistics.MissedPolls;
+            _sentAtTick = _statistics.Sent;
+
+            __set_PRIMASK(primask);
+        }
+
+        /**
+         * @brief Returns pending reports count (including report in flight)
+         *
+         * @returns Reports count
+         */
+        static unsigned Pending()
+        {
+            return _count;
+        }
+
+        /**
+         * @brief Drop pending reports (call it on USB reset, when endpoint transfer is aborted)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Clear()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _count = 0;
+            _armed = false;
+            __set_PRIMASK(primask);
+        }
+
+        /**
+         * @brief Returns statistics
+         *
+         * @returns Statistics
+         */
+        static HidReportStatistics GetStatistics()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            HidReportStatistics statistics = _statistics;
+            __set_PRIMASK(primask);
+            return statistics;
+        }
+
+        /**
+         * @brief Resets statistics
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void ResetStatistics()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _statistics = HidReportStatistics{};
+            _sentAtTick = 0;
+            __set_PRIMASK(primask);
+        }
+
+    private:
+        static void Arm()
+        {
+            _armed = true;
+            _Ep::SendData(_reports[_head], _ReportSize, TxComplete);
+        }
+
+        static void TxComplete()
+        {
+            if (_count == 0)
+                return;
+
+            ++_statistics.Sent;
+            _head = (_head + 1) % Buffers;
+            --_count;
+
+            if (_count > 0)
+                Arm();
+            else
+                _armed = false;
+        }
+
+        static uint8_t _reports[Buffers][_ReportSize];
+        static uint8_t _head;
+        static uint8_t _count;
+        static bool _armed;
+        static uint32_t _sentAtTick;
+        static HidReportStatistics _statistics;
+    };
+
+    #define HID_REPORT_SCHEDULER_TEMPLATE_ARGS template<typename _Ep, unsigned _ReportSize, HidReportMode _Mode, unsigned _Depth>
+    #define HID_REPORT_SCHEDULER_TEMPLATE_QUALIFIER HidReportScheduler<_Ep, _ReportSize, _Mode, _Depth>
+
+    HID_REPORT_SCHEDULER_TEMPLATE_ARGS
+    uint8_t HID_REPORT_SCHEDULER_TEMPLATE_QUALIFIER::_reports[Buffers][_ReportSize];
+
+    HID_REPORT_SCHEDULER_TEMPLATE_ARGS
+    uint8_t HID_REPORT_SCHEDULER_TEMPLATE_QUALIFIER::_head = 0;
+
+    HID_REPORT_SCHEDULER_TEMPLATE_ARGS
+    uint8_t HID_REPORT_SCHEDULER_TEMPLATE_QUALIFIER::_count = 0;
+
+    HID_REPORT_SCHEDULER_TEMPLATE_ARGS
+    bool HID_REPORT_SCHEDULER_TEMPLATE_QUALIFIER::_armed = false;
+
+    HID_REPORT_SCHEDULER_TEMPLATE_ARGS
+    uint32_t HID_REPORT_SCHEDULER_TEMPLATE_QUALIFIER::_sentAtTick = 0;
+
+    HID_REPORT_SCHEDULER_TEMPLATE_ARGS
+    HidReportStatistics HID_REPORT_SCHEDULER_TEMPLATE_QUALIFIER::_statistics = {};
 }
 #endif // ZHELE_USB_HID_H
\ No newline at end of file
@@ -58,7 +58,7 @@ namespace Zhele::Usb
         _ClockCtrl::Enable();
         _epBufferManager.Init();
 
-        _Regs()->CNTR = USB_CNTR_CTRM | USB_CNTR_RESETM;
+        _Regs()->CNTR = USB_CNTR_CTRM | USB_CNTR_RESETM | USB_CNTR_SUSPM | USB_CNTR_WKUPM;
         _Regs()->ISTR = 0;
         _Regs()->BTABLE = 0;
 #if defined (USB_BCDR_DPPU)
@@ -70,25 +70,110 @@ namespace Zhele::Usb
     USB_DEVICE_TEMPLATE_ARGS
     void USB_DEVICE_TEMPLATE_QUALIFIER::Reset()
     {
+        Resume();
+        _remoteWakeupEnabled = false;
+        _resumeFrames = 0;
+
         _Ep0::Reset();
         
         (_Configurations::Reset(), ...);
 
-        _Regs()->CNTR = USB_CNTR_CTRM | USB_CNTR_RESETM;
+        _Regs()->CNTR = USB_CNTR_CTRM | USB_CNTR_RESETM | USB_CNTR_SUSPM | USB_CNTR_WKUPM | (_sofCallback != nullptr ? USB_CNTR_SOFM : 0);
         _Regs()->ISTR = 0;
         _Regs()->BTABLE = 0;
         _Regs()->DADDR = USB_DADDR_EF;
     }
 
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::SetSofCallback(SofCallback callback)
+    {
+        _sofCallback = callback;
+        if (callback != nullptr)
+            _Regs()->CNTR |= USB_CNTR_SOFM;
+        else
+            _Regs()->CNTR &= ~USB_CNTR_SOFM;
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    bool USB_DEVICE_TEMPLATE_QUALIFIER::RemoteWakeup()
+    {
+        if (!_suspended || !_remoteWakeupEnabled)
+            return false;
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        Resume();
+        // Resume signalling is stopped by ESOF interrupt (SOFs are missing while bus is resumed)
+        _resumeFrames = ResumeSignallingFrames;
+        _Regs()->CNTR |= USB_CNTR_RESUME | USB_CNTR_ESOFM;
+        __set_PRIMASK(primask);
+
+        return true;
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::Suspend()
+    {
+        if (_suspended)
+            return;
+
+        // Force suspend first, then low-power mode (analog transceiver is off, wakeup detector is on)
+        _Regs()->CNTR |= USB_CNTR_FSUSP;
+        _Regs()->CNTR |= USB_CNTR_LPMODE;
+        _suspended = true;
+
+        if (_suspendCallback)
+            _suspendCallback(true);
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::Resume()
+    {
+        if (!_suspended)
+            return;
+
+        // LPMODE is cleared by hardware on wakeup event, but not on remote wakeup
+        _Regs()->CNTR &= ~USB_CNTR_LPMODE;
+        _Regs()->CNTR &= ~USB_CNTR_FSUSP;
+        _suspended = false;
+
+        if (_suspendCallback)
+            _suspendCallback(false);
+    }
+
     USB_DEVICE_TEMPLATE_ARGS
     void USB_DEVICE_TEMPLATE_QUALIFIER::CommonHandler()
     {
+        ZHELE_PROFILE_ISR();
+
         NVIC_ClearPendingIRQ(_IRQNumber);
 
+        if (_Regs()->ISTR & USB_ISTR_WKUP)
+        {
+            _Regs()->ISTR = static_cast<uint16_t>(~USB_ISTR_WKUP);
+            Resume();
+        }
         if(_Regs()->ISTR & USB_ISTR_RESET)
         {
             Reset();
         }
+        if (_Regs()->ISTR & USB_ISTR_SUSP)
+        {
+            Suspend();
+            _Regs()->ISTR = static_cast<uint16_t>(~USB_ISTR_SUSP);
+        }
+        if (_Regs()->ISTR & USB_ISTR_ESOF)
+        {
+            _Regs()->ISTR = static_cast<uint16_t>(~USB_ISTR_ESOF);
+            if (_resumeFrames != 0 && --_resumeFrames == 0)
+                _Regs()->CNTR &= ~(USB_CNTR_RESUME | USB_CNTR_ESOFM);
+        }
+        if (_Regs()->ISTR & USB_ISTR_SOF)
+        {
+            _Regs()->ISTR = static_cast<uint16_t>(~USB_ISTR_SOF);
+            if (_sofCallback)
+                _sofCallback(_Regs()->FNR & USB_FNR_FN);
+        }
         if (_Regs()->ISTR & USB_ISTR_CTR)
         {
             uint8_t endpoint = _Regs()->ISTR & USB_ISTR_EP_ID;
@@ -152,7 +237,9 @@ namespace Zhele::Usb
                             | USB_OTG_GINTMSK_OEPINT   // Enable USB OUT RX endpoint interrupt
                             | USB_OTG_GINTMSK_RXFLVLM // USB reciving
                             | USB_OTG_GINTMSK_USBRST
-                            | USB_OTG_GINTMSK_ENUMDNEM;    // Reset interrupt
+                            | USB_OTG_GINTMSK_ENUMDNEM    // Reset interrupt
+                            | USB_OTG_GINTMSK_USBSUSPM  // Bus suspend
+                            | USB_OTG_GINTMSK_WUIM;     // Resume/remote wakeup detected
 
         _Regs()->GCCFG |= USB_OTG_GCCFG_PWRDWN; // Enable USB
         _DeviceRegs()->DCTL = 0;
@@ -181,6 +268,9 @@ namespace Zhele::Usb
     USB_DEVICE_TEMPLATE_ARGS
     void USB_DEVICE_TEMPLATE_QUALIFIER::Reset()
     {
+        Resume();
+        _remoteWakeupEnabled = false;
+
         for (auto i = 0; i < 3; ++i)
             _Regs()->DIEPTXF[i] = 0;
 
@@ -199,9 +289,82 @@ namespace Zhele::Usb
         FlushRx<_Regs>();
     }
 
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::SetSofCallback(SofCallback callback)
+    {
+        _sofCallback = callback;
+        if (callback != nullptr)
+            _Regs()->GINTMSK |= USB_OTG_GINTMSK_SOFM;
+        else
+            _Regs()->GINTMSK &= ~USB_OTG_GINTMSK_SOFM;
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    bool USB_DEVICE_TEMPLATE_QUALIFIER::RemoteWakeup()
+    {
+        if (!_suspended || !_remoteWakeupEnabled)
+            return false;
+
+        Resume();
+        _DeviceRegs()->DCTL |= USB_OTG_DCTL_RWUSIG;
+        // There are no frame interrupts while bus is resumed, so signalling is timed by busy loop
+        // (at least 4 cycles per iteration: 2 to 5 ms for given count)
+        for (volatile uint32_t i = SystemCoreClock / 8000 * ResumeSignallingFrames / 2; i != 0; --i)
+            continue;
+        _DeviceRegs()->DCTL &= ~USB_OTG_DCTL_RWUSIG;
+
+        return true;
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    volatile uint32_t& USB_DEVICE_TEMPLATE_QUALIFIER::ClockGating()
+    {
+        return *reinterpret_cast<volatile uint32_t*>(reinterpret_cast<uintptr_t>(_Regs::Get()) + USB_OTG_PCGCCTL_BASE);
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::Suspend()
+    {
+        if (_suspended)
+            return;
+
+        // PHY clock is stopped, core registers and FIFO RAM are kept
+        ClockGating() |= USB_OTG_PCGCCTL_STOPCLK;
+        _suspended = true;
+
+        if (_suspendCallback)
+            _suspendCallback(true);
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::Resume()
+    {
+        if (!_suspended)
+            return;
+
+        ClockGating() &= ~(USB_OTG_PCGCCTL_STOPCLK | USB_OTG_PCGCCTL_GATECLK);
+        _suspended = false;
+
+        if (_suspendCallback)
+            _suspendCallback(false);
+    }
+
     USB_DEVICE_TEMPLATE_ARGS
     void USB_DEVICE_TEMPLATE_QUALIFIER::CommonHandler()
     {
+        ZHELE_PROFILE_ISR();
+
+        if (_Regs()->GINTSTS & USB_OTG_GINTSTS_WKUINT) {
+            Resume();
+            _Regs()->GINTSTS = USB_OTG_GINTSTS_WKUINT;
+        }
+
+        if (_Regs()->GINTSTS & USB_OTG_GINTSTS_USBSUSP) {
+            _Regs()->GINTSTS = USB_OTG_GINTSTS_USBSUSP;
+            if (_DeviceRegs()->DSTS & USB_OTG_DSTS_SUSPSTS)
+                Suspend();
+        }
+
         if (_Regs()->GINTSTS & USB_OTG_GINTSTS_USBRST) {
             _Regs()->GINTSTS = USB_OTG_GINTSTS_USBRST;
             Reset();
@@ -212,6 +375,12 @@ namespace Zhele::Usb
             _isDeviceConfigured = true;
         } 
 
+        if (_Regs()->GINTSTS & USB_OTG_GINTSTS_SOF) {
+            _Regs()->GINTSTS = USB_OTG_GINTSTS_SOF;
+            if (_sofCallback)
+                _sofCallback((_DeviceRegs()->DSTS & USB_OTG_DSTS_FNSOF) >> USB_OTG_DSTS_FNSOF_Pos);
+        }
+
         if (_Regs()->GINTSTS & USB_OTG_GINTSTS_RXFLVL) {
             uint32_t status = _Regs()->GRXSTSP;
             uint16_t size = (status & USB_OTG_GRXSTSP_BCNT) >> USB_OTG_GRXSTSP_BCNT_Pos;
@@ -287,6 +456,24 @@ namespace Zhele::Usb
         return _isDeviceConfigured;
     }
 
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::SetSuspendCallback(SuspendCallback callback)
+    {
+        _suspendCallback = callback;
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    bool USB_DEVICE_TEMPLATE_QUALIFIER::IsSuspended()
+    {
+        return _suspended;
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    bool USB_DEVICE_TEMPLATE_QUALIFIER::IsRemoteWakeupEnabled()
+    {
+        return _remoteWakeupEnabled;
+    }
+
     USB_DEVICE_TEMPLATE_ARGS
     consteval DeviceDescriptor USB_DEVICE_TEMPLATE_QUALIFIER::BuildDeviceDescriptor()
     {
@@ -356,13 +543,36 @@ namespace Zhele::Usb
             _ifHandlers.HandleSetupRequest(setupRequest->Index & 0xff);
             return;
         }
+
+        if constexpr (_msOsDescriptors.Enabled) {
+            static_assert(_UsbVersion >= 0x0201, "WinUSB device must have USB version 2.01 (BOS descriptor support)");
+
+            if (setupRequest->RequestType.Type == 2
+                && static_cast<uint8_t>(setupRequest->Request) == ZHELE_USB_MS_OS_VENDOR_CODE
+                && setupRequest->Index == 7) {
+                static constexpr auto descriptor = _msOsDescriptors.GetDescriptorSet();
+                _Ep0::SendData(descriptor.data(), setupRequest->Length < descriptor.size() ? setupRequest->Length : descriptor.size());
+                return;
+            }
+        }
         
         switch (setupRequest->Request) {
         case StandartRequestCode::GetStatus: {
-            uint16_t status = 0;
+            // Device status bit 1 is remote wakeup
+            uint16_t status = (setupRequest->RequestType.Recipient == 0 && _remoteWakeupEnabled) ? 0x02 : 0;
             _Ep0::SendData(&status, sizeof(status));
             break;
         }
+        case StandartRequestCode::SetFeature:
+        case StandartRequestCode::ClearFeature: {
+            if (setupRequest->RequestType.Recipient == 0 && setupRequest->Value == RemoteWakeupFeature) {
+                _remoteWakeupEnabled = setupRequest->Request == StandartRequestCode::SetFeature;
+                _Ep0::SendZLP();
+            } else {
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+            }
+            break;
+        }
         case StandartRequestCode::SetAddress: {
             SetAddress(setupRequest->Value);
             break;
@@ -381,6 +591,18 @@ namespace Zhele::Usb
                 _Ep0::SendData(descriptor.data(), setupRequest->Length < descriptor.size() ? setupRequest->Length : descriptor.size());
                 break;
             }
+            case GetDescriptorParameter::BosDescriptor: {
+                if constexpr (_msOsDescriptors.Enabled)
+                {
+                    static constexpr auto descriptor = _msOsDescriptors.GetBosDescriptor();
+                    _Ep0::SendData(descriptor.data(), setupRequest->Length < descriptor.size() ? setupRequest->Length : descriptor.size());
+                }
+                else
+                {
+                    _Ep0::SetTxStatus(EndpointStatus::Stall);
+                }
+                break;
+            }
             case GetDescriptorParameter::StringLangDescriptor: {
                 LangIdDescriptor langIdDescriptor;
                 _Ep0::SendData(&langIdDescriptor, setupRequest->Length < sizeof(langIdDescriptor) ? setupRequest->Length : sizeof(langIdDescriptor));
@@ -495,6 +717,23 @@ namespace Zhele::Usb
 #endif
     USB_DEVICE_TEMPLATE_ARGS
     volatile bool USB_DEVICE_TEMPLATE_QUALIFIER::_isDeviceConfigured = false;
+
+    USB_DEVICE_TEMPLATE_ARGS
+    SofCallback USB_DEVICE_TEMPLATE_QUALIFIER::_sofCallback = nullptr;
+
+    USB_DEVICE_TEMPLATE_ARGS
+    SuspendCallback USB_DEVICE_TEMPLATE_QUALIFIER::_suspendCallback = nullptr;
+
+    USB_DEVICE_TEMPLATE_ARGS
+    volatile bool USB_DEVICE_TEMPLATE_QUALIFIER::_suspended = false;
+
+    USB_DEVICE_TEMPLATE_ARGS
+    volatile bool USB_DEVICE_TEMPLATE_QUALIFIER::_remoteWakeupEnabled = false;
+#if defined (USB)
+
+    USB_DEVICE_TEMPLATE_ARGS
+    volatile uint8_t USB_DEVICE_TEMPLATE_QUALIFIER::_resumeFrames = 0;
+#endif
 }
 
 #endif //! ZHELE_USB_DEVICE_IMPL_H
\ No newline at end of file
@@ -12,6 +12,8 @@
 
 #include "interface.h"
 
+#include <zhele/placement.h>
+
 #include "../template_utils/type_list.h"
 
 namespace Zhele::Usb
@@ -216,16 +218,16 @@ namespace Zhele::Usb
                 }
                 break;
             case ScsiCommand::MmcReadFormatCapacity: {
-                constexpr uint8_t buffer[] = { 0, 0, 0, 8,
-                    (_LunSpecialization::GetLbaCount() >> 24) & 0xff,
-                    (_LunSpecialization::GetLbaCount() >> 16) & 0xff,
-                    (_LunSpecialization::GetLbaCount() >> 8) & 0xff,
-                    (_LunSpecialization::GetLbaCount() >> 0) & 0xff,
+                const uint8_t buffer[] = { 0, 0, 0, 8,
+                    static_cast<uint8_t>(_LunSpecialization::GetLbaCount() >> 24),
+                    static_cast<uint8_t>(_LunSpecialization::GetLbaCount() >> 16),
+                    static_cast<uint8_t>(_LunSpecialization::GetLbaCount() >> 8),
+                    static_cast<uint8_t>(_LunSpecialization::GetLbaCount() >> 0),
 
                     0b10, // formatted media
-                    (_LunSpecialization::GetLbaSize() >> 16) & 0xff,
-                    (_LunSpecialization::GetLbaSize() >> 8) & 0xff,
-                    (_LunSpecialization::GetLbaSize() >> 0) & 0xff,
+                    static_cast<uint8_t>(_LunSpecialization::GetLbaSize() >> 16),
+                    static_cast<uint8_t>(_LunSpecialization::GetLbaSize() >> 8),
+                    static_cast<uint8_t>(_LunSpecialization::GetLbaSize() >> 0),
                 };
                 _InEp::SendData(buffer, sizeof(buffer), callback);
                 break;
@@ -346,8 +348,10 @@ namespace Zhele::Usb
      * @tparam _LunNumber Number
      * @tparam _LbaSize Lba size
      * @tparam _LbaCount Lba count
+     * @tparam _Placement Storage placement (@ref Placement). Large RAM disk can be placed to CCM (it's copied by CPU)
+     * or to .noinit section (it's not cleared at boot and keeps content after reset).
      */
-    template<uint32_t _LbaSize, uint32_t _LbaCount>
+    template<uint32_t _LbaSize, uint32_t _LbaCount, typename _Placement = Placement::Default>
     class DefaultScsiLun : public ScsiLunWithConstSize<_LbaSize, _LbaCount>
     {
     public:
@@ -407,15 +411,13 @@ namespace Zhele::Usb
     private:
         static uint32_t _rxAddress;
         static int32_t _rxBytesRemain;
-        static uint8_t _buffer[_LbaCount * _LbaSize];
+        static constexpr auto& _buffer = PlacedStorage<_Placement, uint8_t[_LbaCount * _LbaSize], DefaultScsiLun>::Value;
     };
 
-    template<uint32_t _LbaSize, uint32_t _LbaCount>
-    uint32_t DefaultScsiLun<_LbaSize, _LbaCount>::_rxAddress;
-    template<uint32_t _LbaSize, uint32_t _LbaCount>
-    int32_t DefaultScsiLun<_LbaSize, _LbaCount>::_rxBytesRemain;
-    template<uint32_t _LbaSize, uint32_t _LbaCount>
-    uint8_t DefaultScsiLun<_LbaSize, _LbaCount>::_buffer[_LbaCount * _LbaSize];;
+    template<uint32_t _LbaSize, uint32_t _LbaCount, typename _Placement>
+    uint32_t DefaultScsiLun<_LbaSize, _LbaCount, _Placement>::_rxAddress;
+    template<uint32_t _LbaSize, uint32_t _LbaCount, typename _Placement>
+    int32_t DefaultScsiLun<_LbaSize, _LbaCount, _Placement>::_rxBytesRemain;
 
 
     /**
@@ -0,0 +1,359 @@
+/**
+ * @file
+ * Implements streaming SCSI logical unit over block storage backend
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_MSC_STREAM_H
+#define ZHELE_USB_MSC_STREAM_H
+
+#include "common.h"
+#include "endpoint.h"
+#include "msc.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+namespace Zhele::Usb
+{
+    /**
+     * @brief SCSI logical unit with block-sized streaming data path
+     *
+     * @details
+     * LUN holds _Blocks block buffers and works with backend by whole blocks, so media I/O
+     * (performed by @ref Process from main loop) overlaps USB transfers:
+     *  - Read (10): Process loads next block while previous block is being sent to host.
+     *    Block is sent by one transfer (without per-packet LUN calls).
+     *  - Write (10): packets are collected to block buffer, Process writes filled blocks.
+     *    OUT endpoint is NAKed while there is no room for next packets.
+     * Use double-buffered bulk endpoints (@ref BulkDoubleBufferedEndpointBase for OUT and
+     * @ref InBulkDoubleBufferedWithoutZlpEndpointBase for IN), so next packet is transferred
+     * while handler works with current one.
+     *
+     * Backend interface:
+     *  - static constexpr uint32_t GetLbaSize()
+     *  - static uint32_t GetLbaCount()
+     *  - static bool ReadBlocks(uint32_t lba, void* buffer, uint32_t count)
+     *  - static bool WriteBlocks(uint32_t lba, const void* buffer, uint32_t count)
+     *
+     * @par Example
+     * @code
+     *  using MscOutEpBase = BulkDoubleBufferedEndpointBase<1, EndpointDirection::Out, 64>;
+     *  using MscInEpBase = InBulkDoubleBufferedWithoutZlpEndpointBase<2, 64>;
+     *  ...
+     *  using Lun0 = BlockStreamScsiLun<QspiFlash, MscOutEp>;
+     *  using Scsi = ScsiBulkInterface<0, 0, Ep0, MscOutEp, MscInEp, Lun0>;
+     *  template<> void MscOutEp::HandleRx(void* data, uint16_t size) { Scsi::HandleRx(data, size); }
+     *  ...
+     *  for(;;)
+     *  {
+     *      Lun0::Process();
+     *  }
+     * @endcode
+     *
+     * @tparam _Backend Block storage backend
+     * @tparam _OutEp MSC OUT endpoint
+     * @tparam _Blocks Block buffers count
+     */
+    template<typename _Backend, typename _OutEp, unsigned _Blocks = 2>
+    class BlockStreamScsiLun : public ScsiLunBase
+    {
+        static const uint32_t BlockSize = _Backend::GetLbaSize();
+
+        static_assert(_Blocks >= 2 && _Blocks < 0xff, "LUN needs at least two block buffers (one is transferred, one is processed)");
+        static_assert(BlockSize % _OutEp::MaxPacketSize == 0, "OUT packets must not cross blocks");
+        static_assert(BlockSize >= 2 * _OutEp::MaxPacketSize, "Block must contain packets that are received after NAK");
+    public:
+        /**
+         * @brief Returns LBA size
+         *
+         * @returns LBA size (in bytes)
+         */
+        static uint32_t GetLbaSize()
+        {
+            return BlockSize;
+        }
+
+        /**
+         * @brief Returns LBA count
+         *
+         * @returns LBA count
+         */
+        static uint32_t GetLbaCount()
+        {
+            return _Backend::GetLbaCount();
+        }
+
+        /**
+         * @brief Read (10) command handler
+         *
+         * @tparam _InEp IN endpoint (without ZLP)
+         *
+         * @param startLba Start LBA
+         * @param lbaCount LBA count
+         * @param callback Transfer complete callback for call
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _InEp>
+        static void Read10Handler(uint32_t startLba, uint32_t lbaCount, InTransferCallback callback)
+        {
+            static_assert(requires { _InEp::DisableZlp; }, "Block is sent by separate transfer, so IN endpoint must not send ZLP");
+
+            // Blocks of previous write (if any) are written by Process before read
+            _readLba = startLba;
+            _readToLoad = lbaCount;
+            _readToSend = lbaCount;
+            _readCallback = callback;
+            _trySend = TrySend<_InEp>;
+
+            if (lbaCount == 0)
+                callback();
+        }
+
+        /**
+         * @brief Write (10) command handler
+         *
+         * @param startLba Start LBA
+         * @param lbaCount LBA count
+         *
+         * @retval true Wait for next packet
+         * @retval false OUT transfer complete
+         */
+        static bool Write10Handler(uint32_t startLba, uint32_t lbaCount)
+        {
+            _rxLba = startLba;
+            _writeRemain = lbaCount * BlockSize;
+            _fillOffset = 0;
+
+            return lbaCount > 0;
+        }
+
+        /**
+         * @brief LUN rx handler
+         *
+         * @param data Data
+         * @param size Data size
+         *
+         * @return true Waiting for next packet (transfer does not complete)
+         * @return false Transfer complete
+         */
+        static bool RxHandler(void* data, uint16_t size)
+        {
+            if (_count < _Blocks)
+                CopyFromUsbPma(_buffers[(_head + _count) % _Blocks] + _fillOffset, data, size);
+            else
+                _failed = true;
+
+            _fillOffset = _fillOffset + size;
+            _writeRemain = _writeRemain > size ? _writeRemain - size : 0;
+
+            if (_fillOffset >= BlockSize)
+            {
+                _fillOffset = 0;
+                if (_count < _Blocks)
+                {
+                    _lbas[(_head + _count) % _Blocks] = _rxLba;
+                    _count = _count + 1;
+                    _writeBlocks = _writeBlocks + 1;
+                }
+                _rxLba = _rxLba + 1;
+            }
+
+            // Double-buffered endpoint can receive one more packet after NAK
+            if (_writeRemain > 0 && FreeBytes() < 2u * _OutEp::MaxPacketSize)
+            {
+                _rxStalled = true;
+                _OutEp::SetRxStatus(EndpointStatus::Nak);
+            }
+
+            return _writeRemain > 0;
+        }
+
+        /**
+         * @brief Performs media transfers (call it from main loop)
+         *
+         * @details
+         * Method writes received block or loads next block of current read request
+         * (received blocks are written first, so read returns written data).
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Process()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            uint8_t head = _head;
+            uint8_t count = _count;
+            uint8_t writeBlocks = _writeBlocks;
+            __set_PRIMASK(primask);
+
+            if (writeBlocks > 0)
+            {
+                if (!_Backend::WriteBlocks(_lbas[head], _buffers[head], 1))
+                    _failed = true;
+
+                __disable_irq();
+                _head = (_head + 1) % _Blocks;
+                _count = _count - 1;
+                _writeBlocks = _writeBlocks - 1;
+                if (_rxStalled && FreeBytes() >= 2u * _OutEp::MaxPacketSize)
+                {
+                    _rxStalled = false;
+                    _OutEp::SetRxStatus(EndpointStatus::Valid);
+                }
+                __set_PRIMASK(primask);
+            }
+            else if (_readToLoad > 0 && count < _Blocks)
+            {
+                uint8_t* buffer = _buffers[(head + count) % _Blocks];
+                if (!_Backend::ReadBlocks(_readLba, buffer, 1))
+                {
+                    memset(buffer, 0, BlockSize);
+                    _failed = true;
+                }
+
+                __disable_irq();
+                _readLba = _readLba + 1;
+                _readToLoad = _readToLoad - 1;
+                _count = _count + 1;
+                _trySend();
+                __set_PRIMASK(primask);
+            }
+        }
+
+        /**
+         * @brief Check that all received blocks are written
+         *
+         * @retval true There are no pending writes
+         * @retval false Some blocks are not written yet
+         */
+        static bool Idle()
+        {
+            return _count == 0 && _readToSend == 0 && _writeRemain == 0;
+        }
+
+        /**
+         * @brief Returns media error flag
+         *
+         * @details
+         * Failed read sends zeroes to host, failed write drops data, so error is reported by this flag.
+         *
+         * @retval true There was media read/write error
+         * @retval false There were no errors
+         */
+        static bool Failed()
+        {
+            return _failed;
+        }
+
+    private:
+        static unsigned FreeBytes()
+        {
+            return (_Blocks - _count) * BlockSize - _fillOffset;
+        }
+
+        template<typename _InEp>
+        static void TrySend()
+        {
+            if (!_sending && _writeBlocks == 0 && _count > 0 && _readToSend > 0)
+            {
+                _sending = true;
+                _InEp::SendData(_buffers[_head], BlockSize, BlockSent);
+            }
+        }
+
+        static void BlockSent()
+        {
+            _sending = false;
+            _head = (_head + 1) % _Blocks;
+            _count = _count - 1;
+            _readToSend = _readToSend - 1;
+
+            if (_readToSend == 0)
+                _readCallback();
+            else
+                _trySend();
+        }
+
+        alignas(4) static uint8_t _buffers[_Blocks][BlockSize];
+        static uint32_t _lbas[_Blocks];
+        static volatile uint8_t _head;
+        static volatile uint8_t _count;
+        static volatile uint8_t _writeBlocks;
+        static volatile bool _sending;
+        static volatile bool _failed;
+
+        // Read request
+        static volatile uint32_t _readLba;
+        static volatile uint32_t _readToLoad;
+        static volatile uint32_t _readToSend;
+        static InTransferCallback _readCallback;
+        static InTransferCallback _trySend;
+
+        // Write request
+        static volatile uint32_t _rxLba;
+        static volatile uint32_t _writeRemain;
+        static volatile uint16_t _fillOffset;
+        static volatile bool _rxStalled;
+    };
+
+    #define BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS template<typename _Backend, typename _OutEp, unsigned _Blocks>
+    #define BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER BlockStreamScsiLun<_Backend, _OutEp, _Blocks>
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    alignas(4) uint8_t BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_buffers[_Blocks][BlockSize];
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    uint32_t BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_lbas[_Blocks];
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint8_t BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_head = 0;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint8_t BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_count = 0;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint8_t BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_writeBlocks = 0;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    volatile bool BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_sending = false;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    volatile bool BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_failed = false;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint32_t BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_readLba = 0;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint32_t BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_readToLoad = 0;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint32_t BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_readToSend = 0;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    InTransferCallback BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_readCallback = nullptr;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    InTransferCallback BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_trySend = nullptr;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint32_t BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_rxLba = 0;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint32_t BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_writeRemain = 0;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint16_t BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_fillOffset = 0;
+
+    BLOCK_STREAM_SCSI_LUN_TEMPLATE_ARGS
+    volatile bool BLOCK_STREAM_SCSI_LUN_TEMPLATE_QUALIFIER::_rxStalled = false;
+}
+
+#endif //! ZHELE_USB_MSC_STREAM_H
@@ -0,0 +1,960 @@
+/**
+ * @file
+ * Implements USB CDC-NCM (Network Control Model) network interface
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_NCM_H
+#define ZHELE_USB_NCM_H
+
+#include "cdc.h"
+#include "common.h"
+#include "endpoint.h"
+#include "interface.h"
+
+#include "../template_utils/type_list.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+namespace Zhele::Usb
+{
+    /**
+     * @brief NCM class-specific requests
+     */
+    enum class NcmRequest : uint8_t
+    {
+        SetEthernetPacketFilter = 0x43, ///< Set Ethernet packet filter
+        GetNtbParameters = 0x80, ///< Get NTB parameters
+        GetNtbInputSize = 0x85, ///< Get NTB input (device to host) size
+        SetNtbInputSize = 0x86, ///< Set NTB input (device to host) size
+    };
+
+    /**
+     * @brief NCM notifications
+     */
+    enum class NcmNotification : uint8_t
+    {
+        NetworkConnection = 0x00, ///< Network connection state
+        ConnectionSpeedChange = 0x2a, ///< Connection speed
+    };
+
+#pragma pack(push, 1)
+    /**
+     * @brief NTB parameters (GET_NTB_PARAMETERS response)
+     */
+    struct NtbParameters
+    {
+        uint16_t Length = 0x1c; ///< Structure length (always 28)
+        uint16_t FormatsSupported = 0x01; ///< Supported NTB formats (NTB-16 only)
+        uint32_t InMaxSize; ///< Max IN (device to host) NTB size
+        uint16_t InDivisor = 4; ///< IN datagrams alignment divisor
+        uint16_t InPayloadRemainder = 0; ///< IN datagrams alignment remainder
+        uint16_t InAlignment = 4; ///< IN NDP alignment
+        uint16_t Reserved = 0; ///< Reserved
+        uint32_t OutMaxSize; ///< Max OUT (host to device) NTB size
+        uint16_t OutDivisor = 4; ///< OUT datagrams alignment divisor
+        uint16_t OutPayloadRemainder = 0; ///< OUT datagrams alignment remainder
+        uint16_t OutAlignment = 4; ///< OUT NDP alignment
+        uint16_t OutMaxDatagrams = 0; ///< Max datagrams in OUT NTB (0 - no limit)
+    };
+
+    /**
+     * @brief NTB-16 header (NTH16)
+     */
+    struct Nth16
+    {
+        static const uint32_t SignatureValue = 0x484d434e; ///< "NCMH"
+
+        uint32_t Signature; ///< Signature
+        uint16_t HeaderLength; ///< Header length (always 12)
+        uint16_t Sequence; ///< NTB sequence number
+        uint16_t BlockLength; ///< NTB length
+        uint16_t NdpIndex; ///< First NDP offset
+    };
+
+    /**
+     * @brief NTB-16 datagram pointer table header (NDP16)
+     */
+    struct Ndp16
+    {
+        static const uint32_t SignatureValue = 0x304d434e; ///< "NCM0" (datagrams without CRC)
+
+        uint32_t Signature; ///< Signature
+        uint16_t Length; ///< Table length (with datagram pointers)
+        uint16_t NextNdpIndex; ///< Next NDP offset (0 if it's last)
+    };
+
+    /**
+     * @brief NDP16 datagram pointer
+     */
+    struct NcmDatagram
+    {
+        uint16_t Index; ///< Datagram offset in NTB
+        uint16_t Length; ///< Datagram length
+    };
+
+    /**
+     * @brief NCM notification packet
+     */
+    struct NcmNotificationPacket
+    {
+        uint8_t RequestType = 0xa1; ///< Request type (class, interface, device to host)
+        NcmNotification Notification; ///< Notification
+        uint16_t Value; ///< Value (connection state)
+        uint16_t Index; ///< Interface number
+        uint16_t Length; ///< Data length
+        uint32_t DownlinkSpeed; ///< Downlink speed (bits per second), connection speed change only
+        uint32_t UplinkSpeed; ///< Uplink speed (bits per second), connection speed change only
+    };
+#pragma pack(pop)
+
+    /**
+     * @brief Union functional descriptor
+     *
+     * @tparam _Master Communication interface number
+     * @tparam _Slave Data interface number
+     */
+    template<uint8_t _Master, uint8_t _Slave>
+    using NcmUnionFunctional = InterfaceFunctionalDescriptor<0x06, _Master, _Slave>;
+
+    /**
+     * @brief Ethernet networking functional descriptor
+     *
+     * @tparam _MacStringIndex MAC address string index
+     * @tparam _MaxSegmentSize Max Ethernet frame size (without CRC)
+     */
+    template<uint8_t _MacStringIndex, uint16_t _MaxSegmentSize = 1514>
+    using EthernetNetworkingFunctional = InterfaceFunctionalDescriptor<0x0f, _MacStringIndex, 0x00, 0x00, 0x00, 0x00,
+        static_cast<uint8_t>(_MaxSegmentSize & 0xff), static_cast<uint8_t>(_MaxSegmentSize >> 8), 0x00, 0x00, 0x00>;
+
+    /**
+     * @brief NCM functional descriptor (NCM 1.0, SetEthernetPacketFilter is supported)
+     */
+    using NcmFunctional = InterfaceFunctionalDescriptor<0x1a, 0x00, 0x01, 0x01>;
+
+    /**
+     * @brief Implements NCM data path (NTB-16 batching)
+     *
+     * @details
+     * Data path works with whole NTBs (NCM transfer blocks), so several Ethernet frames
+     * ride in each bulk transfer. There are two NTB buffers in each direction.
+     *
+     * Received NTB is collected from OUT packets in USB interrupt (NTB ends with short packet
+     * or by NTH16 block length). @ref Poll (call it from main loop) parses NTB and passes every frame
+     * to frame handler directly from NTB buffer (without copy), frame is valid until handler returns.
+     * OUT endpoint is NAKed while both buffers are busy (packets that are received after NAK are kept).
+     *
+     * Frame to send is written by IP stack directly to NTB buffer: @ref AllocFrame returns place
+     * in filling NTB, @ref SendFrame commits frame. If IN endpoint is idle, NTB is sent at once,
+     * otherwise frames are collected in filling NTB and it's sent from transfer complete callback
+     * (USB interrupt), so frames are batched under load without latency at low load.
+     *
+     * Use double-buffered bulk endpoints (@ref BulkDoubleBufferedEndpointBase), IN endpoint must send ZLP.
+     *
+     * @par Example
+     * @code
+     *  using NcmNotificationEpBase = InEndpointBase<1, EndpointType::Interrupt, 16, 32>;
+     *  using NcmOutEpBase = BulkDoubleBufferedEndpointBase<2, EndpointDirection::Out, 64>;
+     *  using NcmInEpBase = BulkDoubleBufferedEndpointBase<3, EndpointDirection::In, 64>;
+     *  ...
+     *  using Network = NcmNetwork<NcmInEp, NcmOutEp>;
+     *  using NcmComm = NcmCommInterface<0, 1, Ep0, NcmNotificationEp, Network>;
+     *  using NcmData = NcmDataInterface<1, Ep0, NcmComm, NcmOutEp, NcmInEp>;
+     *  // MAC address (host side) is serial number string, for example u"02A1B2C3D4E5"
+     *  template<> void NcmOutEp::HandleRx(void* data, uint16_t size) { Network::RxHandler(data, size); }
+     *  ...
+     *  Network::SetFrameHandler([](const uint8_t* frame, uint16_t size) { IpStackInput(frame, size); });
+     *  for(;;)
+     *  {
+     *      Network::Poll();
+     *      if (uint8_t* frame = Network::AllocFrame(); frame != nullptr && IpStackOutput(frame, &size))
+     *          Network::SendFrame(size);
+     *  }
+     * @endcode
+     *
+     * @tparam _InEp Data IN endpoint (double-buffered)
+     * @tparam _OutEp Data OUT endpoint (double-buffered)
+     * @tparam _RxNtbSize RX (OUT) NTB buffer size
+     * @tparam _TxNtbSize TX (IN) NTB buffer size
+     * @tparam _MaxDatagrams Max frames in TX NTB
+     */
+    template<typename _InEp, typename _OutEp, unsigned _RxNtbSize = 2048, unsigned _TxNtbSize = 2048, unsigned _MaxDatagrams = 8>
+    class NcmNetwork
+    {
+        static const unsigned Ntbs = 2;
+        static const unsigned SpillPackets = 2;
+        static const uint16_t NdpOffset = sizeof(Nth16);
+        static const uint16_t NdpSize = sizeof(Ndp16) + (_MaxDatagrams + 1) * sizeof(NcmDatagram);
+        static const uint16_t DatagramsOffset = (NdpOffset + NdpSize + 3) & ~3u;
+    public:
+        static const uint16_t MaxFrameSize = 1514; ///< Max Ethernet frame size (without CRC)
+
+        static_assert(_RxNtbSize >= 2048 && _RxNtbSize <= 0xffff, "NTB-16 OUT size must be from 2048 to 65535 bytes");
+        static_assert(_TxNtbSize >= DatagramsOffset + MaxFrameSize && _TxNtbSize <= 0xffff, "TX NTB must contain max frame");
+        static_assert(_MaxDatagrams > 0, "TX NTB must contain at least one frame");
+
+        /**
+         * @brief Received frame handler
+         */
+        using FrameHandler = std::add_pointer_t<void(const uint8_t* frame, uint16_t size)>;
+
+        /**
+         * @brief Returns NTB parameters
+         *
+         * @returns NTB parameters
+         */
+        static constexpr NtbParameters GetNtbParameters()
+        {
+            return NtbParameters {
+                .InMaxSize = _TxNtbSize,
+                .OutMaxSize = _RxNtbSize,
+            };
+        }
+
+        /**
+         * @brief Sets received frame handler
+         *
+         * @param [in] handler Handler (it's called from @ref Poll)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetFrameHandler(FrameHandler handler)
+        {
+            _frameHandler = handler;
+        }
+
+        /**
+         * @brief Checks that host enabled data interface
+         *
+         * @retval true Data path is active
+         * @retval false Data path is not active
+         */
+        static bool IsActive()
+        {
+            return _active;
+        }
+
+        /**
+         * @brief Activates or deactivates data path (called by data interface)
+         *
+         * @details
+         * Buffers are reset in both cases, frames that are not sent are dropped.
+         *
+         * @param [in] active Host selected data interface alternate setting with endpoints
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetActive(bool active)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _active = false;
+            _rxHead = 0;
+            _rxCount = 0;
+            _rxOffset = 0;
+            _rxOverflow = false;
+            _rxStalled = false;
+            _spillCount = 0;
+            _txHead = 0;
+            _txClosed = 0;
+            _txCount = 0;
+            _txOffset = DatagramsOffset;
+            _txSending = false;
+            _txMaxSize = _TxNtbSize;
+            _active = active;
+            __set_PRIMASK(primask);
+
+            if (active)
+                _OutEp::SetRxStatus(EndpointStatus::Valid);
+        }
+
+        /**
+         * @brief Returns max IN NTB size
+         *
+         * @returns NTB size
+         */
+        static uint32_t GetInputSize()
+        {
+            return _txMaxSize;
+        }
+
+        /**
+         * @brief Sets max IN NTB size (SET_NTB_INPUT_SIZE request)
+         *
+         * @param [in] size NTB size (it's limited by TX buffer size)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetInputSize(uint32_t size)
+        {
+            _txMaxSize = size < DatagramsOffset + MaxFrameSize
+                ? DatagramsOffset + MaxFrameSize
+                : (size > _TxNtbSize ? _TxNtbSize : size);
+        }
+
+        /**
+         * @brief OUT endpoint handler (call it from endpoint HandleRx)
+         *
+         * @param [in] data Packet
+         * @param [in] size Packet size
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void RxHandler(void* data, uint16_t size)
+        {
+            if (!_active)
+                return;
+
+            if (_rxCount == Ntbs)
+            {
+                // Double-buffered endpoint can receive one more packet after NAK
+                if (_spillCount < SpillPackets)
+                {
+                    CopyFromUsbPma(_spill[_spillCount], data, size);
+                    _spillSizes[_spillCount] = size;
+                    _spillCount = _spillCount + 1;
+                }
+                else
+                {
+                    _errors = _errors + 1;
+                }
+                return;
+            }
+
+            if (_rxOffset + size <= _RxNtbSize)
+                CopyFromUsbPma(_rxBuffers[(_rxHead + _rxCount) % Ntbs] + _rxOffset, data, size);
+            else
+                _rxOverflow = true;
+
+            RxCommit(size);
+        }
+
+        /**
+         * @brief Passes received frames to handler (call it from main loop)
+         *
+         * @details
+         * Method parses one received NTB.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Poll()
+        {
+            if (_rxCount == 0)
+                return;
+
+            ParseNtb(_rxBuffers[_rxHead]);
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if (_rxCount > 0)
+            {
+                _rxHead = (_rxHead + 1) % Ntbs;
+                _rxCount = _rxCount - 1;
+
+                uint8_t replayed = 0;
+                while (replayed < _spillCount && _rxCount < Ntbs)
+                {
+                    uint16_t size = _spillSizes[replayed];
+                    if (_rxOffset + size <= _RxNtbSize)
+                        memcpy(_rxBuffers[(_rxHead + _rxCount) % Ntbs] + _rxOffset, _spill[replayed], size);
+                    else
+                        _rxOverflow = true;
+                    RxCommit(size);
+                    ++replayed;
+                }
+                if (replayed > 0 && replayed < _spillCount)
+                {
+                    memcpy(_spill[0], _spill[replayed], _spillSizes[replayed]);
+                    _spillSizes[0] = _spillSizes[replayed];
+                }
+                _spillCount = _spillCount - replayed;
+
+                if (_rxStalled && _rxCount < Ntbs && _spillCount == 0)
+                {
+                    _rxStalled = false;
+                    _OutEp::SetRxStatus(EndpointStatus::Valid);
+                }
+            }
+            __set_PRIMASK(primask);
+        }
+
+        /**
+         * @brief Returns place for frame in TX NTB
+         *
+         * @details
+         * Frame should be written to returned buffer and committed by @ref SendFrame
+         * (next call of method returns the same place until commit).
+         *
+         * @param [in] size Frame size (or max frame size if it's unknown)
+         *
+         * @returns Frame buffer (nullptr if there is no room now or data path is not active)
+         */
+        static uint8_t* AllocFrame(uint16_t size = MaxFrameSize)
+        {
+            if (!_active || size > MaxFrameSize)
+                return nullptr;
+
+            uint8_t* frame = nullptr;
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if (_txClosed < Ntbs && _txCount > 0 && (_txCount == _MaxDatagrams || _txOffset + size > _txMaxSize))
+                CloseTx();
+            if (_txClosed < Ntbs)
+                frame = _txBuffers[(_txHead + _txClosed) % Ntbs] + _txOffset;
+            __set_PRIMASK(primask);
+
+            return frame;
+        }
+
+        /**
+         * @brief Commits frame that is written to @ref AllocFrame buffer
+         *
+         * @param [in] size Frame size (not greater than size passed to AllocFrame)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SendFrame(uint16_t size)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if (_active && _txClosed < Ntbs)
+            {
+                uint8_t* ntb = _txBuffers[(_txHead + _txClosed) % Ntbs];
+                NcmDatagram* datagrams = reinterpret_cast<NcmDatagram*>(ntb + NdpOffset + sizeof(Ndp16));
+                datagrams[_txCount] = {_txOffset, size};
+                _txCount = _txCount + 1;
+                _txEnd = _txOffset + size;
+                _txOffset = (_txEnd + 3) & ~3u;
+
+                TrySend();
+            }
+            __set_PRIMASK(primask);
+        }
+
+        /**
+         * @brief Sends frame (copies frame to TX NTB)
+         *
+         * @param [in] frame Frame
+         * @param [in] size Frame size
+         *
+         * @retval true Frame is queued
+         * @retval false There is no room now
+         */
+        static bool Send(const void* frame, uint16_t size)
+        {
+            uint8_t* buffer = AllocFrame(size);
+            if (buffer == nullptr)
+                return false;
+
+            memcpy(buffer, frame, size);
+            SendFrame(size);
+            return true;
+        }
+
+        /**
+         * @brief Returns errors count (malformed NTBs and dropped packets)
+         *
+         * @returns Errors count
+         */
+        static uint32_t Errors()
+        {
+            return _errors;
+        }
+
+    private:
+        static void RxCommit(uint16_t size)
+        {
+            // ZLP ends NTB with max packet size multiple length, it's completed by NTH16 length already
+            if (size == 0 && _rxOffset == 0)
+                return;
+
+            _rxOffset = _rxOffset + size;
+
+            const Nth16* nth = reinterpret_cast<const Nth16*>(_rxBuffers[(_rxHead + _rxCount) % Ntbs]);
+            bool complete = size < _OutEp::MaxPacketSize
+                || (!_rxOverflow && (_rxOffset >= _RxNtbSize || (_rxOffset >= sizeof(Nth16) && _rxOffset >= nth->BlockLength)));
+            if (!complete)
+                return;
+
+            if (_rxOverflow)
+                _errors = _errors + 1;
+            else
+                _rxCount = _rxCount + 1;
+            _rxOffset = 0;
+            _rxOverflow = false;
+
+            if (_rxCount == Ntbs)
+            {
+                _rxStalled = true;
+                _OutEp::SetRxStatus(EndpointStatus::Nak);
+            }
+        }
+
+        static void ParseNtb(const uint8_t* ntb)
+        {
+            const Nth16* nth = reinterpret_cast<const Nth16*>(ntb);
+            uint16_t blockLength = nth->BlockLength;
+            if (nth->Signature != Nth16::SignatureValue || nth->HeaderLength != sizeof(Nth16) || blockLength > _RxNtbSize)
+            {
+                _errors = _errors + 1;
+                return;
+            }
+
+            uint16_t ndpIndex = nth->NdpIndex;
+            // NDP is at least 16 bytes, so bad chain can't loop forever
+            for (unsigned ndps = 0; ndpIndex != 0 && ndps < blockLength / 16u; ++ndps)
+            {
+                const Ndp16* ndp = reinterpret_cast<const Ndp16*>(ntb + ndpIndex);
+                if ((ndpIndex & 0x03) != 0 || ndpIndex + sizeof(Ndp16) > blockLength
+                    || ndp->Signature != Ndp16::SignatureValue || ndp->Length < 16 || ndpIndex + ndp->Length > blockLength)
+                {
+                    _errors = _errors + 1;
+                    return;
+                }
+
+                const NcmDatagram* datagrams = reinterpret_cast<const NcmDatagram*>(ntb + ndpIndex + sizeof(Ndp16));
+                unsigned count = (ndp->Length - sizeof(Ndp16)) / sizeof(NcmDatagram);
+                for (unsigned i = 0; i < count && datagrams[i].Index != 0 && datagrams[i].Length != 0; ++i)
+                {
+                    if (datagrams[i].Index + datagrams[i].Length > blockLength)
+                        _errors = _errors + 1;
+                    else if (_frameHandler)
+                        _frameHandler(ntb + datagrams[i].Index, datagrams[i].Length);
+                }
+
+                ndpIndex = ndp->NextNdpIndex;
+            }
+        }
+
+        static void CloseTx()
+        {
+            uint8_t index = (_txHead + _txClosed) % Ntbs;
+            uint8_t* ntb = _txBuffers[index];
+
+            *reinterpret_cast<Nth16*>(ntb) = {Nth16::SignatureValue, sizeof(Nth16), _txSequence, _txEnd, NdpOffset};
+            *reinterpret_cast<Ndp16*>(ntb + NdpOffset) = {Ndp16::SignatureValue, static_cast<uint16_t>(sizeof(Ndp16) + (_txCount + 1) * sizeof(NcmDatagram)), 0};
+            reinterpret_cast<NcmDatagram*>(ntb + NdpOffset + sizeof(Ndp16))[_txCount] = {0, 0};
+
+            _txLengths[index] = _txEnd;
+            _txSequence = _txSequence + 1;
+            _txClosed = _txClosed + 1;
+            _txCount = 0;
+            _txOffset = DatagramsOffset;
+        }
+
+        static void TrySend()
+        {
+            if (_txSending)
+                return;
+
+            if (_txClosed == 0 && _txCount > 0)
+                CloseTx();
+
+            if (_txClosed > 0)
+            {
+                _txSending = true;
+                _InEp::SendData(_txBuffers[_txHead], _txLengths[_txHead], TxComplete);
+            }
+        }
+
+        static void TxComplete()
+        {
+            if (!_txSending)
+                return;
+
+            _txSending = false;
+            _txHead = (_txHead + 1) % Ntbs;
+            _txClosed = _txClosed - 1;
+            TrySend();
+        }
+
+        static FrameHandler _frameHandler;
+        static volatile bool _active;
+        static volatile uint32_t _errors;
+
+        // Host to device
+        alignas(4) static uint8_t _rxBuffers[Ntbs][_RxNtbSize];
+        alignas(4) static uint8_t _spill[SpillPackets][_OutEp::MaxPacketSize];
+        static uint16_t _spillSizes[SpillPackets];
+        static volatile uint8_t _spillCount;
+        static volatile uint8_t _rxHead;
+        static volatile uint8_t _rxCount;
+        static volatile uint16_t _rxOffset;
+        static volatile bool _rxOverflow;
+        static volatile bool _rxStalled;
+
+        // Device to host
+        alignas(4) static uint8_t _txBuffers[Ntbs][_TxNtbSize];
+        static uint16_t _txLengths[Ntbs];
+        static volatile uint8_t _txHead;
+        static volatile uint8_t _txClosed;
+        static volatile uint8_t _txCount;
+        static volatile uint16_t _txOffset;
+        static volatile uint16_t _txEnd;
+        static volatile uint16_t _txSequence;
+        static volatile uint16_t _txMaxSize;
+        static volatile bool _txSending;
+    };
+
+    #define NCM_NETWORK_TEMPLATE_ARGS template<typename _InEp, typename _OutEp, unsigned _RxNtbSize, unsigned _TxNtbSize, unsigned _MaxDatagrams>
+    #define NCM_NETWORK_TEMPLATE_QUALIFIER NcmNetwork<_InEp, _OutEp, _RxNtbSize, _TxNtbSize, _MaxDatagrams>
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    typename NCM_NETWORK_TEMPLATE_QUALIFIER::FrameHandler NCM_NETWORK_TEMPLATE_QUALIFIER::_frameHandler = nullptr;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile bool NCM_NETWORK_TEMPLATE_QUALIFIER::_active = false;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile uint32_t NCM_NETWORK_TEMPLATE_QUALIFIER::_errors = 0;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    alignas(4) uint8_t NCM_NETWORK_TEMPLATE_QUALIFIER::_rxBuffers[Ntbs][_RxNtbSize];
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    alignas(4) uint8_t NCM_NETWORK_TEMPLATE_QUALIFIER::_spill[SpillPackets][_OutEp::MaxPacketSize];
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    uint16_t NCM_NETWORK_TEMPLATE_QUALIFIER::_spillSizes[SpillPackets];
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile uint8_t NCM_NETWORK_TEMPLATE_QUALIFIER::_spillCount = 0;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile uint8_t NCM_NETWORK_TEMPLATE_QUALIFIER::_rxHead = 0;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile uint8_t NCM_NETWORK_TEMPLATE_QUALIFIER::_rxCount = 0;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile uint16_t NCM_NETWORK_TEMPLATE_QUALIFIER::_rxOffset = 0;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile bool NCM_NETWORK_TEMPLATE_QUALIFIER::_rxOverflow = false;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile bool NCM_NETWORK_TEMPLATE_QUALIFIER::_rxStalled = false;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    alignas(4) uint8_t NCM_NETWORK_TEMPLATE_QUALIFIER::_txBuffers[Ntbs][_TxNtbSize];
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    uint16_t NCM_NETWORK_TEMPLATE_QUALIFIER::_txLengths[Ntbs];
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile uint8_t NCM_NETWORK_TEMPLATE_QUALIFIER::_txHead = 0;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile uint8_t NCM_NETWORK_TEMPLATE_QUALIFIER::_txClosed = 0;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile uint8_t NCM_NETWORK_TEMPLATE_QUALIFIER::_txCount = 0;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile uint16_t NCM_NETWORK_TEMPLATE_QUALIFIER::_txOffset = NCM_NETWORK_TEMPLATE_QUALIFIER::DatagramsOffset;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile uint16_t NCM_NETWORK_TEMPLATE_QUALIFIER::_txEnd = 0;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile uint16_t NCM_NETWORK_TEMPLATE_QUALIFIER::_txSequence = 0;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile uint16_t NCM_NETWORK_TEMPLATE_QUALIFIER::_txMaxSize = _TxNtbSize;
+
+    NCM_NETWORK_TEMPLATE_ARGS
+    volatile bool NCM_NETWORK_TEMPLATE_QUALIFIER::_txSending = false;
+
+    /**
+     * @brief Implements NCM communication interface
+     *
+     * @details
+     * Interface handles NCM requests and sends link state notifications to host. MAC address
+     * is string descriptor (12 hex digits), default index is serial number string. It's host side address,
+     * device IP stack should use other address.
+     *
+     * @tparam _Number Interface number
+     * @tparam _DataNumber Data interface number
+     * @tparam _Ep0 Zero endpoint instance
+     * @tparam _NotificationEp Notification (interrupt IN) endpoint
+     * @tparam _Network Data path (@ref NcmNetwork)
+     * @tparam _MacStringIndex MAC address string index
+     * @tparam _Speed Reported link speed (bits per second)
+     */
+    template<uint8_t _Number, uint8_t _DataNumber, typename _Ep0, typename _NotificationEp, typename _Network, uint8_t _MacStringIndex = 3, uint32_t _Speed = 12000000>
+    class NcmCommInterface : public Interface<_Number, 0, DeviceAndInterfaceClass::Comm, static_cast<uint8_t>(CdcInterfaceSubClass::Ncm), 0, _Ep0, _NotificationEp>
+    {
+        using Base = Interface<_Number, 0, DeviceAndInterfaceClass::Comm, static_cast<uint8_t>(CdcInterfaceSubClass::Ncm), 0, _Ep0, _NotificationEp>;
+        static constexpr auto Functionals = Zhele::TemplateUtils::TypeList<HeaderFunctional, NcmUnionFunctional<_Number, _DataNumber>,
+            EthernetNetworkingFunctional<_MacStringIndex, _Network::MaxFrameSize>, NcmFunctional>{};
+
+        /**
+         * @brief Returns nested interface descriptor total size
+         *
+         * @returns Size in bytes
+        */
+        static consteval unsigned NestedDescriptorSize()
+        {
+            unsigned size = 0;
+
+            Base::Endpoints.foreach([&size](auto endpoint) {
+                size += endpoint.GetDescriptor().size();
+            });
+
+            Functionals.foreach([&size](auto functional) {
+                size += functional.GetDescriptor().size();
+            });
+
+            return size;
+        }
+
+    public:
+        using Network = _Network;
+
+        /**
+         * @brief Interface setup request handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            SetupPacket* setup = reinterpret_cast<SetupPacket*>(_Ep0::RxBuffer);
+
+            switch (static_cast<NcmRequest>(setup->Request))
+            {
+            case NcmRequest::GetNtbParameters: {
+                static constexpr NtbParameters parameters = _Network::GetNtbParameters();
+                _Ep0::SendData(&parameters, setup->Length < sizeof(parameters) ? setup->Length : sizeof(parameters));
+                break;
+            }
+            case NcmRequest::GetNtbInputSize: {
+                uint32_t size = _Network::GetInputSize();
+                _Ep0::SendData(&size, setup->Length < sizeof(size) ? setup->Length : sizeof(size));
+                break;
+            }
+            case NcmRequest::SetNtbInputSize:
+                if (setup->Length >= 4)
+                {
+                    _Ep0::SetOutDataTransferCallback([]{
+                        uint32_t size;
+                        memcpy(&size, reinterpret_cast<const void*>(_Ep0::RxBuffer), sizeof(size));
+                        _Network::SetInputSize(size);
+                        _Ep0::ResetOutDataTransferCallback();
+                        _Ep0::SendZLP();
+                    });
+                    _Ep0::SetRxStatus(EndpointStatus::Valid);
+                }
+                break;
+            case NcmRequest::SetEthernetPacketFilter:
+                _Ep0::SendZLP();
+                break;
+            default:
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+                break;
+            }
+        }
+
+        /**
+         * @brief Sets link state
+         *
+         * @details
+         * Host shows network cable connected only after notification, so link is reported
+         * each time host enables data interface (link is up by default).
+         *
+         * @param [in] connected Link is up
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetLinkState(bool connected)
+        {
+            _connected = connected;
+            if (_Network::IsActive())
+                Notify();
+        }
+
+        /**
+         * @brief Data interface alternate setting handler (called by data interface)
+         *
+         * @param [in] active Data path is active
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DataInterfaceSelected(bool active)
+        {
+            _Network::SetActive(active);
+            if (active)
+                Notify();
+        }
+
+        /**
+         * @brief Build interface descriptor (with functionals)
+         *
+         * @returns Bytes of interface descriptor
+         */
+        static consteval auto GetDescriptor()
+        {
+            constexpr unsigned size = sizeof(InterfaceDescriptor) + NestedDescriptorSize();
+            std::array<uint8_t, size> result;
+
+            constexpr auto head = InterfaceDescriptor {
+                .Number = _Number,
+                .AlternateSetting = 0,
+                .EndpointsCount = Base::EndpointsCount,
+                .Class = DeviceAndInterfaceClass::Comm,
+                .SubClass = static_cast<uint8_t>(CdcInterfaceSubClass::Ncm),
+                .Protocol = 0
+            }.GetBytes();
+            auto dst = std::copy(head.begin(), head.end(), result.begin());
+
+            Functionals.foreach([&dst](auto functional){
+                auto nextFunctionalDescriptor = Zhele::TemplateUtils::TypeUnbox<functional>::GetDescriptor();
+                dst = std::copy(nextFunctionalDescriptor.begin(), nextFunctionalDescriptor.end(), dst);
+            });
+
+            Base::Endpoints.foreach([&dst](auto endpoint) {
+                auto nextEndpointDescriptor = Zhele::TemplateUtils::TypeUnbox<endpoint>::GetDescriptor();
+                dst = std::copy(nextEndpointDescriptor.begin(), nextEndpointDescriptor.end(), dst);
+            });
+
+            return result;
+        }
+
+    private:
+        /**
+         * @brief Sends connection speed and connection state notifications
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Notify()
+        {
+            _notification = {
+                .Notification = NcmNotification::ConnectionSpeedChange,
+                .Value = 0,
+                .Index = _Number,
+                .Length = 8,
+                .DownlinkSpeed = _Speed,
+                .UplinkSpeed = _Speed
+            };
+            _NotificationEp::SendData(&_notification, sizeof(_notification), []{
+                _notification.Notification = NcmNotification::NetworkConnection;
+                _notification.Value = _connected ? 1 : 0;
+                _notification.Length = 0;
+                _NotificationEp::SendData(&_notification, 8, nullptr);
+            });
+        }
+
+        static NcmNotificationPacket _notification;
+        static volatile bool _connected;
+    };
+
+    template<uint8_t _Number, uint8_t _DataNumber, typename _Ep0, typename _NotificationEp, typename _Network, uint8_t _MacStringIndex, uint32_t _Speed>
+    NcmNotificationPacket NcmCommInterface<_Number, _DataNumber, _Ep0, _NotificationEp, _Network, _MacStringIndex, _Speed>::_notification = {};
+
+    template<uint8_t _Number, uint8_t _DataNumber, typename _Ep0, typename _NotificationEp, typename _Network, uint8_t _MacStringIndex, uint32_t _Speed>
+    volatile bool NcmCommInterface<_Number, _DataNumber, _Ep0, _NotificationEp, _Network, _MacStringIndex, _Speed>::_connected = true;
+
+    /**
+     * @brief Implements NCM data interface
+     *
+     * @details
+     * Interface has two alternate settings: 0 without endpoints (data path is disabled)
+     * and 1 with bulk endpoints. Host enables data path by SET_INTERFACE request.
+     *
+     * @tparam _Number Interface number
+     * @tparam _Ep0 Zero endpoint instance
+     * @tparam _Comm Communication interface (@ref NcmCommInterface)
+     * @tparam _Endpoints Bulk endpoints
+     */
+    template<uint8_t _Number, typename _Ep0, typename _Comm, typename... _Endpoints>
+    class NcmDataInterface : public Interface<_Number, 1, DeviceAndInterfaceClass::CdcData, 0, 0x01, _Ep0, _Endpoints...>
+    {
+        using Base = Interface<_Number, 1, DeviceAndInterfaceClass::CdcData, 0, 0x01, _Ep0, _Endpoints...>;
+    public:
+        /**
+         * @brief Reset interface
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            Base::Reset();
+            _alternateSetting = 0;
+            _Comm::Network::SetActive(false);
+        }
+
+        /**
+         * @brief Interface setup request handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            SetupPacket* setup = reinterpret_cast<SetupPacket*>(_Ep0::RxBuffer);
+
+            switch (setup->Request)
+            {
+            case StandartRequestCode::SetInterface:
+                _alternateSetting = setup->Value == 1 ? 1 : 0;
+                _Ep0::SendZLP();
+                _Comm::DataInterfaceSelected(_alternateSetting == 1);
+                break;
+            case StandartRequestCode::GetInterface:
+                _Ep0::SendData(&_alternateSetting, 1);
+                break;
+            default:
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+                break;
+            }
+        }
+
+        /**
+         * @brief Build interface descriptor (both alternate settings)
+         *
+         * @returns Bytes of interface descriptor
+         */
+        static consteval auto GetDescriptor()
+        {
+            constexpr auto withEndpoints = Base::GetDescriptor();
+            std::array<uint8_t, sizeof(InterfaceDescriptor) + withEndpoints.size()> result;
+
+            constexpr auto head = InterfaceDescriptor {
+                .Number = _Number,
+                .AlternateSetting = 0,
+                .EndpointsCount = 0,
+                .Class = DeviceAndInterfaceClass::CdcData,
+                .SubClass = 0,
+                .Protocol = 0x01
+            }.GetBytes();
+            auto dst = std::copy(head.begin(), head.end(), result.begin());
+            std::copy(withEndpoints.begin(), withEndpoints.end(), dst);
+
+            return result;
+        }
+
+    private:
+        static uint8_t _alternateSetting;
+    };
+
+    template<uint8_t _Number, typename _Ep0, typename _Comm, typename... _Endpoints>
+    uint8_t NcmDataInterface<_Number, _Ep0, _Comm, _Endpoints...>::_alternateSetting = 0;
+}
+
+#endif //! ZHELE_USB_NCM_H
@@ -0,0 +1,196 @@
+/**
+ * @file
+ * Implements queue of IN transfers
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_TRANSFER_QUEUE_H
+#define ZHELE_USB_TRANSFER_QUEUE_H
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Usb
+{
+    /// Buffer release callback (called from USB interrupt after buffer is sent or dropped)
+    using InTransferReleaseCallback = std::add_pointer_t<void(const void* data)>;
+
+    /**
+     * @brief Implements queue of IN transfers for endpoint
+     *
+     * @details
+     * Endpoint's SendData accepts one transfer only, so next send before complete callback
+     * overwrites current transfer. Queue holds up to _Depth transfers and starts next one
+     * from transfer complete callback (i.e. from USB interrupt, main loop is not involved).
+     * Data is not copied: buffer is owned by queue from @ref Push until its release callback,
+     * so release callback should return buffer to application pool.
+     * All endpoint transfers must be sent through queue.
+     *
+     * @par Example
+     * @code
+     *  Containers::BlockPool<64, 8> frames;
+     *  using TelemetryQueue = InTransferQueue<CdcDataInEp, 8>;
+     *  void FrameSent(const void* frame) { frames.deallocate(const_cast<void*>(frame)); }
+     *  ...
+     *  if (void* frame = frames.allocate())
+     *  {
+     *      unsigned size = FillFrame(frame);
+     *      if (!TelemetryQueue::Push(frame, size, FrameSent))
+     *          frames.deallocate(frame);
+     *  }
+     * @endcode
+     *
+     * @tparam _Ep IN (or bidirectional) endpoint
+     * @tparam _Depth Queue depth (transfers count)
+     */
+    template<typename _Ep, unsigned _Depth = 4>
+    class InTransferQueue
+    {
+        static_assert(_Depth > 0 && _Depth < 0xff, "Invalid queue depth");
+
+        /// Queued transfer
+        struct Transfer
+        {
+            const void* Data; ///< Data
+            uint32_t Size; ///< Data size
+            InTransferReleaseCallback Release; ///< Release callback
+        };
+    public:
+        /**
+         * @brief Push transfer to queue (transfer is started immediately if endpoint is idle)
+         *
+         * @param [in] data Data (must be valid until release callback)
+         * @param [in] size Data size
+         * @param [in, opt] release Release callback
+         *
+         * @retval true Transfer is queued
+         * @retval false Queue is full (buffer is not owned by queue)
+         */
+        static bool Push(const void* data, uint32_t size, InTransferReleaseCallback release = nullptr)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+
+            if (_count == _Depth)
+            {
+                __set_PRIMASK(primask);
+                return false;
+            }
+
+            _transfers[(_head + _count) % _Depth] = Transfer{data, size, release};
+            _count = _count + 1;
+
+            if (!_busy)
+                StartNext();
+
+            __set_PRIMASK(primask);
+            return true;
+        }
+
+        /**
+         * @brief Drop all queued transfers (call it on USB reset, when endpoint transfer is aborted), release callbacks are called
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Clear()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+
+            while (_count > 0)
+            {
+                Transfer transfer = _transfers[_head];
+                _head = (_head + 1) % _Depth;
+                _count = _count - 1;
+
+                if (transfer.Release)
+                    transfer.Release(transfer.Data);
+            }
+            _busy = false;
+
+            __set_PRIMASK(primask);
+        }
+
+        /**
+         * @brief Returns queued transfers count (including transfer in progress)
+         *
+         * @returns Transfers count
+         */
+        static unsigned Size()
+        {
+            return _count;
+        }
+
+        /**
+         * @brief Check that queue has no room
+         *
+         * @retval true Queue is full
+         * @retval false Queue has room
+         */
+        static bool Full()
+        {
+            return _count == _Depth;
+        }
+
+        /**
+         * @brief Check that all transfers are completed
+         *
+         * @retval true Queue is empty
+         * @retval false There are queued transfers
+         */
+        static bool Empty()
+        {
+            return _count == 0;
+        }
+
+    private:
+        static void StartNext()
+        {
+            _busy = true;
+            const Transfer& transfer = _transfers[_head];
+            _Ep::SendData(transfer.Data, transfer.Size, TransferComplete);
+        }
+
+        static void TransferComplete()
+        {
+            if (_count == 0)
+                return;
+
+            Transfer transfer = _transfers[_head];
+            _head = (_head + 1) % _Depth;
+            _count = _count - 1;
+
+            // Next transfer is started before release, so endpoint is not idle while application handles buffer
+            if (_count > 0)
+                StartNext();
+            else
+                _busy = false;
+
+            if (transfer.Release)
+                transfer.Release(transfer.Data);
+        }
+
+        static Transfer _transfers[_Depth];
+        static volatile uint8_t _head;
+        static volatile uint8_t _count;
+        static volatile bool _busy;
+    };
+
+    template<typename _Ep, unsigned _Depth>
+    typename InTransferQueue<_Ep, _Depth>::Transfer InTransferQueue<_Ep, _Depth>::_transfers[_Depth];
+
+    template<typename _Ep, unsigned _Depth>
+    volatile uint8_t InTransferQueue<_Ep, _Depth>::_head = 0;
+
+    template<typename _Ep, unsigned _Depth>
+    volatile uint8_t InTransferQueue<_Ep, _Depth>::_count = 0;
+
+    template<typename _Ep, unsigned _Depth>
+    volatile bool InTransferQueue<_Ep, _Depth>::_busy = false;
+}
+
+#endif //! ZHELE_USB_TRANSFER_QUEUE_H
@@ -0,0 +1,231 @@
+/**
+ * @file
+ * Implements vendor-specific interface with WinUSB (MS OS 2.0) descriptors
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_WINUSB_H
+#define ZHELE_USB_WINUSB_H
+
+#include "common.h"
+#include "endpoint.h"
+#include "interface.h"
+
+#include "../template_utils/type_list.h"
+
+#include <array>
+#include <stdint.h>
+
+/// Vendor request code for MS OS 2.0 descriptor set request
+#if !defined (ZHELE_USB_MS_OS_VENDOR_CODE)
+    #define ZHELE_USB_MS_OS_VENDOR_CODE 0x20
+#endif
+
+namespace Zhele::Usb
+{
+    /**
+     * @brief Implements vendor-specific interface, that is bound to WinUSB driver without INF
+     *
+     * @details
+     * Device with this interface returns BOS descriptor and MS OS 2.0 descriptor set
+     * (compatible ID "WINUSB" and DeviceInterfaceGUIDs registry property), so Windows 8.1+
+     * installs WinUSB automatically. Linux and macOS use libusb without kernel driver.
+     * Device USB version must be 0x0201 (or higher), otherwise Windows does not ask BOS descriptor.
+     * Interface has no class requests, endpoints are handled by application.
+     *
+     * @par Example
+     * @code
+     *  using BulkOutEpBase = BulkDoubleBufferedEndpointBase<1, EndpointDirection::Out, 64>;
+     *  using BulkInEpBase = BulkDoubleBufferedEndpointBase<2, EndpointDirection::In, 64>;
+     *  constexpr Zhele::TemplateUtils::fixed_string_16 LinkGuid(u"{2E2A4F17-96C1-4C6E-9E1E-1A3D2F0B7C55}");
+     *  ...
+     *  using Link = WinUsbInterface<0, 0, Ep0, LinkGuid, BulkOutEp, BulkInEp>;
+     *  using Config = Configuration<0, 250, false, false, Link>;
+     *  using MyDevice = Device<0x0201, DeviceAndInterfaceClass::InterfaceSpecified, 0, 0, 0x0483, 0x5720, 0, Ep0, Config>;
+     * @endcode
+     *
+     * @tparam _Number Interface number
+     * @tparam _AlternateSetting Interface alternate setting
+     * @tparam _Ep0 Zero endpoint instance
+     * @tparam _InterfaceGuid Device interface GUID (UTF-16 string "{XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX}")
+     * @tparam _Endpoints Endpoints
+     */
+    template <uint8_t _Number, uint8_t _AlternateSetting, typename _Ep0, auto _InterfaceGuid, typename... _Endpoints>
+    class WinUsbInterface : public Interface<_Number, _AlternateSetting, DeviceAndInterfaceClass::VendorSpecified, 0, 0, _Ep0, _Endpoints...>
+    {
+        static_assert(_InterfaceGuid.Length == 38, "Interface GUID must be in registry format: {XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX}");
+    public:
+        /// Device interface GUID
+        static constexpr auto InterfaceGuid = _InterfaceGuid;
+
+        /**
+         * @brief Interface setup request handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            _Ep0::SetTxStatus(EndpointStatus::Stall);
+        }
+    };
+
+    /**
+     * @brief Builds BOS descriptor and MS OS 2.0 descriptor set for WinUSB interfaces
+     *
+     * @details
+     * Descriptor set contains compatible ID and registry property for every @ref WinUsbInterface.
+     * If device has one interface, features are at set level, otherwise (composite device)
+     * they are wrapped by configuration and function subsets.
+     *
+     * @tparam Interfaces All device interfaces
+     */
+    template<typename... Interfaces>
+    class MsOs20Descriptors
+    {
+        static constexpr auto _interfaces = Zhele::TemplateUtils::TypeList<Interfaces...>{};
+        static constexpr auto _winUsbInterfaces = _interfaces.filter([](auto interface) {
+            return requires { Zhele::TemplateUtils::TypeUnbox<interface>::InterfaceGuid; };
+        });
+
+        static const uint16_t SetHeaderSize = 10;
+        static const uint16_t ConfigurationSubsetSize = 8;
+        static const uint16_t FunctionSubsetSize = 8;
+        static const uint16_t CompatibleIdSize = 20;
+        static const uint16_t RegistryPropertySize = 10 + 42 + 80;
+        static const uint16_t FeaturesSize = CompatibleIdSize + RegistryPropertySize;
+        static const bool Composite = _interfaces.size() > 1;
+
+        static const uint16_t BosSize = 5 + 28;
+
+        /// Windows version (Windows 8.1)
+        static const uint32_t WindowsVersion = 0x06030000;
+
+        /**
+         * @brief Writes little-endian 16-bit value
+         */
+        static constexpr auto Put16(auto dst, uint16_t value)
+        {
+            *dst++ = value & 0xff;
+            *dst++ = value >> 8;
+            return dst;
+        }
+
+        /**
+         * @brief Writes compatible ID and registry property features
+         */
+        static constexpr auto PutFeatures(auto dst, auto interface)
+        {
+            // Compatible ID
+            dst = Put16(dst, CompatibleIdSize);
+            dst = Put16(dst, 0x03);
+            constexpr char compatibleId[8] = {'W', 'I', 'N', 'U', 'S', 'B', 0, 0};
+            for (char c : compatibleId)
+                *dst++ = c;
+            for (unsigned i = 0; i < 8; ++i)
+                *dst++ = 0;
+
+            // Registry property (REG_MULTI_SZ "DeviceInterfaceGUIDs")
+            dst = Put16(dst, RegistryPropertySize);
+            dst = Put16(dst, 0x04);
+            dst = Put16(dst, 0x07);
+            dst = Put16(dst, 42);
+            constexpr char16_t name[] = u"DeviceInterfaceGUIDs";
+            for (char16_t c : name)
+                dst = Put16(dst, c);
+            dst = Put16(dst, 80);
+            constexpr auto guid = Zhele::TemplateUtils::TypeUnbox<interface>::InterfaceGuid;
+            for (unsigned i = 0; i < guid.Length; ++i)
+                dst = Put16(dst, guid.Text[i]);
+            dst = Put16(dst, 0);
+            dst = Put16(dst, 0);
+
+            return dst;
+        }
+
+    public:
+        /**
+         * @brief Constexpr constructor for CTAD
+        */
+        constexpr MsOs20Descriptors(auto interfaces) {}
+
+        /// Device has WinUSB interfaces (BOS and MS OS 2.0 requests are handled)
+        static constexpr bool Enabled = _winUsbInterfaces.size() > 0;
+
+        /// Descriptor set size
+        static constexpr uint16_t SetSize = SetHeaderSize
+            + (Composite ? ConfigurationSubsetSize + _winUsbInterfaces.size() * (FunctionSubsetSize + FeaturesSize) : FeaturesSize);
+
+        /**
+         * @brief Build BOS descriptor (with MS OS 2.0 platform capability)
+         *
+         * @returns Bytes of descriptor
+         */
+        static consteval auto GetBosDescriptor()
+        {
+            std::array<uint8_t, BosSize> result {
+                5, 0x0f, BosSize & 0xff, BosSize >> 8, 1,
+                // Platform capability
+                28, 0x10, 0x05, 0,
+                // MS OS 2.0 platform capability ID {D8DD60DF-4589-4CC7-9CD2-659D9E648A9F}
+                0xdf, 0x60, 0xdd, 0xd8, 0x89, 0x45, 0xc7, 0x4c, 0x9c, 0xd2, 0x65, 0x9d, 0x9e, 0x64, 0x8a, 0x9f,
+                WindowsVersion & 0xff, (WindowsVersion >> 8) & 0xff, (WindowsVersion >> 16) & 0xff, WindowsVersion >> 24,
+                SetSize & 0xff, SetSize >> 8,
+                ZHELE_USB_MS_OS_VENDOR_CODE,
+                0 // Alternate enumeration
+            };
+
+            return result;
+        }
+
+        /**
+         * @brief Build MS OS 2.0 descriptor set
+         *
+         * @returns Bytes of descriptor set
+         */
+        static consteval auto GetDescriptorSet()
+        {
+            std::array<uint8_t, SetSize> result {};
+            auto dst = result.begin();
+
+            dst = Put16(dst, SetHeaderSize);
+            dst = Put16(dst, 0x00);
+            dst = Put16(dst, WindowsVersion & 0xffff);
+            dst = Put16(dst, WindowsVersion >> 16);
+            dst = Put16(dst, SetSize);
+
+            if constexpr (Composite)
+            {
+                dst = Put16(dst, ConfigurationSubsetSize);
+                dst = Put16(dst, 0x01);
+                *dst++ = 0; // Configuration index
+                *dst++ = 0;
+                dst = Put16(dst, SetSize - SetHeaderSize);
+
+                _winUsbInterfaces.foreach([&dst](auto interface) {
+                    dst = Put16(dst, FunctionSubsetSize);
+                    dst = Put16(dst, 0x02);
+                    *dst++ = Zhele::TemplateUtils::TypeUnbox<interface>::Number;
+                    *dst++ = 0;
+                    dst = Put16(dst, FunctionSubsetSize + FeaturesSize);
+                    dst = PutFeatures(dst, interface);
+                });
+            }
+            else
+            {
+                _winUsbInterfaces.foreach([&dst](auto interface) {
+                    dst = PutFeatures(dst, interface);
+                });
+            }
+
+            return result;
+        }
+    };
+    template<typename... Interfaces>
+    MsOs20Descriptors(Zhele::TemplateUtils::TypeList<Interfaces...> interfaces) -> MsOs20Descriptors<Interfaces...>;
+}
+
+#endif //! ZHELE_USB_WINUSB_H
@@ -14,6 +14,7 @@
 #include <zhele/clock.h>
 
 #include <cstdint>
+#include <utility>
 
 namespace Zhele::Timers
 {
@@ -183,6 +184,111 @@ namespace Zhele::Timers
             return std::make_pair(prescaler, reload);
         }
     };
+
+    /**
+     * @brief Window watchdog
+     * 
+     * @details
+     * Counter is decremented every 4096 * prescaler PCLK cycles, MCU is reset when counter
+     * falls below 0x40 or when it's refreshed while counter is greater than window value.
+     */
+    class WWdg
+    {
+        static const uint8_t MinCounter = 0x40;
+        static const uint8_t MaxCounter = 0x7f;
+
+    public:
+        /**
+         * @brief Prescaler
+         */
+        enum class Prescaler : uint16_t
+        {
+            Div1 = 0b000 << WWDG_CFR_WDGTB_Pos, ///< Divide by 1
+            Div2 = 0b001 << WWDG_CFR_WDGTB_Pos, ///< Divide by 2
+            Div4 = 0b010 << WWDG_CFR_WDGTB_Pos, ///< Divide by 4
+            Div8 = 0b011 << WWDG_CFR_WDGTB_Pos, ///< Divide by 8
+        #if defined (WWDG_CFR_WDGTB_2)
+            Div16 = 0b100 << WWDG_CFR_WDGTB_Pos, ///< Divide by 16
+            Div32 = 0b101 << WWDG_CFR_WDGTB_Pos, ///< Divide by 32
+            Div64 = 0b110 << WWDG_CFR_WDGTB_Pos, ///< Divide by 64
+            Div128 = 0b111 << WWDG_CFR_WDGTB_Pos, ///< Divide by 128
+        #endif
+        };
+
+        /**
+         * @brief Start watchdog
+         * 
+         * @details
+         * Watchdog can't be stopped after start.
+         * 
+         * @param [in] counter Counter reload value (0x40 - 0x7f)
+         * @param [in] window Window value: refresh is allowed when counter is not greater than it (0x40 - 0x7f)
+         * @param [in] prescaler Prescaler
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Start(uint8_t counter, uint8_t window = MaxCounter, Prescaler prescaler = Prescaler::Div8)
+        {
+            _counter = counter & MaxCounter;
+
+            Zhele::Clock::WatchDogClock::Enable();
+            WWDG->CFR = static_cast<uint16_t>(prescaler) | (window & WWDG_CFR_W);
+            WWDG->CR = WWDG_CR_WDGA | _counter;
+        }
+
+        /**
+         * @brief Reset (refresh) watchdog counter
+         * 
+         * @details
+         * Refresh outside of window resets MCU, use @ref IsRefreshAllowed before it.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            WWDG->CR = _counter;
+        }
+
+        /**
+         * @brief Check that counter is in window
+         * 
+         * @retval true Refresh is allowed
+         * @retval false Refresh resets MCU
+         */
+        static bool IsRefreshAllowed()
+        {
+            return (WWDG->CR & WWDG_CR_T) <= (WWDG->CFR & WWDG_CFR_W);
+        }
+
+        /**
+         * @brief Returns counter value
+         * 
+         * @returns Counter (MCU is reset when it falls below 0x40)
+         */
+        static uint8_t GetCounter()
+        {
+            return WWDG->CR & WWDG_CR_T;
+        }
+
+        /**
+         * @brief Returns watchdog timeout for counter value
+         * 
+         * @param [in] counter Counter value
+         * @param [in] prescaler Prescaler
+         * 
+         * @returns Time from refresh to reset (in microseconds)
+         */
+        static uint32_t Timeout(uint8_t counter, Prescaler prescaler)
+        {
+            uint64_t cycles = 4096ull * (counter - MinCounter + 1) << (static_cast<uint16_t>(prescaler) >> WWDG_CFR_WDGTB_Pos);
+            return static_cast<uint32_t>(cycles * 1000000 / Zhele::Clock::WatchDogClock::ClockFreq());
+        }
+
+    private:
+        static inline uint8_t _counter = MaxCounter; ///< Reload value
+    };
 }
 
 #endif //! ZHELE_WATCHDOG_COMMON_H
\ No newline at end of file
@@ -0,0 +1,261 @@
+/**
+ * @file
+ * Implements fixed-size blocks memory pool.
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_BLOCK_POOL_H
+#define ZHELE_BLOCK_POOL_H
+
+#if defined(STM32F0)
+    #include <stm32f0xx.h>
+#endif
+#if defined(STM32F1)
+    #include <stm32f1xx.h>
+#endif
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+#if defined(STM32L4)
+    #include <stm32l4xx.h>
+#endif
+#if defined(STM32G0)
+    #include <stm32g0xx.h>
+#endif
+
+#include <cstddef>
+#include <stdint.h>
+
+/// Alignment of DMA block pool blocks (16 bytes allows 4-beat bursts of words)
+#if !defined (ZHELE_DMA_BUFFER_ALIGNMENT)
+    #define ZHELE_DMA_BUFFER_ALIGNMENT 16
+#endif
+
+namespace Zhele::Containers
+{
+    /**
+     * @brief Implements fixed-size blocks memory pool
+     *
+     * @details
+     * Free blocks are linked into stack, link is stored in free block itself, so pool has no overhead
+     * except head index. Allocate and free are O(1) and lock-free: head is updated by LDREX/STREX,
+     * exception entry clears exclusive monitor, so interrupted update is retried and ABA problem is impossible
+     * (critical section is used on Cortex-M0). So pool can be shared by interrupt handlers and main loop,
+     * for example, for packet buffers of rarely active features instead of static buffer per driver.
+     *
+     * @par Example
+     * @code
+     *  Containers::BlockPool<64, 8> packets;
+     *  // In any context
+     *  if (auto packet = packets.acquire())
+     *  {
+     *      Fill(packet.get());
+     *      Send(packet.get());
+     *  } // Block is freed here
+     * @endcode
+     *
+     * @tparam _BlockSize Block size (in bytes)
+     * @tparam _Count Blocks count
+     * @tparam _Alignment Block alignment
+     */
+    template<size_t _BlockSize, unsigned _Count, size_t _Alignment = alignof(std::max_align_t)>
+    class BlockPool
+    {
+        static_assert(_Count > 0, "Pool must have blocks");
+        static_assert((_Alignment & (_Alignment - 1)) == 0, "Alignment must be power of 2");
+
+        // Free block keeps link word, so block is at least word-sized and word-aligned
+        static const size_t Alignment = _Alignment < alignof(uint32_t) ? alignof(uint32_t) : _Alignment;
+        static const size_t Stride = ((_BlockSize < sizeof(uint32_t) ? sizeof(uint32_t) : _BlockSize) + Alignment - 1) & ~(Alignment - 1);
+        static const uint32_t None = _Count;
+    public:
+        /**
+         * @brief RAII block owner (frees block on destruction)
+         */
+        class Handle
+        {
+        public:
+            /**
+             * @brief Constructs empty handle
+             */
+            Handle() = default;
+
+            /**
+             * @brief Takes ownership of block
+             *
+             * @param [in] pool Pool
+             * @param [in] block Block of pool (or nullptr)
+             */
+            Handle(BlockPool& pool, void* block)
+                : _pool(&pool), _block(block)
+            {}
+
+            Handle(const Handle&) = delete;
+            Handle& operator=(const Handle&) = delete;
+
+            /**
+             * @brief Move constructor
+             *
+             * @param [in] other Other handle
+             */
+            Handle(Handle&& other)
+                : _pool(other._pool), _block(other.release())
+            {}
+
+            /**
+             * @brief Move assignment
+             *
+             * @param [in] other Other handle
+             *
+             * @returns This handle
+             */
+            Handle& operator=(Handle&& other)
+            {
+                if (this != &other)
+                {
+                    reset();
+                    _pool = other._pool;
+                    _block = other.release();
+                }
+                return *this;
+            }
+
+            /**
+             * @brief Destructor (frees block)
+             */
+            ~Handle()
+            {
+                reset();
+            }
+
+            /**
+             * @brief Returns block
+             *
+             * @returns Block (nullptr if handle is empty)
+             */
+            void* get() const
+            {
+                return _block;
+            }
+
+            /**
+             * @brief Check that handle owns block
+             */
+            explicit operator bool() const
+            {
+                return _block != nullptr;
+            }
+
+            /**
+             * @brief Releases ownership (block is not freed)
+             *
+             * @returns Block
+             */
+            void* release()
+            {
+                void* block = _block;
+                _block = nullptr;
+                return block;
+            }
+
+            /**
+             * @brief Frees owned block
+             *
+             * @par Returns
+             *  Nothing
+             */
+            void reset()
+            {
+                if (_block != nullptr)
+                    _pool->deallocate(release());
+            }
+
+        private:
+            BlockPool* _pool = nullptr;
+            void* _block = nullptr;
+        };
+
+        /**
+         * @brief Constructor
+         */
+        BlockPool();
+
+        /**
+         * @brief Returns block size
+         *
+         * @returns Block size (in bytes)
+         */
+        static constexpr size_t block_size();
+
+        /**
+         * @brief Returns blocks count
+         *
+         * @returns Blocks count
+         */
+        static constexpr unsigned capacity();
+
+        /**
+         * @brief Check for free blocks
+         *
+         * @retval true There is no free blocks
+         * @retval false There is free block
+         */
+        bool empty() const;
+
+        /**
+         * @brief Allocates block
+         *
+         * @returns Block (nullptr if there is no free blocks)
+         */
+        void* allocate();
+
+        /**
+         * @brief Frees block
+         *
+         * @param [in] block Block allocated from this pool
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void deallocate(void* block);
+
+        /**
+         * @brief Allocates block with RAII owner
+         *
+         * @returns Handle (empty if there is no free blocks)
+         */
+        Handle acquire();
+
+        /**
+         * @brief Check that pointer belongs to pool
+         *
+         * @param [in] pointer Pointer
+         *
+         * @retval true Pointer is inside of pool storage
+         * @retval false Pointer is not from pool
+         */
+        bool owns(const void* pointer) const;
+
+    private:
+        uint32_t& Link(uint32_t index);
+
+        alignas(Alignment) uint8_t _storage[Stride * _Count];
+        volatile uint32_t _head;
+    };
+
+    /**
+     * @brief Block pool for DMA buffers (blocks are aligned to ZHELE_DMA_BUFFER_ALIGNMENT)
+     *
+     * @tparam _BlockSize Block size (in bytes)
+     * @tparam _Count Blocks count
+     */
+    template<size_t _BlockSize, unsigned _Count>
+    using DmaBlockPool = BlockPool<_BlockSize, _Count, ZHELE_DMA_BUFFER_ALIGNMENT>;
+} // namespace Zhele::Containers
+
+#include "impl/block_pool.h"
+
+#endif //! ZHELE_BLOCK_POOL_H
@@ -0,0 +1,122 @@
+/**
+ * @file
+ * Fixed-size blocks memory pool methods implementation.
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_BLOCK_POOL_IMPL_H
+#define ZHELE_BLOCK_POOL_IMPL_H
+
+#include <new>
+
+namespace Zhele::Containers
+{
+    #define BLOCK_POOL_TEMPLATE_ARGS template<size_t _BlockSize, unsigned _Count, size_t _Alignment>
+    #define BLOCK_POOL_TEMPLATE_QUALIFIER BlockPool<_BlockSize, _Count, _Alignment>
+
+    BLOCK_POOL_TEMPLATE_ARGS
+    BLOCK_POOL_TEMPLATE_QUALIFIER::BlockPool()
+        : _head(0)
+    {
+        for (uint32_t i = 0; i < _Count; ++i)
+        {
+            new (&_storage[i * Stride]) uint32_t(i + 1);
+        }
+    }
+
+    BLOCK_POOL_TEMPLATE_ARGS
+    constexpr size_t BLOCK_POOL_TEMPLATE_QUALIFIER::block_size()
+    {
+        return Stride;
+    }
+
+    BLOCK_POOL_TEMPLATE_ARGS
+    constexpr unsigned BLOCK_POOL_TEMPLATE_QUALIFIER::capacity()
+    {
+        return _Count;
+    }
+
+    BLOCK_POOL_TEMPLATE_ARGS
+    bool BLOCK_POOL_TEMPLATE_QUALIFIER::empty() const
+    {
+        return _head == None;
+    }
+
+    BLOCK_POOL_TEMPLATE_ARGS
+    void* BLOCK_POOL_TEMPLATE_QUALIFIER::allocate()
+    {
+    #if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+        for (;;)
+        {
+            uint32_t head = __LDREXW(&_head);
+            if (head == None)
+            {
+                __CLREX();
+                return nullptr;
+            }
+            // Link may be overwritten by preempting owner, but then store fails
+            uint32_t next = Link(head);
+            if (__STREXW(next, &_head) == 0)
+                return &_storage[head * Stride];
+        }
+    #else
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        uint32_t head = _head;
+        if (head != None)
+            _head = Link(head);
+
+        __set_PRIMASK(primask);
+        return head != None ? &_storage[head * Stride] : nullptr;
+    #endif
+    }
+
+    BLOCK_POOL_TEMPLATE_ARGS
+    void BLOCK_POOL_TEMPLATE_QUALIFIER::deallocate(void* block)
+    {
+        if (block == nullptr)
+            return;
+
+        uint32_t index = (static_cast<uint8_t*>(block) - _storage) / Stride;
+    #if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+        do
+        {
+            Link(index) = __LDREXW(&_head);
+        }
+        while (__STREXW(index, &_head) != 0);
+    #else
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        Link(index) = _head;
+        _head = index;
+
+        __set_PRIMASK(primask);
+    #endif
+    }
+
+    BLOCK_POOL_TEMPLATE_ARGS
+    typename BLOCK_POOL_TEMPLATE_QUALIFIER::Handle BLOCK_POOL_TEMPLATE_QUALIFIER::acquire()
+    {
+        return Handle(*this, allocate());
+    }
+
+    BLOCK_POOL_TEMPLATE_ARGS
+    bool BLOCK_POOL_TEMPLATE_QUALIFIER::owns(const void* pointer) const
+    {
+        const uint8_t* address = static_cast<const uint8_t*>(pointer);
+        return address >= _storage && address < _storage + sizeof(_storage);
+    }
+
+    BLOCK_POOL_TEMPLATE_ARGS
+    uint32_t& BLOCK_POOL_TEMPLATE_QUALIFIER::Link(uint32_t index)
+    {
+        return *std::launder(reinterpret_cast<uint32_t*>(&_storage[index * Stride]));
+    }
+}
+
+#endif //! ZHELE_BLOCK_POOL_IMPL_H
@@ -0,0 +1,119 @@
+/**
+ * @file
+ * Multiple producers single consumer queue methods implementation.
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_MPSC_QUEUE_IMPL_H
+#define ZHELE_MPSC_QUEUE_IMPL_H
+
+namespace Zhele::Containers
+{
+    #define MPSC_QUEUE_TEMPLATE_ARGS template<unsigned _Size, typename _DataType>
+    #define MPSC_QUEUE_TEMPLATE_QUALIFIER MpscQueue<_Size, _DataType>
+
+    MPSC_QUEUE_TEMPLATE_ARGS
+    MPSC_QUEUE_TEMPLATE_QUALIFIER::MpscQueue()
+    {
+        for (uint32_t i = 0; i < _Size; ++i)
+        {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPSC_QUEUE_TEMPLATE_ARGS
+    constexpr typename MPSC_QUEUE_TEMPLATE_QUALIFIER::size_type MPSC_QUEUE_TEMPLATE_QUALIFIER::capacity()
+    {
+        return _Size;
+    }
+
+    MPSC_QUEUE_TEMPLATE_ARGS
+    typename MPSC_QUEUE_TEMPLATE_QUALIFIER::size_type MPSC_QUEUE_TEMPLATE_QUALIFIER::size() const
+    {
+        return _writeCount - _readCount;
+    }
+
+    MPSC_QUEUE_TEMPLATE_ARGS
+    bool MPSC_QUEUE_TEMPLATE_QUALIFIER::empty() const
+    {
+        return _slots[_readCount & Mask].sequence.load(std::memory_order_acquire) != _readCount + 1;
+    }
+
+    MPSC_QUEUE_TEMPLATE_ARGS
+    bool MPSC_QUEUE_TEMPLATE_QUALIFIER::push(const _DataType& value)
+    {
+        uint32_t position;
+        if (!Reserve(position))
+            return false;
+
+        Slot& slot = _slots[position & Mask];
+        slot.value = value;
+        slot.sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    MPSC_QUEUE_TEMPLATE_ARGS
+    bool MPSC_QUEUE_TEMPLATE_QUALIFIER::pop(_DataType& value)
+    {
+        Slot& slot = _slots[_readCount & Mask];
+        if (slot.sequence.load(std::memory_order_acquire) != _readCount + 1)
+            return false;
+
+        value = slot.value;
+        // Slot is free for position of next lap
+        slot.sequence.store(_readCount + _Size, std::memory_order_release);
+        ++_readCount;
+        return true;
+    }
+
+    MPSC_QUEUE_TEMPLATE_ARGS
+    typename MPSC_QUEUE_TEMPLATE_QUALIFIER::size_type MPSC_QUEUE_TEMPLATE_QUALIFIER::pop_n(_DataType* values, size_type count)
+    {
+        size_type result = 0;
+        while (result < count && pop(values[result]))
+        {
+            ++result;
+        }
+        return result;
+    }
+
+    MPSC_QUEUE_TEMPLATE_ARGS
+    bool MPSC_QUEUE_TEMPLATE_QUALIFIER::Reserve(uint32_t& position)
+    {
+    #if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+        for (;;)
+        {
+            position = __LDREXW(&_writeCount);
+            int32_t lag = static_cast<int32_t>(_slots[position & Mask].sequence.load(std::memory_order_acquire) - position);
+            if (lag == 0)
+            {
+                if (__STREXW(position + 1, &_writeCount) == 0)
+                    return true;
+                continue;
+            }
+
+            __CLREX();
+            // Slot of previous lap is not popped yet
+            if (lag < 0)
+                return false;
+            // Otherwise slot was reserved by preempting producer, retry with new position
+        }
+    #else
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        position = _writeCount;
+        bool reserved = _slots[position & Mask].sequence.load(std::memory_order_acquire) == position;
+        if (reserved)
+            _writeCount = position + 1;
+
+        __set_PRIMASK(primask);
+        return reserved;
+    #endif
+    }
+}
+
+#endif //! ZHELE_MPSC_QUEUE_IMPL_H
@@ -11,6 +11,10 @@
 #define ZHELE_RINGBUFFER_IMPL_H
 
 #include <atomic>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
 
 namespace Zhele::Containers::Private
 {
@@ -22,6 +26,12 @@ namespace Zhele::Containers::Private
     {
     }
 
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    RINGBUFFERPO2_TEMPLATE_QUALIFIER::~RingBufferPO2()
+    {
+        clear();
+    }
+
     RINGBUFFERPO2_TEMPLATE_ARGS
     typename RINGBUFFERPO2_TEMPLATE_QUALIFIER::size_type RINGBUFFERPO2_TEMPLATE_QUALIFIER::capacity() const
     {
@@ -75,20 +85,32 @@ namespace Zhele::Containers::Private
     RINGBUFFERPO2_TEMPLATE_ARGS
     bool RINGBUFFERPO2_TEMPLATE_QUALIFIER::push_back(const _DataType& value)
     {
-        if(full())
-            return false;
-
-        data()[_writeCount++ & _mask] = value;
+        return emplace_back(value);
+    }
 
-        return true;
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    bool RINGBUFFERPO2_TEMPLATE_QUALIFIER::push_back(_DataType&& value)
+    {
+        return emplace_back(std::move(value));
     }
 
     RINGBUFFERPO2_TEMPLATE_ARGS
     bool RINGBUFFERPO2_TEMPLATE_QUALIFIER::push_back()
+    {
+        return emplace_back();
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    template<typename... Args>
+    bool RINGBUFFERPO2_TEMPLATE_QUALIFIER::emplace_back(Args&&... args)
     {
         if(full())
-            return 0;
-        new(&data()[_writeCount++ & _mask]) _DataType();
+            return false;
+
+        // Element is constructed before it becomes visible for reader
+        new(&data()[_writeCount & _mask]) _DataType(std::forward<Args>(args)...);
+        ++_writeCount;
+
         return true;
     }
 
@@ -98,18 +120,66 @@ namespace Zhele::Containers::Private
         if(empty())
             return false;
 
+        if constexpr (!std::is_trivially_destructible_v<_DataType>)
+            std::destroy_at(&front());
         ++_readCount;
 
         return true;
-    }    
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    bool RINGBUFFERPO2_TEMPLATE_QUALIFIER::pop_front(_DataType& value)
+    {
+        if(empty())
+            return false;
+
+        value = std::move(front());
+        return pop_front();
+    }
 
     RINGBUFFERPO2_TEMPLATE_ARGS
     void RINGBUFFERPO2_TEMPLATE_QUALIFIER::clear()
     {
+        if constexpr (!std::is_trivially_destructible_v<_DataType>)
+        {
+            while(pop_front()) ;
+        }
         _readCount = 0;
         _writeCount = 0;
     }
 
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    std::span<_DataType> RINGBUFFERPO2_TEMPLATE_QUALIFIER::readable_span()
+    {
+        size_type first = _readCount & _mask;
+        size_type count = size();
+        if (count > _Size - first)
+            count = _Size - first;
+        return {data() + first, count};
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    std::span<_DataType> RINGBUFFERPO2_TEMPLATE_QUALIFIER::writable_span()
+    {
+        size_type last = _writeCount & _mask;
+        size_type count = _Size - size();
+        if (count > _Size - last)
+            count = _Size - last;
+        return {data() + last, count};
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    void RINGBUFFERPO2_TEMPLATE_QUALIFIER::commit(size_type count)
+    {
+        _writeCount += count;
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    void RINGBUFFERPO2_TEMPLATE_QUALIFIER::consume(size_type count)
+    {
+        _readCount += count;
+    }
+
     RINGBUFFERPO2_TEMPLATE_ARGS
     _DataType& RINGBUFFERPO2_TEMPLATE_QUALIFIER::operator[] (size_type index)
     {
@@ -141,6 +211,12 @@ namespace Zhele::Containers::Private
     {
     }
 
+    RINGBUFFER_TEMPLATE_ARGS
+    RINGBUFFER_TEMPLATE_QUALIFIER::~RingBuffer()
+    {
+        clear();
+    }
+
     RINGBUFFER_TEMPLATE_ARGS
     typename RINGBUFFER_TEMPLATE_QUALIFIER::size_type RINGBUFFER_TEMPLATE_QUALIFIER::capacity() const
     {
@@ -192,37 +268,46 @@ namespace Zhele::Containers::Private
     RINGBUFFER_TEMPLATE_ARGS
     bool RINGBUFFER_TEMPLATE_QUALIFIER::push_back(const _DataType& item)
     {
-        if(_count.load() == _Size)
-            return false;
-        data()[_last] = item;
-        _last++;
-        if(_last >= _Size)
-            _last = 0;
-        _count.fetch_add(1);
-        return true;
+        return emplace_back(item);
+    }
+
+    RINGBUFFER_TEMPLATE_ARGS
+    bool RINGBUFFER_TEMPLATE_QUALIFIER::push_back(_DataType&& item)
+    {
+        return emplace_back(std::move(item));
     }
 
     RINGBUFFER_TEMPLATE_ARGS
     bool RINGBUFFER_TEMPLATE_QUALIFIER::push_back()
+    {
+        return emplace_back();
+    }
+
+    RINGBUFFER_TEMPLATE_ARGS
+    template<typename... Args>
+    bool RINGBUFFER_TEMPLATE_QUALIFIER::emplace_back(Args&&... args)
     {
         if(_count.load() == _Size)
             return false;
-        new (&data()[_last]) _DataType();
+        new (&data()[_last]) _DataType(std::forward<Args>(args)...);
         ++_last;
 
         if(_last >= _Size)
             _last = 0;
 
         _count.fetch_add(1);
-        
+
         return true;
     }
 
     RINGBUFFER_TEMPLATE_ARGS
     bool RINGBUFFER_TEMPLATE_QUALIFIER::pop_front()
     {
-        if(&_count.load() != 0)
+        if(_count.load() != 0)
         {
+            if constexpr (!std::is_trivially_destructible_v<_DataType>)
+                std::destroy_at(&data()[_first]);
+
             _count.fetch_sub(1);
             ++_first;
 
@@ -235,14 +320,59 @@ namespace Zhele::Containers::Private
         return false;
     }
 
+    RINGBUFFER_TEMPLATE_ARGS
+    bool RINGBUFFER_TEMPLATE_QUALIFIER::pop_front(_DataType& value)
+    {
+        if(_count.load() == 0)
+            return false;
+
+        value = std::move(data()[_first]);
+        return pop_front();
+    }
+
     RINGBUFFER_TEMPLATE_ARGS
     void RINGBUFFER_TEMPLATE_QUALIFIER::clear()
     {
-        do
+        if constexpr (!std::is_trivially_destructible_v<_DataType>)
         {
-            _first = _last = 0;
+            while(pop_front()) ;
         }
-        while(!_count.compare_exchange_weak(_count.load(), size_type(0)));
+        _first = _last = 0;
+        _count.store(0);
+    }
+
+    RINGBUFFER_TEMPLATE_ARGS
+    std::span<_DataType> RINGBUFFER_TEMPLATE_QUALIFIER::readable_span()
+    {
+        size_type count = _count.load();
+        if (count > _Size - _first)
+            count = _Size - _first;
+        return {data() + _first, count};
+    }
+
+    RINGBUFFER_TEMPLATE_ARGS
+    std::span<_DataType> RINGBUFFER_TEMPLATE_QUALIFIER::writable_span()
+    {
+        size_type count = _Size - _count.load();
+        if (count > _Size - _last)
+            count = _Size - _last;
+        return {data() + _last, count};
+    }
+
+    RINGBUFFER_TEMPLATE_ARGS
+    void RINGBUFFER_TEMPLATE_QUALIFIER::commit(size_type count)
+    {
+        size_type last = _last + count;
+        _last = last >= _Size ? last - _Size : last;
+        _count.fetch_add(count);
+    }
+
+    RINGBUFFER_TEMPLATE_ARGS
+    void RINGBUFFER_TEMPLATE_QUALIFIER::consume(size_type count)
+    {
+        size_type first = _first + count;
+        _first = first >= _Size ? first - _Size : first;
+        _count.fetch_sub(count);
     }
 
     RINGBUFFER_TEMPLATE_ARGS
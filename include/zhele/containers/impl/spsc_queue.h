@@ -0,0 +1,110 @@
+/**
+ * @file
+ * Single producer single consumer queue methods implementation.
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SPSC_QUEUE_IMPL_H
+#define ZHELE_SPSC_QUEUE_IMPL_H
+
+#include <algorithm>
+
+namespace Zhele::Containers
+{
+    #define SPSC_QUEUE_TEMPLATE_ARGS template<unsigned _Size, typename _DataType>
+    #define SPSC_QUEUE_TEMPLATE_QUALIFIER SpscQueue<_Size, _DataType>
+
+    SPSC_QUEUE_TEMPLATE_ARGS
+    constexpr typename SPSC_QUEUE_TEMPLATE_QUALIFIER::size_type SPSC_QUEUE_TEMPLATE_QUALIFIER::capacity()
+    {
+        return _Size;
+    }
+
+    SPSC_QUEUE_TEMPLATE_ARGS
+    typename SPSC_QUEUE_TEMPLATE_QUALIFIER::size_type SPSC_QUEUE_TEMPLATE_QUALIFIER::size() const
+    {
+        return _writeCount.load(std::memory_order_acquire) - _readCount.load(std::memory_order_acquire);
+    }
+
+    SPSC_QUEUE_TEMPLATE_ARGS
+    bool SPSC_QUEUE_TEMPLATE_QUALIFIER::empty() const
+    {
+        return size() == 0;
+    }
+
+    SPSC_QUEUE_TEMPLATE_ARGS
+    bool SPSC_QUEUE_TEMPLATE_QUALIFIER::full() const
+    {
+        return size() == _Size;
+    }
+
+    SPSC_QUEUE_TEMPLATE_ARGS
+    bool SPSC_QUEUE_TEMPLATE_QUALIFIER::push(const _DataType& value)
+    {
+        uint32_t write = _writeCount.load(std::memory_order_relaxed);
+        if (write - _readCount.load(std::memory_order_acquire) == _Size)
+            return false;
+
+        _data[write & Mask] = value;
+        _writeCount.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    SPSC_QUEUE_TEMPLATE_ARGS
+    typename SPSC_QUEUE_TEMPLATE_QUALIFIER::size_type SPSC_QUEUE_TEMPLATE_QUALIFIER::push_n(const _DataType* values, size_type count)
+    {
+        uint32_t write = _writeCount.load(std::memory_order_relaxed);
+        size_type free = _Size - (write - _readCount.load(std::memory_order_acquire));
+        if (count > free)
+            count = free;
+
+        // Two contiguous parts: up to the end of storage and from its start
+        size_type offset = write & Mask;
+        size_type first = count < _Size - offset ? count : _Size - offset;
+        std::copy_n(values, first, _data + offset);
+        std::copy_n(values + first, count - first, _data);
+
+        _writeCount.store(write + count, std::memory_order_release);
+        return count;
+    }
+
+    SPSC_QUEUE_TEMPLATE_ARGS
+    bool SPSC_QUEUE_TEMPLATE_QUALIFIER::pop(_DataType& value)
+    {
+        uint32_t read = _readCount.load(std::memory_order_relaxed);
+        if (_writeCount.load(std::memory_order_acquire) == read)
+            return false;
+
+        value = _data[read & Mask];
+        _readCount.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    SPSC_QUEUE_TEMPLATE_ARGS
+    typename SPSC_QUEUE_TEMPLATE_QUALIFIER::size_type SPSC_QUEUE_TEMPLATE_QUALIFIER::pop_n(_DataType* values, size_type count)
+    {
+        uint32_t read = _readCount.load(std::memory_order_relaxed);
+        size_type available = _writeCount.load(std::memory_order_acquire) - read;
+        if (count > available)
+            count = available;
+
+        size_type offset = read & Mask;
+        size_type first = count < _Size - offset ? count : _Size - offset;
+        std::copy_n(_data + offset, first, values);
+        std::copy_n(_data, count - first, values + first);
+
+        _readCount.store(read + count, std::memory_order_release);
+        return count;
+    }
+
+    SPSC_QUEUE_TEMPLATE_ARGS
+    void SPSC_QUEUE_TEMPLATE_QUALIFIER::clear()
+    {
+        _readCount.store(_writeCount.load(std::memory_order_acquire), std::memory_order_release);
+    }
+}
+
+#endif //! ZHELE_SPSC_QUEUE_IMPL_H
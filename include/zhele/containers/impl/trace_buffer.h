@@ -0,0 +1,118 @@
+/**
+ * @file
+ * Trace buffer methods implementation.
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TRACE_BUFFER_IMPL_H
+#define ZHELE_TRACE_BUFFER_IMPL_H
+
+namespace Zhele::Containers
+{
+    namespace Private
+    {
+        /**
+         * @brief Writes hexadecimal number with trailing separator
+         *
+         * @tparam _Output Output
+         *
+         * @param [in] value Value
+         * @param [in] separator Separator
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Output>
+        void WriteTraceHex(uint32_t value, char separator)
+        {
+            char buffer[9];
+            for (int digit = 7; digit >= 0; --digit, value >>= 4)
+            {
+                buffer[digit] = "0123456789abcdef"[value & 0x0f];
+            }
+            buffer[8] = separator;
+            _Output::Write(buffer, sizeof(buffer));
+        }
+    }
+
+    template<unsigned _Size>
+    void TraceBuffer<_Size>::clear()
+    {
+        CycleCounter::Enable();
+        _count = 0;
+        _marker = ValidMarker;
+    }
+
+    template<unsigned _Size>
+    bool TraceBuffer<_Size>::valid() const
+    {
+        return _marker == ValidMarker;
+    }
+
+    template<unsigned _Size>
+    void TraceBuffer<_Size>::log(uint32_t id, uint32_t value)
+    {
+        TraceRecord& record = _records[Reserve() & Mask];
+        record.timestamp = CycleCounter::Read();
+        record.id = id;
+        record.value = value;
+    }
+
+    template<unsigned _Size>
+    unsigned TraceBuffer<_Size>::size() const
+    {
+        return _count < _Size ? _count : _Size;
+    }
+
+    template<unsigned _Size>
+    constexpr unsigned TraceBuffer<_Size>::capacity()
+    {
+        return _Size;
+    }
+
+    template<unsigned _Size>
+    const TraceRecord& TraceBuffer<_Size>::operator[](unsigned index) const
+    {
+        uint32_t first = _count < _Size ? 0 : _count;
+        return _records[(first + index) & Mask];
+    }
+
+    template<unsigned _Size>
+    template<typename _Output>
+    void TraceBuffer<_Size>::dump() const
+    {
+        for (unsigned i = 0, count = size(); i < count; ++i)
+        {
+            const TraceRecord& record = (*this)[i];
+            Private::WriteTraceHex<_Output>(record.timestamp, ' ');
+            Private::WriteTraceHex<_Output>(record.id, ' ');
+            Private::WriteTraceHex<_Output>(record.value, '\n');
+        }
+    }
+
+    template<unsigned _Size>
+    uint32_t TraceBuffer<_Size>::Reserve()
+    {
+    #if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+        uint32_t slot;
+        do
+        {
+            slot = __LDREXW(&_count);
+        }
+        while (__STREXW(slot + 1, &_count) != 0);
+        return slot;
+    #else
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t slot = _count;
+        _count = slot + 1;
+        __set_PRIMASK(primask);
+        return slot;
+    #endif
+    }
+}
+
+#endif //! ZHELE_TRACE_BUFFER_IMPL_H
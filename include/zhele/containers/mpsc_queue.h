@@ -0,0 +1,151 @@
+/**
+ * @file
+ * Implements multiple producers single consumer queue.
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_MPSC_QUEUE_H
+#define ZHELE_MPSC_QUEUE_H
+
+#if defined(STM32F0)
+    #include <stm32f0xx.h>
+#endif
+#if defined(STM32F1)
+    #include <stm32f1xx.h>
+#endif
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+#if defined(STM32L4)
+    #include <stm32l4xx.h>
+#endif
+#if defined(STM32G0)
+    #include <stm32g0xx.h>
+#endif
+
+#include "spsc_queue.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Containers
+{
+    /**
+     * @brief Implements multiple producers single consumer queue
+     *
+     * @details
+     * Several contexts (for example, interrupt handlers with different priorities) push,
+     * one context pops. Every slot has sequence number (bounded queue by D. Vyukov):
+     *  - producer reserves slot by increment of write counter (LDREX/STREX loop, exception entry
+     *    clears exclusive monitor, so preempted reservation is retried; critical section on Cortex-M0),
+     *    writes element and publishes slot by sequence store with release order;
+     *  - consumer checks slot sequence (acquire), reads element and frees slot by sequence store (release).
+     * So preempted producer does not corrupt elements of other producers: consumer waits only
+     * for slots that are reserved, but not written yet.
+     *
+     * @par Example
+     * @code
+     *  Containers::MpscQueue<32, Event> events;
+     *  // In any interrupt handler
+     *  events.push(Event::ButtonPressed);
+     *  // In main loop
+     *  Event event;
+     *  while (events.pop(event)) Handle(event);
+     * @endcode
+     *
+     * @tparam _Size Capacity (power of 2)
+     * @tparam _DataType Element type (trivially copyable)
+     */
+    template<unsigned _Size, typename _DataType = uint8_t>
+    class MpscQueue
+    {
+        static_assert(_Size > 0 && (_Size & (_Size - 1)) == 0, "Size must be a power of 2");
+        static_assert(std::is_trivially_copyable_v<_DataType>, "Element type must be trivially copyable");
+
+        static const uint32_t Mask = _Size - 1;
+
+        struct Slot
+        {
+            std::atomic<uint32_t> sequence;
+            _DataType value;
+        };
+    public:
+        using size_type = unsigned;
+        using value_type = _DataType;
+
+        /**
+         * @brief Constructor
+         */
+        MpscQueue();
+
+        /**
+         * @brief Returns capacity
+         *
+         * @returns Queue capacity
+         */
+        static constexpr size_type capacity();
+
+        /**
+         * @brief Returns count of elements in the queue
+         *
+         * @details
+         * Reserved, but not written yet elements are included.
+         *
+         * @returns Count of elements
+         */
+        size_type size() const;
+
+        /**
+         * @brief Check that consumer has element to pop
+         *
+         * @retval true Queue is empty (or the oldest element is not written yet)
+         * @retval false Queue is not empty
+         */
+        bool empty() const;
+
+        /**
+         * @brief Adds element (any producer)
+         *
+         * @param [in] value Value
+         *
+         * @retval true Element is added
+         * @retval false Queue is full
+         */
+        bool push(const _DataType& value);
+
+        /**
+         * @brief Retrieves element (consumer)
+         *
+         * @param [out] value Value
+         *
+         * @retval true Element is retrieved
+         * @retval false Queue is empty
+         */
+        bool pop(_DataType& value);
+
+        /**
+         * @brief Retrieves elements (consumer)
+         *
+         * @param [out] values Buffer for values
+         * @param [in] count Buffer size
+         *
+         * @returns Retrieved elements count
+         */
+        size_type pop_n(_DataType* values, size_type count);
+
+    private:
+        bool Reserve(uint32_t& position);
+
+        Slot _slots[_Size];
+        alignas(ZHELE_QUEUE_INDEX_ALIGNMENT) volatile uint32_t _writeCount = 0;
+        alignas(ZHELE_QUEUE_INDEX_ALIGNMENT) uint32_t _readCount = 0;
+    };
+} // namespace Zhele::Containers
+
+#include "impl/mpsc_queue.h"
+
+#endif //! ZHELE_MPSC_QUEUE_H
@@ -13,6 +13,7 @@
 #include "../common/template_utils/data_type_selector.h"
 
 #include <atomic>
+#include <span>
 #include <type_traits>
 
 namespace Zhele::Containers
@@ -45,6 +46,12 @@ namespace Zhele::Containers
             */
             RingBufferPO2();
 
+            /**
+            * @brief Destructor (destroys stored elements of non-trivially destructible type)
+            */
+            ~RingBufferPO2() requires std::is_trivially_destructible_v<_DataType> = default;
+            ~RingBufferPO2();
+
             /**
              * @brief Returns capacity
              * 
@@ -113,6 +120,29 @@ namespace Zhele::Containers
             */
             bool push_back(const _DataType& x);
 
+            /**
+            * @brief Move an item to the end
+            *
+            * @param [in] value Value
+            * 
+            * @retval false Buffer is full
+            * @retval true Buffer is not full
+            */
+            bool push_back(_DataType&& value);
+
+            /**
+            * @brief Construct an item in place at the end (without temporary copy)
+            *
+            * @tparam Args Constructor arguments types
+            * 
+            * @param [in] args Constructor arguments
+            * 
+            * @retval false Buffer is full
+            * @retval true Item is added
+            */
+            template<typename... Args>
+            bool emplace_back(Args&&... args);
+
             /**
             * @brief Add DataType() an item to the end
             *
@@ -122,13 +152,26 @@ namespace Zhele::Containers
             bool push_back();
 
             /**
-            * @brief Retrieves the first element
+            * @brief Removes (destroys) the first element
+            *
+            * @details
+            * Element can be processed in place by reference from front() before removing, so it's not copied.
             *
             * @retval false If is empty
             * @retval true If isn't empty
             */
             bool pop_front();
 
+            /**
+            * @brief Moves the first element out and removes it
+            *
+            * @param [out] value Destination
+            *
+            * @retval false If is empty
+            * @retval true If isn't empty
+            */
+            bool pop_front(_DataType& value);
+
             /**
             * @brief Clear the buffer
             * 
@@ -137,6 +180,49 @@ namespace Zhele::Containers
             */
             void clear();
 
+            /**
+            * @brief Returns the largest contiguous region of stored elements (from the first one)
+            *
+            * @details
+            * Region can be passed to DMA (memory to peripheral) directly,
+            * call @ref consume after transfer. Rest of elements (if buffer wraps)
+            * is available after that by next call.
+            *
+            * @returns Readable region
+            */
+            std::span<_DataType> readable_span();
+
+            /**
+            * @brief Returns the largest contiguous free region (after the last element)
+            *
+            * @details
+            * Region can be passed to DMA (peripheral to memory) directly,
+            * call @ref commit with received elements count after transfer.
+            *
+            * @returns Writable region
+            */
+            std::span<_DataType> writable_span();
+
+            /**
+            * @brief Appends elements written to writable region
+            *
+            * @param [in] count Elements count (not greater than writable region size)
+            *
+            * @par Returns
+            *   Nothing
+            */
+            void commit(size_type count);
+
+            /**
+            * @brief Removes elements read from readable region
+            *
+            * @param [in] count Elements count (not greater than readable region size)
+            *
+            * @par Returns
+            *   Nothing
+            */
+            void consume(size_type count);
+
             /**
             * @brief Operator overload []
             * 
@@ -159,7 +245,7 @@ namespace Zhele::Containers
             _DataType* data();
             const _DataType* data() const;
 
-            unsigned _data[(sizeof(_DataType) * (_Size + 1) - 1) / sizeof(unsigned)];
+            alignas(_DataType) unsigned _data[(sizeof(_DataType) * (_Size + 1) - 1) / sizeof(unsigned)];
             
             Atomic _writeCount;
             Atomic _readCount;
@@ -184,6 +270,12 @@ namespace Zhele::Containers
              */
             RingBuffer();
 
+            /**
+             * @brief Destructor (destroys stored elements of non-trivially destructible type)
+             */
+            ~RingBuffer() requires std::is_trivially_destructible_v<_DataType> = default;
+            ~RingBuffer();
+
             /**
              * @brief Returns capacity
              * 
@@ -252,6 +344,29 @@ namespace Zhele::Containers
             */
             bool push_back(const _DataType& x);
 
+            /**
+            * @brief Move an item to the end
+            *
+            * @param [in] value Value
+            * 
+            * @retval false Buffer is full
+            * @retval true Buffer is not full
+            */
+            bool push_back(_DataType&& value);
+
+            /**
+            * @brief Construct an item in place at the end (without temporary copy)
+            *
+            * @tparam Args Constructor arguments types
+            * 
+            * @param [in] args Constructor arguments
+            * 
+            * @retval false Buffer is full
+            * @retval true Item is added
+            */
+            template<typename... Args>
+            bool emplace_back(Args&&... args);
+
             /**
             * @brief Add DataType() an item to the end
             *
@@ -261,13 +376,26 @@ namespace Zhele::Containers
             bool push_back();
 
             /**
-            * @brief Retrieves the first element
+            * @brief Removes (destroys) the first element
+            *
+            * @details
+            * Element can be processed in place by reference from front() before removing, so it's not copied.
             *
             * @retval false If is empty
             * @retval true If isn't empty
             */
             bool pop_front();
 
+            /**
+            * @brief Moves the first element out and removes it
+            *
+            * @param [out] value Destination
+            *
+            * @retval false If is empty
+            * @retval true If isn't empty
+            */
+            bool pop_front(_DataType& value);
+
             /**
             * @brief Clear the buffer
             * 
@@ -276,6 +404,49 @@ namespace Zhele::Containers
             */
             void clear();
 
+            /**
+            * @brief Returns the largest contiguous region of stored elements (from the first one)
+            *
+            * @details
+            * Region can be passed to DMA (memory to peripheral) directly,
+            * call @ref consume after transfer. Rest of elements (if buffer wraps)
+            * is available after that by next call.
+            *
+            * @returns Readable region
+            */
+            std::span<_DataType> readable_span();
+
+            /**
+            * @brief Returns the largest contiguous free region (after the last element)
+            *
+            * @details
+            * Region can be passed to DMA (peripheral to memory) directly,
+            * call @ref commit with received elements count after transfer.
+            *
+            * @returns Writable region
+            */
+            std::span<_DataType> writable_span();
+
+            /**
+            * @brief Appends elements written to writable region
+            *
+            * @param [in] count Elements count (not greater than writable region size)
+            *
+            * @par Returns
+            *   Nothing
+            */
+            void commit(size_type count);
+
+            /**
+            * @brief Removes elements read from readable region
+            *
+            * @param [in] count Elements count (not greater than readable region size)
+            *
+            * @par Returns
+            *   Nothing
+            */
+            void consume(size_type count);
+
             /**
             * @brief Operator overload []
             * 
@@ -298,7 +469,7 @@ namespace Zhele::Containers
             _DataType* data();
             const _DataType* data() const;
 
-            unsigned _data[(sizeof(_DataType) * (_Size + 1) - 1) / sizeof(unsigned)];
+            alignas(_DataType) unsigned _data[(sizeof(_DataType) * (_Size + 1) - 1) / sizeof(unsigned)];
             Atomic _count;
             Atomic _first;
             Atomic _last;
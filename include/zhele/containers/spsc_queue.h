@@ -0,0 +1,149 @@
+/**
+ * @file
+ * Implements lock-free single producer single consumer queue.
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SPSC_QUEUE_H
+#define ZHELE_SPSC_QUEUE_H
+
+#include <atomic>
+#include <stdint.h>
+#include <type_traits>
+
+/// Alignment of queue indices (set it to cache line size for cores with data cache)
+#if !defined (ZHELE_QUEUE_INDEX_ALIGNMENT)
+    #define ZHELE_QUEUE_INDEX_ALIGNMENT 4
+#endif
+
+namespace Zhele::Containers
+{
+    /**
+     * @brief Implements lock-free single producer single consumer queue
+     *
+     * @details
+     * One context (for example, interrupt handler) pushes, other context (for example, main loop) pops.
+     * Write and read counters are free-running 32-bit atomics, every counter is modified only by its owner:
+     *  - producer writes elements, then publishes them by write counter store with release order;
+     *  - consumer loads write counter with acquire order (so elements are visible), reads elements,
+     *    then frees slots by read counter store with release order, producer loads it with acquire order.
+     * 32-bit aligned loads and stores are atomic on all Cortex-M cores, so queue is lock-free everywhere
+     * (there are no read-modify-write operations). Each counter is placed to its own
+     * ZHELE_QUEUE_INDEX_ALIGNMENT block. Cortex-M0/M3/M4 have no data cache, so default alignment is word.
+     * Bulk operations (push_n, pop_n) copy contiguous parts and publish counter once.
+     *
+     * @par Example
+     * @code
+     *  Containers::SpscQueue<64, uint8_t> rxQueue;
+     *  // In USART interrupt
+     *  rxQueue.push(usartData);
+     *  // In main loop
+     *  uint8_t buffer[16];
+     *  unsigned count = rxQueue.pop_n(buffer, sizeof(buffer));
+     * @endcode
+     *
+     * @tparam _Size Capacity (power of 2)
+     * @tparam _DataType Element type (trivially copyable)
+     */
+    template<unsigned _Size, typename _DataType = uint8_t>
+    class SpscQueue
+    {
+        static_assert(_Size > 0 && (_Size & (_Size - 1)) == 0, "Size must be a power of 2");
+        static_assert(std::is_trivially_copyable_v<_DataType>, "Element type must be trivially copyable");
+
+        static const uint32_t Mask = _Size - 1;
+    public:
+        using size_type = unsigned;
+        using value_type = _DataType;
+
+        /**
+         * @brief Returns capacity
+         *
+         * @returns Queue capacity
+         */
+        static constexpr size_type capacity();
+
+        /**
+         * @brief Returns count of elements in the queue
+         *
+         * @returns Count of elements
+         */
+        size_type size() const;
+
+        /**
+         * @brief Check for emptiness
+         *
+         * @retval true Queue is empty
+         * @retval false Queue is not empty
+         */
+        bool empty() const;
+
+        /**
+         * @brief Check for fullness
+         *
+         * @retval true Queue is full
+         * @retval false Queue is not full
+         */
+        bool full() const;
+
+        /**
+         * @brief Adds element (producer)
+         *
+         * @param [in] value Value
+         *
+         * @retval true Element is added
+         * @retval false Queue is full
+         */
+        bool push(const _DataType& value);
+
+        /**
+         * @brief Adds elements (producer)
+         *
+         * @param [in] values Values
+         * @param [in] count Values count
+         *
+         * @returns Added elements count (less than count if queue is full)
+         */
+        size_type push_n(const _DataType* values, size_type count);
+
+        /**
+         * @brief Retrieves element (consumer)
+         *
+         * @param [out] value Value
+         *
+         * @retval true Element is retrieved
+         * @retval false Queue is empty
+         */
+        bool pop(_DataType& value);
+
+        /**
+         * @brief Retrieves elements (consumer)
+         *
+         * @param [out] values Buffer for values
+         * @param [in] count Buffer size
+         *
+         * @returns Retrieved elements count
+         */
+        size_type pop_n(_DataType* values, size_type count);
+
+        /**
+         * @brief Removes all elements (consumer)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void clear();
+
+    private:
+        _DataType _data[_Size];
+        alignas(ZHELE_QUEUE_INDEX_ALIGNMENT) std::atomic<uint32_t> _writeCount = 0;
+        alignas(ZHELE_QUEUE_INDEX_ALIGNMENT) std::atomic<uint32_t> _readCount = 0;
+    };
+} // namespace Zhele::Containers
+
+#include "impl/spsc_queue.h"
+
+#endif //! ZHELE_SPSC_QUEUE_H
@@ -0,0 +1,138 @@
+/**
+ * @file
+ * Implements timestamped events trace buffer.
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TRACE_BUFFER_H
+#define ZHELE_TRACE_BUFFER_H
+
+#include <zhele/delay.h>
+#include <zhele/placement.h>
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace Zhele::Containers
+{
+    /**
+     * @brief Trace record
+     */
+    struct TraceRecord
+    {
+        uint32_t timestamp; ///< Cycle counter value (see CycleCounter)
+        uint32_t id; ///< Event id
+        uint32_t value; ///< Event payload
+    };
+
+    /**
+     * @brief Implements circular buffer of timestamped events for post-mortem analysis
+     *
+     * @details
+     * Buffer has no constructor, so being placed to .noinit section it keeps records
+     * after fault and reset. Valid marker distinguishes kept trace from power-on garbage,
+     * so trace can be dumped by fault handler or after reset.
+     * Log is slot reservation (one LDREX/STREX on Cortex-M3/M4, short critical section on Cortex-M0)
+     * and three stores, so it can be used in interrupt handlers. The oldest records are overwritten.
+     * Timestamp is DWT cycle counter (SysTick counter on Cortex-M0, so it wraps on SysTick period).
+     *
+     * @par Example
+     * @code
+     *  ZHELE_NOINIT Containers::TraceBuffer<256> trace;
+     *  int main()
+     *  {
+     *      if (trace.valid())
+     *          trace.dump<Usart1>(); // Trace of previous run (before reset)
+     *      trace.clear();
+     *      ...
+     *      trace.log(EventDmaComplete, length);
+     *  }
+     *  extern "C" void HardFault_Handler() { trace.dump<Usart1>(); for (;;); }
+     * @endcode
+     *
+     * @tparam _Size Records count (power of 2)
+     */
+    template<unsigned _Size>
+    class TraceBuffer
+    {
+        static_assert(_Size > 0 && (_Size & (_Size - 1)) == 0, "Size must be a power of 2");
+
+        static const uint32_t Mask = _Size - 1;
+        static const uint32_t ValidMarker = 0x54524345;
+    public:
+        /**
+         * @brief Clears buffer and marks it as valid (call it on startup)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void clear();
+
+        /**
+         * @brief Check that buffer was initialized by clear (and kept through reset)
+         *
+         * @retval true Buffer is valid
+         * @retval false Buffer contents is garbage (power on)
+         */
+        bool valid() const;
+
+        /**
+         * @brief Appends record
+         *
+         * @param [in] id Event id
+         * @param [in] value Event payload
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void log(uint32_t id, uint32_t value = 0);
+
+        /**
+         * @brief Returns stored records count
+         *
+         * @returns Records count (not greater than capacity)
+         */
+        unsigned size() const;
+
+        /**
+         * @brief Returns capacity
+         *
+         * @returns Records count
+         */
+        static constexpr unsigned capacity();
+
+        /**
+         * @brief Returns record
+         *
+         * @param [in] index Index (0 is the oldest record)
+         *
+         * @returns Record
+         */
+        const TraceRecord& operator[](unsigned index) const;
+
+        /**
+         * @brief Writes text dump (one line per record, the oldest first: timestamp, id and value)
+         *
+         * @tparam _Output Output with Write(const void* data, size_t size) method (Usart, CDC endpoint and so on)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Output>
+        void dump() const;
+
+    private:
+        uint32_t Reserve();
+
+        TraceRecord _records[_Size];
+        volatile uint32_t _count;
+        uint32_t _marker;
+    };
+} // namespace Zhele::Containers
+
+#include "impl/trace_buffer.h"
+
+#endif //! ZHELE_TRACE_BUFFER_H
@@ -0,0 +1,135 @@
+/**
+ * @file
+ * Implements timer-locked control loop
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CONTROL_LOOP_H
+#define ZHELE_CONTROL_LOOP_H
+
+#include <zhele/delay.h>
+#include <zhele/profiling.h>
+#include <zhele/timer.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief Control loop timing statistics
+     */
+    struct ControlLoopStatistics
+    {
+        uint32_t steps; ///< Executed steps count
+        uint32_t overruns; ///< Steps that have not finished before the next period
+        uint16_t minLatency; ///< Minimal latency from timer update to step start (timer ticks)
+        uint16_t maxLatency; ///< Maximal latency from timer update to step start (timer ticks)
+        uint32_t lastCycles; ///< The last step execution time (core cycles)
+        uint32_t maxCycles; ///< Worst-case step execution time (core cycles)
+
+        /**
+         * @brief Returns start jitter
+         *
+         * @returns Difference of maximal and minimal latency (timer ticks)
+         */
+        uint16_t Jitter() const { return steps == 0 ? 0 : maxLatency - minLatency; }
+    };
+
+    /**
+     * @brief Implements control loop executed at fixed rate in timer update interrupt
+     *
+     * @details
+     * Timer period is calculated by @ref Init from timer clock. Step latency (jitter source: higher priority
+     * interrupts and interrupts masking) is read from timer counter at step start, so it's exact on every core.
+     * Step execution time is measured by CycleCounter (on Cortex-M0/M0+ SysTick is used, so step must be
+     * shorter than SysTick period). Step that lasts longer than loop period is counted as overrun.
+     *
+     * @par Example
+     * @code
+     *  using Loop = ControlLoop<Timers::Timer3, 1000>;
+     *  Loop::Init([]() { Heater::SetPulse(pid.Step(setpoint, Sensor::Read())); });
+     *  Loop::Start();
+     *  // TIM3_IRQHandler
+     *  Loop::IrqHandler();
+     * @endcode
+     *
+     * @tparam _Timer Timer
+     * @tparam _Rate Loop rate (steps per second)
+     */
+    template<typename _Timer, unsigned long _Rate>
+    class ControlLoop
+    {
+        static_assert(_Rate > 0, "Loop rate must be positive");
+    public:
+        /// Loop step (called in timer interrupt)
+        using StepType = std::add_pointer_t<void()>;
+
+        /**
+         * @brief Init timer (loop is stopped)
+         *
+         * @param [in] step Loop step
+         *
+         * @returns Actual loop rate (differs from _Rate if timer clock is not multiple of it)
+         */
+        static uint32_t Init(StepType step);
+
+        /**
+         * @brief Start loop
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start();
+
+        /**
+         * @brief Stop loop
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+
+        /**
+         * @brief Returns timing statistics
+         *
+         * @returns Statistics
+         */
+        static ControlLoopStatistics Statistics();
+
+        /**
+         * @brief Reset timing statistics
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void ResetStatistics();
+
+        /**
+         * @brief Returns timer tick frequency (latency unit)
+         *
+         * @returns Frequency (Hz)
+         */
+        static uint32_t TickFrequency();
+
+        /**
+         * @brief Timer interrupt handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static inline StepType _step = nullptr;
+        static inline uint32_t _tickFrequency = 0;
+        static inline volatile ControlLoopStatistics _statistics = {};
+    };
+}
+
+#include "impl/control_loop.h"
+
+#endif //! ZHELE_CONTROL_LOOP_H
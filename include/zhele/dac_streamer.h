@@ -0,0 +1,121 @@
+/**
+ * @file
+ * Implements timer-paced DAC waveform playback
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DAC_STREAMER_H
+#define ZHELE_DAC_STREAMER_H
+
+#include <zhele/dac.h>
+#include <zhele/dma.h>
+#include <zhele/timer.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements DAC playback by DMA at rate paced by timer TRGO
+     * 
+     * @details
+     * Sample table can be played circularly or samples can be streamed through
+     * double buffer: callback refills the block that has just been played.
+     * For dual DAC (Dac1Dual) one DMA stream transfers packed samples of both channels.
+     * 
+     * @par Example
+     * @code
+     *  using Player = DacStreamer<Dac1Channel1, Timers::Timer2, Dma1Stream5Channel7>;
+     *  Player::Init(48000);
+     *  Player::Play(sineTable, std::size(sineTable));
+     * @endcode
+     * 
+     * @tparam _Dac DAC channel (or dual DAC)
+     * @tparam _Timer Timer (its TRGO must be DAC trigger)
+     * @tparam _DmaChannel DMA channel (stream) connected to DAC (channel 1 for dual DAC)
+     */
+    template<typename _Dac, typename _Timer, typename _DmaChannel>
+    class DacStreamer
+    {
+        using Trigger = Private::DacTimerTrigger<_Timer>;
+        static_assert(Trigger::Supported, "Timer TRGO can not trigger DAC");
+
+    public:
+        /// Sample type
+        using SampleType = typename _Dac::SampleType;
+
+        /**
+         * @brief Refill callback
+         * 
+         * @param [out] block Block to refill (has been played)
+         * @param [in] count Samples count in block
+         */
+        using RefillCallback = std::add_pointer_t<void(SampleType* block, uint32_t count)>;
+
+        /**
+         * @brief Init DAC and timer
+         * 
+         * @param [in] sampleRate Sample rate (samples per second)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint32_t sampleRate);
+
+        /**
+         * @brief Set sample rate (nearest reachable)
+         * 
+         * @param [in] sampleRate Sample rate (samples per second)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetSampleRate(uint32_t sampleRate);
+
+        /**
+         * @brief Play sample table circularly
+         * 
+         * @param [in] table Samples
+         * @param [in] count Samples count
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Play(const SampleType* table, uint16_t count);
+
+        /**
+         * @brief Play samples through double buffer
+         * 
+         * @param [in] buffer Buffer. Must has 2 * blockSize elements (two blocks), both blocks must be filled before call.
+         * @param [in] blockSize Block size
+         * @param [in] callback Refill callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Stream(SampleType* buffer, uint16_t blockSize, RefillCallback callback);
+
+        /**
+         * @brief Stop playback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+
+    private:
+        static DmaBase::Mode SampleSize();
+        static void Start();
+        static void StreamHandler(void* data, unsigned size, unsigned bufferIndex);
+
+        static RefillCallback _refillCallback;
+    };
+}
+
+#include "impl/dac_streamer.h"
+
+#endif //! ZHELE_DAC_STREAMER_H
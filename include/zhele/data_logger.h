@@ -0,0 +1,259 @@
+/**
+ * @file
+ * Implements ADC to SD card data logger pipeline
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DATA_LOGGER_H
+#define ZHELE_DATA_LOGGER_H
+
+#if defined(STM32F0)
+    #include <stm32f0xx.h>
+#endif
+#if defined(STM32F1)
+    #include <stm32f1xx.h>
+#endif
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+#if defined(STM32L4)
+    #include <stm32l4xx.h>
+#endif
+#if defined(STM32G0)
+    #include <stm32g0xx.h>
+#endif
+
+#include <zhele/containers/ring_buffer.h>
+
+#include <stdint.h>
+
+namespace Zhele
+{
+    /**
+     * @brief Data logger samples encoding
+     */
+    enum class LoggerEncoding : uint8_t
+    {
+        Raw = 0x00, ///< Samples are 16-bit little-endian values
+        DeltaVarint = 0x01, ///< Differences of channel samples, zigzag and LEB128 varint encoded
+    };
+
+    /**
+     * @brief Implements data logger pipeline: timer-paced ADC stream, RAM ring, optional compression, SD card
+     *
+     * @details
+     * ADC block callback (DMA interrupt) encodes samples to frame and puts it into large RAM ring,
+     * @ref Process (main loop) writes ring content to card by async multiple blocks writes.
+     * So card stalls (wear leveling can take 100+ ms) are absorbed by ring: samples are lost only
+     * if ring overflows. Ring size for given data rate and worst card latency is @ref RequiredRingSize.
+     * Ring usage high-water mark and lost samples count are reported by @ref GetStatistics,
+     * so ring size can be checked on real card.
+     *
+     * Stream format: sequence of frames, every frame is one ADC block:
+     * 0xA5 marker, encoding byte, samples count (16-bit little-endian), samples.
+     * Delta encoding restarts at every frame (previous value of every channel is 0), so lost frame
+     * doesn't break next frames. Last block is padded by zeros (they are skipped by decoder).
+     *
+     * @par Example
+     * @code
+     *  using Sampler = AdcSampler<Adc1, Timers::Timer3, 10000, 72000000, 72000000>;
+     *  using Card = Drivers::SdCard<Spi1, IO::Pa4>;
+     *  using Logger = DataLogger<Sampler, Card, 256, 32768>;
+     *  Sampler::Init();
+     *  Card::Detect();
+     *  Logger::Start<IO::Pa0, IO::Pa1>(startBlock, blocksCount);
+     *  while (Logger::IsRunning())
+     *      Logger::Process();
+     *  auto statistics = Logger::GetStatistics();
+     * @endcode
+     *
+     * @tparam _Sampler Timer-paced ADC sampler (@ref AdcSampler)
+     * @tparam _Card SD card with async blocks write (@ref Drivers::SdCard)
+     * @tparam _BlockSamples ADC block size in samples (DMA buffer holds two blocks)
+     * @tparam _RingSize Ring size in bytes (multiple of 512)
+     * @tparam _BlocksPerWrite Max SD blocks in one write
+     * @tparam _Encoding Samples encoding
+     */
+    template<typename _Sampler, typename _Card, uint16_t _BlockSamples, unsigned _RingSize,
+        unsigned _BlocksPerWrite = 8, LoggerEncoding _Encoding = LoggerEncoding::DeltaVarint>
+    class DataLogger
+    {
+        static const unsigned CardBlockSize = 512;
+        static_assert(_RingSize % CardBlockSize == 0, "Ring size must be multiple of SD block size");
+        static_assert(_BlocksPerWrite > 0, "At least one block per write is required");
+
+        static const uint8_t FrameMarker = 0xa5;
+        static const unsigned FrameHeaderSize = 4;
+        static const unsigned MaxSampleSize = _Encoding == LoggerEncoding::Raw ? 2 : 3;
+        static const unsigned MaxChannels = 16;
+    public:
+        /// Max encoded frame size
+        static constexpr unsigned MaxFrameSize = FrameHeaderSize + MaxSampleSize * _BlockSamples;
+        static_assert(MaxFrameSize <= _RingSize, "Ring must hold at least one frame");
+
+        /**
+         * @brief Pipeline statistics
+         */
+        struct Statistics
+        {
+            uint32_t RingHighWaterMark; ///< Max ring usage (bytes)
+            uint32_t RingCapacity; ///< Ring size (bytes)
+            uint32_t DroppedFrames; ///< Frames dropped because of ring overflow
+            uint32_t DroppedSamples; ///< Samples dropped because of ring overflow
+            uint32_t AdcOverruns; ///< ADC blocks overwritten by DMA before callback end
+            uint32_t BlocksWritten; ///< SD blocks written
+            uint32_t WriteErrors; ///< Failed SD writes
+            uint32_t EncodedBytes; ///< Encoded data size
+            uint32_t SamplesLogged; ///< Samples put into ring
+        };
+
+        /**
+         * @brief Calculates ring size for zero samples loss
+         *
+         * @details
+         * Ring should hold data produced during worst card write latency plus one write chunk
+         * (it's locked by current write) and one frame.
+         *
+         * @param [in] bytesPerSecond Encoded data rate (worst case is 2 or 3 bytes per sample)
+         * @param [in] latencyMs Worst card write latency (ms)
+         *
+         * @returns Min ring size in bytes (rounded up to SD block)
+         */
+        static constexpr unsigned RequiredRingSize(unsigned long bytesPerSecond, unsigned latencyMs);
+
+        /**
+         * @brief Encodes samples to frame
+         *
+         * @param [in] samples Samples (interleaved channels)
+         * @param [in] count Samples count
+         * @param [in] channels Channels count
+         * @param [out] frame Frame buffer (at least @ref MaxFrameSize bytes)
+         *
+         * @returns Frame size
+         */
+        static unsigned EncodeFrame(const uint16_t* samples, uint16_t count, uint8_t channels, uint8_t* frame);
+
+        /**
+         * @brief Starts logging
+         *
+         * @tparam _Pins ADC input pins (block size must be multiple of pins count)
+         *
+         * @param [in] firstBlock First card block
+         * @param [in] blocksCount Card blocks available for log
+         *
+         * @retval true Logging is started
+         * @retval false Sampler start fail
+         */
+        template<typename... _Pins>
+        static bool Start(uint32_t firstBlock, uint32_t blocksCount);
+
+        /**
+         * @brief Stops sampling
+         *
+         * @details
+         * Ring content is written to card by next @ref Process calls (last block is padded),
+         * logger is running until it's flushed.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+
+        /**
+         * @brief Writes ring content to card (call it from main loop)
+         *
+         * @details
+         * Method continues current card write or starts next one. Whole blocks
+         * (up to @p _BlocksPerWrite) are written directly from ring memory, so ring is not copied.
+         * Failed write is retried. When card region is full, sampling is stopped and rest of ring is discarded.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Process();
+
+        /**
+         * @brief Checks logger is running
+         *
+         * @retval true Sampling is running or ring is not flushed yet
+         * @retval false Logger is stopped
+         */
+        static bool IsRunning();
+
+        /**
+         * @brief Returns next card block to write
+         *
+         * @returns Card block address
+         */
+        static uint32_t CurrentBlock();
+
+        /**
+         * @brief Returns pipeline statistics
+         *
+         * @returns Statistics
+         */
+        static Statistics GetStatistics();
+
+        /**
+         * @brief Resets statistics (high-water mark is set to current usage)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void ResetStatistics();
+
+    private:
+        /**
+         * @brief ADC block handler (DMA interrupt)
+         *
+         * @param [in] data Samples
+         * @param [in] count Samples count
+         * @param [in] overruns ADC stream overruns
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void BlockHandler(uint16_t* data, uint32_t count, uint32_t overruns);
+
+        /**
+         * @brief Card write complete handler
+         *
+         * @param [in] success Write result
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void WriteComplete(bool success);
+
+        /**
+         * @brief Pads ring content to whole card block
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Pad();
+
+        static uint8_t* WriteVarint(uint8_t* out, uint32_t value);
+
+        static inline Containers::RingBuffer<_RingSize, uint8_t> _ring; ///< Encoded data ring
+        static inline uint16_t _samples[2 * _BlockSamples]; ///< ADC DMA buffer
+        static inline uint8_t _frame[MaxFrameSize]; ///< Frame encoding buffer
+        static inline uint8_t _channels = 1; ///< Channels count
+        static inline uint32_t _writeBlocks = 0; ///< Current write size (blocks)
+
+        static inline volatile bool _sampling = false; ///< Sampler is running
+        static inline volatile bool _writing = false; ///< Card write is in progress
+        static inline bool _flushing = false; ///< Ring is flushed after stop
+        static inline uint32_t _block = 0; ///< Next card block
+        static inline uint32_t _lastBlock = 0; ///< Card region end
+
+        static inline Statistics _statistics = {}; ///< Statistics (updated by ADC interrupt)
+    };
+}
+
+#include "impl/data_logger.h"
+
+#endif //! ZHELE_DATA_LOGGER_H
@@ -0,0 +1,230 @@
+/**
+ * @file
+ * Implements deferred interrupt work (PendSV bottom half)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DEFERRED_H
+#define ZHELE_DEFERRED_H
+
+#if defined(STM32F0)
+    #include <stm32f0xx.h>
+#endif
+#if defined(STM32F1)
+    #include <stm32f1xx.h>
+#endif
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+#if defined(STM32L4)
+    #include <stm32l4xx.h>
+#endif
+#if defined(STM32G0)
+    #include <stm32g0xx.h>
+#endif
+
+#include "containers/mpsc_queue.h"
+
+#include <array>
+#include <cstring>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+#if !defined (ZHELE_DEFERRED_QUEUE_SIZE)
+    /// Deferred work queue capacity (power of 2)
+    #define ZHELE_DEFERRED_QUEUE_SIZE 16
+#endif
+
+#if !defined (ZHELE_DEFERRED_ARGUMENTS_SIZE)
+    /// Max size of deferred callback arguments (bytes)
+    #define ZHELE_DEFERRED_ARGUMENTS_SIZE (3 * sizeof(void*))
+#endif
+
+namespace Zhele
+{
+    class Deferred;
+
+    namespace Private
+    {
+        /**
+         * @brief Deferred work item: function and its copied arguments
+         */
+        struct DeferredWork
+        {
+            std::add_pointer_t<void(const uint8_t* arguments)> Invoke; ///< Function that unpacks arguments and calls callback
+            alignas(void*) uint8_t Arguments[ZHELE_DEFERRED_ARGUMENTS_SIZE]; ///< Arguments
+        };
+
+        /**
+         * @brief Adapts callback to deferred one
+         *
+         * @tparam _Function Callback
+         */
+        template<auto _Function, typename = decltype(_Function)>
+        struct DeferredCall;
+
+        template<auto _Function, typename... _Args>
+        struct DeferredCall<_Function, void(*)(_Args...)>
+        {
+            static_assert((std::is_trivially_copyable_v<_Args> && ...), "Deferred callback arguments must be trivially copyable");
+            static_assert((sizeof(_Args) + ... + 0) <= ZHELE_DEFERRED_ARGUMENTS_SIZE, "Deferred callback arguments are too large");
+
+            static constexpr std::array<unsigned, sizeof...(_Args)> Offsets = []() {
+                std::array<unsigned, sizeof...(_Args)> offsets{};
+                unsigned offset = 0, index = 0;
+                ((offsets[index++] = offset, offset += sizeof(_Args)), ...);
+                return offsets;
+            }();
+
+            static inline bool Enqueue(_Args... args);
+
+            static void Handler(_Args... args)
+            {
+                Enqueue(args...);
+            }
+
+            static void Invoke(const uint8_t* arguments)
+            {
+                [arguments]<size_t... _Indexes>(std::index_sequence<_Indexes...>) {
+                    _Function(Load<_Args>(arguments + Offsets[_Indexes])...);
+                }(std::index_sequence_for<_Args...>{});
+            }
+
+            template<typename _Type>
+            static _Type Load(const uint8_t* argument)
+            {
+                _Type value;
+                std::memcpy(&value, argument, sizeof(_Type));
+                return value;
+            }
+        };
+    }
+
+    /**
+     * @brief Implements deferred interrupt work
+     *
+     * @details
+     * Interrupt handler posts work (function with arguments) to static lock-free queue
+     * (@ref Containers::MpscQueue, any interrupt priority can post) and returns, works are called
+     * by PendSV handler with the lowest priority, so long callbacks don't delay other interrupts.
+     * Works are called in posting order after all other pending interrupts.
+     * Call IrqHandler from PendSV_Handler. Work posted to full queue is dropped (and counted).
+     * Peripheral completion callbacks are deferred by @ref Callback adapter.
+     *
+     * @par Example
+     * @code
+     *  void OnReceived(void* data, unsigned size, bool success) { Parse(data, size); }
+     *  extern "C" void PendSV_Handler() { Deferred::IrqHandler(); }
+     *  ...
+     *  Deferred::Init();
+     *  Dma1Channel5::SetTransferCallback(Deferred::Callback<OnReceived>);
+     *  Deferred::Post(Process, &context);
+     * @endcode
+     */
+    class Deferred
+    {
+        template<auto, typename>
+        friend struct Private::DeferredCall;
+    public:
+        /// Deferred function type
+        using Function = std::add_pointer_t<void(void* argument)>;
+
+        /**
+         * @brief Adapts callback to deferred one: returned callback copies arguments and posts original callback
+         *
+         * @tparam _Function Callback (function without return value and with trivially copyable arguments)
+         */
+        template<auto _Function>
+        static constexpr auto Callback = &Private::DeferredCall<_Function>::Handler;
+
+        /**
+         * @brief Sets the lowest priority for PendSV
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+            NVIC_SetPriority(PendSV_IRQn, (1u << __NVIC_PRIO_BITS) - 1);
+        }
+
+        /**
+         * @brief Posts work
+         *
+         * @param [in] function Function
+         * @param [in] argument Function argument
+         *
+         * @retval true Work is posted
+         * @retval false Queue is full
+         */
+        static bool Post(Function function, void* argument = nullptr)
+        {
+            return Private::DeferredCall<Call>::Enqueue(function, argument);
+        }
+
+        /**
+         * @brief Returns count of dropped works (queue was full)
+         *
+         * @returns Dropped works count
+         */
+        static uint32_t Dropped()
+        {
+            return _dropped;
+        }
+
+        /**
+         * @brief PendSV interrupt handler (calls posted works)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler()
+        {
+            Private::DeferredWork work;
+            while (_queue.pop(work))
+                work.Invoke(work.Arguments);
+        }
+
+    private:
+        static void Call(Function function, void* argument)
+        {
+            function(argument);
+        }
+
+        static bool Push(const Private::DeferredWork& work)
+        {
+            if (!_queue.push(work))
+            {
+                uint32_t primask = __get_PRIMASK();
+                __disable_irq();
+                _dropped = _dropped + 1;
+                __set_PRIMASK(primask);
+                return false;
+            }
+
+            SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+            return true;
+        }
+
+        static inline Containers::MpscQueue<ZHELE_DEFERRED_QUEUE_SIZE, Private::DeferredWork> _queue;
+        static inline volatile uint32_t _dropped = 0;
+    };
+
+    namespace Private
+    {
+        template<auto _Function, typename... _Args>
+        bool DeferredCall<_Function, void(*)(_Args...)>::Enqueue(_Args... args)
+        {
+            DeferredWork work{Invoke, {}};
+            unsigned index = 0;
+            (std::memcpy(work.Arguments + Offsets[index++], &args, sizeof(_Args)), ...);
+            return Deferred::Push(work);
+        }
+    }
+}
+
+#endif //! ZHELE_DEFERRED_H
@@ -31,7 +31,9 @@ namespace Zhele
     template<unsigned long ms, unsigned long CpuFreq = F_CPU>
     void delay_ms()
     {
-        delay_us<ms * 1000, CpuFreq>();
+        // Long delays do not fit 32-bit cycles count
+        for (unsigned long i = 0; i < ms; ++i)
+            delay_us<1000, CpuFreq>();
     }
 }
 
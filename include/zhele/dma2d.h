@@ -0,0 +1,24 @@
+/**
+ * @file
+ * United header for DMA2D (Chrom-ART accelerator)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @licence FreeBSD
+ */
+
+#if defined(STM32F0)
+    #error STM32F0 does not support DMA2D
+#endif
+#if defined(STM32F1)
+    #error STM32F1 does not support DMA2D
+#endif
+#if defined(STM32F4)
+    #include "f4/dma2d.h"
+#endif
+#if defined(STM32L4)
+    #include "l4/dma2d.h"
+#endif
+#if defined(STM32G0)
+    #error STM32G0 does not support DMA2D
+#endif
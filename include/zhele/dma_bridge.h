@@ -0,0 +1,192 @@
+/**
+ * @file
+ * Implements peripheral to peripheral DMA forwarding
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMA_BRIDGE_H
+#define ZHELE_DMA_BRIDGE_H
+
+#include <zhele/dma.h>
+
+#include <stdint.h>
+
+namespace Zhele
+{
+    namespace Private
+    {
+        /// DMA bridge source concept (Usart, Spi or adapter with the same members)
+        template<typename T>
+        concept DmaBridgeSource = requires { typename T::DmaRx; T::RxDataRegister(); T::EnableRxDma(true); };
+
+        /// DMA bridge sink concept (Usart, Spi or adapter with the same members)
+        template<typename T>
+        concept DmaBridgeSink = requires { typename T::DmaTx; T::TxDataRegister(); T::EnableTxDma(true); };
+
+        /**
+         * @brief Returns DMA data size mode for frame type
+         *
+         * @tparam _Frame Frame type (1, 2 or 4 bytes)
+         */
+        template<typename _Frame>
+        constexpr DmaBase::Mode DmaFrameSize = static_cast<DmaBase::Mode>(sizeof(_Frame) == 1
+            ? static_cast<uint32_t>(DmaBase::PSize8Bits) | static_cast<uint32_t>(DmaBase::MSize8Bits)
+            : sizeof(_Frame) == 2
+                ? static_cast<uint32_t>(DmaBase::PSize16Bits) | static_cast<uint32_t>(DmaBase::MSize16Bits)
+                : static_cast<uint32_t>(DmaBase::PSize32Bits) | static_cast<uint32_t>(DmaBase::MSize32Bits));
+    }
+
+    /**
+     * @brief Implements peripheral to peripheral forwarding through RAM ring
+     *
+     * @details
+     * Source RX DMA channel fills ring in circular mode, sink TX DMA channel drains it by
+     * contiguous chunks. Next chunk is started from source half transfer and transfer complete
+     * interrupts and from sink transfer complete interrupt, so CPU doesn't touch data and
+     * forwarding rate is limited by buses only. Source and sink rates are decoupled by ring:
+     * sink may be slower for ring half time.
+     *
+     * Source stream can stop in the middle of ring half (for example, UART packet end),
+     * call @ref Flush (from idle line interrupt or periodically) to forward such tail.
+     *
+     * If source overwrites data that is not sent yet, lost data is skipped and counted (@ref Overruns).
+     * Frame types define DMA data sizes, for example ADC samples (16-bit) are forwarded to USART
+     * as little-endian bytes with `DmaBridge<Adapter, Usart1, 512, uint16_t, uint8_t>`.
+     * Route source RX and sink TX DMA channels IRQ handlers to their IrqHandler.
+     *
+     * @par Example
+     * @code
+     *  using Bridge = DmaBridge<Usart2, Spi1, 512>;
+     *  Bridge::Start();
+     *  extern "C" void USART2_IRQHandler() { Usart2::ClearInterruptFlag(Usart2::IdleInt); Bridge::Flush(); }
+     * @endcode
+     *
+     * @tparam _Source Source peripheral (RX DMA)
+     * @tparam _Sink Sink peripheral (TX DMA)
+     * @tparam _RingSize Ring size in bytes (even, multiple of frame sizes)
+     * @tparam _SourceFrame Source frame type
+     * @tparam _SinkFrame Sink frame type
+     */
+    template<Private::DmaBridgeSource _Source, Private::DmaBridgeSink _Sink, unsigned _RingSize = 256,
+        typename _SourceFrame = uint8_t, typename _SinkFrame = _SourceFrame>
+    class DmaBridge
+    {
+        static_assert(_RingSize % (2 * sizeof(_SourceFrame)) == 0, "Ring halves must hold whole source frames");
+        static_assert(_RingSize % sizeof(_SinkFrame) == 0, "Ring must hold whole sink frames");
+
+        using SourceDma = typename _Source::DmaRx;
+        using SinkDma = typename _Sink::DmaTx;
+    public:
+        /**
+         * @brief Starts forwarding
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start();
+
+        /**
+         * @brief Stops forwarding (data in ring is discarded)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+
+        /**
+         * @brief Forwards received data (for example, tail of source packet)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Flush();
+
+        /**
+         * @brief Returns forwarded bytes count
+         *
+         * @returns Bytes passed to sink DMA
+         */
+        static uint32_t Forwarded();
+
+        /**
+         * @brief Returns overruns count
+         *
+         * @returns Count of sink lags (source overwrote unsent data)
+         */
+        static uint32_t Overruns();
+
+    private:
+        /**
+         * @brief Returns bytes written by source since start
+         *
+         * @details
+         * Position is restored from DMA counter and previous position, so source wrap is detected
+         * even if its transfer complete interrupt is pending. It's called from source half transfer and
+         * transfer complete interrupts, so it's called at least twice per ring pass.
+         *
+         * @returns Monotonic write position
+         */
+        static uint32_t WritePosition();
+
+        /**
+         * @brief Starts next sink chunk if sink is idle
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Pump();
+
+        static void SourceHandler(void* data, unsigned size, bool success);
+        static void SinkHandler(void* data, unsigned size, bool success);
+
+        alignas(4) static inline uint8_t _ring[_RingSize]; ///< Ring
+        static inline uint32_t _written = 0; ///< Last monotonic write position
+        static inline uint32_t _read = 0; ///< Monotonic position of next unsent byte
+        static inline uint32_t _chunk = 0; ///< Current sink chunk size
+        static inline volatile bool _sending = false; ///< Sink DMA is busy
+        static inline uint32_t _forwarded = 0; ///< Forwarded bytes
+        static inline uint32_t _overruns = 0; ///< Overruns count
+    };
+
+    /**
+     * @brief Implements direct peripheral to peripheral forwarding (data register to data register)
+     *
+     * @details
+     * Source RX DMA request moves every frame from source data register directly to sink data register,
+     * so there is no RAM ring and no interrupts at all. Sink must be at least as fast as source
+     * (for example, UART to UART with the same baud rate or UART to faster SPI),
+     * otherwise frames are lost in sink data register.
+     *
+     * @tparam _Source Source peripheral (RX DMA)
+     * @tparam _Sink Sink peripheral
+     * @tparam _Frame Frame type
+     */
+    template<Private::DmaBridgeSource _Source, Private::DmaBridgeSink _Sink, typename _Frame = uint8_t>
+    class DirectDmaBridge
+    {
+        using SourceDma = typename _Source::DmaRx;
+    public:
+        /**
+         * @brief Starts forwarding
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start();
+
+        /**
+         * @brief Stops forwarding
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+    };
+}
+
+#include "impl/dma_bridge.h"
+
+#endif //! ZHELE_DMA_BRIDGE_H
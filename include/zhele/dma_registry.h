@@ -0,0 +1,179 @@
+/**
+ * @file
+ * Implements compile-time DMA resources registry
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMA_REGISTRY_H
+#define ZHELE_DMA_REGISTRY_H
+
+#include "common/template_utils/type_list.h"
+
+#include <type_traits>
+
+namespace Zhele
+{
+    using namespace Zhele::TemplateUtils;
+
+    namespace Private
+    {
+        /// DMA channel (stream) concept
+        template<typename T>
+        concept DmaChannelType = requires { typename T::Module; T::Channel; };
+
+        /// DMAMUX request binding concept (see DmaMux::Binding)
+        template<typename T>
+        concept DmaRequestBindingType = requires { typename T::Dma; T::Request; T::MuxChannel; };
+
+        /// Peripheral with DMA concept (Usart, Spi, I2c and so on)
+        template<typename T>
+        concept DmaPeripheralType = requires { typename T::DmaTx; typename T::DmaRx; };
+
+        /**
+         * @brief Returns DMA channels used by resource
+         *
+         * @tparam T Resource: DMA channel, DMAMUX binding or peripheral with DmaTx/DmaRx
+         *
+         * @returns Typelist with DMA channels
+         */
+        template<typename T>
+        consteval auto DmaChannelsOf()
+        {
+            if constexpr (std::is_void_v<T>)
+                return TypeList<>{};
+            else if constexpr (DmaRequestBindingType<T>)
+                return TypeList<typename T::Dma>{};
+            else if constexpr (DmaPeripheralType<T>)
+                return DmaChannelsOf<typename T::DmaTx>() + DmaChannelsOf<typename T::DmaRx>();
+            else
+            {
+                static_assert(DmaChannelType<T>, "Type is not DMA channel, DMAMUX binding or peripheral with DMA");
+                return TypeList<T>{};
+            }
+        }
+
+        /**
+         * @brief Returns DMAMUX bindings of resource
+         *
+         * @tparam T Resource
+         *
+         * @returns Typelist with bindings
+         */
+        template<typename T>
+        consteval auto DmaBindingsOf()
+        {
+            if constexpr (DmaRequestBindingType<T>)
+                return TypeList<T>{};
+            else
+                return TypeList<>{};
+        }
+
+        /**
+         * @brief Check that channels are the same hardware channel (stream)
+         *
+         * @details
+         * Different types can describe one hardware channel,
+         * for example Dma2Stream2Channel4 and Dma2Stream2Channel5.
+         */
+        constexpr auto SameDmaChannel = [](auto first, auto second) {
+            using First = TypeUnbox<first>;
+            using Second = TypeUnbox<second>;
+            return std::is_same_v<typename First::Module, typename Second::Module> && First::Channel == Second::Channel;
+        };
+    }
+
+    /**
+     * @brief Implements compile-time DMA resources registry
+     *
+     * @details
+     * Registry collects DMA channels (streams) of all given resources and
+     * checks (by static_assert) that no channel is shared between resources
+     * and no DMAMUX request is routed twice. Also it can select free channel
+     * for a new resource.
+     *
+     * @par Example
+     * @code
+     *  using Dma = DmaRegistry<Usart1, Spi1, Dma1Channel1>;
+     *  using SensorDma = Dma::FreeChannel<Dma1Channel2, Dma1Channel3>;
+     * @endcode
+     *
+     * @tparam _Resources DMA channels, DMAMUX bindings (DmaMux::Binding) or peripherals with DmaTx/DmaRx
+     */
+    template<typename... _Resources>
+    class DmaRegistry
+    {
+        static constexpr auto _channels = (TypeList<>{} + ... + Zhele::Private::DmaChannelsOf<_Resources>());
+        static constexpr auto _bindings = (TypeList<>{} + ... + Zhele::Private::DmaBindingsOf<_Resources>());
+
+        static_assert(_channels.is_unique(Zhele::Private::SameDmaChannel), "DMA channel (stream) is used by several resources");
+        static_assert(_bindings.is_unique([](auto first, auto second) {
+            return TypeUnbox<first>::Request == TypeUnbox<second>::Request; }), "DMAMUX request is routed to several channels");
+        static_assert(_bindings.is_unique([](auto first, auto second) {
+            return TypeUnbox<first>::MuxChannel == TypeUnbox<second>::MuxChannel; }), "DMAMUX channel is used by several requests");
+
+        template<typename _Candidate, typename... _Others>
+        static consteval auto SelectFree()
+        {
+            if constexpr (!IsUsed<_Candidate>())
+                return TypeBox<_Candidate>{};
+            else
+            {
+                static_assert(sizeof...(_Others) > 0, "There is no free DMA channel among candidates");
+                return SelectFree<_Others...>();
+            }
+        }
+    public:
+        /**
+         * @brief Returns count of used DMA channels
+         *
+         * @returns Channels count
+         */
+        static consteval auto ChannelsCount() { return _channels.size(); }
+
+        /**
+         * @brief Check that channel (stream) is used by some resource
+         *
+         * @tparam _Channel DMA channel
+         *
+         * @retval true Channel is used
+         * @retval false Channel is free
+         */
+        template<typename _Channel>
+        static consteval bool IsUsed()
+        {
+            return _channels.any([](auto channel) { return Zhele::Private::SameDmaChannel(channel, TypeBox<_Channel>{}); });
+        }
+
+        /**
+         * @brief First free channel (stream) among candidates
+         *
+         * @tparam _Candidates Candidate channels in order of preference
+         */
+        template<typename... _Candidates>
+        using FreeChannel = TypeUnbox<SelectFree<_Candidates...>()>;
+
+        /**
+         * @brief Registry extended with given resources (checks are applied to all resources)
+         *
+         * @tparam _Others Additional resources
+         */
+        template<typename... _Others>
+        using With = DmaRegistry<_Resources..., _Others...>;
+
+        /**
+         * @brief Route all registered DMAMUX requests to their channels
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SelectRequests()
+        {
+            _bindings.foreach([](auto binding) { TypeUnbox<binding>::Select(); });
+        }
+    };
+}
+
+#endif //! ZHELE_DMA_REGISTRY_H
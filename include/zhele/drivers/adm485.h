@@ -1,98 +1,209 @@
 /**
  * @file
  * Driver for RS485 (wrapper on usart)
- * 
+ *
  * @author Aleksei Zhelonkin
  * @date 2022
  * @license FreeBSD
  */
 
+#ifndef ZHELE_DRIVERS_ADM485_H
+#define ZHELE_DRIVERS_ADM485_H
+
 #include <zhele/iopins.h>
 #include <zhele/usart.h>
 
+#include <type_traits>
+
 namespace Zhele::Drivers
 {
+    /**
+     * @brief Implements RS485 transceiver (ADM485, MAX485) control
+     *
+     * @details
+     * If direct pin is not set and USART supports driver enable output (F0, L4, G0),
+     * DE is driven by hardware on RTS pin (configure it as alternate function).
+     * Otherwise DE is driven by direct pin: it's set before transmission and cleared
+     * in transmission complete interrupt after async write (or after TC flag polling in sync write).
+     *
+     * Call @ref IrqHandler from USART IRQ handler if async write is used.
+     *
+     * On multi-drop bus node can ignore other nodes traffic by USART mute mode: frame starts
+     * with address byte (@ref WriteTo), receiver of other nodes stays muted until next address byte,
+     * so they don't take RX interrupts for this frame.
+     *
+     * @par Example
+     * @code
+     *  using Bus = Adm485<Usart1>;
+     *  Bus::Init<115200>(Bus::UsartMode::DataBits9 | Bus::UsartMode::RxTxEnable);
+     *  Bus::EnableMuteMode(UsartBase::MuteWakeup::AddressMark, nodeAddress);
+     *  Bus::EnterMuteMode();
+     *  ...
+     *  Bus::WriteToAsync(otherNode, request, sizeof(request));
+     * @endcode
+     *
+     * @tparam _Usart USART
+     * @tparam _DirectPin DE (and RE) pin
+     */
     template<typename _Usart, typename _DirectPin = IO::NullPin>
     class Adm485 : public _Usart
     {
         using Base = _Usart;
+        using Callback = std::add_pointer_t<void()>;
     public:
         using UsartMode = Base::UsartMode;
+
+        /// DE is driven by USART
+    #if defined (USART_CR3_DEM)
+        static constexpr bool HardwareDriverEnable = std::is_same_v<_DirectPin, IO::NullPin>;
+    #else
+        static constexpr bool HardwareDriverEnable = false;
+    #endif
+
+        /// Default DE assertion and deassertion time (in sample time units, half of bit for oversampling by 16)
+        static const uint8_t DefaultDriverEnableTime = 8;
+
         /**
          * @brief Initialize USART and direct pin
-         * 
+         *
          * @tparam baud Baud rate
          * @param [in] mode Mode
-         * 
+         *
          * @par Returns
          *	Nothing
             */
         template<unsigned long baud>
         static inline void Init(UsartMode mode = DefaultUsartMode)
         {
-            Base::Init<baud>(mode);
-            InitPin();
+            Base::template Init<baud>(mode);
+            InitDriverEnable();
         }
-        
+
 
         /**
          * @brief Initialize USART
-         * 
+         *
          * @param [in] baud Baud rate
          * @param[in] mode Mode
-         * 
+         *
          * @par Returns
          *	Nothing
             */
         static void Init(unsigned baud, UsartMode mode = DefaultUsartMode)
         {
             Base::Init(baud, mode);
-            InitPin();
+            InitDriverEnable();
         }
 
         /**
          * @brief Write data to line
-         * 
+         *
+         * @details
+         * Method returns after last stop bit (line is released).
+         *
          * @param [in] data Data to write
          * @param [in] size Data size
-         * 
+         *
          * @par Returns
          * 	Nothing
          */
         static void Write(const void* data, size_t size)
         {
             _DirectPin::Set();
-            Base::Write(data, size + 1); // +1, because usart ready when TX buffer empty (not last byte has been transmitted)
-            while(!Base::WriteReady()) continue;
+            Base::Write(data, size);
+            WaitTransmissionComplete();
             _DirectPin::Clear();
         }
 
         /**
          * @brief Write data to line async
-         * 
+         *
+         * @details
+         * Data is sent by DMA, callback is called from USART interrupt when
+         * last byte is transmitted and line is released.
+         *
+         * @param [in] data Data to write (must be valid until callback)
+         * @param [in] size Data size
+         * @param [in] callback Transmission complete callback
+         *
+         * @par Returns
+         * 	Nothing
+         */
+        static void WriteAsync(const void* data, size_t size, Callback callback = nullptr)
+        {
+            while (_transmitting) continue;
+
+            if (size == 0) {
+                if (callback)
+                    callback();
+                return;
+            }
+
+            _callback = callback;
+            _transmitting = true;
+            _DirectPin::Set();
+            Base::WriteAsync(data, size, DmaTransferComplete);
+        }
+
+        /**
+         * @brief Write address byte and data to line (multiprocessor communication)
+         *
+         * @details
+         * Receivers in address mark mute mode wake up only if address matches.
+         *
+         * @param [in] address Receiver address
          * @param [in] data Data to write
          * @param [in] size Data size
-         * @param [in] async Write async or no
-         * 
+         *
          * @par Returns
          * 	Nothing
          */
-        static void WriteAsync(const void* data, size_t size, std::add_pointer_t<void()> callback = nullptr)
+        static void WriteTo(uint8_t address, const void* data, size_t size)
         {
             _DirectPin::Set();
-            Base::WriteAsync(data, size + 1, [callback](auto... unused){
-                while(!Base::WriteReady()) continue;
-                _DirectPin::Clear();
-                if(callback)
-                    callback();
-            });
+            Base::WriteAddress(address);
+            Base::Write(data, size);
+            WaitTransmissionComplete();
+            _DirectPin::Clear();
+        }
+
+        /**
+         * @brief Write address byte and data to line async (multiprocessor communication)
+         *
+         * @details
+         * Address byte is written to data register synchronously, data is sent by DMA.
+         *
+         * @param [in] address Receiver address
+         * @param [in] data Data to write (must be valid until callback)
+         * @param [in] size Data size
+         * @param [in] callback Transmission complete callback
+         *
+         * @par Returns
+         * 	Nothing
+         */
+        static void WriteToAsync(uint8_t address, const void* data, size_t size, Callback callback = nullptr)
+        {
+            while (_transmitting) continue;
+
+            _callback = callback;
+            _transmitting = true;
+            _DirectPin::Set();
+            Base::WriteAddress(address);
+
+            if (size == 0) {
+                _waitComplete = true;
+                Base::EnableInterrupt(Base::TxCompleteInt);
+                return;
+            }
+
+            Base::WriteAsync(data, size, DmaTransferComplete);
         }
 
         /**
          * @brief Sync write byte
-         * 
+         *
          * @param [in] data Byte to write
-         * 
+         *
          * @par Returns
          *	Nothing
         */
@@ -100,11 +211,46 @@ namespace Zhele::Drivers
         {
             _DirectPin::Set();
             Base::Write(data);
+            WaitTransmissionComplete();
             _DirectPin::Clear();
         }
+
+        /**
+         * @brief Check that async write is in progress
+         *
+         * @retval true Line is driven
+         * @retval false Line is released
+         */
+        static bool Transmitting()
+        {
+            return _transmitting;
+        }
+
+        /**
+         * @brief Handles transmission complete interrupt (call it from USART IRQ handler)
+         *
+         * @par Returns
+         *	Nothing
+        */
+        static void IrqHandler()
+        {
+            if (!_waitComplete || !(Base::InterruptSource() & Base::TxCompleteInt))
+                return;
+
+            Base::DisableInterrupt(Base::TxCompleteInt);
+            _waitComplete = false;
+            Release();
+        }
+
     private:
-        static void InitPin()
+        static void InitDriverEnable()
         {
+        #if defined (USART_CR3_DEM)
+            if constexpr (HardwareDriverEnable) {
+                Base::EnableDriverEnable(DefaultDriverEnableTime, DefaultDriverEnableTime);
+                return;
+            }
+        #endif
             if constexpr (std::is_same_v<_DirectPin, IO::NullPin>)
                 return;
 
@@ -113,5 +259,38 @@ namespace Zhele::Drivers
             _DirectPin::template SetDriverType<_DirectPin::DriverType::PushPull>();
             _DirectPin::Clear();
         }
+
+        static void WaitTransmissionComplete()
+        {
+            while (!(Base::InterruptSource() & Base::TxCompleteInt)) continue;
+        }
+
+        static void DmaTransferComplete(void* data, unsigned size, bool success)
+        {
+            if (!success) {
+                Release();
+                return;
+            }
+
+            // DMA has written last byte to data register, line is released after its transmission
+            _waitComplete = true;
+            Base::EnableInterrupt(Base::TxCompleteInt);
+        }
+
+        static void Release()
+        {
+            _DirectPin::Clear();
+            _transmitting = false;
+
+            Callback callback = _callback;
+            if (callback)
+                callback();
+        }
+
+        static inline Callback _callback = nullptr; ///< Async write callback
+        static inline volatile bool _transmitting = false; ///< Async write is in progress
+        static inline volatile bool _waitComplete = false; ///< Waiting for TC interrupt
     };
-}
\ No newline at end of file
+}
+
+#endif //! ZHELE_DRIVERS_ADM485_H
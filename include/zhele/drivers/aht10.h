@@ -12,7 +12,7 @@
 #ifndef ZHELE_DRIVERS_AHT10_H
 #define ZHELE_DRIVERS_AHT10_H
 
-#include <zhele/delay.h>
+#include <zhele/system_time.h>
 #include <limits.h>
 
 namespace Zhele::Drivers
@@ -44,6 +44,17 @@ namespace Zhele::Drivers
         };
 
     public:
+        /// Measurement state (see StartMeasurement and Poll)
+        enum class MeasurementState : uint8_t
+        {
+            Idle, ///< There is no measurement
+            Triggering, ///< Trigger command is being sent
+            Converting, ///< Sensor converts
+            Reading, ///< Status and result are being read
+            Ready, ///< Result is ready (use Last* methods)
+            Error, ///< I2C error
+        };
+
         /**
          * @brief Init sensor
          * 
@@ -87,12 +98,7 @@ namespace Zhele::Drivers
             if (!ReadRaw(data))
                 return false;
 
-            uint32_t temperature = data[3] & 0x0f;
-            temperature <<= 8;
-            temperature |= data[4];
-            temperature <<= 8;
-            temperature |= data[5];
-            return (static_cast<float>(temperature) * 200 / 0x100000) - 50;
+            return ConvertTemperature(data);
         }
 
         /**
@@ -107,12 +113,7 @@ namespace Zhele::Drivers
             if (!ReadRaw(data))
                 return false;
 
-            uint32_t humidity = data[1];
-            humidity <<= 8;
-            humidity |= data[2];
-            humidity <<= 4;
-            humidity |= data[3] >> 4;
-            return (static_cast<float>(humidity) * 100) / 0x100000;
+            return ConvertHumidity(data);
         }
 
         /**
@@ -127,22 +128,284 @@ namespace Zhele::Drivers
             if (!ReadRaw(data))
                 return std::make_pair(std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN());
 
+            return std::make_pair(ConvertTemperature(data), ConvertHumidity(data));
+        }
+
+        /**
+         * @brief Read temperature and humidity both (fixed-point)
+         * 
+         * @param [out] temperature Temperature (0.01 degrees Celsius)
+         * @param [out] humidity Relative humidity (0.001 %RH)
+         * 
+         * @retval true Success
+         * @retval false I2C error
+         */
+        static bool ReadFixed(int32_t& temperature, uint32_t& humidity)
+        {
+            uint8_t data[6];
+
+            if (!ReadRaw(data))
+                return false;
+
+            temperature = ConvertTemperatureFixed(data);
+            humidity = ConvertHumidityFixed(data);
+            return true;
+        }
+
+        /**
+         * @brief Trigger measurement async (via I2C DMA or I2cBus queue)
+         * 
+         * @details
+         * Measurement takes about 80 ms, after that read result by ReadAsync.
+         * 
+         * @param [in] callback Complete callback (optional parameter)
+         * 
+         * @returns Operation status
+         */
+        static I2cStatus TriggerMeasurementAsync(I2cCallback callback = nullptr)
+        {
+            return _I2CBus::WriteAsync(AHT10Address, 0, _command, sizeof(_command), I2cOpts::RegAddrNone, callback);
+        }
+
+        /**
+         * @brief Read measurement result async (via I2C DMA or I2cBus queue)
+         * 
+         * @details
+         * Use LastTemperature and LastHumidity in callback to get values.
+         * 
+         * @param [in] callback Complete callback
+         * 
+         * @returns Operation status
+         */
+        static I2cStatus ReadAsync(I2cCallback callback)
+        {
+            return _I2CBus::EnableAsyncRead(AHT10Address, 0, _data, sizeof(_data), I2cOpts::RegAddrNone, callback);
+        }
+
+        /**
+         * @brief Temperature from last async read
+         * 
+         * @returns Temperature
+         */
+        static float LastTemperature()
+        {
+            return ConvertTemperature(_data);
+        }
+
+        /**
+         * @brief Humidity from last async read
+         * 
+         * @returns Humidity
+         */
+        static float LastHumidity()
+        {
+            return ConvertHumidity(_data);
+        }
+
+        /**
+         * @brief Temperature from last async read (fixed-point)
+         * 
+         * @returns Temperature (0.01 degrees Celsius)
+         */
+        static int32_t LastTemperatureFixed()
+        {
+            return ConvertTemperatureFixed(_data);
+        }
+
+        /**
+         * @brief Humidity from last async read (fixed-point)
+         * 
+         * @returns Relative humidity (0.001 %RH)
+         */
+        static uint32_t LastHumidityFixed()
+        {
+            return ConvertHumidityFixed(_data);
+        }
+
+        /**
+         * @brief Starts non-blocking measurement
+         * 
+         * @details
+         * Trigger command is sent async, then Poll checks sensor status and reads result
+         * without delays, so conversions of several sensors overlap.
+         * 
+         * @par Example
+         * @code
+         *  Sensor::StartMeasurement();
+         *  // Main loop (or timer)
+         *  if(Sensor::Poll() == Sensor::MeasurementState::Ready)
+         *  {
+         *      int32_t temperature = Sensor::LastTemperatureFixed();
+         *      Sensor::StartMeasurement();
+         *  }
+         * @endcode
+         * 
+         * @retval I2cStatus::Success Measurement was started
+         * @retval I2cStatus::Busy Previous measurement is in progress or bus is busy (state is Idle)
+         * @retval Other I2C error (state is Error)
+         */
+        static I2cStatus StartMeasurement()
+        {
+            if (_state == MeasurementState::Triggering || _state == MeasurementState::Reading)
+                return I2cStatus::Busy;
+
+            _state = MeasurementState::Triggering;
+            I2cStatus status = TriggerMeasurementAsync(TriggerComplete);
+            if (status != I2cStatus::Success)
+                _state = status == I2cStatus::Busy ? MeasurementState::Idle : MeasurementState::Error;
+
+            return status;
+        }
+
+        /**
+         * @brief Advances measurement state machine (never blocks)
+         * 
+         * @details
+         * While sensor converts, every call starts async read of status and data (one short transaction),
+         * so call it not more often than it's needed (conversion takes about 80 ms).
+         * 
+         * @returns Measurement state
+         */
+        static MeasurementState Poll()
+        {
+            if (_state == MeasurementState::Converting) {
+                _state = MeasurementState::Reading;
+                I2cStatus status = ReadAsync(ReadComplete);
+                if (status != I2cStatus::Success)
+                    _state = status == I2cStatus::Busy ? MeasurementState::Converting : MeasurementState::Error;
+            }
+
+            return _state;
+        }
+
+        /**
+         * @brief Returns measurement state
+         * 
+         * @returns Measurement state
+         */
+        static MeasurementState GetMeasurementState()
+        {
+            return _state;
+        }
+
+    private:
+        static const uint8_t _command[3]; ///< Trigger measurement command
+        static uint8_t _data[6]; ///< Raw data of last async read
+        static volatile MeasurementState _state; ///< Measurement state
+
+        /**
+         * @brief Trigger command complete handler
+         * 
+         * @param [in] status Operation status
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void TriggerComplete(I2cStatus status)
+        {
+            _state = status == I2cStatus::Success ? MeasurementState::Converting : MeasurementState::Error;
+        }
+
+        /**
+         * @brief Status and data read complete handler
+         * 
+         * @param [in] status Operation status
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void ReadComplete(I2cStatus status)
+        {
+            if (status != I2cStatus::Success)
+                _state = MeasurementState::Error;
+            else
+                _state = (_data[0] & static_cast<uint8_t>(Status::Busy)) ? MeasurementState::Converting : MeasurementState::Ready;
+        }
+
+        /**
+         * @brief Convert raw data to temperature
+         * 
+         * @param [in] data Raw data (6 bytes)
+         * 
+         * @returns Temperature
+         */
+        static float ConvertTemperature(const uint8_t* data)
+        {
+            return (static_cast<float>(RawTemperature(data)) * 200 / 0x100000) - 50;
+        }
+
+        /**
+         * @brief Convert raw data to temperature (fixed-point)
+         * 
+         * @param [in] data Raw data (6 bytes)
+         * 
+         * @returns Temperature (0.01 degrees Celsius)
+         */
+        static int32_t ConvertTemperatureFixed(const uint8_t* data)
+        {
+            // raw * 20000 / 2^20 = raw * 625 / 2^15
+            return static_cast<int32_t>((RawTemperature(data) * 625) >> 15) - 5000;
+        }
+
+        /**
+         * @brief Returns raw 20-bit temperature
+         * 
+         * @param [in] data Raw data (6 bytes)
+         * 
+         * @returns Raw temperature
+         */
+        static uint32_t RawTemperature(const uint8_t* data)
+        {
             uint32_t temperature = data[3] & 0x0f;
             temperature <<= 8;
             temperature |= data[4];
             temperature <<= 8;
             temperature |= data[5];
+            return temperature;
+        }
+
+        /**
+         * @brief Convert raw data to humidity
+         * 
+         * @param [in] data Raw data (6 bytes)
+         * 
+         * @returns Humidity
+         */
+        static float ConvertHumidity(const uint8_t* data)
+        {
+            return (static_cast<float>(RawHumidity(data)) * 100) / 0x100000;
+        }
+
+        /**
+         * @brief Convert raw data to humidity (fixed-point)
+         * 
+         * @param [in] data Raw data (6 bytes)
+         * 
+         * @returns Relative humidity (0.001 %RH)
+         */
+        static uint32_t ConvertHumidityFixed(const uint8_t* data)
+        {
+            // raw * 100000 / 2^20 = raw * 3125 / 2^15
+            return (RawHumidity(data) * 3125) >> 15;
+        }
 
+        /**
+         * @brief Returns raw 20-bit humidity
+         * 
+         * @param [in] data Raw data (6 bytes)
+         * 
+         * @returns Raw humidity
+         */
+        static uint32_t RawHumidity(const uint8_t* data)
+        {
             uint32_t humidity = data[1];
             humidity <<= 8;
             humidity |= data[2];
             humidity <<= 4;
             humidity |= data[3] >> 4;
-
-            return std::make_pair((static_cast<float>(temperature) * 200 / 0x100000) - 50, (static_cast<float>(humidity) * 100) / 0x100000);
+            return humidity;
         }
 
-    private:
         /**
          * @brief Read raw 6 bytes
          * 
@@ -160,7 +423,7 @@ namespace Zhele::Drivers
             }
 
             while (GetStatus() & static_cast<uint8_t>(Status::Busy)) {
-                delay_ms<10>();
+                SystemTime::Sleep(10);
             }
 
             return Read(data);
@@ -191,7 +454,7 @@ namespace Zhele::Drivers
                 return false;
 
             while(GetStatus() & static_cast<uint8_t>(Status::Busy)) {
-                delay_ms<10>();
+                SystemTime::Sleep(10);
             }
 
             return GetStatus() & static_cast<uint8_t>(Status::Calibrated);
@@ -247,5 +510,12 @@ namespace Zhele::Drivers
             return _I2CBus::Write(AHT10Address, 0, data, Size, I2cOpts::RegAddrNone) == I2cStatus::Success;
         }
     };
+
+    template <typename _I2CBus>
+    const uint8_t Aht10<_I2CBus>::_command[3] = {static_cast<uint8_t>(Aht10<_I2CBus>::Commands::Trigger), static_cast<uint8_t>(Aht10<_I2CBus>::Commands::StartMeasurement), 0};
+    template <typename _I2CBus>
+    uint8_t Aht10<_I2CBus>::_data[6] = {};
+    template <typename _I2CBus>
+    volatile typename Aht10<_I2CBus>::MeasurementState Aht10<_I2CBus>::_state = Aht10<_I2CBus>::MeasurementState::Idle;
 }
 #endif // !ZHELE_DRIVERS_AHT10_H
\ No newline at end of file
@@ -0,0 +1,880 @@
+/**
+ * @file
+ * Implements table-driven bit-stream protocol engine (encoder and decoder) over timer and DMA
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_BIT_STREAM_H
+#define ZHELE_DRIVERS_BIT_STREAM_H
+
+#include <zhele/dma.h>
+#include <zhele/pinlist.h>
+#include <zhele/timer.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Bit-stream protocol table
+     *
+     * @details
+     * Line time is divided into chips (timer update periods), every symbol is sequence of chips levels
+     * (bit n of level is line n, single-line protocols use bit 0). Frame is
+     * frameStart, words (wordStart, wordBits data bit symbols, wordStop) and frameStop, empty symbols are skipped.
+     * Define table as constexpr object and pass it as template argument of @ref BitStreamEngine
+     * and @ref BitStreamDecoder (see @ref BitStreamProtocols).
+     *
+     * @tparam _MaxLength Maximal symbol length (chips)
+     */
+    template<unsigned _MaxLength>
+    struct BitStreamTable
+    {
+        /// Symbol
+        struct Symbol
+        {
+            uint8_t length; ///< Chips count
+            uint8_t levels[_MaxLength]; ///< Lines levels of chips
+        };
+
+        static const unsigned MaxLength = _MaxLength;
+
+        Symbol zero; ///< Data bit 0
+        Symbol one; ///< Data bit 1 (must have the same length as zero)
+        Symbol wordStart; ///< Word prefix (UART start bit)
+        Symbol wordStop; ///< Word suffix (UART stop bits)
+        Symbol frameStart; ///< Frame prefix (preamble, break)
+        Symbol frameStop; ///< Frame suffix (encoder only)
+        uint8_t wordBits; ///< Data bits per word (1..8)
+        bool lsbFirst; ///< Least significant bit is sent first
+        uint8_t idle; ///< Lines levels between frames
+        uint8_t frameGap; ///< Chips count of constant level that ends frame (decoder only)
+    };
+
+    /// Predefined protocol tables
+    namespace BitStreamProtocols
+    {
+        /**
+         * @brief Manchester code (IEEE 802.3: 0 is high-to-low, 1 is low-to-high), chip is half of bit
+         *
+         * @details
+         * Frame starts with one-bit high pulse (it is never found in data) and ends when line is idle (low) for two bits.
+         */
+        inline constexpr BitStreamTable<2> Manchester = {
+            .zero = {2, {1, 0}},
+            .one = {2, {0, 1}},
+            .wordStart = {0, {}},
+            .wordStop = {0, {}},
+            .frameStart = {2, {1, 1}},
+            .frameStop = {0, {}},
+            .wordBits = 8,
+            .lsbFirst = false,
+            .idle = 0,
+            .frameGap = 4,
+        };
+
+        /**
+         * @brief DMX512 (250 kbit/s, 8N2), chip is 4 us
+         *
+         * @details
+         * Frame is break (88 us), mark after break (12 us) and slots (the first one is start code).
+         * Decoder accepts longer break, mark after break and marks between slots.
+         */
+        inline constexpr BitStreamTable<25> Dmx512 = {
+            .zero = {1, {0}},
+            .one = {1, {1}},
+            .wordStart = {1, {0}},
+            .wordStop = {2, {1, 1}},
+            .frameStart = {25, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1}},
+            .frameStop = {0, {}},
+            .wordBits = 8,
+            .lsbFirst = true,
+            .idle = 1,
+            .frameGap = 16,
+        };
+
+        /**
+         * @brief Synchronous serial (line 0 is clock, line 1 is data, data is latched on clock rising edge, MSB first)
+         */
+        inline constexpr BitStreamTable<2> ClockData = {
+            .zero = {2, {0b00, 0b01}},
+            .one = {2, {0b10, 0b11}},
+            .wordStart = {0, {}},
+            .wordStop = {0, {}},
+            .frameStart = {0, {}},
+            .frameStop = {1, {0b00}},
+            .wordBits = 8,
+            .lsbFirst = false,
+            .idle = 0,
+            .frameGap = 0,
+        };
+    }
+
+    /**
+     * @brief Bit-stream output to timer channel (chip is PWM period with 0% or 100% duty)
+     *
+     * @tparam _Timer GP timer
+     * @tparam _Channel Timer channel
+     * @tparam _Pin Output pin
+     */
+    template <typename _Timer, unsigned _Channel, typename _Pin = typename _Timer::template OutputCompare<_Channel>::Pins::template Pin<0>>
+    class BitStreamChannelOutput
+    {
+        using Pwm = typename _Timer::template PWMGeneration<_Channel>;
+    public:
+        /// DMA word (CCR value)
+        using Word = typename _Timer::Counter;
+
+        /// Init channel and pin (timer period must be set)
+        static void Init(uint8_t idle)
+        {
+            Pwm::SetOutputPolarity(Pwm::ActiveHigh);
+            Pwm::EnablePreload();
+            Idle(idle);
+            Pwm::template SelectPins<_Pin>();
+        }
+
+        /// Returns DMA word of chip level
+        static Word Convert(uint8_t level)
+        {
+            // Pulse greater than period keeps output active during whole period
+            return (level & 1) ? static_cast<Word>(_Timer::GetPeriod() + 1) : 0;
+        }
+
+        /// Returns DMA destination
+        static volatile void* Register()
+        {
+            return Pwm::PulseRegister();
+        }
+
+        /// Switch from idle level to DMA words
+        static void Start(uint8_t idle)
+        {
+            Pwm::SetPulse(Convert(idle));
+            _Timer::SetPeriodAndUpdate(_Timer::GetPeriod());
+            Pwm::SetOutputMode(Pwm::PWM1);
+        }
+
+        /// Set idle level
+        static void Idle(uint8_t idle)
+        {
+            Pwm::SetOutputMode((idle & 1) ? Pwm::ForcedActive : Pwm::ForcedInactive);
+        }
+    };
+
+    /**
+     * @brief Bit-stream output to GPIO pins through BSRR
+     *
+     * @note DMA must have access to GPIO (on stm32f4 only DMA2 does, so use TIM1/TIM8 requests).
+     *
+     * @tparam _Pins Lines pins (pinlist, all pins must be on one port, line n is pin n)
+     */
+    template <typename _Pins>
+    class BitStreamPortOutput
+    {
+        using Port = typename _Pins::template Pin<0>::Port;
+
+        static const uint32_t PortMask = _Pins::template PortMask<Port>();
+
+        static_assert(std::popcount(PortMask) == _Pins::Length, "All pins must be on one port");
+    public:
+        /// DMA word (BSRR value)
+        using Word = uint32_t;
+
+        /// Init pins
+        static void Init(uint8_t idle)
+        {
+            _Pins::Enable();
+            Idle(idle);
+            _Pins::template SetConfiguration<_Pins::Out>();
+            _Pins::template SetDriverType<_Pins::PushPull>();
+            _Pins::template SetSpeed<_Pins::Fast>();
+        }
+
+        /// Returns DMA word of chip level
+        static constexpr Word Convert(uint8_t level)
+        {
+            uint32_t portValue = _Pins::template PortValue<Port>(level);
+            return portValue | ((PortMask & ~portValue) << 16);
+        }
+
+        /// Returns DMA destination
+        static volatile void* Register()
+        {
+            return Port::BitSetResetRegister();
+        }
+
+        /// Switch from idle level to DMA words (BSRR words don't need it)
+        static void Start(uint8_t)
+        {
+        }
+
+        /// Set idle level
+        static void Idle(uint8_t idle)
+        {
+            _Pins::Write(idle);
+        }
+    };
+
+    /**
+     * @brief Class for table-driven bit-stream transmitter
+     *
+     * @details
+     * Protocol table symbols are converted to output words (CCR values or BSRR words) once in @ref Init,
+     * so frame is encoded by copying symbols to DMA buffer. Words are transferred by DMA on timer update event
+     * (every chip) through double (circular) buffer with _BlockSlots chips per block,
+     * blocks are encoded in DMA interrupt while other block is being sent. So RAM usage does not depend on frame size
+     * and chip timing does not depend on CPU load.
+     *
+     * @par Example
+     * @code
+     *  using Dmx = Drivers::BitStreamEngine<Drivers::BitStreamChannelOutput<Timers::Timer2, 0>, Drivers::BitStreamProtocols::Dmx512,
+     *                                      Timers::Timer2, Dma1Channel2>;
+     *  Dmx::Init(250000);
+     *  Dmx::Send(universe, 513);
+     * @endcode
+     *
+     * @tparam _Output Output (@ref BitStreamChannelOutput or @ref BitStreamPortOutput)
+     * @tparam _Table Protocol table (@ref BitStreamTable)
+     * @tparam _Timer Timer that paces chips
+     * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+     * @tparam _BlockSlots Chips count in one DMA buffer block
+     */
+    template <typename _Output, auto _Table, typename _Timer, typename _DmaChannel, unsigned _BlockSlots = 64>
+    class BitStreamEngine
+    {
+        using Word = typename _Output::Word;
+        using Symbol = typename decltype(_Table)::Symbol;
+
+        static_assert(_Table.zero.length == _Table.one.length, "Data bit symbols must have the same length");
+        static_assert(_Table.wordBits > 0 && _Table.wordBits <= 8, "Word must have 1..8 bits");
+
+        enum Phase : uint8_t { FrameStart, WordStart, Bits, WordStop, FrameStop, Finished };
+
+        static const unsigned MaxLength = decltype(_Table)::MaxLength;
+        static const unsigned WordChips = _Table.wordStart.length + _Table.wordBits * _Table.zero.length + _Table.wordStop.length;
+    public:
+        /**
+         * @brief Init timer, DMA and output
+         *
+         * @param [in] chipRate Chips per second
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint32_t chipRate)
+        {
+            _Timer::Enable();
+            _Timer::Stop();
+            _Timer::SetPrescaler(0);
+            _Timer::SetPeriod(_Timer::GetClockFreq() / chipRate - 1);
+
+            _Output::Init(_Table.idle);
+
+            const Symbol* symbols[] = {&_Table.frameStart, &_Table.wordStart, &_Table.zero, &_Table.one, &_Table.wordStop, &_Table.frameStop};
+            for (unsigned symbol = 0; symbol < 6; ++symbol)
+            {
+                for (unsigned chip = 0; chip < symbols[symbol]->length; ++chip)
+                {
+                    _symbols[symbol][chip] = _Output::Convert(symbols[symbol]->levels[chip]);
+                }
+            }
+            _idle = _Output::Convert(_Table.idle);
+        }
+
+        /**
+         * @brief Start sending frame (non-blocking)
+         *
+         * @param [in] data Words (must be valid until transfer complete)
+         * @param [in] count Words count
+         * @param [in] callback Complete callback
+         *
+         * @retval true Transfer started
+         * @retval false Previous transfer is in progress
+         */
+        static bool Send(const uint8_t* data, uint16_t count, std::add_pointer_t<void()> callback = nullptr)
+        {
+            if (_busy)
+                return false;
+
+            _busy = true;
+            _data = data;
+            _count = count;
+            _callback = callback;
+            _phase = FrameStart;
+            _word = 0;
+            _bit = 0;
+            _offset = 0;
+            _completedBlocks = 0;
+
+            // One more block keeps the last chip for whole chip time
+            const uint32_t chips = _Table.frameStart.length + count * WordChips + _Table.frameStop.length;
+            _blocks = (chips + _BlockSlots - 1) / _BlockSlots + 1;
+
+            FillBlock(_buffer);
+            FillBlock(_buffer + _BlockSlots);
+
+            auto mode = _DmaChannel::Mem2Periph | _DmaChannel::MemIncrement | _DmaChannel::PriorityHigh;
+            if constexpr (sizeof(Word) == 4)
+                mode = mode | _DmaChannel::PSize32Bits | _DmaChannel::MSize32Bits;
+            else
+                mode = mode | _DmaChannel::PSize16Bits | _DmaChannel::MSize16Bits;
+
+            _DmaChannel::SetDoubleBufferedTransferCallback(BlockHandler);
+            _DmaChannel::TransferDoubleBuffered(mode, _buffer, _buffer + _BlockSlots, _Output::Register(), _BlockSlots);
+
+            _Output::Start(_Table.idle);
+            _Timer::ResetCounterValue();
+            _Timer::DmaRequestEnable();
+            _Timer::Start();
+            return true;
+        }
+
+        /**
+         * @brief Check that engine is ready for new frame
+         *
+         * @retval true Ready
+         * @retval false Transfer in progress
+         */
+        static bool Ready()
+        {
+            return !_busy;
+        }
+
+    private:
+        static const Word* Current(uint8_t& length)
+        {
+            switch (_phase)
+            {
+            case FrameStart:
+                length = _Table.frameStart.length;
+                return _symbols[0];
+            case WordStart:
+                length = _Table.wordStart.length;
+                return _symbols[1];
+            case Bits:
+            {
+                const unsigned shift = _Table.lsbFirst ? _bit : _Table.wordBits - 1 - _bit;
+                length = _Table.zero.length;
+                return _symbols[2 + ((_data[_word] >> shift) & 1)];
+            }
+            case WordStop:
+                length = _Table.wordStop.length;
+                return _symbols[4];
+            default:
+                length = _Table.frameStop.length;
+                return _symbols[5];
+            }
+        }
+
+        static void Advance()
+        {
+            switch (_phase)
+            {
+            case FrameStart:
+                _phase = _count > 0 ? WordStart : FrameStop;
+                break;
+            case WordStart:
+                _phase = Bits;
+                _bit = 0;
+                break;
+            case Bits:
+                if (++_bit == _Table.wordBits)
+                    _phase = WordStop;
+                break;
+            case WordStop:
+                _phase = ++_word < _count ? WordStart : FrameStop;
+                break;
+            default:
+                _phase = Finished;
+                break;
+            }
+        }
+
+        static void FillBlock(Word* block)
+        {
+            unsigned slot = 0;
+            while (slot < _BlockSlots && _phase != Finished)
+            {
+                uint8_t length;
+                const Word* symbol = Current(length);
+                while (_offset < length && slot < _BlockSlots)
+                {
+                    block[slot++] = symbol[_offset++];
+                }
+
+                if (_offset == length)
+                {
+                    _offset = 0;
+                    Advance();
+                }
+            }
+
+            // Tail of the last data block and next block keep line idle
+            while (slot < _BlockSlots)
+            {
+                block[slot++] = _idle;
+            }
+        }
+
+        static void BlockHandler(void* data, unsigned, unsigned)
+        {
+            if (++_completedBlocks >= _blocks)
+            {
+                _Timer::Stop();
+                _Timer::DmaRequestDisable();
+                _DmaChannel::Disable();
+                _Output::Idle(_Table.idle);
+                _busy = false;
+
+                if (_callback)
+                    _callback();
+                return;
+            }
+
+            FillBlock(static_cast<Word*>(data));
+        }
+
+        static Word _buffer[2 * _BlockSlots];
+        static Word _symbols[6][MaxLength];
+        static Word _idle;
+        static const uint8_t* _data;
+        static uint16_t _count;
+        static uint16_t _word;
+        static uint8_t _bit;
+        static uint8_t _offset;
+        static Phase _phase;
+        static uint32_t _completedBlocks;
+        static uint32_t _blocks;
+        static std::add_pointer_t<void()> _callback;
+        static volatile bool _busy;
+    };
+
+    #define BIT_STREAM_ENGINE_TEMPLATE_ARGS template <typename _Output, auto _Table, typename _Timer, typename _DmaChannel, unsigned _BlockSlots>
+    #define BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER BitStreamEngine<_Output, _Table, _Timer, _DmaChannel, _BlockSlots>
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    typename BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::Word BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_buffer[2 * _BlockSlots];
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    typename BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::Word BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_symbols[6][MaxLength];
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    typename BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::Word BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_idle;
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    const uint8_t* BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_data;
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    uint16_t BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_count;
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    uint16_t BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_word;
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    uint8_t BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_bit;
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    uint8_t BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_offset;
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    typename BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::Phase BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_phase;
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    uint32_t BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_completedBlocks;
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    uint32_t BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_blocks;
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    std::add_pointer_t<void()> BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_callback;
+
+    BIT_STREAM_ENGINE_TEMPLATE_ARGS
+    volatile bool BIT_STREAM_ENGINE_TEMPLATE_QUALIFIER::_busy = false;
+
+    /**
+     * @brief Class for table-driven bit-stream receiver
+     *
+     * @details
+     * Timer channel 1 captures both edges of line 0 (TI1 edge detector is TRC, as in hall sensor interface),
+     * DMA copies timestamps to circular buffer, so receiving does not need interrupts.
+     * @ref Process (call it from main loop or periodic task at least every _Edges line edges and every timer period)
+     * converts edge intervals to runs of chips and matches them with table symbols. The first run of
+     * frameStart may be longer (break), idle level is allowed before wordStart (marks between words),
+     * frame ends when level does not change for frameGap chips. Completed frame is passed to callback.
+     *
+     * @par Example
+     * @code
+     *  using Receiver = Drivers::BitStreamDecoder<Timers::Timer3, Drivers::BitStreamProtocols::Manchester, Dma1Channel6>;
+     *  Receiver::Init(2000, [](const uint8_t* data, uint16_t count) { Handle(data, count); });
+     *  for (;;) Receiver::Process();
+     * @endcode
+     *
+     * @tparam _Timer GP timer
+     * @tparam _Table Protocol table (@ref BitStreamTable)
+     * @tparam _DmaChannel DMA channel (stream) connected to timer channel 1 capture request
+     * @tparam _MaxWords Maximal frame size (words)
+     * @tparam _Edges Timestamps buffer size
+     * @tparam _Pin Input pin (timer channel 1 pin)
+     */
+    template <typename _Timer, auto _Table, typename _DmaChannel, unsigned _MaxWords = 64, unsigned _Edges = 64,
+            typename _Pin = typename _Timer::template InputCapture<0>::Pins::template Pin<0>>
+    class BitStreamDecoder
+    {
+        using Capture = typename _Timer::template InputCapture<0>;
+        using Counter = typename _Timer::Counter;
+        using Symbol = typename decltype(_Table)::Symbol;
+
+        static_assert(_Table.zero.length == _Table.one.length && _Table.zero.length > 0, "Data bit symbols must have the same length");
+        static_assert(_Table.frameGap > 0, "Frame gap is required for decoding");
+
+        enum Phase : uint8_t { Hunt, FrameStart, WordStart, Bits, WordStop };
+
+        // Timer ticks per chip (rounding of intervals)
+        static const unsigned ChipTicks = 32;
+    public:
+        /// Frame callback
+        using FrameCallback = std::add_pointer_t<void(const uint8_t* data, uint16_t count)>;
+
+        /**
+         * @brief Init timer, capture channel, DMA and pin and start receiving
+         *
+         * @param [in] chipRate Chips per second
+         * @param [in] callback Frame callback (called from @ref Process)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint32_t chipRate, FrameCallback callback)
+        {
+            _callback = callback;
+
+            _Timer::Enable();
+            _Timer::Stop();
+            const uint32_t prescaler = _Timer::GetClockFreq() / (chipRate * ChipTicks);
+            _Timer::SetPrescaler(prescaler > 0 ? prescaler - 1 : 0);
+            _Timer::SetPeriod(0xffff);
+            _chipTicks = _Timer::GetClockFreq() / ((prescaler > 0 ? prescaler : 1) * chipRate);
+
+            _Timer::SlaveMode::SelectTrigger(_Timer::SlaveMode::Trigger::Ti1EdgeDetector);
+            Capture::SetCaptureMode(Capture::CaptureMode::CaptureTrc);
+            Capture::SetCapturePolarity(Capture::CapturePolarity::RisingEdge);
+            Capture::template SelectPins<_Pin>();
+
+            _read = 0;
+            _phase = Hunt;
+            Capture::template StartCaptureStream<_DmaChannel>(_edges, _Edges, nullptr, true);
+            _Timer::Start();
+            _mark = _Timer::GetCounterValue();
+            _since = 0;
+            _timedOut = true;
+            _level = _Pin::IsSet() ? 1 : 0;
+        }
+
+        /**
+         * @brief Decodes captured edges
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Process()
+        {
+            unsigned written = (_Edges - _DmaChannel::RemainingTransfers()) % _Edges;
+            while (_read != written)
+            {
+                const Counter timestamp = _edges[_read];
+                _read = (_read + 1) % _Edges;
+
+                uint32_t chips = Chips(_since + static_cast<Counter>(timestamp - _mark));
+                _mark = timestamp;
+                _since = 0;
+                if (_timedOut)
+                {
+                    // Line was idle, run is frame gap at least
+                    _timedOut = false;
+                    chips = std::max<uint32_t>(chips, _Table.frameGap);
+                }
+                Run(_level, chips);
+                _level ^= 1;
+            }
+
+            // Edge captured after counter is read would be earlier than mark, so check it again
+            const Counter now = _Timer::GetCounterValue();
+            if (written != (_Edges - _DmaChannel::RemainingTransfers()) % _Edges)
+                return;
+
+            // Long idle run is saturated (break is shorter anyway)
+            _since = std::min<uint32_t>(_since + static_cast<Counter>(now - _mark), 1u << 30);
+            _mark = now;
+            if (!_timedOut && _since >= _Table.frameGap * _chipTicks)
+            {
+                _timedOut = true;
+                Finish(_level);
+                _level = _Pin::IsSet() ? 1 : 0;
+            }
+        }
+
+        /**
+         * @brief Returns count of invalid frames (symbol mismatch or frame longer than _MaxWords)
+         *
+         * @returns Errors count
+         */
+        static uint32_t Errors()
+        {
+            return _errors;
+        }
+
+    private:
+        static uint32_t Chips(uint32_t ticks)
+        {
+            const uint32_t chips = (ticks + _chipTicks / 2) / _chipTicks;
+            return chips > 0 ? chips : 1;
+        }
+
+        static constexpr uint8_t FirstRun()
+        {
+            uint8_t run = 0;
+            while (run < _Table.frameStart.length && (_Table.frameStart.levels[run] & 1) == (_Table.frameStart.levels[0] & 1))
+                ++run;
+            return run;
+        }
+
+        static void Run(uint8_t level, uint32_t chips)
+        {
+            if (_phase != Hunt && chips >= _Table.frameGap && (_words > 0 || level != (_Table.idle & 1)))
+            {
+                Finish(level);
+            }
+
+            if (_phase == Hunt)
+            {
+                if constexpr (_Table.frameStart.length == 0)
+                {
+                    if (level == (_Table.idle & 1))
+                        return;
+                    Begin(WordStart);
+                }
+                else
+                {
+                    if (level != (_Table.frameStart.levels[0] & 1) || chips < FirstRun())
+                        return;
+                    Begin(FrameStart);
+                    // Longer first run (break) is absorbed if level changes inside frame start
+                    _offset = FirstRun();
+                    chips = _offset < _Table.frameStart.length ? 0 : chips - _offset;
+                    if (_offset == _Table.frameStart.length)
+                        Next();
+                }
+            }
+
+            for (; chips > 0 && _phase != Hunt; --chips)
+            {
+                Chip(level);
+            }
+        }
+
+        static void Begin(Phase phase)
+        {
+            _phase = phase;
+            _offset = 0;
+            _words = 0;
+            _bit = 0;
+            _value = 0;
+            if (phase == WordStart && _Table.wordStart.length == 0)
+                Next();
+        }
+
+        static void Chip(uint8_t level)
+        {
+            switch (_phase)
+            {
+            case FrameStart:
+                Match(_Table.frameStart, level);
+                break;
+            case WordStart:
+                // Idle between words
+                if (_offset == 0 && level != (_Table.wordStart.levels[0] & 1))
+                    return;
+                Match(_Table.wordStart, level);
+                break;
+            case Bits:
+                _zero = _zero && (_Table.zero.levels[_offset] & 1) == level;
+                _one = _one && (_Table.one.levels[_offset] & 1) == level;
+                if (++_offset < _Table.zero.length)
+                    return;
+                if (_zero == _one)
+                {
+                    Fail();
+                    return;
+                }
+                _value |= (_one ? 1u : 0u) << (_Table.lsbFirst ? _bit : _Table.wordBits - 1 - _bit);
+                _offset = 0;
+                _zero = _one = true;
+                if (++_bit == _Table.wordBits)
+                    Next();
+                break;
+            case WordStop:
+                Match(_Table.wordStop, level);
+                break;
+            default:
+                break;
+            }
+        }
+
+        static void Match(const Symbol& symbol, uint8_t level)
+        {
+            if ((symbol.levels[_offset] & 1) != level)
+            {
+                Fail();
+                return;
+            }
+            if (++_offset == symbol.length)
+                Next();
+        }
+
+        // Moves to next symbol (skipping empty ones)
+        static void Next()
+        {
+            _offset = 0;
+            switch (_phase)
+            {
+            case FrameStart:
+                _phase = WordStart;
+                break;
+            case WordStart:
+                _phase = Bits;
+                break;
+            case Bits:
+                _phase = WordStop;
+                break;
+            default:
+                if (_words >= _MaxWords)
+                {
+                    Fail();
+                    return;
+                }
+                _frame[_words++] = _value;
+                _phase = WordStart;
+                break;
+            }
+
+            if (_phase == Bits)
+            {
+                _bit = 0;
+                _value = 0;
+                _zero = _one = true;
+            }
+
+            const uint8_t length = _phase == WordStart ? _Table.wordStart.length : _phase == WordStop ? _Table.wordStop.length : 1;
+            if (length == 0)
+                Next();
+        }
+
+        static void Finish(uint8_t level)
+        {
+            // Trailing chips of the last word (bits equal to line level, stop bits) are merged with gap
+            const unsigned maxChips = (_Table.wordBits + 2) * decltype(_Table)::MaxLength;
+            for (unsigned chip = 0; chip < maxChips && InWord(); ++chip)
+            {
+                Chip(level);
+            }
+
+            if (_phase != Hunt && _words > 0 && _callback)
+                _callback(_frame, _words);
+            _phase = Hunt;
+        }
+
+        static bool InWord()
+        {
+            if (_phase == Bits)
+                return _bit > 0 || _offset > 0 || _Table.wordStart.length > 0;
+            return _phase == WordStop || (_phase == WordStart && _offset > 0);
+        }
+
+        static void Fail()
+        {
+            ++_errors;
+            _phase = Hunt;
+        }
+
+        static Counter _edges[_Edges];
+        static uint8_t _frame[_MaxWords];
+        static FrameCallback _callback;
+        static uint32_t _chipTicks;
+        static uint32_t _since;
+        static uint32_t _errors;
+        static unsigned _read;
+        static uint16_t _words;
+        static Counter _mark;
+        static Phase _phase;
+        static uint8_t _offset;
+        static uint8_t _bit;
+        static uint8_t _value;
+        static uint8_t _level;
+        static bool _zero;
+        static bool _one;
+        static bool _timedOut;
+    };
+
+    #define BIT_STREAM_DECODER_TEMPLATE_ARGS template <typename _Timer, auto _Table, typename _DmaChannel, unsigned _MaxWords, unsigned _Edges, typename _Pin>
+    #define BIT_STREAM_DECODER_TEMPLATE_QUALIFIER BitStreamDecoder<_Timer, _Table, _DmaChannel, _MaxWords, _Edges, _Pin>
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    typename BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::Counter BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_edges[_Edges];
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    uint8_t BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_frame[_MaxWords];
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    typename BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::FrameCallback BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_callback;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    uint32_t BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_chipTicks;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    uint32_t BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_since;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    uint32_t BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_errors;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    unsigned BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_read;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    uint16_t BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_words;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    typename BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::Counter BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_mark;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    typename BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::Phase BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_phase;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    uint8_t BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_offset;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    uint8_t BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_bit;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    uint8_t BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_value;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    uint8_t BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_level;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    bool BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_zero;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    bool BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_one;
+
+    BIT_STREAM_DECODER_TEMPLATE_ARGS
+    bool BIT_STREAM_DECODER_TEMPLATE_QUALIFIER::_timedOut;
+}
+
+#endif //! ZHELE_DRIVERS_BIT_STREAM_H
@@ -135,10 +135,32 @@ namespace Zhele::Drivers
         };
 
         static CalibrationData _calibrationData;
+        static uint8_t _rawTemperature[3];
+        static uint8_t _rawData[6];
         static Control _control;
         static Config _config;
 
     public:
+        /// Forced measurement state (see StartMeasurement and Poll)
+        enum class MeasurementState : uint8_t
+        {
+            Idle, ///< There is no measurement
+            Triggering, ///< Forced mode command is being sent
+            Converting, ///< Sensor converts
+            Reading, ///< Status and result are being read
+            Ready, ///< Result is ready (use LastMeasurement)
+            Error, ///< I2C error
+        };
+
+        /**
+         * @brief Measurement result (fixed-point)
+         */
+        struct Measurement
+        {
+            int32_t Temperature; ///< Temperature (0.01 degrees Celsius, 5123 is 51.23 C)
+            uint32_t Pressure; ///< Pressure (Pa in Q24.8 format, 24674867 is 24674867 / 256 = 96386.2 Pa)
+        };
+
         /**
          * @brief Init sensor
          * 
@@ -177,12 +199,273 @@ namespace Zhele::Drivers
          */
         static float ReadTemperature()
         {
-            int32_t raw = ReadRegister24(Register::TemperatureData);
+            return static_cast<float>(ReadTemperatureFixed()) / 100;
+        }
 
-            if (raw == 0x800000)
-                return 0;
+        /**
+         * @brief Read temperature (fixed-point)
+         * 
+         * @returns Temperature (0.01 degrees Celsius)
+         */
+        static int32_t ReadTemperatureFixed()
+        {
+            uint8_t data[3] = {0x80, 0, 0};
+            _I2CBus::Read(Bmp280Address, static_cast<uint16_t>(Register::TemperatureData), data, sizeof(data));
+
+            int32_t fineTemperature;
+            return CompensateTemperature(Raw20(data), fineTemperature);
+        }
+
+        /**
+         * @brief Read pressure and temperature (fixed-point)
+         * 
+         * @details
+         * Pressure and temperature registers (0xf7-0xfc) are read by one I2C transaction,
+         * so both values belong to the same measurement. Only integer arithmetic is used.
+         * 
+         * @param [out] measurement Measurement result
+         * 
+         * @retval true Success
+         * @retval false I2C error
+         */
+        static bool ReadMeasurement(Measurement& measurement)
+        {
+            uint8_t data[6];
+            if (_I2CBus::Read(Bmp280Address, static_cast<uint16_t>(Register::PressureData), data, sizeof(data)) != I2cStatus::Success)
+                return false;
+
+            measurement = ConvertMeasurement(data);
+            return true;
+        }
+
+        /**
+         * @brief Read pressure and temperature async (via I2C DMA or I2cBus queue)
+         * 
+         * @details
+         * Use LastMeasurement in callback to get values.
+         * 
+         * @param [in] callback Complete callback
+         * 
+         * @returns Operation status
+         */
+        static I2cStatus ReadMeasurementAsync(I2cCallback callback)
+        {
+            return _I2CBus::EnableAsyncRead(Bmp280Address, static_cast<uint16_t>(Register::PressureData), _rawData, sizeof(_rawData), I2cOpts::None, callback);
+        }
 
-            raw >>= 4;
+        /**
+         * @brief Measurement from last async read
+         * 
+         * @returns Measurement result
+         */
+        static Measurement LastMeasurement()
+        {
+            return ConvertMeasurement(_rawData);
+        }
+
+        /**
+         * @brief Read temperature async (via I2C DMA or I2cBus queue)
+         * 
+         * @details
+         * Use LastTemperature in callback to get value.
+         * 
+         * @param [in] callback Complete callback
+         * 
+         * @returns Operation status
+         */
+        static I2cStatus ReadTemperatureAsync(I2cCallback callback)
+        {
+            return _I2CBus::EnableAsyncRead(Bmp280Address, static_cast<uint16_t>(Register::TemperatureData), _rawTemperature, sizeof(_rawTemperature), I2cOpts::None, callback);
+        }
+
+        /**
+         * @brief Temperature from last async read
+         * 
+         * @returns Temperature
+         */
+        static float LastTemperature()
+        {
+            return static_cast<float>(LastTemperatureFixed()) / 100;
+        }
+
+        /**
+         * @brief Temperature from last async read (fixed-point)
+         * 
+         * @returns Temperature (0.01 degrees Celsius)
+         */
+        static int32_t LastTemperatureFixed()
+        {
+            int32_t fineTemperature;
+            return CompensateTemperature(Raw20(_rawTemperature), fineTemperature);
+        }
+
+        /**
+         * @brief Starts non-blocking forced measurement
+         * 
+         * @details
+         * Sensor is switched to forced mode (it returns to sleep mode after conversion),
+         * then Poll reads status with result registers without delays, so conversions
+         * of several sensors overlap.
+         * 
+         * @par Example
+         * @code
+         *  Sensor::StartMeasurement();
+         *  // Main loop (or timer)
+         *  if(Sensor::Poll() == Sensor::MeasurementState::Ready)
+         *  {
+         *      auto measurement = Sensor::LastMeasurement();
+         *      Sensor::StartMeasurement();
+         *  }
+         * @endcode
+         * 
+         * @retval I2cStatus::Success Measurement was started
+         * @retval I2cStatus::Busy Previous measurement is in progress or bus is busy (state is Idle)
+         * @retval Other I2C error (state is Error)
+         */
+        static I2cStatus StartMeasurement()
+        {
+            if (_state == MeasurementState::Triggering || _state == MeasurementState::Reading)
+                return I2cStatus::Busy;
+
+            // osrs_t[7:5], osrs_p[4:2], mode[1:0]
+            _forcedControl = static_cast<uint8_t>((_control.TemparatureOversampling << 5)
+                | (_control.PressureOversampling << 2)
+                | static_cast<uint8_t>(Mode::Forced));
+
+            _state = MeasurementState::Triggering;
+            I2cStatus status = _I2CBus::WriteAsync(Bmp280Address, static_cast<uint16_t>(Register::Control), &_forcedControl, 1, I2cOpts::None, TriggerComplete);
+            if (status != I2cStatus::Success)
+                _state = status == I2cStatus::Busy ? MeasurementState::Idle : MeasurementState::Error;
+
+            return status;
+        }
+
+        /**
+         * @brief Advances measurement state machine (never blocks)
+         * 
+         * @details
+         * While sensor converts, every call starts async read of status, control and result
+         * registers (0xf3-0xfc, one transaction), so call it not more often than it's needed.
+         * 
+         * @returns Measurement state
+         */
+        static MeasurementState Poll()
+        {
+            if (_state == MeasurementState::Converting) {
+                _state = MeasurementState::Reading;
+                I2cStatus status = _I2CBus::EnableAsyncRead(Bmp280Address, static_cast<uint16_t>(Register::Status), _pollData, sizeof(_pollData), I2cOpts::None, ReadComplete);
+                if (status != I2cStatus::Success)
+                    _state = status == I2cStatus::Busy ? MeasurementState::Converting : MeasurementState::Error;
+            }
+
+            return _state;
+        }
+
+        /**
+         * @brief Returns measurement state
+         * 
+         * @returns Measurement state
+         */
+        static MeasurementState GetMeasurementState()
+        {
+            return _state;
+        }
+
+    private:
+        /// Raw value of skipped measurement
+        static const int32_t Skipped = 0x80000;
+        /// Measuring flag of status register
+        static const uint8_t Measuring = 0x08;
+        /// Offset of result registers in polled data (0xf7 - 0xf3)
+        static const uint8_t PollDataOffset = 4;
+
+        static uint8_t _forcedControl; ///< Forced mode control register value
+        static uint8_t _pollData[10]; ///< Status, control, config and result registers
+        static volatile MeasurementState _state; ///< Measurement state
+
+        /**
+         * @brief Forced mode command complete handler
+         * 
+         * @param [in] status Operation status
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void TriggerComplete(I2cStatus status)
+        {
+            _state = status == I2cStatus::Success ? MeasurementState::Converting : MeasurementState::Error;
+        }
+
+        /**
+         * @brief Status and result read complete handler
+         * 
+         * @details
+         * Conversion is complete when measuring flag is cleared and sensor has returned to sleep mode.
+         * 
+         * @param [in] status Operation status
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void ReadComplete(I2cStatus status)
+        {
+            if (status != I2cStatus::Success) {
+                _state = MeasurementState::Error;
+                return;
+            }
+
+            if ((_pollData[0] & Measuring) || (_pollData[1] & 0x03) != static_cast<uint8_t>(Mode::Sleep)) {
+                _state = MeasurementState::Converting;
+                return;
+            }
+
+            for (unsigned i = 0; i < sizeof(_rawData); ++i)
+                _rawData[i] = _pollData[PollDataOffset + i];
+
+            _state = MeasurementState::Ready;
+        }
+
+        /**
+         * @brief Returns 20-bit raw value (msb, lsb, xlsb registers)
+         * 
+         * @param [in] data Registers values
+         * 
+         * @returns Raw value
+         */
+        static int32_t Raw20(const uint8_t* data)
+        {
+            return (static_cast<int32_t>(data[0]) << 12) | (static_cast<int32_t>(data[1]) << 4) | (data[2] >> 4);
+        }
+
+        /**
+         * @brief Converts raw pressure and temperature registers
+         * 
+         * @param [in] data Registers values (0xf7-0xfc)
+         * 
+         * @returns Measurement
+         */
+        static Measurement ConvertMeasurement(const uint8_t* data)
+        {
+            int32_t fineTemperature;
+            Measurement measurement;
+            measurement.Temperature = CompensateTemperature(Raw20(data + 3), fineTemperature);
+            measurement.Pressure = CompensatePressure(Raw20(data), fineTemperature);
+            return measurement;
+        }
+
+        /**
+         * @brief Compensates raw temperature (Bosch integer formula)
+         * 
+         * @param [in] raw Raw 20-bit value
+         * @param [out] fineTemperature Fine temperature (for pressure compensation)
+         * 
+         * @returns Temperature (0.01 degrees Celsius)
+         */
+        static int32_t CompensateTemperature(int32_t raw, int32_t& fineTemperature)
+        {
+            fineTemperature = 0;
+            if (raw == Skipped)
+                return 0;
 
             int32_t firstTemp = ((((raw >> 3) - (static_cast<int32_t>(_calibrationData.T1) << 1))) *
                     (static_cast<int32_t>(_calibrationData.T2))) >>
@@ -194,12 +477,44 @@ namespace Zhele::Drivers
                     (static_cast<int32_t>(_calibrationData.T3))) >>
                     14;
 
-            firstTemp += secondTemp;
+            fineTemperature = firstTemp + secondTemp;
 
-            return static_cast<float>((firstTemp * 5) >> 8) / 100;
+            return (fineTemperature * 5 + 128) >> 8;
+        }
+
+        /**
+         * @brief Compensates raw pressure (Bosch 64-bit integer formula)
+         * 
+         * @param [in] raw Raw 20-bit value
+         * @param [in] fineTemperature Fine temperature
+         * 
+         * @returns Pressure (Pa in Q24.8 format)
+         */
+        static uint32_t CompensatePressure(int32_t raw, int32_t fineTemperature)
+        {
+            if (raw == Skipped)
+                return 0;
+
+            int64_t firstVar = static_cast<int64_t>(fineTemperature) - 128000;
+            int64_t secondVar = firstVar * firstVar * _calibrationData.P6;
+            secondVar += (firstVar * _calibrationData.P5) << 17;
+            secondVar += static_cast<int64_t>(_calibrationData.P4) << 35;
+            firstVar = ((firstVar * firstVar * _calibrationData.P3) >> 8) + ((firstVar * _calibrationData.P2) << 12);
+            firstVar = (((static_cast<int64_t>(1) << 47) + firstVar) * _calibrationData.P1) >> 33;
+
+            // Avoid division by zero
+            if (firstVar == 0)
+                return 0;
+
+            int64_t pressure = 1048576 - raw;
+            pressure = (((pressure << 31) - secondVar) * 3125) / firstVar;
+            firstVar = (static_cast<int64_t>(_calibrationData.P9) * (pressure >> 13) * (pressure >> 13)) >> 25;
+            secondVar = (static_cast<int64_t>(_calibrationData.P8) * pressure) >> 19;
+            pressure = ((pressure + firstVar + secondVar) >> 8) + (static_cast<int64_t>(_calibrationData.P7) << 4);
+
+            return static_cast<uint32_t>(pressure);
         }
 
-    private:
         /**
          * @brief Software reset
          * 
@@ -222,23 +537,6 @@ namespace Zhele::Drivers
             _I2CBus::Read(Bmp280Address, static_cast<uint16_t>(Register::DigT1), reinterpret_cast<uint8_t*>(&_calibrationData), sizeof(CalibrationData));
         }
 
-        /**
-         * @brief Read 3-bytes register.
-         * 
-         * @param regAddress Register address
-         * 
-         * @return 3-bytes register value
-         */
-        static uint32_t ReadRegister24(Register regAddress)
-        {  
-            uint32_t value = 0;
-        
-            _I2CBus::Read(Bmp280Address, static_cast<uint16_t>(regAddress), (reinterpret_cast<uint8_t*>(&value)), 3);
-            std::swap(reinterpret_cast<uint8_t*>(&value)[0], reinterpret_cast<uint8_t*>(&value)[2]);
-
-            return value;
-        }
-
         /**
          * @brief Read 1-byte register value
          * 
@@ -273,6 +571,16 @@ namespace Zhele::Drivers
     template<typename _I2CBus>
     Bmp280<_I2CBus>::CalibrationData Bmp280<_I2CBus>::_calibrationData = {};
     template<typename _I2CBus>
+    uint8_t Bmp280<_I2CBus>::_rawTemperature[3] = {};
+    template<typename _I2CBus>
+    uint8_t Bmp280<_I2CBus>::_rawData[6] = {};
+    template<typename _I2CBus>
+    uint8_t Bmp280<_I2CBus>::_forcedControl = 0;
+    template<typename _I2CBus>
+    uint8_t Bmp280<_I2CBus>::_pollData[10] = {};
+    template<typename _I2CBus>
+    volatile typename Bmp280<_I2CBus>::MeasurementState Bmp280<_I2CBus>::_state = Bmp280<_I2CBus>::MeasurementState::Idle;
+    template<typename _I2CBus>
     Bmp280<_I2CBus>::Control Bmp280<_I2CBus>::_control = {
         .TemparatureOversampling = static_cast<uint8_t>(Bmp280<_I2CBus>::Sampling::X4),
         .PressureOversampling  = static_cast<uint8_t>(Bmp280<_I2CBus>::Sampling::X2),
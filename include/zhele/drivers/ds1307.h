@@ -10,14 +10,44 @@
 #ifndef ZHELE_DRIVERS_DS1307_H
 #define ZHELE_DRIVERS_DS1307_H
 
+#include <zhele/i2c.h>
+#include <zhele/iopins.h>
+
+#include <stdint.h>
+#include <type_traits>
+
 namespace Zhele::Drivers
 {
 	/**
 	 * @brief Class for DS1307 RTC
 	 * 
+	 * @details
+	 * Besides direct registers access class implements cached time: after @ref EnableCache
+	 * time is advanced on every falling edge of 1 Hz SQW output (it's seconds update moment)
+	 * and resynchronized by 7-byte async burst read, so @ref Now never touches I2C.
+	 * Sub-second part is measured by hardware timer that is restarted on every edge.
+	 * EXTI handler must call @ref IrqHandler. 
+	 * 
+	 * @par Example
+	 * @code
+	 *  using Rtc = Ds1307<I2c1, IO::Pb0, Exti0, Timers::Timer3>;
+	 *  Rtc::EnableCache();
+	 *
+	 *  extern "C" void EXTI0_IRQHandler()
+	 *  {
+	 *      Rtc::IrqHandler();
+	 *  }
+	 *
+	 *  auto now = Rtc::Now();
+	 *  printf("%lu.%03u", now.Epoch, now.Milliseconds);
+	 * @endcode
+	 * 
 	 * @tparam _I2CBus Target I2C type (See i2c.h)
+	 * @tparam _SqwPin SQW pin (required for cached time)
+	 * @tparam _SqwLine EXTI line of SQW pin (required for cached time)
+	 * @tparam _Timer Timer for sub-second interpolation (optional, milliseconds are zero without it)
 	 */
-	template <typename _I2CBus>
+	template <typename _I2CBus, typename _SqwPin = IO::NullPin, typename _SqwLine = void, typename _Timer = void>
 	class Ds1307
 	{
 		const static uint8_t  Ds1307Address = (0xD0 >> 1); ///< I2C address in 7-bit mode
@@ -45,6 +75,9 @@ namespace Zhele::Drivers
 			Out = 0x07
 		};
 
+		static const uint32_t SubsecondFrequency = 10000; ///< Sub-second timer frequency (prescaler fits 16 bits up to 655 MHz)
+		static const uint32_t UnixEpochDays = 719468; ///< Days from 0000-03-01 to 1970-01-01
+
 	public:
 		struct Time
 		{
@@ -57,6 +90,15 @@ namespace Zhele::Drivers
 			uint8_t Year; ///< Year parameter, 00 to 99, 00 is 2000 and 99 is 2099
 		};
 
+		/**
+		 * @brief Cached time
+		 */
+		struct Instant
+		{
+			uint32_t Epoch; ///< Unix time (seconds since 1970-01-01 00:00:00)
+			uint16_t Milliseconds; ///< Milliseconds, 0 to 999
+		};
+
 		/**
 		 * @brief Initialize MCU to work with RTC
 		 * 
@@ -78,20 +120,40 @@ namespace Zhele::Drivers
 			/* Read multi bytes */
 			_I2CBus::Read(Ds1307Address, 0x00, data, 7);
 
-			Time& time = reinterpret_cast<Time&>(data);
+			return ConvertDateTime(data);
+		}
 
-			/* Fill data */
-			time.Seconds = ConvertFromBcd(data[Registers::Seconds]);
-			time.Minutes = ConvertFromBcd(data[Registers::Minutes]);
-			time.Hours = ConvertFromBcd(data[Registers::Hours]);
-			time.Weekday = ConvertFromBcd(data[Registers::Weekday]);
-			time.Day = ConvertFromBcd(data[Registers::Day]);
-			time.Month = ConvertFromBcd(data[Registers::Month]);
-			time.Year = ConvertFromBcd(data[Registers::Year]);
+		/**
+		 * @brief Read date and time async (via I2C DMA or I2cBus queue)
+		 * 
+		 * @details
+		 * Use LastDateTime in callback to get value.
+		 * 
+		 * @param [in] callback Complete callback
+		 * 
+		 * @returns Operation status
+		 */
+		static I2cStatus ReadDateTimeAsync(I2cCallback callback)
+		{
+			return _I2CBus::EnableAsyncRead(Ds1307Address, 0x00, _data, sizeof(_data), I2cOpts::None, callback);
+		}
 
-			return time;
+		/**
+		 * @brief Returns date and time from last async read
+		 */
+		static Time LastDateTime()
+		{
+			return ConvertDateTime(_data);
 		}
 
+		/**
+		 * @brief Writes date and time
+		 * 
+		 * @param [in] time Date and time
+		 * 
+		 * @par Returns
+		 *	Nothing
+		 */
 		static void SetDateTime(const Time& time)
 		{
 			uint8_t data[7];
@@ -105,6 +167,160 @@ namespace Zhele::Drivers
 			data[Registers::Year] = ConvertToBcd(time.Year);
 
 			_I2CBus::Write(Ds1307Address, 0x00, data, 7);
+			_epoch = ToEpoch(time);
+		}
+
+		/**
+		 * @brief Enables cached time
+		 * 
+		 * @details
+		 * Method enables 1 Hz SQW output, reads time once (blocking),
+		 * configures EXTI line and starts sub-second timer.
+		 * SQW is open-drain output, so internal pull-up is enabled.
+		 * 
+		 * @par Returns
+		 *	Nothing
+		 */
+		static void EnableCache()
+		{
+			static_assert(!std::is_same_v<_SqwLine, void>, "Cached time requires EXTI line of SQW pin");
+
+			_SqwLine::DisableInterrupt();
+			_I2CBus::WriteU8(Ds1307Address, Control, 1 << Sqwe);
+			_epoch = ToEpoch(GetDateTime());
+
+			if constexpr (!std::is_same_v<_Timer, void>)
+			{
+				_Timer::Enable();
+				_Timer::Stop();
+				_Timer::SetPrescaler(static_cast<typename _Timer::Prescaler>(_Timer::GetClockFreq() / SubsecondFrequency - 1));
+				_Timer::SetPeriod(static_cast<typename _Timer::Counter>(~0u));
+				_Timer::ResetCounterValue();
+				_Timer::Start();
+			}
+
+			_SqwLine::template InitPin<_SqwPin>(_SqwPin::PullMode::PullUp);
+			_SqwLine::template Init<_SqwLine::Falling, typename _SqwPin::Port>();
+			_SqwLine::ClearInterruptFlag();
+			_SqwLine::EnableInterrupt();
+		}
+
+		/**
+		 * @brief Returns cached time
+		 * 
+		 * @details
+		 * Method doesn't use I2C, it's safe to call it from interrupts
+		 * with priority not higher than EXTI line priority.
+		 * 
+		 * @returns Unix time and milliseconds
+		 */
+		static Instant Now()
+		{
+			uint32_t epoch;
+			uint32_t ticks;
+			do
+			{
+				epoch = _epoch;
+				ticks = SubsecondTicks();
+			} while (epoch != _epoch);
+
+			uint32_t milliseconds = ticks / (SubsecondFrequency / 1000);
+			return {epoch, static_cast<uint16_t>(milliseconds < 999 ? milliseconds : 999)};
+		}
+
+		/**
+		 * @brief Returns cached date and time
+		 * 
+		 * @returns Date and time
+		 */
+		static Time NowDateTime()
+		{
+			return FromEpoch(Now().Epoch);
+		}
+
+		/**
+		 * @brief SQW pin interrupt handler. Call it from EXTI interrupt handler.
+		 * 
+		 * @details
+		 * Cached time is advanced immediately, then burst read is started to resynchronize it.
+		 * If I2C is busy, resynchronization is skipped until next second.
+		 * 
+		 * @par Returns
+		 *	Nothing
+		 */
+		static void IrqHandler()
+		{
+			_SqwLine::ClearInterruptFlag();
+
+			if constexpr (!std::is_same_v<_Timer, void>)
+			{
+				_Timer::ResetCounterValue();
+			}
+			_epoch = _epoch + 1;
+
+			_I2CBus::EnableAsyncRead(Ds1307Address, 0x00, _cacheData, sizeof(_cacheData), I2cOpts::None, CacheReadComplete);
+		}
+
+		/**
+		 * @brief Converts date and time to Unix time
+		 * 
+		 * @details
+		 * Conversion uses only integer arithmetic without loops and tables (days from civil algorithm).
+		 * Weekday is ignored.
+		 * 
+		 * @param [in] time Date and time
+		 * 
+		 * @returns Seconds since 1970-01-01 00:00:00
+		 */
+		static constexpr uint32_t ToEpoch(const Time& time)
+		{
+			// Year starts from March, so leap day is last day of year
+			const uint32_t year = 2000u + time.Year - (time.Month <= 2 ? 1 : 0);
+			const uint32_t era = year / 400;
+			const uint32_t yearOfEra = year - era * 400;
+			const uint32_t dayOfYear = (153 * (time.Month > 2 ? time.Month - 3 : time.Month + 9) + 2) / 5 + time.Day - 1;
+			const uint32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+			const uint32_t days = era * 146097 + dayOfEra - UnixEpochDays;
+
+			return days * 86400 + time.Hours * 3600 + time.Minutes * 60 + time.Seconds;
+		}
+
+		/**
+		 * @brief Converts Unix time to date and time
+		 * 
+		 * @details
+		 * Conversion uses only integer arithmetic without loops and tables (civil from days algorithm).
+		 * Weekday is ISO 8601 number (1 is Monday, 7 is Sunday).
+		 * 
+		 * @param [in] epoch Seconds since 1970-01-01 00:00:00 (from 2000 to 2099 year)
+		 * 
+		 * @returns Date and time
+		 */
+		static constexpr Time FromEpoch(uint32_t epoch)
+		{
+			const uint32_t days = epoch / 86400;
+			const uint32_t seconds = epoch % 86400;
+
+			const uint32_t shiftedDays = days + UnixEpochDays;
+			const uint32_t era = shiftedDays / 146097;
+			const uint32_t dayOfEra = shiftedDays - era * 146097;
+			const uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+			const uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+			const uint32_t monthIndex = (5 * dayOfYear + 2) / 153;
+			const uint32_t month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+			const uint32_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+			Time time {};
+			time.Seconds = static_cast<uint8_t>(seconds % 60);
+			time.Minutes = static_cast<uint8_t>(seconds / 60 % 60);
+			time.Hours = static_cast<uint8_t>(seconds / 3600);
+			// 1970-01-01 is Thursday
+			time.Weekday = static_cast<uint8_t>((days + 3) % 7 + 1);
+			time.Day = static_cast<uint8_t>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+			time.Month = static_cast<uint8_t>(month);
+			time.Year = static_cast<uint8_t>(year - 2000);
+
+			return time;
 		}
 
 		/**
@@ -269,6 +485,66 @@ namespace Zhele::Drivers
 		}
 
 	private:
+		static uint8_t _data[7]; ///< Raw data of last async read
+		static uint8_t _cacheData[7]; ///< Raw data of last cache resynchronization
+		static volatile uint32_t _epoch; ///< Cached time
+
+		/**
+		 * @brief Returns sub-second timer value
+		 * 
+		 * @returns Ticks since last SQW edge
+		 */
+		static uint32_t SubsecondTicks()
+		{
+			if constexpr (!std::is_same_v<_Timer, void>)
+			{
+				return _Timer::GetCounterValue();
+			}
+			else
+			{
+				return 0;
+			}
+		}
+
+		/**
+		 * @brief Cache burst read complete callback
+		 * 
+		 * @param [in] status Read status
+		 * 
+		 * @par Returns
+		 *	Nothing
+		 */
+		static void CacheReadComplete(I2cStatus status)
+		{
+			if (status == I2cStatus::Success)
+			{
+				_epoch = ToEpoch(ConvertDateTime(_cacheData));
+			}
+		}
+
+		/**
+		 * @brief Convert registers data to Time struct
+		 * 
+		 * @param [in] data Registers data (7 bytes)
+		 * 
+		 * @returns Date and time
+		 */
+		static Time ConvertDateTime(const uint8_t* data)
+		{
+			Time time;
+
+			// Mask clock halt and 12/24 mode bits
+			time.Seconds = ConvertFromBcd(data[Registers::Seconds] & 0x7f);
+			time.Minutes = ConvertFromBcd(data[Registers::Minutes]);
+			time.Hours = ConvertFromBcd(data[Registers::Hours] & 0x3f);
+			time.Weekday = ConvertFromBcd(data[Registers::Weekday]);
+			time.Day = ConvertFromBcd(data[Registers::Day]);
+			time.Month = ConvertFromBcd(data[Registers::Month]);
+			time.Year = ConvertFromBcd(data[Registers::Year]);
+
+			return time;
+		}
+
 		/**
 		 * @brief Convert from bcd value
 		 * 
@@ -280,7 +556,7 @@ namespace Zhele::Drivers
 		 * 
 		 * @returns Decoded (converted) from bcd value
 		 */
-		static uint8_t ConvertFromBcd(uint8_t bcd)
+		static constexpr uint8_t ConvertFromBcd(uint8_t bcd)
 		{
 			return 10 * (bcd >> 4) + (bcd & 0x0f);
 		}
@@ -296,10 +572,19 @@ namespace Zhele::Drivers
 		 * 
 		 * @returns Encoded (converted) to bcd value
 		 */
-		static uint8_t ConvertToBcd(uint8_t bin)
+		static constexpr uint8_t ConvertToBcd(uint8_t bin)
 		{	
 			return (bin / 10) << 4 | (bin % 10);
 		}
 	};
+
+	template <typename _I2CBus, typename _SqwPin, typename _SqwLine, typename _Timer>
+	uint8_t Ds1307<_I2CBus, _SqwPin, _SqwLine, _Timer>::_data[7] = {};
+
+	template <typename _I2CBus, typename _SqwPin, typename _SqwLine, typename _Timer>
+	uint8_t Ds1307<_I2CBus, _SqwPin, _SqwLine, _Timer>::_cacheData[7] = {};
+
+	template <typename _I2CBus, typename _SqwPin, typename _SqwLine, typename _Timer>
+	volatile uint32_t Ds1307<_I2CBus, _SqwPin, _SqwLine, _Timer>::_epoch = 0;
 }
 #endif // !ZHELE_DRIVERS_DS1307_H
\ No newline at end of file
@@ -66,6 +66,19 @@ namespace Zhele::Drivers
             };
         };
 
+        /**
+         * @brief Convert result (fixed-point)
+         */
+        struct FixedConvertResult
+        {
+            bool Success;
+            union
+            {
+                int32_t Temperature; ///< Temperature (0.01 degrees Celsius)
+                typename ConvertResult::ConvertErrors Error;
+            };
+        };
+
         /**
          * @brief Initialize communicate line and sensor
          * 
@@ -109,26 +122,32 @@ namespace Zhele::Drivers
          */
         static ConvertResult Read(const uint8_t* rom = nullptr)
         {
-            Scratchpad scratchpad;
+            int16_t raw;
+            typename ConvertResult::ConvertErrors error;
 
-            if(!_Bus::Reset())
-                return ConvertResult{false, ConvertResult::ConvertErrors::PrecenseError};
+            if(!ReadRaw(rom, raw, error))
+                return ConvertResult{false, {.Error = error}};
 
-            rom == nullptr
-                ? _Bus::SkipRom()
-                : _Bus::MatchRom(rom);
-            
-            _Bus::WriteByte(Commands::ReadScratchPad);
-            _Bus::ReadBytes(&scratchpad, sizeof(scratchpad));
+            return ConvertResult{true, {.Temperature = static_cast<float>(raw) * Resolution}};
+        }
 
-            if(CalculateCrc(&scratchpad, 8) != scratchpad.Crc)
-                return ConvertResult{false, ConvertResult::ConvertErrors::CrcError};
+        /**
+         * @brief Read convert (measure) result (fixed-point)
+         * 
+         * @param [in, opt] rom Sensor ROM
+         * 
+         * @returns Conversion result (temperature in 0.01 degrees Celsius)
+         */
+        static FixedConvertResult ReadFixed(const uint8_t* rom = nullptr)
+        {
+            int16_t raw;
+            typename ConvertResult::ConvertErrors error;
 
-            uint8_t resolution = (scratchpad.Configuration >> 5) & 0b11;
-            scratchpad.Lsb &= 0xff << (3 - resolution);
-            float temperature = static_cast<float>(*(reinterpret_cast<int16_t*>(&scratchpad.Lsb))) * Resolution;
+            if(!ReadRaw(rom, raw, error))
+                return FixedConvertResult{false, {.Error = error}};
 
-            return ConvertResult{true, temperature};
+            // Raw value is in 1/16 degrees
+            return FixedConvertResult{true, {.Temperature = static_cast<int32_t>(raw) * 25 / 4}};
         }
 
         /**
@@ -144,6 +163,45 @@ namespace Zhele::Drivers
         }
 
     private:
+        /**
+         * @brief Reads raw temperature from scratchpad
+         * 
+         * @param [in] rom Sensor ROM (nullptr for SKIP ROM)
+         * @param [out] raw Raw temperature (1/16 degrees, unused bits are cleared)
+         * @param [out] error Error
+         * 
+         * @retval true Success
+         * @retval false Error
+         */
+        static bool ReadRaw(const uint8_t* rom, int16_t& raw, typename ConvertResult::ConvertErrors& error)
+        {
+            Scratchpad scratchpad;
+
+            if(!_Bus::Reset())
+            {
+                error = ConvertResult::ConvertErrors::PrecenseError;
+                return false;
+            }
+
+            rom == nullptr
+                ? _Bus::SkipRom()
+                : _Bus::MatchRom(rom);
+            
+            _Bus::WriteByte(Commands::ReadScratchPad);
+            _Bus::ReadBytes(&scratchpad, sizeof(scratchpad));
+
+            if(CalculateCrc(&scratchpad, 8) != scratchpad.Crc)
+            {
+                error = ConvertResult::ConvertErrors::CrcError;
+                return false;
+            }
+
+            uint8_t resolution = (scratchpad.Configuration >> 5) & 0b11;
+            scratchpad.Lsb &= 0xff << (3 - resolution);
+            raw = static_cast<int16_t>((scratchpad.Msb << 8) | scratchpad.Lsb);
+            return true;
+        }
+
         static uint8_t CalculateCrc(const void* data, uint8_t size)
         {
             const uint8_t* castedData = reinterpret_cast<const uint8_t*>(data);
@@ -163,6 +221,166 @@ namespace Zhele::Drivers
             return crc;
         }
     };
+
+    /**
+     * @brief Implements array of DS18B20 sensors on one line
+     * 
+     * @details
+     * Sensors are enumerated by ROM search into static table. All sensors convert simultaneously
+     * (SKIP ROM + CONVERT T broadcast), then scratchpads are read one by one (MATCH ROM) with CRC check,
+     * so cycle takes one conversion time instead of one per sensor.
+     * 
+     * @par Example
+     * @code
+     *  using Sensors = Drivers::Ds18b20Array<OneWireBus, 20>;
+     *  Sensors::Init();
+     *  Sensors::StartAll();
+     *  while(!Sensors::AllDone());
+     *  Sensors::FixedConvertResult results[20];
+     *  Sensors::ReadAll(results);
+     * @endcode
+     * 
+     * @tparam _Bus One-wire bus
+     * @tparam _MaxDevices Max sensors count (table size)
+     */
+    template <typename _Bus, unsigned _MaxDevices = 8>
+    class Ds18b20Array
+    {
+        using Sensor = Ds18b20<_Bus>;
+        static const uint8_t FamilyCode = 0x28; ///< DS18B20 family code (first ROM byte)
+    public:
+        using ConvertResult = typename Sensor::ConvertResult;
+        using FixedConvertResult = typename Sensor::FixedConvertResult;
+
+        /**
+         * @brief Initialize line and enumerate sensors
+         * 
+         * @returns Found sensors count
+         */
+        static unsigned Init()
+        {
+            Sensor::Init();
+            return Enumerate();
+        }
+
+        /**
+         * @brief Enumerate sensors (fill ROM table)
+         * 
+         * @details
+         * Devices with other family codes are skipped. If there are more than _MaxDevices sensors,
+         * only first of them are stored.
+         * 
+         * @returns Found sensors count
+         */
+        static unsigned Enumerate()
+        {
+            uint8_t rom[8];
+            _count = 0;
+
+            for (bool found = _Bus::SearchFirst(rom); found && _count < _MaxDevices; found = _Bus::SearchNext(rom))
+            {
+                if (rom[0] != FamilyCode)
+                    continue;
+
+                for (uint8_t i = 0; i < 8; ++i)
+                    _roms[_count][i] = rom[i];
+                ++_count;
+            }
+
+            return _count;
+        }
+
+        /**
+         * @brief Returns sensors count
+         * 
+         * @returns Sensors count
+         */
+        static unsigned Count()
+        {
+            return _count;
+        }
+
+        /**
+         * @brief Returns sensor ROM
+         * 
+         * @param [in] index Sensor index
+         * 
+         * @returns ROM (8 bytes)
+         */
+        static const uint8_t* Rom(unsigned index)
+        {
+            return _roms[index];
+        }
+
+        /**
+         * @brief Starts conversion on all sensors (SKIP ROM broadcast)
+         * 
+         * @retval true Success
+         * @retval false No presence
+         */
+        static bool StartAll()
+        {
+            return Sensor::Start();
+        }
+
+        /**
+         * @brief Check that all sensors complete conversion
+         * 
+         * @retval true All sensors complete conversion
+         * @retval false Conversion is in progress
+         */
+        static bool AllDone()
+        {
+            return Sensor::AllDone();
+        }
+
+        /**
+         * @brief Read sensor result
+         * 
+         * @param [in] index Sensor index
+         * 
+         * @returns Conversion result
+         */
+        static ConvertResult Read(unsigned index)
+        {
+            return Sensor::Read(_roms[index]);
+        }
+
+        /**
+         * @brief Read sensor result (fixed-point)
+         * 
+         * @param [in] index Sensor index
+         * 
+         * @returns Conversion result (temperature in 0.01 degrees Celsius)
+         */
+        static FixedConvertResult ReadFixed(unsigned index)
+        {
+            return Sensor::ReadFixed(_roms[index]);
+        }
+
+        /**
+         * @brief Read results of all sensors (fixed-point)
+         * 
+         * @param [out] results Results (Count() items)
+         * 
+         * @returns Successfully read results count
+         */
+        static unsigned ReadAll(FixedConvertResult* results)
+        {
+            unsigned success = 0;
+            for (unsigned i = 0; i < _count; ++i)
+            {
+                results[i] = Sensor::ReadFixed(_roms[i]);
+                if (results[i].Success)
+                    ++success;
+            }
+            return success;
+        }
+
+    private:
+        static inline uint8_t _roms[_MaxDevices][8] = {}; ///< Sensors ROMs
+        static inline unsigned _count = 0; ///< Sensors count
+    };
 }
 
 #endif //! ZHELE_DS18B20_H
\ No newline at end of file
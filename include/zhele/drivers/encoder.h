@@ -12,7 +12,12 @@
 
 #include "../common/template_utils/type_list.h"
 
+#include <zhele/iopins.h>
+#include <zhele/timer_chain.h>
+
 #include <cstdint>
+#include <optional>
+#include <type_traits>
 
 namespace Zhele::Drivers
 {
@@ -22,16 +27,28 @@ namespace Zhele::Drivers
      * @tparam _Timer GP timer instance
      * @tparam _PinA Input pin A (for 1 channel)
      * @tparam _PinB Input pin B (for 2 channel)
+     * @tparam _MaxValue Max encoder value
+     * @tparam _IndexPin Index pulse pin (for 3 channel, optional)
      */
     template <typename _Timer,
             typename _PinA = typename _Timer::InputCapture<0>::Pins::template Pin<0>,
             typename _PinB = typename _Timer::InputCapture<1>::Pins::template Pin<0>,
-            uint16_t _MaxValue = 0xffff>
+            uint16_t _MaxValue = 0xffff,
+            typename _IndexPin = IO::NullPin>
     class Encoder
     {
         using InputA = typename _Timer::InputCapture<0>;
         using InputB = typename _Timer::InputCapture<1>;
+        using InputIndex = typename _Timer::InputCapture<2>;
     public:
+        using Timer = _Timer;
+
+        /// Index pulse is latched by channel 3
+        static constexpr bool HasIndex = !std::is_same_v<_IndexPin, IO::NullPin>;
+
+        /// Counter modulo (counter counts 2 steps per encoder period)
+        static constexpr uint32_t CounterModulo = (_MaxValue * 2u + 2u) < 0x10000u ? (_MaxValue * 2u + 2u) : 0x10000u;
+
         /**
          * @brief Init encoder
          * 
@@ -53,6 +70,15 @@ namespace Zhele::Drivers
             InputB::SetCaptureMode(InputB::CaptureMode::Direct);
             InputB::template SelectPins<_PinB>();
 
+            if constexpr (HasIndex)
+            {
+                // Channel 3 latches counter on index pulse rising edge
+                InputIndex::SetCaptureMode(InputIndex::CaptureMode::Direct);
+                InputIndex::SetCapturePolarity(InputIndex::CapturePolarity::RisingEdge);
+                InputIndex::Enable();
+                InputIndex::template SelectPins<_IndexPin>();
+            }
+
             _Timer::Start();
         }
 
@@ -92,6 +118,260 @@ namespace Zhele::Drivers
                 ? (counter - 1) >> 1
                 : ((counter + 2) >> 1) % (_MaxValue + 1);
         }
+
+        /**
+         * @brief Returns signed difference of two counter values
+         * 
+         * @details
+         * Difference is wrapped to half of counter modulo, so it's correct
+         * if counter moves by less than half of modulo between reads.
+         * 
+         * @param [in] current Current counter value
+         * @param [in] previous Previous counter value
+         * 
+         * @returns Counter steps from previous to current value
+         */
+        static constexpr int32_t CounterDelta(uint32_t current, uint32_t previous)
+        {
+            int32_t delta = static_cast<int32_t>(current) - static_cast<int32_t>(previous);
+            if (delta >= static_cast<int32_t>(CounterModulo / 2))
+                delta -= CounterModulo;
+            else if (delta < -static_cast<int32_t>(CounterModulo / 2))
+                delta += CounterModulo;
+            return delta;
+        }
+    };
+
+    /**
+     * @brief Implements extended encoder position, velocity estimation and index latching
+     * 
+     * @details
+     * Call @ref Update from fixed-rate control interrupt: it takes few dozens of cycles
+     * without 64-bit arithmetic (one 32-bit division at low speed).
+     * 
+     * Position is extended by counter difference between updates, so counter shouldn't move
+     * by more than half of its modulo during sample period. Position and velocity are in counter steps
+     * (2 steps per encoder period in encoder mode 2).
+     * 
+     * Velocity is estimated by counter delta per sample at high speed. At low speed it's measured
+     * by period between TI1 edges: encoder timer channel 1 latches counter on every edge and
+     * generates TRGO pulse, so time base timer latches its counter by the same edge (capture on TRC).
+     * Time base timer must have internal trigger connected to encoder timer TRGO (it's resolved by @ref Timers::TimerChain).
+     * If there are no edges, velocity decays as 1 / time since last edge and it's zero after 1 second.
+     * 
+     * Index pulse position is latched by encoder timer channel 3 (encoder _IndexPin).
+     * 
+     * @par Example
+     * @code
+     *  using Enc = Encoder<Timers::Timer3>;
+     *  // 1 MHz ticks for 84 MHz timer clock, control loop at 10 kHz
+     *  using Tracker = EncoderTracker<Enc, Timers::Timer4, 0, 10000>;
+     *
+     *  Enc::Init();
+     *  Tracker::Init(83);
+     *
+     *  // In control loop interrupt
+     *  Tracker::Update();
+     *  int32_t position = Tracker::GetPosition();
+     *  int32_t velocity = Tracker::GetVelocity();
+     * @endcode
+     * 
+     * @tparam _Encoder Encoder
+     * @tparam _TimeBase Time base timer
+     * @tparam _TimeBaseChannel Time base timer capture channel
+     * @tparam _SampleRate Update call rate (Hz)
+     * @tparam _Position Position type (int32_t or int64_t)
+     */
+    template<typename _Encoder, typename _TimeBase, unsigned _TimeBaseChannel = 0, uint32_t _SampleRate = 1000, typename _Position = int32_t>
+    class EncoderTracker
+    {
+        using EncoderTimer = typename _Encoder::Timer;
+        using EdgeCapture = typename EncoderTimer::template InputCapture<0>;
+        using IndexCapture = typename EncoderTimer::template InputCapture<2>;
+        using TimeCapture = typename _TimeBase::template InputCapture<_TimeBaseChannel>;
+        using Counter = typename _TimeBase::Counter;
+        using Chain = Timers::TimerChain<EncoderTimer, _TimeBase>;
+
+        /// Counter delta per sample to use delta-count velocity
+        static const int32_t DeltaThreshold = 4;
+    public:
+        /**
+         * @brief Init time base and edge latching (init encoder before)
+         * 
+         * @param [in] prescaler Time base prescaler (tick is prescaler + 1 timer clocks, tick frequency should not exceed 100 MHz)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(typename _TimeBase::Prescaler prescaler)
+        {
+            _tickFrequency = _TimeBase::GetClockFreq() / (prescaler + 1);
+
+            // TRGO pulse on every channel 1 capture (TI1 edge)
+            EncoderTimer::SetMasterMode(EncoderTimer::MasterMode::ComparePulse);
+
+            _TimeBase::Enable();
+            _TimeBase::Stop();
+            _TimeBase::SetPrescaler(prescaler);
+            _TimeBase::SetPeriod(static_cast<Counter>(~0u));
+            _TimeBase::SlaveMode::SelectTrigger(Chain::Trigger);
+            TimeCapture::SetCaptureMode(TimeCapture::CaptureMode::CaptureTrc);
+            TimeCapture::SetCapturePolarity(TimeCapture::CapturePolarity::RisingEdge);
+            TimeCapture::Enable();
+            _TimeBase::ResetCounterValue();
+            _TimeBase::Start();
+
+            _previousTime = _TimeBase::GetCounterValue();
+            _previousCounter = EncoderTimer::GetCounterValue();
+            (void)EdgeCapture::GetValue();
+            if constexpr (_Encoder::HasIndex)
+                IndexCapture::ClearInterruptFlag();
+            _hasEdge = false;
+            _edgeInterval = 0;
+            _velocity = 0;
+        }
+
+        /**
+         * @brief Updates position and velocity (call it from fixed-rate control interrupt)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Update()
+        {
+            // Captures should be read before counters, so they are not newer than counters
+            bool edge = EdgeCapture::IsInterrupt();
+            Counter edgeTime;
+            uint32_t edgeCounter;
+            do
+            {
+                edgeTime = TimeCapture::GetValue();
+                // Capture register read clears flag
+                edgeCounter = EdgeCapture::GetValue();
+            } while (edgeTime != TimeCapture::GetValue());
+
+            bool index = false;
+            uint32_t indexCounter = 0;
+            if constexpr (_Encoder::HasIndex)
+            {
+                index = IndexCapture::IsInterrupt();
+                if (index)
+                    indexCounter = IndexCapture::GetValue();
+            }
+
+            Counter now = _TimeBase::GetCounterValue();
+            uint32_t counter = EncoderTimer::GetCounterValue();
+
+            _time += static_cast<Counter>(now - _previousTime);
+            _previousTime = now;
+
+            int32_t delta = _Encoder::CounterDelta(counter, _previousCounter);
+            _previousCounter = counter;
+            _position += delta;
+
+            if (edge)
+            {
+                uint32_t time = _time - static_cast<Counter>(now - edgeTime);
+                _Position position = _position - _Encoder::CounterDelta(counter, edgeCounter);
+                if (_hasEdge)
+                {
+                    _edgeInterval = time - _edgeTime;
+                    _edgeDelta = static_cast<int32_t>(position - _edgePosition);
+                }
+                _hasEdge = true;
+                _edgeTime = time;
+                _edgePosition = position;
+            }
+
+            if (index)
+            {
+                _index = _position - _Encoder::CounterDelta(counter, indexCounter);
+                _indexLatched = true;
+            }
+
+            if (delta >= DeltaThreshold || delta <= -DeltaThreshold || _edgeInterval == 0)
+            {
+                _velocity = delta * static_cast<int32_t>(_SampleRate);
+                return;
+            }
+
+            uint32_t sinceEdge = _time - _edgeTime;
+            if (sinceEdge >= _tickFrequency)
+            {
+                // Stopped
+                _edgeInterval = 0;
+                _velocity = 0;
+                return;
+            }
+
+            uint32_t interval = sinceEdge > _edgeInterval ? sinceEdge : _edgeInterval;
+            _velocity = _edgeDelta * static_cast<int32_t>(_tickFrequency) / static_cast<int32_t>(interval);
+        }
+
+        /**
+         * @brief Returns extended position
+         * 
+         * @returns Position (counter steps)
+         */
+        static _Position GetPosition()
+        {
+            return _position;
+        }
+
+        /**
+         * @brief Sets extended position (for example, after homing)
+         * 
+         * @param [in] position New position
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetPosition(_Position position)
+        {
+            _edgePosition += position - _position;
+            _position = position;
+        }
+
+        /**
+         * @brief Returns velocity estimated by last update
+         * 
+         * @returns Velocity (counter steps per second)
+         */
+        static int32_t GetVelocity()
+        {
+            return _velocity;
+        }
+
+        /**
+         * @brief Returns position of last index pulse (and resets it)
+         * 
+         * @returns Index pulse position or nullopt if there was no index pulse since previous call
+         */
+        static std::optional<_Position> TakeIndex()
+        {
+            if (!_indexLatched)
+                return std::nullopt;
+
+            _indexLatched = false;
+            return _index;
+        }
+
+    private:
+        static inline uint32_t _tickFrequency = 0; ///< Time base tick frequency
+        static inline Counter _previousTime = 0; ///< Time base counter on previous update
+        static inline uint32_t _previousCounter = 0; ///< Encoder counter on previous update
+        static inline uint32_t _time = 0; ///< Extended time base counter
+        static inline _Position _position = 0; ///< Extended position
+        static inline int32_t _velocity = 0; ///< Estimated velocity
+
+        static inline bool _hasEdge = false; ///< Edge was latched
+        static inline uint32_t _edgeTime = 0; ///< Extended time of last edge
+        static inline _Position _edgePosition = 0; ///< Position of last edge
+        static inline uint32_t _edgeInterval = 0; ///< Time between two last edges (0 if unknown)
+        static inline int32_t _edgeDelta = 0; ///< Position delta between two last edges
+
+        static inline _Position _index = 0; ///< Position of last index pulse
+        static inline bool _indexLatched = false; ///< Index pulse was latched
     };
 }
 #endif // !ZHELE_DRIVERS_ENCODER_H
@@ -0,0 +1,497 @@
+/**
+ * @file
+ * Implements FAT32 file system over block device
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_FAT32_H
+#define ZHELE_DRIVERS_FAT32_H
+
+#include <algorithm>
+#include <bit>
+#include <stdint.h>
+#include <string.h>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief FAT32 file system (reader/writer) over block device
+     *
+     * @details
+     * Volume is found on first primary partition with FAT32 type (or on whole device without MBR).
+     * Names are 8.3 (long names are skipped on search and are not created), path components
+     * are separated by '/', directories must exist.
+     *
+     * Sectors are cached by write-back cache with _CacheSectors sectors (LRU replacement),
+     * FAT sectors are written to all FAT copies. Clusters chain is prefetched from cached FAT sector:
+     * file knows contiguous run of clusters after current one, so sector-aligned part of read/write request
+     * (from/to 4-bytes aligned buffer) is transferred by one multiple block command directly from/to
+     * user buffer. Write request allocates clusters for whole request at once (contiguous, if possible).
+     * For append-only logs use @ref File::Preallocate: it allocates contiguous clusters run, so log
+     * is written by multiple block writes without FAT updates. Unused preallocated clusters are freed by
+     * @ref File::Close.
+     *
+     * Data is on card after @ref File::Sync or @ref File::Close. Every file object works with own position,
+     * don't open one file by two objects for write.
+     *
+     * Block device interface (@ref SdCard, @ref SdioCard):
+     *  - static bool ReadBlock(uint8_t* buffer, uint32_t lba)
+     *  - static bool WriteBlock(const uint8_t* buffer, uint32_t lba)
+     *  - static bool ReadMultipleBlock(uint8_t* buffer, uint32_t lba, uint32_t count)
+     *  - static bool WriteMultipleBlock(const uint8_t* buffer, uint32_t lba, uint32_t count)
+     *
+     * @par Example
+     * @code
+     *  using Card = Drivers::SdioCard<>;
+     *  using Fs = Drivers::Fat32<Card>;
+     *  ...
+     *  if (Card::Detect() != Drivers::SdCardNone && Fs::Mount())
+     *  {
+     *      Fs::File log;
+     *      log.Open("LOGS/DATA.CSV", Fs::Create | Fs::Append);
+     *      log.Preallocate(log.Size() + 1024 * 1024);
+     *      log.Write(line, lineLength);
+     *      ...
+     *      log.Close();
+     *  }
+     * @endcode
+     *
+     * @tparam _BlockDevice Block device (512 bytes blocks)
+     * @tparam _CacheSectors Cache size (in sectors)
+     */
+    template<typename _BlockDevice, unsigned _CacheSectors = 2>
+    class Fat32
+    {
+        static_assert(_CacheSectors > 0, "Cache must have at least one sector");
+
+        static const uint32_t SectorSize = 512;
+        static const uint32_t SectorShift = 9;
+        static const uint32_t NoSector = 0xffffffff;
+        static const uint32_t ClusterMask = 0x0fffffff; ///< FAT entry bits (high 4 bits are reserved)
+        static const uint32_t EndOfChain = 0x0fffffff;
+        static const uint32_t EntrySize = 32;
+
+        static const uint8_t AttrReadOnly = 0x01;
+        static const uint8_t AttrVolumeId = 0x08;
+        static const uint8_t AttrDirectory = 0x10;
+        static const uint8_t AttrArchive = 0x20;
+
+        /// Sector access type
+        enum class Access : uint8_t
+        {
+            Read, ///< Sector is read
+            Modify, ///< Sector is read and modified
+            Overwrite ///< Sector is rewritten fully (it's not read, starts with zeroes)
+        };
+
+        /// Cache sector
+        struct CacheSector
+        {
+            alignas(4) uint8_t Data[SectorSize]; ///< Data
+            uint32_t Lba; ///< Sector address
+            uint32_t LastUse; ///< Last use tick (for LRU replacement)
+            bool Dirty; ///< Sector is modified
+        };
+
+    public:
+        /// File open mode flags
+        enum OpenMode : uint8_t
+        {
+            Read = 0x01, ///< Read access
+            Write = 0x02, ///< Write access
+            Create = 0x04, ///< Create file if it does not exist (implies write)
+            Truncate = 0x08, ///< Remove file content (implies write)
+            Append = 0x10 ///< Set position to end of file (implies write)
+        };
+
+        /**
+         * @brief File of FAT32 volume
+         */
+        class File
+        {
+            friend class Fat32;
+        public:
+            /**
+             * @brief Opens file
+             *
+             * @param [in] path File path (8.3 names separated by '/')
+             * @param [in] mode Open mode (@ref OpenMode flags)
+             *
+             * @retval true File is opened
+             * @retval false File is not found (or it's directory or read-only) or I/O error
+             */
+            bool Open(const char* path, uint8_t mode);
+
+            /**
+             * @brief Returns file state
+             *
+             * @retval true File is opened
+             * @retval false File is closed
+             */
+            bool IsOpen() const
+            {
+                return _mode != 0;
+            }
+
+            /**
+             * @brief Returns file size
+             *
+             * @returns File size (in bytes)
+             */
+            uint32_t Size() const
+            {
+                return _size;
+            }
+
+            /**
+             * @brief Returns current position
+             *
+             * @returns Position (in bytes)
+             */
+            uint32_t Position() const
+            {
+                return _position;
+            }
+
+            /**
+             * @brief Reads data from current position
+             *
+             * @param [out] buffer Buffer
+             * @param [in] size Bytes count
+             *
+             * @returns Read bytes count (less than size on end of file or I/O error)
+             */
+            unsigned Read(void* buffer, unsigned size);
+
+            /**
+             * @brief Writes data to current position
+             *
+             * @param [in] data Data
+             * @param [in] size Bytes count
+             *
+             * @returns Written bytes count (less than size if volume is full or on I/O error)
+             */
+            unsigned Write(const void* data, unsigned size);
+
+            /**
+             * @brief Sets current position
+             *
+             * @param [in] position New position (not greater than file size)
+             *
+             * @retval true Success
+             * @retval false Invalid position or I/O error
+             */
+            bool Seek(uint32_t position);
+
+            /**
+             * @brief Allocates contiguous clusters, so file can grow up to given size without allocation
+             *
+             * @param [in] size Required file capacity (in bytes)
+             *
+             * @retval true Success
+             * @retval false There is no contiguous free space or I/O error
+             */
+            bool Preallocate(uint32_t size);
+
+            /**
+             * @brief Writes file entry and cached sectors to device
+             *
+             * @retval true Success
+             * @retval false I/O error
+             */
+            bool Sync();
+
+            /**
+             * @brief Closes file (frees unused allocated clusters and syncs file)
+             *
+             * @retval true Success
+             * @retval false I/O error
+             */
+            bool Close();
+
+        private:
+            bool NextCluster(bool allocate, uint32_t clusters);
+            bool ReleaseUnused();
+
+            uint32_t _firstCluster = 0; ///< First cluster (0 for empty file)
+            uint32_t _cluster = 0; ///< Cluster of current position (of previous byte on cluster boundary)
+            uint32_t _runEnd = 0; ///< End of known contiguous clusters run (that contains current cluster)
+            uint32_t _position = 0; ///< Current position
+            uint32_t _size = 0; ///< File size
+            uint32_t _entrySector = 0; ///< Directory entry sector
+            uint8_t _entryIndex = 0; ///< Directory entry index in sector
+            uint8_t _mode = 0; ///< Open mode (0 for closed file)
+            bool _dirty = false; ///< Directory entry should be updated
+        };
+
+        /**
+         * @brief Mounts volume
+         *
+         * @details
+         * Block device should be initialized.
+         *
+         * @retval true Success
+         * @retval false There is no FAT32 volume or I/O error
+         */
+        static bool Mount();
+
+        /**
+         * @brief Returns volume state
+         *
+         * @retval true Volume is mounted
+         * @retval false Volume is not mounted
+         */
+        static bool Mounted()
+        {
+            return _mounted;
+        }
+
+        /**
+         * @brief Returns cluster size
+         *
+         * @returns Cluster size (in bytes)
+         */
+        static uint32_t ClusterSize()
+        {
+            return SectorSize << _clusterShift;
+        }
+
+        /**
+         * @brief Writes dirty cached sectors (and free cluster hint) to device
+         *
+         * @retval true Success
+         * @retval false I/O error
+         */
+        static bool Flush();
+
+        /**
+         * @brief Sets timestamp for created and modified files
+         *
+         * @param [in] date Date (see @ref MakeDate)
+         * @param [in] time Time (see @ref MakeTime)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetTimestamp(uint16_t date, uint16_t time)
+        {
+            _date = date;
+            _time = time;
+        }
+
+        /**
+         * @brief Packs date to FAT format
+         *
+         * @param [in] year Year (1980...2107)
+         * @param [in] month Month (1...12)
+         * @param [in] day Day (1...31)
+         *
+         * @returns Packed date
+         */
+        static constexpr uint16_t MakeDate(unsigned year, unsigned month, unsigned day)
+        {
+            return ((year - 1980) << 9) | (month << 5) | day;
+        }
+
+        /**
+         * @brief Packs time to FAT format
+         *
+         * @param [in] hours Hours
+         * @param [in] minutes Minutes
+         * @param [in] seconds Seconds (2 seconds resolution)
+         *
+         * @returns Packed time
+         */
+        static constexpr uint16_t MakeTime(unsigned hours, unsigned minutes, unsigned seconds)
+        {
+            return (hours << 11) | (minutes << 5) | (seconds / 2);
+        }
+
+    private:
+        static uint16_t Get16(const uint8_t* data)
+        {
+            return data[0] | (data[1] << 8);
+        }
+
+        static uint32_t Get32(const uint8_t* data)
+        {
+            return Get16(data) | (static_cast<uint32_t>(Get16(data + 2)) << 16);
+        }
+
+        static void Put16(uint8_t* data, uint16_t value)
+        {
+            data[0] = value & 0xff;
+            data[1] = value >> 8;
+        }
+
+        static void Put32(uint8_t* data, uint32_t value)
+        {
+            Put16(data, value & 0xffff);
+            Put16(data + 2, value >> 16);
+        }
+
+        static bool IsCluster(uint32_t cluster)
+        {
+            return cluster >= 2 && cluster <= _clusterCount + 1;
+        }
+
+        static uint32_t ClusterLba(uint32_t cluster)
+        {
+            return _dataStart + ((cluster - 2) << _clusterShift);
+        }
+
+        static uint32_t ClustersFor(uint32_t bytes)
+        {
+            uint32_t shift = _clusterShift + SectorShift;
+            return (bytes >> shift) + ((bytes & ((1u << shift) - 1)) != 0 ? 1 : 0);
+        }
+
+        static uint32_t EntryCluster(const uint8_t* entry)
+        {
+            return (static_cast<uint32_t>(Get16(entry + 20)) << 16) | Get16(entry + 26);
+        }
+
+        /**
+         * @brief Checks that sector is FAT32 boot sector
+         *
+         * @param [in] sector Sector data
+         *
+         * @retval true Sector has FAT32 BPB
+         * @retval false Sector is not FAT32 boot sector
+         */
+        static bool IsBootSector(const uint8_t* sector);
+
+        /**
+         * @brief Returns cached sector
+         *
+         * @details
+         * Returned pointer is valid until next call.
+         *
+         * @param [in] lba Sector address
+         * @param [in] access Access type
+         *
+         * @returns Sector data (nullptr on I/O error)
+         */
+        static uint8_t* GetSector(uint32_t lba, Access access);
+
+        /**
+         * @brief Writes cached sector (if it's dirty)
+         *
+         * @param [in] sector Cache sector
+         *
+         * @retval true Success
+         * @retval false I/O error
+         */
+        static bool WriteBack(CacheSector& sector);
+
+        /**
+         * @brief Prepares cache for direct transfer
+         *
+         * @details
+         * Before read dirty sectors of range are written, before write sectors of range are dropped.
+         *
+         * @param [in] lba First sector
+         * @param [in] count Sectors count
+         * @param [in] write Transfer direction
+         *
+         * @retval true Success
+         * @retval false I/O error
+         */
+        static bool PrepareDirect(uint32_t lba, uint32_t count, bool write);
+
+        static bool GetFat(uint32_t cluster, uint32_t& value);
+        static bool SetFat(uint32_t cluster, uint32_t value);
+
+        /**
+         * @brief Returns contiguous run length of clusters chain
+         *
+         * @param [in] cluster First cluster of run
+         * @param [in] limit Max run length
+         *
+         * @returns Clusters count (at least 1)
+         */
+        static uint32_t ContiguousClusters(uint32_t cluster, uint32_t limit);
+
+        /**
+         * @brief Finds index-th cluster of chain
+         *
+         * @param [in] first First cluster of chain
+         * @param [in] index Cluster index
+         * @param [out] cluster Found cluster
+         * @param [out] runEnd End of contiguous run that contains found cluster
+         *
+         * @retval true Success
+         * @retval false Chain is shorter or I/O error
+         */
+        static bool FindCluster(uint32_t first, uint32_t index, uint32_t& cluster, uint32_t& runEnd);
+
+        /**
+         * @brief Allocates contiguous clusters
+         *
+         * @param [in] previous Last cluster of chain (0 for new chain)
+         * @param [in] count Clusters count
+         *
+         * @returns First allocated cluster (0 if there is no free run)
+         */
+        static uint32_t Allocate(uint32_t previous, uint32_t count);
+
+        static bool FreeChain(uint32_t cluster);
+
+        /**
+         * @brief Converts path component to 8.3 directory entry name
+         *
+         * @param [in,out] path Path (it's moved to next component)
+         * @param [out] name Name (11 chars)
+         *
+         * @retval true Success
+         * @retval false Invalid name
+         */
+        static bool MakeName(const char*& path, uint8_t* name);
+
+        /**
+         * @brief Searches directory entry
+         *
+         * @param [in] directory First cluster of directory
+         * @param [in] name Entry name
+         * @param [out] sector Entry sector (free entry sector if entry is not found or NoSector if directory is full)
+         * @param [out] index Entry index in sector
+         * @param [out] found Entry is found
+         *
+         * @retval true Success
+         * @retval false I/O error
+         */
+        static bool FindEntry(uint32_t directory, const uint8_t* name, uint32_t& sector, uint8_t& index, bool& found);
+
+        /**
+         * @brief Adds zeroed cluster to directory
+         *
+         * @param [in] directory First cluster of directory
+         *
+         * @returns First sector of added cluster (NoSector on error)
+         */
+        static uint32_t ExtendDirectory(uint32_t directory);
+
+        static CacheSector _cache[_CacheSectors]; ///< Sectors cache
+        static uint32_t _useCounter; ///< Cache use counter
+        static uint32_t _fatStart; ///< First sector of first FAT
+        static uint32_t _fatSize; ///< FAT size (in sectors)
+        static uint8_t _fatCount; ///< FAT copies count
+        static uint8_t _clusterShift; ///< Log2 of sectors per cluster
+        static uint32_t _dataStart; ///< First sector of cluster 2
+        static uint32_t _clusterCount; ///< Data clusters count
+        static uint32_t _rootCluster; ///< Root directory first cluster
+        static uint32_t _fsInfoSector; ///< FSInfo sector (0 if volume has no FSInfo)
+        static uint32_t _nextFree; ///< Free cluster search start
+        static bool _fsInfoDirty; ///< Free cluster hint is changed
+        static bool _mounted; ///< Volume is mounted
+        static uint16_t _date; ///< Files timestamp date
+        static uint16_t _time; ///< Files timestamp time
+    };
+} // namespace Zhele::Drivers
+
+#include "impl/fat32.h"
+
+#endif //! ZHELE_DRIVERS_FAT32_H
@@ -59,7 +59,7 @@ namespace Zhele::Drivers
     public:
         static const uint8_t Width = _Width;
         static const uint8_t Height = _Height;
-        static const uint8_t* Get(char symbol)
+        static constexpr const uint8_t* Get(char symbol)
         {
             return &_data[(symbol - _AsciiOffset) * Width * ((Height + 7) / 8)];
         }
@@ -80,17 +80,25 @@ namespace Zhele::Drivers
          * 
          * @returns Symbols`s width.
          */
-        static const uint8_t GetWidth(char symbol)
+        static constexpr uint8_t GetWidth(char symbol)
         {
             return _widths[symbol - _AsciiOffset];
         }
-        static const uint8_t* Get(char symbol)
+        static constexpr const uint8_t* Get(char symbol)
         {
-            volatile uint16_t offset = 0;
-            for(uint16_t i = 0; i < symbol - _AsciiOffset; ++i)
-                offset += _widths[i];
+            if consteval {
+                uint16_t offset = 0;
+                for(uint16_t i = 0; i < symbol - _AsciiOffset; ++i)
+                    offset += _widths[i];
 
-            return &_data[offset * ((Height + 7) / 8)];
+                return &_data[offset * ((Height + 7) / 8)];
+            } else {
+                volatile uint16_t offset = 0;
+                for(uint16_t i = 0; i < symbol - _AsciiOffset; ++i)
+                    offset += _widths[i];
+
+                return &_data[offset * ((Height + 7) / 8)];
+            }
         }
     private:
         static const uint8_t _widths[];
@@ -0,0 +1,295 @@
+/**
+ * @file
+ * Implements pre-rendered (RGB565) glyphs for color displays
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_GLYPH_CACHE_H
+#define ZHELE_DRIVERS_GLYPH_CACHE_H
+
+#include <array>
+#include <cstdint>
+
+namespace Zhele::Drivers
+{
+    namespace Private
+    {
+        /**
+         * @brief Returns glyph pixel state
+         *
+         * @details
+         * Font glyph is stored by columns: column has (Height + 7) / 8 bytes, LSB is upper pixel.
+         * Last byte of column contains (Height % 8) pixels in high bits.
+         *
+         * @tparam _Font Font
+         *
+         * @param [in] glyph Glyph data
+         * @param [in] width Glyph width
+         * @param [in] column Column
+         * @param [in] row Row
+         *
+         * @retval true Pixel is set (foreground)
+         * @retval false Pixel is cleared (background)
+         */
+        template<typename _Font>
+        constexpr bool GlyphPixel(const uint8_t* glyph, uint8_t width, uint8_t column, uint8_t row)
+        {
+            const uint8_t extraBits = _Font::Height % 8;
+            const uint8_t page = row / 8;
+            uint8_t value = glyph[page * width + column];
+
+            if (extraBits > 0 && page == _Font::Height / 8)
+                value >>= (8 - extraBits);
+
+            return (value >> (row % 8)) & 0x01;
+        }
+
+        /**
+         * @brief Converts color to display byte order (pixels are sent by 8-bit transfers)
+         *
+         * @param [in] color Color (RGB565)
+         *
+         * @returns Swapped color
+         */
+        constexpr uint16_t DisplayOrder(uint16_t color)
+        {
+            return static_cast<uint16_t>((color >> 8) | (color << 8));
+        }
+
+        /**
+         * @brief Returns default max glyph width of font
+         *
+         * @tparam _Font Font
+         *
+         * @returns Font width for monospace font, font height for proportional one
+         */
+        template<typename _Font>
+        constexpr uint8_t FontMaxWidth()
+        {
+            if constexpr (_Font::MonoSpace)
+                return _Font::Width;
+            else
+                return _Font::Height;
+        }
+    }
+
+    /**
+     * @brief Implements lazy glyph cache (glyphs are rendered on first use)
+     *
+     * @details
+     * Glyph is rendered to RGB565 pixels (rows from top to bottom, display byte order),
+     * so display can send it by one DMA transfer. Cache is direct-mapped: symbol uses slot
+     * (symbol % _Slots), so symbols with the same slot replace each other.
+     * Returned pixels are valid until next @ref Get call for symbol with the same slot.
+     *
+     * @par Example
+     * @code
+     *  using Glyphs = GlyphCache<Font5x7>;
+     *  Glyphs::SetColors(Lcd::White, Lcd::Blue);
+     *  Lcd::WriteString<Glyphs>(0, 0, "Hello");
+     * @endcode
+     *
+     * @tparam _Font Font
+     * @tparam _Slots Cached glyphs count
+     * @tparam _MaxWidth Max glyph width (wider glyphs of proportional font are clipped)
+     */
+    template<typename _Font, unsigned _Slots = 32, uint8_t _MaxWidth = Private::FontMaxWidth<_Font>()>
+    class GlyphCache
+    {
+        static_assert(_Slots > 0, "Cache must have at least one slot");
+
+        static const unsigned SlotSize = _MaxWidth * _Font::Height;
+    public:
+        /// Glyph height
+        static const uint8_t Height = _Font::Height;
+
+        /**
+         * @brief Sets glyphs colors (cache is cleared if colors are changed)
+         *
+         * @param [in] color Symbol color
+         * @param [in] background Background color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetColors(uint16_t color, uint16_t background)
+        {
+            uint16_t foreground = Private::DisplayOrder(color);
+            uint16_t back = Private::DisplayOrder(background);
+
+            if (foreground == _color && back == _background)
+                return;
+
+            _color = foreground;
+            _background = back;
+            Clear();
+        }
+
+        /**
+         * @brief Clears cache
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Clear()
+        {
+            for (unsigned slot = 0; slot < _Slots; ++slot)
+                _symbols[slot] = 0;
+        }
+
+        /**
+         * @brief Returns glyph width
+         *
+         * @param [in] symbol Symbol
+         *
+         * @returns Glyph width
+         */
+        static uint8_t Width(char symbol)
+        {
+            uint8_t width;
+            if constexpr (_Font::MonoSpace)
+                width = _Font::Width;
+            else
+                width = _Font::GetWidth(symbol);
+
+            return width < _MaxWidth ? width : _MaxWidth;
+        }
+
+        /**
+         * @brief Returns glyph pixels (renders glyph if it's not cached)
+         *
+         * @param [in] symbol Symbol
+         *
+         * @returns Glyph pixels (Width(symbol) * Height)
+         */
+        static const uint16_t* Get(char symbol)
+        {
+            const unsigned slot = static_cast<uint8_t>(symbol) % _Slots;
+
+            if (_symbols[slot] != symbol || symbol == 0) {
+                Render(symbol, _pixels[slot]);
+                _symbols[slot] = symbol;
+            }
+
+            return _pixels[slot];
+        }
+
+    private:
+        /**
+         * @brief Renders glyph
+         *
+         * @param [in] symbol Symbol
+         * @param [out] pixels Glyph pixels
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Render(char symbol, uint16_t* pixels)
+        {
+            const uint8_t* glyph = _Font::Get(symbol);
+            const uint8_t width = Width(symbol);
+            uint8_t fontWidth;
+            if constexpr (_Font::MonoSpace)
+                fontWidth = _Font::Width;
+            else
+                fontWidth = _Font::GetWidth(symbol);
+
+            for (uint8_t row = 0; row < Height; ++row) {
+                for (uint8_t column = 0; column < width; ++column)
+                    *pixels++ = Private::GlyphPixel<_Font>(glyph, fontWidth, column, row) ? _color : _background;
+            }
+        }
+
+        static inline uint16_t _pixels[_Slots][SlotSize]; ///< Slots pixels
+        static inline char _symbols[_Slots]; ///< Slots symbols (0 for empty slot)
+        static inline uint16_t _color = Private::DisplayOrder(0xffff); ///< Symbol color (display byte order)
+        static inline uint16_t _background = Private::DisplayOrder(0x0000); ///< Background color (display byte order)
+    };
+
+    /**
+     * @brief Implements glyphs that are rendered at compile time (they are placed in flash)
+     *
+     * @details
+     * Font must be monospace with constexpr data (all built-in monospace fonts).
+     * Pixels layout is the same as for @ref GlyphCache. Symbols out of range are drawn as first symbol.
+     * Glyphs take (_Last - _First + 1) * Width * Height * 2 bytes of flash.
+     *
+     * @par Example
+     * @code
+     *  using Glyphs = StaticGlyphs<Font5x7, Lcd::White, Lcd::Black>;
+     *  Lcd::WriteString<Glyphs>(0, 0, "Hello");
+     * @endcode
+     *
+     * @tparam _Font Font
+     * @tparam _Color Symbol color
+     * @tparam _Background Background color
+     * @tparam _First First rendered symbol
+     * @tparam _Last Last rendered symbol
+     */
+    template<typename _Font, uint16_t _Color, uint16_t _Background, char _First = ' ', char _Last = '~'>
+    class StaticGlyphs
+    {
+        static_assert(_Font::MonoSpace, "Compile-time rendering supports monospace fonts only");
+        static_assert(_First <= _Last, "Invalid symbols range");
+
+        static const unsigned GlyphSize = _Font::Width * _Font::Height;
+        static const unsigned Count = _Last - _First + 1;
+
+        static constexpr std::array<uint16_t, GlyphSize * Count> Render()
+        {
+            std::array<uint16_t, GlyphSize * Count> pixels{};
+            unsigned index = 0;
+
+            for (unsigned symbol = 0; symbol < Count; ++symbol) {
+                const uint8_t* glyph = _Font::Get(static_cast<char>(_First + symbol));
+
+                for (uint8_t row = 0; row < _Font::Height; ++row) {
+                    for (uint8_t column = 0; column < _Font::Width; ++column) {
+                        pixels[index++] = Private::GlyphPixel<_Font>(glyph, _Font::Width, column, row)
+                            ? Private::DisplayOrder(_Color)
+                            : Private::DisplayOrder(_Background);
+                    }
+                }
+            }
+
+            return pixels;
+        }
+
+        static constexpr std::array<uint16_t, GlyphSize * Count> _pixels = Render(); ///< Pixels of all glyphs
+    public:
+        /// Glyph height
+        static const uint8_t Height = _Font::Height;
+
+        /**
+         * @brief Returns glyph width
+         *
+         * @param [in] symbol Symbol
+         *
+         * @returns Glyph width
+         */
+        static constexpr uint8_t Width(char symbol)
+        {
+            return _Font::Width;
+        }
+
+        /**
+         * @brief Returns glyph pixels
+         *
+         * @param [in] symbol Symbol
+         *
+         * @returns Glyph pixels (Width(symbol) * Height)
+         */
+        static const uint16_t* Get(char symbol)
+        {
+            if (symbol < _First || symbol > _Last)
+                symbol = _First;
+
+            return &_pixels[(symbol - _First) * GlyphSize];
+        }
+    };
+}
+
+#endif //! ZHELE_DRIVERS_GLYPH_CACHE_H
@@ -0,0 +1,403 @@
+/**
+ * @file
+ * Implements 2D graphics (lines, circles, bitmaps) over display framebuffer
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_GRAPHICS_H
+#define ZHELE_DRIVERS_GRAPHICS_H
+
+#include <cstdint>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Monochrome bitmap (sprite)
+     *
+     * @details
+     * Bitmap is stored by rows from top to bottom, row takes (Width + 7) / 8 bytes, MSB is left pixel.
+     */
+    struct Bitmap
+    {
+        uint8_t Width; ///< Width
+        uint8_t Height; ///< Height
+        const uint8_t* Data; ///< Rows
+    };
+
+    /**
+     * @brief Color image
+     *
+     * @details
+     * Image is stored by rows from top to bottom in surface pixel format
+     * (RGB565 in display byte order for St7735 framebuffer).
+     */
+    struct Image
+    {
+        uint8_t Width; ///< Width
+        uint8_t Height; ///< Height
+        const uint16_t* Data; ///< Pixels
+    };
+
+    /**
+     * @brief Implements 2D graphics over RAM surface
+     *
+     * @details
+     * Surface is display framebuffer (@ref St7735::FrameBuffer, @ref Ssd1306Display) that provides:
+     * ScreenWidth and ScreenHeight constants, PixelType (color type), DrawPixel(x, y, color) and
+     * FillRectangle(x, y, width, height, color) methods. DrawImage(x, y, width, height, data) (clipped by surface,
+     * width is line length of data) is required by @ref DrawImage only. Shapes are clipped by screen bounds (coordinates can be negative),
+     * horizontal and vertical lines, filled shapes and bitmaps are drawn by span fills.
+     * Drawing changes RAM only: surface sends changed regions by its DMA path (St7735::FrameBuffer::Flush,
+     * Ssd1306Display::Update).
+     *
+     * @par Example
+     * @code
+     *  using Screen = Lcd::FrameBuffer<>;
+     *  using Gfx = Graphics<Screen>;
+     *  Gfx::DrawLine(0, 0, 159, 127, Lcd::Color::White);
+     *  Gfx::FillCircle(80, 64, 20, Lcd::Color::Red);
+     *  Gfx::DrawBitmap(-4, 10, Icon, Lcd::Color::Yellow);
+     *  Screen::Flush();
+     * @endcode
+     *
+     * @tparam _Surface Surface
+     */
+    template<typename _Surface>
+    class Graphics
+    {
+        static const int16_t Width = _Surface::ScreenWidth;
+        static const int16_t Height = _Surface::ScreenHeight;
+    public:
+        using PixelType = typename _Surface::PixelType;
+
+        /**
+         * @brief Draw pixel
+         *
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawPixel(int16_t x, int16_t y, PixelType color)
+        {
+            if (x >= 0 && y >= 0 && x < Width && y < Height)
+                _Surface::DrawPixel(x, y, color);
+        }
+
+        /**
+         * @brief Fill rectangle
+         *
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] width Width
+         * @param [in] height Height
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void FillRectangle(int16_t x, int16_t y, int16_t width, int16_t height, PixelType color)
+        {
+            if (Clip(x, y, width, height))
+                _Surface::FillRectangle(x, y, width, height, color);
+        }
+
+        /**
+         * @brief Draw horizontal line
+         *
+         * @param [in] x X coordinate of left point
+         * @param [in] y Y coordinate
+         * @param [in] length Length
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawHorizontalLine(int16_t x, int16_t y, int16_t length, PixelType color)
+        {
+            FillRectangle(x, y, length, 1, color);
+        }
+
+        /**
+         * @brief Draw vertical line
+         *
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate of top point
+         * @param [in] length Length
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawVerticalLine(int16_t x, int16_t y, int16_t length, PixelType color)
+        {
+            FillRectangle(x, y, 1, length, color);
+        }
+
+        /**
+         * @brief Draw line (Bresenham algorithm)
+         *
+         * @param [in] x0 X coordinate of first point
+         * @param [in] y0 Y coordinate of first point
+         * @param [in] x1 X coordinate of second point
+         * @param [in] y1 Y coordinate of second point
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, PixelType color)
+        {
+            if (y0 == y1) {
+                DrawHorizontalLine(x0 < x1 ? x0 : x1, y0, Abs(x1 - x0) + 1, color);
+                return;
+            }
+            if (x0 == x1) {
+                DrawVerticalLine(x0, y0 < y1 ? y0 : y1, Abs(y1 - y0) + 1, color);
+                return;
+            }
+
+            const int32_t dx = Abs(x1 - x0);
+            const int32_t dy = -Abs(y1 - y0);
+            const int16_t stepX = x0 < x1 ? 1 : -1;
+            const int16_t stepY = y0 < y1 ? 1 : -1;
+            int32_t error = dx + dy;
+
+            for (;;) {
+                DrawPixel(x0, y0, color);
+                if (x0 == x1 && y0 == y1)
+                    break;
+
+                const int32_t doubleError = 2 * error;
+                if (doubleError >= dy) {
+                    error += dy;
+                    x0 += stepX;
+                }
+                if (doubleError <= dx) {
+                    error += dx;
+                    y0 += stepY;
+                }
+            }
+        }
+
+        /**
+         * @brief Draw rectangle
+         *
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] width Width
+         * @param [in] height Height
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawRectangle(int16_t x, int16_t y, int16_t width, int16_t height, PixelType color)
+        {
+            if (width <= 0 || height <= 0)
+                return;
+
+            DrawHorizontalLine(x, y, width, color);
+            DrawHorizontalLine(x, y + height - 1, width, color);
+            DrawVerticalLine(x, y + 1, height - 2, color);
+            DrawVerticalLine(x + width - 1, y + 1, height - 2, color);
+        }
+
+        /**
+         * @brief Draw circle (midpoint algorithm)
+         *
+         * @param [in] x X coordinate of center
+         * @param [in] y Y coordinate of center
+         * @param [in] radius Radius
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawCircle(int16_t x, int16_t y, int16_t radius, PixelType color)
+        {
+            int16_t dx = radius;
+            int16_t dy = 0;
+            int16_t error = 1 - radius;
+
+            while (dx >= dy) {
+                DrawPixel(x + dx, y + dy, color);
+                DrawPixel(x - dx, y + dy, color);
+                DrawPixel(x + dx, y - dy, color);
+                DrawPixel(x - dx, y - dy, color);
+                DrawPixel(x + dy, y + dx, color);
+                DrawPixel(x - dy, y + dx, color);
+                DrawPixel(x + dy, y - dx, color);
+                DrawPixel(x - dy, y - dx, color);
+
+                NextCirclePoint(dx, dy, error);
+            }
+        }
+
+        /**
+         * @brief Fill circle
+         *
+         * @param [in] x X coordinate of center
+         * @param [in] y Y coordinate of center
+         * @param [in] radius Radius
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void FillCircle(int16_t x, int16_t y, int16_t radius, PixelType color)
+        {
+            int16_t dx = radius;
+            int16_t dy = 0;
+            int16_t error = 1 - radius;
+
+            while (dx >= dy) {
+                DrawHorizontalLine(x - dx, y + dy, 2 * dx + 1, color);
+                DrawHorizontalLine(x - dx, y - dy, 2 * dx + 1, color);
+                DrawHorizontalLine(x - dy, y + dx, 2 * dy + 1, color);
+                DrawHorizontalLine(x - dy, y - dx, 2 * dy + 1, color);
+
+                NextCirclePoint(dx, dy, error);
+            }
+        }
+
+        /**
+         * @brief Draw bitmap (set pixels only, other pixels are transparent)
+         *
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] bitmap Bitmap
+         * @param [in] color Color of set pixels
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawBitmap(int16_t x, int16_t y, const Bitmap& bitmap, PixelType color)
+        {
+            int16_t left = x, top = y, width = bitmap.Width, height = bitmap.Height;
+            if (!Clip(left, top, width, height))
+                return;
+
+            const uint8_t stride = (bitmap.Width + 7) / 8;
+            const int16_t firstColumn = left - x;
+            const int16_t endColumn = firstColumn + width;
+
+            for (int16_t row = top - y; row < top - y + height; ++row) {
+                const uint8_t* line = bitmap.Data + row * stride;
+                int16_t run = -1;
+
+                for (int16_t column = firstColumn; column < endColumn; ++column) {
+                    const bool set = (line[column / 8] & (0x80 >> (column % 8))) != 0;
+
+                    if (set && run < 0) {
+                        run = column;
+                    } else if (!set && run >= 0) {
+                        _Surface::FillRectangle(x + run, y + row, column - run, 1, color);
+                        run = -1;
+                    }
+                }
+
+                if (run >= 0)
+                    _Surface::FillRectangle(x + run, y + row, endColumn - run, 1, color);
+            }
+        }
+
+        /**
+         * @brief Draw bitmap with background
+         *
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] bitmap Bitmap
+         * @param [in] color Color of set pixels
+         * @param [in] background Color of cleared pixels
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawBitmap(int16_t x, int16_t y, const Bitmap& bitmap, PixelType color, PixelType background)
+        {
+            FillRectangle(x, y, bitmap.Width, bitmap.Height, background);
+            DrawBitmap(x, y, bitmap, color);
+        }
+
+        /**
+         * @brief Draw color image (blit)
+         *
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] image Image
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawImage(int16_t x, int16_t y, const Image& image)
+        {
+            int16_t left = x, top = y, width = image.Width, height = image.Height;
+            if (!Clip(left, top, width, height))
+                return;
+
+            // Surface clips right part itself, so image without left clipping is drawn by one call (one DMA2D transfer)
+            if (left == x) {
+                _Surface::DrawImage(left, top, image.Width, height, image.Data + (top - y) * image.Width);
+                return;
+            }
+
+            // Row by row, so clipped left part is skipped
+            for (int16_t row = 0; row < height; ++row)
+                _Surface::DrawImage(left, top + row, width, 1, image.Data + (top - y + row) * image.Width + (left - x));
+        }
+
+    private:
+        static int16_t Abs(int16_t value)
+        {
+            return value < 0 ? -value : value;
+        }
+
+        static void NextCirclePoint(int16_t& dx, int16_t& dy, int16_t& error)
+        {
+            ++dy;
+            if (error < 0) {
+                error += 2 * dy + 1;
+            } else {
+                --dx;
+                error += 2 * (dy - dx) + 1;
+            }
+        }
+
+        /**
+         * @brief Clips rectangle by screen
+         *
+         * @param [in, out] x X coordinate
+         * @param [in, out] y Y coordinate
+         * @param [in, out] width Width
+         * @param [in, out] height Height
+         *
+         * @retval true Rectangle is visible
+         * @retval false Rectangle is out of screen or empty
+         */
+        static bool Clip(int16_t& x, int16_t& y, int16_t& width, int16_t& height)
+        {
+            if (x < 0) {
+                width += x;
+                x = 0;
+            }
+            if (y < 0) {
+                height += y;
+                y = 0;
+            }
+            if (width > Width - x)
+                width = Width - x;
+            if (height > Height - y)
+                height = Height - y;
+
+            return width > 0 && height > 0;
+        }
+    };
+}
+
+#endif //! ZHELE_DRIVERS_GRAPHICS_H
@@ -11,9 +11,13 @@
 #ifndef ZHELE_DRIVERS_HD44780_H
 #define ZHELE_DRIVERS_HD44780_H
 
+#include <zhele/containers/ring_buffer.h>
 #include <zhele/delay.h>
 #include <zhele/i2c.h>
 #include <zhele/pinlist.h>
+#include <zhele/system_time.h>
+
+#include <type_traits>
 
 namespace Zhele::Drivers
 {
@@ -62,6 +66,18 @@ namespace Zhele::Drivers
             Dots5x8  = 0x00 ///< Character size 5x8
         };
     public:
+        /// Queued byte is data (symbol), otherwise it's command (for @ref LcdAsync)
+        static const uint16_t EntryData = 0x100;
+
+        /// Queued command is long (clear, return home)
+        static const uint16_t EntryLong = 0x200;
+
+        /// Command execution time (us)
+        static const unsigned CommandTime = 40;
+
+        /// Long command execution time (us)
+        static const unsigned LongCommandTime = 2000;
+
         /**
          * @brief Display power settings.
          */
@@ -152,7 +168,7 @@ namespace Zhele::Drivers
             Strobe();
             Strobe();
             Strobe();
-            delay_ms<60>();
+            SystemTime::Sleep(60);
             DataBus::template Write<0x02>();  // set 4 bit mode
             Strobe();
 
@@ -171,7 +187,7 @@ namespace Zhele::Drivers
         {
             RS::Clear();
             Write(ClearDisplay);
-            delay_ms<10>();
+            SystemTime::Sleep(10);
         }
 
         /**
@@ -265,7 +281,40 @@ namespace Zhele::Drivers
             Write(DisplayControl | DisplayState | CursorState | BlinkState);
         }
 
+        /**
+         * @brief Sends byte without waiting for execution (low-level method for @ref LcdAsync)
+         * 
+         * @details
+         * Caller must wait command execution time (or busy flag) before next byte.
+         * 
+         * @param [in] value Command or symbol
+         * @param [in] data Value is data (symbol)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Send(uint8_t value, bool data)
+        {
+            if (data)
+                RS::Set();
+            else
+                RS::Clear();
+
+            DataBus::Write(value >> 4);
+            Pulse();
+            DataBus::Write(value);
+            Pulse();
+        }
+
     protected:
+        static void Pulse()
+        {
+            E::Set();
+            delay_us<1>();
+            E::Clear();
+            delay_us<1>();
+        }
+
         static void Strobe()
         {
             E::Set();
@@ -310,6 +359,10 @@ namespace Zhele::Drivers
     {
         using Base = Lcd<RS, E, D4, D5, D6, D7, LINE_WIDTH, LINES>;
     public:
+        using Base::LineWidth;
+        using Base::Lines;
+        using Base::Send;
+
         /**
          * @brief Init display.
          * 
@@ -376,6 +429,7 @@ namespace Zhele::Drivers
         using DataBus = _I2cBus;
         static const uint8_t BackLight = 0x08;
         static const uint8_t Enable = 0x04;
+        static const uint8_t FramesPerByte = 6;
 
         enum Mode : uint8_t
         {
@@ -412,12 +466,12 @@ namespace Zhele::Drivers
          */
         static void Init()
         {
-            delay_ms<50>();
+            SystemTime::Sleep(50);
             Write(BackLight);
-            delay_ms<1000>();
+            SystemTime::Sleep(1000);
 
             WriteU4(0x03 << 4);
-            delay_ms<5>();
+            SystemTime::Sleep(5);
             WriteU4(0x02 << 4);
 
             WriteU8(FunctionSet | Line2 | Dots5x8 | Bit4Mode);
@@ -436,7 +490,7 @@ namespace Zhele::Drivers
         static void Clear()
         {
             WriteU8(ClearDisplay);
-            delay_ms<10>();
+            SystemTime::Sleep(10);
             Home();
         }
 
@@ -449,7 +503,7 @@ namespace Zhele::Drivers
         static void Home()
         {
             WriteU8(ReturnHome);
-            delay_ms<10>();
+            SystemTime::Sleep(10);
         }
 
         /**
@@ -525,11 +579,71 @@ namespace Zhele::Drivers
             WriteU8(DisplayControl | DisplayState | CursorState | BlinkState);
         }
 
+        /// Max bytes count for @ref SendAsync
+        static const uint8_t MaxBatch = 8;
+
+        /**
+         * @brief Sends bytes by one I2C transfer (low-level method for @ref LcdAsync)
+         * 
+         * @details
+         * Every nibble takes three expander writes (setup, enable, latch), so with I2C clock up to 400 kHz
+         * expander writes take more than command execution time and bytes don't need delays.
+         * After long command caller must wait its execution time.
+         * 
+         * @param [in] entries Bytes with flags (@ref EntryData)
+         * @param [in] count Bytes count (not more than @ref MaxBatch)
+         * @param [in] callback Transfer complete callback
+         * 
+         * @returns Transfer start status
+         */
+        static I2cStatus SendAsync(const uint16_t* entries, uint8_t count, I2cCallback callback)
+        {
+            if (count > MaxBatch)
+                count = MaxBatch;
+
+            uint8_t* frames = _frames;
+            for (uint8_t i = 0; i < count; ++i)
+            {
+                Mode mode = (entries[i] & EntryData) != 0 ? Mode::Data : Mode::Command;
+                frames = Encode(static_cast<uint8_t>(entries[i]), mode, frames);
+            }
+
+            return DataBus::WriteAsync(_Address, 0x00, _frames, count * FramesPerByte, Zhele::I2cOpts::RegAddrNone, callback);
+        }
+
     protected:
         static void WriteU8(uint8_t data, Mode mode = Mode::Command)
         {
-            WriteU4((data & 0xf0) | static_cast<uint8_t>(mode));
-            WriteU4(((data << 4) & 0xf0) | static_cast<uint8_t>(mode));
+            uint8_t frames[FramesPerByte];
+            Encode(data, mode, frames);
+            DataBus::Write(_Address, 0x00, frames, FramesPerByte, Zhele::I2cOpts::RegAddrNone);
+            delay_us<50>();
+        }
+
+        /**
+         * @brief Encodes byte to expander writes
+         * 
+         * @param [in] data Byte
+         * @param [in] mode Mode (command/data)
+         * @param [out] frames Expander writes (6 bytes)
+         * 
+         * @returns Pointer after last write
+         */
+        static uint8_t* Encode(uint8_t data, Mode mode, uint8_t* frames)
+        {
+            const uint8_t nibbles[2] = {
+                static_cast<uint8_t>((data & 0xf0) | mode | BackLight),
+                static_cast<uint8_t>(((data << 4) & 0xf0) | mode | BackLight)
+            };
+
+            for (uint8_t nibble : nibbles)
+            {
+                *frames++ = nibble;
+                *frames++ = nibble | Enable;
+                *frames++ = nibble;
+            }
+
+            return frames;
         }
 
         static void WriteU4(uint8_t data)
@@ -550,6 +664,309 @@ namespace Zhele::Drivers
         {
             DataBus::WriteU8(_Address, 0x00, data | BackLight, Zhele::I2cOpts::RegAddrNone);
         }
+
+        static inline uint8_t _frames[MaxBatch * FramesPerByte]; ///< Expander writes for async transfer
+    };
+
+    /**
+     * @brief Implements non-blocking (queued) output for HD44780 lcd
+     * 
+     * @details
+     * Commands and symbols are put to queue and are sent by timer wheel task (from timer interrupt),
+     * so methods don't wait command execution time. Lcd with RW pin (@ref LcdExt) is checked by busy flag,
+     * other ones are waited by command execution time. I2C lcd (@ref LcdI2c) sends queued bytes
+     * by batches (one I2C transfer). Methods wait only if queue is full.
+     * 
+     * @par Example
+     * @code
+     *  using Wheel = Timers::TimerWheel<Timers::Timer3>;
+     *  using lcd = LcdAsync<LcdI2c<I2c1>, Wheel, 100>;
+     *  Wheel::Init(F_CPU / 10000 - 1); // 100 us ticks
+     *  lcd::Init();
+     *  lcd::Clear();
+     *  lcd::Puts("Hello");
+     *  extern "C" void TIM3_IRQHandler() { Wheel::IrqHandler(); }
+     * @endcode
+     * 
+     * @tparam _Lcd Lcd (@ref Lcd, @ref LcdExt or @ref LcdI2c)
+     * @tparam _Wheel Timer wheel (@ref Timers::TimerWheel)
+     * @tparam _TickUs Timer wheel tick (us)
+     * @tparam _QueueSize Queue size (bytes)
+     */
+    template<typename _Lcd, typename _Wheel, unsigned _TickUs = 100, unsigned _QueueSize = 64>
+    class LcdAsync : public LcdBase
+    {
+        static_assert(_TickUs > 0, "Tick must be positive");
+
+        static constexpr bool ReadsBusy = requires { _Lcd::Busy(); };
+        static constexpr bool Batched = requires { _Lcd::MaxBatch; };
+
+        static const uint32_t CommandTicks = (CommandTime + _TickUs - 1) / _TickUs;
+        static const uint32_t LongCommandTicks = (LongCommandTime + _TickUs - 1) / _TickUs;
+    public:
+        /**
+         * @brief Returns line width.
+         *
+         * @returns Line width.
+         */
+        static uint8_t LineWidth()
+        {
+            return _Lcd::LineWidth();
+        }
+
+        /**
+         * @brief Returns lines count.
+         *
+         * @returns Lines count.
+         */
+        static uint8_t Lines()
+        {
+            return _Lcd::Lines();
+        }
+
+        /**
+         * @brief Init display (blocking).
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+            _Lcd::Init();
+        }
+
+        /**
+         * @brief Clear display.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Clear()
+        {
+            Put(ClearDisplay | EntryLong);
+        }
+
+        /**
+         * @brief Returns cursor home.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Home()
+        {
+            Put(ReturnHome | EntryLong);
+        }
+
+        /**
+         * @brief Set cursor's position.
+         * 
+         * @param [in] position New position.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Goto(uint8_t position)
+        {
+            Put(SetDDRamAddr | position);
+        }
+
+        /**
+         * @brief Set cursor's position.
+         * 
+         * @param [in] x New X-position.
+         * @param [in] y New Y-position.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Goto(uint8_t x, uint8_t y)
+        {
+            if (y == 1)
+                x += 0x40;
+            Put(SetDDRamAddr | x);
+        }
+
+        /**
+         * @brief Print text.
+         * 
+         * @param [in] text Text
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Puts(const char* text)
+        {
+            while(*text) {
+                Put(static_cast<uint8_t>(*text++) | EntryData);
+            }
+        }
+
+        /**
+         * @brief Print one character.
+         * 
+         * @param [in] symbol Symbol
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Putch(char symbol)
+        {
+            Put(static_cast<uint8_t>(symbol) | EntryData);
+        }
+
+        /**
+         * @brief Control display power settings.
+         * 
+         * @tparam DisplayState Display state (on/off).
+         * @tparam CursorState Cursor state.
+         * @tparam BlinkState Cursor blink state.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<PowerControl DisplayState, PowerControl CursorState, PowerControl BlinkState>
+        static void PowerControl()
+        {
+            Put(DisplayControl | DisplayState | CursorState | BlinkState);
+        }
+
+        /**
+         * @brief Check queued output is in progress
+         * 
+         * @retval true Queue is not sent yet
+         * @retval false All queued bytes are sent
+         */
+        static bool Busy()
+        {
+            return _running;
+        }
+
+        /**
+         * @brief Waits for queued output
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Flush()
+        {
+            while (_running) ;
+        }
+
+    private:
+        /**
+         * @brief Puts byte to queue (waits if queue is full)
+         * 
+         * @param [in] entry Byte with flags
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Put(uint16_t entry)
+        {
+            while (!_queue.push_back(entry))
+                Kick();
+            Kick();
+        }
+
+        /**
+         * @brief Starts task (if it's not running)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Kick()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            bool start = !_running;
+            _running = true;
+            __set_PRIMASK(primask);
+
+            if (start)
+                _Wheel::Start(_task, 1);
+        }
+
+        /**
+         * @brief Sends next queued byte(s), timer wheel task callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Step()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if (_queue.empty())
+            {
+                _running = false;
+                __set_PRIMASK(primask);
+                return;
+            }
+            __set_PRIMASK(primask);
+
+            if constexpr (Batched)
+            {
+                auto entries = _queue.readable_span();
+                uint8_t count = 0;
+                _long = false;
+                while (count < entries.size() && count < _Lcd::MaxBatch && !_long)
+                    _long = (entries[count++] & EntryLong) != 0;
+
+                _batch = count;
+                if (_Lcd::SendAsync(entries.data(), count, SendComplete) != I2cStatus::Success)
+                    _Wheel::Start(_task, 1);
+            }
+            else
+            {
+                if constexpr (ReadsBusy)
+                {
+                    if (_Lcd::Busy())
+                    {
+                        _Wheel::Start(_task, 1);
+                        return;
+                    }
+                }
+
+                uint16_t entry = _queue.front();
+                _queue.pop_front();
+                _Lcd::Send(static_cast<uint8_t>(entry), (entry & EntryData) != 0);
+
+                if constexpr (ReadsBusy)
+                    _Wheel::Start(_task, 1);
+                else
+                    _Wheel::Start(_task, (entry & EntryLong) != 0 ? LongCommandTicks : CommandTicks);
+            }
+        }
+
+        /**
+         * @brief Batch transfer complete handler
+         * 
+         * @param [in] status Transfer status
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SendComplete(I2cStatus status)
+        {
+            if (status != I2cStatus::Success)
+            {
+                // Batch is sent again
+                _Wheel::Start(_task, 1);
+                return;
+            }
+
+            _queue.consume(_batch);
+            if (_long)
+                _Wheel::Start(_task, LongCommandTicks);
+            else
+                Step();
+        }
+
+        static inline Containers::RingBuffer<_QueueSize, uint16_t> _queue; ///< Queued bytes
+        static inline typename _Wheel::Task _task{Step}; ///< Timer wheel task
+        static inline volatile bool _running = false; ///< Task is running
+        static inline uint8_t _batch = 0; ///< Batch size (I2C lcd)
+        static inline bool _long = false; ///< Batch ends with long command (I2C lcd)
     };
 }
 #endif //! ZHELE_DRIVERS_HD44780_H
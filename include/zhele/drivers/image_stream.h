@@ -0,0 +1,545 @@
+/**
+ * @file
+ * Implements streaming of images from storage to display
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_IMAGE_STREAM_H
+#define ZHELE_DRIVERS_IMAGE_STREAM_H
+
+#include <zhele/common/template_utils/data_transfer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Implements incremental QOI image decoder (RGB565 output)
+     *
+     * @details
+     * Data may be fed by chunks of any size: operation split by chunk boundary is completed
+     * by next chunk. Decoder takes 270 bytes of RAM (64 colors index and state), alpha channel is ignored.
+     * Output pixels are in display byte order (high byte first in memory), as for St7735::DrawImage.
+     */
+    class QoiDecoder
+    {
+        static const uint8_t HeaderSize = 14; ///< File header size
+        static const uint8_t OpIndex = 0x00; ///< 00xxxxxx: color from index
+        static const uint8_t OpDiff = 0x40; ///< 01xxxxxx: small difference
+        static const uint8_t OpLuma = 0x80; ///< 10xxxxxx: luma difference (plus one byte)
+        static const uint8_t OpRun = 0xc0; ///< 11xxxxxx: run of previous color
+        static const uint8_t OpRgb = 0xfe; ///< RGB color (plus three bytes)
+        static const uint8_t OpRgba = 0xff; ///< RGBA color (plus four bytes)
+        static const uint8_t OpMask = 0xc0; ///< Two bits tag mask
+
+        /// Color
+        struct Rgba
+        {
+            uint8_t R, G, B, A;
+        };
+    public:
+        /**
+         * @brief Prepares decoder for new image
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset()
+        {
+            _received = 0;
+            _width = 0;
+            _height = 0;
+            _remaining = 0;
+            _failed = false;
+            _needed = 0;
+            _color = {0, 0, 0, 255};
+            for (auto& color : _index)
+                color = {0, 0, 0, 0};
+        }
+
+        /**
+         * @brief Decodes next chunk of file
+         *
+         * @tparam _Output Pixel output functor (void(uint16_t pixel))
+         *
+         * @param [in] data Chunk
+         * @param [in] size Chunk size
+         * @param [in] output Pixel output
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Output>
+        void Feed(const uint8_t* data, size_t size, _Output&& output)
+        {
+            for (size_t i = 0; i < size && !_failed && !Done(); ++i) {
+                const uint8_t byte = data[i];
+
+                if (_received < HeaderSize) {
+                    _header[_received++] = byte;
+                    if (_received == HeaderSize)
+                        ParseHeader();
+                    continue;
+                }
+
+                if (_needed > 0) {
+                    _args[_argsCount++] = byte;
+                    if (--_needed > 0)
+                        continue;
+                }
+                else {
+                    _op = byte;
+                    _argsCount = 0;
+                    _needed = _op == OpRgb ? 3 : _op == OpRgba ? 4 : (_op & OpMask) == OpLuma ? 1 : 0;
+                    if (_needed > 0)
+                        continue;
+                }
+
+                uint8_t count = Apply();
+                const uint16_t pixel = Pack(_color);
+                for (; count > 0 && _remaining > 0; --count, --_remaining)
+                    output(pixel);
+            }
+        }
+
+        /**
+         * @brief Returns image width
+         *
+         * @returns Width (0 if header isn't decoded yet)
+         */
+        uint32_t Width() const
+        {
+            return _width;
+        }
+
+        /**
+         * @brief Returns image height
+         *
+         * @returns Height (0 if header isn't decoded yet)
+         */
+        uint32_t Height() const
+        {
+            return _height;
+        }
+
+        /**
+         * @brief Checks all pixels are decoded
+         *
+         * @retval true Image is decoded
+         * @retval false Decoding is in progress
+         */
+        bool Done() const
+        {
+            return _received == HeaderSize && _remaining == 0 && !_failed;
+        }
+
+        /**
+         * @brief Checks data is not QOI image
+         *
+         * @retval true Header is invalid
+         * @retval false Header is valid (or isn't received yet)
+         */
+        bool Failed() const
+        {
+            return _failed;
+        }
+
+    private:
+        static uint32_t ReadBigEndian(const uint8_t* data)
+        {
+            return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16)
+                | (static_cast<uint32_t>(data[2]) << 8) | data[3];
+        }
+
+        static constexpr uint16_t Pack(Rgba color)
+        {
+            const uint16_t rgb565 = static_cast<uint16_t>(((color.R & 0xf8) << 8) | ((color.G & 0xfc) << 3) | (color.B >> 3));
+            return static_cast<uint16_t>((rgb565 >> 8) | (rgb565 << 8));
+        }
+
+        void ParseHeader()
+        {
+            _width = ReadBigEndian(_header + 4);
+            _height = ReadBigEndian(_header + 8);
+            _failed = _header[0] != 'q' || _header[1] != 'o' || _header[2] != 'i' || _header[3] != 'f'
+                || _width == 0 || _height == 0 || _width > 0xffff || _height > 0xffff;
+            _remaining = _failed ? 0 : _width * _height;
+        }
+
+        /**
+         * @brief Applies current operation to color
+         *
+         * @returns Pixels count of operation
+         */
+        uint8_t Apply()
+        {
+            uint8_t count = 1;
+
+            if (_op == OpRgb) {
+                _color.R = _args[0];
+                _color.G = _args[1];
+                _color.B = _args[2];
+            }
+            else if (_op == OpRgba) {
+                _color = {_args[0], _args[1], _args[2], _args[3]};
+            }
+            else {
+                switch (_op & OpMask) {
+                case OpIndex:
+                    _color = _index[_op & 0x3f];
+                    break;
+                case OpDiff:
+                    _color.R += ((_op >> 4) & 0x03) - 2;
+                    _color.G += ((_op >> 2) & 0x03) - 2;
+                    _color.B += (_op & 0x03) - 2;
+                    break;
+                case OpLuma:
+                {
+                    const int diffGreen = (_op & 0x3f) - 32;
+                    _color.R += diffGreen - 8 + ((_args[0] >> 4) & 0x0f);
+                    _color.G += diffGreen;
+                    _color.B += diffGreen - 8 + (_args[0] & 0x0f);
+                    break;
+                }
+                default:
+                    count = (_op & 0x3f) + 1;
+                    break;
+                }
+            }
+
+            _index[(_color.R * 3 + _color.G * 5 + _color.B * 7 + _color.A * 11) % 64] = _color;
+            return count;
+        }
+
+        Rgba _index[64]; ///< Previously seen colors
+        Rgba _color; ///< Previous color
+        uint8_t _header[HeaderSize]; ///< Header
+        uint8_t _received = 0; ///< Received header bytes
+        uint8_t _op = 0; ///< Current operation
+        uint8_t _args[4]; ///< Operation arguments
+        uint8_t _argsCount = 0; ///< Received arguments
+        uint8_t _needed = 0; ///< Remaining arguments
+        bool _failed = false; ///< Invalid header
+        uint32_t _width = 0; ///< Image width
+        uint32_t _height = 0; ///< Image height
+        uint32_t _remaining = 0; ///< Pixels to decode
+    };
+
+    /**
+     * @brief Adapts block card (SdCard, SdioCard) to image stream source
+     *
+     * @details
+     * Image must be stored in contiguous blocks and start at block boundary
+     * (offset is byte offset from card start). Card async transfer is continued
+     * by @ref Process (stream calls it while waiting).
+     *
+     * @tparam _Card Card with async ReadBlocks
+     */
+    template<typename _Card>
+    class BlockImageSource
+    {
+    public:
+        /// Read granularity (stream chunk must be multiple of it)
+        static const unsigned Granularity = 512;
+
+        /**
+         * @brief Starts read by DMA
+         *
+         * @param [in] offset Offset (multiple of block size)
+         * @param [out] data Buffer (size rounded up to block size)
+         * @param [in] size Size
+         * @param [in] callback Completion callback
+         *
+         * @retval true Read is started
+         * @retval false Card error
+         */
+        static bool ReadAsync(uint32_t offset, void* data, uint16_t size, TransferCallback callback)
+        {
+            _data = data;
+            _size = size;
+            _callback = callback;
+            return _Card::ReadBlocks(data, offset / Granularity, (size + Granularity - 1) / Granularity, Complete);
+        }
+
+        /**
+         * @brief Continues async read
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Process()
+        {
+            if constexpr (requires { _Card::Process(); })
+                _Card::Process();
+        }
+
+    private:
+        static void Complete(bool success)
+        {
+            if (_callback)
+                _callback(_data, _size, success);
+        }
+
+        static inline void* _data = nullptr; ///< Current buffer
+        static inline uint16_t _size = 0; ///< Current size
+        static inline TransferCallback _callback = nullptr; ///< Completion callback
+    };
+
+    /**
+     * @brief Implements image streaming from storage to display
+     *
+     * @details
+     * Image is read by chunks into one of two buffers by storage DMA, while previous chunk is sent
+     * to display by display DMA (raw images) or is decoded into one of two pixel buffers that
+     * are sent to display by DMA (QOI images), so image is drawn at bus speed with 2 (raw)
+     * or 4 (QOI) chunks of RAM instead of full image buffer.
+     * Storage and display must be on different SPI buses (or storage must use SDIO/QSPI).
+     * Methods are blocking: they wait for transfers (calling source Process, if it has one).
+     *
+     * @par Example
+     * @code
+     *  using Splash = ImageStream<Lcd, SpiFlash<Spi2, IO::Pb12>>;
+     *  Splash::DrawQoi(0, 0, logoOffset, logoSize);
+     *  using Icons = ImageStream<Lcd, BlockImageSource<Card>, 1024>;
+     *  Icons::DrawRaw(16, 16, 32, 32, iconLba * 512);
+     * @endcode
+     *
+     * @tparam _Display Display (with BeginWrite, WritePixelsAsync and EndWrite)
+     * @tparam _Source Source (with ReadAsync(offset, data, size, callback), optional Process and Granularity)
+     * @tparam _ChunkSize Chunk size in bytes
+     */
+    template<typename _Display, typename _Source, unsigned _ChunkSize = 512>
+    class ImageStream
+    {
+        static_assert(_ChunkSize % 2 == 0 && _ChunkSize <= 0xffff, "Chunk must contain whole pixels and fit one DMA transfer");
+        static consteval bool GranularityMatches()
+        {
+            if constexpr (requires { _Source::Granularity; })
+                return _ChunkSize % _Source::Granularity == 0;
+            else
+                return true;
+        }
+        static_assert(GranularityMatches(), "Chunk must be multiple of source granularity");
+
+        static const unsigned PixelsPerChunk = _ChunkSize / sizeof(uint16_t);
+    public:
+        /**
+         * @brief Draws raw RGB565 image (display byte order, rows from top to bottom)
+         *
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] width Width
+         * @param [in] height Height
+         * @param [in] offset Image offset in source
+         *
+         * @retval true Image is drawn
+         * @retval false Source error
+         */
+        static bool DrawRaw(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint32_t offset)
+        {
+            const uint32_t total = static_cast<uint32_t>(width) * height * sizeof(uint16_t);
+            if (total == 0)
+                return true;
+
+            uint8_t current = 0;
+            if (!StartRead(current, offset, total < _ChunkSize ? total : _ChunkSize))
+                return false;
+
+            _Display::BeginWrite(x, y, width, height);
+
+            bool result = true;
+            uint32_t sent = 0;
+            while (sent < total) {
+                const uint32_t size = total - sent < _ChunkSize ? total - sent : _ChunkSize;
+                if (!WaitRead()) {
+                    result = false;
+                    break;
+                }
+
+                // Display sends other buffer
+                WaitDisplay();
+                StartDisplay(_input[current], size);
+                sent += size;
+
+                current ^= 1;
+                if (sent < total && !StartRead(current, offset + sent, total - sent < _ChunkSize ? total - sent : _ChunkSize)) {
+                    result = false;
+                    break;
+                }
+            }
+
+            WaitDisplay();
+            _Display::EndWrite();
+            return result;
+        }
+
+        /**
+         * @brief Draws QOI image
+         *
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] offset File offset in source
+         * @param [in] size File size
+         *
+         * @retval true Image is drawn
+         * @retval false Source error, invalid or truncated file, image doesn't fit display coordinates
+         */
+        static bool DrawQoi(uint8_t x, uint8_t y, uint32_t offset, uint32_t size)
+        {
+            _decoder.Reset();
+            _fill = 0;
+            _output = 0;
+            _started = false;
+            _overflow = false;
+
+            uint8_t current = 0;
+            uint32_t requested = size < _ChunkSize ? size : _ChunkSize;
+            if (size == 0 || !StartRead(current, offset, requested))
+                return false;
+
+            bool result = true;
+            bool pending = true;
+            while (pending) {
+                const uint32_t chunk = _sizes[current];
+                pending = false;
+                if (!WaitRead()) {
+                    result = false;
+                    break;
+                }
+
+                // Next chunk is read while this one is decoded
+                if (requested < size) {
+                    const uint32_t next = size - requested < _ChunkSize ? size - requested : _ChunkSize;
+                    if (!StartRead(current ^ 1, offset + requested, next)) {
+                        result = false;
+                        break;
+                    }
+                    requested += next;
+                    pending = true;
+                }
+
+                _decoder.Feed(_input[current], chunk, [x, y](uint16_t pixel) {
+                    if (!_started) {
+                        if (_decoder.Width() > 0xff || _decoder.Height() > 0xff
+                            || x + _decoder.Width() > 0x100 || y + _decoder.Height() > 0x100) {
+                            _overflow = true;
+                            return;
+                        }
+                        _started = true;
+                        _Display::BeginWrite(x, y, _decoder.Width(), _decoder.Height());
+                    }
+                    Put(pixel);
+                });
+
+                if (_decoder.Failed() || _overflow || _decoder.Done())
+                    break;
+
+                current ^= 1;
+            }
+
+            // Source buffer must not be changed by DMA after return
+            if (pending)
+                WaitRead();
+
+            if (_started) {
+                if (_fill > 0) {
+                    WaitDisplay();
+                    StartDisplay(_pixels[_output], _fill * sizeof(uint16_t));
+                }
+                WaitDisplay();
+                _Display::EndWrite();
+            }
+
+            return result && _decoder.Done();
+        }
+
+    private:
+        /**
+         * @brief Stores decoded pixel and sends full pixel buffer
+         *
+         * @param [in] pixel Pixel
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Put(uint16_t pixel)
+        {
+            _pixels[_output][_fill++] = pixel;
+            if (_fill == PixelsPerChunk) {
+                // Display sends other buffer
+                WaitDisplay();
+                StartDisplay(_pixels[_output], _ChunkSize);
+                _output ^= 1;
+                _fill = 0;
+            }
+        }
+
+        static bool StartRead(uint8_t buffer, uint32_t offset, uint32_t size)
+        {
+            _sizes[buffer] = size;
+            _readComplete = false;
+            _readResult = false;
+
+            if constexpr (std::is_same_v<decltype(_Source::ReadAsync(offset, _input[buffer], static_cast<uint16_t>(size), ReadHandler)), bool>) {
+                if (!_Source::ReadAsync(offset, _input[buffer], static_cast<uint16_t>(size), ReadHandler)) {
+                    _readComplete = true;
+                    return false;
+                }
+            }
+            else {
+                _Source::ReadAsync(offset, _input[buffer], static_cast<uint16_t>(size), ReadHandler);
+            }
+            return true;
+        }
+
+        static bool WaitRead()
+        {
+            while (!_readComplete) {
+                if constexpr (requires { _Source::Process(); })
+                    _Source::Process();
+            }
+            return _readResult;
+        }
+
+        static void StartDisplay(const void* data, uint32_t size)
+        {
+            _displayComplete = false;
+            _Display::WritePixelsAsync(data, size, DisplayHandler);
+        }
+
+        static void WaitDisplay()
+        {
+            while (!_displayComplete) continue;
+        }
+
+        static void ReadHandler([[maybe_unused]] void* data, [[maybe_unused]] unsigned size, bool success)
+        {
+            _readResult = success;
+            _readComplete = true;
+        }
+
+        static void DisplayHandler([[maybe_unused]] void* data, [[maybe_unused]] unsigned size, [[maybe_unused]] bool success)
+        {
+            _displayComplete = true;
+        }
+
+        alignas(4) static inline uint8_t _input[2][_ChunkSize]; ///< Source chunks
+        static inline uint32_t _sizes[2]; ///< Source chunks sizes
+        alignas(4) static inline uint16_t _pixels[2][PixelsPerChunk]; ///< Decoded pixels
+        static inline unsigned _fill = 0; ///< Decoded pixels count in current buffer
+        static inline uint8_t _output = 0; ///< Current pixels buffer
+        static inline bool _started = false; ///< Display write is started
+        static inline bool _overflow = false; ///< Image doesn't fit display coordinates
+        static inline QoiDecoder _decoder; ///< QOI decoder
+        static inline volatile bool _readComplete = true; ///< Source read is complete
+        static inline volatile bool _readResult = false; ///< Source read result
+        static inline volatile bool _displayComplete = true; ///< Display chunk is sent
+    };
+}
+
+#endif //! ZHELE_DRIVERS_IMAGE_STREAM_H
@@ -0,0 +1,793 @@
+/**
+ * @file
+ * Implements methods of FAT32 file system class
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_FAT32_IMPL_H
+#define ZHELE_DRIVERS_FAT32_IMPL_H
+
+namespace Zhele::Drivers
+{
+    #define FAT32_TEMPLATE_ARGS template<typename _BlockDevice, unsigned _CacheSectors>
+    #define FAT32_TEMPLATE_QUALIFIER Fat32<_BlockDevice, _CacheSectors>
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::Mount()
+    {
+        _mounted = false;
+        for(auto& sector : _cache)
+        {
+            sector.Lba = NoSector;
+            sector.LastUse = 0;
+            sector.Dirty = false;
+        }
+
+        const uint8_t* sector = GetSector(0, Access::Read);
+        if(sector == nullptr || Get16(sector + 510) != 0xaa55)
+            return false;
+
+        uint32_t volumeStart = 0;
+        if(!IsBootSector(sector))
+        {
+            // MBR: first primary partition with FAT32 (CHS or LBA) type
+            for(unsigned i = 0; i < 4 && volumeStart == 0; ++i)
+            {
+                const uint8_t* partition = sector + 446 + i * 16;
+                if(partition[4] == 0x0b || partition[4] == 0x0c)
+                    volumeStart = Get32(partition + 8);
+            }
+            if(volumeStart == 0)
+                return false;
+
+            sector = GetSector(volumeStart, Access::Read);
+            if(sector == nullptr || Get16(sector + 510) != 0xaa55 || !IsBootSector(sector))
+                return false;
+        }
+
+        _clusterShift = std::countr_zero(static_cast<unsigned>(sector[13]));
+        _fatStart = volumeStart + Get16(sector + 14);
+        _fatCount = sector[16];
+        _fatSize = Get32(sector + 36);
+        _dataStart = _fatStart + _fatCount * _fatSize;
+        _clusterCount = std::min((volumeStart + Get32(sector + 32) - _dataStart) >> _clusterShift, _fatSize * (SectorSize / 4) - 2);
+        _rootCluster = Get32(sector + 44);
+        uint16_t fsInfo = Get16(sector + 48);
+        _fsInfoSector = (fsInfo != 0 && fsInfo != 0xffff) ? volumeStart + fsInfo : 0;
+        _nextFree = 2;
+        _fsInfoDirty = false;
+
+        if(!IsCluster(_rootCluster))
+            return false;
+
+        if(_fsInfoSector != 0)
+        {
+            sector = GetSector(_fsInfoSector, Access::Read);
+            if(sector == nullptr)
+                return false;
+            if(Get32(sector) == 0x41615252 && Get32(sector + 484) == 0x61417272 && IsCluster(Get32(sector + 492)))
+                _nextFree = Get32(sector + 492);
+        }
+
+        _mounted = true;
+        return true;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::Flush()
+    {
+        if(_fsInfoDirty && _fsInfoSector != 0)
+        {
+            uint8_t* sector = GetSector(_fsInfoSector, Access::Modify);
+            if(sector == nullptr)
+                return false;
+            if(Get32(sector) == 0x41615252 && Get32(sector + 484) == 0x61417272)
+            {
+                // Free clusters count is not tracked
+                Put32(sector + 488, 0xffffffff);
+                Put32(sector + 492, _nextFree);
+            }
+            _fsInfoDirty = false;
+        }
+
+        bool result = true;
+        for(auto& sector : _cache)
+            result = WriteBack(sector) && result;
+        return result;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::IsBootSector(const uint8_t* sector)
+    {
+        return (sector[0] == 0xeb || sector[0] == 0xe9)
+            && Get16(sector + 11) == SectorSize
+            && sector[13] != 0 && std::has_single_bit(static_cast<unsigned>(sector[13]))
+            && sector[16] != 0
+            && Get16(sector + 17) == 0 // Root entries count (FAT12/16 only)
+            && Get16(sector + 22) == 0 // FAT16 size
+            && Get32(sector + 36) != 0;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    uint8_t* FAT32_TEMPLATE_QUALIFIER::GetSector(uint32_t lba, Access access)
+    {
+        CacheSector* victim = &_cache[0];
+        for(auto& sector : _cache)
+        {
+            if(sector.Lba == lba)
+            {
+                sector.LastUse = ++_useCounter;
+                sector.Dirty = sector.Dirty || access != Access::Read;
+                return sector.Data;
+            }
+            if(sector.LastUse < victim->LastUse)
+                victim = &sector;
+        }
+
+        if(!WriteBack(*victim))
+            return nullptr;
+        victim->Lba = NoSector;
+        victim->LastUse = 0;
+
+        if(access == Access::Overwrite)
+            memset(victim->Data, 0, SectorSize);
+        else if(!_BlockDevice::ReadBlock(victim->Data, lba))
+            return nullptr;
+
+        victim->Lba = lba;
+        victim->LastUse = ++_useCounter;
+        victim->Dirty = access != Access::Read;
+        return victim->Data;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::WriteBack(CacheSector& sector)
+    {
+        if(!sector.Dirty)
+            return true;
+
+        const uint8_t* data = sector.Data;
+        if(!_BlockDevice::WriteBlock(data, sector.Lba))
+            return false;
+        // FAT mirrors
+        if(sector.Lba >= _fatStart && sector.Lba < _fatStart + _fatSize)
+        {
+            for(unsigned i = 1; i < _fatCount; ++i)
+            {
+                if(!_BlockDevice::WriteBlock(data, sector.Lba + i * _fatSize))
+                    return false;
+            }
+        }
+        sector.Dirty = false;
+        return true;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::PrepareDirect(uint32_t lba, uint32_t count, bool write)
+    {
+        for(auto& sector : _cache)
+        {
+            if(sector.Lba == NoSector || sector.Lba - lba >= count)
+                continue;
+            if(write)
+            {
+                sector.Lba = NoSector;
+                sector.LastUse = 0;
+                sector.Dirty = false;
+            }
+            else if(!WriteBack(sector))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::GetFat(uint32_t cluster, uint32_t& value)
+    {
+        const uint8_t* sector = GetSector(_fatStart + cluster / (SectorSize / 4), Access::Read);
+        if(sector == nullptr)
+            return false;
+        value = Get32(sector + (cluster % (SectorSize / 4)) * 4) & ClusterMask;
+        return true;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::SetFat(uint32_t cluster, uint32_t value)
+    {
+        uint8_t* sector = GetSector(_fatStart + cluster / (SectorSize / 4), Access::Modify);
+        if(sector == nullptr)
+            return false;
+        uint8_t* entry = sector + (cluster % (SectorSize / 4)) * 4;
+        Put32(entry, (Get32(entry) & ~ClusterMask) | (value & ClusterMask));
+        return true;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    uint32_t FAT32_TEMPLATE_QUALIFIER::ContiguousClusters(uint32_t cluster, uint32_t limit)
+    {
+        // Neighbour entries are in cached FAT sector, so run is got by one sector read
+        uint32_t count = 1;
+        uint32_t next;
+        while(count < limit && GetFat(cluster + count - 1, next) && next == cluster + count)
+            ++count;
+        return count;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::FindCluster(uint32_t first, uint32_t index, uint32_t& cluster, uint32_t& runEnd)
+    {
+        cluster = first;
+        while(IsCluster(cluster))
+        {
+            uint32_t run = ContiguousClusters(cluster, index + 1);
+            if(index < run)
+            {
+                cluster += index;
+                runEnd = cluster + run - index;
+                return true;
+            }
+            index -= run;
+            if(!GetFat(cluster + run - 1, cluster))
+                return false;
+        }
+        return false;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    uint32_t FAT32_TEMPLATE_QUALIFIER::Allocate(uint32_t previous, uint32_t count)
+    {
+        uint32_t start = 0;
+        uint32_t length = 0;
+        uint32_t cluster = _nextFree;
+        for(uint32_t i = 0; i < _clusterCount && length < count; ++i, ++cluster)
+        {
+            if(!IsCluster(cluster))
+            {
+                // Run can't wrap volume end
+                cluster = 2;
+                length = 0;
+            }
+            uint32_t value;
+            if(!GetFat(cluster, value))
+                return 0;
+            if(value != 0)
+            {
+                length = 0;
+                continue;
+            }
+            if(length++ == 0)
+                start = cluster;
+        }
+        if(length < count)
+            return 0;
+
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            if(!SetFat(start + i, i + 1 == count ? EndOfChain : start + i + 1))
+                return 0;
+        }
+        if(previous != 0 && !SetFat(previous, start))
+            return 0;
+
+        _nextFree = IsCluster(start + count) ? start + count : 2;
+        _fsInfoDirty = true;
+        return start;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::FreeChain(uint32_t cluster)
+    {
+        while(IsCluster(cluster))
+        {
+            uint32_t next;
+            if(!GetFat(cluster, next) || !SetFat(cluster, 0))
+                return false;
+            if(cluster < _nextFree)
+                _nextFree = cluster;
+            cluster = next;
+        }
+        _fsInfoDirty = true;
+        return true;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::MakeName(const char*& path, uint8_t* name)
+    {
+        memset(name, ' ', 11);
+        while(*path == '/')
+            ++path;
+        if(*path == 0)
+            return false;
+
+        unsigned length = 0;
+        unsigned limit = 8;
+        for(; *path != 0 && *path != '/'; ++path)
+        {
+            char c = *path;
+            if(c == '.')
+            {
+                if(limit == 11 || length == 0)
+                    return false;
+                length = 8;
+                limit = 11;
+                continue;
+            }
+            if(length >= limit || c <= ' ' || strchr("\"*+,/:;<=>?[\\]|", c) != nullptr)
+                return false;
+            if(c >= 'a' && c <= 'z')
+                c -= 'a' - 'A';
+            name[length++] = c;
+        }
+
+        while(*path == '/')
+            ++path;
+        return true;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::FindEntry(uint32_t directory, const uint8_t* name, uint32_t& sector, uint8_t& index, bool& found)
+    {
+        sector = NoSector;
+        found = false;
+
+        for(uint32_t cluster = directory; IsCluster(cluster);)
+        {
+            uint32_t lba = ClusterLba(cluster);
+            for(uint32_t i = 0; i < (1u << _clusterShift); ++i)
+            {
+                const uint8_t* data = GetSector(lba + i, Access::Read);
+                if(data == nullptr)
+                    return false;
+
+                for(uint8_t j = 0; j < SectorSize / EntrySize; ++j)
+                {
+                    const uint8_t* entry = data + j * EntrySize;
+                    if(entry[0] == 0x00 || entry[0] == 0xe5)
+                    {
+                        if(sector == NoSector)
+                        {
+                            sector = lba + i;
+                            index = j;
+                        }
+                        // Zero marks end of directory
+                        if(entry[0] == 0x00)
+                            return true;
+                        continue;
+                    }
+                    // Long name entries have volume ID attribute too
+                    if((entry[11] & AttrVolumeId) == 0 && memcmp(entry, name, 11) == 0)
+                    {
+                        sector = lba + i;
+                        index = j;
+                        found = true;
+                        return true;
+                    }
+                }
+            }
+            if(!GetFat(cluster, cluster))
+                return false;
+        }
+        return true;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    uint32_t FAT32_TEMPLATE_QUALIFIER::ExtendDirectory(uint32_t directory)
+    {
+        uint32_t last = directory;
+        for(uint32_t next; GetFat(last, next) && IsCluster(next);)
+            last = next;
+
+        uint32_t cluster = Allocate(last, 1);
+        if(cluster == 0)
+            return NoSector;
+
+        uint32_t lba = ClusterLba(cluster);
+        for(uint32_t i = 0; i < (1u << _clusterShift); ++i)
+        {
+            if(GetSector(lba + i, Access::Overwrite) == nullptr)
+                return NoSector;
+        }
+        return lba;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::File::Open(const char* path, uint8_t mode)
+    {
+        if(!_mounted || IsOpen() || (mode & (Fat32::Read | Fat32::Write | Create | Truncate | Append)) == 0)
+            return false;
+        if(mode & (Create | Truncate | Append))
+            mode |= Fat32::Write;
+
+        uint32_t directory = _rootCluster;
+        uint8_t name[11];
+        uint32_t sector;
+        uint8_t index;
+        for(;;)
+        {
+            bool found;
+            if(!MakeName(path, name) || !FindEntry(directory, name, sector, index, found))
+                return false;
+
+            if(*path != 0)
+            {
+                const uint8_t* entry = found ? GetSector(sector, Access::Read) : nullptr;
+                if(entry == nullptr || (entry[index * EntrySize + 11] & AttrDirectory) == 0)
+                    return false;
+                directory = EntryCluster(entry + index * EntrySize);
+                if(directory == 0)
+                    directory = _rootCluster;
+                continue;
+            }
+
+            if(!found)
+            {
+                if((mode & Create) == 0)
+                    return false;
+                if(sector == NoSector)
+                {
+                    sector = ExtendDirectory(directory);
+                    index = 0;
+                    if(sector == NoSector)
+                        return false;
+                }
+
+                uint8_t* entry = GetSector(sector, Access::Modify);
+                if(entry == nullptr)
+                    return false;
+                entry += index * EntrySize;
+                memset(entry, 0, EntrySize);
+                memcpy(entry, name, 11);
+                entry[11] = AttrArchive;
+                Put16(entry + 14, _time);
+                Put16(entry + 16, _date);
+                Put16(entry + 18, _date);
+                Put16(entry + 22, _time);
+                Put16(entry + 24, _date);
+            }
+            break;
+        }
+
+        const uint8_t* entry = GetSector(sector, Access::Read);
+        if(entry == nullptr)
+            return false;
+        entry += index * EntrySize;
+        if((entry[11] & (AttrDirectory | AttrVolumeId)) != 0 || ((mode & Fat32::Write) && (entry[11] & AttrReadOnly)))
+            return false;
+
+        _firstCluster = EntryCluster(entry);
+        _size = Get32(entry + 28);
+        _entrySector = sector;
+        _entryIndex = index;
+        _position = 0;
+        _cluster = 0;
+        _runEnd = 0;
+        _dirty = false;
+        _mode = mode;
+
+        if((mode & Truncate) && _firstCluster != 0)
+        {
+            if(!FreeChain(_firstCluster))
+            {
+                _mode = 0;
+                return false;
+            }
+            _firstCluster = 0;
+            _size = 0;
+            _dirty = true;
+        }
+
+        if((mode & Append) && !Seek(_size))
+        {
+            _mode = 0;
+            return false;
+        }
+        return true;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    unsigned FAT32_TEMPLATE_QUALIFIER::File::Read(void* buffer, unsigned size)
+    {
+        if(!IsOpen() || (_mode & Fat32::Read) == 0)
+            return 0;
+        if(size > _size - _position)
+            size = _size - _position;
+
+        uint8_t* data = static_cast<uint8_t*>(buffer);
+        const uint32_t clusterMask = (SectorSize << _clusterShift) - 1;
+        unsigned done = 0;
+        while(done < size)
+        {
+            unsigned remaining = size - done;
+            if((_position & clusterMask) == 0 && !NextCluster(false, ClustersFor(remaining)))
+                break;
+
+            uint32_t sectorInCluster = (_position & clusterMask) >> SectorShift;
+            uint32_t offset = _position & (SectorSize - 1);
+            uint32_t lba = ClusterLba(_cluster) + sectorInCluster;
+            unsigned chunk;
+            if(offset == 0 && remaining >= SectorSize && (reinterpret_cast<uintptr_t>(data + done) & 0x03) == 0)
+            {
+                // Whole sectors of contiguous run are read directly to user buffer
+                uint32_t count = std::min<uint32_t>(remaining / SectorSize, ((_runEnd - _cluster) << _clusterShift) - sectorInCluster);
+                if(!PrepareDirect(lba, count, false))
+                    break;
+                if(!(count == 1
+                        ? _BlockDevice::ReadBlock(data + done, lba)
+                        : _BlockDevice::ReadMultipleBlock(data + done, lba, count)))
+                    break;
+                _cluster += (sectorInCluster + count - 1) >> _clusterShift;
+                chunk = count * SectorSize;
+            }
+            else
+            {
+                const uint8_t* sector = GetSector(lba, Access::Read);
+                if(sector == nullptr)
+                    break;
+                chunk = std::min<unsigned>(SectorSize - offset, remaining);
+                memcpy(data + done, sector + offset, chunk);
+            }
+            _position += chunk;
+            done += chunk;
+        }
+        return done;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    unsigned FAT32_TEMPLATE_QUALIFIER::File::Write(const void* data, unsigned size)
+    {
+        if(!IsOpen() || (_mode & Fat32::Write) == 0)
+            return 0;
+        // Max FAT file size is 4 GiB - 1
+        if(size > 0xffffffff - _position)
+            size = 0xffffffff - _position;
+
+        const uint8_t* source = static_cast<const uint8_t*>(data);
+        const uint32_t clusterMask = (SectorSize << _clusterShift) - 1;
+        unsigned done = 0;
+        while(done < size)
+        {
+            unsigned remaining = size - done;
+            if((_position & clusterMask) == 0 && !NextCluster(true, ClustersFor(remaining)))
+                break;
+
+            uint32_t sectorInCluster = (_position & clusterMask) >> SectorShift;
+            uint32_t offset = _position & (SectorSize - 1);
+            uint32_t lba = ClusterLba(_cluster) + sectorInCluster;
+            unsigned chunk;
+            if(offset == 0 && remaining >= SectorSize && (reinterpret_cast<uintptr_t>(source + done) & 0x03) == 0)
+            {
+                // Whole sectors of contiguous run are written directly from user buffer
+                uint32_t count = std::min<uint32_t>(remaining / SectorSize, ((_runEnd - _cluster) << _clusterShift) - sectorInCluster);
+                if(!PrepareDirect(lba, count, true))
+                    break;
+                if(!(count == 1
+                        ? _BlockDevice::WriteBlock(source + done, lba)
+                        : _BlockDevice::WriteMultipleBlock(source + done, lba, count)))
+                    break;
+                _cluster += (sectorInCluster + count - 1) >> _clusterShift;
+                chunk = count * SectorSize;
+            }
+            else
+            {
+                chunk = std::min<unsigned>(SectorSize - offset, remaining);
+                // Sector after end of file has no data, so it's not read
+                Access access = (offset == 0 && (_position >= _size || chunk == SectorSize)) ? Access::Overwrite : Access::Modify;
+                uint8_t* sector = GetSector(lba, access);
+                if(sector == nullptr)
+                    break;
+                memcpy(sector + offset, source + done, chunk);
+            }
+            _position += chunk;
+            done += chunk;
+            if(_position > _size)
+                _size = _position;
+            _dirty = true;
+        }
+        return done;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::File::Seek(uint32_t position)
+    {
+        if(!IsOpen() || position > _size)
+            return false;
+
+        _position = position;
+        _cluster = 0;
+        _runEnd = 0;
+        // Cluster of first byte is got on access
+        if(position == 0)
+            return true;
+
+        if(!FindCluster(_firstCluster, (position - 1) >> (_clusterShift + SectorShift), _cluster, _runEnd))
+        {
+            _position = 0;
+            _cluster = 0;
+            return false;
+        }
+        return true;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::File::Preallocate(uint32_t size)
+    {
+        if(!IsOpen() || (_mode & Fat32::Write) == 0)
+            return false;
+
+        uint32_t required = ClustersFor(size);
+        uint32_t count = 0;
+        uint32_t last = 0;
+        for(uint32_t cluster = _firstCluster; IsCluster(cluster) && count < required;)
+        {
+            uint32_t run = ContiguousClusters(cluster, required - count);
+            count += run;
+            last = cluster + run - 1;
+            if(!GetFat(last, cluster))
+                return false;
+        }
+        if(count >= required)
+            return true;
+
+        uint32_t first = Allocate(last, required - count);
+        if(first == 0)
+            return false;
+        if(last == 0)
+            _firstCluster = first;
+        _dirty = true;
+
+        // Allocation is written, so it's kept after power loss
+        return Sync();
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::File::Sync()
+    {
+        if(!IsOpen())
+            return false;
+
+        if(_dirty)
+        {
+            uint8_t* entry = GetSector(_entrySector, Access::Modify);
+            if(entry == nullptr)
+                return false;
+            entry += _entryIndex * EntrySize;
+            entry[11] |= AttrArchive;
+            Put16(entry + 18, _date);
+            Put16(entry + 20, _firstCluster >> 16);
+            Put16(entry + 22, _time);
+            Put16(entry + 24, _date);
+            Put16(entry + 26, _firstCluster & 0xffff);
+            Put32(entry + 28, _size);
+            _dirty = false;
+        }
+        return Flush();
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::File::Close()
+    {
+        if(!IsOpen())
+            return false;
+
+        bool result = (_mode & Fat32::Write) == 0 || ReleaseUnused();
+        result = Sync() && result;
+        _mode = 0;
+        return result;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::File::NextCluster(bool allocate, uint32_t clusters)
+    {
+        uint32_t next = _firstCluster;
+        if(_position != 0)
+        {
+            if(_cluster + 1 < _runEnd)
+            {
+                ++_cluster;
+                return true;
+            }
+            if(!GetFat(_cluster, next))
+                return false;
+        }
+
+        if(!IsCluster(next))
+        {
+            if(!allocate)
+                return false;
+
+            // Whole request is allocated at once (so it's written by multiple block write)
+            uint32_t previous = _position != 0 ? _cluster : 0;
+            next = Allocate(previous, clusters);
+            if(next == 0 && clusters > 1)
+                next = Allocate(previous, 1);
+            if(next == 0)
+                return false;
+            if(previous == 0)
+                _firstCluster = next;
+            _dirty = true;
+        }
+
+        _cluster = next;
+        _runEnd = next + ContiguousClusters(next, clusters);
+        return true;
+    }
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::File::ReleaseUnused()
+    {
+        if(_firstCluster == 0)
+            return true;
+
+        if(_size == 0)
+        {
+            if(!FreeChain(_firstCluster))
+                return false;
+            _firstCluster = 0;
+            _cluster = 0;
+            _runEnd = 0;
+            _dirty = true;
+            return true;
+        }
+
+        uint32_t last;
+        uint32_t runEnd;
+        uint32_t next;
+        if(!FindCluster(_firstCluster, ClustersFor(_size) - 1, last, runEnd) || !GetFat(last, next))
+            return false;
+        if(!IsCluster(next))
+            return true;
+        return SetFat(last, EndOfChain) && FreeChain(next);
+    }
+
+    FAT32_TEMPLATE_ARGS
+    typename FAT32_TEMPLATE_QUALIFIER::CacheSector FAT32_TEMPLATE_QUALIFIER::_cache[_CacheSectors];
+
+    FAT32_TEMPLATE_ARGS
+    uint32_t FAT32_TEMPLATE_QUALIFIER::_useCounter = 0;
+
+    FAT32_TEMPLATE_ARGS
+    uint32_t FAT32_TEMPLATE_QUALIFIER::_fatStart = 0;
+
+    FAT32_TEMPLATE_ARGS
+    uint32_t FAT32_TEMPLATE_QUALIFIER::_fatSize = 0;
+
+    FAT32_TEMPLATE_ARGS
+    uint8_t FAT32_TEMPLATE_QUALIFIER::_fatCount = 0;
+
+    FAT32_TEMPLATE_ARGS
+    uint8_t FAT32_TEMPLATE_QUALIFIER::_clusterShift = 0;
+
+    FAT32_TEMPLATE_ARGS
+    uint32_t FAT32_TEMPLATE_QUALIFIER::_dataStart = 0;
+
+    FAT32_TEMPLATE_ARGS
+    uint32_t FAT32_TEMPLATE_QUALIFIER::_clusterCount = 0;
+
+    FAT32_TEMPLATE_ARGS
+    uint32_t FAT32_TEMPLATE_QUALIFIER::_rootCluster = 0;
+
+    FAT32_TEMPLATE_ARGS
+    uint32_t FAT32_TEMPLATE_QUALIFIER::_fsInfoSector = 0;
+
+    FAT32_TEMPLATE_ARGS
+    uint32_t FAT32_TEMPLATE_QUALIFIER::_nextFree = 2;
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::_fsInfoDirty = false;
+
+    FAT32_TEMPLATE_ARGS
+    bool FAT32_TEMPLATE_QUALIFIER::_mounted = false;
+
+    FAT32_TEMPLATE_ARGS
+    uint16_t FAT32_TEMPLATE_QUALIFIER::_date = FAT32_TEMPLATE_QUALIFIER::MakeDate(2024, 1, 1);
+
+    FAT32_TEMPLATE_ARGS
+    uint16_t FAT32_TEMPLATE_QUALIFIER::_time = 0;
+}
+
+#endif //! ZHELE_DRIVERS_FAT32_IMPL_H
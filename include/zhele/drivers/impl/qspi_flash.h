@@ -0,0 +1,194 @@
+/**
+ * @file
+ * Implements QSPI NOR flash driver
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_QSPI_FLASH_IMPL_H
+#define ZHELE_DRIVERS_QSPI_FLASH_IMPL_H
+
+namespace Zhele::Drivers
+{
+    #define QSPI_FLASH_TEMPLATE_ARGS template<typename _QuadSpi, uint32_t _Size, QspiQuadEnable _QuadEnable>
+    #define QSPI_FLASH_TEMPLATE_QUALIFIER QspiFlash<_QuadSpi, _Size, _QuadEnable>
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    template<uint32_t frequency, uint32_t clockFrequency>
+    bool QSPI_FLASH_TEMPLATE_QUALIFIER::Init()
+    {
+        _QuadSpi::template Init<frequency, clockFrequency>(static_cast<uint8_t>(std::countr_zero(_Size)));
+
+        // Software reset leaves continuous read and QPI modes
+        _QuadSpi::Command(ResetEnable);
+        _QuadSpi::Command(Reset);
+        if (!WaitReady())
+            return false;
+
+        uint32_t id = JedecId();
+        if (id == 0 || id == 0xffffff)
+            return false;
+
+        if (!EnableQuadMode())
+            return false;
+
+        EnableMemoryMapped();
+        return true;
+    }
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    uint32_t QSPI_FLASH_TEMPLATE_QUALIFIER::JedecId()
+    {
+        uint8_t id[3] {};
+        bool memoryMapped = _QuadSpi::MemoryMapped();
+        _QuadSpi::Read(ReadId, 0, id, sizeof(id));
+        if (memoryMapped)
+            EnableMemoryMapped();
+        return (id[0] << 16) | (id[1] << 8) | id[2];
+    }
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    void QSPI_FLASH_TEMPLATE_QUALIFIER::EnableMemoryMapped()
+    {
+        _QuadSpi::EnableMemoryMapped(QuadRead);
+    }
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    bool QSPI_FLASH_TEMPLATE_QUALIFIER::Read(uint32_t offset, void* data, uint32_t size)
+    {
+        bool memoryMapped = _QuadSpi::MemoryMapped();
+        bool result = _QuadSpi::Read(QuadRead, offset, data, size);
+        if (memoryMapped)
+            EnableMemoryMapped();
+        return result;
+    }
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    void QSPI_FLASH_TEMPLATE_QUALIFIER::ReadAsync(uint32_t offset, void* data, uint32_t size, TransferCallback callback)
+    {
+        _QuadSpi::ReadAsync(QuadRead, offset, data, size, callback);
+    }
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    unsigned QSPI_FLASH_TEMPLATE_QUALIFIER::AddressToPage(const void* address)
+    {
+        return (reinterpret_cast<uintptr_t>(address) - _QuadSpi::MappedAddress) / SectorSize;
+    }
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    bool QSPI_FLASH_TEMPLATE_QUALIFIER::WaitReady()
+    {
+        // Write in progress bit is polled by QUADSPI
+        return _QuadSpi::AutoPoll(ReadStatus1, 0x01, 0x00);
+    }
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    bool QSPI_FLASH_TEMPLATE_QUALIFIER::EnableQuadMode()
+    {
+        if constexpr (_QuadEnable == QspiQuadEnable::None)
+        {
+            return true;
+        }
+        else
+        {
+            constexpr bool statusRegister1 = _QuadEnable == QspiQuadEnable::StatusRegister1Bit6;
+            constexpr uint8_t quadEnableBit = statusRegister1 ? 0x40 : 0x02;
+
+            uint8_t status = 0;
+            if (!_QuadSpi::Read(statusRegister1 ? ReadStatus1 : ReadStatus2, 0, &status, 1))
+                return false;
+            if (status & quadEnableBit)
+                return true;
+
+            status |= quadEnableBit;
+            return _QuadSpi::Command(WriteEnable)
+                && _QuadSpi::Write(statusRegister1 ? WriteStatus1 : WriteStatus2, 0, &status, 1)
+                && WaitReady();
+        }
+    }
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    bool QSPI_FLASH_TEMPLATE_QUALIFIER::ErasePage(uint32_t page)
+    {
+        if (page >= PageCount())
+            return false;
+
+        bool memoryMapped = _QuadSpi::MemoryMapped();
+        bool result = _QuadSpi::Command(WriteEnable)
+            && _QuadSpi::Command(SectorErase, page * SectorSize)
+            && WaitReady();
+        if (memoryMapped)
+            EnableMemoryMapped();
+        return result;
+    }
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    bool QSPI_FLASH_TEMPLATE_QUALIFIER::WritePage(void* dst, const void* src, unsigned size)
+    {
+        unsigned page = AddressToPage(dst);
+        uint32_t offset = reinterpret_cast<uintptr_t>(dst) - PageAddress(page);
+        if (page >= PageCount() || offset + size > SectorSize)
+            return false;
+
+        return WriteFlash(dst, src, size);
+    }
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    bool QSPI_FLASH_TEMPLATE_QUALIFIER::WritePage(unsigned page, const void* src, unsigned size, unsigned offset)
+    {
+        if (page >= PageCount() || offset + size > SectorSize)
+            return false;
+
+        return WriteFlash(reinterpret_cast<uint8_t*>(PageAddress(page)) + offset, src, size);
+    }
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    bool QSPI_FLASH_TEMPLATE_QUALIFIER::Program(uint32_t offset, const uint8_t* data, unsigned size)
+    {
+        // Source in mapped region can't be read while memory-mapped mode is disabled
+        uint8_t bounce[ProgramPageSize];
+        uintptr_t source = reinterpret_cast<uintptr_t>(data);
+        if (source >= _QuadSpi::MappedAddress && source < _QuadSpi::MappedAddress + _Size)
+        {
+            if (!_QuadSpi::Read(QuadRead, source - _QuadSpi::MappedAddress, bounce, size))
+                return false;
+            data = bounce;
+        }
+
+        return _QuadSpi::Command(WriteEnable)
+            && _QuadSpi::Write(QuadProgram, offset, data, size)
+            && WaitReady();
+    }
+
+    QSPI_FLASH_TEMPLATE_ARGS
+    bool QSPI_FLASH_TEMPLATE_QUALIFIER::WriteFlash(void* dst, const void* src, unsigned size)
+    {
+        uint32_t offset = reinterpret_cast<uintptr_t>(dst) - _QuadSpi::MappedAddress;
+        if (offset >= _Size || size > _Size - offset)
+            return false;
+
+        bool memoryMapped = _QuadSpi::MemoryMapped();
+        const uint8_t* data = static_cast<const uint8_t*>(src);
+        bool result = true;
+        while (size > 0 && result)
+        {
+            // Program command wraps inside 256-byte page, so data is split by page boundaries
+            unsigned chunk = ProgramPageSize - offset % ProgramPageSize;
+            if (chunk > size)
+                chunk = size;
+
+            result = Program(offset, data, chunk);
+            offset += chunk;
+            data += chunk;
+            size -= chunk;
+        }
+
+        if (memoryMapped)
+            EnableMemoryMapped();
+        return result;
+    }
+}
+
+#endif //! ZHELE_DRIVERS_QSPI_FLASH_IMPL_H
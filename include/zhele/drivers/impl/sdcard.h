@@ -12,9 +12,12 @@
 
 namespace Zhele::Drivers
 {
-    template<typename _SpiModule, typename _CsPin>
-    uint16_t SdCard<_SpiModule, _CsPin>::SpiCommand(uint8_t index, uint32_t arg, uint8_t crc)
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    uint16_t SdCard<_SpiModule, _CsPin, _UseCrc>::SpiCommand(uint8_t index, uint32_t arg, uint8_t crc)
     {
+        if constexpr (_UseCrc)
+            crc = Crc7(index | (1 << 6), arg);
+
         _CsPin::Clear();
         //Spi.Read();
         Spi.Write(index | (1 << 6));
@@ -29,17 +32,20 @@ namespace Zhele::Drivers
     }
 
 
-    template<class _SpiModule, class _CsPin>
-    bool SdCard<_SpiModule, _CsPin>::CheckStatus()
+    template<class _SpiModule, class _CsPin, bool _UseCrc>
+    bool SdCard<_SpiModule, _CsPin, _UseCrc>::CheckStatus()
     {
         return SpiCommand(SendStatus, 0) == 0;
     }
 
-    template<class _SpiModule, class _CsPin>
-    SdCardType SdCard<_SpiModule, _CsPin>::Detect()
+    template<class _SpiModule, class _CsPin, bool _UseCrc>
+    SdCardType SdCard<_SpiModule, _CsPin, _UseCrc>::Detect()
     {
         _type = SdCardNone;
 
+        // Card identification runs at low speed
+        _SpiModule::SetFrequency(InitFrequency);
+
         _CsPin::SetDirWrite();
         _CsPin::Set();
 
@@ -50,7 +56,7 @@ namespace Zhele::Drivers
             return _type;
 
         uint8_t resp;
-        uint16_t timeout = 10000;
+        Deadline deadline(InitTimeout, 10000);
 
         // test for SDCv2
         if(SpiCommand(SendIfCond, 0x1aa, 0x87) <= SdR1Idle)
@@ -68,9 +74,9 @@ namespace Zhele::Drivers
                         continue;
                         
                     resp = SpiCommand(SdSendOpCond, 1ul << 30);
-                    delay_ms<50, F_CPU>();
+                    SystemTime::Sleep(50);
                     
-                }while(resp != 0 && --timeout);
+                }while(resp != 0 && !deadline.Expired());
 
                 if(resp == 0 && !SpiCommand(ReadOcr, 0))
                 {
@@ -86,10 +92,10 @@ namespace Zhele::Drivers
             // try SD_SEND_OP_COND for SDSC
             if(SpiCommand(AppCmd, 0) <= SdR1Idle && (resp = SpiCommand(SdSendOpCond, 0)) <= SdR1Idle)
             {
-                while(resp != 0 && --timeout)
+                while(resp != 0 && !deadline.Expired())
                 {
                     resp = SpiCommand(SendOpCond, 0);
-                    delay_ms<50, F_CPU>();
+                    SystemTime::Sleep(50);
                 }
 
                 if(resp == 0)
@@ -100,18 +106,28 @@ namespace Zhele::Drivers
                 do
                 {
                     resp = SpiCommand(SendOpCond, 0);
-                    delay_ms<50, F_CPU>();
-                }while(resp != 0 && --timeout);
+                    SystemTime::Sleep(50);
+                }while(resp != 0 && !deadline.Expired());
 
                 if(resp == SdR1Idle)
                     _type = SdCardMmc;
             }
         }
+
+        if constexpr (_UseCrc)
+        {
+            if(_type != SdCardNone && SpiCommand(CrcOnOff, 1) != 0)
+                _type = SdCardNone;
+        }
+
+        if(_type != SdCardNone)
+            _SpiModule::SetFrequency(DataFrequency);
+
         return _type;
     }
 
-    template<class _SpiModule, class _CsPin>
-    uint32_t SdCard<_SpiModule, _CsPin>::ReadBlocksCount()
+    template<class _SpiModule, class _CsPin, bool _UseCrc>
+    uint32_t SdCard<_SpiModule, _CsPin, _UseCrc>::ReadBlocksCount()
     {
         uint8_t csd[16];
         if(!SpiCommand(SendCsd, 0) && ReadDataBlock(csd, 16))
@@ -119,37 +135,315 @@ namespace Zhele::Drivers
             if(csd[0] & 0xC0) // SD v2
             {
                 uint32_t c_size = (((uint32_t)csd[7] & 0x3F) << 16) | ((uint32_t)csd[8] << 8) | csd[9];
-                return (c_size + 1) * 1024u - 1u;
+                return (c_size + 1) * 1024u;
             }else // SD v1
             {
                 uint32_t c_size = ((((uint32_t)csd[6] << 16) | ((uint32_t)csd[7] << 8) | csd[8]) & 0x0003FFC0) >> 6;
                 uint16_t c_size_mult = ((uint16_t)((csd[9] & 0x03) << 1)) | ((uint16_t)((csd[10] & 0x80) >> 7));
                 uint16_t block_len = csd[5] & 0x0F;
                 block_len = 1u << (block_len - 9);
-                return ((c_size + 1u) * (1u << (c_size_mult + 2u)) * block_len) - 1u;
+                return (c_size + 1u) * (1u << (c_size_mult + 2u)) * block_len;
             }
         }
         return 0;
     }
 
-    template<class _SpiModule, class _CsPin>
-    uint32_t SdCard<_SpiModule, _CsPin>::BlocksCount()
+    template<class _SpiModule, class _CsPin, bool _UseCrc>
+    uint32_t SdCard<_SpiModule, _CsPin, _UseCrc>::BlocksCount()
     {
         // TODO: cache this value
         return ReadBlocksCount();
     }
 
-    template<class _SpiModule, class _CsPin>
-    size_t SdCard<_SpiModule, _CsPin>::BlockSize()
+    template<class _SpiModule, class _CsPin, bool _UseCrc>
+    size_t SdCard<_SpiModule, _CsPin, _UseCrc>::BlockSize()
     {
         return 512;
     }
 
-    template<class _SpiModule, class _CsPin>
-    bool SdCard<_SpiModule, _CsPin>::WaitWhileBusy()
+    template<class _SpiModule, class _CsPin, bool _UseCrc>
+    bool SdCard<_SpiModule, _CsPin, _UseCrc>::WaitWhileBusy()
     {
         _CsPin::Clear();
-        return Spi.Ignore(10000u, 0xff) == 0xff;
+
+        // 10000 bytes without system time
+        Deadline deadline(WriteTimeout, 10000 / CommandTimeoutValue - 1);
+        [[maybe_unused]] uint32_t start = 0;
+        if constexpr (Statistics::Enabled)
+        {
+            CycleCounter::Enable();
+            start = CycleCounter::Read();
+        }
+
+        uint8_t value;
+        uint32_t polls = 0;
+        do
+        {
+            value = Spi.Ignore(CommandTimeoutValue, 0xff);
+            ++polls;
+        }while(value != 0xff && !deadline.Expired());
+
+        if constexpr (Statistics::Enabled)
+        {
+            if(polls > 1)
+            {
+                Counters::Add(Statistics::SdCardCounters::BusyPolls, polls - 1);
+                Counters::Add(Statistics::SdCardCounters::BusyCycles, CycleCounter::Elapsed(start, CycleCounter::Read()));
+            }
+        }
+        return value == 0xff;
+    }
+
+    template<class _SpiModule, class _CsPin, bool _UseCrc>
+    bool SdCard<_SpiModule, _CsPin, _UseCrc>::StartBlocks(bool read, void* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount, BlocksCallback callback)
+    {
+        static_assert(!std::is_same_v<typename _SpiModule::DmaRx, void> && !std::is_same_v<typename _SpiModule::DmaTx, void>,
+            "SPI module should have DMA channels for blocks transfer");
+
+        if(blocksCount == 0 || _asyncState != AsyncState::Idle)
+            return false;
+
+        if(_type != SdhcCard)
+            logicalBlockAddress <<= 9;
+        if(!WaitWhileBusy())
+        {
+            _CsPin::Set();
+            return false;
+        }
+
+        _asyncMultiple = blocksCount > 1;
+        uint8_t command;
+        if(read)
+        {
+            command = _asyncMultiple ? SdCardCommand::ReadMultipleBlock : SdCardCommand::ReadSingleBlock;
+        }
+        else
+        {
+            // Pre-erase speeds up multiple block write (it's not supported by MMC)
+            if(_asyncMultiple && _type != SdCardMmc && SpiCommand(AppCmd, 0) <= SdR1Idle)
+                SpiCommand(SetWrBlkEraseCount, blocksCount);
+            command = _asyncMultiple ? SdCardCommand::WriteMultipleBlock : SdCardCommand::WriteBlock;
+        }
+
+        if(SpiCommand(command, logicalBlockAddress) != 0)
+            return false;
+
+        _asyncRead = read;
+        _asyncBuffer = static_cast<uint8_t*>(buffer);
+        _asyncBlocks = blocksCount;
+        _asyncDeadline = Deadline(read ? ReadTimeout : WriteTimeout, AsyncPollTimeout);
+        _asyncCallback = callback;
+
+        if constexpr (_UseCrc)
+        {
+            _crcError = false;
+            _crcBlock = nullptr;
+            if(!read)
+            {
+                _crcValue = Crc16(_asyncBuffer, 512);
+                if(blocksCount > 1)
+                    _crcBlock = _asyncBuffer + 512;
+            }
+        }
+
+        _asyncState = read ? AsyncState::WaitToken : AsyncState::WaitReady;
+
+        if(callback != nullptr)
+            return true;
+
+        while(_asyncState != AsyncState::Idle)
+            Process();
+        return _asyncResult;
+    }
+
+    template<class _SpiModule, class _CsPin, bool _UseCrc>
+    void SdCard<_SpiModule, _CsPin, _UseCrc>::Process()
+    {
+        uint8_t token;
+
+        switch(_asyncState)
+        {
+        case AsyncState::WaitToken:
+        case AsyncState::WaitReady:
+            if(!Poll(token))
+            {
+                Counters::Add(Statistics::SdCardCounters::BusyPolls);
+                if(_asyncDeadline.Expired())
+                    Complete(false);
+                break;
+            }
+            if(_asyncRead && token != 0xfe)
+            {
+                Complete(false);
+                break;
+            }
+
+            _asyncDeadline = Deadline(_asyncRead ? ReadTimeout : WriteTimeout, AsyncPollTimeout);
+            _asyncState = AsyncState::Data;
+            if(_asyncRead)
+            {
+                _SpiModule::ReadAsync(_asyncBuffer, 512, DmaHandler);
+            }
+            else
+            {
+                Spi.Write(_asyncMultiple ? 0xfc : 0xfe);
+                _SpiModule::WriteAsync(_asyncBuffer, 512, DmaHandler);
+            }
+            break;
+
+        case AsyncState::Data:
+            // CRC of previous (or next) block is processed while block is transferred by DMA
+            if constexpr (_UseCrc)
+                ProcessCrc();
+            break;
+
+        case AsyncState::DataDone:
+            // After TX-only DMA CRC transfer also flushes SPI receiver
+            if(_asyncRead)
+            {
+                uint16_t crc = Spi.ReadU16Be();
+                if constexpr (_UseCrc)
+                {
+                    ProcessCrc();
+                    _crcBlock = _asyncBuffer;
+                    _crcValue = crc;
+                }
+            }
+            else
+            {
+                if constexpr (_UseCrc)
+                {
+                    Spi.WriteU16Be(_crcValue);
+                    if(_asyncBlocks > 1)
+                    {
+                        ProcessCrc();
+                        _crcValue = _crcNext;
+                        if(_asyncBlocks > 2)
+                            _crcBlock = _asyncBuffer + 1024;
+                    }
+                }
+                else
+                {
+                    Spi.ReadU16Be();
+                }
+
+                if((Spi.Read() & 0x1f) != 0x05)
+                {
+                    Complete(false);
+                    break;
+                }
+            }
+
+            Counters::Add(_asyncRead ? Statistics::SdCardCounters::BlocksRead : Statistics::SdCardCounters::BlocksWritten);
+            _asyncBuffer += 512;
+            if(--_asyncBlocks > 0)
+            {
+                _asyncState = _asyncRead ? AsyncState::WaitToken : AsyncState::WaitReady;
+            }
+            else if(_asyncRead)
+            {
+                bool stopped = !_asyncMultiple || StopMultipleBlockRead();
+                _asyncMultiple = false;
+                if constexpr (_UseCrc)
+                {
+                    ProcessCrc();
+                    stopped = stopped && !_crcError;
+                }
+                Complete(stopped);
+            }
+            else
+            {
+                _asyncState = AsyncState::WaitProgram;
+            }
+            break;
+
+        case AsyncState::WaitProgram:
+            if(!Poll(token))
+            {
+                Counters::Add(Statistics::SdCardCounters::BusyPolls);
+                if(_asyncDeadline.Expired())
+                    Complete(false);
+                break;
+            }
+            if(_asyncMultiple)
+            {
+                // Stop token, then card is busy again
+                Spi.Write(0xfd);
+                Spi.Read();
+                _asyncMultiple = false;
+                _asyncDeadline = Deadline(WriteTimeout, AsyncPollTimeout);
+                break;
+            }
+            Complete(true);
+            break;
+
+        case AsyncState::Failed:
+            Complete(false);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    template<class _SpiModule, class _CsPin, bool _UseCrc>
+    bool SdCard<_SpiModule, _CsPin, _UseCrc>::Poll(uint8_t& token)
+    {
+        _CsPin::Clear();
+
+        bool done;
+        if(_asyncState == AsyncState::WaitToken)
+        {
+            token = Spi.IgnoreWhile(AsyncPollBytes, 0xff);
+            done = token != 0xff;
+        }
+        else
+        {
+            token = Spi.Ignore(AsyncPollBytes, 0xff);
+            done = token == 0xff;
+        }
+
+        return done;
+    }
+
+    template<class _SpiModule, class _CsPin, bool _UseCrc>
+    void SdCard<_SpiModule, _CsPin, _UseCrc>::Complete(bool success)
+    {
+        if(!success)
+            Counters::Add(Statistics::SdCardCounters::Errors);
+
+        // Failed multiple block transfer is terminated by CMD12
+        if(!success && _asyncMultiple)
+            SpiCommand(StopTransmission, 0);
+
+        _CsPin::Set();
+        Spi.Read();
+
+        _asyncResult = success;
+        BlocksCallback callback = _asyncCallback;
+        _asyncCallback = nullptr;
+        _asyncState = AsyncState::Idle;
+        if(callback != nullptr)
+            callback(success);
+    }
+
+    template<class _SpiModule, class _CsPin, bool _UseCrc>
+    void SdCard<_SpiModule, _CsPin, _UseCrc>::ProcessCrc()
+    {
+        if(_crcBlock == nullptr)
+            return;
+
+        if(_asyncRead)
+            _crcError = _crcError || Crc16(_crcBlock, 512) != _crcValue;
+        else
+            _crcNext = Crc16(_crcBlock, 512);
+        _crcBlock = nullptr;
+    }
+
+    template<class _SpiModule, class _CsPin, bool _UseCrc>
+    void SdCard<_SpiModule, _CsPin, _UseCrc>::DmaHandler(void*, unsigned, bool success)
+    {
+        _asyncState = success ? AsyncState::DataDone : AsyncState::Failed;
     }
 }
 
@@ -0,0 +1,512 @@
+/**
+ * @file
+ * Implements USB MSC logical unit backed by SD card
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_SDCARD_MSC_IMPL_H
+#define ZHELE_DRIVERS_SDCARD_MSC_IMPL_H
+
+#include <algorithm>
+
+namespace Zhele::Drivers
+{
+    #define SDCARD_SCSI_LUN_TEMPLATE_ARGS template<typename _SdCard, typename _OutEp, unsigned _CacheBlocks, unsigned _ReadAhead>
+    #define SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER SdCardScsiLun<_SdCard, _OutEp, _CacheBlocks, _ReadAhead>
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    bool SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::Init()
+    {
+        for (Block& block : _blocks)
+        {
+            block.State = BlockState::Free;
+            block.Stale = false;
+        }
+
+        _tick = 0;
+        _failed = false;
+        _readLba = NoBlock;
+        _readRemain = 0;
+        _readWaiting = false;
+        _readAhead = false;
+        _sending = NoIndex;
+        _writeRemain = 0;
+        _filling = NoIndex;
+        _fillOffset = 0;
+        _rxStalled = false;
+
+        _lbaCount = _SdCard::BlocksCount();
+        return _lbaCount > 0;
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    template<typename _InEp>
+    void SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::Read10Handler(uint32_t startLba, uint32_t lbaCount, Usb::InTransferCallback callback)
+    {
+        // Continue read-ahead after transfer only for sequential reads
+        _readAhead = startLba == _readLba;
+        _readLba = startLba;
+        _readRemain = lbaCount;
+        _readWaiting = false;
+        _readCallback = callback;
+        _sendBlock = SendBlock<_InEp>;
+
+        if (lbaCount == 0)
+        {
+            callback();
+            return;
+        }
+
+        TrySend();
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    bool SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::Write10Handler(uint32_t startLba, uint32_t lbaCount)
+    {
+        _readAhead = false;
+        _writeLba = startLba;
+        _writeRemain = lbaCount * BlockSize;
+        _filling = NoIndex;
+        _fillOffset = 0;
+
+        return lbaCount > 0;
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    bool SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::RxHandler(void* data, uint16_t size)
+    {
+        if (_filling == NoIndex)
+            _filling = AcquireBlock(_writeLba);
+
+        if (_filling != NoIndex)
+            Usb::CopyFromUsbPma(_blocks[_filling].Data + _fillOffset, data, size);
+        else
+            _failed = true;
+
+        _fillOffset += size;
+        _writeRemain = _writeRemain > size ? _writeRemain - size : 0;
+
+        if (_fillOffset >= BlockSize)
+        {
+            if (_filling != NoIndex)
+            {
+                Touch(_blocks[_filling]);
+                _blocks[_filling].State = BlockState::Dirty;
+            }
+            _filling = NoIndex;
+            _fillOffset = 0;
+            ++_writeLba;
+        }
+
+        // Double-buffered endpoint can receive one more packet after NAK
+        if (_writeRemain > 0 && FreeBytes() < RxReserve())
+        {
+            _rxStalled = true;
+            _OutEp::SetRxStatus(Usb::EndpointStatus::Nak);
+        }
+
+        return _writeRemain > 0;
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    void SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::Process()
+    {
+        if (_readRemain > 0 || _readAhead)
+        {
+            uint32_t from = _readLba;
+            uint32_t to = std::min<uint32_t>(from + _ReadAhead + 1, _lbaCount);
+            if (from < to && LoadBlocks(from, to))
+            {
+                ResumeRx();
+                return;
+            }
+        }
+
+        unsigned dirty = 0;
+        for (const Block& block : _blocks)
+        {
+            if (block.State == BlockState::Dirty)
+                ++dirty;
+        }
+
+        // Dirty blocks are kept while write is in progress to coalesce them into one CMD25
+        if (dirty > 0 && (_rxStalled || _readWaiting || _writeRemain == 0 || dirty >= _CacheBlocks / 2))
+            FlushRun();
+
+        ResumeRx();
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    bool SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::Flush()
+    {
+        while (FlushRun()) ;
+
+        ResumeRx();
+        return !_failed;
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    template<typename _InEp>
+    void SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::SendBlock(uint8_t index)
+    {
+        _sending = index;
+        Touch(_blocks[index]);
+        _InEp::SendData(_blocks[index].Data, BlockSize, BlockSent<_InEp>);
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    template<typename _InEp>
+    void SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::BlockSent()
+    {
+        _sending = NoIndex;
+        ++_readLba;
+
+        if (--_readRemain == 0)
+        {
+            _readCallback();
+            return;
+        }
+
+        TrySend();
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    void SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::TrySend()
+    {
+        int index = FindBlock(_readLba);
+        if (index < 0)
+        {
+            // Process will send block after load
+            _readWaiting = true;
+            return;
+        }
+
+        _readWaiting = false;
+        _sendBlock(index);
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    int SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::FindBlock(uint32_t lba)
+    {
+        for (unsigned i = 0; i < _CacheBlocks; ++i)
+        {
+            const Block& block = _blocks[i];
+            if (block.Lba == lba && !block.Stale
+                && (block.State == BlockState::Valid || block.State == BlockState::Dirty || block.State == BlockState::Flushing))
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    int SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::AllocateBlock(uint32_t keepFrom, uint32_t keepTo)
+    {
+        int result = -1;
+        for (unsigned i = 0; i < _CacheBlocks; ++i)
+        {
+            const Block& block = _blocks[i];
+            if (i == _sending || i == _filling)
+                continue;
+
+            if (block.State == BlockState::Free)
+                return i;
+
+            // Least recently used clean block out of kept range
+            if (block.State == BlockState::Valid && (block.Lba < keepFrom || block.Lba >= keepTo)
+                && (result < 0 || block.LastUse < _blocks[result].LastUse))
+            {
+                result = i;
+            }
+        }
+        return result;
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    uint8_t SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::AcquireBlock(uint32_t lba)
+    {
+        int index = -1;
+        for (unsigned i = 0; i < _CacheBlocks; ++i)
+        {
+            Block& block = _blocks[i];
+            if (block.Lba != lba || block.Stale)
+                continue;
+
+            if (block.State == BlockState::Valid || block.State == BlockState::Dirty)
+            {
+                index = i;
+                break;
+            }
+
+            // Block is being transferred by card, it will be freed after transfer
+            if (block.State == BlockState::Loading || block.State == BlockState::Flushing)
+                block.Stale = true;
+        }
+
+        if (index < 0)
+            index = AllocateBlock(0, 0);
+        if (index < 0)
+            return NoIndex;
+
+        Block& block = _blocks[index];
+        block.Lba = lba;
+        block.Stale = false;
+        block.State = BlockState::Filling;
+        return index;
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    unsigned SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::FreeBytes()
+    {
+        unsigned result = _filling != NoIndex ? BlockSize - _fillOffset : 0;
+        for (unsigned i = 0; i < _CacheBlocks; ++i)
+        {
+            BlockState state = _blocks[i].State;
+            if (i != _sending && i != _filling && (state == BlockState::Free || state == BlockState::Valid))
+                result += BlockSize;
+        }
+        return result;
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    uint32_t SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::RxReserve()
+    {
+        uint32_t remain = _writeRemain;
+        return std::min<uint32_t>(remain, 2u * _OutEp::MaxPacketSize);
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    void SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::Touch(Block& block)
+    {
+        block.LastUse = ++_tick;
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    void SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::CompleteLoad(uint8_t index, bool success)
+    {
+        Block& block = _blocks[index];
+        if (!success)
+        {
+            std::fill_n(block.Data, BlockSize, 0);
+            _failed = true;
+        }
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        bool waiting = _readWaiting && _readRemain > 0 && block.Lba == _readLba && !block.Stale;
+        block.State = success && !block.Stale ? BlockState::Valid : BlockState::Free;
+        Touch(block);
+
+        // Failed block is sent once (with zeroes), then it's reused as free
+        if (waiting)
+        {
+            _readWaiting = false;
+            _sendBlock(index);
+        }
+
+        __set_PRIMASK(primask);
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    void SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::CompleteFlush(uint8_t index, bool success)
+    {
+        Block& block = _blocks[index];
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        block.State = success && !block.Stale ? BlockState::Valid : BlockState::Free;
+        __set_PRIMASK(primask);
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    bool SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::LoadBlocks(uint32_t from, uint32_t to)
+    {
+        uint8_t run[_CacheBlocks];
+        unsigned count = 0;
+        uint32_t first = from;
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        for (uint32_t lba = from; lba < to && count < _CacheBlocks; ++lba)
+        {
+            if (FindBlock(lba) >= 0)
+            {
+                // Run of missing blocks is loaded by one command
+                if (count > 0)
+                    break;
+                continue;
+            }
+
+            int index = AllocateBlock(from, to);
+            if (index < 0)
+                break;
+
+            Block& block = _blocks[index];
+            block.Lba = lba;
+            block.Stale = false;
+            block.State = BlockState::Loading;
+
+            if (count == 0)
+                first = lba;
+            run[count++] = index;
+        }
+        __set_PRIMASK(primask);
+
+        if (count == 0)
+            return false;
+
+        if (count == 1)
+        {
+            CompleteLoad(run[0], _SdCard::ReadBlock(_blocks[run[0]].Data, first));
+            return true;
+        }
+
+        // Every block is passed to host right after it's read while card reads next one
+        bool started = _SdCard::StartMultipleBlockRead(first);
+        bool success = started;
+        for (unsigned i = 0; i < count; ++i)
+        {
+            success = success && _SdCard::ReadNextBlock(_blocks[run[i]].Data);
+            CompleteLoad(run[i], success);
+        }
+        if (started)
+            _SdCard::StopMultipleBlockRead();
+
+        return true;
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    bool SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::FlushRun()
+    {
+        uint8_t run[_CacheBlocks];
+        unsigned count = 0;
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        int start = -1;
+        for (unsigned i = 0; i < _CacheBlocks; ++i)
+        {
+            if (_blocks[i].State == BlockState::Dirty && (start < 0 || _blocks[i].Lba < _blocks[start].Lba))
+                start = i;
+        }
+
+        if (start < 0)
+        {
+            __set_PRIMASK(primask);
+            return false;
+        }
+
+        // Consecutive dirty blocks from the lowest one
+        uint32_t first = _blocks[start].Lba;
+        for (int index = start; index >= 0 && count < _CacheBlocks; )
+        {
+            _blocks[index].State = BlockState::Flushing;
+            run[count++] = index;
+
+            index = -1;
+            for (unsigned i = 0; i < _CacheBlocks; ++i)
+            {
+                if (_blocks[i].State == BlockState::Dirty && _blocks[i].Lba == first + count)
+                {
+                    index = i;
+                    break;
+                }
+            }
+        }
+        __set_PRIMASK(primask);
+
+        bool success;
+        if (count == 1)
+        {
+            success = _SdCard::WriteBlock(_blocks[run[0]].Data, first);
+        }
+        else
+        {
+            bool started = _SdCard::StartMultipleBlockWrite(first);
+            success = started;
+            for (unsigned i = 0; i < count && success; ++i)
+            {
+                success = _SdCard::WriteNextBlock(_blocks[run[i]].Data);
+            }
+            if (started)
+                success = _SdCard::StopMultipleBlockWrite() && success;
+        }
+
+        if (!success)
+            _failed = true;
+
+        for (unsigned i = 0; i < count; ++i)
+        {
+            CompleteFlush(run[i], success);
+        }
+        return true;
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    void SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::ResumeRx()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (_rxStalled && FreeBytes() >= RxReserve())
+        {
+            _rxStalled = false;
+            _OutEp::SetRxStatus(Usb::EndpointStatus::Valid);
+        }
+        __set_PRIMASK(primask);
+    }
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    typename SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::Block SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_blocks[_CacheBlocks];
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    uint32_t SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_lbaCount;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    uint32_t SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_tick;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    volatile bool SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_failed;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint32_t SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_readLba = SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::NoBlock;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint32_t SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_readRemain;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    volatile bool SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_readWaiting;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    volatile bool SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_readAhead;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint8_t SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_sending = SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::NoIndex;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    Usb::InTransferCallback SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_readCallback;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    std::add_pointer_t<void(uint8_t)> SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_sendBlock;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint32_t SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_writeLba;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint32_t SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_writeRemain;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint8_t SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_filling = SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::NoIndex;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    volatile uint16_t SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_fillOffset;
+
+    SDCARD_SCSI_LUN_TEMPLATE_ARGS
+    volatile bool SDCARD_SCSI_LUN_TEMPLATE_QUALIFIER::_rxStalled;
+}
+
+#endif //! ZHELE_DRIVERS_SDCARD_MSC_IMPL_H
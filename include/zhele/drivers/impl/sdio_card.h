@@ -0,0 +1,340 @@
+/**
+ * @file
+ * Implements methods of SDIO card class
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_SDIO_CARD_IMPL_H
+#define ZHELE_DRIVERS_SDIO_CARD_IMPL_H
+
+namespace Zhele::Drivers
+{
+    #define SDIO_CARD_TEMPLATE_ARGS template<typename _Dma, uint32_t _KernelClock>
+    #define SDIO_CARD_TEMPLATE_QUALIFIER SdioCard<_Dma, _KernelClock>
+
+    SDIO_CARD_TEMPLATE_ARGS
+    SdCardType SDIO_CARD_TEMPLATE_QUALIFIER::Detect()
+    {
+        _type = SdCardNone;
+        _blocksCount = 0;
+        _highSpeed = false;
+        _rca = 0;
+
+        // D0-D3 (PC8-PC11), CK (PC12), CMD (PD2)
+        using Pins = IO::PinList<IO::Pc8, IO::Pc9, IO::Pc10, IO::Pc11, IO::Pc12, IO::Pd2>;
+        using PullUpPins = IO::PinList<IO::Pc8, IO::Pc9, IO::Pc10, IO::Pc11, IO::Pd2>;
+        Pins::Enable();
+        Pins::template SetConfiguration<Pins::AltFunc>();
+        Pins::template SetDriverType<Pins::PushPull>();
+        Pins::template SetSpeed<Pins::Fastest>();
+        Pins::template AltFuncNumber<12>();
+        PullUpPins::template SetPullMode<PullUpPins::PullUp>();
+
+        Clock::SdioClock::Enable();
+        SDIO->MASK = 0;
+        SDIO->DCTRL = 0;
+        SDIO->CLKCR = 0;
+        SetClock(_KernelClock / InitFrequency - 2);
+        SDIO->POWER = SDIO_POWER_PWRCTRL;
+        // Power ramp up and 74 clocks before first command
+        SystemTime::Sleep(2);
+
+        SendCommand(GoIdleState, 0, Response::None);
+
+        bool v2 = SendCommand(SendIfCond, 0x1aa, Response::R7) && (SDIO->RESP1 & 0xfff) == 0x1aa;
+
+        uint32_t ocr = 0;
+        for(uint16_t timeout = 100; (ocr & 0x80000000) == 0; --timeout)
+        {
+            // Card without response to ACMD41 is MMC (it's not supported)
+            if(timeout == 0 || !SendAppCommand(SdSendOpCond, 0x80100000 | (v2 ? 0x40000000 : 0), Response::R3))
+                return _type;
+            ocr = SDIO->RESP1;
+            if((ocr & 0x80000000) == 0)
+                SystemTime::Sleep(10);
+        }
+
+        if(!SendCommand(AllSendCid, 0, Response::R2) || !SendCommand(SendRelativeAddress, 0, Response::R6))
+            return _type;
+        _rca = SDIO->RESP1 & 0xffff0000;
+
+        if(!SendCommand(SendCsd, _rca, Response::R2))
+            return _type;
+        uint32_t csd1 = SDIO->RESP1;
+        uint32_t csd2 = SDIO->RESP2;
+        uint32_t csd3 = SDIO->RESP3;
+        if((csd1 >> 30) == 1) // CSD v2
+        {
+            uint32_t c_size = ((csd2 & 0x3f) << 16) | (csd3 >> 16);
+            _blocksCount = (c_size + 1) * 1024u;
+        }
+        else // CSD v1
+        {
+            uint32_t c_size = ((csd2 & 0x3ff) << 2) | (csd3 >> 30);
+            uint32_t c_size_mult = (csd3 >> 15) & 0x07;
+            uint32_t read_bl_len = (csd2 >> 16) & 0x0f;
+            _blocksCount = (c_size + 1) << (c_size_mult + 2 + read_bl_len - 9);
+        }
+
+        if(!SendCommand(SelectCard, _rca, Response::R1))
+            return _type;
+
+        SdCardType type = v2 ? ((ocr & 0x40000000) ? SdhcCard : SdCardV2) : SdCardV1;
+        if(type != SdhcCard && !SendCommand(SetBlockLength, 512, Response::R1))
+            return _type;
+
+        // 4-bit bus
+        if(!SendAppCommand(SwitchFunction, 2, Response::R1))
+            return _type;
+        SDIO->CLKCR |= SDIO_CLKCR_WIDBUS_0;
+
+        SetClock(0);
+        _highSpeed = SwitchHighSpeed();
+        if(_highSpeed)
+            SetClock(SDIO_CLKCR_BYPASS);
+
+        _type = type;
+        return _type;
+    }
+
+    SDIO_CARD_TEMPLATE_ARGS
+    void SDIO_CARD_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        uint32_t status = SDIO->STA;
+        if((status & (SDIO_STA_DATAEND | DataErrors)) == 0)
+            return;
+
+        bool success = CompleteTransfer(status);
+        BlocksCallback callback = _callback;
+        _callback = nullptr;
+        _busy = false;
+        if(callback != nullptr)
+            callback(success);
+    }
+
+    SDIO_CARD_TEMPLATE_ARGS
+    bool SDIO_CARD_TEMPLATE_QUALIFIER::SendCommand(uint8_t index, uint32_t arg, Response response)
+    {
+        const uint32_t commandFlags = SDIO_STA_CCRCFAIL | SDIO_STA_CTIMEOUT | SDIO_STA_CMDREND | SDIO_STA_CMDSENT;
+
+        uint32_t waitResponse = 0;
+        if(response == Response::R2)
+            waitResponse = SDIO_CMD_WAITRESP_0 | SDIO_CMD_WAITRESP_1;
+        else if(response != Response::None)
+            waitResponse = SDIO_CMD_WAITRESP_0;
+
+        SDIO->ICR = commandFlags;
+        SDIO->ARG = arg;
+        SDIO->CMD = index | waitResponse | SDIO_CMD_CPSMEN;
+
+        const uint32_t doneFlags = response == Response::None
+            ? SDIO_STA_CMDSENT
+            : SDIO_STA_CMDREND | SDIO_STA_CCRCFAIL | SDIO_STA_CTIMEOUT;
+        uint32_t status = 0;
+        for(uint32_t timeout = CommandTimeout; timeout > 0 && (status & doneFlags) == 0; --timeout)
+            status = SDIO->STA;
+        SDIO->ICR = commandFlags;
+
+        if(response == Response::None)
+            return status & SDIO_STA_CMDSENT;
+        if(status & SDIO_STA_CTIMEOUT)
+            return false;
+        // OCR response has no CRC
+        if(status & SDIO_STA_CCRCFAIL)
+            return response == Response::R3;
+        if((status & SDIO_STA_CMDREND) == 0)
+            return false;
+        if(response == Response::R1)
+            return (SDIO->RESP1 & CardStatusErrors) == 0;
+        return true;
+    }
+
+    SDIO_CARD_TEMPLATE_ARGS
+    bool SDIO_CARD_TEMPLATE_QUALIFIER::SendAppCommand(uint8_t index, uint32_t arg, Response response)
+    {
+        return SendCommand(AppCmd, _rca, Response::R1) && SendCommand(index, arg, response);
+    }
+
+    SDIO_CARD_TEMPLATE_ARGS
+    bool SDIO_CARD_TEMPLATE_QUALIFIER::WaitReady()
+    {
+        for(uint32_t timeout = ReadyTimeout; timeout > 0; --timeout)
+        {
+            if(!SendCommand(SendStatus, _rca, Response::R1))
+                return false;
+
+            // READY_FOR_DATA and "tran" current state
+            uint32_t status = SDIO->RESP1;
+            if((status & (1 << 8)) != 0 && ((status >> 9) & 0x0f) == 4)
+                return true;
+        }
+        return false;
+    }
+
+    SDIO_CARD_TEMPLATE_ARGS
+    bool SDIO_CARD_TEMPLATE_QUALIFIER::SwitchHighSpeed()
+    {
+        uint32_t switchStatus[16];
+        unsigned count = 0;
+
+        SDIO->ICR = StaticFlags;
+        SDIO->DTIMER = DataTimeout;
+        SDIO->DLEN = sizeof(switchStatus);
+        SDIO->DCTRL = BlockSize64 | SDIO_DCTRL_DTDIR | SDIO_DCTRL_DTEN;
+
+        // Set function 1 (high-speed) of group 1, other groups are not changed
+        if(!SendCommand(SwitchFunction, 0x80fffff1, Response::R1))
+        {
+            SDIO->DCTRL = 0;
+            return false;
+        }
+
+        uint32_t status = 0;
+        for(uint32_t timeout = ReadyTimeout; timeout > 0 && (status & (SDIO_STA_DATAEND | DataErrors)) == 0; --timeout)
+        {
+            status = SDIO->STA;
+            if((status & SDIO_STA_RXDAVL) && count < 16)
+                switchStatus[count++] = SDIO->FIFO;
+        }
+        while((SDIO->STA & SDIO_STA_RXDAVL) && count < 16)
+            switchStatus[count++] = SDIO->FIFO;
+
+        SDIO->DCTRL = 0;
+        SDIO->ICR = StaticFlags;
+
+        if((status & DataErrors) != 0 || count < 16)
+            return false;
+
+        // Status is sent MSB first: function group 1 result is low nibble of byte 16
+        return (switchStatus[4] & 0x0f) == 1;
+    }
+
+    SDIO_CARD_TEMPLATE_ARGS
+    bool SDIO_CARD_TEMPLATE_QUALIFIER::StartTransfer(bool read, void* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount, BlocksCallback callback)
+    {
+        if(blocksCount == 0 || _busy || (reinterpret_cast<uintptr_t>(buffer) & 0x03) != 0)
+            return false;
+
+        if(!WaitReady())
+            return false;
+
+        if(_type != SdhcCard)
+            logicalBlockAddress <<= 9;
+        _multiple = blocksCount > 1;
+
+        // Pre-erase speeds up multiple block write
+        if(!read && _multiple)
+            SendAppCommand(SetWrBlkEraseCount, blocksCount, Response::R1);
+
+        SDIO->DCTRL = 0;
+        SDIO->ICR = StaticFlags;
+
+        _Dma::SetTransferCallback(nullptr);
+        _Dma::SetHalfTransferCallback(nullptr);
+        _Dma::ClearFlags();
+        _Dma::SetFifoMode(true);
+        // Transfer length is controlled by SDIO
+        _Dma::Transfer((read ? _Dma::Periph2Mem : _Dma::Mem2Periph) | _Dma::MemIncrement
+                | _Dma::PSize32Bits | _Dma::MSize32Bits | _Dma::MemBurst4 | _Dma::PeriphBurst4
+                | _Dma::PeriphFlowControl | _Dma::PriorityVeryHigh,
+            buffer, &SDIO->FIFO, blocksCount * 128);
+
+        SDIO->DTIMER = DataTimeout;
+        SDIO->DLEN = blocksCount * 512;
+        const uint32_t dctrl = BlockSize512 | SDIO_DCTRL_DMAEN | SDIO_DCTRL_DTEN;
+
+        bool started;
+        if(read)
+        {
+            // Data path should be ready before card starts sending
+            SDIO->DCTRL = dctrl | SDIO_DCTRL_DTDIR;
+            started = SendCommand(_multiple ? SdCardCommand::ReadMultipleBlock : SdCardCommand::ReadSingleBlock, logicalBlockAddress, Response::R1);
+        }
+        else
+        {
+            started = SendCommand(_multiple ? SdCardCommand::WriteMultipleBlock : SdCardCommand::WriteBlock, logicalBlockAddress, Response::R1);
+            if(started)
+                SDIO->DCTRL = dctrl;
+        }
+
+        if(!started)
+        {
+            SDIO->DCTRL = 0;
+            _Dma::Disable();
+            _multiple = false;
+            return false;
+        }
+
+        if(callback != nullptr)
+        {
+            _callback = callback;
+            _busy = true;
+            SDIO->MASK = SDIO_MASK_DATAENDIE | SDIO_MASK_DCRCFAILIE | SDIO_MASK_DTIMEOUTIE
+                | SDIO_MASK_TXUNDERRIE | SDIO_MASK_RXOVERRIE | SDIO_MASK_STBITERRIE;
+            NVIC_EnableIRQ(SDIO_IRQn);
+            return true;
+        }
+
+        // Data timeout guarantees end of wait
+        uint32_t status;
+        while(((status = SDIO->STA) & (SDIO_STA_DATAEND | DataErrors)) == 0)
+            continue;
+        return CompleteTransfer(status);
+    }
+
+    SDIO_CARD_TEMPLATE_ARGS
+    bool SDIO_CARD_TEMPLATE_QUALIFIER::CompleteTransfer(uint32_t status)
+    {
+        SDIO->MASK = 0;
+
+        bool success = (status & DataErrors) == 0;
+        if(success)
+        {
+            // DMA flushes its FIFO to memory after SDIO end of read
+            for(uint32_t timeout = CommandTimeout; timeout > 0 && _Dma::Enabled(); --timeout)
+                continue;
+        }
+        _Dma::Disable();
+
+        SDIO->DCTRL = 0;
+        SDIO->ICR = StaticFlags;
+
+        if(_multiple)
+            success = SendCommand(SdCardCommand::StopTransmission, 0, Response::R1) && success;
+        _multiple = false;
+
+        return success;
+    }
+
+    SDIO_CARD_TEMPLATE_ARGS
+    void SDIO_CARD_TEMPLATE_QUALIFIER::SetClock(uint32_t clkcr)
+    {
+        SDIO->CLKCR = (SDIO->CLKCR & SDIO_CLKCR_WIDBUS) | clkcr | SDIO_CLKCR_CLKEN;
+    }
+
+    SDIO_CARD_TEMPLATE_ARGS
+    SdCardType SDIO_CARD_TEMPLATE_QUALIFIER::_type = SdCardNone;
+
+    SDIO_CARD_TEMPLATE_ARGS
+    uint32_t SDIO_CARD_TEMPLATE_QUALIFIER::_rca = 0;
+
+    SDIO_CARD_TEMPLATE_ARGS
+    uint32_t SDIO_CARD_TEMPLATE_QUALIFIER::_blocksCount = 0;
+
+    SDIO_CARD_TEMPLATE_ARGS
+    bool SDIO_CARD_TEMPLATE_QUALIFIER::_highSpeed = false;
+
+    SDIO_CARD_TEMPLATE_ARGS
+    volatile bool SDIO_CARD_TEMPLATE_QUALIFIER::_busy = false;
+
+    SDIO_CARD_TEMPLATE_ARGS
+    bool SDIO_CARD_TEMPLATE_QUALIFIER::_multiple = false;
+
+    SDIO_CARD_TEMPLATE_ARGS
+    typename SDIO_CARD_TEMPLATE_QUALIFIER::BlocksCallback SDIO_CARD_TEMPLATE_QUALIFIER::_callback = nullptr;
+}
+
+#endif //! ZHELE_DRIVERS_SDIO_CARD_IMPL_H
@@ -0,0 +1,407 @@
+/**
+ * @file
+ * Implements SPI NOR flash driver
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_SPI_FLASH_IMPL_H
+#define ZHELE_DRIVERS_SPI_FLASH_IMPL_H
+
+namespace Zhele::Drivers
+{
+    #define SPI_FLASH_TEMPLATE_ARGS template<typename _Spi, typename _CsPin, uint32_t _Size>
+    #define SPI_FLASH_TEMPLATE_QUALIFIER SpiFlash<_Spi, _CsPin, _Size>
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::Init()
+    {
+        _CsPin::SetDirWrite();
+        _CsPin::Set();
+
+        // Flash may be in power-down or still erasing after MCU reset
+        Wake();
+        _busy = true;
+        WaitReady();
+
+        uint32_t id = JedecId();
+        return id != 0 && id != 0xffffff;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    uint32_t SPI_FLASH_TEMPLATE_QUALIFIER::JedecId()
+    {
+        uint8_t id[3];
+        Select(ReadId);
+        _Spi::Transfer(nullptr, id, sizeof(id));
+        _CsPin::Set();
+        return (id[0] << 16) | (id[1] << 8) | id[2];
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::Read(uint32_t offset, void* data, uint32_t size)
+    {
+        if (offset >= _Size || size > _Size - offset)
+            return false;
+
+        // Fast read has dummy byte after address, data is streamed while chip select is low
+        Select(FastRead, offset, 5);
+        uint8_t* buffer = static_cast<uint8_t*>(data);
+        while (size > 0)
+        {
+            uint32_t chunk = size < MaxTransferSize ? size : MaxTransferSize;
+            _Spi::Transfer(nullptr, buffer, chunk);
+            buffer += chunk;
+            size -= chunk;
+        }
+        _CsPin::Set();
+        return true;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::ReadAsync(uint32_t offset, void* data, uint16_t size, TransferCallback callback)
+    {
+        if (offset >= _Size || size > _Size - offset)
+            return false;
+
+        _readCallback = callback;
+        Select(FastRead, offset, 5);
+        _Spi::ReadAsync(data, size, ReadHandler);
+        return true;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    void SPI_FLASH_TEMPLATE_QUALIFIER::ReadHandler(void* data, unsigned size, bool success)
+    {
+        while (_Spi::Busy())
+            continue;
+        _CsPin::Set();
+
+        if (_readCallback)
+            _readCallback(data, size, success);
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::Write(uint32_t offset, const void* data, uint32_t size)
+    {
+        if (offset >= _Size || size > _Size - offset)
+            return false;
+
+        const uint8_t* source = static_cast<const uint8_t*>(data);
+        while (size > 0)
+        {
+            // Program command wraps inside 256-byte page, so data is split by page boundaries
+            unsigned chunk = ProgramPageSize - offset % ProgramPageSize;
+            if (chunk > size)
+                chunk = size;
+
+            ProgramPage(offset, source, chunk);
+            offset += chunk;
+            source += chunk;
+            size -= chunk;
+        }
+        return true;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::Erase(uint32_t offset, uint32_t size)
+    {
+        if (offset >= _Size || size > _Size - offset)
+            return false;
+        if (size == 0)
+            return true;
+
+        uint32_t end = (offset + size + SectorSize - 1) & ~(SectorSize - 1);
+        offset &= ~(SectorSize - 1);
+
+        if (offset == 0 && end == _Size)
+        {
+            SimpleCommand(WriteEnable);
+            SimpleCommand(ChipErase);
+            _busy = true;
+            return true;
+        }
+
+        while (offset < end)
+        {
+            constexpr uint32_t Block64 = 64 * 1024;
+            constexpr uint32_t Block32 = 32 * 1024;
+
+            uint32_t remaining = end - offset;
+            if (offset % Block64 == 0 && remaining >= Block64)
+            {
+                EraseBlock(Block64Erase, offset);
+                offset += Block64;
+            }
+            else if (offset % Block32 == 0 && remaining >= Block32)
+            {
+                EraseBlock(Block32Erase, offset);
+                offset += Block32;
+            }
+            else
+            {
+                EraseBlock(SectorErase, offset);
+                offset += SectorSize;
+            }
+        }
+        return true;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    void SPI_FLASH_TEMPLATE_QUALIFIER::WaitReady()
+    {
+        if (!_busy)
+            return;
+
+        // Status register is output continuously while chip select is low
+        _CsPin::Clear();
+        _Spi::Send(ReadStatus1);
+        while (_Spi::Send(0xff) & StatusBusy)
+            continue;
+        _CsPin::Set();
+        _busy = false;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::Busy()
+    {
+        if (!_busy)
+            return false;
+
+        _CsPin::Clear();
+        _Spi::Send(ReadStatus1);
+        _busy = (_Spi::Send(0xff) & StatusBusy) != 0;
+        _CsPin::Set();
+        return _busy;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    void SPI_FLASH_TEMPLATE_QUALIFIER::Sleep()
+    {
+        SimpleCommand(PowerDown);
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    void SPI_FLASH_TEMPLATE_QUALIFIER::Wake()
+    {
+        _CsPin::Clear();
+        _Spi::Send(ReleasePowerDown);
+        _CsPin::Set();
+
+        // tRES1 (3 us for W25Q)
+        delay_us<3>();
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::ReadBlock(uint8_t* buffer, uint32_t logicalBlockAddress)
+    {
+        return ReadMultipleBlock(buffer, logicalBlockAddress, 1);
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::WriteBlock(const uint8_t* buffer, uint32_t logicalBlockAddress)
+    {
+        return WriteMultipleBlock(buffer, logicalBlockAddress, 1);
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::ReadMultipleBlock(uint8_t* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount)
+    {
+        if (logicalBlockAddress >= BlocksCount() || blocksCount > BlocksCount() - logicalBlockAddress)
+            return false;
+
+        return Read(logicalBlockAddress * BlockSizeValue, buffer, blocksCount * BlockSizeValue);
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::WriteMultipleBlock(const uint8_t* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount)
+    {
+        if (logicalBlockAddress >= BlocksCount() || blocksCount > BlocksCount() - logicalBlockAddress)
+            return false;
+
+        StartMultipleBlockWrite(logicalBlockAddress);
+        for (uint32_t i = 0; i < blocksCount; ++i)
+            WriteNextBlock(buffer + i * BlockSizeValue);
+        return StopMultipleBlockWrite();
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::StartMultipleBlockRead(uint32_t logicalBlockAddress)
+    {
+        if (logicalBlockAddress >= BlocksCount())
+            return false;
+
+        _stream = logicalBlockAddress;
+        return true;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::ReadNextBlock(uint8_t* buffer)
+    {
+        return ReadMultipleBlock(buffer, _stream++, 1);
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::StopMultipleBlockRead()
+    {
+        return true;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::StartMultipleBlockWrite(uint32_t logicalBlockAddress)
+    {
+        if (logicalBlockAddress >= BlocksCount())
+            return false;
+
+        _stream = logicalBlockAddress;
+        return true;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::WriteNextBlock(const uint8_t* buffer)
+    {
+        if (_stream >= BlocksCount())
+            return false;
+
+        UpdateBlock(buffer, _stream++);
+        if (_stream % BlocksPerSector == 0)
+            FlushSector();
+        return true;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::StopMultipleBlockWrite()
+    {
+        FlushSector();
+        return true;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    void SPI_FLASH_TEMPLATE_QUALIFIER::Select(uint8_t command, uint32_t address, unsigned headerSize)
+    {
+        uint8_t header[] = {command, static_cast<uint8_t>(address >> 16), static_cast<uint8_t>(address >> 8),
+            static_cast<uint8_t>(address), 0};
+
+        WaitReady();
+        _CsPin::Clear();
+        _Spi::Transfer(header, nullptr, headerSize);
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    void SPI_FLASH_TEMPLATE_QUALIFIER::SimpleCommand(uint8_t command)
+    {
+        Select(command);
+        _CsPin::Set();
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    void SPI_FLASH_TEMPLATE_QUALIFIER::ProgramPage(uint32_t offset, const uint8_t* data, unsigned size)
+    {
+        // Completion is not awaited: status is polled before next command
+        SimpleCommand(WriteEnable);
+        Select(PageProgram, offset, 4);
+        _Spi::Transfer(data, nullptr, size);
+        _CsPin::Set();
+        _busy = true;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    void SPI_FLASH_TEMPLATE_QUALIFIER::EraseBlock(uint8_t command, uint32_t offset)
+    {
+        SimpleCommand(WriteEnable);
+        Select(command, offset, 4);
+        _CsPin::Set();
+        _busy = true;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    void SPI_FLASH_TEMPLATE_QUALIFIER::LoadSector(uint32_t sector)
+    {
+        Read(sector * SectorSize, _sectorBuffer, SectorSize);
+        _sector = sector;
+        _dirtyBlocks = 0;
+        _eraseRequired = false;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    void SPI_FLASH_TEMPLATE_QUALIFIER::UpdateBlock(const uint8_t* buffer, uint32_t logicalBlockAddress)
+    {
+        uint32_t sector = logicalBlockAddress / BlocksPerSector;
+        if (sector != _sector)
+        {
+            FlushSector();
+            LoadSector(sector);
+        }
+
+        unsigned index = logicalBlockAddress % BlocksPerSector;
+        uint8_t* block = _sectorBuffer + index * BlockSizeValue;
+        bool changed = false;
+        for (unsigned i = 0; i < BlockSizeValue; ++i)
+        {
+            // Program clears bits only, set bit requires sector erase
+            if (buffer[i] & ~block[i])
+                _eraseRequired = true;
+            changed = changed || buffer[i] != block[i];
+            block[i] = buffer[i];
+        }
+        if (changed)
+            _dirtyBlocks |= 1 << index;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    void SPI_FLASH_TEMPLATE_QUALIFIER::FlushSector()
+    {
+        if (_sector == NoSector)
+            return;
+
+        uint32_t base = _sector * SectorSize;
+        if (_eraseRequired)
+        {
+            EraseBlock(SectorErase, base);
+            _dirtyBlocks = (1 << BlocksPerSector) - 1;
+        }
+
+        for (unsigned page = 0; page < SectorSize / ProgramPageSize; ++page)
+        {
+            if (!(_dirtyBlocks & (1 << (page * ProgramPageSize / BlockSizeValue))))
+                continue;
+
+            // Erased bytes are 0xff, so page of 0xff needs no program
+            const uint8_t* data = _sectorBuffer + page * ProgramPageSize;
+            bool erased = true;
+            for (unsigned i = 0; i < ProgramPageSize && erased; ++i)
+                erased = data[i] == 0xff;
+            if (!erased)
+                ProgramPage(base + page * ProgramPageSize, data, ProgramPageSize);
+        }
+
+        _sector = NoSector;
+        _dirtyBlocks = 0;
+        _eraseRequired = false;
+    }
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::_busy = false;
+
+    SPI_FLASH_TEMPLATE_ARGS
+    TransferCallback SPI_FLASH_TEMPLATE_QUALIFIER::_readCallback = nullptr;
+
+    SPI_FLASH_TEMPLATE_ARGS
+    uint32_t SPI_FLASH_TEMPLATE_QUALIFIER::_stream = 0;
+
+    SPI_FLASH_TEMPLATE_ARGS
+    uint32_t SPI_FLASH_TEMPLATE_QUALIFIER::_sector = SPI_FLASH_TEMPLATE_QUALIFIER::NoSector;
+
+    SPI_FLASH_TEMPLATE_ARGS
+    uint8_t SPI_FLASH_TEMPLATE_QUALIFIER::_dirtyBlocks = 0;
+
+    SPI_FLASH_TEMPLATE_ARGS
+    bool SPI_FLASH_TEMPLATE_QUALIFIER::_eraseRequired = false;
+
+    SPI_FLASH_TEMPLATE_ARGS
+    uint8_t SPI_FLASH_TEMPLATE_QUALIFIER::_sectorBuffer[SPI_FLASH_TEMPLATE_QUALIFIER::SectorSize];
+}
+
+#endif //! ZHELE_DRIVERS_SPI_FLASH_IMPL_H
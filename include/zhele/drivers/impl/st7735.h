@@ -0,0 +1,598 @@
+/**
+ * @file
+ * Implements framebuffer (partial update) for ST7735 based TFT display
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_ST7735_IMPL_H
+#define ZHELE_DRIVERS_ST7735_IMPL_H
+
+#if defined (DMA2D)
+    #include <zhele/dma2d.h>
+#endif
+
+#include <cstring>
+
+namespace Zhele::Drivers
+{
+    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width, uint8_t _Height>
+    template <uint8_t _TileWidth, uint8_t _TileHeight, uint8_t _BurstTiles>
+    class St7735<_SpiBus, _SsPin, _DcPin, _ResetPin, _Width, _Height>::FrameBuffer
+    {
+        static_assert(_Width % _TileWidth == 0 && _Height % _TileHeight == 0, "Display size must be multiple of tile size");
+        static_assert(_BurstTiles > 0, "Burst must contain at least one tile");
+
+        static const uint8_t TilesX = _Width / _TileWidth;
+        static const uint8_t TilesY = _Height / _TileHeight;
+        static const unsigned TilesCount = TilesX * TilesY;
+        static const unsigned BufferSize = _BurstTiles * _TileWidth * _TileHeight;
+        static_assert(BufferSize * sizeof(uint16_t) <= 0xffff, "Burst is too large for one DMA transfer");
+
+        /// Transmitted region (run of tiles in one tiles row)
+        struct Region
+        {
+            uint8_t X; ///< Left column
+            uint8_t Y; ///< Top row
+            uint8_t Width; ///< Width (height is tile height)
+        };
+    public:
+        /// Pixel color type (RGB565)
+        using PixelType = uint16_t;
+
+        /// Screen width
+        static const uint8_t ScreenWidth = _Width;
+        /// Screen height
+        static const uint8_t ScreenHeight = _Height;
+
+        /**
+         * @brief Draw pixel
+         *
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param color Pixel color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawPixel(uint8_t x, uint8_t y, uint16_t color)
+        {
+            if (x >= _Width || y >= _Height)
+                return;
+
+            _frame[y * _Width + x] = Swap(color);
+            _dirty[(y / _TileHeight) * TilesX + x / _TileWidth] = true;
+        }
+
+        /**
+         * @brief Fill rectangle
+         *
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param width Width
+         * @param height Height
+         * @param color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void FillRectangle(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint16_t color)
+        {
+            if (!Clip(x, y, width, height))
+                return;
+
+            const uint16_t value = Swap(color);
+#if defined (DMA2D)
+            if (static_cast<unsigned>(width) * height >= ZHELE_DMA2D_THRESHOLD) {
+                Dma2d::Init();
+                Dma2d::Fill(&_frame[y * _Width + x], _Width, width, height, value);
+                Dma2d::Wait();
+                MarkDirty(x, y, width, height);
+                return;
+            }
+#endif
+            for (uint8_t row = 0; row < height; ++row) {
+                uint16_t* line = &_frame[(y + row) * _Width + x];
+                for (uint8_t column = 0; column < width; ++column)
+                    line[column] = value;
+            }
+
+            MarkDirty(x, y, width, height);
+        }
+
+        /**
+         * @brief Fill screen with given color
+         *
+         * @param color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void FillScreen(uint16_t color)
+        {
+            FillRectangle(0, 0, _Width, _Height, color);
+        }
+
+        /**
+         * @brief Draw image
+         *
+         * @details
+         * Image data has the same format as for @ref St7735::DrawImage (display byte order).
+         *
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param width Image width
+         * @param height Image height
+         * @param data Image data source
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawImage(uint8_t x, uint8_t y, uint8_t width, uint8_t height, const uint16_t* data)
+        {
+            uint8_t visibleWidth = width;
+            uint8_t visibleHeight = height;
+            if (!Clip(x, y, visibleWidth, visibleHeight))
+                return;
+
+#if defined (DMA2D)
+            if (static_cast<unsigned>(visibleWidth) * visibleHeight >= ZHELE_DMA2D_THRESHOLD) {
+                Dma2d::Init();
+                Dma2d::Copy(data, width, &_frame[y * _Width + x], _Width, visibleWidth, visibleHeight);
+                Dma2d::Wait();
+                MarkDirty(x, y, visibleWidth, visibleHeight);
+                return;
+            }
+#endif
+            for (uint8_t row = 0; row < visibleHeight; ++row)
+                memcpy(&_frame[(y + row) * _Width + x], data + row * width, visibleWidth * sizeof(uint16_t));
+
+            MarkDirty(x, y, visibleWidth, visibleHeight);
+        }
+
+        /**
+         * @brief Write char
+         *
+         * @tparam Font Font
+         *
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param symbol Symbol
+         * @param color Symbol color
+         * @param background Background color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename Font>
+        static void WriteChar(uint8_t x, uint8_t y, char symbol, uint16_t color, uint16_t background)
+        {
+            uint8_t width;
+            if constexpr (Font::MonoSpace)
+                width = Font::Width;
+            else
+                width = Font::GetWidth(symbol);
+
+            const uint16_t foreground = Swap(color);
+            const uint16_t back = Swap(background);
+
+            if constexpr (Private::IsRleFont<Font>) {
+                // Runs are decoded straight into framebuffer
+                Font::Decode(symbol, [x, y, foreground, back](uint8_t row, uint8_t column, uint8_t length, bool set) {
+                    for (uint8_t i = 0; i < length; ++i)
+                        Put(x + column + i, y + row, set ? foreground : back);
+                });
+            } else {
+                const uint8_t extraBits = Font::Height % 8;
+
+                for (uint8_t column = 0; column < width; ++column) {
+                    uint8_t page = 0;
+                    for(page = 0; page < Font::Height / 8; ++page) {
+                        uint8_t temp = Font::Get(symbol)[page * width + column];
+
+                        for(uint8_t i = 0; i < 8; ++i) {
+                            Put(x + column, y + page * 8 + i, (temp & 0x01) > 0 ? foreground : back);
+                            temp >>= 1;
+                        }
+                    }
+
+                    if constexpr (extraBits > 0) {
+                        uint8_t temp = Font::Get(symbol)[page * width + column] >> (8 - extraBits);
+
+                        for(uint8_t i = 0; i < extraBits; ++i) {
+                            Put(x + column, y + page * 8 + i, (temp & 0x01) > 0 ? foreground : back);
+                            temp >>= 1;
+                        }
+                    }
+                }
+            }
+
+            uint8_t height = Font::Height;
+            if (Clip(x, y, width, height))
+                MarkDirty(x, y, width, height);
+        }
+
+        /**
+         * @brief Write string
+         *
+         * @tparam Font Font
+         *
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param str String
+         * @param color Symbol color
+         * @param background Background color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename Font>
+        static void WriteString(uint8_t x, uint8_t y, const char* str, uint16_t color, uint16_t background)
+        {
+            while(*str) {
+                uint8_t width;
+                if constexpr (Font::MonoSpace)
+                    width = Font::Width;
+                else
+                    width = Font::GetWidth(*str);
+
+                if(x + width >= _Width) {
+                    x = 0;
+                    y += Font::Height;
+
+                    if(y + Font::Height >= _Height)
+                        break;
+
+                    if(*str == ' ') {
+                        // skip spaces in the beginning of the new line
+                        ++str;
+                        continue;
+                    }
+                }
+                WriteChar<Font>(x, y, *str, color, background);
+
+                x += width;
+
+                ++str;
+            }
+        }
+
+        /**
+         * @brief Marks whole screen as dirty (next flush sends all tiles)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Invalidate()
+        {
+            for (unsigned tile = 0; tile < TilesCount; ++tile)
+                _dirty[tile] = true;
+        }
+
+        /**
+         * @brief Starts sending of dirty tiles (non-blocking)
+         *
+         * @details
+         * If flush is in progress, method does nothing: running flush sends tiles
+         * until there are no dirty ones.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Flush()
+        {
+            if (_flushing)
+                return;
+
+            // Wait for other display async operation
+            while (_busy) continue;
+
+            _sizes[0] = Prepare(0);
+            if (_sizes[0] == 0)
+                return;
+            _sizes[1] = Prepare(1);
+
+            _flushing = true;
+            _busy = true;
+
+            _SsPin::Clear();
+            Start(0);
+        }
+
+        /**
+         * @brief Indicates flush state
+         *
+         * @retval true Flush is in progress
+         * @retval false Flush is complete
+         */
+        static bool Busy()
+        {
+            return _flushing;
+        }
+
+    private:
+        /**
+         * @brief Converts color to display byte order (framebuffer is sent by 8-bit DMA transfer)
+         *
+         * @param color Color
+         *
+         * @returns Swapped color
+         */
+        static constexpr uint16_t Swap(uint16_t color)
+        {
+            return static_cast<uint16_t>((color >> 8) | (color << 8));
+        }
+
+        /**
+         * @brief Writes pixel (with bounds check) without dirty mark
+         *
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param value Pixel value (display byte order)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Put(unsigned x, unsigned y, uint16_t value)
+        {
+            if (x < _Width && y < _Height)
+                _frame[y * _Width + x] = value;
+        }
+
+        /**
+         * @brief Clips rectangle by screen
+         *
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param [in, out] width Width
+         * @param [in, out] height Height
+         *
+         * @retval true Rectangle is visible
+         * @retval false Rectangle is out of screen or empty
+         */
+        static bool Clip(uint8_t x, uint8_t y, uint8_t& width, uint8_t& height)
+        {
+            if (x >= _Width || y >= _Height || width == 0 || height == 0)
+                return false;
+
+            if (width > _Width - x)
+                width = _Width - x;
+            if (height > _Height - y)
+                height = _Height - y;
+
+            return true;
+        }
+
+        /**
+         * @brief Marks tiles of (clipped) rectangle as dirty
+         *
+         * @details
+         * Tiles are marked after pixels change, so flush that copies tile before mark
+         * sends it again.
+         *
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param width Width
+         * @param height Height
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void MarkDirty(uint8_t x, uint8_t y, uint8_t width, uint8_t height)
+        {
+            const unsigned lastX = (x + width - 1) / _TileWidth;
+            const unsigned lastY = (y + height - 1) / _TileHeight;
+
+            for (unsigned tileY = y / _TileHeight; tileY <= lastY; ++tileY) {
+                for (unsigned tileX = x / _TileWidth; tileX <= lastX; ++tileX)
+                    _dirty[tileY * TilesX + tileX] = true;
+            }
+        }
+
+        /**
+         * @brief Copies next run of dirty tiles to transmit buffer
+         *
+         * @param buffer Transmit buffer index
+         *
+         * @returns Run size in bytes (0 if there are no dirty tiles)
+         */
+        static uint32_t Prepare(uint8_t buffer)
+        {
+            for (unsigned n = 0; n < TilesCount; ++n) {
+                unsigned tile = (_scan + n) % TilesCount;
+                if (!_dirty[tile])
+                    continue;
+
+                const uint8_t tileX = tile % TilesX;
+                uint8_t count = 1;
+                while (count < _BurstTiles && tileX + count < TilesX && _dirty[tile + count])
+                    ++count;
+
+                for (uint8_t i = 0; i < count; ++i)
+                    _dirty[tile + i] = false;
+                _scan = (tile + count) % TilesCount;
+
+                Region& region = _regions[buffer];
+                region.X = tileX * _TileWidth;
+                region.Y = (tile / TilesX) * _TileHeight;
+                region.Width = count * _TileWidth;
+
+                uint16_t* dst = _buffers[buffer];
+                for (uint8_t row = 0; row < _TileHeight; ++row) {
+                    memcpy(dst, &_frame[(region.Y + row) * _Width + region.X], region.Width * sizeof(uint16_t));
+                    dst += region.Width;
+                }
+
+                return region.Width * _TileHeight * sizeof(uint16_t);
+            }
+
+            return 0;
+        }
+
+        /**
+         * @brief Sets address window and starts DMA burst of transmit buffer
+         *
+         * @param buffer Transmit buffer index
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start(uint8_t buffer)
+        {
+            const Region& region = _regions[buffer];
+
+            _sending = buffer;
+            SetAddressWindow(region.X, region.Y, region.X + region.Width - 1, region.Y + _TileHeight - 1);
+            WriteDataAsync(_buffers[buffer], _sizes[buffer], TransferHandler);
+        }
+
+        /**
+         * @brief Burst complete handler: starts prepared burst and prepares next one during transfer
+         *
+         * @param data Data
+         * @param size Size
+         * @param success Transfer result
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void TransferHandler(void* data, unsigned size, bool success)
+        {
+            _SpiBus::EndWrite();
+
+            const uint8_t sent = _sending;
+
+            if (!success) {
+                // Send regions again by next flush
+                for (uint8_t buffer = 0; buffer < 2; ++buffer) {
+                    if (buffer == sent || _sizes[buffer] > 0)
+                        MarkDirty(_regions[buffer].X, _regions[buffer].Y, _regions[buffer].Width, _TileHeight);
+                    _sizes[buffer] = 0;
+                }
+            }
+            else {
+                _sizes[sent] = 0;
+                const uint8_t next = sent ^ 1;
+                if (_sizes[next] == 0)
+                    _sizes[next] = Prepare(next);
+
+                if (_sizes[next] > 0) {
+                    Start(next);
+                    _sizes[sent] = Prepare(sent);
+                    return;
+                }
+            }
+
+            _SsPin::Set();
+            _flushing = false;
+            _busy = false;
+        }
+
+        static inline uint16_t _frame[_Width * _Height]; ///< Framebuffer (display byte order)
+        static inline volatile bool _dirty[TilesCount]; ///< Dirty tiles
+        static inline uint16_t _buffers[2][BufferSize]; ///< Transmit buffers
+        static inline Region _regions[2]; ///< Transmit buffers regions
+        static inline uint32_t _sizes[2]; ///< Transmit buffers sizes (0 for free buffer)
+        static inline uint8_t _sending = 0; ///< Transmitted buffer
+        static inline unsigned _scan = 0; ///< Next tile to check
+        static inline volatile bool _flushing = false; ///< Flush is in progress
+    };
+
+    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width, uint8_t _Height>
+    template <typename _Glyphs, uint8_t _TopFixed, uint16_t _Background>
+    class St7735<_SpiBus, _SsPin, _DcPin, _ResetPin, _Width, _Height>::ScrollingTerminal
+    {
+        static_assert(_Width < _Height, "Hardware scroll is vertical in portrait orientation only");
+        static_assert(_TopFixed + _Glyphs::Height <= _Height, "Scroll area must contain at least one line");
+
+        /// Text lines count
+        static const uint8_t Lines = (_Height - _TopFixed) / _Glyphs::Height;
+        /// Bottom fixed area (rest of screen)
+        static const uint8_t BottomFixed = _Height - _TopFixed - Lines * _Glyphs::Height;
+    public:
+        /**
+         * @brief Defines scroll area and clears it
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+            SetScrollArea(_TopFixed, BottomFixed);
+            Clear();
+        }
+
+        /**
+         * @brief Clears terminal (scroll area)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Clear()
+        {
+            _next = 0;
+            _full = false;
+            SetScrollStart(_TopFixed);
+
+            FillRectangle(0, _TopFixed, _Width, Lines * _Glyphs::Height, _Background);
+            while (_busy) continue;
+        }
+
+        /**
+         * @brief Writes text line (text that doesn't fit line is truncated)
+         *
+         * @param str String
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void WriteLine(const char* str)
+        {
+            const uint8_t line = _next;
+            _next = _next + 1u < Lines ? _next + 1 : 0;
+
+            if (_full) {
+                // The oldest line goes to the bottom, it's overwritten below
+                SetScrollStart(LineY(_next));
+            }
+            else if (_next == 0) {
+                _full = true;
+            }
+
+            const char* end = str;
+            unsigned width = 0;
+            while (*end && width + _Glyphs::Width(*end) <= _Width) {
+                width += _Glyphs::Width(*end);
+                ++end;
+            }
+
+            if (width > 0)
+                St7735::template WriteLine<_Glyphs>(0, LineY(line), str, end, width);
+
+            if (width < _Width) {
+                FillRectangle(width, LineY(line), _Width - width, _Glyphs::Height, _Background);
+                while (_busy) continue;
+            }
+        }
+
+    private:
+        /**
+         * @brief Returns frame memory row of text line
+         *
+         * @param line Text line
+         *
+         * @returns Row
+         */
+        static uint8_t LineY(uint8_t line)
+        {
+            return _TopFixed + line * _Glyphs::Height;
+        }
+
+        static inline uint8_t _next = 0; ///< Text line for next write
+        static inline bool _full = false; ///< All lines are written (next write scrolls)
+    };
+}
+
+#endif //! ZHELE_DRIVERS_ST7735_IMPL_H
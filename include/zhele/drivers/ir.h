@@ -12,6 +12,9 @@
 #ifndef ZHELE_DRIVERS_IR_H
 #define ZHELE_DRIVERS_IR_H
 
+#include <stdint.h>
+#include <type_traits>
+
 namespace Zhele::Drivers
 {
     /**
@@ -227,5 +230,617 @@ namespace Zhele::Drivers
 
     uint32_t NecDecoder::_frame;
     NecDecoder::Callback NecDecoder::_callback;
+
+    /// IR protocol
+    enum class IrProtocol : uint8_t
+    {
+        Nec, ///< NEC (and extended NEC)
+        Rc5, ///< Philips RC5
+        Rc6, ///< Philips RC6 (mode 0)
+        Sirc, ///< Sony SIRC (12, 15 and 20 bits)
+    };
+
+    /// Decoded IR code
+    struct IrCode
+    {
+        IrProtocol Protocol; ///< Protocol
+        uint16_t Address; ///< Address (device)
+        uint16_t Command; ///< Command
+        bool Repeat; ///< Key is held (NEC repeat code or RC5/RC6 frame with the same toggle bit)
+    };
+
+    namespace Private
+    {
+        /**
+         * @brief Compare duration with protocol constant
+         * 
+         * @details
+         * Tolerance is 25% + 50 us (IR receivers stretch marks and shorten spaces).
+         * 
+         * @param [in] value Duration (us)
+         * @param [in] target Protocol constant (us)
+         * 
+         * @retval true Value is near target
+         * @retval false Value is differ
+         */
+        inline bool IrNear(uint16_t value, uint16_t target)
+        {
+            uint16_t tolerance = target / 4 + 50;
+            return value + tolerance >= target && value <= target + tolerance;
+        }
+
+        /**
+         * @brief Converts duration to count of protocol time units
+         * 
+         * @param [in] value Duration (us)
+         * @param [in] unit Time unit (us)
+         * @param [in] maxUnits Max units count
+         * 
+         * @returns Units count (0 if duration is invalid)
+         */
+        inline uint8_t IrUnits(uint16_t value, uint16_t unit, uint8_t maxUnits)
+        {
+            unsigned units = (value + unit / 2) / unit;
+            return units <= maxUnits ? units : 0;
+        }
+
+        /**
+         * @brief Expands durations to levels sequence of protocol time units (for bi-phase protocols)
+         * 
+         * @param [in] durations Durations (marks at even indexes, spaces at odd ones)
+         * @param [in] count Durations count
+         * @param [in] unit Time unit (us)
+         * @param [in] maxUnits Max units count of one duration
+         * @param [out] levels Levels (1 for mark, 0 for space), it's padded by spaces (trailing gap)
+         * @param [in] size Levels count
+         * @param [in] offset Levels count before first mark (leading space)
+         * 
+         * @returns Levels count before padding (0 if durations are invalid or too long)
+         */
+        inline unsigned IrExpand(const uint16_t* durations, unsigned count, uint16_t unit, uint8_t maxUnits, uint8_t* levels, unsigned size, unsigned offset)
+        {
+            unsigned position = 0;
+            for (; position < offset; ++position)
+                levels[position] = 0;
+
+            for (unsigned i = 0; i < count; ++i) {
+                uint8_t units = IrUnits(durations[i], unit, maxUnits);
+                if (units == 0 || position + units > size)
+                    return 0;
+
+                while (units-- > 0)
+                    levels[position++] = (i % 2) == 0 ? 1 : 0;
+            }
+
+            for (unsigned i = position; i < size; ++i)
+                levels[i] = 0;
+
+            return position;
+        }
+    }
+
+    /**
+     * @brief NEC frame decoder (for @ref IrCaptureReceiver)
+     */
+    class NecFrameDecoder
+    {
+    public:
+        /**
+         * @brief Decode frame
+         * 
+         * @param [in] durations Durations in us (marks at even indexes, spaces at odd ones)
+         * @param [in] count Durations count
+         * @param [out] code Decoded code
+         * 
+         * @retval true Frame was decoded
+         * @retval false Frame is not NEC frame
+         */
+        static bool Decode(const uint16_t* durations, unsigned count, IrCode& code)
+        {
+            if (count < 3 || !Private::IrNear(durations[0], 9000))
+                return false;
+
+            // Repeat code: 9 ms mark, 2.25 ms space, 560 us mark
+            if (count == 3) {
+                if (!_valid || !Private::IrNear(durations[1], 2250) || !Private::IrNear(durations[2], 560))
+                    return false;
+
+                code = _last;
+                code.Repeat = true;
+                return true;
+            }
+
+            // Leader, 32 bits (mark + space) and stop mark
+            if (count != 67 || !Private::IrNear(durations[1], 4500))
+                return false;
+
+            uint32_t frame = 0;
+            for (unsigned bit = 0; bit < 32; ++bit) {
+                uint16_t mark = durations[2 + bit * 2];
+                uint16_t space = durations[3 + bit * 2];
+
+                if (!Private::IrNear(mark, 560))
+                    return false;
+
+                if (Private::IrNear(space, 1690))
+                    frame |= 1ul << bit;
+                else if (!Private::IrNear(space, 560))
+                    return false;
+            }
+
+            uint8_t address = frame & 0xff;
+            uint8_t addressInverted = (frame >> 8) & 0xff;
+            uint8_t command = (frame >> 16) & 0xff;
+            uint8_t commandInverted = (frame >> 24) & 0xff;
+
+            if ((command ^ commandInverted) != 0xff)
+                return false;
+
+            _last.Protocol = IrProtocol::Nec;
+            // Extended NEC uses 16-bit address without inversion
+            _last.Address = (address ^ addressInverted) == 0xff
+                ? address
+                : static_cast<uint16_t>(address | (addressInverted << 8));
+            _last.Command = command;
+            _last.Repeat = false;
+            _valid = true;
+
+            code = _last;
+            return true;
+        }
+
+    private:
+        static inline IrCode _last = {}; ///< Last decoded code (for repeat codes)
+        static inline bool _valid = false; ///< Last code is valid
+    };
+
+    /**
+     * @brief RC5 frame decoder (for @ref IrCaptureReceiver)
+     */
+    class Rc5FrameDecoder
+    {
+        static const uint16_t HalfBit = 889;
+        static const unsigned Bits = 14;
+    public:
+        /**
+         * @brief Decode frame
+         * 
+         * @param [in] durations Durations in us (marks at even indexes, spaces at odd ones)
+         * @param [in] count Durations count
+         * @param [out] code Decoded code
+         * 
+         * @retval true Frame was decoded
+         * @retval false Frame is not RC5 frame
+         */
+        static bool Decode(const uint16_t* durations, unsigned count, IrCode& code)
+        {
+            uint8_t levels[Bits * 2];
+
+            // First half of start bit is space. Last half may be space (it's merged with trailing gap)
+            unsigned length = Private::IrExpand(durations, count, HalfBit, 2, levels, sizeof(levels), 1);
+            if (length < sizeof(levels) - 1)
+                return false;
+
+            uint16_t frame = 0;
+            for (unsigned bit = 0; bit < Bits; ++bit) {
+                // Bit 1 is space-to-mark transition
+                if (levels[bit * 2] == levels[bit * 2 + 1])
+                    return false;
+                frame = (frame << 1) | levels[bit * 2 + 1];
+            }
+
+            // Second start bit is inverted 7-th command bit (RC5X)
+            uint8_t toggle = (frame >> 11) & 0x01;
+            uint16_t address = (frame >> 6) & 0x1f;
+            uint16_t command = (frame & 0x3f) | (((frame >> 12) & 0x01) ? 0 : 0x40);
+
+            code.Protocol = IrProtocol::Rc5;
+            code.Address = address;
+            code.Command = command;
+            code.Repeat = _valid && toggle == _toggle && address == _address && command == _command;
+
+            _toggle = toggle;
+            _address = address;
+            _command = command;
+            _valid = true;
+            return true;
+        }
+
+    private:
+        static inline uint16_t _address = 0; ///< Last address
+        static inline uint16_t _command = 0; ///< Last command
+        static inline uint8_t _toggle = 0; ///< Last toggle bit
+        static inline bool _valid = false; ///< Last code is valid
+    };
+
+    /**
+     * @brief RC6 (mode 0) frame decoder (for @ref IrCaptureReceiver)
+     */
+    class Rc6FrameDecoder
+    {
+        static const uint16_t Unit = 444;
+        /// Leader (6 + 2), start bit (2), mode (3 * 2), trailer (4), address and command (16 * 2)
+        static const unsigned Units = 52;
+    public:
+        /**
+         * @brief Decode frame
+         * 
+         * @param [in] durations Durations in us (marks at even indexes, spaces at odd ones)
+         * @param [in] count Durations count
+         * @param [out] code Decoded code
+         * 
+         * @retval true Frame was decoded
+         * @retval false Frame is not RC6 mode 0 frame
+         */
+        static bool Decode(const uint16_t* durations, unsigned count, IrCode& code)
+        {
+            uint8_t levels[Units];
+
+            unsigned length = Private::IrExpand(durations, count, Unit, 6, levels, sizeof(levels), 0);
+            if (length < sizeof(levels) - 1)
+                return false;
+
+            for (unsigned i = 0; i < 8; ++i) {
+                if (levels[i] != (i < 6 ? 1 : 0))
+                    return false;
+            }
+
+            unsigned position = 8;
+            uint8_t bit;
+
+            // Start bit is always 1
+            if (!ReadBit(levels, position, 1, bit) || bit != 1)
+                return false;
+
+            uint8_t mode = 0;
+            for (unsigned i = 0; i < 3; ++i) {
+                if (!ReadBit(levels, position, 1, bit))
+                    return false;
+                mode = (mode << 1) | bit;
+            }
+
+            uint8_t toggle;
+            if (mode != 0 || !ReadBit(levels, position, 2, toggle))
+                return false;
+
+            uint16_t frame = 0;
+            for (unsigned i = 0; i < 16; ++i) {
+                if (!ReadBit(levels, position, 1, bit))
+                    return false;
+                frame = (frame << 1) | bit;
+            }
+
+            uint16_t address = frame >> 8;
+            uint16_t command = frame & 0xff;
+
+            code.Protocol = IrProtocol::Rc6;
+            code.Address = address;
+            code.Command = command;
+            code.Repeat = _valid && toggle == _toggle && address == _address && command == _command;
+
+            _toggle = toggle;
+            _address = address;
+            _command = command;
+            _valid = true;
+            return true;
+        }
+
+    private:
+        /**
+         * @brief Reads bi-phase bit (bit 1 is mark-to-space transition)
+         * 
+         * @param [in] levels Levels
+         * @param [in, out] position Bit position
+         * @param [in] width Half-bit width (in units, 2 for trailer bit)
+         * @param [out] bit Bit value
+         * 
+         * @retval true Success
+         * @retval false Invalid bit
+         */
+        static bool ReadBit(const uint8_t* levels, unsigned& position, unsigned width, uint8_t& bit)
+        {
+            uint8_t first = levels[position];
+            uint8_t second = levels[position + width];
+
+            for (unsigned i = 1; i < width; ++i) {
+                if (levels[position + i] != first || levels[position + width + i] != second)
+                    return false;
+            }
+
+            position += width * 2;
+            bit = first;
+            return first != second;
+        }
+
+        static inline uint16_t _address = 0; ///< Last address
+        static inline uint16_t _command = 0; ///< Last command
+        static inline uint8_t _toggle = 0; ///< Last toggle bit
+        static inline bool _valid = false; ///< Last code is valid
+    };
+
+    /**
+     * @brief Sony SIRC frame decoder (for @ref IrCaptureReceiver)
+     * 
+     * @details
+     * Sony remotes repeat frame while key is held, but protocol has no toggle bit,
+     * so Repeat is always false.
+     */
+    class SircFrameDecoder
+    {
+    public:
+        /**
+         * @brief Decode frame
+         * 
+         * @param [in] durations Durations in us (marks at even indexes, spaces at odd ones)
+         * @param [in] count Durations count
+         * @param [out] code Decoded code
+         * 
+         * @retval true Frame was decoded
+         * @retval false Frame is not SIRC frame
+         */
+        static bool Decode(const uint16_t* durations, unsigned count, IrCode& code)
+        {
+            // Leader (mark + space) and bits (mark + space), last space is trailing gap
+            unsigned bits = (count - 1) / 2;
+            if (count % 2 == 0 || (bits != 12 && bits != 15 && bits != 20))
+                return false;
+
+            if (!Private::IrNear(durations[0], 2400) || !Private::IrNear(durations[1], 600))
+                return false;
+
+            uint32_t frame = 0;
+            for (unsigned bit = 0; bit < bits; ++bit) {
+                uint16_t mark = durations[2 + bit * 2];
+
+                if (bit < bits - 1 && !Private::IrNear(durations[3 + bit * 2], 600))
+                    return false;
+
+                if (Private::IrNear(mark, 1200))
+                    frame |= 1ul << bit;
+                else if (!Private::IrNear(mark, 600))
+                    return false;
+            }
+
+            // 7-bit command, then 5-bit or 8-bit address (20-bit frame has 8-bit extended address after 5-bit one)
+            code.Protocol = IrProtocol::Sirc;
+            code.Command = frame & 0x7f;
+            code.Address = static_cast<uint16_t>(frame >> 7);
+            code.Repeat = false;
+            return true;
+        }
+    };
+
+    /**
+     * @brief Tries several frame decoders (first decoded protocol is used)
+     * 
+     * @tparam _Decoders Frame decoders
+     */
+    template<typename... _Decoders>
+    class IrAnyFrameDecoder
+    {
+    public:
+        /**
+         * @brief Decode frame
+         * 
+         * @param [in] durations Durations in us (marks at even indexes, spaces at odd ones)
+         * @param [in] count Durations count
+         * @param [out] code Decoded code
+         * 
+         * @retval true Frame was decoded
+         * @retval false Frame was not decoded by any decoder
+         */
+        static bool Decode(const uint16_t* durations, unsigned count, IrCode& code)
+        {
+            return (_Decoders::Decode(durations, count, code) || ...);
+        }
+    };
+
+    /**
+     * @brief IR receiver with DMA edges capturing
+     * 
+     * @details
+     * Falling and rising edges of TI1 input are captured by channels 1 and 2 and copied by DMA
+     * into circular buffers, so there is no interrupt for every edge. Channel 3 interrupt checks
+     * buffers every 4 ms: when trailing gap (8 ms without edges) is detected, frame is converted
+     * to marks and spaces durations and decoded in one pass. Timer counts freely with 1 us tick.
+     * 
+     * @par Example
+     * @code
+     *  using Decoder = IrAnyFrameDecoder<NecFrameDecoder, Rc5FrameDecoder, Rc6FrameDecoder, SircFrameDecoder>;
+     *  using Receiver = IrCaptureReceiver<Timer3, Pa6, Dma1Channel6, Dma1Channel3, Decoder>;
+     *  Receiver::SetCallback([](const IrCode& code) {
+     *      // Do smth
+     *  });
+     *  Receiver::Init();
+     *  // TIM3_IRQHandler calls Receiver::IRQHandler()
+     * @endcode
+     * 
+     * @tparam _Timer GP timer instance
+     * @tparam _Pin Input pin (channel 1 pin)
+     * @tparam _FallingDma DMA channel of timer channel 1 capture request
+     * @tparam _RisingDma DMA channel of timer channel 2 capture request
+     * @tparam _Decoder Frame decoder (NecFrameDecoder, Rc5FrameDecoder, Rc6FrameDecoder, SircFrameDecoder or IrAnyFrameDecoder)
+     * @tparam _BufferSize Edges buffer size (for each direction)
+     */
+    template <typename _Timer, typename _Pin, typename _FallingDma, typename _RisingDma, typename _Decoder, unsigned _BufferSize = 64>
+    class IrCaptureReceiver
+    {
+        using InputCaptureFalling = typename _Timer::template InputCapture<0>;
+        using InputCaptureRising = typename _Timer::template InputCapture<1>;
+        using CheckChannel = typename _Timer::template OutputCompare<2>;
+
+        static const uint16_t GapTicks = 8000; ///< Trailing gap (longest space of supported protocols is 4.5 ms)
+        static const uint16_t CheckPeriod = 4000; ///< Gap check period
+    public:
+        using Callback = std::add_pointer_t<void(const IrCode& code)>;
+
+        /**
+         * @brief Init receiver
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+            _Timer::Enable();
+            _Timer::SetPrescaler(_Timer::GetClockFreq() / 1000000 * 2 - 1); // 1us period
+            _Timer::SetPeriod(0xffff);
+
+            InputCaptureFalling::SetCapturePolarity(InputCaptureFalling::CapturePolarity::FallingEdge);
+            InputCaptureFalling::SetCaptureMode(InputCaptureFalling::CaptureMode::Direct);
+            InputCaptureFalling::Enable();
+
+            InputCaptureRising::SetCapturePolarity(InputCaptureRising::CapturePolarity::RisingEdge);
+            InputCaptureRising::SetCaptureMode(InputCaptureRising::CaptureMode::Indirect);
+            InputCaptureRising::Enable();
+
+            _fallingRead = 0;
+            _risingRead = 0;
+            InputCaptureFalling::template StartCaptureStream<_FallingDma>(_falling, _BufferSize, nullptr, true);
+            InputCaptureRising::template StartCaptureStream<_RisingDma>(_rising, _BufferSize, nullptr, true);
+
+            CheckChannel::SetPulse(CheckPeriod);
+            CheckChannel::EnableInterrupt();
+
+            _Pin::Port::Enable();
+            _Pin::template SetConfiguration<_Pin::Configuration::In>();
+            _Pin::template SetPullMode<_Pin::PullMode::PullUp>();
+
+            _Timer::Start();
+        }
+
+        /**
+         * @brief Set callback for decoded codes (it's called from timer interrupt)
+         * 
+         * @param [in] callback Callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetCallback(Callback callback)
+        {
+            _callback = callback;
+        }
+
+        /**
+         * @brief Timer IRQ handler (call this method in TIMx_IRQHandler)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void IRQHandler()
+        {
+            if (CheckChannel::IsInterrupt()) {
+                CheckChannel::ClearInterruptFlag();
+                CheckChannel::SetPulse(CheckChannel::GetPulse() + CheckPeriod);
+
+                Process();
+            }
+        }
+
+        /**
+         * @brief Decode received frames (if trailing gap is elapsed)
+         * 
+         * @details
+         * It's called by IRQHandler, but it can be called from main loop too
+         * (timer IRQ should be disabled then).
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Process()
+        {
+            uint16_t falling = Position<_FallingDma>();
+            uint16_t rising = Position<_RisingDma>();
+            uint16_t now = _Timer::GetCounterValue();
+
+            // Edge was captured while positions were read
+            if (falling != Position<_FallingDma>() || rising != Position<_RisingDma>())
+                return;
+
+            unsigned pendingFalling = (falling + _BufferSize - _fallingRead) % _BufferSize;
+            unsigned pendingRising = (rising + _BufferSize - _risingRead) % _BufferSize;
+
+            if (pendingFalling == 0 && pendingRising == 0)
+                return;
+
+            // Mark is in progress
+            if (pendingRising < pendingFalling)
+                return;
+
+            // Rising edge without falling one (line was low at start), resync
+            if (pendingRising > pendingFalling) {
+                _fallingRead = falling;
+                _risingRead = rising;
+                return;
+            }
+
+            uint16_t lastRising = _rising[(rising + _BufferSize - 1) % _BufferSize];
+            if (static_cast<uint16_t>(now - lastRising) < GapTicks)
+                return;
+
+            // Edges alternate, so falling[i]..rising[i] is mark and rising[i]..falling[i + 1] is space
+            unsigned count = 0;
+            uint16_t previousRising = 0;
+            for (unsigned i = 0; i < pendingFalling; ++i) {
+                uint16_t fallingEdge = _falling[(_fallingRead + i) % _BufferSize];
+                uint16_t risingEdge = _rising[(_risingRead + i) % _BufferSize];
+
+                if (count > 0) {
+                    uint16_t space = fallingEdge - previousRising;
+                    if (space >= GapTicks) {
+                        Decode(count);
+                        count = 0;
+                    }
+                    else {
+                        _durations[count++] = space;
+                    }
+                }
+
+                _durations[count++] = risingEdge - fallingEdge;
+                previousRising = risingEdge;
+            }
+            Decode(count);
+
+            _fallingRead = falling;
+            _risingRead = rising;
+        }
+
+    private:
+        /**
+         * @brief Returns DMA write position
+         * 
+         * @tparam _Dma DMA channel
+         * 
+         * @returns Position
+         */
+        template<typename _Dma>
+        static uint16_t Position()
+        {
+            return (_BufferSize - _Dma::RemainingTransfers()) % _BufferSize;
+        }
+
+        /**
+         * @brief Decode frame and notify user
+         * 
+         * @param [in] count Durations count
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Decode(unsigned count)
+        {
+            IrCode code;
+            if (_Decoder::Decode(_durations, count, code) && _callback != nullptr)
+                _callback(code);
+        }
+
+        static inline uint16_t _falling[_BufferSize]; ///< Falling edges timestamps
+        static inline uint16_t _rising[_BufferSize]; ///< Rising edges timestamps
+        static inline uint16_t _durations[_BufferSize * 2]; ///< Frame durations
+        static inline unsigned _fallingRead = 0; ///< Falling edges read position
+        static inline unsigned _risingRead = 0; ///< Rising edges read position
+        static inline Callback _callback = nullptr; ///< Code callback
+    };
 }
 #endif // !ZHELE_DRIVERS_IR_H
\ No newline at end of file
@@ -0,0 +1,325 @@
+/**
+ * @file
+ * Implements DMA-driven key matrix and LED multiplex scanner
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_MATRIX_SCANNER_H
+#define ZHELE_DRIVERS_MATRIX_SCANNER_H
+
+#include <zhele/dma.h>
+#include <zhele/pinlist.h>
+#include <zhele/timer.h>
+
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Class for key matrix and multiplexed display scanner
+     *
+     * @details
+     * Row step is one timer period. On update event DMA writes BSRR word of the next row to row port:
+     * it selects row (open-drain output low, other rows are released) and sets segments of the row (digit) at the same write,
+     * so there is no ghosting between digits. In the middle of step compare event of timer channel requests the second DMA
+     * that copies column port IDR (columns are pulled up, pressed key pulls column low) to samples buffer.
+     * Both transfers are circular, so matrix is scanned without CPU. Column DMA completes once per scan of all rows,
+     * its interrupt debounces keys (4 equal samples, vertical counters) and reports changes by callback.
+     * Display segments are changed by single table word write (@ref SetSegments), so display never flickers.
+     *
+     * @note DMA must have access to GPIO (on stm32f4 only DMA2 does, so use TIM1/TIM8 requests).
+     *
+     * @par Example
+     * @code
+     *  using Rows = IO::PinList<IO::Pb0, IO::Pb1, IO::Pb2, IO::Pb3>;
+     *  using Columns = IO::PinList<IO::Pa0, IO::Pa1, IO::Pa2, IO::Pa3>;
+     *  using Segments = IO::PinList<IO::Pb8, IO::Pb9, IO::Pb10, IO::Pb11, IO::Pb12, IO::Pb13, IO::Pb14, IO::Pb15>;
+     *  using Scanner = Drivers::MatrixScanner<Rows, Columns, Timers::Timer2, Dma1Channel2, Dma1Channel5, Segments>;
+     *  Scanner::Init(4000, [](uint8_t row, uint8_t column, bool pressed) { OnKey(row * 4 + column, pressed); });
+     *  Scanner::SetSegments(0, 0x3f); // "0" on the first digit
+     *  Scanner::Start();
+     * @endcode
+     *
+     * @tparam _RowPins Row (digit select) pins (pinlist, all pins on one port)
+     * @tparam _ColPins Column (key input) pins (pinlist, all pins on one port)
+     * @tparam _Timer Timer that paces rows
+     * @tparam _RowDma DMA channel (stream) connected to timer update request
+     * @tparam _ColDma DMA channel (stream) connected to timer channel compare request
+     * @tparam _SegmentPins Display segments pins (pinlist on rows port, segment is on at high level) or void
+     * @tparam _SampleChannel Timer channel that triggers columns sampling
+     */
+    template <typename _RowPins, typename _ColPins, typename _Timer, typename _RowDma, typename _ColDma,
+            typename _SegmentPins = void, unsigned _SampleChannel = 0>
+    class MatrixScanner
+    {
+        using RowPort = typename _RowPins::template Pin<0>::Port;
+        using ColPort = typename _ColPins::template Pin<0>::Port;
+        using Sample = typename _Timer::template OutputCompare<_SampleChannel>;
+
+        static constexpr uint32_t SegmentMask()
+        {
+            if constexpr (std::is_void_v<_SegmentPins>)
+                return 0;
+            else
+                return _SegmentPins::template PortMask<RowPort>();
+        }
+
+        static constexpr unsigned SegmentCount()
+        {
+            if constexpr (std::is_void_v<_SegmentPins>)
+                return 0;
+            else
+                return _SegmentPins::Length;
+        }
+
+        static const uint32_t RowMask = _RowPins::template PortMask<RowPort>();
+        static const uint32_t ColMask = _ColPins::template PortMask<ColPort>();
+
+        static_assert(std::popcount(RowMask) == _RowPins::Length, "All row pins must be on one port");
+        static_assert(std::popcount(ColMask) == _ColPins::Length, "All column pins must be on one port");
+        static_assert(std::popcount(SegmentMask()) == SegmentCount(), "Segment pins must be on rows port");
+        static_assert((RowMask & SegmentMask()) == 0, "Row pin cannot be segment pin");
+        static_assert(_ColPins::Length <= 16, "Too many columns");
+    public:
+        /// Rows (digits) count
+        static const unsigned Rows = _RowPins::Length;
+
+        /// Columns count
+        static const unsigned Columns = _ColPins::Length;
+
+        /// Key event callback (called from DMA interrupt)
+        using KeyCallback = std::add_pointer_t<void(uint8_t row, uint8_t column, bool pressed)>;
+
+        /**
+         * @brief Init timer, DMA and pins
+         *
+         * @param [in] rowRate Row steps per second (scan rate is rowRate / Rows)
+         * @param [in] callback Key event callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint32_t rowRate, KeyCallback callback = nullptr)
+        {
+            _callback = callback;
+
+            _RowPins::Enable();
+            _RowPins::Write(static_cast<typename _RowPins::DataType>(~0u));
+            _RowPins::template SetConfiguration<_RowPins::Out>();
+            _RowPins::template SetDriverType<_RowPins::OpenDrain>();
+            if constexpr (!std::is_void_v<_SegmentPins>)
+            {
+                _SegmentPins::Enable();
+                _SegmentPins::Write(0);
+                _SegmentPins::template SetConfiguration<_SegmentPins::Out>();
+                _SegmentPins::template SetDriverType<_SegmentPins::PushPull>();
+            }
+
+            _ColPins::Enable();
+            _ColPins::template SetConfiguration<_ColPins::In>();
+            _ColPins::template SetPullMode<_ColPins::PullUp>();
+
+            for (unsigned row = 0; row < Rows; ++row)
+            {
+                _table[TableIndex(row)] = RowWord(row, 0);
+                _state[row] = 0;
+                _counter0[row] = _counter1[row] = static_cast<uint16_t>(~0u);
+            }
+
+            const uint32_t period = _Timer::GetClockFreq() / rowRate;
+            _Timer::Enable();
+            _Timer::Stop();
+            _Timer::SetPrescaler(0);
+            _Timer::SetPeriod(period - 1);
+            Sample::SetOutputMode(Sample::Timing);
+            Sample::SetPulse(period / 2);
+        }
+
+        /**
+         * @brief Start scanning
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start()
+        {
+            // Row 0 is selected before start, so table entry r selects row r + 1 (update r ends step r)
+            *RowPort::BitSetResetRegister() = _table[TableIndex(0)];
+
+            _RowDma::Transfer(_RowDma::Mem2Periph | _RowDma::MemIncrement | _RowDma::Circular | _RowDma::PriorityHigh
+                            | _RowDma::PSize32Bits | _RowDma::MSize32Bits, _table, RowPort::BitSetResetRegister(), Rows);
+
+            _ColDma::SetTransferCallback(ScanHandler);
+            _ColDma::Transfer(_ColDma::Periph2Mem | _ColDma::MemIncrement | _ColDma::Circular | _ColDma::PriorityHigh
+                            | _ColDma::PSize16Bits | _ColDma::MSize16Bits, _samples, ColPort::InputDataRegister(), Rows);
+
+            _Timer::ResetCounterValue();
+            _Timer::DmaRequestEnable();
+            Sample::EnableDmaRequest();
+            _Timer::Start();
+        }
+
+        /**
+         * @brief Stop scanning (rows are released, segments are off)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop()
+        {
+            _Timer::Stop();
+            _Timer::DmaRequestDisable();
+            Sample::DisableDmaRequest();
+            _RowDma::Disable();
+            _ColDma::Disable();
+            *RowPort::BitSetResetRegister() = RowMask | (SegmentMask() << 16);
+        }
+
+        /**
+         * @brief Check debounced key state
+         *
+         * @param [in] row Row
+         * @param [in] column Column
+         *
+         * @retval true Key is pressed
+         * @retval false Key is released
+         */
+        static bool IsPressed(unsigned row, unsigned column)
+        {
+            return row < Rows && (_state[row] & (1u << column)) != 0;
+        }
+
+        /**
+         * @brief Returns debounced keys state of row
+         *
+         * @param [in] row Row
+         *
+         * @returns Pressed keys mask (bit n is column n)
+         */
+        static uint16_t RowState(unsigned row)
+        {
+            return row < Rows ? _state[row] : 0;
+        }
+
+        /**
+         * @brief Set segments of digit
+         *
+         * @details
+         * Table word is replaced by one store, so DMA sends either old or new pattern.
+         *
+         * @param [in] row Row (digit)
+         * @param [in] segments Segments mask (bit n is segment pin n)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetSegments(unsigned row, uint16_t segments)
+        {
+            static_assert(!std::is_void_v<_SegmentPins>, "Scanner has no segment pins");
+            if (row < Rows)
+                _table[TableIndex(row)] = RowWord(row, segments);
+        }
+
+        /**
+         * @brief Returns completed scans count
+         *
+         * @returns Scans count
+         */
+        static uint32_t Scans()
+        {
+            return _scans;
+        }
+
+    private:
+        static constexpr unsigned TableIndex(unsigned row)
+        {
+            return (row + Rows - 1) % Rows;
+        }
+
+        static uint32_t RowWord(unsigned row, uint16_t segments)
+        {
+            const uint32_t select = _RowPins::template PortValue<RowPort>(static_cast<typename _RowPins::DataType>(1u << row));
+            uint32_t on = 0;
+            if constexpr (!std::is_void_v<_SegmentPins>)
+                on = _SegmentPins::template PortValue<RowPort>(static_cast<typename _SegmentPins::DataType>(segments));
+
+            // Selected row is low, others are released
+            return (RowMask & ~select) | on | ((select | (SegmentMask() & ~on)) << 16);
+        }
+
+        static uint16_t Pressed(uint16_t sample)
+        {
+            uint16_t pressed = 0;
+            for (unsigned column = 0; column < Columns; ++column)
+            {
+                const uint32_t mask = _ColPins::template PortValue<ColPort>(static_cast<typename _ColPins::DataType>(1u << column));
+                if ((sample & mask) == 0)
+                    pressed |= 1u << column;
+            }
+            return pressed;
+        }
+
+        static void ScanHandler(void*, unsigned, bool success)
+        {
+            if (!success)
+                return;
+
+            ++_scans;
+            for (unsigned row = 0; row < Rows; ++row)
+            {
+                // Vertical counters: bit changes after 4 equal samples
+                uint16_t changed = _state[row] ^ Pressed(_samples[row]);
+                _counter0[row] = ~(_counter0[row] & changed);
+                _counter1[row] = _counter0[row] ^ (_counter1[row] & changed);
+                changed &= _counter0[row] & _counter1[row];
+                _state[row] ^= changed;
+
+                while (_callback && changed != 0)
+                {
+                    const unsigned column = std::countr_zero(changed);
+                    changed &= changed - 1;
+                    _callback(row, column, (_state[row] & (1u << column)) != 0);
+                }
+            }
+        }
+
+        static uint32_t _table[Rows];
+        static uint16_t _samples[Rows];
+        static uint16_t _state[Rows];
+        static uint16_t _counter0[Rows];
+        static uint16_t _counter1[Rows];
+        static KeyCallback _callback;
+        static volatile uint32_t _scans;
+    };
+
+    #define MATRIX_SCANNER_TEMPLATE_ARGS template <typename _RowPins, typename _ColPins, typename _Timer, typename _RowDma, typename _ColDma, typename _SegmentPins, unsigned _SampleChannel>
+    #define MATRIX_SCANNER_TEMPLATE_QUALIFIER MatrixScanner<_RowPins, _ColPins, _Timer, _RowDma, _ColDma, _SegmentPins, _SampleChannel>
+
+    MATRIX_SCANNER_TEMPLATE_ARGS
+    uint32_t MATRIX_SCANNER_TEMPLATE_QUALIFIER::_table[Rows];
+
+    MATRIX_SCANNER_TEMPLATE_ARGS
+    uint16_t MATRIX_SCANNER_TEMPLATE_QUALIFIER::_samples[Rows];
+
+    MATRIX_SCANNER_TEMPLATE_ARGS
+    uint16_t MATRIX_SCANNER_TEMPLATE_QUALIFIER::_state[Rows];
+
+    MATRIX_SCANNER_TEMPLATE_ARGS
+    uint16_t MATRIX_SCANNER_TEMPLATE_QUALIFIER::_counter0[Rows];
+
+    MATRIX_SCANNER_TEMPLATE_ARGS
+    uint16_t MATRIX_SCANNER_TEMPLATE_QUALIFIER::_counter1[Rows];
+
+    MATRIX_SCANNER_TEMPLATE_ARGS
+    typename MATRIX_SCANNER_TEMPLATE_QUALIFIER::KeyCallback MATRIX_SCANNER_TEMPLATE_QUALIFIER::_callback;
+
+    MATRIX_SCANNER_TEMPLATE_ARGS
+    volatile uint32_t MATRIX_SCANNER_TEMPLATE_QUALIFIER::_scans;
+}
+
+#endif //! ZHELE_DRIVERS_MATRIX_SCANNER_H
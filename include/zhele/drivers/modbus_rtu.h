@@ -0,0 +1,280 @@
+/**
+ * @file
+ * Implements Modbus RTU frame engine over RS485
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_MODBUS_RTU_H
+#define ZHELE_DRIVERS_MODBUS_RTU_H
+
+#include <zhele/drivers/adm485.h>
+#include <zhele/soft_crc.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Implements Modbus RTU frames transmission and reception (for master and slave)
+     *
+     * @details
+     * Frames are sent by DMA from internal buffer. Reception is performed by DMA too,
+     * frame end is detected by receiver timeout (t3.5 silence) on USARTs with RTO feature
+     * or by idle line (one character silence) on other ones (F1, F4), so there are no per-byte interrupts.
+     * Frame CRC16 is calculated by table-driven @ref Crc16Modbus.
+     *
+     * Receiver is stopped while frame is transmitted and restarted when line is released,
+     * so response can be sent right from frame callback. Slave engine (non-zero address)
+     * accepts frames with its address and broadcast frames, master engine accepts all frames.
+     *
+     * Frame callback is called from USART interrupt. Call @ref IrqHandler from USART IRQ handler,
+     * TX DMA IRQ handler should call _Rs485::DmaTx::IrqHandler.
+     *
+     * @par Example
+     * @code
+     *  using Rs485 = Adm485<Usart1, IO::Pa8>;
+     *  using Modbus = ModbusRtu<Rs485>;
+     *
+     *  void OnFrame(uint8_t address, uint8_t function, const uint8_t* data, unsigned size)
+     *  {
+     *      // Parse response
+     *  }
+     *
+     *  Modbus::Init(115200);
+     *  Modbus::SetFrameCallback(OnFrame);
+     *  const uint8_t request[] = {0x00, 0x00, 0x00, 0x0a}; // Read 10 holding registers from 0
+     *  Modbus::Send(0x01, 0x03, request, sizeof(request));
+     *
+     *  extern "C" void USART1_IRQHandler()
+     *  {
+     *      Modbus::IrqHandler();
+     *  }
+     * @endcode
+     *
+     * @tparam _Rs485 RS485 driver (@ref Adm485)
+     * @tparam _BufferSize Max frame size (with address and CRC)
+     */
+    template<typename _Rs485, unsigned _BufferSize = 256>
+    class ModbusRtu
+    {
+        static_assert(_BufferSize >= 4, "Buffer is too small for Modbus frame");
+
+        using DmaRx = typename _Rs485::DmaRx;
+        static const unsigned CharacterBits = 11; ///< Start, 8 data, parity (or second stop) and stop bits
+    public:
+        /// Received frame callback (data is valid until callback returns)
+        using FrameCallback = std::add_pointer_t<void(uint8_t address, uint8_t function, const uint8_t* data, unsigned size)>;
+
+        /// Master (accepts every frame)
+        static const uint8_t MasterAddress = 0;
+        /// Broadcast address
+        static const uint8_t BroadcastAddress = 0;
+
+        /**
+         * @brief Initializes USART and starts reception
+         *
+         * @param [in] baud Baud rate
+         * @param [in] address Slave address (MasterAddress for master)
+         * @param [in] mode USART mode (Modbus requires 8E1 by default, 8N2 and 8N1 are common too)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(unsigned baud, uint8_t address = MasterAddress, typename _Rs485::UsartMode mode = DefaultUsartMode)
+        {
+            _address = address;
+            _Rs485::Init(baud, mode);
+
+        #if defined (USART_CR2_RTOEN)
+            // t3.5 is fixed to 1750 us for baud rates greater than 19200
+            uint32_t silenceBits = baud > 19200
+                ? static_cast<uint32_t>((1750ull * baud + 999999) / 1000000)
+                : (CharacterBits * 7 + 1) / 2;
+            _Rs485::EnableReceiverTimeout(silenceBits);
+            _Rs485::ClearInterruptFlag(_Rs485::ReceiveTimeout);
+            _Rs485::EnableInterrupt(_Rs485::ReceiveTimeout);
+        #else
+            _Rs485::ClearInterruptFlag(_Rs485::IdleInt);
+            _Rs485::EnableInterrupt(_Rs485::IdleInt);
+        #endif
+
+            StartReceive();
+        }
+
+    #if defined (USART_CR2_RTOEN)
+        /**
+         * @brief Sets frame end silence (it's t3.5 after @ref Init)
+         *
+         * @param [in] bitCount Silence time (in bits)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetFrameTimeout(uint32_t bitCount)
+        {
+            _Rs485::SetReceiverTimeout(bitCount);
+        }
+    #endif
+
+        /**
+         * @brief Sets received frame callback
+         *
+         * @param [in] callback Callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetFrameCallback(FrameCallback callback)
+        {
+            _callback = callback;
+        }
+
+        /**
+         * @brief Sends frame
+         *
+         * @param [in] address Slave address (own address for slave response)
+         * @param [in] function Function code
+         * @param [in] data Frame data (it's copied to internal buffer)
+         * @param [in] size Data size
+         *
+         * @retval true Frame transmission is started
+         * @retval false Previous frame is being sent or frame is too long
+         */
+        static bool Send(uint8_t address, uint8_t function, const void* data, unsigned size)
+        {
+            if (_transmitting || size + 4 > _BufferSize)
+                return false;
+
+            _txBuffer[0] = address;
+            _txBuffer[1] = function;
+            if (size > 0)
+                memcpy(&_txBuffer[2], data, size);
+            uint16_t crc = Crc16Modbus::Calculate(_txBuffer, size + 2);
+            _txBuffer[size + 2] = static_cast<uint8_t>(crc);
+            _txBuffer[size + 3] = static_cast<uint8_t>(crc >> 8);
+
+            _transmitting = true;
+            StopReceive();
+            _Rs485::WriteAsync(_txBuffer, size + 4, TransmitComplete);
+            return true;
+        }
+
+        /**
+         * @brief Check that frame is being sent
+         *
+         * @retval true Frame is being sent
+         * @retval false Engine is receiving
+         */
+        static bool Busy()
+        {
+            return _transmitting;
+        }
+
+        /**
+         * @brief Returns received valid frames count
+         *
+         * @returns Frames count
+         */
+        static unsigned Frames()
+        {
+            return _frames;
+        }
+
+        /**
+         * @brief Returns rejected frames count (CRC, length or USART errors)
+         *
+         * @returns Errors count
+         */
+        static unsigned Errors()
+        {
+            return _errors;
+        }
+
+        /**
+         * @brief USART interrupt handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler()
+        {
+            _Rs485::IrqHandler();
+
+            auto source = _Rs485::InterruptSource();
+        #if defined (USART_CR2_RTOEN)
+            if (!(source & _Rs485::ReceiveTimeout))
+                return;
+            _Rs485::ClearInterruptFlag(_Rs485::ReceiveTimeout);
+        #else
+            if (!(source & _Rs485::IdleInt))
+                return;
+            // IDLE is cleared by SR read followed by DR read
+            (void)typename _Rs485::Regs()->RECEIVE_DATA_REG;
+        #endif
+
+            if (!_transmitting)
+                FrameReceived();
+        }
+
+    private:
+        static void StartReceive()
+        {
+            // Drop data received while receiver was stopped
+            _Rs485::ClearInterruptFlag(static_cast<typename _Rs485::InterruptFlags>(_Rs485::OverrunError));
+            while (_Rs485::ReadReady())
+                (void)_Rs485::Read();
+
+            _Rs485::EnableAsyncRead(_rxBuffer, _BufferSize);
+        }
+
+        static void StopReceive()
+        {
+            DmaRx::Disable();
+        }
+
+        static void FrameReceived()
+        {
+            unsigned size = _BufferSize - DmaRx::RemainingTransfers();
+            bool overrun = _Rs485::GetError() & _Rs485::OverrunError;
+            StopReceive();
+
+            if (size == 0) {
+                StartReceive();
+                return;
+            }
+
+            if (overrun || size < 4 || Crc16Modbus::Calculate(_rxBuffer, size) != 0) {
+                _errors = _errors + 1;
+            } else if (_address == MasterAddress || _rxBuffer[0] == _address || _rxBuffer[0] == BroadcastAddress) {
+                _frames = _frames + 1;
+                if (_callback)
+                    _callback(_rxBuffer[0], _rxBuffer[1], &_rxBuffer[2], size - 4);
+            }
+
+            // Callback may start response transmission
+            if (!_transmitting)
+                StartReceive();
+        }
+
+        static void TransmitComplete()
+        {
+            _transmitting = false;
+            StartReceive();
+        }
+
+        static inline uint8_t _rxBuffer[_BufferSize]; ///< Received frame
+        static inline uint8_t _txBuffer[_BufferSize]; ///< Transmitted frame
+        static inline uint8_t _address = MasterAddress; ///< Own address
+        static inline FrameCallback _callback = nullptr; ///< Frame callback
+        static inline volatile bool _transmitting = false; ///< Frame is being sent
+        static inline volatile unsigned _frames = 0; ///< Valid frames count
+        static inline volatile unsigned _errors = 0; ///< Rejected frames count
+    };
+}
+
+#endif //! ZHELE_DRIVERS_MODBUS_RTU_H
@@ -10,6 +10,11 @@
 #ifndef ZHELE_DRIVERS_NRF24L_H
 #define ZHELE_DRIVERS_NRF24L_H
 
+#include <zhele/containers/ring_buffer.h>
+
+#include <string.h>
+#include <type_traits>
+
 namespace Zhele::Drivers
 {	
     /**
@@ -48,9 +53,32 @@ namespace Zhele::Drivers
             RxPayload5 = 0x16, ///< Number of bytes in RX payload id data pipe 5 (0 - pipe no used, 1..32 - data size in bytes)
             FifoStatus = 0x17, ///< FIFO status register
             DynamicPayload = 0x1c, ///< Dynamic payload setting
-            Feature = 0x1d ///< Reserved
+            Feature = 0x1d ///< Feature register
         };
 
+        /**
+         * @brief NRF24L commands
+         */
+        enum Commands : uint8_t
+        {
+            ReadRxPayloadWidth = 0x60, ///< Read payload width (from the top of RX FIFO)
+            ReadRxPayload = 0x61, ///< Read RX payload (from the top of RX FIFO)
+            WriteTxPayload = 0xa0, ///< Write TX payload (to TX FIFO)
+            WriteAckPayload = 0xa8, ///< Write ACK payload for pipe (pipe number is in 3 LSB)
+            FlushTxCommand = 0xe1, ///< Flush TX FIFO
+            FlushRxCommand = 0xe2, ///< Flush RX FIFO
+            Nop = 0xff ///< No operation (returns status register)
+        };
+
+        /// TX FIFO depth (packets)
+        static const uint8_t TxFifoDepth = 3;
+
+        /// Max payload size
+        static const uint8_t MaxPayloadSize = 32;
+
+        /// Pipes count
+        static const uint8_t PipesCount = 6;
+
         /**
          * @brief Default values for registers (need for init/reset)
          */
@@ -263,6 +291,24 @@ namespace Zhele::Drivers
             RfDataRate250Kbps = 0b100 << RfDataRatePos, ///< Data rate 250Kbps
         };
 
+        /**
+         * @brief FEATURE register wrapper
+         */
+        enum FeatureRegister : uint8_t
+        {
+            FeatureDynamicAckPos = 0,
+            FeatureDynamicAckMask = 1 << FeatureDynamicAckPos,
+            FeatureDynamicAck = FeatureDynamicAckMask, ///< Enable W_TX_PAYLOAD_NOACK command
+
+            FeatureAckPayloadPos = 1,
+            FeatureAckPayloadMask = 1 << FeatureAckPayloadPos,
+            FeatureAckPayload = FeatureAckPayloadMask, ///< Enable payload with ACK
+
+            FeatureDynamicPayloadPos = 2,
+            FeatureDynamicPayloadMask = 1 << FeatureDynamicPayloadPos,
+            FeatureDynamicPayload = FeatureDynamicPayloadMask, ///< Enable dynamic payload length
+        };
+
         /**
          * @brief Status register wrapper
          */
@@ -347,15 +393,84 @@ namespace Zhele::Drivers
     /**
      * @brief Implements NRF24L+ functional
      * 
+     * @details
+     * Module can be used in polling mode (@ref Transmit, @ref DataReady, @ref GetData) or
+     * in interrupt mode (@ref EnableInterruptMode, @ref TransmitAsync, @ref Receive).
+     * In interrupt mode IRQ pin (EXTI line) drives state machine: received packets are read by DMA
+     * to RX queue, packets from TX queue are loaded by DMA to TX FIFO (all 3 levels are used), so radio
+     * sends them back-to-back with auto acknowledgment. Radio stays in TX mode while TX queue
+     * is not empty and returns to RX mode after that.
+     * 
+     * Interrupt mode requires SPI bus with DMA, EXTI handler must call @ref IrqHandler
+     * and DMA channels interrupts of SPI must be enabled.
+     * 
+     * For star network (gateway) module listens up to 6 pipes (@ref SetPipeAddress). Packets of pipe
+     * with handler (@ref SetPipeHandler) are passed to handler, other ones are queued with pipe number.
+     * With dynamic payload length (@ref EnableDynamicPayload) gateway can reply by ACK payloads (@ref SetAckPayload).
+     * 
+     * @par Example
+     * @code
+     *  using Radio = Nrf24l<Spi1, Pa4, Pa3, Pa2, Exti2>;
+     *  Radio::Init(76);
+     *  Radio::EnableInterruptMode();
+     *  Radio::TransmitAsync(packet);
+     *  if (Radio::Receive(buffer))
+     *  {
+     *      // ...
+     *  }
+     *  extern "C" void EXTI2_IRQHandler()
+     *  {
+     *      Radio::IrqHandler();
+     *  }
+     * @endcode
+     * 
      * @tparam SpiBus Spi bus class
      * @tparam SSPin GPIO pin for SS
      * @tparam CEPin GPIO pin for CE
      * @tparam EXTIPin Pin for extern interrupt. Use it if you want to connect IRQ 
+     * @tparam _IrqLine EXTI line of IRQ pin (required for interrupt mode)
+     * @tparam _QueueSize RX and TX queues size (packets)
      */
-    template<typename SpiBus, typename SSPin, typename CEPin, typename EXTIPin = IO::NullPin>
+    template<typename SpiBus, typename SSPin, typename CEPin, typename EXTIPin = IO::NullPin, typename _IrqLine = void, unsigned _QueueSize = 8>
     class Nrf24l : public Nrf24lBase
-    {		
+    {
+        /// Queued packet
+        struct Packet
+        {
+            uint8_t Data[MaxPayloadSize]; ///< Payload
+            uint8_t Size; ///< Payload size
+            uint8_t Pipe; ///< Pipe number (for received packet)
+        };
+
+        /// Received packet destination
+        enum class RxTarget : uint8_t
+        {
+            Queue, ///< RX queue
+            Handler, ///< Pipe handler
+            Drop ///< RX queue is full, packet is dropped
+        };
     public:
+        /**
+         * @brief Received packet handler (it's called in interrupt context)
+         * 
+         * @param [in] data Payload
+         * @param [in] size Payload size
+         */
+        using PacketHandler = std::add_pointer_t<void(const uint8_t* data, uint8_t size)>;
+
+        /**
+         * @brief Time source for radio events (for example, 64-bit timer timestamp)
+         */
+        using TimeSource = std::add_pointer_t<uint64_t()>;
+
+        /**
+         * @brief Radio event handler (it's called in interrupt context)
+         * 
+         * @param [in] transmitted Packet is transmitted (TX_DS), otherwise packet is received (RX_DR)
+         * @param [in] time Time of IRQ pin edge
+         */
+        using EventHandler = std::add_pointer_t<void(bool transmitted, uint64_t time)>;
+
         /**
          * @brief Init module
          * 
@@ -374,6 +489,8 @@ namespace Zhele::Drivers
                 payloadSize = 32;
 
             _payloadSize = payloadSize;
+            _dynamicPayload = false;
+            _interruptMode = false;
             Reset();
 
             SetChannel(channel);
@@ -481,24 +598,21 @@ namespace Zhele::Drivers
         /**
          * @brief Transmit data
          * 
-         * @param [in] data Data to transmit (module will transmit payloadSize bytes)
+         * @param [in] data Data to transmit
+         * @param [in] size Data size (ignored without dynamic payload length, 0 for payloadSize)
          * 
          * @par Returns
          *	Nothing
          */
-        static void Transmit(const uint8_t* data)
+        static void Transmit(const uint8_t* data, uint8_t size = 0)
         {
             CEPin::Clear();
             PowerUpTx();
             FlushTx();
 
             SSPin::Clear();
-            SpiBus::Send(0xa0);
-            for (int i = 0; i < _payloadSize; ++i)
-            {
-                SpiBus::Send(data[i]);
-            }
-
+            SpiBus::Send(WriteTxPayload);
+            SpiBus::Transfer(data, nullptr, TransmitSize(size));
             SSPin::Set();
             CEPin::Set();
         }
@@ -506,20 +620,34 @@ namespace Zhele::Drivers
         /**
          * @brief Get data (read) from module
          * 
-         * @param [out] data Buffer
+         * @param [out] data Buffer (32 bytes with dynamic payload length, payloadSize otherwise)
+         * @param [out] pipe Pipe number (optional)
          * 
-         * @par Returns
-         *	Nothing
+         * @returns Payload size (0 for corrupted dynamic length packet)
          */
-        static void GetData(uint8_t* data)
+        static uint8_t GetData(uint8_t* data, uint8_t* pipe = nullptr)
         {
-            SSPin::Clear();
-            SpiBus::Send(0x61);
-            for (int i = 0; i < _payloadSize; ++i)
-                data[i] = SpiBus::Send(0x00);
-            SSPin::Set();
+            uint8_t status = GetStatus();
+            uint8_t size = ReceiveSize();
 
+            if (size > MaxPayloadSize)
+            {
+                FlushRx();
+                size = 0;
+            }
+            else
+            {
+                SSPin::Clear();
+                SpiBus::Send(ReadRxPayload);
+                SpiBus::Transfer(nullptr, data, size);
+                SSPin::Set();
+            }
+
+            if (pipe != nullptr)
+                *pipe = (status & RxPipeNumberMask) >> RxPipeNumberPos;
             WriteRegister(Registers::Status, StatusRegister::RxDr);
+
+            return size;
         }
 
         /**
@@ -552,7 +680,7 @@ namespace Zhele::Drivers
         static uint8_t GetStatus()
         {
             SSPin::Clear();
-            uint8_t status = SpiBus::Send(0xff);
+            uint8_t status = SpiBus::Send(Nop);
             SSPin::Set();
 
             return status;
@@ -589,7 +717,628 @@ namespace Zhele::Drivers
         {
             return ReadRegister(Registers::ObserveTx) & 0x0f;
         }
+
+        /**
+         * @brief Sets pipe address and enables pipe (with auto acknowledgment)
+         * 
+         * @details
+         * Pipes 0 and 1 have full (5 bytes) addresses, pipes 2-5 share 4 high bytes with pipe 1,
+         * so only first (LSB) byte of address is used for them. Pipe 0 is also used by @ref SetTxAddress
+         * (for TX acknowledgment). Configure pipes before @ref EnableInterruptMode.
+         * 
+         * @param [in] pipe Pipe number (0-5)
+         * @param [in] address Address (5 bytes, LSB first)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void SetPipeAddress(uint8_t pipe, const uint8_t* address)
+        {
+            if (pipe >= PipesCount)
+                return;
+
+            CEPin::Clear();
+            Registers addressRegister = static_cast<Registers>(static_cast<uint8_t>(Registers::RxAddress0) + pipe);
+            if (pipe < 2)
+                WriteRegister(addressRegister, address, 5);
+            else
+                WriteRegister(addressRegister, address[0]);
+
+            WriteBit(Registers::EnableRxAddresses, pipe, true);
+            WriteBit(Registers::EnableAutoAcknowledgment, pipe, true);
+            CEPin::Set();
+        }
+
+        /**
+         * @brief Disables pipe
+         * 
+         * @param [in] pipe Pipe number (0-5)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void DisablePipe(uint8_t pipe)
+        {
+            if (pipe >= PipesCount)
+                return;
+
+            WriteBit(Registers::EnableRxAddresses, pipe, false);
+        }
+
+        /**
+         * @brief Enables dynamic payload length (for all pipes)
+         * 
+         * @details
+         * Both sides must use dynamic payload length. Configure it before @ref EnableInterruptMode.
+         * 
+         * @param [in] ackPayload Enable ACK payloads
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void EnableDynamicPayload(bool ackPayload = true)
+        {
+            WriteRegister(Registers::Feature, FeatureDynamicPayload | (ackPayload ? FeatureAckPayload : 0));
+            WriteRegister(Registers::DynamicPayload, (1 << PipesCount) - 1);
+            _dynamicPayload = true;
+        }
+
+        /**
+         * @brief Sets payload for next acknowledgment of pipe (RX mode)
+         * 
+         * @details
+         * Requires dynamic payload length with ACK payloads. In interrupt mode payload is loaded
+         * to module by state machine. TX FIFO is shared by ACK payloads (up to 3) and transmitted packets,
+         * so ACK payloads that are not sent are discarded when module switches to TX mode.
+         * 
+         * @param [in] pipe Pipe number (0-5)
+         * @param [in] data Payload
+         * @param [in] size Payload size (1-32)
+         * 
+         * @retval true Payload is accepted
+         * @retval false Invalid parameters or previous payload of pipe is not loaded yet
+         */
+        static bool SetAckPayload(uint8_t pipe, const uint8_t* data, uint8_t size)
+        {
+            if (pipe >= PipesCount || size == 0 || size > MaxPayloadSize || (_ackPending & (1 << pipe)) != 0)
+                return false;
+
+            if (!_interruptMode)
+            {
+                WriteAck(pipe, data, size);
+                return true;
+            }
+
+            memcpy(_ackPayloads[pipe].Data, data, size);
+            _ackPayloads[pipe].Size = size;
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _ackPending |= 1 << pipe;
+            __set_PRIMASK(primask);
+            Process();
+
+            return true;
+        }
+
+        /**
+         * @brief Sets handler of pipe packets (interrupt mode)
+         * 
+         * @details
+         * Handler is called in interrupt context, packets of pipe without handler are queued.
+         * 
+         * @param [in] pipe Pipe number (0-5)
+         * @param [in] handler Handler (nullptr to queue packets)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void SetPipeHandler(uint8_t pipe, PacketHandler handler)
+        {
+            if (pipe < PipesCount)
+                _handlers[pipe] = handler;
+        }
+
+        /**
+         * @brief Sets radio events timestamping (interrupt mode)
+         * 
+         * @details
+         * Time is read at the beginning of @ref IrqHandler (before status is read by SPI),
+         * so it has constant latency from packet end. It's passed to handler after status read,
+         * before received packet is read. Transmit event is acknowledgment receiving (or ACK payload
+         * sending in RX mode), it's constant delay after successful attempt.
+         * 
+         * @param [in] source Time source (nullptr disables timestamping)
+         * @param [in] handler Event handler
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void SetEventTimestamp(TimeSource source, EventHandler handler)
+        {
+            _eventHandler = handler;
+            _timeSource = source;
+        }
+
+        /**
+         * @brief Enables interrupt (IRQ-driven) mode
+         * 
+         * @details
+         * Call it after @ref Init. Module is switched to RX mode, queues are cleared.
+         * After this polling methods must not be used.
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void EnableInterruptMode()
+        {
+            static_assert(!std::is_same_v<_IrqLine, void>, "Interrupt mode requires EXTI line of IRQ pin");
+
+            _IrqLine::DisableInterrupt();
+            _IrqLine::template InitPin<EXTIPin>(EXTIPin::PullMode::PullUp);
+            _IrqLine::template Init<_IrqLine::Falling, typename EXTIPin::Port>();
+
+            CEPin::Clear();
+            FlushTx();
+            _rxQueue.clear();
+            _txQueue.clear();
+            _txLoaded = 0;
+            _transmitting = false;
+            _busy = false;
+            _pending = false;
+            _ackPending = 0;
+            _interruptMode = true;
+            PowerUpRx();
+
+            _IrqLine::ClearInterruptFlag();
+            _IrqLine::EnableInterrupt();
+        }
+
+        /**
+         * @brief Adds packet to TX queue (interrupt mode)
+         * 
+         * @param [in] data Data to transmit
+         * @param [in] size Data size (ignored without dynamic payload length, 0 for payloadSize)
+         * 
+         * @retval true Packet is queued
+         * @retval false TX queue is full
+         */
+        static bool TransmitAsync(const uint8_t* data, uint8_t size = 0)
+        {
+            auto span = _txQueue.writable_span();
+            if (span.empty())
+                return false;
+
+            span[0].Size = TransmitSize(size);
+            memcpy(span[0].Data, data, span[0].Size);
+            _txQueue.commit(1);
+            Process();
+
+            return true;
+        }
+
+        /**
+         * @brief Gets packet from RX queue (interrupt mode)
+         * 
+         * @param [out] data Buffer (32 bytes with dynamic payload length, payloadSize otherwise)
+         * @param [out] pipe Pipe number (optional)
+         * 
+         * @returns Payload size (0 if RX queue is empty)
+         */
+        static uint8_t Receive(uint8_t* data, uint8_t* pipe = nullptr)
+        {
+            if (_rxQueue.empty())
+                return 0;
+
+            const Packet& packet = _rxQueue.front();
+            uint8_t size = packet.Size;
+            memcpy(data, packet.Data, size);
+            if (pipe != nullptr)
+                *pipe = packet.Pipe;
+            _rxQueue.pop_front();
+
+            return size;
+        }
+
+        /**
+         * @brief Returns received packets count (interrupt mode)
+         * 
+         * @returns Packets count in RX queue
+         */
+        static unsigned Available()
+        {
+            return _rxQueue.size();
+        }
+
+        /**
+         * @brief Returns not acknowledged packets count (interrupt mode)
+         * 
+         * @returns Packets count in TX queue (including packets in TX FIFO)
+         */
+        static unsigned TransmitPending()
+        {
+            return _txQueue.size();
+        }
+
+        /**
+         * @brief Returns lost packets count (no acknowledgment after all retransmissions)
+         * 
+         * @returns Lost packets count
+         */
+        static unsigned GetLostPacketsCount()
+        {
+            return _lostPackets;
+        }
+
+        /**
+         * @brief Returns received packets count that were dropped (RX queue was full)
+         * 
+         * @returns Dropped packets count
+         */
+        static unsigned GetDroppedPacketsCount()
+        {
+            return _droppedPackets;
+        }
+
+        /**
+         * @brief IRQ pin interrupt handler. Call it from EXTI interrupt handler.
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void IrqHandler()
+        {
+            if (_timeSource != nullptr)
+            {
+                _eventTime = _timeSource();
+                _eventTimeValid = true;
+            }
+            _IrqLine::ClearInterruptFlag();
+            Process();
+        }
     private:
+        /**
+         * @brief Starts state machine (if it's not running)
+         * 
+         * @details
+         * If state machine is running (SPI transfer is in progress), it will check module after transfer.
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Process()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if (_busy)
+            {
+                _pending = true;
+                __set_PRIMASK(primask);
+                return;
+            }
+            _busy = true;
+            __set_PRIMASK(primask);
+
+            Continue();
+        }
+
+        /**
+         * @brief Performs state machine steps until DMA transfer is started or there is nothing to do
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Continue()
+        {
+            for (;;)
+            {
+                uint8_t status = GetStatus();
+                uint8_t flags = status & (RxDr | TxDataSend | MaxRt);
+                if (flags != 0)
+                    WriteRegister(Registers::Status, flags);
+
+                if (flags != 0 && _eventHandler != nullptr && _timeSource != nullptr)
+                    HandleEvents(flags);
+
+                // In RX mode TX_DS means that ACK payload is sent
+                if ((flags & TxDataSend) && _transmitting)
+                {
+                    // Few acknowledgments can be handled by one interrupt, but count is known only for empty FIFO
+                    uint8_t acknowledged = (ReadRegister(Registers::FifoStatus) & TxEmptyMask) != 0 ? _txLoaded : 1;
+                    if (acknowledged > _txLoaded)
+                        acknowledged = _txLoaded;
+                    _txQueue.consume(acknowledged);
+                    _txLoaded -= acknowledged;
+                }
+
+                if ((flags & MaxRt) && _transmitting)
+                {
+                    // Module is stopped with lost packet on top of TX FIFO. Packets count in FIFO
+                    // is found by filling it with dummy payloads, following packets are loaded again from queue.
+                    CEPin::Clear();
+                    uint8_t inFifo = TxFifoDepth;
+                    while (inFifo > 0 && (ReadRegister(Registers::FifoStatus) & FifoFullMask) == 0)
+                    {
+                        SSPin::Clear();
+                        SpiBus::Send(WriteTxPayload);
+                        SpiBus::Send(0x00);
+                        SSPin::Set();
+                        --inFifo;
+                    }
+                    FlushTx();
+
+                    if (_txLoaded > inFifo)
+                        _txQueue.consume(_txLoaded - inFifo);
+                    if (!_txQueue.empty())
+                        _txQueue.pop_front();
+                    _txLoaded = 0;
+                    ++_lostPackets;
+                }
+
+                if ((status & RxPipeNumberMask) != RxPipeNumberMask)
+                {
+                    if (StartRead(status))
+                        return;
+                    continue;
+                }
+
+                if (!_transmitting && !_txQueue.empty())
+                {
+                    CEPin::Clear();
+                    // Not sent ACK payloads would be transmitted as packets
+                    FlushTx();
+                    WriteRegister(Registers::Configuration, EnableCRC | CRCScheme1Byte | PTX | PowerUp);
+                    _transmitting = true;
+                }
+
+                if (!_transmitting && _ackPending != 0 && (ReadRegister(Registers::FifoStatus) & FifoFullMask) == 0)
+                {
+                    StartAckWrite();
+                    return;
+                }
+
+                if (_transmitting && _txLoaded < TxFifoDepth && _txLoaded < _txQueue.size())
+                {
+                    StartWrite();
+                    return;
+                }
+
+                if (_transmitting && _txQueue.empty())
+                {
+                    CEPin::Clear();
+                    WriteRegister(Registers::Configuration, EnableCRC | CRCScheme1Byte | PRX | PowerUp);
+                    CEPin::Set();
+                    _transmitting = false;
+                }
+
+                if (flags != 0)
+                    continue;
+
+                uint32_t primask = __get_PRIMASK();
+                __disable_irq();
+                if (!_pending)
+                {
+                    _busy = false;
+                    __set_PRIMASK(primask);
+                    return;
+                }
+                _pending = false;
+                __set_PRIMASK(primask);
+            }
+        }
+
+        /**
+         * @brief Passes radio events to event handler
+         * 
+         * @param [in] flags Status flags
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void HandleEvents(uint8_t flags)
+        {
+            // Events that are found by next state machine loop (not by IRQ) are timestamped now
+            uint64_t time = _eventTimeValid ? _eventTime : _timeSource();
+            _eventTimeValid = false;
+
+            if (flags & RxDr)
+                _eventHandler(false, time);
+            if (flags & TxDataSend)
+                _eventHandler(true, time);
+        }
+
+        /**
+         * @brief Starts payload read (from top of RX FIFO)
+         * 
+         * @param [in] status Status register value
+         * 
+         * @retval true Read is started
+         * @retval false Packet has invalid length and RX FIFO is flushed
+         */
+        static bool StartRead(uint8_t status)
+        {
+            uint8_t size = ReceiveSize();
+            if (size > MaxPayloadSize)
+            {
+                FlushRx();
+                ++_droppedPackets;
+                return false;
+            }
+
+            uint8_t pipe = (status & RxPipeNumberMask) >> RxPipeNumberPos;
+            auto span = _rxQueue.writable_span();
+            if (pipe < PipesCount && _handlers[pipe] != nullptr)
+                _rxTarget = RxTarget::Handler;
+            else
+                _rxTarget = span.empty() ? RxTarget::Drop : RxTarget::Queue;
+
+            Packet& packet = _rxTarget == RxTarget::Queue ? span[0] : _scratch;
+            packet.Pipe = pipe;
+            packet.Size = size;
+
+            SSPin::Clear();
+            SpiBus::Send(ReadRxPayload);
+            SpiBus::ReadAsync(packet.Data, size, ReadComplete);
+            return true;
+        }
+
+        /**
+         * @brief Payload read complete handler
+         * 
+         * @param [in] data Buffer
+         * @param [in] size Transferred size
+         * @param [in] success Transfer result
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void ReadComplete(void* data, unsigned size, bool success)
+        {
+            SSPin::Set();
+
+            if (!success || _rxTarget == RxTarget::Drop)
+                ++_droppedPackets;
+            else if (_rxTarget == RxTarget::Handler)
+                _handlers[_scratch.Pipe](_scratch.Data, _scratch.Size);
+            else
+                _rxQueue.commit(1);
+
+            Continue();
+        }
+
+        /**
+         * @brief Starts next queued payload write to TX FIFO
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void StartWrite()
+        {
+            SSPin::Clear();
+            SpiBus::Send(WriteTxPayload);
+            const Packet& packet = _txQueue[_txLoaded];
+            SpiBus::WriteAsync(packet.Data, packet.Size, WriteComplete);
+        }
+
+        /**
+         * @brief Payload write complete handler
+         * 
+         * @param [in] data Buffer
+         * @param [in] size Transferred size
+         * @param [in] success Transfer result
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void WriteComplete(void* data, unsigned size, bool success)
+        {
+            SpiBus::EndWrite();
+            SSPin::Set();
+
+            if (success)
+            {
+                ++_txLoaded;
+            }
+            else
+            {
+                FlushTx();
+                _txLoaded = 0;
+            }
+
+            // CE is kept high in TX mode, so module sends packets while TX FIFO is not empty
+            CEPin::Set();
+            Continue();
+        }
+
+        /**
+         * @brief Starts pending ACK payload write
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void StartAckWrite()
+        {
+            _ackPipe = 0;
+            while ((_ackPending & (1 << _ackPipe)) == 0)
+                ++_ackPipe;
+
+            SSPin::Clear();
+            SpiBus::Send(WriteAckPayload | _ackPipe);
+            SpiBus::WriteAsync(_ackPayloads[_ackPipe].Data, _ackPayloads[_ackPipe].Size, AckWriteComplete);
+        }
+
+        /**
+         * @brief ACK payload write complete handler
+         * 
+         * @param [in] data Buffer
+         * @param [in] size Transferred size
+         * @param [in] success Transfer result
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void AckWriteComplete(void* data, unsigned size, bool success)
+        {
+            SpiBus::EndWrite();
+            SSPin::Set();
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _ackPending &= ~(1 << _ackPipe);
+            __set_PRIMASK(primask);
+
+            Continue();
+        }
+
+        /**
+         * @brief Writes ACK payload (blocking)
+         * 
+         * @param [in] pipe Pipe number
+         * @param [in] data Payload
+         * @param [in] size Payload size
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void WriteAck(uint8_t pipe, const uint8_t* data, uint8_t size)
+        {
+            SSPin::Clear();
+            SpiBus::Send(WriteAckPayload | pipe);
+            SpiBus::Transfer(data, nullptr, size);
+            SSPin::Set();
+        }
+
+        /**
+         * @brief Returns size of packet to transmit
+         * 
+         * @param [in] size Requested size
+         * 
+         * @returns Payload size
+         */
+        static uint8_t TransmitSize(uint8_t size)
+        {
+            if (!_dynamicPayload || size == 0)
+                return _payloadSize;
+            return size > MaxPayloadSize ? MaxPayloadSize : size;
+        }
+
+        /**
+         * @brief Returns size of packet on top of RX FIFO
+         * 
+         * @returns Payload size (greater than 32 for corrupted packet)
+         */
+        static uint8_t ReceiveSize()
+        {
+            if (!_dynamicPayload)
+                return _payloadSize;
+
+            SSPin::Clear();
+            SpiBus::Send(ReadRxPayloadWidth);
+            uint8_t size = SpiBus::Send(Nop);
+            SSPin::Set();
+            return size;
+        }
+
         static void InitPins()
         {
             SSPin::Port::Enable();
@@ -649,14 +1398,14 @@ namespace Zhele::Drivers
         static void FlushTx()
         {
             SSPin::Clear();
-            SpiBus::Send(0xe1);
+            SpiBus::Send(FlushTxCommand);
             SSPin::Set();
         }
 
         static void FlushRx()
         {
             SSPin::Clear();
-            SpiBus::Send(0xe2);
+            SpiBus::Send(FlushRxCommand);
             SSPin::Set();
         }
         static uint8_t ReadRegister(Registers registerAddress)
@@ -706,7 +1455,7 @@ namespace Zhele::Drivers
          * @par Returns
          *	Nothing
          */
-        static void WriteRegister(Registers registerAddress, uint8_t* data, uint8_t size)
+        static void WriteRegister(Registers registerAddress, const uint8_t* data, uint8_t size)
         {
             SSPin::Clear();
             SpiBus::Send((static_cast <uint8_t>(registerAddress) & 0x1F) | 0x20);
@@ -753,9 +1502,30 @@ namespace Zhele::Drivers
         }
 
         static uint8_t _payloadSize;
+
+        static inline Containers::RingBuffer<_QueueSize, Packet> _rxQueue; ///< Received packets
+        static inline Containers::RingBuffer<_QueueSize, Packet> _txQueue; ///< Packets to transmit (until acknowledgment)
+        static inline Packet _scratch; ///< Buffer for dropped packet
+        static inline uint8_t _txLoaded = 0; ///< Queued packets count that are loaded to TX FIFO
+        static inline bool _transmitting = false; ///< Module is in TX mode
+        static inline RxTarget _rxTarget = RxTarget::Queue; ///< Destination of packet that is read
+        static inline PacketHandler _handlers[PipesCount] = {}; ///< Pipes handlers
+        static inline Packet _ackPayloads[PipesCount]; ///< ACK payloads
+        static inline volatile uint8_t _ackPending = 0; ///< Pipes with ACK payloads to load
+        static inline uint8_t _ackPipe = 0; ///< Pipe of ACK payload that is loaded
+        static inline bool _dynamicPayload = false; ///< Dynamic payload length is enabled
+        static inline bool _interruptMode = false; ///< Interrupt mode is enabled
+        static inline volatile bool _busy = false; ///< State machine is running
+        static inline volatile bool _pending = false; ///< IRQ or new packet while state machine is running
+        static inline volatile unsigned _lostPackets = 0; ///< Lost packets count
+        static inline volatile unsigned _droppedPackets = 0; ///< Dropped packets count
+        static inline TimeSource _timeSource = nullptr; ///< Events time source
+        static inline EventHandler _eventHandler = nullptr; ///< Events handler
+        static inline volatile uint64_t _eventTime = 0; ///< Time of last IRQ
+        static inline volatile bool _eventTimeValid = false; ///< IRQ time is not passed to handler yet
     };
 
-    template<typename SpiBus, typename SSPin, typename CEPin, typename EXTIPin>
-    uint8_t Nrf24l<SpiBus, SSPin, CEPin, EXTIPin>::_payloadSize;
+    template<typename SpiBus, typename SSPin, typename CEPin, typename EXTIPin, typename _IrqLine, unsigned _QueueSize>
+    uint8_t Nrf24l<SpiBus, SSPin, CEPin, EXTIPin, _IrqLine, _QueueSize>::_payloadSize;
 }
 #endif //! ZHELE_DRIVERS_NRF24L_H
\ No newline at end of file
@@ -0,0 +1,225 @@
+/**
+ * @file
+ * Implements DMA-driven parallel bus (i8080-like write-only interface)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_PARALLEL_BUS_H
+#define ZHELE_DRIVERS_PARALLEL_BUS_H
+
+#include <zhele/dma.h>
+#include <zhele/pinlist.h>
+#include <zhele/timer.h>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Class for parallel bus with write strobe
+     *
+     * @details
+     * Every data word is sent as two BSRR writes: data with strobe asserted (low),
+     * then strobe deasserted (high), so receiver latches data on strobe rising edge.
+     * BSRR words are precomputed from data and streamed to GPIO BSRR by DMA
+     * on timer update event through double (circular) buffer with _WordsPerBlock words per block.
+     * Blocks are encoded in DMA interrupt while other block is being sent, so long data (images)
+     * is streamed continuously and RAM usage does not depend on data size.
+     *
+     * @note DMA must have access to GPIO (on stm32f4 only DMA2 does, so use TIM1/TIM8 requests).
+     *
+     * @par Example
+     * @code
+     *  using Data = IO::PinList<IO::Pa0, IO::Pa1, IO::Pa2, IO::Pa3, IO::Pa4, IO::Pa5, IO::Pa6, IO::Pa7>;
+     *  using Bus = Drivers::ParallelBus<Data, IO::Pa8, Timers::Timer2, Dma1Channel2>;
+     *  Bus::Init(4000000);
+     *  Bus::Write(image, sizeof(image));
+     * @endcode
+     *
+     * @tparam _DataPins Data pins (pinlist, all pins must be on strobe port)
+     * @tparam _Strobe Write strobe pin
+     * @tparam _Timer Timer that paces transfer
+     * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+     * @tparam _WordsPerBlock Data words count in one DMA buffer block
+     */
+    template <typename _DataPins, typename _Strobe, typename _Timer, typename _DmaChannel, unsigned _WordsPerBlock = 32>
+    class ParallelBus
+    {
+        using Port = typename _Strobe::Port;
+
+        static const uint32_t StrobeMask = 1u << _Strobe::Number;
+        static const uint32_t DataMask = _DataPins::template PortMask<Port>();
+        static const unsigned BlockSize = _WordsPerBlock * 2;
+
+        static_assert(std::popcount(DataMask) == _DataPins::Length, "All data pins must be on strobe port");
+        static_assert((DataMask & StrobeMask) == 0, "Strobe pin cannot be data pin");
+    public:
+        using DataType = typename _DataPins::DataType;
+
+        /**
+         * @brief Init timer, DMA and pins
+         *
+         * @param [in] strobeFrequence Data words rate (timer update rate is twice as much)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint32_t strobeFrequence)
+        {
+            _DataPins::Enable();
+            _DataPins::template SetConfiguration<_DataPins::Out>();
+            _DataPins::template SetDriverType<_DataPins::PushPull>();
+            _DataPins::template SetSpeed<_DataPins::Fast>();
+
+            _Strobe::Port::Enable();
+            _Strobe::Set();
+            _Strobe::template SetConfiguration<_Strobe::Configuration::Out>();
+            _Strobe::template SetDriverType<_Strobe::DriverType::PushPull>();
+            _Strobe::template SetSpeed<_Strobe::Speed::Fast>();
+
+            _Timer::Enable();
+            _Timer::Stop();
+            _Timer::SetPrescaler(0);
+            _Timer::SetPeriod(_Timer::GetClockFreq() / (strobeFrequence * 2) - 1);
+        }
+
+        /**
+         * @brief Start sending data (non-blocking)
+         *
+         * @param [in] data Data (must be valid until transfer complete)
+         * @param [in] count Data words count
+         * @param [in] callback Complete callback
+         *
+         * @retval true Transfer started
+         * @retval false Previous transfer is in progress or no data
+         */
+        static bool Write(const DataType* data, size_t count, std::add_pointer_t<void()> callback = nullptr)
+        {
+            if (_busy || count == 0)
+                return false;
+
+            _busy = true;
+            _data = data;
+            _count = count;
+            _next = 0;
+            _completedBlocks = 0;
+            _dataBlocks = (count + _WordsPerBlock - 1) / _WordsPerBlock;
+            _callback = callback;
+
+            FillBlock(_buffer);
+            FillBlock(_buffer + BlockSize);
+
+            _DmaChannel::SetDoubleBufferedTransferCallback(BlockHandler);
+            _DmaChannel::TransferDoubleBuffered(_DmaChannel::Mem2Periph | _DmaChannel::MemIncrement | _DmaChannel::PriorityHigh
+                                            | _DmaChannel::PSize32Bits | _DmaChannel::MSize32Bits,
+                                            _buffer, _buffer + BlockSize, Port::BitSetResetRegister(), BlockSize);
+
+            _Timer::ResetCounterValue();
+            _Timer::DmaRequestEnable();
+            _Timer::Start();
+            return true;
+        }
+
+        /**
+         * @brief Check that bus is ready for new transfer
+         *
+         * @retval true Ready
+         * @retval false Transfer in progress
+         */
+        static bool Ready()
+        {
+            return !_busy;
+        }
+
+        /**
+         * @brief Returns BSRR word that outputs data word with asserted strobe
+         *
+         * @param [in] value Data word
+         *
+         * @returns BSRR value
+         */
+        static constexpr uint32_t DataWord(DataType value)
+        {
+            uint32_t portValue = _DataPins::template PortValue<Port>(value);
+            return portValue | ((DataMask & ~portValue) << 16) | (StrobeMask << 16);
+        }
+
+    private:
+        static void FillBlock(uint32_t* block)
+        {
+            unsigned slot = 0;
+            for (; slot < BlockSize && _next < _count; ++_next)
+            {
+                block[slot++] = DataWord(_data[_next]);
+                block[slot++] = StrobeMask;
+            }
+
+            // Tail of the last data block and next block keep strobe deasserted
+            while (slot < BlockSize)
+            {
+                block[slot++] = StrobeMask;
+            }
+        }
+
+        static void BlockHandler(void* data, unsigned, unsigned)
+        {
+            if (++_completedBlocks >= _dataBlocks)
+            {
+                _Timer::Stop();
+                _Timer::DmaRequestDisable();
+                _DmaChannel::Disable();
+                _busy = false;
+
+                if (_callback)
+                    _callback();
+                return;
+            }
+
+            FillBlock(static_cast<uint32_t*>(data));
+        }
+
+        static uint32_t _buffer[2 * BlockSize];
+        static const DataType* _data;
+        static size_t _count;
+        static size_t _next;
+        static size_t _completedBlocks;
+        static size_t _dataBlocks;
+        static std::add_pointer_t<void()> _callback;
+        static volatile bool _busy;
+    };
+
+    #define PARALLEL_BUS_TEMPLATE_ARGS template <typename _DataPins, typename _Strobe, typename _Timer, typename _DmaChannel, unsigned _WordsPerBlock>
+    #define PARALLEL_BUS_TEMPLATE_QUALIFIER ParallelBus<_DataPins, _Strobe, _Timer, _DmaChannel, _WordsPerBlock>
+
+    PARALLEL_BUS_TEMPLATE_ARGS
+    uint32_t PARALLEL_BUS_TEMPLATE_QUALIFIER::_buffer[2 * BlockSize];
+
+    PARALLEL_BUS_TEMPLATE_ARGS
+    const typename PARALLEL_BUS_TEMPLATE_QUALIFIER::DataType* PARALLEL_BUS_TEMPLATE_QUALIFIER::_data;
+
+    PARALLEL_BUS_TEMPLATE_ARGS
+    size_t PARALLEL_BUS_TEMPLATE_QUALIFIER::_count;
+
+    PARALLEL_BUS_TEMPLATE_ARGS
+    size_t PARALLEL_BUS_TEMPLATE_QUALIFIER::_next;
+
+    PARALLEL_BUS_TEMPLATE_ARGS
+    size_t PARALLEL_BUS_TEMPLATE_QUALIFIER::_completedBlocks;
+
+    PARALLEL_BUS_TEMPLATE_ARGS
+    size_t PARALLEL_BUS_TEMPLATE_QUALIFIER::_dataBlocks;
+
+    PARALLEL_BUS_TEMPLATE_ARGS
+    std::add_pointer_t<void()> PARALLEL_BUS_TEMPLATE_QUALIFIER::_callback;
+
+    PARALLEL_BUS_TEMPLATE_ARGS
+    volatile bool PARALLEL_BUS_TEMPLATE_QUALIFIER::_busy = false;
+}
+
+#endif //! ZHELE_DRIVERS_PARALLEL_BUS_H
@@ -0,0 +1,313 @@
+/**
+ * @file
+ * Implements GPIO port sampler (logic analyzer)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_PORT_SAMPLER_H
+#define ZHELE_DRIVERS_PORT_SAMPLER_H
+
+#include <zhele/dma.h>
+#include <zhele/timer.h>
+
+#include <cstdint>
+#include <type_traits>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Class for GPIO port sampler
+     *
+     * @details
+     * Port input (IDR) is sampled to RAM by DMA on timer update event, buffer is circular
+     * (double buffered), so sampling rate is limited by DMA/bus only.
+     * Sampler supports two modes:
+     *  - Capture: pre-trigger samples are collected continuously until trigger (pattern that is searched
+     *    in completed half of buffer or external trigger by @ref Trigger method, for example
+     *    from EXTI handler for edge trigger), then postTrigger samples are collected and sampling stops.
+     *    Capture stops on buffer half boundary, so pre-trigger depth is at least _Samples / 2 - postTrigger.
+     *  - Stream: every completed half of the buffer is passed to callback (for example, to send it via USB CDC).
+     *
+     * @par Example
+     * @code
+     *  using Sampler = Drivers::PortSampler<IO::Portb, Timers::Timer2, Dma1Channel2>;
+     *  Sampler::Init(4000000);
+     *  // Trigger on PB0 low (mask 0x0001, value 0x0000)
+     *  Sampler::Capture(0x0001, 0x0000);
+     *  while (!Sampler::Ready()) ;
+     *  Dump(Sampler::Buffer(), Sampler::FirstIndex(), Sampler::TriggerIndex());
+     *  // or stream over USB CDC data endpoint
+     *  Sampler::Stream([](const uint16_t* samples, unsigned count) { CdcDataEp::SendData(samples, count * 2); });
+     * @endcode
+     *
+     * @tparam _Port GPIO port
+     * @tparam _Timer Timer that paces sampling
+     * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+     * @tparam _Samples Buffer size (samples), must be even
+     */
+    template <typename _Port, typename _Timer, typename _DmaChannel, unsigned _Samples = 1024>
+    class PortSampler
+    {
+        static_assert(_Samples % 2 == 0, "Samples count must be even");
+        static const unsigned HalfSize = _Samples / 2;
+    public:
+        using DataType = typename _Port::DataType;
+
+        /// Stream callback (half of the buffer is completed)
+        using SamplesCallback = std::add_pointer_t<void(const DataType* samples, unsigned count)>;
+
+        /**
+         * @brief Init timer and port
+         *
+         * @param [in] sampleRate Samples per second
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint32_t sampleRate)
+        {
+            _Port::Enable();
+
+            _Timer::Enable();
+            _Timer::Stop();
+            _Timer::SetPrescaler(0);
+            _Timer::SetPeriod(_Timer::GetClockFreq() / sampleRate - 1);
+        }
+
+        /**
+         * @brief Start triggered capture
+         *
+         * @details
+         * Trigger is pattern ((sample & mask) == pattern), search is performed in DMA interrupt.
+         * Zero mask means that any sample matches (immediate trigger).
+         *
+         * @param [in] mask Trigger pattern mask
+         * @param [in] pattern Trigger pattern
+         * @param [in] postTrigger Samples count after trigger (not greater than _Samples / 2)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Capture(DataType mask, DataType pattern, unsigned postTrigger = HalfSize / 2)
+        {
+            _mask = mask;
+            _pattern = pattern;
+            _patternTrigger = true;
+            StartCapture(postTrigger);
+        }
+
+        /**
+         * @brief Start capture that waits for external trigger (@ref Trigger)
+         *
+         * @param [in] postTrigger Samples count after trigger (not greater than _Samples / 2)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Capture(unsigned postTrigger = HalfSize / 2)
+        {
+            _patternTrigger = false;
+            StartCapture(postTrigger);
+        }
+
+        /**
+         * @brief External trigger (call it from EXTI or other handler)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Trigger()
+        {
+            if (_state != State::Armed)
+                return;
+
+            unsigned remaining = _DmaChannel::RemainingTransfers();
+            if (remaining > HalfSize)
+                remaining -= HalfSize;
+
+            unsigned position = (_DmaChannel::CurrentBuffer() * HalfSize + HalfSize - remaining) % _Samples;
+            unsigned offset = (position + _Samples - _completedSamples % _Samples) % _Samples;
+            SetTrigger(_completedSamples + offset);
+        }
+
+        /**
+         * @brief Start continuous sampling
+         *
+         * @param [in] callback Callback for every completed half of the buffer (called from DMA interrupt)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stream(SamplesCallback callback)
+        {
+            _streamCallback = callback;
+            Start(State::Streaming);
+        }
+
+        /**
+         * @brief Stop sampling
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop()
+        {
+            _Timer::Stop();
+            _Timer::DmaRequestDisable();
+            _DmaChannel::Disable();
+            _state = _state == State::Triggered ? State::Completed : State::Idle;
+        }
+
+        /**
+         * @brief Check that capture is completed
+         *
+         * @retval true Capture is completed
+         * @retval false Capture is in progress (or was not started)
+         */
+        static bool Ready()
+        {
+            return _state == State::Completed;
+        }
+
+        /**
+         * @brief Returns samples buffer
+         *
+         * @returns Buffer (circular, see @ref FirstIndex)
+         */
+        static const DataType* Buffer()
+        {
+            return _buffer;
+        }
+
+        /**
+         * @brief Returns index of the oldest sample in buffer (for completed capture)
+         *
+         * @returns Index
+         */
+        static unsigned FirstIndex()
+        {
+            return _completedSamples % _Samples;
+        }
+
+        /**
+         * @brief Returns index of trigger sample in buffer (for completed capture)
+         *
+         * @returns Index
+         */
+        static unsigned TriggerIndex()
+        {
+            return _triggerSample % _Samples;
+        }
+
+    private:
+        enum class State : uint8_t
+        {
+            Idle,
+            Armed,
+            Triggered,
+            Completed,
+            Streaming
+        };
+
+        static void StartCapture(unsigned postTrigger)
+        {
+            _postTrigger = postTrigger < HalfSize ? postTrigger : HalfSize;
+            Start(State::Armed);
+        }
+
+        static void Start(State state)
+        {
+            Stop();
+            _completedSamples = 0;
+            _state = state;
+
+            _DmaChannel::SetDoubleBufferedTransferCallback(HalfHandler);
+            _DmaChannel::TransferDoubleBuffered(_DmaChannel::Periph2Mem | _DmaChannel::MemIncrement | _DmaChannel::PriorityHigh
+                                            | _DmaChannel::PSize16Bits | _DmaChannel::MSize16Bits,
+                                            _buffer, _buffer + HalfSize, _Port::InputDataRegister(), HalfSize);
+
+            _Timer::ResetCounterValue();
+            _Timer::DmaRequestEnable();
+            _Timer::Start();
+        }
+
+        static void SetTrigger(uint32_t sample)
+        {
+            _triggerSample = sample;
+            _state = State::Triggered;
+        }
+
+        static void HalfHandler(void* data, unsigned, unsigned)
+        {
+            const DataType* samples = static_cast<const DataType*>(data);
+            _completedSamples += HalfSize;
+
+            if (_state == State::Streaming)
+            {
+                if (_streamCallback)
+                    _streamCallback(samples, HalfSize);
+                return;
+            }
+
+            if (_state == State::Armed && _patternTrigger)
+            {
+                for (unsigned i = 0; i < HalfSize; ++i)
+                {
+                    if ((samples[i] & _mask) == _pattern)
+                    {
+                        SetTrigger(_completedSamples - HalfSize + i);
+                        break;
+                    }
+                }
+            }
+
+            if (_state == State::Triggered && _completedSamples >= _triggerSample + _postTrigger + 1)
+                Stop();
+        }
+
+        static DataType _buffer[_Samples];
+        static DataType _mask;
+        static DataType _pattern;
+        static bool _patternTrigger;
+        static unsigned _postTrigger;
+        static uint32_t _triggerSample;
+        static volatile uint32_t _completedSamples;
+        static SamplesCallback _streamCallback;
+        static volatile State _state;
+    };
+
+    #define PORT_SAMPLER_TEMPLATE_ARGS template <typename _Port, typename _Timer, typename _DmaChannel, unsigned _Samples>
+    #define PORT_SAMPLER_TEMPLATE_QUALIFIER PortSampler<_Port, _Timer, _DmaChannel, _Samples>
+
+    PORT_SAMPLER_TEMPLATE_ARGS
+    typename PORT_SAMPLER_TEMPLATE_QUALIFIER::DataType PORT_SAMPLER_TEMPLATE_QUALIFIER::_buffer[_Samples];
+
+    PORT_SAMPLER_TEMPLATE_ARGS
+    typename PORT_SAMPLER_TEMPLATE_QUALIFIER::DataType PORT_SAMPLER_TEMPLATE_QUALIFIER::_mask;
+
+    PORT_SAMPLER_TEMPLATE_ARGS
+    typename PORT_SAMPLER_TEMPLATE_QUALIFIER::DataType PORT_SAMPLER_TEMPLATE_QUALIFIER::_pattern;
+
+    PORT_SAMPLER_TEMPLATE_ARGS
+    bool PORT_SAMPLER_TEMPLATE_QUALIFIER::_patternTrigger;
+
+    PORT_SAMPLER_TEMPLATE_ARGS
+    unsigned PORT_SAMPLER_TEMPLATE_QUALIFIER::_postTrigger;
+
+    PORT_SAMPLER_TEMPLATE_ARGS
+    uint32_t PORT_SAMPLER_TEMPLATE_QUALIFIER::_triggerSample;
+
+    PORT_SAMPLER_TEMPLATE_ARGS
+    volatile uint32_t PORT_SAMPLER_TEMPLATE_QUALIFIER::_completedSamples;
+
+    PORT_SAMPLER_TEMPLATE_ARGS
+    typename PORT_SAMPLER_TEMPLATE_QUALIFIER::SamplesCallback PORT_SAMPLER_TEMPLATE_QUALIFIER::_streamCallback;
+
+    PORT_SAMPLER_TEMPLATE_ARGS
+    volatile typename PORT_SAMPLER_TEMPLATE_QUALIFIER::State PORT_SAMPLER_TEMPLATE_QUALIFIER::_state = PORT_SAMPLER_TEMPLATE_QUALIFIER::State::Idle;
+}
+
+#endif //! ZHELE_DRIVERS_PORT_SAMPLER_H
@@ -0,0 +1,229 @@
+/**
+ * @file
+ * Driver for QSPI NOR flash
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_QSPI_FLASH_H
+#define ZHELE_DRIVERS_QSPI_FLASH_H
+
+#include <zhele/quadspi.h>
+
+#include <bit>
+#include <stdint.h>
+
+namespace Zhele::Drivers
+{
+    /// Quad mode enable bit of NOR flash
+    enum class QspiQuadEnable : uint8_t
+    {
+        None, ///< Quad mode is always enabled
+        StatusRegister2Bit1, ///< QE is bit 1 of status register 2 (Winbond, GigaDevice), quad page program is 1-1-4 (0x32)
+        StatusRegister1Bit6, ///< QE is bit 6 of status register 1 (Macronix, ISSI), quad page program is 1-4-4 (0x38)
+    };
+
+    /**
+     * @brief Implements QSPI NOR flash (up to 16 MB, 24-bit address)
+     *
+     * @details
+     * Flash is read in memory-mapped mode (quad I/O fast read 0xEB), so data can be read by pointer.
+     * Erase and program commands leave memory-mapped mode, it's restored after operation.
+     * Interface is compatible with @ref Flash (4K sectors are pages), so flash can be used
+     * as FlashKvStore storage.
+     *
+     * @par Example
+     * @code
+     *  using Assets = Drivers::QspiFlash<QuadSpi, 8 * 1024 * 1024>;
+     *  Assets::Init<40000000, 80000000>();
+     *  auto font = reinterpret_cast<const uint8_t*>(Assets::PageAddress(0));
+     *  using Settings = FlashKvStore<0, 4, 32, Assets>;
+     * @endcode
+     *
+     * @tparam _QuadSpi QUADSPI
+     * @tparam _Size Flash size (power of 2)
+     * @tparam _QuadEnable Quad mode enable bit
+     */
+    template<typename _QuadSpi, uint32_t _Size, QspiQuadEnable _QuadEnable = QspiQuadEnable::StatusRegister2Bit1>
+    class QspiFlash
+    {
+        static_assert(std::has_single_bit(_Size), "Flash size must be power of 2");
+        static_assert(_Size <= 16 * 1024 * 1024, "Only 24-bit address is supported");
+
+        static constexpr uint32_t SectorSize = 4096;
+        static constexpr uint32_t ProgramPageSize = 256;
+
+        static constexpr QuadSpiCommand ResetEnable {.Instruction = 0x66};
+        static constexpr QuadSpiCommand Reset {.Instruction = 0x99};
+        static constexpr QuadSpiCommand ReadId {.Instruction = 0x9f, .DataLines = QuadSpiLines::Single};
+        static constexpr QuadSpiCommand WriteEnable {.Instruction = 0x06};
+        static constexpr QuadSpiCommand ReadStatus1 {.Instruction = 0x05, .DataLines = QuadSpiLines::Single};
+        static constexpr QuadSpiCommand ReadStatus2 {.Instruction = 0x35, .DataLines = QuadSpiLines::Single};
+        static constexpr QuadSpiCommand WriteStatus1 {.Instruction = 0x01, .DataLines = QuadSpiLines::Single};
+        static constexpr QuadSpiCommand WriteStatus2 {.Instruction = 0x31, .DataLines = QuadSpiLines::Single};
+        static constexpr QuadSpiCommand SectorErase {.Instruction = 0x20, .AddressLines = QuadSpiLines::Single};
+        static constexpr QuadSpiCommand QuadProgram = _QuadEnable == QspiQuadEnable::StatusRegister1Bit6
+            ? QuadSpiCommand {.Instruction = 0x38, .AddressLines = QuadSpiLines::Quad, .DataLines = QuadSpiLines::Quad}
+            : QuadSpiCommand {.Instruction = 0x32, .AddressLines = QuadSpiLines::Single, .DataLines = QuadSpiLines::Quad};
+        // Mode bits 0xff disable continuous read mode, 2 mode clocks and 4 dummy clocks
+        static constexpr QuadSpiCommand QuadRead {.Instruction = 0xeb, .AddressLines = QuadSpiLines::Quad,
+            .AlternateLines = QuadSpiLines::Quad, .Alternate = 0xff, .DummyCycles = 4, .DataLines = QuadSpiLines::Quad};
+
+    public:
+        /**
+         * @brief Initializes QUADSPI and flash (software reset, quad mode), enables memory-mapped mode
+         *
+         * @tparam frequency Max clock frequency
+         * @tparam clockFrequency QUADSPI kernel (AHB) clock frequency
+         *
+         * @retval true Flash is found
+         * @retval false Flash does not respond
+         */
+        template<uint32_t frequency, uint32_t clockFrequency>
+        static bool Init();
+
+        /**
+         * @brief Reads JEDEC identifier
+         *
+         * @returns Manufacturer (high byte), memory type and capacity
+         */
+        static uint32_t JedecId();
+
+        /**
+         * @brief Enables memory-mapped mode
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void EnableMemoryMapped();
+
+        /**
+         * @brief Reads data (indirect mode, blocking)
+         *
+         * @param [in] offset Offset in flash
+         * @param [out] data Data buffer
+         * @param [in] size Data size
+         *
+         * @retval true Data is read
+         * @retval false Transfer error
+         */
+        static bool Read(uint32_t offset, void* data, uint32_t size);
+
+        /**
+         * @brief Reads data by DMA (indirect mode)
+         *
+         * @details
+         * Memory-mapped mode is not restored after read, call EnableMemoryMapped from callback (or later).
+         *
+         * @param [in] offset Offset in flash
+         * @param [out] data Data buffer
+         * @param [in] size Data size
+         * @param [in] callback Completion callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void ReadAsync(uint32_t offset, void* data, uint32_t size, TransferCallback callback = nullptr);
+
+        /**
+         * @brief Returns total flash size
+         *
+         * @returns Flash size in bytes
+         */
+        static constexpr uint32_t FlashSize() { return _Size; }
+
+        /**
+         * @brief Returns page (erase sector) size
+         *
+         * @returns Page size in bytes
+         */
+        static constexpr uint32_t PageSize(unsigned) { return SectorSize; }
+
+        /**
+         * @brief Returns page count
+         *
+         * @returns Page count
+         */
+        static constexpr uint32_t PageCount() { return _Size / SectorSize; }
+
+        /**
+         * @brief Calculates page address (in memory-mapped region)
+         *
+         * @param [in] page Page number
+         *
+         * @returns Page address
+         */
+        static constexpr uint32_t PageAddress(unsigned page) { return _QuadSpi::MappedAddress + page * SectorSize; }
+
+        /**
+         * @brief Calculates page number by address (in memory-mapped region)
+         *
+         * @param [in] address Address
+         *
+         * @returns Page number
+         */
+        static unsigned AddressToPage(const void* address);
+
+        /**
+         * @brief Erases page (4K sector)
+         *
+         * @param [in] page Page number
+         *
+         * @retval true Erase success
+         * @retval false Erase failed
+         */
+        static bool ErasePage(uint32_t page);
+
+        /**
+         * @brief Writes data to page
+         *
+         * @param [in] dst Destination address (in memory-mapped region)
+         * @param [in] src Data to write
+         * @param [in] size Data size
+         *
+         * @retval true Write success
+         * @retval false Write failed (or data crosses page)
+         */
+        static bool WritePage(void* dst, const void* src, unsigned size);
+
+        /**
+         * @brief Writes data to page
+         *
+         * @param [in] page Page number
+         * @param [in] src Data to write
+         * @param [in] size Data size
+         * @param [in] offset Offset in page
+         *
+         * @retval true Write success
+         * @retval false Write failed (or data crosses page)
+         */
+        static bool WritePage(unsigned page, const void* src, unsigned size, unsigned offset);
+
+        /**
+         * @brief Writes data to flash
+         *
+         * @details
+         * Data is programmed by 256-byte program pages. Source may be in memory-mapped region
+         * (it's read into bounce buffer).
+         *
+         * @param [in] dst Destination address (in memory-mapped region)
+         * @param [in] src Data to write
+         * @param [in] size Data size
+         *
+         * @retval true Write success
+         * @retval false Write failed
+         */
+        static bool WriteFlash(void* dst, const void* src, unsigned size);
+
+    private:
+        static bool WaitReady();
+        static bool EnableQuadMode();
+        static bool Program(uint32_t offset, const uint8_t* data, unsigned size);
+    };
+}
+
+#include "impl/qspi_flash.h"
+
+#endif //! ZHELE_DRIVERS_QSPI_FLASH_H
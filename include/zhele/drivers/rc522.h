@@ -11,6 +11,12 @@
 
 #include <zhele/spi.h>
 #include <zhele/delay.h>
+#include <zhele/soft_crc.h>
+#include <zhele/system_time.h>
+
+#include <array>
+#include <string.h>
+#include <type_traits>
 
 namespace Zhele
 {
@@ -19,8 +25,41 @@ namespace Zhele
         /**
          * @brief Implements MFRC522 RFID reader
          * 
+         * @details
+         * Multi-byte FIFO data is transferred in one SPI transaction.
+         * Besides blocking @ref Check, class implements non-blocking card check:
+         * @ref CheckAsync starts it and @ref Process performs next step when current command is completed.
+         * Completion is detected by ComIrq register polling or by IRQ pin (see @ref EnableInterruptMode),
+         * then EXTI handler must call @ref IrqHandler.
+         * 
+         * @par Example
+         * @code
+         *  using Reader = Rc522<Spi1, Pa4, Pa3, Exti3>;
+         *
+         *  void OnCheck(Reader::Status status, const uint8_t* cardId)
+         *  {
+         *      // Compare card ID
+         *  }
+         *
+         *  Reader::Init();
+         *  Reader::EnableInterruptMode();
+         *  for (;;)
+         *  {
+         *      Reader::CheckAsync(OnCheck);
+         *      Reader::Process();
+         *      // Other tasks
+         *  }
+         *
+         *  extern "C" void EXTI3_IRQHandler()
+         *  {
+         *      Reader::IrqHandler();
+         *  }
+         * @endcode
+         * 
          * @tparam _SpiBus Target SPI
          * @tparam _SSPin Slave select pin for transaction control
+         * @tparam _IrqPin IRQ pin (required for interrupt mode)
+         * @tparam _IrqLine EXTI line of IRQ pin (required for interrupt mode)
          * 
          * @todo
          * Class exports basic functional: Init and Check method.
@@ -30,7 +69,7 @@ namespace Zhele
          * The best source for Arduino that i know is MFRC522 class
          * https://github.com/miguelbalboa/rfid/
          */
-        template<typename _SpiBus, typename _SSPin = IO::NullPin>
+        template<typename _SpiBus, typename _SSPin = IO::NullPin, typename _IrqPin = IO::NullPin, typename _IrqLine = void>
         class Rc522
         { 
             /**
@@ -123,7 +162,37 @@ namespace Zhele
                 Version = 0x37, // Software version
             };
 
-            static const uint8_t MaxDataSize = 16;
+            /**
+             * @brief ComIrq register bits
+             */
+            enum ComIrqBits : uint8_t
+            {
+                TimerIrq = 0x01, ///< Timer decremented to zero
+                ErrorIrq = 0x02, ///< Error bit in Error register is set
+                IdleIrq = 0x10, ///< Command terminated
+                RxIrq = 0x20, ///< End of received data stream
+                TxIrq = 0x40, ///< Last bit of transmitted data was sent out
+                Set1 = 0x80 ///< Marked bits are set (otherwise cleared) on write
+            };
+
+            static const uint8_t FifoSize = 64; ///< MFRC522 FIFO size
+            static const uint8_t BlockSize = 16; ///< Mifare block size
+            static const uint8_t IdSize = 5; ///< Card serial number (with check byte) size
+            static const uint8_t CommandTimeout = 50; ///< Command completion timeout (ms), two MFRC522 timer periods
+
+            /// CRC_A (ISO 14443-3) for PICC commands
+            using CrcA = SoftCrc<0x1021, 16, true, 0xc6c6, 0x0000>;
+
+            /**
+             * @brief Async check state
+             */
+            enum class CheckState : uint8_t
+            {
+                Idle, ///< Check is not started
+                Request, ///< Waiting for ATQA
+                AntiCollision, ///< Waiting for serial number
+                Halt ///< Waiting for HLTA sending
+            };
 
         public:
             enum Status
@@ -133,6 +202,9 @@ namespace Zhele
                 Error
             }; 
 
+            /// Async check callback (card ID is valid if status is Success)
+            using CheckCallback = std::add_pointer_t<void(Status status, const uint8_t* cardId)>;
+
             /**
              * @brief Initialize MCU and MFRC522 unit
              * 
@@ -159,6 +231,7 @@ namespace Zhele
                 WriteRegister(Registers::RxMode, 0x00);
                 WriteRegister(Registers::ModWidth, 0x26);
 
+                // Timer starts after transmission and stops RX with TimerIrq after 25 ms (it's response timeout)
                 WriteRegister(Registers::TMode, 0x80);
                 WriteRegister(Registers::TPrescaler, 0xa9);
                 WriteRegister(Registers::TReloadHigh, 0x03);
@@ -184,10 +257,37 @@ namespace Zhele
                 Init();
             }
 
+            /**
+             * @brief Enables IRQ pin driven completion for async check
+             * 
+             * @details
+             * Call it after @ref Init. MFRC522 IRQ pin is switched to push-pull active low output,
+             * so @ref Process makes no SPI transactions until EXTI interrupt signals command completion.
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void EnableInterruptMode()
+            {
+                static_assert(!std::is_same_v<_IrqLine, void>, "Interrupt mode requires EXTI line of IRQ pin");
+
+                _IrqLine::DisableInterrupt();
+                _IrqLine::template InitPin<_IrqPin>(_IrqPin::PullMode::PullUp);
+                _IrqLine::template Init<_IrqLine::Falling, typename _IrqPin::Port>();
+
+                // IRQPushPull
+                WriteRegister(Registers::DivInterruptEnable, 0x80);
+                _irqPending = false;
+                _interruptMode = true;
+
+                _IrqLine::ClearInterruptFlag();
+                _IrqLine::EnableInterrupt();
+            }
+
             /**
              * @brief Try to read card and fix collision.
              * 
-             * @param [out] cardId Buffer for card ID
+             * @param [out] cardId Buffer for card ID (5 bytes)
              * 
              * @retval I2cStatus::Success If card was presented and successful readed.
              * @retval I2cStatus::NoTagError If card was presented but fail readed.
@@ -205,6 +305,111 @@ namespace Zhele
                 return status;
             }
 
+            /**
+             * @brief Starts async card check (request, anticollision and halt)
+             * 
+             * @details
+             * Method sends request and returns. Next steps are performed by @ref Process,
+             * callback is called from it when check is finished.
+             * 
+             * @param [in] callback Check callback
+             * 
+             * @retval true Check is started
+             * @retval false Previous check is in progress
+             */
+            static bool CheckAsync(CheckCallback callback)
+            {
+                if (_state != CheckState::Idle)
+                    return false;
+
+                _callback = callback;
+                _status = Status::Error;
+                _state = CheckState::Request;
+                StartRequest(static_cast<uint8_t>(Commands::RequestIdl));
+                return true;
+            }
+
+            /**
+             * @brief Performs async check step if current command is completed
+             * 
+             * @details
+             * Call it periodically (from main loop or timer interrupt, but not concurrently with other methods).
+             * In interrupt mode it returns immediately until IRQ pin is asserted,
+             * otherwise it reads ComIrq register once per call.
+             * Command timeout is measured by MFRC522 timer, so check always finishes.
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void Process()
+            {
+                if (_state == CheckState::Idle)
+                    return;
+
+                if (_interruptMode)
+                {
+                    if (!_irqPending)
+                        return;
+                    _irqPending = false;
+                }
+
+                uint8_t irq = CommandStatus();
+                if (irq == 0)
+                    return;
+
+                switch (_state)
+                {
+                case CheckState::Request:
+                    _status = FinishRequest(irq, _cardId);
+                    if (_status == Status::Success)
+                    {
+                        _state = CheckState::AntiCollision;
+                        StartAntiCollision();
+                        return;
+                    }
+                    break;
+
+                case CheckState::AntiCollision:
+                    _status = FinishAntiCollision(irq, _cardId);
+                    break;
+
+                default:
+                    _state = CheckState::Idle;
+                    if (_callback)
+                        _callback(_status, _cardId);
+                    return;
+                }
+
+                _state = CheckState::Halt;
+                StartHalt();
+            }
+
+            /**
+             * @brief Check that async check is in progress
+             * 
+             * @retval true Check is in progress
+             * @retval false Reader is idle
+             */
+            static bool Busy()
+            {
+                return _state != CheckState::Idle;
+            }
+
+            /**
+             * @brief IRQ pin interrupt handler. Call it from EXTI interrupt handler.
+             * 
+             * @details
+             * Handler only marks command completion, SPI transactions are performed by @ref Process.
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void IrqHandler()
+            {
+                _IrqLine::ClearInterruptFlag();
+                _irqPending = true;
+            }
+
             /**
              * @brief Compare two card ID.
              * 
@@ -219,7 +424,7 @@ namespace Zhele
              */
             static bool Compare(const uint8_t* first, const uint8_t* second)
             {
-                for (int i = 0; i < 5; ++i)
+                for (int i = 0; i < IdSize; ++i)
                 {
                     if (first[i] != second[i])
                         return false;
@@ -228,6 +433,19 @@ namespace Zhele
             }
 
         private:
+            /**
+             * @brief Returns SPI address byte for register
+             * 
+             * @param [in] registerAddress Register address
+             * @param [in] read Read (true) or write (false) access
+             * 
+             * @returns Address byte
+             */
+            static constexpr uint8_t Address(Registers registerAddress, bool read)
+            {
+                return ((static_cast<uint8_t>(registerAddress) << 1) & 0x7e) | (read ? 0x80 : 0x00);
+            }
+
             /**
              * @brief Writes value to register.
              * 
@@ -240,7 +458,7 @@ namespace Zhele
             static void WriteRegister(Registers registerAddress, uint8_t value)
             {
                 _SSPin::Clear();
-                _SpiBus::Send((static_cast <uint8_t>(registerAddress) << 1) & 0x7e);
+                _SpiBus::Send(Address(registerAddress, false));
                 _SpiBus::Send(value);
                 _SSPin::Set();
             }
@@ -255,12 +473,63 @@ namespace Zhele
             static uint8_t ReadRegister(Registers registerAddress)
             {
                 _SSPin::Clear();
-                _SpiBus::Write(((static_cast <uint8_t >(registerAddress) << 1) & 0x7e) | 0x80);
+                _SpiBus::Write(Address(registerAddress, true));
                 uint8_t readed = _SpiBus::Read();
                 _SSPin::Set();
                 return readed;
             }
 
+            /**
+             * @brief Writes data to FIFO in one SPI transaction
+             * 
+             * @details
+             * MFRC522 writes all bytes after address byte to the same register.
+             * 
+             * @param [in] data Data to write
+             * @param [in] size Data size
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void WriteFifo(const uint8_t* data, uint8_t size)
+            {
+                if (size == 0)
+                    return;
+
+                _SSPin::Clear();
+                _SpiBus::Send(Address(Registers::FifoData, false));
+                _SpiBus::Transfer(data, nullptr, size);
+                _SSPin::Set();
+            }
+
+            /**
+             * @brief Reads data from FIFO in one SPI transaction
+             * 
+             * @details
+             * MFRC522 returns register value while next address byte is clocked,
+             * so address is repeated for every byte except last one (it's terminated by zero).
+             * 
+             * @param [out] data Output buffer
+             * @param [in] size Data size (not greater than FIFO size)
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void ReadFifo(uint8_t* data, uint8_t size)
+            {
+                if (size == 0)
+                    return;
+
+                uint8_t addresses[FifoSize];
+                memset(addresses, Address(Registers::FifoData, true), size - 1);
+                addresses[size - 1] = 0x00;
+
+                _SSPin::Clear();
+                _SpiBus::Send(Address(Registers::FifoData, true));
+                _SpiBus::Transfer(addresses, data, size);
+                _SSPin::Set();
+            }
+
             /**
              * @brief Set register`s bits with mask
              * 
@@ -327,194 +596,297 @@ namespace Zhele
             }
 
             /**
-             * @brief Makes a request to MFRC522
-             * 
-             * @param [in] requestMode Request type
-             * @param [in, out] tagType Data for transmit and buffer for receive
+             * @brief Starts command execution
              * 
-             * @returns Operation result
-             */
-            static Status Request(uint8_t requestMode, uint8_t* tagType)
-            {
-                WriteRegister(Registers::BitFraming, 0x07);
-
-                tagType[0] = requestMode;
-                uint16_t tagTypeSize;
-                Status status = ToCard(Commands::Transceive, tagType, 1, tagType, &tagTypeSize);
-                if (tagTypeSize != 0x10)
-                {
-                    status = Status::Error;
-                }
-                return status;
-            }
-
-            /**
-             * @brief Send command and data to module, read answer
+             * @details
+             * Only completion interrupts are enabled (and routed to IRQ pin),
+             * so IRQ pin is asserted once per command.
              * 
              * @param [in] command Command
              * @param [in] transmitData Data to transmit
              * @param [in] transmitDataSize Transmit data size
-             * @param [out] receiveData Output buffer
-             * @param [out] receiveDataSize Received size
+             * @param [in] lastBits Number of bits of last byte to transmit (0 for whole byte)
              * 
-             * @returns Operation status
+             * @par Returns
+             *	Nothing
              */
-            static Status ToCard(Commands command, uint8_t* transmitData, uint8_t transmitDataSize, uint8_t* receiveData, uint16_t* receiveDataSize)
+            static void StartCommand(Commands command, const uint8_t* transmitData, uint8_t transmitDataSize, uint8_t lastBits = 0)
             {
-                uint8_t irqEnable = 0x00;
-                uint8_t waitIrq = 0x00;
-
                 switch (command)
                 {
-                case Commands::Auth:
-                    irqEnable = 0x12;
-                    waitIrq = 0x10;
-                    break;
-
                 case Commands::Transceive:
-                    irqEnable = 0x77;
-                    waitIrq = 0x30;
+                    _waitIrq = RxIrq | IdleIrq | TimerIrq;
                     break;
 
                 default:
+                    _waitIrq = IdleIrq | TimerIrq;
                     break;
                 }
 
+                WriteRegister(Registers::Command, static_cast<uint8_t>(Commands::Idle));
+                // IRqInv (IRQ pin is active low)
+                WriteRegister(Registers::ComInterruptEnable, _waitIrq | 0x80);
+                WriteRegister(Registers::ComIrq, static_cast<uint8_t>(~Set1));
+                // FlushBuffer
+                WriteRegister(Registers::FifoLevel, 0x80);
 
-                WriteRegister(Registers::ComInterruptEnable, irqEnable | 0x80);
-                ClearBitMask(Registers::ComIrq, 0x80);
-                SetBitMask(Registers::FifoLevel, 0x80);
+                WriteFifo(transmitData, transmitDataSize);
 
-                WriteRegister(Registers::Command, static_cast <uint8_t >(Commands::Idle));
-
-                for (int i = 0; i < transmitDataSize; ++i)
-                {
-                    WriteRegister(Registers::FifoData, transmitData[i]);
-                }
-
-                WriteRegister(Registers::Command, static_cast <uint8_t >(command));
+                WriteRegister(Registers::BitFraming, lastBits);
+                WriteRegister(Registers::Command, static_cast<uint8_t>(command));
 
                 if (command == Commands::Transceive)
                 {
-                    SetBitMask(Registers::BitFraming, 0x80);
+                    // StartSend
+                    WriteRegister(Registers::BitFraming, lastBits | 0x80);
                 }
+            }
+
+            /**
+             * @brief Returns command completion interrupt bits
+             * 
+             * @returns ComIrq register value masked by completion bits (0 if command is in progress)
+             */
+            static uint8_t CommandStatus()
+            {
+                return ReadRegister(Registers::ComIrq) & _waitIrq;
+            }
 
-                uint16_t timeout = 10000;
-                uint8_t comIrqRegisterValue;
+            /**
+             * @brief Waits for command completion
+             * 
+             * @returns ComIrq register value masked by completion bits (0 if timeout is expired)
+             */
+            static uint8_t WaitCommand()
+            {
+                // 10000 polls without system time
+                Deadline deadline(CommandTimeout, 9999);
+                uint8_t irq;
                 do
                 {
-                    comIrqRegisterValue = ReadRegister(Registers::ComIrq);
-                    --timeout;
-                } while ((timeout != 0) && !(comIrqRegisterValue & 0x01) && !(comIrqRegisterValue & waitIrq));
+                    irq = CommandStatus();
+                } while (irq == 0 && !deadline.Expired());
 
-                ClearBitMask(Registers::BitFraming, 0x80);
+                return irq;
+            }
 
-                if (timeout == 0)
-                {
-                    return Status::Error;
-                }
+            /**
+             * @brief Reads command result
+             * 
+             * @param [in] irq Completion interrupt bits
+             * @param [out] receiveData Output buffer
+             * @param [in] receiveDataSize Output buffer size
+             * @param [out] receiveBits Received size (in bits)
+             * 
+             * @returns Operation status
+             */
+            static Status FinishCommand(uint8_t irq, uint8_t* receiveData, uint8_t receiveDataSize, uint16_t* receiveBits)
+            {
+                *receiveBits = 0;
 
                 if ((ReadRegister(Registers::Error) & 0x1b))
                     return Status::Error;
 
-                if (comIrqRegisterValue & irqEnable & 0x01)
+                if (irq & TimerIrq)
                     return Status::NoTagError;
 
-                if (command == Commands::Transceive)
-                {
-                    uint8_t fifoSize = ReadRegister(Registers::FifoLevel);
-                    uint8_t lastBits = ReadRegister(Registers::Control) & 0x07;
-                    if (lastBits)
-                    {
-                        *receiveDataSize = (fifoSize - 1) * 8 + lastBits;
-                    }
-                    else
-                    {
-                        *receiveDataSize = fifoSize * 8;
-                    }
+                uint8_t fifoSize = ReadRegister(Registers::FifoLevel) & 0x7f;
+                uint8_t lastBits = ReadRegister(Registers::Control) & 0x07;
+                *receiveBits = lastBits && fifoSize > 0
+                    ? (fifoSize - 1) * 8 + lastBits
+                    : fifoSize * 8;
 
-                    if (fifoSize == 0)
-                    {
-                        fifoSize = 1;
-                    }
-                    if (fifoSize > MaxDataSize)
-                    {
-                        fifoSize = MaxDataSize;
-                    }
+                ReadFifo(receiveData, fifoSize < receiveDataSize ? fifoSize : receiveDataSize);
+                return Status::Success;
+            }
 
-                    for (int i = 0; i < fifoSize; ++i)
-                    {
-                        receiveData[i] = ReadRegister(Registers::FifoData);
-                    }
-                    
+            /**
+             * @brief Send command and data to module, read answer
+             * 
+             * @param [in] command Command
+             * @param [in] transmitData Data to transmit
+             * @param [in] transmitDataSize Transmit data size
+             * @param [out] receiveData Output buffer
+             * @param [in] receiveDataSize Output buffer size
+             * @param [out] receiveBits Received size (in bits)
+             * 
+             * @returns Operation status
+             */
+            static Status ToCard(Commands command, const uint8_t* transmitData, uint8_t transmitDataSize, uint8_t* receiveData, uint8_t receiveDataSize, uint16_t* receiveBits)
+            {
+                StartCommand(command, transmitData, transmitDataSize);
+
+                uint8_t irq = WaitCommand();
+                if (irq == 0)
+                {
+                    *receiveBits = 0;
+                    return Status::Error;
                 }
 
-                return Status::Success;
+                return FinishCommand(irq, receiveData, command == Commands::Transceive ? receiveDataSize : 0, receiveBits);
             }
 
-            static Status AntiCollision(uint8_t* id)
+            /**
+             * @brief Sends request (REQA or WUPA)
+             * 
+             * @param [in] requestMode Request type
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void StartRequest(uint8_t requestMode)
+            {
+                // Short frame (7 bits)
+                StartCommand(Commands::Transceive, &requestMode, 1, 0x07);
+            }
+
+            /**
+             * @brief Reads request answer (ATQA)
+             * 
+             * @param [in] irq Completion interrupt bits
+             * @param [out] tagType Buffer for answer (2 bytes)
+             * 
+             * @returns Operation status
+             */
+            static Status FinishRequest(uint8_t irq, uint8_t* tagType)
             {
-                WriteRegister(Registers::BitFraming, 0x00);
+                uint16_t tagTypeBits;
+                Status status = FinishCommand(irq, tagType, 2, &tagTypeBits);
+                if (tagTypeBits != 0x10)
+                {
+                    status = Status::Error;
+                }
+                return status;
+            }
 
-                id[0] = static_cast <uint8_t >(Commands::AntiCollision);
-                id[1] = 0x20;
+            /**
+             * @brief Makes a request to MFRC522
+             * 
+             * @param [in] requestMode Request type
+             * @param [out] tagType Buffer for answer (2 bytes)
+             * 
+             * @returns Operation result
+             */
+            static Status Request(uint8_t requestMode, uint8_t* tagType)
+            {
+                StartRequest(requestMode);
+                uint8_t irq = WaitCommand();
+                return irq != 0
+                    ? FinishRequest(irq, tagType)
+                    : Status::Error;
+            }
 
-                uint16_t dummy;
-                Status status = ToCard(Commands::Transceive, id, 2, id, &dummy);
-            
+            /**
+             * @brief Sends anticollision command (cascade level 1)
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void StartAntiCollision()
+            {
+                const uint8_t command[] = {static_cast<uint8_t>(Commands::AntiCollision), 0x20};
+                StartCommand(Commands::Transceive, command, sizeof(command));
+            }
+
+            /**
+             * @brief Reads anticollision answer (serial number and check byte)
+             * 
+             * @param [in] irq Completion interrupt bits
+             * @param [out] id Buffer for card ID (5 bytes)
+             * 
+             * @returns Operation status
+             */
+            static Status FinishAntiCollision(uint8_t irq, uint8_t* id)
+            {
+                uint16_t idBits;
+                Status status = FinishCommand(irq, id, IdSize, &idBits);
                 if (status != Status::Success)
                 {
                     return status;
                 }
+                if (idBits != IdSize * 8)
+                {
+                    return Status::Error;
+                }
 
+                // Last byte is XOR of serial number bytes
                 uint8_t idCheck = 0;
                 for (int i = 0; i < 4; ++i)
                 {
                     idCheck ^= id[i];
                 }
-                //todo:: Check this code! In TM lib it's strange place.
                 return idCheck == id[4] ? Status::Success : Status::Error;
             }
 
-            static void CalculateCRC(uint8_t* data, uint8_t size, uint8_t* result)
+            static Status AntiCollision(uint8_t* id)
             {
-                ClearBitMask(Registers::DivIrq, 0x04);
-                SetBitMask(Registers::FifoLevel, 0x80);
+                StartAntiCollision();
+                uint8_t irq = WaitCommand();
+                return irq != 0
+                    ? FinishAntiCollision(irq, id)
+                    : Status::Error;
+            }
 
-                for (int i = 0; i < size; ++i)
-                {
-                    WriteRegister(Registers::FifoData, data[i]);
-                }
-                WriteRegister(Registers::Command, static_cast <uint8_t >(Commands::CalculateCRC));
+            /**
+             * @brief Sends halt command (HLTA)
+             * 
+             * @details
+             * Card doesn't answer to HLTA, so it's only transmitted (without waiting for response timeout).
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void StartHalt()
+            {
+                constexpr uint16_t crc = CrcA::Calculate(std::array<uint8_t, 2>{static_cast<uint8_t>(Commands::Halt), 0x00});
+                const uint8_t command[] = {static_cast<uint8_t>(Commands::Halt), 0x00, static_cast<uint8_t>(crc), static_cast<uint8_t>(crc >> 8)};
+                StartCommand(Commands::Transmit, command, sizeof(command));
+            }
 
-                uint8_t timeout = 0xff;
-                while (!(ReadRegister(Registers::DivIrq) & 0x04) && timeout--) ;
+            static void Halt()
+            {
+                StartHalt();
+                WaitCommand();
+            }
 
-                result[0] = ReadRegister(Registers::CRCResultLSB);
-                result[1] = ReadRegister(Registers::CRCResultMSB);
+            /**
+             * @brief Calculates CRC_A for PICC command
+             * 
+             * @param [in] data Data
+             * @param [in] size Data size
+             * @param [out] result CRC (2 bytes, LSB first)
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void CalculateCRC(const uint8_t* data, uint8_t size, uint8_t* result)
+            {
+                uint16_t crc = CrcA::Calculate(data, size);
+                result[0] = static_cast<uint8_t>(crc);
+                result[1] = static_cast<uint8_t>(crc >> 8);
             }
 
             static uint8_t SelectTag(uint8_t* id)
             {
                 uint8_t buffer[9];
-                buffer[0] = Commands::SelectTag;
+                buffer[0] = static_cast<uint8_t>(Commands::SelectTag);
                 buffer[1] = 0x70;
 
-                for (int i = 0; i < 5; ++i)
+                for (int i = 0; i < IdSize; ++i)
                 {
                     buffer[i + 2] = id[i];
                 }
 
                 CalculateCRC(buffer, 7, &buffer[7]);
 
-                uint16_t receiveSize = 0;
-                Status status = ToCard(Commands::Transeive, buffer, 9, buffer, &receiveSize);
+                uint16_t receiveBits = 0;
+                Status status = ToCard(Commands::Transceive, buffer, 9, buffer, sizeof(buffer), &receiveBits);
 
-                return status == Status::Success && receiveSize == 0x18
+                return status == Status::Success && receiveBits == 0x18
                     ? buffer[0]
                     : 0;
             }
-            static Status Auth(uint8_t authMode, uint8_t blockAddress, uint8_t* sectorKey, uint8_t* id)
+            static Status Auth(uint8_t authMode, uint8_t blockAddress, const uint8_t* sectorKey, const uint8_t* id)
             {
                 uint8_t buffer[12];
 
@@ -532,7 +904,7 @@ namespace Zhele
                 }
 
                 uint16_t dummy;
-                Status status = ToCard(Commands::Auth, buffer, 12, buffer, &dummy);
+                Status status = ToCard(Commands::Auth, buffer, 12, buffer, sizeof(buffer), &dummy);
                 return (status != Status::Success || (!(ReadRegister(Registers::Status2) & 0x08)))
                     ? Status::Error
                     : status;
@@ -540,54 +912,50 @@ namespace Zhele
 
             static Status Read(uint8_t blockAddress, uint8_t* receiveData)
             {
-                receiveData[0] = Commands::Read;
+                receiveData[0] = static_cast<uint8_t>(Commands::Read);
                 receiveData[1] = blockAddress;
 
                 CalculateCRC(receiveData, 2, &receiveData[2]);
-                uint16_t receiveSize;
-                Status status = ToCard(Commands::Transeive, receiveData, 4, receiveData, &receiveSize);
+                uint16_t receiveBits;
+                Status status = ToCard(Commands::Transceive, receiveData, 4, receiveData, BlockSize + 2, &receiveBits);
 
-                return (status != Status::Success || receiveSize != 0x90)
+                return (status != Status::Success || receiveBits != 0x90)
                     ? Status::Error
                     : status;		
             }
-            static Status Write(uint8_t blockAddress, uint8_t* data)
+            static Status Write(uint8_t blockAddress, const uint8_t* data)
             {
-                uint8_t buffer[18];
+                uint8_t buffer[BlockSize + 2];
 
-                buffer[0] = Commands::Send;
+                buffer[0] = static_cast<uint8_t>(Commands::Write);
                 buffer[1] = blockAddress;
                 CalculateCRC(buffer, 2, &buffer[2]);
-                uint16_t receiveSize;
-                Status status = ToCard(Commands::Transeive, buffer, 4, buffer, &receiveSize);
+                uint16_t receiveBits;
+                Status status = ToCard(Commands::Transceive, buffer, 4, buffer, sizeof(buffer), &receiveBits);
 
-                if (status != Status::Success || receiveSize != 4 || (buffer[0] & 0x0f) != 0x0a)
-                    status == Status::Error;
-
-                if (status != Status::Success)
-                    return status;
+                if (status != Status::Success || receiveBits != 4 || (buffer[0] & 0x0f) != 0x0a)
+                    return Status::Error;
 
-                for (int i = 0; i < 16; ++i)
+                for (int i = 0; i < BlockSize; ++i)
                 {
                     buffer[i] = data[i];
                 }
-                CalculateCRC(buffer, 16, &buffer[16]);
-                status = ToCard(Commands::Transeive, buffer, 18, buffer, &receiveSize);
+                CalculateCRC(buffer, BlockSize, &buffer[BlockSize]);
+                status = ToCard(Commands::Transceive, buffer, sizeof(buffer), buffer, sizeof(buffer), &receiveBits);
 
-                return (status != Status::Success || receiveSize != 4 || (buffer[0] & 0x0f) != 0x0a)
+                return (status != Status::Success || receiveBits != 4 || (buffer[0] & 0x0f) != 0x0a)
                     ? Status::Error
                     : status;
 
             }
-            static void Halt()
-            {
-                uint8_t buffer[4];
-                buffer[0] = static_cast <uint8_t >(Commands::Halt);
-                CalculateCRC(buffer, 2, &buffer[2]);
 
-                uint16_t resultSize;
-                ToCard(Commands::Transceive, buffer, 4, buffer, &resultSize);
-            }
+            static inline uint8_t _waitIrq = 0; ///< Completion interrupt bits of current command
+            static inline volatile CheckState _state = CheckState::Idle; ///< Async check state
+            static inline Status _status = Status::Error; ///< Async check result
+            static inline CheckCallback _callback = nullptr; ///< Async check callback
+            static inline uint8_t _cardId[IdSize]; ///< Async check card ID
+            static inline bool _interruptMode = false; ///< IRQ pin is used
+            static inline volatile bool _irqPending = false; ///< IRQ pin was asserted
         };
     }
 }
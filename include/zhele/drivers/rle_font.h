@@ -0,0 +1,308 @@
+/**
+ * @file
+ * Implements run-length compressed proportional fonts
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_RLE_FONT_H
+#define ZHELE_DRIVERS_RLE_FONT_H
+
+#include "glyph_cache.h"
+
+#include <array>
+#include <cstdint>
+
+namespace Zhele::Drivers
+{
+    namespace Private
+    {
+        /**
+         * @brief Compressed glyph stream writer (counts nibbles only if data is not given)
+         */
+        struct RleWriter
+        {
+            uint8_t* Data = nullptr; ///< Output data
+            unsigned Nibbles = 0; ///< Written nibbles count
+
+            /**
+             * @brief Writes nibble (high nibble of byte is the first)
+             *
+             * @param [in] nibble Nibble
+             *
+             * @par Returns
+             *  Nothing
+             */
+            constexpr void Put(uint8_t nibble)
+            {
+                if (Data != nullptr) {
+                    if (Nibbles % 2 == 0)
+                        Data[Nibbles / 2] = static_cast<uint8_t>(nibble << 4);
+                    else
+                        Data[Nibbles / 2] |= nibble;
+                }
+                ++Nibbles;
+            }
+
+            /**
+             * @brief Writes run
+             *
+             * @details
+             * Run of 1..15 pixels takes one nibble, other runs are written as zero nibble and
+             * length byte. Runs that are longer than 255 pixels are split by empty runs of other color.
+             *
+             * @param [in] length Run length
+             *
+             * @par Returns
+             *  Nothing
+             */
+            constexpr void Run(unsigned length)
+            {
+                while (length > 0xff) {
+                    Run(0xff);
+                    Run(0);
+                    length -= 0xff;
+                }
+
+                if (length > 0 && length < 0x10) {
+                    Put(length);
+                } else {
+                    Put(0);
+                    Put(length >> 4);
+                    Put(length & 0x0f);
+                }
+            }
+        };
+
+        /**
+         * @brief Returns glyph width of bitmap font
+         *
+         * @tparam _Font Font
+         *
+         * @param [in] symbol Symbol
+         *
+         * @returns Glyph width
+         */
+        template<typename _Font>
+        constexpr uint8_t BitmapGlyphWidth(char symbol)
+        {
+            if constexpr (_Font::MonoSpace)
+                return _Font::Width;
+            else
+                return _Font::GetWidth(symbol);
+        }
+
+        /**
+         * @brief Compresses glyph of bitmap font
+         *
+         * @details
+         * Pixels are scanned by rows from top to bottom, runs alternate starting from background one.
+         * Trailing background run is omitted.
+         *
+         * @tparam _Font Font (with constexpr data)
+         *
+         * @param [in] symbol Symbol
+         * @param [in, out] writer Stream writer
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Font>
+        constexpr void EncodeGlyph(char symbol, RleWriter& writer)
+        {
+            const uint8_t* glyph = _Font::Get(symbol);
+            const uint8_t width = BitmapGlyphWidth<_Font>(symbol);
+
+            bool state = false;
+            unsigned run = 0;
+
+            for (uint8_t row = 0; row < _Font::Height; ++row) {
+                for (uint8_t column = 0; column < width; ++column) {
+                    if (GlyphPixel<_Font>(glyph, width, column, row) != state) {
+                        writer.Run(run);
+                        state = !state;
+                        run = 0;
+                    }
+                    ++run;
+                }
+            }
+
+            if (state)
+                writer.Run(run);
+        }
+    }
+
+    /**
+     * @brief Implements run-length compressed proportional font, that is built from bitmap font at compile time
+     *
+     * @details
+     * Glyph is stored as runs of background and foreground pixels (rows from top to bottom, the same order
+     * as display RAM write), short run takes one nibble. Glyphs are addressed by offsets table, so glyph
+     * lookup doesn't depend on symbol position (unlike @ref Font). Decoder passes runs to renderer,
+     * so displays fill framebuffer or DMA rows by runs without intermediate bitmap.
+     * Compression pays off for large fonts (glyph bitmap of small font is shorter than its runs),
+     * compare @ref Size with source font data size.
+     * Symbols out of range are drawn as first symbol.
+     *
+     * @par Example
+     * @code
+     *  using BigFont = RleFont<Fixed10x15Bold>;
+     *  Lcd::WriteString<BigFont>(0, 0, "Hello", Lcd::White, Lcd::Black);
+     *  Oled::Puts<BigFont>("Hello");
+     * @endcode
+     *
+     * @tparam _Font Source font (monospace or proportional with constexpr data)
+     * @tparam _First First symbol
+     * @tparam _Last Last symbol
+     */
+    template<typename _Font, char _First = ' ', char _Last = '~'>
+    class RleFont
+    {
+        static_assert(_First <= _Last, "Invalid symbols range");
+
+        static const unsigned Count = _Last - _First + 1;
+
+        static constexpr unsigned Nibbles = []() {
+            Private::RleWriter writer;
+            for (unsigned symbol = 0; symbol < Count; ++symbol)
+                Private::EncodeGlyph<_Font>(static_cast<char>(_First + symbol), writer);
+            return writer.Nibbles;
+        }();
+        static_assert(Nibbles <= 0xffff, "Font is too large for 16-bit offsets");
+
+        struct Tables
+        {
+            std::array<uint16_t, Count + 1> Offsets; ///< Glyphs offsets (in nibbles)
+            std::array<uint8_t, Count> Widths; ///< Glyphs widths
+            std::array<uint8_t, (Nibbles + 1) / 2> Data; ///< Runs
+        };
+
+        static constexpr Tables Build()
+        {
+            Tables tables{};
+            Private::RleWriter writer{tables.Data.data(), 0};
+
+            for (unsigned symbol = 0; symbol < Count; ++symbol) {
+                tables.Offsets[symbol] = static_cast<uint16_t>(writer.Nibbles);
+                tables.Widths[symbol] = Private::BitmapGlyphWidth<_Font>(static_cast<char>(_First + symbol));
+                Private::EncodeGlyph<_Font>(static_cast<char>(_First + symbol), writer);
+            }
+            tables.Offsets[Count] = static_cast<uint16_t>(writer.Nibbles);
+
+            return tables;
+        }
+
+        static constexpr Tables _tables = Build(); ///< Font tables
+
+        static uint8_t Nibble(unsigned index)
+        {
+            const uint8_t value = _tables.Data[index / 2];
+            return (index % 2 == 0) ? (value >> 4) : (value & 0x0f);
+        }
+
+        static constexpr unsigned Index(char symbol)
+        {
+            return (symbol < _First || symbol > _Last) ? 0 : symbol - _First;
+        }
+    public:
+        /// Font is not monospace (glyphs have own widths)
+        static const bool MonoSpace = false;
+
+        /// Font height
+        static const uint8_t Height = _Font::Height;
+
+        /// Font size in flash (bytes)
+        static const unsigned Size = sizeof(Tables);
+
+        /**
+         * @brief Returns width for given symbol
+         *
+         * @param [in] symbol Symbol
+         *
+         * @returns Symbols`s width.
+         */
+        static constexpr uint8_t GetWidth(char symbol)
+        {
+            return _tables.Widths[Index(symbol)];
+        }
+
+        /**
+         * @brief Decodes glyph
+         *
+         * @details
+         * Callback is called for every run (runs are split by glyph rows),
+         * all pixels of glyph are passed in order of rows from top to bottom.
+         * Callback signature: void(uint8_t row, uint8_t column, uint8_t length, bool set).
+         *
+         * @tparam _Callback Run callback
+         *
+         * @param [in] symbol Symbol
+         * @param [in] callback Run callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Callback>
+        static void Decode(char symbol, _Callback&& callback)
+        {
+            const unsigned index = Index(symbol);
+            const uint8_t width = _tables.Widths[index];
+            unsigned nibble = _tables.Offsets[index];
+            const unsigned end = _tables.Offsets[index + 1];
+
+            if (width == 0)
+                return;
+
+            uint8_t row = 0;
+            uint8_t column = 0;
+            bool set = false;
+
+            while (row < Height) {
+                unsigned length;
+                if (nibble < end) {
+                    length = Nibble(nibble++);
+                    if (length == 0) {
+                        length = (Nibble(nibble) << 4) | Nibble(nibble + 1);
+                        nibble += 2;
+                    }
+                } else {
+                    // Trailing background
+                    length = (Height - row) * width;
+                    set = false;
+                }
+
+                while (length > 0 && row < Height) {
+                    const uint8_t part = length < static_cast<unsigned>(width - column) ? length : width - column;
+                    callback(row, column, part, set);
+
+                    length -= part;
+                    column += part;
+                    if (column == width) {
+                        column = 0;
+                        ++row;
+                    }
+                }
+
+                set = !set;
+            }
+        }
+    };
+
+    namespace Private
+    {
+        /**
+         * @brief Check that font is run-length compressed
+         *
+         * @tparam _Font Font
+         */
+        template<typename _Font>
+        constexpr bool IsRleFont = false;
+
+        template<typename _Font, char _First, char _Last>
+        constexpr bool IsRleFont<RleFont<_Font, _First, _Last>> = true;
+    }
+}
+
+#endif //! ZHELE_DRIVERS_RLE_FONT_H
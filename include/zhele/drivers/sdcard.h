@@ -10,8 +10,15 @@
 #ifndef ZHELE_DRIVERS_SDCARD_H
 #define ZHELE_DRIVERS_SDCARD_H
 
-#include <zhele/delay.h>
 #include <zhele/binary_stream.h>
+#include <zhele/delay.h>
+#include <zhele/soft_crc.h>
+#include <zhele/statistics.h>
+#include <zhele/system_time.h>
+
+#include <array>
+#include <stdint.h>
+#include <type_traits>
 
 namespace Zhele::Drivers
 {
@@ -41,6 +48,7 @@ namespace Zhele::Drivers
         GenCmd = 56, ///< Transfer data block
         ReadOcr = 58, ///< Read OCR register
         CrcOnOff = 59, ///< Turns CRC option on or off
+        SetWrBlkEraseCount = 23, ///< Set number of blocks to be pre-erased before writing (ACMD23)
         SdSendOpCond = 41 // ACMD41
     };
 
@@ -87,16 +95,55 @@ namespace Zhele::Drivers
     /**
      * @brief Implements SD card
      * 
+     * @details
+     * With _UseCrc card CRC checking is enabled (CMD59): commands are sent with CRC7, data blocks are sent
+     * with CRC16 and received blocks are checked. CRC16 is calculated by slice-by-4 table (2 KB of flash).
+     * In DMA mode (@ref ReadBlocks / @ref WriteBlocks) CRC of block is calculated while next block is transferred.
+     * 
      * @tparam _SpiModule SPI module
      * @tparam _CsPin Chip select pin
+     * @tparam _UseCrc Enable CRC checking
      */
-    template<typename _SpiModule, typename _CsPin>
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc = false>
     class SdCard
     {
-        static const uint16_t CommandTimeoutValue = 100; ///< Command timeout
-        static const bool useCrc = false; ///< CRC using flag
+        static const uint16_t CommandTimeoutValue = 100; ///< Command timeout (bytes polled between deadline checks)
+        static const uint16_t InitTimeout = 1000; ///< Initialization timeout (ms)
+        static const uint16_t ReadTimeout = 100; ///< Data token timeout (ms)
+        static const uint16_t WriteTimeout = 250; ///< Busy timeout (ms)
+        static const uint16_t AsyncPollBytes = 16; ///< Bytes polled by one @ref Process call
+        static const uint32_t AsyncPollTimeout = 65536; ///< Max @ref Process polls for token or busy end (without system time)
         static SdCardType _type; ///< SD card type
         static BinaryStream<_SpiModule> Spi; ///< Binary stream
+
+        /// Async blocks transfer state
+        enum class AsyncState : uint8_t
+        {
+            Idle, ///< No transfer
+            WaitToken, ///< Read: wait data start token
+            WaitReady, ///< Write: wait card is not busy before data token
+            Data, ///< Block data is being transferred by DMA
+            DataDone, ///< DMA transfer of block is complete
+            WaitProgram, ///< Write: wait while card programs last block
+            Failed ///< DMA error
+        };
+
+        using DataCrc = SoftCrc<0x1021, 16, false, 0x0000, 0x0000, CrcTable::Slice4>; ///< Data blocks CRC16 (XMODEM, slice-by-4 table)
+
+        /// Returns true if iterator is byte pointer (so block is transferred by stream in bulk, with DMA if SPI supports it)
+        template<typename Iterator>
+        static constexpr bool IsBytePointer = std::is_pointer_v<Iterator>
+            && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<Iterator>>, uint8_t>;
+
+    public:
+        static const uint32_t InitFrequency = 400000; ///< Max SPI clock during card identification
+        static const uint32_t DataFrequency = 25000000; ///< Max SPI clock in data transfer mode
+
+        /// Async blocks transfer complete callback
+        using BlocksCallback = std::add_pointer_t<void(bool success)>;
+
+        /// Runtime counters (blocks, failures, busy waits), enabled by ZHELE_STATISTICS
+        using Counters = Statistics::Counters<Statistics::SdCardCounters, SdCard>;
     
     protected:
         /**
@@ -139,28 +186,151 @@ namespace Zhele::Drivers
         {
             _CsPin::Clear();
 
+            // 1000 bytes without system time
+            Deadline deadline(ReadTimeout, 1000 / CommandTimeoutValue - 1);
             uint8_t resp;
-            resp = Spi.IgnoreWhile(1000, 0xFF);
+            do
+            {
+                resp = Spi.IgnoreWhile(CommandTimeoutValue, 0xFF);
+                if(resp == 0xFF)
+                    Counters::Add(Statistics::SdCardCounters::BusyPolls);
+            }while(resp == 0xFF && !deadline.Expired());
             if(resp != 0xFE)
             {
                 _CsPin::Set();
+                Counters::Add(Statistics::SdCardCounters::Errors);
                 return false;
             }
-            Spi. template Read<ReadIterator>(iter, size);
-            uint16_t crc = Spi.ReadU16Le();
-            if(useCrc)
+            if constexpr (IsBytePointer<ReadIterator>)
+                Spi.ReadSpan({iter, size});
+            else
+                Spi. template Read<ReadIterator>(iter, size);
+            uint16_t crc = Spi.ReadU16Be();
+            _CsPin::Set();
+            Spi.Read();
+            bool valid = true;
+            if constexpr (_UseCrc)
             {
-                // TBD
+                static_assert(std::is_pointer_v<ReadIterator>, "CRC check requires pointer to buffer");
+                valid = crc == Crc16(iter, size);
             }
             else
             {
                 (void)crc;
             }
-            _CsPin::Set();
-            Spi.Read();
-            return true;
+            // Registers (CSD, CID) are read as short data blocks too
+            if(!valid)
+                Counters::Add(Statistics::SdCardCounters::Errors);
+            else if(size == 512)
+                Counters::Add(Statistics::SdCardCounters::BlocksRead);
+            return valid;
+        }
+
+        /**
+         * @brief Write data block and its CRC (without token)
+         * 
+         * @tparam WriteIterator Iterator type
+         * 
+         * @param iter Iterator
+         */
+        template<typename WriteIterator>
+        static void WriteDataBlock(WriteIterator iter)
+        {
+            if constexpr (IsBytePointer<WriteIterator>)
+                Spi.WriteSpan({iter, 512});
+            else
+                Spi.template Write<WriteIterator>(iter, 512);
+
+            if constexpr (_UseCrc)
+            {
+                static_assert(std::is_pointer_v<WriteIterator>, "CRC calculation requires pointer to buffer");
+                Spi.WriteU16Be(Crc16(iter, 512));
+            }
+            else
+            {
+                Spi.ReadU16Be();
+            }
+        }
+
+        /**
+         * @brief Calculates CRC16-CCITT of data block
+         * 
+         * @tparam Pointer Data pointer type
+         * 
+         * @param data Data
+         * @param size Data size
+         * 
+         * @returns CRC16
+         */
+        template<typename Pointer>
+        static uint16_t Crc16(Pointer data, size_t size)
+        {
+            return DataCrc::Calculate(&*data, size);
         }
 
+        /**
+         * @brief Calculates command CRC7
+         * 
+         * @param index Command index (with start bits)
+         * @param arg Argument
+         * 
+         * @returns CRC7 shifted left by 1 (without end bit)
+         */
+        static uint8_t Crc7(uint8_t index, uint32_t arg)
+        {
+            const uint8_t command[] = {index, static_cast<uint8_t>(arg >> 24), static_cast<uint8_t>(arg >> 16),
+                static_cast<uint8_t>(arg >> 8), static_cast<uint8_t>(arg)};
+            return Crc7Mmc::Calculate(command, sizeof(command)) << 1;
+        }
+
+        /**
+         * @brief Starts async blocks transfer
+         * 
+         * @param read Transfer direction
+         * @param buffer Data buffer
+         * @param logicalBlockAddress First block address
+         * @param blocksCount Blocks count
+         * @param callback Complete callback
+         * 
+         * @return true Transfer started (or done if callback is nullptr)
+         * @return false Fail
+         */
+        static bool StartBlocks(bool read, void* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount, BlocksCallback callback);
+
+        /**
+         * @brief Polls card for given state end (token or busy end)
+         * 
+         * @param token [out] Last read byte
+         * 
+         * @return true Wait is finished (token was read)
+         * @return false Wait is not finished yet
+         */
+        static bool Poll(uint8_t& token);
+
+        /**
+         * @brief Completes async transfer
+         * 
+         * @param success Transfer result
+         */
+        static void Complete(bool success);
+
+        /**
+         * @brief Processes pending block CRC (checks received block or calculates CRC of next block to write)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void ProcessCrc();
+
+        /**
+         * @brief DMA transfer complete handler
+         * 
+         * @param data Buffer
+         * @param size Size
+         * @param success Success flag
+         */
+        static void DmaHandler(void* data, unsigned size, bool success);
+
     public:
         /**
          * @brief Check card status
@@ -212,17 +382,19 @@ namespace Zhele::Drivers
                 _CsPin::Clear();
                 if(Spi.Ignore(10000u, 0xff) != 0xff)
                 {
+                    Counters::Add(Statistics::SdCardCounters::Errors);
                     return false;
                 }
 
                 Spi.Write(0xFE);
-                Spi.template Write<WriteIterator>(iter, 512);
-                Spi.ReadU16Be();
+                WriteDataBlock<WriteIterator>(iter);
                 uint8_t resp;
                 if((resp = Spi.Read() & 0x1F) != 0x05)
                 {
+                    Counters::Add(Statistics::SdCardCounters::Errors);
                     return false;
                 }
+                Counters::Add(Statistics::SdCardCounters::BlocksWritten);
                 _CsPin::Set();
                 Spi.Read();
                 return true;
@@ -258,7 +430,7 @@ namespace Zhele::Drivers
         /**
          * @brief Read multiple blocks from card
          * 
-         * @tparam ReadIterator Iterator type
+         * @tparam ReadIterator Iterator type (random access)
          * 
          * @param iter [in] Iterator
          * @param logicalBlockAddress [in] Block address
@@ -269,23 +441,284 @@ namespace Zhele::Drivers
          */
         template<typename ReadIterator>
         static bool ReadMultipleBlock(ReadIterator iter, uint32_t logicalBlockAddress, uint32_t blocksCount)
+        {
+            if(!StartMultipleBlockRead(logicalBlockAddress))
+                return false;
+
+            bool result = true;
+            for(uint32_t i = 0; i < blocksCount && result; ++i)
+            {
+                result = ReadNextBlock<ReadIterator>(iter + i * 512);
+            }
+            return StopMultipleBlockRead() && result;
+        }
+
+        /**
+         * @brief Write multiple blocks to card (CMD25)
+         * 
+         * @tparam WriteIterator Iterator type (random access)
+         * 
+         * @param iter [in] Iterator
+         * @param logicalBlockAddress [in] Block address
+         * @param [in] blocksCount Block to write count
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        template<typename WriteIterator>
+        static bool WriteMultipleBlock(WriteIterator iter, uint32_t logicalBlockAddress, uint32_t blocksCount)
+        {
+            if(!StartMultipleBlockWrite(logicalBlockAddress))
+                return false;
+
+            bool result = true;
+            for(uint32_t i = 0; i < blocksCount && result; ++i)
+            {
+                result = WriteNextBlock<WriteIterator>(iter + i * 512);
+            }
+            return StopMultipleBlockWrite() && result;
+        }
+
+        /**
+         * @brief Starts multiple blocks read (CMD18)
+         * 
+         * @details
+         * Blocks are read by @ref ReadNextBlock (to different buffers), read is stopped by @ref StopMultipleBlockRead.
+         * 
+         * @param logicalBlockAddress [in] First block address
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        static bool StartMultipleBlockRead(uint32_t logicalBlockAddress)
+        {
+            if(_type != SdhcCard)
+                logicalBlockAddress <<= 9;
+            if(!WaitWhileBusy())
+                return false;
+            return SpiCommand(SdCardCommand::ReadMultipleBlock, logicalBlockAddress) == 0;
+        }
+
+        /**
+         * @brief Reads next block of multiple blocks read
+         * 
+         * @tparam ReadIterator Iterator type
+         * 
+         * @param iter [in] Iterator
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        template<typename ReadIterator>
+        static bool ReadNextBlock(ReadIterator iter)
+        {
+            return ReadDataBlock<ReadIterator>(iter, 512);
+        }
+
+        /**
+         * @brief Stops multiple blocks read (CMD12)
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        static bool StopMultipleBlockRead()
+        {
+            // The byte after CMD12 is stuff byte, so R1 is not checked
+            SpiCommand(StopTransmission, 0);
+            bool ready = WaitWhileBusy();
+            _CsPin::Set();
+            return ready;
+        }
+
+        /**
+         * @brief Starts multiple blocks write (CMD25)
+         * 
+         * @details
+         * Blocks are written by @ref WriteNextBlock (from different buffers), write is stopped by @ref StopMultipleBlockWrite.
+         * 
+         * @param logicalBlockAddress [in] First block address
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        static bool StartMultipleBlockWrite(uint32_t logicalBlockAddress)
         {
             if(_type != SdhcCard)
                 logicalBlockAddress <<= 9;
             if(!WaitWhileBusy())
                 return false;
-            if(SpiCommand(SdCardCommand::ReadMultipleBlock, logicalBlockAddress) == 0)
+            return SpiCommand(SdCardCommand::WriteMultipleBlock, logicalBlockAddress) == 0;
+        }
+
+        /**
+         * @brief Writes next block of multiple blocks write
+         * 
+         * @tparam WriteIterator Iterator type
+         * 
+         * @param iter [in] Iterator
+         * 
+         * @return true Block is accepted
+         * @return false Fail
+         */
+        template<typename WriteIterator>
+        static bool WriteNextBlock(WriteIterator iter)
+        {
+            _CsPin::Clear();
+            if(Spi.Ignore(10000u, 0xff) != 0xff)
             {
-                ReadDataBlock<ReadIterator>(iter, 512 * blocksCount);
+                _CsPin::Set();
+                Counters::Add(Statistics::SdCardCounters::Errors);
+                return false;
             }
-            return false;
+
+            Spi.Write(0xFC);
+            WriteDataBlock<WriteIterator>(iter);
+            bool accepted = (Spi.Read() & 0x1F) == 0x05;
+            _CsPin::Set();
+            Counters::Add(accepted ? Statistics::SdCardCounters::BlocksWritten : Statistics::SdCardCounters::Errors);
+            return accepted;
+        }
+
+        /**
+         * @brief Stops multiple blocks write (stop token) and waits for programming end
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        static bool StopMultipleBlockWrite()
+        {
+            _CsPin::Clear();
+            bool ready = Spi.Ignore(10000u, 0xff) == 0xff;
+            Spi.Write(0xFD);
+            Spi.Read();
+            ready = Spi.Ignore(10000u, 0xff) == 0xff && ready;
+            _CsPin::Set();
+            return ready;
         }
+
+        /**
+         * @brief Reads blocks from card by DMA
+         * 
+         * @details
+         * Every block is received by SPI DMA (RX channel, dummy 0xFF is sent by TX channel without memory increment),
+         * start token and CRC of each block are handled separately. Several blocks are read by CMD18
+         * and read is terminated by CMD12. SPI module should have both DMA channels and their IRQ handlers should be enabled.
+         * If callback is given, method only starts transfer, it's continued by @ref Process calls (from main loop)
+         * and callback is called on finish. Without callback method is blocking.
+         * 
+         * @param [out] buffer Data buffer (blocksCount * 512 bytes)
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks count
+         * @param [in] callback Transfer complete callback (optional)
+         * 
+         * @return true Success (transfer is started for async mode)
+         * @return false Fail
+         */
+        static bool ReadBlocks(void* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount, BlocksCallback callback = nullptr)
+        {
+            return StartBlocks(true, buffer, logicalBlockAddress, blocksCount, callback);
+        }
+
+        /**
+         * @brief Writes blocks to card by DMA
+         * 
+         * @details
+         * Every block is sent by SPI DMA (TX channel), data token and data response of each block are handled separately.
+         * Several blocks are written by CMD25 after pre-erase request (ACMD23), write is terminated by stop token.
+         * Async mode is the same as for @ref ReadBlocks: it's continued by @ref Process calls, card programming
+         * does not block caller.
+         * 
+         * @par Example
+         * @code
+         *  void LogWritten(bool success) { ... }
+         *  ...
+         *  Card::WriteBlocks(logBuffer, lba, 4, LogWritten);
+         *  while (true)
+         *  {
+         *      Card::Process();
+         *      ...
+         *  }
+         * @endcode
+         * 
+         * @param [in] buffer Data buffer (blocksCount * 512 bytes)
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks count
+         * @param [in] callback Transfer complete callback (optional)
+         * 
+         * @return true Success (transfer is started for async mode)
+         * @return false Fail
+         */
+        static bool WriteBlocks(const void* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount, BlocksCallback callback = nullptr)
+        {
+            return StartBlocks(false, const_cast<void*>(buffer), logicalBlockAddress, blocksCount, callback);
+        }
+
+        /**
+         * @brief Continues async blocks transfer (call it periodically while @ref IsBusy)
+         * 
+         * @details
+         * Method does not wait for card: it polls a few bytes for token (or busy end)
+         * and starts DMA transfer of next block.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Process();
+
+        /**
+         * @brief Returns async transfer state
+         * 
+         * @retval true Transfer is in progress
+         * @retval false Card is free
+         */
+        static bool IsBusy()
+        {
+            return _asyncState != AsyncState::Idle;
+        }
+
+    private:
+        static volatile AsyncState _asyncState; ///< Async transfer state
+        static bool _asyncRead; ///< Async transfer direction
+        static bool _asyncResult; ///< Last async transfer result
+        static uint8_t* _asyncBuffer; ///< Current block buffer
+        static uint32_t _asyncBlocks; ///< Remaining blocks count
+        static bool _asyncMultiple; ///< Multiple blocks command was sent
+        static Deadline _asyncDeadline; ///< Token or busy end deadline
+        static BlocksCallback _asyncCallback; ///< Complete callback
+        static const uint8_t* _crcBlock; ///< Block, that waits CRC calculation (overlapped with next block transfer)
+        static uint16_t _crcValue; ///< Received CRC of _crcBlock (read) or CRC of block that is being sent (write)
+        static uint16_t _crcNext; ///< Calculated CRC of next block (write)
+        static bool _crcError; ///< CRC mismatch
     };
 
-    template<typename _SpiModule, typename _CsPin>
-    SdCardType SdCard<_SpiModule, _CsPin>::_type;
-    template<typename _SpiModule, typename _CsPin>        
-    BinaryStream<_SpiModule> SdCard<_SpiModule, _CsPin>::Spi;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    SdCardType SdCard<_SpiModule, _CsPin, _UseCrc>::_type;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    volatile typename SdCard<_SpiModule, _CsPin, _UseCrc>::AsyncState SdCard<_SpiModule, _CsPin, _UseCrc>::_asyncState = SdCard<_SpiModule, _CsPin, _UseCrc>::AsyncState::Idle;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    bool SdCard<_SpiModule, _CsPin, _UseCrc>::_asyncRead = false;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    bool SdCard<_SpiModule, _CsPin, _UseCrc>::_asyncResult = false;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    uint8_t* SdCard<_SpiModule, _CsPin, _UseCrc>::_asyncBuffer = nullptr;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    uint32_t SdCard<_SpiModule, _CsPin, _UseCrc>::_asyncBlocks = 0;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    bool SdCard<_SpiModule, _CsPin, _UseCrc>::_asyncMultiple = false;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    Deadline SdCard<_SpiModule, _CsPin, _UseCrc>::_asyncDeadline{0};
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    typename SdCard<_SpiModule, _CsPin, _UseCrc>::BlocksCallback SdCard<_SpiModule, _CsPin, _UseCrc>::_asyncCallback = nullptr;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    const uint8_t* SdCard<_SpiModule, _CsPin, _UseCrc>::_crcBlock = nullptr;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    uint16_t SdCard<_SpiModule, _CsPin, _UseCrc>::_crcValue = 0;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    uint16_t SdCard<_SpiModule, _CsPin, _UseCrc>::_crcNext = 0;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>
+    bool SdCard<_SpiModule, _CsPin, _UseCrc>::_crcError = false;
+    template<typename _SpiModule, typename _CsPin, bool _UseCrc>        
+    BinaryStream<_SpiModule> SdCard<_SpiModule, _CsPin, _UseCrc>::Spi;
 } // namespace Zhele::Drivers
 
 #include "impl/sdcard.h"
@@ -0,0 +1,233 @@
+/**
+ * @file
+ * Implements USB MSC logical unit backed by SD card
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_SDCARD_MSC_H
+#define ZHELE_DRIVERS_SDCARD_MSC_H
+
+#include <zhele/usb.h>
+
+#include "sdcard.h"
+
+#include <cstdint>
+#include <type_traits>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief SCSI logical unit backed by SD card with block cache
+     *
+     * @details
+     * SD card driver is blocking, so USB handlers (called from USB interrupt) work with cache only
+     * and all card transfers are performed by @ref Process method from main loop:
+     *  - Read (10): cached blocks are sent immediately. Process reads missing block and next _ReadAhead blocks
+     *    by one multiple blocks read (CMD18), so card is read while previous block is being sent to host.
+     *    Read-ahead is continued after transfer if the host reads sequentially.
+     *  - Write (10): data is copied to cache blocks (write-back), CSW is sent after all data is received.
+     *    Process writes consecutive dirty blocks by one multiple blocks write (CMD25).
+     *    OUT endpoint is NAKed while cache has no room for next packets.
+     * Call @ref Flush before card removal or power off to write dirty blocks.
+     *
+     * @par Example
+     * @code
+     *  using Card = Drivers::SdCard<Spi1, IO::Pa4>;
+     *  using Lun0 = Drivers::SdCardScsiLun<Card, MscOutEp>;
+     *  using Scsi = ScsiBulkInterface<0, 0, Ep0, MscOutEp, MscInEp, Lun0>;
+     *  ...
+     *  Lun0::Init();
+     *  MyDevice::Enable();
+     *  for(;;)
+     *  {
+     *      Lun0::Process();
+     *  }
+     * @endcode
+     *
+     * @tparam _SdCard SD card (@ref SdCard, must be initialized)
+     * @tparam _OutEp MSC OUT endpoint
+     * @tparam _CacheBlocks Cache size (in blocks), at least _ReadAhead + 2
+     * @tparam _ReadAhead Read-ahead depth (in blocks)
+     */
+    template<typename _SdCard, typename _OutEp, unsigned _CacheBlocks = 4, unsigned _ReadAhead = 2>
+    class SdCardScsiLun : public Usb::ScsiLunBase
+    {
+        static_assert(_CacheBlocks >= _ReadAhead + 2, "Cache must contain read-ahead blocks, block that is being sent and block for write");
+        static_assert(_CacheBlocks < 0xff, "Cache is too big");
+        static_assert(512 % _OutEp::MaxPacketSize == 0, "OUT packets must not cross cache blocks");
+
+        static const uint32_t BlockSize = 512;
+        static const uint32_t NoBlock = 0xffffffff;
+        static const uint8_t NoIndex = 0xff;
+
+        /// Cache block state
+        enum class BlockState : uint8_t
+        {
+            Free, ///< Block is not used
+            Loading, ///< Block is being read from card
+            Valid, ///< Block is equal to card data
+            Filling, ///< Block is being received from host
+            Dirty, ///< Block is received, but is not written to card
+            Flushing ///< Block is being written to card
+        };
+
+        /// Cache block
+        struct Block
+        {
+            alignas(4) uint8_t Data[BlockSize]; ///< Data
+            uint32_t Lba; ///< Block address
+            uint32_t LastUse; ///< Last use tick (for LRU replacement)
+            volatile BlockState State; ///< State
+            volatile bool Stale; ///< Block is replaced by newer data during card transfer
+        };
+    public:
+        /**
+         * @brief Inits LUN (reads card capacity)
+         *
+         * @retval true Success
+         * @retval false Card is not ready
+         */
+        static bool Init();
+
+        /**
+         * @brief Returns LBA size
+         *
+         * @returns LBA size (in bytes)
+         */
+        static uint32_t GetLbaSize()
+        {
+            return BlockSize;
+        }
+
+        /**
+         * @brief Returns LBA count
+         *
+         * @returns LBA count
+         */
+        static uint32_t GetLbaCount()
+        {
+            return _lbaCount;
+        }
+
+        /**
+         * @brief Read (10) command handler
+         *
+         * @tparam _InEp IN endpoint
+         *
+         * @param startLba Start LBA
+         * @param lbaCount LBA count
+         * @param callback Transfer complete callback for call
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _InEp>
+        static void Read10Handler(uint32_t startLba, uint32_t lbaCount, Usb::InTransferCallback callback);
+
+        /**
+         * @brief Write (10) command handler
+         *
+         * @param startLba Start LBA
+         * @param lbaCount LBA count
+         *
+         * @retval true Wait for next packet
+         * @retval false OUT transfer complete
+         */
+        static bool Write10Handler(uint32_t startLba, uint32_t lbaCount);
+
+        /**
+         * @brief LUN rx handler
+         *
+         * @param data Data
+         * @param size Data size
+         *
+         * @return true Waiting for next packet (transfer does not complete)
+         * @return false Transfer complete
+         */
+        static bool RxHandler(void* data, uint16_t size);
+
+        /**
+         * @brief Performs card transfers (call it from main loop)
+         *
+         * @details
+         * Method reads blocks for current read request (and read-ahead blocks)
+         * and writes dirty blocks to card.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Process();
+
+        /**
+         * @brief Writes all dirty blocks to card
+         *
+         * @retval true Success
+         * @retval false Write error
+         */
+        static bool Flush();
+
+        /**
+         * @brief Returns card error flag
+         *
+         * @details
+         * Failed read sends zeroes to host, failed write drops data, so error is reported by this flag
+         * (it is cleared by @ref Init).
+         *
+         * @retval true There was card read/write error
+         * @retval false There were no errors
+         */
+        static bool Failed()
+        {
+            return _failed;
+        }
+
+    private:
+        template<typename _InEp>
+        static void SendBlock(uint8_t index);
+
+        template<typename _InEp>
+        static void BlockSent();
+
+        static void TrySend();
+        static int FindBlock(uint32_t lba);
+        static int AllocateBlock(uint32_t keepFrom, uint32_t keepTo);
+        static uint8_t AcquireBlock(uint32_t lba);
+        static unsigned FreeBytes();
+        static uint32_t RxReserve();
+        static void Touch(Block& block);
+        static void CompleteLoad(uint8_t index, bool success);
+        static void CompleteFlush(uint8_t index, bool success);
+
+        static bool LoadBlocks(uint32_t from, uint32_t to);
+        static bool FlushRun();
+        static void ResumeRx();
+
+        static Block _blocks[_CacheBlocks];
+        static uint32_t _lbaCount;
+        static uint32_t _tick;
+        static volatile bool _failed;
+
+        // Read request
+        static volatile uint32_t _readLba;
+        static volatile uint32_t _readRemain;
+        static volatile bool _readWaiting;
+        static volatile bool _readAhead;
+        static volatile uint8_t _sending;
+        static Usb::InTransferCallback _readCallback;
+        static std::add_pointer_t<void(uint8_t)> _sendBlock;
+
+        // Write request
+        static volatile uint32_t _writeLba;
+        static volatile uint32_t _writeRemain;
+        static volatile uint8_t _filling;
+        static volatile uint16_t _fillOffset;
+        static volatile bool _rxStalled;
+    };
+}
+
+#include "impl/sdcard_msc.h"
+
+#endif //! ZHELE_DRIVERS_SDCARD_MSC_H
@@ -0,0 +1,351 @@
+/**
+ * @file
+ * Driver for SD card on SDIO bus (4-bit mode, DMA)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_SDIO_CARD_H
+#define ZHELE_DRIVERS_SDIO_CARD_H
+
+#include <zhele/clock.h>
+#include <zhele/dma.h>
+#include <zhele/iopins.h>
+#include <zhele/pinlist.h>
+#include <zhele/system_time.h>
+
+#include "sdcard.h"
+
+#include <stdint.h>
+#include <type_traits>
+
+#if defined (SDIO)
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Implements SD card on SDIO bus
+     *
+     * @details
+     * Card is used in 4-bit mode. Card identification runs at 400 kHz, data transfer runs at
+     * kernel clock / 2 (24 MHz, default speed) or at kernel clock (48 MHz) if card supports high-speed mode.
+     * Blocks are transferred by DMA stream in FIFO mode with bursts of 4 words and peripheral flow control,
+     * so buffers must be 4-bytes aligned. Multiple blocks are read by CMD18 and written by CMD25
+     * (after pre-erase request ACMD23), both are terminated by CMD12.
+     * If card programs previous block, next transfer waits for it (by CMD13) before start.
+     * Blocks interface is the same as for @ref SdCard.
+     *
+     * SDIO hardware flow control is not used (it's affected by errata on F4), DMA keeps FIFO
+     * from overrun/underrun at full SDIO clock.
+     *
+     * For async transfers (@ref ReadBlocks/@ref WriteBlocks with callback) call @ref IrqHandler from SDIO_IRQHandler.
+     *
+     * @par Example
+     * @code
+     *  using Card = Drivers::SdioCard<>;
+     *  alignas(4) static uint8_t buffer[4 * 512];
+     *  ...
+     *  if (Card::Detect() != Drivers::SdCardNone)
+     *      Card::ReadMultipleBlock(buffer, 0, 4);
+     *  ...
+     *  extern "C" void SDIO_IRQHandler()
+     *  {
+     *      Card::IrqHandler();
+     *  }
+     * @endcode
+     *
+     * @tparam _Dma DMA stream (with channel) for SDIO
+     * @tparam _KernelClock SDIO kernel clock (PLL 48 MHz output) frequency
+     */
+    template<typename _Dma = Dma2Stream3Channel4, uint32_t _KernelClock = 48000000>
+    class SdioCard
+    {
+        static const uint32_t InitFrequency = 400000; ///< Max bus clock during card identification
+        static const uint32_t CommandTimeout = 100000; ///< Command response timeout (in status polls)
+        static const uint32_t ReadyTimeout = 1000000; ///< Card ready (programming end) timeout (in status polls)
+        static const uint32_t DataTimeout = 0x00ffffff; ///< Data timeout (in bus clock cycles)
+        static const uint32_t BlockSize512 = 9 << SDIO_DCTRL_DBLOCKSIZE_Pos; ///< Block size field for 512 bytes
+        static const uint32_t BlockSize64 = 6 << SDIO_DCTRL_DBLOCKSIZE_Pos; ///< Block size field for 64 bytes
+
+        static const uint32_t DataErrors = SDIO_STA_DCRCFAIL | SDIO_STA_DTIMEOUT | SDIO_STA_TXUNDERR | SDIO_STA_RXOVERR | SDIO_STA_STBITERR;
+        static const uint32_t StaticFlags = 0x000005ff; ///< All static (clearable) flags
+        static const uint32_t CardStatusErrors = 0xfdffe008; ///< Error bits of card status (R1)
+
+        static_assert(_KernelClock / InitFrequency - 2 <= 0xff, "Kernel clock is too high for identification clock");
+
+        /// SD bus specific commands (common commands are in @ref SdCardCommand)
+        enum BusCommand : uint8_t
+        {
+            AllSendCid = 2, ///< Ask card CID
+            SendRelativeAddress = 3, ///< Ask card relative address
+            SwitchFunction = 6, ///< Switch card function (CMD6) or set bus width (ACMD6)
+            SelectCard = 7 ///< Select card
+        };
+
+        /// Command response type
+        enum class Response : uint8_t
+        {
+            None, ///< No response
+            R1, ///< Card status
+            R2, ///< CID or CSD (long response)
+            R3, ///< OCR (without CRC)
+            R6, ///< Relative address
+            R7 ///< Interface condition
+        };
+
+    public:
+        /// Async blocks transfer complete callback
+        using BlocksCallback = std::add_pointer_t<void(bool success)>;
+
+        /**
+         * @brief Inits SDIO and detects card
+         *
+         * @details
+         * Configures pins (PC8-PC12, PD2), powers SDIO, identifies card, switches it to 4-bit bus
+         * and high-speed mode (if it's supported).
+         *
+         * @returns Card type (SdCardNone on error or for MMC card)
+         */
+        static SdCardType Detect();
+
+        /**
+         * @brief Returns card's blocks count
+         *
+         * @return uint32_t Blocks count
+         */
+        static uint32_t BlocksCount()
+        {
+            return _blocksCount;
+        }
+
+        /**
+         * @brief Returns card's block size
+         *
+         * @return size_t Block size
+         */
+        static size_t BlockSize()
+        {
+            return 512;
+        }
+
+        /**
+         * @brief Returns high-speed mode flag
+         *
+         * @retval true Bus clock is kernel clock (48 MHz)
+         * @retval false Bus clock is half of kernel clock
+         */
+        static bool HighSpeed()
+        {
+            return _highSpeed;
+        }
+
+        /**
+         * @brief Reads block from card
+         *
+         * @param [out] buffer Buffer (512 bytes, 4-bytes aligned)
+         * @param [in] logicalBlockAddress Block address
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool ReadBlock(void* buffer, uint32_t logicalBlockAddress)
+        {
+            return ReadBlocks(buffer, logicalBlockAddress, 1);
+        }
+
+        /**
+         * @brief Writes block to card
+         *
+         * @param [in] buffer Buffer (512 bytes, 4-bytes aligned)
+         * @param [in] logicalBlockAddress Block address
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool WriteBlock(const void* buffer, uint32_t logicalBlockAddress)
+        {
+            return WriteBlocks(buffer, logicalBlockAddress, 1);
+        }
+
+        /**
+         * @brief Reads multiple blocks from card
+         *
+         * @param [out] buffer Buffer (blocksCount * 512 bytes, 4-bytes aligned)
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks count
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool ReadMultipleBlock(void* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount)
+        {
+            return ReadBlocks(buffer, logicalBlockAddress, blocksCount);
+        }
+
+        /**
+         * @brief Writes multiple blocks to card
+         *
+         * @param [in] buffer Buffer (blocksCount * 512 bytes, 4-bytes aligned)
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks count
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool WriteMultipleBlock(const void* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount)
+        {
+            return WriteBlocks(buffer, logicalBlockAddress, blocksCount);
+        }
+
+        /**
+         * @brief Reads blocks from card by DMA
+         *
+         * @details
+         * Without callback method is blocking, otherwise it only starts transfer and
+         * callback is called from @ref IrqHandler.
+         *
+         * @param [out] buffer Buffer (blocksCount * 512 bytes, 4-bytes aligned)
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks count
+         * @param [in] callback Transfer complete callback (optional)
+         *
+         * @return true Success (transfer is started for async mode)
+         * @return false Fail
+         */
+        static bool ReadBlocks(void* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount, BlocksCallback callback = nullptr)
+        {
+            return StartTransfer(true, buffer, logicalBlockAddress, blocksCount, callback);
+        }
+
+        /**
+         * @brief Writes blocks to card by DMA
+         *
+         * @details
+         * Without callback method is blocking (it returns after last block is received by card,
+         * card programming is waited by next transfer), otherwise it only starts transfer and
+         * callback is called from @ref IrqHandler.
+         *
+         * @param [in] buffer Buffer (blocksCount * 512 bytes, 4-bytes aligned)
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks count
+         * @param [in] callback Transfer complete callback (optional)
+         *
+         * @return true Success (transfer is started for async mode)
+         * @return false Fail
+         */
+        static bool WriteBlocks(const void* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount, BlocksCallback callback = nullptr)
+        {
+            return StartTransfer(false, const_cast<void*>(buffer), logicalBlockAddress, blocksCount, callback);
+        }
+
+        /**
+         * @brief Returns async transfer state
+         *
+         * @retval true Transfer is in progress
+         * @retval false Card is free
+         */
+        static bool IsBusy()
+        {
+            return _busy;
+        }
+
+        /**
+         * @brief SDIO interrupt handler (call it from SDIO_IRQHandler)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        /**
+         * @brief Sends command and waits for response
+         *
+         * @param [in] index Command index
+         * @param [in] arg Argument
+         * @param [in] response Response type
+         *
+         * @return true Success (for R1 card status has no errors)
+         * @return false Fail
+         */
+        static bool SendCommand(uint8_t index, uint32_t arg, Response response);
+
+        /**
+         * @brief Sends application specific command (CMD55 + ACMD)
+         *
+         * @param [in] index Command index
+         * @param [in] arg Argument
+         * @param [in] response Response type
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool SendAppCommand(uint8_t index, uint32_t arg, Response response);
+
+        /**
+         * @brief Waits while card is ready for data (transfer state)
+         *
+         * @return true Card is ready
+         * @return false Timeout or error
+         */
+        static bool WaitReady();
+
+        /**
+         * @brief Switches card to high-speed mode (CMD6)
+         *
+         * @return true Card is in high-speed mode
+         * @return false Card does not support high-speed mode
+         */
+        static bool SwitchHighSpeed();
+
+        /**
+         * @brief Starts blocks transfer
+         *
+         * @param [in] read Transfer direction
+         * @param [in] buffer Buffer
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks count
+         * @param [in] callback Complete callback
+         *
+         * @return true Success (transfer is started for async mode)
+         * @return false Fail
+         */
+        static bool StartTransfer(bool read, void* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount, BlocksCallback callback);
+
+        /**
+         * @brief Completes blocks transfer (stops multiple blocks transfer)
+         *
+         * @param [in] status SDIO status
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool CompleteTransfer(uint32_t status);
+
+        /**
+         * @brief Sets bus clock
+         *
+         * @param [in] clkcr Clock divider and bypass bits
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetClock(uint32_t clkcr);
+
+        static SdCardType _type; ///< Card type
+        static uint32_t _rca; ///< Card relative address (shifted to argument position)
+        static uint32_t _blocksCount; ///< Card blocks count
+        static bool _highSpeed; ///< High-speed mode flag
+        static volatile bool _busy; ///< Async transfer flag
+        static bool _multiple; ///< Current transfer is multiple blocks transfer
+        static BlocksCallback _callback; ///< Async transfer callback
+    };
+} // namespace Zhele::Drivers
+
+#include "impl/sdio_card.h"
+
+#endif //! SDIO
+
+#endif //! ZHELE_DRIVERS_SDIO_CARD_H
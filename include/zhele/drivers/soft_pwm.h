@@ -0,0 +1,237 @@
+/**
+ * @file
+ * Implements DMA-driven multi-channel software PWM
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_SOFT_PWM_H
+#define ZHELE_DRIVERS_SOFT_PWM_H
+
+#include <zhele/dma.h>
+#include <zhele/pinlist.h>
+#include <zhele/timer.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Class for software PWM on GPIO pins
+     *
+     * @details
+     * One PWM period is table of _Resolution BSRR words: slot 0 sets outputs of channels with non-zero duty,
+     * slot d resets output of channel with duty d (other slots are zero, so they don't change port).
+     * Table is streamed to GPIO BSRR by circular DMA on timer update event, so outputs are switched without CPU.
+     * Buffer holds two tables (double buffered), duty change is applied to the table that DMA has just completed
+     * (DMA interrupt patches only slots of changed channels), so output never has partially updated period.
+     * New duty takes effect in one or two PWM periods.
+     * All pins must be on one port, use several instances (with own timer and DMA) for more channels.
+     *
+     * @note DMA must have access to GPIO (on stm32f4 only DMA2 does, so use TIM1/TIM8 requests).
+     *
+     * @par Example
+     * @code
+     *  using Leds = IO::PinList<IO::Pb0, IO::Pb1, IO::Pb10, IO::Pb11, IO::Pb12, IO::Pb13, IO::Pb14, IO::Pb15>;
+     *  using Pwm = Drivers::SoftPwm<Leds, Timers::Timer2, Dma1Channel2>;
+     *  Pwm::Init(200);
+     *  Pwm::SetDuty(0, 128);
+     *  Pwm::Start();
+     * @endcode
+     *
+     * @tparam _Pins Channels pins (pinlist, all pins must be on one port)
+     * @tparam _Timer Timer that paces slots
+     * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+     * @tparam _Resolution Slots count in PWM period (duty is 0.._Resolution)
+     */
+    template <typename _Pins, typename _Timer, typename _DmaChannel, unsigned _Resolution = 256>
+    class SoftPwm
+    {
+        using Port = typename _Pins::template Pin<0>::Port;
+
+        static const uint32_t PortMask = _Pins::template PortMask<Port>();
+
+        static_assert(std::popcount(PortMask) == _Pins::Length, "All pins must be on one port");
+        static_assert(_Resolution >= 2 && _Resolution <= UINT16_MAX, "Resolution is out of range");
+    public:
+        /// Channels count
+        static const unsigned Channels = _Pins::Length;
+
+        /// Duty of fully on channel
+        static const uint16_t Resolution = _Resolution;
+
+        /**
+         * @brief Init timer and pins
+         *
+         * @param [in] frequency PWM frequency (timer update rate is frequency * _Resolution)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint32_t frequency)
+        {
+            _Pins::Enable();
+            _Pins::Write(0);
+            _Pins::template SetConfiguration<_Pins::Out>();
+            _Pins::template SetDriverType<_Pins::PushPull>();
+
+            _Timer::Enable();
+            _Timer::Stop();
+            _Timer::SetPrescaler(0);
+            _Timer::SetPeriod(_Timer::GetClockFreq() / (frequency * _Resolution) - 1);
+        }
+
+        /**
+         * @brief Builds tables from current duties and starts PWM
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start()
+        {
+            for (unsigned half = 0; half < 2; ++half)
+            {
+                uint32_t* table = _buffer + half * _Resolution;
+                std::fill(table, table + _Resolution, 0);
+                for (unsigned channel = 0; channel < Channels; ++channel)
+                {
+                    _applied[half][channel] = _duty[channel];
+                    Place(table, channel, _duty[channel]);
+                }
+                _dirty[half] = 0;
+            }
+
+            _DmaChannel::SetDoubleBufferedTransferCallback(BlockHandler);
+            _DmaChannel::TransferDoubleBuffered(_DmaChannel::Mem2Periph | _DmaChannel::MemIncrement | _DmaChannel::PriorityHigh
+                                            | _DmaChannel::PSize32Bits | _DmaChannel::MSize32Bits,
+                                            _buffer, _buffer + _Resolution, Port::BitSetResetRegister(), _Resolution);
+
+            _Timer::ResetCounterValue();
+            _Timer::DmaRequestEnable();
+            _Timer::Start();
+        }
+
+        /**
+         * @brief Stops PWM, outputs go low
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop()
+        {
+            _Timer::Stop();
+            _Timer::DmaRequestDisable();
+            _DmaChannel::Disable();
+            _Pins::Write(0);
+        }
+
+        /**
+         * @brief Set channel duty
+         *
+         * @details
+         * Method is safe to call at any time (from interrupts too), it only marks channel as changed.
+         *
+         * @param [in] channel Channel index (pin index in pinlist)
+         * @param [in] duty Duty (0.._Resolution, greater value is fully on)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetDuty(unsigned channel, uint16_t duty)
+        {
+            if (channel >= Channels)
+                return;
+
+            _duty[channel] = std::min<uint16_t>(duty, _Resolution);
+            AtomicSetBits(_dirty[0], 1u << channel);
+            AtomicSetBits(_dirty[1], 1u << channel);
+        }
+
+        /**
+         * @brief Returns channel duty
+         *
+         * @param [in] channel Channel index
+         *
+         * @returns Duty (last set value, it may be not applied yet)
+         */
+        static uint16_t GetDuty(unsigned channel)
+        {
+            return channel < Channels ? _duty[channel] : 0;
+        }
+
+    private:
+        static constexpr uint32_t ChannelMask(unsigned channel)
+        {
+            return _Pins::template PortValue<Port>(static_cast<typename _Pins::DataType>(1u << channel));
+        }
+
+        static void Place(uint32_t* table, unsigned channel, uint16_t duty)
+        {
+            const uint32_t mask = ChannelMask(channel);
+            if (duty == 0)
+            {
+                table[0] |= mask << 16;
+                return;
+            }
+
+            table[0] |= mask;
+            if (duty < _Resolution)
+                table[duty] |= mask << 16;
+        }
+
+        static void Remove(uint32_t* table, unsigned channel, uint16_t duty)
+        {
+            const uint32_t mask = ChannelMask(channel);
+            table[0] &= ~(mask | (mask << 16));
+            if (duty > 0 && duty < _Resolution)
+                table[duty] &= ~(mask << 16);
+        }
+
+        static void BlockHandler(void* data, unsigned, unsigned bufferIndex)
+        {
+            uint32_t dirty = _dirty[bufferIndex];
+            if (dirty == 0)
+                return;
+            AtomicClearBits(_dirty[bufferIndex], dirty);
+
+            // Completed table is idle during the whole next period
+            uint32_t* table = static_cast<uint32_t*>(data);
+            while (dirty != 0)
+            {
+                const unsigned channel = std::countr_zero(dirty);
+                dirty &= dirty - 1;
+
+                const uint16_t duty = _duty[channel];
+                Remove(table, channel, _applied[bufferIndex][channel]);
+                Place(table, channel, duty);
+                _applied[bufferIndex][channel] = duty;
+            }
+        }
+
+        static uint32_t _buffer[2 * _Resolution];
+        static volatile uint16_t _duty[Channels];
+        static uint16_t _applied[2][Channels];
+        static volatile uint32_t _dirty[2];
+    };
+
+    #define SOFT_PWM_TEMPLATE_ARGS template <typename _Pins, typename _Timer, typename _DmaChannel, unsigned _Resolution>
+    #define SOFT_PWM_TEMPLATE_QUALIFIER SoftPwm<_Pins, _Timer, _DmaChannel, _Resolution>
+
+    SOFT_PWM_TEMPLATE_ARGS
+    uint32_t SOFT_PWM_TEMPLATE_QUALIFIER::_buffer[2 * _Resolution];
+
+    SOFT_PWM_TEMPLATE_ARGS
+    volatile uint16_t SOFT_PWM_TEMPLATE_QUALIFIER::_duty[Channels];
+
+    SOFT_PWM_TEMPLATE_ARGS
+    uint16_t SOFT_PWM_TEMPLATE_QUALIFIER::_applied[2][Channels];
+
+    SOFT_PWM_TEMPLATE_ARGS
+    volatile uint32_t SOFT_PWM_TEMPLATE_QUALIFIER::_dirty[2];
+}
+
+#endif //! ZHELE_DRIVERS_SOFT_PWM_H
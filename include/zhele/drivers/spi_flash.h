@@ -0,0 +1,338 @@
+/**
+ * @file
+ * Driver for SPI NOR flash (W25Qxx and compatible)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_SPI_FLASH_H
+#define ZHELE_DRIVERS_SPI_FLASH_H
+
+#include <zhele/delay.h>
+#include <zhele/spi.h>
+
+#include <bit>
+#include <stdint.h>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Implements SPI NOR flash (W25Qxx, GD25Qxx, MX25Lxx and compatible, up to 16 MB)
+     *
+     * @details
+     * Data is read by fast read command (0x0B), bulk transfers use SPI DMA (see Spi::Transfer).
+     * Page program doesn't wait for completion: write in progress bit is polled before next command only,
+     * so caller prepares next data while flash is programming. @ref Erase selects largest block
+     * (64K, 32K or 4K) for every part of range.
+     *
+     * Driver has block device interface (512 bytes blocks) for @ref Fat32 and @ref SdCardScsiLun.
+     * Block write reprograms 4K sector in RAM buffer (4 KB of RAM is allocated only if block write is used):
+     * sector is erased only if new data sets bits, consecutive blocks of multiple block write
+     * are merged into one erase-program cycle.
+     *
+     * SPI must be initialized (mode 0 or 3, 8-bit data), chip select pin is configured by @ref Init.
+     *
+     * @par Example
+     * @code
+     *  using Flash = Drivers::SpiFlash<Spi1, IO::Pa4, 8 * 1024 * 1024>;
+     *  Spi1::Init(Spi1::Fastest, Spi1::Master);
+     *  Spi1::SelectPins<IO::Pa7, IO::Pa6, IO::Pa5, IO::NullPin>();
+     *  if (Flash::Init())
+     *  {
+     *      Flash::Read(0, buffer, sizeof(buffer));
+     *      Flash::Erase(0x10000, 0x20000);
+     *      Flash::Write(0x10000, data, dataSize);
+     *  }
+     *  using Fs = Drivers::Fat32<Flash>;
+     * @endcode
+     *
+     * @tparam _Spi SPI
+     * @tparam _CsPin Chip select pin
+     * @tparam _Size Flash size (power of 2)
+     */
+    template<typename _Spi, typename _CsPin, uint32_t _Size>
+    class SpiFlash
+    {
+        static_assert(std::has_single_bit(_Size), "Flash size must be power of 2");
+        static_assert(_Size >= 64 * 1024 && _Size <= 16 * 1024 * 1024, "Only 24-bit address is supported");
+
+        static constexpr uint32_t ProgramPageSize = 256;
+        static constexpr uint32_t BlockSizeValue = 512;
+        static constexpr uint32_t BlocksPerSector = 4096 / BlockSizeValue;
+
+        enum Command : uint8_t
+        {
+            WriteEnable = 0x06,
+            ReadStatus1 = 0x05,
+            FastRead = 0x0b,
+            PageProgram = 0x02,
+            SectorErase = 0x20,
+            Block32Erase = 0x52,
+            Block64Erase = 0xd8,
+            ChipErase = 0xc7,
+            PowerDown = 0xb9,
+            ReleasePowerDown = 0xab,
+            ReadId = 0x9f,
+        };
+
+        static constexpr uint8_t StatusBusy = 0x01;
+        static constexpr uint32_t NoSector = 0xffffffff;
+        static constexpr uint32_t MaxTransferSize = 0x8000;
+
+    public:
+        /// Erase sector size
+        static constexpr uint32_t SectorSize = 4096;
+
+        /**
+         * @brief Initializes chip select pin, wakes flash up and checks it responds
+         *
+         * @retval true Flash is found
+         * @retval false Flash does not respond
+         */
+        static bool Init();
+
+        /**
+         * @brief Reads JEDEC identifier
+         *
+         * @returns Manufacturer (high byte), memory type and capacity
+         */
+        static uint32_t JedecId();
+
+        /**
+         * @brief Reads data (blocking, by DMA for long data)
+         *
+         * @param [in] offset Offset in flash
+         * @param [out] data Data buffer
+         * @param [in] size Data size
+         *
+         * @retval true Data is read
+         * @retval false Range is out of flash
+         */
+        static bool Read(uint32_t offset, void* data, uint32_t size);
+
+        /**
+         * @brief Reads data by DMA
+         *
+         * @details
+         * Chip select is released in DMA interrupt before callback is called.
+         * Don't call other methods until callback.
+         *
+         * @param [in] offset Offset in flash
+         * @param [out] data Data buffer
+         * @param [in] size Data size (up to 65535 bytes)
+         * @param [in] callback Completion callback
+         *
+         * @retval true Read is started
+         * @retval false Range is out of flash
+         */
+        static bool ReadAsync(uint32_t offset, void* data, uint16_t size, TransferCallback callback = nullptr);
+
+        /**
+         * @brief Writes data to erased area
+         *
+         * @details
+         * Data is split by 256-byte program pages. Method returns while last page is programming.
+         *
+         * @param [in] offset Offset in flash
+         * @param [in] data Data to write
+         * @param [in] size Data size
+         *
+         * @retval true Write is done (or last page is programming)
+         * @retval false Range is out of flash
+         */
+        static bool Write(uint32_t offset, const void* data, uint32_t size);
+
+        /**
+         * @brief Erases range
+         *
+         * @details
+         * Range is extended to 4K sectors, every part is erased by largest fitting aligned block
+         * (64K, 32K or 4K), whole flash is erased by chip erase command.
+         *
+         * @param [in] offset Range start
+         * @param [in] size Range size
+         *
+         * @retval true Erase is done (or last block is erasing)
+         * @retval false Range is out of flash
+         */
+        static bool Erase(uint32_t offset, uint32_t size);
+
+        /**
+         * @brief Waits for program or erase completion
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void WaitReady();
+
+        /**
+         * @brief Returns flash is programming or erasing
+         *
+         * @retval true Flash is busy
+         * @retval false Flash is ready
+         */
+        static bool Busy();
+
+        /**
+         * @brief Enters deep power-down mode (after current operation completes)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Sleep();
+
+        /**
+         * @brief Leaves deep power-down mode
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Wake();
+
+        /**
+         * @brief Returns total flash size
+         *
+         * @returns Flash size in bytes
+         */
+        static constexpr uint32_t FlashSize() { return _Size; }
+
+        /**
+         * @brief Returns blocks count
+         *
+         * @returns Blocks count
+         */
+        static constexpr uint32_t BlocksCount() { return _Size / BlockSizeValue; }
+
+        /**
+         * @brief Returns block size
+         *
+         * @returns Block size (512)
+         */
+        static constexpr size_t BlockSize() { return BlockSizeValue; }
+
+        /**
+         * @brief Reads block
+         *
+         * @param [out] buffer Output buffer (512 bytes)
+         * @param [in] logicalBlockAddress Block address
+         *
+         * @retval true Block is read
+         * @retval false Address is out of flash
+         */
+        static bool ReadBlock(uint8_t* buffer, uint32_t logicalBlockAddress);
+
+        /**
+         * @brief Writes block (erases and reprograms sector if needed)
+         *
+         * @param [in] buffer Block data (512 bytes)
+         * @param [in] logicalBlockAddress Block address
+         *
+         * @retval true Block is written
+         * @retval false Address is out of flash
+         */
+        static bool WriteBlock(const uint8_t* buffer, uint32_t logicalBlockAddress);
+
+        /**
+         * @brief Reads blocks
+         *
+         * @param [out] buffer Output buffer
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks count
+         *
+         * @retval true Blocks are read
+         * @retval false Range is out of flash
+         */
+        static bool ReadMultipleBlock(uint8_t* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount);
+
+        /**
+         * @brief Writes blocks
+         *
+         * @param [in] buffer Blocks data
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks count
+         *
+         * @retval true Blocks are written
+         * @retval false Range is out of flash
+         */
+        static bool WriteMultipleBlock(const uint8_t* buffer, uint32_t logicalBlockAddress, uint32_t blocksCount);
+
+        /**
+         * @brief Starts multiple blocks read
+         *
+         * @param [in] logicalBlockAddress First block address
+         *
+         * @retval true Read is started
+         * @retval false Address is out of flash
+         */
+        static bool StartMultipleBlockRead(uint32_t logicalBlockAddress);
+
+        /**
+         * @brief Reads next block
+         *
+         * @param [out] buffer Output buffer (512 bytes)
+         *
+         * @retval true Block is read
+         * @retval false End of flash
+         */
+        static bool ReadNextBlock(uint8_t* buffer);
+
+        /**
+         * @brief Stops multiple blocks read
+         *
+         * @retval true Always
+         */
+        static bool StopMultipleBlockRead();
+
+        /**
+         * @brief Starts multiple blocks write
+         *
+         * @param [in] logicalBlockAddress First block address
+         *
+         * @retval true Write is started
+         * @retval false Address is out of flash
+         */
+        static bool StartMultipleBlockWrite(uint32_t logicalBlockAddress);
+
+        /**
+         * @brief Writes next block (sector is programmed when all its blocks are written or on stop)
+         *
+         * @param [in] buffer Block data (512 bytes)
+         *
+         * @retval true Block is written
+         * @retval false End of flash
+         */
+        static bool WriteNextBlock(const uint8_t* buffer);
+
+        /**
+         * @brief Stops multiple blocks write (programs last sector)
+         *
+         * @retval true Always
+         */
+        static bool StopMultipleBlockWrite();
+
+    private:
+        static void Select(uint8_t command, uint32_t address = 0, unsigned headerSize = 1);
+        static void SimpleCommand(uint8_t command);
+        static void ProgramPage(uint32_t offset, const uint8_t* data, unsigned size);
+        static void EraseBlock(uint8_t command, uint32_t offset);
+        static void ReadHandler(void* data, unsigned size, bool success);
+
+        static void LoadSector(uint32_t sector);
+        static void UpdateBlock(const uint8_t* buffer, uint32_t logicalBlockAddress);
+        static void FlushSector();
+
+        static bool _busy; ///< Program or erase command was sent, status was not polled yet
+        static TransferCallback _readCallback; ///< User callback of async read
+        static uint32_t _stream; ///< Next block of multiple block read/write
+        static uint32_t _sector; ///< Sector in buffer
+        static uint8_t _dirtyBlocks; ///< Changed blocks of sector in buffer
+        static bool _eraseRequired; ///< Changed blocks set bits of sector in buffer
+        static uint8_t _sectorBuffer[SectorSize]; ///< Sector buffer for block writes
+    };
+}
+
+#include "impl/spi_flash.h"
+
+#endif //! ZHELE_DRIVERS_SPI_FLASH_H
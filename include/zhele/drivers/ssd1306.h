@@ -9,32 +9,290 @@
 #ifndef ZHELE_DRIVERS_SSD1306_H
 #define ZHELE_DRIVERS_SSD1306_H
 
-#include <zhele/delay.h>
+#include <zhele/i2c.h>
+#include <zhele/placement.h>
+#include <zhele/system_time.h>
+
+#include "rle_font.h"
 
 #include <cstring>
+#include <type_traits>
 
 namespace Zhele::Drivers
 {
-    template <typename I2CBus, unsigned Width = 128, unsigned Height = 64>
-    class Ssd1306
+    /**
+     * @brief Implements I2C interface of Ssd1306
+     * 
+     * @details
+     * Region is sent by two async transactions (range commands and data), so I2C with DMA
+     * or @ref I2cBus queue is required.
+     * 
+     * @tparam _I2cBus I2C (or I2C bus)
+     * @tparam _Address Device address
+     */
+    template <typename _I2cBus, uint8_t _Address = (0x78 >> 1)>
+    class Ssd1306I2cInterface
     {
-        static const uint8_t I2cAddress = (0x78 >> 1);
+    public:
+        /// Update complete callback
+        using Callback = I2cCallback;
+
+        /// Region transfer complete callback
+        using RegionCallback = std::add_pointer_t<void(bool success)>;
+
+        /**
+         * @brief Init interface (nothing to do for I2C)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+        }
+
+        /**
+         * @brief Writes commands (blocking)
+         * 
+         * @param [in] commands Commands
+         * @param [in] size Commands count
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void WriteCommands(const uint8_t* commands, uint16_t size)
+        {
+            _I2cBus::Write(_Address, 0x00, commands, size);
+        }
+
+        /**
+         * @brief Writes display RAM region (async)
+         * 
+         * @param [in] range Range commands (column and page address), should be valid until callback
+         * @param [in] data Region data (should be valid until callback)
+         * @param [in] size Data size
+         * @param [in] callback Complete callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void WriteRegionAsync(const uint8_t* range, const uint8_t* data, uint16_t size, RegionCallback callback)
+        {
+            _data = data;
+            _size = size;
+            _callback = callback;
+
+            if (_I2cBus::WriteAsync(_Address, 0x00, range, RangeSize, I2cOpts::None, RangeComplete) != I2cStatus::Success)
+                Complete(I2cStatus::Busy);
+        }
+
+        /**
+         * @brief Calls update complete callback
+         * 
+         * @param [in] callback Update complete callback
+         * @param [in] success Update result
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Notify(Callback callback, bool success)
+        {
+            if (callback != nullptr)
+                callback(success ? I2cStatus::Success : _status);
+        }
+
+        /// Range commands size
+        static const uint16_t RangeSize = 6;
+    private:
+        static void RangeComplete(I2cStatus status)
+        {
+            if (status != I2cStatus::Success)
+            {
+                Complete(status);
+                return;
+            }
+
+            if (_I2cBus::WriteAsync(_Address, 0x40, _data, _size, I2cOpts::None, Complete) != I2cStatus::Success)
+                Complete(I2cStatus::Busy);
+        }
+
+        static void Complete(I2cStatus status)
+        {
+            _status = status;
+            _callback(status == I2cStatus::Success);
+        }
+
+        static inline const uint8_t* _data = nullptr;
+        static inline uint16_t _size = 0;
+        static inline RegionCallback _callback = nullptr;
+        static inline I2cStatus _status = I2cStatus::Success;
+    };
+
+    /**
+     * @brief Implements 4-wire SPI interface of Ssd1306
+     * 
+     * @details
+     * Commands are sent with low D/C pin, display data is sent by DMA. SPI clock can be up to 10 MHz,
+     * so full screen is sent for about 1 ms (I2C at 400 kHz needs about 25 ms).
+     * 
+     * @tparam _SpiBus SPI (with DMA)
+     * @tparam _CsPin Chip select pin
+     * @tparam _DcPin Data/Command pin
+     * @tparam _ResetPin Reset pin
+     */
+    template <typename _SpiBus, typename _CsPin, typename _DcPin, typename _ResetPin>
+    class Ssd1306SpiInterface
+    {
+    public:
+        /// Update complete callback
+        using Callback = std::add_pointer_t<void(bool success)>;
+
+        /// Region transfer complete callback
+        using RegionCallback = std::add_pointer_t<void(bool success)>;
+
+        /**
+         * @brief Init interface (pins and reset pulse)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+            _CsPin::Port::Enable();
+            _CsPin::template SetConfiguration<_CsPin::Configuration::Out>();
+            _CsPin::Set();
+            _DcPin::Port::Enable();
+            _DcPin::template SetConfiguration<_DcPin::Configuration::Out>();
+            _ResetPin::Port::Enable();
+            _ResetPin::template SetConfiguration<_ResetPin::Configuration::Out>();
+
+            _ResetPin::Set();
+            SystemTime::Sleep(1);
+            _ResetPin::Clear();
+            SystemTime::Sleep(10);
+            _ResetPin::Set();
+            SystemTime::Sleep(10);
+        }
+
+        /**
+         * @brief Writes commands (blocking)
+         * 
+         * @param [in] commands Commands
+         * @param [in] size Commands count
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void WriteCommands(const uint8_t* commands, uint16_t size)
+        {
+            _CsPin::Clear();
+            _DcPin::Clear();
+
+            for (uint16_t i = 0; i < size; ++i)
+                _SpiBus::Write(commands[i]);
+
+            _CsPin::Set();
+        }
+
+        /**
+         * @brief Writes display RAM region (async)
+         * 
+         * @param [in] range Range commands (column and page address)
+         * @param [in] data Region data (should be valid until callback)
+         * @param [in] size Data size
+         * @param [in] callback Complete callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void WriteRegionAsync(const uint8_t* range, const uint8_t* data, uint16_t size, RegionCallback callback)
+        {
+            _callback = callback;
+
+            _CsPin::Clear();
+            _DcPin::Clear();
+            for (uint16_t i = 0; i < RangeSize; ++i)
+                _SpiBus::Write(range[i]);
+
+            _DcPin::Set();
+            _SpiBus::WriteAsync(data, size, Complete);
+        }
+
+        /**
+         * @brief Calls update complete callback
+         * 
+         * @param [in] callback Update complete callback
+         * @param [in] success Update result
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Notify(Callback callback, bool success)
+        {
+            if (callback != nullptr)
+                callback(success);
+        }
+
+        /// Range commands size
+        static const uint16_t RangeSize = 6;
+    private:
+        static void Complete(void* data, unsigned size, bool success)
+        {
+            _SpiBus::EndWrite();
+            _CsPin::Set();
+            _callback(success);
+        }
+
+        static inline RegionCallback _callback = nullptr;
+    };
+
+    /**
+     * @brief Implements Ssd1306 OLED display
+     * 
+     * @details
+     * Drawing methods change RAM buffer and track changed columns range of every page.
+     * @ref Update sends changed regions only (with column/page address commands),
+     * consecutive pages changed on full width are sent by one transfer.
+     * 
+     * @tparam _Interface Display interface (@ref Ssd1306I2cInterface or @ref Ssd1306SpiInterface)
+     * @tparam Width Display width
+     * @tparam Height Display height
+     * @tparam _Placement Framebuffer placement (@ref Placement, framebuffer is sent by DMA)
+     */
+    template <typename _Interface, unsigned Width = 128, unsigned Height = 64, typename _Placement = Placement::Default>
+    class Ssd1306Display
+    {
+        static_assert(Width <= 128 && Height % 8 == 0 && Height <= 64, "Invalid display size");
+        static_assert(_Placement::DmaAccessible, "Framebuffer is sent by DMA, it can't be placed to CCM");
+
+        static const uint8_t Pages = Height / 8;
 
         // Ssd1306 commands
         enum Commands : uint8_t
         {
             SetMemoryMode = 0x20, ///< Set Memory Addressing Mode
+            SetColumnAddress = 0x21, ///< Set column start and end address
+            SetPageAddress = 0x22, ///< Set page start and end address
             On = 0xAF, ///< Display On
             Off = 0xAE, ///< Display off
-        };       
+        };
 
     public:
+        using Callback = typename _Interface::Callback;
+
         enum class Pixel : bool
         {
             Off = false, ///< Pixel off (black)
             On = true ///< Pixel on (color depends of LCD used)
         };
 
+        /// Pixel color type (for @ref Graphics)
+        using PixelType = Pixel;
+
+        /// Screen width
+        static const uint8_t ScreenWidth = Width;
+        /// Screen height
+        static const uint8_t ScreenHeight = Height;
+
         /**
          * Initialize display
          * 
@@ -54,12 +312,34 @@ namespace Zhele::Drivers
         static void Fill(Pixel state);
 
         /**
-         * Update LCD
+         * Update LCD: send changed regions (async, via DMA or I2cBus queue)
+         * 
+         * @details
+         * If previous update is in progress, method waits for its completion.
+         * Pixels changed during update are sent by next update.
+         * 
+         * @param [in] callback Update complete callback (optional parameter)
          * 
          * @par Returns
          *  Nothing
          */
-        static void Update();
+        static void Update(Callback callback = nullptr);
+
+        /**
+         * Marks whole display as changed (next update sends full buffer)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Invalidate();
+
+        /**
+         * Returns update state
+         * 
+         * @retval true Update is in progress
+         * @retval false Update is complete
+         */
+        static bool Busy();
 
         /**
          * Draws pixel (x; y);
@@ -73,6 +353,20 @@ namespace Zhele::Drivers
          */
         static void DrawPixel(uint16_t x, uint16_t y, Pixel state = Pixel::On);
 
+        /**
+         * Fills rectangle (by page masks)
+         * 
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] width Width
+         * @param [in] height Height
+         * @param [in] state Pixel color (on or off)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void FillRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, Pixel state = Pixel::On);
+
         /**
          * Sets cursor to given position
          * 
@@ -120,16 +414,74 @@ namespace Zhele::Drivers
          * @par Returns
          *  Nothing
          */
-        void WriteCommand(uint8_t command);
+        static void WriteCommand(uint8_t command);
+
+        /**
+         * Marks region as changed
+         * 
+         * @param [in] firstPage First page
+         * @param [in] lastPage Last page
+         * @param [in] firstColumn First column
+         * @param [in] lastColumn Last column
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void MarkDirty(unsigned firstPage, unsigned lastPage, unsigned firstColumn, unsigned lastColumn);
+
+        /**
+         * Sends next changed region (region complete callback)
+         * 
+         * @param [in] success Previous region transfer result
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SendNext(bool success);
 
     private:
-        static uint8_t _buffer[Width * Height / 8];
+        static constexpr auto& _buffer = PlacedStorage<_Placement, uint8_t[Width * Height / 8], Ssd1306Display>::Value;
         static uint16_t _x;
         static uint16_t _y;
+
+        static uint8_t _dirtyFirst[Pages]; ///< First changed column of page
+        static uint8_t _dirtyEnd[Pages]; ///< Changed columns end of page (0 for clean page)
+        static uint8_t _sendFirst[Pages]; ///< Columns ranges of update in progress (unsent pages stay after failure)
+        static uint8_t _sendEnd[Pages];
+        static uint8_t _regionPage; ///< First page of region in progress
+        static uint8_t _sendPage; ///< Next page for update
+        static uint8_t _range[_Interface::RangeSize]; ///< Region range commands
+        static volatile bool _updating;
+        static Callback _callback;
     };
 
-    template <typename I2CBus, unsigned Width, unsigned Height>
-    bool Ssd1306<I2CBus, Width, Height>::Init()
+    /**
+     * @brief Ssd1306 with I2C interface
+     * 
+     * @tparam I2CBus I2C (with DMA) or I2C bus
+     * @tparam Width Display width
+     * @tparam Height Display height
+     * @tparam _Placement Framebuffer placement
+     */
+    template <typename I2CBus, unsigned Width = 128, unsigned Height = 64, typename _Placement = Placement::Default>
+    using Ssd1306 = Ssd1306Display<Ssd1306I2cInterface<I2CBus>, Width, Height, _Placement>;
+
+    /**
+     * @brief Ssd1306 with 4-wire SPI interface
+     * 
+     * @tparam SpiBus SPI (with DMA)
+     * @tparam CsPin Chip select pin
+     * @tparam DcPin Data/Command pin
+     * @tparam ResetPin Reset pin
+     * @tparam Width Display width
+     * @tparam Height Display height
+     * @tparam _Placement Framebuffer placement
+     */
+    template <typename SpiBus, typename CsPin, typename DcPin, typename ResetPin, unsigned Width = 128, unsigned Height = 64, typename _Placement = Placement::Default>
+    using Ssd1306Spi = Ssd1306Display<Ssd1306SpiInterface<SpiBus, CsPin, DcPin, ResetPin>, Width, Height, _Placement>;
+
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    bool Ssd1306Display<_Interface, Width, Height, _Placement>::Init()
     {
         constexpr uint8_t initSequence[] = {
             Commands::Off,
@@ -155,7 +507,8 @@ namespace Zhele::Drivers
             Commands::On,
         };
 
-        I2CBus::Write(I2cAddress, 0x00, initSequence, sizeof(initSequence));
+        _Interface::Init();
+        _Interface::WriteCommands(initSequence, sizeof(initSequence));
 
         Fill(Pixel::Off);
         Update();
@@ -166,20 +519,113 @@ namespace Zhele::Drivers
         return true;
     }
 
-    template <typename I2CBus, unsigned Width, unsigned Height>
-    void Ssd1306<I2CBus, Width, Height>::Fill(Pixel state)
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    void Ssd1306Display<_Interface, Width, Height, _Placement>::Fill(Pixel state)
     {
         memset(_buffer, state == Pixel::Off ? 0x00 : 0xff, sizeof(_buffer));
+        Invalidate();
+    }
+
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    void Ssd1306Display<_Interface, Width, Height, _Placement>::Update(Callback callback)
+    {
+        while (_updating) continue;
+
+        // Dirty ranges are changed in main loop only, so snapshot is taken here
+        for (uint8_t page = 0; page < Pages; ++page)
+        {
+            // Pages of failed update are sent again
+            if (_sendEnd[page] != 0)
+                MarkDirty(page, page, _sendFirst[page], _sendEnd[page] - 1);
+
+            _sendFirst[page] = _dirtyFirst[page];
+            _sendEnd[page] = _dirtyEnd[page];
+            _dirtyEnd[page] = 0;
+        }
+
+        _callback = callback;
+        _regionPage = 0;
+        _sendPage = 0;
+        _updating = true;
+
+        SendNext(true);
+    }
+
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    void Ssd1306Display<_Interface, Width, Height, _Placement>::Invalidate()
+    {
+        MarkDirty(0, Pages - 1, 0, Width - 1);
+    }
+
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    bool Ssd1306Display<_Interface, Width, Height, _Placement>::Busy()
+    {
+        return _updating;
+    }
+
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    void Ssd1306Display<_Interface, Width, Height, _Placement>::SendNext(bool success)
+    {
+        if (success)
+        {
+            // Previous region is sent
+            for (uint8_t page = _regionPage; page < _sendPage; ++page)
+                _sendEnd[page] = 0;
+
+            while (_sendPage < Pages && _sendEnd[_sendPage] == 0)
+                ++_sendPage;
+        }
+
+        if (!success || _sendPage >= Pages)
+        {
+            _updating = false;
+            _Interface::Notify(_callback, success);
+            return;
+        }
+
+        const uint8_t firstPage = _sendPage;
+        const uint8_t firstColumn = _sendFirst[firstPage];
+        const uint8_t end = _sendEnd[firstPage];
+        uint8_t lastPage = firstPage;
+
+        // Full width pages are contiguous in buffer
+        if (firstColumn == 0 && end == Width)
+        {
+            while (lastPage + 1 < Pages && _sendFirst[lastPage + 1] == 0 && _sendEnd[lastPage + 1] == Width)
+                ++lastPage;
+        }
+
+        _regionPage = firstPage;
+        _sendPage = lastPage + 1;
+
+        _range[0] = Commands::SetColumnAddress;
+        _range[1] = firstColumn;
+        _range[2] = end - 1;
+        _range[3] = Commands::SetPageAddress;
+        _range[4] = firstPage;
+        _range[5] = lastPage;
+
+        _Interface::WriteRegionAsync(_range, &_buffer[firstPage * Width + firstColumn],
+            (lastPage - firstPage) * Width + (end - firstColumn), SendNext);
     }
 
-    template <typename I2CBus, unsigned Width, unsigned Height>
-    void Ssd1306<I2CBus, Width, Height>::Update()
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    void Ssd1306Display<_Interface, Width, Height, _Placement>::MarkDirty(unsigned firstPage, unsigned lastPage, unsigned firstColumn, unsigned lastColumn)
     {
-        I2CBus::WriteAsync(I2cAddress, 0x40, _buffer, Width * Height / 8);
+        if (lastColumn >= Width)
+            lastColumn = Width - 1;
+
+        for (unsigned page = firstPage; page <= lastPage && page < Pages; ++page)
+        {
+            if (_dirtyEnd[page] == 0 || firstColumn < _dirtyFirst[page])
+                _dirtyFirst[page] = firstColumn;
+            if (lastColumn + 1 > _dirtyEnd[page])
+                _dirtyEnd[page] = lastColumn + 1;
+        }
     }
 
-    template <typename I2CBus, unsigned Width, unsigned Height>
-    void Ssd1306<I2CBus, Width, Height>::DrawPixel(uint16_t x, uint16_t y, Pixel state)
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    void Ssd1306Display<_Interface, Width, Height, _Placement>::DrawPixel(uint16_t x, uint16_t y, Pixel state)
     {
         if(x >= Width || y >= Height)
             return;
@@ -191,18 +637,47 @@ namespace Zhele::Drivers
         {
             _buffer[(y / 8) * Width + x] &= ~(1 << (y % 8));
         }
+        MarkDirty(y / 8, y / 8, x, x);
     }
 
-    template <typename I2CBus, unsigned Width, unsigned Height>
-    void Ssd1306<I2CBus, Width, Height>::Goto(uint16_t x, uint16_t y)
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    void Ssd1306Display<_Interface, Width, Height, _Placement>::FillRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, Pixel state)
+    {
+        if (x >= Width || y >= Height || width == 0 || height == 0)
+            return;
+        if (width > Width - x)
+            width = Width - x;
+        if (height > Height - y)
+            height = Height - y;
+
+        const uint16_t lastRow = y + height - 1;
+        for (uint16_t page = y / 8; page <= lastRow / 8; ++page)
+        {
+            uint8_t mask = 0xff;
+            if (page == y / 8)
+                mask &= 0xff << (y % 8);
+            if (page == lastRow / 8)
+                mask &= 0xff >> (7 - lastRow % 8);
+
+            uint8_t* bytes = &_buffer[page * Width + x];
+            for (uint16_t column = 0; column < width; ++column)
+            {
+                bytes[column] = state == Pixel::On ? (bytes[column] | mask) : (bytes[column] & ~mask);
+            }
+        }
+        MarkDirty(y / 8, lastRow / 8, x, x + width - 1);
+    }
+
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    void Ssd1306Display<_Interface, Width, Height, _Placement>::Goto(uint16_t x, uint16_t y)
     {
         _x = x;
         _y = y;
     }
 
-    template <typename I2CBus, unsigned Width, unsigned Height>
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
     template <typename Font>
-    std::enable_if_t<Font::MonoSpace, bool> Ssd1306<I2CBus, Width, Height>::Putc(char symbol)
+    std::enable_if_t<Font::MonoSpace, bool> Ssd1306Display<_Interface, Width, Height, _Placement>::Putc(char symbol)
     {            
         if (Width <= (_x + Font::Width) || Height <= (_y + Font::Height))
         {
@@ -227,15 +702,17 @@ namespace Zhele::Drivers
                     | (Font::Get(symbol)[page * Font::Width + column] & (0xff >> (8 - extraBits)));
             }
         }
+
+        MarkDirty(_y / 8, (_y + Font::Height - 1) / 8, _x, _x + Font::Width - 1);
         
         _x += Font::Width + 1;
         
         return true;
     }
 
-    template <typename I2CBus, unsigned Width, unsigned Height>
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
     template <typename Font>
-    std::enable_if_t<!Font::MonoSpace, bool> Ssd1306<I2CBus, Width, Height>::Putc(char symbol)
+    std::enable_if_t<!Font::MonoSpace, bool> Ssd1306Display<_Interface, Width, Height, _Placement>::Putc(char symbol)
     {            
         volatile uint8_t width = Font::GetWidth(symbol);
         if (Width <= (_x + width) || Height <= (_y + Font::Height))
@@ -243,33 +720,50 @@ namespace Zhele::Drivers
             return false;
         }
         
-        uint8_t page = 0;
-        for(; page < Font::Height / 8; ++page)
+        if constexpr (Private::IsRleFont<Font>)
         {
-            for (uint8_t column = 0; column < width; ++column)
-            {
-                _buffer[(_y / 8 + page) * Width + _x + column] = Font::Get(symbol)[page * width + column];
-            }
+            // Runs are decoded straight into page buffer
+            Font::Decode(symbol, [](uint8_t row, uint8_t column, uint8_t length, bool set) {
+                const uint16_t y = _y + row;
+                const uint8_t mask = 1 << (y % 8);
+                uint8_t* bytes = &_buffer[(y / 8) * Width + _x + column];
+
+                for (uint8_t i = 0; i < length; ++i)
+                    bytes[i] = set ? (bytes[i] | mask) : (bytes[i] & ~mask);
+            });
         }
-        const uint8_t extraBits = Font::Height % 8;
-        if constexpr (extraBits > 0)
+        else
         {
-            for (uint8_t column = 0; column < width; ++column)
+            uint8_t page = 0;
+            for(; page < Font::Height / 8; ++page)
             {
-                _buffer[(_y + Font::Height) / 8 * Width + _x + column] =
-                    (_buffer[(_y + Font::Height) / 8 * Width + _x + column] & (0xff << extraBits))
-                    | (Font::Get(symbol)[page * width + column] >> (8 - extraBits));
+                for (uint8_t column = 0; column < width; ++column)
+                {
+                    _buffer[(_y / 8 + page) * Width + _x + column] = Font::Get(symbol)[page * width + column];
+                }
+            }
+            const uint8_t extraBits = Font::Height % 8;
+            if constexpr (extraBits > 0)
+            {
+                for (uint8_t column = 0; column < width; ++column)
+                {
+                    _buffer[(_y + Font::Height) / 8 * Width + _x + column] =
+                        (_buffer[(_y + Font::Height) / 8 * Width + _x + column] & (0xff << extraBits))
+                        | (Font::Get(symbol)[page * width + column] >> (8 - extraBits));
+                }
             }
         }
+
+        MarkDirty(_y / 8, (_y + Font::Height - 1) / 8, _x, _x + width - 1);
         
         _x += width + 1;
         
         return true;
     }
 
-    template <typename I2CBus, unsigned Width, unsigned Height>
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
     template <typename Font>
-    bool Ssd1306<I2CBus, Width, Height>::Puts(const char* str)
+    bool Ssd1306Display<_Interface, Width, Height, _Placement>::Puts(const char* str)
     {
         while (*str)
         {
@@ -282,18 +776,34 @@ namespace Zhele::Drivers
         return true;
     }
 
-    template <typename I2CBus, unsigned Width, unsigned Height>
-    void Ssd1306<I2CBus, Width, Height>::WriteCommand(uint8_t command)
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    void Ssd1306Display<_Interface, Width, Height, _Placement>::WriteCommand(uint8_t command)
     {
-        I2CBus::WriteU8(I2cAddress, 0x00, command);
+        _Interface::WriteCommands(&command, 1);
     }
 
-    template <typename I2CBus, unsigned Width, unsigned Height>
-    uint8_t Ssd1306<I2CBus, Width, Height>::_buffer[Width * Height / 8];
-    template <typename I2CBus, unsigned Width, unsigned Height>
-    uint16_t Ssd1306<I2CBus, Width, Height>::_x = 0;
-    template <typename I2CBus, unsigned Width, unsigned Height>
-    uint16_t Ssd1306<I2CBus, Width, Height>::_y = 0;
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    uint16_t Ssd1306Display<_Interface, Width, Height, _Placement>::_x = 0;
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    uint16_t Ssd1306Display<_Interface, Width, Height, _Placement>::_y = 0;
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    uint8_t Ssd1306Display<_Interface, Width, Height, _Placement>::_dirtyFirst[Pages] = {};
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    uint8_t Ssd1306Display<_Interface, Width, Height, _Placement>::_dirtyEnd[Pages] = {};
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    uint8_t Ssd1306Display<_Interface, Width, Height, _Placement>::_sendFirst[Pages] = {};
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    uint8_t Ssd1306Display<_Interface, Width, Height, _Placement>::_sendEnd[Pages] = {};
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    uint8_t Ssd1306Display<_Interface, Width, Height, _Placement>::_regionPage = 0;
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    uint8_t Ssd1306Display<_Interface, Width, Height, _Placement>::_sendPage = 0;
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    uint8_t Ssd1306Display<_Interface, Width, Height, _Placement>::_range[_Interface::RangeSize];
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    volatile bool Ssd1306Display<_Interface, Width, Height, _Placement>::_updating = false;
+    template <typename _Interface, unsigned Width, unsigned Height, typename _Placement>
+    typename Ssd1306Display<_Interface, Width, Height, _Placement>::Callback Ssd1306Display<_Interface, Width, Height, _Placement>::_callback = nullptr;
 }
 
 #endif //! ZHELE_DRIVERS_SSD1306_H
\ No newline at end of file
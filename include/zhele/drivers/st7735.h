@@ -9,7 +9,10 @@
 #ifndef ZHELE_DRIVERS_ST7735_H
 #define ZHELE_DRIVERS_ST7735_H
 
-#include <zhele/delay.h>
+#include <zhele/system_time.h>
+
+#include "glyph_cache.h"
+#include "rle_font.h"
 
 #include <cstdint>
 #include <initializer_list>
@@ -64,6 +67,8 @@ namespace Zhele::Drivers
             RamRd = 0x2e,
 
             PrlAr = 0x30,
+            ScrlAr = 0x33, ///< Vertical scrolling definition
+            VScsAd = 0x37, ///< Vertical scrolling start address
             ColMod = 0x3a,
             MadCtl = 0x36,
 
@@ -96,6 +101,11 @@ namespace Zhele::Drivers
                 ? MadCtl::Mx | MadCtl::My
                 : MadCtl::My | MadCtl::Mv);
 
+        /// Panel lines count (hardware scroll is along panel lines: display rows in portrait, columns in landscape)
+        static const uint8_t PanelLines = _Width < _Height ? _Height : _Width;
+        /// Frame memory rows order is mirrored relative to display lines
+        static const bool MirroredLines = (Rotation & MadCtl::My) != 0;
+
         static bool _busy;
     public:
         /// Color
@@ -124,10 +134,10 @@ namespace Zhele::Drivers
             Reset();
 
             WriteCommand(Command::SoftwareReset);
-            delay_ms<150>();
+            SystemTime::Sleep(150);
 
             WriteCommand(Command::SlpOut);
-            delay_ms<500>();
+            SystemTime::Sleep(500);
 
             WriteCommand(Command::FrmCtr1);
             WriteData({0x01, 0x2c, 0x2d});
@@ -202,10 +212,10 @@ namespace Zhele::Drivers
                 0x00, 0x00, 0x02, 0x10});
 
             WriteCommand(Command::NorOn);
-            delay_ms<10>();
+            SystemTime::Sleep(10);
 
             WriteCommand(Command::DispOn);
-            delay_ms<100>();
+            SystemTime::Sleep(100);
 
             _SsPin::Set();
         }
@@ -269,14 +279,10 @@ namespace Zhele::Drivers
 
             SetAddressWindow(x, y, x + width - 1, y + height - 1);
 
-            _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize16);
-
             _DcPin::Set();
-            
-            _SpiBus::WriteAsyncNoIncrement(&color, height * width, [](void* data, unsigned size, bool success){
-                while(_SpiBus::Busy()) continue;
+
+            _SpiBus::Fill(color, static_cast<size_t>(height) * width, [](void* data, unsigned size, bool success){
                 _SsPin::Set();
-                _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize8);
                 _busy = false;
             });
         }
@@ -317,6 +323,61 @@ namespace Zhele::Drivers
             WriteDataAsync(data, sizeof(uint16_t) * width * height);
         }
 
+        /**
+         * @brief Starts streamed write of rectangle (pixels are sent by @ref WritePixelsAsync chunks)
+         * 
+         * @details
+         * Method waits for previous async operation, sets address window and keeps display selected
+         * until @ref EndWrite, so image may be sent by chunks of any size (chunk boundary
+         * doesn't have to match scanline).
+         * 
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param width Width
+         * @param height Height
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void BeginWrite(uint8_t x, uint8_t y, uint8_t width, uint8_t height)
+        {
+            while (_busy) continue;
+
+            _busy = true;
+            _SsPin::Clear();
+
+            SetAddressWindow(x, y, x + width - 1, y + height - 1);
+            _DcPin::Set();
+        }
+
+        /**
+         * @brief Sends pixels chunk of streamed write by DMA
+         * 
+         * @param data Pixels (display byte order, as for @ref DrawImage)
+         * @param size Size in bytes
+         * @param callback Chunk complete callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void WritePixelsAsync(const void* data, uint32_t size, TransferCallback callback)
+        {
+            _SpiBus::WriteAsync(data, size, callback);
+        }
+
+        /**
+         * @brief Finishes streamed write (call it after last chunk is sent)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void EndWrite()
+        {
+            _SpiBus::EndWrite();
+            _SsPin::Set();
+            _busy = false;
+        }
+
         /**
          * @brief Write char to display
          * 
@@ -334,55 +395,59 @@ namespace Zhele::Drivers
         template<typename Font>
         static void WriteChar(uint8_t x, uint8_t y, char symbol, uint16_t color, uint16_t background)
         {
-            _SsPin::Clear();
+            if constexpr (Private::IsRleFont<Font>) {
+                WriteRleChar<Font>(x, y, symbol, color, background);
+            } else {
+                _SsPin::Clear();
 
-            // For compatibility with old fonts I need to fill display by column not by row
-            // So, temporarily change the X and Y axes
-            WriteCommand(Command::MadCtl);
-            WriteData(Rotation ^ MadCtl::Mv);
+                // For compatibility with old fonts I need to fill display by column not by row
+                // So, temporarily change the X and Y axes
+                WriteCommand(Command::MadCtl);
+                WriteData(Rotation ^ MadCtl::Mv);
 
-            uint8_t width;
-            if constexpr (Font::MonoSpace)
-                width = Font::Width;
-            else
-                width = Font::GetWidth(symbol);
+                uint8_t width;
+                if constexpr (Font::MonoSpace)
+                    width = Font::Width;
+                else
+                    width = Font::GetWidth(symbol);
 
-            SetAddressWindow(y, x, y + Font::Height - 1, x + width - 1);
+                SetAddressWindow(y, x, y + Font::Height - 1, x + width - 1);
 
-            _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize16);
-            _DcPin::Set();
+                _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize16);
+                _DcPin::Set();
 
-            const uint8_t extraBits = Font::Height % 8;
+                const uint8_t extraBits = Font::Height % 8;
 
-            for (uint8_t column = 0; column < width; ++column) {
+                for (uint8_t column = 0; column < width; ++column) {
 
-                uint8_t page = 0;
-                for(page = 0; page < Font::Height / 8; ++page) {
-                    uint8_t temp = Font::Get(symbol)[page * width + column];
+                    uint8_t page = 0;
+                    for(page = 0; page < Font::Height / 8; ++page) {
+                        uint8_t temp = Font::Get(symbol)[page * width + column];
 
-                    for(uint8_t i = 0; i < 8; ++i) {
-                        _SpiBus::Write((temp & 0x01) > 0 ? color : background);
-                        temp >>= 1;
+                        for(uint8_t i = 0; i < 8; ++i) {
+                            _SpiBus::Write((temp & 0x01) > 0 ? color : background);
+                            temp >>= 1;
+                        }
                     }
-                }
 
-                if constexpr (extraBits > 0) {
-                    uint8_t temp = Font::Get(symbol)[page * width + column] >> (8 - extraBits);
+                    if constexpr (extraBits > 0) {
+                        uint8_t temp = Font::Get(symbol)[page * width + column] >> (8 - extraBits);
 
-                    for(uint8_t i = 0; i < extraBits; ++i) {
-                        _SpiBus::Write((temp & 0x01) > 0 ? color : background);
-                        temp >>= 1;
+                        for(uint8_t i = 0; i < extraBits; ++i) {
+                            _SpiBus::Write((temp & 0x01) > 0 ? color : background);
+                            temp >>= 1;
+                        }
                     }
                 }
-            }
 
-            _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize8);
+                _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize8);
 
-            // Put back
-            WriteCommand(Command::MadCtl);
-            WriteData(Rotation);
-            
-            _SsPin::Set();
+                // Put back
+                WriteCommand(Command::MadCtl);
+                WriteData(Rotation);
+
+                _SsPin::Set();
+            }
         }
 
         /**
@@ -430,6 +495,143 @@ namespace Zhele::Drivers
             }
         }
 
+        /**
+         * @brief Write char by pre-rendered glyph (one DMA transfer)
+         * 
+         * @tparam Glyphs Glyphs (@ref GlyphCache or @ref StaticGlyphs)
+         * 
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param symbol Symbol
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename Glyphs>
+        static void WriteChar(uint8_t x, uint8_t y, char symbol)
+        {
+            while (_busy) continue;
+
+            const uint8_t width = Glyphs::Width(symbol);
+            const uint16_t* pixels = Glyphs::Get(symbol);
+
+            _busy = true;
+            _SsPin::Clear();
+
+            SetAddressWindow(x, y, x + width - 1, y + Glyphs::Height - 1);
+
+            WriteDataAsync(pixels, sizeof(uint16_t) * width * Glyphs::Height);
+        }
+
+        /**
+         * @brief Write string by pre-rendered glyphs
+         * 
+         * @details
+         * Every text line is sent through one address window: line is sent row by row,
+         * next row is composed from glyphs while previous one is transmitted by DMA.
+         * Method waits for transfer complete. Full screen of text (160x128) is sent for about 9 ms
+         * with 36 MHz SPI clock.
+         * 
+         * @tparam Glyphs Glyphs (@ref GlyphCache or @ref StaticGlyphs)
+         * 
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param str String
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename Glyphs>
+        static void WriteString(uint8_t x, uint8_t y, const char* str)
+        {
+            while(*str) {
+                const char* end = str;
+                unsigned width = 0;
+
+                while(*end && x + width + Glyphs::Width(*end) < _Width) {
+                    width += Glyphs::Width(*end);
+                    ++end;
+                }
+
+                if (width > 0)
+                    WriteLine<Glyphs>(x, y, str, end, width);
+
+                if (*end == 0)
+                    break;
+
+                x = 0;
+                y += Glyphs::Height;
+
+                if(y + Glyphs::Height >= _Height)
+                    break;
+
+                str = end;
+                // skip spaces in the beginning of the new line
+                if(*str == ' ')
+                    ++str;
+            }
+        }
+
+        /**
+         * @brief Defines hardware scroll area
+         * 
+         * @details
+         * Panel lines are display rows in portrait orientation and display columns in landscape.
+         * Fixed areas are not scrolled (for example, status bar).
+         * 
+         * @param topFixed Top (left in landscape) fixed area lines count
+         * @param bottomFixed Bottom (right in landscape) fixed area lines count
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetScrollArea(uint8_t topFixed, uint8_t bottomFixed)
+        {
+            while (_busy) continue;
+
+            _scrollTop = topFixed;
+            _scrollBottom = bottomFixed;
+            const uint8_t scrollLines = PanelLines - topFixed - bottomFixed;
+
+            // Fixed areas are defined in panel scan order
+            const uint8_t first = MirroredLines ? bottomFixed : topFixed;
+            const uint8_t last = MirroredLines ? topFixed : bottomFixed;
+
+            _SsPin::Clear();
+            WriteCommand(Command::ScrlAr);
+            WriteData({0x00, first, 0x00, scrollLines, 0x00, last});
+            _SsPin::Set();
+        }
+
+        /**
+         * @brief Sets scroll offset: line that is shown first in scroll area
+         * 
+         * @details
+         * Drawing methods still use frame memory coordinates, so line drawn at @p line
+         * is shown at top of scroll area. Only one command (4 bytes) is sent.
+         * 
+         * @param line Line (display row in portrait or column in landscape) within scroll area
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetScrollStart(uint8_t line)
+        {
+            while (_busy) continue;
+
+            uint8_t address = line;
+            if constexpr (MirroredLines)
+            {
+                const uint8_t scrollLines = PanelLines - _scrollTop - _scrollBottom;
+                address = _scrollBottom + (PanelLines - line - _scrollBottom) % scrollLines;
+            }
+
+            _SsPin::Clear();
+            WriteCommand(Command::VScsAd);
+            WriteData({0x00, address});
+            _SsPin::Set();
+        }
+
         /**
          * @brief Reset controller
          * 
@@ -439,13 +641,13 @@ namespace Zhele::Drivers
         static void Reset()
         {
             _ResetPin::Set();
-            delay_ms<50>();
+            SystemTime::Sleep(50);
 
             _ResetPin::Clear();            
-            delay_ms<50>();
+            SystemTime::Sleep(50);
 
             _ResetPin::Set();
-            delay_ms<50>();
+            SystemTime::Sleep(50);
         }
 
         /**
@@ -459,6 +661,59 @@ namespace Zhele::Drivers
             return _busy;
         }
 
+        /**
+         * @brief Implements RAM framebuffer with dirty tiles tracking (partial update)
+         * 
+         * @details
+         * Drawing methods change RAM framebuffer only and mark changed tiles as dirty. @ref Flush
+         * pushes dirty tiles only: horizontal run of dirty tiles (up to _BurstTiles) is sent
+         * with one address window and one DMA burst. Runs are copied to one of two transmit buffers,
+         * so next run is prepared while previous is transmitted and drawing can continue during flush
+         * (tile that is changed during flush becomes dirty again and it's sent later).
+         * Framebuffer takes _Width * _Height * 2 bytes of RAM (plus two transmit buffers).
+         * On MCU with DMA2D (STM32F429 and so on) fills and image copies are done by DMA2D
+         * (rectangles smaller than ZHELE_DMA2D_THRESHOLD pixels are drawn by CPU).
+         * Don't call display drawing methods while flush is in progress.
+         * 
+         * @par Example
+         * @code
+         *  using Screen = Lcd::FrameBuffer<>;
+         *  Screen::FillScreen(Lcd::Black);
+         *  Screen::WriteString<Font>(0, 0, "Hello", Lcd::White, Lcd::Black);
+         *  Screen::Flush();
+         * @endcode
+         * 
+         * @tparam _TileWidth Tile width (display width must be multiple of it)
+         * @tparam _TileHeight Tile height (display height must be multiple of it)
+         * @tparam _BurstTiles Max tiles count in one DMA burst
+         */
+        template<uint8_t _TileWidth = 16, uint8_t _TileHeight = 16, uint8_t _BurstTiles = 4>
+        class FrameBuffer;
+
+        /**
+         * @brief Implements text terminal with hardware vertical scroll
+         * 
+         * @details
+         * Scroll area is divided into text lines. Until screen is full new lines are written one by one,
+         * then the oldest line is scrolled to the bottom and it's overwritten by new line,
+         * so every new line costs one text line of pixels (and scroll command) instead of full redraw.
+         * Line is sent by pre-rendered glyphs with one address window, rest of line is filled with background.
+         * Hardware scroll is vertical in portrait orientation only.
+         * 
+         * @par Example
+         * @code
+         *  using Log = Lcd::ScrollingTerminal<Glyphs>;
+         *  Log::Init();
+         *  Log::WriteLine("Started");
+         * @endcode
+         * 
+         * @tparam _Glyphs Glyphs (@ref GlyphCache or @ref StaticGlyphs)
+         * @tparam _TopFixed Top fixed area (not scrolled) height
+         * @tparam _Background Background color
+         */
+        template<typename _Glyphs, uint8_t _TopFixed = 0, uint16_t _Background = Black>
+        class ScrollingTerminal;
+
     private:
         /**
          * @brief Write command to display
@@ -512,16 +767,127 @@ namespace Zhele::Drivers
          * @param size Size
          * @param callback Complete callback
          */
-        static void WriteDataAsync(const void* data, uint32_t size, TransferCallback callback = [](void* data, unsigned size, bool success){_SsPin::Set(); _busy = false;})
+        static void WriteDataAsync(const void* data, uint32_t size, TransferCallback callback = [](void* data, unsigned size, bool success){_SpiBus::EndWrite(); _SsPin::Set(); _busy = false;})
         {
             _DcPin::Set();
 
             _SpiBus::WriteAsync(data, size, callback);
         }
+
+        /**
+         * @brief Write text line by pre-rendered glyphs (one address window)
+         * 
+         * @tparam Glyphs Glyphs
+         * 
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param begin Line begin
+         * @param end Line end
+         * @param width Line width
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename Glyphs>
+        static void WriteLine(uint8_t x, uint8_t y, const char* begin, const char* end, unsigned width)
+        {
+            while (_busy) continue;
+
+            _busy = true;
+            _SsPin::Clear();
+
+            SetAddressWindow(x, y, x + width - 1, y + Glyphs::Height - 1);
+            _DcPin::Set();
+
+            _rowComplete = true;
+            for (uint8_t row = 0; row < Glyphs::Height; ++row) {
+                // Previous row is transmitted from other buffer
+                uint16_t* line = _rows[row & 0x01];
+                for (const char* symbol = begin; symbol != end; ++symbol) {
+                    const uint8_t glyphWidth = Glyphs::Width(*symbol);
+                    const uint16_t* pixels = Glyphs::Get(*symbol) + row * glyphWidth;
+                    for (uint8_t i = 0; i < glyphWidth; ++i)
+                        *line++ = pixels[i];
+                }
+
+                while (!_rowComplete) continue;
+                _rowComplete = false;
+                _SpiBus::WriteAsync(_rows[row & 0x01], sizeof(uint16_t) * width, [](void* data, unsigned size, bool success){
+                    _rowComplete = true;
+                });
+            }
+
+            while (!_rowComplete) continue;
+            _SpiBus::EndWrite();
+
+            _SsPin::Set();
+            _busy = false;
+        }
+
+        /**
+         * @brief Write char of compressed font (runs are decoded straight into DMA rows)
+         * 
+         * @tparam Font Font (@ref RleFont)
+         * 
+         * @param x X coordinate
+         * @param y Y coordinate
+         * @param symbol Symbol
+         * @param color Symbol color
+         * @param background Background color
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename Font>
+        static void WriteRleChar(uint8_t x, uint8_t y, char symbol, uint16_t color, uint16_t background)
+        {
+            while (_busy) continue;
+
+            const uint8_t width = Font::GetWidth(symbol);
+            const uint16_t foreground = Private::DisplayOrder(color);
+            const uint16_t back = Private::DisplayOrder(background);
+
+            _busy = true;
+            _SsPin::Clear();
+
+            SetAddressWindow(x, y, x + width - 1, y + Font::Height - 1);
+            _DcPin::Set();
+
+            _rowComplete = true;
+            Font::Decode(symbol, [width, foreground, back](uint8_t row, uint8_t column, uint8_t length, bool set) {
+                // Previous row is transmitted from other buffer
+                uint16_t* line = _rows[row & 0x01];
+                const uint16_t value = set ? foreground : back;
+
+                for (uint8_t i = 0; i < length; ++i)
+                    line[column + i] = value;
+
+                if (column + length == width) {
+                    while (!_rowComplete) continue;
+                    _rowComplete = false;
+                    _SpiBus::WriteAsync(line, sizeof(uint16_t) * width, [](void* data, unsigned size, bool success){
+                        _rowComplete = true;
+                    });
+                }
+            });
+
+            while (!_rowComplete) continue;
+            _SpiBus::EndWrite();
+
+            _SsPin::Set();
+            _busy = false;
+        }
+
+        static inline uint16_t _rows[2][_Width]; ///< Text line rows (double buffer)
+        static inline volatile bool _rowComplete = true; ///< Row transfer complete flag
+        static inline uint8_t _scrollTop = 0; ///< Top fixed area lines
+        static inline uint8_t _scrollBottom = 0; ///< Bottom fixed area lines
     };
 
     template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width, uint8_t _Height>
     bool St7735<_SpiBus, _SsPin, _DcPin, _ResetPin, _Width, _Height>::_busy = false;
 }
 
+#include "impl/st7735.h"
+
 #endif //! ZHELE_DRIVERS_ST7735_H
\ No newline at end of file
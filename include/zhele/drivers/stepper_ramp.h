@@ -0,0 +1,552 @@
+/**
+ * @file
+ * Implements hardware step pulse generator with acceleration ramps
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_STEPPER_RAMP_H
+#define ZHELE_DRIVERS_STEPPER_RAMP_H
+
+#include <zhele/dma.h>
+#include <zhele/iopins.h>
+#include <zhele/timer.h>
+
+#include <cstdint>
+#include <type_traits>
+
+namespace Zhele::Drivers
+{
+    namespace Private
+    {
+        /**
+         * @brief Returns integer square root
+         *
+         * @param [in] value Value
+         *
+         * @returns Rounded down square root
+         */
+        inline uint32_t StepperSqrt(uint64_t value)
+        {
+            uint64_t result = 0;
+            uint64_t bit = 1ull << 62;
+
+            while (bit > value)
+                bit >>= 2;
+
+            while (bit != 0)
+            {
+                if (value >= result + bit)
+                {
+                    value -= result + bit;
+                    result = (result >> 1) + bit;
+                }
+                else
+                {
+                    result >>= 1;
+                }
+                bit >>= 2;
+            }
+
+            return static_cast<uint32_t>(result);
+        }
+
+        /**
+         * @brief Implements integer trapezoidal ramp (step intervals generator)
+         *
+         * @details
+         * Intervals are computed by D. Austin algorithm ("Generate stepper-motor speed profiles in real time"):
+         * interval of acceleration step n is c(n) = c(n - 1) - 2 * c(n - 1) / (4 * n + 1), deceleration reverts it.
+         * Interval is kept in 17.15 fixed point, so long ramps have no cumulative rounding errors.
+         * Deceleration is started when remaining steps count equals ramp level, so profile is symmetric
+         * (triangular if speed is not reached).
+         */
+        class StepperRampGenerator
+        {
+            static const unsigned FractionBits = 15;
+        public:
+            /**
+             * @brief Starts new ramp
+             *
+             * @param [in] steps Steps count
+             * @param [in] speed Max speed (steps per second)
+             * @param [in] acceleration Acceleration (steps per second^2, 0 for move without ramp)
+             * @param [in] tickFrequency Interval tick frequency
+             * @param [in] minInterval Min interval (ticks)
+             * @param [in] maxInterval Max interval (ticks, not more than 65536)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            void Start(uint32_t steps, uint32_t speed, uint32_t acceleration, uint32_t tickFrequency, uint32_t minInterval, uint32_t maxInterval)
+            {
+                _steps = steps;
+                _step = 0;
+                _level = 0;
+                _minInterval = minInterval;
+                _maxInterval = maxInterval;
+
+                _cruise = Clamp(tickFrequency / speed) << FractionBits;
+                uint32_t first = _cruise >> FractionBits;
+                if (acceleration != 0)
+                {
+                    // c0 = 0.676 * f * sqrt(2 / a) (0.676 compensates first step error)
+                    uint64_t squared = 2ull * tickFrequency * tickFrequency / acceleration;
+                    first = static_cast<uint32_t>(static_cast<uint64_t>(StepperSqrt(squared)) * 676 / 1000);
+                }
+                _interval = Clamp(first) << FractionBits;
+                if (_interval < _cruise)
+                    _interval = _cruise;
+            }
+
+            /**
+             * @brief Returns ramp state
+             *
+             * @retval true All steps are generated
+             * @retval false There are steps
+             */
+            bool Done() const
+            {
+                return _step >= _steps;
+            }
+
+            /**
+             * @brief Returns generated steps count
+             *
+             * @returns Steps count
+             */
+            uint32_t Generated() const
+            {
+                return _step;
+            }
+
+            /**
+             * @brief Returns next step interval
+             *
+             * @returns Interval (ticks)
+             */
+            uint32_t Next()
+            {
+                uint32_t interval = _interval >> FractionBits;
+                uint32_t remaining = _steps - ++_step;
+
+                if (remaining <= _level)
+                {
+                    if (_level > 0)
+                    {
+                        _interval += 2 * (_interval / (4 * _level - 1));
+                        --_level;
+                        if (_interval > (_maxInterval << FractionBits))
+                            _interval = _maxInterval << FractionBits;
+                    }
+                }
+                else if (remaining >= _level + 2 && _interval > _cruise)
+                {
+                    ++_level;
+                    _interval -= 2 * (_interval / (4 * _level + 1));
+                    if (_interval < _cruise)
+                        _interval = _cruise;
+                }
+
+                return Clamp(interval);
+            }
+
+            /**
+             * @brief Shortens ramp: deceleration is started from current speed
+             *
+             * @par Returns
+             *  Nothing
+             */
+            void Decelerate()
+            {
+                if (_steps - _step > _level + 1)
+                    _steps = _step + _level + 1;
+            }
+
+        private:
+            uint32_t Clamp(uint32_t interval) const
+            {
+                if (interval < _minInterval)
+                    return _minInterval;
+                if (interval > _maxInterval)
+                    return _maxInterval;
+                return interval;
+            }
+
+            uint32_t _steps = 0; ///< Steps count
+            uint32_t _step = 0; ///< Generated steps count
+            uint32_t _level = 0; ///< Ramp level (acceleration steps count of current speed)
+            uint32_t _interval = 0; ///< Current interval (fixed point)
+            uint32_t _cruise = 0; ///< Cruise interval (fixed point)
+            uint32_t _minInterval = 0; ///< Min interval
+            uint32_t _maxInterval = 0; ///< Max interval
+        };
+    }
+
+    /**
+     * @brief Implements hardware step pulse generator with acceleration ramps
+     *
+     * @details
+     * Every step is one timer period, step intervals of ramp are precomputed into double DMA buffer
+     * and DMA writes them to ARR (with preload) on update event, so pulses have no jitter.
+     * Free block is refilled in DMA interrupt (one integer division per step), so step rate of tens kHz
+     * costs almost no CPU time. Channel works in PWM2 mode: output is low during PulseDelay ticks and high
+     * until period end, so rising edge is step. When ramp is done, tail of buffer gets periods that are
+     * shorter than PulseDelay (without pulses), timer is stopped when tail block is sent.
+     *
+     * @par Example
+     * @code
+     *  using Axis = Drivers::StepperRamp<Timers::Timer2, 0, Dma1Channel2, IO::Pa1>;
+     *  Axis::Init(1000000);
+     *  Axis::Move(-3200, 20000, 40000);
+     *  while (Axis::Busy()) ;
+     * @endcode
+     *
+     * @tparam _Timer GP timer
+     * @tparam _Channel Timer channel (step output)
+     * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+     * @tparam _DirPin Direction pin (it's set for positive steps, NullPin if direction is controlled by user)
+     * @tparam _Pin Step pin
+     * @tparam _BlockSize Steps in one DMA buffer block
+     */
+    template <typename _Timer, unsigned _Channel, typename _DmaChannel, typename _DirPin = IO::NullPin,
+            typename _Pin = typename _Timer::template OutputCompare<_Channel>::Pins::template Pin<0>,
+            unsigned _BlockSize = 32>
+    class StepperRamp
+    {
+        static_assert(_BlockSize >= 2, "Block must contain at least two steps");
+
+        using Pwm = typename _Timer::template PWMGeneration<_Channel>;
+        using Counter = typename _Timer::Counter;
+
+        static const uint32_t MaxInterval = 0x10000;
+    public:
+        /// Timer
+        using Timer = _Timer;
+
+        /**
+         * @brief Inits timer, PWM channel and pins
+         *
+         * @param [in] tickFrequency Timer tick frequency (step interval resolution)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint32_t tickFrequency = 1000000)
+        {
+            uint32_t prescaler = _Timer::GetClockFreq() / tickFrequency;
+            if (prescaler == 0)
+                prescaler = 1;
+            _tickFrequency = _Timer::GetClockFreq() / prescaler;
+
+            // Step low time is 5 us (at least 2 ticks)
+            _pulseDelay = _tickFrequency / 200000;
+            if (_pulseDelay < 2)
+                _pulseDelay = 2;
+
+            _Timer::Enable();
+            _Timer::Stop();
+            _Timer::SetPrescaler(prescaler - 1);
+            // Prescaler is preloaded, update event applies it
+            _Timer::SetPeriodAndUpdate(_pulseDelay - 1);
+
+            Pwm::SetOutputPolarity(Pwm::ActiveHigh);
+            Pwm::SetOutputMode(Pwm::PWM2);
+            Pwm::SetPulse(_pulseDelay);
+            Pwm::template SelectPins<_Pin>();
+
+            if constexpr (!std::is_same_v<_DirPin, IO::NullPin>)
+            {
+                _DirPin::Port::Enable();
+                _DirPin::template SetConfiguration<_DirPin::Configuration::Out>();
+                _DirPin::template SetDriverType<_DirPin::DriverType::PushPull>();
+            }
+        }
+
+        /**
+         * @brief Prepares move (fills DMA buffer), timer is not started
+         *
+         * @details
+         * Use it with @ref Start to start several axes simultaneously
+         * (or start master timer if axes timers are trigger slaves).
+         *
+         * @param [in] steps Steps (sign is direction)
+         * @param [in] speed Max speed (steps per second)
+         * @param [in] acceleration Acceleration (steps per second^2, 0 for move without ramp)
+         * @param [in] callback Move complete callback
+         *
+         * @retval true Move is prepared
+         * @retval false Move is in progress or invalid parameters
+         */
+        static bool Prepare(int32_t steps, uint32_t speed, uint32_t acceleration, std::add_pointer_t<void()> callback = nullptr)
+        {
+            if (_busy || steps == 0 || speed == 0)
+                return false;
+
+            if constexpr (!std::is_same_v<_DirPin, IO::NullPin>)
+            {
+                if (steps > 0)
+                    _DirPin::Set();
+                else
+                    _DirPin::Clear();
+            }
+
+            uint32_t count = steps > 0 ? steps : -static_cast<uint32_t>(steps);
+            _ramp.Start(count, speed, acceleration, _tickFrequency, _pulseDelay + 1, MaxInterval);
+            _callback = callback;
+            _completedBlocks = 0;
+
+            // First two periods are written directly: ARR and its preload value
+            _Timer::Stop();
+            _Timer::DisablePeriodPreload();
+            _Timer::SetPeriod(NextPeriod());
+            _Timer::ResetCounterValue();
+            _Timer::EnablePeriodPreload();
+            _Timer::SetPeriod(NextPeriod());
+
+            _dataBlocks = 0;
+            if (count > 2)
+                _dataBlocks = (count - 2 + _BlockSize - 1) / _BlockSize;
+            FillBlock(_buffer);
+            FillBlock(_buffer + _BlockSize);
+
+            _DmaChannel::SetDoubleBufferedTransferCallback(BlockHandler);
+            _DmaChannel::TransferDoubleBuffered(_DmaChannel::Mem2Periph | _DmaChannel::MemIncrement | _DmaChannel::PriorityHigh
+                                            | _DmaChannel::PSize16Bits | _DmaChannel::MSize16Bits,
+                                            _buffer, _buffer + _BlockSize, _Timer::PeriodRegister(), _BlockSize);
+            _Timer::DmaRequestEnable();
+            _busy = true;
+            return true;
+        }
+
+        /**
+         * @brief Starts prepared move
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start()
+        {
+            if (_busy)
+                _Timer::Start();
+        }
+
+        /**
+         * @brief Starts move
+         *
+         * @param [in] steps Steps (sign is direction)
+         * @param [in] speed Max speed (steps per second)
+         * @param [in] acceleration Acceleration (steps per second^2, 0 for move without ramp)
+         * @param [in] callback Move complete callback
+         *
+         * @retval true Move is started
+         * @retval false Move is in progress or invalid parameters
+         */
+        static bool Move(int32_t steps, uint32_t speed, uint32_t acceleration, std::add_pointer_t<void()> callback = nullptr)
+        {
+            if (!Prepare(steps, speed, acceleration, callback))
+                return false;
+
+            Start();
+            return true;
+        }
+
+        /**
+         * @brief Decelerates to stop (move is completed with ramp from current speed)
+         *
+         * @details
+         * Buffered steps (up to two blocks) are sent before deceleration.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Decelerate()
+        {
+            NVIC_DisableIRQ(_DmaChannel::IRQNumber);
+            _ramp.Decelerate();
+            NVIC_EnableIRQ(_DmaChannel::IRQNumber);
+        }
+
+        /**
+         * @brief Stops immediately (without ramp, so steps may be lost), callback is not called
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop()
+        {
+            _Timer::Stop();
+            _Timer::DmaRequestDisable();
+            _DmaChannel::Disable();
+            _busy = false;
+        }
+
+        /**
+         * @brief Check that move is in progress
+         *
+         * @retval true Move is in progress
+         * @retval false Axis is stopped
+         */
+        static bool Busy()
+        {
+            return _busy;
+        }
+
+    private:
+        static Counter NextPeriod()
+        {
+            // Period shorter than pulse delay has no pulse
+            return _ramp.Done()
+                ? static_cast<Counter>(_pulseDelay - 1)
+                : static_cast<Counter>(_ramp.Next() - 1);
+        }
+
+        static void FillBlock(Counter* block)
+        {
+            for (unsigned slot = 0; slot < _BlockSize; ++slot)
+                block[slot] = NextPeriod();
+        }
+
+        static void BlockHandler(void* data, unsigned, unsigned)
+        {
+            // Last period of data block is written to preload, so it's completed during next block
+            if (++_completedBlocks > _dataBlocks)
+            {
+                Stop();
+
+                if (_callback)
+                    _callback();
+                return;
+            }
+
+            FillBlock(static_cast<Counter*>(data));
+        }
+
+        static inline Private::StepperRampGenerator _ramp;
+        static inline Counter _buffer[2 * _BlockSize];
+        static inline uint32_t _tickFrequency = 1000000;
+        static inline uint32_t _pulseDelay = 5;
+        static inline uint32_t _dataBlocks;
+        static inline volatile uint32_t _completedBlocks;
+        static inline std::add_pointer_t<void()> _callback;
+        static inline volatile bool _busy = false;
+    };
+
+    /**
+     * @brief Implements synchronised (linear) move of several axes
+     *
+     * @details
+     * Speed and acceleration of every axis are scaled by its steps count (relative to the longest axis),
+     * so all axes have the same ramp duration and finish together. Axes timers are started one by one
+     * with disabled interrupts (skew is few CPU cycles). For exact start configure axes timers
+     * as trigger slaves (SlaveMode::TriggerMode) of one master timer, call @ref Prepare and start master.
+     *
+     * @par Example
+     * @code
+     *  using Axes = Drivers::StepperGroup<AxisX, AxisY>;
+     *  Axes::Move(40000, 80000, 3200, -1600);
+     * @endcode
+     *
+     * @tparam _Axes Axes (@ref StepperRamp)
+     */
+    template <typename... _Axes>
+    class StepperGroup
+    {
+        static_assert(sizeof...(_Axes) > 0, "Group must contain at least one axis");
+    public:
+        /**
+         * @brief Prepares move of all axes
+         *
+         * @param [in] speed Speed of the longest axis (steps per second)
+         * @param [in] acceleration Acceleration of the longest axis (steps per second^2)
+         * @param [in] steps Steps of axes (sign is direction)
+         *
+         * @retval true Move is prepared
+         * @retval false Some axis is busy or speed is zero
+         */
+        template <typename... _Steps>
+        static bool Prepare(uint32_t speed, uint32_t acceleration, _Steps... steps)
+        {
+            static_assert(sizeof...(_Steps) == sizeof...(_Axes), "Steps count must be specified for every axis");
+
+            if (Busy() || speed == 0)
+                return false;
+
+            uint32_t longest = 0;
+            ((longest = Abs(steps) > longest ? Abs(steps) : longest), ...);
+            if (longest == 0)
+                return false;
+
+            (PrepareAxis<_Axes>(static_cast<int32_t>(steps), speed, acceleration, longest), ...);
+            return true;
+        }
+
+        /**
+         * @brief Starts prepared move
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            (_Axes::Start(), ...);
+            __set_PRIMASK(primask);
+        }
+
+        /**
+         * @brief Starts move of all axes
+         *
+         * @param [in] speed Speed of the longest axis (steps per second)
+         * @param [in] acceleration Acceleration of the longest axis (steps per second^2)
+         * @param [in] steps Steps of axes (sign is direction)
+         *
+         * @retval true Move is started
+         * @retval false Some axis is busy or speed is zero
+         */
+        template <typename... _Steps>
+        static bool Move(uint32_t speed, uint32_t acceleration, _Steps... steps)
+        {
+            if (!Prepare(speed, acceleration, steps...))
+                return false;
+
+            Start();
+            return true;
+        }
+
+        /**
+         * @brief Check that move is in progress
+         *
+         * @retval true Some axis moves
+         * @retval false All axes are stopped
+         */
+        static bool Busy()
+        {
+            return (_Axes::Busy() || ...);
+        }
+
+    private:
+        static uint32_t Abs(int32_t steps)
+        {
+            return steps >= 0 ? steps : -static_cast<uint32_t>(steps);
+        }
+
+        template <typename _Axis>
+        static void PrepareAxis(int32_t steps, uint32_t speed, uint32_t acceleration, uint32_t longest)
+        {
+            if (steps == 0)
+                return;
+
+            uint32_t axisSpeed = static_cast<uint64_t>(speed) * Abs(steps) / longest;
+            uint32_t axisAcceleration = static_cast<uint64_t>(acceleration) * Abs(steps) / longest;
+            if (acceleration != 0 && axisAcceleration == 0)
+                axisAcceleration = 1;
+            _Axis::Prepare(steps, axisSpeed > 0 ? axisSpeed : 1, axisAcceleration);
+        }
+    };
+}
+
+#endif //! ZHELE_DRIVERS_STEPPER_RAMP_H
@@ -15,8 +15,17 @@
 
 #include <limits>
 #include <cstdint>
+#include <type_traits>
 
+#include <zhele/containers/ring_buffer.h>
+#include <zhele/delay.h>
 #include <zhele/iopins.h>
+#include <zhele/soft_crc.h>
+
+#if !defined (ZHELE_TMC2209_FULL_REGISTER_SET)
+    /// Write all configuration registers on init and cache write-only registers (0 - rely on power-on defaults, smaller code and RAM)
+    #define ZHELE_TMC2209_FULL_REGISTER_SET 1
+#endif
 
 namespace Zhele::Drivers {
     /**
@@ -90,6 +99,278 @@ namespace Zhele::Drivers {
         }
     };
 
+    /**
+     * @brief Implements TMC22xx UART transaction engine (datagrams queue with DMA transfers)
+     * 
+     * @details
+     * Write and read datagrams of all drivers on one UART (drivers with different serial address)
+     * are queued and started one by one from DMA receive complete handler of previous transaction.
+     * Half-duplex single wire UART receives own transmission, so every transaction receives echo of
+     * sent datagram (and reply datagram for read), echo and reply are checked (sync byte, address, CRC).
+     * Lost reply doesn't complete DMA transfer, so call @ref poll periodically (or use blocking @ref wait):
+     * transaction that doesn't complete in time is aborted with error.
+     * 
+     * @note Engine owns DMA transfer callbacks of UART. UART DMA IRQ handlers should call DmaTx/DmaRx::IrqHandler as usual.
+     * 
+     * @tparam _uart UART (with DMA channels)
+     * @tparam _depth Transactions queue depth
+    */
+    template<typename _uart, unsigned _depth = 8>
+    class tmc2209_bus
+    {
+        static_assert(!std::is_same_v<typename _uart::DmaTx, void> && !std::is_same_v<typename _uart::DmaRx, void>,
+            "TMC2209 transaction engine requires UART with DMA channels");
+
+        static const uint8_t SYNC_BYTE = 0x05;
+        static const uint8_t REPLY_ADDRESS = 0xff;
+        static const uint8_t READ_REQUEST_SIZE = 4;
+        static const uint8_t DATAGRAM_SIZE = 8;
+        static const unsigned STALL_POLLS = 3;
+        static const unsigned WAIT_STEP_US = 100;
+        static const unsigned WAIT_TIMEOUT_STEPS = 50;
+    public:
+        /// @brief Transaction complete callback (data is read value or written value)
+        using callback_type = std::add_pointer_t<void(bool success, uint8_t serial_address, uint8_t register_address, uint32_t data)>;
+
+        /**
+         * @brief Queues register write
+         * 
+         * @param [in] serial_address Driver serial address
+         * @param [in] register_address Register address
+         * @param [in] data Register value
+         * @param [in] callback Transaction complete callback (may be nullptr)
+         * 
+         * @retval true Transaction is queued
+         * @retval false Queue is full
+        */
+        static bool write(uint8_t serial_address, uint8_t register_address, uint32_t data, callback_type callback = nullptr) {
+            job_type job{{SYNC_BYTE, serial_address, static_cast<uint8_t>(register_address | 0x80),
+                static_cast<uint8_t>(data >> 24), static_cast<uint8_t>(data >> 16), static_cast<uint8_t>(data >> 8), static_cast<uint8_t>(data)},
+                DATAGRAM_SIZE, callback};
+            job.datagram[DATAGRAM_SIZE - 1] = Crc8Tmc::Calculate(job.datagram, DATAGRAM_SIZE - 1);
+            return enqueue(job);
+        }
+
+        /**
+         * @brief Queues register read
+         * 
+         * @param [in] serial_address Driver serial address
+         * @param [in] register_address Register address
+         * @param [in] callback Transaction complete callback (may be nullptr)
+         * 
+         * @retval true Transaction is queued
+         * @retval false Queue is full
+        */
+        static bool read(uint8_t serial_address, uint8_t register_address, callback_type callback) {
+            job_type job{{SYNC_BYTE, serial_address, static_cast<uint8_t>(register_address & 0x7f)}, READ_REQUEST_SIZE, callback};
+            job.datagram[READ_REQUEST_SIZE - 1] = Crc8Tmc::Calculate(job.datagram, READ_REQUEST_SIZE - 1);
+            return enqueue(job);
+        }
+
+        /**
+         * @brief Returns engine state
+         * 
+         * @retval true There is active transaction
+         * @retval false Engine is idle
+        */
+        static bool busy() {
+            return busy_;
+        }
+
+        /**
+         * @brief Returns queued (not started) transactions count
+         * 
+         * @returns Transactions count
+        */
+        static unsigned pending() {
+            return queue_.size();
+        }
+
+        /**
+         * @brief Returns failed transactions count (CRC or echo errors and timeouts)
+         * 
+         * @returns Errors count
+        */
+        static unsigned errors() {
+            return errors_;
+        }
+
+        /**
+         * @brief Checks active transaction timeout (call it periodically, for example from servo tick)
+         * 
+         * @details
+         * Transaction that is active during three calls is aborted,
+         * so period of calls should be greater than transaction time (about 1 ms at 115200 baud).
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void poll() {
+            if (!busy_) {
+                stall_polls_ = 0;
+                return;
+            }
+            if (polled_sequence_ != sequence_) {
+                polled_sequence_ = sequence_;
+                stall_polls_ = 0;
+            }
+            if (++stall_polls_ >= STALL_POLLS) {
+                stall_polls_ = 0;
+                abort(polled_sequence_);
+            }
+        }
+
+        /**
+         * @brief Waits until flag is set (transaction callback sets it), aborts stalled transactions
+         * 
+         * @param [in] done Flag
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void wait(const volatile bool& done) {
+            waitUntil([&done]() { return done; });
+        }
+
+        /**
+         * @brief Waits until queue has free place, aborts stalled transactions
+         * 
+         * @par Returns
+         *  Nothing
+        */
+        static void waitQueueSpace() {
+            waitUntil([]() { return !queue_.full(); });
+        }
+
+    private:
+        /// @brief Transaction
+        struct job_type
+        {
+            uint8_t datagram[DATAGRAM_SIZE]; ///< Sent datagram
+            uint8_t size; ///< Sent datagram size
+            callback_type callback; ///< Complete callback
+        };
+
+        template<typename _condition>
+        static void waitUntil(_condition condition) {
+            unsigned sequence = sequence_;
+            unsigned steps = 0;
+            while (!condition()) {
+                delay_us<WAIT_STEP_US>();
+                if (sequence != sequence_) {
+                    sequence = sequence_;
+                    steps = 0;
+                } else if (busy_ && ++steps >= WAIT_TIMEOUT_STEPS) {
+                    abort(sequence);
+                    steps = 0;
+                }
+            }
+        }
+
+        static bool enqueue(const job_type& job) {
+            bool result = true;
+
+            lock();
+            if (!busy_) {
+                busy_ = true;
+                run(job);
+            } else {
+                result = queue_.push_back(job);
+            }
+            unlock();
+
+            return result;
+        }
+
+        static void run(const job_type& job) {
+            active_ = job;
+            ++sequence_;
+
+            // drop stale bytes (and overrun flag) before echo receiving
+            while (_uart::ReadReady())
+                _uart::Read();
+
+            uint8_t expected = job.size + (job.size == READ_REQUEST_SIZE ? DATAGRAM_SIZE : 0);
+            _uart::EnableAsyncRead(receive_buffer_, expected, receiveComplete);
+            _uart::WriteAsync(active_.datagram, job.size);
+        }
+
+        static void runNext() {
+            if (queue_.empty()) {
+                busy_ = false;
+                return;
+            }
+
+            job_type next = queue_.front();
+            queue_.pop_front();
+            run(next);
+        }
+
+        static void complete(bool success) {
+            callback_type callback = active_.callback;
+            bool read = active_.size == READ_REQUEST_SIZE;
+            uint8_t serial_address = active_.datagram[1];
+            uint8_t register_address = active_.datagram[2] & 0x7f;
+            uint32_t data = 0;
+
+            if (success) {
+                for (uint8_t i = 0; i < active_.size; ++i)
+                    success &= receive_buffer_[i] == active_.datagram[i];
+            }
+            if (success && read) {
+                const uint8_t* reply = receive_buffer_ + READ_REQUEST_SIZE;
+                success = reply[0] == SYNC_BYTE
+                    && reply[1] == REPLY_ADDRESS
+                    && reply[2] == register_address
+                    && reply[DATAGRAM_SIZE - 1] == Crc8Tmc::Calculate(reply, DATAGRAM_SIZE - 1);
+                data = (uint32_t(reply[3]) << 24) | (uint32_t(reply[4]) << 16) | (uint32_t(reply[5]) << 8) | reply[6];
+            } else if (!read) {
+                data = (uint32_t(active_.datagram[3]) << 24) | (uint32_t(active_.datagram[4]) << 16) | (uint32_t(active_.datagram[5]) << 8) | active_.datagram[6];
+            }
+            if (!success)
+                ++errors_;
+
+            runNext();
+
+            if (callback != nullptr)
+                callback(success, serial_address, register_address, data);
+        }
+
+        static void receiveComplete(void* data, unsigned size, bool success) {
+            complete(success);
+        }
+
+        static void abort(unsigned sequence) {
+            lock();
+            // transaction may be completed while handler is locked
+            if (busy_ && sequence == sequence_ && _uart::DmaRx::RemainingTransfers() != 0) {
+                _uart::DmaRx::Disable();
+                _uart::DmaRx::ClearFlags();
+                complete(false);
+            }
+            unlock();
+        }
+
+        static void lock() {
+            NVIC_DisableIRQ(_uart::DmaTx::IRQNumber);
+            NVIC_DisableIRQ(_uart::DmaRx::IRQNumber);
+        }
+
+        static void unlock() {
+            NVIC_EnableIRQ(_uart::DmaTx::IRQNumber);
+            NVIC_EnableIRQ(_uart::DmaRx::IRQNumber);
+        }
+
+        static inline Containers::RingBuffer<_depth, job_type> queue_;
+        static inline job_type active_;
+        static inline uint8_t receive_buffer_[READ_REQUEST_SIZE + DATAGRAM_SIZE];
+        static inline volatile bool busy_ = false;
+        static inline volatile unsigned sequence_ = 0;
+        static inline unsigned polled_sequence_ = 0;
+        static inline unsigned stall_polls_ = 0;
+        static inline volatile unsigned errors_ = 0;
+    };
+
     /**
      * @brief Implements stepper motor control over TMC2226 (2209) driver by UART
     */
@@ -166,40 +447,6 @@ namespace Zhele::Drivers {
             uint32_t standstill : 1;
         };
 
-        /// @brief Write-read-reply datagram
-        union WriteReadReplyDatagram {
-            struct {
-                uint64_t sync : 4;
-                uint64_t reserved : 4;
-                uint64_t serial_address : 8;
-                uint64_t register_address : 7;
-                uint64_t rw : 1;
-                uint64_t data : 32;
-                uint64_t crc : 8;
-            };
-            uint64_t bytes;
-        };
-        static_assert(sizeof(WriteReadReplyDatagram) == 8, "Invalid WriteReadReplyDatagram size!");
-        const static uint8_t SYNC = 0b101;
-        const static uint8_t RW_READ = 0;
-        const static uint8_t RW_WRITE = 1;
-        const static uint8_t READ_REPLY_SERIAL_ADDRESS = 0b11111111;
-
-
-        /// @brief Read request datagram
-        union ReadRequestDatagram {
-            struct {
-                uint32_t sync : 4;
-                uint32_t reserved : 4;
-                uint32_t serial_address : 8;
-                uint32_t register_address : 7;
-                uint32_t rw : 1;
-                uint32_t crc : 8;
-            };
-            uint32_t bytes;
-        };
-        static_assert(sizeof(ReadRequestDatagram) == 4, "Invalid ReadRequestDatagram size!");
-
         // General Configuration Registers
 
         /// @brief GCONF
@@ -446,9 +693,26 @@ namespace Zhele::Drivers {
         const static uint8_t STEPPER_DRIVER_FEATURE_OFF = 0;
         const static uint8_t STEPPER_DRIVER_FEATURE_ON = 1;
 
+        /// @brief Shadow registers (last written values of write-only registers)
+        const static uint8_t SHADOW_REGISTERS_COUNT = 10;
+        const static uint8_t NO_SHADOW = 0xff;
+        static uint32_t shadow_[SHADOW_REGISTERS_COUNT];
+        static uint16_t shadow_valid_;
+
+        static volatile bool read_done_;
+        static volatile bool read_success_;
+        static volatile uint32_t read_value_;
+
+        static DriveStatus last_status_;
+        static volatile uint16_t last_stall_guard_result_;
+        static volatile uint8_t requests_pending_;
+
     public:
         static_assert(_serial_address <= 3, "Serial address can be only 0..3");
 
+        /// @brief UART transaction engine (all drivers on UART share it, call bus::poll periodically for async requests)
+        using bus = tmc2209_bus<_uart>;
+
         /**
          * @brief Initialize driver
          * 
@@ -1084,6 +1348,57 @@ namespace Zhele::Drivers {
             return read(ADDRESS_SG_RESULT);
         }
 
+        /**
+         * @brief Queues status (DRV_STATUS) read, doesn't wait reply
+         * 
+         * @details
+         * Requests of drivers with different addresses on one UART are queued,
+         * so all axes can be polled without waiting. Result is returned by @ref lastStatus.
+         * 
+         * @retval true Request is queued
+         * @retval false Queue is full
+        */
+        static bool requestStatus() {
+            return request(ADDRESS_DRV_STATUS);
+        }
+
+        /**
+         * @brief Returns status received by last successful @ref requestStatus
+         * 
+         * @returns Status
+        */
+        static Status lastStatus() {
+            return last_status_.status;
+        }
+
+        /**
+         * @brief Queues StallGuard result read, doesn't wait reply
+         * 
+         * @retval true Request is queued
+         * @retval false Queue is full
+        */
+        static bool requestStallGuardResult() {
+            return request(ADDRESS_SG_RESULT);
+        }
+
+        /**
+         * @brief Returns StallGuard result received by last successful @ref requestStallGuardResult
+         * 
+         * @returns StallGuard result
+        */
+        static uint16_t lastStallGuardResult() {
+            return last_stall_guard_result_;
+        }
+
+        /**
+         * @brief Returns queued async requests count
+         * 
+         * @returns Requests count (0 if all replies are received or failed)
+        */
+        static uint8_t requestsPending() {
+            return requests_pending_;
+        }
+
         /**
          * @brief Returns PWM scale sum
          * 
@@ -1144,6 +1459,7 @@ namespace Zhele::Drivers {
     private:
         static void initialize()
         {
+            invalidateShadowRegisters();
             setOperationModeToSerial();
             setRegistersToDefaults();
 
@@ -1153,18 +1469,6 @@ namespace Zhele::Drivers {
             disableAutomaticGradientAdaptation();
         }
 
-        static bool serialAvailable() {
-            return _uart::ReadReady();
-        }
-
-        static void serialWrite(uint8_t c) {
-            _uart::Write(c);
-        }
-
-        static uint8_t serialRead() {
-            return _uart::Read();
-        }
-
         static void setOperationModeToSerial() {
             global_config_.bytes = 0;
             global_config_.i_scale_analog = 0;
@@ -1180,19 +1484,24 @@ namespace Zhele::Drivers {
             driver_current_.ihold = IHOLD_DEFAULT;
             driver_current_.irun = IRUN_DEFAULT;
             driver_current_.iholddelay = IHOLDDELAY_DEFAULT;
-            write(ADDRESS_IHOLD_IRUN, driver_current_.bytes);
 
             chopper_config_.bytes = CHOPPER_CONFIG_DEFAULT;
             chopper_config_.tbl = TBL_DEFAULT;
             chopper_config_.hend = HEND_DEFAULT;
             chopper_config_.hstart = HSTART_DEFAULT;
             chopper_config_.toff = TOFF_DEFAULT;
-            write(ADDRESS_CHOPCONF, chopper_config_.bytes);
 
             pwm_config_.bytes = PWM_CONFIG_DEFAULT;
-            write(ADDRESS_PWMCONF, pwm_config_.bytes);
-
             cool_config_.bytes = COOLCONF_DEFAULT;
+
+            // IHOLD_IRUN, CHOPCONF and PWMCONF are written by initialize, others have power-on values.
+            // Minimal register set doesn't restore them, so driver should be power cycled with MCU.
+            if constexpr (!ZHELE_TMC2209_FULL_REGISTER_SET)
+                return;
+
+            write(ADDRESS_IHOLD_IRUN, driver_current_.bytes);
+            write(ADDRESS_CHOPCONF, chopper_config_.bytes);
+            write(ADDRESS_PWMCONF, pwm_config_.bytes);
             write(ADDRESS_COOLCONF, cool_config_.bytes);
 
             write(ADDRESS_TPOWERDOWN, TPOWERDOWN_DEFAULT);
@@ -1222,98 +1531,84 @@ namespace Zhele::Drivers {
             writeStoredDriverCurrent();
         }
 
-        static uint32_t reverseData(uint32_t data) {
-            uint32_t reversed_data = 0;
-            uint8_t right_shift;
-            uint8_t left_shift;
-            for (int i = 0; i < sizeof(data); ++i)
-            {
-                right_shift = (sizeof(data) - i - 1) * std::numeric_limits<uint8_t>::digits;
-                left_shift = i * std::numeric_limits<uint8_t>::digits;
-                reversed_data |= ((data >> right_shift) & std::numeric_limits<uint8_t>::max()) << left_shift;
+        static constexpr uint8_t shadowIndex(uint8_t register_address) {
+            switch (register_address) {
+                case ADDRESS_GCONF: return 0;
+                case ADDRESS_IHOLD_IRUN: return 1;
+                case ADDRESS_TPOWERDOWN: return 2;
+                case ADDRESS_TPWMTHRS: return 3;
+                case ADDRESS_TCOOLTHRS: return 4;
+                case ADDRESS_VACTUAL: return 5;
+                case ADDRESS_SGTHRS: return 6;
+                case ADDRESS_COOLCONF: return 7;
+                case ADDRESS_CHOPCONF: return 8;
+                case ADDRESS_PWMCONF: return 9;
+                default: return NO_SHADOW;
             }
-            return reversed_data;
         }
 
-        static uint8_t calculateCrc(auto&& datagram) {
-            uint8_t crc = 0;
-            uint8_t byte;
-            for (int i = 0; i < (sizeof(datagram) - 1); ++i)
-            {
-                byte = (datagram.bytes >> (i * std::numeric_limits<uint8_t>::digits)) & std::numeric_limits<uint8_t>::max();
-                for (int j = 0; j < std::numeric_limits<uint8_t>::digits; ++j)
-                {
-                    if ((crc >> 7) ^ (byte & 0x01)) {
-                        crc = (crc << 1) ^ 0x07;
-                    }
-                    else {
-                        crc = crc << 1;
-                    }
-                    byte = byte >> 1;
+        static void write(uint8_t register_address, uint32_t data) {
+            if constexpr (ZHELE_TMC2209_FULL_REGISTER_SET) {
+                uint8_t index = shadowIndex(register_address);
+                if (index != NO_SHADOW) {
+                    // value is already written (write registers can't be read back, so cache is only way to skip it)
+                    if ((shadow_valid_ & (1u << index)) && shadow_[index] == data)
+                        return;
+                    shadow_[index] = data;
+                    shadow_valid_ |= (1u << index);
                 }
+
+                while (!bus::write(_serial_address, register_address, data, writeComplete))
+                    bus::waitQueueSpace();
+            } else {
+                // no cache, every write goes to bus
+                while (!bus::write(_serial_address, register_address, data))
+                    bus::waitQueueSpace();
             }
-            return crc;
         }
 
-        static void sendDatagramUnidirectional(auto&& datagram) {
-            for (int i = 0; i < sizeof(datagram); ++i) {
-                uint8_t byte = (datagram.bytes >> (i * std::numeric_limits<uint8_t>::digits)) & std::numeric_limits<uint8_t>::max();
-                serialWrite(byte);
-            }
+        static void writeComplete(bool success, uint8_t serial_address, uint8_t register_address, uint32_t data) {
+            uint8_t index = shadowIndex(register_address);
+            if (!success && index != NO_SHADOW)
+                shadow_valid_ &= ~(1u << index);
         }
 
-        static void sendDatagramBidirectional(auto&& datagram) {
-            // clear the serial receive buffer if necessary
-            while (serialAvailable())
-                serialRead();
+        static void invalidateShadowRegisters() {
+            if constexpr (ZHELE_TMC2209_FULL_REGISTER_SET)
+                shadow_valid_ = 0;
+        }
 
-            // write datagram
-            for (int i = 0; i < sizeof(datagram); ++i) {
-                uint8_t byte = (datagram.bytes >> (i * std::numeric_limits<uint8_t>::digits)) & std::numeric_limits<uint8_t>::max();
-                serialWrite(byte);
-            }
+        static uint32_t read(uint8_t register_address) {
+            read_done_ = false;
+            read_success_ = false;
+            while (!bus::read(_serial_address, register_address, readComplete))
+                bus::waitQueueSpace();
+            bus::wait(read_done_);
 
-            while (serialAvailable())
-                serialRead();
+            return read_success_ ? read_value_ : 0;
         }
 
-        static void write(uint8_t register_address, uint32_t data) {
-            WriteReadReplyDatagram write_datagram;
-            write_datagram.bytes = 0;
-            write_datagram.sync = SYNC;
-            write_datagram.serial_address = _serial_address;
-            write_datagram.register_address = register_address;
-            write_datagram.rw = RW_WRITE;
-            write_datagram.data = reverseData(data);
-            write_datagram.crc = calculateCrc(write_datagram);
-
-            sendDatagramUnidirectional(write_datagram);
+        static void readComplete(bool success, uint8_t serial_address, uint8_t register_address, uint32_t data) {
+            read_value_ = data;
+            read_success_ = success;
+            read_done_ = true;
         }
 
-        static uint32_t read(uint8_t register_address) {
-            ReadRequestDatagram read_request_datagram;
-            read_request_datagram.bytes = 0;
-            read_request_datagram.sync = SYNC;
-            read_request_datagram.serial_address = _serial_address;
-            read_request_datagram.register_address = register_address;
-            read_request_datagram.rw = RW_READ;
-            read_request_datagram.crc = calculateCrc(read_request_datagram);
-
-            sendDatagramBidirectional(read_request_datagram);
-
-            uint64_t byte;
-            uint8_t byte_count = 0;
-            WriteReadReplyDatagram read_reply_datagram;
-            read_reply_datagram.bytes = 0;
-            for (uint8_t i = 0; i < sizeof(read_reply_datagram); ++i) {
-                if (!serialAvailable())
-                    return 0;
-
-                byte = serialRead();
-                read_reply_datagram.bytes |= (byte << (byte_count++ * std::numeric_limits<uint8_t>::digits));
+        static void requestComplete(bool success, uint8_t serial_address, uint8_t register_address, uint32_t data) {
+            if (success) {
+                if (register_address == ADDRESS_DRV_STATUS)
+                    last_status_.bytes = data;
+                else if (register_address == ADDRESS_SG_RESULT)
+                    last_stall_guard_result_ = data;
             }
+            --requests_pending_;
+        }
 
-            return reverseData(read_reply_datagram.data);
+        static bool request(uint8_t register_address) {
+            if (!bus::read(_serial_address, register_address, requestComplete))
+                return false;
+            ++requests_pending_;
+            return true;
         }
 
         static uint8_t percentToCurrentSetting(uint8_t percent) {
@@ -1427,5 +1722,29 @@ namespace Zhele::Drivers {
 
     template<typename _uart, typename _tx_pin, uint8_t _serial_address, typename _rx_pin, typename _en_pin>
     inline tmc2209<_uart, _tx_pin, _serial_address, _rx_pin, _en_pin>::PwmConfig tmc2209<_uart, _tx_pin, _serial_address, _rx_pin, _en_pin>::pwm_config_;
+
+    template<typename _uart, typename _tx_pin, uint8_t _serial_address, typename _rx_pin, typename _en_pin>
+    inline uint32_t tmc2209<_uart, _tx_pin, _serial_address, _rx_pin, _en_pin>::shadow_[tmc2209<_uart, _tx_pin, _serial_address, _rx_pin, _en_pin>::SHADOW_REGISTERS_COUNT];
+
+    template<typename _uart, typename _tx_pin, uint8_t _serial_address, typename _rx_pin, typename _en_pin>
+    inline uint16_t tmc2209<_uart, _tx_pin, _serial_address, _rx_pin, _en_pin>::shadow_valid_ = 0;
+
+    template<typename _uart, typename _tx_pin, uint8_t _serial_address, typename _rx_pin, typename _en_pin>
+    inline volatile bool tmc2209<_uart, _tx_pin, _serial_address, _rx_pin, _en_pin>::read_done_;
+
+    template<typename _uart, typename _tx_pin, uint8_t _serial_address, typename _rx_pin, typename _en_pin>
+    inline volatile bool tmc2209<_uart, _tx_pin, _serial_address, _rx_pin, _en_pin>::read_success_;
+
+    template<typename _uart, typename _tx_pin, uint8_t _serial_address, typename _rx_pin, typename _en_pin>
+    inline volatile uint32_t tmc2209<_uart, _tx_pin, _serial_address, _rx_pin, _en_pin>::read_value_;
+
+    template<typename _uart, typename _tx_pin, uint8_t _serial_address, typename _rx_pin, typename _en_pin>
+    inline tmc2209<_uart, _tx_pin, _serial_address, _rx_pin, _en_pin>::DriveStatus tmc2209<_uart, _tx_pin, _serial_address, _rx_pin, _en_pin>::last_status_;
+
+    template<typename _uart, typename _tx_pin, uint8_t _serial_address, typename _rx_pin, typename _en_pin>
+    inline volatile uint16_t tmc2209<_uart, _tx_pin, _serial_address, _rx_pin, _en_pin>::last_stall_guard_result_;
+
+    template<typename _uart, typename _tx_pin, uint8_t _serial_address, typename _rx_pin, typename _en_pin>
+    inline volatile uint8_t tmc2209<_uart, _tx_pin, _serial_address, _rx_pin, _en_pin>::requests_pending_ = 0;
 }
 #endif //! ZHELE_DRIVERS_TMC2209_H_
@@ -0,0 +1,230 @@
+/**
+ * @file
+ * Driver for WS2812 (and compatible) addressable LEDs
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_WS2812_H
+#define ZHELE_DRIVERS_WS2812_H
+
+#include <zhele/dma.h>
+#include <zhele/timer.h>
+
+#include <cstdint>
+
+namespace Zhele::Drivers
+{
+    /// LED color (in WS2812 wire order)
+    struct Ws2812Color
+    {
+        uint8_t green; ///< Green
+        uint8_t red; ///< Red
+        uint8_t blue; ///< Blue
+    };
+
+    /**
+     * @brief Class for WS2812 LED strip
+     *
+     * @details
+     * Every bit is one PWM period (800 kHz), pulse width encodes bit value.
+     * Pulses are transferred to CCR by DMA on timer update event through double (circular) buffer
+     * with _PixelsPerBlock pixels per block, blocks are encoded in DMA interrupt while other block is being sent.
+     * So RAM usage does not depend on strip length.
+     *
+     * @par Example
+     * @code
+     *  using Strip = Drivers::Ws2812<Timers::Timer2, 0, Dma1Channel2>;
+     *  Drivers::Ws2812Color pixels[1000];
+     *  Strip::Init();
+     *  Strip::Show(pixels, 1000);
+     * @endcode
+     *
+     * @tparam _Timer GP timer
+     * @tparam _Channel Timer channel
+     * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+     * @tparam _Pin Output pin
+     * @tparam _PixelsPerBlock Pixels count in one DMA buffer block
+     */
+    template <typename _Timer, unsigned _Channel, typename _DmaChannel,
+            typename _Pin = typename _Timer::template OutputCompare<_Channel>::Pins::template Pin<0>,
+            unsigned _PixelsPerBlock = 8>
+    class Ws2812
+    {
+        using Pwm = typename _Timer::template PWMGeneration<_Channel>;
+        using Counter = typename _Timer::Counter;
+
+        static const unsigned BitsPerPixel = 24;
+        static const unsigned BlockSize = _PixelsPerBlock * BitsPerPixel;
+
+        // Reset (latch) time is at least 280 us (newer LEDs), bit time is 1.25 us
+        static const unsigned ResetBits = 224;
+        static const unsigned ResetBlocks = (ResetBits + BlockSize - 1) / BlockSize;
+    public:
+        /// Bit rate
+        static const unsigned long BitRate = 800000;
+
+        /**
+         * @brief Init timer, PWM channel and pin
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+            uint32_t period = _Timer::GetClockFreq() / BitRate;
+            // T0H = 0.4 us, T1H = 0.8 us (of 1.25 us)
+            _zeroPulse = static_cast<Counter>(period * 8 / 25);
+            _onePulse = static_cast<Counter>(period * 16 / 25);
+
+            _Timer::Enable();
+            _Timer::Stop();
+            _Timer::SetPrescaler(0);
+            _Timer::SetPeriod(period - 1);
+
+            Pwm::SetOutputPolarity(Pwm::ActiveHigh);
+            Pwm::SetOutputMode(Pwm::PWM1);
+            Pwm::EnablePreload();
+            Pwm::SetPulse(0);
+            Pwm::template SelectPins<_Pin>();
+        }
+
+        /**
+         * @brief Start sending pixels (non-blocking)
+         *
+         * @param [in] pixels Pixels (must be valid until transfer complete)
+         * @param [in] count Pixels count
+         * @param [in] callback Complete callback (called after reset time)
+         *
+         * @retval true Transfer started
+         * @retval false Previous transfer is in progress or no pixels
+         */
+        static bool Show(const Ws2812Color* pixels, uint16_t count, std::add_pointer_t<void()> callback = nullptr)
+        {
+            if (_busy || count == 0)
+                return false;
+
+            _busy = true;
+            _pixels = pixels;
+            _count = count;
+            _next = 0;
+            _completedBlocks = 0;
+            _dataBlocks = (count + _PixelsPerBlock - 1) / _PixelsPerBlock;
+            _callback = callback;
+
+            FillBlock(_buffer);
+            FillBlock(_buffer + BlockSize);
+
+            _DmaChannel::SetDoubleBufferedTransferCallback(BlockHandler);
+            _DmaChannel::TransferDoubleBuffered(_DmaChannel::Mem2Periph | _DmaChannel::MemIncrement | _DmaChannel::PriorityHigh
+                                            | _DmaChannel::PSize16Bits | _DmaChannel::MSize16Bits,
+                                            _buffer, _buffer + BlockSize, Pwm::PulseRegister(), BlockSize);
+
+            _Timer::ResetCounterValue();
+            _Timer::DmaRequestEnable();
+            _Timer::Start();
+            return true;
+        }
+
+        /**
+         * @brief Check that strip is ready for new transfer
+         *
+         * @retval true Ready
+         * @retval false Transfer in progress
+         */
+        static bool Ready()
+        {
+            return !_busy;
+        }
+
+    private:
+        static void FillBlock(Counter* block)
+        {
+            unsigned slot = 0;
+            for (unsigned pixel = 0; pixel < _PixelsPerBlock && _next < _count; ++pixel, ++_next)
+            {
+                const uint8_t* bytes = &_pixels[_next].green;
+                for (unsigned byte = 0; byte < 3; ++byte)
+                {
+                    uint8_t value = bytes[byte];
+                    for (uint8_t mask = 0x80; mask != 0; mask >>= 1)
+                    {
+                        block[slot++] = (value & mask) ? _onePulse : _zeroPulse;
+                    }
+                }
+            }
+
+            // Tail of the last data block and reset blocks keep line low
+            while (slot < BlockSize)
+            {
+                block[slot++] = 0;
+            }
+        }
+
+        static void BlockHandler(void* data, unsigned, unsigned)
+        {
+            if (++_completedBlocks >= _dataBlocks + ResetBlocks)
+            {
+                _Timer::Stop();
+                _Timer::DmaRequestDisable();
+                _DmaChannel::Disable();
+                Pwm::SetPulse(0);
+                _busy = false;
+
+                if (_callback)
+                    _callback();
+                return;
+            }
+
+            FillBlock(static_cast<Counter*>(data));
+        }
+
+        static Counter _buffer[2 * BlockSize];
+        static Counter _zeroPulse;
+        static Counter _onePulse;
+        static const Ws2812Color* _pixels;
+        static uint16_t _count;
+        static uint16_t _next;
+        static uint16_t _completedBlocks;
+        static uint16_t _dataBlocks;
+        static std::add_pointer_t<void()> _callback;
+        static volatile bool _busy;
+    };
+
+    #define WS2812_TEMPLATE_ARGS template <typename _Timer, unsigned _Channel, typename _DmaChannel, typename _Pin, unsigned _PixelsPerBlock>
+    #define WS2812_TEMPLATE_QUALIFIER Ws2812<_Timer, _Channel, _DmaChannel, _Pin, _PixelsPerBlock>
+
+    WS2812_TEMPLATE_ARGS
+    typename WS2812_TEMPLATE_QUALIFIER::Counter WS2812_TEMPLATE_QUALIFIER::_buffer[2 * BlockSize];
+
+    WS2812_TEMPLATE_ARGS
+    typename WS2812_TEMPLATE_QUALIFIER::Counter WS2812_TEMPLATE_QUALIFIER::_zeroPulse;
+
+    WS2812_TEMPLATE_ARGS
+    typename WS2812_TEMPLATE_QUALIFIER::Counter WS2812_TEMPLATE_QUALIFIER::_onePulse;
+
+    WS2812_TEMPLATE_ARGS
+    const Ws2812Color* WS2812_TEMPLATE_QUALIFIER::_pixels;
+
+    WS2812_TEMPLATE_ARGS
+    uint16_t WS2812_TEMPLATE_QUALIFIER::_count;
+
+    WS2812_TEMPLATE_ARGS
+    uint16_t WS2812_TEMPLATE_QUALIFIER::_next;
+
+    WS2812_TEMPLATE_ARGS
+    uint16_t WS2812_TEMPLATE_QUALIFIER::_completedBlocks;
+
+    WS2812_TEMPLATE_ARGS
+    uint16_t WS2812_TEMPLATE_QUALIFIER::_dataBlocks;
+
+    WS2812_TEMPLATE_ARGS
+    std::add_pointer_t<void()> WS2812_TEMPLATE_QUALIFIER::_callback;
+
+    WS2812_TEMPLATE_ARGS
+    volatile bool WS2812_TEMPLATE_QUALIFIER::_busy = false;
+}
+
+#endif //! ZHELE_DRIVERS_WS2812_H
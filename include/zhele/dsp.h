@@ -0,0 +1,309 @@
+/**
+ * @file
+ * Implements fixed-point (Q15, Q31) FIR and biquad filters
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DSP_H
+#define ZHELE_DSP_H
+
+#if defined(STM32F0)
+    #include <stm32f0xx.h>
+#endif
+#if defined(STM32F1)
+    #include <stm32f1xx.h>
+#endif
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+#if defined(STM32L4)
+    #include <stm32l4xx.h>
+#endif
+#if defined(STM32G0)
+    #include <stm32g0xx.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Zhele::Dsp
+{
+    /**
+     * @brief Converts number to Q15 (saturated)
+     *
+     * @param [in] value Number in [-1, 1)
+     *
+     * @returns Q15 value
+     */
+    constexpr int16_t ToQ15(double value);
+
+    /**
+     * @brief Converts number to Q31 (saturated)
+     *
+     * @param [in] value Number in [-1, 1)
+     *
+     * @returns Q31 value
+     */
+    constexpr int32_t ToQ31(double value);
+
+    /**
+     * @brief Implements FIR filter
+     *
+     * @details
+     * Delay line keeps every sample twice, so window of last samples is always contiguous and
+     * output is dot product without index wrapping. Q15 dot product uses dual 16-bit MAC (SMLALD) on Cortex-M4,
+     * Q31 one uses 32x32->64 MAC. Accumulator is 64-bit: Q15 filter does not overflow, Q31 accumulator
+     * has one guard bit (scale input down by log2(taps) bits if coefficients sum is large).
+     * Result is rounded and saturated. Filter state persists between blocks, so stream can be processed
+     * by blocks of any size (for example, ADC stream halves) in place.
+     *
+     * @par Example
+     * @code
+     *  static constexpr std::array<int16_t, 4> average = {8192, 8192, 8192, 8192};
+     *  Dsp::FirQ15<4> fir(average);
+     *  void OnBlock(uint16_t* data, uint32_t count, uint32_t overruns)
+     *  {
+     *      auto samples = Adc1::RemoveDcOffset({data, count});
+     *      fir.Process(samples, samples);
+     *  }
+     * @endcode
+     *
+     * @tparam _Sample Sample type (int16_t for Q15, int32_t for Q31)
+     * @tparam _Taps Taps count
+     */
+    template<typename _Sample, unsigned _Taps>
+    class Fir
+    {
+        static_assert(_Taps > 0, "Filter must have taps");
+    public:
+        /**
+         * @brief Creates filter with zero state
+         *
+         * @param [in] coefficients Coefficients (h[0] is for the newest sample), they are not copied
+         */
+        explicit Fir(std::span<const _Sample, _Taps> coefficients);
+
+        /**
+         * @brief Clears filter state
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset();
+
+        /**
+         * @brief Filters one sample
+         *
+         * @param [in] sample Input sample
+         *
+         * @returns Output sample
+         */
+        _Sample Process(_Sample sample);
+
+        /**
+         * @brief Filters block
+         *
+         * @param [in] input Input samples
+         * @param [out] output Output samples (can be the same buffer as input)
+         *
+         * @returns Processed samples count (minimal of sizes)
+         */
+        size_t Process(std::span<const _Sample> input, std::span<_Sample> output);
+
+    protected:
+        void Push(_Sample sample);
+        _Sample Output() const;
+
+        const _Sample* _coefficients; ///< Coefficients
+        _Sample _delay[2 * _Taps]; ///< Delay line (every sample is written twice)
+        unsigned _position; ///< The newest sample position
+    };
+
+    /**
+     * @brief Implements decimating FIR filter
+     *
+     * @details
+     * Output is calculated for every _Factor-th input sample only, so filter costs 1/_Factor
+     * of full rate FIR. Decimation phase persists between blocks, so block size doesn't have to be multiple of factor.
+     *
+     * @par Example
+     * @code
+     *  Dsp::FirDecimatorQ15<32, 4> decimator(lowPass);
+     *  size_t outputs = decimator.Process(samples, samples); // samples.size() / 4 outputs in place
+     * @endcode
+     *
+     * @tparam _Sample Sample type (int16_t for Q15, int32_t for Q31)
+     * @tparam _Taps Taps count
+     * @tparam _Factor Decimation factor
+     */
+    template<typename _Sample, unsigned _Taps, unsigned _Factor>
+    class FirDecimator : private Fir<_Sample, _Taps>
+    {
+        static_assert(_Factor > 0, "Decimation factor must be positive");
+        using Base = Fir<_Sample, _Taps>;
+    public:
+        /**
+         * @brief Creates filter with zero state
+         *
+         * @param [in] coefficients Coefficients (h[0] is for the newest sample), they are not copied
+         */
+        explicit FirDecimator(std::span<const _Sample, _Taps> coefficients);
+
+        /**
+         * @brief Clears filter state and decimation phase
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset();
+
+        /**
+         * @brief Filters and decimates block
+         *
+         * @param [in] input Input samples
+         * @param [out] output Output samples (can be the same buffer as input, input.size() / _Factor + 1 elements
+         * are enough, extra outputs are dropped)
+         *
+         * @returns Output samples count
+         */
+        size_t Process(std::span<const _Sample> input, std::span<_Sample> output);
+
+    private:
+        unsigned _phase; ///< Input samples count since last output
+    };
+
+    /**
+     * @brief Biquad stage coefficients
+     *
+     * @details
+     * Stage is y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] + a1 * y[n-1] + a2 * y[n-2],
+     * so feedback coefficients are negated ones of usual transfer function (as in CMSIS-DSP).
+     * Coefficients are scaled by 2^-postShift to fit [-1, 1) (see @ref BiquadCascade).
+     *
+     * @tparam _Sample Coefficient type (int16_t for Q15, int32_t for Q31)
+     */
+    template<typename _Sample>
+    struct BiquadCoefficients
+    {
+        _Sample b0; ///< Feedforward coefficient
+        _Sample b1; ///< Feedforward coefficient
+        _Sample b2; ///< Feedforward coefficient
+        _Sample a1; ///< Feedback coefficient (negated)
+        _Sample a2; ///< Feedback coefficient (negated)
+
+        /**
+         * @brief Converts floating point coefficients (call it in constant expression)
+         *
+         * @param [in] b0 Feedforward coefficient
+         * @param [in] b1 Feedforward coefficient
+         * @param [in] b2 Feedforward coefficient
+         * @param [in] a1 Feedback coefficient (negated)
+         * @param [in] a2 Feedback coefficient (negated)
+         * @param [in] postShift Post shift of cascade
+         *
+         * @returns Fixed-point coefficients
+         */
+        static constexpr BiquadCoefficients From(double b0, double b1, double b2, double a1, double a2, unsigned postShift);
+    };
+
+    /**
+     * @brief Implements cascade of biquad filters (direct form I)
+     *
+     * @details
+     * Block is filtered by every stage in turn (stage state stays in registers during block).
+     * Stage uses two dual 16-bit MACs (SMLALD) for Q15 on Cortex-M4, accumulator is 64-bit.
+     * Coefficients are scaled by 2^-postShift, so IIR coefficients up to 2^postShift (usually 2) are represented.
+     *
+     * @par Example
+     * @code
+     *  // Butterworth low-pass, fc = fs / 10, a1 and a2 are negated
+     *  static constexpr Dsp::BiquadCoefficients<int16_t> lowPass[] = {
+     *      Dsp::BiquadCoefficients<int16_t>::From(0.0675, 0.1349, 0.0675, 1.1430, -0.4128, 1)
+     *  };
+     *  Dsp::BiquadCascadeQ15<1> biquad(lowPass, 1);
+     *  biquad.Process(samples, samples);
+     * @endcode
+     *
+     * @tparam _Sample Sample type (int16_t for Q15, int32_t for Q31)
+     * @tparam _Stages Stages count
+     */
+    template<typename _Sample, unsigned _Stages>
+    class BiquadCascade
+    {
+        static_assert(_Stages > 0, "Cascade must have stages");
+    public:
+        using Coefficients = BiquadCoefficients<_Sample>;
+
+        /**
+         * @brief Creates filter with zero state
+         *
+         * @param [in] coefficients Stages coefficients, they are not copied
+         * @param [in] postShift Coefficients scale (2^-postShift)
+         */
+        BiquadCascade(std::span<const Coefficients, _Stages> coefficients, unsigned postShift = 1);
+
+        /**
+         * @brief Clears filter state
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset();
+
+        /**
+         * @brief Filters block
+         *
+         * @param [in] input Input samples
+         * @param [out] output Output samples (can be the same buffer as input)
+         *
+         * @returns Processed samples count (minimal of sizes)
+         */
+        size_t Process(std::span<const _Sample> input, std::span<_Sample> output);
+
+    private:
+        /// Stage state (delayed input and output)
+        struct State
+        {
+            _Sample x1;
+            _Sample x2;
+            _Sample y1;
+            _Sample y2;
+        };
+
+        const Coefficients* _coefficients; ///< Coefficients
+        State _state[_Stages]; ///< Stages state
+        unsigned _shift; ///< Accumulator shift
+    };
+
+    /// Q15 FIR filter
+    template<unsigned _Taps>
+    using FirQ15 = Fir<int16_t, _Taps>;
+
+    /// Q31 FIR filter
+    template<unsigned _Taps>
+    using FirQ31 = Fir<int32_t, _Taps>;
+
+    /// Q15 decimating FIR filter
+    template<unsigned _Taps, unsigned _Factor>
+    using FirDecimatorQ15 = FirDecimator<int16_t, _Taps, _Factor>;
+
+    /// Q31 decimating FIR filter
+    template<unsigned _Taps, unsigned _Factor>
+    using FirDecimatorQ31 = FirDecimator<int32_t, _Taps, _Factor>;
+
+    /// Q15 biquad cascade
+    template<unsigned _Stages>
+    using BiquadCascadeQ15 = BiquadCascade<int16_t, _Stages>;
+
+    /// Q31 biquad cascade
+    template<unsigned _Stages>
+    using BiquadCascadeQ31 = BiquadCascade<int32_t, _Stages>;
+}
+
+#include "impl/dsp.h"
+
+#endif //! ZHELE_DSP_H
@@ -0,0 +1,163 @@
+/**
+ * @file
+ * Implements compile-time EXTI interrupts dispatcher
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_EXTI_DISPATCHER_H
+#define ZHELE_EXTI_DISPATCHER_H
+
+#include <zhele/exti.h>
+
+#include <array>
+#include <bit>
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief EXTI line handler for dispatcher
+     *
+     * @tparam _Exti EXTI line (Exti0, Exti1, ...)
+     * @tparam _Handler Handler (called from interrupt)
+     */
+    template<typename _Exti, std::add_pointer_t<void()> _Handler>
+    class ExtiHandler
+    {
+    public:
+        using Exti = _Exti;
+
+        /**
+         * @brief Handles line event
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Handle();
+    };
+
+    /**
+     * @brief Debounced EXTI line handler for dispatcher
+     *
+     * @details
+     * Handler is called on the first edge, then line is masked and it's unmasked
+     * by software timer task after debounce time, so no interrupts are generated
+     * by contact bounce and nothing is blocked while line is waiting.
+     * Edges during debounce time are dropped.
+     *
+     * @tparam _Exti EXTI line (Exti0, Exti1, ...)
+     * @tparam _Handler Handler (called from interrupt)
+     * @tparam _Wheel Software timers (@ref Timers::TimerWheel)
+     * @tparam _Ticks Debounce time (in wheel ticks)
+     */
+    template<typename _Exti, std::add_pointer_t<void()> _Handler, typename _Wheel, uint32_t _Ticks>
+    class DebouncedExtiHandler
+    {
+        static_assert(_Ticks > 0, "Debounce time must be positive");
+    public:
+        using Exti = _Exti;
+
+        /**
+         * @brief Handles line event
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Handle();
+
+    private:
+        static void Rearm();
+
+        static typename _Wheel::Task _task;
+    };
+
+    /**
+     * @brief Implements EXTI interrupts dispatcher
+     *
+     * @details
+     * Dispatcher has compile-time table of line handlers. Shared vector handler
+     * reads pending register once, clears pending lines of that vector and calls
+     * handlers of pending lines (highest line first), line search is one CLZ instruction,
+     * so lines without pending events are not tested.
+     *
+     * @par Example
+     * @code
+     *  using Buttons = ExtiDispatcher<
+     *      ExtiHandler<Exti5, OnStart>,
+     *      DebouncedExtiHandler<Exti12, OnStop, Wheel, 20>
+     *  >;
+     *  Buttons::EnableInterrupts();
+     *  extern "C" void EXTI9_5_IRQHandler() { Buttons::IrqHandler<EXTI9_5_IRQn>(); }
+     *  extern "C" void EXTI15_10_IRQHandler() { Buttons::IrqHandler<EXTI15_10_IRQn>(); }
+     * @endcode
+     *
+     * @tparam _Handlers Line handlers (@ref ExtiHandler, @ref DebouncedExtiHandler)
+     */
+    template<typename... _Handlers>
+    class ExtiDispatcher
+    {
+        using Callback = std::add_pointer_t<void()>;
+
+        static const uint32_t LinesMask = ((1u << _Handlers::Exti::Line) | ... | 0u);
+        static_assert(sizeof...(_Handlers) > 0, "Dispatcher has no handlers");
+        static_assert(std::popcount(LinesMask) == sizeof...(_Handlers), "Every EXTI line must have one handler");
+
+        template<IRQn_Type _IRQn>
+        static const uint32_t VectorMask = (((_Handlers::Exti::IRQNumber == _IRQn) ? (1u << _Handlers::Exti::Line) : 0u) | ... | 0u);
+
+        static consteval std::array<Callback, 32> MakeTable()
+        {
+            std::array<Callback, 32> table{};
+            ((table[_Handlers::Exti::Line] = &_Handlers::Handle), ...);
+            return table;
+        }
+
+        static constexpr std::array<Callback, 32> Table = MakeTable();
+    public:
+        /**
+         * @brief Enables interrupts of all lines
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void EnableInterrupts();
+
+        /**
+         * @brief Disables interrupts of all lines
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DisableInterrupts();
+
+        /**
+         * @brief Interrupt handler of vector (call it in EXTIx_IRQHandler)
+         *
+         * @tparam _IRQn Vector IRQ number
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<IRQn_Type _IRQn>
+        static void IrqHandler();
+
+        /**
+         * @brief Interrupt handler of all dispatcher lines (for one function for all vectors)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static void Dispatch(uint32_t pending);
+    };
+}
+
+#include "impl/exti_dispatcher.h"
+
+#endif //! ZHELE_EXTI_DISPATCHER_H
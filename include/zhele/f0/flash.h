@@ -12,6 +12,24 @@
 
 #include <stm32f0xx.h>
 
+/**
+ * @def ZHELE_FLASH_WAIT_STATE_FREQUENCE
+ * @brief Max HCLK frequence for one flash wait state
+ * @details
+ * Default value is taken from reference manual (0 wait states up to 24 MHz, 1 up to 48 MHz).
+ */
+#if !defined (ZHELE_FLASH_WAIT_STATE_FREQUENCE)
+    #define ZHELE_FLASH_WAIT_STATE_FREQUENCE 24000000
+#endif
+
+/**
+ * @def ZHELE_FLASH_MAX_LATENCY
+ * @brief Max flash wait states count
+ */
+#if !defined (ZHELE_FLASH_MAX_LATENCY)
+    #define ZHELE_FLASH_MAX_LATENCY 1
+#endif
+
 #include "../common/flash.h"
 
 #include <algorithm>
@@ -20,11 +38,31 @@ namespace Zhele
 {    
     inline void Flash::ConfigureFrequence(uint32_t frequence)
     {
-        static constexpr uint32_t MaxFlashFrequence = 24000000;
+        FLASH->ACR |= FLASH_ACR_PRFTBE;
+        SetLatency(Latency(frequence));
+    }
+
+    inline void Flash::EnablePrefetch()
+    {
+        FLASH->ACR |= FLASH_ACR_PRFTBE;
+        while ((FLASH->ACR & FLASH_ACR_PRFTBS) == 0)
+            continue;
+    }
+
+    inline void Flash::DisablePrefetch()
+    {
+        FLASH->ACR &= ~FLASH_ACR_PRFTBE;
+    }
+
+    template<uint32_t _Frequence>
+    inline void Flash::OptimiseForFrequency()
+    {
+        static constexpr uint32_t latency = Latency(_Frequence);
+        static_assert((_Frequence - 1) / ZHELE_FLASH_WAIT_STATE_FREQUENCE <= ZHELE_FLASH_MAX_LATENCY,
+            "Frequence is too high for flash");
 
-        FLASH->ACR |= frequence > MaxFlashFrequence
-            ? (FLASH_ACR_PRFTBE | FLASH_ACR_LATENCY)
-            : FLASH_ACR_PRFTBE;
+        SetLatency(latency);
+        EnablePrefetch();
     }
 
     inline constexpr uint32_t Flash::PageSize(unsigned page)
@@ -40,7 +78,7 @@ namespace Zhele
 
     inline constexpr unsigned Flash::AddressToPage(const void* address)
     {
-        uint32_t offset = reinterpret_cast<uint32_t>(address) - FLASH_BASE;
+        uint32_t offset = AddressOf(address) - FLASH_BASE;
 
         return offset / PageSize(0);
     }
@@ -84,7 +122,7 @@ namespace Zhele
 
         FLASH->CR |= FLASH_CR_PG;
 
-        if ((reinterpret_cast<uint32_t>(aligned_src) & 0x1) == 0) {
+        if ((AddressOf(aligned_src) & 0x1) == 0) {
             while (size >= sizeof(uint16_t)) {
                 *aligned_dst++ = *aligned_src++;
                 size -= sizeof(uint16_t);
@@ -128,7 +166,104 @@ namespace Zhele
         FLASH->CR &= (~FLASH_CR_PG);
         Lock();
 
-        return (FLASH->SR & (FLASH_SR_WRPRTERR | FLASH_SR_PGERR) == 0);
+        return ((FLASH->SR & (FLASH_SR_WRPRTERR | FLASH_SR_PGERR)) == 0);
+    }
+
+    inline bool Flash::ErasePageAsync(uint32_t page, AsyncCallback callback)
+    {
+        if (page >= PageCount() || IsBusy())
+            return false;
+
+        if (IsLock())
+            Unlock();
+
+        WaitWhileBusy();
+
+        _asyncCallback = callback;
+        _asyncOperation = AsyncOperation::Erase;
+
+        FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+        FLASH->CR |= FLASH_CR_PER | FLASH_CR_EOPIE | FLASH_CR_ERRIE;
+        FLASH->AR = PageAddress(page);
+        NVIC_EnableIRQ(FLASH_IRQn);
+        FLASH->CR |= FLASH_CR_STRT;
+
+        return true;
+    }
+
+    inline bool Flash::WriteFlashAsync(void* dst, const void* src, unsigned size, AsyncCallback callback)
+    {
+        if (IsBusy())
+            return false;
+
+        if (size == 0) {
+            if (callback != nullptr)
+                callback(true);
+            return true;
+        }
+
+        if (IsLock())
+            Unlock();
+
+        WaitWhileBusy();
+
+        _asyncDst = reinterpret_cast<uint8_t*>(dst);
+        _asyncSrc = reinterpret_cast<const uint8_t*>(src);
+        _asyncSize = size;
+        _asyncCallback = callback;
+        _asyncOperation = AsyncOperation::Write;
+
+        FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+        FLASH->CR |= FLASH_CR_PG | FLASH_CR_EOPIE | FLASH_CR_ERRIE;
+        NVIC_EnableIRQ(FLASH_IRQn);
+
+        if (!ProgramNextAsync()) {
+            FLASH->CR &= ~(FLASH_CR_PG | FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+            _asyncCallback = nullptr;
+            _asyncOperation = AsyncOperation::None;
+            Lock();
+            return false;
+        }
+
+        return true;
+    }
+
+    ZHELE_RAMFUNC inline bool Flash::ProgramNextAsync()
+    {
+        uint16_t buffer;
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&buffer);
+        unsigned count = _asyncSize < sizeof(buffer) ? _asyncSize : sizeof(buffer);
+
+        // Byte copy (source may be unaligned, tail is padded by current flash content)
+        for (unsigned i = 0; i < sizeof(buffer); ++i)
+            bytes[i] = i < count ? _asyncSrc[i] : _asyncDst[i];
+
+        *reinterpret_cast<volatile uint16_t*>(_asyncDst) = buffer;
+        _asyncDst += sizeof(buffer);
+        _asyncSrc += count;
+        _asyncSize -= count;
+
+        return (FLASH->SR & (FLASH_SR_WRPRTERR | FLASH_SR_PGERR)) == 0;
+    }
+
+    ZHELE_RAMFUNC inline void Flash::IrqHandler()
+    {
+        uint32_t status = FLASH->SR;
+        FLASH->SR = status & (FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR);
+
+        if ((status & (FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR)) == 0 || _asyncOperation == AsyncOperation::None)
+            return;
+
+        bool success = (status & (FLASH_SR_PGERR | FLASH_SR_WRPRTERR)) == 0;
+
+        if (success && _asyncOperation == AsyncOperation::Write && _asyncSize > 0) {
+            if (ProgramNextAsync())
+                return;
+            success = false;
+        }
+
+        FLASH->CR &= ~(FLASH_CR_PER | FLASH_CR_PG | FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+        CompleteAsync(success);
     }
 }
 
@@ -45,6 +45,8 @@ namespace Zhele
             SdaPin::template AltFuncNumber<GetNonTypeValueByIndex<sdaPinNumber, SdaAltFuncNumbers>::value>();
             SdaPin::SetDriverType(SdaPin::Port::OpenDrain);
             SdaPin::SetPullMode(SdaPin::PullMode::PullUp);
+
+            _busClear = ClearBus<SclPin, SdaPin>;
         }
 
         I2C_TEMPLATE_ARGS
@@ -90,6 +92,16 @@ namespace Zhele
         using I2C1SdaPins = Pair<IO::PinList<IO::Pa10, IO::Pa12, IO::Pb7, IO::Pb9, IO::Pb11>, NonTypeTemplateArray<4, 5, 1, 1, 1>>;
 
         IO_STRUCT_WRAPPER(I2C1, I2C1Regs, I2C_TypeDef);
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::EnableFastModePlus()
+        {
+            Clock::SysCfgCompClock::Enable();
+        #if defined (SYSCFG_CFGR1_I2C_FMP_I2C1)
+            if constexpr (std::is_same_v<_Regs, I2C1Regs>)
+                SYSCFG->CFGR1 |= SYSCFG_CFGR1_I2C_FMP_I2C1;
+        #endif
+        }
     }
     using I2c1 = Private::I2cBase<Private::I2C1Regs, I2C1_IRQn, I2C1_IRQn, Clock::I2c1Clock, Private::I2C1SclPins, Private::I2C1SdaPins, Dma1Channel2, Dma1Channel3>;
 }
@@ -0,0 +1,25 @@
+/**
+ * @file
+ * Implements internal RTC for stm32f0 series
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_RTC_H
+#define ZHELE_RTC_H
+
+#include <stm32f0xx.h>
+
+#include "../common/rtc.h"
+
+#include "clock.h"
+
+namespace Zhele
+{
+    // Wakeup timer (EXTI 20) and alarm (EXTI 17) share one IRQ
+    using Rtc = Private::Rtc<void, 20, RTC_IRQn, 17, RTC_IRQn>;
+}
+
+#endif //! ZHELE_RTC_H
@@ -0,0 +1,42 @@
+/**
+ * @file
+ * Implements touch sensing controller for stm32f0 series
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TSC_H
+#define ZHELE_TSC_H
+
+#include <stm32f0xx.h>
+
+#if defined (TSC)
+#include "../common/tsc.h"
+
+#include "clock.h"
+#include "iopins.h"
+
+namespace Zhele
+{
+    namespace Private
+    {
+        IO_STRUCT_WRAPPER(TSC, TscRegs, TSC_TypeDef);
+
+        using TscPins = IO::PinList<
+            IO::Pa0, IO::Pa1, IO::Pa2, IO::Pa3,
+            IO::Pa4, IO::Pa5, IO::Pa6, IO::Pa7,
+            IO::Pc5, IO::Pb0, IO::Pb1, IO::Pb2,
+            IO::Pa9, IO::Pa10, IO::Pa11, IO::Pa12,
+            IO::Pb3, IO::Pb4, IO::Pb6, IO::Pb7,
+            IO::Pb11, IO::Pb12, IO::Pb13, IO::Pb14,
+            IO::Pe2, IO::Pe3, IO::Pe4, IO::Pe5,
+            IO::Pd12, IO::Pd13, IO::Pd14, IO::Pd15>;
+    }
+
+    using Tsc = Private::Tsc<Private::TscRegs, Clock::TscClock, TSC_IRQn, Private::TscPins, 3>;
+}
+#endif
+
+#endif //! ZHELE_TSC_H
@@ -13,6 +13,7 @@
 #include <zhele/dma.h>
 #include <zhele/iopins.h>
 #include <zhele/pinlist.h>
+#include <zhele/timer.h>
 
 #include "../common/adc.h"
 
@@ -24,14 +25,36 @@ namespace Zhele
         class Adc : public AdcBase<_Regs, _ClockCtrl, _InputPins, _DmaChannel>
         {
         public:
+            /// Max ADC clock frequency
+            static const unsigned long MaxClockFreq = 14000000;
+
+            /// Available sample times (in ADC cycles, rounded down)
+            static constexpr uint16_t SampleTimes[] = {1, 7, 13, 28, 41, 55, 71, 239};
+
             // External trigger for regular channels
             enum class RegularTrigger : uint8_t
+            {
+                Timer1CC1 = 0, //< Timer 1 CC1
+                Timer1CC2, //< Timer 1 CC2
+                Timer1CC3, //< Timer 1 CC3
+                Timer2CC2, //< Timer 2 CC2
+                Timer3TRGO, //< Timer 3 TRGO
+                Timer4CC4, //< Timer 4 CC4
+                Exti11, //< EXTI line 11
+                Software, //< SWSTART
+            };
+
+            // External trigger for injected channels
+            enum class InjectedTrigger : uint8_t
             {
                 Timer1TRGO = 0, //< Timer 1 TRGO
                 Timer1CC4, //< Timer 1 CC4
                 Timer2TRGO, //< Timer 2 TRGO
-                Timer3TRGO, //< Timer 3 TRGO
-                Timer15TRGO, //< Timer 15 TRGO
+                Timer2CC1, //< Timer 2 CC1
+                Timer3CC4, //< Timer 3 CC4
+                Timer4TRGO, //< Timer 4 TRGO
+                Exti15, //< EXTI line 15
+                Software, //< JSWSTART
             };
 
             // Trigger mode
@@ -61,9 +84,45 @@ namespace Zhele
             Zhele::IO::Pc5>;
 
         IO_STRUCT_WRAPPER(ADC1, Adc1Regs, ADC_TypeDef);
+    #if defined (ADC2)
+        // ADC1 and ADC2 share inputs
+        using Adc2Pins = Adc1Pins;
+
+        IO_STRUCT_WRAPPER(ADC2, Adc2Regs, ADC_TypeDef);
+    #endif
     }
 
     using Adc1 = Private::Adc<Private::Adc1Regs, Clock::Adc1Clock, Private::Adc1Pins, Dma1Channel1>;
+#if defined (ADC2)
+    // ADC2 has no DMA request, use dual mode (AdcMulti) to transfer its data by ADC1 DMA
+    using Adc2 = Private::Adc<Private::Adc2Regs, Clock::Adc2Clock, Private::Adc2Pins, void>;
+#endif
+
+    namespace Private
+    {
+        template<>
+        struct AdcTimerTrigger<Adc1, Timers::Timer3>
+        {
+            static constexpr bool Supported = true;
+            static constexpr auto Trigger = Adc1::RegularTrigger::Timer3TRGO;
+        };
+
+        template<>
+        struct AdcInjectedTimerTrigger<Adc1, Timers::Timer1>
+        {
+            static constexpr bool Supported = true;
+            static constexpr auto Trigger = Adc1::InjectedTrigger::Timer1CC4;
+        };
+    #if defined (ADC2)
+
+        template<>
+        struct AdcInjectedTimerTrigger<Adc2, Timers::Timer1>
+        {
+            static constexpr bool Supported = true;
+            static constexpr auto Trigger = Adc2::InjectedTrigger::Timer1CC4;
+        };
+    #endif
+    }
 }
 
 #endif //! ZHELE_ADC_H
\ No newline at end of file
@@ -0,0 +1,97 @@
+/**
+ * @file
+ * Implements bxCAN for stm32f1 series
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CAN_H
+#define ZHELE_CAN_H
+
+#include <stm32f1xx.h>
+
+#if !defined (CAN1)
+    #error "THIS MCU does not support CAN"
+#endif
+
+#include "../common/can.h"
+
+#include "clock.h"
+#include "iopins.h"
+#include "remap.h"
+#include "../common/template_utils/pair.h"
+#include "../common/template_utils/static_array.h"
+
+#include <type_traits>
+
+namespace Zhele
+{
+    namespace Private
+    {
+        /**
+         * @brief Selects TX and RX pins
+         *
+         * @details
+         * TX and RX pins are remapped together, so pins must have the same index.
+         * On medium and high density devices CAN shares SRAM with USB, they cannot be used at the same time.
+         */
+        CAN_TEMPLATE_ARGS
+        template<int8_t txPinNumber, int8_t rxPinNumber>
+        void CAN_TEMPLATE_QUALIFIER::SelectPins()
+        {
+            static_assert(txPinNumber == rxPinNumber, "TX and RX pins are remapped together");
+
+            using TxPin = typename _TxPins::Key::template Pin<txPinNumber>;
+            TxPin::Port::Enable();
+            TxPin::SetConfiguration(TxPin::Port::AltFunc);
+
+            using RxPin = typename _RxPins::Key::template Pin<rxPinNumber>;
+            if constexpr (!std::is_same_v<typename RxPin::Port, typename TxPin::Port>)
+            {
+                RxPin::Port::Enable();
+            }
+            RxPin::SetConfiguration(RxPin::Port::In);
+
+            Clock::AfioClock::Enable();
+            Zhele::IO::Private::PeriphRemap<_ClockCtrl>::Set(GetNonTypeValueByIndex<txPinNumber, typename _TxPins::Value>::value);
+        }
+
+        CAN_TEMPLATE_ARGS
+        template<typename TxPin, typename RxPin>
+        void CAN_TEMPLATE_QUALIFIER::SelectPins()
+        {
+            constexpr int8_t txPinIndex = _TxPins::Key::template IndexOf<TxPin>;
+            constexpr int8_t rxPinIndex = _RxPins::Key::template IndexOf<RxPin>;
+
+            static_assert(txPinIndex >= 0, "TX pin is not CAN TX pin");
+            static_assert(rxPinIndex >= 0, "RX pin is not CAN RX pin");
+
+            SelectPins<txPinIndex, rxPinIndex>();
+        }
+
+        using Can1TxPins = Pair<IO::PinList<IO::Pa12, IO::Pb9, IO::Pd1>, NonTypeTemplateArray<0, 2, 3>>;
+        using Can1RxPins = Pair<IO::PinList<IO::Pa11, IO::Pb8, IO::Pd0>, NonTypeTemplateArray<0, 2, 3>>;
+        IO_STRUCT_WRAPPER(CAN1, Can1Regs, CAN_TypeDef);
+
+    #if defined (CAN2)
+        using Can2TxPins = Pair<IO::PinList<IO::Pb13, IO::Pb6>, NonTypeTemplateArray<0, 1>>;
+        using Can2RxPins = Pair<IO::PinList<IO::Pb12, IO::Pb5>, NonTypeTemplateArray<0, 1>>;
+        IO_STRUCT_WRAPPER(CAN2, Can2Regs, CAN_TypeDef);
+    #endif
+    }
+
+#if defined (CAN2)
+    // Connectivity line has dedicated CAN interrupts
+    using Can1 = Private::Can<Private::Can1Regs, Private::Can1Regs, Clock::Can1Clock, Clock::Can1Clock,
+        CAN1_TX_IRQn, CAN1_RX0_IRQn, CAN1_RX1_IRQn, CAN1_SCE_IRQn, Private::Can1TxPins, Private::Can1RxPins>;
+    using Can2 = Private::Can<Private::Can2Regs, Private::Can1Regs, Clock::Can2Clock, Clock::Can1Clock,
+        CAN2_TX_IRQn, CAN2_RX0_IRQn, CAN2_RX1_IRQn, CAN2_SCE_IRQn, Private::Can2TxPins, Private::Can2RxPins>;
+#else
+    using Can1 = Private::Can<Private::Can1Regs, Private::Can1Regs, Clock::Can1Clock, Clock::Can1Clock,
+        USB_HP_CAN1_TX_IRQn, USB_LP_CAN1_RX0_IRQn, CAN1_RX1_IRQn, CAN1_SCE_IRQn, Private::Can1TxPins, Private::Can1RxPins>;
+#endif
+}
+
+#endif //! ZHELE_CAN_H
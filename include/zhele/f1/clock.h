@@ -32,11 +32,10 @@ namespace Zhele::Clock
     inline void PllClock::SetDivider()
     {
     #if defined(RCC_CFGR2_PREDIV1)
-        static_assert(divider <= 15, "Divider cannot be greater than 15!");
-        divider -= 1;
-        RCC->CFGR2 = ((RCC->CFGR2 & ~RCC_CFGR2_PREDIV1) | (divider << RCC_CFGR2_PREDIV1_Pos));
+        static_assert(1 <= divider && divider <= 16, "Divider can be equal 1..16!");
+        RCC->CFGR2 = ((RCC->CFGR2 & ~RCC_CFGR2_PREDIV1) | ((divider - 1) << RCC_CFGR2_PREDIV1_Pos));
     #else
-        static_assert(1 <= divider && divider <= 15, "Divider can be equal 1 or 2!");
+        static_assert(1 <= divider && divider <= 2, "Divider can be equal 1 or 2!");
         RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_PLLXTPRE) | (divider == 2
             ? RCC_CFGR_PLLXTPRE_HSE_DIV2
             : RCC_CFGR_PLLXTPRE_HSE);
@@ -61,7 +60,7 @@ namespace Zhele::Clock
     #if !(defined(RCC_CFGR_PLLMULL3) && defined(RCC_CFGR_PLLMULL10))
         static_assert(4 <= multiplier && multiplier <= 9, "Multiplier can be equal 4..9!");
     #else
-        static_assert(4 <= multiplier && multiplier <= 9, "Multiplier cannot be greate than 16");
+        static_assert(2 <= multiplier && multiplier <= 16, "Multiplier can be equal 2..16!");
     #endif
         RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_PLLMULL) | ((multiplier - 2) << RCC_CFGR_PLLMULL_Pos);
     }    
@@ -373,10 +372,10 @@ namespace Zhele::Clock
     #endif
 
     #if defined (RCC_APB2ENR_ADC2EN)
-        using Adc2Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_ADC2EN, Apb2Clock>;
+        using Adc2Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_ADC2EN, AdcClockSource>;
     #endif
     #if defined (RCC_APB2ENR_ADC3EN)
-        using Adc3Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_ADC3EN, Apb2Clock>;
+        using Adc3Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_ADC3EN, AdcClockSource>;
     #endif
     #if defined (RCC_APB2ENR_IOPEEN)
         using PorteClock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_IOPEEN, Apb2Clock>;
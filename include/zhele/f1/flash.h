@@ -12,17 +12,56 @@
 
 #include <stm32f1xx.h>
 
+/**
+ * @def ZHELE_FLASH_WAIT_STATE_FREQUENCE
+ * @brief Max HCLK frequence for one flash wait state
+ * @details
+ * Default value is taken from reference manual (0 wait states up to 24 MHz, 1 up to 48 MHz, 2 up to 72 MHz).
+ */
+#if !defined (ZHELE_FLASH_WAIT_STATE_FREQUENCE)
+    #define ZHELE_FLASH_WAIT_STATE_FREQUENCE 24000000
+#endif
+
+/**
+ * @def ZHELE_FLASH_MAX_LATENCY
+ * @brief Max flash wait states count
+ */
+#if !defined (ZHELE_FLASH_MAX_LATENCY)
+    #define ZHELE_FLASH_MAX_LATENCY 2
+#endif
+
 #include "../common/flash.h"
 
 namespace Zhele
 {
-    const static uint32_t MaxFlashFrequence = 24000000;
+    const static uint32_t MaxFlashFrequence = ZHELE_FLASH_WAIT_STATE_FREQUENCE;
     inline void Flash::ConfigureFrequence(uint32_t frequence)
     {
-        uint32_t ws = (frequence - 1) / MaxFlashFrequence;
-        if(ws > 7)
-            ws = 7;
-        FLASH->ACR |= FLASH_ACR_PRFTBE | ws;
+        FLASH->ACR |= FLASH_ACR_PRFTBE;
+        SetLatency(Latency(frequence));
+    }
+
+    inline void Flash::EnablePrefetch()
+    {
+        FLASH->ACR |= FLASH_ACR_PRFTBE;
+        while ((FLASH->ACR & FLASH_ACR_PRFTBS) == 0)
+            continue;
+    }
+
+    inline void Flash::DisablePrefetch()
+    {
+        FLASH->ACR &= ~FLASH_ACR_PRFTBE;
+    }
+
+    template<uint32_t _Frequence>
+    inline void Flash::OptimiseForFrequency()
+    {
+        static constexpr uint32_t latency = Latency(_Frequence);
+        static_assert((_Frequence - 1) / ZHELE_FLASH_WAIT_STATE_FREQUENCE <= ZHELE_FLASH_MAX_LATENCY,
+            "Frequence is too high for flash");
+
+        SetLatency(latency);
+        EnablePrefetch();
     }
 }
 
@@ -66,6 +66,8 @@ namespace Zhele
             {
                 Zhele::IO::Private::PeriphRemap<_ClockCtrl>::Set(1);
             }
+
+            _busClear = ClearBus<SclPin, SdaPin>;
         }
         
         I2C_TEMPLATE_ARGS
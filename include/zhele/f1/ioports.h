@@ -366,6 +366,9 @@ namespace Zhele
             template<uint8_t, DataT>
             static void AltFuncNumber() {}
 
+            template<Configuration, Speed, PullMode, uint8_t, DriverType, DataT>
+            static void Configure() {}
+
             static void Enable() {}
             static void Disable() {}
 
@@ -598,7 +601,7 @@ namespace Zhele
                 static void SetSpeed()
                 {
                     constexpr unsigned lowMaskPart = ConfigurationMask(mask);
-                    constexpr unsigned highMaskPart = ConfigurationMask(mask);
+                    constexpr unsigned highMaskPart = ConfigurationMask(mask >> 8);
                     _Regs()->CRL = (_Regs()->CRL & ~(lowMaskPart * 0x03)) | lowMaskPart * speed;
                     _Regs()->CRH = (_Regs()->CRH & ~(highMaskPart * 0x03)) | highMaskPart * speed;
                 }
@@ -680,7 +683,7 @@ namespace Zhele
                 static void SetDriverType()
                 {
                     constexpr unsigned lowMaskPart = ConfigurationMask(mask);
-                    constexpr unsigned highMaskPart = ConfigurationMask(mask);
+                    constexpr unsigned highMaskPart = ConfigurationMask(mask >> 8);
                     _Regs()->CRL = (_Regs()->CRL & ~(lowMaskPart * 0x04)) | lowMaskPart * driver;
                     _Regs()->CRH = (_Regs()->CRH & ~(highMaskPart * 0x04)) | highMaskPart * driver;
                 }
@@ -713,6 +716,50 @@ namespace Zhele
                 {
                 }
 
+                /**
+                 * @brief Configure pins (all attributes at once)
+                 * 
+                 * @details
+                 * CRL/CRH images are computed at compile time, every register is written once.
+                 * Pull direction (ODR) is written before configuration registers.
+                 * Alternate function number is ignored (use remap).
+                 * 
+                 * @tparam configuration Configuration
+                 * @tparam speed Speed (for outputs)
+                 * @tparam pull Pull mode (for inputs)
+                 * @tparam altFunc Alternate function number (ignored)
+                 * @tparam driver Driver type (for outputs)
+                 * @tparam mask Pin mask
+                 * 
+                 * @par Returns
+                 *	Nothing
+                 */
+                template<Configuration configuration, Speed speed, PullMode pull, uint8_t altFunc = 0,
+                    DriverType driver = PushPull, DataType mask = std::numeric_limits<DataType>::max()>
+                static void Configure()
+                {
+                    constexpr unsigned lowMaskPart = ConfigurationMask(mask);
+                    constexpr unsigned highMaskPart = ConfigurationMask(mask >> 8);
+                    constexpr unsigned value = configuration == In
+                        ? (pull == NoPull ? static_cast<unsigned>(In) : (pull & 0x08))
+                        : configuration == Analog
+                            ? static_cast<unsigned>(Analog)
+                            : (configuration & 0x0c) | driver | speed;
+
+                    if constexpr (configuration == In && pull != NoPull)
+                    {
+                        if constexpr (pull & 0x10) // pulldown
+                            Clear<mask>();
+                        else
+                            Set<mask>();
+                    }
+
+                    if constexpr (lowMaskPart != 0)
+                        _Regs()->CRL = (_Regs()->CRL & ~(lowMaskPart * 0x0f)) | lowMaskPart * value;
+                    if constexpr (highMaskPart != 0)
+                        _Regs()->CRH = (_Regs()->CRH & ~(highMaskPart * 0x0f)) | highMaskPart * value;
+                }
+
                 /**
                  * @brief Enable clock for port
                  * 
@@ -734,6 +781,26 @@ namespace Zhele
                 {
                     _ClkEnReg::Disable();
                 }
+
+                /**
+                 * @brief Returns BSRR register address (for DMA)
+                 * 
+                 * @returns BSRR address
+                 */
+                static volatile uint32_t* BitSetResetRegister()
+                {
+                    return &_Regs()->BSRR;
+                }
+
+                /**
+                 * @brief Returns IDR register address (for DMA)
+                 * 
+                 * @returns IDR address
+                 */
+                static volatile uint32_t* InputDataRegister()
+                {
+                    return &_Regs()->IDR;
+                }
                 enum { Id = ID };
 
             private:
@@ -120,6 +120,34 @@ namespace Zhele::Timers
             SelectPins<Pins::template IndexOf<Pin>>();
         }
 
+        template <typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins, template<unsigned> typename _ChNPins, typename _BreakPins>
+        template <unsigned _ChannelNumber>
+        template <typename Pin>
+        void AdvancedTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins, _ChNPins, _BreakPins>::ComplementaryPwm<_ChannelNumber>::SelectComplementaryPins()
+        {
+            using Pins = AdvancedTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins, _ChNPins, _BreakPins>::ComplementaryPwm<_ChannelNumber>::ComplementaryPins;
+            using PinsAltFuncNumbers = AdvancedTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins, _ChNPins, _BreakPins>::ComplementaryPwm<_ChannelNumber>::ComplementaryPinsAltFuncNumber;
+            static_assert(Pins::template IndexOf<Pin> >= 0);
+
+            Pin::Port::Enable();
+            Pin::template SetConfiguration<Pins::AltFunc>();
+            Pin::template SetDriverType<Pins::DriverType::PushPull>();
+            GetTimerRemap<_Regs>::Set(GetNonTypeValueByIndex<Pins::template IndexOf<Pin>, PinsAltFuncNumbers>::value);
+        }
+
+        template <typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins, template<unsigned> typename _ChNPins, typename _BreakPins>
+        template <typename Pin>
+        void AdvancedTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins, _ChNPins, _BreakPins>::SelectBreakPins()
+        {
+            using Pins = typename _BreakPins::Key;
+            using PinsAltFuncNumbers = typename _BreakPins::Value;
+            static_assert(Pins::template IndexOf<Pin> >= 0);
+
+            Pin::Port::Enable();
+            Pin::template SetConfiguration<Pin::Configuration::In>();
+            GetTimerRemap<_Regs>::Set(GetNonTypeValueByIndex<Pins::template IndexOf<Pin>, PinsAltFuncNumbers>::value);
+        }
+
         using namespace Zhele::IO;
 
         template<unsigned ChannelNumber> struct Tim1ChPins;
@@ -128,6 +156,12 @@ namespace Zhele::Timers
         template<> struct Tim1ChPins<2>{ using Pins = Pair<IO::PinList<Pa10, Pe13>, NonTypeTemplateArray<0, 3>>; };
         template<> struct Tim1ChPins<3>{ using Pins = Pair<IO::PinList<Pa11, Pe14>, NonTypeTemplateArray<0, 3>>; };		
 
+        template<unsigned ChannelNumber> struct Tim1ChNPins;
+        template<> struct Tim1ChNPins<0>{ using Pins = Pair<IO::PinList<Pb13, Pa7, Pe8>, NonTypeTemplateArray<0, 1, 3>>; };
+        template<> struct Tim1ChNPins<1>{ using Pins = Pair<IO::PinList<Pb14, Pb0, Pe10>, NonTypeTemplateArray<0, 1, 3>>; };
+        template<> struct Tim1ChNPins<2>{ using Pins = Pair<IO::PinList<Pb15, Pb1, Pe12>, NonTypeTemplateArray<0, 1, 3>>; };
+        using Tim1BreakPins = Pair<IO::PinList<Pb12, Pa6, Pe15>, NonTypeTemplateArray<0, 1, 3>>;
+
         template<unsigned ChannelNumber> struct Tim2ChPins;
         template<> struct Tim2ChPins<0>{ using Pins = Pair<IO::PinList<Pa0, Pa15, Pa0, Pa15>, NonTypeTemplateArray<0, 1, 2, 3>>; };
         template<> struct Tim2ChPins<1>{ using Pins = Pair<IO::PinList<Pa1, Pb3, Pa1, Pb3>, NonTypeTemplateArray<0, 1, 2, 3>>; };
@@ -161,7 +195,7 @@ namespace Zhele::Timers
 #endif
     }
 
-    using Timer1 = Private::AdvancedTimer<Private::Tim1Regs, Clock::Tim1Clock, TIM1_UP_IRQn, Private::Tim1ChPins>;
+    using Timer1 = Private::AdvancedTimer<Private::Tim1Regs, Clock::Tim1Clock, TIM1_UP_IRQn, Private::Tim1ChPins, Private::Tim1ChNPins, Private::Tim1BreakPins>;
     using Timer2 = Private::GPTimer<Private::Tim2Regs, Clock::Tim2Clock, TIM2_IRQn, Private::Tim2ChPins>;
     using Timer3 = Private::GPTimer<Private::Tim3Regs, Clock::Tim3Clock, TIM3_IRQn, Private::Tim3ChPins>;
 #if defined (TIM4)
@@ -173,6 +207,29 @@ namespace Zhele::Timers
 #if defined (TIM7)
     using Timer7 = Private::BaseTimer<Private::Tim7Regs, Clock::Tim7Clock, TIM7_IRQn>;
 #endif
+
+    namespace Private
+    {
+        // Internal trigger connection (slave timer ITRx <- master timer TRGO)
+        template<> struct TimerInternalTrigger<Timer2, Timer1> { static const int Value = 1; };
+        template<> struct TimerInternalTrigger<Timer3, Timer1> { static const int Value = 2; };
+#if defined (TIM4)
+        template<> struct TimerInternalTrigger<Timer4, Timer1> { static const int Value = 3; };
+#endif
+        template<> struct TimerInternalTrigger<Timer1, Timer2> { static const int Value = 0; };
+        template<> struct TimerInternalTrigger<Timer3, Timer2> { static const int Value = 2; };
+#if defined (TIM4)
+        template<> struct TimerInternalTrigger<Timer4, Timer2> { static const int Value = 3; };
+#endif
+        template<> struct TimerInternalTrigger<Timer1, Timer3> { static const int Value = 0; };
+        template<> struct TimerInternalTrigger<Timer2, Timer3> { static const int Value = 1; };
+#if defined (TIM4)
+        template<> struct TimerInternalTrigger<Timer4, Timer3> { static const int Value = 3; };
+        template<> struct TimerInternalTrigger<Timer1, Timer4> { static const int Value = 0; };
+        template<> struct TimerInternalTrigger<Timer2, Timer4> { static const int Value = 1; };
+        template<> struct TimerInternalTrigger<Timer3, Timer4> { static const int Value = 2; };
+#endif
+    }
 }
 
 #endif //! ZHELE_TIMER_H
\ No newline at end of file
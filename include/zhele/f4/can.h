@@ -0,0 +1,85 @@
+/**
+ * @file
+ * Implements bxCAN for stm32f4 series
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CAN_H
+#define ZHELE_CAN_H
+
+#include <stm32f4xx.h>
+
+#if !defined (CAN1)
+    #error "THIS MCU does not support CAN"
+#endif
+
+#include "../common/can.h"
+
+#include "afio_bind.h"
+#include "clock.h"
+#include "iopins.h"
+
+#include <type_traits>
+
+namespace Zhele
+{
+    namespace Private
+    {
+        /**
+         * @brief Selects TX and RX pins
+         */
+        CAN_TEMPLATE_ARGS
+        template<int8_t txPinNumber, int8_t rxPinNumber>
+        void CAN_TEMPLATE_QUALIFIER::SelectPins()
+        {
+            using TxPin = typename _TxPins::template Pin<txPinNumber>;
+            TxPin::Port::Enable();
+            TxPin::SetConfiguration(TxPin::Port::AltFunc);
+            TxPin::template SetSpeed<TxPin::Speed::Fast>();
+            TxPin::AltFuncNumber(GetAltFunctionNumber<_Regs>);
+
+            using RxPin = typename _RxPins::template Pin<rxPinNumber>;
+            if constexpr (!std::is_same_v<typename RxPin::Port, typename TxPin::Port>)
+            {
+                RxPin::Port::Enable();
+            }
+            RxPin::SetConfiguration(RxPin::Port::AltFunc);
+            RxPin::AltFuncNumber(GetAltFunctionNumber<_Regs>);
+        }
+
+        CAN_TEMPLATE_ARGS
+        template<typename TxPin, typename RxPin>
+        void CAN_TEMPLATE_QUALIFIER::SelectPins()
+        {
+            constexpr int8_t txPinIndex = _TxPins::template IndexOf<TxPin>;
+            constexpr int8_t rxPinIndex = _RxPins::template IndexOf<RxPin>;
+
+            static_assert(txPinIndex >= 0, "TX pin is not CAN TX pin");
+            static_assert(rxPinIndex >= 0, "RX pin is not CAN RX pin");
+
+            SelectPins<txPinIndex, rxPinIndex>();
+        }
+
+        using Can1TxPins = IO::PinList<IO::Pa12, IO::Pb9, IO::Pd1>;
+        using Can1RxPins = IO::PinList<IO::Pa11, IO::Pb8, IO::Pd0>;
+        IO_STRUCT_WRAPPER(CAN1, Can1Regs, CAN_TypeDef);
+
+    #if defined (CAN2)
+        using Can2TxPins = IO::PinList<IO::Pb13, IO::Pb6>;
+        using Can2RxPins = IO::PinList<IO::Pb12, IO::Pb5>;
+        IO_STRUCT_WRAPPER(CAN2, Can2Regs, CAN_TypeDef);
+    #endif
+    }
+
+    using Can1 = Private::Can<Private::Can1Regs, Private::Can1Regs, Clock::Can1Clock, Clock::Can1Clock,
+        CAN1_TX_IRQn, CAN1_RX0_IRQn, CAN1_RX1_IRQn, CAN1_SCE_IRQn, Private::Can1TxPins, Private::Can1RxPins>;
+#if defined (CAN2)
+    using Can2 = Private::Can<Private::Can2Regs, Private::Can1Regs, Clock::Can2Clock, Clock::Can1Clock,
+        CAN2_TX_IRQn, CAN2_RX0_IRQn, CAN2_RX1_IRQn, CAN2_SCE_IRQn, Private::Can2TxPins, Private::Can2RxPins>;
+#endif
+}
+
+#endif //! ZHELE_CAN_H
@@ -65,15 +65,14 @@ namespace Zhele::Clock
 
     inline unsigned PllClock::GetSystemOutputDivider()
     {
-        return (PllP::Get() >> 2) + 2;
+        return (PllP::Get() + 1) * 2;
     }
     
     template<unsigned divider>
     inline void PllClock::SetSystemOutputDivider()
     {
         static_assert(divider == 2 || divider == 4 || divider == 6 || divider == 8, "Divider can be one of 2, 4, 6, 8");
-        static constexpr uint8_t pllpValue = (divider - 2) << 2;
-        PllP::Set(pllpValue);
+        PllP::Set(divider / 2 - 1);
     }
 
     inline unsigned PllClock::GetUsbOutputDivider()
@@ -101,6 +100,114 @@ namespace Zhele::Clock
     }
 #endif
 
+#if defined (RCC_PLLI2SCFGR_PLLI2SN)
+    DECLARE_IO_BITFIELD_WRAPPER(RCC->PLLI2SCFGR, PllI2sN, RCC_PLLI2SCFGR_PLLI2SN);
+    DECLARE_IO_BITFIELD_WRAPPER(RCC->PLLI2SCFGR, PllI2sR, RCC_PLLI2SCFGR_PLLI2SR);
+    #if defined (RCC_PLLI2SCFGR_PLLI2SM)
+        DECLARE_IO_BITFIELD_WRAPPER(RCC->PLLI2SCFGR, PllI2sM, RCC_PLLI2SCFGR_PLLI2SM);
+    #endif
+
+    /**
+     * @brief Implements I2S PLL (PLLI2S)
+     *
+     * @details
+     * PLLI2S input is main PLL input (PLL source divided by PLLM), I2S clock is input * N / R.
+     */
+    class PllI2sClock : public ClockBase<>
+    {
+    public:
+        /**
+         * @brief Returns PLLI2S multiplier (N)
+         *
+         * @returns Multiplier
+         */
+        static unsigned GetMultiplier()
+        {
+            return PllI2sN::Get();
+        }
+
+        /**
+         * @brief Set PLLI2S multiplier (N). PLLI2S must be disabled.
+         *
+         * @tparam multiplier Multiplier
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<unsigned multiplier>
+        static void SetMultiplier()
+        {
+            static_assert(50 <= multiplier && multiplier <= 432, "Invalide multiplier value");
+            PllI2sN::Set(multiplier);
+        #if defined (RCC_PLLI2SCFGR_PLLI2SM)
+            // Input divider is separate on some devices, keep input equal to main PLL input
+            PllI2sM::Set(PllM::Get());
+        #endif
+        }
+
+        /**
+         * @brief Returns I2S output divider (R)
+         *
+         * @returns Divider
+         */
+        static unsigned GetOutputDivider()
+        {
+            return PllI2sR::Get();
+        }
+
+        /**
+         * @brief Set I2S output divider (R). PLLI2S must be disabled.
+         *
+         * @tparam divider Divider
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<unsigned divider>
+        static void SetOutputDivider()
+        {
+            static_assert(2 <= divider && divider <= 7, "Invalide divider value");
+            PllI2sR::Set(divider);
+        }
+
+        /**
+         * @brief Returns I2S clock frequence
+         *
+         * @returns Frequence
+         */
+        static ClockFrequenceT ClockFreq()
+        {
+            return PllClock::SrcClockFreq() / PllClock::GetDivider() * GetMultiplier() / GetOutputDivider();
+        }
+
+        /**
+         * @brief Enables PLLI2S
+         *
+         * @retval true Successful enable
+         * @retval false Fail enable
+         */
+        static bool Enable()
+        {
+        #if defined (RCC_CFGR_I2SSRC)
+            // I2S clock source is PLLI2S (not external I2S_CKIN)
+            RCC->CFGR &= ~RCC_CFGR_I2SSRC;
+        #endif
+            return ClockBase::EnableClockSource(RCC_CR_PLLI2SON, RCC_CR_PLLI2SRDY);
+        }
+
+        /**
+         * @brief Disables PLLI2S
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Disable()
+        {
+            ClockBase::DisableClockSource(RCC_CR_PLLI2SON, RCC_CR_PLLI2SRDY);
+        }
+    };
+#endif
+
     DECLARE_IO_BITFIELD_WRAPPER(RCC->CFGR, AhbPrescalerBitField, RCC_CFGR_HPRE);
 
     class AhbClock : public BusClock<SysClock, AhbPrescalerBitField>
@@ -235,6 +342,7 @@ namespace Zhele::Clock
     using I2c1Clock = ClockControl<PeriphClockEnable1, RCC_APB1ENR_I2C1EN, Apb1Clock>;
     using I2c2Clock = ClockControl<PeriphClockEnable1, RCC_APB1ENR_I2C2EN, Apb1Clock>;
     using PwrClock = ClockControl<PeriphClockEnable1, RCC_APB1ENR_PWREN, Apb1Clock>;
+    using PowerClock = PwrClock;
     using Tim5Clock = ClockControl<PeriphClockEnable1, RCC_APB1ENR_TIM5EN, Apb1Clock>;
     using Usart2Clock = ClockControl<PeriphClockEnable1, RCC_APB1ENR_USART2EN, Apb1Clock>;
     using WatchDogClock = ClockControl<PeriphClockEnable1, RCC_APB1ENR_WWDGEN, Apb1Clock>;
@@ -254,7 +362,7 @@ namespace Zhele::Clock
         using CcmDataRamClock = ClockControl<Ahb1ClockEnableReg, RCC_AHB1ENR_CCMDATARAMEN, AhbClock>;
     #endif
     #if defined (RCC_AHB1ENR_DMA2DEN)
-        using Dma2Clock = ClockControl<Ahb1ClockEnableReg, RCC_AHB1ENR_DMA2DEN, AhbClock>;
+        using Dma2DClock = ClockControl<Ahb1ClockEnableReg, RCC_AHB1ENR_DMA2DEN, AhbClock>;
     #endif
     #if defined (RCC_AHB1ENR_ETHMACEN)
         using EthMacClock = ClockControl<Ahb1ClockEnableReg, RCC_AHB1ENR_ETHMACEN, AhbClock>;
@@ -11,6 +11,7 @@
 #define ZHELE_DAC_H
 
 #include <stm32f4xx.h>
+#include <zhele/timer.h>
 #include "../common/dac.h"
 
 namespace Zhele
@@ -27,6 +28,23 @@ namespace Zhele
         Exti9 = 0x06, ///< External line 9
         Software = 0x07 ///< Software trigger
     };
+
+    namespace Private
+    {
+        template<>
+        struct DacTimerTrigger<Timers::Timer2>
+        {
+            static constexpr bool Supported = true;
+            static constexpr DacTrigger Trigger = DacTrigger::Timer2Trgo;
+        };
+
+        template<>
+        struct DacTimerTrigger<Timers::Timer4>
+        {
+            static constexpr bool Supported = true;
+            static constexpr DacTrigger Trigger = DacTrigger::Timer4Trgo;
+        };
+    }
 }
 
 #endif //! ZHELE_DAC_H
\ No newline at end of file
@@ -12,17 +12,102 @@
 
 #include <stm32f4xx.h>
 
+/**
+ * @def ZHELE_FLASH_WAIT_STATE_FREQUENCE
+ * @brief Max HCLK frequence for one flash wait state
+ * @details
+ * Default value is for 2.7-3.6 V supply voltage, define it as 24000000 for 2.4-2.7 V supply (see reference manual).
+ */
+#if !defined (ZHELE_FLASH_WAIT_STATE_FREQUENCE)
+    #define ZHELE_FLASH_WAIT_STATE_FREQUENCE 30000000
+#endif
+
+/**
+ * @def ZHELE_FLASH_MAX_LATENCY
+ * @brief Max flash wait states count
+ */
+#if !defined (ZHELE_FLASH_MAX_LATENCY)
+    #define ZHELE_FLASH_MAX_LATENCY 7
+#endif
+
 #include "../common/flash.h"
 
 namespace Zhele
 {
-    const static uint32_t MaxFlashFrequence = 24000000;
+    const static uint32_t MaxFlashFrequence = ZHELE_FLASH_WAIT_STATE_FREQUENCE;
     inline void Flash::ConfigureFrequence(uint32_t frequence)
     {
-        uint32_t ws = (frequence - 1) / MaxFlashFrequence;
-        if(ws > 7)
-            ws = 7;
-        FLASH->ACR |= FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN | ws;
+        FLASH->ACR |= FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN;
+        SetLatency(Latency(frequence));
+    }
+
+    inline void Flash::EnablePrefetch()
+    {
+        FLASH->ACR |= FLASH_ACR_PRFTEN;
+    }
+
+    inline void Flash::DisablePrefetch()
+    {
+        FLASH->ACR &= ~FLASH_ACR_PRFTEN;
+    }
+
+    inline void Flash::EnableICache()
+    {
+        FLASH->ACR |= FLASH_ACR_ICEN;
+    }
+
+    inline void Flash::DisableICache()
+    {
+        FLASH->ACR &= ~FLASH_ACR_ICEN;
+    }
+
+    inline void Flash::ResetICache()
+    {
+        uint32_t enabled = FLASH->ACR & FLASH_ACR_ICEN;
+        FLASH->ACR &= ~FLASH_ACR_ICEN;
+        FLASH->ACR |= FLASH_ACR_ICRST;
+        FLASH->ACR &= ~FLASH_ACR_ICRST;
+        FLASH->ACR |= enabled;
+    }
+
+    inline void Flash::EnableDCache()
+    {
+        FLASH->ACR |= FLASH_ACR_DCEN;
+    }
+
+    inline void Flash::DisableDCache()
+    {
+        FLASH->ACR &= ~FLASH_ACR_DCEN;
+    }
+
+    inline void Flash::ResetDCache()
+    {
+        uint32_t enabled = FLASH->ACR & FLASH_ACR_DCEN;
+        FLASH->ACR &= ~FLASH_ACR_DCEN;
+        FLASH->ACR |= FLASH_ACR_DCRST;
+        FLASH->ACR &= ~FLASH_ACR_DCRST;
+        FLASH->ACR |= enabled;
+    }
+
+    template<uint32_t _Frequence>
+    inline void Flash::OptimiseForFrequency()
+    {
+        static constexpr uint32_t latency = Latency(_Frequence);
+        static_assert((_Frequence - 1) / ZHELE_FLASH_WAIT_STATE_FREQUENCE <= ZHELE_FLASH_MAX_LATENCY,
+            "Frequence is too high for flash");
+
+        SetLatency(latency);
+        EnablePrefetch();
+
+        // Cache must be reset only while it's disabled
+        if ((FLASH->ACR & FLASH_ACR_ICEN) == 0) {
+            ResetICache();
+            EnableICache();
+        }
+        if ((FLASH->ACR & FLASH_ACR_DCEN) == 0) {
+            ResetDCache();
+            EnableDCache();
+        }
     }
 }
 
@@ -63,6 +63,8 @@ namespace Zhele
             SdaPin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
             SdaPin::template SetDriverType<SdaPin::Port::OpenDrain>();
             SdaPin::template SetPullMode<SdaPin::PullMode::PullUp>();
+
+            _busClear = ClearBus<SclPin, SdaPin>;
         }
 
         I2C_TEMPLATE_ARGS
@@ -0,0 +1,21 @@
+/**
+ * @file
+ * Implements I2S for stm32f4 series
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_I2S_H
+#define ZHELE_I2S_H
+
+#include <stm32f4xx.h>
+
+#if defined (SPI_I2SCFGR_I2SMOD) && defined (RCC_PLLI2SCFGR_PLLI2SN)
+    #include "../common/i2s.h"
+#else
+    #error "THIS MCU does not support I2S"
+#endif
+
+#endif //! ZHELE_I2S_H
@@ -69,8 +69,8 @@ namespace Zhele::Timers
             using Type = typename Pins::DataType;
             Type mask = 1 << pinNumber;
             Pins::Enable();
-            Pins::SetConfiguration(mask, Pins::Configuration::AltFunc);
-            Pins::AltFuncNumber(mask, GetNumberRuntime<PinAltFuncNumbers>::Get(pinNumber));
+            Pins::SetConfiguration(Pins::Configuration::AltFunc, mask);
+            Pins::AltFuncNumber(GetNumberRuntime<PinAltFuncNumbers>::Get(pinNumber), mask);
         }
 
         template <typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins>
@@ -97,7 +97,47 @@ namespace Zhele::Timers
             SelectPins<Pins::template IndexOf<Pin>>();
         }
 
+        template <typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins, template<unsigned> typename _ChNPins, typename _BreakPins>
+        template <unsigned _ChannelNumber>
+        template <typename Pin>
+        void AdvancedTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins, _ChNPins, _BreakPins>::ComplementaryPwm<_ChannelNumber>::SelectComplementaryPins()
+        {
+            using Pins = AdvancedTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins, _ChNPins, _BreakPins>::ComplementaryPwm<_ChannelNumber>::ComplementaryPins;
+            using PinAltFuncNumbers = AdvancedTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins, _ChNPins, _BreakPins>::ComplementaryPwm<_ChannelNumber>::ComplementaryPinsAltFuncNumber;
+            static_assert(Pins::template IndexOf<Pin> >= 0);
+
+            Pin::Port::Enable();
+            Pin::template SetConfiguration<Pin::Port::AltFunc>();
+            Pin::template SetDriverType<Pin::Port::DriverType::PushPull>();
+            Pin::template AltFuncNumber<GetNonTypeValueByIndex<Pins::template IndexOf<Pin>, PinAltFuncNumbers>::value>();
+        }
+
+        template <typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins, template<unsigned> typename _ChNPins, typename _BreakPins>
+        template <typename Pin>
+        void AdvancedTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins, _ChNPins, _BreakPins>::SelectBreakPins()
+        {
+            using Pins = typename _BreakPins::Key;
+            using PinAltFuncNumbers = typename _BreakPins::Value;
+            static_assert(Pins::template IndexOf<Pin> >= 0);
+
+            Pin::Port::Enable();
+            Pin::template SetConfiguration<Pin::Configuration::AltFunc>();
+            Pin::template AltFuncNumber<GetNonTypeValueByIndex<Pins::template IndexOf<Pin>, PinAltFuncNumbers>::value>();
+        }
+
         using namespace Zhele::IO;
+        template<unsigned ChannelNumber> struct Tim1ChPins;
+        template<> struct Tim1ChPins<0>{ using Pins = Pair<IO::PinList<Pa8, Pe9>, NonTypeTemplateArray<1, 1>>; };
+        template<> struct Tim1ChPins<1>{ using Pins = Pair<IO::PinList<Pa9, Pe11>, NonTypeTemplateArray<1, 1>>; };
+        template<> struct Tim1ChPins<2>{ using Pins = Pair<IO::PinList<Pa10, Pe13>, NonTypeTemplateArray<1, 1>>; };
+        template<> struct Tim1ChPins<3>{ using Pins = Pair<IO::PinList<Pa11, Pe14>, NonTypeTemplateArray<1, 1>>; };
+
+        template<unsigned ChannelNumber> struct Tim1ChNPins;
+        template<> struct Tim1ChNPins<0>{ using Pins = Pair<IO::PinList<Pa7, Pb13, Pe8>, NonTypeTemplateArray<1, 1, 1>>; };
+        template<> struct Tim1ChNPins<1>{ using Pins = Pair<IO::PinList<Pb0, Pb14, Pe10>, NonTypeTemplateArray<1, 1, 1>>; };
+        template<> struct Tim1ChNPins<2>{ using Pins = Pair<IO::PinList<Pb1, Pb15, Pe12>, NonTypeTemplateArray<1, 1, 1>>; };
+        using Tim1BreakPins = Pair<IO::PinList<Pa6, Pb12, Pe15>, NonTypeTemplateArray<1, 1, 1>>;
+
         template<unsigned ChannelNumber> struct Tim2ChPins;
         template<> struct Tim2ChPins<0>{ using Pins = Pair<IO::PinList<Pa0, Pa5, Pa15>, NonTypeTemplateArray<1, 1, 1>>; };
         template<> struct Tim2ChPins<1>{ using Pins = Pair<IO::PinList<Pa1, Pb3>, NonTypeTemplateArray<1, 1, 1>>; };
@@ -122,9 +162,27 @@ namespace Zhele::Timers
         IO_STRUCT_WRAPPER(TIM4, Tim4Regs, TIM_TypeDef);
     }
 
+    using Timer1 = Private::AdvancedTimer<Private::Tim1Regs, Clock::Tim1Clock, TIM1_UP_TIM10_IRQn, Private::Tim1ChPins, Private::Tim1ChNPins, Private::Tim1BreakPins>;
     using Timer2 = Private::GPTimer<Private::Tim2Regs, Clock::Tim2Clock, TIM2_IRQn, Private::Tim2ChPins>;
     using Timer3 = Private::GPTimer<Private::Tim3Regs, Clock::Tim3Clock, TIM3_IRQn, Private::Tim3ChPins>;
     using Timer4 = Private::GPTimer<Private::Tim4Regs, Clock::Tim4Clock, TIM4_IRQn, Private::Tim4ChPins>;
+
+    namespace Private
+    {
+        // Internal trigger connection (slave timer ITRx <- master timer TRGO)
+        template<> struct TimerInternalTrigger<Timer2, Timer1> { static const int Value = 1; };
+        template<> struct TimerInternalTrigger<Timer3, Timer1> { static const int Value = 2; };
+        template<> struct TimerInternalTrigger<Timer4, Timer1> { static const int Value = 3; };
+        template<> struct TimerInternalTrigger<Timer1, Timer2> { static const int Value = 0; };
+        template<> struct TimerInternalTrigger<Timer1, Timer3> { static const int Value = 0; };
+        template<> struct TimerInternalTrigger<Timer1, Timer4> { static const int Value = 0; };
+        template<> struct TimerInternalTrigger<Timer3, Timer2> { static const int Value = 2; };
+        template<> struct TimerInternalTrigger<Timer4, Timer2> { static const int Value = 3; };
+        template<> struct TimerInternalTrigger<Timer2, Timer3> { static const int Value = 1; };
+        template<> struct TimerInternalTrigger<Timer4, Timer3> { static const int Value = 3; };
+        template<> struct TimerInternalTrigger<Timer2, Timer4> { static const int Value = 1; };
+        template<> struct TimerInternalTrigger<Timer3, Timer4> { static const int Value = 2; };
+    }
 }
 
 #endif //! ZHELE_TIMER_H
\ No newline at end of file
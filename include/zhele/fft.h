@@ -0,0 +1,180 @@
+/**
+ * @file
+ * Implements real FFT (Q15 and float), windows and spectrum analysis
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_FFT_H
+#define ZHELE_FFT_H
+
+#include <zhele/dsp.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Zhele::Dsp
+{
+    /**
+     * @brief Complex number (interleaved real and imaginary parts)
+     *
+     * @tparam _Sample Part type (int16_t for Q15, float)
+     */
+    template<typename _Sample>
+    struct Complex
+    {
+        _Sample re; ///< Real part
+        _Sample im; ///< Imaginary part
+    };
+
+    /// Window function
+    enum class Window : uint8_t
+    {
+        Rectangular, ///< No window
+        Hann, ///< Hann (raised cosine)
+        Hamming, ///< Hamming
+        Blackman, ///< Blackman
+    };
+
+    /**
+     * @brief Generates window table (call it in constant expression to place table in flash)
+     *
+     * @par Example
+     * @code
+     *  static constexpr auto hann = Dsp::MakeWindow<int16_t, 256>(Dsp::Window::Hann);
+     * @endcode
+     *
+     * @tparam _Sample Table type (int16_t for Q15, float)
+     * @tparam _Size Table size
+     *
+     * @param [in] window Window function
+     *
+     * @returns Table
+     */
+    template<typename _Sample, size_t _Size>
+    consteval std::array<_Sample, _Size> MakeWindow(Window window);
+
+    /**
+     * @brief Spectrum peak
+     *
+     * @tparam _Sample Magnitude type
+     */
+    template<typename _Sample>
+    struct SpectrumPeak
+    {
+        size_t bin; ///< Bin index
+        _Sample magnitude; ///< Bin magnitude
+    };
+
+    /**
+     * @brief Implements real FFT
+     *
+     * @details
+     * Real input of _Size samples is transformed as complex sequence of _Size / 2 points
+     * (even samples are real parts, odd ones are imaginary parts) and spectrum is split to _Size / 2 + 1 bins
+     * (from DC to Nyquist frequency). Input is loaded in bit-reversed order (window is applied at the same pass),
+     * then two radix-2 stages are fused in every radix-4 pass (one radix-2 pass remains if log2(_Size / 2) is odd).
+     * Twiddle table is computed by compiler and is placed in flash.
+     * Q15 transform halves data on every stage (halving add/subtract is one SIMD instruction on Cortex-M4,
+     * Q15 twiddle multiply is SMUSD/SMUADX), so it never overflows and output is X[k] / _Size.
+     * Float transform (use it on parts with FPU) is not scaled.
+     *
+     * @par Example
+     * @code
+     *  using Fft = Dsp::RealFft<int16_t, 256>;
+     *  static constexpr auto window = Dsp::MakeWindow<int16_t, 256>(Dsp::Window::Hann);
+     *  Dsp::Complex<int16_t> spectrum[Fft::Bins];
+     *  Fft::Transform(samples, window, spectrum);
+     *  auto peak = Fft::FindPeak(spectrum);
+     *  uint32_t frequency = Fft::BinFrequency(peak.bin, 10000);
+     * @endcode
+     *
+     * @tparam _Sample Sample type (int16_t for Q15, float)
+     * @tparam _Size Transform size (power of two, at least 4)
+     */
+    template<typename _Sample, size_t _Size>
+    class RealFft
+    {
+        static_assert(_Size >= 4 && (_Size & (_Size - 1)) == 0, "FFT size must be power of two");
+        static constexpr size_t Points = _Size / 2;
+    public:
+        using ComplexType = Complex<_Sample>;
+
+        /// Spectrum bins count
+        static constexpr size_t Bins = _Size / 2 + 1;
+
+        /**
+         * @brief Transforms real samples
+         *
+         * @param [in] input Samples (at least _Size)
+         * @param [out] output Spectrum (at least Bins)
+         *
+         * @retval true Spectrum is calculated
+         * @retval false Buffer is too small
+         */
+        static bool Transform(std::span<const _Sample> input, std::span<ComplexType> output);
+
+        /**
+         * @brief Transforms real samples with window
+         *
+         * @param [in] input Samples (at least _Size)
+         * @param [in] window Window (see @ref MakeWindow)
+         * @param [out] output Spectrum (at least Bins)
+         *
+         * @retval true Spectrum is calculated
+         * @retval false Buffer is too small
+         */
+        static bool Transform(std::span<const _Sample> input, std::span<const _Sample, _Size> window, std::span<ComplexType> output);
+
+        /**
+         * @brief Calculates bins magnitudes
+         *
+         * @param [in] spectrum Spectrum
+         * @param [out] output Magnitudes (can be the same buffer as spectrum)
+         *
+         * @returns Calculated magnitudes count
+         */
+        static size_t Magnitude(std::span<const ComplexType> spectrum, std::span<_Sample> output);
+
+        /**
+         * @brief Finds bin with maximal magnitude
+         *
+         * @param [in] spectrum Spectrum
+         * @param [in] firstBin First bin to search (1 skips DC)
+         *
+         * @returns Peak (bin and magnitude)
+         */
+        static SpectrumPeak<_Sample> FindPeak(std::span<const ComplexType> spectrum, size_t firstBin = 1);
+
+        /**
+         * @brief Returns bin center frequency
+         *
+         * @param [in] bin Bin index
+         * @param [in] sampleRate Sample rate
+         *
+         * @returns Frequency
+         */
+        static constexpr uint32_t BinFrequency(size_t bin, uint32_t sampleRate);
+
+    private:
+        static void Load(const _Sample* input, const _Sample* window, ComplexType* output);
+        static void Butterflies(ComplexType* data);
+        static void Split(ComplexType* data);
+    };
+
+    /// Q15 real FFT
+    template<size_t _Size>
+    using RealFftQ15 = RealFft<int16_t, _Size>;
+
+    /// Float real FFT
+    template<size_t _Size>
+    using RealFftF32 = RealFft<float, _Size>;
+}
+
+#include "impl/fft.h"
+
+#endif //! ZHELE_FFT_H
@@ -0,0 +1,335 @@
+/**
+ * @file
+ * Implements log-structured key-value store in flash pages
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_FLASH_KV_H
+#define ZHELE_FLASH_KV_H
+
+#include <zhele/flash.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements key-value store (calibration, counters, settings) over flash pages
+     *
+     * @details
+     * Store is append-only log: every update appends record (8 bytes header with key, size and CRC32
+     * and data padded to 8 bytes), so update costs few flash word writes instead of page erase.
+     * RAM index (key -> last record) is rebuilt by @ref Init from pages log.
+     *
+     * Page starts with header (sequence number with check word). When head page is full, next erased page
+     * becomes head. Compaction copies live records of the oldest page to head page and erases it,
+     * it's performed by @ref Process from main loop (one record copy or page erase per call), so
+     * updates don't wait for page erase while there are two erased pages. One erased page is always kept
+     * for compaction, if it's needed for update, compaction is performed synchronously.
+     *
+     * Power-fail safety:
+     *  - Interrupted record write gives record with wrong CRC, it's skipped on rebuild.
+     *  - Copied record is newer than original one (by page sequence), so interrupted compaction doesn't lose data.
+     *  - Compacted page is marked as obsolete before erase, so after interrupted erase it's not used.
+     *
+     * Methods are not reentrant, call them from main loop only.
+     *
+     * @par Example
+     * @code
+     *  // Last 4 pages of flash
+     *  using Settings = FlashKvStore<Flash::PageCount() - 4, 4>;
+     *  Settings::Init();
+     *  uint32_t bootCount = 0;
+     *  Settings::Get(1, bootCount);
+     *  Settings::Set(1, bootCount + 1);
+     *  for(;;)
+     *  {
+     *      Settings::Process();
+     *  }
+     * @endcode
+     *
+     * @tparam _FirstPage First page of store
+     * @tparam _PagesCount Pages count (at least 2, all pages must have the same size)
+     * @tparam _MaxKeys Max keys count (RAM index size)
+     * @tparam _Flash Flash (@ref Flash interface)
+     */
+    template<unsigned _FirstPage, unsigned _PagesCount, unsigned _MaxKeys = 32, typename _Flash = Flash>
+    class FlashKvStore
+    {
+        static_assert(_PagesCount >= 2, "Store needs at least two pages (one is reserved for compaction)");
+        static_assert(_PagesCount < 0xff, "Too many pages");
+
+        static const uint32_t PageSize = _Flash::PageSize(_FirstPage);
+        static const uint32_t Unit = 8; ///< Program unit (double word for G0, both half word and word programming accept it)
+        static const uint32_t PageMagic = 0x3153564b; ///< "KVS1"
+        static const uint32_t ActiveState = 0xffffffff; ///< Page state unit is erased while page is used
+        static const uint32_t ObsoleteState = 0;
+        static const uint16_t Erased = 0xffff;
+        static const uint16_t Tombstone = 0x8000; ///< Removed key flag (in record length)
+        static const uint8_t NoPage = 0xff;
+
+        /// Page header (two program units)
+        struct PageHeader
+        {
+            uint32_t Sequence; ///< Page sequence number
+            uint32_t Check; ///< Sequence number XOR magic (interrupted header write gives wrong check)
+            uint32_t State; ///< Page state (it's programmed to 0 before erase)
+            uint32_t Reserved; ///< Reserved
+        };
+
+        /// Record header (one program unit)
+        struct RecordHeader
+        {
+            uint16_t Key; ///< Key
+            uint16_t Length; ///< Data length (with tombstone flag)
+            uint32_t Crc; ///< CRC32 of key, length and data
+        };
+
+        /// Index entry
+        struct Entry
+        {
+            uint16_t Key; ///< Key
+            uint16_t Length; ///< Data length
+            uint32_t Offset; ///< Record offset (from store start)
+        };
+
+        static_assert(PageSize % Unit == 0, "Page size must be multiple of program unit");
+        static_assert(PageSize >= sizeof(PageHeader) + 2 * sizeof(RecordHeader), "Page is too small");
+    public:
+        /// Max value size
+        static const uint16_t MaxValueSize = (PageSize - sizeof(PageHeader) - sizeof(RecordHeader)) < Tombstone
+            ? PageSize - sizeof(PageHeader) - sizeof(RecordHeader)
+            : Tombstone - 1;
+
+        /**
+         * @brief Inits store (rebuilds index, completes interrupted compaction, erases damaged pages)
+         *
+         * @retval true Success
+         * @retval false Flash error
+         */
+        static bool Init();
+
+        /**
+         * @brief Writes value
+         *
+         * @details
+         * If value is not changed, nothing is written.
+         *
+         * @param [in] key Key (0...0xfffe)
+         * @param [in] data Value
+         * @param [in] size Value size
+         *
+         * @retval true Success
+         * @retval false Invalid key or size, store is full or flash error
+         */
+        static bool Set(uint16_t key, const void* data, uint16_t size);
+
+        /**
+         * @brief Writes value (trivially copyable object)
+         *
+         * @tparam T Value type
+         *
+         * @param [in] key Key
+         * @param [in] value Value
+         *
+         * @retval true Success
+         * @retval false Invalid key, store is full or flash error
+         */
+        template<typename T>
+        static bool Set(uint16_t key, const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Value must be trivially copyable");
+            return Set(key, &value, sizeof(T));
+        }
+
+        /**
+         * @brief Reads value
+         *
+         * @param [in] key Key
+         * @param [out] buffer Buffer
+         * @param [in] size Buffer size
+         *
+         * @returns Stored value size (0 if key is not found). Buffer gets not more than size bytes.
+         */
+        static uint16_t Get(uint16_t key, void* buffer, uint16_t size);
+
+        /**
+         * @brief Reads value (trivially copyable object)
+         *
+         * @tparam T Value type
+         *
+         * @param [in] key Key
+         * @param [out] value Value
+         *
+         * @retval true Value is found (and it has type size)
+         * @retval false Value is not found, value is not changed
+         */
+        template<typename T>
+        static bool Get(uint16_t key, T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Value must be trivially copyable");
+            const Entry* entry = Find(key);
+            if(entry == nullptr || entry->Length != sizeof(T))
+                return false;
+            memcpy(&value, Data(entry->Offset + sizeof(RecordHeader)), sizeof(T));
+            return true;
+        }
+
+        /**
+         * @brief Checks that key is stored
+         *
+         * @param [in] key Key
+         *
+         * @retval true Key is found
+         * @retval false Key is not found
+         */
+        static bool Contains(uint16_t key)
+        {
+            return Find(key) != nullptr;
+        }
+
+        /**
+         * @brief Removes value
+         *
+         * @param [in] key Key
+         *
+         * @retval true Success (or key is not found)
+         * @retval false Store is full or flash error
+         */
+        static bool Remove(uint16_t key);
+
+        /**
+         * @brief Returns stored keys count
+         *
+         * @returns Keys count
+         */
+        static unsigned Count()
+        {
+            return _count;
+        }
+
+        /**
+         * @brief Performs background compaction step (call it from main loop)
+         *
+         * @details
+         * Compaction is started if there are less than two erased pages. One call copies one live record
+         * or erases compacted page.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Process();
+
+        /**
+         * @brief Returns compaction state
+         *
+         * @retval true Compaction is in progress
+         * @retval false There is no compaction
+         */
+        static bool Compacting()
+        {
+            return _compactPage != NoPage;
+        }
+
+    private:
+        static const uint8_t* Data(uint32_t offset)
+        {
+            return reinterpret_cast<const uint8_t*>(_Flash::PageAddress(_FirstPage)) + offset;
+        }
+
+        static uint32_t RecordSize(uint16_t length)
+        {
+            return sizeof(RecordHeader) + ((length & ~Tombstone) + Unit - 1) / Unit * Unit;
+        }
+
+        static uint32_t HeadSpace()
+        {
+            return PageSize - _headOffset;
+        }
+
+        static uint32_t Crc32(uint32_t crc, const void* data, unsigned size);
+        static const Entry* Find(uint16_t key);
+        static unsigned FreePages();
+        static uint8_t OldestPage();
+        static bool ErasePage(uint8_t page);
+
+        /**
+         * @brief Checks record
+         *
+         * @param [in] page Page
+         * @param [in] offset Record offset in page
+         * @param [out] valid Record has valid CRC
+         *
+         * @returns Next record offset (offset if there is no record)
+         */
+        static uint32_t ScanRecord(uint8_t page, uint32_t offset, bool& valid);
+
+        /**
+         * @brief Updates index by record
+         *
+         * @param [in] key Key
+         * @param [in] length Record length
+         * @param [in] offset Record offset (from store start)
+         *
+         * @retval true Success
+         * @retval false Index is full
+         */
+        static bool Apply(uint16_t key, uint16_t length, uint32_t offset);
+
+        /**
+         * @brief Makes next erased page head
+         *
+         * @retval true Success
+         * @retval false There are no erased pages or flash error
+         */
+        static bool OpenHead();
+
+        /**
+         * @brief Provides head space for record
+         *
+         * @param [in] size Record size
+         *
+         * @retval true Success
+         * @retval false Store is full or flash error
+         */
+        static bool Reserve(uint32_t size);
+
+        /**
+         * @brief Appends record to head page
+         *
+         * @param [in] key Key
+         * @param [in] length Record length (with tombstone flag)
+         * @param [in] data Data
+         *
+         * @retval true Success
+         * @retval false Store is full or flash error
+         */
+        static bool Append(uint16_t key, uint16_t length, const void* data);
+
+        /**
+         * @brief Performs compaction step
+         *
+         * @retval true Success
+         * @retval false There is no space for live record or flash error
+         */
+        static bool CompactStep();
+
+        static Entry _index[_MaxKeys]; ///< Index
+        static unsigned _count; ///< Index entries count
+        static uint32_t _sequences[_PagesCount]; ///< Page sequence numbers (0 for erased pages)
+        static uint32_t _nextSequence; ///< Sequence number for next head page
+        static uint8_t _head; ///< Head page
+        static uint32_t _headOffset; ///< Write offset in head page
+        static uint8_t _compactPage; ///< Page under compaction (NoPage if there is no compaction)
+        static uint32_t _compactOffset; ///< Compaction offset
+    };
+} // namespace Zhele
+
+#include "impl/flash_kv.h"
+
+#endif //! ZHELE_FLASH_KV_H
@@ -0,0 +1,143 @@
+/**
+ * @file
+ * Implements compact formatter with compile-time format string parsing
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_FORMAT_H
+#define ZHELE_FORMAT_H
+
+#include <zhele/binary_stream.h>
+
+#include "common/template_utils/fixed_string.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace Zhele
+{
+    /**
+     * @brief Fixed-point format argument
+     *
+     * @details
+     * Wraps raw fixed-point value (for example, Q16.16 PID output or Q15 sample)
+     * and prints it as decimal fraction: "{:.2}" with Fixed<16>{0x18000} gives "1.50".
+     * Default precision is 3 fractional digits.
+     *
+     * @tparam _FractionalBits Fractional bits count
+     * @tparam T Raw value type
+     */
+    template<unsigned _FractionalBits, typename T = int32_t>
+    struct Fixed
+    {
+        static_assert(std::is_integral_v<T> && sizeof(T) <= 4, "Raw value must be integer up to 32 bits");
+        static_assert(_FractionalBits > 0 && _FractionalBits < sizeof(T) * 8 + (std::is_unsigned_v<T> ? 1 : 0), "Invalid fractional bits count");
+
+        static const unsigned FractionalBits = _FractionalBits; ///< Fractional bits count
+        T Value; ///< Raw value
+    };
+
+    /// Q16.16 format argument
+    using FixedQ16 = Fixed<16>;
+
+    /// Q15 format argument
+    using FixedQ15 = Fixed<15, int16_t>;
+
+    /// Q31 format argument
+    using FixedQ31 = Fixed<31>;
+
+    namespace Private
+    {
+        /// Sink with bulk write into ring (RingBuffer, RingBufferPO2 of bytes)
+        template<typename T>
+        concept RingSink = requires(T& sink, typename T::size_type count) { sink.writable_span(); sink.commit(count); }
+            && sizeof(typename decltype(std::declval<T&>().writable_span())::element_type) == 1;
+    }
+
+    /**
+     * @brief Max formatted text length
+     *
+     * @tparam _Format Format string
+     * @tparam Args Arguments types
+     */
+    template<TemplateUtils::fixed_string _Format, typename... Args>
+    constexpr size_t FormatMaxSize();
+
+    /**
+     * @brief Formats arguments into buffer
+     *
+     * @details
+     * Format string is parsed at compile time, so runtime work is literal copies and
+     * integer to text conversions only (no heap, no varargs).
+     *
+     * Replacement field is "{[:[0][width][.precision][type]]}", arguments are taken in order.
+     * Types:
+     *  - d (default): decimal integer or fixed-point value (precision is fractional digits count)
+     *  - x, X: hexadecimal (signed values are printed as two's complement)
+     *  - b: binary
+     *  - c: character (default for char)
+     *
+     * "{{" and "}}" are printed as braces. Invalid format string and argument count
+     * mismatch are compile errors.
+     *
+     * @tparam _Format Format string
+     * @tparam Args Arguments types (integers, enums, char, @ref Fixed)
+     *
+     * @param [out] buffer Buffer (at least @ref FormatMaxSize bytes, no terminating zero is written)
+     * @param [in] args Arguments
+     *
+     * @returns Formatted text length
+     */
+    template<TemplateUtils::fixed_string _Format, typename... Args>
+    size_t FormatTo(char* buffer, Args... args);
+
+    /**
+     * @brief Formats arguments and writes text to ring buffer
+     *
+     * @par Example
+     * @code
+     *  Containers::RingBuffer<128> log;
+     *  Format<"adc {} rpm {:.1}\r\n">(log, sample, FixedQ16{speed});
+     * @endcode
+     *
+     * @tparam _Format Format string (see @ref FormatTo)
+     * @tparam _Sink Ring buffer type
+     * @tparam Args Arguments types
+     *
+     * @param [in] sink Ring buffer
+     * @param [in] args Arguments
+     *
+     * @returns Written bytes count (less than formatted length if ring is full)
+     */
+    template<TemplateUtils::fixed_string _Format, Private::RingSink _Sink, typename... Args>
+    size_t Format(_Sink& sink, Args... args);
+
+    /**
+     * @brief Formats arguments and writes text to static sink by one Write call
+     *
+     * @par Example
+     * @code
+     *  Format<"status {:08x}\r\n", Usart1>(status);
+     *  Format<"t={} {:.2}V\r\n", CdcSerial<CdcDataEndpoint>>(tick, FixedQ16{voltage});
+     * @endcode
+     *
+     * @tparam _Format Format string (see @ref FormatTo)
+     * @tparam _Sink Sink with static Write(const void*, size_t): Usart (blocking), BufferedUsart, CdcSerial
+     * @tparam Args Arguments types
+     *
+     * @param [in] args Arguments
+     *
+     * @returns Formatted text length
+     */
+    template<TemplateUtils::fixed_string _Format, Private::BulkWriteSource _Sink, typename... Args>
+    size_t Format(Args... args);
+}
+
+#include "impl/format.h"
+
+#endif //! ZHELE_FORMAT_H
@@ -92,14 +92,15 @@ namespace Zhele::Clock
 #if defined (RCC_PLLCFGR_PLLQ_Pos)
     inline unsigned PllClock::GetUsbOutputDivider()
     {
-        return PllQ::Get();
+        return PllQ::Get() + 1;
     }
 
     template<unsigned divider>
     inline void PllClock::SetUsbOutputDivider()
     {
-        static_assert(2 <= multiplier && multiplier <= (PllQ::MaxValue + 1), "Invalid divider value!");
-        PllQ::Set(divider);
+        static_assert(2 <= divider && divider <= (PllQ::MaxValue + 1), "Invalid divider value!");
+        RCC->PLLCFGR |= RCC_PLLCFGR_PLLQEN;
+        PllQ::Set(divider - 1);
     }
 #endif
 
@@ -220,7 +221,11 @@ namespace Zhele::Clock
     using RtcClock = ClockControl<PeriphClockEnable1, RCC_APBENR1_RTCAPBEN, ApbClock>;
     using WatchDogClock = ClockControl<PeriphClockEnable1, RCC_APBENR1_WWDGEN, ApbClock>;
     using Spi2Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_SPI2EN, ApbClock>;
+#if defined (RCC_CCIPR_USART2SEL)
+    using Usart2Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_USART2EN, UsartKernelClock<ApbClock, RCC_CCIPR_USART2SEL_Pos>>;
+#else
     using Usart2Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_USART2EN, ApbClock>;
+#endif
     using I2c1Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_I2C1EN, ApbClock>;
     using I2c2Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_I2C2EN, ApbClock>;
     using DbgClock = ClockControl<PeriphClockEnable1, RCC_APBENR1_DBGEN, ApbClock>;
@@ -228,7 +233,7 @@ namespace Zhele::Clock
     using SysCfgClock = ClockControl<PeriphClockEnable2, RCC_APBENR2_SYSCFGEN, ApbClock>;
     using Tim1Clock = ClockControl<PeriphClockEnable2, RCC_APBENR2_TIM1EN, ApbClock>;
     using Spi1Clock = ClockControl<PeriphClockEnable2, RCC_APBENR2_SPI1EN, ApbClock>;
-    using Usart1Clock = ClockControl<PeriphClockEnable2, RCC_APBENR2_USART1EN, ApbClock>;
+    using Usart1Clock = ClockControl<PeriphClockEnable2, RCC_APBENR2_USART1EN, UsartKernelClock<ApbClock, RCC_CCIPR_USART1SEL_Pos>>;
     using Tim14Clock = ClockControl<PeriphClockEnable2, RCC_APBENR2_TIM14EN, ApbClock>;
     using Tim16Clock = ClockControl<PeriphClockEnable2, RCC_APBENR2_TIM16EN, ApbClock>;
     using Tim17Clock = ClockControl<PeriphClockEnable2, RCC_APBENR2_TIM17EN, ApbClock>;
@@ -238,13 +243,13 @@ namespace Zhele::Clock
     using Tim2Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_TIM2EN, ApbClock>;
 #endif
 #if defined (RCC_APBENR1_LPUART1EN)
-    using LpUart1Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_LPUART1EN, ApbClock>;
+    using LpUart1Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_LPUART1EN, UsartKernelClock<ApbClock, RCC_CCIPR_LPUART1SEL_Pos>>;
 #endif
 #if defined (RCC_APBENR1_LPTIM2EN)
-    using LpTim2Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_LPTIM2EN, ApbClock>;
+    using LpTim2Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_LPTIM2EN, LpTimerKernelClock<ApbClock, RCC_CCIPR_LPTIM2SEL_Pos>>;
 #endif
 #if defined (RCC_APBENR1_LPTIM1EN)
-    using LpTim1Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_LPTIM1EN, ApbClock>;
+    using LpTim1Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_LPTIM1EN, LpTimerKernelClock<ApbClock, RCC_CCIPR_LPTIM1SEL_Pos>>;
 #endif
 #if defined (RCC_AHBENR_AESEN)
     using AesClock = ClockControl<AhbClockEnableReg, RCC_AHBENR_AESEN, AhbClock>;
@@ -265,7 +270,7 @@ namespace Zhele::Clock
     using Dac1Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_DAC1EN, ApbClock>;
 #endif
 #if defined (RCC_APBENR1_USART3EN)
-    using Usart3Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_USART3EN, ApbClock>;
+    using Usart3Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_USART3EN, UsartKernelClock<ApbClock, RCC_CCIPR_USART3SEL_Pos>>;
 #endif
 #if defined (RCC_APBENR1_USART4EN)
     using Usart4Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_USART4EN, ApbClock>;
@@ -304,7 +309,7 @@ namespace Zhele::Clock
     using I2c3Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_I2C3EN, ApbClock>;
 #endif
 #if defined (RCC_APBENR1_LPUART2EN)
-    using LpUart2Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_LPUART2EN, ApbClock>;
+    using LpUart2Clock = ClockControl<PeriphClockEnable1, RCC_APBENR1_LPUART2EN, UsartKernelClock<ApbClock, RCC_CCIPR_LPUART2SEL_Pos>>;
 #endif
 #if defined (RCC_APBENR1_FDCANEN)
     using FdCanClock = ClockControl<PeriphClockEnable1, RCC_APBENR1_FDCANEN, ApbClock>;
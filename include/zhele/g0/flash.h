@@ -12,6 +12,32 @@
 
 #include <stm32g0xx.h>
 
+/**
+ * @def ZHELE_FLASH_WAIT_STATE_FREQUENCE
+ * @brief Max HCLK frequence for one flash wait state
+ * @details
+ * Default value is for voltage range 1 (0 wait states up to 24 MHz, 2 up to 64 MHz), define it as 8000000 for range 2.
+ */
+#if !defined (ZHELE_FLASH_WAIT_STATE_FREQUENCE)
+    #define ZHELE_FLASH_WAIT_STATE_FREQUENCE 24000000
+#endif
+
+/**
+ * @def ZHELE_FLASH_MAX_LATENCY
+ * @brief Max flash wait states count
+ */
+#if !defined (ZHELE_FLASH_MAX_LATENCY)
+    #define ZHELE_FLASH_MAX_LATENCY 2
+#endif
+
+/**
+ * @def ZHELE_FLASH_DUAL_BANK
+ * @brief Flash has two banks (read while write, bank swap)
+ */
+#if defined (FLASH_OPTR_nSWAP_BANK)
+    #define ZHELE_FLASH_DUAL_BANK
+#endif
+
 #include "../common/flash.h"
 
 #include <algorithm>
@@ -19,13 +45,57 @@
 
 namespace Zhele
 {
-    const static uint32_t MaxFlashFrequence = 24000000;
+    const static uint32_t MaxFlashFrequence = ZHELE_FLASH_WAIT_STATE_FREQUENCE;
     inline void Flash::ConfigureFrequence(uint32_t frequence)
     {
-        uint32_t ws = (frequence - 1) / MaxFlashFrequence;
-        if(ws > 2)
-            ws = 2;
-        FLASH->ACR |= FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | ws;
+        FLASH->ACR |= FLASH_ACR_PRFTEN | FLASH_ACR_ICEN;
+        SetLatency(Latency(frequence));
+    }
+
+    inline void Flash::EnablePrefetch()
+    {
+        FLASH->ACR |= FLASH_ACR_PRFTEN;
+    }
+
+    inline void Flash::DisablePrefetch()
+    {
+        FLASH->ACR &= ~FLASH_ACR_PRFTEN;
+    }
+
+    inline void Flash::EnableICache()
+    {
+        FLASH->ACR |= FLASH_ACR_ICEN;
+    }
+
+    inline void Flash::DisableICache()
+    {
+        FLASH->ACR &= ~FLASH_ACR_ICEN;
+    }
+
+    inline void Flash::ResetICache()
+    {
+        uint32_t enabled = FLASH->ACR & FLASH_ACR_ICEN;
+        FLASH->ACR &= ~FLASH_ACR_ICEN;
+        FLASH->ACR |= FLASH_ACR_ICRST;
+        FLASH->ACR &= ~FLASH_ACR_ICRST;
+        FLASH->ACR |= enabled;
+    }
+
+    template<uint32_t _Frequence>
+    inline void Flash::OptimiseForFrequency()
+    {
+        static constexpr uint32_t latency = Latency(_Frequence);
+        static_assert((_Frequence - 1) / ZHELE_FLASH_WAIT_STATE_FREQUENCE <= ZHELE_FLASH_MAX_LATENCY,
+            "Frequence is too high for flash");
+
+        SetLatency(latency);
+        EnablePrefetch();
+
+        // Cache must be reset only while it's disabled
+        if ((FLASH->ACR & FLASH_ACR_ICEN) == 0) {
+            ResetICache();
+            EnableICache();
+        }
     }
 
     inline constexpr uint32_t Flash::PageSize(unsigned page)
@@ -41,11 +111,32 @@ namespace Zhele
 
     inline constexpr unsigned Flash::AddressToPage(const void* address)
     {
-        uint32_t offset = reinterpret_cast<uint32_t>(address) - FLASH_BASE;
+        uint32_t offset = AddressOf(address) - FLASH_BASE;
 
         return offset / PageSize(0);
     }
 
+    /// Erase selection bits of control register
+#if defined (ZHELE_FLASH_DUAL_BANK)
+    static constexpr uint32_t FlashEraseSelection = FLASH_CR_PNB_Msk | FLASH_CR_BKER | FLASH_CR_MER1 | FLASH_CR_MER2;
+#else
+    static constexpr uint32_t FlashEraseSelection = FLASH_CR_PNB_Msk | FLASH_CR_MER1;
+#endif
+
+    inline uint32_t Flash::PageSelection(uint32_t page)
+    {
+    #if defined (ZHELE_FLASH_DUAL_BANK)
+        if (IsDualBank()) {
+            uint32_t pagesPerBank = BankSize() / PageSize(0);
+            // Bank 2 pages are numbered from 256
+            if (AddressToBank(reinterpret_cast<const void*>(PageAddress(page))) == Bank::Bank2)
+                return FLASH_CR_BKER | ((256 + page % pagesPerBank) << FLASH_CR_PNB_Pos);
+            return (page % pagesPerBank) << FLASH_CR_PNB_Pos;
+        }
+    #endif
+        return page << FLASH_CR_PNB_Pos;
+    }
+
     inline bool Flash::ErasePage(uint32_t page)
     {
         if (page >= PageCount())
@@ -56,7 +147,7 @@ namespace Zhele
 
         WaitWhileBusy();
 
-        FLASH->CR |= FLASH_CR_PER | (page << FLASH_CR_PNB_Pos) | FLASH_CR_EOPIE;
+        FLASH->CR = (FLASH->CR & ~FlashEraseSelection) | FLASH_CR_PER | PageSelection(page) | FLASH_CR_EOPIE;
         FLASH->CR |= FLASH_CR_STRT;
 
         __asm("nop"); // The software should start checking if the BSY bit equals “0” at least one CPU cycle after setting the STRT bit.
@@ -68,7 +159,7 @@ namespace Zhele
             return false;
         }
         
-        FLASH->CR &= ~(FLASH_CR_PER | FLASH_CR_EOPIE | FLASH_CR_PNB_Msk);
+        FLASH->CR &= ~(FLASH_CR_PER | FLASH_CR_EOPIE | FlashEraseSelection);
         FLASH->SR = FLASH_SR_EOP;
 
         return true;
@@ -84,7 +175,7 @@ namespace Zhele
 
         FLASH->CR |= FLASH_CR_PG | FLASH_CR_EOPIE;
 
-        if ((reinterpret_cast<uint32_t>(aligned_src) & 0x111) == 0) {
+        if ((AddressOf(aligned_src) & 0x111) == 0) {
             while (size >= (2 * sizeof(uint32_t))) {
                 *aligned_dst++ = *aligned_src++;
                 *aligned_dst++ = *aligned_src++;
@@ -144,6 +235,214 @@ namespace Zhele
 
         return ((FLASH->SR & (FLASH_SR_WRPERR | FLASH_SR_PROGERR)) == 0);
     }
+
+    /// Flash operation errors mask
+    static constexpr uint32_t FlashErrors = FLASH_SR_OPERR | FLASH_SR_PROGERR | FLASH_SR_WRPERR | FLASH_SR_PGAERR
+        | FLASH_SR_SIZERR | FLASH_SR_PGSERR | FLASH_SR_MISERR | FLASH_SR_FASTERR;
+
+    inline bool Flash::ErasePageAsync(uint32_t page, AsyncCallback callback)
+    {
+        if (page >= PageCount() || IsBusy())
+            return false;
+
+        if (IsLock())
+            Unlock();
+
+        WaitWhileBusy();
+
+        _asyncCallback = callback;
+        _asyncOperation = AsyncOperation::Erase;
+
+        FLASH->SR = FLASH_SR_EOP | FlashErrors;
+        FLASH->CR = (FLASH->CR & ~FlashEraseSelection) | FLASH_CR_PER | PageSelection(page) | FLASH_CR_EOPIE | FLASH_CR_ERRIE;
+        NVIC_EnableIRQ(FLASH_IRQn);
+        FLASH->CR |= FLASH_CR_STRT;
+
+        return true;
+    }
+
+    inline bool Flash::WriteFlashAsync(void* dst, const void* src, unsigned size, AsyncCallback callback)
+    {
+        if (IsBusy())
+            return false;
+
+        if (size == 0) {
+            if (callback != nullptr)
+                callback(true);
+            return true;
+        }
+
+        if (IsLock())
+            Unlock();
+
+        WaitWhileBusy();
+
+        _asyncDst = reinterpret_cast<uint8_t*>(dst);
+        _asyncSrc = reinterpret_cast<const uint8_t*>(src);
+        _asyncSize = size;
+        _asyncCallback = callback;
+        _asyncOperation = AsyncOperation::Write;
+
+        FLASH->SR = FLASH_SR_EOP | FlashErrors;
+        FLASH->CR |= FLASH_CR_PG | FLASH_CR_EOPIE | FLASH_CR_ERRIE;
+        NVIC_EnableIRQ(FLASH_IRQn);
+
+        if (!ProgramNextAsync()) {
+            FLASH->CR &= ~(FLASH_CR_PG | FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+            _asyncCallback = nullptr;
+            _asyncOperation = AsyncOperation::None;
+            Lock();
+            return false;
+        }
+
+        return true;
+    }
+
+    ZHELE_RAMFUNC inline bool Flash::ProgramNextAsync()
+    {
+        uint32_t buffer[2];
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(buffer);
+        unsigned count = _asyncSize < sizeof(buffer) ? _asyncSize : sizeof(buffer);
+
+        // Byte copy (source may be unaligned, tail is padded by current flash content)
+        for (unsigned i = 0; i < sizeof(buffer); ++i)
+            bytes[i] = i < count ? _asyncSrc[i] : _asyncDst[i];
+
+        volatile uint32_t* dst = reinterpret_cast<volatile uint32_t*>(_asyncDst);
+        dst[0] = buffer[0];
+        dst[1] = buffer[1];
+        _asyncDst += sizeof(buffer);
+        _asyncSrc += count;
+        _asyncSize -= count;
+
+        return (FLASH->SR & FlashErrors) == 0;
+    }
+
+    ZHELE_RAMFUNC inline void Flash::IrqHandler()
+    {
+        uint32_t status = FLASH->SR;
+        FLASH->SR = status & (FLASH_SR_EOP | FlashErrors);
+
+        if ((status & (FLASH_SR_EOP | FlashErrors)) == 0 || _asyncOperation == AsyncOperation::None)
+            return;
+
+        bool success = (status & FlashErrors) == 0;
+
+        if (success && _asyncOperation == AsyncOperation::Write && _asyncSize > 0) {
+            if (ProgramNextAsync())
+                return;
+            success = false;
+        }
+
+        FLASH->CR &= ~(FLASH_CR_PER | FLASH_CR_PG | FLASH_CR_EOPIE | FLASH_CR_ERRIE | FlashEraseSelection);
+        CompleteAsync(success);
+    }
+
+#if defined (ZHELE_FLASH_DUAL_BANK)
+    inline bool Flash::IsDualBank()
+    {
+        return (FLASH->OPTR & FLASH_OPTR_DUAL_BANK) != 0;
+    }
+
+    inline uint32_t Flash::BankSize()
+    {
+        return IsDualBank() ? FlashSize() / 2 : FlashSize();
+    }
+
+    inline Flash::Bank Flash::ActiveBank()
+    {
+        // nSWAP_BANK is cleared when bank 2 is mapped at flash base address
+        return IsDualBank() && (FLASH->OPTR & FLASH_OPTR_nSWAP_BANK) == 0 ? Bank::Bank2 : Bank::Bank1;
+    }
+
+    inline bool Flash::EraseBank(Bank bank)
+    {
+        if (!IsDualBank() || bank == ActiveBank() || IsBusy())
+            return false;
+
+        if (IsLock())
+            Unlock();
+
+        WaitWhileBusy();
+
+        FLASH->SR = FLASH_SR_EOP | FlashErrors;
+        FLASH->CR = (FLASH->CR & ~FlashEraseSelection) | (bank == Bank::Bank1 ? FLASH_CR_MER1 : FLASH_CR_MER2) | FLASH_CR_EOPIE;
+        FLASH->CR |= FLASH_CR_STRT;
+
+        __asm("nop");
+
+        WaitWhileBusy();
+
+        bool success = (FLASH->SR & (FLASH_SR_EOP | FlashErrors)) == FLASH_SR_EOP;
+
+        FLASH->CR &= ~(FLASH_CR_EOPIE | FlashEraseSelection);
+        FLASH->SR = FLASH_SR_EOP | FlashErrors;
+        Lock();
+
+        return success;
+    }
+
+    inline bool Flash::EraseBankAsync(Bank bank, AsyncCallback callback)
+    {
+        if (!IsDualBank() || bank == ActiveBank() || IsBusy())
+            return false;
+
+        if (IsLock())
+            Unlock();
+
+        WaitWhileBusy();
+
+        _asyncCallback = callback;
+        _asyncOperation = AsyncOperation::Erase;
+
+        FLASH->SR = FLASH_SR_EOP | FlashErrors;
+        FLASH->CR = (FLASH->CR & ~FlashEraseSelection) | (bank == Bank::Bank1 ? FLASH_CR_MER1 : FLASH_CR_MER2) | FLASH_CR_EOPIE | FLASH_CR_ERRIE;
+        NVIC_EnableIRQ(FLASH_IRQn);
+        FLASH->CR |= FLASH_CR_STRT;
+
+        return true;
+    }
+
+    inline bool Flash::SwapBanks()
+    {
+        static constexpr uint32_t optionKey1 = 0x08192A3BUL;
+        static constexpr uint32_t optionKey2 = 0x4C5D6E7FUL;
+
+        if (!IsDualBank() || IsBusy())
+            return false;
+
+        if (IsLock())
+            Unlock();
+
+        FLASH->OPTKEYR = optionKey1;
+        FLASH->OPTKEYR = optionKey2;
+
+        WaitWhileBusy();
+
+        if ((FLASH->CR & FLASH_CR_OPTLOCK) != 0) {
+            Lock();
+            return false;
+        }
+
+        FLASH->SR = FlashErrors;
+        FLASH->OPTR ^= FLASH_OPTR_nSWAP_BANK;
+        FLASH->CR |= FLASH_CR_OPTSTRT;
+
+        __asm("nop");
+
+        WaitWhileBusy();
+
+        if ((FLASH->SR & FlashErrors) != 0) {
+            Lock(); // Option bytes are locked too
+            return false;
+        }
+
+        // Option bytes reload resets MCU
+        FLASH->CR |= FLASH_CR_OBL_LAUNCH;
+
+        return true;
+    }
+#endif
 }
 
 #endif //! ZHELE_FLASH_H
\ No newline at end of file
@@ -45,6 +45,8 @@ namespace Zhele
             SdaPin::template AltFuncNumber<GetNonTypeValueByIndex<sdaPinNumber, SdaAltFuncNumbers>::value>();
             SdaPin::SetDriverType(SdaPin::Port::OpenDrain);
             SdaPin::SetPullMode(SdaPin::PullMode::PullUp);
+
+            _busClear = ClearBus<SclPin, SdaPin>;
         }
 
         I2C_TEMPLATE_ARGS
@@ -94,6 +96,20 @@ namespace Zhele
 
         IO_STRUCT_WRAPPER(I2C1, I2c1Regs, I2C_TypeDef);
         IO_STRUCT_WRAPPER(I2C2, I2c2Regs, I2C_TypeDef);
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::EnableFastModePlus()
+        {
+            Clock::SysCfgClock::Enable();
+        #if defined (SYSCFG_CFGR1_I2C1_FMP)
+            if constexpr (std::is_same_v<_Regs, I2c1Regs>)
+                SYSCFG->CFGR1 |= SYSCFG_CFGR1_I2C1_FMP;
+        #endif
+        #if defined (SYSCFG_CFGR1_I2C2_FMP)
+            if constexpr (std::is_same_v<_Regs, I2c2Regs>)
+                SYSCFG->CFGR1 |= SYSCFG_CFGR1_I2C2_FMP;
+        #endif
+        }
     }
 
 // TODO:: Implement DMAMUX for use DMA
@@ -0,0 +1,55 @@
+/**
+ * @file
+ * Implements low-power timers for stm32g0 series
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LPTIMER_H
+#define ZHELE_LPTIMER_H
+
+#include <stm32g0xx.h>
+
+#if !defined (LPTIM1)
+    #error "THIS MCU does not support LPTIM"
+#endif
+
+#include "../common/lptimer.h"
+
+#include "clock.h"
+#include "iopins.h"
+
+namespace Zhele::Timers
+{
+    namespace Private
+    {
+        IO_STRUCT_WRAPPER(LPTIM1, LpTimer1Regs, LPTIM_TypeDef);
+        IO_STRUCT_WRAPPER(LPTIM2, LpTimer2Regs, LPTIM_TypeDef);
+
+        using LpTimer1In1Pins = Pair<IO::PinList<IO::Pb5, IO::Pc0>, NonTypeTemplateArray<5, 0>>;
+        using LpTimer1In2Pins = Pair<IO::PinList<IO::Pb7, IO::Pc2>, NonTypeTemplateArray<5, 0>>;
+        using LpTimer1OutPins = Pair<IO::PinList<IO::Pb2, IO::Pc1>, NonTypeTemplateArray<5, 0>>;
+
+        using LpTimer2In1Pins = Pair<IO::PinList<IO::Pb1>, NonTypeTemplateArray<5>>;
+        using LpTimer2In2Pins = Pair<IO::PinList<IO::NullPin>, NonTypeTemplateArray<0>>;
+        using LpTimer2OutPins = Pair<IO::PinList<IO::Pa4>, NonTypeTemplateArray<5>>;
+
+#if defined (TIM6)
+        constexpr IRQn_Type LpTimer1IRQn = TIM6_DAC_LPTIM1_IRQn;
+#else
+        constexpr IRQn_Type LpTimer1IRQn = LPTIM1_IRQn;
+#endif
+#if defined (TIM7)
+        constexpr IRQn_Type LpTimer2IRQn = TIM7_LPTIM2_IRQn;
+#else
+        constexpr IRQn_Type LpTimer2IRQn = LPTIM2_IRQn;
+#endif
+    }
+
+    using LpTimer1 = Private::LpTimer<Private::LpTimer1Regs, Clock::LpTim1Clock, Private::LpTimer1IRQn, Private::LpTimer1In1Pins, Private::LpTimer1In2Pins, Private::LpTimer1OutPins>;
+    using LpTimer2 = Private::LpTimer<Private::LpTimer2Regs, Clock::LpTim2Clock, Private::LpTimer2IRQn, Private::LpTimer2In1Pins, Private::LpTimer2In2Pins, Private::LpTimer2OutPins>;
+}
+
+#endif //! ZHELE_LPTIMER_H
@@ -0,0 +1,25 @@
+/**
+ * @file
+ * Implements internal RTC for stm32g0 series
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_RTC_H
+#define ZHELE_RTC_H
+
+#include <stm32g0xx.h>
+
+#include "../common/rtc.h"
+
+#include "clock.h"
+
+namespace Zhele
+{
+    // Wakeup timer and alarms share direct EXTI line 19 and IRQ
+    using Rtc = Private::Rtc<Clock::RtcClock, 19, RTC_TAMP_IRQn, 19, RTC_TAMP_IRQn>;
+}
+
+#endif //! ZHELE_RTC_H
@@ -139,6 +139,15 @@ namespace Zhele::Timers
     using Timer14 = Private::GPTimer<Private::Tim14Regs, Clock::Tim14Clock, TIM14_IRQn, Private::Tim14ChPins>;
     using Timer16 = Private::BaseTimer<Private::Tim16Regs, Clock::Tim16Clock, TIM16_IRQn>;
     using Timer17 = Private::BaseTimer<Private::Tim17Regs, Clock::Tim17Clock, TIM17_IRQn>;
+
+    namespace Private
+    {
+        // Internal trigger connection (slave timer ITRx <- master timer TRGO)
+#if defined (TIM2)
+        template<> struct TimerInternalTrigger<Timer3, Timer2> { static const int Value = 2; };
+        template<> struct TimerInternalTrigger<Timer2, Timer3> { static const int Value = 1; };
+#endif
+    }
 }
 
 #endif //! ZHELE_TIMER_H
\ No newline at end of file
@@ -131,11 +131,29 @@ namespace Zhele
         using Usart3TxPins = Pair<IO::PinList<IO::Pa5, IO::Pb2, IO::Pb8, IO::Pb10, IO::Pc4, IO::Pc10>, NonTypeTemplateArray<4, 4, 4, 4, 0, 0>>;
         using Usart3RxPins = Pair<IO::PinList<IO::Pb0, IO::Pb9, IO::Pb11, IO::Pc5, IO::Pc11>, NonTypeTemplateArray<4, 4, 4, 0, 0>>;
 
+        using LpUart1TxPins = Pair<IO::PinList<IO::Pa2, IO::Pb11, IO::Pc1>, NonTypeTemplateArray<6, 1, 1>>;
+        using LpUart1RxPins = Pair<IO::PinList<IO::Pa3, IO::Pb10, IO::Pc0>, NonTypeTemplateArray<6, 1, 1>>;
+
         IO_STRUCT_WRAPPER(USART1, Usart1Regs, USART_TypeDef);
         IO_STRUCT_WRAPPER(USART2, Usart2Regs, USART_TypeDef);
     #if defined(USART3)
         IO_STRUCT_WRAPPER(USART3, Usart3Regs, USART_TypeDef);
     #endif
+    #if defined(LPUART1)
+        IO_STRUCT_WRAPPER(LPUART1, LpUart1Regs, USART_TypeDef);
+
+        template<>
+        struct IsLowPowerUart<LpUart1Regs> : std::true_type {};
+
+        // LPUART1 shares interrupt with USART3...USART6 on larger devices
+        #if defined (STM32G0B1xx) || defined (STM32G0C1xx)
+        constexpr IRQn_Type LpUart1IRQn = USART3_4_5_6_LPUART1_IRQn;
+        #elif defined (STM32G071xx) || defined (STM32G081xx)
+        constexpr IRQn_Type LpUart1IRQn = USART3_4_LPUART1_IRQn;
+        #else
+        constexpr IRQn_Type LpUart1IRQn = LPUART1_IRQn;
+        #endif
+    #endif
     }
 
     template<typename _DmaTx = void, typename _DmaRx = void>
@@ -148,6 +166,11 @@ namespace Zhele
     template<typename _DmaTx = void, typename _DmaRx = void>
     using Usart3 = Private::Usart<Private::Usart3Regs, USART3_IRQn, Clock::Usart3Clock, Private::Usart3TxPins, Private::Usart3RxPins, _DmaTx, _DmaRx>;
 #endif
+
+#if defined (LPUART1)
+    template<typename _DmaTx = void, typename _DmaRx = void>
+    using LpUart1 = Private::Usart<Private::LpUart1Regs, Private::LpUart1IRQn, Clock::LpUart1Clock, Private::LpUart1TxPins, Private::LpUart1RxPins, _DmaTx, _DmaRx>;
+#endif
 }
 
 #endif //! ZHELE_USART_H
\ No newline at end of file
@@ -0,0 +1,165 @@
+/**
+ * @file
+ * Implements host (x86, POSIX) backend for peripheral registers
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_HOST_H
+#define ZHELE_HOST_H
+
+#if !defined (ZHELE_HOST)
+    #error "Host backend requires ZHELE_HOST build (use zhele::host target)"
+#endif
+
+#if defined(STM32F0)
+    #include <stm32f0xx.h>
+#endif
+#if defined(STM32F1)
+    #include <stm32f1xx.h>
+#endif
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+#if defined(STM32L4)
+    #include <stm32l4xx.h>
+#endif
+#if defined(STM32G0)
+    #include <stm32g0xx.h>
+#endif
+
+#include <sys/mman.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Zhele::Host
+{
+    /// Simulated memory region
+    struct MemoryRegion
+    {
+        uintptr_t Base; ///< Region address (the same as on MCU)
+        size_t Size; ///< Region size
+    };
+
+    /// Simulated regions: system memory (UID, flash size) and peripherals (APB, AHB, GPIO ports)
+    constexpr MemoryRegion Regions[] = {
+        {0x1fff0000, 0x00010000},
+        {0x40000000, 0x20000000},
+    };
+
+    /**
+     * @brief Maps simulated registers memory to MCU addresses
+     *
+     * @details
+     * In host build (ZHELE_HOST) framework is compiled with CMSIS device header and core header replacements
+     * from include/zhele/host, so register wrappers (IO_STRUCT_WRAPPER, IO_REG_WRAPPER, RegisterWrapper)
+     * access peripherals by the same addresses as on MCU. This method maps zero-filled memory
+     * (pages are allocated on first access) to these addresses, so any driver code can be executed on host.
+     * Core peripherals (NVIC, SCB, SysTick, DWT, ITM) are plain variables and don't need mapping.
+     *
+     * There is no peripheral behavior: test code presets status flags (for example, TXE) and checks
+     * written registers. Call it before first register access, application must define SystemCoreClock
+     * (as system_stm32xxxx.c does on MCU).
+     *
+     * @par Example
+     * @code
+     *  uint32_t SystemCoreClock = 8000000;
+     *
+     *  int main()
+     *  {
+     *      Host::Init();
+     *      Host::Registers<IO::Private::PortaRegs>().IDR = 0x0005;
+     *      assert(PinList<Pa0, Pa2>::PinRead() == 0x03);
+     *  }
+     * @endcode
+     *
+     * @retval true Memory is mapped
+     * @retval false Some address range is not available in host process
+     */
+    inline bool Init()
+    {
+        static bool initialized = false;
+        if (initialized)
+            return true;
+
+        for (const MemoryRegion& region : Regions)
+        {
+            void* address = mmap(reinterpret_cast<void*>(region.Base), region.Size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED_NOREPLACE, -1, 0);
+            if (address != reinterpret_cast<void*>(region.Base))
+                return false;
+        }
+
+        initialized = true;
+        return true;
+    }
+
+    /**
+     * @brief Resets all registers (peripheral and core) to zero
+     *
+     * @par Returns
+     *  Nothing
+     */
+    inline void Reset()
+    {
+        for (const MemoryRegion& region : Regions)
+            madvise(reinterpret_cast<void*>(region.Base), region.Size, MADV_DONTNEED);
+
+        memset(const_cast<NVIC_Type*>(NVIC), 0, sizeof(NVIC_Type));
+        memset(const_cast<SCB_Type*>(SCB), 0, sizeof(SCB_Type));
+        memset(const_cast<SysTick_Type*>(SysTick), 0, sizeof(SysTick_Type));
+        memset(const_cast<DWT_Type*>(DWT), 0, sizeof(DWT_Type));
+        memset(const_cast<CoreDebug_Type*>(CoreDebug), 0, sizeof(CoreDebug_Type));
+        memset(const_cast<ITM_Type*>(ITM), 0, sizeof(ITM_Type));
+        memset(const_cast<TPI_Type*>(TPI), 0, sizeof(TPI_Type));
+        __enable_irq();
+        __set_BASEPRI(0);
+    }
+
+    /**
+     * @brief Returns peripheral registers
+     *
+     * @tparam _Regs Registers wrapper (from IO_STRUCT_WRAPPER)
+     *
+     * @returns Registers structure
+     */
+    template<typename _Regs>
+    inline auto& Registers()
+    {
+        return *_Regs::Get();
+    }
+
+    /**
+     * @brief Check that interrupt is enabled in NVIC
+     *
+     * @param [in] irq Interrupt number
+     *
+     * @retval true Interrupt is enabled
+     * @retval false Interrupt is disabled
+     */
+    inline bool IsInterruptEnabled(int irq)
+    {
+        return NVIC_GetEnableIRQ(irq) != 0;
+    }
+
+    /**
+     * @brief Check that interrupt is pending (and clears pending bit)
+     *
+     * @param [in] irq Interrupt number
+     *
+     * @retval true Interrupt was pending
+     * @retval false Interrupt was not pending
+     */
+    inline bool TakePendingInterrupt(int irq)
+    {
+        bool pending = NVIC_GetPendingIRQ(irq) != 0;
+        NVIC_ClearPendingIRQ(irq);
+        return pending;
+    }
+} // namespace Zhele::Host
+
+#endif //! ZHELE_HOST_H
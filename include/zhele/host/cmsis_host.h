@@ -0,0 +1,266 @@
+/**
+ * @file
+ * Host replacement of CMSIS core header (core peripherals and intrinsics)
+ *
+ * @details
+ * File is included by core_cmX.h replacements of this directory, which are found instead of
+ * CMSIS ones if this directory precedes CMSIS include directory (see zhele::host CMake target).
+ * Core peripherals (NVIC, SCB, SysTick, DWT, ITM and so on) are plain variables,
+ * intrinsics are emulated, so core-dependent code paths (for example, LDREX/STREX loops) work on host.
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_HOST_CMSIS_H
+#define ZHELE_HOST_CMSIS_H
+
+#include <stdint.h>
+
+#ifndef __CORTEX_M
+    #error "Include core_cmX.h replacement instead of this file"
+#endif
+
+#define ZHELE_HOST_CORE
+
+// Qualifiers and compiler attributes
+#define __I volatile const
+#define __O volatile
+#define __IO volatile
+#define __IM volatile const
+#define __OM volatile
+#define __IOM volatile
+
+#define __ASM __asm__
+#define __INLINE inline
+#define __STATIC_INLINE static inline
+#define __STATIC_FORCEINLINE __attribute__((always_inline)) static inline
+#define __NO_RETURN __attribute__((__noreturn__))
+#define __USED __attribute__((used))
+#define __WEAK __attribute__((weak))
+#define __PACKED __attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT struct __attribute__((packed, aligned(1)))
+#define __ALIGNED(x) __attribute__((aligned(x)))
+#define __RESTRICT __restrict
+
+#ifndef __NVIC_PRIO_BITS
+    #define __NVIC_PRIO_BITS 4U
+#endif
+
+// Core peripherals layout (only registers used by framework and device headers)
+typedef struct
+{
+    __IOM uint32_t ISER[16];
+    uint32_t RESERVED0[16];
+    __IOM uint32_t ICER[16];
+    uint32_t RESERVED1[16];
+    __IOM uint32_t ISPR[16];
+    uint32_t RESERVED2[16];
+    __IOM uint32_t ICPR[16];
+    uint32_t RESERVED3[16];
+    __IOM uint32_t IABR[16];
+    uint32_t RESERVED4[48];
+    __IOM uint8_t IP[496];
+} NVIC_Type;
+
+typedef struct
+{
+    __IM uint32_t CPUID;
+    __IOM uint32_t ICSR;
+    __IOM uint32_t VTOR;
+    __IOM uint32_t AIRCR;
+    __IOM uint32_t SCR;
+    __IOM uint32_t CCR;
+    __IOM uint8_t SHP[12];
+    __IOM uint32_t SHCSR;
+} SCB_Type;
+
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t LOAD;
+    __IOM uint32_t VAL;
+    __IM uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    __IOM uint32_t DHCSR;
+    __OM uint32_t DCRSR;
+    __IOM uint32_t DCRDR;
+    __IOM uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct
+{
+    __OM union
+    {
+        __OM uint8_t u8;
+        __OM uint16_t u16;
+        __OM uint32_t u32;
+    } PORT[32];
+    __IOM uint32_t TER;
+    __IOM uint32_t TPR;
+    __IOM uint32_t TCR;
+    __OM uint32_t LAR;
+} ITM_Type;
+
+typedef struct
+{
+    __IM uint32_t SSPSR;
+    __IOM uint32_t CSPSR;
+    __IOM uint32_t ACPR;
+    __IOM uint32_t SPPR;
+    __IM uint32_t FFSR;
+    __IOM uint32_t FFCR;
+} TPI_Type;
+
+// Core peripherals and special registers storage
+inline NVIC_Type ZheleHostNvic{};
+inline SCB_Type ZheleHostScb{};
+inline SysTick_Type ZheleHostSysTick{};
+inline DWT_Type ZheleHostDwt{};
+inline CoreDebug_Type ZheleHostCoreDebug{};
+inline ITM_Type ZheleHostItm{};
+inline TPI_Type ZheleHostTpi{};
+inline uint32_t ZheleHostPrimask = 0;
+inline uint32_t ZheleHostBasepri = 0;
+
+#define NVIC (&ZheleHostNvic)
+#define SCB (&ZheleHostScb)
+#define SysTick (&ZheleHostSysTick)
+#define DWT (&ZheleHostDwt)
+#define CoreDebug (&ZheleHostCoreDebug)
+#define ITM (&ZheleHostItm)
+#define TPI (&ZheleHostTpi)
+
+// Core registers bits
+#define SCB_ICSR_PENDSTSET_Msk (1UL << 26U)
+#define SCB_ICSR_PENDSVSET_Msk (1UL << 28U)
+#define SCB_SCR_SLEEPONEXIT_Msk (1UL << 1U)
+#define SCB_SCR_SLEEPDEEP_Msk (1UL << 2U)
+#define SCB_SCR_SEVONPEND_Msk (1UL << 4U)
+#define SCB_AIRCR_VECTKEY_Pos 16U
+#define SCB_AIRCR_SYSRESETREQ_Msk (1UL << 2U)
+#define SCB_AIRCR_PRIGROUP_Pos 8U
+
+#define SysTick_CTRL_ENABLE_Msk (1UL << 0U)
+#define SysTick_CTRL_TICKINT_Msk (1UL << 1U)
+#define SysTick_CTRL_CLKSOURCE_Msk (1UL << 2U)
+#define SysTick_CTRL_COUNTFLAG_Msk (1UL << 16U)
+#define SysTick_LOAD_RELOAD_Msk 0xFFFFFFUL
+#define SysTick_VAL_CURRENT_Msk 0xFFFFFFUL
+
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << 0U)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24U)
+
+#define ITM_TCR_ITMENA_Msk (1UL << 0U)
+#define ITM_TCR_TSENA_Msk (1UL << 1U)
+#define ITM_TCR_SYNCENA_Msk (1UL << 2U)
+#define ITM_TCR_TXENA_Msk (1UL << 3U)
+#define ITM_TCR_SWOENA_Msk (1UL << 4U)
+#define ITM_TCR_TraceBusID_Pos 16U
+#define ITM_TCR_BUSY_Msk (1UL << 23U)
+
+// Interrupts control (enable and pending bits are kept in NVIC storage)
+__STATIC_INLINE void NVIC_EnableIRQ(int irq) { if (irq >= 0) NVIC->ISER[irq >> 5] |= 1UL << (irq & 0x1f); }
+__STATIC_INLINE void NVIC_DisableIRQ(int irq) { if (irq >= 0) NVIC->ISER[irq >> 5] &= ~(1UL << (irq & 0x1f)); }
+__STATIC_INLINE uint32_t NVIC_GetEnableIRQ(int irq) { return irq >= 0 ? (NVIC->ISER[irq >> 5] >> (irq & 0x1f)) & 1UL : 0; }
+__STATIC_INLINE void NVIC_SetPendingIRQ(int irq) { if (irq >= 0) NVIC->ISPR[irq >> 5] |= 1UL << (irq & 0x1f); }
+__STATIC_INLINE void NVIC_ClearPendingIRQ(int irq) { if (irq >= 0) NVIC->ISPR[irq >> 5] &= ~(1UL << (irq & 0x1f)); }
+__STATIC_INLINE uint32_t NVIC_GetPendingIRQ(int irq) { return irq >= 0 ? (NVIC->ISPR[irq >> 5] >> (irq & 0x1f)) & 1UL : 0; }
+__STATIC_INLINE void NVIC_SetPriority(int irq, uint32_t priority) { if (irq >= 0) NVIC->IP[irq] = static_cast<uint8_t>(priority << (8U - __NVIC_PRIO_BITS)); }
+__STATIC_INLINE uint32_t NVIC_GetPriority(int irq) { return irq >= 0 ? NVIC->IP[irq] >> (8U - __NVIC_PRIO_BITS) : 0; }
+#if (__CORTEX_M >= 3)
+__STATIC_INLINE void NVIC_SetPriorityGrouping(uint32_t group) { SCB->AIRCR = (0x5FAUL << SCB_AIRCR_VECTKEY_Pos) | ((group & 7UL) << SCB_AIRCR_PRIGROUP_Pos); }
+__STATIC_INLINE uint32_t NVIC_GetPriorityGrouping() { return (SCB->AIRCR >> SCB_AIRCR_PRIGROUP_Pos) & 7UL; }
+#endif
+__STATIC_INLINE void NVIC_SystemReset() { SCB->AIRCR = (0x5FAUL << SCB_AIRCR_VECTKEY_Pos) | SCB_AIRCR_SYSRESETREQ_Msk; }
+
+__STATIC_INLINE uint32_t SysTick_Config(uint32_t ticks)
+{
+    if ((ticks - 1UL) > SysTick_LOAD_RELOAD_Msk)
+        return 1UL;
+    SysTick->LOAD = ticks - 1UL;
+    SysTick->VAL = 0UL;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+    return 0UL;
+}
+
+__STATIC_INLINE uint32_t ITM_SendChar(uint32_t ch)
+{
+    if ((ITM->TCR & ITM_TCR_ITMENA_Msk) && (ITM->TER & 1UL))
+        ITM->PORT[0].u8 = static_cast<uint8_t>(ch);
+    return ch;
+}
+
+// Special registers
+__STATIC_FORCEINLINE void __enable_irq() { ZheleHostPrimask = 0; }
+__STATIC_FORCEINLINE void __disable_irq() { ZheleHostPrimask = 1; }
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK() { return ZheleHostPrimask; }
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t primask) { ZheleHostPrimask = primask & 1UL; }
+__STATIC_FORCEINLINE uint32_t __get_BASEPRI() { return ZheleHostBasepri; }
+__STATIC_FORCEINLINE void __set_BASEPRI(uint32_t basepri) { ZheleHostBasepri = basepri & 0xffUL; }
+__STATIC_FORCEINLINE void __set_BASEPRI_MAX(uint32_t basepri)
+{
+    basepri &= 0xffUL;
+    if (basepri != 0 && (ZheleHostBasepri == 0 || basepri < ZheleHostBasepri))
+        ZheleHostBasepri = basepri;
+}
+__STATIC_FORCEINLINE uint32_t __get_IPSR() { return 0; }
+
+// Hints and barriers (there is no other bus master on host, so compiler barrier is enough)
+__STATIC_FORCEINLINE void __NOP() { __ASM volatile ("" ::: "memory"); }
+__STATIC_FORCEINLINE void __WFI() { __ASM volatile ("" ::: "memory"); }
+__STATIC_FORCEINLINE void __WFE() { __ASM volatile ("" ::: "memory"); }
+__STATIC_FORCEINLINE void __SEV() { __ASM volatile ("" ::: "memory"); }
+__STATIC_FORCEINLINE void __ISB() { __ASM volatile ("" ::: "memory"); }
+__STATIC_FORCEINLINE void __DSB() { __ASM volatile ("" ::: "memory"); }
+__STATIC_FORCEINLINE void __DMB() { __ASM volatile ("" ::: "memory"); }
+#define __BKPT(value) __builtin_trap()
+
+// Data processing
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t value) { return __builtin_bswap32(value); }
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t value) { return ((value >> 8) & 0x00ff00ffUL) | ((value << 8) & 0xff00ff00UL); }
+__STATIC_FORCEINLINE int16_t __REVSH(int16_t value) { return static_cast<int16_t>(__builtin_bswap16(static_cast<uint16_t>(value))); }
+__STATIC_FORCEINLINE uint32_t __ROR(uint32_t value, uint32_t shift) { shift %= 32U; return shift == 0U ? value : (value >> shift) | (value << (32U - shift)); }
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t value) { return value == 0U ? 32U : static_cast<uint8_t>(__builtin_clz(value)); }
+
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value)
+{
+    uint32_t result = 0;
+    for (unsigned i = 0; i < 32; ++i, value >>= 1)
+        result = (result << 1) | (value & 1U);
+    return result;
+}
+
+__STATIC_FORCEINLINE int32_t __SSAT(int32_t value, uint32_t bits)
+{
+    const int32_t max = static_cast<int32_t>((1U << (bits - 1U)) - 1U);
+    const int32_t min = -1 - max;
+    return value > max ? max : value < min ? min : value;
+}
+
+__STATIC_FORCEINLINE uint32_t __USAT(int32_t value, uint32_t bits)
+{
+    const uint32_t max = (1U << bits) - 1U;
+    return value < 0 ? 0U : static_cast<uint32_t>(value) > max ? max : static_cast<uint32_t>(value);
+}
+
+// Exclusive access (program is single-threaded, so store always succeeds)
+__STATIC_FORCEINLINE uint8_t __LDREXB(volatile uint8_t* address) { return *address; }
+__STATIC_FORCEINLINE uint16_t __LDREXH(volatile uint16_t* address) { return *address; }
+__STATIC_FORCEINLINE uint32_t __LDREXW(volatile uint32_t* address) { return *address; }
+__STATIC_FORCEINLINE uint32_t __STREXB(uint8_t value, volatile uint8_t* address) { *address = value; return 0; }
+__STATIC_FORCEINLINE uint32_t __STREXH(uint16_t value, volatile uint16_t* address) { *address = value; return 0; }
+__STATIC_FORCEINLINE uint32_t __STREXW(uint32_t value, volatile uint32_t* address) { *address = value; return 0; }
+__STATIC_FORCEINLINE void __CLREX() {}
+
+#endif //! ZHELE_HOST_CMSIS_H
@@ -0,0 +1,17 @@
+/**
+ * @file
+ * Host replacement of CMSIS core_cm0plus.h
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_HOST_CORE_CM0PLUS_H
+#define ZHELE_HOST_CORE_CM0PLUS_H
+
+#define __CORTEX_M (0U)
+
+#include "cmsis_host.h"
+
+#endif //! ZHELE_HOST_CORE_CM0PLUS_H
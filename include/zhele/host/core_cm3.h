@@ -0,0 +1,17 @@
+/**
+ * @file
+ * Host replacement of CMSIS core_cm3.h
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_HOST_CORE_CM3_H
+#define ZHELE_HOST_CORE_CM3_H
+
+#define __CORTEX_M (3U)
+
+#include "cmsis_host.h"
+
+#endif //! ZHELE_HOST_CORE_CM3_H
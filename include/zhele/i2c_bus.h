@@ -0,0 +1,241 @@
+/**
+ * @file
+ * Implements shared I2C bus with transaction queue
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_I2C_BUS_H
+#define ZHELE_I2C_BUS_H
+
+#include <zhele/containers/ring_buffer.h>
+#include <zhele/i2c.h>
+
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief I2C bus job (one item of bus queue)
+     */
+    struct I2cJob
+    {
+        uint16_t devAddr; ///< Device address
+        uint16_t regAddr; ///< Register address
+        uint8_t* data; ///< Data buffer
+        uint16_t size; ///< Data size
+        I2cOpts opts; ///< Options
+        I2cMode mode; ///< Direction (read or write)
+        I2cCallback callback; ///< Job complete callback (may be nullptr)
+    };
+
+    /**
+     * @brief Implements shared I2C bus with job queue
+     * 
+     * @details
+     * Async reads and writes of all devices are queued and started one by one from
+     * DMA transfer complete handler of previous job. Bus has the same interface as I2C,
+     * so it can be used as I2C parameter of drivers. Blocking methods wait until queue is empty.
+     * 
+     * @note Bus owns DMA transfer callbacks of I2C. DMA IRQ handlers should call DmaTx/DmaRx::IrqHandler as usual.
+     * 
+     * @tparam _I2c I2C (with DMA channels)
+     * @tparam _Depth Job queue depth
+     */
+    template<typename _I2c, unsigned _Depth = 8>
+    class I2cBus
+    {
+        static_assert(!std::is_same_v<typename _I2c::DmaTx, void> && !std::is_same_v<typename _I2c::DmaRx, void>,
+            "I2C bus requires I2C with DMA channels");
+
+        static Containers::RingBuffer<_Depth, I2cJob> _queue;
+        static I2cJob _active;
+        static volatile bool _busy;
+    public:
+        using I2c = _I2c;
+        using DmaTx = typename _I2c::DmaTx;
+        using DmaRx = typename _I2c::DmaRx;
+        static constexpr unsigned Depth = _Depth;
+
+        /**
+         * @brief Initialize I2C
+         * 
+         * @param [in] args I2C init arguments (see I2c::Init)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename... Args>
+        static void Init(Args... args);
+
+        /**
+         * @brief Write 8-bit unsigned to register (blocking).
+         * 
+         * @param [in] devAddr Device address.
+         * @param [in] regAddr Register address.
+         * @param [in] data Data to write.
+         * @param [in] opts Options.
+         * 
+         * @returns Write status.
+         */
+        static I2cStatus WriteU8(uint16_t devAddr, uint16_t regAddr, uint8_t data, I2cOpts opts = I2cOpts::None);
+
+        /**
+         * @brief Write data to register (blocking).
+         * 
+         * @param [in] devAddr Device address.
+         * @param [in] regAddr Register address.
+         * @param [in] data Data to write.
+         * @param [in] size Data size.
+         * @param [in] opts Options.
+         * 
+         * @returns Write status.
+         */
+        static I2cStatus Write(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cOpts opts = I2cOpts::None);
+
+        /**
+         * @brief Queue write job.
+         * 
+         * @param [in] devAddr Device address.
+         * @param [in] regAddr Register address.
+         * @param [in] data Data to write (should be valid until callback).
+         * @param [in] size Data size.
+         * @param [in] opts Options.
+         * @param [in] callback Complete (or error) callback.
+         * 
+         * @retval I2cStatus::Success Job was started or queued
+         * @retval I2cStatus::Busy Queue is full
+         */
+        static I2cStatus WriteAsync(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cOpts opts = I2cOpts::None, I2cCallback callback = nullptr);
+
+        /**
+         * @brief Read 8-bit unsigned (blocking).
+         * 
+         * @param [in] devAddr Device address.
+         * @param [in] regAddr Register address.
+         * @param [in] opts Options.
+         * 
+         * @returns Read result.
+         */
+        static ReadResult ReadU8(uint16_t devAddr, uint16_t regAddr, I2cOpts opts = I2cOpts::None);
+
+        /**
+         * @brief Read some bytes (blocking).
+         * 
+         * @param [in] devAddr Device address.
+         * @param [in] regAddr Register address.
+         * @param [out] data Data buffer.
+         * @param [in] size Data size.
+         * @param [in] opts Options.
+         * 
+         * @returns Operation status.
+         */
+        static I2cStatus Read(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts = I2cOpts::None);
+
+        /**
+         * @brief Queue read job.
+         * 
+         * @param [in] devAddr Device address.
+         * @param [in] regAddr Register address.
+         * @param [out] data Output buffer (should be valid until callback).
+         * @param [in] size Data size to read.
+         * @param [in] opts Options.
+         * @param [in] callback Complete (or error) callback.
+         * 
+         * @retval I2cStatus::Success Job was started or queued
+         * @retval I2cStatus::Busy Queue is full
+         */
+        static I2cStatus EnableAsyncRead(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts = I2cOpts::None, I2cCallback callback = nullptr);
+
+        /**
+         * @brief Add job to queue (or start it immediately if bus is idle)
+         * 
+         * @param [in] job Job
+         * 
+         * @retval true Job was started or queued
+         * @retval false Queue is full
+         */
+        static bool Enqueue(const I2cJob& job);
+
+        /**
+         * @brief Check that bus has active job
+         * 
+         * @retval true Bus is busy
+         * @retval false Bus is idle
+         */
+        static bool Busy();
+
+        /**
+         * @brief Wait for all queued jobs
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Wait();
+
+        /**
+         * @brief Returns count of jobs waiting for bus
+         * 
+         * @returns Pending jobs count
+         */
+        static unsigned Pending();
+
+    private:
+        /**
+         * @brief Start job. If job cannot be started, its callback is called and next job is started.
+         * 
+         * @param [in] job Job
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Run(I2cJob job);
+
+        /**
+         * @brief Start next queued job or mark bus idle
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void RunNext();
+
+        /**
+         * @brief Job complete handler. Starts next job and notify user.
+         * 
+         * @param [in] status Job status
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void JobHandler(I2cStatus status);
+
+        /**
+         * @brief Disable DMA interrupts (queue is modified from them)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Lock();
+
+        /**
+         * @brief Enable DMA interrupts
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Unlock();
+    };
+
+    template<typename _I2c, unsigned _Depth>
+    Containers::RingBuffer<_Depth, I2cJob> I2cBus<_I2c, _Depth>::_queue;
+    template<typename _I2c, unsigned _Depth>
+    I2cJob I2cBus<_I2c, _Depth>::_active;
+    template<typename _I2c, unsigned _Depth>
+    volatile bool I2cBus<_I2c, _Depth>::_busy = false;
+}
+
+#include "impl/i2c_bus.h"
+
+#endif //! ZHELE_I2C_BUS_H
@@ -0,0 +1,24 @@
+/**
+ * @file
+ * United header for I2S
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @licence FreeBSD
+ */
+
+#if defined(STM32F0)
+    #error I2S is not implemented for STM32F0
+#endif
+#if defined(STM32F1)
+    #error I2S is not implemented for STM32F1
+#endif
+#if defined(STM32F4)
+    #include "f4/i2s.h"
+#endif
+#if defined(STM32L4)
+    #error STM32L4 does not support I2S
+#endif
+#if defined(STM32G0)
+    #error I2S is not implemented for STM32G0
+#endif
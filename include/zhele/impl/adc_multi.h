@@ -0,0 +1,177 @@
+/**
+ * @file
+ * Implements multi ADC (dual) mode
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ADC_MULTI_IMPL_H
+#define ZHELE_ADC_MULTI_IMPL_H
+
+namespace Zhele
+{
+    #define ADCMULTI_TEMPLATE_ARGS template<typename _Master, typename... _Slaves>
+    #define ADCMULTI_TEMPLATE_QUALIFIER AdcMulti<_Master, _Slaves...>
+
+    ADCMULTI_TEMPLATE_ARGS
+    template<typename _Master::AdcDivider divider>
+    void ADCMULTI_TEMPLATE_QUALIFIER::Init()
+    {
+        _Master::template Init<divider>();
+        Slave::template Init<divider>();
+    }
+
+    ADCMULTI_TEMPLATE_ARGS
+    bool ADCMULTI_TEMPLATE_QUALIFIER::Configure(Mode mode, std::initializer_list<uint8_t> masterChannels, std::initializer_list<uint8_t> slaveChannels)
+    {
+        bool valid = mode == Mode::RegularSimultaneous
+            ? masterChannels.size() == slaveChannels.size()
+            : masterChannels.size() == 1 && slaveChannels.size() == 1;
+
+        if (!valid
+            || !_Master::SetRegularSequence(masterChannels.begin(), static_cast<uint8_t>(masterChannels.size()))
+            || !Slave::SetRegularSequence(slaveChannels.begin(), static_cast<uint8_t>(slaveChannels.size())))
+        {
+            _data.error = AdcError::ArgumentError;
+            return false;
+        }
+
+        MasterRegs()->SR &= ~(ADC_SR_STRT | ADC_SR_EOC);
+        SlaveRegs()->SR &= ~(ADC_SR_STRT | ADC_SR_EOC);
+
+        // Slave is started by master, its own trigger must be SWSTART
+        SlaveRegs()->CR2 |= ADC_CR2_EXTSEL | ADC_CR2_EXTTRIG;
+        MasterRegs()->CR1 = (MasterRegs()->CR1 & ~ADC_CR1_DUALMOD) | (static_cast<uint32_t>(mode) << ADC_CR1_DUALMOD_Pos);
+
+        _data.error = AdcError::NoError;
+        return true;
+    }
+
+    ADCMULTI_TEMPLATE_ARGS
+    void ADCMULTI_TEMPLATE_QUALIFIER::StartConversion(bool continuous)
+    {
+        // Hardware trigger paces conversions
+        bool softwareTrigger = (MasterRegs()->CR2 & ADC_CR2_EXTSEL) == ADC_CR2_EXTSEL;
+
+        if (continuous && softwareTrigger)
+        {
+            SlaveRegs()->CR2 |= ADC_CR2_CONT;
+            MasterRegs()->CR2 |= ADC_CR2_DMA | ADC_CR2_CONT;
+        }
+        else
+        {
+            MasterRegs()->CR2 |= ADC_CR2_DMA;
+        }
+
+        if (softwareTrigger)
+            MasterRegs()->CR2 |= ADC_CR2_SWSTART;
+    }
+
+    ADCMULTI_TEMPLATE_ARGS
+    bool ADCMULTI_TEMPLATE_QUALIFIER::StartRegular(Mode mode, std::initializer_list<uint8_t> masterChannels, std::initializer_list<uint8_t> slaveChannels,
+                                                DataT* dataBuffer, uint16_t scanCount, AdcMultiCallbackType callback)
+    {
+        if (scanCount == 0 || !Configure(mode, masterChannels, slaveChannels))
+        {
+            _data.error = AdcError::ArgumentError;
+            return false;
+        }
+
+        _data.regularCallback = callback;
+
+        using DmaChannel = typename _Master::DmaChannel;
+        DmaChannel::SetTransferCallback(DmaHandler);
+        DmaChannel::Transfer(DmaBase::Periph2Mem | DmaBase::MemIncrement | DmaBase::PriorityHigh | DmaBase::PSize32Bits | DmaBase::MSize32Bits,
+                            dataBuffer, &MasterRegs()->DR, masterChannels.size() * scanCount);
+
+        StartConversion(scanCount > 1);
+        return true;
+    }
+
+    ADCMULTI_TEMPLATE_ARGS
+    bool ADCMULTI_TEMPLATE_QUALIFIER::StartRegularStream(Mode mode, std::initializer_list<uint8_t> masterChannels, std::initializer_list<uint8_t> slaveChannels,
+                                                DataT* buffer, uint16_t blockSize, AdcMultiStreamCallbackType callback)
+    {
+        if (blockSize == 0 || masterChannels.size() == 0 || blockSize % masterChannels.size() != 0
+            || !Configure(mode, masterChannels, slaveChannels))
+        {
+            _data.error = AdcError::ArgumentError;
+            return false;
+        }
+
+        _data.streamCallback = callback;
+        _data.streamOverruns = 0;
+
+        using DmaChannel = typename _Master::DmaChannel;
+        DmaChannel::SetTransferCallback(DmaHandler);
+        DmaChannel::SetDoubleBufferedTransferCallback(StreamHandler);
+        DmaChannel::TransferDoubleBuffered(DmaBase::Periph2Mem | DmaBase::MemIncrement | DmaBase::PriorityHigh | DmaBase::PSize32Bits | DmaBase::MSize32Bits,
+                            buffer, buffer + blockSize, &MasterRegs()->DR, blockSize);
+
+        StartConversion(true);
+        return true;
+    }
+
+    ADCMULTI_TEMPLATE_ARGS
+    void ADCMULTI_TEMPLATE_QUALIFIER::DmaHandler(void* data, unsigned size, bool success)
+    {
+        _Master::DmaChannel::Disable();
+        MasterRegs()->CR2 &= ~(ADC_CR2_DMA | ADC_CR2_CONT);
+        SlaveRegs()->CR2 &= ~ADC_CR2_CONT;
+
+        if (success)
+        {
+            if (_data.regularCallback)
+                _data.regularCallback(static_cast<DataT*>(data), size);
+        }
+        else
+            _data.error = AdcError::TransferError;
+    }
+
+    ADCMULTI_TEMPLATE_ARGS
+    void ADCMULTI_TEMPLATE_QUALIFIER::StreamHandler(void* data, unsigned size, unsigned bufferIndex)
+    {
+        if (_data.streamCallback)
+            _data.streamCallback(static_cast<DataT*>(data), size, _data.streamOverruns);
+
+        // DMA has returned to the reported block while callback was processing it
+        if (_Master::DmaChannel::CurrentBuffer() == bufferIndex)
+            ++_data.streamOverruns;
+    }
+
+    ADCMULTI_TEMPLATE_ARGS
+    bool ADCMULTI_TEMPLATE_QUALIFIER::RegularReady()
+    {
+        return _Master::DmaChannel::Ready();
+    }
+
+    ADCMULTI_TEMPLATE_ARGS
+    void ADCMULTI_TEMPLATE_QUALIFIER::StopRegular()
+    {
+        _Master::StopRegular();
+        SlaveRegs()->CR2 &= ~ADC_CR2_CONT;
+        SlaveRegs()->SQR1 = 0;
+        SlaveRegs()->SQR2 = 0;
+        SlaveRegs()->SQR3 = 0;
+        MasterRegs()->CR1 &= ~ADC_CR1_DUALMOD;
+    }
+
+    ADCMULTI_TEMPLATE_ARGS
+    uint32_t ADCMULTI_TEMPLATE_QUALIFIER::StreamOverruns()
+    {
+        return _data.streamOverruns;
+    }
+
+    ADCMULTI_TEMPLATE_ARGS
+    typename ADCMULTI_TEMPLATE_QUALIFIER::AdcError ADCMULTI_TEMPLATE_QUALIFIER::GetError()
+    {
+        return _data.error;
+    }
+
+    ADCMULTI_TEMPLATE_ARGS
+    typename ADCMULTI_TEMPLATE_QUALIFIER::MultiData ADCMULTI_TEMPLATE_QUALIFIER::_data;
+}
+
+#endif //! ZHELE_ADC_MULTI_IMPL_H
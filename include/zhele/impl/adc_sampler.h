@@ -0,0 +1,115 @@
+/**
+ * @file
+ * Implements timer-paced ADC sampling
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ADC_SAMPLER_IMPL_H
+#define ZHELE_ADC_SAMPLER_IMPL_H
+
+namespace Zhele
+{
+    #define ADCSAMPLER_TEMPLATE_ARGS template<typename _Adc, typename _Timer, unsigned long _SampleRate, unsigned long _TimerClockFreq, unsigned long _AdcSourceClockFreq>
+    #define ADCSAMPLER_TEMPLATE_QUALIFIER AdcSampler<_Adc, _Timer, _SampleRate, _TimerClockFreq, _AdcSourceClockFreq>
+
+    ADCSAMPLER_TEMPLATE_ARGS
+    consteval uint32_t ADCSAMPLER_TEMPLATE_QUALIFIER::CalculatePrescaler()
+    {
+        // The smallest prescaler gives the best resolution of period
+        for (uint32_t prescaler = 1; prescaler <= 0x10000; ++prescaler)
+        {
+            if (_TimerClockFreq % (prescaler * _SampleRate) == 0 && _TimerClockFreq / (prescaler * _SampleRate) <= 0x10000)
+                return prescaler;
+        }
+        return 0;
+    }
+
+    ADCSAMPLER_TEMPLATE_ARGS
+    consteval typename _Adc::AdcDivider ADCSAMPLER_TEMPLATE_QUALIFIER::SelectDivider()
+    {
+        using Divider = typename _Adc::AdcDivider;
+
+        if (_AdcSourceClockFreq / 2 <= _Adc::MaxClockFreq)
+            return Divider::Div2;
+        if (_AdcSourceClockFreq / 4 <= _Adc::MaxClockFreq)
+            return Divider::Div4;
+        if (_AdcSourceClockFreq / 6 <= _Adc::MaxClockFreq)
+            return Divider::Div6;
+        return Divider::Div8;
+    }
+
+    ADCSAMPLER_TEMPLATE_ARGS
+    consteval unsigned ADCSAMPLER_TEMPLATE_QUALIFIER::DividerValue(typename _Adc::AdcDivider divider)
+    {
+        using Divider = typename _Adc::AdcDivider;
+
+        switch (divider)
+        {
+            case Divider::Div2: return 2;
+            case Divider::Div4: return 4;
+            case Divider::Div6: return 6;
+            default: return 8;
+        }
+    }
+
+    ADCSAMPLER_TEMPLATE_ARGS
+    template<unsigned _ChannelsCount>
+    consteval unsigned ADCSAMPLER_TEMPLATE_QUALIFIER::SampleTime()
+    {
+        unsigned result = 0;
+        for (uint16_t sampleTime : _Adc::SampleTimes)
+        {
+            // Same as AdcBase::ConvertionTimeCycles
+            if (_ChannelsCount * (_Adc::ResolutionBits + sampleTime + 1) <= CyclesPerSample)
+                result = sampleTime;
+        }
+        return result;
+    }
+
+    ADCSAMPLER_TEMPLATE_ARGS
+    void ADCSAMPLER_TEMPLATE_QUALIFIER::Init()
+    {
+        _Adc::template Init<Divider>();
+        _Adc::SetRegularTrigger(Trigger::Trigger, _Adc::TriggerMode::RisingFalling);
+
+        _Timer::Enable();
+        _Timer::Stop();
+        _Timer::SetPrescaler(TimerPrescaler - 1);
+        _Timer::SetPeriod(TimerPeriod - 1);
+        _Timer::SetMasterMode(_Timer::MasterMode::Update);
+    }
+
+    ADCSAMPLER_TEMPLATE_ARGS
+    template<typename... _Pins>
+    bool ADCSAMPLER_TEMPLATE_QUALIFIER::Start(uint16_t* buffer, uint16_t blockSize, AdcStreamCallbackType callback)
+    {
+        static_assert(sizeof...(_Pins) > 0, "At least one pin is required");
+        constexpr unsigned sampleTime = SampleTime<sizeof...(_Pins)>();
+        static_assert(sampleTime > 0, "Conversion time does not fit sample period");
+
+        const uint8_t channels[] = {static_cast<uint8_t>(_Adc::Pins::template IndexOf<_Pins>)...};
+        for (uint8_t channel : channels)
+        {
+            _Adc::SetSampleTime(channel, sampleTime);
+        }
+
+        if (!_Adc::StartRegularStream(channels, sizeof...(_Pins), buffer, blockSize, callback))
+            return false;
+
+        _Timer::ResetCounterValue();
+        _Timer::Start();
+        return true;
+    }
+
+    ADCSAMPLER_TEMPLATE_ARGS
+    void ADCSAMPLER_TEMPLATE_QUALIFIER::Stop()
+    {
+        _Timer::Stop();
+        _Adc::StopRegular();
+    }
+}
+
+#endif //! ZHELE_ADC_SAMPLER_IMPL_H
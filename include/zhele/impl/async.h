@@ -0,0 +1,394 @@
+/**
+ * @file
+ * Implements C++20 coroutines support: tasks, scheduler and awaitable peripheral operations
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ASYNC_IMPL_H
+#define ZHELE_ASYNC_IMPL_H
+
+#include <exception>
+
+namespace Zhele::Async
+{
+    namespace Private
+    {
+        /**
+         * @brief Static pool of coroutine frames
+         */
+        class FramePool
+        {
+        public:
+            static void* Allocate(size_t size)
+            {
+                if (size > ZHELE_ASYNC_FRAME_SIZE)
+                    return nullptr;
+
+                uint32_t primask = __get_PRIMASK();
+                __disable_irq();
+
+                void* frame = nullptr;
+                for (unsigned i = 0; i < ZHELE_ASYNC_MAX_TASKS; ++i)
+                {
+                    if (!_used[i])
+                    {
+                        _used[i] = true;
+                        frame = _frames[i].data;
+                        break;
+                    }
+                }
+
+                __set_PRIMASK(primask);
+                return frame;
+            }
+
+            static void Free(void* frame)
+            {
+                unsigned index = reinterpret_cast<Frame*>(frame) - _frames;
+                _used[index] = false;
+            }
+
+        private:
+            struct Frame
+            {
+                alignas(std::max_align_t) uint8_t data[ZHELE_ASYNC_FRAME_SIZE];
+            };
+
+            static inline Frame _frames[ZHELE_ASYNC_MAX_TASKS];
+            static inline volatile bool _used[ZHELE_ASYNC_MAX_TASKS];
+        };
+    }
+
+    inline std::coroutine_handle<> Task::promise_type::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+    {
+        promise_type& promise = handle.promise();
+        if (promise._continuation)
+            return promise._continuation;
+
+        if (promise._detached)
+            handle.destroy();
+
+        return std::noop_coroutine();
+    }
+
+    inline Task Task::promise_type::get_return_object() noexcept
+    {
+        return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    inline Task Task::promise_type::get_return_object_on_allocation_failure() noexcept
+    {
+        return Task(nullptr);
+    }
+
+    inline void Task::promise_type::unhandled_exception() const noexcept
+    {
+        std::terminate();
+    }
+
+    inline void* Task::promise_type::operator new(size_t size) noexcept
+    {
+        return Private::FramePool::Allocate(size);
+    }
+
+    inline void Task::promise_type::operator delete(void* frame) noexcept
+    {
+        Private::FramePool::Free(frame);
+    }
+
+    inline Task::Task(std::coroutine_handle<promise_type> handle)
+        : _handle(handle)
+    {}
+
+    inline Task::Task(Task&& other) noexcept
+        : _handle(other._handle)
+    {
+        other._handle = nullptr;
+    }
+
+    inline Task::~Task()
+    {
+        if (_handle)
+            _handle.destroy();
+    }
+
+    inline bool Task::IsValid() const
+    {
+        return static_cast<bool>(_handle);
+    }
+
+    inline bool Task::await_ready() const noexcept
+    {
+        return !_handle || _handle.done();
+    }
+
+    inline std::coroutine_handle<> Task::await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        _handle.promise()._continuation = awaiting;
+        return _handle;
+    }
+
+    inline bool Scheduler::Spawn(Task&& task)
+    {
+        if (!task._handle)
+            return false;
+
+        task._handle.promise()._detached = true;
+        Ready(task._handle);
+        task._handle = nullptr;
+        return true;
+    }
+
+    inline void Scheduler::Ready(std::coroutine_handle<> handle)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        _queue[(_head + _count) % QueueSize] = handle;
+        ++_count;
+
+        __set_PRIMASK(primask);
+    }
+
+    inline void Scheduler::Sleep(std::coroutine_handle<> handle, uint32_t milliseconds)
+    {
+        // Every frame can sleep only once at a time, so free slot always exists
+        for (Sleeper& sleeper : _sleepers)
+        {
+            if (!sleeper.Handle)
+            {
+                sleeper.Handle = handle;
+                sleeper.Wake = Deadline(milliseconds);
+                ++_sleeping;
+                return;
+            }
+        }
+        Ready(handle);
+    }
+
+    inline bool Scheduler::Poll()
+    {
+        Wake();
+
+        bool resumed = false;
+        while (std::coroutine_handle<> handle = Pop())
+        {
+            handle.resume();
+            resumed = true;
+        }
+        return resumed;
+    }
+
+    inline void Scheduler::Run()
+    {
+        while (true)
+        {
+            Poll();
+
+            // Interrupt between check and WFI wakes core anyway. Sleepers are woken by SysTick only.
+            __disable_irq();
+            if (_count == 0 && (_sleeping == 0 || SystemTime::Running()))
+                __WFI();
+            __enable_irq();
+        }
+    }
+
+    inline std::coroutine_handle<> Scheduler::Pop()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        std::coroutine_handle<> handle = nullptr;
+        if (_count > 0)
+        {
+            handle = _queue[_head];
+            _head = (_head + 1) % QueueSize;
+            --_count;
+        }
+
+        __set_PRIMASK(primask);
+        return handle;
+    }
+
+    inline void Scheduler::Wake()
+    {
+        if (_sleeping == 0)
+            return;
+
+        for (Sleeper& sleeper : _sleepers)
+        {
+            if (sleeper.Handle && sleeper.Wake.Expired())
+            {
+                Ready(sleeper.Handle);
+                sleeper.Handle = nullptr;
+                --_sleeping;
+            }
+        }
+    }
+
+    inline std::coroutine_handle<> Scheduler::_queue[QueueSize];
+    inline unsigned Scheduler::_head = 0;
+    inline unsigned Scheduler::_count = 0;
+    inline Scheduler::Sleeper Scheduler::_sleepers[QueueSize];
+    inline unsigned Scheduler::_sleeping = 0;
+
+    namespace Private
+    {
+        template<typename _Tag, typename _Result>
+        void Completion<_Tag, _Result>::Begin(std::coroutine_handle<> handle)
+        {
+            _handle = handle;
+            _pending = true;
+        }
+
+        template<typename _Tag, typename _Result>
+        bool Completion<_Tag, _Result>::Cancel(_Result result)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+
+            // Callback can be called before start function returns
+            bool cancelled = _pending;
+            if (cancelled)
+            {
+                _pending = false;
+                _result = result;
+            }
+
+            __set_PRIMASK(primask);
+            return cancelled;
+        }
+
+        template<typename _Tag, typename _Result>
+        _Result Completion<_Tag, _Result>::Result()
+        {
+            return _result;
+        }
+
+        template<typename _Tag, typename _Result>
+        void Completion<_Tag, _Result>::OnTransfer(void*, unsigned, bool success)
+        {
+            Complete(success);
+        }
+
+        template<typename _Tag, typename _Result>
+        void Completion<_Tag, _Result>::OnStatus(_Result status)
+        {
+            Complete(status);
+        }
+
+        template<typename _Tag, typename _Result>
+        void Completion<_Tag, _Result>::Complete(_Result result)
+        {
+            if (!_pending)
+                return;
+
+            _pending = false;
+            _result = result;
+            Scheduler::Ready(_handle);
+        }
+
+        template<typename _Tag, typename _Result>
+        std::coroutine_handle<> Completion<_Tag, _Result>::_handle;
+
+        template<typename _Tag, typename _Result>
+        _Result Completion<_Tag, _Result>::_result;
+
+        template<typename _Tag, typename _Result>
+        volatile bool Completion<_Tag, _Result>::_pending = false;
+
+        template<typename _Tag, typename _Result, typename _Start>
+        bool Operation<_Tag, _Result, _Start>::await_suspend(std::coroutine_handle<> handle)
+        {
+            Completion::Begin(handle);
+            return _start();
+        }
+
+        template<typename _Tag, typename _Result, typename _Start>
+        auto MakeOperation(_Start start)
+        {
+            return Operation<_Tag, _Result, _Start>(start);
+        }
+    }
+
+    template<typename _DmaChannel>
+    auto Transfer(typename _DmaChannel::Mode mode, const void* buffer, volatile void* periph, uint32_t size)
+    {
+        using Completion = Private::Completion<_DmaChannel, bool>;
+        return Private::MakeOperation<_DmaChannel, bool>([=]() {
+            _DmaChannel::SetTransferCallback(Completion::OnTransfer);
+            _DmaChannel::Transfer(mode, buffer, periph, size);
+            return true;
+        });
+    }
+
+    template<typename _Peripheral>
+    auto Write(const void* data, size_t size)
+    {
+        using Tag = Private::WriteTag<_Peripheral>;
+        using Completion = Private::Completion<Tag, bool>;
+        return Private::MakeOperation<Tag, bool>([=]() {
+            // Nothing is transferred (and callback is not called) for empty data
+            if (size == 0)
+            {
+                Completion::OnTransfer(nullptr, 0, true);
+                return true;
+            }
+            _Peripheral::WriteAsync(data, size, Completion::OnTransfer);
+            return true;
+        });
+    }
+
+    template<typename _Peripheral>
+    auto Read(void* buffer, size_t size)
+    {
+        using Tag = Private::ReadTag<_Peripheral>;
+        using Completion = Private::Completion<Tag, bool>;
+        return Private::MakeOperation<Tag, bool>([=]() {
+            if constexpr (requires { _Peripheral::ReadAsync(buffer, size, Completion::OnTransfer); })
+                _Peripheral::ReadAsync(buffer, size, Completion::OnTransfer);
+            else
+                _Peripheral::EnableAsyncRead(buffer, size, Completion::OnTransfer);
+            return true;
+        });
+    }
+
+    template<typename _Spi>
+    auto Send(void* transmitBuffer, void* receiveBuffer, size_t size)
+    {
+        using Completion = Private::Completion<_Spi, bool>;
+        return Private::MakeOperation<_Spi, bool>([=]() {
+            _Spi::SendAsync(transmitBuffer, receiveBuffer, size, Completion::OnTransfer);
+            return true;
+        });
+    }
+
+    template<typename _I2c>
+    auto Write(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cOpts opts)
+    {
+        // Second operation is rejected by I2C (Busy) and cancels its own completion only
+        using Tag = Private::WriteTag<_I2c>;
+        using Completion = Private::Completion<Tag, I2cStatus>;
+        return Private::MakeOperation<Tag, I2cStatus>([=]() {
+            I2cStatus status = _I2c::WriteAsync(devAddr, regAddr, data, size, opts, Completion::OnStatus);
+            // Resume immediately if operation failed and callback was not called
+            return status == I2cStatus::Success || !Completion::Cancel(status);
+        });
+    }
+
+    template<typename _I2c>
+    auto Read(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts)
+    {
+        using Tag = Private::ReadTag<_I2c>;
+        using Completion = Private::Completion<Tag, I2cStatus>;
+        return Private::MakeOperation<Tag, I2cStatus>([=]() {
+            I2cStatus status = _I2c::EnableAsyncRead(devAddr, regAddr, data, size, opts, Completion::OnStatus);
+            return status == I2cStatus::Success || !Completion::Cancel(status);
+        });
+    }
+}
+
+#endif //! ZHELE_ASYNC_IMPL_H
@@ -0,0 +1,279 @@
+/**
+ * @file
+ * Implements deferred binary logging (format strings are decoded on host)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_BINARY_LOG_IMPL_H
+#define ZHELE_BINARY_LOG_IMPL_H
+
+#include <array>
+#include <cstring>
+#include <type_traits>
+
+namespace Zhele
+{
+    namespace Private
+    {
+        /// Log argument kind (wire size and type)
+        enum class LogArgument : uint8_t
+        {
+            Integer, ///< Integer (4 bytes)
+            LongInteger, ///< Integer (8 bytes)
+            Float, ///< Float (4 bytes)
+            Double, ///< Double (8 bytes)
+        };
+
+        /// Parsed log format string
+        template<unsigned _Capacity>
+        struct LogFormatArguments
+        {
+            std::array<LogArgument, _Capacity> Arguments {};
+            unsigned Count = 0; ///< Arguments count
+            bool Valid = true; ///< Format string is supported
+        };
+
+        /**
+         * @brief Parses log format string
+         *
+         * @tparam _Format Format string
+         *
+         * @returns Conversions of format string
+         */
+        template<TemplateUtils::fixed_string _Format>
+        consteval LogFormatArguments<_Format.Length / 2 + 1> ParseLogFormat()
+        {
+            LogFormatArguments<_Format.Length / 2 + 1> result;
+            const char* text = _Format.Text;
+            const unsigned length = _Format.Length;
+
+            for (unsigned i = 0; i < length; ++i)
+            {
+                if (text[i] != '%')
+                    continue;
+                if (++i < length && text[i] == '%')
+                    continue;
+
+                // Flags, width and precision
+                while (i < length && (text[i] == '-' || text[i] == '+' || text[i] == ' ' || text[i] == '#' || text[i] == '.' || (text[i] >= '0' && text[i] <= '9')))
+                    ++i;
+
+                unsigned longs = 0;
+                while (i < length && (text[i] == 'h' || text[i] == 'l' || text[i] == 'z'))
+                {
+                    if (text[i] == 'l')
+                        ++longs;
+                    ++i;
+                }
+
+                if (i >= length)
+                {
+                    result.Valid = false;
+                    return result;
+                }
+
+                switch (text[i])
+                {
+                case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+                    result.Arguments[result.Count++] = longs >= 2 ? LogArgument::LongInteger : LogArgument::Integer;
+                    break;
+                case 'f': case 'e': case 'g':
+                    result.Arguments[result.Count++] = longs >= 1 ? LogArgument::Double : LogArgument::Float;
+                    break;
+                default:
+                    result.Valid = false;
+                    return result;
+                }
+            }
+
+            return result;
+        }
+
+        /**
+         * @brief Format string storage
+         *
+         * @details
+         * Compilers ignore section attribute of template variables, so text is emitted to .rodata.<mangled name>
+         * section and it's moved out of flash by linker script (see cmake/zhele-log.ld). Text address is record id.
+         *
+         * @tparam _Format Format string
+         */
+        template<TemplateUtils::fixed_string _Format>
+        struct LogFormat
+        {
+            static constexpr TemplateUtils::fixed_string<_Format.Length> Text = _Format;
+        };
+
+        template<typename T>
+        consteval LogArgument LogArgumentOf()
+        {
+            if constexpr (std::is_same_v<T, float>)
+                return LogArgument::Float;
+            else if constexpr (std::is_same_v<T, double>)
+                return LogArgument::Double;
+            else
+            {
+                static_assert((std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_enum_v<T>, "Unsupported log argument type");
+                return sizeof(T) > 4 ? LogArgument::LongInteger : LogArgument::Integer;
+            }
+        }
+
+        /**
+         * @brief Stores argument to record
+         *
+         * @param [out] record Record position
+         * @param [in] value Argument
+         *
+         * @returns Next position
+         */
+        template<typename T>
+        inline uint8_t* StoreLogArgument(uint8_t* record, T value)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                memcpy(record, &value, sizeof(T));
+                return record + sizeof(T);
+            }
+            else
+            {
+                // Integers are extended (signed by sign) to 4 or 8 bytes, like variadic arguments
+                using Wire = std::conditional_t<(sizeof(T) > 4), uint64_t, uint32_t>;
+                using Integer = std::conditional_t<std::is_enum_v<T>, std::underlying_type<T>, std::type_identity<T>>::type;
+                Wire wire = static_cast<Wire>(static_cast<Integer>(value));
+                memcpy(record, &wire, sizeof(wire));
+                return record + sizeof(wire);
+            }
+        }
+
+        template<typename T>
+        consteval unsigned LogArgumentSize()
+        {
+            LogArgument kind = LogArgumentOf<T>();
+            return kind == LogArgument::LongInteger || kind == LogArgument::Double ? 8 : 4;
+        }
+    }
+
+    #define BINARY_LOG_TEMPLATE_ARGS template<unsigned _Size, uint8_t _Level>
+    #define BINARY_LOG_TEMPLATE_QUALIFIER BinaryLog<_Size, _Level>
+
+    BINARY_LOG_TEMPLATE_ARGS
+    template<TemplateUtils::fixed_string _Format, typename... Args>
+    bool BINARY_LOG_TEMPLATE_QUALIFIER::Write(Args... args)
+    {
+        static constexpr auto Parsed = Private::ParseLogFormat<_Format>();
+        static_assert(Parsed.Valid, "Unsupported log format string");
+        static_assert(Parsed.Count == sizeof...(Args), "Log arguments count mismatch");
+        static_assert([]<size_t... _Indexes>(std::index_sequence<_Indexes...>) {
+                return ((Parsed.Arguments[_Indexes] == Private::LogArgumentOf<Args>()) && ...);
+            }(std::index_sequence_for<Args...>{}), "Log argument type does not match format");
+
+        constexpr unsigned RecordSize = 4 + (Private::LogArgumentSize<Args>() + ... + 0);
+        static_assert(RecordSize <= _Size, "Log record is greater than ring");
+
+        uint8_t record[RecordSize];
+        const uint32_t id = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&Private::LogFormat<_Format>::Text));
+        memcpy(record, &id, sizeof(id));
+        [[maybe_unused]] uint8_t* position = record + sizeof(id);
+        ((position = Private::StoreLogArgument(position, args)), ...);
+
+        Irq::CriticalSection<_Level> lock;
+
+        if (static_cast<unsigned>(_buffer.capacity() - _buffer.size()) < RecordSize)
+        {
+            _dropped = _dropped + 1;
+            return false;
+        }
+
+        unsigned written = 0;
+        while (written < RecordSize)
+        {
+            auto region = _buffer.writable_span();
+            unsigned chunk = region.size() < RecordSize - written ? region.size() : RecordSize - written;
+            memcpy(region.data(), record + written, chunk);
+            _buffer.commit(chunk);
+            written += chunk;
+        }
+
+        return true;
+    }
+
+    BINARY_LOG_TEMPLATE_ARGS
+    template<typename _Output>
+    void BINARY_LOG_TEMPLATE_QUALIFIER::Drain()
+    {
+        while (_sending == 0)
+        {
+            auto region = _buffer.readable_span();
+            if (region.empty())
+                return;
+
+            if constexpr (std::is_void_v<decltype(_Output::Write(region.data(), region.size()))>)
+            {
+                _Output::Write(region.data(), region.size());
+                _buffer.consume(region.size());
+            }
+            else
+            {
+                size_t written = _Output::Write(region.data(), region.size());
+                _buffer.consume(written);
+                if (written < region.size())
+                    return;
+            }
+        }
+    }
+
+    BINARY_LOG_TEMPLATE_ARGS
+    template<typename _Usart>
+    bool BINARY_LOG_TEMPLATE_QUALIFIER::DrainAsync()
+    {
+        {
+            Irq::CriticalSection<0> lock;
+            if (_sending != 0)
+                return false;
+
+            auto region = _buffer.readable_span();
+            if (region.empty())
+                return false;
+
+            _sending = region.size();
+        }
+
+        _Usart::WriteAsync(_buffer.readable_span().data(), _sending, DrainComplete<_Usart>);
+        return true;
+    }
+
+    BINARY_LOG_TEMPLATE_ARGS
+    template<typename _Usart>
+    void BINARY_LOG_TEMPLATE_QUALIFIER::DrainComplete(void*, unsigned, bool)
+    {
+        _buffer.consume(_sending);
+        _sending = 0;
+        DrainAsync<_Usart>();
+    }
+
+    BINARY_LOG_TEMPLATE_ARGS
+    unsigned BINARY_LOG_TEMPLATE_QUALIFIER::Size()
+    {
+        return _buffer.size();
+    }
+
+    BINARY_LOG_TEMPLATE_ARGS
+    uint32_t BINARY_LOG_TEMPLATE_QUALIFIER::Dropped()
+    {
+        return _dropped;
+    }
+
+    BINARY_LOG_TEMPLATE_ARGS
+    Containers::RingBuffer<_Size, uint8_t> BINARY_LOG_TEMPLATE_QUALIFIER::_buffer;
+
+    BINARY_LOG_TEMPLATE_ARGS
+    volatile uint32_t BINARY_LOG_TEMPLATE_QUALIFIER::_dropped = 0;
+
+    BINARY_LOG_TEMPLATE_ARGS
+    volatile unsigned BINARY_LOG_TEMPLATE_QUALIFIER::_sending = 0;
+}
+
+#endif //! ZHELE_BINARY_LOG_IMPL_H
@@ -10,6 +10,9 @@
 #ifndef ZHELE_BINARY_STREAM_IMPL_H
 #define ZHELE_BINARY_STREAM_IMPL_H
 
+#include <algorithm>
+#include <iterator>
+
 namespace Zhele
 {
     template<typename _Source>
@@ -80,6 +83,98 @@ namespace Zhele
         _Source::Write(uint8_t(value >> 8));
     }
 
+    template<typename _Source>
+    void BinaryStream<_Source>::ReadSpan(std::span<uint8_t> data)
+    {
+        if constexpr (Private::BulkTransferSource<_Source>)
+        {
+            _Source::Transfer(nullptr, data.data(), data.size());
+        }
+        else if constexpr (Private::BulkReadSource<_Source>)
+        {
+            _Source::Read(data.data(), data.size());
+        }
+        else
+        {
+            for(uint8_t& value : data)
+            {
+                value = _Source::Read();
+            }
+        }
+    }
+
+    template<typename _Source>
+    void BinaryStream<_Source>::WriteSpan(std::span<const uint8_t> data)
+    {
+        if constexpr (Private::BulkTransferSource<_Source>)
+        {
+            _Source::Transfer(data.data(), nullptr, data.size());
+        }
+        else if constexpr (Private::BulkWriteSource<_Source>)
+        {
+            _Source::Write(data.data(), data.size());
+        }
+        else
+        {
+            for(uint8_t value : data)
+            {
+                _Source::Write(value);
+            }
+        }
+    }
+
+    template<typename _Source>
+    void BinaryStream<_Source>::ReadU32BeSpan(std::span<uint32_t> values)
+    {
+        ReadSpan(AsBytes(values));
+        for(uint32_t& value : values)
+        {
+            value = Private::ByteSwap32(value);
+        }
+    }
+
+    template<typename _Source>
+    void BinaryStream<_Source>::ReadU16BeSpan(std::span<uint16_t> values)
+    {
+        ReadSpan(AsBytes(values));
+        for(uint16_t& value : values)
+        {
+            value = Private::ByteSwap16(value);
+        }
+    }
+
+    template<typename _Source>
+    void BinaryStream<_Source>::WriteU32BeSpan(std::span<const uint32_t> values)
+    {
+        uint32_t chunk[SwapChunkSize / sizeof(uint32_t)];
+        while(!values.empty())
+        {
+            size_t count = std::min(values.size(), std::size(chunk));
+            for(size_t i = 0; i < count; ++i)
+            {
+                chunk[i] = Private::ByteSwap32(values[i]);
+            }
+            WriteSpan(AsBytes(std::span<const uint32_t>(chunk, count)));
+            values = values.subspan(count);
+        }
+    }
+
+    template<typename _Source>
+    void BinaryStream<_Source>::WriteU16BeSpan(std::span<const uint16_t> values)
+    {
+        uint16_t chunk[SwapChunkSize / sizeof(uint16_t)];
+        while(!values.empty())
+        {
+            size_t count = std::min(values.size(), std::size(chunk));
+            for(size_t i = 0; i < count; ++i)
+            {
+                chunk[i] = Private::ByteSwap16(values[i]);
+            }
+            WriteSpan(AsBytes(std::span<const uint16_t>(chunk, count)));
+            values = values.subspan(count);
+        }
+    }
+
     template<typename _Source>
     uint8_t BinaryStream<_Source>::Ignore(size_t bytes)
     {
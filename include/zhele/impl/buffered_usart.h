@@ -0,0 +1,191 @@
+/**
+ * @file
+ * Implements interrupt-driven buffered USART
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_BUFFERED_USART_IMPL_H
+#define ZHELE_BUFFERED_USART_IMPL_H
+
+namespace Zhele
+{
+    #define BUFFEREDUSART_TEMPLATE_ARGS template<typename _Usart, unsigned _TxSize, unsigned _RxSize>
+    #define BUFFEREDUSART_TEMPLATE_QUALIFIER BufferedUsart<_Usart, _TxSize, _RxSize>
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    template<unsigned long baud>
+    void BUFFEREDUSART_TEMPLATE_QUALIFIER::Init(UsartMode mode)
+    {
+        Init(baud, mode);
+    }
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    void BUFFEREDUSART_TEMPLATE_QUALIFIER::Init(unsigned baud, UsartMode mode)
+    {
+        _txBuffer.clear();
+        _rxBuffer.clear();
+        ResetStatistics();
+
+        Base::Init(baud, mode);
+        _rxInterrupt = InterruptFlags::RxNotEmptyInt;
+        _txInterrupt = InterruptFlags::TxEmptyInt;
+        Base::EnableInterrupt(_rxInterrupt);
+    }
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    bool BUFFEREDUSART_TEMPLATE_QUALIFIER::Write(uint8_t data)
+    {
+        if(!_txBuffer.push_back(data))
+            return false;
+
+        if(_txBuffer.size() > _txHighWater)
+            _txHighWater = _txBuffer.size();
+
+        // TXE interrupt is disabled by handler when buffer becomes empty
+        Base::EnableInterrupt(_txInterrupt);
+        return true;
+    }
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    size_t BUFFEREDUSART_TEMPLATE_QUALIFIER::Write(const void* data, size_t size)
+    {
+        const uint8_t* ptr = static_cast<const uint8_t*>(data);
+        size_t written = 0;
+
+        while(written < size && _txBuffer.push_back(ptr[written]))
+            ++written;
+
+        if(_txBuffer.size() > _txHighWater)
+            _txHighWater = _txBuffer.size();
+
+        if(written > 0)
+            Base::EnableInterrupt(_txInterrupt);
+
+        return written;
+    }
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    bool BUFFEREDUSART_TEMPLATE_QUALIFIER::Read(uint8_t& data)
+    {
+        if(_rxBuffer.empty())
+            return false;
+
+        data = _rxBuffer.front();
+        _rxBuffer.pop_front();
+        return true;
+    }
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    size_t BUFFEREDUSART_TEMPLATE_QUALIFIER::Read(void* data, size_t size)
+    {
+        uint8_t* ptr = static_cast<uint8_t*>(data);
+        size_t read = 0;
+
+        while(read < size && Read(ptr[read]))
+            ++read;
+
+        return read;
+    }
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    unsigned BUFFEREDUSART_TEMPLATE_QUALIFIER::RxAvailable()
+    {
+        return _rxBuffer.size();
+    }
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    unsigned BUFFEREDUSART_TEMPLATE_QUALIFIER::TxFree()
+    {
+        return _txBuffer.capacity() - _txBuffer.size();
+    }
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    void BUFFEREDUSART_TEMPLATE_QUALIFIER::Flush()
+    {
+        while(!_txBuffer.empty())
+            continue;
+        while(!Base::WriteReady())
+            continue;
+    }
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    unsigned BUFFEREDUSART_TEMPLATE_QUALIFIER::TxHighWater()
+    {
+        return _txHighWater;
+    }
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    unsigned BUFFEREDUSART_TEMPLATE_QUALIFIER::RxHighWater()
+    {
+        return _rxHighWater;
+    }
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    unsigned BUFFEREDUSART_TEMPLATE_QUALIFIER::RxOverflows()
+    {
+        return _rxOverflows;
+    }
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    void BUFFEREDUSART_TEMPLATE_QUALIFIER::ResetStatistics()
+    {
+        _txHighWater = 0;
+        _rxHighWater = 0;
+        _rxOverflows = 0;
+    }
+
+#if defined (USART_CR1_FIFOEN)
+    BUFFEREDUSART_TEMPLATE_ARGS
+    void BUFFEREDUSART_TEMPLATE_QUALIFIER::EnableFifo(FifoThreshold rxThreshold, FifoThreshold txThreshold)
+    {
+        Base::DisableInterrupt(static_cast<InterruptFlags>(InterruptFlags::RxNotEmptyInt | InterruptFlags::TxEmptyInt));
+        Base::EnableFifo(rxThreshold, txThreshold);
+
+        // Idle line flushes bytes below RX threshold
+        _rxInterrupt = static_cast<InterruptFlags>(InterruptFlags::RxFifoThreshold | InterruptFlags::IdleInt);
+        _txInterrupt = InterruptFlags::TxFifoThreshold;
+        Base::EnableInterrupt(_rxInterrupt);
+        if(!_txBuffer.empty())
+            Base::EnableInterrupt(_txInterrupt);
+    }
+#endif
+
+    BUFFEREDUSART_TEMPLATE_ARGS
+    void BUFFEREDUSART_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        InterruptFlags source = Base::InterruptSource();
+
+        // Drain all received bytes (whole RX FIFO if it is enabled)
+        while(Base::ReadReady())
+        {
+            if(_rxBuffer.push_back(Base::Read()))
+            {
+                if(_rxBuffer.size() > _rxHighWater)
+                    _rxHighWater = _rxBuffer.size();
+            }
+            else
+            {
+                ++_rxOverflows;
+            }
+        }
+
+        // Overrun keeps RXNE interrupt active until cleared
+        if(source & (InterruptFlags::ErrorInt | InterruptFlags::IdleInt))
+            Base::ClearInterruptFlag(static_cast<InterruptFlags>(source & (InterruptFlags::ErrorInt | InterruptFlags::IdleInt)));
+
+        // Fill TX data register (or whole TX FIFO if it is enabled)
+        while(!_txBuffer.empty() && (Base::InterruptSource() & InterruptFlags::TxEmptyInt))
+        {
+            Base::Write(_txBuffer.front());
+            _txBuffer.pop_front();
+        }
+
+        if(_txBuffer.empty())
+            Base::DisableInterrupt(_txInterrupt);
+    }
+}
+
+#endif //! ZHELE_BUFFERED_USART_IMPL_H
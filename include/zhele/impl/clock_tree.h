@@ -0,0 +1,381 @@
+/**
+ * @file
+ * Implements compile-time clock tree configuration
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CLOCK_TREE_IMPL_H
+#define ZHELE_CLOCK_TREE_IMPL_H
+
+namespace Zhele::Clock
+{
+    namespace Private
+    {
+        /**
+         * @brief PLL limits of family
+         */
+        struct PllLimits
+        {
+            unsigned MinDivider; ///< Min input divider
+            unsigned MaxDivider; ///< Max input divider
+            unsigned MinMultiplier; ///< Min multiplier
+            unsigned MaxMultiplier; ///< Max multiplier
+            unsigned MinSystemDivider; ///< Min system output divider
+            unsigned MaxSystemDivider; ///< Max system output divider
+            unsigned MinUsbDivider; ///< Min 48 MHz output divider (0 if there is no divider)
+            unsigned MaxUsbDivider; ///< Max 48 MHz output divider (0 if there is no divider)
+            unsigned SystemDividerStep; ///< System output divider step (2 if divider must be even)
+            unsigned UsbDividerStep; ///< 48 MHz output divider step (2 if divider must be even)
+            ClockFrequenceT MinInput; ///< Min frequence after input divider
+            ClockFrequenceT MaxInput; ///< Max frequence after input divider
+            ClockFrequenceT MinVco; ///< Min frequence after multiplier
+            ClockFrequenceT MaxVco; ///< Max frequence after multiplier
+            ClockFrequenceT UsbOutputs[2]; ///< PLL output frequencies suitable for USB (if there is no 48 MHz divider)
+        };
+
+        /**
+         * @brief Returns PLL limits
+         *
+         * @param [in] internal PLL source is internal oscillator
+         *
+         * @returns PLL limits
+         */
+        consteval PllLimits GetPllLimits(bool internal)
+        {
+        #if defined (STM32F1)
+            // HSI is always divided by 2, USB prescaler is 1 or 1.5
+        #if defined (RCC_CFGR2_PREDIV1)
+            return {internal ? 2u : 1u, internal ? 2u : 16u, 4, 9, 1, 1, 0, 0, 1, 1, 3000000, 12000000, 18000000, 72000000, {48000000, 72000000}};
+        #else
+            return {internal ? 2u : 1u, 2, 2, 16, 1, 1, 0, 0, 1, 1, 1000000, 25000000, 16000000, 72000000, {48000000, 72000000}};
+        #endif
+        #elif defined (STM32F0)
+            return {internal ? 2u : 1u, 2, 2, 16, 1, 1, 0, 0, 1, 1, 1000000, 24000000, 16000000, 48000000, {48000000, 48000000}};
+        #elif defined (STM32F4)
+        #if defined (STM32F401xC) || defined (STM32F401xE)
+            return {2, 63, 50, 432, 2, 8, 2, 15, 2, 1, 1000000, 2000000, 192000000, 432000000, {0, 0}};
+        #else
+            return {2, 63, 50, 432, 2, 8, 2, 15, 2, 1, 1000000, 2000000, 100000000, 432000000, {0, 0}};
+        #endif
+        #elif defined (STM32G0)
+        #if defined (RCC_PLLCFGR_PLLQ_Pos)
+            return {1, 8, 8, 86, 2, 8, 2, 8, 1, 1, 2660000, 16000000, 64000000, 344000000, {0, 0}};
+        #else
+            return {1, 8, 8, 86, 2, 8, 0, 0, 1, 1, 2660000, 16000000, 64000000, 344000000, {0, 0}};
+        #endif
+        #elif defined (STM32L4)
+            return {1, 8, 8, 86, 2, 8, 2, 8, 2, 2, 4000000, 16000000, 64000000, 344000000, {0, 0}};
+        #endif
+        }
+
+        /**
+         * @brief Returns 48 MHz output divider
+         *
+         * @param [in] limits PLL limits
+         * @param [in] vco Frequence after multiplier
+         *
+         * @returns Divider, 1 if PLL output is suitable for USB itself, 0 if there is no suitable divider
+         */
+        consteval unsigned SelectUsbDivider(const PllLimits& limits, ClockFrequenceT vco)
+        {
+            constexpr ClockFrequenceT usbFrequence = 48000000;
+            if (limits.MaxUsbDivider == 0)
+                return vco == limits.UsbOutputs[0] || vco == limits.UsbOutputs[1] ? 1 : 0;
+
+            for (unsigned divider = limits.MinUsbDivider; divider <= limits.MaxUsbDivider; divider += limits.UsbDividerStep)
+            {
+                if (vco == usbFrequence * divider)
+                    return divider;
+            }
+            return 0;
+        }
+
+        /**
+         * @brief Returns minimal bus prescaler
+         *
+         * @param [in] frequence Source frequence
+         * @param [in] maxFrequence Max bus frequence
+         *
+         * @returns Prescaler (power of 2)
+         */
+        consteval unsigned SelectBusDivider(ClockFrequenceT frequence, ClockFrequenceT maxFrequence)
+        {
+            unsigned divider = 1;
+            while (frequence > maxFrequence * divider)
+                divider *= 2;
+            return divider;
+        }
+
+        /**
+         * @brief Converts prescaler value to bus prescaler enum
+         *
+         * @tparam _Bus Bus clock (Apb1Clock, Apb2Clock)
+         *
+         * @param [in] divider Prescaler value
+         *
+         * @returns Prescaler
+         */
+        template<typename _Bus>
+        consteval typename _Bus::Prescaler BusPrescaler(unsigned divider)
+        {
+            switch (divider)
+            {
+                case 1: return _Bus::Div1;
+                case 2: return _Bus::Div2;
+                case 4: return _Bus::Div4;
+                case 8: return _Bus::Div8;
+                default: return _Bus::Div16;
+            }
+        }
+
+        /**
+         * @brief Searches PLL configuration
+         *
+         * @details
+         * Dividers are searched in ascending order, so solver prefers the highest
+         * PLL input frequence (lower jitter) and the lowest VCO frequence (lower consumption).
+         *
+         * @param [in] source PLL source frequence
+         * @param [in] internal PLL source is internal oscillator
+         * @param [in] target Target system clock frequence
+         * @param [in] usb Need 48 MHz clock
+         *
+         * @returns Configuration
+         */
+        consteval PllConfiguration SolvePll(ClockFrequenceT source, bool internal, ClockFrequenceT target, bool usb)
+        {
+            PllConfiguration result{};
+            if (source == 0 || target == 0 || target > ZHELE_CLOCK_MAX_SYSCLK)
+                return result;
+
+            const PllLimits limits = GetPllLimits(internal);
+            for (unsigned divider = limits.MinDivider; divider <= limits.MaxDivider; ++divider)
+            {
+                ClockFrequenceT input = source / divider;
+                if (source % divider != 0 || input < limits.MinInput || input > limits.MaxInput)
+                    continue;
+
+                for (unsigned systemDivider = limits.MinSystemDivider; systemDivider <= limits.MaxSystemDivider; systemDivider += limits.SystemDividerStep)
+                {
+                    uint64_t vco = static_cast<uint64_t>(target) * systemDivider;
+                    if (vco % input != 0 || vco < limits.MinVco || vco > limits.MaxVco)
+                        continue;
+
+                    uint64_t multiplier = vco / input;
+                    if (multiplier < limits.MinMultiplier || multiplier > limits.MaxMultiplier)
+                        continue;
+
+                    unsigned usbDivider = 0;
+                    if (usb)
+                    {
+                        usbDivider = SelectUsbDivider(limits, static_cast<ClockFrequenceT>(vco));
+                        if (usbDivider == 0)
+                            continue;
+                        if (limits.MaxUsbDivider == 0)
+                            usbDivider = 0;
+                    }
+
+                    result.Valid = true;
+                    result.Input = source;
+                    result.Divider = divider;
+                    result.Multiplier = static_cast<unsigned>(multiplier);
+                    result.SystemDivider = systemDivider;
+                    result.UsbDivider = usbDivider;
+                    result.Apb1Divider = SelectBusDivider(target, ZHELE_CLOCK_MAX_APB1);
+                    result.Apb2Divider = SelectBusDivider(target, ZHELE_CLOCK_MAX_APB2);
+                    return result;
+                }
+            }
+            return result;
+        }
+
+        /**
+         * @brief Sets PLL factors and bus prescalers (PLL must be disabled)
+         *
+         * @tparam _Config PLL configuration
+         * @tparam _Internal PLL source is internal oscillator
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<PllConfiguration _Config, bool _Internal>
+        void SetupPll()
+        {
+            PllClock::SelectClockSource<_Internal ? PllClock::Internal : PllClock::External>();
+            PllClock::SetDivider<_Config.Divider>();
+            PllClock::SetMultiplier<_Config.Multiplier>();
+        #if !defined (STM32F0) && !defined (STM32F1)
+            PllClock::SetSystemOutputDivider<_Config.SystemDivider>();
+            if constexpr (_Config.UsbDivider != 0)
+                PllClock::SetUsbOutputDivider<_Config.UsbDivider>();
+        #endif
+
+            AhbClock::SetPrescaler<AhbClock::Div1>();
+            Apb1Clock::SetPrescaler<BusPrescaler<Apb1Clock>(_Config.Apb1Divider)>();
+            Apb2Clock::SetPrescaler<BusPrescaler<Apb2Clock>(_Config.Apb2Divider)>();
+        }
+
+        /**
+         * @brief RCC clock ready interrupt bits
+         */
+        struct ReadyInterrupt
+        {
+            uint32_t Enable; ///< Interrupt enable bit
+            uint32_t Flag; ///< Interrupt flag
+            uint32_t Clear; ///< Flag clear bit
+        };
+
+    #if defined (RCC_CIER_PLLRDYIE)
+        constexpr ReadyInterrupt HseReady{RCC_CIER_HSERDYIE, RCC_CIFR_HSERDYF, RCC_CICR_HSERDYC};
+        constexpr ReadyInterrupt PllReady{RCC_CIER_PLLRDYIE, RCC_CIFR_PLLRDYF, RCC_CICR_PLLRDYC};
+
+        inline void EnableReadyInterrupt(const ReadyInterrupt& interrupt)
+        {
+            RCC->CICR = interrupt.Clear;
+            RCC->CIER |= interrupt.Enable;
+        }
+
+        inline void DisableReadyInterrupt(const ReadyInterrupt& interrupt)
+        {
+            RCC->CIER &= ~interrupt.Enable;
+            RCC->CICR = interrupt.Clear;
+        }
+
+        inline bool IsReadyInterrupt(const ReadyInterrupt& interrupt)
+        {
+            return (RCC->CIFR & interrupt.Flag) != 0;
+        }
+    #else
+        constexpr ReadyInterrupt HseReady{RCC_CIR_HSERDYIE, RCC_CIR_HSERDYF, RCC_CIR_HSERDYC};
+        constexpr ReadyInterrupt PllReady{RCC_CIR_PLLRDYIE, RCC_CIR_PLLRDYF, RCC_CIR_PLLRDYC};
+
+        inline void EnableReadyInterrupt(const ReadyInterrupt& interrupt)
+        {
+            RCC->CIR = (RCC->CIR & ~interrupt.Enable) | interrupt.Clear;
+            RCC->CIR |= interrupt.Enable;
+        }
+
+        inline void DisableReadyInterrupt(const ReadyInterrupt& interrupt)
+        {
+            RCC->CIR = (RCC->CIR & ~interrupt.Enable) | interrupt.Clear;
+        }
+
+        inline bool IsReadyInterrupt(const ReadyInterrupt& interrupt)
+        {
+            return (RCC->CIR & interrupt.Flag) != 0;
+        }
+    #endif
+    }
+
+    template<ClockFrequenceT _HseHz, ClockFrequenceT _SysHz, bool _Usb48>
+    consteval PllConfiguration ClockTree::Solve()
+    {
+        return Private::SolvePll(_HseHz == 0 ? HSI_VALUE : _HseHz, _HseHz == 0, _SysHz, _Usb48);
+    }
+
+    template<ClockFrequenceT _HseHz, ClockFrequenceT _SysHz, bool _Usb48>
+    SysClock::ErrorCode ClockTree::Configure()
+    {
+        static_assert(_HseHz == 0 || _HseHz == HSE_VALUE, "HSE frequence must be equal to HSE_VALUE (it is used to calculate clocks at runtime)");
+        static_assert(_SysHz <= ZHELE_CLOCK_MAX_SYSCLK, "Target system clock frequence exceeds max frequence");
+
+        static constexpr PllConfiguration config = Solve<_HseHz, _SysHz, _Usb48>();
+        static_assert(config.Valid, "There is no PLL configuration for target system clock frequence (and 48 MHz clock)");
+
+        // Peripherals are re-timed once for final clocks
+        ClockChange::BeginUpdate();
+
+        // PLL cannot be configured while it is enabled
+        SysClock::ErrorCode result = SysClock::SelectClockSource<SysClock::Internal>();
+        if (result != SysClock::Success)
+        {
+            ClockChange::EndUpdate();
+            return result;
+        }
+        PllClock::Disable();
+        Private::SetupPll<config, _HseHz == 0>();
+
+        // System clock is HSI now, so wait states for target frequence are safe
+        Flash::OptimiseForFrequency<_SysHz>();
+
+        result = SysClock::SelectClockSource<SysClock::Pll>();
+        ClockChange::EndUpdate();
+        return result;
+    }
+
+    #define ASYNC_CLOCK_TREE_TEMPLATE_ARGS template<ClockFrequenceT _HseHz, ClockFrequenceT _SysHz, bool _Usb48>
+    #define ASYNC_CLOCK_TREE_TEMPLATE_QUALIFIER AsyncClockTree<_HseHz, _SysHz, _Usb48>
+
+    ASYNC_CLOCK_TREE_TEMPLATE_ARGS
+    SysClock::ErrorCode ASYNC_CLOCK_TREE_TEMPLATE_QUALIFIER::Start(ReadyCallback callback)
+    {
+        _callback = callback;
+        _ready = false;
+
+        // Peripherals initialized after start are timed for HSI with final bus prescalers
+        ClockChange::BeginUpdate();
+        SysClock::ErrorCode result = SysClock::SelectClockSource<SysClock::Internal>();
+        if (result != SysClock::Success)
+        {
+            ClockChange::EndUpdate();
+            return result;
+        }
+        PllClock::Disable();
+        Private::SetupPll<Config, _HseHz == 0>();
+        ClockChange::EndUpdate();
+
+        // Oscillator and PLL start in background, switch is done by ready interrupts
+        if constexpr (_HseHz != 0)
+        {
+            Private::EnableReadyInterrupt(Private::HseReady);
+            RccCrReg::Or(RCC_CR_HSEON);
+        }
+        else
+        {
+            Private::EnableReadyInterrupt(Private::PllReady);
+            RccCrReg::Or(RCC_CR_PLLON);
+        }
+        NVIC_EnableIRQ(RCC_IRQn);
+
+        return SysClock::Success;
+    }
+
+    ASYNC_CLOCK_TREE_TEMPLATE_ARGS
+    bool ASYNC_CLOCK_TREE_TEMPLATE_QUALIFIER::IsReady()
+    {
+        return _ready;
+    }
+
+    ASYNC_CLOCK_TREE_TEMPLATE_ARGS
+    void ASYNC_CLOCK_TREE_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        if constexpr (_HseHz != 0)
+        {
+            if (Private::IsReadyInterrupt(Private::HseReady))
+            {
+                Private::DisableReadyInterrupt(Private::HseReady);
+                Private::EnableReadyInterrupt(Private::PllReady);
+                RccCrReg::Or(RCC_CR_PLLON);
+            }
+        }
+
+        if (!Private::IsReadyInterrupt(Private::PllReady))
+            return;
+
+        Private::DisableReadyInterrupt(Private::PllReady);
+        NVIC_DisableIRQ(RCC_IRQn);
+
+        // PLL is locked, so switch doesn't wait, subscribers are re-timed by switch
+        Flash::OptimiseForFrequency<_SysHz>();
+        SysClock::ErrorCode result = SysClock::SelectClockSource<SysClock::Pll>();
+        _ready = true;
+
+        if (_callback != nullptr)
+            _callback(result);
+    }
+}
+
+#endif //! ZHELE_CLOCK_TREE_IMPL_H
@@ -0,0 +1,124 @@
+/**
+ * @file
+ * Implements timer-locked control loop
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CONTROL_LOOP_IMPL_H
+#define ZHELE_CONTROL_LOOP_IMPL_H
+
+namespace Zhele
+{
+    #define CONTROL_LOOP_TEMPLATE_ARGS template<typename _Timer, unsigned long _Rate>
+    #define CONTROL_LOOP_TEMPLATE_QUALIFIER ControlLoop<_Timer, _Rate>
+
+    CONTROL_LOOP_TEMPLATE_ARGS
+    uint32_t CONTROL_LOOP_TEMPLATE_QUALIFIER::Init(StepType step)
+    {
+        _step = step;
+
+        _Timer::Enable();
+        _Timer::Stop();
+
+        // The smallest prescaler gives the best latency resolution
+        const uint32_t clockFreq = _Timer::GetClockFreq();
+        const uint32_t prescaler = (clockFreq / _Rate + 0xffff) / 0x10000;
+        const uint32_t period = clockFreq / prescaler / _Rate;
+        _Timer::SetPrescaler(prescaler - 1);
+        _Timer::SetPeriod(period - 1);
+        _tickFrequency = clockFreq / prescaler;
+
+        CycleCounter::Enable();
+        ResetStatistics();
+        return _tickFrequency / period;
+    }
+
+    CONTROL_LOOP_TEMPLATE_ARGS
+    void CONTROL_LOOP_TEMPLATE_QUALIFIER::Start()
+    {
+        _Timer::ResetCounterValue();
+        _Timer::ClearInterruptFlag();
+        _Timer::EnableInterrupt();
+        _Timer::Start();
+    }
+
+    CONTROL_LOOP_TEMPLATE_ARGS
+    void CONTROL_LOOP_TEMPLATE_QUALIFIER::Stop()
+    {
+        _Timer::Stop();
+        _Timer::DisableInterrupt();
+    }
+
+    CONTROL_LOOP_TEMPLATE_ARGS
+    ControlLoopStatistics CONTROL_LOOP_TEMPLATE_QUALIFIER::Statistics()
+    {
+        ControlLoopStatistics result;
+
+        // Consistent snapshot (statistics are updated in interrupt)
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        result.steps = _statistics.steps;
+        result.overruns = _statistics.overruns;
+        result.minLatency = _statistics.minLatency;
+        result.maxLatency = _statistics.maxLatency;
+        result.lastCycles = _statistics.lastCycles;
+        result.maxCycles = _statistics.maxCycles;
+        __set_PRIMASK(primask);
+
+        return result;
+    }
+
+    CONTROL_LOOP_TEMPLATE_ARGS
+    void CONTROL_LOOP_TEMPLATE_QUALIFIER::ResetStatistics()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        _statistics.steps = 0;
+        _statistics.overruns = 0;
+        _statistics.minLatency = UINT16_MAX;
+        _statistics.maxLatency = 0;
+        _statistics.lastCycles = 0;
+        _statistics.maxCycles = 0;
+        __set_PRIMASK(primask);
+    }
+
+    CONTROL_LOOP_TEMPLATE_ARGS
+    uint32_t CONTROL_LOOP_TEMPLATE_QUALIFIER::TickFrequency()
+    {
+        return _tickFrequency;
+    }
+
+    CONTROL_LOOP_TEMPLATE_ARGS
+    void CONTROL_LOOP_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        ZHELE_PROFILE_ISR();
+
+        // Up-counting counter is ticks count since update event
+        const uint16_t latency = static_cast<uint16_t>(_Timer::GetCounterValue());
+        const uint32_t start = CycleCounter::Read();
+        _Timer::ClearInterruptFlag();
+
+        if (_step)
+            _step();
+
+        const uint32_t cycles = CycleCounter::Elapsed(start, CycleCounter::Read());
+
+        // The next update has occurred during step
+        if (_Timer::IsInterrupt())
+            _statistics.overruns = _statistics.overruns + 1;
+
+        _statistics.steps = _statistics.steps + 1;
+        if (latency < _statistics.minLatency)
+            _statistics.minLatency = latency;
+        if (latency > _statistics.maxLatency)
+            _statistics.maxLatency = latency;
+        _statistics.lastCycles = cycles;
+        if (cycles > _statistics.maxCycles)
+            _statistics.maxCycles = cycles;
+    }
+}
+
+#endif //! ZHELE_CONTROL_LOOP_IMPL_H
@@ -0,0 +1,99 @@
+/**
+ * @file
+ * Implements timer-paced DAC waveform playback
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DAC_STREAMER_IMPL_H
+#define ZHELE_DAC_STREAMER_IMPL_H
+
+namespace Zhele
+{
+    #define DACSTREAMER_TEMPLATE_ARGS template<typename _Dac, typename _Timer, typename _DmaChannel>
+    #define DACSTREAMER_TEMPLATE_QUALIFIER DacStreamer<_Dac, _Timer, _DmaChannel>
+
+    DACSTREAMER_TEMPLATE_ARGS
+    void DACSTREAMER_TEMPLATE_QUALIFIER::Init(uint32_t sampleRate)
+    {
+        _Dac::Init(Trigger::Trigger);
+        _Dac::Enable();
+
+        _Timer::Enable();
+        _Timer::Stop();
+        SetSampleRate(sampleRate);
+        _Timer::SetMasterMode(_Timer::MasterMode::Update);
+    }
+
+    DACSTREAMER_TEMPLATE_ARGS
+    void DACSTREAMER_TEMPLATE_QUALIFIER::SetSampleRate(uint32_t sampleRate)
+    {
+        uint32_t divider = (_Timer::GetClockFreq() + sampleRate / 2) / sampleRate;
+        if (divider == 0)
+            divider = 1;
+
+        // The smallest prescaler gives the best resolution of period
+        uint32_t prescaler = (divider + 0xffff) / 0x10000;
+        _Timer::SetPrescaler(prescaler - 1);
+        _Timer::SetPeriod((divider + prescaler / 2) / prescaler - 1);
+    }
+
+    DACSTREAMER_TEMPLATE_ARGS
+    void DACSTREAMER_TEMPLATE_QUALIFIER::Play(const SampleType* table, uint16_t count)
+    {
+        _Timer::Stop();
+        _DmaChannel::Transfer(DmaBase::Mem2Periph | DmaBase::MemIncrement | DmaBase::Circular | DmaBase::PriorityHigh | SampleSize(),
+                            table, _Dac::DataRegister(), count);
+        Start();
+    }
+
+    DACSTREAMER_TEMPLATE_ARGS
+    void DACSTREAMER_TEMPLATE_QUALIFIER::Stream(SampleType* buffer, uint16_t blockSize, RefillCallback callback)
+    {
+        _Timer::Stop();
+        _refillCallback = callback;
+        _DmaChannel::SetDoubleBufferedTransferCallback(StreamHandler);
+        _DmaChannel::TransferDoubleBuffered(DmaBase::Mem2Periph | DmaBase::MemIncrement | DmaBase::PriorityHigh | SampleSize(),
+                            buffer, buffer + blockSize, _Dac::DataRegister(), blockSize);
+        Start();
+    }
+
+    DACSTREAMER_TEMPLATE_ARGS
+    DmaBase::Mode DACSTREAMER_TEMPLATE_QUALIFIER::SampleSize()
+    {
+        if constexpr (sizeof(SampleType) == 4)
+            return DmaBase::PSize32Bits | DmaBase::MSize32Bits;
+        else
+            return DmaBase::PSize16Bits | DmaBase::MSize16Bits;
+    }
+
+    DACSTREAMER_TEMPLATE_ARGS
+    void DACSTREAMER_TEMPLATE_QUALIFIER::Start()
+    {
+        _Dac::EnableDma();
+        _Timer::ResetCounterValue();
+        _Timer::Start();
+    }
+
+    DACSTREAMER_TEMPLATE_ARGS
+    void DACSTREAMER_TEMPLATE_QUALIFIER::Stop()
+    {
+        _Timer::Stop();
+        _Dac::DisableDma();
+        _DmaChannel::Disable();
+    }
+
+    DACSTREAMER_TEMPLATE_ARGS
+    void DACSTREAMER_TEMPLATE_QUALIFIER::StreamHandler(void* data, unsigned size, unsigned)
+    {
+        if (_refillCallback)
+            _refillCallback(static_cast<SampleType*>(data), size);
+    }
+
+    DACSTREAMER_TEMPLATE_ARGS
+    typename DACSTREAMER_TEMPLATE_QUALIFIER::RefillCallback DACSTREAMER_TEMPLATE_QUALIFIER::_refillCallback = nullptr;
+}
+
+#endif //! ZHELE_DAC_STREAMER_IMPL_H
@@ -0,0 +1,262 @@
+/**
+ * @file
+ * Implements ADC to SD card data logger pipeline
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DATA_LOGGER_IMPL_H
+#define ZHELE_DATA_LOGGER_IMPL_H
+
+#include <cstring>
+
+namespace Zhele
+{
+    #define DATA_LOGGER_TEMPLATE_ARGS template<typename _Sampler, typename _Card, uint16_t _BlockSamples, unsigned _RingSize, unsigned _BlocksPerWrite, LoggerEncoding _Encoding>
+    #define DATA_LOGGER_TEMPLATE_QUALIFIER DataLogger<_Sampler, _Card, _BlockSamples, _RingSize, _BlocksPerWrite, _Encoding>
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    constexpr unsigned DATA_LOGGER_TEMPLATE_QUALIFIER::RequiredRingSize(unsigned long bytesPerSecond, unsigned latencyMs)
+    {
+        uint64_t size = static_cast<uint64_t>(bytesPerSecond) * latencyMs / 1000
+            + _BlocksPerWrite * CardBlockSize + MaxFrameSize;
+        return static_cast<unsigned>((size + CardBlockSize - 1) / CardBlockSize * CardBlockSize);
+    }
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    unsigned DATA_LOGGER_TEMPLATE_QUALIFIER::EncodeFrame(const uint16_t* samples, uint16_t count, uint8_t channels, uint8_t* frame)
+    {
+        frame[0] = FrameMarker;
+        frame[1] = static_cast<uint8_t>(_Encoding);
+        frame[2] = static_cast<uint8_t>(count);
+        frame[3] = static_cast<uint8_t>(count >> 8);
+        uint8_t* out = frame + FrameHeaderSize;
+
+        if constexpr (_Encoding == LoggerEncoding::Raw)
+        {
+            for (uint16_t i = 0; i < count; ++i)
+            {
+                *out++ = static_cast<uint8_t>(samples[i]);
+                *out++ = static_cast<uint8_t>(samples[i] >> 8);
+            }
+        }
+        else
+        {
+            uint16_t previous[MaxChannels] = {};
+            uint8_t channel = 0;
+            for (uint16_t i = 0; i < count; ++i)
+            {
+                int32_t delta = static_cast<int32_t>(samples[i]) - previous[channel];
+                previous[channel] = samples[i];
+                // Zigzag: small negative differences are small codes too
+                out = WriteVarint(out, (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31));
+
+                if (++channel == channels)
+                    channel = 0;
+            }
+        }
+
+        return static_cast<unsigned>(out - frame);
+    }
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    template<typename... _Pins>
+    bool DATA_LOGGER_TEMPLATE_QUALIFIER::Start(uint32_t firstBlock, uint32_t blocksCount)
+    {
+        static_assert(sizeof...(_Pins) > 0 && sizeof...(_Pins) <= MaxChannels, "Invalid channels count");
+        static_assert(_BlockSamples % sizeof...(_Pins) == 0, "Block size must be multiple of channels count");
+
+        _channels = sizeof...(_Pins);
+        _ring.clear();
+        _block = firstBlock;
+        _lastBlock = firstBlock + blocksCount;
+        _writing = false;
+        _flushing = false;
+        _statistics = {};
+        _statistics.RingCapacity = _RingSize;
+
+        _sampling = true;
+        if (!_Sampler::template Start<_Pins...>(_samples, _BlockSamples, BlockHandler))
+        {
+            _sampling = false;
+            return false;
+        }
+
+        return true;
+    }
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    void DATA_LOGGER_TEMPLATE_QUALIFIER::Stop()
+    {
+        if (!_sampling)
+            return;
+
+        _Sampler::Stop();
+        _sampling = false;
+
+        Pad();
+        _flushing = true;
+    }
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    void DATA_LOGGER_TEMPLATE_QUALIFIER::Process()
+    {
+        if (_writing)
+        {
+            _Card::Process();
+            return;
+        }
+
+        if (_block >= _lastBlock)
+        {
+            if (_sampling)
+            {
+                _Sampler::Stop();
+                _sampling = false;
+            }
+            _ring.clear();
+            _flushing = false;
+            return;
+        }
+
+        // Ring is multiple of card block and reads are whole blocks, so readable region is block-aligned
+        auto data = _ring.readable_span();
+        uint32_t blocks = data.size() / CardBlockSize;
+        if (blocks == 0)
+        {
+            if (_flushing && _ring.empty())
+                _flushing = false;
+            return;
+        }
+
+        if (blocks > _BlocksPerWrite)
+            blocks = _BlocksPerWrite;
+        if (blocks > _lastBlock - _block)
+            blocks = _lastBlock - _block;
+
+        _writeBlocks = blocks;
+        _writing = true;
+        if (!_Card::WriteBlocks(data.data(), _block, blocks, WriteComplete))
+        {
+            _writing = false;
+            ++_statistics.WriteErrors;
+        }
+    }
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    bool DATA_LOGGER_TEMPLATE_QUALIFIER::IsRunning()
+    {
+        return _sampling || _flushing || _writing;
+    }
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    uint32_t DATA_LOGGER_TEMPLATE_QUALIFIER::CurrentBlock()
+    {
+        return _block;
+    }
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    typename DATA_LOGGER_TEMPLATE_QUALIFIER::Statistics DATA_LOGGER_TEMPLATE_QUALIFIER::GetStatistics()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        Statistics statistics = _statistics;
+        __set_PRIMASK(primask);
+
+        return statistics;
+    }
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    void DATA_LOGGER_TEMPLATE_QUALIFIER::ResetStatistics()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t adcOverruns = _statistics.AdcOverruns;
+        _statistics = {};
+        _statistics.RingCapacity = _RingSize;
+        _statistics.RingHighWaterMark = _ring.size();
+        _statistics.AdcOverruns = adcOverruns;
+        __set_PRIMASK(primask);
+    }
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    void DATA_LOGGER_TEMPLATE_QUALIFIER::BlockHandler(uint16_t* data, uint32_t count, uint32_t overruns)
+    {
+        if (!_sampling)
+            return;
+
+        _statistics.AdcOverruns = overruns;
+
+        uint16_t samples = static_cast<uint16_t>(count);
+        unsigned size = EncodeFrame(data, samples, _channels, _frame);
+
+        // Backpressure: whole frame is dropped (partial frame would break stream)
+        if (_RingSize - _ring.size() < size)
+        {
+            ++_statistics.DroppedFrames;
+            _statistics.DroppedSamples += samples;
+            return;
+        }
+
+        auto space = _ring.writable_span();
+        unsigned first = space.size() < size ? space.size() : size;
+        std::memcpy(space.data(), _frame, first);
+        _ring.commit(first);
+        if (first < size)
+        {
+            space = _ring.writable_span();
+            std::memcpy(space.data(), _frame + first, size - first);
+            _ring.commit(size - first);
+        }
+
+        _statistics.EncodedBytes += size;
+        _statistics.SamplesLogged += samples;
+
+        uint32_t used = _ring.size();
+        if (used > _statistics.RingHighWaterMark)
+            _statistics.RingHighWaterMark = used;
+    }
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    void DATA_LOGGER_TEMPLATE_QUALIFIER::WriteComplete(bool success)
+    {
+        if (success)
+        {
+            _ring.consume(_writeBlocks * CardBlockSize);
+            _block += _writeBlocks;
+            _statistics.BlocksWritten += _writeBlocks;
+        }
+        else
+        {
+            // Same blocks are written again by next Process call
+            ++_statistics.WriteErrors;
+        }
+
+        _writing = false;
+    }
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    void DATA_LOGGER_TEMPLATE_QUALIFIER::Pad()
+    {
+        // Ring size is multiple of block, so there is space for padding
+        unsigned padding = (CardBlockSize - _ring.size() % CardBlockSize) % CardBlockSize;
+        while (padding-- > 0)
+            _ring.push_back(0);
+    }
+
+    DATA_LOGGER_TEMPLATE_ARGS
+    uint8_t* DATA_LOGGER_TEMPLATE_QUALIFIER::WriteVarint(uint8_t* out, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            *out++ = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        *out++ = static_cast<uint8_t>(value);
+        return out;
+    }
+}
+
+#endif //! ZHELE_DATA_LOGGER_IMPL_H
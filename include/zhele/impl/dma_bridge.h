@@ -0,0 +1,151 @@
+/**
+ * @file
+ * Implements peripheral to peripheral DMA forwarding
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMA_BRIDGE_IMPL_H
+#define ZHELE_DMA_BRIDGE_IMPL_H
+
+namespace Zhele
+{
+    #define DMA_BRIDGE_TEMPLATE_ARGS template<Private::DmaBridgeSource _Source, Private::DmaBridgeSink _Sink, unsigned _RingSize, typename _SourceFrame, typename _SinkFrame>
+    #define DMA_BRIDGE_TEMPLATE_QUALIFIER DmaBridge<_Source, _Sink, _RingSize, _SourceFrame, _SinkFrame>
+
+    DMA_BRIDGE_TEMPLATE_ARGS
+    void DMA_BRIDGE_TEMPLATE_QUALIFIER::Start()
+    {
+        _written = 0;
+        _read = 0;
+        _chunk = 0;
+        _sending = false;
+        _forwarded = 0;
+        _overruns = 0;
+
+        SinkDma::SetTransferCallback(SinkHandler);
+        _Sink::EnableTxDma();
+
+        SourceDma::SetHalfTransferCallback(SourceHandler);
+        SourceDma::SetTransferCallback(SourceHandler);
+        _Source::EnableRxDma();
+        SourceDma::Transfer(SourceDma::Periph2Mem | SourceDma::MemIncrement | SourceDma::Circular | Private::DmaFrameSize<_SourceFrame>,
+            _ring, _Source::RxDataRegister(), _RingSize / sizeof(_SourceFrame));
+    }
+
+    DMA_BRIDGE_TEMPLATE_ARGS
+    void DMA_BRIDGE_TEMPLATE_QUALIFIER::Stop()
+    {
+        SourceDma::Disable();
+        _Source::EnableRxDma(false);
+        SourceDma::SetHalfTransferCallback(nullptr);
+        SourceDma::SetTransferCallback(nullptr);
+
+        SinkDma::Disable();
+        _Sink::EnableTxDma(false);
+        SinkDma::SetTransferCallback(nullptr);
+
+        _sending = false;
+    }
+
+    DMA_BRIDGE_TEMPLATE_ARGS
+    void DMA_BRIDGE_TEMPLATE_QUALIFIER::Flush()
+    {
+        Pump();
+    }
+
+    DMA_BRIDGE_TEMPLATE_ARGS
+    uint32_t DMA_BRIDGE_TEMPLATE_QUALIFIER::Forwarded()
+    {
+        return _forwarded;
+    }
+
+    DMA_BRIDGE_TEMPLATE_ARGS
+    uint32_t DMA_BRIDGE_TEMPLATE_QUALIFIER::Overruns()
+    {
+        return _overruns;
+    }
+
+    DMA_BRIDGE_TEMPLATE_ARGS
+    uint32_t DMA_BRIDGE_TEMPLATE_QUALIFIER::WritePosition()
+    {
+        uint32_t offset = _RingSize - SourceDma::RemainingTransfers() * sizeof(_SourceFrame);
+        uint32_t position = _written - _written % _RingSize + offset;
+
+        // DMA counter is behind last position only if source has wrapped ring
+        if (position < _written)
+            position += _RingSize;
+
+        _written = position;
+        return position;
+    }
+
+    DMA_BRIDGE_TEMPLATE_ARGS
+    void DMA_BRIDGE_TEMPLATE_QUALIFIER::Pump()
+    {
+        // Source and sink interrupts may have different priorities
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        uint32_t write = WritePosition();
+
+        if (!_sending)
+        {
+            // Unsent data is overwritten: skip it
+            if (write - _read > _RingSize)
+            {
+                ++_overruns;
+                _read = write;
+            }
+
+            uint32_t available = (write - _read) / sizeof(_SinkFrame) * sizeof(_SinkFrame);
+            uint32_t offset = _read % _RingSize;
+            uint32_t chunk = available < _RingSize - offset ? available : _RingSize - offset;
+
+            if (chunk > 0)
+            {
+                _chunk = chunk;
+                _sending = true;
+                _forwarded += chunk;
+                SinkDma::Transfer(SinkDma::Mem2Periph | SinkDma::MemIncrement | Private::DmaFrameSize<_SinkFrame>,
+                    _ring + offset, _Sink::TxDataRegister(), chunk / sizeof(_SinkFrame));
+            }
+        }
+
+        __set_PRIMASK(primask);
+    }
+
+    DMA_BRIDGE_TEMPLATE_ARGS
+    void DMA_BRIDGE_TEMPLATE_QUALIFIER::SourceHandler([[maybe_unused]] void* data, [[maybe_unused]] unsigned size, [[maybe_unused]] bool success)
+    {
+        Pump();
+    }
+
+    DMA_BRIDGE_TEMPLATE_ARGS
+    void DMA_BRIDGE_TEMPLATE_QUALIFIER::SinkHandler([[maybe_unused]] void* data, [[maybe_unused]] unsigned size, [[maybe_unused]] bool success)
+    {
+        _read += _chunk;
+        _sending = false;
+        Pump();
+    }
+
+    template<Private::DmaBridgeSource _Source, Private::DmaBridgeSink _Sink, typename _Frame>
+    void DirectDmaBridge<_Source, _Sink, _Frame>::Start()
+    {
+        _Source::EnableRxDma();
+        // Both addresses are fixed: memory address is sink data register
+        SourceDma::Transfer(SourceDma::Periph2Mem | SourceDma::Circular | Private::DmaFrameSize<_Frame>,
+            const_cast<const void*>(_Sink::TxDataRegister()), _Source::RxDataRegister(), 1);
+    }
+
+    template<Private::DmaBridgeSource _Source, Private::DmaBridgeSink _Sink, typename _Frame>
+    void DirectDmaBridge<_Source, _Sink, _Frame>::Stop()
+    {
+        SourceDma::Disable();
+        _Source::EnableRxDma(false);
+    }
+}
+
+#endif //! ZHELE_DMA_BRIDGE_IMPL_H
@@ -0,0 +1,251 @@
+/**
+ * @file
+ * Implements fixed-point (Q15, Q31) FIR and biquad filters
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DSP_IMPL_H
+#define ZHELE_DSP_IMPL_H
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace Zhele::Dsp
+{
+    namespace Private
+    {
+        /// Fractional bits of Q format
+        template<typename _Sample>
+        constexpr unsigned FractionalBits = sizeof(_Sample) * 8 - 1;
+
+        template<typename _Sample>
+        constexpr _Sample ToFixed(double value)
+        {
+            constexpr double scale = static_cast<double>(1ull << FractionalBits<_Sample>);
+            const double scaled = value * scale;
+            if (scaled >= scale - 1)
+                return std::numeric_limits<_Sample>::max();
+            if (scaled <= -scale)
+                return std::numeric_limits<_Sample>::min();
+            return static_cast<_Sample>(scaled >= 0 ? scaled + 0.5 : scaled - 0.5);
+        }
+
+        /**
+         * @brief Rounds, shifts and saturates accumulator
+         */
+        template<typename _Sample>
+        inline _Sample Narrow(int64_t accumulator, unsigned shift)
+        {
+            if (shift > 0)
+                accumulator = (accumulator + (int64_t(1) << (shift - 1))) >> shift;
+            return static_cast<_Sample>(std::clamp<int64_t>(accumulator, std::numeric_limits<_Sample>::min(), std::numeric_limits<_Sample>::max()));
+        }
+
+        inline int64_t Dot(const int16_t* first, const int16_t* second, unsigned count)
+        {
+            int64_t accumulator = 0;
+            unsigned i = 0;
+#if defined (__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+            // Two products per instruction
+            for (; i + 1 < count; i += 2)
+            {
+                uint32_t firstPair, secondPair;
+                std::memcpy(&firstPair, &first[i], sizeof(firstPair));
+                std::memcpy(&secondPair, &second[i], sizeof(secondPair));
+                accumulator = static_cast<int64_t>(__SMLALD(firstPair, secondPair, static_cast<uint64_t>(accumulator)));
+            }
+#endif
+            for (; i < count; ++i)
+            {
+                accumulator += static_cast<int32_t>(first[i]) * second[i];
+            }
+            return accumulator;
+        }
+
+        inline int64_t Dot(const int32_t* first, const int32_t* second, unsigned count)
+        {
+            int64_t accumulator = 0;
+            for (unsigned i = 0; i < count; ++i)
+            {
+                accumulator += static_cast<int64_t>(first[i]) * second[i];
+            }
+            return accumulator;
+        }
+
+        /**
+         * @brief Returns a * x + b * y for adjacent pairs {a, b} and {x, y}
+         */
+        inline int64_t MultiplyPairs(const int16_t* coefficients, const int16_t* samples, int64_t accumulator)
+        {
+#if defined (__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+            uint32_t coefficientsPair, samplesPair;
+            std::memcpy(&coefficientsPair, coefficients, sizeof(coefficientsPair));
+            std::memcpy(&samplesPair, samples, sizeof(samplesPair));
+            return static_cast<int64_t>(__SMLALD(coefficientsPair, samplesPair, static_cast<uint64_t>(accumulator)));
+#else
+            return accumulator + static_cast<int32_t>(coefficients[0]) * samples[0] + static_cast<int32_t>(coefficients[1]) * samples[1];
+#endif
+        }
+
+        inline int64_t MultiplyPairs(const int32_t* coefficients, const int32_t* samples, int64_t accumulator)
+        {
+            return accumulator + static_cast<int64_t>(coefficients[0]) * samples[0] + static_cast<int64_t>(coefficients[1]) * samples[1];
+        }
+    }
+
+    constexpr int16_t ToQ15(double value)
+    {
+        return Private::ToFixed<int16_t>(value);
+    }
+
+    constexpr int32_t ToQ31(double value)
+    {
+        return Private::ToFixed<int32_t>(value);
+    }
+
+    template<typename _Sample, unsigned _Taps>
+    Fir<_Sample, _Taps>::Fir(std::span<const _Sample, _Taps> coefficients)
+        : _coefficients(coefficients.data())
+    {
+        Reset();
+    }
+
+    template<typename _Sample, unsigned _Taps>
+    void Fir<_Sample, _Taps>::Reset()
+    {
+        std::fill(std::begin(_delay), std::end(_delay), 0);
+        _position = 0;
+    }
+
+    template<typename _Sample, unsigned _Taps>
+    void Fir<_Sample, _Taps>::Push(_Sample sample)
+    {
+        // Delay line grows down: window [_position, _position + _Taps) is from the newest sample to the oldest
+        _position = _position == 0 ? _Taps - 1 : _position - 1;
+        _delay[_position] = sample;
+        _delay[_position + _Taps] = sample;
+    }
+
+    template<typename _Sample, unsigned _Taps>
+    _Sample Fir<_Sample, _Taps>::Output() const
+    {
+        return Private::Narrow<_Sample>(Private::Dot(_coefficients, &_delay[_position], _Taps), Private::FractionalBits<_Sample>);
+    }
+
+    template<typename _Sample, unsigned _Taps>
+    _Sample Fir<_Sample, _Taps>::Process(_Sample sample)
+    {
+        Push(sample);
+        return Output();
+    }
+
+    template<typename _Sample, unsigned _Taps>
+    size_t Fir<_Sample, _Taps>::Process(std::span<const _Sample> input, std::span<_Sample> output)
+    {
+        const size_t count = std::min(input.size(), output.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            Push(input[i]);
+            output[i] = Output();
+        }
+        return count;
+    }
+
+    template<typename _Sample, unsigned _Taps, unsigned _Factor>
+    FirDecimator<_Sample, _Taps, _Factor>::FirDecimator(std::span<const _Sample, _Taps> coefficients)
+        : Base(coefficients)
+        , _phase(0)
+    {
+    }
+
+    template<typename _Sample, unsigned _Taps, unsigned _Factor>
+    void FirDecimator<_Sample, _Taps, _Factor>::Reset()
+    {
+        Base::Reset();
+        _phase = 0;
+    }
+
+    template<typename _Sample, unsigned _Taps, unsigned _Factor>
+    size_t FirDecimator<_Sample, _Taps, _Factor>::Process(std::span<const _Sample> input, std::span<_Sample> output)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < input.size(); ++i)
+        {
+            Base::Push(input[i]);
+            if (++_phase < _Factor)
+                continue;
+
+            _phase = 0;
+            if (count < output.size())
+                output[count++] = Base::Output();
+        }
+        return count;
+    }
+
+    template<typename _Sample>
+    constexpr BiquadCoefficients<_Sample> BiquadCoefficients<_Sample>::From(double b0, double b1, double b2, double a1, double a2, unsigned postShift)
+    {
+        const double scale = static_cast<double>(1u << postShift);
+        return {
+            Private::ToFixed<_Sample>(b0 / scale),
+            Private::ToFixed<_Sample>(b1 / scale),
+            Private::ToFixed<_Sample>(b2 / scale),
+            Private::ToFixed<_Sample>(a1 / scale),
+            Private::ToFixed<_Sample>(a2 / scale),
+        };
+    }
+
+    template<typename _Sample, unsigned _Stages>
+    BiquadCascade<_Sample, _Stages>::BiquadCascade(std::span<const Coefficients, _Stages> coefficients, unsigned postShift)
+        : _coefficients(coefficients.data())
+        , _shift(Private::FractionalBits<_Sample> - postShift)
+    {
+        Reset();
+    }
+
+    template<typename _Sample, unsigned _Stages>
+    void BiquadCascade<_Sample, _Stages>::Reset()
+    {
+        std::fill(std::begin(_state), std::end(_state), State{});
+    }
+
+    template<typename _Sample, unsigned _Stages>
+    size_t BiquadCascade<_Sample, _Stages>::Process(std::span<const _Sample> input, std::span<_Sample> output)
+    {
+        const size_t count = std::min(input.size(), output.size());
+        const _Sample* source = input.data();
+
+        for (unsigned stage = 0; stage < _Stages; ++stage)
+        {
+            const Coefficients& coefficients = _coefficients[stage];
+            State state = _state[stage];
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const _Sample sample = source[i];
+                // b1, b2 and a1, a2 are adjacent as x1, x2 and y1, y2 are
+                int64_t accumulator = static_cast<int64_t>(coefficients.b0) * sample;
+                accumulator = Private::MultiplyPairs(&coefficients.b1, &state.x1, accumulator);
+                accumulator = Private::MultiplyPairs(&coefficients.a1, &state.y1, accumulator);
+
+                const _Sample result = Private::Narrow<_Sample>(accumulator, _shift);
+                state.x2 = state.x1;
+                state.x1 = sample;
+                state.y2 = state.y1;
+                state.y1 = result;
+                output[i] = result;
+            }
+
+            _state[stage] = state;
+            // Next stages filter output in place
+            source = output.data();
+        }
+        return count;
+    }
+}
+
+#endif //! ZHELE_DSP_IMPL_H
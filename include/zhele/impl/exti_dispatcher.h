@@ -0,0 +1,157 @@
+/**
+ * @file
+ * Implements compile-time EXTI interrupts dispatcher
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_EXTI_DISPATCHER_IMPL_H
+#define ZHELE_EXTI_DISPATCHER_IMPL_H
+
+namespace Zhele
+{
+    namespace Private
+    {
+        /**
+         * @brief Returns pending EXTI lines
+         *
+         * @returns Pending lines mask
+         */
+        inline uint32_t ExtiPendingLines()
+        {
+        #if defined (STM32G0)
+            return EXTI->RPR1 | EXTI->FPR1;
+        #elif defined (STM32L4)
+            return EXTI->PR1;
+        #else
+            return EXTI->PR;
+        #endif
+        }
+
+        /**
+         * @brief Clears pending EXTI lines
+         *
+         * @param [in] lines Lines mask
+         *
+         * @par Returns
+         *  Nothing
+         */
+        inline void ExtiClearPendingLines(uint32_t lines)
+        {
+        #if defined (STM32G0)
+            EXTI->RPR1 = lines;
+            EXTI->FPR1 = lines;
+        #elif defined (STM32L4)
+            EXTI->PR1 = lines;
+        #else
+            EXTI->PR = lines;
+        #endif
+        }
+
+        /**
+         * @brief Masks or unmasks EXTI line interrupt (NVIC is not changed)
+         *
+         * @param [in] line Line
+         * @param [in] enable Unmask line
+         *
+         * @par Returns
+         *  Nothing
+         */
+        inline void ExtiSetLineInterrupt(uint8_t line, bool enable)
+        {
+        #if defined (STM32L4)
+            volatile uint32_t& imr = EXTI->IMR1;
+        #else
+            volatile uint32_t& imr = EXTI->IMR;
+        #endif
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            imr = enable ? (imr | (1u << line)) : (imr & ~(1u << line));
+            __set_PRIMASK(primask);
+        }
+    }
+
+    template<typename _Exti, std::add_pointer_t<void()> _Handler>
+    void ExtiHandler<_Exti, _Handler>::Handle()
+    {
+        _Handler();
+    }
+
+    #define DEBOUNCED_EXTI_HANDLER_TEMPLATE_ARGS template<typename _Exti, std::add_pointer_t<void()> _Handler, typename _Wheel, uint32_t _Ticks>
+    #define DEBOUNCED_EXTI_HANDLER_TEMPLATE_QUALIFIER DebouncedExtiHandler<_Exti, _Handler, _Wheel, _Ticks>
+
+    DEBOUNCED_EXTI_HANDLER_TEMPLATE_ARGS
+    typename _Wheel::Task DEBOUNCED_EXTI_HANDLER_TEMPLATE_QUALIFIER::_task(DEBOUNCED_EXTI_HANDLER_TEMPLATE_QUALIFIER::Rearm);
+
+    DEBOUNCED_EXTI_HANDLER_TEMPLATE_ARGS
+    void DEBOUNCED_EXTI_HANDLER_TEMPLATE_QUALIFIER::Handle()
+    {
+        Private::ExtiSetLineInterrupt(_Exti::Line, false);
+        _Wheel::Start(_task, _Ticks);
+        _Handler();
+    }
+
+    DEBOUNCED_EXTI_HANDLER_TEMPLATE_ARGS
+    void DEBOUNCED_EXTI_HANDLER_TEMPLATE_QUALIFIER::Rearm()
+    {
+        // Drop bounces latched while line was masked
+        Private::ExtiClearPendingLines(1u << _Exti::Line);
+        Private::ExtiSetLineInterrupt(_Exti::Line, true);
+    }
+
+    template<typename... _Handlers>
+    void ExtiDispatcher<_Handlers...>::EnableInterrupts()
+    {
+        (_Handlers::Exti::EnableInterrupt(), ...);
+    }
+
+    template<typename... _Handlers>
+    void ExtiDispatcher<_Handlers...>::DisableInterrupts()
+    {
+        (_Handlers::Exti::DisableInterrupt(), ...);
+    }
+
+    template<typename... _Handlers>
+    template<IRQn_Type _IRQn>
+    void ExtiDispatcher<_Handlers...>::IrqHandler()
+    {
+        constexpr uint32_t mask = VectorMask<_IRQn>;
+        static_assert(mask != 0, "Dispatcher has no handlers for this vector");
+
+        uint32_t pending = Private::ExtiPendingLines() & mask;
+        Private::ExtiClearPendingLines(pending);
+
+        if constexpr (std::has_single_bit(mask))
+        {
+            if (pending != 0)
+                Table[std::countr_zero(mask)]();
+        }
+        else
+        {
+            Dispatch(pending);
+        }
+    }
+
+    template<typename... _Handlers>
+    void ExtiDispatcher<_Handlers...>::IrqHandler()
+    {
+        uint32_t pending = Private::ExtiPendingLines() & LinesMask;
+        Private::ExtiClearPendingLines(pending);
+        Dispatch(pending);
+    }
+
+    template<typename... _Handlers>
+    void ExtiDispatcher<_Handlers...>::Dispatch(uint32_t pending)
+    {
+        while (pending != 0)
+        {
+            unsigned line = 31 - std::countl_zero(pending);
+            pending &= ~(1u << line);
+            Table[line]();
+        }
+    }
+}
+
+#endif //! ZHELE_EXTI_DISPATCHER_IMPL_H
@@ -0,0 +1,442 @@
+/**
+ * @file
+ * Implements real FFT (Q15 and float), windows and spectrum analysis
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_FFT_IMPL_H
+#define ZHELE_FFT_IMPL_H
+
+#include <zhele/waveform.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace Zhele::Dsp
+{
+    namespace Private
+    {
+        using Waveform::Private::Pi;
+
+        constexpr double Cos(double x)
+        {
+            return Waveform::Private::Sin(x + Pi / 2);
+        }
+
+        template<typename _Sample>
+        constexpr _Sample FromDouble(double value)
+        {
+            if constexpr (std::is_floating_point_v<_Sample>)
+                return static_cast<_Sample>(value);
+            else
+                return ToFixed<_Sample>(value);
+        }
+
+        /**
+         * @brief Twiddle table W^k = exp(-2 * pi * i * k / _Size), k < _Size / 2
+         */
+        template<typename _Sample, size_t _Size>
+        constexpr std::array<Complex<_Sample>, _Size / 2> MakeTwiddles()
+        {
+            std::array<Complex<_Sample>, _Size / 2> twiddles{};
+            for (size_t k = 0; k < _Size / 2; ++k)
+            {
+                const double angle = 2 * Pi * static_cast<double>(k) / static_cast<double>(_Size);
+                twiddles[k] = {FromDouble<_Sample>(Cos(angle)), FromDouble<_Sample>(-Waveform::Private::Sin(angle))};
+            }
+            return twiddles;
+        }
+
+        template<typename _Sample, size_t _Size>
+        constexpr std::array<Complex<_Sample>, _Size / 2> Twiddles = MakeTwiddles<_Sample, _Size>();
+
+        inline int16_t Negate(int16_t value)
+        {
+            return value == std::numeric_limits<int16_t>::min() ? std::numeric_limits<int16_t>::max() : static_cast<int16_t>(-value);
+        }
+
+        inline float Negate(float value)
+        {
+            return -value;
+        }
+
+        template<typename _Sample>
+        Complex<_Sample> Conjugate(Complex<_Sample> value)
+        {
+            return {value.re, Negate(value.im)};
+        }
+
+#if defined (__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+        // Q15 complex is packed as re (low halfword) and im (high halfword)
+        inline uint32_t Pack(Complex<int16_t> value)
+        {
+            uint32_t packed;
+            std::memcpy(&packed, &value, sizeof(packed));
+            return packed;
+        }
+
+        inline Complex<int16_t> Unpack(uint32_t packed)
+        {
+            Complex<int16_t> value;
+            std::memcpy(&value, &packed, sizeof(packed));
+            return value;
+        }
+
+        inline Complex<int16_t> Multiply(Complex<int16_t> value, Complex<int16_t> twiddle)
+        {
+            const uint32_t first = Pack(value);
+            const uint32_t second = Pack(twiddle);
+            return {static_cast<int16_t>(__SMUSD(first, second) >> 15), static_cast<int16_t>(__SMUADX(first, second) >> 15)};
+        }
+
+        // Q15 sums are halved (scaled stage)
+        inline Complex<int16_t> Add(Complex<int16_t> first, Complex<int16_t> second)
+        {
+            return Unpack(__SHADD16(Pack(first), Pack(second)));
+        }
+
+        inline Complex<int16_t> Subtract(Complex<int16_t> first, Complex<int16_t> second)
+        {
+            return Unpack(__SHSUB16(Pack(first), Pack(second)));
+        }
+
+        // first + (-i) * second
+        inline Complex<int16_t> AddRotated(Complex<int16_t> first, Complex<int16_t> second)
+        {
+            return Unpack(__SHSAX(Pack(first), Pack(second)));
+        }
+
+        // first - (-i) * second
+        inline Complex<int16_t> SubtractRotated(Complex<int16_t> first, Complex<int16_t> second)
+        {
+            return Unpack(__SHASX(Pack(first), Pack(second)));
+        }
+#else
+        inline Complex<int16_t> Multiply(Complex<int16_t> value, Complex<int16_t> twiddle)
+        {
+            const int32_t re = static_cast<int32_t>(value.re) * twiddle.re - static_cast<int32_t>(value.im) * twiddle.im;
+            const int32_t im = static_cast<int32_t>(value.re) * twiddle.im + static_cast<int32_t>(value.im) * twiddle.re;
+            return {static_cast<int16_t>(re >> 15), static_cast<int16_t>(im >> 15)};
+        }
+
+        inline int16_t Half(int32_t value)
+        {
+            return static_cast<int16_t>(value >> 1);
+        }
+
+        inline Complex<int16_t> Add(Complex<int16_t> first, Complex<int16_t> second)
+        {
+            return {Half(first.re + second.re), Half(first.im + second.im)};
+        }
+
+        inline Complex<int16_t> Subtract(Complex<int16_t> first, Complex<int16_t> second)
+        {
+            return {Half(first.re - second.re), Half(first.im - second.im)};
+        }
+
+        inline Complex<int16_t> AddRotated(Complex<int16_t> first, Complex<int16_t> second)
+        {
+            return {Half(first.re + second.im), Half(first.im - second.re)};
+        }
+
+        inline Complex<int16_t> SubtractRotated(Complex<int16_t> first, Complex<int16_t> second)
+        {
+            return {Half(first.re - second.im), Half(first.im + second.re)};
+        }
+#endif
+
+        /// Halved sum (exact for both types)
+        inline Complex<int16_t> Average(Complex<int16_t> first, Complex<int16_t> second)
+        {
+            return Add(first, second);
+        }
+
+        /// Halved difference (exact for both types)
+        inline Complex<int16_t> HalfDifference(Complex<int16_t> first, Complex<int16_t> second)
+        {
+            return Subtract(first, second);
+        }
+
+        inline Complex<float> Multiply(Complex<float> value, Complex<float> twiddle)
+        {
+            return {value.re * twiddle.re - value.im * twiddle.im, value.re * twiddle.im + value.im * twiddle.re};
+        }
+
+        // Float stages are not scaled
+        inline Complex<float> Add(Complex<float> first, Complex<float> second)
+        {
+            return {first.re + second.re, first.im + second.im};
+        }
+
+        inline Complex<float> Subtract(Complex<float> first, Complex<float> second)
+        {
+            return {first.re - second.re, first.im - second.im};
+        }
+
+        inline Complex<float> AddRotated(Complex<float> first, Complex<float> second)
+        {
+            return {first.re + second.im, first.im - second.re};
+        }
+
+        inline Complex<float> SubtractRotated(Complex<float> first, Complex<float> second)
+        {
+            return {first.re - second.im, first.im + second.re};
+        }
+
+        inline Complex<float> Average(Complex<float> first, Complex<float> second)
+        {
+            return {(first.re + second.re) * 0.5f, (first.im + second.im) * 0.5f};
+        }
+
+        inline Complex<float> HalfDifference(Complex<float> first, Complex<float> second)
+        {
+            return {(first.re - second.re) * 0.5f, (first.im - second.im) * 0.5f};
+        }
+
+        inline int16_t ApplyWindow(int16_t sample, int16_t window)
+        {
+            return static_cast<int16_t>((static_cast<int32_t>(sample) * window) >> 15);
+        }
+
+        inline float ApplyWindow(float sample, float window)
+        {
+            return sample * window;
+        }
+
+        inline uint32_t SquaredMagnitude(Complex<int16_t> value)
+        {
+            return static_cast<uint32_t>(static_cast<int32_t>(value.re) * value.re) + static_cast<uint32_t>(static_cast<int32_t>(value.im) * value.im);
+        }
+
+        inline float SquaredMagnitude(Complex<float> value)
+        {
+            return value.re * value.re + value.im * value.im;
+        }
+
+        inline int16_t SquareRoot(uint32_t value)
+        {
+            // Bitwise integer square root
+            uint32_t result = 0;
+            uint32_t bit = 1u << 30;
+            while (bit > value)
+                bit >>= 2;
+            while (bit != 0)
+            {
+                if (value >= result + bit)
+                {
+                    value -= result + bit;
+                    result = (result >> 1) + bit;
+                }
+                else
+                {
+                    result >>= 1;
+                }
+                bit >>= 2;
+            }
+            return static_cast<int16_t>(std::min<uint32_t>(result, std::numeric_limits<int16_t>::max()));
+        }
+
+        inline float SquareRoot(float value)
+        {
+            return std::sqrt(value);
+        }
+    }
+
+    template<typename _Sample, size_t _Size>
+    consteval std::array<_Sample, _Size> MakeWindow(Window window)
+    {
+        std::array<_Sample, _Size> table{};
+        for (size_t n = 0; n < _Size; ++n)
+        {
+            // Periodic window (spectral analysis)
+            const double angle = 2 * Private::Pi * static_cast<double>(n) / static_cast<double>(_Size);
+            double value = 1;
+            switch (window)
+            {
+            case Window::Rectangular:
+                break;
+            case Window::Hann:
+                value = 0.5 - 0.5 * Private::Cos(angle);
+                break;
+            case Window::Hamming:
+                value = 0.54 - 0.46 * Private::Cos(angle);
+                break;
+            case Window::Blackman:
+                value = 0.42 - 0.5 * Private::Cos(angle) + 0.08 * Private::Cos(2 * angle);
+                break;
+            }
+            table[n] = Private::FromDouble<_Sample>(value);
+        }
+        return table;
+    }
+
+    template<typename _Sample, size_t _Size>
+    bool RealFft<_Sample, _Size>::Transform(std::span<const _Sample> input, std::span<ComplexType> output)
+    {
+        if (input.size() < _Size || output.size() < Bins)
+            return false;
+
+        Load(input.data(), nullptr, output.data());
+        Butterflies(output.data());
+        Split(output.data());
+        return true;
+    }
+
+    template<typename _Sample, size_t _Size>
+    bool RealFft<_Sample, _Size>::Transform(std::span<const _Sample> input, std::span<const _Sample, _Size> window, std::span<ComplexType> output)
+    {
+        if (input.size() < _Size || output.size() < Bins)
+            return false;
+
+        Load(input.data(), window.data(), output.data());
+        Butterflies(output.data());
+        Split(output.data());
+        return true;
+    }
+
+    template<typename _Sample, size_t _Size>
+    size_t RealFft<_Sample, _Size>::Magnitude(std::span<const ComplexType> spectrum, std::span<_Sample> output)
+    {
+        const size_t count = std::min(spectrum.size(), output.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            // Spectrum is read before output is written, so buffers can overlap
+            output[i] = Private::SquareRoot(Private::SquaredMagnitude(spectrum[i]));
+        }
+        return count;
+    }
+
+    template<typename _Sample, size_t _Size>
+    SpectrumPeak<_Sample> RealFft<_Sample, _Size>::FindPeak(std::span<const ComplexType> spectrum, size_t firstBin)
+    {
+        const size_t count = std::min(spectrum.size(), Bins);
+        if (firstBin >= count)
+            return {0, 0};
+
+        size_t peak = firstBin;
+        auto peakPower = Private::SquaredMagnitude(spectrum[firstBin]);
+        for (size_t i = firstBin + 1; i < count; ++i)
+        {
+            const auto power = Private::SquaredMagnitude(spectrum[i]);
+            if (power > peakPower)
+            {
+                peakPower = power;
+                peak = i;
+            }
+        }
+        return {peak, Private::SquareRoot(peakPower)};
+    }
+
+    template<typename _Sample, size_t _Size>
+    constexpr uint32_t RealFft<_Sample, _Size>::BinFrequency(size_t bin, uint32_t sampleRate)
+    {
+        return static_cast<uint32_t>(static_cast<uint64_t>(bin) * sampleRate / _Size);
+    }
+
+    template<typename _Sample, size_t _Size>
+    void RealFft<_Sample, _Size>::Load(const _Sample* input, const _Sample* window, ComplexType* output)
+    {
+        // Reversed index is incremented from the most significant bit
+        size_t reversed = 0;
+        for (size_t n = 0; n < Points; ++n)
+        {
+            ComplexType value = {input[2 * n], input[2 * n + 1]};
+            if (window != nullptr)
+            {
+                value.re = Private::ApplyWindow(value.re, window[2 * n]);
+                value.im = Private::ApplyWindow(value.im, window[2 * n + 1]);
+            }
+            output[reversed] = value;
+
+            size_t bit = Points >> 1;
+            while (bit != 0 && (reversed & bit) != 0)
+            {
+                reversed ^= bit;
+                bit >>= 1;
+            }
+            reversed |= bit;
+        }
+    }
+
+    template<typename _Sample, size_t _Size>
+    void RealFft<_Sample, _Size>::Butterflies(ComplexType* data)
+    {
+        // W_Points^m is Twiddles[2 * m]
+        constexpr auto& twiddles = Private::Twiddles<_Sample, _Size>;
+        size_t half = 1;
+
+        if constexpr ((std::countr_zero(Points) & 1) != 0)
+        {
+            // Odd stages count: radix-2 stage with unit twiddles
+            for (size_t i = 0; i < Points; i += 2)
+            {
+                const ComplexType first = data[i];
+                const ComplexType second = data[i + 1];
+                data[i] = Private::Add(first, second);
+                data[i + 1] = Private::Subtract(first, second);
+            }
+            half = 2;
+        }
+
+        // Radix-4 pass is radix-2 stages of half and 2 * half butterflies
+        for (; 4 * half <= Points; half *= 4)
+        {
+            const size_t stride = Points / half;
+            for (size_t j = 0; j < half; ++j)
+            {
+                const ComplexType inner = twiddles[j * stride];
+                const ComplexType outer = twiddles[j * stride / 2];
+                for (size_t group = j; group < Points; group += 4 * half)
+                {
+                    ComplexType* x = &data[group];
+
+                    const ComplexType x1 = Private::Multiply(x[half], inner);
+                    const ComplexType x3 = Private::Multiply(x[3 * half], inner);
+                    const ComplexType a0 = Private::Add(x[0], x1);
+                    const ComplexType a1 = Private::Subtract(x[0], x1);
+                    const ComplexType a2 = Private::Multiply(Private::Add(x[2 * half], x3), outer);
+                    const ComplexType a3 = Private::Multiply(Private::Subtract(x[2 * half], x3), outer);
+
+                    // Twiddle of the second pair is outer * (-i)
+                    x[0] = Private::Add(a0, a2);
+                    x[2 * half] = Private::Subtract(a0, a2);
+                    x[half] = Private::AddRotated(a1, a3);
+                    x[3 * half] = Private::SubtractRotated(a1, a3);
+                }
+            }
+        }
+    }
+
+    template<typename _Sample, size_t _Size>
+    void RealFft<_Sample, _Size>::Split(ComplexType* data)
+    {
+        // X[k] = E[k] - i * W^k * D[k], E and D are even and odd samples spectra
+        constexpr auto& twiddles = Private::Twiddles<_Sample, _Size>;
+
+        const ComplexType first = data[0];
+        data[0] = Private::Add(first, ComplexType{first.im, first.re});
+        data[0].im = 0;
+        data[Points] = Private::Subtract(first, ComplexType{first.im, first.re});
+        data[Points].im = 0;
+
+        for (size_t k = 1; k <= Points / 2; ++k)
+        {
+            const ComplexType direct = data[k];
+            const ComplexType mirrored = Private::Conjugate(data[Points - k]);
+            const ComplexType even = Private::Average(direct, mirrored);
+            const ComplexType odd = Private::Multiply(Private::HalfDifference(direct, mirrored), twiddles[k]);
+
+            data[k] = Private::AddRotated(even, odd);
+            data[Points - k] = Private::Conjugate(Private::SubtractRotated(even, odd));
+        }
+    }
+}
+
+#endif //! ZHELE_FFT_IMPL_H
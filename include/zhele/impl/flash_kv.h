@@ -0,0 +1,402 @@
+/**
+ * @file
+ * Implements log-structured key-value store in flash pages
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_FLASH_KV_IMPL_H
+#define ZHELE_FLASH_KV_IMPL_H
+
+namespace Zhele
+{
+    #define FLASHKV_TEMPLATE_ARGS template<unsigned _FirstPage, unsigned _PagesCount, unsigned _MaxKeys, typename _Flash>
+    #define FLASHKV_TEMPLATE_QUALIFIER FlashKvStore<_FirstPage, _PagesCount, _MaxKeys, _Flash>
+
+    FLASHKV_TEMPLATE_ARGS
+    bool FLASHKV_TEMPLATE_QUALIFIER::Init()
+    {
+        _count = 0;
+        _nextSequence = 1;
+        _head = NoPage;
+        _headOffset = PageSize;
+        _compactPage = NoPage;
+
+        bool result = true;
+        for(uint8_t page = 0; page < _PagesCount; ++page)
+        {
+            PageHeader header;
+            memcpy(&header, Data(page * PageSize), sizeof(header));
+            _sequences[page] = 0;
+
+            // Page with programmed (or partially erased) state is obsolete
+            if(header.Check == (header.Sequence ^ PageMagic) && header.State == ActiveState && header.Reserved == ActiveState && header.Sequence != 0)
+            {
+                _sequences[page] = header.Sequence;
+                if(header.Sequence >= _nextSequence)
+                    _nextSequence = header.Sequence + 1;
+                continue;
+            }
+
+            // Free page must be erased fully (page erase or head opening could be interrupted)
+            const uint8_t* data = Data(page * PageSize);
+            bool erased = true;
+            for(uint32_t i = 0; i < PageSize && erased; ++i)
+                erased = data[i] == 0xff;
+            if(!erased)
+                result = ErasePage(page) && result;
+        }
+
+        // Replay pages from the oldest one
+        for(uint32_t last = 0;;)
+        {
+            uint8_t page = NoPage;
+            for(uint8_t i = 0; i < _PagesCount; ++i)
+            {
+                if(_sequences[i] > last && (page == NoPage || _sequences[i] < _sequences[page]))
+                    page = i;
+            }
+            if(page == NoPage)
+                break;
+            last = _sequences[page];
+
+            uint32_t offset = sizeof(PageHeader);
+            while(offset < PageSize)
+            {
+                bool valid;
+                uint32_t next = ScanRecord(page, offset, valid);
+                if(next == offset)
+                    break;
+                if(valid)
+                {
+                    RecordHeader header;
+                    memcpy(&header, Data(page * PageSize + offset), sizeof(header));
+                    Apply(header.Key, header.Length, page * PageSize + offset);
+                }
+                offset = next;
+            }
+            _head = page;
+            _headOffset = offset;
+        }
+
+        if(_head == NoPage)
+            return OpenHead() && result;
+
+        // Compaction was interrupted: it's completed, so updates have spare page
+        if(FreePages() == 0)
+        {
+            _compactPage = OldestPage();
+            _compactOffset = sizeof(PageHeader);
+            while(_compactPage != NoPage && result)
+                result = CompactStep();
+        }
+        return result;
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    bool FLASHKV_TEMPLATE_QUALIFIER::Set(uint16_t key, const void* data, uint16_t size)
+    {
+        if(key == Erased || size > MaxValueSize)
+            return false;
+
+        // Unchanged value is not written
+        const Entry* entry = Find(key);
+        if(entry != nullptr && entry->Length == size && memcmp(Data(entry->Offset + sizeof(RecordHeader)), data, size) == 0)
+            return true;
+        if(entry == nullptr && _count >= _MaxKeys)
+            return false;
+
+        return Reserve(RecordSize(size)) && Append(key, size, data);
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    uint16_t FLASHKV_TEMPLATE_QUALIFIER::Get(uint16_t key, void* buffer, uint16_t size)
+    {
+        const Entry* entry = Find(key);
+        if(entry == nullptr)
+            return 0;
+
+        memcpy(buffer, Data(entry->Offset + sizeof(RecordHeader)), entry->Length < size ? entry->Length : size);
+        return entry->Length;
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    bool FLASHKV_TEMPLATE_QUALIFIER::Remove(uint16_t key)
+    {
+        if(Find(key) == nullptr)
+            return true;
+
+        return Reserve(RecordSize(0)) && Append(key, Tombstone, nullptr);
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    void FLASHKV_TEMPLATE_QUALIFIER::Process()
+    {
+        if(_compactPage == NoPage)
+        {
+            if(FreePages() >= 2)
+                return;
+            // Head page is compacted only when there is no other space
+            uint8_t oldest = OldestPage();
+            if(oldest == _head)
+                return;
+            _compactPage = oldest;
+            _compactOffset = sizeof(PageHeader);
+        }
+        CompactStep();
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    uint32_t FLASHKV_TEMPLATE_QUALIFIER::Crc32(uint32_t crc, const void* data, unsigned size)
+    {
+        static constexpr uint32_t table[16] = {
+            0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+            0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+        };
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for(unsigned i = 0; i < size; ++i)
+        {
+            crc ^= bytes[i];
+            crc = (crc >> 4) ^ table[crc & 0x0f];
+            crc = (crc >> 4) ^ table[crc & 0x0f];
+        }
+        return crc;
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    const typename FLASHKV_TEMPLATE_QUALIFIER::Entry* FLASHKV_TEMPLATE_QUALIFIER::Find(uint16_t key)
+    {
+        for(unsigned i = 0; i < _count; ++i)
+        {
+            if(_index[i].Key == key)
+                return &_index[i];
+        }
+        return nullptr;
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    unsigned FLASHKV_TEMPLATE_QUALIFIER::FreePages()
+    {
+        unsigned result = 0;
+        for(uint32_t sequence : _sequences)
+        {
+            if(sequence == 0)
+                ++result;
+        }
+        return result;
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    uint8_t FLASHKV_TEMPLATE_QUALIFIER::OldestPage()
+    {
+        uint8_t result = NoPage;
+        for(uint8_t page = 0; page < _PagesCount; ++page)
+        {
+            if(_sequences[page] != 0 && (result == NoPage || _sequences[page] < _sequences[result]))
+                result = page;
+        }
+        return result;
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    bool FLASHKV_TEMPLATE_QUALIFIER::ErasePage(uint8_t page)
+    {
+        _sequences[page] = 0;
+        return _Flash::ErasePage(_FirstPage + page);
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    uint32_t FLASHKV_TEMPLATE_QUALIFIER::ScanRecord(uint8_t page, uint32_t offset, bool& valid)
+    {
+        valid = false;
+        if(offset + sizeof(RecordHeader) > PageSize)
+            return PageSize;
+
+        const uint8_t* record = Data(page * PageSize + offset);
+        RecordHeader header;
+        memcpy(&header, record, sizeof(header));
+
+        if(header.Key == Erased && header.Length == Erased && header.Crc == 0xffffffff)
+            return offset;
+
+        // Header write was interrupted, so nothing is written after it
+        if(header.Key == Erased || header.Length == Erased || offset + RecordSize(header.Length) > PageSize)
+            return offset + Unit;
+
+        uint32_t crc = Crc32(0xffffffff, record, 4);
+        crc = Crc32(crc, record + sizeof(RecordHeader), header.Length & ~Tombstone);
+        valid = ~crc == header.Crc;
+        return offset + RecordSize(header.Length);
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    bool FLASHKV_TEMPLATE_QUALIFIER::Apply(uint16_t key, uint16_t length, uint32_t offset)
+    {
+        Entry* entry = const_cast<Entry*>(Find(key));
+        if(length & Tombstone)
+        {
+            if(entry != nullptr)
+                *entry = _index[--_count];
+            return true;
+        }
+
+        if(entry == nullptr)
+        {
+            if(_count >= _MaxKeys)
+                return false;
+            entry = &_index[_count++];
+            entry->Key = key;
+        }
+        entry->Length = length;
+        entry->Offset = offset;
+        return true;
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    bool FLASHKV_TEMPLATE_QUALIFIER::OpenHead()
+    {
+        // Pages are used in ring order (wear levelling)
+        uint8_t page = _head == NoPage ? 0 : (_head + 1) % _PagesCount;
+        for(unsigned i = 0; i < _PagesCount && _sequences[page] != 0; ++i)
+            page = (page + 1) % _PagesCount;
+        if(_sequences[page] != 0)
+            return false;
+
+        alignas(Unit) PageHeader header {_nextSequence, _nextSequence ^ PageMagic, ActiveState, ActiveState};
+        _head = page;
+        _headOffset = PageSize;
+        _sequences[page] = _nextSequence++;
+        // State unit stays erased (it's programmed before page erase)
+        if(!_Flash::WriteFlash(const_cast<uint8_t*>(Data(page * PageSize)), &header, Unit)
+            || memcmp(Data(page * PageSize), &header, Unit) != 0)
+            return false;
+
+        _headOffset = sizeof(PageHeader);
+        return true;
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    bool FLASHKV_TEMPLATE_QUALIFIER::Reserve(uint32_t size)
+    {
+        for(unsigned compactions = 0; HeadSpace() < size;)
+        {
+            // One erased page is kept for compaction
+            if(FreePages() > 1)
+            {
+                if(!OpenHead())
+                    return false;
+                continue;
+            }
+
+            if(compactions++ >= _PagesCount)
+                return false;
+
+            if(_compactPage == NoPage)
+            {
+                _compactPage = OldestPage();
+                _compactOffset = sizeof(PageHeader);
+                // Head page is compacted to spare page
+                if(_compactPage == _head && !OpenHead())
+                {
+                    _compactPage = NoPage;
+                    return false;
+                }
+            }
+            while(_compactPage != NoPage)
+            {
+                if(!CompactStep())
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    bool FLASHKV_TEMPLATE_QUALIFIER::Append(uint16_t key, uint16_t length, const void* data)
+    {
+        uint16_t size = length & ~Tombstone;
+        uint32_t offset = _head * PageSize + _headOffset;
+        uint8_t* record = const_cast<uint8_t*>(Data(offset));
+
+        alignas(Unit) RecordHeader header {key, length, 0};
+        header.Crc = ~Crc32(Crc32(0xffffffff, &header, 4), data, size);
+
+        // Space is skipped even on error (it can't be rewritten)
+        _headOffset += RecordSize(length);
+
+        // Header is written first: interrupted write gives record with wrong CRC
+        if(!_Flash::WriteFlash(record, &header, sizeof(header)) || memcmp(record, &header, sizeof(header)) != 0)
+            return false;
+        if(size > 0 && (!_Flash::WriteFlash(record + sizeof(header), data, size) || memcmp(record + sizeof(header), data, size) != 0))
+            return false;
+
+        return Apply(key, length, offset);
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    bool FLASHKV_TEMPLATE_QUALIFIER::CompactStep()
+    {
+        uint8_t page = _compactPage;
+        while(_compactOffset < PageSize)
+        {
+            bool valid;
+            uint32_t next = ScanRecord(page, _compactOffset, valid);
+            if(next == _compactOffset)
+                break;
+
+            uint32_t offset = page * PageSize + _compactOffset;
+            RecordHeader header;
+            memcpy(&header, Data(offset), sizeof(header));
+            const Entry* entry = valid ? Find(header.Key) : nullptr;
+            if(entry == nullptr || entry->Offset != offset)
+            {
+                // Old versions, tombstones and damaged records are dropped
+                _compactOffset = next;
+                continue;
+            }
+
+            uint32_t size = RecordSize(header.Length);
+            if(HeadSpace() < size && (FreePages() == 0 || !OpenHead()))
+                return false;
+            if(!Append(header.Key, header.Length, Data(offset + sizeof(RecordHeader))))
+                return false;
+            _compactOffset = next;
+            return true;
+        }
+
+        // All live records are copied: page is marked as obsolete, so it's not used after interrupted erase
+        alignas(Unit) uint32_t state[2] = {ObsoleteState, ObsoleteState};
+        _Flash::WriteFlash(const_cast<uint8_t*>(Data(page * PageSize + Unit)), state, sizeof(state));
+        _compactPage = NoPage;
+        return ErasePage(page);
+    }
+
+    FLASHKV_TEMPLATE_ARGS
+    typename FLASHKV_TEMPLATE_QUALIFIER::Entry FLASHKV_TEMPLATE_QUALIFIER::_index[_MaxKeys];
+
+    FLASHKV_TEMPLATE_ARGS
+    unsigned FLASHKV_TEMPLATE_QUALIFIER::_count = 0;
+
+    FLASHKV_TEMPLATE_ARGS
+    uint32_t FLASHKV_TEMPLATE_QUALIFIER::_sequences[_PagesCount];
+
+    FLASHKV_TEMPLATE_ARGS
+    uint32_t FLASHKV_TEMPLATE_QUALIFIER::_nextSequence = 1;
+
+    FLASHKV_TEMPLATE_ARGS
+    uint8_t FLASHKV_TEMPLATE_QUALIFIER::_head = FLASHKV_TEMPLATE_QUALIFIER::NoPage;
+
+    FLASHKV_TEMPLATE_ARGS
+    uint32_t FLASHKV_TEMPLATE_QUALIFIER::_headOffset = 0;
+
+    FLASHKV_TEMPLATE_ARGS
+    uint8_t FLASHKV_TEMPLATE_QUALIFIER::_compactPage = FLASHKV_TEMPLATE_QUALIFIER::NoPage;
+
+    FLASHKV_TEMPLATE_ARGS
+    uint32_t FLASHKV_TEMPLATE_QUALIFIER::_compactOffset = 0;
+}
+
+#endif //! ZHELE_FLASH_KV_IMPL_H
@@ -0,0 +1,497 @@
+/**
+ * @file
+ * Implements compact formatter with compile-time format string parsing
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_FORMAT_IMPL_H
+#define ZHELE_FORMAT_IMPL_H
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <tuple>
+
+namespace Zhele
+{
+    namespace Private
+    {
+        template<typename T>
+        struct IsFixed : std::false_type {};
+
+        template<unsigned _FractionalBits, typename T>
+        struct IsFixed<Fixed<_FractionalBits, T>> : std::true_type {};
+
+        /// Replacement field specification
+        struct FormatSpec
+        {
+            char Type = 0; ///< Conversion type (0 if omitted)
+            bool ZeroPad = false; ///< Pad with zeros instead of spaces
+            unsigned Width = 0; ///< Min field width
+            int Precision = -1; ///< Fractional digits count (-1 if omitted)
+        };
+
+        /// Format string segment: literal text or replacement field
+        struct FormatSegment
+        {
+            unsigned Offset = 0; ///< Literal offset in format string
+            unsigned Length = 0; ///< Literal length (0 for replacement field)
+            int Argument = -1; ///< Argument index (-1 for literal)
+            FormatSpec Spec; ///< Replacement field specification
+        };
+
+        /// Parsed format string
+        template<unsigned _Capacity>
+        struct ParsedFormat
+        {
+            std::array<FormatSegment, _Capacity> Segments {};
+            unsigned Count = 0; ///< Segments count
+            unsigned Arguments = 0; ///< Replacement fields count
+            bool Valid = true; ///< Format string is well-formed
+        };
+
+        /**
+         * @brief Parses format string
+         *
+         * @tparam _Format Format string
+         *
+         * @returns Parsed format
+         */
+        template<TemplateUtils::fixed_string _Format>
+        consteval ParsedFormat<_Format.Length + 1> ParseFormat()
+        {
+            ParsedFormat<_Format.Length + 1> result;
+            const char* text = _Format.Text;
+            const unsigned length = _Format.Length;
+
+            auto addLiteral = [&](unsigned offset, unsigned size) {
+                if (size == 0)
+                    return;
+                // Merge with previous literal if they are adjacent
+                if (result.Count > 0)
+                {
+                    FormatSegment& last = result.Segments[result.Count - 1];
+                    if (last.Argument < 0 && last.Offset + last.Length == offset)
+                    {
+                        last.Length += size;
+                        return;
+                    }
+                }
+                result.Segments[result.Count++] = {offset, size, -1, {}};
+            };
+
+            unsigned literalStart = 0;
+            unsigned i = 0;
+            while (i < length)
+            {
+                if (text[i] == '}')
+                {
+                    if (i + 1 >= length || text[i + 1] != '}')
+                    {
+                        result.Valid = false;
+                        return result;
+                    }
+                    addLiteral(literalStart, i + 1 - literalStart);
+                    i += 2;
+                    literalStart = i;
+                    continue;
+                }
+
+                if (text[i] != '{')
+                {
+                    ++i;
+                    continue;
+                }
+
+                if (i + 1 < length && text[i + 1] == '{')
+                {
+                    addLiteral(literalStart, i + 1 - literalStart);
+                    i += 2;
+                    literalStart = i;
+                    continue;
+                }
+
+                addLiteral(literalStart, i - literalStart);
+                ++i;
+
+                FormatSpec spec;
+                if (i < length && text[i] == ':')
+                {
+                    ++i;
+                    if (i < length && text[i] == '0')
+                    {
+                        spec.ZeroPad = true;
+                        ++i;
+                    }
+                    while (i < length && text[i] >= '0' && text[i] <= '9')
+                        spec.Width = spec.Width * 10 + (text[i++] - '0');
+                    if (i < length && text[i] == '.')
+                    {
+                        ++i;
+                        spec.Precision = 0;
+                        if (i >= length || text[i] < '0' || text[i] > '9')
+                        {
+                            result.Valid = false;
+                            return result;
+                        }
+                        while (i < length && text[i] >= '0' && text[i] <= '9')
+                            spec.Precision = spec.Precision * 10 + (text[i++] - '0');
+                    }
+                    if (i < length && text[i] != '}')
+                        spec.Type = text[i++];
+                }
+
+                if (i >= length || text[i] != '}'
+                    || (spec.Type != 0 && spec.Type != 'd' && spec.Type != 'x' && spec.Type != 'X' && spec.Type != 'b' && spec.Type != 'c')
+                    || spec.Width > 64 || spec.Precision > 9)
+                {
+                    result.Valid = false;
+                    return result;
+                }
+
+                result.Segments[result.Count++] = {0, 0, static_cast<int>(result.Arguments++), spec};
+                literalStart = ++i;
+            }
+
+            addLiteral(literalStart, length - literalStart);
+            return result;
+        }
+
+        /**
+         * @brief Returns argument max formatted length (without padding)
+         *
+         * @tparam T Argument type
+         *
+         * @param [in] spec Replacement field specification
+         *
+         * @returns Max length
+         */
+        template<typename T>
+        consteval unsigned FormatArgumentMaxSize(FormatSpec spec)
+        {
+            if constexpr (IsFixed<T>::value)
+            {
+                using Raw = decltype(T::Value);
+                const unsigned precision = spec.Precision < 0 ? 3 : spec.Precision;
+                const unsigned integerBits = sizeof(Raw) * 8 - T::FractionalBits;
+                // Decimal digits of 2^integerBits, sign and point
+                unsigned digits = 1;
+                for (uint64_t value = uint64_t(1) << integerBits; value >= 10; value /= 10)
+                    ++digits;
+                return digits + 1 + (precision > 0 ? precision + 1 : 0);
+            }
+            else
+            {
+                const unsigned bits = sizeof(T) * 8;
+                switch (spec.Type)
+                {
+                case 'c':
+                    return 1;
+                case 'x':
+                case 'X':
+                    return bits / 4;
+                case 'b':
+                    return bits;
+                default:
+                    if constexpr (std::is_same_v<T, char>)
+                        return 1;
+                    return std::numeric_limits<std::make_unsigned_t<T>>::digits10 + 2;
+                }
+            }
+        }
+
+        /**
+         * @brief Writes padding and digits to output
+         *
+         * @param [out] out Output
+         * @param [in] digits Digits
+         * @param [in] count Digits count
+         * @param [in] negative Write minus sign
+         * @param [in] width Min field width
+         * @param [in] zeroPad Pad with zeros instead of spaces
+         *
+         * @returns Output end
+         */
+        inline char* FormatPadded(char* out, const char* digits, unsigned count, bool negative, unsigned width, bool zeroPad)
+        {
+            unsigned length = count + (negative ? 1 : 0);
+            unsigned padding = width > length ? width - length : 0;
+
+            if (!zeroPad)
+            {
+                while (padding-- > 0)
+                    *out++ = ' ';
+                padding = 0;
+            }
+            if (negative)
+                *out++ = '-';
+            while (padding-- > 0)
+                *out++ = '0';
+            while (count-- > 0)
+                *out++ = *digits++;
+
+            return out;
+        }
+
+        /**
+         * @brief Converts unsigned value to decimal digits (backward)
+         *
+         * @param [in] end Digits buffer end
+         * @param [in] value Value
+         *
+         * @returns Digits start
+         */
+        inline char* FormatDecimalDigits(char* end, uint64_t value)
+        {
+            // 64-bit division is library call, so use it only while value does not fit 32 bits
+            while (value > std::numeric_limits<uint32_t>::max())
+            {
+                *--end = static_cast<char>('0' + value % 10);
+                value /= 10;
+            }
+            uint32_t low = static_cast<uint32_t>(value);
+            do
+            {
+                *--end = static_cast<char>('0' + low % 10);
+                low /= 10;
+            } while (low != 0);
+
+            return end;
+        }
+
+        /**
+         * @brief Writes integer
+         *
+         * @param [out] out Output
+         * @param [in] value Value magnitude (or two's complement for non-decimal conversions)
+         * @param [in] negative Value is negative (decimal only)
+         * @param [in] type Conversion type
+         * @param [in] width Min field width
+         * @param [in] zeroPad Pad with zeros instead of spaces
+         *
+         * @returns Output end
+         */
+        inline char* FormatInteger(char* out, uint64_t value, bool negative, char type, unsigned width, bool zeroPad)
+        {
+            char digits[64];
+            char* end = digits + sizeof(digits);
+            char* start = end;
+
+            if (type == 'x' || type == 'X')
+            {
+                const char* alphabet = type == 'x' ? "0123456789abcdef" : "0123456789ABCDEF";
+                do
+                {
+                    *--start = alphabet[value & 0x0f];
+                    value >>= 4;
+                } while (value != 0);
+            }
+            else if (type == 'b')
+            {
+                do
+                {
+                    *--start = static_cast<char>('0' + (value & 0x01));
+                    value >>= 1;
+                } while (value != 0);
+            }
+            else
+            {
+                start = FormatDecimalDigits(end, value);
+            }
+
+            return FormatPadded(out, start, static_cast<unsigned>(end - start), negative, width, zeroPad);
+        }
+
+        /**
+         * @brief Writes fixed-point value
+         *
+         * @param [out] out Output
+         * @param [in] value Raw value
+         * @param [in] fractionalBits Fractional bits count
+         * @param [in] precision Fractional digits count
+         * @param [in] width Min field width
+         * @param [in] zeroPad Pad with zeros instead of spaces
+         *
+         * @returns Output end
+         */
+        inline char* FormatFixed(char* out, int64_t value, unsigned fractionalBits, unsigned precision, unsigned width, bool zeroPad)
+        {
+            static constexpr uint32_t Pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+            const bool negative = value < 0;
+            const uint64_t magnitude = negative ? static_cast<uint64_t>(-value) : static_cast<uint64_t>(value);
+            const uint32_t scale = Pow10[precision];
+
+            // Value in 10^-precision units with rounding, magnitude < 2^32 and scale < 2^30, so product fits 64 bits
+            const uint64_t scaled = (magnitude * scale + (uint64_t(1) << (fractionalBits - 1))) >> fractionalBits;
+            const uint64_t integer = precision > 0 ? scaled / scale : scaled;
+            uint32_t fraction = static_cast<uint32_t>(scaled - integer * scale);
+
+            char digits[32];
+            char* end = digits + sizeof(digits);
+            char* start = end;
+            for (unsigned i = 0; i < precision; ++i)
+            {
+                *--start = static_cast<char>('0' + fraction % 10);
+                fraction /= 10;
+            }
+            if (precision > 0)
+                *--start = '.';
+            start = FormatDecimalDigits(start, integer);
+
+            return FormatPadded(out, start, static_cast<unsigned>(end - start), negative && scaled != 0, width, zeroPad);
+        }
+
+        /**
+         * @brief Writes one argument
+         *
+         * @tparam _Spec Replacement field specification
+         * @tparam T Argument type
+         *
+         * @param [out] out Output
+         * @param [in] value Argument
+         *
+         * @returns Output end
+         */
+        template<FormatSpec _Spec, typename T>
+        inline char* FormatArgument(char* out, T value)
+        {
+            if constexpr (IsFixed<T>::value)
+            {
+                static_assert(_Spec.Type == 0 || _Spec.Type == 'd', "Fixed-point value supports decimal conversion only");
+                return FormatFixed(out, value.Value, T::FractionalBits, _Spec.Precision < 0 ? 3 : _Spec.Precision, _Spec.Width, _Spec.ZeroPad);
+            }
+            else
+            {
+                static_assert((std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_enum_v<T>, "Unsupported format argument type");
+                static_assert(_Spec.Precision < 0, "Precision is supported for fixed-point values only");
+
+                if constexpr (std::is_enum_v<T>)
+                {
+                    return FormatArgument<_Spec>(out, static_cast<std::underlying_type_t<T>>(value));
+                }
+                else if constexpr (_Spec.Type == 'c' || (_Spec.Type == 0 && std::is_same_v<T, char>))
+                {
+                    out = FormatPadded(out, out, 0, false, _Spec.Width > 0 ? _Spec.Width - 1 : 0, false);
+                    *out++ = static_cast<char>(value);
+                    return out;
+                }
+                else
+                {
+                    using Unsigned = std::make_unsigned_t<T>;
+                    constexpr bool Decimal = _Spec.Type == 0 || _Spec.Type == 'd';
+                    const bool negative = Decimal && std::is_signed_v<T> && value < 0;
+                    const Unsigned magnitude = negative ? static_cast<Unsigned>(Unsigned(0) - static_cast<Unsigned>(value)) : static_cast<Unsigned>(value);
+                    return FormatInteger(out, magnitude, negative, Decimal ? 'd' : _Spec.Type, _Spec.Width, _Spec.ZeroPad);
+                }
+            }
+        }
+
+        template<TemplateUtils::fixed_string _Format>
+        constexpr auto ParsedFormatOf = ParseFormat<_Format>();
+
+        template<TemplateUtils::fixed_string _Format, typename... Args, size_t... _Indexes>
+        consteval size_t FormatMaxSize(std::index_sequence<_Indexes...>)
+        {
+            constexpr auto& parsed = ParsedFormatOf<_Format>;
+            using Arguments = std::tuple<Args...>;
+            size_t size = 0;
+
+            [[maybe_unused]] auto segmentSize = [&]<size_t _Index>() {
+                constexpr FormatSegment segment = parsed.Segments[_Index];
+                if constexpr (segment.Argument < 0)
+                {
+                    return segment.Length;
+                }
+                else
+                {
+                    const unsigned length = FormatArgumentMaxSize<std::tuple_element_t<segment.Argument, Arguments>>(segment.Spec);
+                    return length > segment.Spec.Width ? length : segment.Spec.Width;
+                }
+            };
+            ((size += segmentSize.template operator()<_Indexes>()), ...);
+
+            return size;
+        }
+
+        template<TemplateUtils::fixed_string _Format, typename... Args, size_t... _Indexes>
+        inline char* FormatSegments(char* out, std::index_sequence<_Indexes...>, Args... args)
+        {
+            constexpr auto& parsed = ParsedFormatOf<_Format>;
+            std::tuple<Args...> arguments {args...};
+
+            [[maybe_unused]] auto formatSegment = [&]<size_t _Index>() {
+                constexpr FormatSegment segment = parsed.Segments[_Index];
+                if constexpr (segment.Argument < 0)
+                {
+                    memcpy(out, _Format.Text + segment.Offset, segment.Length);
+                    out += segment.Length;
+                }
+                else
+                {
+                    out = FormatArgument<segment.Spec>(out, std::get<segment.Argument>(arguments));
+                }
+            };
+            (formatSegment.template operator()<_Indexes>(), ...);
+
+            return out;
+        }
+    }
+
+    template<TemplateUtils::fixed_string _Format, typename... Args>
+    constexpr size_t FormatMaxSize()
+    {
+        constexpr auto& parsed = Private::ParsedFormatOf<_Format>;
+        static_assert(parsed.Valid, "Invalid format string");
+        static_assert(parsed.Arguments == sizeof...(Args), "Format arguments count mismatch");
+
+        return Private::FormatMaxSize<_Format, Args...>(std::make_index_sequence<parsed.Count>{});
+    }
+
+    template<TemplateUtils::fixed_string _Format, typename... Args>
+    size_t FormatTo(char* buffer, Args... args)
+    {
+        constexpr auto& parsed = Private::ParsedFormatOf<_Format>;
+        static_assert(parsed.Valid, "Invalid format string");
+        static_assert(parsed.Arguments == sizeof...(Args), "Format arguments count mismatch");
+
+        return Private::FormatSegments<_Format>(buffer, std::make_index_sequence<parsed.Count>{}, args...) - buffer;
+    }
+
+    template<TemplateUtils::fixed_string _Format, Private::RingSink _Sink, typename... Args>
+    size_t Format(_Sink& sink, Args... args)
+    {
+        std::array<char, FormatMaxSize<_Format, Args...>()> text;
+        const size_t size = FormatTo<_Format>(text.data(), args...);
+        size_t count = 0;
+
+        while (count < size)
+        {
+            auto region = sink.writable_span();
+            if (region.empty())
+                break;
+
+            size_t chunk = region.size() < size - count ? region.size() : size - count;
+            memcpy(region.data(), text.data() + count, chunk);
+            sink.commit(static_cast<typename _Sink::size_type>(chunk));
+            count += chunk;
+        }
+
+        return count;
+    }
+
+    template<TemplateUtils::fixed_string _Format, Private::BulkWriteSource _Sink, typename... Args>
+    size_t Format(Args... args)
+    {
+        std::array<char, FormatMaxSize<_Format, Args...>()> text;
+        const size_t size = FormatTo<_Format>(text.data(), args...);
+        _Sink::Write(text.data(), size);
+
+        return size;
+    }
+}
+
+#endif //! ZHELE_FORMAT_IMPL_H
@@ -0,0 +1,161 @@
+/**
+ * @file
+ * Implements shared I2C bus with transaction queue
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_I2C_BUS_IMPL_H
+#define ZHELE_I2C_BUS_IMPL_H
+
+namespace Zhele
+{
+    #define I2CBUS_TEMPLATE_ARGS template<typename _I2c, unsigned _Depth>
+    #define I2CBUS_TEMPLATE_QUALIFIER I2cBus<_I2c, _Depth>
+
+    I2CBUS_TEMPLATE_ARGS
+    template<typename... Args>
+    void I2CBUS_TEMPLATE_QUALIFIER::Init(Args... args)
+    {
+        _I2c::Init(args...);
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    I2cStatus I2CBUS_TEMPLATE_QUALIFIER::WriteU8(uint16_t devAddr, uint16_t regAddr, uint8_t data, I2cOpts opts)
+    {
+        Wait();
+        return _I2c::WriteU8(devAddr, regAddr, data, opts);
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    I2cStatus I2CBUS_TEMPLATE_QUALIFIER::Write(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cOpts opts)
+    {
+        Wait();
+        return _I2c::Write(devAddr, regAddr, data, size, opts);
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    I2cStatus I2CBUS_TEMPLATE_QUALIFIER::WriteAsync(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cOpts opts, I2cCallback callback)
+    {
+        return Enqueue(I2cJob{devAddr, regAddr, const_cast<uint8_t*>(data), size, opts, I2cMode::Write, callback})
+            ? I2cStatus::Success
+            : I2cStatus::Busy;
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    ReadResult I2CBUS_TEMPLATE_QUALIFIER::ReadU8(uint16_t devAddr, uint16_t regAddr, I2cOpts opts)
+    {
+        Wait();
+        return _I2c::ReadU8(devAddr, regAddr, opts);
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    I2cStatus I2CBUS_TEMPLATE_QUALIFIER::Read(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts)
+    {
+        Wait();
+        return _I2c::Read(devAddr, regAddr, data, size, opts);
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    I2cStatus I2CBUS_TEMPLATE_QUALIFIER::EnableAsyncRead(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts, I2cCallback callback)
+    {
+        return Enqueue(I2cJob{devAddr, regAddr, data, size, opts, I2cMode::Read, callback})
+            ? I2cStatus::Success
+            : I2cStatus::Busy;
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    bool I2CBUS_TEMPLATE_QUALIFIER::Enqueue(const I2cJob& job)
+    {
+        bool result = true;
+
+        Lock();
+        if(!_busy)
+        {
+            _busy = true;
+            Run(job);
+        }
+        else
+        {
+            result = _queue.push_back(job);
+        }
+        Unlock();
+
+        return result;
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    bool I2CBUS_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _busy;
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    void I2CBUS_TEMPLATE_QUALIFIER::Wait()
+    {
+        while(_busy) ;
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    unsigned I2CBUS_TEMPLATE_QUALIFIER::Pending()
+    {
+        return _queue.size();
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    void I2CBUS_TEMPLATE_QUALIFIER::Run(I2cJob job)
+    {
+        _active = job;
+
+        I2cStatus status = job.mode == I2cMode::Read
+            ? _I2c::EnableAsyncRead(job.devAddr, job.regAddr, job.data, job.size, job.opts, JobHandler)
+            : _I2c::WriteAsync(job.devAddr, job.regAddr, job.data, job.size, job.opts, JobHandler);
+
+        // Job failed before transfer was started, so handler will not be called
+        if(status != I2cStatus::Success)
+            JobHandler(status);
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    void I2CBUS_TEMPLATE_QUALIFIER::RunNext()
+    {
+        if(_queue.empty())
+        {
+            _busy = false;
+            return;
+        }
+
+        I2cJob next = _queue.front();
+        _queue.pop_front();
+        Run(next);
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    void I2CBUS_TEMPLATE_QUALIFIER::JobHandler(I2cStatus status)
+    {
+        I2cCallback callback = _active.callback;
+
+        RunNext();
+
+        if(callback != nullptr)
+            callback(status);
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    void I2CBUS_TEMPLATE_QUALIFIER::Lock()
+    {
+        NVIC_DisableIRQ(DmaTx::IRQNumber);
+        NVIC_DisableIRQ(DmaRx::IRQNumber);
+    }
+
+    I2CBUS_TEMPLATE_ARGS
+    void I2CBUS_TEMPLATE_QUALIFIER::Unlock()
+    {
+        NVIC_EnableIRQ(DmaTx::IRQNumber);
+        NVIC_EnableIRQ(DmaRx::IRQNumber);
+    }
+}
+
+#endif //! ZHELE_I2C_BUS_IMPL_H
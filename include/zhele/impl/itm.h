@@ -0,0 +1,102 @@
+/**
+ * @file
+ * Implements ITM (SWO) trace output
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ITM_IMPL_H
+#define ZHELE_ITM_IMPL_H
+
+#include <cstring>
+
+namespace Zhele::Trace
+{
+    inline void Itm::Enable(uint32_t swoFrequency, uint32_t ports)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        // Asynchronous trace mode (SWO pin only)
+        DBGMCU->CR = (DBGMCU->CR & ~DBGMCU_CR_TRACE_MODE) | DBGMCU_CR_TRACE_IOEN;
+
+        // NRZ (UART) encoding, formatter bypass
+        TPI->SPPR = 2;
+        TPI->FFCR = 0x100;
+        SetSwoFrequency(swoFrequency);
+
+        ITM->LAR = 0xc5acce55;
+        ITM->TCR = (1 << ITM_TCR_TraceBusID_Pos) | ITM_TCR_SWOENA_Msk | ITM_TCR_SYNCENA_Msk | ITM_TCR_ITMENA_Msk;
+        ITM->TPR = 0;
+        ITM->TER = ports;
+    }
+
+    inline void Itm::SetSwoFrequency(uint32_t swoFrequency)
+    {
+        // Trace clock is HCLK
+        TPI->ACPR = Clock::AhbClock::ClockFreq() / swoFrequency - 1;
+    }
+
+    inline void Itm::Disable()
+    {
+        ITM->TER = 0;
+        ITM->TCR &= ~ITM_TCR_ITMENA_Msk;
+    }
+
+    inline bool Itm::IsPortEnabled(unsigned port)
+    {
+        return (ITM->TCR & ITM_TCR_ITMENA_Msk) && (ITM->TER & (1u << port));
+    }
+
+    template<unsigned _Port>
+    bool ItmPort<_Port>::WaitReady()
+    {
+        if (!Itm::IsPortEnabled(_Port))
+            return false;
+
+        // Port reads 1 when stimulus FIFO can accept data
+        while (ITM->PORT[_Port].u32 == 0) ;
+        return true;
+    }
+
+    template<unsigned _Port>
+    void ItmPort<_Port>::Write(uint8_t value)
+    {
+        if (WaitReady())
+            ITM->PORT[_Port].u8 = value;
+    }
+
+    template<unsigned _Port>
+    void ItmPort<_Port>::Write(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        while (size >= 4)
+        {
+            uint32_t word;
+            std::memcpy(&word, bytes, sizeof(word));
+            WriteU32(word);
+            bytes += 4;
+            size -= 4;
+        }
+
+        while (size-- > 0)
+            Write(*bytes++);
+    }
+
+    template<unsigned _Port>
+    void ItmPort<_Port>::WriteU16(uint16_t value)
+    {
+        if (WaitReady())
+            ITM->PORT[_Port].u16 = value;
+    }
+
+    template<unsigned _Port>
+    void ItmPort<_Port>::WriteU32(uint32_t value)
+    {
+        if (WaitReady())
+            ITM->PORT[_Port].u32 = value;
+    }
+}
+
+#endif //! ZHELE_ITM_IMPL_H
@@ -0,0 +1,190 @@
+/**
+ * @file
+ * Implements compile-time lookup tables and interpolation for sensor linearization
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LOOKUP_TABLE_IMPL_H
+#define ZHELE_LOOKUP_TABLE_IMPL_H
+
+#include <limits>
+
+namespace Zhele::Lut
+{
+    namespace Private
+    {
+        static constexpr double Ln2 = 0.69314718055994530942;
+
+        constexpr double Log(double x)
+        {
+            // ln(x) = ln(m) + e * ln(2), m in [1, 2), ln(m) = 2 atanh((m - 1) / (m + 1))
+            int exponent = 0;
+            while (x >= 2)
+            {
+                x /= 2;
+                ++exponent;
+            }
+            while (x < 1)
+            {
+                x *= 2;
+                --exponent;
+            }
+
+            double z = (x - 1) / (x + 1);
+            double term = z;
+            double result = 0;
+            for (int n = 1; n < 40; n += 2)
+            {
+                result += term / n;
+                term *= z * z;
+            }
+            return 2 * result + exponent * Ln2;
+        }
+
+        template<typename _Value>
+        constexpr _Value Saturate(double value)
+        {
+            constexpr double min = static_cast<double>(std::numeric_limits<_Value>::min());
+            constexpr double max = static_cast<double>(std::numeric_limits<_Value>::max());
+            if (value <= min)
+                return std::numeric_limits<_Value>::min();
+            if (value >= max)
+                return std::numeric_limits<_Value>::max();
+            return static_cast<_Value>(value < 0 ? value - 0.5 : value + 0.5);
+        }
+
+        constexpr size_t HighestPowerOfTwo(size_t value)
+        {
+            size_t result = 1;
+            while (result * 2 <= value)
+                result *= 2;
+            return result;
+        }
+    }
+
+    template<typename _Value, unsigned _InputBits, unsigned _SegmentBits>
+    constexpr _Value UniformTable<_Value, _InputBits, _SegmentBits>::operator()(uint32_t input) const
+    {
+        uint32_t code = input < MaxInput ? input : MaxInput;
+        uint32_t index = code >> Shift;
+        _Value base = Points[index];
+        if constexpr (Shift == 0)
+        {
+            return base;
+        }
+        else
+        {
+            uint32_t fraction = code & ((1ul << Shift) - 1);
+
+            // 32-bit product is enough for 16-bit values and short segments
+            if constexpr (sizeof(_Value) <= 2 && Shift <= 14)
+                return static_cast<_Value>(base + ((static_cast<int32_t>(Points[index + 1]) - base) * static_cast<int32_t>(fraction) >> Shift));
+            else
+                return static_cast<_Value>(base + ((static_cast<int64_t>(Points[index + 1]) - base) * fraction >> Shift));
+        }
+    }
+
+    template<typename _Value, unsigned _InputBits, unsigned _SegmentBits>
+    size_t UniformTable<_Value, _InputBits, _SegmentBits>::Process(std::span<const uint16_t> input, std::span<_Value> output) const
+    {
+        size_t count = input.size() < output.size() ? input.size() : output.size();
+        for (size_t i = 0; i < count; ++i)
+            output[i] = (*this)(input[i]);
+        return count;
+    }
+
+    template<typename _Value, size_t _Size>
+    constexpr _Value BreakpointTable<_Value, _Size>::operator()(uint32_t input) const
+    {
+        uint32_t code = input < Inputs[0] ? Inputs[0] : (input > Inputs[_Size - 1] ? Inputs[_Size - 1] : input);
+
+        // Largest segment start not above code, steps count is constant
+        size_t index = 0;
+        for (size_t step = Private::HighestPowerOfTwo(_Size - 1); step > 0; step >>= 1)
+        {
+            size_t next = index + step;
+            index = next < _Size - 1 && Inputs[next] <= code ? next : index;
+        }
+
+        return static_cast<_Value>(Values[index] + (static_cast<int64_t>(Slopes[index]) * static_cast<int32_t>(code - Inputs[index]) >> 16));
+    }
+
+    template<typename _Value, size_t _Size>
+    size_t BreakpointTable<_Value, _Size>::Process(std::span<const uint16_t> input, std::span<_Value> output) const
+    {
+        size_t count = input.size() < output.size() ? input.size() : output.size();
+        for (size_t i = 0; i < count; ++i)
+            output[i] = (*this)(input[i]);
+        return count;
+    }
+
+    consteval SteinhartHart SteinhartHart::FromBeta(double beta, double nominalOhms)
+    {
+        constexpr double nominalKelvin = 298.15;
+        return {1 / nominalKelvin - Private::Log(nominalOhms) / beta, 1 / beta, 0};
+    }
+
+    constexpr double SteinhartHart::Celsius(double ohms) const
+    {
+        double log = Private::Log(ohms);
+        return 1 / (A + B * log + C * log * log * log) - 273.15;
+    }
+
+    template<unsigned _InputBits, unsigned _SegmentBits, typename _Value, typename _Function>
+    consteval UniformTable<_Value, _InputBits, _SegmentBits> TabulateUniform(_Function function)
+    {
+        UniformTable<_Value, _InputBits, _SegmentBits> table{};
+        for (size_t i = 0; i < table.Points.size(); ++i)
+            table.Points[i] = Private::Saturate<_Value>(function(static_cast<double>(i << table.Shift)));
+        return table;
+    }
+
+    template<typename _Value, size_t _Size, typename _Function>
+    consteval BreakpointTable<_Value, _Size> TabulateBreakpoints(const std::array<uint16_t, _Size>& inputs, _Function function)
+    {
+        BreakpointTable<_Value, _Size> table{};
+        table.Valid = true;
+        table.Inputs = inputs;
+        for (size_t i = 0; i < _Size; ++i)
+            table.Values[i] = Private::Saturate<_Value>(function(static_cast<double>(inputs[i])));
+
+        for (size_t i = 0; i < _Size - 1; ++i)
+        {
+            if (inputs[i + 1] <= inputs[i])
+            {
+                table.Valid = false;
+                continue;
+            }
+
+            double slope = (static_cast<double>(table.Values[i + 1]) - table.Values[i]) * 65536 / (inputs[i + 1] - inputs[i]);
+            if (slope >= 2147483647.0 || slope <= -2147483648.0)
+                table.Valid = false;
+            else
+                table.Slopes[i] = static_cast<int32_t>(slope < 0 ? slope - 0.5 : slope + 0.5);
+        }
+        return table;
+    }
+
+    template<unsigned _InputBits>
+    consteval auto ThermistorDivider(SteinhartHart thermistor, double seriesOhms, double scale, bool toGround)
+    {
+        return [thermistor, seriesOhms, scale, toGround](double code) {
+            constexpr double fullScale = static_cast<double>(1ul << _InputBits);
+            if (code < 0.5)
+                code = 0.5;
+            if (code > fullScale - 0.5)
+                code = fullScale - 0.5;
+
+            double ratio = code / fullScale;
+            double ohms = toGround
+                ? seriesOhms * ratio / (1 - ratio)
+                : seriesOhms * (1 - ratio) / ratio;
+            return thermistor.Celsius(ohms) * scale;
+        };
+    }
+}
+
+#endif //! ZHELE_LOOKUP_TABLE_IMPL_H
@@ -0,0 +1,85 @@
+/**
+ * @file
+ * Implements PWM-synchronized injected ADC sampling for motor control
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_MOTOR_SAMPLER_IMPL_H
+#define ZHELE_MOTOR_SAMPLER_IMPL_H
+
+namespace Zhele
+{
+    #define MOTOR_SAMPLER_TEMPLATE_ARGS template<typename _Timer, typename _Adc>
+    #define MOTOR_SAMPLER_TEMPLATE_QUALIFIER MotorSampler<_Timer, _Adc>
+
+    MOTOR_SAMPLER_TEMPLATE_ARGS
+    template<typename... _Pins>
+    bool MOTOR_SAMPLER_TEMPLATE_QUALIFIER::Start(ControlCallbackType callback, uint16_t sampleTime, Counter advance)
+    {
+        static_assert(sizeof...(_Pins) > 0, "At least one pin is required");
+        static_assert(sizeof...(_Pins) <= MaxChannels, "Injected sequence is too long");
+
+        const uint8_t channels[] = {static_cast<uint8_t>(_Adc::Pins::template IndexOf<_Pins>)...};
+        for (uint8_t channel : channels)
+        {
+            _Adc::SetSampleTime(channel, sampleTime);
+        }
+
+        _callback = callback;
+        _count = sizeof...(_Pins);
+
+        // OC4REF rises (and triggers ADC) once per period, when up-counting counter reaches pulse
+        TriggerChannel::SetOutputMode(TriggerChannel::PWM2);
+        SetSamplePoint(advance);
+        TriggerChannel::Enable();
+
+        return _Adc::StartInjectedTriggered(channels, sizeof...(_Pins), Trigger::Trigger);
+    }
+
+    MOTOR_SAMPLER_TEMPLATE_ARGS
+    void MOTOR_SAMPLER_TEMPLATE_QUALIFIER::SetSamplePoint(Counter advance)
+    {
+        TriggerChannel::SetPulse(_Timer::GetPeriod() - advance);
+    }
+
+    MOTOR_SAMPLER_TEMPLATE_ARGS
+    void MOTOR_SAMPLER_TEMPLATE_QUALIFIER::Stop()
+    {
+        _Adc::StopInjected();
+        TriggerChannel::Disable();
+        _callback = nullptr;
+    }
+
+    MOTOR_SAMPLER_TEMPLATE_ARGS
+    void MOTOR_SAMPLER_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        ZHELE_PROFILE_ISR();
+
+        const uint32_t sr = Regs()->SR;
+        if (sr & ADC_SR_JEOC)
+        {
+            // Flags are cleared by writing zero, so other flags are not lost
+            Regs()->SR = ~(ADC_SR_JEOC | ADC_SR_JSTRT);
+
+            // JDR1..JDR4 are adjacent
+            const volatile uint32_t* data = &Regs()->JDR1;
+            uint16_t results[MaxChannels];
+            const uint8_t count = _count;
+            for (unsigned i = 0; i < count; ++i)
+            {
+                results[i] = static_cast<uint16_t>(data[i]);
+            }
+
+            if (_callback)
+                _callback(results, count);
+        }
+
+        if (sr & ADC_SR_AWD)
+            _Adc::IrqHandler();
+    }
+}
+
+#endif //! ZHELE_MOTOR_SAMPLER_IMPL_H
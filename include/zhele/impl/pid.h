@@ -0,0 +1,136 @@
+/**
+ * @file
+ * Implements fixed-point (Q16.16, Q31) PID regulator
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PID_IMPL_H
+#define ZHELE_PID_IMPL_H
+
+#include <zhele/waveform.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace Zhele::Dsp
+{
+    namespace Private
+    {
+        using Waveform::Private::Pi;
+
+        constexpr int32_t ToFixedPoint(double value, unsigned fractionalBits)
+        {
+            const double scaled = value * static_cast<double>(1ull << fractionalBits);
+            if (scaled >= static_cast<double>(std::numeric_limits<int32_t>::max()))
+                return std::numeric_limits<int32_t>::max();
+            if (scaled <= static_cast<double>(std::numeric_limits<int32_t>::min()))
+                return std::numeric_limits<int32_t>::min();
+            return static_cast<int32_t>(scaled >= 0 ? scaled + 0.5 : scaled - 0.5);
+        }
+
+        inline int32_t Saturate(int64_t value)
+        {
+            return static_cast<int32_t>(std::clamp<int64_t>(value, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+        }
+    }
+
+    constexpr PidCoefficients PidCoefficients::From(double kp, double ki, double kd, double sampleRate, double derivativeCutoff)
+    {
+        // Backward Euler discretization of first-order low-pass
+        const double cutoff = 2 * Private::Pi * derivativeCutoff;
+        const double filter = derivativeCutoff > 0 ? cutoff / (cutoff + sampleRate) : 1.0;
+        return {
+            Private::ToFixedPoint(kp, 16),
+            Private::ToFixedPoint(ki / sampleRate, 31),
+            Private::ToFixedPoint(kd * sampleRate, 16),
+            Private::ToFixedPoint(filter, 16),
+        };
+    }
+
+    template<unsigned _FractionalBits>
+    constexpr typename Pid<_FractionalBits>::Value Pid<_FractionalBits>::FromDouble(double value)
+    {
+        return Private::ToFixedPoint(value, _FractionalBits);
+    }
+
+    template<unsigned _FractionalBits>
+    Pid<_FractionalBits>::Pid(const PidCoefficients& coefficients, Value min, Value max)
+        : _coefficients(coefficients)
+        , _min(min)
+        , _max(max)
+    {
+        Reset();
+    }
+
+    template<unsigned _FractionalBits>
+    void Pid<_FractionalBits>::SetCoefficients(const PidCoefficients& coefficients)
+    {
+        _coefficients = coefficients;
+    }
+
+    template<unsigned _FractionalBits>
+    void Pid<_FractionalBits>::SetLimits(Value min, Value max)
+    {
+        _min = min;
+        _max = max;
+        _integral = std::clamp<int64_t>(_integral, static_cast<int64_t>(_min) << 31, static_cast<int64_t>(_max) << 31);
+    }
+
+    template<unsigned _FractionalBits>
+    void Pid<_FractionalBits>::Reset(Value output)
+    {
+        _output = std::clamp(output, _min, _max);
+        _integral = static_cast<int64_t>(_output) << 31;
+        _derivative = 0;
+        _previousMeasurement = 0;
+        _started = false;
+    }
+
+    template<unsigned _FractionalBits>
+    typename Pid<_FractionalBits>::Value Pid<_FractionalBits>::Step(Value setpoint, Value measurement)
+    {
+        // Difference of two signals does not fit 32 bits
+        const int32_t error = Private::Saturate(static_cast<int64_t>(setpoint) - measurement);
+        const int64_t proportional = (static_cast<int64_t>(_coefficients.kp) * error) >> 16;
+
+        // Derivative of measurement (there is no previous one on the first step)
+        if (!_started)
+        {
+            _previousMeasurement = measurement;
+            _started = true;
+        }
+        const int32_t delta = Private::Saturate(static_cast<int64_t>(_previousMeasurement) - measurement);
+        _previousMeasurement = measurement;
+        const int32_t derivative = Private::Saturate((static_cast<int64_t>(_coefficients.kd) * delta) >> 16);
+        _derivative = Private::Saturate(_derivative + ((static_cast<int64_t>(_coefficients.filter) * (static_cast<int64_t>(derivative) - _derivative)) >> 16));
+
+        // Integrator is inside output limits (Ki < 1, so sum does not overflow)
+        const int64_t integral = std::clamp<int64_t>(_integral + static_cast<int64_t>(_coefficients.ki) * error,
+            static_cast<int64_t>(_min) << 31, static_cast<int64_t>(_max) << 31);
+
+        int64_t output = proportional + (integral >> 31) + _derivative;
+        if ((output > _max && error > 0) || (output < _min && error < 0))
+        {
+            // Saturated: integration would wind up
+            output = proportional + (_integral >> 31) + _derivative;
+        }
+        else
+        {
+            _integral = integral;
+        }
+
+        _output = static_cast<Value>(std::clamp<int64_t>(output, _min, _max));
+        return _output;
+    }
+
+    template<unsigned _FractionalBits>
+    typename Pid<_FractionalBits>::Value Pid<_FractionalBits>::Output() const
+    {
+        return _output;
+    }
+}
+
+#endif //! ZHELE_PID_IMPL_H
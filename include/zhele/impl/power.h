@@ -0,0 +1,130 @@
+/**
+ * @file
+ * Implements low-power idle management
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_POWER_IMPL_H
+#define ZHELE_POWER_IMPL_H
+
+namespace Zhele::Power
+{
+    #define POWERMANAGER_TEMPLATE_ARGS template<typename... _Guards>
+    #define POWERMANAGER_TEMPLATE_QUALIFIER PowerManager<_Guards...>
+
+    POWERMANAGER_TEMPLATE_ARGS
+    void POWERMANAGER_TEMPLATE_QUALIFIER::Lock(Mode deepest)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        ++_locks[static_cast<unsigned>(deepest)];
+        __set_PRIMASK(primask);
+    }
+
+    POWERMANAGER_TEMPLATE_ARGS
+    void POWERMANAGER_TEMPLATE_QUALIFIER::Unlock(Mode deepest)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (_locks[static_cast<unsigned>(deepest)] > 0)
+            --_locks[static_cast<unsigned>(deepest)];
+        __set_PRIMASK(primask);
+    }
+
+    POWERMANAGER_TEMPLATE_ARGS
+    Mode POWERMANAGER_TEMPLATE_QUALIFIER::AllowedMode()
+    {
+        for (unsigned mode = 0; mode < ModesCount - 1; ++mode)
+        {
+            if (_locks[mode] > 0)
+                return static_cast<Mode>(mode);
+        }
+
+        if ((_Guards::Enabled() || ...))
+            return Mode::Sleep;
+
+        return Mode::Stop;
+    }
+
+    POWERMANAGER_TEMPLATE_ARGS
+    Mode POWERMANAGER_TEMPLATE_QUALIFIER::Idle()
+    {
+        // Interrupt between check and WFI wakes core anyway
+        __disable_irq();
+
+        Mode mode = AllowedMode();
+        if (mode == Mode::Sleep)
+        {
+            __WFI();
+        }
+        else if (mode == Mode::Stop)
+        {
+            EnterStop();
+        }
+
+        __enable_irq();
+        return mode;
+    }
+
+    POWERMANAGER_TEMPLATE_ARGS
+    uint32_t POWERMANAGER_TEMPLATE_QUALIFIER::WakeLatency()
+    {
+        return _wakeLatency;
+    }
+
+    POWERMANAGER_TEMPLATE_ARGS
+    uint32_t POWERMANAGER_TEMPLATE_QUALIFIER::MaxWakeLatency()
+    {
+        return _maxWakeLatency;
+    }
+
+    POWERMANAGER_TEMPLATE_ARGS
+    void POWERMANAGER_TEMPLATE_QUALIFIER::EnterStop()
+    {
+        uint32_t clockSource = RCC->CFGR & RCC_CFGR_SWS;
+
+        Clock::PowerClock::Enable();
+    #if defined (PWR_CR_LPDS)
+        // Stop with low-power regulator
+        PWR->CR = (PWR->CR & ~PWR_CR_PDDS) | PWR_CR_LPDS;
+    #elif defined (PWR_CR1_LPMS)
+        // Stop 1
+        PWR->CR1 = (PWR->CR1 & ~PWR_CR1_LPMS) | PWR_CR1_LPMS_0;
+    #endif
+
+        SystemTime::Suspend();
+        SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+        __WFI();
+        SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+        // System clock is HSI after wake up
+        CycleCounter::Enable();
+        uint32_t start = CycleCounter::Read();
+
+        if (clockSource == RCC_CFGR_SWS_PLL)
+            Clock::SysClock::SelectClockSource<Clock::SysClock::Pll>();
+        else if (clockSource == RCC_CFGR_SWS_HSE)
+            Clock::SysClock::SelectClockSource<Clock::SysClock::External>();
+
+        // SysTick is stopped in Stop mode
+        SystemTime::Resume();
+
+        _wakeLatency = CycleCounter::Elapsed(start, CycleCounter::Read());
+        if (_wakeLatency > _maxWakeLatency)
+            _maxWakeLatency = _wakeLatency;
+    }
+
+    POWERMANAGER_TEMPLATE_ARGS
+    volatile uint16_t POWERMANAGER_TEMPLATE_QUALIFIER::_locks[ModesCount];
+
+    POWERMANAGER_TEMPLATE_ARGS
+    uint32_t POWERMANAGER_TEMPLATE_QUALIFIER::_wakeLatency = 0;
+
+    POWERMANAGER_TEMPLATE_ARGS
+    uint32_t POWERMANAGER_TEMPLATE_QUALIFIER::_maxWakeLatency = 0;
+}
+
+#endif //! ZHELE_POWER_IMPL_H
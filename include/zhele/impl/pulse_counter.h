@@ -0,0 +1,170 @@
+/**
+ * @file
+ * Implements hardware pulse counting with timer external clock
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PULSE_COUNTER_IMPL_H
+#define ZHELE_PULSE_COUNTER_IMPL_H
+
+namespace Zhele::Timers
+{
+    template<typename _Timer>
+    void PulseCounter<_Timer>::Configure()
+    {
+        _Timer::Enable();
+        _Timer::Stop();
+        SlaveMode::DisableSlaveMode();
+        SlaveMode::SetExternalClockMode2(SlaveMode::ExternalClockMode2::Disabled);
+
+        // Update event loads prescaler
+        _Timer::SetPrescaler(0);
+        _Timer::SetPeriodAndUpdate(0xffff);
+        _Timer::ClearInterruptFlag();
+        _Timer::EnableInterrupt();
+    }
+
+    template<typename _Timer>
+    void PulseCounter<_Timer>::EnableEtr(Filter filter, Edge edge, Prescaler prescaler)
+    {
+        Configure();
+        SlaveMode::SetTriggerFilter(filter);
+        SlaveMode::SetTriggerPolarity(edge == Edge::Falling
+            ? SlaveMode::ExternalTriggerPolarity::Inverted
+            : SlaveMode::ExternalTriggerPolarity::NonInverted);
+        SlaveMode::SetTriggerPrescaler(prescaler);
+        SlaveMode::SetExternalClockMode2(SlaveMode::ExternalClockMode2::Enabled);
+    }
+
+    template<typename _Timer>
+    template<typename _Pin>
+    void PulseCounter<_Timer>::EnableTi1(Filter filter, Edge edge)
+    {
+        Configure();
+        InputChannel::template SelectPins<_Pin>();
+        InputChannel::SetCaptureMode(InputChannel::Direct);
+        InputChannel::SetFilter(filter);
+        InputChannel::SetCapturePolarity(edge == Edge::Falling ? InputChannel::FallingEdge : InputChannel::RisingEdge);
+
+        // Edge detector counts both edges, polarity doesn't matter
+        SlaveMode::SelectTrigger(edge == Edge::Both ? SlaveMode::Trigger::Ti1EdgeDetector : SlaveMode::Trigger::FilteredTimerInput1);
+        SlaveMode::EnableSlaveMode(SlaveMode::Mode::ExternalClockMode);
+    }
+
+    template<typename _Timer>
+    void PulseCounter<_Timer>::Start()
+    {
+        Reset();
+        _Timer::Start();
+    }
+
+    template<typename _Timer>
+    void PulseCounter<_Timer>::Stop()
+    {
+        _Timer::Stop();
+    }
+
+    template<typename _Timer>
+    void PulseCounter<_Timer>::Reset()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        _Timer::SetCounterValue(0);
+        _Timer::ClearInterruptFlag();
+        _overflows = 0;
+        _lastGate = 0;
+        __set_PRIMASK(primask);
+    }
+
+    template<typename _Timer>
+    uint32_t PulseCounter<_Timer>::Count()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t overflows = _overflows;
+        uint16_t counter = _Timer::GetCounterValue();
+
+        // Overflow is not handled yet: counter is re-read, so it's surely after wrap
+        if (_Timer::IsInterrupt())
+        {
+            ++overflows;
+            counter = _Timer::GetCounterValue();
+        }
+        __set_PRIMASK(primask);
+
+        return (overflows << 16) | counter;
+    }
+
+    template<typename _Timer>
+    uint32_t PulseCounter<_Timer>::Gate()
+    {
+        uint32_t count = Count();
+        uint32_t pulses = count - _lastGate;
+        _lastGate = count;
+        return pulses;
+    }
+
+    template<typename _Timer>
+    template<typename _GateTimer>
+    void PulseCounter<_Timer>::MeasureFrequency(uint16_t gateMs, FrequencyCallback callback)
+    {
+        _gateMs = gateMs;
+        _callback = callback;
+        _measuring = true;
+
+        // Gate timer ticks every 100 us, its counter enable is counter gate (TRGO)
+        _GateTimer::Enable();
+        _GateTimer::Stop();
+        TimerChain<_GateTimer, _Timer>::EnableGatedMode(_GateTimer::MasterMode::Enable);
+
+        Reset();
+        _Timer::Start();
+
+        _GateTimer::SetCounterFrequency(10000);
+        _GateTimer::EnableOnePulseMode();
+        _GateTimer::SetPeriodAndUpdate(gateMs * 10 - 1);
+        _GateTimer::ClearInterruptFlag();
+        _GateTimer::EnableInterrupt();
+        _GateTimer::Start();
+    }
+
+    template<typename _Timer>
+    bool PulseCounter<_Timer>::IsMeasuring()
+    {
+        return _measuring;
+    }
+
+    template<typename _Timer>
+    void PulseCounter<_Timer>::IrqHandler()
+    {
+        if (_Timer::IsInterrupt())
+        {
+            _Timer::ClearInterruptFlag();
+            ++_overflows;
+        }
+    }
+
+    template<typename _Timer>
+    template<typename _GateTimer>
+    void PulseCounter<_Timer>::GateIrqHandler()
+    {
+        if (!_GateTimer::IsInterrupt())
+            return;
+
+        _GateTimer::ClearInterruptFlag();
+        _GateTimer::DisableInterrupt();
+
+        // Gate is closed: counter is frozen until it's disconnected from gate timer
+        uint32_t pulses = Count();
+        TimerChain<_GateTimer, _Timer>::Disconnect();
+        _measuring = false;
+
+        if (_callback != nullptr)
+            _callback(static_cast<uint32_t>(static_cast<uint64_t>(pulses) * 1000 / _gateMs));
+    }
+}
+
+#endif //! ZHELE_PULSE_COUNTER_IMPL_H
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * Implements timer and DMA driven pulse train (arbitrary waveform) generator
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PULSE_TRAIN_IMPL_H
+#define ZHELE_PULSE_TRAIN_IMPL_H
+
+namespace Zhele
+{
+    #define PULSE_TRAIN_TEMPLATE_ARGS template<typename _Timer, unsigned _Channel, typename _DmaChannel>
+    #define PULSE_TRAIN_TEMPLATE_QUALIFIER PulseTrain<_Timer, _Channel, _DmaChannel>
+
+    PULSE_TRAIN_TEMPLATE_ARGS
+    constexpr typename PULSE_TRAIN_TEMPLATE_QUALIFIER::Step PULSE_TRAIN_TEMPLATE_QUALIFIER::MakeStep(uint32_t ticks, Counter pulse, uint16_t repeat)
+    {
+        Step step{static_cast<Counter>(ticks - 1), static_cast<Counter>(repeat - 1), {}};
+        step.pulses[_Channel] = pulse;
+        return step;
+    }
+
+    PULSE_TRAIN_TEMPLATE_ARGS
+    void PULSE_TRAIN_TEMPLATE_QUALIFIER::Init()
+    {
+        _Timer::Enable();
+        _Timer::Stop();
+        _Timer::EnablePeriodPreload();
+        Channel::SetOutputMode(Channel::OutputMode::PWM1);
+        Channel::EnablePreload();
+        Channel::SetPulse(0);
+        Channel::Enable();
+
+        if constexpr (RepetitionSupported)
+            _Timer::EnableOutputs();
+    }
+
+    PULSE_TRAIN_TEMPLATE_ARGS
+    void PULSE_TRAIN_TEMPLATE_QUALIFIER::Start(const Step* steps, uint16_t count, TransferCallback callback, bool circular)
+    {
+        Stop();
+
+        // Idle lead-in step (two ticks) is loaded by UG before DMA request is enabled. Its overflow loads it
+        // once more and requests steps[0], so the first step is applied from the second overflow
+        if constexpr (RepetitionSupported)
+            _Timer::SetRepetitionCounter(0);
+        _Timer::SetPeriodAndUpdate(1);
+
+        _Timer::template StartDmaBurst<_DmaChannel>(_Timer::BurstRegister::Arr, BurstLength,
+            reinterpret_cast<const Counter*>(steps), count, callback, circular);
+        _Timer::Start();
+    }
+
+    PULSE_TRAIN_TEMPLATE_ARGS
+    void PULSE_TRAIN_TEMPLATE_QUALIFIER::Stop()
+    {
+        _Timer::template StopDmaBurst<_DmaChannel>();
+        _Timer::Stop();
+
+        // Zero pulse with UG sets output inactive immediately
+        Channel::SetPulse(0);
+        _Timer::SetPeriodAndUpdate(_Timer::GetPeriod());
+    }
+}
+
+#endif //! ZHELE_PULSE_TRAIN_IMPL_H
@@ -0,0 +1,347 @@
+/**
+ * @file
+ * Implements software I2C master over GPIO paced by timer
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SOFT_I2C_IMPL_H
+#define ZHELE_SOFT_I2C_IMPL_H
+
+namespace Zhele
+{
+    #define SOFT_I2C_TEMPLATE_ARGS template<typename _SclPin, typename _SdaPin, typename _Timer>
+    #define SOFT_I2C_TEMPLATE_QUALIFIER SoftI2c<_SclPin, _SdaPin, _Timer>
+
+    SOFT_I2C_TEMPLATE_ARGS
+    void SOFT_I2C_TEMPLATE_QUALIFIER::Init(uint32_t i2cClockSpeed)
+    {
+        _SclPin::Port::Enable();
+        _SdaPin::Port::Enable();
+        _SclPin::Set();
+        _SdaPin::Set();
+        _SclPin::SetConfiguration(_SclPin::Port::Out);
+        _SclPin::SetDriverType(_SclPin::Port::OpenDrain);
+        _SdaPin::SetConfiguration(_SdaPin::Port::Out);
+        _SdaPin::SetDriverType(_SdaPin::Port::OpenDrain);
+
+        // Timer ticks twice per SCL period, prescaler follows clock changes
+        _Timer::Enable();
+        uint32_t frequency = _Timer::SetCounterFrequency(TimerFrequency);
+        uint32_t period = frequency / (2 * i2cClockSpeed);
+        _Timer::SetPeriodAndUpdate(period > 1 ? period - 1 : 1);
+        _Timer::ClearInterruptFlag();
+        _Timer::EnableInterrupt();
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    I2cStatus SOFT_I2C_TEMPLATE_QUALIFIER::WriteU8(uint16_t devAddr, uint16_t regAddr, uint8_t data, I2cOpts opts)
+    {
+        return Write(devAddr, regAddr, &data, 1, opts);
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    I2cStatus SOFT_I2C_TEMPLATE_QUALIFIER::Write(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cOpts opts)
+    {
+        return Wait(Begin(devAddr, regAddr, const_cast<uint8_t*>(data), size, opts, I2cMode::Write, nullptr));
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    I2cStatus SOFT_I2C_TEMPLATE_QUALIFIER::WriteAsync(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cOpts opts, I2cCallback callback)
+    {
+        return Begin(devAddr, regAddr, const_cast<uint8_t*>(data), size, opts, I2cMode::Write, callback);
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    ReadResult SOFT_I2C_TEMPLATE_QUALIFIER::ReadU8(uint16_t devAddr, uint16_t regAddr, I2cOpts opts)
+    {
+        uint8_t value = 0;
+        I2cStatus status = Read(devAddr, regAddr, &value, 1, opts);
+        return {value, status};
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    I2cStatus SOFT_I2C_TEMPLATE_QUALIFIER::Read(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts)
+    {
+        return Wait(Begin(devAddr, regAddr, data, size, opts, I2cMode::Read, nullptr));
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    I2cStatus SOFT_I2C_TEMPLATE_QUALIFIER::EnableAsyncRead(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts, I2cCallback callback)
+    {
+        return Begin(devAddr, regAddr, data, size, opts, I2cMode::Read, callback);
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    bool SOFT_I2C_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _busy;
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    void SOFT_I2C_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        if (!_Timer::IsInterrupt())
+            return;
+
+        _Timer::ClearInterruptFlag();
+        Tick();
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    I2cStatus SOFT_I2C_TEMPLATE_QUALIFIER::Begin(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts, I2cMode mode, I2cCallback callback)
+    {
+        if (devAddr > 0x7f || opts == I2cOpts::DevAddr10Bit || (mode == I2cMode::Read && size == 0))
+            return I2cStatus::ArgumentError;
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (_busy)
+        {
+            __set_PRIMASK(primask);
+            return I2cStatus::Busy;
+        }
+
+        // Slave holds line (interrupted transfer), use I2C bus recovery
+        if (!_SclPin::IsSet() || !_SdaPin::IsSet())
+        {
+            __set_PRIMASK(primask);
+            return I2cStatus::BusError;
+        }
+        _busy = true;
+        __set_PRIMASK(primask);
+
+        const bool read = mode == I2cMode::Read;
+        const bool hasRegister = opts != I2cOpts::RegAddrNone;
+
+        _headerSize = 0;
+        _header[_headerSize++] = static_cast<uint8_t>((devAddr << 1) | (read && !hasRegister ? 1 : 0));
+        if (opts == I2cOpts::RegAddr16Bit)
+            _header[_headerSize++] = static_cast<uint8_t>(regAddr >> 8);
+        if (hasRegister)
+            _header[_headerSize++] = static_cast<uint8_t>(regAddr);
+        _readAddress = read && hasRegister ? static_cast<uint8_t>((devAddr << 1) | 1) : 0;
+
+        _headerIndex = 0;
+        _headerDone = false;
+        _data = data;
+        _size = size;
+        _dataIndex = 0;
+        _mode = mode;
+        _callback = callback;
+        _status = I2cStatus::Success;
+        _stretch = 0;
+        _step = Step::Start;
+
+        _Timer::SetCounterValue(0);
+        _Timer::ClearInterruptFlag();
+        _Timer::Start();
+
+        return I2cStatus::Success;
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    I2cStatus SOFT_I2C_TEMPLATE_QUALIFIER::Wait(I2cStatus status)
+    {
+        if (status != I2cStatus::Success)
+            return status;
+
+        while (_busy)
+            ;
+        return _status;
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    void SOFT_I2C_TEMPLATE_QUALIFIER::Tick()
+    {
+        // Slave may stretch clock before SCL fall and before start/stop condition
+        if ((_step == Step::RestartStart || _step == Step::StopDone || (_step == Step::Bit && !_rise)) && !_SclPin::IsSet())
+        {
+            if (++_stretch > MaxStretchTicks)
+            {
+                _SclPin::Set();
+                _SdaPin::Set();
+                Finish(I2cStatus::Timeout);
+            }
+            return;
+        }
+        _stretch = 0;
+
+        switch (_step)
+        {
+            case Step::Start:
+                _SdaPin::Clear();
+                _step = Step::StartLow;
+                break;
+            case Step::StartLow:
+                _SclPin::Clear();
+                _rise = true;
+                _step = Step::Bit;
+                NextByte();
+                break;
+            case Step::Bit:
+                if (_rise)
+                {
+                    _SclPin::Set();
+                    _rise = false;
+                }
+                else
+                {
+                    BitFall();
+                }
+                break;
+            case Step::RestartHigh:
+                _SclPin::Set();
+                _step = Step::RestartStart;
+                break;
+            case Step::RestartStart:
+                _SdaPin::Clear();
+                _step = Step::StartLow;
+                break;
+            case Step::StopHigh:
+                _SclPin::Set();
+                _step = Step::StopDone;
+                break;
+            case Step::StopDone:
+                _SdaPin::Set();
+                Finish(_status);
+                break;
+            default:
+                _Timer::Stop();
+                break;
+        }
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    void SOFT_I2C_TEMPLATE_QUALIFIER::BitFall()
+    {
+        // SDA is stable while SCL is high, so it's sampled just before fall
+        bool sample = _SdaPin::IsSet();
+        _SclPin::Clear();
+        _rise = true;
+
+        if (_bit < 8)
+        {
+            ++_bit;
+            if (_receive)
+            {
+                _shift = static_cast<uint8_t>((_shift << 1) | (sample ? 1 : 0));
+                if (_bit == 8)
+                {
+                    // Last byte is not acknowledged
+                    _data[_dataIndex] = _shift;
+                    SetSda(_dataIndex + 1u >= _size);
+                }
+            }
+            else
+            {
+                _shift <<= 1;
+                SetSda(_bit == 8 || (_shift & 0x80) != 0);
+            }
+            return;
+        }
+
+        // Acknowledge bit
+        if (!_receive && sample)
+        {
+            BeginStop(I2cStatus::Nack);
+            return;
+        }
+        if (_receive)
+            ++_dataIndex;
+        NextByte();
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    void SOFT_I2C_TEMPLATE_QUALIFIER::NextByte()
+    {
+        if (!_headerDone)
+        {
+            if (_headerIndex < _headerSize)
+            {
+                LoadTx(_header[_headerIndex++]);
+                return;
+            }
+            _headerDone = true;
+
+            // Register address is written, data is read after repeated start
+            if (_readAddress != 0)
+            {
+                _header[0] = _readAddress;
+                _headerSize = 1;
+                _headerIndex = 0;
+                _readAddress = 0;
+                _headerDone = false;
+                SetSda(true);
+                _step = Step::RestartHigh;
+                return;
+            }
+        }
+
+        if (_dataIndex >= _size)
+        {
+            BeginStop(I2cStatus::Success);
+            return;
+        }
+
+        if (_mode == I2cMode::Read)
+            LoadRx();
+        else
+            LoadTx(_data[_dataIndex++]);
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    void SOFT_I2C_TEMPLATE_QUALIFIER::LoadTx(uint8_t value)
+    {
+        _receive = false;
+        _shift = value;
+        _bit = 0;
+        SetSda((value & 0x80) != 0);
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    void SOFT_I2C_TEMPLATE_QUALIFIER::LoadRx()
+    {
+        _receive = true;
+        _shift = 0;
+        _bit = 0;
+        SetSda(true);
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    void SOFT_I2C_TEMPLATE_QUALIFIER::BeginStop(I2cStatus status)
+    {
+        _status = status;
+        SetSda(false);
+        _step = Step::StopHigh;
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    void SOFT_I2C_TEMPLATE_QUALIFIER::Finish(I2cStatus status)
+    {
+        _Timer::Stop();
+        _step = Step::Idle;
+        _status = status;
+        _mode = I2cMode::Idle;
+
+        // Callback may start next transfer
+        I2cCallback callback = _callback;
+        _callback = nullptr;
+        _busy = false;
+        if (callback != nullptr)
+            callback(status);
+    }
+
+    SOFT_I2C_TEMPLATE_ARGS
+    void SOFT_I2C_TEMPLATE_QUALIFIER::SetSda(bool high)
+    {
+        if (high)
+            _SdaPin::Set();
+        else
+            _SdaPin::Clear();
+    }
+}
+
+#endif //! ZHELE_SOFT_I2C_IMPL_H
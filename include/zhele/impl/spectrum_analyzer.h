@@ -0,0 +1,97 @@
+/**
+ * @file
+ * Implements spectrum analysis of ADC stream
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SPECTRUM_ANALYZER_IMPL_H
+#define ZHELE_SPECTRUM_ANALYZER_IMPL_H
+
+namespace Zhele
+{
+    #define SPECTRUM_ANALYZER_TEMPLATE_ARGS template<typename _Adc, typename _Sample, size_t _Size, Dsp::Window _Window, typename _Placement>
+    #define SPECTRUM_ANALYZER_TEMPLATE_QUALIFIER SpectrumAnalyzer<_Adc, _Sample, _Size, _Window, _Placement>
+
+    SPECTRUM_ANALYZER_TEMPLATE_ARGS
+    void SPECTRUM_ANALYZER_TEMPLATE_QUALIFIER::Init(SpectrumCallbackType callback)
+    {
+        _callback = callback;
+        _received = 0;
+        _dropped = 0;
+        CycleCounter::Enable();
+    }
+
+    SPECTRUM_ANALYZER_TEMPLATE_ARGS
+    uint16_t* SPECTRUM_ANALYZER_TEMPLATE_QUALIFIER::Buffer()
+    {
+        return _buffer;
+    }
+
+    SPECTRUM_ANALYZER_TEMPLATE_ARGS
+    void SPECTRUM_ANALYZER_TEMPLATE_QUALIFIER::BlockReady(uint16_t* data, uint32_t count, uint32_t overruns)
+    {
+        (void)count;
+        (void)overruns;
+
+        // The only writer is DMA interrupt
+        const uint32_t sequence = _received + 1;
+        _received = sequence;
+        Deferred::Callback<Process>(data, sequence);
+    }
+
+    SPECTRUM_ANALYZER_TEMPLATE_ARGS
+    uint32_t SPECTRUM_ANALYZER_TEMPLATE_QUALIFIER::LastCycles()
+    {
+        return _lastCycles;
+    }
+
+    SPECTRUM_ANALYZER_TEMPLATE_ARGS
+    uint32_t SPECTRUM_ANALYZER_TEMPLATE_QUALIFIER::Dropped()
+    {
+        return _dropped;
+    }
+
+    SPECTRUM_ANALYZER_TEMPLATE_ARGS
+    void SPECTRUM_ANALYZER_TEMPLATE_QUALIFIER::Process(uint16_t* data, uint32_t sequence)
+    {
+        const uint32_t start = CycleCounter::Read();
+
+        // Samples are centered in place, their magnitude is less than 2^ResolutionBits
+        const std::span<int16_t> samples = _Adc::RemoveDcOffset({data, _Size});
+        if constexpr (std::is_floating_point_v<_Sample>)
+        {
+            static _Sample input[_Size];
+            constexpr _Sample scale = _Sample(1) / (1u << _Adc::ResolutionBits);
+            for (size_t i = 0; i < _Size; ++i)
+            {
+                input[i] = samples[i] * scale;
+            }
+            Fft::Transform(input, _window, _spectrum);
+        }
+        else
+        {
+            for (int16_t& sample : samples)
+            {
+                sample = static_cast<int16_t>(sample * (1 << (15 - _Adc::ResolutionBits)));
+            }
+            Fft::Transform(samples, _window, _spectrum);
+        }
+
+        _lastCycles = CycleCounter::Elapsed(start, CycleCounter::Read());
+
+        // DMA has completed the next block, so this one is being overwritten
+        if (_received != sequence)
+        {
+            _dropped = _dropped + 1;
+            return;
+        }
+
+        if (_callback != nullptr)
+            _callback({_spectrum, Fft::Bins});
+    }
+}
+
+#endif //! ZHELE_SPECTRUM_ANALYZER_IMPL_H
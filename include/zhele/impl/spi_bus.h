@@ -0,0 +1,181 @@
+/**
+ * @file
+ * Implements shared SPI bus with per-device configuration
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SPI_BUS_IMPL_H
+#define ZHELE_SPI_BUS_IMPL_H
+
+namespace Zhele
+{
+    #define SPIBUS_TEMPLATE_ARGS template<typename _Spi, unsigned _Depth>
+    #define SPIBUS_TEMPLATE_QUALIFIER SpiBus<_Spi, _Depth>
+
+    SPIBUS_TEMPLATE_ARGS
+    void SPIBUS_TEMPLATE_QUALIFIER::Init()
+    {
+        _Spi::Init(_Spi::ClockDivider::Medium, _Spi::Mode::Master);
+        _Spi::SetSlaveControl(_Spi::SlaveControl::SoftSlaveControl);
+        _Spi::SetSS();
+        Invalidate();
+    }
+
+    SPIBUS_TEMPLATE_ARGS
+    template<typename _Config>
+    void SPIBUS_TEMPLATE_QUALIFIER::Configure()
+    {
+        Configure(_Config::Key);
+    }
+
+    SPIBUS_TEMPLATE_ARGS
+    void SPIBUS_TEMPLATE_QUALIFIER::Configure(uint32_t configKey)
+    {
+        if(configKey == _configKey)
+            return;
+
+        _Spi::Configure(static_cast<typename _Spi::ClockDivider>(configKey & SPI_CR1_BR),
+            static_cast<typename _Spi::ClockPolarity>(configKey & SPI_CR1_CPOL),
+            static_cast<typename _Spi::ClockPhase>(configKey & SPI_CR1_CPHA),
+            static_cast<typename _Spi::BitOrder>(configKey & SPI_CR1_LSBFIRST),
+            static_cast<typename _Spi::DataSize>(configKey >> 16));
+
+        _configKey = configKey;
+    }
+
+    SPIBUS_TEMPLATE_ARGS
+    void SPIBUS_TEMPLATE_QUALIFIER::Invalidate()
+    {
+        _configKey = 0xffffffff;
+    }
+
+    SPIBUS_TEMPLATE_ARGS
+    bool SPIBUS_TEMPLATE_QUALIFIER::Enqueue(const SpiTransaction& transaction)
+    {
+        bool result = true;
+
+        // DMA RX IRQ handler pops queue, so lock it while check state
+        NVIC_DisableIRQ(_Spi::DmaRx::IRQNumber);
+        if(!_busy)
+        {
+            _busy = true;
+            Start(transaction);
+        }
+        else
+        {
+            result = _queue.push_back(transaction);
+        }
+        NVIC_EnableIRQ(_Spi::DmaRx::IRQNumber);
+
+        return result;
+    }
+
+    SPIBUS_TEMPLATE_ARGS
+    bool SPIBUS_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _busy;
+    }
+
+    SPIBUS_TEMPLATE_ARGS
+    void SPIBUS_TEMPLATE_QUALIFIER::Wait()
+    {
+        while(_busy) ;
+    }
+
+    SPIBUS_TEMPLATE_ARGS
+    unsigned SPIBUS_TEMPLATE_QUALIFIER::Pending()
+    {
+        return _queue.size();
+    }
+
+    SPIBUS_TEMPLATE_ARGS
+    void SPIBUS_TEMPLATE_QUALIFIER::Start(const SpiTransaction& transaction)
+    {
+        _active = transaction;
+        Configure(transaction.configKey);
+        if(transaction.select)
+            transaction.select();
+        _Spi::SendAsync(transaction.transmitBuffer, transaction.receiveBuffer, transaction.size, TransferHandler);
+    }
+
+    SPIBUS_TEMPLATE_ARGS
+    void SPIBUS_TEMPLATE_QUALIFIER::TransferHandler(void* data, unsigned size, bool success)
+    {
+        SpiTransaction completed = _active;
+
+        while(_Spi::Busy()) ;
+        if(completed.release)
+            completed.release();
+
+        if(!_queue.empty())
+        {
+            SpiTransaction next = _queue.front();
+            _queue.pop_front();
+            Start(next);
+        }
+        else
+        {
+            _busy = false;
+        }
+
+        if(completed.callback)
+            completed.callback(data, size, success);
+    }
+
+    #define SPIDEVICE_TEMPLATE_ARGS template<typename _Bus, typename _CsPin, typename _Config>
+    #define SPIDEVICE_TEMPLATE_QUALIFIER SpiDevice<_Bus, _CsPin, _Config>
+
+    SPIDEVICE_TEMPLATE_ARGS
+    void SPIDEVICE_TEMPLATE_QUALIFIER::Init()
+    {
+        _CsPin::Port::Enable();
+        _CsPin::template SetConfiguration<_CsPin::Configuration::Out>();
+        _CsPin::template SetDriverType<_CsPin::DriverType::PushPull>();
+        _CsPin::Set();
+    }
+
+    SPIDEVICE_TEMPLATE_ARGS
+    void SPIDEVICE_TEMPLATE_QUALIFIER::Select()
+    {
+        _Bus::Wait();
+        Activate();
+    }
+
+    SPIDEVICE_TEMPLATE_ARGS
+    void SPIDEVICE_TEMPLATE_QUALIFIER::Release()
+    {
+        _CsPin::Set();
+    }
+
+    SPIDEVICE_TEMPLATE_ARGS
+    uint16_t SPIDEVICE_TEMPLATE_QUALIFIER::Send(uint16_t value)
+    {
+        return _Bus::Spi::Send(value);
+    }
+
+    SPIDEVICE_TEMPLATE_ARGS
+    void SPIDEVICE_TEMPLATE_QUALIFIER::Transfer(const void* transmitBuffer, void* receiveBuffer, size_t size)
+    {
+        Select();
+        _Bus::Spi::Transfer(transmitBuffer, receiveBuffer, size);
+        Release();
+    }
+
+    SPIDEVICE_TEMPLATE_ARGS
+    bool SPIDEVICE_TEMPLATE_QUALIFIER::TransferAsync(void* transmitBuffer, void* receiveBuffer, size_t size, TransferCallback callback)
+    {
+        return _Bus::Enqueue(SpiTransaction{_Config::Key, Activate, Release, transmitBuffer, receiveBuffer, size, callback});
+    }
+
+    SPIDEVICE_TEMPLATE_ARGS
+    void SPIDEVICE_TEMPLATE_QUALIFIER::Activate()
+    {
+        _Bus::Configure(_Config::Key);
+        _CsPin::Clear();
+    }
+}
+
+#endif //! ZHELE_SPI_BUS_IMPL_H
@@ -0,0 +1,363 @@
+/**
+ * @file
+ * Implements multi-node time synchronization
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIME_SYNC_IMPL_H
+#define ZHELE_TIME_SYNC_IMPL_H
+
+#include <cstring>
+
+namespace Zhele
+{
+    #define TIME_SYNC_TEMPLATE_ARGS template<typename _Clock, unsigned _Entries, uint32_t _MaxError>
+    #define TIME_SYNC_TEMPLATE_QUALIFIER TimeSync<_Clock, _Entries, _MaxError>
+
+    TIME_SYNC_TEMPLATE_ARGS
+    void TIME_SYNC_TEMPLATE_QUALIFIER::Init(uint8_t node, bool root)
+    {
+        _node = node;
+        _root = root;
+        _rootNode = root ? node : NoNode;
+
+        _sequence = 0;
+        _txPending = false;
+        _lastBeaconTime = Message::InvalidTime;
+        _pendingValid = false;
+
+        _lastBeaconRxTime = Message::InvalidTime;
+        _delayState = DelayState::Idle;
+        _delay = 0;
+        _delayValid = false;
+
+        _count = 0;
+        _next = 0;
+        _regression[0] = {};
+        _regression[1] = {};
+        _version = 0;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    bool TIME_SYNC_TEMPLATE_QUALIFIER::IsRoot()
+    {
+        return _root;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    bool TIME_SYNC_TEMPLATE_QUALIFIER::IsSynchronized()
+    {
+        return _root || _count >= MinEntries;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    uint64_t TIME_SYNC_TEMPLATE_QUALIFIER::GlobalTime()
+    {
+        return ToGlobal(_Clock::Now());
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    uint64_t TIME_SYNC_TEMPLATE_QUALIFIER::ToGlobal(uint64_t local)
+    {
+        if (_root)
+            return local;
+
+        return local + Offset(CurrentRegression(), local);
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    uint64_t TIME_SYNC_TEMPLATE_QUALIFIER::ToLocal(uint64_t global)
+    {
+        if (_root)
+            return global;
+
+        Regression regression = CurrentRegression();
+        // Offset changes slowly, so one iteration is enough
+        uint64_t local = global - regression.OffsetAverage;
+        return global - Offset(regression, local);
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    float TIME_SYNC_TEMPLATE_QUALIFIER::Skew()
+    {
+        return _root ? 0 : CurrentRegression().Skew;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    int32_t TIME_SYNC_TEMPLATE_QUALIFIER::LinkDelay()
+    {
+        return _delay;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    void TIME_SYNC_TEMPLATE_QUALIFIER::SetLinkDelay(int32_t delay)
+    {
+        _delay = delay;
+        _delayValid = true;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    bool TIME_SYNC_TEMPLATE_QUALIFIER::MakeBeacon(Message& message)
+    {
+        if (!_root)
+            return false;
+
+        message.Kind = Message::Type::Beacon;
+        message.Node = _node;
+        message.Sequence = ++_sequence;
+        // Previous beacon time is valid only if it was transmitted
+        message.Time = _lastBeaconTime;
+        _lastBeaconTime = Message::InvalidTime;
+
+        _txKind = Message::Type::Beacon;
+        _txPending = true;
+        return true;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    bool TIME_SYNC_TEMPLATE_QUALIFIER::MakeDelayRequest(Message& message)
+    {
+        if (_root || _rootNode == NoNode)
+            return false;
+
+        message.Kind = Message::Type::DelayRequest;
+        message.Node = _node;
+        message.Sequence = ++_sequence;
+        message.Time = Message::InvalidTime;
+
+        // Previous request (if any) is abandoned
+        _delayState = DelayState::Requesting;
+        _txKind = Message::Type::DelayRequest;
+        _txPending = true;
+        return true;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    bool TIME_SYNC_TEMPLATE_QUALIFIER::NextMessage(Message& message)
+    {
+        if (!_pendingValid)
+            return false;
+
+        message = _pending;
+        _pendingValid = false;
+
+        _txKind = message.Kind;
+        _txPending = true;
+        return true;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    void TIME_SYNC_TEMPLATE_QUALIFIER::TxEvent(uint64_t time)
+    {
+        if (!_txPending)
+            return;
+        _txPending = false;
+
+        switch (_txKind)
+        {
+        case Message::Type::Beacon:
+            _lastBeaconTime = time;
+            break;
+        case Message::Type::DelayRequest:
+            if (_delayState == DelayState::Requesting)
+            {
+                _t1 = time;
+                _delayState = DelayState::Requested;
+            }
+            break;
+        case Message::Type::DelayResponse:
+            // Response is still in pending slot (requests are dropped while it's busy)
+            _pending.Kind = Message::Type::FollowUp;
+            _pending.Time = time;
+            _pendingValid = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    void TIME_SYNC_TEMPLATE_QUALIFIER::RxEvent(uint64_t time)
+    {
+        _rxTime = time;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    void TIME_SYNC_TEMPLATE_QUALIFIER::Received(const Message& message)
+    {
+        switch (message.Kind)
+        {
+        case Message::Type::Beacon:
+            HandleBeacon(message);
+            break;
+        case Message::Type::DelayRequest:
+            HandleDelayRequest(message);
+            break;
+        case Message::Type::DelayResponse:
+            HandleDelayResponse(message);
+            break;
+        case Message::Type::FollowUp:
+            HandleFollowUp(message);
+            break;
+        }
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    bool TIME_SYNC_TEMPLATE_QUALIFIER::Received(const void* data, unsigned size)
+    {
+        if (size != sizeof(Message))
+            return false;
+
+        Message message;
+        std::memcpy(&message, data, sizeof(Message));
+        if (message.Kind > Message::Type::FollowUp)
+            return false;
+
+        Received(message);
+        return true;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    typename TIME_SYNC_TEMPLATE_QUALIFIER::Regression TIME_SYNC_TEMPLATE_QUALIFIER::CurrentRegression()
+    {
+        Regression regression;
+        unsigned version;
+
+        // Writer fills inactive buffer and then increments version, so retry if version is changed during copy
+        do
+        {
+            version = _version;
+            regression = _regression[version & 1];
+        } while (version != _version);
+
+        return regression;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    void TIME_SYNC_TEMPLATE_QUALIFIER::AddEntry(uint64_t local, uint64_t global)
+    {
+        int64_t offset = static_cast<int64_t>(global - local);
+
+        if (_count >= MinEntries)
+        {
+            int64_t error = offset - Offset(_regression[_version & 1], local);
+            if (error > static_cast<int64_t>(_MaxError) || error < -static_cast<int64_t>(_MaxError))
+            {
+                // Clock jumped (or root is changed), restart regression
+                _count = 0;
+                _next = 0;
+            }
+        }
+
+        _locals[_next] = local;
+        _offsets[_next] = offset;
+        _next = (_next + 1) % _Entries;
+        if (_count < _Entries)
+            ++_count;
+
+        // Values are relative to newest entry, so they fit float mantissa
+        float localMean = 0;
+        float offsetMean = 0;
+        for (unsigned i = 0; i < _count; ++i)
+        {
+            localMean += static_cast<float>(static_cast<int64_t>(_locals[i] - local));
+            offsetMean += static_cast<float>(_offsets[i] - offset);
+        }
+        localMean /= _count;
+        offsetMean /= _count;
+
+        float covariance = 0;
+        float variance = 0;
+        for (unsigned i = 0; i < _count; ++i)
+        {
+            float dl = static_cast<float>(static_cast<int64_t>(_locals[i] - local)) - localMean;
+            float doff = static_cast<float>(_offsets[i] - offset) - offsetMean;
+            covariance += dl * doff;
+            variance += dl * dl;
+        }
+
+        Regression& regression = _regression[(_version + 1) & 1];
+        regression.LocalAverage = local + static_cast<int64_t>(localMean);
+        regression.OffsetAverage = offset + static_cast<int64_t>(offsetMean);
+        regression.Skew = variance > 0 ? covariance / variance : 0;
+        _version = _version + 1;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    int64_t TIME_SYNC_TEMPLATE_QUALIFIER::Offset(const Regression& regression, uint64_t local)
+    {
+        float delta = static_cast<float>(static_cast<int64_t>(local - regression.LocalAverage));
+        return regression.OffsetAverage + static_cast<int64_t>(regression.Skew * delta);
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    void TIME_SYNC_TEMPLATE_QUALIFIER::HandleBeacon(const Message& message)
+    {
+        // Node follows first heard root (call Init to change it)
+        if (_root || (_rootNode != NoNode && _rootNode != message.Node))
+            return;
+        _rootNode = message.Node;
+
+        if (message.Time != Message::InvalidTime
+            && _lastBeaconRxTime != Message::InvalidTime
+            && static_cast<uint16_t>(_lastBeaconSequence + 1) == message.Sequence)
+        {
+            AddEntry(_lastBeaconRxTime, message.Time + _delay);
+        }
+
+        _lastBeaconSequence = message.Sequence;
+        _lastBeaconRxTime = _rxTime;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    void TIME_SYNC_TEMPLATE_QUALIFIER::HandleDelayRequest(const Message& message)
+    {
+        // Drop request while previous response is not sent
+        if (!_root || _pendingValid)
+            return;
+
+        _pending.Kind = Message::Type::DelayResponse;
+        _pending.Node = message.Node;
+        _pending.Sequence = message.Sequence;
+        _pending.Time = _rxTime;
+        _pendingValid = true;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    void TIME_SYNC_TEMPLATE_QUALIFIER::HandleDelayResponse(const Message& message)
+    {
+        if (message.Node != _node || _delayState != DelayState::Requested || message.Sequence != _sequence)
+            return;
+
+        _t2 = message.Time;
+        _t4 = _rxTime;
+        _delayState = DelayState::Responded;
+    }
+
+    TIME_SYNC_TEMPLATE_ARGS
+    void TIME_SYNC_TEMPLATE_QUALIFIER::HandleFollowUp(const Message& message)
+    {
+        if (message.Node != _node || _delayState != DelayState::Responded || message.Sequence != _sequence)
+            return;
+        _delayState = DelayState::Idle;
+
+        // Round trip without root processing time
+        int64_t roundTrip = static_cast<int64_t>(_t4 - _t1) - static_cast<int64_t>(message.Time - _t2);
+        int32_t delay = static_cast<int32_t>(roundTrip / 2);
+
+        if (!_delayValid)
+        {
+            _delay = delay;
+            _delayValid = true;
+        }
+        else
+        {
+            _delay += (delay - _delay) / (1 << DelayFilterShift);
+        }
+    }
+}
+
+#endif //! ZHELE_TIME_SYNC_IMPL_H
@@ -0,0 +1,57 @@
+/**
+ * @file
+ * Implements timers chaining (master/slave)
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIMER_CHAIN_IMPL_H
+#define ZHELE_TIMER_CHAIN_IMPL_H
+
+namespace Zhele::Timers
+{
+    template<typename _Master, typename _Slave>
+    void TimerChain<_Master, _Slave>::Connect(MasterMode masterMode, typename SlaveMode::Mode slaveMode)
+    {
+        _Master::SetMasterMode(masterMode);
+
+        // Trigger must be selected while slave mode is disabled
+        SlaveMode::DisableSlaveMode();
+        SlaveMode::SelectTrigger(Trigger);
+        SlaveMode::EnableSlaveMode(slaveMode);
+    }
+
+    template<typename _Master, typename _Slave>
+    void TimerChain<_Master, _Slave>::EnableExternalClock()
+    {
+        Connect(MasterMode::Update, SlaveMode::Mode::ExternalClockMode);
+    }
+
+    template<typename _Master, typename _Slave>
+    void TimerChain<_Master, _Slave>::EnableGatedMode(MasterMode masterMode)
+    {
+        Connect(masterMode, SlaveMode::Mode::GatedMode);
+    }
+
+    template<typename _Master, typename _Slave>
+    void TimerChain<_Master, _Slave>::EnableResetMode(MasterMode masterMode)
+    {
+        Connect(masterMode, SlaveMode::Mode::ResetMode);
+    }
+
+    template<typename _Master, typename _Slave>
+    void TimerChain<_Master, _Slave>::EnableTriggerMode(MasterMode masterMode)
+    {
+        Connect(masterMode, SlaveMode::Mode::TriggerMode);
+    }
+
+    template<typename _Master, typename _Slave>
+    void TimerChain<_Master, _Slave>::Disconnect()
+    {
+        SlaveMode::DisableSlaveMode();
+    }
+}
+
+#endif //! ZHELE_TIMER_CHAIN_IMPL_H
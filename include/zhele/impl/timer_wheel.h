@@ -0,0 +1,221 @@
+/**
+ * @file
+ * Implements software timers on one hardware timer
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIMER_WHEEL_IMPL_H
+#define ZHELE_TIMER_WHEEL_IMPL_H
+
+#include <bit>
+
+namespace Zhele::Timers
+{
+    #define TIMERWHEEL_TEMPLATE_ARGS template<typename _Timer, unsigned _Channel, unsigned _Slots>
+    #define TIMERWHEEL_TEMPLATE_QUALIFIER TimerWheel<_Timer, _Channel, _Slots>
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Init(typename _Timer::Prescaler prescaler)
+    {
+        _now = 0;
+
+        _Timer::Enable();
+        _Timer::Stop();
+        _Timer::SetPrescaler(prescaler);
+        _Timer::SetPeriod(static_cast<Counter>(~0u));
+        _Timer::ResetCounterValue();
+
+        Channel::SetOutputMode(Channel::Timing);
+        Channel::SetPulse(static_cast<Counter>(_Slots));
+        Channel::ClearInterruptFlag();
+        Channel::EnableInterrupt();
+
+        _Timer::Start();
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Start(Task& task, uint32_t delay, uint32_t period)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        if (task._active)
+            Unlink(task);
+
+        task._deadline = _now + Elapsed() + (delay > 0 ? delay : 1);
+        task._period = period;
+        Link(task);
+        Schedule();
+
+        __set_PRIMASK(primask);
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Stop(Task& task)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        // Wake up for empty slot is harmless, so there is no reschedule
+        if (task._active)
+            Unlink(task);
+
+        __set_PRIMASK(primask);
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    uint32_t TIMERWHEEL_TEMPLATE_QUALIFIER::Now()
+    {
+        uint32_t now;
+        uint32_t elapsed;
+
+        // Time base can be moved forward by interrupt during read
+        do
+        {
+            now = _now;
+            elapsed = Elapsed();
+        } while (now != _now);
+
+        return now + elapsed;
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        if (!Channel::IsInterrupt())
+            return;
+
+        Channel::ClearInterruptFlag();
+
+        uint32_t now = _now + Elapsed();
+        while (true)
+        {
+            unsigned distance = NextSlotDistance();
+            if (distance > now - _now)
+                break;
+
+            _now += distance;
+            Expire(_now);
+        }
+        _now = now;
+
+        Schedule();
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    uint32_t TIMERWHEEL_TEMPLATE_QUALIFIER::Elapsed()
+    {
+        return static_cast<Counter>(_Timer::GetCounterValue() - static_cast<Counter>(_now));
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Link(Task& task)
+    {
+        unsigned slot = task._deadline & SlotMask;
+
+        task._prev = nullptr;
+        task._next = _slots[slot];
+        if (task._next != nullptr)
+            task._next->_prev = &task;
+        _slots[slot] = &task;
+        _occupied[slot / 32] |= (1u << (slot % 32));
+        task._active = true;
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Unlink(Task& task)
+    {
+        unsigned slot = task._deadline & SlotMask;
+
+        if (task._prev != nullptr)
+            task._prev->_next = task._next;
+        else
+            _slots[slot] = task._next;
+
+        if (task._next != nullptr)
+            task._next->_prev = task._prev;
+
+        if (_slots[slot] == nullptr)
+            _occupied[slot / 32] &= ~(1u << (slot % 32));
+
+        task._active = false;
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Expire(uint32_t time)
+    {
+        Task* task = _slots[time & SlotMask];
+        while (task != nullptr)
+        {
+            // Slot also contains tasks of next wheel revolutions
+            if (task->_deadline != time)
+            {
+                task = task->_next;
+                continue;
+            }
+
+            Unlink(*task);
+            if (task->_period != 0)
+            {
+                task->_deadline += task->_period;
+                Link(*task);
+            }
+            task->_callback();
+
+            // Callback can start or stop other tasks, so scan slot again
+            task = _slots[time & SlotMask];
+        }
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    unsigned TIMERWHEEL_TEMPLATE_QUALIFIER::NextSlotDistance()
+    {
+        unsigned start = (_now + 1) & SlotMask;
+
+        for (unsigned i = 0; i <= BitmapWords; ++i)
+        {
+            unsigned word = (start / 32 + i) % BitmapWords;
+            uint32_t bits = _occupied[word];
+
+            // Skip slots before start in the first word (they are checked last)
+            if (i == 0)
+                bits &= ~0u << (start % 32);
+            else if (i == BitmapWords)
+                bits &= ~(~0u << (start % 32));
+
+            if (bits != 0)
+            {
+                unsigned slot = word * 32 + std::countr_zero(bits);
+                return ((slot - start) & SlotMask) + 1;
+            }
+        }
+
+        // No tasks: wake up once per revolution to keep time base
+        return _Slots;
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Schedule()
+    {
+        unsigned distance = NextSlotDistance();
+        Channel::SetPulse(static_cast<Counter>(_now + distance));
+
+        // Deadline could be passed before compare register update
+        if (Elapsed() >= distance)
+            Channel::GenerateEvent();
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    typename TIMERWHEEL_TEMPLATE_QUALIFIER::Task* TIMERWHEEL_TEMPLATE_QUALIFIER::_slots[_Slots];
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    uint32_t TIMERWHEEL_TEMPLATE_QUALIFIER::_occupied[BitmapWords];
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    volatile uint32_t TIMERWHEEL_TEMPLATE_QUALIFIER::_now = 0;
+}
+
+#endif //! ZHELE_TIMER_WHEEL_IMPL_H
@@ -0,0 +1,98 @@
+/**
+ * @file
+ * Implements extended timestamp counters
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIMESTAMP_IMPL_H
+#define ZHELE_TIMESTAMP_IMPL_H
+
+namespace Zhele::Timers
+{
+    template<typename _Timer>
+    void Timestamp<_Timer>::Init(typename _Timer::Prescaler prescaler)
+    {
+        _overflows = 0;
+
+        _Timer::Enable();
+        _Timer::Stop();
+        _Timer::SetPrescaler(prescaler);
+        _Timer::SetPeriod(static_cast<typename _Timer::Counter>(~0u));
+        _Timer::ResetCounterValue();
+        _Timer::ClearInterruptFlag();
+        _Timer::EnableInterrupt(_Timer::Interrupt::Update);
+        _Timer::Start();
+    }
+
+    template<typename _Timer>
+    uint64_t Timestamp<_Timer>::Now()
+    {
+        uint32_t overflows;
+        uint32_t counter;
+        bool pending;
+
+        do
+        {
+            overflows = _overflows;
+            counter = _Timer::GetCounterValue();
+            pending = _Timer::IsInterrupt();
+            // Counter could be read before overflow, read it again after flag
+            if (pending)
+                counter = _Timer::GetCounterValue();
+        } while (overflows != _overflows);
+
+        return ((static_cast<uint64_t>(overflows) + (pending ? 1 : 0)) << CounterBits) | counter;
+    }
+
+    template<typename _Timer>
+    void Timestamp<_Timer>::IrqHandler()
+    {
+        if (_Timer::IsInterrupt())
+        {
+            _Timer::ClearInterruptFlag();
+            _overflows = _overflows + 1;
+        }
+    }
+
+    template<typename _Timer>
+    volatile uint32_t Timestamp<_Timer>::_overflows = 0;
+
+    template<typename _Master, typename _Slave>
+    void CascadedTimestamp<_Master, _Slave>::Init(typename _Master::Prescaler prescaler)
+    {
+        _Slave::Enable();
+        _Slave::Stop();
+        _Slave::SetPrescaler(0);
+        _Slave::SetPeriod(static_cast<typename _Slave::Counter>(~0u));
+        _Slave::ResetCounterValue();
+        TimerChain<_Master, _Slave>::EnableExternalClock();
+        _Slave::Start();
+
+        _Master::Enable();
+        _Master::Stop();
+        _Master::SetPrescaler(prescaler);
+        _Master::SetPeriod(static_cast<typename _Master::Counter>(~0u));
+        _Master::ResetCounterValue();
+        _Master::Start();
+    }
+
+    template<typename _Master, typename _Slave>
+    uint32_t CascadedTimestamp<_Master, _Slave>::Now()
+    {
+        uint32_t high;
+        uint32_t low;
+
+        do
+        {
+            high = _Slave::GetCounterValue();
+            low = _Master::GetCounterValue();
+        } while (high != _Slave::GetCounterValue());
+
+        return (high << CounterBits) | low;
+    }
+}
+
+#endif //! ZHELE_TIMESTAMP_IMPL_H
@@ -0,0 +1,159 @@
+/**
+ * @file
+ * Implements capacitive touch keys over touch sensing controller
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TOUCH_KEYS_IMPL_H
+#define ZHELE_TOUCH_KEYS_IMPL_H
+
+namespace Zhele
+{
+    #define TOUCH_KEYS_TEMPLATE_ARGS template<typename _Tsc, uint16_t _Threshold, typename... _Keys>
+    #define TOUCH_KEYS_TEMPLATE_QUALIFIER TouchKeys<_Tsc, _Threshold, _Keys...>
+
+    TOUCH_KEYS_TEMPLATE_ARGS
+    void TOUCH_KEYS_TEMPLATE_QUALIFIER::Init(ChangeCallback callback)
+    {
+        _callback = callback;
+        Recalibrate();
+        _busy = false;
+        _bank = 0;
+
+        _Tsc::template SelectChannelPins<_Keys...>();
+        _Tsc::ClearInterruptFlag();
+        _Tsc::EnableInterrupt();
+    }
+
+    TOUCH_KEYS_TEMPLATE_ARGS
+    bool TOUCH_KEYS_TEMPLATE_QUALIFIER::Scan()
+    {
+        if (_busy)
+            return false;
+
+        _busy = true;
+        _Tsc::SetChannels(_bankChannels[_bank]);
+        _Tsc::StartAcquisition();
+
+        return true;
+    }
+
+    TOUCH_KEYS_TEMPLATE_ARGS
+    void TOUCH_KEYS_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        _Tsc::ClearInterruptFlag();
+
+        // Failed groups (max count error) have no status flag, their keys are skipped
+        for (unsigned key = 0; key < KeysCount; ++key)
+        {
+            if (_banks[key] == _bank && _Tsc::IsGroupComplete(_groups[key]))
+                Update(key, _Tsc::GetGroupCount(_groups[key]));
+        }
+
+        _bank = _bank + 1u < BanksCount ? _bank + 1 : 0;
+        _busy = false;
+    }
+
+    TOUCH_KEYS_TEMPLATE_ARGS
+    void TOUCH_KEYS_TEMPLATE_QUALIFIER::Recalibrate()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        for (unsigned key = 0; key < KeysCount; ++key)
+        {
+            _baseline[key] = 0;
+            _calibration[key] = 0;
+            _debounce[key] = 0;
+        }
+        _touched = 0;
+        __set_PRIMASK(primask);
+    }
+
+    TOUCH_KEYS_TEMPLATE_ARGS
+    bool TOUCH_KEYS_TEMPLATE_QUALIFIER::IsCalibrated()
+    {
+        for (unsigned key = 0; key < KeysCount; ++key)
+        {
+            if (_calibration[key] < CalibrationSamples)
+                return false;
+        }
+        return true;
+    }
+
+    TOUCH_KEYS_TEMPLATE_ARGS
+    bool TOUCH_KEYS_TEMPLATE_QUALIFIER::IsTouched(unsigned key)
+    {
+        return _touched & (1ul << key);
+    }
+
+    TOUCH_KEYS_TEMPLATE_ARGS
+    uint32_t TOUCH_KEYS_TEMPLATE_QUALIFIER::TouchedMask()
+    {
+        return _touched;
+    }
+
+    TOUCH_KEYS_TEMPLATE_ARGS
+    int16_t TOUCH_KEYS_TEMPLATE_QUALIFIER::Delta(unsigned key)
+    {
+        if (_calibration[key] < CalibrationSamples)
+            return 0;
+        return static_cast<int16_t>((_baseline[key] - _filtered[key]) >> FractionBits);
+    }
+
+    TOUCH_KEYS_TEMPLATE_ARGS
+    uint16_t TOUCH_KEYS_TEMPLATE_QUALIFIER::Baseline(unsigned key)
+    {
+        if (_calibration[key] < CalibrationSamples)
+            return 0;
+        return static_cast<uint16_t>(_baseline[key] >> FractionBits);
+    }
+
+    TOUCH_KEYS_TEMPLATE_ARGS
+    void TOUCH_KEYS_TEMPLATE_QUALIFIER::Update(unsigned key, uint16_t count)
+    {
+        int32_t value = static_cast<int32_t>(count) << FractionBits;
+
+        if (_calibration[key] < CalibrationSamples)
+        {
+            _baseline[key] += value;
+            if (++_calibration[key] == CalibrationSamples)
+            {
+                _baseline[key] /= CalibrationSamples;
+                _filtered[key] = _baseline[key];
+            }
+            return;
+        }
+
+        _filtered[key] += (value - _filtered[key]) >> FilterShift;
+        int32_t delta = (_baseline[key] - _filtered[key]) >> FractionBits;
+
+        uint32_t mask = 1ul << key;
+        bool touched = _touched & mask;
+        bool detected = delta >= (touched ? ReleaseThreshold : static_cast<int32_t>(_Threshold));
+
+        if (detected != touched)
+        {
+            if (++_debounce[key] >= DebounceSamples)
+            {
+                _debounce[key] = 0;
+                touched = detected;
+                _touched = touched ? (_touched | mask) : (_touched & ~mask);
+                if (_callback)
+                    _callback(key, touched);
+            }
+        }
+        else
+        {
+            _debounce[key] = 0;
+        }
+
+        // Baseline is frozen while key is touched or touch is being debounced
+        if (!touched && _debounce[key] == 0)
+            _baseline[key] += (_filtered[key] - _baseline[key]) >> (delta < 0 ? RecoveryShift : BaselineShift);
+    }
+}
+
+#endif //! ZHELE_TOUCH_KEYS_IMPL_H
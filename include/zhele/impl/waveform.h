@@ -0,0 +1,123 @@
+/**
+ * @file
+ * Implements compile-time waveform tables
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_WAVEFORM_IMPL_H
+#define ZHELE_WAVEFORM_IMPL_H
+
+namespace Zhele::Waveform
+{
+    namespace Private
+    {
+        static constexpr double Pi = 3.14159265358979323846;
+
+        constexpr double Sin(double x)
+        {
+            // Reduce to [-pi, pi], then to [-pi/2, pi/2]
+            long turns = static_cast<long>(x / (2 * Pi) + (x < 0 ? -0.5 : 0.5));
+            x -= turns * 2 * Pi;
+            if (x > Pi / 2)
+                x = Pi - x;
+            else if (x < -Pi / 2)
+                x = -Pi - x;
+
+            double term = x;
+            double result = x;
+            for (int n = 1; n < 12; ++n)
+            {
+                term *= -x * x / ((2 * n) * (2 * n + 1));
+                result += term;
+            }
+            return result;
+        }
+
+        constexpr double Exp(double x)
+        {
+            // exp(x) = exp(x / 2^k) ^ (2^k)
+            int halvings = 0;
+            while (x > 0.5 || x < -0.5)
+            {
+                x /= 2;
+                ++halvings;
+            }
+
+            double term = 1;
+            double result = 1;
+            for (int n = 1; n < 16; ++n)
+            {
+                term *= x / n;
+                result += term;
+            }
+
+            while (halvings-- > 0)
+                result *= result;
+            return result;
+        }
+
+        template<uint16_t _MaxValue>
+        constexpr uint16_t Scale(double value)
+        {
+            if (value <= 0)
+                return 0;
+            if (value >= 1)
+                return _MaxValue;
+            return static_cast<uint16_t>(value * _MaxValue + 0.5);
+        }
+    }
+
+    template<size_t _Size, uint16_t _MaxValue, typename _Function>
+    consteval std::array<uint16_t, _Size> Generate(_Function function)
+    {
+        static_assert(_Size > 0, "Table must not be empty");
+
+        std::array<uint16_t, _Size> table{};
+        for (size_t i = 0; i < _Size; ++i)
+        {
+            table[i] = Private::Scale<_MaxValue>(function(static_cast<double>(i) / _Size));
+        }
+        return table;
+    }
+
+    template<size_t _Size, uint16_t _MaxValue>
+    consteval std::array<uint16_t, _Size> Sine()
+    {
+        return Generate<_Size, _MaxValue>([](double phase) { return (1 + Private::Sin(2 * Private::Pi * phase)) / 2; });
+    }
+
+    template<size_t _Size, uint16_t _MaxValue>
+    consteval std::array<uint16_t, _Size> Cosine()
+    {
+        return Generate<_Size, _MaxValue>([](double phase) { return (1 + Private::Sin(2 * Private::Pi * phase + Private::Pi / 2)) / 2; });
+    }
+
+    template<size_t _Size, uint16_t _MaxValue>
+    consteval std::array<uint16_t, _Size> Triangle()
+    {
+        return Generate<_Size, _MaxValue>([](double phase) { return phase < 0.5 ? 2 * phase : 2 * (1 - phase); });
+    }
+
+    template<size_t _Size, uint16_t _MaxValue>
+    consteval std::array<uint16_t, _Size> Sawtooth()
+    {
+        // Last sample reaches max value
+        return Generate<_Size, _MaxValue>([](double phase) { return _Size > 1 ? phase * _Size / (_Size - 1) : 0; });
+    }
+
+    template<size_t _Size, uint16_t _MaxValue>
+    consteval std::array<uint16_t, _Size> ExponentialDecay(double timeConstant)
+    {
+        std::array<uint16_t, _Size> table{};
+        for (size_t i = 0; i < _Size; ++i)
+        {
+            table[i] = Private::Scale<_MaxValue>(Private::Exp(-static_cast<double>(i) / timeConstant));
+        }
+        return table;
+    }
+}
+
+#endif //! ZHELE_WAVEFORM_IMPL_H
@@ -0,0 +1,299 @@
+/**
+ * @file
+ * Implements compile-time interrupt binding
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_IRQ_H
+#define ZHELE_IRQ_H
+
+#if defined(STM32F0)
+    #include <stm32f0xx.h>
+#endif
+#if defined(STM32F1)
+    #include <stm32f1xx.h>
+#endif
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+#if defined(STM32L4)
+    #include <stm32l4xx.h>
+#endif
+#if defined(STM32G0)
+    #include <stm32g0xx.h>
+#endif
+
+#include "common/template_utils/type_list.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Defines interrupt vector handler that calls IrqHandler of given handlers directly
+ *
+ * @details
+ * Handlers are types with static IrqHandler method (DMA channels, @ref Zhele::Irq::Function and so on),
+ * they are called in given order (for shared vectors) without any indirection.
+ *
+ * @par Example
+ * @code
+ *  ZHELE_IRQ_HANDLER(DMA1_Channel2_3, Dma1Channel2, Dma1Channel3);
+ *  ZHELE_IRQ_HANDLER(USART1, Irq::Function<Usart1::CircularReadIrqHandler>);
+ * @endcode
+ *
+ * @param Vector Vector name without "_IRQHandler" suffix (USART1, DMA1_Channel4 and so on)
+ * @param ... Handlers
+ */
+#define ZHELE_IRQ_HANDLER(Vector, ...) \
+    extern "C" void Vector##_IRQHandler() { Zhele::Irq::Handlers<__VA_ARGS__>::IrqHandler(); }
+
+namespace Zhele::Irq
+{
+    /**
+     * @brief Adapts function to handler type
+     *
+     * @tparam _Function Function (static method)
+     */
+    template<auto _Function>
+    struct Function
+    {
+        static void IrqHandler() { _Function(); }
+    };
+
+    /**
+     * @brief Interrupt line for priority table (for sources without IRQNumber member)
+     *
+     * @tparam _IRQNumber IRQ number
+     */
+    template<IRQn_Type _IRQNumber>
+    struct Line
+    {
+        static constexpr IRQn_Type IRQNumber = _IRQNumber;
+    };
+
+    /**
+     * @brief Calls IrqHandler of all handlers
+     *
+     * @tparam _Handlers Handlers
+     */
+    template<typename... _Handlers>
+    struct Handlers
+    {
+        static_assert(sizeof...(_Handlers) > 0, "Vector without handlers");
+
+        static void IrqHandler() { (_Handlers::IrqHandler(), ...); }
+    };
+
+    /**
+     * @brief Interrupt priority
+     *
+     * @tparam _Source Interrupt source with IRQNumber member (DMA channel, timer, USART, EXTI, @ref Line)
+     * @tparam _Preempt Preemption priority (0 is the highest)
+     * @tparam _Sub Subpriority (order of pending interrupts with the same preemption priority)
+     */
+    template<typename _Source, uint8_t _Preempt, uint8_t _Sub = 0>
+    struct Priority
+    {
+        static constexpr IRQn_Type IRQNumber = _Source::IRQNumber;
+        static constexpr uint8_t Preempt = _Preempt;
+        static constexpr uint8_t Sub = _Sub;
+    };
+
+    /**
+     * @brief Critical section (RAII)
+     *
+     * @details
+     * Masks interrupts with preemption priority value equal or greater than given level (BASEPRI on Cortex-M3 and higher),
+     * so higher priority handlers keep their latency. Level 0 (and any level on Cortex-M0/M0+) masks all interrupts.
+     * Sections can be nested: inner section never lowers mask of outer section, previous state is restored on exit.
+     * Level is preemption priority, so with grouping it must be used with @ref GroupedPriorityTable::PreemptOf
+     * (or @ref GroupedPriorityTable::CriticalSectionFor).
+     *
+     * @par Example
+     * @code
+     *  {
+     *      Irq::CriticalSection<Priorities::PreemptOf<Usart2>> lock;
+     *      logQueue.push_back(value); // Shared with USART2 handler, USB handler is not masked
+     *  }
+     * @endcode
+     *
+     * @tparam _Level Highest masked preemption priority
+     * @tparam _PreemptBits Preemption priority bits count
+     */
+    template<uint8_t _Level, unsigned _PreemptBits = __NVIC_PRIO_BITS>
+    class CriticalSection
+    {
+        static_assert(_Level < (1u << _PreemptBits), "Level is out of preemption bits");
+
+#if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+        static constexpr bool UseBasepri = _Level != 0;
+        static constexpr uint32_t Basepri = static_cast<uint32_t>(_Level) << (8 - _PreemptBits);
+#else
+        static constexpr bool UseBasepri = false;
+#endif
+
+        uint32_t _state;
+
+    public:
+        CriticalSection()
+        {
+#if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+            if constexpr (UseBasepri)
+            {
+                _state = __get_BASEPRI();
+                __set_BASEPRI_MAX(Basepri);
+                return;
+            }
+#endif
+            _state = __get_PRIMASK();
+            __disable_irq();
+        }
+
+        ~CriticalSection()
+        {
+#if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+            if constexpr (UseBasepri)
+            {
+                __set_BASEPRI(_state);
+                return;
+            }
+#endif
+            __set_PRIMASK(_state);
+        }
+
+        CriticalSection(const CriticalSection&) = delete;
+        CriticalSection& operator=(const CriticalSection&) = delete;
+    };
+
+    /**
+     * @brief Board interrupt priorities with priority grouping
+     *
+     * @details
+     * NVIC priority field (__NVIC_PRIO_BITS wide) is split into preemption priority (high bits)
+     * and subpriority (low bits). Interrupt preempts running handler only if its preemption priority is higher,
+     * so time-critical handlers (USB, motor control) should have lower preemption value than logging ones.
+     * Every IRQ can be listed once (sharing sources, for example, timer and its DMA, should be listed by one of them).
+     * Cortex-M0/M0+ has no grouping, so all priority bits are preemption bits there.
+     *
+     * @par Example
+     * @code
+     *  using Priorities = Irq::GroupedPriorityTable<2,
+     *      Irq::Priority<Irq::Line<OTG_FS_IRQn>, 0>,
+     *      Irq::Priority<Timer2, 1>,
+     *      Irq::Priority<Dma2Stream7, 3, 1>
+     *  >;
+     *  ...
+     *  Priorities::Apply();
+     * @endcode
+     *
+     * @tparam _PreemptBits Preemption priority bits count
+     * @tparam _Priorities Priorities (@ref Priority)
+     */
+    template<unsigned _PreemptBits, typename... _Priorities>
+    class GroupedPriorityTable
+    {
+        static_assert(_PreemptBits <= __NVIC_PRIO_BITS, "Preemption bits count is greater than NVIC priority bits");
+#if !defined (__CORTEX_M) || (__CORTEX_M < 3)
+        static_assert(_PreemptBits == __NVIC_PRIO_BITS, "Cortex-M0 doesn't support priority grouping");
+#endif
+        static_assert(TemplateUtils::TypeList<Line<_Priorities::IRQNumber>...>::is_unique(), "IRQ is listed several times");
+        static_assert(((_Priorities::Preempt < (1u << _PreemptBits)) && ...), "Preemption priority is out of preemption bits");
+        static_assert(((_Priorities::Sub < (1u << (__NVIC_PRIO_BITS - _PreemptBits))) && ...), "Subpriority is out of subpriority bits");
+
+        template<typename _Priority>
+        static constexpr uint8_t Encode = (_Priority::Preempt << (__NVIC_PRIO_BITS - _PreemptBits)) | _Priority::Sub;
+
+        struct Entry
+        {
+            uint8_t Preempt;
+            uint8_t Sub;
+        };
+
+        template<typename _Source>
+        static consteval Entry Find()
+        {
+            static_assert(((_Priorities::IRQNumber == _Source::IRQNumber) || ...), "Source is not listed in priority table");
+            Entry result{};
+            ((_Priorities::IRQNumber == _Source::IRQNumber ? (result = {_Priorities::Preempt, _Priorities::Sub}, 0) : 0), ...);
+            return result;
+        }
+
+    public:
+        /// Preemption priority bits count
+        static const unsigned PreemptBits = _PreemptBits;
+
+        /**
+         * @brief Returns NVIC priority of source (preemption priority and subpriority)
+         *
+         * @tparam _Source Interrupt source
+         */
+        template<typename _Source>
+        static constexpr uint8_t PriorityOf = (Find<_Source>().Preempt << (__NVIC_PRIO_BITS - _PreemptBits)) | Find<_Source>().Sub;
+
+        /**
+         * @brief Returns preemption priority of source
+         *
+         * @tparam _Source Interrupt source
+         */
+        template<typename _Source>
+        static constexpr uint8_t PreemptOf = Find<_Source>().Preempt;
+
+        /**
+         * @brief Critical section that masks source interrupt (and all interrupts with the same or lower priority)
+         *
+         * @tparam _Source Interrupt source
+         */
+        template<typename _Source>
+        using CriticalSectionFor = CriticalSection<PreemptOf<_Source>, _PreemptBits>;
+
+        /**
+         * @brief Sets priority grouping and priorities of all listed interrupts
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Apply()
+        {
+#if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+            NVIC_SetPriorityGrouping(7 - _PreemptBits);
+#endif
+            (NVIC_SetPriority(_Priorities::IRQNumber, Encode<_Priorities>), ...);
+        }
+
+        /**
+         * @brief Sets priorities and enables all listed interrupts
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void ApplyAndEnable()
+        {
+            Apply();
+            (NVIC_EnableIRQ(_Priorities::IRQNumber), ...);
+        }
+    };
+
+    /**
+     * @brief Board interrupt priorities (all priority bits are preemption bits)
+     *
+     * @par Example
+     * @code
+     *  using Priorities = Irq::PriorityTable<
+     *      Irq::Priority<Dma1Channel4, 1>,
+     *      Irq::Priority<Timer2, 2>,
+     *      Irq::Priority<Irq::Line<USB_LP_IRQn>, 3>
+     *  >;
+     *  ...
+     *  Priorities::Apply();
+     * @endcode
+     *
+     * @tparam _Priorities Priorities (@ref Priority)
+     */
+    template<typename... _Priorities>
+    using PriorityTable = GroupedPriorityTable<__NVIC_PRIO_BITS, _Priorities...>;
+
+} // namespace Zhele::Irq
+
+#endif //! ZHELE_IRQ_H
@@ -0,0 +1,153 @@
+/**
+ * @file
+ * Implements ITM (SWO) trace output
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ITM_H
+#define ZHELE_ITM_H
+
+#if defined(STM32F1)
+    #include <stm32f1xx.h>
+#endif
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+#if defined(STM32L4)
+    #include <stm32l4xx.h>
+#endif
+
+#include <zhele/clock.h>
+
+#include <cstddef>
+#include <stdint.h>
+
+#if !defined (ITM)
+    #error "ITM is not available on Cortex-M0/M0+ cores"
+#endif
+
+namespace Zhele::Trace
+{
+    /**
+     * @brief ITM and SWO configuration
+     * 
+     * @details
+     * Debugger usually configures trace itself, Enable is needed for standalone SWO capture
+     * (with USB-UART or logic analyzer on SWO pin).
+     */
+    class Itm
+    {
+    public:
+        /**
+         * @brief Enable ITM and SWO output (NRZ/UART encoding)
+         * 
+         * @param [in] swoFrequency SWO bit rate
+         * @param [in] ports Enabled stimulus ports mask
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Enable(uint32_t swoFrequency, uint32_t ports = 0x01);
+
+        /**
+         * @brief Set SWO bit rate (TPI prescaler from core clock)
+         * 
+         * @param [in] swoFrequency SWO bit rate
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetSwoFrequency(uint32_t swoFrequency);
+
+        /**
+         * @brief Disable ITM
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Disable();
+
+        /**
+         * @brief Check that stimulus port is enabled (by debugger or Enable)
+         * 
+         * @param [in] port Stimulus port
+         * 
+         * @retval true Port is enabled
+         * @retval false Port is disabled
+         */
+        static bool IsPortEnabled(unsigned port);
+    };
+
+    /**
+     * @brief ITM stimulus port (BinaryStream compatible source)
+     * 
+     * @details
+     * Writes are ignored if port is disabled, so tracing code can stay in firmware without debugger.
+     * 
+     * @par Example
+     * @code
+     *  Trace::Itm::Enable(2000000);
+     *  BinaryStream<Trace::ItmPort<0>> trace;
+     *  trace.WriteU32Le(value);
+     *  Trace::ItmPort<1>::WriteU32(DWT->CYCCNT);
+     * @endcode
+     * 
+     * @tparam _Port Stimulus port number (0..31)
+     */
+    template<unsigned _Port>
+    class ItmPort
+    {
+        static_assert(_Port < 32, "ITM has 32 stimulus ports");
+    public:
+        /**
+         * @brief Write byte
+         * 
+         * @param [in] value Byte
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Write(uint8_t value);
+
+        /**
+         * @brief Write data (by 32-bit words where possible)
+         * 
+         * @param [in] data Data
+         * @param [in] size Data size
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Write(const void* data, size_t size);
+
+        /**
+         * @brief Write 16-bit value (one ITM packet)
+         * 
+         * @param [in] value Value
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void WriteU16(uint16_t value);
+
+        /**
+         * @brief Write 32-bit value (one ITM packet)
+         * 
+         * @param [in] value Value
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void WriteU32(uint32_t value);
+
+    private:
+        static bool WaitReady();
+    };
+}
+
+#include "impl/itm.h"
+
+#endif //! ZHELE_ITM_H
@@ -26,14 +26,14 @@ namespace Zhele::Clock
 
     inline unsigned PllClock::GetDivider()
     {
-        return PllM::Get();
+        return PllM::Get() + 1;
     }
 
     template<unsigned divider>
     inline void PllClock::SetDivider()
     {
-        static_assert(2 <= divider && divider <= PllM::MaxValue, "Invalide divider value");
-        PllM::Set(divider);
+        static_assert(1 <= divider && divider <= (PllM::MaxValue + 1), "Invalide divider value");
+        PllM::Set(divider - 1);
     }
 
     inline unsigned PllClock::GetMultipler()
@@ -44,48 +44,50 @@ namespace Zhele::Clock
     template<unsigned multiplier>
     inline void PllClock::SetMultiplier()
     {
-        static_assert(2 <= multiplier && multiplier <= 432, "Invalide multiplier value");
+        static_assert(8 <= multiplier && multiplier <= 86, "Invalide multiplier value");
         PllN::Set(multiplier);
     }  
 
     template<PllClock::ClockSource clockSource>
     inline void PllClock::SelectClockSource()
     {
-        RCC->PLLCFGR = clockSource == External
-            ? RCC->PLLCFGR  | RCC_PLLCFGR_PLLSRC_HSE
-            : RCC->PLLCFGR  & ~RCC_PLLCFGR_PLLSRC;
+        RCC->PLLCFGR = (RCC->PLLCFGR & ~RCC_PLLCFGR_PLLSRC)
+            | (clockSource == External
+                ? RCC_PLLCFGR_PLLSRC_HSE
+                : RCC_PLLCFGR_PLLSRC_HSI);
     }
 
     inline PllClock::ClockSource PllClock::GetClockSource()
     {
-        return RCC->PLLCFGR & RCC_PLLCFGR_PLLSRC_HSE
+        return (RCC->PLLCFGR & RCC_PLLCFGR_PLLSRC) == RCC_PLLCFGR_PLLSRC_HSE
             ? ClockSource::External
             : ClockSource::Internal;
     }
 
     inline unsigned PllClock::GetSystemOutputDivider()
     {
-        return (PllP::Get() >> 2) + 2;
+        return (PllR::Get() + 1) * 2;
     }
     
     template<unsigned divider>
     inline void PllClock::SetSystemOutputDivider()
     {
         static_assert(divider == 2 || divider == 4 || divider == 6 || divider == 8, "Divider can be one of 2, 4, 6, 8");
-        static constexpr uint8_t pllpValue = (divider - 2) << 2;
-        PllP::Set(pllpValue);
+        RCC->PLLCFGR |= RCC_PLLCFGR_PLLREN;
+        PllR::Set(divider / 2 - 1);
     }
 
     inline unsigned PllClock::GetUsbOutputDivider()
     {
-        return PllQ::Get();
+        return (PllQ::Get() + 1) * 2;
     }
 
     template<unsigned divider>
     inline void PllClock::SetUsbOutputDivider()
     {
-        static_assert(2 <= divider && divider <= PllQ::MaxValue, "Invalide divider value");
-        PllQ::Set(divider);
+        static_assert(divider == 2 || divider == 4 || divider == 6 || divider == 8, "Divider can be one of 2, 4, 6, 8");
+        RCC->PLLCFGR |= RCC_PLLCFGR_PLLQEN;
+        PllQ::Set(divider / 2 - 1);
     }
 
 #if defined (RCC_PLLCFGR_PLLR_Pos)
@@ -242,21 +244,23 @@ namespace Zhele::Clock
     using Tim2Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_TIM2EN, Apb1Clock>;
     using Tim6Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_TIM6EN, Apb1Clock>;
 
-    using Usart2Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_USART2EN, Apb1Clock>;
+    using Usart2Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_USART2EN, UsartKernelClock<Apb1Clock, RCC_CCIPR_USART2SEL_Pos>>;
     using WatchDogClock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_WWDGEN, Apb1Clock>;
     using I2c1Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_I2C1EN, Apb1Clock>;
     using I2c3Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_I2C3EN, Apb1Clock>;
     using PwrClock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_PWREN, Apb1Clock>;
+    using PowerClock = PwrClock;
     using OpampClock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_OPAMPEN, Apb1Clock>;
-    using LPTim1Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_LPTIM1EN, Apb1Clock>;
-    using LpUart1Clock = ClockControl<PeriphClockEnable12, RCC_APB1ENR2_LPUART1EN, Apb1Clock>;
-    using LpTim2Clock = ClockControl<PeriphClockEnable12, RCC_APB1ENR2_LPTIM2EN, Apb1Clock>;
+    using LPTim1Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_LPTIM1EN, LpTimerKernelClock<Apb1Clock, RCC_CCIPR_LPTIM1SEL_Pos>>;
+    using LpTim1Clock = LPTim1Clock;
+    using LpUart1Clock = ClockControl<PeriphClockEnable12, RCC_APB1ENR2_LPUART1EN, UsartKernelClock<Apb1Clock, RCC_CCIPR_LPUART1SEL_Pos>>;
+    using LpTim2Clock = ClockControl<PeriphClockEnable12, RCC_APB1ENR2_LPTIM2EN, LpTimerKernelClock<Apb1Clock, RCC_CCIPR_LPTIM2SEL_Pos>>;
 
     using SysCfgCompClock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_SYSCFGEN, Apb2Clock>;
     using FirewallClock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_FWEN, Apb2Clock>;
     using Tim1Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_TIM1EN, Apb2Clock>;
     using Spi1Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_SPI1EN, Apb2Clock>;
-    using Usart1Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_USART1EN, Apb2Clock>;
+    using Usart1Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_USART1EN, UsartKernelClock<Apb2Clock, RCC_CCIPR_USART1SEL_Pos>>;
     using Tim15Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_TIM15EN, Apb2Clock>;
     using Tim16Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_TIM16EN, Apb2Clock>;
 
@@ -312,13 +316,13 @@ namespace Zhele::Clock
         using FmcClock = ClockControl<Ahb2ClockEnableReg, RCC_AHB3ENR_FMCEN, AhbClock>;
     #endif
     #if defined (RCC_AHB3ENR_OSPI1EN)
-        using OSPI1Clock = ClockControl<Ahb2ClockEnableReg, RCC_AHB3ENR_OSPI1EN, AhbClock>;
+        using OSPI1Clock = ClockControl<Ahb3ClockEnableReg, RCC_AHB3ENR_OSPI1EN, AhbClock>;
     #endif
     #if defined (RCC_AHB3ENR_OSPI2EN)
-        using OSPI2Clock = ClockControl<Ahb2ClockEnableReg, RCC_AHB3ENR_OSPI2EN, AhbClock>;
+        using OSPI2Clock = ClockControl<Ahb3ClockEnableReg, RCC_AHB3ENR_OSPI2EN, AhbClock>;
     #endif    
     #if defined (RCC_AHB3ENR_QSPIEN)
-        using QSPIClock = ClockControl<Ahb2ClockEnableReg, RCC_AHB3ENR_QSPIEN, AhbClock>;
+        using QSPIClock = ClockControl<Ahb3ClockEnableReg, RCC_AHB3ENR_QSPIEN, AhbClock>;
     #endif
 
     #if defined (RCC_APB1ENR1_RTCAPBEN)
@@ -328,7 +332,7 @@ namespace Zhele::Clock
         using Spi2Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_SPI2EN, Apb1Clock>;
     #endif
     #if defined (RCC_APB1ENR1_USART3EN)
-        using Usart3Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_USART3EN, Apb1Clock>;
+        using Usart3Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_USART3EN, UsartKernelClock<Apb1Clock, RCC_CCIPR_USART3SEL_Pos>>;
     #endif
     #if defined (RCC_APB1ENR1_I2C2EN)
         using I2c2Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_I2C2EN, Apb1Clock>;
@@ -361,7 +365,7 @@ namespace Zhele::Clock
         using Tim3Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_TIM3EN, Apb1Clock>;
     #endif
     #if defined (RCC_APB1ENR1_UART4EN)
-        using Uart4Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_UART4EN, Apb1Clock>;
+        using Uart4Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_UART4EN, UsartKernelClock<Apb1Clock, RCC_CCIPR_UART4SEL_Pos>>;
     #endif
     #if defined (RCC_APB1ENR2_I2C4EN)
         using I2c4Clock = ClockControl<PeriphClockEnable1, RCC_APB1ENR2_I2C4EN, Apb1Clock>;
@@ -373,7 +377,7 @@ namespace Zhele::Clock
         using Tim5Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_TIM5EN, Apb1Clock>;
     #endif
     #if defined (RCC_APB1ENR1_UART5EN)
-        using Uart5Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_UART5EN, Apb1Clock>;
+        using Uart5Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_UART5EN, UsartKernelClock<Apb1Clock, RCC_CCIPR_UART5SEL_Pos>>;
     #endif
 
     #if defined (RCC_APB2ENR_SDMMC1EN)
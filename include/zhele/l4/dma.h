@@ -44,6 +44,11 @@ namespace Zhele
             {
                 _DmaStream::Transfer(mode, buffer, periph, bufferSize, _DmaChannel);
             }
+
+            static void TransferDoubleBuffered(DmaBase::Mode mode, void* buffer0, void* buffer1, volatile void* periph, uint32_t bufferSize)
+            {
+                _DmaStream::TransferDoubleBuffered(mode, buffer0, buffer1, periph, bufferSize, _DmaChannel);
+            }
         };
     }        
 
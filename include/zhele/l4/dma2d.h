@@ -0,0 +1,21 @@
+/**
+ * @file
+ * Implements DMA2D for stm32l4 series
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMA2D_H
+#define ZHELE_DMA2D_H
+
+#include <stm32l4xx.h>
+
+#if defined (DMA2D)
+    #include "../common/dma2d.h"
+#else
+    #error "THIS MCU does not support DMA2D"
+#endif
+
+#endif //! ZHELE_DMA2D_H
@@ -63,6 +63,8 @@ namespace Zhele
             SdaPin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
             SdaPin::template SetDriverType<SdaPin::Port::OpenDrain>();
             SdaPin::template SetPullMode<SdaPin::PullMode::PullUp>();
+
+            _busClear = ClearBus<SclPin, SdaPin>;
         }
 
         I2C_TEMPLATE_ARGS
@@ -92,6 +94,24 @@ namespace Zhele
     #if defined (I2C3)
         IO_STRUCT_WRAPPER(I2C3, I2C3Regs, I2C_TypeDef);
     #endif
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::EnableFastModePlus()
+        {
+            Clock::SysCfgCompClock::Enable();
+        #if defined (SYSCFG_CFGR1_I2C1_FMP)
+            if constexpr (std::is_same_v<_Regs, I2C1Regs>)
+                SYSCFG->CFGR1 |= SYSCFG_CFGR1_I2C1_FMP;
+        #endif
+        #if defined (SYSCFG_CFGR1_I2C2_FMP)
+            if constexpr (std::is_same_v<_Regs, I2C2Regs>)
+                SYSCFG->CFGR1 |= SYSCFG_CFGR1_I2C2_FMP;
+        #endif
+        #if defined (I2C3) && defined (SYSCFG_CFGR1_I2C3_FMP)
+            if constexpr (std::is_same_v<_Regs, I2C3Regs>)
+                SYSCFG->CFGR1 |= SYSCFG_CFGR1_I2C3_FMP;
+        #endif
+        }
     }
         using I2c1 = Private::I2cBase<Private::I2C1Regs, I2C1_EV_IRQn, I2C1_ER_IRQn, Clock::I2c1Clock, Private::I2C1SclPins, Private::I2C1SdaPins, Dma1Stream6Channel3, Dma1Stream7Channel3>;
         using I2c2 = Private::I2cBase<Private::I2C2Regs, I2C2_EV_IRQn, I2C2_ER_IRQn, Clock::I2c2Clock, Private::I2C2SclPins, Private::I2C2SdaPins, Dma1Stream4Channel3, Dma1Stream4Channel3>;
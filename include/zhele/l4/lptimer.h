@@ -0,0 +1,40 @@
+/**
+ * @file
+ * Implements low-power timers for stm32l4 series
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LPTIMER_H
+#define ZHELE_LPTIMER_H
+
+#include <stm32l4xx.h>
+
+#include "../common/lptimer.h"
+
+#include "clock.h"
+#include "iopins.h"
+
+namespace Zhele::Timers
+{
+    namespace Private
+    {
+        IO_STRUCT_WRAPPER(LPTIM1, LpTimer1Regs, LPTIM_TypeDef);
+        IO_STRUCT_WRAPPER(LPTIM2, LpTimer2Regs, LPTIM_TypeDef);
+
+        using LpTimer1In1Pins = Pair<IO::PinList<IO::Pb5, IO::Pc0>, NonTypeTemplateArray<1, 1>>;
+        using LpTimer1In2Pins = Pair<IO::PinList<IO::Pb7, IO::Pc2>, NonTypeTemplateArray<1, 1>>;
+        using LpTimer1OutPins = Pair<IO::PinList<IO::Pa14, IO::Pb2, IO::Pc1>, NonTypeTemplateArray<1, 1, 1>>;
+
+        using LpTimer2In1Pins = Pair<IO::PinList<IO::Pb1, IO::Pc0>, NonTypeTemplateArray<14, 14>>;
+        using LpTimer2In2Pins = Pair<IO::PinList<IO::NullPin>, NonTypeTemplateArray<0>>;
+        using LpTimer2OutPins = Pair<IO::PinList<IO::Pa4, IO::Pa8>, NonTypeTemplateArray<14, 14>>;
+    }
+
+    using LpTimer1 = Private::LpTimer<Private::LpTimer1Regs, Clock::LPTim1Clock, LPTIM1_IRQn, Private::LpTimer1In1Pins, Private::LpTimer1In2Pins, Private::LpTimer1OutPins>;
+    using LpTimer2 = Private::LpTimer<Private::LpTimer2Regs, Clock::LpTim2Clock, LPTIM2_IRQn, Private::LpTimer2In1Pins, Private::LpTimer2In2Pins, Private::LpTimer2OutPins>;
+}
+
+#endif //! ZHELE_LPTIMER_H
@@ -0,0 +1,83 @@
+/**
+ * @file
+ * Implements QUADSPI for stm32l4 series
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_QUADSPI_H
+#define ZHELE_QUADSPI_H
+
+#include <stm32l4xx.h>
+
+#if !defined (QUADSPI)
+    #error "THIS MCU does not support QUADSPI"
+#endif
+
+#include "../common/quadspi.h"
+
+#include "afio_bind.h"
+#include "clock.h"
+#include "dma.h"
+#include "iopins.h"
+
+#include <type_traits>
+
+namespace Zhele
+{
+    namespace Private
+    {
+        QUADSPI_TEMPLATE_ARGS
+        template<typename ClkPin, typename NcsPin, typename Io0Pin, typename Io1Pin, typename Io2Pin, typename Io3Pin>
+        void QUADSPI_TEMPLATE_QUALIFIER::SelectPins()
+        {
+            static_assert(_ClkPins::template IndexOf<ClkPin> >= 0, "CLK pin is not QUADSPI CLK pin");
+            static_assert(_NcsPins::template IndexOf<NcsPin> >= 0, "NCS pin is not QUADSPI NCS pin");
+            static_assert(_Io0Pins::template IndexOf<Io0Pin> >= 0, "IO0 pin is not QUADSPI IO0 pin");
+            static_assert(_Io1Pins::template IndexOf<Io1Pin> >= 0, "IO1 pin is not QUADSPI IO1 pin");
+            static_assert(std::is_same_v<Io2Pin, IO::NullPin> || _Io2Pins::template IndexOf<Io2Pin> >= 0, "IO2 pin is not QUADSPI IO2 pin");
+            static_assert(std::is_same_v<Io3Pin, IO::NullPin> || _Io3Pins::template IndexOf<Io3Pin> >= 0, "IO3 pin is not QUADSPI IO3 pin");
+
+            constexpr auto usedPorts = TemplateUtils::TypeList<typename ClkPin::Port, typename NcsPin::Port, typename Io0Pin::Port,
+                typename Io1Pin::Port, typename Io2Pin::Port, typename Io3Pin::Port>::remove_duplicates();
+            usedPorts.foreach([](auto port){
+                port.Enable();
+            });
+
+            TemplateUtils::TypeList<ClkPin, NcsPin, Io0Pin, Io1Pin, Io2Pin, Io3Pin>::foreach([](auto pin){
+                using Pin = typename decltype(pin)::type;
+                if constexpr (!std::is_same_v<Pin, IO::NullPin>)
+                {
+                    Pin::template SetConfiguration<Pin::Port::AltFunc>();
+                    Pin::template SetDriverType<Pin::DriverType::PushPull>();
+                    Pin::template SetSpeed<Pin::Speed::Fastest>();
+                    Pin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
+                }
+            });
+        }
+
+        IO_STRUCT_WRAPPER(QUADSPI, QuadSpiRegs, QUADSPI_TypeDef);
+
+        using QuadSpiClkPins = IO::PinList<IO::Pa3, IO::Pb10, IO::Pe10>;
+        using QuadSpiNcsPins = IO::PinList<IO::Pa2, IO::Pb11, IO::Pe11>;
+        using QuadSpiIo0Pins = IO::PinList<IO::Pb1, IO::Pe12>;
+        using QuadSpiIo1Pins = IO::PinList<IO::Pb0, IO::Pe13>;
+        using QuadSpiIo2Pins = IO::PinList<IO::Pa7, IO::Pe14>;
+        using QuadSpiIo3Pins = IO::PinList<IO::Pa6, IO::Pe15>;
+    }
+
+    using QuadSpi = Private::QuadSpi<
+        Private::QuadSpiRegs,
+        Clock::QSPIClock,
+        Dma1Stream5Channel5,
+        Private::QuadSpiClkPins,
+        Private::QuadSpiNcsPins,
+        Private::QuadSpiIo0Pins,
+        Private::QuadSpiIo1Pins,
+        Private::QuadSpiIo2Pins,
+        Private::QuadSpiIo3Pins>;
+}
+
+#endif //! ZHELE_QUADSPI_H
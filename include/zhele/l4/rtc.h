@@ -0,0 +1,28 @@
+/**
+ * @file
+ * Implements internal RTC for stm32l4 series
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_RTC_H
+#define ZHELE_RTC_H
+
+#include <stm32l4xx.h>
+
+#include "../common/rtc.h"
+
+#include "clock.h"
+
+namespace Zhele
+{
+#if defined (RCC_APB1ENR1_RTCAPBEN)
+    using Rtc = Private::Rtc<Clock::RtcApbClock, 20, RTC_WKUP_IRQn, 18, RTC_Alarm_IRQn>;
+#else
+    using Rtc = Private::Rtc<void, 20, RTC_WKUP_IRQn, 18, RTC_Alarm_IRQn>;
+#endif
+}
+
+#endif //! ZHELE_RTC_H
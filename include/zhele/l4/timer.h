@@ -125,6 +125,17 @@ namespace Zhele::Timers
     using Timer2 = Private::GPTimer<Private::Tim2Regs, Clock::Tim2Clock, TIM2_IRQn, Private::Tim2ChPins>;
     using Timer3 = Private::GPTimer<Private::Tim3Regs, Clock::Tim3Clock, TIM3_IRQn, Private::Tim3ChPins>;
     using Timer4 = Private::GPTimer<Private::Tim4Regs, Clock::Tim4Clock, TIM4_IRQn, Private::Tim4ChPins>;
+
+    namespace Private
+    {
+        // Internal trigger connection (slave timer ITRx <- master timer TRGO)
+        template<> struct TimerInternalTrigger<Timer3, Timer2> { static const int Value = 2; };
+        template<> struct TimerInternalTrigger<Timer4, Timer2> { static const int Value = 3; };
+        template<> struct TimerInternalTrigger<Timer2, Timer3> { static const int Value = 1; };
+        template<> struct TimerInternalTrigger<Timer4, Timer3> { static const int Value = 3; };
+        template<> struct TimerInternalTrigger<Timer2, Timer4> { static const int Value = 1; };
+        template<> struct TimerInternalTrigger<Timer3, Timer4> { static const int Value = 2; };
+    }
 }
 
 #endif //! ZHELE_TIMER_H
\ No newline at end of file
@@ -0,0 +1,42 @@
+/**
+ * @file
+ * Implements touch sensing controller for stm32l4 series
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TSC_H
+#define ZHELE_TSC_H
+
+#include <stm32l4xx.h>
+
+#if defined (TSC)
+#include "../common/tsc.h"
+
+#include "clock.h"
+#include "iopins.h"
+
+namespace Zhele
+{
+    namespace Private
+    {
+        IO_STRUCT_WRAPPER(TSC, TscRegs, TSC_TypeDef);
+
+        using TscPins = IO::PinList<
+            IO::Pb12, IO::Pb13, IO::Pb14, IO::Pb15,
+            IO::Pb4, IO::Pb5, IO::Pb6, IO::Pb7,
+            IO::Pa15, IO::Pc10, IO::Pc11, IO::Pc12,
+            IO::Pc6, IO::Pc7, IO::Pc8, IO::Pc9,
+            IO::Pe10, IO::Pe11, IO::Pe12, IO::Pe13,
+            IO::Pd10, IO::Pd11, IO::Pd12, IO::Pd13,
+            IO::Pe2, IO::Pe3, IO::Pe4, IO::Pe5,
+            IO::Pf14, IO::Pf15, IO::Pg0, IO::Pg1>;
+    }
+
+    using Tsc = Private::Tsc<Private::TscRegs, Clock::TscClock, TSC_IRQn, Private::TscPins, 9>;
+}
+#endif
+
+#endif //! ZHELE_TSC_H
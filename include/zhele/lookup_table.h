@@ -0,0 +1,210 @@
+/**
+ * @file
+ * Implements compile-time lookup tables and interpolation for sensor linearization
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LOOKUP_TABLE_H
+#define ZHELE_LOOKUP_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Zhele::Lut
+{
+    /**
+     * @brief Implements table with uniform breakpoints over input code range
+     *
+     * @details
+     * Input range [0, 2^_InputBits) is split to 2^_SegmentBits segments, so segment index and
+     * position in segment are input bits: interpolation is shift, mask, multiply and add without
+     * branches and divisions. Input above range is clamped.
+     *
+     * @tparam _Value Output type
+     * @tparam _InputBits Input code bits (ADC resolution)
+     * @tparam _SegmentBits Segments count bits
+     */
+    template<typename _Value, unsigned _InputBits, unsigned _SegmentBits>
+    struct UniformTable
+    {
+        static_assert(_SegmentBits <= _InputBits && _InputBits <= 16, "Input must be 16-bit at most and has at least one code per segment");
+
+        /// Position in segment bits
+        static constexpr unsigned Shift = _InputBits - _SegmentBits;
+
+        /// Max input code
+        static constexpr uint32_t MaxInput = (1ul << _InputBits) - 1;
+
+        /// Values at segment bounds (last one is value at 2^_InputBits)
+        std::array<_Value, (1u << _SegmentBits) + 1> Points;
+
+        /**
+         * @brief Returns interpolated value
+         *
+         * @param [in] input Input code
+         *
+         * @returns Value
+         */
+        constexpr _Value operator()(uint32_t input) const;
+
+        /**
+         * @brief Converts block of input codes (for example, ADC DMA buffer half)
+         *
+         * @param [in] input Input codes
+         * @param [out] output Values (may be the same memory if value is 16-bit)
+         *
+         * @returns Converted values count (minimal of sizes)
+         */
+        size_t Process(std::span<const uint16_t> input, std::span<_Value> output) const;
+    };
+
+    /**
+     * @brief Implements table with arbitrary (ascending) breakpoints
+     *
+     * @details
+     * Breakpoints may be dense where function is curved and sparse where it's almost linear.
+     * Segment is found by binary search with fixed steps count (without early exit),
+     * segment slopes are precomputed (Q16), so interpolation has no division.
+     * Input outside of breakpoints is clamped. Table is valid (@ref Valid) if breakpoints
+     * are ascending and value changes less than 32768 per input code.
+     *
+     * @tparam _Value Output type
+     * @tparam _Size Breakpoints count
+     */
+    template<typename _Value, size_t _Size>
+    struct BreakpointTable
+    {
+        static_assert(_Size >= 2, "Table must contain at least two breakpoints");
+
+        std::array<uint16_t, _Size> Inputs; ///< Breakpoints
+        std::array<_Value, _Size> Values; ///< Values at breakpoints
+        std::array<int32_t, _Size - 1> Slopes; ///< Segment slopes (Q16 value per input code)
+        bool Valid; ///< Breakpoints are ascending and slopes fit
+
+        /**
+         * @brief Returns interpolated value
+         *
+         * @param [in] input Input code
+         *
+         * @returns Value
+         */
+        constexpr _Value operator()(uint32_t input) const;
+
+        /**
+         * @brief Converts block of input codes (for example, ADC DMA buffer half)
+         *
+         * @param [in] input Input codes
+         * @param [out] output Values (may be the same memory if value is 16-bit)
+         *
+         * @returns Converted values count (minimal of sizes)
+         */
+        size_t Process(std::span<const uint16_t> input, std::span<_Value> output) const;
+    };
+
+    /**
+     * @brief Steinhart-Hart thermistor equation (1/T = A + B ln(R) + C ln(R)^3)
+     */
+    struct SteinhartHart
+    {
+        double A; ///< A coefficient
+        double B; ///< B coefficient
+        double C; ///< C coefficient
+
+        /**
+         * @brief Returns coefficients for beta model (C is zero)
+         *
+         * @param [in] beta Beta (B25/85 for example)
+         * @param [in] nominalOhms Resistance at 25 degrees
+         *
+         * @returns Coefficients
+         */
+        static consteval SteinhartHart FromBeta(double beta, double nominalOhms);
+
+        /**
+         * @brief Returns temperature for resistance
+         *
+         * @param [in] ohms Resistance
+         *
+         * @returns Temperature in Celsius degrees
+         */
+        constexpr double Celsius(double ohms) const;
+    };
+
+    /**
+     * @brief Generates uniform table by function
+     *
+     * @details
+     * Table is computed by compiler. Declare it as static constexpr to place it in flash:
+     * @code
+     *  // Thermocouple (mV to 0.01 degree) by polynomial
+     *  static constexpr auto thermocouple = Lut::TabulateUniform<12, 6, int16_t>([](double code) {
+     *      double mv = code * 0.0122;
+     *      return 100 * (25.08355 * mv + 7.860106e-2 * mv * mv);
+     *  });
+     *  int16_t temperature = thermocouple(Adc1::Read());
+     * @endcode
+     *
+     * @tparam _InputBits Input code bits (ADC resolution)
+     * @tparam _SegmentBits Segments count bits
+     * @tparam _Value Output type
+     * @tparam _Function Function type
+     *
+     * @param [in] function Function of input code returning value (rounded and saturated to value type)
+     *
+     * @returns Table
+     */
+    template<unsigned _InputBits, unsigned _SegmentBits, typename _Value = int32_t, typename _Function>
+    consteval UniformTable<_Value, _InputBits, _SegmentBits> TabulateUniform(_Function function);
+
+    /**
+     * @brief Generates breakpoint table by function
+     *
+     * @tparam _Value Output type
+     * @tparam _Size Breakpoints count
+     * @tparam _Function Function type
+     *
+     * @param [in] inputs Ascending breakpoints (input codes)
+     * @param [in] function Function of input code returning value (rounded and saturated to value type)
+     *
+     * @returns Table (check @ref BreakpointTable::Valid by static_assert)
+     */
+    template<typename _Value = int32_t, size_t _Size, typename _Function>
+    consteval BreakpointTable<_Value, _Size> TabulateBreakpoints(const std::array<uint16_t, _Size>& inputs, _Function function);
+
+    /**
+     * @brief Returns function of ADC code to temperature for thermistor in divider
+     *
+     * @details
+     * Thermistor is connected between ADC input and ground (series resistor to reference)
+     * or between reference and ADC input. Codes at range ends are moved by half code,
+     * so function is finite at open and shorted thermistor.
+     *
+     * @par Example
+     * @code
+     *  // 10k NTC (B = 3950) to ground, 10k to 3.3 V, 12-bit ADC, 0.01 degree
+     *  static constexpr auto ntc = Lut::TabulateUniform<12, 7, int16_t>(
+     *      Lut::ThermistorDivider<12>(Lut::SteinhartHart::FromBeta(3950, 10000), 10000, 100));
+     *  ntc.Process(samples, temperatures);
+     * @endcode
+     *
+     * @tparam _InputBits ADC resolution
+     *
+     * @param [in] thermistor Thermistor coefficients
+     * @param [in] seriesOhms Series resistor
+     * @param [in] scale Temperature units per degree (100 for 0.01 degree)
+     * @param [in] toGround Thermistor is connected to ground
+     *
+     * @returns Function for table generators
+     */
+    template<unsigned _InputBits>
+    consteval auto ThermistorDivider(SteinhartHart thermistor, double seriesOhms, double scale = 1, bool toGround = true);
+}
+
+#include "impl/lookup_table.h"
+
+#endif //! ZHELE_LOOKUP_TABLE_H
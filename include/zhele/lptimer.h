@@ -0,0 +1,24 @@
+/**
+ * @file
+ * United header for low-power timers (LPTIM)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @licence FreeBSD
+ */
+
+#if defined(STM32F0)
+    #error STM32F0 does not support LPTIM
+#endif
+#if defined(STM32F1)
+    #error STM32F1 does not support LPTIM
+#endif
+#if defined(STM32F4)
+    #error LPTIM is not implemented for STM32F4
+#endif
+#if defined(STM32L4)
+    #include "l4/lptimer.h"
+#endif
+#if defined(STM32G0)
+    #include "g0/lptimer.h"
+#endif
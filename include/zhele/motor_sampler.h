@@ -0,0 +1,120 @@
+/**
+ * @file
+ * Implements PWM-synchronized injected ADC sampling for motor control
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_MOTOR_SAMPLER_H
+#define ZHELE_MOTOR_SAMPLER_H
+
+#include <zhele/adc.h>
+#include <zhele/profiling.h>
+#include <zhele/timer.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements phase current sampling synchronized with bridge PWM
+     *
+     * @details
+     * Timer channel 4 (PWM2 mode, pin is not used) rises shortly before counter peak of center-aligned PWM
+     * (see AdvancedTimer::InitCenterAligned), where all low-side switches are on (PWM1 mode of phases),
+     * and its compare event triggers injected sequence of ADC. So shunt currents are sampled at the same point of
+     * every PWM period without CPU. Control loop callback is called directly from JEOC interrupt (@ref IrqHandler)
+     * with results read from JDRx registers, so latency from sample to duty update is minimal and constant:
+     * pulses written in callback (AdvancedTimer::SetSpaceVector) are applied on the next update event (counter underflow).
+     * Give ADC interrupt the highest priority and keep callback shorter than half of PWM period.
+     *
+     * @par Example
+     * @code
+     *  using Sampler = MotorSampler<Timers::Timer1, Adc1>;
+     *  Timer1::InitCenterAligned(1800);
+     *  Adc1::Init<Adc1::AdcDivider::Div6>();
+     *  Sampler::Start<IO::Pa0, IO::Pa1>([](const uint16_t* currents, uint8_t count) { Timer1::SetSpaceVector(alpha, beta); }, 7, 8);
+     *  Timer1::Start();
+     *  // ADC1_IRQHandler
+     *  Sampler::IrqHandler();
+     * @endcode
+     *
+     * @tparam _Timer Advanced timer (bridge PWM)
+     * @tparam _Adc ADC
+     */
+    template<typename _Timer, typename _Adc>
+    class MotorSampler
+    {
+        using Trigger = Private::AdcInjectedTimerTrigger<_Adc, _Timer>;
+        static_assert(Trigger::Supported, "Timer channel 4 can not trigger ADC injected conversion");
+
+        using Regs = typename _Adc::Regs;
+        using TriggerChannel = typename _Timer::template PWMGeneration<3>;
+        using Counter = decltype(_Timer::GetPeriod());
+    public:
+        /// Maximal channels count (injected sequence length)
+        static constexpr unsigned MaxChannels = _Adc::MaxInjected;
+
+        /// Control loop callback (called in ADC interrupt), results are in pins order
+        using ControlCallbackType = std::add_pointer_t<void(const uint16_t* results, uint8_t count)>;
+
+        /**
+         * @brief Start sampling (timer should be initialized already)
+         *
+         * @tparam _Pins ADC input pins (up to MaxChannels)
+         *
+         * @param [in] callback Control loop callback
+         * @param [in] sampleTime Sample time (ADC cycles)
+         * @param [in] advance Trigger advance before counter peak (timer ticks, see @ref SetSamplePoint)
+         *
+         * @retval true Sampling started
+         * @retval false Sampling start fail
+         */
+        template<typename... _Pins>
+        static bool Start(ControlCallbackType callback, uint16_t sampleTime, Counter advance = 1);
+
+        /**
+         * @brief Set sample point
+         *
+         * @details
+         * Sequence is triggered advance ticks before counter peak. Set it to about half of sequence
+         * conversion time to center sampling on the peak (in the middle of low-side switches pulses).
+         *
+         * @param [in] advance Trigger advance before counter peak (timer ticks, from 1 to period - 1)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetSamplePoint(Counter advance);
+
+        /**
+         * @brief Stop sampling
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+
+        /**
+         * @brief ADC interrupt handler (call it instead of AdcBase::IrqHandler)
+         *
+         * @details
+         * Other ADC events (analog watchdog) are passed to AdcBase::IrqHandler.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static inline ControlCallbackType _callback = nullptr;
+        static inline uint8_t _count = 0;
+    };
+}
+
+#include "impl/motor_sampler.h"
+
+#endif //! ZHELE_MOTOR_SAMPLER_H
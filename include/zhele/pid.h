@@ -0,0 +1,161 @@
+/**
+ * @file
+ * Implements fixed-point (Q16.16, Q31) PID regulator
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PID_H
+#define ZHELE_PID_H
+
+#include <cstdint>
+
+namespace Zhele::Dsp
+{
+    /**
+     * @brief PID regulator coefficients
+     *
+     * @details
+     * Gains are discrete (sample time is folded into integral and derivative gains):
+     * proportional and derivative gains are Q16.16, integral gain is Q31 (Ki / sampleRate is always less than 1 for
+     * usable loop), derivative filter coefficient is Q16.16 fraction (1.0 disables filtering).
+     */
+    struct PidCoefficients
+    {
+        int32_t kp; ///< Proportional gain (Q16.16)
+        int32_t ki; ///< Integral gain per sample (Q31)
+        int32_t kd; ///< Derivative gain per sample (Q16.16)
+        int32_t filter; ///< Derivative low-pass filter coefficient (Q16.16, from 0 to 1.0)
+
+        /**
+         * @brief Converts continuous gains (call it in constant expression)
+         *
+         * @param [in] kp Proportional gain
+         * @param [in] ki Integral gain (1/s)
+         * @param [in] kd Derivative gain (s)
+         * @param [in] sampleRate Loop rate (Hz)
+         * @param [in] derivativeCutoff Derivative filter cutoff frequency (Hz, 0 disables filtering)
+         *
+         * @returns Coefficients
+         */
+        static constexpr PidCoefficients From(double kp, double ki, double kd, double sampleRate, double derivativeCutoff = 0);
+    };
+
+    /**
+     * @brief Implements PID regulator
+     *
+     * @details
+     * Regulator is integer only (64-bit products), so it's cheap on cores without FPU.
+     * Derivative term is calculated from measurement (not from error), so setpoint step does not kick output,
+     * and is smoothed by first-order low-pass filter. Output is saturated by limits, integrator is clamped by limits too
+     * and is frozen while output is saturated in direction of error (anti-windup).
+     *
+     * @par Example
+     * @code
+     *  static constexpr auto coefficients = Dsp::PidCoefficients::From(2.0, 50.0, 0.001, 1000, 100);
+     *  Dsp::PidQ16 pid(coefficients, 0, Dsp::PidQ16::FromDouble(100.0));
+     *  int32_t output = pid.Step(setpoint, measurement);
+     * @endcode
+     *
+     * @tparam _FractionalBits Fractional bits of signals (16 for Q16.16, 31 for Q31)
+     */
+    template<unsigned _FractionalBits>
+    class Pid
+    {
+        static_assert(_FractionalBits < 32, "Signals are 32-bit");
+    public:
+        /// Signal type
+        using Value = int32_t;
+
+        /**
+         * @brief Converts number to signal format (saturated)
+         *
+         * @param [in] value Number
+         *
+         * @returns Fixed-point value
+         */
+        static constexpr Value FromDouble(double value);
+
+        /**
+         * @brief Creates regulator with zero state
+         *
+         * @param [in] coefficients Coefficients (they are copied)
+         * @param [in] min Output minimal value
+         * @param [in] max Output maximal value
+         */
+        Pid(const PidCoefficients& coefficients, Value min, Value max);
+
+        /**
+         * @brief Set coefficients (state is kept, so change is bumpless)
+         *
+         * @param [in] coefficients Coefficients
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void SetCoefficients(const PidCoefficients& coefficients);
+
+        /**
+         * @brief Set output limits
+         *
+         * @param [in] min Output minimal value
+         * @param [in] max Output maximal value
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void SetLimits(Value min, Value max);
+
+        /**
+         * @brief Reset state
+         *
+         * @details
+         * Integrator is preset to given output, so switch from manual control to regulator is bumpless.
+         *
+         * @param [in] output Initial output
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset(Value output = 0);
+
+        /**
+         * @brief Calculates output for the next sample
+         *
+         * @param [in] setpoint Setpoint
+         * @param [in] measurement Measured value
+         *
+         * @returns Output
+         */
+        Value Step(Value setpoint, Value measurement);
+
+        /**
+         * @brief Returns the last output
+         *
+         * @returns Output
+         */
+        Value Output() const;
+
+    private:
+        PidCoefficients _coefficients; ///< Coefficients
+        int64_t _integral; ///< Integrator (Q31 above signal format)
+        int32_t _derivative; ///< Filtered derivative term
+        Value _previousMeasurement; ///< Previous measurement
+        Value _output; ///< The last output
+        Value _min; ///< Output minimal value
+        Value _max; ///< Output maximal value
+        bool _started; ///< Previous measurement is valid
+    };
+
+    /// Q16.16 PID regulator
+    using PidQ16 = Pid<16>;
+
+    /// Q31 PID regulator
+    using PidQ31 = Pid<31>;
+}
+
+#include "impl/pid.h"
+
+#endif //! ZHELE_PID_H
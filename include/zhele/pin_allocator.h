@@ -0,0 +1,284 @@
+/**
+ * @file
+ * Implements board-level compile-time pin allocation
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PIN_ALLOCATOR_H
+#define ZHELE_PIN_ALLOCATOR_H
+
+#include <zhele/iopins.h>
+#include <zhele/spi.h>
+#include <zhele/usart.h>
+
+#include "common/template_utils/pair.h"
+#include "common/template_utils/static_array.h"
+#include "common/template_utils/type_list.h"
+
+#include <type_traits>
+
+namespace Zhele::IO
+{
+    /**
+     * @brief Pins of one peripheral
+     *
+     * @tparam _Peripheral Peripheral (Usart1, Spi1, Timer1::PWMGeneration<0>, I2c1 and so on)
+     * @tparam _Pins Pins in order of peripheral SelectPins/SelectTxRxPins method (NullPin for unused)
+     */
+    template<typename _Peripheral, typename... _Pins>
+    struct PinAssignment
+    {
+        using Peripheral = _Peripheral;
+        using Pins = TemplateUtils::TypeList<_Pins...>;
+    };
+
+    namespace Private
+    {
+        /**
+         * @brief Peripheral pin tables
+         *
+         * @details
+         * Specializations expose pin tables of peripherals, so allocator resolves alternate function numbers itself.
+         * Pins of other peripherals are selected by peripheral methods.
+         */
+        template<typename _Peripheral>
+        struct PeripheralPins
+        {
+            static const bool Resolvable = false;
+        };
+
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        struct PeripheralPins<Zhele::Private::Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>>
+        {
+            static const bool Resolvable = true;
+            using Regs = _Regs;
+            using Tables = TemplateUtils::TypeList<_TxPins, _RxPins>;
+        };
+
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        struct PeripheralPins<Zhele::Private::Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>>
+        {
+            static const bool Resolvable = true;
+            using Regs = _Regs;
+            using Tables = TemplateUtils::TypeList<_MosiPins, _MisoPins, _ClockPins, _SsPins>;
+        };
+
+        /**
+         * @brief Pin table: PinList (F1, F4, L4) or pair of PinList and numbers (alternate function on F0/G0, remap on F1)
+         */
+        template<typename _Table>
+        struct PinTable
+        {
+            using Pins = _Table;
+        };
+
+        template<typename _Pins, typename _Numbers>
+        struct PinTable<Pair<_Pins, _Numbers>>
+        {
+            using Pins = _Pins;
+            using Numbers = _Numbers;
+        };
+
+        /**
+         * @brief Pin with resolved alternate function number
+         */
+        template<typename _Pin, uint8_t _AltFunc>
+        struct PinFunction
+        {
+            using Pin = _Pin;
+            using Port = typename _Pin::Port;
+            static const uint8_t AltFunc = _AltFunc;
+        };
+
+        /**
+         * @brief Resolves alternate function of pin for peripheral
+         *
+         * @tparam _Regs Peripheral registers
+         * @tparam _Table Pin table
+         * @tparam _Pin Pin
+         */
+        template<typename _Regs, typename _Table, typename _Pin>
+        consteval uint8_t AltFunctionOf()
+        {
+            constexpr int index = PinTable<_Table>::Pins::template IndexOf<_Pin>;
+            static_assert(index >= 0, "Pin can't be used by peripheral (see peripheral pin table)");
+
+            if constexpr (!std::is_same_v<typename PinTable<_Table>::Pins, _Table>)
+            {
+                return static_cast<uint8_t>(GetNonTypeValueByIndex<index, typename PinTable<_Table>::Numbers>::value);
+            }
+            else
+            {
+#if defined (STM32F4) || defined (STM32L4)
+                return Zhele::Private::GetAltFunctionNumber<_Regs>;
+#else
+                static_assert(!std::is_same_v<_Regs, _Regs>, "Alternate function is not defined by pin table");
+                return 0;
+#endif
+            }
+        }
+
+        /**
+         * @brief Resolved pins of assignment (NullPin is skipped, pins are validated by peripheral table)
+         */
+        template<typename _Assignment>
+        consteval auto ResolvePins()
+        {
+            using Tables = typename PeripheralPins<typename _Assignment::Peripheral>::Tables;
+            using Regs = typename PeripheralPins<typename _Assignment::Peripheral>::Regs;
+            static_assert(_Assignment::Pins::size() <= Tables::size(), "Too many pins for peripheral");
+
+            return [&]<std::size_t... _Indexes>(std::index_sequence<_Indexes...>) {
+                return (TemplateUtils::TypeList<>{} + ... + []<std::size_t _Index>() {
+                    using Pin = TemplateUtils::TypeUnbox<_Assignment::Pins::template get<_Index>()>;
+                    if constexpr (std::is_same_v<Pin, NullPin>)
+                        return TemplateUtils::TypeList<>{};
+                    else
+                        return TemplateUtils::TypeList<PinFunction<Pin, AltFunctionOf<Regs, TemplateUtils::TypeUnbox<Tables::template get<_Index>()>, Pin>()>>{};
+                }.template operator()<_Indexes>());
+            }(std::make_index_sequence<_Assignment::Pins::size()>());
+        }
+
+        /**
+         * @brief Selects pins by peripheral method
+         */
+        template<typename _Peripheral, typename... _Pins>
+        void SelectByPeripheral(TemplateUtils::TypeList<_Pins...>)
+        {
+            if constexpr (requires { _Peripheral::template SelectTxRxPins<_Pins...>(); })
+                _Peripheral::template SelectTxRxPins<_Pins...>();
+            else
+                _Peripheral::template SelectPins<_Pins...>();
+        }
+    } // namespace Private
+
+    /**
+     * @brief Board pin allocator
+     *
+     * @details
+     * Collects pins of all peripherals of board and checks them at compile time:
+     * every pin can be used by one peripheral only and must be present in peripheral pin table.
+     * USART and SPI pins are resolved by allocator: alternate function numbers are calculated at compile time,
+     * ports are enabled once and every port is configured by one mode write and one AFR write
+     * per alternate function number. Other peripherals (timers, I2C) select their pins as usual.
+     * On STM32F1 all pins are selected by peripherals (AFIO remap is peripheral-wide).
+     * Output driver type and speed keep reset values (push-pull, low speed).
+     *
+     * @par Example
+     * @code
+     *  using Board = PinAllocator<
+     *      PinAssignment<Usart1, Pa9, Pa10>,
+     *      PinAssignment<Spi1, Pa7, Pa6, Pa5, NullPin>,
+     *      PinAssignment<Timer3::PWMGeneration<0>, Pb4>
+     *  >;
+     *  ...
+     *  Board::Select();
+     * @endcode
+     *
+     * @tparam _Assignments Pin assignments (@ref PinAssignment)
+     */
+    template<typename... _Assignments>
+    class PinAllocator
+    {
+        static constexpr auto _pins = (TemplateUtils::TypeList<>{} + ... + typename _Assignments::Pins{})
+            .filter([](auto pin) { return !std::is_same_v<TemplateUtils::TypeUnbox<pin>, NullPin>; });
+
+        static_assert(_pins.is_unique(), "Pin is assigned to several peripherals");
+
+#if defined (STM32F1)
+        static constexpr auto _resolved = TemplateUtils::TypeList<>{};
+        static constexpr auto _unresolved = TemplateUtils::TypeList<_Assignments...>{};
+#else
+        static constexpr auto _resolved = (TemplateUtils::TypeList<>{} + ... + []() {
+            if constexpr (Private::PeripheralPins<typename _Assignments::Peripheral>::Resolvable)
+                return Private::ResolvePins<_Assignments>();
+            else
+                return TemplateUtils::TypeList<>{};
+        }());
+
+        static constexpr auto _unresolved = (TemplateUtils::TypeList<>{} + ... + []() {
+            if constexpr (Private::PeripheralPins<typename _Assignments::Peripheral>::Resolvable)
+                return TemplateUtils::TypeList<>{};
+            else
+                return TemplateUtils::TypeList<_Assignments>{};
+        }());
+#endif
+
+        static constexpr auto _ports = _resolved.transform([](auto function) {
+            return TemplateUtils::TypeBox<typename TemplateUtils::TypeUnbox<function>::Port>{};
+        }).remove_duplicates();
+
+        template<typename _Port>
+        static consteval typename _Port::DataType PortMask()
+        {
+            typename _Port::DataType mask = 0;
+            _resolved.foreach([&mask](auto function) {
+                using Function = TemplateUtils::TypeUnbox<function>;
+                if constexpr (std::is_same_v<typename Function::Port, _Port>)
+                    mask |= (1 << Function::Pin::Number);
+            });
+            return mask;
+        }
+
+        template<typename _Port, uint8_t _AltFunc>
+        static consteval typename _Port::DataType AltFuncMask()
+        {
+            typename _Port::DataType mask = 0;
+            _resolved.foreach([&mask](auto function) {
+                using Function = TemplateUtils::TypeUnbox<function>;
+                if constexpr (std::is_same_v<typename Function::Port, _Port> && Function::AltFunc == _AltFunc)
+                    mask |= (1 << Function::Pin::Number);
+            });
+            return mask;
+        }
+
+    public:
+        /// Pins count (except NullPin)
+        static const unsigned PinsCount = _pins.size();
+
+        /**
+         * @brief Check that pin is assigned to some peripheral
+         *
+         * @tparam _Pin Pin
+         */
+        template<typename _Pin>
+        static constexpr bool IsAssigned = _pins.template contains<_Pin>();
+
+        /**
+         * @brief Configures all assigned pins
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Select()
+        {
+            _ports.foreach([](auto port) { TemplateUtils::TypeUnbox<port>::Enable(); });
+
+            _ports.foreach([](auto port) {
+                using Port = TemplateUtils::TypeUnbox<port>;
+                Port::template SetConfiguration<Port::AltFunc, PortMask<Port>()>();
+
+                _resolved.foreach([](auto function) {
+                    using Function = TemplateUtils::TypeUnbox<function>;
+                    if constexpr (std::is_same_v<typename Function::Port, Port>)
+                    {
+                        constexpr auto mask = AltFuncMask<Port, Function::AltFunc>();
+                        // Single write for all pins with the same function number (by the lowest of them)
+                        if constexpr ((mask & -mask) == (1 << Function::Pin::Number))
+                            Port::template AltFuncNumber<Function::AltFunc, mask>();
+                    }
+                });
+            });
+
+            _unresolved.foreach([](auto assignment) {
+                using Assignment = TemplateUtils::TypeUnbox<assignment>;
+                Private::SelectByPeripheral<typename Assignment::Peripheral>(typename Assignment::Pins{});
+            });
+        }
+    };
+} // namespace Zhele::IO
+
+#endif //! ZHELE_PIN_ALLOCATOR_H
@@ -0,0 +1,179 @@
+/**
+ * @file
+ * Implements memory placement of static buffers (.noinit, CCM, SRAM2, DMA-capable RAM)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PLACEMENT_H
+#define ZHELE_PLACEMENT_H
+
+#if defined(STM32F0)
+    #include <stm32f0xx.h>
+#endif
+#if defined(STM32F1)
+    #include <stm32f1xx.h>
+#endif
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+#if defined(STM32L4)
+    #include <stm32l4xx.h>
+#endif
+#if defined(STM32G0)
+    #include <stm32g0xx.h>
+#endif
+
+#include <stdint.h>
+#include <type_traits>
+
+/**
+ * @def ZHELE_NOINIT
+ * @brief Places variable to .noinit section (it's not cleared by startup code, so it survives reset)
+ *
+ * @details
+ * Linker script must have NOLOAD .noinit section in RAM (see cmake/zhele-placement.ld).
+ * Section attributes are for ordinary (not template) variables, templates use @ref PlacedStorage.
+ */
+#if !defined (ZHELE_NOINIT)
+    #define ZHELE_NOINIT __attribute__((section(".noinit")))
+#endif
+
+/**
+ * @def ZHELE_CCMRAM
+ * @brief Places variable to core coupled memory (F4). DMA has no access to CCM.
+ */
+#if !defined (ZHELE_CCMRAM)
+    #define ZHELE_CCMRAM __attribute__((section(".ccmram")))
+#endif
+
+/**
+ * @def ZHELE_SRAM2
+ * @brief Places variable to SRAM2 (F4, L4)
+ */
+#if !defined (ZHELE_SRAM2)
+    #define ZHELE_SRAM2 __attribute__((section(".sram2")))
+#endif
+
+/**
+ * @def ZHELE_DMARAM
+ * @brief Places variable to RAM that is accessible by DMA (main SRAM)
+ */
+#if !defined (ZHELE_DMARAM)
+    #define ZHELE_DMARAM __attribute__((section(".dmaram")))
+#endif
+
+namespace Zhele
+{
+    /**
+     * @brief Memory placement policies
+     *
+     * @details
+     * Sections of all placements except Default are NOLOAD (see cmake/zhele-placement*.ld): they are not
+     * cleared by startup code, so large buffers don't take boot time, but their content is undefined after power-on.
+     * DmaAccessible is checked by drivers that transfer buffer by DMA.
+     */
+    namespace Placement
+    {
+        /// Ordinary static (.bss)
+        struct Default
+        {
+            static const bool Available = true;
+            static const bool DmaAccessible = true;
+        };
+
+        /// Main SRAM, not initialized at startup (.noinit)
+        struct NoInit
+        {
+            static const bool Available = true;
+            static const bool DmaAccessible = true;
+        };
+
+        /// Core coupled memory, not initialized at startup (.ccmram)
+        struct Ccm
+        {
+        #if defined (CCMDATARAM_BASE)
+            static const bool Available = true;
+        #else
+            static const bool Available = false;
+        #endif
+            static const bool DmaAccessible = false;
+        };
+
+        /// SRAM2, not initialized at startup (.sram2)
+        struct Sram2
+        {
+        #if defined (SRAM2_BASE)
+            static const bool Available = true;
+        #else
+            static const bool Available = false;
+        #endif
+            static const bool DmaAccessible = true;
+        };
+
+        /// Main SRAM reachable by DMA even if .bss is moved to CCM, not initialized at startup (.dmaram)
+        struct DmaSafe
+        {
+            static const bool Available = true;
+            static const bool DmaAccessible = true;
+        };
+    }
+
+    /**
+     * @brief Static storage with given placement
+     *
+     * @details
+     * Storage is defined once for every owner, so class template can keep its buffer here.
+     * Compilers ignore section attribute of template variables, so storage is placed by linker script
+     * (see cmake/zhele-placement.ld): template variable is emitted to its own section .bss.<mangled name>
+     * and name contains placement type. Storage with placement other than Default is not initialized,
+     * so type must be trivial.
+     *
+     * @par Example
+     * @code
+     *  template<typename _Placement = Placement::Default>
+     *  class Logger
+     *  {
+     *      static constexpr auto& _buffer = PlacedStorage<_Placement, uint8_t[4096], Logger>::Value;
+     *  };
+     * @endcode
+     *
+     * @tparam _Placement Placement policy
+     * @tparam _Type Stored type
+     * @tparam _Owner Owner (tag to distinguish storages of the same type)
+     */
+    template<typename _Placement, typename _Type, typename _Owner = void>
+    struct PlacedStorage
+    {
+        static_assert(_Placement::Available, "Memory region is not available on this MCU");
+        static_assert(std::is_same_v<_Placement, Placement::Default> || std::is_trivial_v<_Type>, "Not initialized storage type must be trivial");
+
+        static inline _Type Value{};
+    };
+
+    /**
+     * @brief Checks that DMA has access to memory
+     *
+     * @details
+     * Runtime check for buffers given by pointer (compile-time check is @ref Placement policy DmaAccessible).
+     *
+     * @param [in] pointer Buffer
+     *
+     * @retval true DMA can access buffer
+     * @retval false Buffer is in CCM
+     */
+    inline bool IsDmaAccessible(const volatile void* pointer)
+    {
+    #if defined (CCMDATARAM_BASE) && defined (CCMDATARAM_END) && !defined (ZHELE_HOST)
+        const uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+        return address < CCMDATARAM_BASE || address > CCMDATARAM_END;
+    #else
+        (void)pointer;
+        return true;
+    #endif
+    }
+}
+
+#endif //! ZHELE_PLACEMENT_H
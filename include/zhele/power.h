@@ -0,0 +1,119 @@
+/**
+ * @file
+ * Implements low-power idle management
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_POWER_H
+#define ZHELE_POWER_H
+
+#include <zhele/clock.h>
+#include <zhele/delay.h>
+#include <zhele/system_time.h>
+
+#include <stdint.h>
+
+namespace Zhele::Power
+{
+    /// Idle modes (from the lightest to the deepest)
+    enum class Mode : uint8_t
+    {
+        Run = 0, ///< Do not sleep
+        Sleep = 1, ///< Core is stopped, peripherals and clocks run
+        Stop = 2, ///< All clocks are stopped (wake up by EXTI or LPTIM), system clock is restored on wake up
+    };
+
+    /**
+     * @brief Implements low-power idle
+     * 
+     * @details
+     * Idle enters the deepest mode allowed by locks and guards and returns after wake up.
+     * Timing-critical drivers lock the deepest allowed mode (for example, Sleep if they use timers,
+     * which are stopped in Stop mode) and can use WakeLatency to decide.
+     * Low-power timers keep counting in Stop mode, so @ref SystemTime is corrected by its stop time source on wake up.
+     * Guards are peripherals with static Enabled() method (DMA channels and so on): Stop is not entered
+     * while any guard is enabled.
+     * 
+     * @par Example
+     * @code
+     *  using Power = Power::PowerManager<Dma1Channel4, Dma1Channel5>;
+     *  while (true)
+     *  {
+     *      Power::Idle();
+     *      ProcessEvents();
+     *  }
+     * @endcode
+     * 
+     * @tparam _Guards Peripherals that forbid Stop mode while they are enabled
+     */
+    template<typename... _Guards>
+    class PowerManager
+    {
+        static const unsigned ModesCount = 3;
+    public:
+        /**
+         * @brief Forbid modes deeper than given
+         * 
+         * @param [in] deepest The deepest allowed mode
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Lock(Mode deepest);
+
+        /**
+         * @brief Release lock taken by Lock
+         * 
+         * @param [in] deepest Mode given to Lock
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Unlock(Mode deepest);
+
+        /**
+         * @brief Returns the deepest mode allowed now
+         * 
+         * @returns Mode
+         */
+        static Mode AllowedMode();
+
+        /**
+         * @brief Enter the deepest allowed mode until interrupt
+         * 
+         * @details
+         * Pending interrupt handlers are called after system clock restore.
+         * 
+         * @returns Entered mode
+         */
+        static Mode Idle();
+
+        /**
+         * @brief Returns system clock restore time of last wake up from Stop
+         * 
+         * @returns Core cycles count
+         */
+        static uint32_t WakeLatency();
+
+        /**
+         * @brief Returns maximal system clock restore time after Stop
+         * 
+         * @returns Core cycles count
+         */
+        static uint32_t MaxWakeLatency();
+
+    private:
+        static void EnterStop();
+
+        static volatile uint16_t _locks[ModesCount];
+        static uint32_t _wakeLatency;
+        static uint32_t _maxWakeLatency;
+    };
+}
+
+#include "impl/power.h"
+
+#endif //! ZHELE_POWER_H
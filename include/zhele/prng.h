@@ -0,0 +1,167 @@
+/**
+ * @file
+ * Implements fast pseudo-random generator (xoshiro128++)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PRNG_H
+#define ZHELE_PRNG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements xoshiro128++ pseudo-random generator
+     *
+     * @details
+     * Generator is fast (few 32-bit operations per word) and has 2^128 - 1 period,
+     * but it's not cryptographically secure: use it for bulk non-critical randomness
+     * (backoff jitter, test data, dithering) and seed it from hardware RNG.
+     * Class meets UniformRandomBitGenerator requirements, so it can be used with standard algorithms.
+     *
+     * @par Example
+     * @code
+     *  Xoshiro128 random(Rng::Next().value_or(0));
+     *  unsigned backoff = random.Next(0, 16) * slotTime;
+     * @endcode
+     */
+    class Xoshiro128
+    {
+    public:
+        using result_type = uint32_t;
+
+        /**
+         * @brief Constructor (state is expanded from seed by splitmix64)
+         *
+         * @param [in] seed Seed
+         */
+        constexpr explicit Xoshiro128(uint64_t seed = 0)
+        {
+            Seed(seed);
+        }
+
+        /**
+         * @brief Sets new seed
+         *
+         * @param [in] seed Seed
+         *
+         * @par Returns
+         *  Nothing
+         */
+        constexpr void Seed(uint64_t seed)
+        {
+            for (unsigned i = 0; i < 4; i += 2) {
+                uint64_t z = (seed += 0x9e3779b97f4a7c15);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+                z = z ^ (z >> 31);
+                _state[i] = static_cast<uint32_t>(z);
+                _state[i + 1] = static_cast<uint32_t>(z >> 32);
+            }
+        }
+
+        /**
+         * @brief Generates random number
+         *
+         * @returns Random number
+         */
+        constexpr uint32_t Next()
+        {
+            const uint32_t result = Rotl(_state[0] + _state[3], 7) + _state[0];
+            const uint32_t t = _state[1] << 9;
+
+            _state[2] ^= _state[0];
+            _state[3] ^= _state[1];
+            _state[1] ^= _state[2];
+            _state[0] ^= _state[3];
+            _state[2] ^= t;
+            _state[3] = Rotl(_state[3], 11);
+
+            return result;
+        }
+
+        /**
+         * @brief Generates random number in given range exclude upperBound
+         *
+         * @details
+         * Number is scaled by multiplication (without division), bias is less than range / 2^32.
+         *
+         * @param [in] lowerBound Range lower bound
+         * @param [in] upperBound Range upper bound
+         *
+         * @returns Random number from range [lowerBound, upperBound)
+         */
+        constexpr uint32_t Next(uint32_t lowerBound, uint32_t upperBound)
+        {
+            const uint32_t range = upperBound - lowerBound;
+            return lowerBound + static_cast<uint32_t>((static_cast<uint64_t>(Next()) * range) >> 32);
+        }
+
+        /**
+         * @brief Generates random data in given buffer
+         *
+         * @param [out] data Data buffer
+         * @param [in] size Bytes to generate
+         *
+         * @par Returns
+         *  Nothing
+         */
+        constexpr void NextBytes(uint8_t* data, size_t size)
+        {
+            for (size_t i = 0; i < size; i += 4) {
+                uint32_t random = Next();
+                for (size_t j = i; j < size && j < i + 4; ++j, random >>= 8)
+                    data[j] = static_cast<uint8_t>(random);
+            }
+        }
+
+        /**
+         * @brief Advances generator by 2^64 numbers (gives non-overlapping sequence for another consumer)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        constexpr void Jump()
+        {
+            constexpr uint32_t JumpPolynom[] = {0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b};
+
+            uint32_t state[4] = {0, 0, 0, 0};
+            for (uint32_t word : JumpPolynom) {
+                for (unsigned bit = 0; bit < 32; ++bit) {
+                    if (word & (1u << bit)) {
+                        for (unsigned i = 0; i < 4; ++i)
+                            state[i] ^= _state[i];
+                    }
+                    Next();
+                }
+            }
+
+            for (unsigned i = 0; i < 4; ++i)
+                _state[i] = state[i];
+        }
+
+        /// Returns min generated value
+        static constexpr result_type min() { return 0; }
+
+        /// Returns max generated value
+        static constexpr result_type max() { return 0xffffffff; }
+
+        /// Generates random number
+        constexpr result_type operator()() { return Next(); }
+
+    private:
+        static constexpr uint32_t Rotl(uint32_t value, unsigned shift)
+        {
+            return (value << shift) | (value >> (32 - shift));
+        }
+
+        uint32_t _state[4] {}; ///< Generator state
+    };
+} // namespace Zhele
+
+#endif //! ZHELE_PRNG_H
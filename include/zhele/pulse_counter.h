@@ -0,0 +1,206 @@
+/**
+ * @file
+ * Implements hardware pulse counting with timer external clock
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PULSE_COUNTER_H
+#define ZHELE_PULSE_COUNTER_H
+
+#include <zhele/timer_chain.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Timers
+{
+    /**
+     * @brief Implements pulse counter (flow meter, tachometer) clocked by input pulses
+     *
+     * @details
+     * Timer counter is clocked by input signal (ETR pin in external clock mode 2 or TI1 pin
+     * in external clock mode 1), so pulses are counted by hardware and CPU is spent
+     * only for overflow interrupt every 65536 pulses (extends counter to 32 bits).
+     * Input is synchronized to timer clock, so pulse rate must be less than half (ETR: quarter)
+     * of timer clock, ETR prescaler extends this limit. Digital filter rejects bounces and spikes
+     * shorter than N samples of its clock (timer clock divided by filter divider).
+     *
+     * Frequency is measured by gate time:
+     *  - Software gate: call @ref Gate with fixed period (from SysTick or other timer interrupt),
+     *    it returns pulses count since previous call. Gate jitter is interrupt latency.
+     *  - Hardware gate (ETR input only): gate timer in one-pulse mode enables counter
+     *    through internal trigger (gated mode), so gate time is exact in timer clocks.
+     *
+     * ETR pin is not remapped by counter: configure it as alternate function input by application.
+     *
+     * @par Example
+     * @code
+     *  using Counter = Timers::PulseCounter<Timers::Timer2>;
+     *  IO::Pa0::SetConfiguration(IO::Pa0::Configuration::AltFunc);
+     *  IO::Pa0::AltFuncNumber(1); // TIM2_ETR
+     *  Counter::EnableEtr(Counter::Filter::Divide4Filter8);
+     *  Counter::Start();
+     *  extern "C" void TIM2_IRQHandler() { Counter::IrqHandler(); }
+     *  // Frequency over 100 ms gate (Timer3 gates Timer2)
+     *  Counter::MeasureFrequency<Timers::Timer3>(100, [](uint32_t frequency){ ... });
+     *  extern "C" void TIM3_IRQHandler() { Counter::GateIrqHandler<Timers::Timer3>(); }
+     * @endcode
+     *
+     * @tparam _Timer General purpose timer
+     */
+    template<typename _Timer>
+    class PulseCounter
+    {
+        using SlaveMode = typename _Timer::SlaveMode;
+        using InputChannel = typename _Timer::template InputCapture<0>;
+    public:
+        /// Input digital filter (sampling clock divider and samples count)
+        using Filter = typename SlaveMode::ExternalTriggerFilter;
+
+        /// ETR prescaler
+        using Prescaler = typename SlaveMode::ExternalTriggerPrescaler;
+
+        /// Counted edges
+        enum class Edge
+        {
+            Rising, ///< Rising edges
+            Falling, ///< Falling edges
+            Both ///< Both edges (TI1 input only)
+        };
+
+        /// Frequency measurement complete callback (frequency in Hz)
+        using FrequencyCallback = std::add_pointer_t<void(uint32_t frequency)>;
+
+        /**
+         * @brief Configures counter clocked by ETR pin (external clock mode 2)
+         *
+         * @param [in] filter Digital filter
+         * @param [in] edge Counted edge (rising or falling)
+         * @param [in] prescaler ETR prescaler (for input rate above quarter of timer clock)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void EnableEtr(Filter filter = Filter::NoFilter, Edge edge = Edge::Rising, Prescaler prescaler = Prescaler::PrescalerOff);
+
+        /**
+         * @brief Configures counter clocked by TI1 pin (external clock mode 1)
+         *
+         * @tparam _Pin Channel 1 pin
+         *
+         * @param [in] filter Digital filter
+         * @param [in] edge Counted edge
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Pin>
+        static void EnableTi1(Filter filter = Filter::NoFilter, Edge edge = Edge::Rising);
+
+        /**
+         * @brief Resets count and starts counting
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start();
+
+        /**
+         * @brief Stops counting (count is kept)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+
+        /**
+         * @brief Resets count
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset();
+
+        /**
+         * @brief Returns pulses count
+         *
+         * @details
+         * Pending overflow (interrupt is masked or not handled yet) is taken into account,
+         * so count is consistent in any context.
+         *
+         * @returns Pulses count (32-bit, wraps)
+         */
+        static uint32_t Count();
+
+        /**
+         * @brief Software gate: returns pulses since previous call
+         *
+         * @details
+         * Call it with fixed gate period, frequency is result divided by gate time.
+         *
+         * @returns Pulses count during gate
+         */
+        static uint32_t Gate();
+
+        /**
+         * @brief Starts frequency measurement with hardware gate (ETR input only)
+         *
+         * @details
+         * Counter is reset and counts while gate timer runs (one pulse of @p gateMs).
+         * Gate timer must be connected to counter internal trigger.
+         *
+         * @tparam _GateTimer Gate timer
+         *
+         * @param [in] gateMs Gate time in milliseconds (1 - 6553)
+         * @param [in] callback Measurement complete callback (called from gate timer interrupt)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _GateTimer>
+        static void MeasureFrequency(uint16_t gateMs, FrequencyCallback callback);
+
+        /**
+         * @brief Returns hardware gate measurement state
+         *
+         * @retval true Measurement is in progress
+         * @retval false No measurement
+         */
+        static bool IsMeasuring();
+
+        /**
+         * @brief Counter timer interrupt handler (overflow)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+        /**
+         * @brief Gate timer interrupt handler (end of gate)
+         *
+         * @tparam _GateTimer Gate timer
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _GateTimer>
+        static void GateIrqHandler();
+
+    private:
+        static void Configure();
+
+        static inline volatile uint32_t _overflows = 0; ///< Counter overflows (high half of count)
+        static inline uint32_t _lastGate = 0; ///< Count at previous software gate
+        static inline uint16_t _gateMs = 0; ///< Hardware gate time
+        static inline volatile bool _measuring = false; ///< Hardware gate is open
+        static inline FrequencyCallback _callback = nullptr; ///< Measurement callback
+    };
+}
+
+#include "impl/pulse_counter.h"
+
+#endif //! ZHELE_PULSE_COUNTER_H
@@ -0,0 +1,130 @@
+/**
+ * @file
+ * Implements timer and DMA driven pulse train (arbitrary waveform) generator
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PULSE_TRAIN_H
+#define ZHELE_PULSE_TRAIN_H
+
+#include <zhele/timer.h>
+
+#include <stdint.h>
+
+namespace Zhele
+{
+    namespace Private
+    {
+        /// Timer with repetition counter (advanced timer) concept
+        template<typename T>
+        concept RepetitionCounterTimerType = requires { T::SetRepetitionCounter(0); T::EnableOutputs(); };
+    }
+
+    /**
+     * @brief Implements pulse train generator
+     *
+     * @details
+     * Every step of sequence is (ARR, RCR, CCR1..CCRn) values, DMA burst (see GPTimer::StartDmaBurst) writes
+     * the next step to preload registers on every update event, so steps are switched exactly
+     * at period boundary with timer clock resolution and without CPU. Step is one PWM period (PWM1 mode):
+     * output is active for pulse ticks, then inactive up to period end.
+     * Advanced timer repeats step (RCR + 1) times before the next update event, so one step
+     * describes burst of equal pulses (repeat-count mode), general-purpose timer ignores repetition value.
+     * Steps of other channels (CCR1..CCR(n-1)) are written too, set them as needed or to zero.
+     * Sequence starts after short idle lead-in (four timer ticks). Finite sequence ends with its last step
+     * repeated endlessly, so make it idle one (zero pulse) and call @ref Stop in callback if timer should be released.
+     * Circular sequence is generated continuously, with constant period and varying pulses it is arbitrary waveform
+     * (PWM DAC, filter output by low-pass RC).
+     *
+     * @par Example
+     * @code
+     *  using Train = PulseTrain<Timers::Timer1, 0, Dma1Channel5>;
+     *  // 3 pulses of 10 us every 50 us, pause 200 us, 2 pulses of 20 us, idle (timer clock is 1 MHz)
+     *  static const Train::Step steps[] = {
+     *      Train::MakeStep(50, 10, 3), Train::MakeStep(200, 0), Train::MakeStep(40, 20, 2), Train::MakeStep(100, 0)
+     *  };
+     *  Timers::Timer1::SetPrescaler(Timers::Timer1::GetClockFreq() / 1000000 - 1);
+     *  Train::Init();
+     *  Train::Channel::SelectPins<IO::Pa8>();
+     *  Train::Start(steps, 4);
+     * @endcode
+     *
+     * @tparam _Timer Timer (general-purpose or advanced)
+     * @tparam _Channel Output channel number (0..3)
+     * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+     */
+    template<typename _Timer, unsigned _Channel, typename _DmaChannel>
+    class PulseTrain
+    {
+        static_assert(_Channel < 4, "Timer has 4 channels");
+        using Counter = decltype(_Timer::GetPeriod());
+        static constexpr uint8_t BurstLength = 3 + _Channel;
+    public:
+        /// Output channel
+        using Channel = typename _Timer::template PWMGeneration<_Channel>;
+
+        /// Repeat-count mode is supported (advanced timer)
+        static constexpr bool RepetitionSupported = Private::RepetitionCounterTimerType<_Timer>;
+
+        /// Sequence step (layout mirrors registers from ARR, do not reorder fields)
+        struct Step
+        {
+            Counter period; ///< Period (ARR value, ticks count - 1)
+            Counter repetition; ///< Step repetitions - 1 (RCR value, ignored by general-purpose timer)
+            Counter pulses[_Channel + 1]; ///< Pulses (CCRx values) of channels 0.._Channel
+        };
+
+        /**
+         * @brief Creates step
+         *
+         * @param [in] ticks Period in timer ticks (2 at least)
+         * @param [in] pulse Output channel pulse in timer ticks (0 is idle step)
+         * @param [in] repeat Step repetitions (1..256, advanced timer only)
+         *
+         * @returns Step
+         */
+        static constexpr Step MakeStep(uint32_t ticks, Counter pulse, uint16_t repeat = 1);
+
+        /**
+         * @brief Inits timer and output channel
+         *
+         * @details
+         * Timer clock (prescaler) should be set by user, it is step resolution.
+         * Method enables period and pulse preload, sets PWM1 mode and enables channel (and main output of advanced timer).
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Starts sequence
+         *
+         * @param [in] steps Steps (must be accessible by DMA and stay valid while sequence is generated)
+         * @param [in] count Steps count
+         * @param [in] callback DMA transfer complete callback (the last step is loaded, it is generated after callback)
+         * @param [in] circular Repeat sequence endlessly
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start(const Step* steps, uint16_t count, TransferCallback callback = nullptr, bool circular = false);
+
+        /**
+         * @brief Stops timer and DMA, output goes to inactive level
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+
+        static_assert(sizeof(Step) == BurstLength * sizeof(Counter), "Step must be registers image");
+    };
+}
+
+#include "impl/pulse_train.h"
+
+#endif //! ZHELE_PULSE_TRAIN_H
@@ -0,0 +1,24 @@
+/**
+ * @file
+ * United header for QUADSPI
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @licence FreeBSD
+ */
+
+#if defined(STM32F0)
+    #error STM32F0 does not support QUADSPI
+#endif
+#if defined(STM32F1)
+    #error STM32F1 does not support QUADSPI
+#endif
+#if defined(STM32F4)
+    #error QUADSPI is not implemented for STM32F4
+#endif
+#if defined(STM32L4)
+    #include "l4/quadspi.h"
+#endif
+#if defined(STM32G0)
+    #error STM32G0 does not support QUADSPI
+#endif
@@ -0,0 +1,24 @@
+/**
+ * @file
+ * United header for internal RTC
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @licence FreeBSD
+ */
+
+#if defined(STM32F0)
+    #include "f0/rtc.h"
+#endif
+#if defined(STM32F1)
+    #error RTC is not implemented for STM32F1 (it has counter-based RTC without calendar)
+#endif
+#if defined(STM32F4)
+    #include "f4/rtc.h"
+#endif
+#if defined(STM32L4)
+    #include "l4/rtc.h"
+#endif
+#if defined(STM32G0)
+    #include "g0/rtc.h"
+#endif
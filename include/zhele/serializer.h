@@ -0,0 +1,249 @@
+/**
+ * @file
+ * Implements compile-time serializer for packed wire structs
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SERIALIZER_H
+#define ZHELE_SERIALIZER_H
+
+#include <zhele/binary_stream.h>
+
+#include "common/template_utils/type_list.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Zhele
+{
+    /**
+     * @brief Wire struct field
+     *
+     * @tparam T Field type (integer, enum or floating point type of 1, 2, 4 or 8 bytes)
+     * @tparam _Order Byte order on wire
+     */
+    template<typename T, Endianness _Order = LittleEndian>
+    struct Field
+    {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "Field must be scalar");
+        static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "Unsupported field size");
+        static_assert(_Order != MixedEndian, "Mixed endian fields are not supported");
+
+        using Type = T; ///< Field type
+        static const Endianness Order = _Order; ///< Field byte order
+    };
+
+    /**
+     * @brief Implements encoding and decoding of packed wire struct
+     *
+     * @details
+     * Fields layout (offsets and total size) is calculated at compile time, so encoding is sequence of
+     * stores to constant offsets of one contiguous buffer (with REV for big-endian fields on little-endian core).
+     * Encoded buffer can be sent by one DMA transfer.
+     *
+     * @par Example
+     * @code
+     *  enum class Command : uint8_t { Read = 1, Write = 2 };
+     *  using Header = Serializer<Field<Command>, Field<uint16_t, BigEndian>, Field<uint32_t, BigEndian>>;
+     *
+     *  static Header::Buffer frame;
+     *  Header::Encode(frame, Command::Read, length, address);
+     *  Usart1::WriteAsync(frame.data(), frame.size());
+     *
+     *  auto [command, length, address] = Header::Decode(received);
+     * @endcode
+     *
+     * @tparam Fields Fields (@ref Field)
+     */
+    template<typename... Fields>
+    class Serializer
+    {
+        static_assert(sizeof...(Fields) > 0, "Struct must have at least one field");
+
+        using FieldList = TemplateUtils::TypeList<Fields...>;
+
+        template<size_t _Index>
+        using FieldAt = TemplateUtils::TypeUnbox<FieldList::template get<_Index>()>;
+
+        /// Field offsets
+        static constexpr std::array<size_t, sizeof...(Fields)> Offsets = []() {
+            std::array<size_t, sizeof...(Fields)> offsets {};
+            size_t offset = 0, index = 0;
+            ((offsets[index++] = offset, offset += sizeof(typename Fields::Type)), ...);
+            return offsets;
+        }();
+
+    public:
+        /// Encoded struct size
+        static const size_t Size = (sizeof(typename Fields::Type) + ...);
+
+        /// Encoded struct buffer
+        using Buffer = std::array<uint8_t, Size>;
+
+        /// Decoded values
+        using Values = std::tuple<typename Fields::Type...>;
+
+        /**
+         * @brief Encodes values to buffer
+         *
+         * @param [out] buffer Buffer (at least Size bytes)
+         * @param [in] values Fields values
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Encode(uint8_t* buffer, typename Fields::Type... values)
+        {
+            EncodeFields(buffer, std::index_sequence_for<Fields...>{}, values...);
+        }
+
+        /**
+         * @brief Encodes values to buffer
+         *
+         * @param [out] buffer Buffer
+         * @param [in] values Fields values
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Encode(Buffer& buffer, typename Fields::Type... values)
+        {
+            Encode(buffer.data(), values...);
+        }
+
+        /**
+         * @brief Decodes values from buffer
+         *
+         * @param [in] buffer Buffer (at least Size bytes)
+         *
+         * @returns Fields values
+         */
+        static Values Decode(const uint8_t* buffer)
+        {
+            return DecodeFields(buffer, std::index_sequence_for<Fields...>{});
+        }
+
+        /**
+         * @brief Decodes values from buffer
+         *
+         * @param [in] buffer Buffer
+         *
+         * @returns Fields values
+         */
+        static Values Decode(const Buffer& buffer)
+        {
+            return Decode(buffer.data());
+        }
+
+        /**
+         * @brief Decodes one field from buffer
+         *
+         * @tparam _Index Field index
+         *
+         * @param [in] buffer Buffer (at least Size bytes)
+         *
+         * @returns Field value
+         */
+        template<size_t _Index>
+        static auto Get(const uint8_t* buffer)
+        {
+            return Load<FieldAt<_Index>>(buffer + Offsets[_Index]);
+        }
+
+        /**
+         * @brief Encodes values and writes them to stream by one bulk write
+         *
+         * @tparam _Stream Stream type (@ref BinaryStream)
+         *
+         * @param [in] stream Stream
+         * @param [in] values Fields values
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Stream>
+        static void Write(_Stream& stream, typename Fields::Type... values)
+        {
+            Buffer buffer;
+            Encode(buffer, values...);
+            stream.WriteSpan(buffer);
+        }
+
+        /**
+         * @brief Reads struct from stream by one bulk read and decodes it
+         *
+         * @tparam _Stream Stream type (@ref BinaryStream)
+         *
+         * @param [in] stream Stream
+         *
+         * @returns Fields values
+         */
+        template<typename _Stream>
+        static Values Read(_Stream& stream)
+        {
+            Buffer buffer;
+            stream.ReadSpan(buffer);
+            return Decode(buffer);
+        }
+
+    private:
+        template<size_t _Size>
+        using Raw = std::conditional_t<_Size == 1, uint8_t,
+            std::conditional_t<_Size == 2, uint16_t,
+            std::conditional_t<_Size == 4, uint32_t, uint64_t>>>;
+
+        template<typename T>
+        static T Swap(T value)
+        {
+            if constexpr (sizeof(T) == 2)
+                return Private::ByteSwap16(value);
+            else if constexpr (sizeof(T) == 4)
+                return Private::ByteSwap32(value);
+            else if constexpr (sizeof(T) == 8)
+                return (uint64_t(Private::ByteSwap32(uint32_t(value))) << 32) | Private::ByteSwap32(uint32_t(value >> 32));
+            else
+                return value;
+        }
+
+        template<typename _Field>
+        static void Store(uint8_t* destination, typename _Field::Type value)
+        {
+            auto raw = std::bit_cast<Raw<sizeof(value)>>(value);
+            if constexpr (_Field::Order == BigEndian)
+                raw = Swap(raw);
+            memcpy(destination, &raw, sizeof(raw));
+        }
+
+        template<typename _Field>
+        static typename _Field::Type Load(const uint8_t* source)
+        {
+            Raw<sizeof(typename _Field::Type)> raw;
+            memcpy(&raw, source, sizeof(raw));
+            if constexpr (_Field::Order == BigEndian)
+                raw = Swap(raw);
+            return std::bit_cast<typename _Field::Type>(raw);
+        }
+
+        template<size_t... _Indexes>
+        static void EncodeFields(uint8_t* buffer, std::index_sequence<_Indexes...>, typename Fields::Type... values)
+        {
+            (Store<Fields>(buffer + Offsets[_Indexes], values), ...);
+        }
+
+        template<size_t... _Indexes>
+        static Values DecodeFields(const uint8_t* buffer, std::index_sequence<_Indexes...>)
+        {
+            return Values{Load<Fields>(buffer + Offsets[_Indexes])...};
+        }
+    };
+} // namespace Zhele
+
+#endif //! ZHELE_SERIALIZER_H
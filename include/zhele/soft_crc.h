@@ -0,0 +1,365 @@
+/**
+ * @file
+ * Implements table-driven software CRC (CRC7/CRC8/CRC16/CRC32)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SOFT_CRC_H
+#define ZHELE_SOFT_CRC_H
+
+#include "crc.h"
+
+#include <array>
+#include <span>
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief Software CRC lookup table kind
+     */
+    enum class CrcTable
+    {
+        Nibble, ///< 16 entries table (small flash, two lookups per byte)
+        Byte, ///< 256 entries table (one lookup per byte)
+        Slice4 ///< Four 256 entries tables (four bytes per iteration)
+    };
+
+    namespace Private
+    {
+        /**
+         * @brief Returns CRC register type for given width
+         *
+         * @tparam _Width CRC width
+         */
+        template<unsigned _Width>
+        using CrcRegister = std::conditional_t<_Width <= 8, uint8_t, std::conditional_t<_Width <= 16, uint16_t, uint32_t>>;
+
+        /**
+         * @brief Reflects low bits of value
+         *
+         * @param [in] value Value
+         * @param [in] width Bits count
+         *
+         * @returns Reflected value
+         */
+        constexpr uint32_t CrcReflect(uint32_t value, unsigned width)
+        {
+            uint32_t result = 0;
+            for (unsigned bit = 0; bit < width; ++bit, value >>= 1)
+                result = (result << 1) | (value & 0x01);
+            return result;
+        }
+
+        /**
+         * @brief Shifts CRC register by given bits count (bitwise algorithm)
+         *
+         * @details
+         * Reflected register is low-aligned and shifted right, direct register is
+         * aligned to the register type top and shifted left.
+         *
+         * @tparam T Register type
+         *
+         * @param [in] crc Register value
+         * @param [in] polynom Polynom (reflected or aligned with register)
+         * @param [in] reflect Register is reflected
+         * @param [in] bits Bits count
+         *
+         * @returns Register value
+         */
+        template<typename T>
+        constexpr T CrcShift(T crc, T polynom, bool reflect, unsigned bits)
+        {
+            constexpr T Top = static_cast<T>(T{1} << (sizeof(T) * 8 - 1));
+            for (unsigned bit = 0; bit < bits; ++bit) {
+                if (reflect)
+                    crc = static_cast<T>((crc & 0x01) ? (crc >> 1) ^ polynom : crc >> 1);
+                else
+                    crc = static_cast<T>((crc & Top) ? (crc << 1) ^ polynom : crc << 1);
+            }
+            return crc;
+        }
+
+        /**
+         * @brief Builds nibble lookup table
+         *
+         * @tparam T Register type
+         *
+         * @param [in] polynom Polynom (reflected or aligned with register)
+         * @param [in] reflect Register is reflected
+         *
+         * @returns Table
+         */
+        template<typename T>
+        constexpr std::array<T, 16> MakeCrcNibbleTable(T polynom, bool reflect)
+        {
+            std::array<T, 16> table {};
+            for (unsigned i = 0; i < 16; ++i)
+                table[i] = CrcShift<T>(static_cast<T>(reflect ? i : i << (sizeof(T) * 8 - 4)), polynom, reflect, 4);
+            return table;
+        }
+
+        /**
+         * @brief Builds slice-by-N lookup tables
+         *
+         * @tparam T Register type
+         * @tparam _Slices Tables count (table k is CRC of byte followed by k zero bytes)
+         *
+         * @param [in] polynom Polynom (reflected or aligned with register)
+         * @param [in] reflect Register is reflected
+         *
+         * @returns Tables
+         */
+        template<typename T, unsigned _Slices>
+        constexpr std::array<std::array<T, 256>, _Slices> MakeCrcByteTables(T polynom, bool reflect)
+        {
+            constexpr unsigned Shift = sizeof(T) * 8 - 8;
+            std::array<std::array<T, 256>, _Slices> tables {};
+            for (unsigned i = 0; i < 256; ++i)
+                tables[0][i] = CrcShift<T>(static_cast<T>(reflect ? i : i << Shift), polynom, reflect, 8);
+
+            for (unsigned k = 1; k < _Slices; ++k) {
+                for (unsigned i = 0; i < 256; ++i) {
+                    T previous = tables[k - 1][i];
+                    tables[k][i] = reflect
+                        ? static_cast<T>((previous >> 8) ^ tables[0][previous & 0xff])
+                        : static_cast<T>((previous << 8) ^ tables[0][previous >> Shift]);
+                }
+            }
+            return tables;
+        }
+    }
+
+    /**
+     * @brief Implements table-driven CRC (Rocksoft model parameters)
+     *
+     * @details
+     * Lookup tables are generated at compile time and placed in flash.
+     * Flash usage is 16, 256 or 1024 entries (of CRC register type) for nibble, byte and slice-by-4 tables.
+     *
+     * @ref Calculate uses hardware CRC unit if it can calculate CRC with given parameters:
+     * standard CRC-32 on all MCUs and any reflected 32-bit CRC with all ones initial value and output XOR
+     * on MCUs with programmable polynom (F0, L4, G0). Incremental calculation is always software.
+     *
+     * @note Hardware calculation resets CRC unit, so don't call @ref Calculate for such CRC
+     * between @ref Crc::Begin and @ref Crc::Finish (and from interrupts if CRC unit is used by main loop).
+     *
+     * @par Example
+     * @code
+     *  const uint8_t data[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x0a};
+     *  uint16_t crc = Crc16Modbus::Calculate(data, sizeof(data));
+     *
+     *  // Incremental calculation
+     *  auto state = Crc32C::Initial();
+     *  state = Crc32C::Update(state, header);
+     *  state = Crc32C::Update(state, payload);
+     *  uint32_t crc32c = Crc32C::Finish(state);
+     * @endcode
+     *
+     * @tparam _Polynom Polynom (normal representation, without top bit)
+     * @tparam _Width CRC width (3...32 bits)
+     * @tparam _Reflect Input bytes are reflected (LSB first)
+     * @tparam _Init Initial value
+     * @tparam _XorOut Final XOR value
+     * @tparam _Table Lookup table kind
+     * @tparam _ReflectOut Output is reflected (it's the same as input reflection for most CRCs)
+     */
+    template<uint32_t _Polynom, unsigned _Width, bool _Reflect, uint32_t _Init, uint32_t _XorOut, CrcTable _Table = CrcTable::Byte, bool _ReflectOut = _Reflect>
+    class SoftCrc
+    {
+        static_assert(_Width >= 3 && _Width <= 32, "CRC width must be in range 3...32");
+
+        using Register = Private::CrcRegister<_Width < 8 ? 8 : _Width>;
+
+        static const unsigned RegisterWidth = sizeof(Register) * 8;
+        static const unsigned Shift = _Reflect ? 0 : RegisterWidth - _Width; ///< Direct register is aligned to top
+        static constexpr uint32_t Mask = 0xffffffff >> (32 - _Width);
+
+        static constexpr Register Polynom = _Reflect
+            ? static_cast<Register>(Private::CrcReflect(_Polynom & Mask, _Width))
+            : static_cast<Register>((_Polynom & Mask) << Shift);
+
+        static constexpr auto Table = []() {
+            if constexpr (_Table == CrcTable::Nibble)
+                return Private::MakeCrcNibbleTable<Register>(Polynom, _Reflect);
+            else
+                return Private::MakeCrcByteTables<Register, _Table == CrcTable::Slice4 ? 4 : 1>(Polynom, _Reflect);
+        }();
+
+        /// Hardware CRC unit can calculate this CRC
+        static constexpr bool HardwareCompatible = _Width == 32 && _Reflect && _ReflectOut
+            && _Init == 0xffffffff && _XorOut == 0xffffffff
+        #if defined (CRC_POL_POL)
+            && (_Polynom & 0x01) != 0; // Programmable polynom must be odd
+        #else
+            && _Polynom == 0x04c11db7;
+        #endif
+
+        /**
+         * @brief Returns register byte that is combined with n-th input byte
+         *
+         * @param [in] crc Register
+         * @param [in] n Byte index (from the first processed byte)
+         *
+         * @returns Register byte (0 if register has less bytes)
+         */
+        static constexpr uint8_t RegisterByte(Register crc, unsigned n)
+        {
+            if (n >= sizeof(Register))
+                return 0;
+            return _Reflect
+                ? static_cast<uint8_t>(crc >> (8 * n))
+                : static_cast<uint8_t>(crc >> (RegisterWidth - 8 - 8 * n));
+        }
+
+    public:
+        /// CRC value type
+        using ValueType = Register;
+
+        /**
+         * @brief Returns initial state of incremental calculation
+         *
+         * @returns State
+         */
+        static constexpr Register Initial()
+        {
+            return _Reflect
+                ? static_cast<Register>(Private::CrcReflect(_Init & Mask, _Width))
+                : static_cast<Register>((_Init & Mask) << Shift);
+        }
+
+        /**
+         * @brief Adds byte to incremental calculation
+         *
+         * @param [in] state State
+         * @param [in] byte Data byte
+         *
+         * @returns New state
+         */
+        static constexpr Register Update(Register state, uint8_t byte)
+        {
+            if constexpr (_Table == CrcTable::Nibble) {
+                if constexpr (_Reflect) {
+                    state = static_cast<Register>((state >> 4) ^ Table[(state ^ byte) & 0x0f]);
+                    return static_cast<Register>((state >> 4) ^ Table[(state ^ (byte >> 4)) & 0x0f]);
+                } else {
+                    state = static_cast<Register>((state << 4) ^ Table[((state >> (RegisterWidth - 4)) ^ (byte >> 4)) & 0x0f]);
+                    return static_cast<Register>((state << 4) ^ Table[((state >> (RegisterWidth - 4)) ^ byte) & 0x0f]);
+                }
+            } else {
+                if constexpr (_Reflect)
+                    return static_cast<Register>((state >> 8) ^ Table[0][(state ^ byte) & 0xff]);
+                else
+                    return static_cast<Register>((state << 8) ^ Table[0][((state >> (RegisterWidth - 8)) ^ byte) & 0xff]);
+            }
+        }
+
+        /**
+         * @brief Adds data to incremental calculation
+         *
+         * @param [in] state State
+         * @param [in] data Data
+         *
+         * @returns New state
+         */
+        static constexpr Register Update(Register state, std::span<const uint8_t> data)
+        {
+            const uint8_t* bytes = data.data();
+            size_t size = data.size();
+
+            if constexpr (_Table == CrcTable::Slice4) {
+                for (; size >= 4; size -= 4, bytes += 4) {
+                    state = static_cast<Register>(Table[3][bytes[0] ^ RegisterByte(state, 0)]
+                        ^ Table[2][bytes[1] ^ RegisterByte(state, 1)]
+                        ^ Table[1][bytes[2] ^ RegisterByte(state, 2)]
+                        ^ Table[0][bytes[3] ^ RegisterByte(state, 3)]);
+                }
+            }
+
+            for (; size > 0; --size, ++bytes)
+                state = Update(state, *bytes);
+
+            return state;
+        }
+
+        /**
+         * @brief Finishes incremental calculation
+         *
+         * @param [in] state State
+         *
+         * @returns CRC
+         */
+        static constexpr Register Finish(Register state)
+        {
+            uint32_t crc = static_cast<uint32_t>(state) >> Shift;
+            if constexpr (_Reflect != _ReflectOut)
+                crc = Private::CrcReflect(crc, _Width);
+            return static_cast<Register>((crc ^ _XorOut) & Mask);
+        }
+
+        /**
+         * @brief Calculates CRC (by hardware unit if it's possible)
+         *
+         * @param [in] data Data
+         *
+         * @returns CRC
+         */
+        static constexpr Register Calculate(std::span<const uint8_t> data)
+        {
+            if !consteval {
+                if constexpr (HardwareCompatible) {
+                    Crc::Enable();
+                #if defined (CRC_POL_POL)
+                    if constexpr (_Polynom != 0x04c11db7) {
+                        uint32_t polynom = Crc::GetPolynom();
+                        uint32_t crc = Crc::CalculateCrc32(_Polynom, data.data(), data.size());
+                        Crc::SetPolynom(polynom);
+                        return crc;
+                    }
+                #endif
+                    return Crc::CalculateCrc32(data.data(), data.size());
+                }
+            }
+
+            return Finish(Update(Initial(), data));
+        }
+
+        /**
+         * @brief Calculates CRC (by hardware unit if it's possible)
+         *
+         * @param [in] data Data
+         * @param [in] size Data size
+         *
+         * @returns CRC
+         */
+        static Register Calculate(const void* data, size_t size)
+        {
+            return Calculate(std::span<const uint8_t>(static_cast<const uint8_t*>(data), size));
+        }
+    };
+
+    /// CRC-7/MMC (SD card commands)
+    using Crc7Mmc = SoftCrc<0x09, 7, false, 0x00, 0x00>;
+    /// CRC-8/MAXIM (1-Wire)
+    using Crc8Maxim = SoftCrc<0x31, 8, true, 0x00, 0x00>;
+    /// CRC-8/SMBUS
+    using Crc8Smbus = SoftCrc<0x07, 8, false, 0x00, 0x00>;
+    /// CRC-8 of Trinamic UART datagrams (LSB first input, direct output)
+    using Crc8Tmc = SoftCrc<0x07, 8, true, 0x00, 0x00, CrcTable::Byte, false>;
+    /// CRC-16/XMODEM (SD card data)
+    using Crc16Xmodem = SoftCrc<0x1021, 16, false, 0x0000, 0x0000>;
+    /// CRC-16/CCITT-FALSE
+    using Crc16CcittFalse = SoftCrc<0x1021, 16, false, 0xffff, 0x0000>;
+    /// CRC-16/MODBUS
+    using Crc16Modbus = SoftCrc<0x8005, 16, true, 0xffff, 0x0000>;
+    /// CRC-32 (Ethernet, zlib)
+    using Crc32Ieee = SoftCrc<0x04c11db7, 32, true, 0xffffffff, 0xffffffff>;
+    /// CRC-32C (Castagnoli)
+    using Crc32C = SoftCrc<0x1edc6f41, 32, true, 0xffffffff, 0xffffffff>;
+} // namespace Zhele
+
+#endif //! ZHELE_SOFT_CRC_H
@@ -0,0 +1,236 @@
+/**
+ * @file
+ * Implements software I2C master over GPIO paced by timer
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SOFT_I2C_H
+#define ZHELE_SOFT_I2C_H
+
+#include <zhele/i2c.h>
+
+#include <stdint.h>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements software I2C master (extra I2C bus on any pins)
+     *
+     * @details
+     * Bus is driven by timer update interrupt with half SCL period, so SCL frequency doesn't depend
+     * on optimization level and CPU load is two short interrupts per bit (timer is stopped between
+     * transactions). Every interrupt is one step of state machine: SCL is released on one tick,
+     * on next tick SDA is sampled, SCL is pulled low and SDA is set for next bit
+     * (setup time is half period, hold time is a few CPU cycles, which is allowed by I2C specification).
+     * Clock stretching is supported, slave holding SCL too long (@ref MaxStretchTicks) aborts transfer
+     * with timeout. Only single master and 7-bit addresses are supported.
+     *
+     * Class has the same interface as I2C, so sensor drivers work on it unchanged. Async methods return
+     * immediately and call callback from timer interrupt, blocking methods wait for transfer end,
+     * so they must not be called from interrupts with priority higher (or equal) than timer one.
+     *
+     * @par Example
+     * @code
+     *  using I2c3 = SoftI2c<IO::Pb6, IO::Pb7, Timers::Timer4>;
+     *  extern "C" void TIM4_IRQHandler() { I2c3::IrqHandler(); }
+     *  I2c3::Init(100000);
+     *  Drivers::Bmp280<I2c3> sensor;
+     * @endcode
+     *
+     * @tparam _SclPin SCL pin
+     * @tparam _SdaPin SDA pin
+     * @tparam _Timer Timer (basic or general purpose)
+     */
+    template<typename _SclPin, typename _SdaPin, typename _Timer>
+    class SoftI2c
+    {
+        /// Transfer steps
+        enum class Step : uint8_t
+        {
+            Idle, ///< No transfer
+            Start, ///< SDA falls while SCL is high
+            StartLow, ///< SCL falls after start
+            Bit, ///< Bit transfer (SCL rise or fall)
+            RestartHigh, ///< SCL rises before repeated start
+            RestartStart, ///< SDA falls while SCL is high (repeated start)
+            StopHigh, ///< SCL rises before stop
+            StopDone, ///< SDA rises while SCL is high
+        };
+
+        /// Counter frequency of timer
+        static const uint32_t TimerFrequency = 8000000;
+
+        /// Max header bytes count (device address and 16-bit register address)
+        static const uint8_t MaxHeaderSize = 3;
+    public:
+        using DmaTx = void;
+        using DmaRx = void;
+
+        /// Max clock stretching (in half periods of SCL)
+        static const uint16_t MaxStretchTicks = 2000;
+
+        /**
+         * @brief Initializes pins and timer
+         *
+         * @param [in] i2cClockSpeed SCL frequency (up to 400 kHz)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint32_t i2cClockSpeed = 100000U);
+
+        /**
+         * @brief Write 8-bit unsigned to register.
+         *
+         * @param [in] devAddr Device address.
+         * @param [in] regAddr Register address.
+         * @param [in] data Data to write.
+         * @param [in] opts Options.
+         *
+         * @returns Write status.
+         */
+        static I2cStatus WriteU8(uint16_t devAddr, uint16_t regAddr, uint8_t data, I2cOpts opts = I2cOpts::None);
+
+        /**
+         * @brief Write data to register.
+         *
+         * @param [in] devAddr Device address.
+         * @param [in] regAddr Register address.
+         * @param [in] data Data to write.
+         * @param [in] size Data size.
+         * @param [in] opts Options.
+         *
+         * @returns Write status.
+         */
+        static I2cStatus Write(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cOpts opts = I2cOpts::None);
+
+        /**
+         * @brief Write data to register async.
+         *
+         * @param [in] devAddr Device address.
+         * @param [in] regAddr Register address.
+         * @param [in] data Data to write (must be valid until callback).
+         * @param [in] size Data size.
+         * @param [in] opts Options.
+         * @param [in] callback Complete (or error) callback.
+         *
+         * @returns Start status.
+         */
+        static I2cStatus WriteAsync(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cOpts opts = I2cOpts::None, I2cCallback callback = nullptr);
+
+        /**
+         * @brief Read 8-bit unsigned.
+         *
+         * @param [in] devAddr Device address.
+         * @param [in] regAddr Register address.
+         * @param [in] opts Options.
+         *
+         * @returns Read value and status.
+         */
+        static ReadResult ReadU8(uint16_t devAddr, uint16_t regAddr, I2cOpts opts = I2cOpts::None);
+
+        /**
+         * @brief Read some bytes.
+         *
+         * @param [in] devAddr Device address.
+         * @param [in] regAddr Register address.
+         * @param [out] data Data buffer.
+         * @param [in] size Data size.
+         * @param [in] opts Options.
+         *
+         * @returns Operation status.
+         */
+        static I2cStatus Read(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts = I2cOpts::None);
+
+        /**
+         * @brief Read some bytes async.
+         *
+         * @param [in] devAddr Device address.
+         * @param [in] regAddr Register address.
+         * @param [out] data Output buffer.
+         * @param [in] size Data size to read.
+         * @param [in] opts Options.
+         * @param [in] callback Complete (or error) callback.
+         *
+         * @returns Start status.
+         */
+        static I2cStatus EnableAsyncRead(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts = I2cOpts::None, I2cCallback callback = nullptr);
+
+        /**
+         * @brief Returns bus state
+         *
+         * @retval true Transfer is in progress
+         * @retval false Bus is idle
+         */
+        static bool Busy();
+
+        /**
+         * @brief Timer interrupt handler (one step of transfer)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        /**
+         * @brief Starts transfer
+         *
+         * @param [in] devAddr Device address
+         * @param [in] regAddr Register address
+         * @param [in] data Data buffer
+         * @param [in] size Data size
+         * @param [in] opts Options
+         * @param [in] mode Direction
+         * @param [in] callback Callback
+         *
+         * @returns Start status
+         */
+        static I2cStatus Begin(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts, I2cMode mode, I2cCallback callback);
+
+        /**
+         * @brief Waits for transfer end
+         *
+         * @param [in] status Start status
+         *
+         * @returns Transfer status
+         */
+        static I2cStatus Wait(I2cStatus status);
+
+        static void Tick();
+        static void BitFall();
+        static void NextByte();
+        static void LoadTx(uint8_t value);
+        static void LoadRx();
+        static void BeginStop(I2cStatus status);
+        static void Finish(I2cStatus status);
+        static void SetSda(bool high);
+
+        static inline uint8_t _header[MaxHeaderSize] = {}; ///< Device and register address bytes
+        static inline uint8_t _headerSize = 0; ///< Header bytes count
+        static inline uint8_t _headerIndex = 0; ///< Next header byte
+        static inline uint8_t _readAddress = 0; ///< Device address byte for reading after repeated start (0 if there is no restart)
+        static inline uint8_t* _data = nullptr; ///< Data buffer
+        static inline uint16_t _size = 0; ///< Data size
+        static inline uint16_t _dataIndex = 0; ///< Current data byte
+        static inline I2cMode _mode = I2cMode::Idle; ///< Direction
+        static inline I2cCallback _callback = nullptr; ///< Callback
+
+        static inline Step _step = Step::Idle; ///< Current step
+        static inline bool _rise = false; ///< Next bit tick releases SCL
+        static inline bool _receive = false; ///< Current byte is received
+        static inline bool _headerDone = false; ///< Address and register are sent
+        static inline uint8_t _shift = 0; ///< Current byte shift register
+        static inline uint8_t _bit = 0; ///< Current bit (8 - acknowledge)
+        static inline uint16_t _stretch = 0; ///< Clock stretching ticks
+        static inline I2cStatus _status = I2cStatus::Success; ///< Transfer status
+        static inline volatile bool _busy = false; ///< Transfer is in progress
+    };
+}
+
+#include "impl/soft_i2c.h"
+
+#endif //! ZHELE_SOFT_I2C_H
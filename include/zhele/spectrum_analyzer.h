@@ -0,0 +1,127 @@
+/**
+ * @file
+ * Implements spectrum analysis of ADC stream
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SPECTRUM_ANALYZER_H
+#define ZHELE_SPECTRUM_ANALYZER_H
+
+#include <zhele/adc.h>
+#include <zhele/deferred.h>
+#include <zhele/delay.h>
+#include <zhele/fft.h>
+#include <zhele/placement.h>
+
+#include <span>
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements spectrum analysis of ADC regular stream
+     *
+     * @details
+     * Analyzer owns stream buffer (two blocks of _Size samples). ADC DMA callback (@ref BlockReady) only
+     * posts filled block to PendSV (see @ref Deferred), so block is transformed while the other one is filling and
+     * DMA interrupt latency stays short. Processing removes DC offset, converts samples, applies window and
+     * transforms block (see Dsp::RealFft). If DMA has completed the next block before processing ends,
+     * block could be overwritten: spectrum is dropped and counted.
+     * Processing time (core cycles) of the last block is measured by CycleCounter.
+     *
+     * @par Example
+     * @code
+     *  using Analyzer = SpectrumAnalyzer<Adc1, int16_t, 256>;
+     *  Deferred::Init();
+     *  Analyzer::Init([](std::span<const Dsp::Complex<int16_t>> spectrum) { auto peak = Analyzer::Fft::FindPeak(spectrum); });
+     *  Adc1::StartRegularStream({0}, Analyzer::Buffer(), Analyzer::BlockSize, Analyzer::BlockReady);
+     * @endcode
+     *
+     * @tparam _Adc ADC
+     * @tparam _Sample Transform type (int16_t for Q15, float for parts with FPU)
+     * @tparam _Size Block (transform) size
+     * @tparam _Window Window function
+     * @tparam _Placement Stream buffer placement (must be accessible by DMA)
+     */
+    template<typename _Adc, typename _Sample, size_t _Size, Dsp::Window _Window = Dsp::Window::Hann, typename _Placement = Placement::Default>
+    class SpectrumAnalyzer
+    {
+        static_assert(_Placement::DmaAccessible, "ADC stream buffer must be accessible by DMA");
+        static_assert(_Size <= UINT16_MAX, "Block size is too large for ADC stream");
+    public:
+        /// Transform
+        using Fft = Dsp::RealFft<_Sample, _Size>;
+
+        /// Spectrum callback (called in PendSV handler)
+        using SpectrumCallbackType = std::add_pointer_t<void(std::span<const typename Fft::ComplexType> spectrum)>;
+
+        /// Stream block size
+        static constexpr uint16_t BlockSize = _Size;
+
+        /**
+         * @brief Init analyzer
+         *
+         * @param [in] callback Spectrum callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(SpectrumCallbackType callback);
+
+        /**
+         * @brief Returns stream buffer (2 * BlockSize samples)
+         *
+         * @returns Buffer
+         */
+        static uint16_t* Buffer();
+
+        /**
+         * @brief ADC stream callback (pass it to StartRegularStream)
+         *
+         * @param [in] data Filled block
+         * @param [in] count Block size
+         * @param [in] overruns Stream overruns
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void BlockReady(uint16_t* data, uint32_t count, uint32_t overruns);
+
+        /**
+         * @brief Returns processing time of the last block
+         *
+         * @returns Core cycles count
+         */
+        static uint32_t LastCycles();
+
+        /**
+         * @brief Returns count of dropped blocks (processing has not finished in time, full work queue is counted by Deferred::Dropped)
+         *
+         * @returns Dropped blocks count
+         */
+        static uint32_t Dropped();
+
+    private:
+        template<auto, typename>
+        friend struct Private::DeferredCall;
+
+        static void Process(uint16_t* data, uint32_t sequence);
+
+        static constexpr auto& _buffer = PlacedStorage<_Placement, uint16_t[2 * _Size], SpectrumAnalyzer>::Value;
+        static constexpr std::array<_Sample, _Size> _window = Dsp::MakeWindow<_Sample, _Size>(_Window);
+
+        static inline typename Fft::ComplexType _spectrum[Fft::Bins];
+        static inline SpectrumCallbackType _callback = nullptr;
+        static inline volatile uint32_t _received = 0;
+        static inline volatile uint32_t _dropped = 0;
+        static inline volatile uint32_t _lastCycles = 0;
+    };
+}
+
+#include "impl/spectrum_analyzer.h"
+
+#endif //! ZHELE_SPECTRUM_ANALYZER_H
@@ -0,0 +1,274 @@
+/**
+ * @file
+ * Implements shared SPI bus with per-device configuration
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SPI_BUS_H
+#define ZHELE_SPI_BUS_H
+
+#include <zhele/containers/ring_buffer.h>
+#include <zhele/spi.h>
+
+#include <stddef.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief SPI device configuration
+     * 
+     * @tparam _Divider Clock divider
+     * @tparam _Polarity Clock polarity (CPOL)
+     * @tparam _Phase Clock phase (CPHA)
+     * @tparam _BitOrder Bit order
+     * @tparam _DataSize Data size
+     */
+    template<Private::SpiBase::ClockDivider _Divider,
+        Private::SpiBase::ClockPolarity _Polarity = Private::SpiBase::ClockPolarityLow,
+        Private::SpiBase::ClockPhase _Phase = Private::SpiBase::ClockPhaseLeadingEdge,
+        Private::SpiBase::BitOrder _BitOrder = Private::SpiBase::MsbFirst,
+        Private::SpiBase::DataSize _DataSize = Private::SpiBase::DataSize8>
+    struct SpiConfig
+    {
+        static constexpr Private::SpiBase::ClockDivider Divider = _Divider;
+        static constexpr Private::SpiBase::ClockPolarity Polarity = _Polarity;
+        static constexpr Private::SpiBase::ClockPhase Phase = _Phase;
+        static constexpr Private::SpiBase::BitOrder Order = _BitOrder;
+        static constexpr Private::SpiBase::DataSize Size = _DataSize;
+
+        /// Unique configuration key (CR1 bits and data size)
+        static constexpr uint32_t Key = static_cast<uint32_t>(_Divider) | _Polarity | _Phase | _BitOrder
+            | (static_cast<uint32_t>(_DataSize) << 16);
+    };
+
+    /**
+     * @brief SPI bus transaction (one item of bus queue)
+     */
+    struct SpiTransaction
+    {
+        uint32_t configKey; ///< Device configuration key
+        std::add_pointer_t<void()> select; ///< Select device (CS low)
+        std::add_pointer_t<void()> release; ///< Release device (CS high)
+        void* transmitBuffer; ///< Data to transmit
+        void* receiveBuffer; ///< Output buffer
+        size_t size; ///< Data size
+        TransferCallback callback; ///< Transaction complete callback (may be nullptr)
+    };
+
+    /**
+     * @brief Implements shared SPI bus
+     * 
+     * @details
+     * Bus tracks active configuration and reprograms SPI only when device
+     * with other configuration takes the bus. Async transactions of all devices
+     * are queued and started one by one from DMA RX transfer complete handler.
+     * 
+     * @note Bus owns DMA RX transfer callback. DMA RX IRQ handler should call Spi::DmaRx::IrqHandler as usual.
+     * 
+     * @tparam _Spi SPI
+     * @tparam _Depth Transactions queue depth
+     */
+    template<typename _Spi, unsigned _Depth = 8>
+    class SpiBus
+    {
+        static Containers::RingBuffer<_Depth, SpiTransaction> _queue;
+        static SpiTransaction _active;
+        static volatile bool _busy;
+        static uint32_t _configKey;
+    public:
+        using Spi = _Spi;
+        static constexpr unsigned Depth = _Depth;
+
+        /**
+         * @brief Init SPI bus (master mode)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Apply configuration if it differs from active one
+         * 
+         * @tparam _Config Configuration (SpiConfig)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        template<typename _Config>
+        static void Configure();
+
+        /**
+         * @brief Apply configuration by key if it differs from active one
+         * 
+         * @param [in] configKey Configuration key (SpiConfig::Key)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Configure(uint32_t configKey);
+
+        /**
+         * @brief Forget active configuration (call it if SPI was reconfigured bypassing bus)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Invalidate();
+
+        /**
+         * @brief Add transaction to queue (or start it immediately if bus is idle)
+         * 
+         * @param [in] transaction Transaction
+         * 
+         * @retval true Transaction was started or queued
+         * @retval false Queue is full
+         */
+        static bool Enqueue(const SpiTransaction& transaction);
+
+        /**
+         * @brief Check that bus has active transaction
+         * 
+         * @retval true Bus is busy
+         * @retval false Bus is idle
+         */
+        static bool Busy();
+
+        /**
+         * @brief Wait for all queued transactions
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Wait();
+
+        /**
+         * @brief Returns count of transactions waiting for bus
+         * 
+         * @returns Pending transactions count
+         */
+        static unsigned Pending();
+
+    private:
+        /**
+         * @brief Start transaction
+         * 
+         * @param [in] transaction Transaction
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Start(const SpiTransaction& transaction);
+
+        /**
+         * @brief DMA RX transfer callback. Releases device, starts next transaction and notify user.
+         * 
+         * @param [in] data Received data
+         * @param [in] size Data size
+         * @param [in] success Transfer result
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void TransferHandler(void* data, unsigned size, bool success);
+    };
+
+    /**
+     * @brief Implements device on shared SPI bus
+     * 
+     * @tparam _Bus SPI bus (SpiBus)
+     * @tparam _CsPin Chip select pin (active low)
+     * @tparam _Config Device configuration (SpiConfig)
+     */
+    template<typename _Bus, typename _CsPin, typename _Config>
+    class SpiDevice
+    {
+    public:
+        using Bus = _Bus;
+        using Config = _Config;
+
+        /**
+         * @brief Init CS pin (device is released)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Select device: wait for queued transactions, apply configuration and set CS low
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Select();
+
+        /**
+         * @brief Release device (CS high)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Release();
+
+        /**
+         * @brief Send and receive one frame (device should be selected)
+         * 
+         * @param [in] value Data to send
+         * 
+         * @returns Received value
+         */
+        static uint16_t Send(uint16_t value);
+
+        /**
+         * @brief Blocking transaction: select, transfer and release
+         * 
+         * @param [in] transmitBuffer Data to transmit (nullptr to send 0xff)
+         * @param [out] receiveBuffer Output buffer (nullptr to ignore received data)
+         * @param [in] size Data size
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Transfer(const void* transmitBuffer, void* receiveBuffer, size_t size);
+
+        /**
+         * @brief Queue async (DMA) transaction
+         * 
+         * @param [in] transmitBuffer Data to transmit
+         * @param [out] receiveBuffer Output buffer (may be the same as transmit buffer)
+         * @param [in] size Data size
+         * @param [in] callback Transaction complete callback (optional parameter)
+         * 
+         * @retval true Transaction was started or queued
+         * @retval false Bus queue is full
+         */
+        static bool TransferAsync(void* transmitBuffer, void* receiveBuffer, size_t size, TransferCallback callback = nullptr);
+
+    private:
+        /**
+         * @brief Apply configuration and set CS low (without waiting for bus)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Activate();
+    };
+
+    template<typename _Spi, unsigned _Depth>
+    Containers::RingBuffer<_Depth, SpiTransaction> SpiBus<_Spi, _Depth>::_queue;
+    template<typename _Spi, unsigned _Depth>
+    SpiTransaction SpiBus<_Spi, _Depth>::_active;
+    template<typename _Spi, unsigned _Depth>
+    volatile bool SpiBus<_Spi, _Depth>::_busy = false;
+    template<typename _Spi, unsigned _Depth>
+    uint32_t SpiBus<_Spi, _Depth>::_configKey = 0xffffffff;
+}
+
+#include "impl/spi_bus.h"
+
+#endif //! ZHELE_SPI_BUS_H
@@ -0,0 +1,338 @@
+/**
+ * @file
+ * Implements multi-node time synchronization
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIME_SYNC_H
+#define ZHELE_TIME_SYNC_H
+
+#include <stdint.h>
+
+namespace Zhele
+{
+#pragma pack(push, 1)
+    /**
+     * @brief Time synchronization message
+     */
+    struct TimeSyncMessage
+    {
+        /**
+         * @brief Message type
+         */
+        enum class Type : uint8_t
+        {
+            Beacon, ///< Root beacon, Time is global transmit time of previous beacon
+            DelayRequest, ///< Link delay request (node to root)
+            DelayResponse, ///< Link delay response, Time is request receive time
+            FollowUp, ///< Link delay response follow up, Time is response transmit time
+        };
+
+        Type Kind; ///< Message type
+        uint8_t Node; ///< Root node (beacon) or requesting node (delay messages)
+        uint16_t Sequence; ///< Sequence number
+        uint64_t Time; ///< Global time in ticks
+
+        static const uint64_t InvalidTime = ~static_cast<uint64_t>(0); ///< Time is unknown
+    };
+#pragma pack(pop)
+
+    /**
+     * @brief Implements time synchronization of nodes by root beacons (FTSP-like)
+     *
+     * @details
+     * Root node clock is global clock. Root periodically sends beacons, each beacon carries global
+     * transmit time of previous beacon (two-step scheme: transmit time is known after transmission only).
+     * Node pairs it with local receive time of previous beacon and estimates offset and skew
+     * of local clock by linear regression over last @p _Entries pairs, so global time is extrapolated
+     * between beacons with skew correction.
+     *
+     * Propagation and stack latency is measured by delay request: t1 (node request transmit),
+     * t2 (root request receive), t3 (root response transmit), t4 (node response receive),
+     * delay is ((t4 - t1) - (t3 - t2)) / 2. So constant difference between transmit and receive
+     * event latencies is compensated too (if it's the same for both nodes).
+     *
+     * Messages are transported by application (for example, by @ref Drivers::Nrf24l or @ref Drivers::Adm485).
+     * Transport must timestamp transmit and receive events as close to hardware as possible:
+     * call @ref TxEvent when message is transmitted and @ref RxEvent when message is received
+     * (before @ref Received for the message). Every sent message must be produced by MakeBeacon,
+     * MakeDelayRequest or NextMessage and must be transmitted before next message is produced.
+     *
+     * Event methods may be called from interrupts. @ref Received uses time of last receive event,
+     * so it should be called before next packet is received (for example, from packet handler).
+     * Conversion methods are safe to call from interrupts: regression result is double buffered.
+     *
+     * @par Example
+     * @code
+     *  using Clock = Timers::Timestamp<Timers::Timer2>;
+     *  using Sync = TimeSync<Clock>;
+     *  Sync::Init(nodeId, nodeId == 0);
+     *  // Nrf24l: events are timestamped at IRQ pin edge
+     *  Radio::SetEventTimestamp(Clock::Now, [](bool transmitted, uint64_t time) {
+     *      transmitted ? Sync::TxEvent(time) : Sync::RxEvent(time);
+     *  });
+     *  // Adm485: transmit complete callback is called from TC interrupt,
+     *  // receive event is last byte RXNE interrupt
+     *  Rs485::WriteAsync(&message, sizeof(message), [] { Sync::TxEvent(Clock::Now()); });
+     *  ...
+     *  Sync::Received(message);
+     *  uint64_t now = Sync::GlobalTime();
+     * @endcode
+     *
+     * @tparam _Clock Local clock (with static uint64_t Now() method)
+     * @tparam _Entries Regression table size
+     * @tparam _MaxError Max difference (in ticks) between prediction and new pair (table is cleared if it's exceeded)
+     */
+    template<typename _Clock, unsigned _Entries = 8, uint32_t _MaxError = 1000>
+    class TimeSync
+    {
+        static_assert(_Entries >= 2, "Regression requires at least two entries");
+
+        static const uint8_t NoNode = 0xff;
+        static const unsigned MinEntries = _Entries < 3 ? _Entries : 3; ///< Min entries count for synchronized state
+        static const unsigned DelayFilterShift = 2; ///< Link delay exponential filter factor (1 / 4)
+    public:
+        using Message = TimeSyncMessage;
+
+        /**
+         * @brief Inits synchronization
+         *
+         * @param [in] node Node identifier (0 to 254)
+         * @param [in] root Node is root (global time source)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint8_t node, bool root);
+
+        /**
+         * @brief Checks node is root
+         *
+         * @retval true Node is root
+         * @retval false Node is not root
+         */
+        static bool IsRoot();
+
+        /**
+         * @brief Checks node is synchronized
+         *
+         * @retval true Node is root or regression table has enough entries
+         * @retval false Node is not synchronized
+         */
+        static bool IsSynchronized();
+
+        /**
+         * @brief Returns current global time
+         *
+         * @returns Global time in ticks
+         */
+        static uint64_t GlobalTime();
+
+        /**
+         * @brief Converts local time to global time
+         *
+         * @param [in] local Local time
+         *
+         * @returns Global time
+         */
+        static uint64_t ToGlobal(uint64_t local);
+
+        /**
+         * @brief Converts global time to local time (for example, to schedule synchronized action)
+         *
+         * @param [in] global Global time
+         *
+         * @returns Local time
+         */
+        static uint64_t ToLocal(uint64_t global);
+
+        /**
+         * @brief Returns estimated local clock skew
+         *
+         * @returns Relative rate difference (global rate / local rate - 1)
+         */
+        static float Skew();
+
+        /**
+         * @brief Returns link delay
+         *
+         * @returns Delay from root transmit event to node receive event (in ticks)
+         */
+        static int32_t LinkDelay();
+
+        /**
+         * @brief Sets link delay (if it's known and not measured)
+         *
+         * @param [in] delay Link delay in ticks
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetLinkDelay(int32_t delay);
+
+        /**
+         * @brief Makes beacon (root only)
+         *
+         * @param [out] message Message
+         *
+         * @retval true Message is made
+         * @retval false Node is not root
+         */
+        static bool MakeBeacon(Message& message);
+
+        /**
+         * @brief Makes delay request (non-root only)
+         *
+         * @param [out] message Message
+         *
+         * @retval true Message is made
+         * @retval false Node is root or root is unknown (no beacons received)
+         */
+        static bool MakeDelayRequest(Message& message);
+
+        /**
+         * @brief Returns pending message (delay response or follow up on root)
+         *
+         * @param [out] message Message
+         *
+         * @retval true Message is pending
+         * @retval false No pending messages
+         */
+        static bool NextMessage(Message& message);
+
+        /**
+         * @brief Handles transmit event of last produced message
+         *
+         * @param [in] time Local time of event
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void TxEvent(uint64_t time);
+
+        /**
+         * @brief Handles receive event
+         *
+         * @param [in] time Local time of event
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void RxEvent(uint64_t time);
+
+        /**
+         * @brief Handles received message (receive event must be handled before)
+         *
+         * @param [in] message Message
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Received(const Message& message);
+
+        /**
+         * @brief Handles received packet
+         *
+         * @param [in] data Packet data
+         * @param [in] size Packet size
+         *
+         * @retval true Packet is synchronization message
+         * @retval false Packet size mismatch
+         */
+        static bool Received(const void* data, unsigned size);
+
+    private:
+        /**
+         * @brief Delay measurement state
+         */
+        enum class DelayState : uint8_t
+        {
+            Idle, ///< No request
+            Requesting, ///< Request is made, waiting for transmit event
+            Requested, ///< Request is sent, waiting for response
+            Responded, ///< Response is received, waiting for follow up
+        };
+
+        /**
+         * @brief Regression result (offset is linear function of local time)
+         */
+        struct Regression
+        {
+            uint64_t LocalAverage; ///< Regression center (local time)
+            int64_t OffsetAverage; ///< Offset (global - local) in regression center
+            float Skew; ///< Offset slope
+        };
+
+        /**
+         * @brief Returns consistent copy of current regression
+         *
+         * @returns Regression
+         */
+        static Regression CurrentRegression();
+
+        /**
+         * @brief Adds pair to regression table and recalculates regression
+         *
+         * @param [in] local Local time
+         * @param [in] global Global time
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void AddEntry(uint64_t local, uint64_t global);
+
+        /**
+         * @brief Calculates offset (global - local) by regression
+         *
+         * @param [in] regression Regression
+         * @param [in] local Local time
+         *
+         * @returns Offset
+         */
+        static int64_t Offset(const Regression& regression, uint64_t local);
+
+        static void HandleBeacon(const Message& message);
+        static void HandleDelayRequest(const Message& message);
+        static void HandleDelayResponse(const Message& message);
+        static void HandleFollowUp(const Message& message);
+
+        static inline uint8_t _node = NoNode; ///< This node
+        static inline uint8_t _rootNode = NoNode; ///< Root node
+        static inline bool _root = false; ///< This node is root
+
+        static inline uint16_t _sequence = 0; ///< Last beacon (root) or delay request (node) sequence
+        static inline volatile bool _txPending = false; ///< Produced message waits for transmit event
+        static inline Message::Type _txKind = Message::Type::Beacon; ///< Produced message type
+        static inline volatile uint64_t _rxTime = 0; ///< Last receive event time
+
+        // Root state
+        static inline uint64_t _lastBeaconTime = Message::InvalidTime; ///< Global transmit time of last beacon
+        static inline Message _pending = {}; ///< Pending response
+        static inline volatile bool _pendingValid = false; ///< Response is pending
+
+        // Node state
+        static inline uint16_t _lastBeaconSequence = 0; ///< Sequence of last received beacon
+        static inline uint64_t _lastBeaconRxTime = Message::InvalidTime; ///< Local receive time of last beacon
+        static inline DelayState _delayState = DelayState::Idle; ///< Delay measurement state
+        static inline uint64_t _t1 = 0; ///< Request transmit time (local)
+        static inline uint64_t _t2 = 0; ///< Request receive time (global)
+        static inline uint64_t _t4 = 0; ///< Response receive time (local)
+        static inline int32_t _delay = 0; ///< Link delay
+        static inline bool _delayValid = false; ///< Link delay is measured
+
+        // Regression table and result
+        static inline uint64_t _locals[_Entries] = {}; ///< Local times
+        static inline int64_t _offsets[_Entries] = {}; ///< Offsets (global - local)
+        static inline unsigned _count = 0; ///< Entries count
+        static inline unsigned _next = 0; ///< Next entry index
+        static inline Regression _regression[2] = {}; ///< Current and next regression
+        static inline volatile unsigned _version = 0; ///< Regression version (its low bit is current buffer)
+    };
+}
+
+#include "impl/time_sync.h"
+
+#endif //! ZHELE_TIME_SYNC_H
@@ -0,0 +1,112 @@
+/**
+ * @file
+ * Implements timers chaining (master/slave)
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIMER_CHAIN_H
+#define ZHELE_TIMER_CHAIN_H
+
+#include <zhele/timer.h>
+
+namespace Zhele::Timers
+{
+    /**
+     * @brief Implements master/slave timers connection
+     * 
+     * @details
+     * Resolves slave internal trigger (ITRx) connected to master TRGO for current family
+     * (compile error if timers are not connected) and configures master output and slave mode.
+     * 
+     * @par Example
+     * @code
+     *  // Timer3 is clocked by Timer2 updates (32-bit counter)
+     *  using Chain = Timers::TimerChain<Timers::Timer2, Timers::Timer3>;
+     *  Chain::EnableExternalClock();
+     *  // Timer4 starts with Timer2 (phase-locked PWM)
+     *  Timers::TimerChain<Timers::Timer2, Timers::Timer4>::EnableTriggerMode();
+     * @endcode
+     * 
+     * @tparam _Master Master timer
+     * @tparam _Slave Slave timer
+     */
+    template<typename _Master, typename _Slave>
+    class TimerChain
+    {
+        static const int TriggerNumber = Private::TimerInternalTrigger<_Master, _Slave>::Value;
+        static_assert(TriggerNumber >= 0, "Slave timer has no internal trigger connected to master timer");
+
+        using SlaveMode = typename _Slave::SlaveMode;
+        using MasterMode = typename _Master::MasterMode;
+    public:
+        /// Slave internal trigger connected to master
+        static constexpr typename SlaveMode::Trigger Trigger = static_cast<typename SlaveMode::Trigger>(TriggerNumber << TIM_SMCR_TS_Pos);
+
+        /**
+         * @brief Connect timers
+         * 
+         * @param [in] masterMode Master TRGO source
+         * @param [in] slaveMode Slave mode
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Connect(MasterMode masterMode, typename SlaveMode::Mode slaveMode);
+
+        /**
+         * @brief Slave counts master update events (external clock mode 1)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void EnableExternalClock();
+
+        /**
+         * @brief Slave counts while master TRGO is high (gated mode)
+         * 
+         * @param [in] masterMode Master TRGO source (counter enable or OCxREF)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void EnableGatedMode(MasterMode masterMode = MasterMode::Enable);
+
+        /**
+         * @brief Slave counter is reset by master TRGO (reset mode)
+         * 
+         * @param [in] masterMode Master TRGO source
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void EnableResetMode(MasterMode masterMode = MasterMode::Update);
+
+        /**
+         * @brief Slave counter starts by master TRGO (trigger mode)
+         * 
+         * @details
+         * With default master mode slave starts with master, so timers run synchronously.
+         * 
+         * @param [in] masterMode Master TRGO source
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void EnableTriggerMode(MasterMode masterMode = MasterMode::Enable);
+
+        /**
+         * @brief Disconnect timers (disable slave mode)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Disconnect();
+    };
+}
+
+#include "impl/timer_chain.h"
+
+#endif //! ZHELE_TIMER_CHAIN_H
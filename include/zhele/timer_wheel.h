@@ -0,0 +1,161 @@
+/**
+ * @file
+ * Implements software timers on one hardware timer
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIMER_WHEEL_H
+#define ZHELE_TIMER_WHEEL_H
+
+#include <zhele/timer.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Timers
+{
+    /**
+     * @brief Implements software timers (hashed timer wheel) on one timer compare channel
+     * 
+     * @details
+     * Timer counts freely, compare register is programmed to the next occupied wheel slot,
+     * so there are no interrupts without deadlines (tickless), except one per wheel revolution
+     * to keep time base. Task start and stop are O(1), next slot search is O(_Slots / 32).
+     * Task callbacks are called from timer interrupt.
+     * Wheel on low-power timer (@ref LpTimer) keeps running in Stop mode and its interrupts wake MCU up,
+     * so tasks are scheduled across Stop mode (set timer as @ref SystemTime stop time source to keep system time too).
+     * 
+     * @par Example
+     * @code
+     *  using Wheel = Timers::TimerWheel<Timers::Timer2, 0, 256>;
+     *  Wheel::Task blink(Toggle);
+     *  Wheel::Init(7199); // 10 kHz ticks for 72 MHz timer clock
+     *  Wheel::Start(blink, 5000, 5000);
+     *  extern "C" void TIM2_IRQHandler() { Wheel::IrqHandler(); }
+     * @endcode
+     * 
+     * @tparam _Timer GP timer or low-power timer
+     * @tparam _Channel Compare channel
+     * @tparam _Slots Wheel slots count (power of two), maximal interval between interrupts
+     */
+    template<typename _Timer, unsigned _Channel = 0, unsigned _Slots = 64>
+    class TimerWheel
+    {
+        static_assert((_Slots & (_Slots - 1)) == 0, "Slots count must be power of two");
+        static_assert(_Slots >= 2 && _Slots <= 0x8000, "Slots count must be in range [2, 32768]");
+
+        using Channel = typename _Timer::template OutputCompare<_Channel>;
+        using Counter = typename _Timer::Counter;
+
+        static const unsigned SlotMask = _Slots - 1;
+        static const unsigned BitmapWords = (_Slots + 31) / 32;
+    public:
+        /// Task callback type
+        using Callback = std::add_pointer_t<void()>;
+
+        /**
+         * @brief Software timer task
+         * 
+         * @details
+         * Task object must live while task is active (it's linked into wheel).
+         */
+        class Task
+        {
+            friend class TimerWheel;
+        public:
+            /**
+             * @brief Constructor
+             * 
+             * @param [in] callback Task callback
+             */
+            Task(Callback callback)
+                : _callback(callback)
+            {}
+
+            /**
+             * @brief Check that task is started
+             * 
+             * @retval true Task is active
+             * @retval false Task is stopped or expired (for one-shot task)
+             */
+            bool IsActive() const
+            {
+                return _active;
+            }
+
+        private:
+            Callback _callback;
+            uint32_t _deadline = 0;
+            uint32_t _period = 0;
+            Task* _next = nullptr;
+            Task* _prev = nullptr;
+            volatile bool _active = false;
+        };
+
+        /**
+         * @brief Init and start timer
+         * 
+         * @param [in] prescaler Timer prescaler (tick is prescaler + 1 timer clocks for GP timer, power of two for LPTIM)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(typename _Timer::Prescaler prescaler);
+
+        /**
+         * @brief Start (or restart) task
+         * 
+         * @param [in] task Task
+         * @param [in] delay Delay (in ticks, at least 1)
+         * @param [in] period Repeat period (in ticks), zero for one-shot task
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Start(Task& task, uint32_t delay, uint32_t period = 0);
+
+        /**
+         * @brief Stop task
+         * 
+         * @param [in] task Task
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop(Task& task);
+
+        /**
+         * @brief Returns current time
+         * 
+         * @returns Ticks count since Init
+         */
+        static uint32_t Now();
+
+        /**
+         * @brief Timer compare interrupt handler
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static uint32_t Elapsed();
+        static void Link(Task& task);
+        static void Unlink(Task& task);
+        static void Expire(uint32_t time);
+        static unsigned NextSlotDistance();
+        static void Schedule();
+
+        static Task* _slots[_Slots];
+        static uint32_t _occupied[BitmapWords];
+        static volatile uint32_t _now;
+    };
+}
+
+#include "impl/timer_wheel.h"
+
+#endif //! ZHELE_TIMER_WHEEL_H
@@ -0,0 +1,113 @@
+/**
+ * @file
+ * Implements extended timestamp counters
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIMESTAMP_H
+#define ZHELE_TIMESTAMP_H
+
+#include <zhele/timer_chain.h>
+
+#include <stdint.h>
+
+namespace Zhele::Timers
+{
+    /**
+     * @brief Implements 64-bit timestamp: timer counter extended by update interrupt
+     * 
+     * @details
+     * Call IrqHandler from timer IRQ handler. Now() is lock-free and consistent:
+     * it retries if overflow was handled during read and accounts pending (not handled yet) overflow,
+     * so it can be used with interrupts disabled and from interrupts with priority not higher than timer IRQ.
+     * 
+     * @par Example
+     * @code
+     *  using Clock = Timers::Timestamp<Timers::Timer2>;
+     *  Clock::Init(71); // 1 MHz ticks for 72 MHz timer clock
+     *  extern "C" void TIM2_IRQHandler() { Clock::IrqHandler(); }
+     *  uint64_t now = Clock::Now();
+     * @endcode
+     * 
+     * @tparam _Timer Timer
+     */
+    template<typename _Timer>
+    class Timestamp
+    {
+        static const unsigned CounterBits = sizeof(typename _Timer::Counter) * 8;
+    public:
+        /**
+         * @brief Init and start timer
+         * 
+         * @param [in] prescaler Timer prescaler (tick is prescaler + 1 timer clocks)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(typename _Timer::Prescaler prescaler);
+
+        /**
+         * @brief Returns current timestamp
+         * 
+         * @returns Ticks count since Init
+         */
+        static uint64_t Now();
+
+        /**
+         * @brief Timer update interrupt handler
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static volatile uint32_t _overflows;
+    };
+
+    /**
+     * @brief Implements 32-bit timestamp by two cascaded timers (without interrupts)
+     * 
+     * @details
+     * Master update event (TRGO) clocks slave timer, so slave counts master overflows.
+     * 
+     * @par Example
+     * @code
+     *  using Clock = Timers::CascadedTimestamp<Timers::Timer2, Timers::Timer3>;
+     *  Clock::Init(71);
+     * @endcode
+     * 
+     * @tparam _Master Master timer (low half)
+     * @tparam _Slave Slave timer (high half)
+     */
+    template<typename _Master, typename _Slave>
+    class CascadedTimestamp
+    {
+        static const unsigned CounterBits = sizeof(typename _Master::Counter) * 8;
+        static_assert(CounterBits == 16, "Cascaded timestamp is implemented for 16-bit timers");
+    public:
+        /**
+         * @brief Init and start timers
+         * 
+         * @param [in] prescaler Master timer prescaler (tick is prescaler + 1 timer clocks)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(typename _Master::Prescaler prescaler);
+
+        /**
+         * @brief Returns current timestamp
+         * 
+         * @returns Ticks count since Init
+         */
+        static uint32_t Now();
+    };
+}
+
+#include "impl/timestamp.h"
+
+#endif //! ZHELE_TIMESTAMP_H
@@ -0,0 +1,223 @@
+/**
+ * @file
+ * Implements capacitive touch keys over touch sensing controller
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TOUCH_KEYS_H
+#define ZHELE_TOUCH_KEYS_H
+
+#if defined(STM32F0)
+    #include <stm32f0xx.h>
+#endif
+#if defined(STM32F1)
+    #include <stm32f1xx.h>
+#endif
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+#if defined(STM32L4)
+    #include <stm32l4xx.h>
+#endif
+#if defined(STM32G0)
+    #include <stm32g0xx.h>
+#endif
+
+#include <array>
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements capacitive touch keys with baseline tracking
+     *
+     * @details
+     * Keys are scanned in banks: every bank contains at most one key of each TSC group, so all keys
+     * of bank are acquired in parallel by one hardware acquisition. @ref Scan starts acquisition of next bank
+     * (call it periodically, period is discharge pause), end of acquisition interrupt updates keys of bank.
+     * CPU time is spent in short interrupt handler only.
+     *
+     * Every key has integer filters (fixed point with 4 fractional bits):
+     * raw count is smoothed by exponential filter (1 / 4), baseline is filtered count
+     * of released key: it's calibrated by first samples average, it follows slow drift (1 / 64)
+     * and fast follows count rise (1 / 4), baseline is frozen while key is touched.
+     * Delta is baseline minus filtered count (touch decreases count). Key is touched when delta
+     * reaches @p _Threshold and released when it falls below 3/4 of threshold,
+     * both changes are debounced (two samples).
+     *
+     * @par Example
+     * @code
+     *  using Keys = TouchKeys<Tsc, 40, IO::Pa0, IO::Pa1, IO::Pa4, IO::Pa5>;
+     *  Tsc::Init();
+     *  Tsc::SelectSamplingPins<IO::Pa3, IO::Pa7>();
+     *  Keys::Init([](unsigned key, bool touched) { ... });
+     *  extern "C" void TSC_IRQHandler() { Keys::IrqHandler(); }
+     *  extern "C" void SysTick_Handler() { Keys::Scan(); }
+     * @endcode
+     *
+     * @tparam _Tsc Touch sensing controller
+     * @tparam _Threshold Touch threshold (counts)
+     * @tparam _Keys Key (channel) pins
+     */
+    template<typename _Tsc, uint16_t _Threshold, typename... _Keys>
+    class TouchKeys
+    {
+        static const unsigned FractionBits = 4; ///< Fixed point fractional bits
+        static const unsigned FilterShift = 2; ///< Count filter factor (1 / 4)
+        static const unsigned BaselineShift = 6; ///< Baseline drift tracking factor (1 / 64)
+        static const unsigned RecoveryShift = 2; ///< Baseline tracking factor for count above baseline (1 / 4)
+        static const uint8_t CalibrationSamples = 8; ///< Baseline calibration samples count
+        static const uint8_t DebounceSamples = 2; ///< Samples count for state change
+        static const int32_t ReleaseThreshold = _Threshold - _Threshold / 4; ///< Release threshold (hysteresis)
+
+    public:
+        /// Keys count
+        static const unsigned KeysCount = sizeof...(_Keys);
+        static_assert(KeysCount > 0 && KeysCount <= 32, "From 1 to 32 keys are supported");
+
+        /// Key state change callback (called from TSC interrupt)
+        using ChangeCallback = std::add_pointer_t<void(unsigned key, bool touched)>;
+
+        /**
+         * @brief Configures key pins, enables TSC interrupt and starts calibration
+         *
+         * @details
+         * TSC must be initialized and sampling pins must be selected before.
+         *
+         * @param [in] callback Key state change callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(ChangeCallback callback = nullptr);
+
+        /**
+         * @brief Starts acquisition of next bank
+         *
+         * @retval true Acquisition is started
+         * @retval false Previous acquisition is in progress
+         */
+        static bool Scan();
+
+        /**
+         * @brief TSC interrupt handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+        /**
+         * @brief Restarts baseline calibration (keys must not be touched)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Recalibrate();
+
+        /**
+         * @brief Checks all keys are calibrated
+         *
+         * @retval true Baselines are calibrated
+         * @retval false Calibration is in progress
+         */
+        static bool IsCalibrated();
+
+        /**
+         * @brief Checks key is touched
+         *
+         * @param [in] key Key index
+         *
+         * @retval true Key is touched
+         * @retval false Key is released
+         */
+        static bool IsTouched(unsigned key);
+
+        /**
+         * @brief Returns touched keys
+         *
+         * @returns Touched keys mask (bit index is key index)
+         */
+        static uint32_t TouchedMask();
+
+        /**
+         * @brief Returns key delta (for threshold tuning)
+         *
+         * @param [in] key Key index
+         *
+         * @returns Baseline minus filtered count
+         */
+        static int16_t Delta(unsigned key);
+
+        /**
+         * @brief Returns key baseline
+         *
+         * @param [in] key Key index
+         *
+         * @returns Baseline count
+         */
+        static uint16_t Baseline(unsigned key);
+
+        /**
+         * @brief Handles new key count
+         *
+         * @param [in] key Key index
+         * @param [in] count Acquisition result
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Update(unsigned key, uint16_t count);
+
+    private:
+        static constexpr uint8_t _groups[] = {static_cast<uint8_t>(_Tsc::template GroupOf<_Keys>)...}; ///< Key groups
+        static constexpr uint32_t _channels[] = {_Tsc::template IoMask<_Keys>...}; ///< Key IO masks
+
+        /// Key banks: key bank is count of previous keys in the same group
+        static constexpr auto _banks = [] {
+            std::array<uint8_t, KeysCount> banks{};
+            for (unsigned key = 0; key < KeysCount; ++key)
+            {
+                for (unsigned previous = 0; previous < key; ++previous)
+                {
+                    if (_groups[previous] == _groups[key])
+                        ++banks[key];
+                }
+            }
+            return banks;
+        }();
+
+        /// Banks count (max keys count in one group)
+        static constexpr unsigned BanksCount = [] {
+            unsigned count = 0;
+            for (auto bank : _banks)
+                count = bank + 1u > count ? bank + 1u : count;
+            return count;
+        }();
+
+        /// Bank channels masks
+        static constexpr auto _bankChannels = [] {
+            std::array<uint32_t, BanksCount> channels{};
+            for (unsigned key = 0; key < KeysCount; ++key)
+                channels[_banks[key]] |= _channels[key];
+            return channels;
+        }();
+
+        static inline int32_t _filtered[KeysCount] = {}; ///< Filtered counts
+        static inline int32_t _baseline[KeysCount] = {}; ///< Baselines (calibration sums while calibration)
+        static inline uint8_t _calibration[KeysCount] = {}; ///< Calibration samples count
+        static inline uint8_t _debounce[KeysCount] = {}; ///< State change samples count
+        static inline volatile uint32_t _touched = 0; ///< Touched keys
+        static inline uint8_t _bank = 0; ///< Current bank
+        static inline volatile bool _busy = false; ///< Acquisition is in progress
+        static inline ChangeCallback _callback = nullptr; ///< State change callback
+    };
+}
+
+#include "impl/touch_keys.h"
+
+#endif //! ZHELE_TOUCH_KEYS_H
@@ -0,0 +1,24 @@
+/**
+ * @file
+ * United header for touch sensing controller (TSC)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @licence FreeBSD
+ */
+
+#if defined(STM32F0)
+    #include "f0/tsc.h"
+#endif
+#if defined(STM32F1)
+    #error STM32F1 does not support TSC
+#endif
+#if defined(STM32F4)
+    #error STM32F4 does not support TSC
+#endif
+#if defined(STM32L4)
+    #include "l4/tsc.h"
+#endif
+#if defined(STM32G0)
+    #error STM32G0 does not support TSC
+#endif
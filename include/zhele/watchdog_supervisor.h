@@ -0,0 +1,161 @@
+/**
+ * @file
+ * Implements watchdog supervisor for multi-task liveness
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_WATCHDOG_SUPERVISOR_H
+#define ZHELE_WATCHDOG_SUPERVISOR_H
+
+#include <zhele/watchdog.h>
+
+#include "common/template_utils/type_list.h"
+
+#include <stdint.h>
+
+namespace Zhele::Timers
+{
+    /**
+     * @brief Implements watchdog supervisor: watchdog is refreshed only if all tasks are alive
+     *
+     * @details
+     * Every task (main loop stage, ISR, DMA pipeline callback) checks in by setting its bit in one word.
+     * @ref Service is called periodically (for example, from timer interrupt): if all bits are set
+     * since previous refresh, it refreshes watchdog and clears bits, otherwise watchdog is not refreshed
+     * and it resets MCU when any task stalls longer than watchdog period.
+     * Window watchdog (@ref WWdg) is refreshed only in its window, so too fast refreshes are caught too.
+     *
+     * On Cortex-M3/M4 check-in is single store to bit-band alias (bit mask must be in bit-band SRAM region),
+     * on other cores it's short critical section.
+     *
+     * @par Example
+     * @code
+     *  struct MainLoop;
+     *  struct AdcPipeline;
+     *  using Supervisor = Timers::WatchdogSupervisor<Timers::IWdg, MainLoop, AdcPipeline>;
+     *
+     *  Timers::IWdg::Start(100);
+     *  // Main loop
+     *  Supervisor::CheckIn<MainLoop>();
+     *  // ADC DMA callback
+     *  Supervisor::CheckIn<AdcPipeline>();
+     *  // Timer interrupt (period is less than watchdog period)
+     *  Supervisor::Service();
+     * @endcode
+     *
+     * @tparam _Watchdog Watchdog (IWdg or WWdg)
+     * @tparam _Tasks Supervised tasks (tag types)
+     */
+    template<typename _Watchdog, typename... _Tasks>
+    class WatchdogSupervisor
+    {
+        static_assert(sizeof...(_Tasks) > 0 && sizeof...(_Tasks) <= 32, "Supervisor supports from 1 to 32 tasks");
+
+        using TaskList = TemplateUtils::TypeList<_Tasks...>;
+
+        /// Mask of all tasks
+        static const uint32_t AllTasks = sizeof...(_Tasks) == 32 ? 0xffffffff : (1u << sizeof...(_Tasks)) - 1;
+
+        /// Watchdog has refresh window
+        static constexpr bool Windowed = requires { _Watchdog::IsRefreshAllowed(); };
+
+    public:
+        /**
+         * @brief Returns task bit
+         *
+         * @tparam _Task Task
+         *
+         * @returns Task bit mask
+         */
+        template<typename _Task>
+        static consteval uint32_t TaskMask()
+        {
+            constexpr int index = TaskList::template search<_Task>();
+            static_assert(index >= 0, "Task is not supervised");
+            return 1u << index;
+        }
+
+        /**
+         * @brief Marks task as alive
+         *
+         * @details
+         * It's safe to call it from any interrupt.
+         *
+         * @tparam _Task Task
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Task>
+        static void CheckIn()
+        {
+            constexpr int index = TaskList::template search<_Task>();
+            static_assert(index >= 0, "Task is not supervised");
+
+        #if defined (__CORTEX_M) && (__CORTEX_M >= 3) && defined (SRAM_BB_BASE) && !defined (ZHELE_HOST)
+            *reinterpret_cast<volatile uint32_t*>(SRAM_BB_BASE + ((reinterpret_cast<uint32_t>(&_checkIns) - SRAM_BASE) << 5) + (index << 2)) = 1;
+        #else
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _checkIns = _checkIns | TaskMask<_Task>();
+            __set_PRIMASK(primask);
+        #endif
+        }
+
+        /**
+         * @brief Refreshes watchdog if all tasks checked in
+         *
+         * @details
+         * For window watchdog method also waits (returns false) until counter is in window,
+         * so it should be called more often than window duration.
+         *
+         * @retval true Watchdog is refreshed, new supervision period is started
+         * @retval false Some tasks didn't check in (or window is not opened yet)
+         */
+        static bool Service()
+        {
+            if ((_checkIns & AllTasks) != AllTasks)
+                return false;
+
+            if constexpr (Windowed)
+            {
+                if (!_Watchdog::IsRefreshAllowed())
+                    return false;
+            }
+
+            // Check-in between read and clear belongs to next period, so bits are taken atomically
+        #if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+            while (__STREXW(__LDREXW(&_checkIns) & ~AllTasks, &_checkIns) != 0) continue;
+        #else
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _checkIns = _checkIns & ~AllTasks;
+            __set_PRIMASK(primask);
+        #endif
+
+            _Watchdog::Reset();
+            return true;
+        }
+
+        /**
+         * @brief Returns tasks that didn't check in during current period
+         *
+         * @details
+         * Use it for diagnostics (for example, from WWDG early wakeup interrupt before reset).
+         *
+         * @returns Mask of missing tasks (bit number is task index in supervisor)
+         */
+        static uint32_t Missing()
+        {
+            return ~_checkIns & AllTasks;
+        }
+
+    private:
+        static inline volatile uint32_t _checkIns = 0; ///< Checked in tasks mask
+    };
+} // namespace Zhele::Timers
+
+#endif //! ZHELE_WATCHDOG_SUPERVISOR_H
@@ -0,0 +1,104 @@
+/**
+ * @file
+ * Implements compile-time waveform tables
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_WAVEFORM_H
+#define ZHELE_WAVEFORM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Zhele::Waveform
+{
+    /// Max value of 12-bit DAC
+    static constexpr uint16_t DacMaxValue = 4095;
+
+    /**
+     * @brief Generates table by user function
+     * 
+     * @details
+     * Table is computed by compiler. Declare it as static constexpr to place it in flash:
+     * @code
+     *  static constexpr auto sine = Waveform::Sine<256>();
+     *  static constexpr auto pwm = Waveform::Generate<64, 999>([](double phase) { return phase * phase; });
+     *  DacStreamer<Dac1Channel1, Timers::Timer2, Dma1Stream5Channel7>::Play(sine.data(), sine.size());
+     * @endcode
+     * 
+     * @tparam _Size Samples count (one period)
+     * @tparam _MaxValue Value for 1.0 (DAC max value or timer period)
+     * @tparam _Function Function type
+     * 
+     * @param [in] function Function of phase [0, 1) returning value in [0, 1] (is clamped)
+     * 
+     * @returns Table
+     */
+    template<size_t _Size, uint16_t _MaxValue = DacMaxValue, typename _Function>
+    consteval std::array<uint16_t, _Size> Generate(_Function function);
+
+    /**
+     * @brief Generates sine table (one period from zero phase, middle-scale offset)
+     * 
+     * @tparam _Size Samples count
+     * @tparam _MaxValue Value for 1.0 (DAC max value or timer period)
+     * 
+     * @returns Table
+     */
+    template<size_t _Size, uint16_t _MaxValue = DacMaxValue>
+    consteval std::array<uint16_t, _Size> Sine();
+
+    /**
+     * @brief Generates cosine table (one period from zero phase, middle-scale offset)
+     * 
+     * @tparam _Size Samples count
+     * @tparam _MaxValue Value for 1.0 (DAC max value or timer period)
+     * 
+     * @returns Table
+     */
+    template<size_t _Size, uint16_t _MaxValue = DacMaxValue>
+    consteval std::array<uint16_t, _Size> Cosine();
+
+    /**
+     * @brief Generates triangle table (rise from zero to max value and fall back)
+     * 
+     * @tparam _Size Samples count
+     * @tparam _MaxValue Value for 1.0 (DAC max value or timer period)
+     * 
+     * @returns Table
+     */
+    template<size_t _Size, uint16_t _MaxValue = DacMaxValue>
+    consteval std::array<uint16_t, _Size> Triangle();
+
+    /**
+     * @brief Generates sawtooth table (rise from zero to max value)
+     * 
+     * @tparam _Size Samples count
+     * @tparam _MaxValue Value for 1.0 (DAC max value or timer period)
+     * 
+     * @returns Table
+     */
+    template<size_t _Size, uint16_t _MaxValue = DacMaxValue>
+    consteval std::array<uint16_t, _Size> Sawtooth();
+
+    /**
+     * @brief Generates exponential decay table (from max value)
+     * 
+     * @tparam _Size Samples count
+     * @tparam _MaxValue Value for 1.0 (DAC max value or timer period)
+     * 
+     * @param [in] timeConstant Time constant in samples
+     * 
+     * @returns Table
+     */
+    template<size_t _Size, uint16_t _MaxValue = DacMaxValue>
+    consteval std::array<uint16_t, _Size> ExponentialDecay(double timeConstant);
+}
+
+#include "impl/waveform.h"
+
+#endif //! ZHELE_WAVEFORM_H
@@ -100,6 +100,10 @@ void DmaCompileTest()
 #endif
     DmaCh::Transfer(DmaCh::Mode(), nullptr, nullptr, 0);
     DmaCh::SetTransferCallback(nullptr);
+    DmaCh::SetHalfTransferCallback(nullptr);
+    DmaCh::TransferDoubleBuffered(DmaCh::Mode(), nullptr, nullptr, nullptr, 0);
+    DmaCh::SetDoubleBufferedTransferCallback(nullptr);
+    DmaCh::CurrentBuffer();
     DmaCh::Ready();
     DmaCh::Enabled();
     DmaCh::Enable();
@@ -122,6 +126,21 @@ void DmaCompileTest()
 #endif
     DmaCh::IrqHandler();
 
+    using DmaQueue = DmaTransferQueue<DmaCh, 4>;
+    DmaQueue::Enqueue(DmaCh::Mode(), nullptr, nullptr, 0);
+    DmaQueue::Enqueue(DmaCh::Mode(), nullptr, nullptr, 0, nullptr);
+    DmaQueue::Busy();
+    DmaQueue::Pending();
+    DmaQueue::Clear();
+
+    using Memcpy = DmaMemcpy<DmaCh, 16>;
+    Memcpy::Copy(nullptr, nullptr, 0);
+    Memcpy::Copy(nullptr, nullptr, 0, nullptr);
+    Memcpy::Fill(nullptr, 0, 0);
+    Memcpy::Fill(nullptr, 0, 0, nullptr);
+    Memcpy::Busy();
+    Memcpy::Wait();
+
     using DmaMod = Dma1;
 
     DmaMod::TransferError<0>();
@@ -145,6 +164,25 @@ void DmaCompileTest()
     DmaMod::Disable();
 }
 
+#include <zhele/dma_registry.h>
+void DmaRegistryCompileTest()
+{
+#if defined (DMA1_Stream0)
+    using First = Dma1Stream0;
+    using Second = Dma1Stream1;
+#else
+    using First = Dma1Channel1;
+    using Second = Dma1Channel2;
+#endif
+    using Registry = DmaRegistry<First>;
+    static_assert(Registry::ChannelsCount() == 1);
+    static_assert(Registry::IsUsed<First>());
+    static_assert(!Registry::IsUsed<Second>());
+    static_assert(std::is_same_v<Registry::FreeChannel<First, Second>, Second>);
+    static_assert(Registry::With<Second>::ChannelsCount() == 2);
+    Registry::SelectRequests();
+}
+
 #include <zhele/i2c.h>
 void I2cCompileTest()
 {
@@ -163,12 +201,34 @@ void I2cCompileTest()
     I2c::WaitWhileBusy();
     I2c::EventIrqHandler();
     I2c::ErrorIrqHandler();
+    I2c::EnableSlave(0, nullptr, 0);
+    I2c::DisableSlave();
+    I2c::SetTickSource(nullptr, 0);
+    I2c::Recover();
+    I2c::ClearBus<IO::Pb6, IO::Pb7>();
     I2c::GetErorFromEvent(0);
     I2c::SelectPins<0, 0>();
     I2c::SelectPins(0, 0);
     I2c::SelectPins<IO::Pb6, IO::Pb7>();
 }
 
+#include <zhele/i2c_bus.h>
+void I2cBusCompileTest()
+{
+    using Bus = I2cBus<I2c1>;
+
+    Bus::Init();
+    Bus::WriteU8(0, 0, 0);
+    Bus::Write(0, 0, nullptr, 0);
+    Bus::WriteAsync(0, 0, nullptr, 0);
+    Bus::ReadU8(0, 0);
+    Bus::Read(0, 0, nullptr, 0);
+    Bus::EnableAsyncRead(0, 0, nullptr, 0);
+    Bus::Busy();
+    Bus::Wait();
+    Bus::Pending();
+}
+
 #include <zhele/ioports.h>
 void IoPortsCompileTest()
 {
@@ -239,6 +299,11 @@ void SpiCompileTest()
     SpiBus::Enable();
     SpiBus::Disable();
     SpiBus::Init();
+    SpiBus::Init<1000000>();
+    SpiBus::Init<1000000, 8000000>();
+    SpiBus::SetFrequency(1000000);
+    SpiBus::GetFrequency();
+    static_assert(SpiBus::AchievedFrequency<18000000, 72000000>() == 18000000);
     SpiBus::SetDivider(SpiBus::ClockDivider::Slow);
     SpiBus::SetClockPolarity(SpiBus::ClockPolarity::ClockPolarityLow);
     SpiBus::SetClockPhase(SpiBus::ClockPhase::ClockPhaseLeadingEdge);
@@ -248,12 +313,45 @@ void SpiCompileTest()
     SpiBus::SetSS();
     SpiBus::Send(0);
     SpiBus::SendAsync(nullptr, nullptr, 0);
+    SpiBus::Transfer(nullptr, nullptr, 0);
+    SpiBus::Transfer16(nullptr, nullptr, 0);
     SpiBus::Write(0);
     SpiBus::WriteAsync(nullptr, 0);
+    SpiBus::Fill(0, 0);
     SpiBus::Read();
     SpiBus::ReadAsync(nullptr, 0);
+    SpiBus::EnableSlaveStream(nullptr, 0, nullptr);
+    SpiBus::SlaveFrameEnd();
+    SpiBus::DisableSlaveStream();
     SpiBus::SelectPins(0, 0, 0, 0);
     SpiBus::SelectPins<0, 0, 0, 0>();
+    static_assert(DmaRegistry<SpiBus>::IsUsed<SpiBus::DmaTx>() && DmaRegistry<SpiBus>::IsUsed<SpiBus::DmaRx>());
+#if defined (DMA_SxCR_EN)
+    using SpiFifo = DmaFifo<DmaBase::FifoThreshold::Quarter, 1, 4>;
+    SpiBus::DmaTx::Transfer<SpiFifo>(SpiBus::DmaTx::Mem2Periph | SpiBus::DmaTx::MemIncrement, nullptr, nullptr, 0);
+    SpiBus::DmaRx::Transfer<SpiFifo>(SpiBus::DmaRx::Periph2Mem | SpiBus::DmaRx::MemIncrement, nullptr, nullptr, 0);
+#endif
+}
+
+#include <zhele/spi_bus.h>
+void SpiBusCompileTest()
+{
+    using Bus = SpiBus<Spi1>;
+    using Flash = SpiDevice<Bus, IO::Pa4, SpiConfig<Spi1::ClockDivider::Fast>>;
+    using Sensor = SpiDevice<Bus, IO::Pa3, SpiConfig<Spi1::ClockDivider::Slow, Spi1::ClockPolarityHigh, Spi1::ClockPhaseFallingEdge>>;
+
+    Bus::Init();
+    Bus::Configure<Flash::Config>();
+    Bus::Invalidate();
+    Bus::Busy();
+    Bus::Wait();
+    Bus::Pending();
+    Flash::Init();
+    Flash::Select();
+    Flash::Send(0);
+    Flash::Release();
+    Flash::Transfer(nullptr, nullptr, 0);
+    Sensor::TransferAsync(nullptr, nullptr, 0);
 }
 
 #include <zhele/timer.h>
@@ -298,7 +396,103 @@ void TimerCompileTest()
     TimPWM::SetOutputFastMode(TimPWM::FastMode::Disable);
     TimPWM::SelectPins(0);
     TimPWM::SelectPins<0>();
+
+    using TimPwmInput = Tim::PwmInput<0>;
+    TimPwmInput::Enable(TimPwmInput::Polarity::ActiveLow);
+    TimPwmInput::IsReady();
+    TimPwmInput::IsOverflow();
+    TimPwmInput::GetPeriod();
+    TimPwmInput::GetPulse();
+    TimPwmInput::GetDuty();
+    TimPwmInput::Disable();
+    TimPwmInput::SelectPins(0);
+    TimPwmInput::SelectPins<0>();
+    Tim::PwmInput<1>::Enable();
+}
+
+#if defined (STM32F1) || defined (STM32F4)
+void AdvancedTimerCompileTest()
+{
+    using Tim = Timers::Timer1;
+    Tim::InitCenterAligned(1800);
+    Tim::SetDeadTime<72000000, 500>();
+    Tim::EnableBreak(Tim::BreakPolarity::ActiveLow);
+    Tim::DisableBreak();
+    Tim::SelectBreakPins<Tim::BreakPins::Pin<0>>();
+    Tim::IsBreak();
+    Tim::ClearBreakFlag();
+    Tim::SetOffState(true, true);
+    Tim::EnableOutputs();
+    Tim::DisableOutputs();
+    Tim::IsOutputsEnabled();
+    Tim::Lock(Tim::LockLevel::Off);
+    Tim::SetSpaceVector(0, 0);
+
+    using TimCPWM = Tim::ComplementaryPwm<0>;
+    TimCPWM::EnableComplementary();
+    TimCPWM::DisableComplementary();
+    TimCPWM::SetComplementaryPolarity(TimCPWM::OutputPolarity::ActiveHigh);
+    TimCPWM::SetIdleState(false, false);
+    TimCPWM::SelectComplementaryPins<TimCPWM::ComplementaryPins::Pin<0>>();
+}
+#endif
+
+#if !defined (STM32F1)
+#include <zhele/rtc.h>
+void RtcCompileTest()
+{
+    Rtc::Init(Rtc::ClockSource::Lsi, 32000);
+    Rtc::SetDateTime({.Seconds = 0, .Minutes = 30, .Hours = 12, .Weekday = 1, .Day = 1, .Month = 7, .Year = 24});
+    Rtc::GetDateTime();
+    Rtc::Now();
+    Rtc::DayTicks();
+    Rtc::Resynchronize();
+    Rtc::EnableAlarm(Rtc::Alarm::A, {.Seconds = 0, .Minutes = 0, .Hours = 6}, Rtc::AlarmMatch::Time);
+    Rtc::IsInterrupt(Rtc::Interrupt::AlarmA);
+    Rtc::ClearInterruptFlag(Rtc::Interrupt::AlarmA);
+    Rtc::DisableAlarm(Rtc::Alarm::A);
+#if defined (RTC_CR_WUTE)
+    Rtc::EnableWakeup(500);
+    Rtc::DisableWakeup();
+#endif
+    Rtc::SetCalibration(-1000);
+    static_assert(Rtc::CalculateCalibration(-1000) == 1);
+    static_assert(Rtc::CalculateCalibration(10000) == (RTC_CALR_CALP | 502));
+    static_assert(Rtc::ToEpoch({.Seconds = 0, .Minutes = 0, .Hours = 0, .Weekday = 6, .Day = 1, .Month = 1, .Year = 0}) == 946684800);
+    static_assert(Rtc::FromEpoch(946684800).Weekday == 6);
 }
+#endif
+
+#if defined (STM32L4) || defined (STM32G0)
+#include <zhele/lptimer.h>
+#include <zhele/system_time.h>
+#include <zhele/timer_wheel.h>
+void LpTimerCompileTest()
+{
+    using Tim = Timers::LpTimer1;
+    Clock::LpTim1Clock::SelectClockSource(Clock::LpTimerClockSource::Lse);
+    Tim::Enable();
+    Tim::SetPrescaler(Tim::Div32);
+    Tim::SetPeriod(0xffff);
+    Tim::Start();
+    Tim::GetCounterValue();
+    Tim::EnableInterrupt(Tim::Interrupt::AutoReloadMatch | Tim::Interrupt::CompareMatch);
+    Tim::IsInterrupt(Tim::Interrupt::AutoReloadMatch);
+    Tim::ClearInterruptFlag(Tim::Interrupt::AutoReloadMatch);
+    Tim::EnableEncoderMode();
+    Tim::EnableExternalCounting(Tim::Edge::Rising, true);
+    Tim::SelectInputPins<IO::Pb5, IO::Pb7>();
+    Tim::SelectOutputPin<IO::Pb2>();
+    Tim::OutputCompare<0>::SetOutputMode(Tim::OutputCompare<0>::SetOnce);
+    Tim::OutputCompare<0>::SetPulse(100);
+    Timers::LpTimer2::SelectInputPins<IO::Pb1>();
+    SystemTime::SetStopTimeSource<Tim>();
+
+    using Wheel = Timers::TimerWheel<Timers::LpTimer2, 0, 256>;
+    Wheel::Init(Timers::LpTimer2::Div1);
+    Wheel::IrqHandler();
+}
+#endif
 
 #include <zhele/sart.h>
 void UsartCompileTest()
@@ -310,21 +504,86 @@ void UsartCompileTest()
     UsartBus::SetConfig(UsartBus::UsartMode::DataBits8 | UsartBus::UsartMode::FullDuplex);
     UsartBus::ClearConfig(UsartBus::UsartMode::DataBits8 | UsartBus::UsartMode::FullDuplex);
     UsartBus::SetBaud(9600);
+    UsartBus::GetBaud();
+    UsartBus::Init<115200, 8000000>();
+    static_assert(UsartBus::BaudError<9600, 8000000>() < 1000);
+#if defined (USART_CR2_ABREN)
+    UsartBus::EnableAutoBaud();
+    UsartBus::EnableAutoBaud(UsartBus::AutoBaudMode::Frame0x55);
+    UsartBus::DisableAutoBaud();
+    UsartBus::RestartAutoBaud();
+    UsartBus::AutoBaudReady();
+    UsartBus::AutoBaudFailed();
+#endif
     UsartBus::ReadReady();
     UsartBus::Read();
     UsartBus::EnableAsyncRead(nullptr, 0);
+    UsartBus::EnableCircularRead(nullptr, 0, nullptr);
+    UsartBus::DisableCircularRead();
+    UsartBus::CircularReadIrqHandler();
     UsartBus::WriteReady();
     UsartBus::Write(nullptr, 0);
+    UsartBus::WriteAsync({std::span<const uint8_t>(), std::span<const uint8_t>()});
+    UsartBus::WriteAsync({std::span<const uint8_t>()}, nullptr);
     UsartBus::Write(0);
     UsartBus::EnableInterrupt(UsartBus::InterruptFlags::AllInterrupts);
     UsartBus::DisableInterrupt(UsartBus::InterruptFlags::AllInterrupts);
     UsartBus::InterruptSource();
     UsartBus::GetError();
     UsartBus::ClearInterruptFlag(UsartBus::InterruptFlags::AllInterrupts);
+#if defined (USART_CR1_FIFOEN)
+    UsartBus::EnableFifo(UsartBus::FifoThreshold::OneEighth, UsartBus::FifoThreshold::Full);
+    UsartBus::DisableFifo();
+    UsartBus::FifoEnabled();
+#endif
+#if defined (USART_CR1_UESM)
+    UsartBus::EnableWakeUpFromStop(UsartBus::WakeUpSource::StartBit);
+    UsartBus::EnableWakeUpFromStop(UsartBus::WakeUpSource::AddressMatch, 0x21);
+    UsartBus::DisableWakeUpFromStop();
+#endif
     UsartBus::SelectTxRxPins(0, 0);
     UsartBus::SelectTxRxPins<0, 0>();
 }
 
+#if defined (STM32L4)
+void LpUartCompileTest()
+{
+    Clock::LpUart1Clock::SelectClockSource(Clock::UsartClockSource::Lse);
+    LpUart1::Init<9600, 32768>();
+    LpUart1::SetBaud(9600);
+    LpUart1::GetBaud();
+    static_assert(LpUart1::LowPower && !Usart1::LowPower);
+    static_assert(UsartBase::CalculateLowPowerBaudRegister(32768, 9600) == 0x36a);
+    LpUart1::EnableWakeUpFromStop(LpUart1::WakeUpSource::StartBit);
+    LpUart1::SelectTxRxPins<IO::Pb11, IO::Pb10>();
+}
+#endif
+
+#include <zhele/buffered_usart.h>
+void BufferedUsartCompileTest()
+{
+    using BufferedBus = BufferedUsart<Usart1, 32, 16>;
+    uint8_t byte;
+
+    BufferedBus::Init<9600>();
+    BufferedBus::Init(9600);
+    BufferedBus::Write(0);
+    BufferedBus::Write(nullptr, 0);
+    BufferedBus::Read(byte);
+    BufferedBus::Read(nullptr, 0);
+    BufferedBus::RxAvailable();
+    BufferedBus::TxFree();
+    BufferedBus::Flush();
+    BufferedBus::TxHighWater();
+    BufferedBus::RxHighWater();
+    BufferedBus::RxOverflows();
+    BufferedBus::ResetStatistics();
+#if defined (USART_CR1_FIFOEN)
+    BufferedBus::EnableFifo(BufferedBus::FifoThreshold::Half, BufferedBus::FifoThreshold::Half);
+#endif
+    BufferedBus::IrqHandler();
+}
+
 /*
 #include <one_wire.h>
 void OneWireCompileTest()
@@ -363,4 +622,279 @@ void RingBufferTest()
     buffer64[0] = 42;
     constBuffer64[0];
 
-}
\ No newline at end of file
+    struct Message
+    {
+        Message(uint8_t id, const uint8_t* data) : Id(id), Data(data) {}
+        Message(Message&&) = default;
+        Message& operator=(Message&&) = default;
+
+        uint8_t Id;
+        const uint8_t* Data;
+    };
+    Zhele::Containers::RingBuffer<10, Message> messages;
+    messages.emplace_back(1, nullptr);
+    messages.push_back(Message(2, nullptr));
+    Message message(0, nullptr);
+    messages.pop_front(message);
+    messages.clear();
+}
+#include <zhele/dsp.h>
+void DspCompileTest()
+{
+    using namespace Zhele::Dsp;
+    static constexpr int16_t fir15[4] = {ToQ15(0.25), ToQ15(0.25), ToQ15(0.25), ToQ15(0.25)};
+    static constexpr int32_t fir31[4] = {ToQ31(0.25), ToQ31(0.25), ToQ31(0.25), ToQ31(0.25)};
+    static constexpr BiquadCoefficients<int16_t> biquad15[] = {BiquadCoefficients<int16_t>::From(0.0675, 0.1349, 0.0675, 1.1430, -0.4128, 1)};
+    static constexpr BiquadCoefficients<int32_t> biquad31[] = {BiquadCoefficients<int32_t>::From(0.0675, 0.1349, 0.0675, 1.1430, -0.4128, 1)};
+    int16_t samples15[16] = {};
+    int32_t samples31[16] = {};
+
+    FirQ15<4> firQ15(fir15);
+    firQ15.Process(samples15, samples15);
+    firQ15.Process(int16_t(0));
+    firQ15.Reset();
+    FirQ31<4> firQ31(fir31);
+    firQ31.Process(samples31, samples31);
+
+    FirDecimatorQ15<4, 2> decimatorQ15(fir15);
+    decimatorQ15.Process(samples15, samples15);
+    decimatorQ15.Reset();
+    FirDecimatorQ31<4, 2> decimatorQ31(fir31);
+    decimatorQ31.Process(samples31, samples31);
+
+    BiquadCascadeQ15<1> biquadQ15(biquad15);
+    biquadQ15.Process(samples15, samples15);
+    biquadQ15.Reset();
+    BiquadCascadeQ31<1> biquadQ31(biquad31, 1);
+    biquadQ31.Process(samples31, samples31);
+}
+#include <zhele/fft.h>
+void FftCompileTest()
+{
+    using namespace Zhele::Dsp;
+    static constexpr auto hann = MakeWindow<int16_t, 64>(Window::Hann);
+    static constexpr auto blackman = MakeWindow<float, 64>(Window::Blackman);
+    int16_t samples15[64] = {};
+    float samplesF32[64] = {};
+    Complex<int16_t> spectrum15[RealFftQ15<64>::Bins];
+    Complex<float> spectrumF32[RealFftF32<64>::Bins];
+    int16_t magnitudes15[RealFftQ15<64>::Bins];
+
+    RealFftQ15<64>::Transform(samples15, spectrum15);
+    RealFftQ15<64>::Transform(samples15, hann, spectrum15);
+    RealFftQ15<64>::Magnitude(spectrum15, magnitudes15);
+    RealFftQ15<64>::FindPeak(spectrum15);
+    static_assert(RealFftQ15<64>::BinFrequency(1, 6400) == 100);
+
+    RealFftF32<64>::Transform(samplesF32, blackman, spectrumF32);
+    RealFftF32<64>::FindPeak(spectrumF32, 0);
+}
+
+#if defined (STM32F1)
+#include <zhele/adc.h>
+void AdcInitCompileTest()
+{
+    Adc1::InitAsync();
+    Adc1::Ready();
+    Adc1::WaitReady();
+    Adc1::Calibrated();
+    Adc1::Suspend();
+    Adc1::Init();
+    Adc1::Calibrate();
+}
+#endif
+
+#if defined (STM32F1)
+#include <zhele/motor_sampler.h>
+void MotorSamplerCompileTest()
+{
+    using Sampler = MotorSampler<Timers::Timer1, Adc1>;
+    Sampler::Start<IO::Pa0, IO::Pa1>([](const uint16_t* results, uint8_t count) { (void)results; (void)count; }, 7);
+    Sampler::SetSamplePoint(8);
+    Sampler::IrqHandler();
+    Sampler::Stop();
+}
+#endif
+
+#include <zhele/pid.h>
+void PidCompileTest()
+{
+    using namespace Zhele::Dsp;
+    static constexpr auto coefficients = PidCoefficients::From(2.0, 50.0, 0.001, 1000, 100);
+    PidQ16 pidQ16(coefficients, 0, PidQ16::FromDouble(100.0));
+    pidQ16.Step(PidQ16::FromDouble(1.0), 0);
+    pidQ16.SetCoefficients(coefficients);
+    pidQ16.SetLimits(0, PidQ16::FromDouble(50.0));
+    pidQ16.Reset(PidQ16::FromDouble(10.0));
+    pidQ16.Output();
+    PidQ31 pidQ31(coefficients, PidQ31::FromDouble(-0.5), PidQ31::FromDouble(0.5));
+    pidQ31.Step(PidQ31::FromDouble(0.25), PidQ31::FromDouble(0.125));
+}
+
+#include <zhele/control_loop.h>
+void ControlLoopCompileTest()
+{
+    using Loop = ControlLoop<Timers::Timer3, 1000>;
+    Loop::Init([]() {});
+    Loop::Start();
+    Loop::IrqHandler();
+    Loop::Statistics().Jitter();
+    Loop::ResetStatistics();
+    Loop::TickFrequency();
+    Loop::Stop();
+}
+
+#include <zhele/pulse_train.h>
+void PulseTrainCompileTest()
+{
+#if defined (DMA1_Stream0)
+    using DmaCh = Dma1Stream2;
+#else
+    using DmaCh = Dma1Channel3;
+#endif
+    using Train = PulseTrain<Timers::Timer3, 1, DmaCh>;
+    static constexpr Train::Step steps[] = {Train::MakeStep(50, 10), Train::MakeStep(100, 0)};
+    Train::Init();
+    Train::Start(steps, 2);
+    Train::Start(steps, 2, nullptr, true);
+    Train::Stop();
+}
+
+#include <zhele/format.h>
+void FormatCompileTest()
+{
+    char text[FormatMaxSize<"{} {:08x} {:.2}", int, uint32_t, FixedQ16>()];
+    FormatTo<"{} {:08x} {:.2}">(text, -1, 0xbeefu, FixedQ16{0x18000});
+
+    Zhele::Containers::RingBuffer<64, uint8_t> log;
+    Format<"adc {:5} {:b}\r\n">(log, uint16_t(4095), uint8_t(5));
+    Format<"{{}} {:c}\r\n", Usart1>('x');
+}
+
+#include <zhele/binary_log.h>
+void BinaryLogCompileTest()
+{
+    using Log = BinaryLog<256>;
+    ZHELE_LOG(Log, "boot");
+    ZHELE_LOG(Log, "adc=%u t=%d v=%f", 4095u, -12, 3.3f);
+    Log::Drain<Usart1>();
+    Log::DrainAsync<Usart1>();
+    Log::Size();
+    Log::Dropped();
+}
+
+#include <zhele/statistics.h>
+void StatisticsCompileTest()
+{
+    Usart1::Counters::Value(Statistics::UsartCounters::Overrun);
+    Usart1::Counters::Add(Statistics::UsartCounters::TxBytes, 16);
+    Statistics::Report<Usart1>();
+    Statistics::Reset();
+}
+
+#if defined (STM32F4)
+#include <zhele/i2s.h>
+void I2sCompileTest()
+{
+    using Audio = I2s<Spi2, IO::Pc6>;
+    static uint16_t samples[512];
+    Audio::Init<48000, 1000000>(Audio::Mode::MasterTx);
+    Audio::SelectPins<IO::Pb15, IO::Pb13, IO::Pb12>();
+    Audio::Stream(samples, 256, [](uint16_t*, uint32_t) {});
+    Audio::DataLost();
+    Audio::Stop();
+}
+#endif
+
+#if defined (STM32F1) || defined (STM32F4)
+#include <zhele/can.h>
+void CanCompileTest()
+{
+    static_assert(Can1::CalculateTiming(36000000, 1000000, 875).Prescaler == 2);
+    Can1::SelectPins<IO::Pb9, IO::Pb8>();
+    Can1::Init<500000, 36000000>(Can1::Mode::Loopback);
+    Can1::SetMaskFilter(0, 0x100, 0x700);
+    Can1::SetListFilter(1, 0x1234567, 0x1234568, true, 1);
+    Can1::Send({.Id = 0x123, .Length = 2, .Data = {1, 2}});
+    CanMessage message;
+    Can1::Receive(message);
+    Can1::Rx0IrqHandler();
+    Can1::TxIrqHandler();
+}
+#endif
+
+#if defined (STM32L4) && defined (QUADSPI)
+#include <zhele/drivers/qspi_flash.h>
+void QuadSpiCompileTest()
+{
+    using Assets = Drivers::QspiFlash<QuadSpi, 8 * 1024 * 1024>;
+    QuadSpi::SelectPins<IO::Pe10, IO::Pe11, IO::Pe12, IO::Pe13, IO::Pe14, IO::Pe15>();
+    Assets::Init<40000000, 80000000>();
+    static const uint8_t data[] = {1, 2, 3};
+    Assets::ErasePage(0);
+    Assets::WritePage(0u, data, sizeof(data), 0u);
+    uint8_t buffer[3];
+    Assets::Read(0, buffer, sizeof(buffer));
+}
+#endif
+
+#include <zhele/drivers/spi_flash.h>
+void SpiFlashCompileTest()
+{
+    using Flash = Drivers::SpiFlash<Spi1, IO::Pa4, 8 * 1024 * 1024>;
+    Flash::Init();
+    static const uint8_t data[] = {1, 2, 3};
+    Flash::Erase(0, 0x11000);
+    Flash::Write(0, data, sizeof(data));
+    uint8_t block[512];
+    Flash::ReadBlock(block, 0);
+    Flash::WriteBlock(block, 1);
+    Flash::Sleep();
+    Flash::Wake();
+}
+
+#include <zhele/flash.h>
+#if defined (ZHELE_FLASH_DUAL_BANK)
+#include <zhele/crc.h>
+void FlashDualBankCompileTest()
+{
+    static const uint8_t image[] = {1, 2, 3};
+    auto bank = Flash::InactiveBank();
+    uint32_t address = Flash::BankAddress(bank);
+    Flash::EraseBankAsync(bank, [](bool) {});
+    Flash::ErasePage(Flash::AddressToPage(reinterpret_cast<const void*>(address)));
+    Flash::WriteFlashAsync(reinterpret_cast<void*>(address), image, sizeof(image));
+    if (Flash::Verify<Crc>(reinterpret_cast<const void*>(address), sizeof(image), 0x12345678))
+        Flash::SwapBanks();
+}
+#endif
+
+#include <zhele/soft_i2c.h>
+#include <zhele/drivers/bmp280.h>
+#if defined (TIM4)
+void SoftI2cCompileTest()
+{
+    using I2c = SoftI2c<IO::Pb6, IO::Pb7, Timers::Timer4>;
+
+    I2c::Init();
+    I2c::Init(400000);
+    I2c::WriteU8(0, 0, 0);
+    I2c::Write(0, 0, nullptr, 0);
+    I2c::WriteAsync(0, 0, nullptr, 0);
+    I2c::ReadU8(0, 0);
+    I2c::Read(0, 0, nullptr, 0);
+    I2c::EnableAsyncRead(0, 0, nullptr, 0);
+    I2c::Busy();
+    I2c::IrqHandler();
+
+    // Sensor driver works on software I2C unchanged
+    using Sensor = Drivers::Bmp280<I2c>;
+    Sensor::Init();
+    Sensor::ReadTemperature();
+    Sensor::Measurement measurement;
+    Sensor::ReadMeasurement(measurement);
+    Sensor::ReadMeasurementAsync(nullptr);
+    Sensor::StartMeasurement();
+    Sensor::Poll();
+}
+#endif
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""
+Decodes Zhele binary log (include/zhele/binary_log.h).
+
+Format strings are read from firmware ELF: every log call site defines symbol
+Zhele::Private::LogFormat<...>::Text, its address is record id. Record is id (4 bytes)
+and arguments (little-endian, 4 or 8 bytes, see BinaryLog). Unknown id is skipped
+byte by byte, so decoder resynchronizes after lost data.
+
+Usage:
+    zhele_log_decode.py firmware.elf log.bin
+    stty -F /dev/ttyUSB0 921600 raw && zhele_log_decode.py firmware.elf /dev/ttyUSB0
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+FORMAT_SYMBOL = b"_ZN5Zhele7Private9LogFormatI"
+CONVERSION = re.compile(r"%([-+ #0-9.]*)([hlz]*)([diuxXocfeg%])")
+
+
+def read_formats(path):
+    """Returns {id: format string} from ELF symbols."""
+    with open(path, "rb") as file:
+        elf = file.read()
+
+    if elf[:4] != b"\x7fELF":
+        sys.exit(f"{path}: not an ELF file")
+    is64 = elf[4] == 2
+    endian = "<" if elf[5] == 1 else ">"
+
+    if is64:
+        shoff, = struct.unpack_from(endian + "Q", elf, 0x28)
+        shentsize, shnum = struct.unpack_from(endian + "HH", elf, 0x3a)
+        section_format, symbol_format = "IIQQQQIIQQ", "IBBHQQ"
+    else:
+        shoff, = struct.unpack_from(endian + "I", elf, 0x20)
+        shentsize, shnum = struct.unpack_from(endian + "HH", elf, 0x2e)
+        section_format, symbol_format = "IIIIIIIIII", "IIIBBH"
+
+    sections = [struct.unpack_from(endian + section_format, elf, shoff + i * shentsize) for i in range(shnum)]
+
+    def section(index):
+        name, kind, flags, address, offset, size, link, info, align, entsize = sections[index]
+        return kind, address, offset, size, link, entsize
+
+    formats = {}
+    for index in range(shnum):
+        kind, _, offset, size, link, entsize = section(index)
+        if kind != 2:  # SHT_SYMTAB
+            continue
+        strings_offset = section(link)[2]
+        for position in range(offset, offset + size, entsize):
+            fields = struct.unpack_from(endian + symbol_format, elf, position)
+            if is64:
+                name, _, _, shndx, value, symbol_size = fields
+            else:
+                name, value, symbol_size, _, _, shndx = fields
+            end = elf.index(b"\0", strings_offset + name)
+            if not elf[strings_offset + name:end].startswith(FORMAT_SYMBOL) or shndx == 0 or shndx >= shnum:
+                continue
+            _, section_address, section_offset, _, _, _ = section(shndx)
+            start = section_offset + value - section_address
+            text = elf[start:start + symbol_size].split(b"\0")[0]
+            formats[value & 0xffffffff] = text.decode("ascii", "replace")
+    return formats
+
+
+def argument_sizes(text):
+    """Returns argument wire formats (struct codes) and python format string."""
+    codes = []
+
+    def convert(match):
+        flags, modifiers, conversion = match.groups()
+        if conversion == "%":
+            return "%%"
+        if conversion in "fge":
+            codes.append("d" if "l" in modifiers else "f")
+        elif conversion in "di":
+            codes.append("q" if modifiers.count("l") >= 2 else "i")
+        else:
+            codes.append("Q" if modifiers.count("l") >= 2 else "I")
+        return "%" + flags + ("d" if conversion == "u" else conversion)
+
+    return codes, CONVERSION.sub(convert, text)
+
+
+def decode(formats, stream, output):
+    parsed = {id: argument_sizes(text) for id, text in formats.items()}
+    buffer = b""
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            break
+        buffer += chunk
+        position = 0
+        while len(buffer) - position >= 4:
+            id, = struct.unpack_from("<I", buffer, position)
+            if id not in parsed:
+                position += 1
+                continue
+            codes, text = parsed[id]
+            size = 4 + struct.calcsize("<" + "".join(codes))
+            if len(buffer) - position < size:
+                break
+            values = struct.unpack_from("<" + "".join(codes), buffer, position + 4)
+            output.write(text % values + "\n")
+            output.flush()
+            position += size
+        buffer = buffer[position:]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decodes Zhele binary log")
+    parser.add_argument("elf", help="Firmware ELF file")
+    parser.add_argument("log", nargs="?", help="Binary log file or serial device (stdin by default)")
+    parser.add_argument("--list", action="store_true", help="List format strings and exit")
+    arguments = parser.parse_args()
+
+    formats = read_formats(arguments.elf)
+    if arguments.list:
+        for id, text in sorted(formats.items()):
+            print(f"{id:08x} {text}")
+        return
+
+    if arguments.log:
+        with open(arguments.log, "rb", buffering=0) as stream:
+            decode(formats, stream, sys.stdout)
+    else:
+        decode(formats, sys.stdin.buffer, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()